@@ -1259,6 +1259,11 @@ TF_CAPI_EXPORT extern void TF_DeleteSession(TF_Session*, TF_Status* status);
 // output_values[]. Ownership of the elements of output_values[] is transferred
 // to the caller, which must eventually call TF_DeleteTensor on them.
 //
+// Input and output tensors of types other than TF_STRING and TF_RESOURCE are
+// passed without copying their data: inputs are used in place, and outputs
+// refer to the buffers produced by the session. TF_STRING tensors are
+// re-encoded; use TF_TensorStringView to read output strings in place.
+//
 // On failure, output_values[] contains NULLs.
 TF_CAPI_EXPORT extern void TF_SessionRun(
     TF_Session* session,
@@ -250,6 +250,20 @@ void TestEncodeDecode(int line, const std::vector<string>& data) {
       ASSERT_EQ(data[i], output.flat<tstring>()(i)) << line;
     }
 
+    // The strings can also be read in place.
+    TF_Status* s = TF_NewStatus();
+    const char* base = static_cast<const char*>(TF_TensorData(dst));
+    for (tensorflow::int64 i = 0; i < src.NumElements(); ++i) {
+      const char* view;
+      size_t view_len;
+      TF_TensorStringView(dst, i, &view, &view_len, s);
+      ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s) << line;
+      EXPECT_EQ(data[i], string(view, view_len)) << line;
+      EXPECT_GE(view, base) << line;
+      EXPECT_LE(view + view_len, base + TF_TensorByteSize(dst)) << line;
+    }
+    TF_DeleteStatus(s);
+
     TF_DeleteTensor(dst);
   }
 }
@@ -264,6 +278,51 @@ TEST(CAPI, TensorEncodeDecodeStrings) {
   TestEncodeDecode(__LINE__, {"small", big, "small2"});
 }
 
+TEST(CAPI, TensorStringViewErrors) {
+  TF_Status* s = TF_NewStatus();
+  const char* view;
+  size_t view_len;
+
+  Tensor src(tensorflow::DT_STRING, TensorShape({2}));
+  src.flat<tstring>()(0) = "a";
+  src.flat<tstring>()(1) = "b";
+  Status status;
+  TF_Tensor* t = TF_TensorFromTensor(src, &status);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  TF_TensorStringView(t, 2, &view, &view_len, s);
+  EXPECT_EQ(TF_OUT_OF_RANGE, TF_GetCode(s));
+  TF_TensorStringView(t, -1, &view, &view_len, s);
+  EXPECT_EQ(TF_OUT_OF_RANGE, TF_GetCode(s));
+  TF_DeleteTensor(t);
+
+  int64_t dims[] = {1};
+  t = TF_AllocateTensor(TF_FLOAT, dims, 1, sizeof(float));
+  TF_TensorStringView(t, 0, &view, &view_len, s);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(s));
+  TF_DeleteTensor(t);
+
+  TF_DeleteStatus(s);
+}
+
+TEST(CAPI, TensorDefaultAlignmentAvoidsCopy) {
+  const size_t alignment = TF_TensorDefaultAlignment();
+  EXPECT_GE(alignment, 1);
+  const int num_bytes = 6 * sizeof(float);
+  float* values =
+      reinterpret_cast<float*>(tensorflow::cpu_allocator()->AllocateRaw(
+          alignment, num_bytes));
+  ASSERT_EQ(0, reinterpret_cast<uintptr_t>(values) % alignment);
+  int64_t dims[] = {2, 3};
+  bool deallocator_called = false;
+  TF_Tensor* t = TF_NewTensor(TF_FLOAT, dims, 2, values, num_bytes,
+                              &Deallocator, &deallocator_called);
+  EXPECT_EQ(static_cast<void*>(values), TF_TensorData(t));
+  EXPECT_TRUE(TF_TensorIsAligned(t));
+  EXPECT_FALSE(deallocator_called);
+  TF_DeleteTensor(t);
+  EXPECT_TRUE(deallocator_called);
+}
+
 TEST(CAPI, SessionOptions) {
   TF_SessionOptions* opt = TF_NewSessionOptions();
   TF_DeleteSessionOptions(opt);
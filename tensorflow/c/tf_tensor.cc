@@ -128,6 +128,10 @@ TF_Tensor* TF_NewTensor(TF_DataType dtype, const int64_t* dims, int num_dims,
   return CreateTensor(buf, dtype, dims, num_dims, len);
 }
 
+size_t TF_TensorDefaultAlignment() {
+  return std::max(1, EIGEN_MAX_ALIGN_BYTES);
+}
+
 TF_Tensor* TF_TensorMaybeMove(TF_Tensor* t) {
   return t->tensor->CanMove() ? t : nullptr;
 }
@@ -280,6 +284,43 @@ size_t TF_StringEncodedSize(size_t len) {
   return static_cast<size_t>(tensorflow::core::VarintLength(len)) + len;
 }
 
+void TF_TensorStringView(const TF_Tensor* t, int64_t index, const char** dst,
+                         size_t* dst_len, TF_Status* status) {
+  if (TF_TensorType(t) != TF_STRING) {
+    Set_TF_Status_from_Status(
+        status, InvalidArgument("TF_TensorStringView requires a TF_STRING "
+                                "tensor, got type ",
+                                TF_TensorType(t)));
+    return;
+  }
+  const int64_t num_elements = TF_TensorElementCount(t);
+  if (index < 0 || index >= num_elements) {
+    Set_TF_Status_from_Status(
+        status, tensorflow::errors::OutOfRange("string index ", index,
+                                               " out of range for a tensor of ",
+                                               num_elements, " strings"));
+    return;
+  }
+  // See the TF_STRING encoding described in tf_tensor.h.
+  const char* base = static_cast<const char*>(TF_TensorData(t));
+  const size_t size = TF_TensorByteSize(t);
+  const size_t offsets_size = sizeof(tensorflow::uint64) * num_elements;
+  tensorflow::uint64 offset = 0;
+  if (size >= offsets_size) {
+    std::memcpy(&offset, base + sizeof(tensorflow::uint64) * index,
+                sizeof(offset));
+  }
+  if (size < offsets_size || offset >= size - offsets_size) {
+    Set_TF_Status_from_Status(
+        status, InvalidArgument("invalid string tensor encoding"));
+    return;
+  }
+  const char* src = base + offsets_size + offset;
+  Set_TF_Status_from_Status(
+      status, TF_StringDecode_Impl(src, size - offsets_size - offset, dst,
+                                   dst_len));
+}
+
 static void DeleteArray(void* data, size_t size, void* arg) {
   DCHECK_EQ(data, arg);
   delete[] reinterpret_cast<char*>(arg);
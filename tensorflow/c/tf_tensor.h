@@ -74,11 +74,20 @@ typedef struct TF_Tensor TF_Tensor;
 // May return NULL (and invoke the deallocator) if the provided data buffer
 // (data, len) is inconsistent with a tensor of the given TF_DataType
 // and the shape specified by (dima, num_dims).
+//
+// If `data` is aligned to TF_TensorDefaultAlignment(), the tensor uses the
+// buffer in place. Otherwise, buffers of types other than
+// TF_STRING and TF_RESOURCE are copied into aligned memory, and the
+// deallocator is called right away.
 TF_CAPI_EXPORT extern TF_Tensor* TF_NewTensor(
     TF_DataType, const int64_t* dims, int num_dims, void* data, size_t len,
     void (*deallocator)(void* data, size_t len, void* arg),
     void* deallocator_arg);
 
+// Returns the alignment, in bytes, that buffers passed to TF_NewTensor must
+// have to be used without a copy.
+TF_CAPI_EXPORT extern size_t TF_TensorDefaultAlignment(void);
+
 // Allocate and return a new Tensor.
 //
 // This function is an alternative to TF_NewTensor and should be used when
@@ -176,6 +185,17 @@ TF_CAPI_EXPORT extern size_t TF_StringDecode(const char* src, size_t src_len,
 // TF_STRING tensor.
 TF_CAPI_EXPORT extern size_t TF_StringEncodedSize(size_t len);
 
+// Sets `*dst` and `*dst_len` to the `index`-th string (in row-major order) of
+// the TF_STRING tensor `t`, without copying it. `*dst` points into
+// TF_TensorData(t) and remains valid until `t` is deleted.
+//
+// On failure (e.g. `t` is not a TF_STRING tensor, `index` is out of range, or
+// the encoding is malformed) `status` is set accordingly.
+TF_CAPI_EXPORT extern void TF_TensorStringView(const TF_Tensor* t,
+                                               int64_t index, const char** dst,
+                                               size_t* dst_len,
+                                               TF_Status* status);
+
 // Returns bool iff this tensor is aligned.
 TF_CAPI_EXPORT extern bool TF_TensorIsAligned(const TF_Tensor*);
 
@@ -33,6 +33,9 @@ constexpr char kSavedModelFilenamePb[] = "saved_model.pb";
 /// SavedModel text format proto filename.
 constexpr char kSavedModelFilenamePbTxt[] = "saved_model.pbtxt";
 
+/// SavedModel warm-start graph filename, see ExportWarmStartGraph().
+constexpr char kSavedModelWarmStartGraphFilename[] = "warm_start_graph.pb";
+
 /// SavedModel legacy init op collection key. Used in v1 SavedModels.
 constexpr char kSavedModelLegacyInitOpKey[] = "legacy_init_op";
 
@@ -15,14 +15,19 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
 #include "tensorflow/cc/saved_model/reader.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
@@ -30,10 +35,14 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -95,16 +104,6 @@ static Status ValidateSavedTensors(const GraphDef& graph_def) {
   return Status::OK();
 }
 
-Status LoadMetaGraphIntoSession(const MetaGraphDef& meta_graph_def,
-                                const SessionOptions& session_options,
-                                std::unique_ptr<Session>* session) {
-  Session* session_p = nullptr;
-  TF_RETURN_IF_ERROR(NewSession(session_options, &session_p));
-  session->reset(session_p);
-  TF_RETURN_IF_ERROR(ValidateSavedTensors(meta_graph_def.graph_def()));
-  return (*session)->Create(meta_graph_def.graph_def());
-}
-
 Tensor CreateStringTensor(const string& value) {
   Tensor tensor(DT_STRING, TensorShape({}));
   tensor.scalar<tstring>()() = value;
@@ -191,12 +190,12 @@ Status RunInitOp(const RunOptions& run_options, const string& export_dir,
   return Status::OK();
 }
 
-Status RunRestore(const RunOptions& run_options, const string& export_dir,
-                  const StringPiece restore_op_name,
-                  const StringPiece variable_filename_const_op_name,
-                  const std::vector<AssetFileDef>& asset_file_defs,
-                  Session* session) {
-  LOG(INFO) << "Restoring SavedModel bundle.";
+// Returns the feeds of the restore op in "inputs", or false if the SavedModel
+// has no variables to restore.
+bool GetRestoreInputs(const string& export_dir,
+                      const StringPiece variable_filename_const_op_name,
+                      const std::vector<AssetFileDef>& asset_file_defs,
+                      std::vector<std::pair<string, Tensor>>* inputs) {
   // Find path to variables to be restored in export directory.
   const string variables_directory =
       io::JoinPath(export_dir, kSavedModelVariablesDirectory);
@@ -209,7 +208,7 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
     LOG(INFO) << "The specified SavedModel has no variables; no checkpoints "
                  "were restored. File does not exist: "
               << variables_index_path;
-    return Status::OK();
+    return false;
   }
   const string variables_path =
       io::JoinPath(variables_directory, kSavedModelVariablesFilename);
@@ -218,16 +217,393 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
   Tensor variables_path_tensor(DT_STRING, TensorShape({}));
   variables_path_tensor.scalar<tstring>()() = variables_path;
 
-  std::vector<std::pair<string, Tensor>> inputs = {
-      {string(variable_filename_const_op_name), variables_path_tensor}};
+  *inputs = {{string(variable_filename_const_op_name), variables_path_tensor}};
 
-  AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
+  AddAssetsTensorsToInputs(export_dir, asset_file_defs, inputs);
+  return true;
+}
 
+Status RunRestore(const RunOptions& run_options, const string& export_dir,
+                  const StringPiece restore_op_name,
+                  const StringPiece variable_filename_const_op_name,
+                  const std::vector<AssetFileDef>& asset_file_defs,
+                  Session* session) {
+  LOG(INFO) << "Restoring SavedModel bundle.";
+  std::vector<std::pair<string, Tensor>> inputs;
+  if (!GetRestoreInputs(export_dir, variable_filename_const_op_name,
+                        asset_file_defs, &inputs)) {
+    return Status::OK();
+  }
   RunMetadata run_metadata;
   return RunOnce(run_options, inputs, {}, {string(restore_op_name)},
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Returns in "tensor" the value of the Const node that produces "input".
+bool GetConstTensor(const std::unordered_map<string, const NodeDef*>& nodes,
+                    const string& input, Tensor* tensor) {
+  const TensorId id = ParseTensorName(input);
+  if (id.index() != 0) return false;
+  const auto node = nodes.find(string(id.node()));
+  if (node == nodes.end() || node->second->op() != "Const") return false;
+  const auto value = node->second->attr().find("value");
+  return value != node->second->attr().end() &&
+         tensor->FromProto(value->second.tensor());
+}
+
+NodeDef MakeStringConst(const string& name, const string& device,
+                        const tstring& value) {
+  NodeDef node;
+  node.set_name(name);
+  node.set_op("Const");
+  node.set_device(device);
+  (*node.mutable_attr())["dtype"].set_type(DT_STRING);
+  Tensor tensor(DT_STRING, TensorShape({1}));
+  tensor.flat<tstring>()(0) = value;
+  tensor.AsProtoField((*node.mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+// Splits the RestoreV2 nodes of "graph_def" that restore several tensors into
+// one RestoreV2 node per tensor, so that restoring some variables does not
+// read the others as well.  Nodes whose tensor names are not constants, or
+// that are control inputs of other nodes, are left alone.
+void SplitRestoreV2Nodes(GraphDef* graph_def) {
+  std::unordered_map<string, const NodeDef*> nodes;
+  std::unordered_set<string> control_inputs;
+  for (const NodeDef& node : graph_def->node()) {
+    nodes[node.name()] = &node;
+    for (const string& input : node.input()) {
+      if (absl::StartsWith(input, "^")) control_inputs.insert(input.substr(1));
+    }
+  }
+
+  std::vector<NodeDef> new_nodes;
+  std::unordered_set<string> split_nodes;
+  // Maps the outputs of the split nodes to the nodes that replace them.
+  std::unordered_map<string, string> new_outputs;
+  for (const NodeDef& node : graph_def->node()) {
+    if (node.op() != "RestoreV2" || node.input_size() != 3 ||
+        control_inputs.count(node.name()) > 0) {
+      continue;
+    }
+    Tensor tensor_names, shape_and_slices;
+    const auto dtypes = node.attr().find("dtypes");
+    if (!GetConstTensor(nodes, node.input(1), &tensor_names) ||
+        !GetConstTensor(nodes, node.input(2), &shape_and_slices) ||
+        tensor_names.dtype() != DT_STRING ||
+        shape_and_slices.dtype() != DT_STRING ||
+        tensor_names.NumElements() <= 1 ||
+        tensor_names.NumElements() != shape_and_slices.NumElements() ||
+        dtypes == node.attr().end() ||
+        dtypes->second.list().type_size() != tensor_names.NumElements()) {
+      continue;
+    }
+    for (int i = 0; i < tensor_names.NumElements(); ++i) {
+      const string part = strings::StrCat(node.name(), "/part_", i);
+      new_nodes.push_back(
+          MakeStringConst(strings::StrCat(part, "/tensor_names"),
+                          node.device(), tensor_names.flat<tstring>()(i)));
+      new_nodes.push_back(
+          MakeStringConst(strings::StrCat(part, "/shape_and_slices"),
+                          node.device(), shape_and_slices.flat<tstring>()(i)));
+      NodeDef restore = node;
+      restore.set_name(part);
+      restore.set_input(1, strings::StrCat(part, "/tensor_names"));
+      restore.set_input(2, strings::StrCat(part, "/shape_and_slices"));
+      auto* restore_dtypes = (*restore.mutable_attr())["dtypes"].mutable_list();
+      restore_dtypes->clear_type();
+      restore_dtypes->add_type(dtypes->second.list().type(i));
+      new_nodes.push_back(std::move(restore));
+      new_outputs[strings::StrCat(node.name(), ":", i)] = part;
+      if (i == 0) new_outputs[node.name()] = part;
+    }
+    split_nodes.insert(node.name());
+  }
+  if (split_nodes.empty()) return;
+
+  auto* graph_nodes = graph_def->mutable_node();
+  graph_nodes->erase(
+      std::remove_if(graph_nodes->begin(), graph_nodes->end(),
+                     [&split_nodes](const NodeDef& node) {
+                       return split_nodes.count(node.name()) > 0;
+                     }),
+      graph_nodes->end());
+  for (NodeDef& node : *graph_nodes) {
+    for (string& input : *node.mutable_input()) {
+      const auto new_output = new_outputs.find(input);
+      if (new_output != new_outputs.end()) input = new_output->second;
+    }
+  }
+  for (NodeDef& node : new_nodes) *graph_def->add_node() = std::move(node);
+}
+
+// Maps each variable node restored by "restore_op_name" to the assignments
+// that restore it.  Returns false if the restore op runs anything else, such
+// as the restore of a lookup table, which then cannot be deferred.
+bool GetVariableRestores(
+    const GraphDef& graph_def, const string& restore_op_name,
+    std::unordered_map<string, std::vector<string>>* restores) {
+  std::unordered_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) nodes[node.name()] = &node;
+  std::vector<string> stack = {restore_op_name};
+  std::unordered_set<string> visited;
+  while (!stack.empty()) {
+    const string name = stack.back();
+    stack.pop_back();
+    if (!visited.insert(name).second) continue;
+    const auto node = nodes.find(name);
+    if (node == nodes.end()) return false;
+    const NodeDef& node_def = *node->second;
+    if (node_def.op() == "NoOp") {
+      for (const string& input : node_def.input()) {
+        stack.emplace_back(ParseTensorName(input).node());
+      }
+    } else if ((node_def.op() == "Assign" ||
+                node_def.op() == "AssignVariableOp") &&
+               node_def.input_size() >= 2) {
+      (*restores)[string(ParseTensorName(node_def.input(0)).node())]
+          .push_back(node_def.name());
+    } else {
+      return false;
+    }
+  }
+  return !restores->empty();
+}
+
+// Session wrapper that restores each variable the first time a step that
+// reads it is run or made callable, rather than when the SavedModel is loaded.
+// A step is assumed to read every variable that its fetches and targets
+// depend on.
+class LazyRestoreSession : public Session {
+ public:
+  LazyRestoreSession(std::unique_ptr<Session> wrapped,
+                     const GraphDef& graph_def,
+                     std::unordered_map<string, std::vector<string>> restores,
+                     const RunOptions& run_options,
+                     std::vector<std::pair<string, Tensor>> restore_inputs)
+      : wrapped_(std::move(wrapped)),
+        run_options_(run_options),
+        restore_inputs_(std::move(restore_inputs)),
+        pending_restores_(std::move(restores)) {
+    for (const NodeDef& node : graph_def.node()) {
+      std::vector<string>& inputs = node_inputs_[node.name()];
+      for (const string& input : node.input()) {
+        inputs.emplace_back(ParseTensorName(input).node());
+      }
+    }
+  }
+
+  Status Create(const GraphDef& graph) override {
+    return wrapped_->Create(graph);
+  }
+  Status Create(GraphDef&& graph) override {
+    return wrapped_->Create(std::move(graph));
+  }
+  Status Create(const RunOptions& run_options, const GraphDef& graph) override {
+    return wrapped_->Create(run_options, graph);
+  }
+  Status Create(const RunOptions& run_options, GraphDef&& graph) override {
+    return wrapped_->Create(run_options, std::move(graph));
+  }
+
+  // The nodes added by Extend() are not tracked, so all variables are
+  // restored first.
+  Status Extend(const GraphDef& graph) override {
+    TF_RETURN_IF_ERROR(RestoreAll());
+    return wrapped_->Extend(graph);
+  }
+  Status Extend(GraphDef&& graph) override {
+    TF_RETURN_IF_ERROR(RestoreAll());
+    return wrapped_->Extend(std::move(graph));
+  }
+  Status Extend(const RunOptions& run_options, const GraphDef& graph) override {
+    TF_RETURN_IF_ERROR(RestoreAll());
+    return wrapped_->Extend(run_options, graph);
+  }
+  Status Extend(const RunOptions& run_options, GraphDef&& graph) override {
+    TF_RETURN_IF_ERROR(RestoreAll());
+    return wrapped_->Extend(run_options, std::move(graph));
+  }
+
+  Status Run(const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs) override {
+    TF_RETURN_IF_ERROR(RestoreFor(output_tensor_names, target_node_names));
+    return wrapped_->Run(inputs, output_tensor_names, target_node_names,
+                         outputs);
+  }
+
+  Status Run(const RunOptions& run_options,
+             const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs, RunMetadata* run_metadata) override {
+    TF_RETURN_IF_ERROR(RestoreFor(output_tensor_names, target_node_names));
+    return wrapped_->Run(run_options, inputs, output_tensor_names,
+                         target_node_names, outputs, run_metadata);
+  }
+
+  Status Run(const RunOptions& run_options,
+             const std::vector<std::pair<string, Tensor>>& inputs,
+             const std::vector<string>& output_tensor_names,
+             const std::vector<string>& target_node_names,
+             std::vector<Tensor>* outputs, RunMetadata* run_metadata,
+             const thread::ThreadPoolOptions& threadpool_options) override {
+    TF_RETURN_IF_ERROR(RestoreFor(output_tensor_names, target_node_names));
+    return wrapped_->Run(run_options, inputs, output_tensor_names,
+                         target_node_names, outputs, run_metadata,
+                         threadpool_options);
+  }
+
+  Status PRunSetup(const std::vector<string>& input_names,
+                   const std::vector<string>& output_names,
+                   const std::vector<string>& target_nodes,
+                   string* handle) override {
+    TF_RETURN_IF_ERROR(RestoreFor(output_names, target_nodes));
+    return wrapped_->PRunSetup(input_names, output_names, target_nodes,
+                               handle);
+  }
+
+  Status PRun(const string& handle,
+              const std::vector<std::pair<string, Tensor>>& inputs,
+              const std::vector<string>& output_names,
+              std::vector<Tensor>* outputs) override {
+    return wrapped_->PRun(handle, inputs, output_names, outputs);
+  }
+
+  Status ListDevices(std::vector<DeviceAttributes>* response) override {
+    return wrapped_->ListDevices(response);
+  }
+
+  Status Close() override { return wrapped_->Close(); }
+  Status Close(const RunOptions& run_options) override {
+    return wrapped_->Close(run_options);
+  }
+
+  Status LocalDeviceManager(const DeviceMgr** output) override {
+    return wrapped_->LocalDeviceManager(output);
+  }
+
+  Status MakeCallable(const CallableOptions& callable_options,
+                      CallableHandle* out_handle) override {
+    TF_RETURN_IF_ERROR(
+        RestoreFor({callable_options.fetch().begin(),
+                    callable_options.fetch().end()},
+                   {callable_options.target().begin(),
+                    callable_options.target().end()}));
+    return wrapped_->MakeCallable(callable_options, out_handle);
+  }
+
+  Status RunCallable(CallableHandle handle,
+                     const std::vector<Tensor>& feed_tensors,
+                     std::vector<Tensor>* fetch_tensors,
+                     RunMetadata* run_metadata) override {
+    return wrapped_->RunCallable(handle, feed_tensors, fetch_tensors,
+                                 run_metadata);
+  }
+
+  Status RunCallable(
+      CallableHandle handle, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata,
+      const thread::ThreadPoolOptions& threadpool_options) override {
+    return wrapped_->RunCallable(handle, feed_tensors, fetch_tensors,
+                                 run_metadata, threadpool_options);
+  }
+
+  Status ReleaseCallable(CallableHandle handle) override {
+    return wrapped_->ReleaseCallable(handle);
+  }
+
+  // Callables cannot be made after Finalize(), so all variables are restored
+  // first.
+  Status Finalize() override {
+    TF_RETURN_IF_ERROR(RestoreAll());
+    return wrapped_->Finalize();
+  }
+
+ private:
+  // Restores the variables that "fetches" and "targets" depend on.
+  Status RestoreFor(const std::vector<string>& fetches,
+                    const std::vector<string>& targets) {
+    mutex_lock l(mu_);
+    if (pending_restores_.empty()) return Status::OK();
+    const string step = strings::StrCat(absl::StrJoin(fetches, ","), ";",
+                                        absl::StrJoin(targets, ","));
+    if (restored_steps_.count(step) > 0) return Status::OK();
+
+    std::vector<string> variables;
+    std::vector<string> stack;
+    for (const string& name : fetches) {
+      stack.emplace_back(ParseTensorName(name).node());
+    }
+    for (const string& name : targets) {
+      stack.emplace_back(ParseTensorName(name).node());
+    }
+    std::unordered_set<string> visited;
+    while (!stack.empty()) {
+      const string name = stack.back();
+      stack.pop_back();
+      if (!visited.insert(name).second) continue;
+      if (pending_restores_.count(name) > 0) variables.push_back(name);
+      const auto inputs = node_inputs_.find(name);
+      if (inputs == node_inputs_.end()) continue;
+      stack.insert(stack.end(), inputs->second.begin(), inputs->second.end());
+    }
+    TF_RETURN_IF_ERROR(Restore(variables));
+    restored_steps_.insert(step);
+    return Status::OK();
+  }
+
+  Status RestoreAll() {
+    mutex_lock l(mu_);
+    std::vector<string> variables;
+    for (const auto& restore : pending_restores_) {
+      variables.push_back(restore.first);
+    }
+    return Restore(variables);
+  }
+
+  Status Restore(const std::vector<string>& variables)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (variables.empty()) return Status::OK();
+    std::vector<string> targets;
+    for (const string& variable : variables) {
+      const std::vector<string>& assigns = pending_restores_.at(variable);
+      targets.insert(targets.end(), assigns.begin(), assigns.end());
+    }
+    VLOG(1) << "Restoring " << variables.size() << " SavedModel variables.";
+    RunMetadata run_metadata;
+    TF_RETURN_IF_ERROR(RunOnce(run_options_, restore_inputs_, {}, targets,
+                               nullptr /* outputs */, &run_metadata,
+                               wrapped_.get()));
+    for (const string& variable : variables) {
+      pending_restores_.erase(variable);
+    }
+    if (pending_restores_.empty()) {
+      // Nothing is left to restore, so the graph is no longer needed.
+      node_inputs_.clear();
+      restored_steps_.clear();
+    }
+    return Status::OK();
+  }
+
+  const std::unique_ptr<Session> wrapped_;
+  const RunOptions run_options_;
+  const std::vector<std::pair<string, Tensor>> restore_inputs_;
+
+  mutex mu_;
+  // The assignments that restore each variable not restored yet.
+  std::unordered_map<string, std::vector<string>> pending_restores_
+      TF_GUARDED_BY(mu_);
+  // The names of the input nodes of each node of the graph.
+  std::unordered_map<string, std::vector<string>> node_inputs_
+      TF_GUARDED_BY(mu_);
+  // The fetches and targets of the steps whose variables were restored.
+  std::unordered_set<string> restored_steps_ TF_GUARDED_BY(mu_);
+};
+
 Status ReadSavedModelDebugInfoIfPresent(
     const string& export_dir,
     std::unique_ptr<GraphDebugInfo>* debug_info_proto) {
@@ -246,27 +622,160 @@ Status ReadSavedModelDebugInfoIfPresent(
   return Status::OK();
 }
 
+// Reads the warm-start graph at "path", checking that it was derived from the
+// MetaGraphDef "tags" of the current version of the SavedModel.
+Status ReadWarmStartGraph(const string& export_dir, const string& path,
+                          const std::unordered_set<string>& tags,
+                          WarmStartGraph* warm_start_graph) {
+  TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), path, warm_start_graph));
+  const std::unordered_set<string> graph_tags(warm_start_graph->tags().begin(),
+                                              warm_start_graph->tags().end());
+  if (graph_tags != tags) {
+    return errors::FailedPrecondition(
+        "it was optimized for the MetaGraphDef with tags { ",
+        absl::StrJoin(warm_start_graph->tags(), " "), " }");
+  }
+  uint64 fingerprint;
+  TF_RETURN_IF_ERROR(internal::GetSavedModelFingerprint(export_dir,
+                                                        &fingerprint));
+  if (fingerprint != warm_start_graph->saved_model_fingerprint()) {
+    return errors::FailedPrecondition(
+        "the SavedModel changed since it was optimized");
+  }
+  return Status::OK();
+}
+
+// Checks that "session" has the devices the warm-start graph was placed on.
+Status CheckWarmStartDevices(Session* session,
+                             const WarmStartGraph& warm_start_graph) {
+  std::vector<DeviceAttributes> devices;
+  TF_RETURN_IF_ERROR(session->ListDevices(&devices));
+  std::vector<string> device_names;
+  for (const DeviceAttributes& device : devices) {
+    device_names.push_back(device.name());
+  }
+  std::sort(device_names.begin(), device_names.end());
+  if (!std::equal(device_names.begin(), device_names.end(),
+                  warm_start_graph.devices().begin(),
+                  warm_start_graph.devices().end())) {
+    return errors::FailedPrecondition(
+        "it was placed on devices { ",
+        absl::StrJoin(warm_start_graph.devices(), " "),
+        " } but the session has devices { ", absl::StrJoin(device_names, " "),
+        " }");
+  }
+  return Status::OK();
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
                               SavedModelBundle* const bundle) {
   const uint64 read_start_microseconds = Env::Default()->NowMicros();
-  TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
-                                                    &bundle->meta_graph_def));
+  // Setting TF_SAVED_MODEL_LAZY_RESTORE defers the restore of each variable
+  // until the first step that reads it, see LazyRestoreSession.
+  bool lazy_restore;
   TF_RETURN_IF_ERROR(
-      ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
-      bundle->meta_graph_def, session_options, &bundle->session));
+      ReadBoolFromEnvVar("TF_SAVED_MODEL_LAZY_RESTORE", false, &lazy_restore));
+
+  // A warm-start graph is already optimized, so the session does not run
+  // Grappler again if it is used.
+  const string warm_start_graph_path =
+      io::JoinPath(export_dir, kSavedModelWarmStartGraphFilename);
+  const bool has_warm_start_graph =
+      Env::Default()->FileExists(warm_start_graph_path).ok();
+  SessionOptions warm_start_session_options(session_options);
+  warm_start_session_options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+
+  // Reading the debug info and the warm-start graph, and creating the session
+  // (which initializes its devices) do not depend on the MetaGraphDef, so they
+  // overlap with reading it.
+  Status meta_graph_status, debug_info_status, new_session_status;
+  Status warm_start_status;
+  WarmStartGraph warm_start_graph;
+  Session* new_session = nullptr;
+  {
+    std::unique_ptr<Thread> debug_info_thread(Env::Default()->StartThread(
+        ThreadOptions(), "saved_model_read_debug_info", [&]() {
+          debug_info_status =
+              ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info);
+        }));
+    std::unique_ptr<Thread> new_session_thread(Env::Default()->StartThread(
+        ThreadOptions(), "saved_model_new_session", [&]() {
+          new_session_status = NewSession(has_warm_start_graph
+                                              ? warm_start_session_options
+                                              : session_options,
+                                          &new_session);
+        }));
+    std::unique_ptr<Thread> warm_start_thread;
+    if (has_warm_start_graph) {
+      warm_start_thread.reset(Env::Default()->StartThread(
+          ThreadOptions(), "saved_model_read_warm_start_graph", [&]() {
+            warm_start_status = ReadWarmStartGraph(
+                export_dir, warm_start_graph_path, tags, &warm_start_graph);
+          }));
+    }
+    meta_graph_status = ReadMetaGraphDefFromSavedModel(export_dir, tags,
+                                                       &bundle->meta_graph_def);
+  }
+  bundle->session.reset(new_session);
+  TF_RETURN_IF_ERROR(meta_graph_status);
+  TF_RETURN_IF_ERROR(debug_info_status);
+  TF_RETURN_IF_ERROR(new_session_status);
+  if (has_warm_start_graph) {
+    if (warm_start_status.ok()) {
+      warm_start_status =
+          CheckWarmStartDevices(bundle->session.get(), warm_start_graph);
+    }
+    if (warm_start_status.ok()) {
+      LOG(INFO) << "Using the warm-start graph " << warm_start_graph_path;
+      bundle->meta_graph_def.mutable_graph_def()->Swap(
+          warm_start_graph.mutable_graph_def());
+    } else {
+      LOG(INFO) << "Not using the warm-start graph " << warm_start_graph_path
+                << ": " << warm_start_status;
+      new_session = nullptr;
+      bundle->session.reset();
+      TF_RETURN_IF_ERROR(NewSession(session_options, &new_session));
+      bundle->session.reset(new_session);
+    }
+  }
+
+  GraphDef* graph_def = bundle->meta_graph_def.mutable_graph_def();
+  TF_RETURN_IF_ERROR(ValidateSavedTensors(*graph_def));
+  if (lazy_restore) SplitRestoreV2Nodes(graph_def);
+  TF_RETURN_IF_ERROR(bundle->session->Create(*graph_def));
 
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       internal::GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
-  TF_RETURN_IF_ERROR(
-      RunRestore(run_options, export_dir,
-                 bundle->meta_graph_def.saver_def().restore_op_name(),
-                 bundle->meta_graph_def.saver_def().filename_tensor_name(),
-                 asset_file_defs, bundle->session.get()));
+  const SaverDef& saver_def = bundle->meta_graph_def.saver_def();
+  std::unordered_map<string, std::vector<string>> variable_restores;
+  if (lazy_restore && GetVariableRestores(*graph_def,
+                                          saver_def.restore_op_name(),
+                                          &variable_restores)) {
+    std::vector<std::pair<string, Tensor>> restore_inputs;
+    if (GetRestoreInputs(export_dir, saver_def.filename_tensor_name(),
+                         asset_file_defs, &restore_inputs)) {
+      LOG(INFO) << "Deferring the restore of " << variable_restores.size()
+                << " SavedModel variables until they are used.";
+      bundle->session = absl::make_unique<LazyRestoreSession>(
+          std::move(bundle->session), *graph_def, std::move(variable_restores),
+          run_options, std::move(restore_inputs));
+    }
+  } else {
+    if (lazy_restore) {
+      LOG(INFO) << "The restore op of the SavedModel does not only restore "
+                   "variables; restoring them all now.";
+    }
+    TF_RETURN_IF_ERROR(RunRestore(run_options, export_dir,
+                                  saver_def.restore_op_name(),
+                                  saver_def.filename_tensor_name(),
+                                  asset_file_defs, bundle->session.get()));
+  }
   // Record walltime spent in restoring graph from disk, but postpone metric
   // increments until graph init finishes.
   const uint64 restore_graph_walltime =
@@ -18,8 +18,11 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
 
 namespace tensorflow {
@@ -86,5 +89,17 @@ Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
   return Status::OK();
 }
 
+Status GetSavedModelFingerprint(const string& export_dir, uint64* fingerprint) {
+  string saved_model_path = io::JoinPath(export_dir, kSavedModelFilenamePb);
+  if (!Env::Default()->FileExists(saved_model_path).ok()) {
+    saved_model_path = io::JoinPath(export_dir, kSavedModelFilenamePbTxt);
+  }
+  string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), saved_model_path, &contents));
+  *fingerprint = Fingerprint64(contents);
+  return Status::OK();
+}
+
 }  // namespace internal
 }  // namespace tensorflow
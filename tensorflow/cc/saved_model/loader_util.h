@@ -33,6 +33,11 @@ Status GetInitOp(const string& export_dir, const MetaGraphDef& meta_graph_def,
 Status GetAssetFileDefs(const MetaGraphDef& meta_graph_def,
                         std::vector<AssetFileDef>* asset_file_defs);
 
+// Returns the fingerprint of the SavedModel proto file in export_dir, which
+// identifies the version of the SavedModel that graphs derived from it were
+// derived from.
+Status GetSavedModelFingerprint(const string& export_dir, uint64* fingerprint);
+
 }  // namespace internal
 }  // namespace tensorflow
 
@@ -131,6 +131,28 @@ TEST_F(LoaderTest, TagMatch) {
   CheckSavedModelBundle(export_dir, bundle);
 }
 
+TEST_F(LoaderTest, LazyRestore) {
+  setenv("TF_SAVED_MODEL_LAZY_RESTORE", "1", 1 /* replace */);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  const Status status = LoadSavedModel(session_options, run_options,
+                                       export_dir, {kSavedModelTagServe},
+                                       &bundle);
+  unsetenv("TF_SAVED_MODEL_LAZY_RESTORE");
+  TF_ASSERT_OK(status);
+  // Each variable is restored by its own RestoreV2 node.
+  for (const NodeDef& node : bundle.meta_graph_def.graph_def().node()) {
+    if (node.op() == "RestoreV2") {
+      EXPECT_EQ(1, node.attr().at("dtypes").list().type_size()) << node.name();
+    }
+  }
+  CheckSavedModelBundle(export_dir, bundle);
+}
+
 TEST_F(LoaderTest, NoTagMatch) {
   SavedModelBundle bundle;
   RunOptions run_options;
@@ -0,0 +1,172 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warm_start.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/loader_util.h"
+#include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/placer.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/grappler_item_builder.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// Optimizes the graph of "meta_graph_def" for "devices" with Grappler.
+Status OptimizeGraph(const SessionOptions& session_options,
+                     const string& export_dir,
+                     const MetaGraphDef& meta_graph_def,
+                     const DeviceSet& device_set, Device* cpu_device,
+                     GraphDef* optimized_graph) {
+  grappler::ItemConfig item_config;
+  item_config.ignore_user_placement = false;
+  item_config.ignore_colocation = false;
+  std::unique_ptr<grappler::GrapplerItem> item =
+      grappler::GrapplerItemFromMetaGraphDef("saved_model", meta_graph_def,
+                                             item_config);
+  if (item == nullptr) {
+    return errors::InvalidArgument(
+        "Failed to prepare the graph of the SavedModel at ", export_dir,
+        " for optimization");
+  }
+  // The loader also runs the initialization op and feeds the assets.
+  string init_op_name;
+  TF_RETURN_IF_ERROR(
+      internal::GetInitOp(export_dir, meta_graph_def, &init_op_name));
+  if (!init_op_name.empty()) item->keep_ops.push_back(init_op_name);
+  std::vector<AssetFileDef> asset_file_defs;
+  TF_RETURN_IF_ERROR(
+      internal::GetAssetFileDefs(meta_graph_def, &asset_file_defs));
+  for (const AssetFileDef& asset_file_def : asset_file_defs) {
+    item->keep_ops.push_back(asset_file_def.tensor_info().name());
+  }
+
+  ConfigProto config = session_options.config;
+  config.mutable_graph_options()->mutable_rewrite_options()->set_remapping(
+      RewriterConfig::OFF);
+  grappler::VirtualCluster cluster(&device_set);
+  TF_RETURN_IF_ERROR(cluster.Provision());
+  TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+      std::move(*item), config, cpu_device, &cluster, optimized_graph));
+
+  for (const NodeDef& node : optimized_graph->node()) {
+    if (absl::StartsWith(node.op(), "_")) {
+      return errors::FailedPrecondition(
+          "The optimized graph of the SavedModel at ", export_dir,
+          " has node ", node.name(), " of internal op ", node.op(),
+          ", which cannot be imported into a session");
+    }
+  }
+  return Status::OK();
+}
+
+// Sets the device of each node of "graph_def" to the one the placer assigns.
+Status PlaceGraph(const SessionOptions& session_options,
+                  const DeviceSet& device_set, GraphDef* graph_def) {
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(),
+                                     graph_def->library());
+  Graph graph(flib_def);
+  TF_RETURN_IF_ERROR(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), *graph_def, &graph));
+  Placer placer(&graph, "", &flib_def, &device_set,
+                /* default_local_device= */ nullptr,
+                session_options.config.allow_soft_placement(),
+                session_options.config.log_device_placement());
+  TF_RETURN_IF_ERROR(placer.Run());
+
+  std::unordered_map<string, string> devices;
+  for (const Node* node : graph.op_nodes()) {
+    devices[node->name()] = node->assigned_device_name();
+  }
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    const auto device = devices.find(node.name());
+    if (device != devices.end()) node.set_device(device->second);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+Status ExportWarmStartGraph(const SessionOptions& session_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags) {
+  MetaGraphDef meta_graph_def;
+  TF_RETURN_IF_ERROR(
+      ReadMetaGraphDefFromSavedModel(export_dir, tags, &meta_graph_def));
+
+  // The devices of a DirectSession created with "session_options".
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_RETURN_IF_ERROR(DeviceFactory::AddDevices(
+      session_options, "/job:localhost/replica:0/task:0", &devices));
+  DeviceSet device_set;
+  Device* cpu_device = nullptr;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+    if (cpu_device == nullptr && device->device_type() == DEVICE_CPU) {
+      cpu_device = device.get();
+    }
+  }
+  if (cpu_device == nullptr) {
+    return errors::FailedPrecondition("No CPU device to optimize graphs on");
+  }
+  device_set.set_client_device(cpu_device);
+
+  WarmStartGraph warm_start_graph;
+  TF_RETURN_IF_ERROR(OptimizeGraph(session_options, export_dir, meta_graph_def,
+                                   device_set, cpu_device,
+                                   warm_start_graph.mutable_graph_def()));
+  TF_RETURN_IF_ERROR(PlaceGraph(session_options, device_set,
+                                warm_start_graph.mutable_graph_def()));
+
+  std::vector<string> sorted_tags(tags.begin(), tags.end());
+  std::sort(sorted_tags.begin(), sorted_tags.end());
+  for (const string& tag : sorted_tags) warm_start_graph.add_tags(tag);
+  std::vector<string> device_names;
+  for (const auto& device : devices) device_names.push_back(device->name());
+  std::sort(device_names.begin(), device_names.end());
+  for (const string& name : device_names) warm_start_graph.add_devices(name);
+  uint64 fingerprint;
+  TF_RETURN_IF_ERROR(internal::GetSavedModelFingerprint(export_dir,
+                                                        &fingerprint));
+  warm_start_graph.set_saved_model_fingerprint(fingerprint);
+
+  return WriteBinaryProto(
+      Env::Default(),
+      io::JoinPath(export_dir, kSavedModelWarmStartGraphFilename),
+      warm_start_graph);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,46 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/// Functions to export optimized graphs that speed up loading SavedModels.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_WARM_START_H_
+#define TENSORFLOW_CC_SAVED_MODEL_WARM_START_H_
+
+#include <string>
+#include <unordered_set>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+
+/// Optimizes the graph of the MetaGraphDef identified by `tags` with Grappler,
+/// places it on the devices that `session_options` creates, and writes it to
+/// the warm-start graph file of the SavedModel in `export_dir`.
+///
+/// LoadSavedModel() creates its session from that graph, without optimizing
+/// or placing it again, when it loads the same MetaGraphDef of the same
+/// SavedModel on the same devices; otherwise it ignores the file.  Exporting
+/// the graph again after the SavedModel changes keeps the fast path.
+///
+/// The remapper is disabled, since the fused ops it creates are internal and
+/// cannot be imported into a session.
+Status ExportWarmStartGraph(const SessionOptions& session_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_WARM_START_H_
@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warm_start.h"
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTestDataSharded[] =
+    "cc/saved_model/testdata/half_plus_two/00000123";
+
+// Copies the files of the SavedModel in the test data to a writable
+// directory.
+string CopyTestSavedModel(const string& name) {
+  Env* env = Env::Default();
+  const string src = io::JoinPath(testing::TensorFlowSrcRoot(),
+                                  kTestDataSharded);
+  const string dst = io::JoinPath(testing::TmpDir(), name);
+  for (const string& dir :
+       {kSavedModelAssetsDirectory, kSavedModelVariablesDirectory}) {
+    TF_CHECK_OK(env->RecursivelyCreateDir(io::JoinPath(dst, dir)));
+    std::vector<string> children;
+    TF_CHECK_OK(env->GetChildren(io::JoinPath(src, dir), &children));
+    for (const string& child : children) {
+      TF_CHECK_OK(env->CopyFile(io::JoinPath(src, dir, child),
+                                io::JoinPath(dst, dir, child)));
+    }
+  }
+  TF_CHECK_OK(env->CopyFile(io::JoinPath(src, kSavedModelFilenamePb),
+                            io::JoinPath(dst, kSavedModelFilenamePb)));
+  return dst;
+}
+
+void CheckRegression(const SavedModelBundle& bundle) {
+  const auto& signature_def = bundle.GetSignatures().at("regress_x_to_y");
+  const string input_name = signature_def.inputs().at(kRegressInputs).name();
+  const string output_name =
+      signature_def.outputs().at(kRegressOutputs).name();
+
+  std::vector<tstring> serialized_examples;
+  for (float x : {0, 1, 2, 3}) {
+    Example example;
+    (*example.mutable_features()->mutable_feature())["x"]
+        .mutable_float_list()
+        ->add_value(x);
+    serialized_examples.push_back(example.SerializeAsString());
+  }
+  Tensor input = test::AsTensor<tstring>(serialized_examples, TensorShape({4}));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(bundle.session->Run({{input_name, input}}, {output_name}, {},
+                                   &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(
+      outputs[0], test::AsTensor<float>({2, 2.5, 3, 3.5}, TensorShape({4, 1})));
+}
+
+TEST(WarmStartTest, ExportAndLoad) {
+  const string export_dir = CopyTestSavedModel("warm_start");
+  SessionOptions session_options;
+  TF_ASSERT_OK(
+      ExportWarmStartGraph(session_options, export_dir, {kSavedModelTagServe}));
+
+  WarmStartGraph warm_start_graph;
+  TF_ASSERT_OK(ReadBinaryProto(
+      Env::Default(),
+      io::JoinPath(export_dir, kSavedModelWarmStartGraphFilename),
+      &warm_start_graph));
+  ASSERT_EQ(1, warm_start_graph.tags_size());
+  EXPECT_EQ(kSavedModelTagServe, warm_start_graph.tags(0));
+  for (const NodeDef& node : warm_start_graph.graph_def().node()) {
+    EXPECT_FALSE(node.device().empty()) << node.name();
+  }
+
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(session_options, RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  // The session was created from the warm-start graph, which is placed.
+  for (const NodeDef& node : bundle.meta_graph_def.graph_def().node()) {
+    EXPECT_FALSE(node.device().empty()) << node.name();
+  }
+  CheckRegression(bundle);
+}
+
+TEST(WarmStartTest, IgnoresStaleGraph) {
+  const string export_dir = CopyTestSavedModel("warm_start_stale");
+  SessionOptions session_options;
+  TF_ASSERT_OK(
+      ExportWarmStartGraph(session_options, export_dir, {kSavedModelTagServe}));
+
+  // Changing the SavedModel invalidates the warm-start graph.
+  SavedModel saved_model;
+  const string saved_model_path =
+      io::JoinPath(export_dir, kSavedModelFilenamePb);
+  TF_ASSERT_OK(ReadBinaryProto(Env::Default(), saved_model_path, &saved_model));
+  saved_model.mutable_meta_graphs(0)
+      ->mutable_meta_info_def()
+      ->set_stripped_default_attrs(true);
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), saved_model_path, saved_model));
+
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(session_options, RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  EXPECT_EQ(saved_model.meta_graphs(0).graph_def().node_size(),
+            bundle.meta_graph_def.graph_def().node_size());
+  CheckRegression(bundle);
+}
+
+}  // namespace
+}  // namespace tensorflow
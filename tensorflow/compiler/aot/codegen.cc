@@ -528,6 +528,15 @@ extern "C" void {{ENTRY}}(
 // o Concurrent calls to const methods are OK, if those calls are made while it
 //   is guaranteed that no thread may call a non-const method.
 //
+// To serve independent requests in parallel, create one instance per request
+// (instances share the code and constants in the object file) and run them
+// together, e.g. on an Eigen::ThreadPool:
+//
+//   std::vector<tensorflow::XlaCompiledCpuFunction*> batch = ...;
+//   // ...set args of each instance
+//   CHECK({{CLASS}}::RunBatch(batch.data(), batch.size(),
+//       [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); }));
+//
 // The logical function signature is:
 //   {{PROGRAM_SHAPE}}
 //
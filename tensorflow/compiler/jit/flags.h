@@ -97,6 +97,18 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If true, _XlaCompile compiles clusters that are not in the compilation
+  // cache in the background, and the clusters run in the TF executor until
+  // their compilation finishes.  Defaults to false.
+  bool tf_xla_async_compilation;
+
+  // Comma-separated, increasing sizes.  If non-empty, XLA clusters compiled by
+  // _XlaCompile and XlaLaunch on CPU and GPU round the leading dimension of
+  // their non-constant tensor arguments up to the smallest of these sizes
+  // that holds it, so that a bounded set of executables covers all sizes up to
+  // the largest one.  Defaults to empty.
+  string tf_xla_shape_buckets;
 };
 
 // Flags for the build_xla_ops pass.
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/compiler/jit/defs.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
 #include "tensorflow/compiler/jit/flags.h"
@@ -217,6 +219,23 @@ XlaLocalLaunchBase::XlaLocalLaunchBase(OpKernelConstruction* ctx,
       platform_info_(PlatformInfoFromContext(ctx)),
       has_ref_vars_(has_ref_vars) {}
 
+// Parses the --tf_xla_shape_buckets flag.
+static Status ParseShapeBuckets(const string& flag,
+                                std::vector<int64>* shape_buckets) {
+  for (absl::string_view bucket :
+       absl::StrSplit(flag, ',', absl::SkipEmpty())) {
+    int64 size;
+    if (!absl::SimpleAtoi(bucket, &size) || size <= 0 ||
+        (!shape_buckets->empty() && size <= shape_buckets->back())) {
+      return errors::InvalidArgument(
+          "--tf_xla_shape_buckets must be increasing positive sizes, got ",
+          flag);
+    }
+    shape_buckets->push_back(size);
+  }
+  return Status::OK();
+}
+
 static Status BuildCompilationCache(OpKernelContext* ctx,
                                     const XlaPlatformInfo& platform_info,
                                     XlaCompilationCache** cache) {
@@ -268,8 +287,12 @@ static Status BuildCompilationCache(OpKernelContext* ctx,
     return errors::InvalidArgument("No JIT device registered for ",
                                    platform_info.device_type().type());
   }
+  std::vector<int64> shape_buckets;
+  TF_RETURN_IF_ERROR(ParseShapeBuckets(
+      GetXlaOpsCommonFlags().tf_xla_shape_buckets, &shape_buckets));
   *cache = new XlaCompilationCache(
-      client.ValueOrDie(), DeviceType(registration->compilation_device_name));
+      client.ValueOrDie(), DeviceType(registration->compilation_device_name),
+      std::move(shape_buckets));
   return Status::OK();
 }
 
@@ -277,7 +300,8 @@ static Status CompileToLocalExecutable(
     OpKernelContext* ctx, const NameAttrList& function, bool has_ref_vars,
     const XlaPlatformInfo& platform_info,
     absl::Span<VariableInfo const> variable_infos,
-    absl::Span<const int> constants, bool lazy, xla::LocalClient** client,
+    absl::Span<const int> constants,
+    XlaCompilationCache::CompileMode compile_mode, xla::LocalClient** client,
     const XlaCompiler::CompilationResult** compilation_result,
     xla::LocalExecutable** executable) {
   // We store information about the JIT-compiled XLA computation
@@ -336,9 +360,7 @@ static Status CompileToLocalExecutable(
   std::vector<XlaCompiler::Argument> args;
   TF_RETURN_IF_ERROR(XlaComputationLaunchContext::BuildXlaCompilerArguments(
       constant_args, variable_infos, ctx, &args));
-  return cache->Compile(options, function, args, compile_options,
-                        lazy ? XlaCompilationCache::CompileMode::kLazy
-                             : XlaCompilationCache::CompileMode::kStrict,
+  return cache->Compile(options, function, args, compile_options, compile_mode,
                         compilation_result, executable);
 }
 
@@ -358,8 +380,8 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
     Status s = CompileToLocalExecutable(
         ctx, function_, /*has_ref_vars=*/has_ref_vars_, platform_info_,
-        variable_infos, constants_, /*lazy=*/false, &client,
-        &compilation_result, &executable);
+        variable_infos, constants_, XlaCompilationCache::CompileMode::kStrict,
+        &client, &compilation_result, &executable);
     OP_REQUIRES_OK(ctx, s);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
@@ -377,8 +399,9 @@ void XlaLocalLaunchBase::Compute(OpKernelContext* ctx) {
       client, allocator,
       /*allocate_xla_tensors=*/platform_info_.is_on_xla_device(),
       platform_info_.UseMultipleStreams());
-  launch_context.PopulateInputs(ctx, compilation_result, variables,
-                                /*missing_ctx_input_prefix=*/0);
+  OP_REQUIRES_OK(ctx, launch_context.PopulateInputs(
+                          ctx, compilation_result, variables,
+                          /*missing_ctx_input_prefix=*/0));
 
   // Execute the computation.
   VLOG(2) << "Executing computation.";
@@ -514,10 +537,16 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
     OP_REQUIRES_OK(
         ctx, GetVariableInfosFromCtxInputs(ctx, resources_, &variable_infos));
     OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(variable_infos)));
+    XlaCompilationCache::CompileMode compile_mode =
+        XlaCompilationCache::CompileMode::kStrict;
+    if (!must_compile_) {
+      compile_mode = GetXlaOpsCommonFlags().tf_xla_async_compilation
+                         ? XlaCompilationCache::CompileMode::kAsync
+                         : XlaCompilationCache::CompileMode::kLazy;
+    }
     Status status = CompileToLocalExecutable(
         ctx, function_, has_ref_vars_, platform_info_, variable_infos,
-        constants_,
-        /*lazy=*/!must_compile_, &client, &kernel, &executable);
+        constants_, compile_mode, &client, &kernel, &executable);
     OP_REQUIRES_OK(ctx, SnapshotResourceVariables(ctx, resources_,
                                                   variable_infos, &variables));
     if (must_compile_ || status.code() != error::UNIMPLEMENTED) {
@@ -602,9 +631,11 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
         },
         tensorflow::profiler::TraceMeLevel::kInfo);
 
-    launch_context.PopulateInputs(
-        ctx, closure.compilation_result(), closure.resource_var_snapshots(),
-        /*missing_ctx_input_prefix=*/closure.num_constant_args());
+    OP_REQUIRES_OK(
+        ctx, launch_context.PopulateInputs(
+                 ctx, closure.compilation_result(),
+                 closure.resource_var_snapshots(),
+                 /*missing_ctx_input_prefix=*/closure.num_constant_args()));
   }
 
   se::Stream* stream =
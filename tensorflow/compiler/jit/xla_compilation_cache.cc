@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <numeric>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
@@ -52,8 +54,11 @@ namespace tensorflow {
 constexpr int64 XlaCompilationCache::kDefaultCompilationThreshold;
 
 XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
-                                         DeviceType device_type)
-    : client_(client), device_type_(std::move(device_type)) {}
+                                         DeviceType device_type,
+                                         std::vector<int64> shape_buckets)
+    : client_(client),
+      device_type_(std::move(device_type)),
+      shape_buckets_(std::move(shape_buckets)) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
   // Ensure any use of our programs have completed by waiting for all stream
@@ -150,6 +155,36 @@ XlaCompilationCache::BuildSignature(
   return std::move(signature);
 }
 
+bool XlaCompilationCache::BucketArguments(
+    absl::Span<const int64> shape_buckets,
+    absl::Span<const XlaCompiler::Argument> args,
+    std::vector<XlaCompiler::Argument>* bucketed_args) {
+  bucketed_args->assign(args.begin(), args.end());
+  for (int i = 0; i < args.size(); ++i) {
+    if (args[i].kind != XlaCompiler::Argument::kParameter ||
+        !absl::holds_alternative<TensorShape>(args[i].shape)) {
+      continue;
+    }
+    const TensorShape& shape = absl::get<TensorShape>(args[i].shape);
+    if (shape.dims() == 0 || shape.dim_size(0) == 0) continue;
+    auto bucket = absl::c_lower_bound(shape_buckets, shape.dim_size(0));
+    if (bucket == shape_buckets.end()) continue;
+
+    XlaCompiler::Argument& arg = (*bucketed_args)[i];
+    absl::get<TensorShape>(arg.shape).set_dim(0, *bucket);
+    arg.dynamic_dim_to_arg_num_map[0] = bucketed_args->size();
+
+    XlaCompiler::Argument pad_arg;
+    pad_arg.kind = XlaCompiler::Argument::kParameter;
+    pad_arg.type = DT_INT32;
+    pad_arg.shape = TensorShape();
+    pad_arg.name = absl::StrCat(args[i].name, "_size");
+    pad_arg.is_pad_arg = true;
+    bucketed_args->push_back(std::move(pad_arg));
+  }
+  return bucketed_args->size() > args.size();
+}
+
 Status XlaCompilationCache::BuildExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& result,
@@ -185,15 +220,31 @@ Status XlaCompilationCache::Compile(
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   absl::optional<int64> compile_threshold;
-  if (compile_mode == CompileMode::kLazy) {
+  if (compile_mode == CompileMode::kLazy ||
+      compile_mode == CompileMode::kAsync) {
     compile_threshold = kDefaultCompilationThreshold;
   }
-  auto compile_fn = [&](XlaCompiler* compiler,
+  const bool async = compile_mode == CompileMode::kAsync;
+  // Captures by value, since asynchronous compilations outlive this call.
+  auto compile_fn = [compile_options, function](
+                        XlaCompiler* compiler,
+                        absl::Span<const XlaCompiler::Argument> args,
                         XlaCompiler::CompilationResult* result) {
     return compiler->CompileFunction(compile_options, function, args, result);
   };
+  std::vector<XlaCompiler::Argument> bucketed_args;
+  if (!shape_buckets_.empty() && !compile_options.use_tuple_arg &&
+      BucketArguments(shape_buckets_, args, &bucketed_args)) {
+    Status status =
+        CompileImpl(options, function, bucketed_args, compile_fn,
+                    compile_threshold, async, out_compilation_result,
+                    out_executable);
+    if (status.ok()) return status;
+    VLOG(1) << "Compiling " << function.name() << " for shape buckets failed, "
+            << "compiling it for the exact shapes instead: " << status;
+  }
   return CompileImpl(options, function, args, compile_fn,
-                     /*compile_threshold=*/compile_threshold,
+                     /*compile_threshold=*/compile_threshold, async,
                      out_compilation_result, out_executable);
 }
 
@@ -269,6 +320,7 @@ Status XlaCompilationCache::CompileSingleOp(
   // and causes false uniqueness between nodes.
   name.mutable_attr()->erase("_class");
   auto compile_op = [&](XlaCompiler* compiler,
+                        absl::Span<const XlaCompiler::Argument> args,
                         XlaCompiler::CompilationResult* result) {
     std::vector<DataType> result_dtypes(ctx->num_outputs());
     for (int i = 0; i < result_dtypes.size(); ++i) {
@@ -299,7 +351,7 @@ Status XlaCompilationCache::CompileSingleOp(
         options.shape_representation_fn, result);
   };
   return CompileImpl(options, name, args, compile_op,
-                     /*compile_threshold=*/absl::nullopt,
+                     /*compile_threshold=*/absl::nullopt, /*async=*/false,
                      out_compilation_result, out_executable);
 }
 
@@ -317,12 +369,95 @@ void LogOnceXlaCompiledFirstCluster() {
 }
 }  // namespace
 
+Status XlaCompilationCache::RecordCompilation(const string& function_name,
+                                              uint64 compile_time_us) {
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  mutex_lock lock(cluster_compile_stats_mu_);
+  auto it = cluster_compile_stats_.find(function_name);
+  it->second.compile_count++;
+  it->second.cumulative_compile_time_us += compile_time_us;
+  LogOnceXlaCompiledFirstCluster();
+  VLOG(1) << "compiled " << function_name << " " << it->second.compile_count
+          << " times, compile time: " << compile_time_us
+          << " us, cumulative: " << it->second.cumulative_compile_time_us
+          << " us ("
+          << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                           1.0e6)
+          << " / "
+          << tensorflow::strings::HumanReadableElapsedTime(
+                 it->second.cumulative_compile_time_us / 1.0e6)
+          << ")";
+
+  XlaJitCompilationActivity jit_compilation_activity;
+  jit_compilation_activity.set_cluster_name(function_name);
+  jit_compilation_activity.set_compile_count(it->second.compile_count);
+  jit_compilation_activity.set_compile_time_us(compile_time_us);
+  jit_compilation_activity.set_cumulative_compile_time_us(
+      it->second.cumulative_compile_time_us);
+
+  return BroadcastXlaActivity(std::move(jit_compilation_activity));
+}
+
+void XlaCompilationCache::CompileAsync(
+    const XlaCompiler::Options& options, const string& function_name,
+    absl::Span<const XlaCompiler::Argument> args, const CompileFn& compile_fn,
+    Entry* entry) {
+  // The function library and the allocator of the caller may be gone by the
+  // time the compilation runs, so it uses a copy of the former and the
+  // backend's allocator instead of the latter.
+  auto flib_def =
+      std::make_shared<FunctionLibraryDefinition>(*options.flib_def);
+  XlaCompiler::Options async_options = options;
+  async_options.flib_def = flib_def.get();
+  async_options.device_allocator = nullptr;
+  std::vector<XlaCompiler::Argument> async_args(args.begin(), args.end());
+
+  thread::ThreadPool* threads;
+  {
+    mutex_lock lock(async_compiler_mu_);
+    if (async_compiler_threads_ == nullptr) {
+      async_compiler_threads_ = absl::make_unique<thread::ThreadPool>(
+          tensorflow::Env::Default(), "xla_async_compiler",
+          kNumAsyncCompilerThreads);
+    }
+    threads = async_compiler_threads_.get();
+  }
+  VLOG(1) << "Starting the compilation of " << function_name
+          << " in the background";
+  threads->Schedule([this, flib_def, async_options, function_name, async_args,
+                     compile_fn, entry]() {
+    tensorflow::Env* env = tensorflow::Env::Default();
+    const uint64 compile_start_us = env->NowMicros();
+    XlaCompiler compiler(async_options);
+    XlaCompiler::CompilationResult result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status status = compile_fn(&compiler, async_args, &result);
+    if (status.ok()) {
+      status = BuildExecutable(async_options, result, &executable);
+      Status record_status = RecordCompilation(
+          function_name, env->NowMicros() - compile_start_us);
+      if (!record_status.ok()) {
+        LOG(WARNING) << "Failed to record the compilation of " << function_name
+                     << ": " << record_status;
+      }
+    }
+    VLOG(1) << "Finished the compilation of " << function_name
+            << " in the background: " << status;
+
+    // Later requests for the signature use the executable from now on.
+    mutex_lock lock(entry->mu);
+    entry->compilation_status = status;
+    entry->compilation_result = std::move(result);
+    entry->executable = std::move(executable);
+    entry->compile_state = Entry::CompileState::kCompiled;
+  });
+}
+
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
-    const std::function<Status(XlaCompiler* compiler,
-                               XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    const CompileFn& compile_fn, absl::optional<int64> compile_threshold,
+    bool async,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   DCHECK_NE(out_executable, nullptr);
@@ -388,12 +523,19 @@ Status XlaCompilationCache::CompileImpl(
   // cache eviction.
   mutex_lock entry_lock(entry->mu);
   int64 current_request_count = ++entry->request_count;
-  VLOG(2) << "Compilation cache entry hit: " << entry->compiled
+  VLOG(2) << "Compilation cache entry hit: "
+          << (entry->compile_state == Entry::CompileState::kCompiled)
           << " signature: " << signature.HumanString() << " with request count "
           << current_request_count << " and compile threshold "
           << compile_threshold.value_or(0);
-  if (!entry->compiled) {
-    XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
+  if (entry->compile_state == Entry::CompileState::kCompiling) {
+    VLOG(3) << "Not compiling cluster " << function.name()
+            << " because it is being compiled in the background.";
+    *out_compilation_result = nullptr;
+    *out_executable = nullptr;
+    return Status::OK();
+  }
+  if (entry->compile_state == Entry::CompileState::kUncompiled) {
     const bool should_compile = [&] {
       if (!compile_threshold.has_value()) {
         // Lazy compilation is disabled.
@@ -432,52 +574,33 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
+    if (async) {
+      entry->compile_state = Entry::CompileState::kCompiling;
+      CompileAsync(options, function.name(), args, compile_fn, entry);
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
+    }
+
+    XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
     tensorflow::Env* env = tensorflow::Env::Default();
     const uint64 compile_start_us = env->NowMicros();
     // Do the actual JIT compilation without holding the lock (it can take
     // a long time.)
 
     XlaCompiler compiler(options);
-    entry->compiled = true;
+    entry->compile_state = Entry::CompileState::kCompiled;
 
     entry->compilation_status =
-        compile_fn(&compiler, &entry->compilation_result);
+        compile_fn(&compiler, args, &entry->compilation_result);
     TF_RETURN_IF_ERROR(entry->compilation_status);
     CHECK_EQ(entry->executable.get(), nullptr);
     entry->compilation_status =
         BuildExecutable(options, entry->compilation_result, &entry->executable);
 
     const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
-    }
+    TF_RETURN_IF_ERROR(
+        RecordCompilation(function.name(), compile_end_us - compile_start_us));
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
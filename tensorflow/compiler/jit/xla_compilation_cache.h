@@ -38,18 +38,28 @@ namespace tensorflow {
 // which converts a Tensorflow graph into a compiled XLA compilation.
 //
 // Since XLA computations must have static shapes, the cache generates a new
-// XLA computation for each new set of input shapes.
+// XLA computation for each new set of input shapes.  If shape buckets are
+// given, Compile() instead rounds the leading dimension of tensor parameters
+// up to the smallest bucket that holds it and compiles the computation with
+// that dimension dynamic, so that one computation handles all the sizes of a
+// bucket; the launch context pads the inputs, and the outputs carry their
+// actual sizes.  Computations that XLA cannot compile with dynamic dimensions
+// are compiled for the exact shapes instead.
 //
 // Currently no cache eviction policy is implemented and the cache grows without
 // bound.
 class XlaCompilationCache : public ResourceBase {
  public:
-  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type);
+  // `shape_buckets`, if non-empty, are the increasing sizes that Compile()
+  // rounds leading dimensions up to.
+  XlaCompilationCache(xla::LocalClient* client, DeviceType device_type,
+                      std::vector<int64> shape_buckets = {});
   ~XlaCompilationCache() override;
 
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,7 +72,11 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then, on a cache miss that `kLazy` would compile, the
+  // compilation cache starts the compilation on a background thread and
+  // returns null, as it does for this signature until the compilation has
+  // finished.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -122,17 +136,43 @@ class XlaCompilationCache : public ResourceBase {
       const NameAttrList& function,
       absl::Span<const XlaCompiler::Argument> args);
 
+  // Sets `*bucketed_args` to `args` with the leading dimension of each tensor
+  // parameter rounded up to the smallest of `shape_buckets` that holds it and
+  // made dynamic, followed by the padding arguments that hold the actual
+  // sizes.  Returns false if no argument fits in a bucket.
+  static bool BucketArguments(
+      absl::Span<const int64> shape_buckets,
+      absl::Span<const XlaCompiler::Argument> args,
+      std::vector<XlaCompiler::Argument>* bucketed_args);
+
  private:
-  // Common implementation of Compile and CompileSingleOp.
+  using CompileFn = std::function<Status(
+      XlaCompiler* compiler, absl::Span<const XlaCompiler::Argument> args,
+      XlaCompiler::CompilationResult*)>;
+
+  struct Entry;
+
+  // Common implementation of Compile and CompileSingleOp.  If `async` is true,
+  // `compile_fn` must not refer to the state of the caller.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
-      absl::Span<const XlaCompiler::Argument> args,
-      const std::function<Status(XlaCompiler* compiler,
-                                 XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      absl::Span<const XlaCompiler::Argument> args, const CompileFn& compile_fn,
+      absl::optional<int64> compile_threshold, bool async,
       const XlaCompiler::CompilationResult** out_compilation_result,
       xla::LocalExecutable** out_executable);
 
+  // Compiles `entry` on a background thread, and then stores the results in
+  // it and marks it compiled.
+  void CompileAsync(const XlaCompiler::Options& options,
+                    const string& function_name,
+                    absl::Span<const XlaCompiler::Argument> args,
+                    const CompileFn& compile_fn, Entry* entry);
+
+  // Updates the compilation statistics of the cluster `function_name` after a
+  // compilation that took `compile_time_us`, and broadcasts them to the
+  // activity listeners.
+  Status RecordCompilation(const string& function_name, uint64 compile_time_us);
+
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
   Status BuildExecutable(const XlaCompiler::Options& options,
@@ -141,13 +181,21 @@ class XlaCompilationCache : public ResourceBase {
 
   xla::LocalClient* const client_;
   const DeviceType device_type_;
+  const std::vector<int64> shape_buckets_;
 
   // The value associated with a cache entry.
   struct Entry {
     mutex mu;
 
-    // Have we tried compiling this entry?
-    bool compiled = false;
+    enum class CompileState {
+      kUncompiled,
+      kCompiling,
+      kCompiled,
+    };
+
+    // Have we tried compiling this entry, or is it being compiled in the
+    // background?
+    CompileState compile_state TF_GUARDED_BY(mu) = CompileState::kUncompiled;
 
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
@@ -193,6 +241,16 @@ class XlaCompilationCache : public ResourceBase {
   // signature before  we attempt to compile it.
   static constexpr int64 kDefaultCompilationThreshold = 2;
 
+  // The number of threads that run asynchronous compilations.
+  static constexpr int kNumAsyncCompilerThreads = 2;
+
+  // Created on the first asynchronous compilation.  Declared after the entries
+  // and statistics that the compilations update, so that it waits for them to
+  // finish before those are destroyed.
+  mutex async_compiler_mu_;
+  std::unique_ptr<thread::ThreadPool> async_compiler_threads_
+      TF_GUARDED_BY(async_compiler_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(XlaCompilationCache);
 };
 
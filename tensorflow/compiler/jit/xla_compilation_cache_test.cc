@@ -16,6 +16,12 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
 #include "tensorflow/compiler/tf2xla/shape_util.h"
+#include "tensorflow/compiler/tf2xla/xla_op_registry.h"
+#include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -52,6 +58,90 @@ TEST(XlaCompilationCacheTest, SignatureEquality) {
   }
 }
 
+TEST(XlaCompilationCacheTest, BucketArguments) {
+  std::vector<XlaCompiler::Argument> args(3);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({5, 3});
+  args[1].kind = XlaCompiler::Argument::kConstant;
+  args[1].type = DT_INT32;
+  args[1].shape = TensorShape({2});
+  args[1].constant_value = Tensor(DT_INT32, {2});
+  args[2].kind = XlaCompiler::Argument::kParameter;
+  args[2].type = DT_FLOAT;
+  args[2].shape = TensorShape({100});
+  const std::vector<int64> shape_buckets = {4, 8, 16};
+
+  std::vector<XlaCompiler::Argument> bucketed;
+  ASSERT_TRUE(
+      XlaCompilationCache::BucketArguments(shape_buckets, args, &bucketed));
+  ASSERT_EQ(bucketed.size(), 4);
+  EXPECT_EQ(absl::get<TensorShape>(bucketed[0].shape), TensorShape({8, 3}));
+  EXPECT_EQ(bucketed[0].dynamic_dim_to_arg_num_map,
+            (std::map<int32, int32>{{0, 3}}));
+  // Constants and sizes over the largest bucket are not bucketed.
+  EXPECT_TRUE(bucketed[1] == args[1]);
+  EXPECT_TRUE(bucketed[2] == args[2]);
+  EXPECT_TRUE(bucketed[3].is_pad_arg);
+  EXPECT_EQ(bucketed[3].type, DT_INT32);
+  EXPECT_EQ(absl::get<TensorShape>(bucketed[3].shape), TensorShape());
+
+  // Sizes of the same bucket share a signature.
+  NameAttrList fn;
+  fn.set_name("afunction");
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s1,
+                          XlaCompilationCache::BuildSignature(fn, bucketed));
+  args[0].shape = TensorShape({8, 3});
+  ASSERT_TRUE(
+      XlaCompilationCache::BucketArguments(shape_buckets, args, &bucketed));
+  TF_ASSERT_OK_AND_ASSIGN(XlaCompilationCache::Signature s2,
+                          XlaCompilationCache::BuildSignature(fn, bucketed));
+  EXPECT_TRUE(s1 == s2);
+
+  args[0].shape = TensorShape({20, 3});
+  EXPECT_FALSE(
+      XlaCompilationCache::BucketArguments(shape_buckets, args, &bucketed));
+}
+
+TEST(XlaCompilationCacheTest, CompilesAsynchronously) {
+  FunctionDefLibrary fdef_lib;
+  *fdef_lib.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition flib_def(OpRegistry::Global(), fdef_lib);
+  xla::LocalClient* client = xla::ClientLibrary::LocalClientOrDie();
+  auto* cache = new XlaCompilationCache(client, DeviceType(DEVICE_CPU_XLA_JIT));
+  core::ScopedUnref cache_ref(cache);
+
+  XlaCompiler::Options options;
+  options.device_type = DeviceType(DEVICE_CPU_XLA_JIT);
+  options.client = client;
+  options.flib_def = &flib_def;
+  NameAttrList fn;
+  fn.set_name("XTimesTwo");
+  (*fn.mutable_attr())["T"].set_type(DT_FLOAT);
+  std::vector<XlaCompiler::Argument> args(1);
+  args[0].kind = XlaCompiler::Argument::kParameter;
+  args[0].type = DT_FLOAT;
+  args[0].shape = TensorShape({2});
+
+  // The first request starts the compilation and returns without a result,
+  // and so do later ones until it has finished.
+  const XlaCompiler::CompilationResult* result;
+  xla::LocalExecutable* executable;
+  TF_ASSERT_OK(cache->Compile(options, fn, args, XlaCompiler::CompileOptions(),
+                              XlaCompilationCache::CompileMode::kAsync, &result,
+                              &executable));
+  EXPECT_EQ(result, nullptr);
+  EXPECT_EQ(executable, nullptr);
+  for (int i = 0; i < 10000 && executable == nullptr; ++i) {
+    Env::Default()->SleepForMicroseconds(1000);
+    TF_ASSERT_OK(cache->Compile(
+        options, fn, args, XlaCompiler::CompileOptions(),
+        XlaCompilationCache::CompileMode::kAsync, &result, &executable));
+  }
+  EXPECT_NE(result, nullptr);
+  EXPECT_NE(executable, nullptr);
+}
+
 static void BM_BuildSignature(int iters, int n_args) {
   NameAttrList fn;
   fn.set_name("afunction");
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 
+#include <cstring>
 #include <memory>
 
 #include "absl/algorithm/container.h"
@@ -187,7 +188,20 @@ XlaComputationLaunchContext::XlaComputationLaunchContext(
   }
 }
 
-void XlaComputationLaunchContext::PopulateInputs(
+xla::StatusOr<se::DeviceMemoryBase>
+XlaComputationLaunchContext::AllocateArgBuffer(se::Stream* stream,
+                                               const xla::Shape& shape) {
+  const int device_ordinal = stream ? stream->parent()->device_ordinal()
+                                    : client_->default_device_ordinal();
+  TF_ASSIGN_OR_RETURN(
+      se::OwningDeviceMemory buffer,
+      xla_allocator_->Allocate(device_ordinal,
+                               xla::ShapeUtil::ByteSizeOf(shape)));
+  owned_arg_buffers_.push_back(std::move(buffer));
+  return *owned_arg_buffers_.back();
+}
+
+Status XlaComputationLaunchContext::PopulateInputs(
     OpKernelContext* ctx,
     const XlaCompiler::CompilationResult* compilation_result,
     const ResourceVarsSnapshot& variables, int missing_ctx_input_prefix) {
@@ -195,15 +209,47 @@ void XlaComputationLaunchContext::PopulateInputs(
   arg_ptrs_ =
       std::vector<ShapedBuffer*>(compilation_result->xla_input_shapes.size());
 
+  if (allocate_xla_tensors_ && !compilation_result->pad_args.empty()) {
+    return errors::Unimplemented(
+        "Shape buckets are not supported for XLA tensors");
+  }
+  se::Stream* stream =
+      ctx->op_device_context() ? ctx->op_device_context()->stream() : nullptr;
+  auto input_tensor = [&](int arg_num) {
+    return variables.count(arg_num)
+               ? &(variables.at(arg_num).value())
+               : &(ctx->input(arg_num - missing_ctx_input_prefix));
+  };
+
   xla::TransferManager* transfer_manager =
       client_->backend().transfer_manager();
   for (int i = 0; i < compilation_result->xla_input_shapes.size(); ++i) {
     int arg_num = compilation_result->input_mapping[i];
     CHECK_GE(arg_num, missing_ctx_input_prefix);
     const xla::Shape& shape = compilation_result->xla_input_shapes[i];
-    const Tensor* t = variables.count(arg_num)
-                          ? &(variables.at(arg_num).value())
-                          : &(ctx->input(arg_num - missing_ctx_input_prefix));
+
+    auto pad_arg = compilation_result->pad_args.find(arg_num);
+    if (pad_arg != compilation_result->pad_args.end()) {
+      // The argument holds the actual size of a bucketed dimension.
+      const Tensor* bucketed = input_tensor(pad_arg->second.first);
+      const int32 size =
+          static_cast<int32>(bucketed->dim_size(pad_arg->second.second));
+      TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase dmem,
+                          AllocateArgBuffer(stream, shape));
+      if (stream) {
+        stream->ThenMemset32(&dmem, size, sizeof(size));
+      } else {
+        *static_cast<int32*>(dmem.opaque()) = size;
+      }
+      arg_buffers_.emplace_back(
+          /*on_host_shape=*/shape, /*on_device_shape=*/shape,
+          client_->platform(), client_->default_device_ordinal());
+      arg_buffers_.back().set_buffer(dmem, /*index=*/{});
+      arg_ptrs_[i] = &arg_buffers_.back();
+      continue;
+    }
+
+    const Tensor* t = input_tensor(arg_num);
     CHECK(t);
 
     if (use_multiple_streams_) {
@@ -218,6 +264,28 @@ void XlaComputationLaunchContext::PopulateInputs(
     if (xla::Shape::Equal().MinorToMajorOnlyInLayout()(
             shape, transfer_manager->HostShapeToDeviceShape(shape))) {
       se::DeviceMemoryBase dmem = XlaTensor::DeviceMemoryFromTensor(*t);
+      if (shape.IsArray() && t->dims() > 0 &&
+          t->dim_size(0) != shape.dimensions(0)) {
+        // The leading dimension was rounded up to a shape bucket: copy the
+        // tensor to the start of a buffer of the compiled size, which is where
+        // a smaller leading dimension puts the elements, and zero the rest.
+        TF_RET_CHECK(t->dim_size(0) < shape.dimensions(0))
+            << t->shape().DebugString() << " vs. "
+            << xla::ShapeUtil::HumanString(shape);
+        TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase padded,
+                            AllocateArgBuffer(stream, shape));
+        const uint64 size = t->TotalBytes();
+        se::DeviceMemoryBase tail(static_cast<char*>(padded.opaque()) + size,
+                                  padded.size() - size);
+        if (stream) {
+          stream->ThenMemcpyD2D(&padded, dmem, size);
+          stream->ThenMemZero(&tail, tail.size());
+        } else {
+          std::memcpy(padded.opaque(), dmem.opaque(), size);
+          std::memset(tail.opaque(), 0, tail.size());
+        }
+        dmem = padded;
+      }
       arg_buffers_.emplace_back(
           /*on_host_shape=*/shape, /*on_device_shape=*/shape,
           client_->platform(), client_->default_device_ordinal());
@@ -229,6 +297,7 @@ void XlaComputationLaunchContext::PopulateInputs(
       arg_ptrs_[i] = const_cast<ShapedBuffer*>(&xla_tensor->shaped_buffer());
     }
   }
+  return Status::OK();
 }
 
 static bool MustAliasOutput(
@@ -142,10 +142,14 @@ class XlaComputationLaunchContext {
   // missing and adjusts input indices accordingly.  All elements in kernel's
   // input_mapping must be greater than or equal to `missing_ctx_input_prefix`
   // (in other words, no inputs actually required by the kernel can be missing).
-  void PopulateInputs(OpKernelContext* ctx,
-                      const XlaCompiler::CompilationResult* compilation_result,
-                      const ResourceVarsSnapshot& variables,
-                      int missing_ctx_input_prefix);
+  //
+  // Inputs whose leading dimension was rounded up to a shape bucket by the
+  // compilation cache are copied into buffers of the compiled size, and the
+  // padding arguments of the computation are set to their actual sizes.
+  Status PopulateInputs(
+      OpKernelContext* ctx,
+      const XlaCompiler::CompilationResult* compilation_result,
+      const ResourceVarsSnapshot& variables, int missing_ctx_input_prefix);
 
   // Given the XLA output in `output`, populate all outputs of `ctx`.  Also
   // writes out the resource variable updates.
@@ -169,12 +173,20 @@ class XlaComputationLaunchContext {
   const std::vector<xla::ShapedBuffer*>& arguments() const { return arg_ptrs_; }
 
  private:
+  // Allocates a buffer for the `shape` to pass to the computation, which
+  // lives as long as this context, on the device of `stream`, or on the host
+  // if `stream` is null.
+  xla::StatusOr<se::DeviceMemoryBase> AllocateArgBuffer(
+      se::Stream* stream, const xla::Shape& shape);
+
   xla::LocalClient* client_;
   se::DeviceMemoryAllocator* xla_allocator_;
   bool allocate_xla_tensors_;
   bool use_multiple_streams_;
   std::deque<xla::ShapedBuffer> arg_buffers_;
   std::vector<xla::ShapedBuffer*> arg_ptrs_;
+  // Padded inputs and the sizes held by padding arguments.
+  std::vector<se::OwningDeviceMemory> owned_arg_buffers_;
 };
 
 // A simple TensorBuffer implementation that allows us to create Tensors that
@@ -36,7 +36,8 @@ struct PassConfig {
         unfold_batch_matmul(true),
         legalize_tf_while(true),
         shape_inference(true),
-        runtime_verification(true) {}
+        runtime_verification(true),
+        fuse_elementwise_chains(false) {}
 
   // If `emit_builtin_tflite_ops` is true, TF Lite legalization passes will be
   // added, which produces TF Lite ops.
@@ -62,6 +63,9 @@ struct PassConfig {
   bool shape_inference;
   // Whether to do TFLite runtime verification.
   bool runtime_verification;
+  // Whether to fuse chains of float element-wise ops into FusedElementwise
+  // custom ops. The resulting model needs the op registered at runtime.
+  bool fuse_elementwise_chains;
 };
 
 }  // namespace TFL
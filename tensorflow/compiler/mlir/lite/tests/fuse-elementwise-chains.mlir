@@ -0,0 +1,57 @@
+// RUN: tf-opt -tfl-fuse-elementwise-chains %s | FileCheck %s
+
+// CHECK-LABEL: fuseChain
+func @fuseChain(%arg0: tensor<1x8xf32>, %arg1: tensor<1x8xf32>, %arg2: tensor<f32>) -> tensor<1x8xf32> {
+  %0 = "tfl.mul"(%arg0, %arg1) {fused_activation_function = "NONE"} : (tensor<1x8xf32>, tensor<1x8xf32>) -> tensor<1x8xf32>
+  %1 = "tfl.add"(%0, %arg2) {fused_activation_function = "NONE"} : (tensor<1x8xf32>, tensor<f32>) -> tensor<1x8xf32>
+  %2 = "tfl.logistic"(%1) : (tensor<1x8xf32>) -> tensor<1x8xf32>
+  %3 = "tfl.mul"(%2, %arg0) {fused_activation_function = "RELU"} : (tensor<1x8xf32>, tensor<1x8xf32>) -> tensor<1x8xf32>
+  return %3 : tensor<1x8xf32>
+
+  // CHECK: %[[FUSED:.*]] = "tfl.custom"(%arg0, %arg1, %arg2) {custom_code = "FusedElementwise", custom_option = opaque<"tfl", "0x{{[0-9A-F]*}}"> : tensor<{{[0-9]*}}xi8>} : (tensor<1x8xf32>, tensor<1x8xf32>, tensor<f32>) -> tensor<1x8xf32>
+  // CHECK-NOT: tfl.mul
+  // CHECK-NOT: tfl.add
+  // CHECK-NOT: tfl.logistic
+  // CHECK: return %[[FUSED]]
+}
+
+// CHECK-LABEL: fuseSwish
+func @fuseSwish(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = "tfl.logistic"(%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  %1 = "tfl.mul"(%arg0, %0) {fused_activation_function = "NONE"} : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %1 : tensor<4xf32>
+
+  // CHECK: %[[FUSED:.*]] = "tfl.custom"(%arg0) {custom_code = "FusedElementwise"
+  // CHECK: return %[[FUSED]]
+}
+
+// CHECK-LABEL: doNotFuseSingleOp
+func @doNotFuseSingleOp(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = "tfl.add"(%arg0, %arg1) {fused_activation_function = "NONE"} : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+
+  // CHECK: tfl.add
+  // CHECK-NOT: tfl.custom
+}
+
+// CHECK-LABEL: doNotFuseMultipleUses
+func @doNotFuseMultipleUses(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %0 = "tfl.add"(%arg0, %arg1) {fused_activation_function = "NONE"} : (tensor<4xf32>, tensor<4xf32>) -> tensor<4xf32>
+  %1 = "tfl.tanh"(%0) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0, %1 : tensor<4xf32>, tensor<4xf32>
+
+  // CHECK: tfl.add
+  // CHECK: tfl.tanh
+  // CHECK-NOT: tfl.custom
+}
+
+// CHECK-LABEL: doNotFuseBroadcast
+func @doNotFuseBroadcast(%arg0: tensor<2x4xf32>, %arg1: tensor<4xf32>) -> tensor<2x4xf32> {
+  %0 = "tfl.add"(%arg0, %arg1) {fused_activation_function = "NONE"} : (tensor<2x4xf32>, tensor<4xf32>) -> tensor<2x4xf32>
+  %1 = "tfl.relu"(%0) : (tensor<2x4xf32>) -> tensor<2x4xf32>
+  return %1 : tensor<2x4xf32>
+
+  // CHECK: tfl.add
+  // CHECK: tfl.relu
+  // CHECK-NOT: tfl.custom
+}
@@ -163,6 +163,11 @@ void AddTFToTFLConversionPasses(const mlir::TFL::PassConfig& pass_config,
     pass_manager->addPass(mlir::createSymbolDCEPass());
     pass_manager->addNestedPass<mlir::FuncOp>(mlir::createCanonicalizerPass());
     pass_manager->addNestedPass<mlir::FuncOp>(mlir::createCSEPass());
+    // Fused chains are opaque to the quantizer, so only fuse float models.
+    if (pass_config.fuse_elementwise_chains &&
+        !pass_config.quant_specs.RunPropagationAndRewriteQuantizationPasses()) {
+      pass_manager->addPass(mlir::TFL::CreateFuseElementwiseChainsPass());
+    }
     // This pass should be always at the end of the floating point model
     // conversion. Some TFL ops like unidirectional
     // sequence lstm will have stateful operands and some optimization passes
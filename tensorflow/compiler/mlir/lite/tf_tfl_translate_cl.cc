@@ -109,3 +109,10 @@ opt<bool> convert_tf_while_to_tfl_while(
     "convert_tf_while_to_tfl_while",
     llvm::cl::desc("Whether to legalize TF While to TFL While."),
     llvm::cl::init(true));
+
+// NOLINTNEXTLINE
+opt<bool> fuse_elementwise_chains(
+    "fuse_elementwise_chains",
+    llvm::cl::desc("Whether to fuse chains of float element-wise ops into "
+                   "FusedElementwise custom ops."),
+    llvm::cl::init(false));
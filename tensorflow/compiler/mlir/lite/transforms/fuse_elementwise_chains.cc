@@ -0,0 +1,249 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This transformation pass fuses chains of float element-wise TFL ops (e.g.
+// MUL -> ADD -> LOGISTIC -> MUL) into a single "FusedElementwise" custom op,
+// so the runtime makes one pass over memory instead of one per op.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "mlir/IR/Attributes.h"  // from @llvm-project
+#include "mlir/IR/Builders.h"  // from @llvm-project
+#include "mlir/IR/StandardTypes.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/lite/ir/tfl_ops.h"
+
+//===----------------------------------------------------------------------===//
+// The FuseElementwiseChains Pass.
+//
+namespace mlir {
+namespace TFL {
+
+namespace {
+
+constexpr char kFusedElementwise[] = "FusedElementwise";
+constexpr char kFusedActivationFunction[] = "fused_activation_function";
+
+// A single step of the fused program. `operand` indexes the inputs of the
+// fused op for binary steps and is -1 for unary ones.
+struct Step {
+  std::string op;
+  int operand;
+};
+
+enum class StepKind { kNone, kUnary, kCommutative, kNonCommutative };
+
+StepKind GetStepKind(Operation* op) {
+  return llvm::StringSwitch<StepKind>(op->getName().getStringRef())
+      .Cases("tfl.add", "tfl.mul", "tfl.maximum", "tfl.minimum",
+             StepKind::kCommutative)
+      .Cases("tfl.sub", "tfl.div", StepKind::kNonCommutative)
+      .Cases("tfl.logistic", "tfl.tanh", "tfl.relu", "tfl.relu6",
+             StepKind::kUnary)
+      .Cases("tfl.relu_n1_to_1", "tfl.neg", "tfl.abs", "tfl.square",
+             StepKind::kUnary)
+      .Default(StepKind::kNone);
+}
+
+// Returns the runtime name of `op`; `reversed` is set when the chain value is
+// the right-hand side of a non-commutative op.
+std::string GetStepName(Operation* op, bool reversed) {
+  std::string name =
+      op->getName().getStringRef().drop_front(strlen("tfl.")).upper();
+  return reversed ? "REVERSE_" + name : name;
+}
+
+// Returns the runtime name of the fused activation of `op`, which is empty
+// when there is none.
+std::string GetActivationName(Operation* op) {
+  auto attr = op->getAttrOfType<StringAttr>(kFusedActivationFunction);
+  if (!attr || attr.getValue() == "NONE") return "";
+  return attr.getValue().str();
+}
+
+bool HasSupportedActivation(Operation* op) {
+  const std::string activation = GetActivationName(op);
+  return activation.empty() || activation == "RELU" ||
+         activation == "RELU6" || activation == "RELU_N1_TO_1" ||
+         activation == "TANH";
+}
+
+bool IsStaticFloatTensor(Type type) {
+  auto tensor_type = type.dyn_cast<RankedTensorType>();
+  return tensor_type && tensor_type.hasStaticShape() &&
+         tensor_type.getElementType().isF32();
+}
+
+// Returns true if `side_operand` can be read element by element alongside a
+// chain value of `result_type`, either with the same shape or as a scalar.
+bool IsCompatibleSideOperand(Value side_operand, RankedTensorType result_type) {
+  auto type = side_operand.getType().dyn_cast<RankedTensorType>();
+  if (!type || !type.hasStaticShape() || !type.getElementType().isF32()) {
+    return false;
+  }
+  return type.getShape() == result_type.getShape() ||
+         type.getNumElements() == 1;
+}
+
+// Returns the operand index of `op` that carries the chain value when it is
+// fed by `chain_value`, or the preferred one when `chain_value` is null.
+// Returns -1 if `op` can't be part of a chain.
+int GetChainOperandIndex(Operation* op, Value chain_value) {
+  const StepKind kind = GetStepKind(op);
+  if (kind == StepKind::kNone || op->getNumResults() != 1 ||
+      !IsStaticFloatTensor(op->getResult(0).getType()) ||
+      !HasSupportedActivation(op)) {
+    return -1;
+  }
+  auto result_type = op->getResult(0).getType().cast<RankedTensorType>();
+  if (kind == StepKind::kUnary) {
+    if (op->getNumOperands() != 1) return -1;
+    if (chain_value && op->getOperand(0) != chain_value) return -1;
+    return IsStaticFloatTensor(op->getOperand(0).getType()) ? 0 : -1;
+  }
+  if (op->getNumOperands() != 2) return -1;
+  // Squaring the chain value requires it as a side operand, which it isn't.
+  if (op->getOperand(0) == op->getOperand(1)) return -1;
+  for (int i = 0; i < 2; ++i) {
+    Value candidate = op->getOperand(i);
+    if (chain_value && candidate != chain_value) continue;
+    if (candidate.getType() != result_type) continue;
+    if (IsCompatibleSideOperand(op->getOperand(1 - i), result_type)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// Returns the single user of the result of `op`, if it can extend the chain.
+Operation* GetNextInChain(Operation* op) {
+  Value result = op->getResult(0);
+  if (!result.hasOneUse()) return nullptr;
+  Operation* user = *result.getUsers().begin();
+  if (user->getBlock() != op->getBlock()) return nullptr;
+  return GetChainOperandIndex(user, result) >= 0 ? user : nullptr;
+}
+
+OpaqueElementsAttr BuildCustomOption(OpBuilder* builder,
+                                     const std::vector<Step>& steps) {
+  flexbuffers::Builder fbb;
+  fbb.Map([&]() {
+    fbb.Vector("ops", [&]() {
+      for (const Step& step : steps) fbb.String(step.op);
+    });
+    fbb.Vector("operands", [&]() {
+      for (const Step& step : steps) fbb.Int(step.operand);
+    });
+  });
+  fbb.Finish();
+  const std::vector<uint8_t>& buffer = fbb.GetBuffer();
+  std::string content(buffer.begin(), buffer.end());
+  ShapedType type = RankedTensorType::get(
+      {static_cast<int64_t>(content.size())}, builder->getIntegerType(8));
+  return OpaqueElementsAttr::get(
+      builder->getContext()->getRegisteredDialect("tfl"), type, content);
+}
+
+// Replaces `chain` by a single custom op.
+void FuseChain(const llvm::SmallVector<Operation*, 8>& chain) {
+  Operation* head = chain.front();
+  Operation* tail = chain.back();
+
+  llvm::SmallVector<Value, 4> inputs;
+  llvm::DenseMap<Value, int> input_index;
+  auto get_input_index = [&](Value value) {
+    auto it = input_index.find(value);
+    if (it != input_index.end()) return it->second;
+    const int index = inputs.size();
+    inputs.push_back(value);
+    input_index[value] = index;
+    return index;
+  };
+  get_input_index(head->getOperand(GetChainOperandIndex(head, nullptr)));
+
+  std::vector<Step> steps;
+  Value chain_value = inputs.front();
+  for (Operation* op : chain) {
+    const int chain_operand = GetChainOperandIndex(op, chain_value);
+    if (GetStepKind(op) == StepKind::kUnary) {
+      steps.push_back({GetStepName(op, false), -1});
+    } else {
+      const bool reversed = chain_operand == 1 &&
+                            GetStepKind(op) == StepKind::kNonCommutative;
+      steps.push_back({GetStepName(op, reversed),
+                       get_input_index(op->getOperand(1 - chain_operand))});
+      const std::string activation = GetActivationName(op);
+      if (!activation.empty()) steps.push_back({activation, -1});
+    }
+    chain_value = op->getResult(0);
+  }
+
+  // All inputs dominate the tail, so the fused op takes its place.
+  OpBuilder builder(tail);
+  auto fused = builder.create<CustomOp>(
+      tail->getLoc(), tail->getResultTypes(), inputs, kFusedElementwise,
+      BuildCustomOption(&builder, steps));
+  tail->getResult(0).replaceAllUsesWith(fused.getResult(0));
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    (*it)->erase();
+  }
+}
+
+struct FuseElementwiseChains
+    : public PassWrapper<FuseElementwiseChains, FunctionPass> {
+  void runOnFunction() override;
+};
+
+void FuseElementwiseChains::runOnFunction() {
+  // Collect the chains first, since fusing erases ops.
+  std::vector<llvm::SmallVector<Operation*, 8>> chains;
+  llvm::DenseSet<Operation*> visited;
+  getFunction().walk([&](Operation* op) {
+    if (visited.count(op) || GetChainOperandIndex(op, nullptr) < 0) return;
+    llvm::SmallVector<Operation*, 8> chain = {op};
+    visited.insert(op);
+    while (Operation* next = GetNextInChain(chain.back())) {
+      if (visited.count(next)) break;
+      chain.push_back(next);
+      visited.insert(next);
+    }
+    // A single op gains nothing from being interpreted.
+    if (chain.size() > 1) chains.push_back(std::move(chain));
+  });
+  for (const auto& chain : chains) FuseChain(chain);
+}
+
+}  // namespace
+
+// Creates an instance of the TensorFlow Lite dialect FuseElementwiseChains
+// pass.
+std::unique_ptr<OperationPass<FuncOp>> CreateFuseElementwiseChainsPass() {
+  return absl::make_unique<FuseElementwiseChains>();
+}
+
+static PassRegistration<FuseElementwiseChains> pass(
+    "tfl-fuse-elementwise-chains",
+    "Fuse chains of element-wise ops into a FusedElementwise custom op.");
+
+}  // namespace TFL
+}  // namespace mlir
@@ -82,6 +82,10 @@ std::unique_ptr<OperationPass<FuncOp>> CreateDefaultQuantParamsPass(
 // tensor to sparse format.
 std::unique_ptr<OperationPass<FuncOp>> CreateDenseToSparsePass();
 
+// Creates an instance of the TensorFlow Lite dialect pass to fuse chains of
+// element-wise ops into FusedElementwise custom ops.
+std::unique_ptr<OperationPass<FuncOp>> CreateFuseElementwiseChainsPass();
+
 // Creates function pass to legalize TF While to TFL While.
 std::unique_ptr<OperationPass<ModuleOp>> CreateLegalizeTFWhilePass();
 
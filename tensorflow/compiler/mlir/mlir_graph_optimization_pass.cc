@@ -16,9 +16,9 @@ limitations under the License.
 #include "tensorflow/compiler/mlir/mlir_graph_optimization_pass.h"
 
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
-#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "mlir/Dialect/Shape/IR/Shape.h"  // from @llvm-project
@@ -109,18 +109,21 @@ Status MlirFunctionOptimizationPass::Run(
     std::vector<std::string>* control_ret_node_names,
     bool* control_rets_updated) {
   // Skip conversion from Graph to MLIR if none of the passes are enabled.
-  const bool is_enabled =
-      llvm::any_of(registry_->passes(), [&](auto& pass_registration) -> bool {
-        return pass_registration.pass->IsEnabled(config_proto);
-      });
+  std::vector<MlirOptimizationPass*> enabled_passes;
+  for (auto& pass_registration : registry_->passes()) {
+    if (pass_registration.pass->IsEnabled(config_proto)) {
+      enabled_passes.push_back(pass_registration.pass.get());
+    }
+  }
 
-  if (!is_enabled) {
+  if (enabled_passes.empty()) {
     VLOG(1) << "None of the MLIR optimization passes are enabled "
             << "(registered " << registry_->passes().size() << ")";
     return Status::OK();
   }
 
-  VLOG(1) << "Running MLIR Graph Optimization Passes "
+  VLOG(1) << "Running " << enabled_passes.size()
+          << " MLIR Graph Optimization Passes "
           << "(registered " << registry_->passes().size() << " passes)";
 
   GraphDebugInfo debug_info;
@@ -136,15 +139,17 @@ Status MlirFunctionOptimizationPass::Run(
 
   AddDevicesToOp(*module_ref, &device_set);
 
-  for (auto& pass_registration : registry_->passes()) {
-    llvm::StringRef name = pass_registration.pass->name();
+  // All enabled passes run on the same module, so the graph is converted to
+  // MLIR and back once however many of them there are.
+  for (MlirOptimizationPass* pass : enabled_passes) {
+    llvm::StringRef name = pass->name();
     VLOG(2) << "Run MLIR graph optimization pass: " << StringRefToView(name);
 
     if (VLOG_IS_ON(1)) {
       DumpModule(*module_ref, llvm::formatv("mlir_{0}_before_", name));
     }
 
-    TF_RETURN_IF_ERROR(pass_registration.pass->Run(config_proto, *module_ref));
+    TF_RETURN_IF_ERROR(pass->Run(config_proto, *module_ref));
 
     if (VLOG_IS_ON(1)) {
       DumpModule(*module_ref, llvm::formatv("mlir_{0}_after_", name));
@@ -180,19 +185,21 @@ Status MlirV1CompatGraphOptimizationPass::Run(
   if (options.is_function_graph) return Status::OK();
 
   // Skip conversion from Graph to MLIR if none of the passes are enabled.
-  const bool is_enabled =
-      absl::c_any_of(registry_->passes(), [&](auto& pass_registration) -> bool {
-        return pass_registration.pass->IsEnabled(
-            options.session_options->config);
-      });
+  std::vector<MlirV1CompatOptimizationPass*> enabled_passes;
+  for (auto& pass_registration : registry_->passes()) {
+    if (pass_registration.pass->IsEnabled(options.session_options->config)) {
+      enabled_passes.push_back(pass_registration.pass.get());
+    }
+  }
 
-  if (!is_enabled) {
+  if (enabled_passes.empty()) {
     VLOG(1) << "None of the MLIR optimization passes are enabled "
             << "(registered" << registry_->passes().size() << " passes)";
     return Status::OK();
   }
 
-  VLOG(1) << "Running MLIR Graph Optimization V1 Compat Passes "
+  VLOG(1) << "Running " << enabled_passes.size()
+          << " MLIR Graph Optimization V1 Compat Passes "
           << "(registered" << registry_->passes().size() << " passes)";
 
   GraphDebugInfo debug_info;
@@ -209,15 +216,15 @@ Status MlirV1CompatGraphOptimizationPass::Run(
 
   AddDevicesToOp(*module_ref, options.device_set);
 
-  for (auto& pass_registration : registry_->passes()) {
-    llvm::StringRef name = pass_registration.pass->name();
+  for (MlirV1CompatOptimizationPass* pass : enabled_passes) {
+    llvm::StringRef name = pass->name();
     VLOG(2) << "Run MLIR graph optimization pass: " << StringRefToView(name);
 
     if (VLOG_IS_ON(1)) {
       DumpModule(*module_ref, llvm::formatv("mlir_{0}_before_", name));
     }
 
-    TF_RETURN_IF_ERROR(pass_registration.pass->Run(options, *module_ref));
+    TF_RETURN_IF_ERROR(pass->Run(options, *module_ref));
 
     if (VLOG_IS_ON(1)) {
       DumpModule(*module_ref, llvm::formatv("mlir_{0}_after_", name));
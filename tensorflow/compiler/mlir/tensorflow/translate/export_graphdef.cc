@@ -631,13 +631,16 @@ Status Exporter::ConvertLibFunction(const GraphExportConfig& configs,
                                     mlir::FuncOp function,
                                     FunctionDefLibrary* flib) {
   // First look for the function in the current function library. If found,
-  // nothing needs to be done.
-  OpRegistry empty_registry;
-  FunctionLibraryDefinition flib_def(&empty_registry, *flib);
+  // nothing needs to be done. The library is scanned in place, as building a
+  // FunctionLibraryDefinition from it would copy every function exported so
+  // far, once per exported function.
   auto function_name = function.getName().str();
-  if (flib_def.Find(function_name)) return Status::OK();
+  if (llvm::any_of(flib->function(), [&](const FunctionDef& func_def) {
+        return func_def.signature().name() == function_name;
+      })) {
+    return Status::OK();
+  }
 
-  // TODO(fengliuai): use a small flib_def to reduce overhead
   absl::flat_hash_set<Node*> control_ret_nodes;
   TF_ASSIGN_OR_RETURN(auto sub_graph,
                       Exporter::Convert(configs, tf_dialect, function, flib,
@@ -38,8 +38,12 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -129,11 +133,22 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Builds and returns a cuda engine for the input shapes. If building the
   // engine fails, enters a dummy entry into the cache_resource cache so we
-  // don't continually try to build the same failing engine.
+  // don't continually try to build the same failing engine. If the on-disk
+  // engine cache is enabled, the engine is loaded from there when possible,
+  // and newly built engines are written to it.
   StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> BuildEngine(
       const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
       bool use_calibration, TRTInt8Calibrator* calibrator,
-      TRTEngineCacheResource* cache_resource);
+      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
+
+  // Returns the file of the on-disk engine cache for the engine built for the
+  // input shapes, or an empty string if the engine is not cached on disk. The
+  // file name fingerprints the segment, the build parameters, the TensorRT
+  // version and the GPU, so that engines are never shared between
+  // incompatible builds.
+  string GetEngineCacheFile(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
@@ -521,6 +536,30 @@ Status TRTEngineOp::VerifyInputShapes(
   return Status::OK();
 }
 
+// Returns the directory in which TensorRT engines built at runtime are
+// persisted across processes, or an empty string if they are not.
+static string EngineCacheDir() {
+  string value;
+  Status status = ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR",
+                                       /*default_value=*/"", &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return value;
+}
+
+// Returns the maximum number of optimization profiles created from the
+// collected input shapes, or 0 to create one profile per input shape.
+static int64 MaxOptimizationProfiles() {
+  int64 value;
+  Status status = ReadInt64FromEnvVar("TF_TRT_MAX_OPTIMIZATION_PROFILES",
+                                      /*default_val=*/0, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return value;
+}
+
 static bool AllowEngineNativeSegmentExecution() {
   bool value;
   Status status =
@@ -607,7 +646,7 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
       return;
     } else if (cache_res->profiles_.GetNumProfiles() == 0) {
       // Create profiles out of collected shapes during profile generation.
-      cache_res->profiles_.InitProfiles();
+      cache_res->profiles_.InitProfiles(MaxOptimizationProfiles());
     }
   }
   StatusOr<std::pair<EngineContext*, int>> status =
@@ -734,7 +773,36 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
-    TRTEngineCacheResource* cache_resource) {
+    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+  // Engines calibrated at runtime depend on the calibration data, which is not
+  // part of the cache key.
+  const string cache_file =
+      calibrator == nullptr
+          ? GetEngineCacheFile(input_concrete_shapes, batch_size,
+                               cache_resource, ctx)
+          : "";
+  if (!cache_file.empty() && Env::Default()->FileExists(cache_file).ok()) {
+    string serialized_engine;
+    Status status = ReadFileToString(Env::Default(), cache_file,
+                                     &serialized_engine);
+    if (status.ok()) {
+      TrtUniquePtrType<IRuntime> infer(nvinfer1::createInferRuntime(logger));
+      infer->setGpuAllocator(cache_resource->allocator_.get());
+      TrtUniquePtrType<nvinfer1::ICudaEngine> engine(
+          infer->deserializeCudaEngine(serialized_engine.data(),
+                                       serialized_engine.size(), nullptr));
+      if (engine) {
+        VLOG(1) << "Loaded TensorRT engine for " << name() << " from "
+                << cache_file;
+        return engine;
+      }
+      status = errors::DataLoss("Failed to deserialize the engine");
+    }
+    LOG_WARNING_WITH_PREFIX << "Loading the cached engine " << cache_file
+                            << " for " << name() << " failed, building a new "
+                            << "engine instead. Reason: " << status;
+  }
+
   VLOG(1) << "Building a new TensorRT engine for " << name()
           << " with input shapes: "
           << TensorShapeUtils::ShapeListString(input_concrete_shapes);
@@ -762,9 +830,73 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
                                    absl::make_unique<EngineContext>());
     return status;
   }
+  if (!cache_file.empty()) {
+    // Write to a temporary file first, so that concurrent processes never
+    // load a partially written engine.
+    TrtUniquePtrType<nvinfer1::IHostMemory> serialized_engine(
+        engine->serialize());
+    const string tmp_file =
+        StrCat(cache_file, ".tmp", Env::Default()->NowMicros());
+    Status status = WriteStringToFile(
+        Env::Default(), tmp_file,
+        StringPiece(static_cast<const char*>(serialized_engine->data()),
+                    serialized_engine->size()));
+    if (status.ok()) {
+      status = Env::Default()->RenameFile(tmp_file, cache_file);
+    }
+    if (status.ok()) {
+      VLOG(1) << "Saved TensorRT engine for " << name() << " to "
+              << cache_file;
+    } else {
+      LOG_WARNING_WITH_PREFIX << "Saving the engine for " << name() << " to "
+                              << cache_file << " failed. Reason: " << status;
+    }
+  }
   return engine;
 }
 
+string TRTEngineOp::GetEngineCacheFile(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
+  const string cache_dir = EngineCacheDir();
+  if (cache_dir.empty() || segment_graph_def_.node().empty()) {
+    return "";
+  }
+  Status status = Env::Default()->RecursivelyCreateDir(cache_dir);
+  if (!status.ok()) {
+    LOG_WARNING_WITH_PREFIX << "Not caching the engine for " << name()
+                            << " on disk. Reason: " << status;
+    return "";
+  }
+  string segment;
+  if (!SerializeToStringDeterministic(segment_graph_def_, &segment)) {
+    return "";
+  }
+  const se::DeviceDescription& device =
+      ctx->op_device_context()->stream()->parent()->GetDeviceDescription();
+  int cc_major = 0, cc_minor = 0;
+  device.cuda_compute_capability(&cc_major, &cc_minor);
+
+  string key = StrCat(Fingerprint64(segment), ";",
+                      static_cast<int>(precision_mode_), ";",
+                      workspace_size_, ";", use_implicit_batch_, ";",
+                      GetLoadedTensorRTVersion(), ";", device.name(), ";",
+                      cc_major, ".", cc_minor, ";");
+  if (use_implicit_batch_) {
+    StrAppend(&key, TensorShapeUtils::ShapeListString(input_concrete_shapes));
+  } else {
+    for (const PartialTensorShape& shape : input_partial_shapes_) {
+      StrAppend(&key, shape.DebugString());
+    }
+    StrAppend(&key, cache_resource->profiles_.ProfilesDebugString());
+  }
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return io::JoinPath(
+      cache_dir, StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                        absl::Hex(fingerprint.low64, absl::kZeroPad16),
+                        ".trtengine"));
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
@@ -824,7 +956,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       }
       auto result = BuildEngine(input_concrete_shapes, batch_size,
                                 /*use_calibration=*/false,
-                                /*calibrator=*/nullptr, cache_res);
+                                /*calibrator=*/nullptr, cache_res, ctx);
       if (!result.ok()) {
         return std::pair<EngineContext*, int>(&empty_context, 0);
       }
@@ -892,7 +1024,8 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result = BuildEngine(input_concrete_shapes, batch_size,
-                              use_calibration_, calibrator_.get(), cache_res);
+                              use_calibration_, calibrator_.get(), cache_res,
+                              ctx);
     if (!result.ok()) {
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <map>
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 
@@ -24,19 +25,46 @@ limitations under the License.
 namespace tensorflow {
 namespace tensorrt {
 
+namespace {
+
+// Returns the ranks of the shapes. Only shape vectors with the same ranks can
+// share an optimization profile.
+string RankSignature(const std::vector<TensorShape>& shapes) {
+  string signature;
+  for (const TensorShape& shape : shapes) {
+    absl::StrAppend(&signature, shape.dims(), ",");
+  }
+  return signature;
+}
+
+int64 NumElements(const std::vector<TensorShape>& shapes) {
+  int64 num_elements = 0;
+  for (const TensorShape& shape : shapes) {
+    num_elements += shape.num_elements();
+  }
+  return num_elements;
+}
+
+}  // namespace
+
 // Creates optimization profiles for a list of input shapes. The list of input
 // shapes are stored in shapes_.
-void TrtShapeOptimizationProfile::InitProfiles() {
+void TrtShapeOptimizationProfile::InitProfiles(int max_profiles) {
   if (input_shapes_.size() == 0) {
     VLOG(1) << "Not creating profiles without input_shapes. "
                "You have to enable profile generation mode first (build).";
+  } else if (max_profiles > 0 && input_shapes_.size() > max_profiles) {
+    VLOG(1) << "Creating up to " << max_profiles << " profiles from "
+            << input_shapes_.size() << " collected input shapes.";
+    CreateMergedProfiles(max_profiles);
+    return;
   } else {
     VLOG(1) << "Creating profiles with startegy of one profile "
             << "for each input (min=opt=max).";
   }
-  for (auto& shape_vec : input_shapes_) {
+  for (auto& entry : input_shapes_) {
     std::vector<nvinfer1::Dims> dimvec;
-    for (auto& shape : shape_vec) {
+    for (auto& shape : entry.first) {
       dimvec.push_back(TensorShapeToTrtDims(shape, false));
     }
     // We set min=opt=max.
@@ -46,6 +74,83 @@ void TrtShapeOptimizationProfile::InitProfiles() {
   }
 }
 
+void TrtShapeOptimizationProfile::CreateMergedProfiles(int max_profiles) {
+  // Group the shape vectors by ranks. std::map keeps the profile order
+  // deterministic.
+  std::map<string, std::vector<ShapeCount>> groups;
+  int64 total_count = 0;
+  for (const auto& entry : input_shapes_) {
+    groups[RankSignature(entry.first)].push_back(entry);
+    total_count += entry.second;
+  }
+  for (auto& group : groups) {
+    std::vector<ShapeCount>& shapes = group.second;
+    std::sort(shapes.begin(), shapes.end(),
+              [](const ShapeCount& a, const ShapeCount& b) {
+                const int64 a_elements = NumElements(a.first);
+                const int64 b_elements = NumElements(b.first);
+                if (a_elements != b_elements) return a_elements < b_elements;
+                return TensorShapeUtils::ShapeListString(a.first) <
+                       TensorShapeUtils::ShapeListString(b.first);
+              });
+    int64 group_count = 0;
+    for (const ShapeCount& shape : shapes) {
+      group_count += shape.second;
+    }
+    // Every group needs a profile of its own. The budget is shared among the
+    // groups in proportion to the number of observations.
+    const int num_buckets = std::min<int64>(
+        shapes.size(),
+        std::max<int64>(1, max_profiles * group_count / total_count));
+    // Split the sorted shapes into contiguous buckets, closing a bucket once
+    // it holds its share of the observations.
+    int begin = 0;
+    int64 seen = 0;
+    for (int bucket = 1; bucket <= num_buckets && begin < shapes.size();
+         bucket++) {
+      const int64 target = group_count * bucket / num_buckets;
+      int end = begin;
+      while (end < shapes.size() &&
+             (end == begin || bucket == num_buckets ||
+              seen + shapes[end].second <= target)) {
+        seen += shapes[end].second;
+        end++;
+      }
+      AddMergedProfile(shapes, begin, end);
+      begin = end;
+    }
+  }
+}
+
+void TrtShapeOptimizationProfile::AddMergedProfile(
+    const std::vector<ShapeCount>& shapes, int begin, int end) {
+  OptimizationProfileConfig profConfig;
+  int most_frequent = begin;
+  for (int i = begin; i < end; i++) {
+    if (shapes[i].second > shapes[most_frequent].second) {
+      most_frequent = i;
+    }
+    for (int j = 0; j < shapes[i].first.size(); j++) {
+      nvinfer1::Dims dims = TensorShapeToTrtDims(shapes[i].first[j], false);
+      if (i == begin) {
+        profConfig.min.push_back(dims);
+        profConfig.max.push_back(dims);
+        continue;
+      }
+      for (int d = 0; d < dims.nbDims; d++) {
+        profConfig.min[j].d[d] = std::min(profConfig.min[j].d[d], dims.d[d]);
+        profConfig.max[j].d[d] = std::max(profConfig.max[j].d[d], dims.d[d]);
+      }
+    }
+  }
+  for (auto& shape : shapes[most_frequent].first) {
+    profConfig.opt.push_back(TensorShapeToTrtDims(shape, false));
+  }
+  profiles_.push_back(std::move(profConfig));
+  VLOG(1) << "Created profile " << profiles_.back().DebugString() << " for "
+          << end - begin << " collected input shapes";
+}
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
 Status TrtShapeOptimizationProfile::AddProfiles(
     nvinfer1::IBuilder* builder, nvinfer1::IBuilderConfig* config,
@@ -180,6 +285,14 @@ int TrtShapeOptimizationProfile::GetNumProfiles() const {
   return profiles_.size();
 }
 
+string TrtShapeOptimizationProfile::ProfilesDebugString() const {
+  string result;
+  for (const OptimizationProfileConfig& profile : profiles_) {
+    absl::StrAppend(&result, profile.DebugString());
+  }
+  return result;
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -18,7 +18,7 @@ limitations under the License.
 
 #include <list>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
@@ -118,9 +118,10 @@ class TrtShapeOptimizationProfile {
  public:
   TrtShapeOptimizationProfile() {}
 
-  // Stores input shape information during profile_generation_mode
+  // Stores input shape information during profile_generation_mode. Repeated
+  // shapes are counted, so that InitProfiles can favor the common ones.
   void AddShape(std::vector<TensorShape> shapes) {
-    input_shapes_.insert(shapes);
+    ++input_shapes_[shapes];
     VLOG(1) << "Collected shape(s) " << DebugString(shapes) << " for profiles.";
   }
 
@@ -145,22 +146,46 @@ class TrtShapeOptimizationProfile {
 
   // Maps input vector shapes to TRT Optimization profiles (min, max, opt) i.e.
   // maps input_shapes_ to profiles_
-  void InitProfiles();
+  //
+  // By default every collected shape vector gets its own profile
+  // (min=opt=max). If max_profiles > 0 and more distinct shape vectors were
+  // collected, shapes of the same ranks are sorted by size and split into
+  // buckets that hold a similar number of observations. Each bucket becomes a
+  // profile covering the [min, max] of its shapes, optimized for its most
+  // frequently observed shape.
+  void InitProfiles(int max_profiles = 0);
 
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
+  // Returns a description of all created profiles, e.g. to tell apart engines
+  // built for different profiles.
+  string ProfilesDebugString() const;
+
   // Restores profiles from the engine (used after deserialization)
   Status RestoreProfiles(const nvinfer1::ICudaEngine* engine);
 
  private:
-  // Set of input shape vetors that we collect during profile_generation_mode
-  std::unordered_set<std::vector<TensorShape>, VectorTensorShapeHasher>
+  // Input shape vectors that we collect during profile_generation_mode, with
+  // the number of times each was seen.
+  std::unordered_map<std::vector<TensorShape>, int64, VectorTensorShapeHasher>
       input_shapes_;
 
   // The optimization profiles generated from input_shapes_
   std::vector<OptimizationProfileConfig> profiles_;
 
+  // A collected input shape vector and the number of times it was seen.
+  using ShapeCount = std::pair<std::vector<TensorShape>, int64>;
+
+  // Creates about max_profiles profiles from the histogram of input_shapes_,
+  // see InitProfiles.
+  void CreateMergedProfiles(int max_profiles);
+
+  // Creates a profile covering shapes[begin, end), which must have the same
+  // ranks, with opt set to the most frequent shape vector.
+  void AddMergedProfile(const std::vector<ShapeCount>& shapes, int begin,
+                        int end);
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
   /// Adds optimization profiles to the builder config
   Status AddProfiles(nvinfer1::IBuilder* builder,
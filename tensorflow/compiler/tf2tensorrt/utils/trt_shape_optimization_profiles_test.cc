@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string.h>
 
+#include <map>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -208,6 +209,32 @@ TEST_F(TrtShapeOptimizationProfileTest, Dynamic) {
     }
   }
 }
+
+TEST_F(TrtShapeOptimizationProfileTest, MergedProfiles) {
+  TrtShapeOptimizationProfile profile;
+  // Shape (n, n, 10) for both inputs, collected counts[n] times.
+  std::map<int, int> counts{{1, 1}, {2, 3}, {3, 1}, {4, 1}, {16, 2}};
+  for (const auto& count : counts) {
+    std::vector<nvinfer1::Dims3> dim_vec(
+        2, nvinfer1::Dims3(count.first, count.first, 10));
+    for (int i = 0; i < count.second; i++) {
+      profile.AddShape(DimVecToShapeVec(dim_vec));
+    }
+  }
+  profile.InitProfiles(/*max_profiles=*/2);
+  EXPECT_EQ(2, profile.GetNumProfiles());
+
+  // The smaller half of the observations share the first profile.
+  std::map<int, int> expected_profile{{1, 0}, {2, 0}, {3, 1}, {4, 1}, {16, 1}};
+  for (const auto& expected : expected_profile) {
+    std::vector<nvinfer1::Dims3> dim_vec(
+        2, nvinfer1::Dims3(expected.first, expected.first, 10));
+    EXPECT_EQ(expected.second,
+              profile.GetProfileNumber(DimVecToShapeVec(dim_vec)));
+  }
+  std::vector<nvinfer1::Dims3> dim_vec(2, nvinfer1::Dims3(17, 17, 10));
+  EXPECT_EQ(-1, profile.GetProfileNumber(DimVecToShapeVec(dim_vec)));
+}
 #endif
 
 }  // namespace tensorrt
@@ -16,6 +16,9 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
 
 #include <cassert>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <mutex>               // NOLINT(build/c++11)
+
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 
 namespace tensorflow {
@@ -57,6 +60,39 @@ bool XlaCompiledCpuFunction::Run() {
   return true;
 }
 
+bool XlaCompiledCpuFunction::RunBatch(XlaCompiledCpuFunction* const* functions,
+                                      int num_functions,
+                                      const Scheduler& schedule) {
+  if (!schedule || num_functions <= 1) {
+    bool ok = true;
+    for (int i = 0; i < num_functions; ++i) {
+      ok &= functions[i]->Run();
+    }
+    return ok;
+  }
+  // Uses std synchronization primitives to keep the dependencies of AOT
+  // binaries to a minimum.
+  std::mutex mu;
+  std::condition_variable done;
+  int pending = num_functions - 1;
+  bool ok = true;
+  for (int i = 1; i < num_functions; ++i) {
+    schedule([&, i]() {
+      const bool run_ok = functions[i]->Run();
+      // Notify while holding the lock, since the waiter owns `done`.
+      std::lock_guard<std::mutex> lock(mu);
+      ok &= run_ok;
+      if (--pending == 0) {
+        done.notify_one();
+      }
+    });
+  }
+  const bool first_ok = functions[0]->Run();
+  std::unique_lock<std::mutex> lock(mu);
+  done.wait(lock, [&pending]() { return pending == 0; });
+  return ok && first_ok;
+}
+
 XlaCompiledCpuFunction::~XlaCompiledCpuFunction() {
   xla::cpu_function_runtime::FreeContiguous(alloc_buffer_table_);
   delete[] buffer_table_;
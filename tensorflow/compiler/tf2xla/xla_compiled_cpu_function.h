@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_TF2XLA_XLA_COMPILED_CPU_FUNCTION_H_
 
 #include <cassert>
+#include <functional>
 #include <string>
 
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
@@ -46,6 +47,12 @@ namespace tensorflow {
 // o Calls to non-const methods require exclusive access to the object.
 // o Concurrent calls to const methods are OK, if those calls are made while it
 //   is guaranteed that no thread may call a non-const method.
+//
+// Instances created from the same StaticData share the code and the constants
+// compiled into the function, and otherwise only own their arg, result and
+// temp buffers. To serve independent requests concurrently, create one
+// instance per request (or per thread) and use RunBatch; read-only variables
+// can be shared between instances through set_arg_data.
 class XlaCompiledCpuFunction {
  public:
   // Type of the raw function, produced by either JIT or AOT.
@@ -134,6 +141,20 @@ class XlaCompiledCpuFunction {
   // written to result buffers. Returns true on success and false on failure.
   bool Run();
 
+  // Schedules a closure to run, e.g. on a thread pool.
+  using Scheduler = std::function<void(std::function<void()>)>;
+
+  // Runs `functions[i]` for each of the `num_functions` distinct instances,
+  // as if Run() was called on each of them. The runs are independent and are
+  // spread over `schedule`, with one of them on the calling thread; if
+  // `schedule` is empty they run sequentially. Returns once all runs are done;
+  // returns true iff all of them succeeded.
+  //
+  // Each instance still uses its own intra-op thread pool, if any; batches of
+  // small computations usually scale best without one.
+  static bool RunBatch(XlaCompiledCpuFunction* const* functions,
+                       int num_functions, const Scheduler& schedule);
+
   // Returns the error message from the previous failed Run call.
   //
   // TODO(fschneider): For now this always returns an empty string because there
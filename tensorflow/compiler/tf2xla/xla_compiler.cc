@@ -60,8 +60,11 @@ namespace {
 // Checks that arguments `args` match types `types`.
 Status CheckSignature(const DataTypeVector& types,
                       absl::Span<const XlaCompiler::Argument> args) {
-  if (args.size() != types.size()) {
-    return errors::Internal("Compilation arguments have ", args.size(),
+  // Padding arguments have no counterpart in the function.
+  int num_args = args.size();
+  while (num_args > 0 && args[num_args - 1].is_pad_arg) --num_args;
+  if (num_args != types.size()) {
+    return errors::Internal("Compilation arguments have ", num_args,
                             " elements while function has ", types.size());
   }
   for (int i = 0; i < types.size(); ++i) {
@@ -418,10 +421,12 @@ Status BuildComputation(
 bool XlaCompiler::Argument::operator==(
     const XlaCompiler::Argument& other) const {
   if (std::tie(kind, resource_kind, type, name, initialized, max_array_size,
-               tensor_array_gradients) !=
+               tensor_array_gradients, dynamic_dim_to_arg_num_map,
+               is_pad_arg) !=
       std::tie(other.kind, other.resource_kind, other.type, other.name,
                other.initialized, other.max_array_size,
-               other.tensor_array_gradients)) {
+               other.tensor_array_gradients, other.dynamic_dim_to_arg_num_map,
+               other.is_pad_arg)) {
     return false;
   }
   if (absl::holds_alternative<xla::Shape>(shape)) {
@@ -700,7 +705,7 @@ Status XlaCompiler::CompileFunction(
   // Set shapes for _Arg nodes. They are useful for constant folding (e.g. an
   // Xla op requires a compile-time constant input, and that input is shape of
   // an _Arg node.
-  for (int i = 0; i < args.size(); i++) {
+  for (int i = 0; i < fbody->arg_nodes.size(); i++) {
     // Skip resource variables and tensor lists.
     DataType dtype;
     TF_RETURN_IF_ERROR(GetNodeAttr(fbody->arg_nodes[i]->def(), "T", &dtype));
@@ -1258,6 +1263,13 @@ Status XlaCompiler::CompileGraph(
       arg_shardings, &arg_expressions, &result->input_mapping,
       &result->xla_input_shapes, options.is_entry_computation));
   context->set_args(std::move(arg_expressions));
+  for (int i = 0; i < args.size(); ++i) {
+    for (const auto& dim_and_arg_num : args[i].dynamic_dim_to_arg_num_map) {
+      if (args[dim_and_arg_num.second].is_pad_arg) {
+        result->pad_args[dim_and_arg_num.second] = {i, dim_and_arg_num.first};
+      }
+    }
+  }
 
   PushNodeTokenMapping();
   // Use std::set instead of std::unordered_set to ensure determinism.
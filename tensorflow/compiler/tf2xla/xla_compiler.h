@@ -170,6 +170,10 @@ class XlaCompiler {
 
     // dynamic dims to arg number map. Empty if no dynamic shapes.
     std::map<int32, int32> dynamic_dim_to_arg_num_map;
+
+    // Whether this is a padding argument, which holds the runtime size of a
+    // dynamic dimension of another argument and has no counterpart in the
+    // compiled function.  Padding arguments come after all other arguments.
     bool is_pad_arg = false;
 
     // Whether this argument will receive the same data across all replicas.
@@ -291,6 +295,10 @@ class XlaCompiler {
 
     // The XLA computation built from the tensorflow subgraph.
     std::shared_ptr<xla::XlaComputation> computation;
+
+    // Maps the argument numbers of padding arguments to the argument number
+    // and dimension whose runtime size they hold.
+    std::map<int, std::pair<int, int>> pad_args;
   };
 
   typedef std::function<xla::StatusOr<xla::Shape>(const TensorShape&, DataType,
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
@@ -33,7 +34,9 @@ limitations under the License.
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/stream_executor/multi_platform_manager.h"
 #include "tensorflow/stream_executor/platform.h"
 
@@ -229,6 +232,42 @@ TEST(XlaJitCompiledCpuFunction, Sum) {
   EXPECT_TRUE(ShapeUtil::Compatible(result0, s32));
 }
 
+TEST(XlaJitCompiledCpuFunction, RunBatch) {
+  GraphDef graph_def = SumGraph();
+  tf2xla::Config config = SumConfig();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<XlaJitCompiledCpuFunction> jit,
+      XlaJitCompiledCpuFunction::Compile(graph_def, config,
+                                         xla::ExecutableBuildOptions()));
+  constexpr int kBatchSize = 16;
+  std::vector<std::unique_ptr<XlaCompiledCpuFunction>> functions;
+  std::vector<XlaCompiledCpuFunction*> batch;
+  for (int i = 0; i < kBatchSize; ++i) {
+    functions.push_back(
+        absl::make_unique<XlaCompiledCpuFunction>(jit->StaticData()));
+    batch.push_back(functions.back().get());
+    *static_cast<int32*>(batch.back()->arg_data(0)) = i;
+    *static_cast<int32*>(batch.back()->arg_data(1)) = 100 * i;
+  }
+
+  thread::ThreadPool pool(Env::Default(), "run_batch", 4);
+  EXPECT_TRUE(XlaCompiledCpuFunction::RunBatch(
+      batch.data(), batch.size(),
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); }));
+  for (int i = 0; i < kBatchSize; ++i) {
+    EXPECT_EQ(*static_cast<int32*>(batch[i]->result_data(0)), 101 * i);
+  }
+
+  // Without a scheduler the instances run sequentially.
+  *static_cast<int32*>(batch[0]->arg_data(0)) = 10;
+  *static_cast<int32*>(batch[0]->arg_data(1)) = 32;
+  EXPECT_TRUE(XlaCompiledCpuFunction::RunBatch(batch.data(), batch.size(),
+                                               /*schedule=*/nullptr));
+  EXPECT_EQ(*static_cast<int32*>(batch[0]->result_data(0)), 42);
+  EXPECT_EQ(*static_cast<int32*>(batch[1]->result_data(0)), 101);
+}
+
 TEST(XlaJitCompiledCpuFunction, SumVariable) {
   GraphDef graph_def = SumGraphVariable();
   tf2xla::Config config = SumConfigVariable();
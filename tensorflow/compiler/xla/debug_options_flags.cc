@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/strings/str_split.h"
 #include "tensorflow/compiler/xla/debug_options_parsers.h"
 #include "tensorflow/compiler/xla/parse_flags_from_env.h"
+#include "tensorflow/core/platform/protobuf.h"
 
 namespace xla {
 
@@ -38,6 +39,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_cpu_multi_thread_eigen(true);
   opts.set_xla_gpu_cuda_data_dir("./cuda_sdk_lib");
   opts.set_xla_gpu_asm_extra_flags("");
+  opts.set_xla_gpu_persistent_cache_max_bytes(int64{1} << 30);
   opts.set_xla_eliminate_hlo_implicit_broadcast(true);
   opts.set_xla_dump_hlo_as_html(false);
   opts.set_xla_dump_include_timestamp(true);
@@ -72,6 +74,11 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_force_host_platform_device_count(1);
   opts.set_xla_gpu_deterministic_reductions(false);
   opts.set_xla_cpu_enable_xprof_traceme(true);
+  opts.set_xla_cpu_parallel_codegen_split_count(1);
+  opts.set_xla_cpu_calibrated_parallel_task_assignment(false);
+  opts.set_xla_gpu_enable_cuda_graphs(false);
+  opts.set_xla_gpu_max_streams(0);
+  opts.set_xla_gpu_host_offload_limit_bytes(0);
   opts.set_xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found(false);
 
   return opts;
@@ -137,6 +144,16 @@ static void AllocateFlags() {
     };
   };
 
+  // Returns a lambda that calls "member_setter" on "flag_values" with the
+  // argument passed in to the lambda.
+  auto int64_setter_for =
+      [](void (DebugOptions::*member_setter)(tensorflow::protobuf_int64)) {
+        return [member_setter](int64 value) {
+          (flag_values->*member_setter)(value);
+          return true;
+        };
+      };
+
   auto string_setter_for =
       [](void (DebugOptions::*member_setter)(const string& value)) {
         return [member_setter](const string& value) {
@@ -436,6 +453,18 @@ static void AllocateFlags() {
       string_setter_for(&DebugOptions::set_xla_gpu_asm_extra_flags), "",
       "Pass extra parameters to the GPU assembler tool (i.e., ptxas for CUDA). "
       "If multiple parameters, separate them by comma."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_persistent_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_persistent_cache_dir),
+      flag_values->xla_gpu_persistent_cache_dir(),
+      "If non-empty, persist the PTX and cubin compiled by the GPU backend in "
+      "this directory, and reuse them in later processes."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_persistent_cache_max_bytes",
+      int64_setter_for(&DebugOptions::set_xla_gpu_persistent_cache_max_bytes),
+      static_cast<int64>(flag_values->xla_gpu_persistent_cache_max_bytes()),
+      "Maximum size of the --xla_gpu_persistent_cache_dir cache, beyond which "
+      "the oldest entries are evicted."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_fuel", setter_for_xla_fuel, /*default_value_for_display=*/"",
       "Sets compiler fuel, useful for bisecting bugs in passes.  Format "
@@ -561,6 +590,48 @@ static void AllocateFlags() {
       flag_values->xla_cpu_enable_xprof_traceme(),
       "If true, XLA CPU generates code to call "
       "TraceMe::Activity{Start|End} around HLO operations."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      flag_values->xla_cpu_parallel_codegen_split_count(),
+      "If greater than 1, the CPU backend splits the LLVM module into up to "
+      "this many parts and compiles them in parallel."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_cpu_calibrated_parallel_task_assignment",
+      bool_setter_for(
+          &DebugOptions::set_xla_cpu_calibrated_parallel_task_assignment),
+      flag_values->xla_cpu_calibrated_parallel_task_assignment(),
+      "If true, XLA CPU measures the speed of the machine it compiles on and "
+      "uses it to decide how many parallel tasks to split instructions into."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_enable_cuda_graphs",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
+      flag_values->xla_gpu_enable_cuda_graphs(),
+      "If true, XLA GPU captures executables that only launch kernels, "
+      "memsets and device to device copies into CUDA graphs, and relaunches "
+      "the graphs when executed again with the same buffers."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_max_streams",
+      int32_setter_for(&DebugOptions::set_xla_gpu_max_streams),
+      flag_values->xla_gpu_max_streams(),
+      "If positive, XLA GPU assigns instructions to at most this many streams "
+      "based on their estimated run times, and dumps the estimated timeline "
+      "with --xla_dump_to."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_autotune_results_path",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_results_path),
+      flag_values->xla_gpu_autotune_results_path(),
+      "If non-empty, a file from which XLA GPU loads conv and GEMM autotuning "
+      "results, and to which it adds the results it measures, so that they "
+      "are shared across processes."));
+  flag_objects->push_back(tensorflow::Flag(
+      "xla_gpu_host_offload_limit_bytes",
+      int64_setter_for(&DebugOptions::set_xla_gpu_host_offload_limit_bytes),
+      static_cast<int64>(flag_values->xla_gpu_host_offload_limit_bytes()),
+      "If positive, offload buffers with long gaps between their uses to host "
+      "memory until the estimated peak device memory is at most this many "
+      "bytes."));
   flag_objects->push_back(tensorflow::Flag(
       "xla_gpu_unsafe_fallback_to_driver_on_ptxas_not_found",
       bool_setter_for(
@@ -1292,6 +1292,23 @@ Status PjRtBuffer::BlockHostUntilReady() {
   return Status::OK();
 }
 
+StatusOr<bool> PjRtBuffer::IsReady() {
+  std::shared_ptr<TrackedDeviceBuffer> device_buffer;
+  {
+    absl::MutexLock lock(&mu_);
+    if (device_buffer_ == nullptr) {
+      return InvalidArgument("IsReady() called on invalid buffer.");
+    }
+    device_buffer = device_buffer_;
+  }
+  for (const auto& event : device_buffer->definition_events()) {
+    if (!event->IsReady()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 namespace {
 
 // Helper struct for the tuple that is transiently constructed to hold the
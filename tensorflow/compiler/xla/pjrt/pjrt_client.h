@@ -560,6 +560,12 @@ class PjRtBuffer {
   // immediate use on the device. Useful in particular for timing benchmarks.
   Status BlockHostUntilReady();
 
+  // Returns true if the buffer's value has been computed and is ready for
+  // immediate use on the device, without blocking the host. Callers can poll
+  // this instead of blocking in BlockHostUntilReady while a transfer or a
+  // computation that defines the buffer is in flight.
+  StatusOr<bool> IsReady();
+
  private:
   friend class PjRtClient;
   // The cached value of the buffer on the host, produced either from a call to
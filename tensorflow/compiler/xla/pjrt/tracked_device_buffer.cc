@@ -93,6 +93,12 @@ bool BufferSequencingEvent::IsComplete() {
   return event_.event()->PollForStatus() == se::Event::Status::kComplete;
 }
 
+bool BufferSequencingEvent::IsReady() {
+  absl::MutexLock lock(&mu_);
+  return EventHasBeenRecorded() &&
+         event_.event()->PollForStatus() == se::Event::Status::kComplete;
+}
+
 /* static */ std::shared_ptr<TrackedDeviceBuffer>
 TrackedDeviceBuffer::FromScopedShapedBuffer(
     ScopedShapedBuffer* shaped_buffer,
@@ -81,6 +81,10 @@ class BufferSequencingEvent {
   // event has been recorded.
   bool IsComplete();
 
+  // Returns true if the event has been recorded and is known by the host to
+  // have already occurred. Unlike IsComplete, never blocks the calling thread.
+  bool IsReady();
+
   // Compares the sequence numbers of two recorded events. It is illegal to call
   // the comparison operators unless both events have been recorded.
   inline bool operator<(const BufferSequencingEvent& rhs) const {
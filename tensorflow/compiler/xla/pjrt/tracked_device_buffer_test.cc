@@ -117,5 +117,11 @@ TEST(TrackedDeviceBufferTest, FromScopedShapedBuffer) {
                     literal.shape())));
 }
 
+TEST(BufferSequencingEventTest, IsNotReadyUntilRecorded) {
+  BufferSequencingEvent event;
+  // Unlike IsComplete, IsReady does not wait for the event to be recorded.
+  EXPECT_FALSE(event.IsReady());
+}
+
 }  // namespace
 }  // namespace xla
@@ -48,6 +48,7 @@ class PyBuffer {
   void Delete() { return buffer_->Delete(); }
 
   Status BlockHostUntilReady();
+  StatusOr<bool> IsReady() { return buffer_->IsReady(); }
   Status CopyToHostAsync() { return buffer_->CopyToHostAsync(); }
 
   const Shape& shape() { return buffer_->on_host_shape(); }
@@ -108,6 +108,14 @@ StatusOr<std::unique_ptr<PyBuffer>> PyClient::BufferFromPyal(
   std::shared_ptr<PythonRefManager::ManagedPyObjects> py_buffer_ref =
       GlobalPyRefManager()->ManageReference(std::move(c->array));
 
+  // A forced copy must not alias the array, but keeping the array alive until
+  // the transfer completes still lets the caller return before the copy.
+  if (force_copy &&
+      host_buffer_semantics == PjRtBuffer::HostBufferSemantics::kZeroCopy) {
+    host_buffer_semantics =
+        PjRtBuffer::HostBufferSemantics::kImmutableUntilTransferCompletes;
+  }
+
   std::unique_ptr<PjRtBuffer> buffer;
   {
     py::gil_scoped_release gil_release;
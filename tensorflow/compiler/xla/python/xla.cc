@@ -607,6 +607,7 @@ PYBIND11_MODULE(xla_extension, m) {
   buffer.def("copy_to_device", &PyBuffer::CopyToDevice)
       .def("delete", &PyBuffer::Delete)
       .def("block_host_until_ready", &PyBuffer::BlockHostUntilReady)
+      .def("is_ready", &PyBuffer::IsReady)
       .def("copy_to_host_async", &PyBuffer::CopyToHostAsync,
            py::call_guard<py::gil_scoped_release>())
       .def(
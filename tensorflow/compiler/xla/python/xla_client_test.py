@@ -502,6 +502,15 @@ def TestFactory(xla_backend, cloud_tpu=False):
       # This test merely checks that nothing goes awry when we call
       # block_host_until_ready(); it's difficult to test anything else.
 
+    def testIsReadyAfterBlockHostUntilReady(self):
+      arg = np.array([[1., 2.]], np.float32)
+      arg_buffer = self.backend.buffer_from_pyval(arg)
+      arg_buffer.block_host_until_ready()
+      self.assertTrue(arg_buffer.is_ready())
+      arg_buffer.delete()
+      with self.assertRaises(RuntimeError):
+        arg_buffer.is_ready()
+
     def testCopyToHost(self):
       arg0 = np.array([[1., 2.]], np.float32)
       arg1 = np.array([[3., 4.]], np.float32)
@@ -2003,6 +2012,16 @@ def TestFactory(xla_backend, cloud_tpu=False):
       self.assertNotEqual(x.__array_interface__["data"][0],
                           z.__array_interface__["data"][0])
 
+    def testForceCopyDoesNotAlias(self):
+      x = np.arange(16, dtype=np.float32)
+      buffer = self.backend.buffer_from_pyval(
+          x,
+          force_copy=True,
+          host_buffer_semantics=xla_client.HostBufferSemantics.ZERO_COPY)
+      self.assertNotEqual(x.__array_interface__["data"][0],
+                          buffer.unsafe_buffer_pointer())
+      np.testing.assert_array_equal(x, np.array(buffer, copy=False))
+
     def testDeleteWithActiveView(self):
       x = np.random.randn(20, 10)
       buffer = self.backend.buffer_from_pyval(x)
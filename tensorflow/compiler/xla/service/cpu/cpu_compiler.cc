@@ -102,6 +102,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/slice_sinker.h"
 #include "tensorflow/compiler/xla/service/slow_operation_alarm.h"
 #include "tensorflow/compiler/xla/service/sort_simplifier.h"
+#include "tensorflow/compiler/xla/service/topk_rewriter.h"
 #include "tensorflow/compiler/xla/service/transpose_folding.h"
 #include "tensorflow/compiler/xla/service/tree_reduction_rewriter.h"
 #include "tensorflow/compiler/xla/service/triangular_solve_expander.h"
@@ -239,7 +240,7 @@ class CollectProfileCandidates : public DfsHloVisitorWithDefault {
 }  // namespace
 
 Status CpuCompiler::RunHloPassesThroughLayoutAssn(
-    HloModule* module, bool /*is_aot_compile*/,
+    HloModule* module, bool is_aot_compile,
     LLVMTargetMachineFeatures* target_machine_features) {
   HloPassPipeline pipeline("HLO passes through layout assignment");
   pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
@@ -315,6 +316,12 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
     pass.AddPass<HloConstantFolding>();
     pass.AddPass<ConditionalSimplifier>();
   }
+  // The runtime function that implements TopK is only registered with the JIT.
+  if (!is_aot_compile) {
+    pipeline.AddPass<TopkRewriter>([](const HloSortInstruction* sort, int64 k) {
+      return k < sort->keys()->shape().dimensions(sort->sort_dimension());
+    });
+  }
   pipeline.AddPass<IndexedArrayAnalysisPrinterPass>();
   pipeline.AddPass<TransposeFolding>(
       [&](const HloInstruction& dot,
@@ -717,8 +724,17 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  jit->AddModule(std::move(llvm_module));
+  // JIT compile the LLVM IR module to in-memory machine code.  The IR and
+  // object file dumps and the user hooks expect the whole module, so it is only
+  // split into parts compiled in parallel if none of them are enabled.
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1 && !DumpingEnabledForHloModule(*module) &&
+      !user_pre_optimization_hook_ && !user_post_optimization_hook_) {
+    jit->AddModuleInParts(std::move(llvm_module), split_count);
+  } else {
+    jit->AddModule(std::move(llvm_module));
+  }
   cpu_executable.reset(new CpuExecutable(
       std::move(jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map)));
@@ -871,13 +871,35 @@ bool AreGemmShapes(const Shape& lhs_shape, const Shape& rhs_shape,
     case F64:
     case C64:
     case C128:
+    case S8:
+    case S16:
     case S32:
+    case S64:
+    case U8:
+    case U16:
+    case U32:
+    case U64:
       return IsRank2(lhs_shape) && IsRank2(rhs_shape) && IsRank2(output_shape);
     default:
       return false;
   }
 }
 
+// Returns true if the Eigen runtime has a matrix multiplication for `type`.
+bool HasEigenMatMul(PrimitiveType type) {
+  switch (type) {
+    case F16:
+    case F32:
+    case F64:
+    case C64:
+    case C128:
+    case S32:
+      return true;
+    default:
+      return false;
+  }
+}
+
 bool IsAlignedGemm(const DotInfo& dot_info,
                    const TargetMachineFeatures& target_machine_features) {
   if (ShapeUtil::IsZeroElementArray(dot_info.lhs_shape) ||
@@ -894,7 +916,12 @@ bool CanEmitTiledLlvmIrGemm(
     const TargetMachineFeatures& target_machine_features) {
   CHECK(IsAlignedGemm(dot_info, target_machine_features));
 
-  if (ShouldUseMultiThreadedEigen(config)) {
+  // The other GEMMs fall back to naive loops, so the tiled GEMM is always
+  // better for them.
+  const bool has_eigen_matmul =
+      HasEigenMatMul(dot_info.result_shape.element_type());
+
+  if (has_eigen_matmul && ShouldUseMultiThreadedEigen(config)) {
     return false;
   }
 
@@ -903,7 +930,7 @@ bool CanEmitTiledLlvmIrGemm(
       dot_info.dim_nums.lhs_contracting_dimensions(0));
   int n = dot_info.result_shape.dimensions(1);
 
-  if (!options::ForceEnableExperimentalLlvmIrGemm(config)) {
+  if (has_eigen_matmul && !options::ForceEnableExperimentalLlvmIrGemm(config)) {
     // TODO(sanjoy):  We should make these numbers micro-arch specific.
     bool small_gemm =
         k <= 128 && ((m <= 32 && n <= 128) || (m <= 128 && n <= 32));
@@ -952,7 +979,9 @@ DotImplementationStrategy GetDotImplementationStrategy(
                  ? DotImplementationStrategy::kLinalgMatmul
                  : DotImplementationStrategy::kTiledLlvmIrGemm;
     }
-    return DotImplementationStrategy::kEigen;
+    if (HasEigenMatMul(element_type)) {
+      return DotImplementationStrategy::kEigen;
+    }
   }
 
   return DotImplementationStrategy::kNaiveLlvmIr;
@@ -966,8 +995,8 @@ Status EmitNonBatchDotOperation(
     mlir::MLIRContext* mlir_context, const HloModuleConfig& hlo_module_config,
     const TargetMachineFeatures& target_machine_features) {
   PrimitiveType type = target_array.GetShape().element_type();
-  TF_RET_CHECK(S32 == type || F16 == type || F32 == type || F64 == type ||
-               C64 == type || C128 == type);
+  TF_RET_CHECK(primitive_util::IsIntegralType(type) || F16 == type ||
+               F32 == type || F64 == type || C64 == type || C128 == type);
   DotOpEmitter dot_emitter(std::move(dot_info), std::move(hlo_name),
                            target_array, lhs_array, rhs_array, addend_array,
                            executable_run_options_value, b, mlir_context,
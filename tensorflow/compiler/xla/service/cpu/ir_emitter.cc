@@ -874,7 +874,8 @@ Status IrEmitter::HandleDot(HloInstruction* dot) {
   auto rhs = dot->operand(1);
   TF_RETURN_IF_ERROR(ElementTypesSameAndSupported(
       /*instruction=*/*dot, /*operands=*/{lhs, rhs},
-      /*supported_types=*/{S32, F16, F32, F64, C64, C128}));
+      /*supported_types=*/
+      {S8, S16, S32, S64, U8, U16, U32, U64, F16, F32, F64, C64, C128}));
   const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
 
   if (dnums.lhs_contracting_dimensions_size() != 1) {
@@ -2458,6 +2459,56 @@ Status IrEmitter::HandlePadToStatic(HloInstruction* hlo) {
   return Status::OK();
 }
 
+Status IrEmitter::HandleTopK(HloInstruction* hlo) {
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(hlo));
+  const HloInstruction* input = hlo->operand(0);
+  const int64 k = hlo->shape().tuple_shapes(0).dimensions().back();
+  const bool has_batch = hlo->shape().tuple_shapes(0).dimensions_size() == 2;
+  TF_RET_CHECK(input->shape().element_type() == F32);
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(
+      hlo->shape().tuple_shapes(0).layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(
+      hlo->shape().tuple_shapes(1).layout()));
+  TF_RET_CHECK(LayoutUtil::IsMonotonicWithDim0Major(input->shape().layout()));
+
+  TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice values_slice,
+                      assignment_.GetUniqueSlice(input, {}));
+  TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice out_values_slice,
+                      assignment_.GetUniqueSlice(hlo, {0}));
+  TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice out_indices_slice,
+                      assignment_.GetUniqueSlice(hlo, {1}));
+  llvm::Value* values_ptr = EmitBufferPointer(values_slice, input->shape());
+  llvm::Value* out_values_ptr =
+      EmitBufferPointer(out_values_slice, hlo->shape().tuple_shapes(0));
+  llvm::Value* out_indices_ptr =
+      EmitBufferPointer(out_indices_slice, hlo->shape().tuple_shapes(1));
+
+  llvm::Type* float_ptr_type = b_.getFloatTy()->getPointerTo();
+  llvm::Type* int64_type = b_.getInt64Ty();
+  llvm::FunctionType* topk_type = llvm::FunctionType::get(
+      b_.getVoidTy(),
+      {b_.getInt8PtrTy(), int64_type, int64_type, int64_type, float_ptr_type,
+       float_ptr_type, b_.getInt32Ty()->getPointerTo()},
+      /*isVarArg=*/false);
+  llvm::Function* topk_func = llvm::dyn_cast<llvm::Function>(
+      module_->getOrInsertFunction(runtime::kTopKF32SymbolName, topk_type)
+          .getCallee());
+  topk_func->setCallingConv(llvm::CallingConv::C);
+  topk_func->setDoesNotThrow();
+  topk_func->setOnlyAccessesInaccessibleMemOrArgMem();
+  Call(topk_func,
+       {GetExecutableRunOptionsArgument(),
+        b_.getInt64(has_batch ? input->shape().dimensions(0) : 1),
+        b_.getInt64(input->shape().dimensions().back()), b_.getInt64(k),
+        BitCast(values_ptr, float_ptr_type),
+        BitCast(out_values_ptr, float_ptr_type),
+        BitCast(out_indices_ptr, b_.getInt32Ty()->getPointerTo())});
+
+  llvm_ir::EmitTuple(GetIrArrayFor(hlo), {out_values_ptr, out_indices_ptr},
+                     &b_);
+  return Status::OK();
+}
+
 Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   if (custom_call->custom_call_target() == "PadToStatic") {
     return HandlePadToStatic(custom_call);
@@ -2465,6 +2516,9 @@ Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   if (custom_call->custom_call_target() == "SliceToDynamic") {
     return HandleSliceToDynamic(custom_call);
   }
+  if (custom_call->custom_call_target() == "TopK") {
+    return HandleTopK(custom_call);
+  }
   absl::Span<HloInstruction* const> operands(custom_call->operands());
   llvm::Type* i8_ptr_type = b_.getInt8PtrTy();
   llvm::AllocaInst* operands_alloca =
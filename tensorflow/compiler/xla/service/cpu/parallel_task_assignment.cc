@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -24,6 +28,9 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_opcode.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace xla {
 namespace cpu {
@@ -106,6 +113,134 @@ class DefaultCostModel : public ParallelCostModel {
   const std::unique_ptr<HloCostAnalysis> cost_analysis_;
 };
 
+namespace {
+
+// The time this machine takes for the units of work that HloCostAnalysis
+// counts.
+struct MachineCosts {
+  double ns_per_flop;
+  double ns_per_transcendental;
+  double ns_per_byte;
+  // The time to hand a task to a pool thread and wait for it to finish.
+  double ns_per_task;
+};
+
+// Measures the machine costs by running small kernels.  This takes a few tens
+// of milliseconds.
+MachineCosts MeasureMachineCosts() {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  auto nanos_since = [env](uint64 start) {
+    return std::max<double>(1, env->NowNanos() - start);
+  };
+  MachineCosts costs;
+
+  // Multiply-adds on values that stay in the L1 cache.
+  constexpr int kFlopSize = 1024;
+  constexpr int kFlopRepetitions = 4096;
+  std::vector<float> x(kFlopSize, 1.0f);
+  std::vector<float> y(kFlopSize, 0.5f);
+  uint64 start = env->NowNanos();
+  for (int r = 0; r < kFlopRepetitions; ++r) {
+    for (int i = 0; i < kFlopSize; ++i) {
+      y[i] = y[i] * 0.999f + x[i];
+    }
+  }
+  costs.ns_per_flop =
+      nanos_since(start) / (2.0 * kFlopSize * kFlopRepetitions);
+
+  constexpr int kTranscendentalSize = 1 << 18;
+  std::vector<float> z(kTranscendentalSize, 0.5f);
+  start = env->NowNanos();
+  for (int i = 0; i < kTranscendentalSize; ++i) {
+    z[i] = std::exp(z[i] * 1e-3f);
+  }
+  costs.ns_per_transcendental = nanos_since(start) / kTranscendentalSize;
+
+  // Copies of buffers much larger than the caches.
+  constexpr int kCopySize = 32 << 20;
+  constexpr int kCopyRepetitions = 4;
+  std::vector<char> source(kCopySize, 1);
+  std::vector<char> destination(kCopySize);
+  start = env->NowNanos();
+  for (int r = 0; r < kCopyRepetitions; ++r) {
+    source[r] = r;
+    std::memcpy(destination.data(), source.data(), kCopySize);
+  }
+  costs.ns_per_byte =
+      nanos_since(start) / (2.0 * kCopySize * kCopyRepetitions);
+
+  constexpr int kTasks = 256;
+  {
+    tensorflow::thread::ThreadPool pool(env, "xla_cpu_calibration", 1);
+    start = env->NowNanos();
+    for (int i = 0; i < kTasks; ++i) {
+      tensorflow::BlockingCounter counter(1);
+      pool.Schedule([&counter]() { counter.DecrementCount(); });
+      counter.Wait();
+    }
+    costs.ns_per_task = nanos_since(start) / kTasks;
+  }
+
+  // Keep the kernels from being optimized away.
+  volatile float sink = y[kFlopSize / 2] + z[kTranscendentalSize / 2] +
+                        destination[kCopySize / 2];
+  (void)sink;
+
+  VLOG(1) << "Calibrated CPU costs: " << costs.ns_per_flop << "ns per flop, "
+          << costs.ns_per_transcendental << "ns per transcendental, "
+          << costs.ns_per_byte << "ns per byte, " << costs.ns_per_task
+          << "ns per task";
+  return costs;
+}
+
+// Returns the machine costs, which are measured on the first call.
+const MachineCosts& GetMachineCosts() {
+  static const MachineCosts* costs = new MachineCosts(MeasureMachineCosts());
+  return *costs;
+}
+
+}  // namespace
+
+// Cost model that estimates how long instructions take from the speed of the
+// machine it runs on, and splits them into tasks that take long enough to
+// amortize the cost of dispatching them.
+class CalibratedCostModel : public ParallelCostModel {
+ public:
+  CalibratedCostModel(const int64 max_parallelism,
+                      std::unique_ptr<HloCostAnalysis> cost_analysis)
+      : max_parallelism_(max_parallelism),
+        cost_analysis_(std::move(cost_analysis)),
+        costs_(GetMachineCosts()) {}
+  ~CalibratedCostModel() override {}
+
+  int64 GetParallelTaskCount(HloInstruction* instruction) override {
+    const double flops = cost_analysis_->flop_count(*instruction);
+    const double bytes_accessed = cost_analysis_->bytes_accessed(*instruction);
+    int64 max_parallelism = max_parallelism_;
+    if (flops <= bytes_accessed) {
+      // I/O bound instructions scale sub-linearly, as in DefaultCostModel.
+      max_parallelism = std::min<int64>(
+          max_parallelism,
+          std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
+    }
+    const double instruction_ns =
+        flops * costs_.ns_per_flop +
+        cost_analysis_->transcendental_count(*instruction) *
+            costs_.ns_per_transcendental +
+        bytes_accessed * costs_.ns_per_byte;
+    // Each task must take many times the cost of dispatching it.
+    const double min_ns_per_task = 20 * costs_.ns_per_task;
+    return std::min(max_parallelism,
+                    std::max(int64{1}, static_cast<int64>(instruction_ns /
+                                                          min_ns_per_task)));
+  }
+
+ private:
+  const int64 max_parallelism_;
+  const std::unique_ptr<HloCostAnalysis> cost_analysis_;
+  const MachineCosts& costs_;
+};
+
 ParallelTaskAssignment::ParallelTaskAssignment(
     const int64 max_parallelism,
     const HloCostAnalysis::ShapeSizeFunction& shape_size, HloModule* module,
@@ -116,7 +251,12 @@ ParallelTaskAssignment::ParallelTaskAssignment(
   auto cost_analysis = absl::make_unique<HloCostAnalysis>(shape_size);
   HloComputation* computation = module->entry_computation();
   Status status = computation->root_instruction()->Accept(cost_analysis.get());
-  if (status.ok()) {
+  if (status.ok() && module->config()
+                         .debug_options()
+                         .xla_cpu_calibrated_parallel_task_assignment()) {
+    cost_model_.reset(
+        new CalibratedCostModel(max_parallelism, std::move(cost_analysis)));
+  } else if (status.ok()) {
     // Set default cost model based on 'cost_analysis'.
     cost_model_.reset(new DefaultCostModel(max_parallelism, shape_size,
                                            std::move(cost_analysis)));
@@ -191,5 +191,32 @@ TEST_F(ParallelTaskAssignmentTest, AllReduceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, CalibratedCostModel) {
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_calibrated
+    ENTRY Exp {
+      small = f32[4] parameter(0)
+      small_exp = f32[4] exponential(small)
+      large = f32[16777216] parameter(1)
+      large_exp = f32[16777216] exponential(large)
+      ROOT tuple = (f32[4], f32[16777216]) tuple(small_exp, large_exp)
+    }
+  )";
+
+  HloModuleConfig config = GetModuleConfigForTest();
+  DebugOptions debug_options = config.debug_options();
+  debug_options.set_xla_cpu_calibrated_parallel_task_assignment(true);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string, config));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+
+  // Only the large exponential is outlined into a parallel computation.
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  EXPECT_EQ(root->operand(0)->opcode(), HloOpcode::kExp);
+  EXPECT_EQ(root->operand(1)->opcode(), HloOpcode::kCall);
+}
+
 }  // namespace
 }  // namespace xla
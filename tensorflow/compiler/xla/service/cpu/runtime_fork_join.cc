@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/runtime_fork_join.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #define EIGEN_USE_THREADS
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -31,9 +35,34 @@ using tensorflow::uint64;
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      int64*, uint64*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// The state that the caller of a fork/join shares with the tasks it enqueues.
+// It is reference counted because a task may only start running after the
+// caller has returned.
+struct ForkJoinState {
+  explicit ForkJoinState(int32 num_partitions)
+      : num_partitions(num_partitions), done(num_partitions) {}
+
+  // Claims the next partition to run, or returns a value >= num_partitions if
+  // all partitions have been claimed.
+  int32 ClaimPartition() { return next_partition.fetch_add(1); }
+
+  const int32 num_partitions;
+  std::atomic<int32> next_partition{0};
+  tensorflow::BlockingCounter done;
+};
+
+}  // namespace
+
+// Runs the 'num_partitions' calls to 'function_ptr' on the calling thread and
+// on up to 'num_partitions - 1' tasks enqueued on the intra-op thread pool.
+// The calling thread and the tasks claim partitions until there are none left,
+// and then the calling thread waits for the partitions that other threads are
+// still running.  So the join never waits for tasks that are still queued,
+// e.g. because the fork/join runs on a pool thread and all the others are
+// busy: their partitions are run by the calling thread instead, and the tasks
+// find nothing to do once they start.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -81,24 +110,31 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32 i = 1; i < num_partitions; ++i) {
-    const int64 offset = i * stride;
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+  // Runs partitions until all have been claimed.  The arguments are only used
+  // while running a partition, before the join returns.
+  auto run_partitions = [function, result_ptr, run_options_ptr, buffer_table,
+                         prof_counters, partitions, stride](
+                            ForkJoinState* fork_join) {
+    for (int32 i = fork_join->ClaimPartition(); i < fork_join->num_partitions;
+         i = fork_join->ClaimPartition()) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      fork_join->done.DecrementCount();
+    }
+  };
+
+  // Enqueue no more tasks than the pool has threads to run them.
+  const int32 num_tasks =
+      std::min(num_partitions - 1,
+               run_options->intra_op_thread_pool()->numThreads());
+  for (int32 i = 0; i < num_tasks; ++i) {
     run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+        [state, run_partitions]() { run_partitions(state.get()); });
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &partitions[0],
-           prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  run_partitions(state.get());
+  state->done.Wait();
   VLOG(2) << "ParallelForkJoin EXIT";
 }
@@ -0,0 +1,98 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/runtime_topk.h"
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/compiler/xla/executable_run_options.h"
+#include "tensorflow/core/platform/dynamic_annotations.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace {
+using tensorflow::int32;
+using tensorflow::int64;
+
+// Maps `value` to an integer with the same order, in which -0.0 is smaller
+// than 0.0. The bits of negative values other than the sign are flipped, so
+// that larger magnitudes map to smaller integers.
+int32 ToOrderedInt(float value) {
+  int32 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits ^ ((bits >> 31) & std::numeric_limits<int32>::max());
+}
+
+// Computes the topk of the rows [first_row, last_row).
+void TopKRows(int64 first_row, int64 last_row, int64 input_size, int64 k,
+              const float* values, float* out_values, int32* out_indices) {
+  std::vector<int32> indices(input_size);
+  for (int64 row = first_row; row < last_row; ++row) {
+    const float* row_values = values + row * input_size;
+    std::iota(indices.begin(), indices.end(), 0);
+    auto kth_element = indices.begin() + k;
+    std::partial_sort(indices.begin(), kth_element, indices.end(),
+                      [&](int32 i1, int32 i2) {
+                        int32 v1 = ToOrderedInt(row_values[i1]);
+                        int32 v2 = ToOrderedInt(row_values[i2]);
+                        if (v1 == v2) {
+                          return i1 < i2;
+                        }
+                        return v1 > v2;
+                      });
+    std::copy(indices.begin(), kth_element, out_indices + row * k);
+    for (int64 i = 0; i < k; ++i) {
+      out_values[row * k + i] = row_values[indices[i]];
+    }
+  }
+}
+
+}  // namespace
+
+TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_TopKF32(
+    const void* run_options_ptr, int64 batch_size, int64 input_size, int64 k,
+    const float* values, float* out_values, int32* out_indices) {
+  // 'values' is managed by the JIT code, so msan can't tell they are
+  // initialized.
+  TF_ANNOTATE_MEMORY_IS_INITIALIZED(values,
+                                    batch_size * input_size * sizeof(float));
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options == nullptr ? nullptr : run_options->intra_op_thread_pool();
+  if (thread_pool == nullptr || batch_size == 1) {
+    TopKRows(0, batch_size, input_size, k, values, out_values, out_indices);
+    return;
+  }
+  // A partial sort of a row reads it once and does O(input_size * log(k))
+  // comparisons.
+  const Eigen::TensorOpCost cost(
+      /*bytes_loaded=*/input_size * sizeof(float),
+      /*bytes_stored=*/k * (sizeof(float) + sizeof(int32)),
+      /*compute_cycles=*/input_size * (std::log2(k + 1) + 1) * 4);
+  thread_pool->parallelFor(batch_size, cost,
+                           [&](Eigen::Index first_row, Eigen::Index last_row) {
+                             TopKRows(first_row, last_row, input_size, k,
+                                      values, out_values, out_indices);
+                           });
+}
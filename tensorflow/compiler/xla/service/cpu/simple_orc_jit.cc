@@ -22,6 +22,8 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
@@ -29,6 +31,7 @@ limitations under the License.
 #include "llvm/IR/Operator.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
@@ -43,9 +46,12 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_fft.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_single_threaded_matmul.h"
+#include "tensorflow/compiler/xla/service/cpu/runtime_topk.h"
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -89,11 +95,25 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(pre_optimization_hook),
+      post_optimization_hook_(post_optimization_hook),
+      post_codegen_hook_(post_codegen_hook),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](llvm::StringRef name) -> llvm::JITSymbol {
+            // The symbols that the parts of a split module share are hidden,
+            // so non-exported symbols are looked up too.
+            if (auto symbol = this->compile_layer_.findSymbol(
+                    std::string(name), /*ExportedSymbolsOnly=*/false)) {
+              return symbol;
+            }
             return this->ResolveRuntimeSymbol(std::string(name));
           },
           [](llvm::Error Err) {
@@ -180,6 +200,56 @@ SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
   return key;
 }
 
+std::vector<SimpleOrcJIT::VModuleKeyT> SimpleOrcJIT::AddModuleInParts(
+    std::unique_ptr<llvm::Module> module, int num_parts) {
+  // Modules that share an LLVMContext cannot be compiled concurrently, so each
+  // part is written to bitcode and read back into a context of its own, as
+  // llvm::splitCodeGen does.
+  std::vector<std::string> part_bitcodes;
+  llvm::SplitModule(
+      std::move(module), num_parts,
+      [&](std::unique_ptr<llvm::Module> part) {
+        part_bitcodes.emplace_back();
+        llvm::raw_string_ostream stream(part_bitcodes.back());
+        llvm::WriteBitcodeToFile(*part, stream);
+        stream.flush();
+      },
+      /*PreserveLocals=*/false);
+
+  std::vector<ObjLayerT::ObjectPtr> objects(part_bitcodes.size());
+  {
+    tensorflow::thread::ThreadPool pool(tensorflow::Env::Default(),
+                                        "xla_cpu_codegen", num_parts);
+    for (int i = 0, e = part_bitcodes.size(); i < e; ++i) {
+      pool.Schedule([this, i, &part_bitcodes, &objects]() {
+        llvm::LLVMContext context;
+        std::unique_ptr<llvm::Module> part =
+            cantFail(llvm::parseBitcodeFile(
+                         llvm::MemoryBufferRef(part_bitcodes[i], "part"),
+                         context),
+                     "parsing a module part failed");
+        // TargetMachines are not thread-safe either.
+        std::unique_ptr<llvm::TargetMachine> target_machine =
+            InferTargetMachineForJIT(target_options_, opt_level_);
+        objects[i] = CompilerFunctor(
+            target_machine.get(), opt_level_, optimize_for_size_,
+            disable_expensive_passes_, fast_math_flags_, pre_optimization_hook_,
+            post_optimization_hook_, post_codegen_hook_)(*part);
+      });
+    }
+  }
+
+  std::vector<VModuleKeyT> keys;
+  for (ObjLayerT::ObjectPtr& object : objects) {
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object)));
+    module_keys_.push_back(key);
+    keys.push_back(key);
+  }
+  VLOG(1) << "Compiled the module in " << keys.size() << " parts";
+  return keys;
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
@@ -267,6 +337,7 @@ bool RegisterKnownJITSymbols() {
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseInfeedBufferAfterDequeue);
   REGISTER_CPU_RUNTIME_SYMBOL(ReleaseOutfeedBufferAfterPopulation);
   REGISTER_CPU_RUNTIME_SYMBOL(KeyValueSort);
+  REGISTER_CPU_RUNTIME_SYMBOL(TopKF32);
   REGISTER_CPU_RUNTIME_SYMBOL(TracingStart);
   REGISTER_CPU_RUNTIME_SYMBOL(TracingEnd);
 
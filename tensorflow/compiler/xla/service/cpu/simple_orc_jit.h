@@ -39,9 +39,10 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
-// Implements eager compilation - the module is lowered to binary as soon as
-// it's added to the JIT.
+// Supports JIT-ing multiple modules; symbols that a module does not define are
+// looked up in the other modules and then in the runtime.  Implements eager
+// compilation - the module is lowered to binary as soon as it's added to the
+// JIT.
 class SimpleOrcJIT {
  public:
   using ObjLayerT = llvm::orc::LegacyRTDyldObjectLinkingLayer;
@@ -73,6 +74,13 @@ class SimpleOrcJIT {
   // remove this module.
   VModuleKeyT AddModule(std::unique_ptr<llvm::Module> module);
 
+  // Splits `module` into up to `num_parts` modules, compiles them in parallel
+  // and adds them to the JIT.  Returns the keys of the parts.  Since calls
+  // between the parts are not inlined, this trades some run time for compile
+  // time.  The module hooks are run on each part, concurrently.
+  std::vector<VModuleKeyT> AddModuleInParts(
+      std::unique_ptr<llvm::Module> module, int num_parts);
+
   // Remove a module from the JIT and free the memory associated with it.
   void RemoveModule(VModuleKeyT key);
 
@@ -101,6 +109,17 @@ class SimpleOrcJIT {
   void NotifyObjectFreed(const llvm::object::ObjectFile& object);
 
   std::vector<VModuleKeyT> module_keys_;
+
+  // The options the parts of a split module are compiled with.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const LLVMCompiler::ModuleHook post_optimization_hook_;
+  const std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook_;
+
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const llvm::DataLayout data_layout_;
   llvm::orc::ExecutionSession execution_session_;
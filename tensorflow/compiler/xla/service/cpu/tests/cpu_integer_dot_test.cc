@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Integer dots that have no Eigen matrix multiplication use the tiled LLVM IR
+// emitters.
+class CpuIntegerDotTest : public CpuCodegenTest {};
+
+TEST_F(CpuIntegerDotTest, S8MatrixMatrix) {
+  const char* hlo_text = R"(
+HloModule S8MatrixMatrix
+
+ENTRY main {
+  lhs = s8[19,37] parameter(0)
+  rhs = s8[37,23] parameter(1)
+  ROOT dot = s8[19,23] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, absl::nullopt));
+}
+
+TEST_F(CpuIntegerDotTest, U16MatrixVector) {
+  const char* hlo_text = R"(
+HloModule U16MatrixVector
+
+ENTRY main {
+  lhs = u16[67,41] parameter(0)
+  rhs = u16[41] parameter(1)
+  ROOT dot = u16[67] dot(lhs, rhs), lhs_contracting_dims={1},
+    rhs_contracting_dims={0}
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, absl::nullopt));
+}
+
+TEST_F(CpuIntegerDotTest, S64TransposedMatrixMatrix) {
+  // Not canonical, so this is emitted as naive loops rather than tiles.
+  const char* hlo_text = R"(
+HloModule S64TransposedMatrixMatrix
+
+ENTRY main {
+  lhs = s64[13,7] parameter(0)
+  rhs = s64[5,13] parameter(1)
+  ROOT dot = s64[7,5] dot(lhs, rhs), lhs_contracting_dims={0},
+    rhs_contracting_dims={1}
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, absl::nullopt));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
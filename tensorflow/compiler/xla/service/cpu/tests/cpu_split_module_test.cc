@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuSplitModuleTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuSplitModuleTest, LinksComputationsAcrossParts) {
+  // The while loop, its condition and body, the reduction and the constants
+  // are emitted as separate functions and globals, which the split puts in
+  // different parts.
+  const char* hlo_text = R"(
+HloModule SplitModule
+
+add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+body {
+  state = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  one = s32[] constant(1)
+  next_i = s32[] add(i, one)
+  x = f32[4] get-tuple-element(state), index=1
+  offsets = f32[4] constant({1, 2, 3, 4})
+  next_x = f32[4] add(x, offsets)
+  ROOT next_state = (s32[], f32[4]) tuple(next_i, next_x)
+}
+
+cond {
+  state = (s32[], f32[4]) parameter(0)
+  i = s32[] get-tuple-element(state), index=0
+  limit = s32[] constant(10)
+  ROOT less = pred[] compare(i, limit), direction=LT
+}
+
+ENTRY main {
+  x = f32[4] parameter(0)
+  zero = s32[] constant(0)
+  init = (s32[], f32[4]) tuple(zero, x)
+  loop = (s32[], f32[4]) while(init), condition=cond, body=body
+  result = f32[4] get-tuple-element(loop), index=1
+  init_sum = f32[] constant(0)
+  ROOT sum = f32[] reduce(result, init_sum), dimensions={0}, to_apply=add
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5}));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
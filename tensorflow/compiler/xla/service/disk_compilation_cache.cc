@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/disk_compilation_cache.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/raw_coding.h"
+
+namespace xla {
+namespace {
+
+// An entry is the magic, the sizes of the key and the value, the fingerprint
+// of the value, and then the key and the value.
+constexpr absl::string_view kMagic = "XLADCC01";
+constexpr size_t kHeaderSize = kMagic.size() + 3 * sizeof(uint64);
+constexpr absl::string_view kEntrySuffix = ".xdcc";
+
+}  // namespace
+
+DiskCompilationCache::DiskCompilationCache(std::string dir, int64 max_bytes,
+                                           tensorflow::Env* env)
+    : dir_(std::move(dir)), max_bytes_(max_bytes), env_(env) {}
+
+std::string DiskCompilationCache::EntryPath(absl::string_view key) const {
+  return tensorflow::io::JoinPath(
+      dir_, absl::StrCat(absl::Hex(tensorflow::Fingerprint64(key),
+                                   absl::kZeroPad16),
+                         kEntrySuffix));
+}
+
+absl::optional<std::string> DiskCompilationCache::Lookup(
+    absl::string_view key) const {
+  const std::string path = EntryPath(key);
+  std::string entry;
+  if (!tensorflow::ReadFileToString(env_, path, &entry).ok()) {
+    return absl::nullopt;
+  }
+  bool valid = entry.size() >= kHeaderSize &&
+               absl::string_view(entry).substr(0, kMagic.size()) == kMagic;
+  uint64 key_size = 0;
+  uint64 value_size = 0;
+  uint64 value_fingerprint = 0;
+  if (valid) {
+    const char* header = entry.data() + kMagic.size();
+    key_size = tensorflow::core::DecodeFixed64(header);
+    value_size = tensorflow::core::DecodeFixed64(header + sizeof(uint64));
+    value_fingerprint =
+        tensorflow::core::DecodeFixed64(header + 2 * sizeof(uint64));
+    valid = entry.size() - kHeaderSize == key_size + value_size;
+  }
+  if (!valid) {
+    LOG(WARNING) << "Removing corrupted compilation cache entry " << path;
+    env_->DeleteFile(path).IgnoreError();
+    return absl::nullopt;
+  }
+  if (absl::string_view(entry).substr(kHeaderSize, key_size) != key) {
+    VLOG(1) << "Compilation cache entry " << path << " is for another key";
+    return absl::nullopt;
+  }
+  std::string value = entry.substr(kHeaderSize + key_size);
+  if (tensorflow::Fingerprint64(value) != value_fingerprint) {
+    LOG(WARNING) << "Removing corrupted compilation cache entry " << path;
+    env_->DeleteFile(path).IgnoreError();
+    return absl::nullopt;
+  }
+  VLOG(1) << "Compilation cache hit for " << path;
+  return value;
+}
+
+void DiskCompilationCache::Insert(absl::string_view key,
+                                  absl::string_view value) {
+  if (static_cast<int64>(kHeaderSize + key.size() + value.size()) >
+      max_bytes_) {
+    VLOG(1) << "Not caching a compilation result of " << value.size()
+            << " bytes, over the cache size limit";
+    return;
+  }
+  tensorflow::Status status = env_->RecursivelyCreateDir(dir_);
+  if (!status.ok()) {
+    LOG(WARNING) << "Cannot create compilation cache directory " << dir_
+                 << ": " << status;
+    return;
+  }
+  std::string entry(kMagic);
+  tensorflow::core::PutFixed64(&entry, key.size());
+  tensorflow::core::PutFixed64(&entry, value.size());
+  tensorflow::core::PutFixed64(&entry, tensorflow::Fingerprint64(value));
+  absl::StrAppend(&entry, key, value);
+
+  const std::string path = EntryPath(key);
+  const std::string tmp_path =
+      absl::StrCat(path, ".tmp.", absl::Hex(tensorflow::random::New64()));
+  status = tensorflow::WriteStringToFile(env_, tmp_path, entry);
+  if (status.ok()) {
+    status = env_->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Cannot write compilation cache entry " << path << ": "
+                 << status;
+    env_->DeleteFile(tmp_path).IgnoreError();
+    return;
+  }
+  VLOG(1) << "Inserted compilation cache entry " << path << " of "
+          << entry.size() << " bytes";
+  EvictIfNeeded();
+}
+
+void DiskCompilationCache::EvictIfNeeded() {
+  std::vector<std::string> children;
+  if (!env_->GetChildren(dir_, &children).ok()) return;
+  struct Entry {
+    std::string path;
+    int64 mtime_nsec;
+    int64 length;
+  };
+  std::vector<Entry> entries;
+  int64 total_bytes = 0;
+  for (const std::string& child : children) {
+    if (!absl::EndsWith(child, kEntrySuffix)) continue;
+    const std::string path = tensorflow::io::JoinPath(dir_, child);
+    tensorflow::FileStatistics stat;
+    if (!env_->Stat(path, &stat).ok()) continue;
+    entries.push_back({path, stat.mtime_nsec, stat.length});
+    total_bytes += stat.length;
+  }
+  if (total_bytes <= max_bytes_) return;
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.mtime_nsec < b.mtime_nsec;
+            });
+  for (const Entry& entry : entries) {
+    if (total_bytes <= max_bytes_) break;
+    VLOG(1) << "Evicting compilation cache entry " << entry.path;
+    if (env_->DeleteFile(entry.path).ok()) {
+      total_bytes -= entry.length;
+    }
+  }
+}
+
+}  // namespace xla
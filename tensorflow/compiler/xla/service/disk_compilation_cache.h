@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_DISK_COMPILATION_CACHE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_DISK_COMPILATION_CACHE_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace xla {
+
+// A cache of compilation results in a directory, shared by all the processes
+// that use the directory, so that a new process does not have to compile
+// again what an earlier one compiled.
+//
+// Each entry is a file named after the fingerprint of its key, which holds the
+// key itself, so that fingerprint collisions are detected, and a fingerprint
+// of its value, so that truncated or corrupted entries are detected and
+// removed.  Entries are written to a temporary file first and renamed into
+// place, so that readers in other processes never see partial entries.
+//
+// Once the entries take more than `max_bytes`, the oldest ones are evicted.
+// The class is thread-safe, since all its state is in the directory.
+// Concurrent processes may race on eviction, which at worst evicts more than
+// needed.
+class DiskCompilationCache {
+ public:
+  DiskCompilationCache(std::string dir, int64 max_bytes,
+                       tensorflow::Env* env = tensorflow::Env::Default());
+
+  // Returns the value stored for `key`, or nullopt if there is none or it is
+  // corrupted.
+  absl::optional<std::string> Lookup(absl::string_view key) const;
+
+  // Stores `value` for `key`, and evicts the oldest entries if the cache is
+  // over its size limit.  Failures are logged and otherwise ignored, since the
+  // cache is only an optimization.
+  void Insert(absl::string_view key, absl::string_view value);
+
+ private:
+  std::string EntryPath(absl::string_view key) const;
+
+  // Removes the oldest entries until the cache holds at most max_bytes_.
+  void EvictIfNeeded();
+
+  const std::string dir_;
+  const int64 max_bytes_;
+  tensorflow::Env* const env_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DiskCompilationCache);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_DISK_COMPILATION_CACHE_H_
@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/disk_compilation_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace {
+
+class DiskCompilationCacheTest : public ::testing::Test {
+ protected:
+  DiskCompilationCacheTest()
+      : dir_(tensorflow::io::JoinPath(
+            tensorflow::testing::TmpDir(),
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+  }
+
+  // Returns the paths of the entries in the cache directory.
+  std::vector<std::string> Entries() {
+    std::vector<std::string> children;
+    TF_CHECK_OK(tensorflow::Env::Default()->GetChildren(dir_, &children));
+    std::vector<std::string> paths;
+    for (const std::string& child : children) {
+      paths.push_back(tensorflow::io::JoinPath(dir_, child));
+    }
+    return paths;
+  }
+
+  const std::string dir_;
+};
+
+TEST_F(DiskCompilationCacheTest, RoundTrip) {
+  DiskCompilationCache cache(dir_, 1 << 20);
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+  cache.Insert("key", std::string("value\0with nul", 14));
+  absl::optional<std::string> value = cache.Lookup("key");
+  ASSERT_TRUE(value.has_value());
+  EXPECT_EQ(*value, std::string("value\0with nul", 14));
+  EXPECT_FALSE(cache.Lookup("other key").has_value());
+
+  // Another cache on the same directory, e.g. in another process, sees it.
+  DiskCompilationCache other_cache(dir_, 1 << 20);
+  EXPECT_EQ(other_cache.Lookup("key"), value);
+}
+
+TEST_F(DiskCompilationCacheTest, RemovesCorruptedEntries) {
+  DiskCompilationCache cache(dir_, 1 << 20);
+  cache.Insert("key", "value");
+  std::vector<std::string> entries = Entries();
+  ASSERT_EQ(entries.size(), 1);
+  std::string entry;
+  TF_ASSERT_OK(tensorflow::ReadFileToString(tensorflow::Env::Default(),
+                                            entries[0], &entry));
+  entry.back() ^= 1;
+  TF_ASSERT_OK(tensorflow::WriteStringToFile(tensorflow::Env::Default(),
+                                             entries[0], entry));
+
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+  EXPECT_TRUE(Entries().empty());
+}
+
+TEST_F(DiskCompilationCacheTest, EvictsOldestEntries) {
+  // Room for two entries of this size, but not three.
+  const std::string value(400, 'x');
+  DiskCompilationCache cache(dir_, 1000);
+  cache.Insert("first", value);
+  tensorflow::Env::Default()->SleepForMicroseconds(10000);
+  cache.Insert("second", value);
+  tensorflow::Env::Default()->SleepForMicroseconds(10000);
+  cache.Insert("third", value);
+
+  EXPECT_FALSE(cache.Lookup("first").has_value());
+  EXPECT_TRUE(cache.Lookup("second").has_value());
+  EXPECT_TRUE(cache.Lookup("third").has_value());
+}
+
+TEST_F(DiskCompilationCacheTest, SkipsValuesOverTheLimit) {
+  DiskCompilationCache cache(dir_, 100);
+  cache.Insert("key", std::string(200, 'x'));
+  EXPECT_FALSE(cache.Lookup("key").has_value());
+}
+
+}  // namespace
+}  // namespace xla
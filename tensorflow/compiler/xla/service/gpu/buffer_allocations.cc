@@ -43,7 +43,10 @@ Status BufferAllocations::TearDown(
     const BufferAllocation& allocation = buffer_assignment->GetAllocation(i);
     se::DeviceMemoryBase buffer_address = GetDeviceAddress(allocation.index());
     // Deallocate buffers marked "maybe_live_out" but aren't actually live out,
-    // and temp buffers.
+    // and temp buffers.  The executable owns the host buffers.
+    if (allocation.color() == kHostMemorySpace) {
+      continue;
+    }
     if ((allocation.maybe_live_out() &&
          !live_addresses.count(buffer_address)) ||
         allocation.IsPreallocatedTempBuffer()) {
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logger.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
+#include "tensorflow/core/util/autotune_results_file.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 #include "tensorflow/stream_executor/blas.h"
 #include "tensorflow/stream_executor/device_memory.h"
@@ -265,8 +266,41 @@ static StatusOr<absl::optional<se::blas::AlgorithmType>> DoGemmAutotune(
     VLOG(2) << "Batch size is non-singular, using generic algorithm";
     result = absl::nullopt;
   } else {
-    TF_ASSIGN_OR_RETURN(result,
-                        DoUncachedGemmAutotune(instr, stream, allocator));
+    const std::string& results_path = instr->GetModule()
+                                          ->config()
+                                          .debug_options()
+                                          .xla_gpu_autotune_results_path();
+    std::string device_key;
+    const std::string hlo_key = absl::StrCat(
+        "gemm ", lhs->shape().ToString(/*print_layout=*/true), " ",
+        rhs->shape().ToString(/*print_layout=*/true), " ",
+        instr->shape().ToString(/*print_layout=*/true), " ",
+        gemm_config.ShortDebugString());
+    absl::optional<AutotuneResult> stored;
+    if (!results_path.empty()) {
+      device_key = tensorflow::AutotuneDeviceKey(stream->parent());
+      stored =
+          tensorflow::LookupAutotuneResult(results_path, device_key, hlo_key);
+    }
+    if (stored.has_value()) {
+      VLOG(2) << "Loaded the autotuning result of " << instr->ToString()
+              << " from " << results_path;
+      // Results without a gemm algorithm record that the generic one is used.
+      if (stored->has_gemm()) {
+        result = stored->gemm().algorithm();
+      }
+    } else {
+      TF_ASSIGN_OR_RETURN(result,
+                          DoUncachedGemmAutotune(instr, stream, allocator));
+      if (!results_path.empty()) {
+        AutotuneResult to_store;
+        if (result.has_value()) {
+          to_store.mutable_gemm()->set_algorithm(*result);
+        }
+        tensorflow::StoreAutotuneResult(results_path, device_key, hlo_key,
+                                        to_store);
+      }
+    }
   }
 
   CHECK(autotune_cache.emplace(key, result).second);
@@ -55,6 +55,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
 #include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
 #include "tensorflow/compiler/xla/service/gpu/instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emitter_context.h"
@@ -311,6 +312,16 @@ Status GpuCompiler::OptimizeHloModule(
     pipeline.AddPass<AlgebraicSimplifier>(options);
     TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
   }
+  const int64 host_offload_limit_bytes =
+      hlo_module->config().debug_options().xla_gpu_host_offload_limit_bytes();
+  if (host_offload_limit_bytes > 0) {
+    // Runs after fusion, so that the copies to and from the host are not fused
+    // into the instructions around them.
+    HloPassPipeline pipeline("host_offload");
+    pipeline.AddPass<HostOffloader>(host_offload_limit_bytes,
+                                    ShapeSizeBytesFunction());
+    TF_RETURN_IF_ERROR(pipeline.Run(hlo_module).status());
+  }
   return Status::OK();
 }
 
@@ -488,6 +499,12 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
   // is used by buffer assignment to enable buffer reuse, and the same ordering
   // must also be used to determine the thunk launch schedule.
   std::unique_ptr<StreamAssignment> stream_assignment = AssignStreams(*module);
+  if (DumpingEnabledForHloModule(*module)) {
+    std::string timeline = stream_assignment->EstimatedTimelineToString();
+    if (!timeline.empty()) {
+      DumpToFileInDirOrStdout(*module, "", "stream_timeline", timeline);
+    }
+  }
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<GpuHloSchedule> hlo_schedule,
       GpuHloSchedule::Build(*module, *stream_assignment, pointer_size_));
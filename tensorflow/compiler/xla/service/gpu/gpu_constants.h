@@ -31,6 +31,11 @@ extern const int64 kXlaAllocatedBufferAlignBytes;
 // Minimum alignment for constant buffers.
 extern const int64 kConstantBufferAlignBytes;
 
+// The layout memory space of buffers that live in pinned host memory, which
+// kernels and device copies access through unified addressing.  All other
+// buffers live in device memory, memory space 0.
+extern const int64 kHostMemorySpace;
+
 }  // namespace gpu
 }  // namespace xla
 
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logger.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/autotune_results_file.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 
@@ -303,6 +304,25 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  const string& results_path = instr->GetModule()
+                                   ->config()
+                                   .debug_options()
+                                   .xla_gpu_autotune_results_path();
+  string device_key;
+  const string hlo_key = absl::StrCat("conv ", std::get<1>(key));
+  if (!results_path.empty()) {
+    device_key = tensorflow::AutotuneDeviceKey(stream_exec_);
+    absl::optional<AutotuneResult> result =
+        tensorflow::LookupAutotuneResult(results_path, device_key, hlo_key);
+    if (result.has_value()) {
+      VLOG(2) << "Loaded the autotuning result of " << instr->ToString()
+              << " from " << results_path;
+      tensorflow::mutex_lock lock(autotune_cache_lock);
+      autotune_cache.insert({key, *result});
+      return *result;
+    }
+  }
+
   // Make sure any previous activity on this executor is done. We don't want to
   // interfere with programs that are still running on the GPU.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -335,6 +355,10 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
   }
 
   if (result_or.ok()) {
+    if (!results_path.empty()) {
+      tensorflow::StoreAutotuneResult(results_path, device_key, hlo_key,
+                                      result_or.ValueOrDie());
+    }
     tensorflow::mutex_lock lock(autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
   }
@@ -19,15 +19,19 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/copy_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_debug_info_manager.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_executable_run_options.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_types.h"
 #include "tensorflow/compiler/xla/service/gpu/hlo_execution_profiler.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/buffer_assignment_util.h"
 #include "tensorflow/compiler/xla/service/logical_buffer.h"
@@ -44,12 +48,52 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/platform.h"
 
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#endif  // GOOGLE_CUDA
+
 namespace xla {
 namespace gpu {
 namespace {
 
 using ::tensorflow::profiler::ScopedAnnotation;
 
+// Returns true if `thunk` only enqueues kernels, memsets and device to device
+// copies on its stream, which can be captured into a CUDA graph.  Thunks that
+// synchronize with the host (e.g. while loops and conditionals read their
+// predicate back), call into libraries or allocate memory cannot be captured.
+bool IsCapturable(const Thunk& thunk) {
+  switch (thunk.kind()) {
+    case Thunk::kKernel:
+    case Thunk::kMemzero:
+    case Thunk::kMemset32BitValue:
+      return true;
+    case Thunk::kCopy:
+      return dynamic_cast<const DeviceToDeviceCopyThunk*>(&thunk) != nullptr;
+    case Thunk::kSequential:
+      return absl::c_all_of(
+          static_cast<const SequentialThunk&>(thunk).thunks(),
+          [](const std::unique_ptr<Thunk>& t) { return IsCapturable(*t); });
+    default:
+      return false;
+  }
+}
+
+bool AllThunksCapturable(const ThunkSchedule& thunk_schedule) {
+  return absl::c_all_of(thunk_schedule.TotalOrder(), [](const Thunk* thunk) {
+    return IsCapturable(*thunk);
+  });
+}
+
+#if GOOGLE_CUDA
+se::gpu::GpuContext* GetGpuContext(se::StreamExecutor* executor) {
+  return static_cast<se::gpu::GpuExecutor*>(executor->implementation())
+      ->gpu_context();
+}
+#endif  // GOOGLE_CUDA
+
 }  // namespace
 
 // Implementation note: HLO profiling is always enabled for GPU executables,
@@ -67,7 +111,12 @@ GpuExecutable::GpuExecutable(
       binary_(binary),
       gpu_version_(gpu_version),
       thunk_schedule_(std::move(thunk_schedule)),
-      assignment_(std::move(assignment)) {
+      assignment_(std::move(assignment)),
+      thunks_capturable_(AllThunksCapturable(*thunk_schedule_)),
+      has_host_buffers_(absl::c_any_of(
+          assignment_->Allocations(), [](const BufferAllocation& allocation) {
+            return allocation.color() == kHostMemorySpace;
+          })) {
   CHECK(has_module() && assignment_);
   GpuDebugInfoManager::Get()->RegisterModule(module().name(), shared_module(),
                                              assignment_);
@@ -91,6 +140,29 @@ GpuExecutable::~GpuExecutable() {
       CHECK(pair.first->SynchronizeAllActivity());
     }
   }
+
+  {
+    tensorflow::mutex_lock lock(host_buffers_mutex_);
+    for (auto& pair : host_buffers_) {
+      CHECK(pair.first->SynchronizeAllActivity());
+      for (auto& buffer : pair.second) {
+        if (!buffer.second.is_null()) {
+          pair.first->HostMemoryDeallocate(buffer.second.opaque());
+        }
+      }
+    }
+  }
+
+#if GOOGLE_CUDA
+  tensorflow::mutex_lock lock(cuda_graph_mutex_);
+  for (auto& pair : cuda_graphs_) {
+    CHECK(pair.first->SynchronizeAllActivity());
+    auto graph_exec =
+        static_cast<se::gpu::GpuGraphExecHandle>(pair.second.graph_exec);
+    se::gpu::GpuDriver::DestroyGraphExec(GetGpuContext(pair.first),
+                                         &graph_exec);
+  }
+#endif  // GOOGLE_CUDA
 }
 
 void GpuExecutable::ComputeThunkAnnotations() {
@@ -150,10 +222,34 @@ Status GpuExecutable::ExecuteThunks(
     LOG(WARNING) << "PROFILING: profiling is enabled";
   }
 
+  // The thunks are captured into a CUDA graph on the first execution, and on
+  // later executions with the same buffers the graph is launched instead,
+  // which saves the host the cost of launching each thunk.
+  bool use_cuda_graph =
+      !do_profile && thunks_capturable_ &&
+      executor->platform_kind() == se::PlatformKind::kCuda &&
+      module().config().debug_options().xla_gpu_enable_cuda_graphs();
+  bool launched_cuda_graph = false;
+  if (use_cuda_graph) {
+    TF_ASSIGN_OR_RETURN(launched_cuda_graph,
+                        LaunchCudaGraph(main_stream, buffer_allocations));
+  }
+  bool capturing = false;
+  auto capture_cleanup = MakeCleanup([&]() {
+    if (capturing) {
+      AbortCudaGraphCapture(main_stream);
+    }
+  });
+  if (use_cuda_graph && !launched_cuda_graph) {
+    TF_RETURN_IF_ERROR(BeginCudaGraphCapture(main_stream));
+    capturing = true;
+  }
+
   // Stream 0 indicates `main_stream` and substreams start from stream 1.
   std::vector<StreamPool::Ptr> sub_streams;
   sub_streams.reserve(thunk_schedule_->StreamCount() - 1);
-  while (sub_streams.size() + 1 < thunk_schedule_->StreamCount()) {
+  while (!launched_cuda_graph &&
+         sub_streams.size() + 1 < thunk_schedule_->StreamCount()) {
     sub_streams.emplace_back();
     TF_ASSIGN_OR_RETURN(sub_streams.back(),
                         run_options->BorrowStream(executor->device_ordinal()));
@@ -173,6 +269,9 @@ Status GpuExecutable::ExecuteThunks(
   std::map<const Thunk*, std::unique_ptr<se::Event>> thunk_to_finish_event;
   std::vector<std::function<void()>> deferred_host_callbacks;
   for (Thunk* thunk : thunk_schedule_->TotalOrder()) {
+    if (launched_cuda_graph) {
+      break;
+    }
     CHECK(thunk->hlo_instruction());
     // Annotate execution of this op if tracing was enabled when we started
     // running this module.  If tracing is enabled *while* we're running the
@@ -216,6 +315,11 @@ Status GpuExecutable::ExecuteThunks(
   }
 
   main_stream->ThenWaitFor(&sub_streams);
+  if (capturing) {
+    capturing = false;
+    TF_RETURN_IF_ERROR(
+        EndCudaGraphCaptureAndLaunch(main_stream, buffer_allocations));
+  }
   if (!deferred_host_callbacks.empty()) {
     auto fn = [deferred_host_callbacks{std::move(deferred_host_callbacks)}]() {
       for (auto& callback : deferred_host_callbacks) {
@@ -264,6 +368,99 @@ Status GpuExecutable::ExecuteThunks(
   return Status::OK();
 }
 
+#if GOOGLE_CUDA
+namespace {
+
+std::vector<const void*> GetBufferAddresses(
+    const BufferAllocations& buffer_allocations) {
+  std::vector<const void*> addresses;
+  addresses.reserve(buffer_allocations.size());
+  for (BufferAllocation::Index i = 0; i < buffer_allocations.size(); ++i) {
+    addresses.push_back(buffer_allocations.GetDeviceAddress(i).opaque());
+  }
+  return addresses;
+}
+
+}  // namespace
+
+StatusOr<bool> GpuExecutable::LaunchCudaGraph(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  se::StreamExecutor* executor = stream->parent();
+  tensorflow::mutex_lock lock(cuda_graph_mutex_);
+  auto it = cuda_graphs_.find(executor);
+  if (it == cuda_graphs_.end() ||
+      it->second.buffer_addresses != GetBufferAddresses(buffer_allocations)) {
+    return false;
+  }
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::GraphLaunch(
+      GetGpuContext(executor),
+      static_cast<se::gpu::GpuGraphExecHandle>(it->second.graph_exec),
+      se::gpu::AsGpuStreamValue(stream)));
+  return true;
+}
+
+Status GpuExecutable::BeginCudaGraphCapture(se::Stream* stream) {
+  return se::gpu::GpuDriver::StreamBeginCapture(
+      GetGpuContext(stream->parent()), se::gpu::AsGpuStreamValue(stream));
+}
+
+Status GpuExecutable::EndCudaGraphCaptureAndLaunch(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  se::StreamExecutor* executor = stream->parent();
+  se::gpu::GpuContext* context = GetGpuContext(executor);
+  se::gpu::GpuGraphHandle graph;
+  TF_RETURN_IF_ERROR(se::gpu::GpuDriver::StreamEndCapture(
+      context, se::gpu::AsGpuStreamValue(stream), &graph));
+  se::gpu::GpuGraphExecHandle graph_exec;
+  Status status =
+      se::gpu::GpuDriver::GraphInstantiate(context, graph, &graph_exec);
+  se::gpu::GpuDriver::DestroyGraph(context, &graph);
+  TF_RETURN_IF_ERROR(status);
+
+  tensorflow::mutex_lock lock(cuda_graph_mutex_);
+  CapturedCudaGraph& captured = cuda_graphs_[executor];
+  if (captured.graph_exec != nullptr) {
+    // The old graph may still be running on another stream.
+    if (!executor->SynchronizeAllActivity()) {
+      return InternalError("Failed to synchronize executor %p", executor);
+    }
+    auto old_graph_exec =
+        static_cast<se::gpu::GpuGraphExecHandle>(captured.graph_exec);
+    se::gpu::GpuDriver::DestroyGraphExec(context, &old_graph_exec);
+  }
+  captured.buffer_addresses = GetBufferAddresses(buffer_allocations);
+  captured.graph_exec = graph_exec;
+  return se::gpu::GpuDriver::GraphLaunch(context, graph_exec,
+                                         se::gpu::AsGpuStreamValue(stream));
+}
+
+void GpuExecutable::AbortCudaGraphCapture(se::Stream* stream) {
+  se::gpu::GpuContext* context = GetGpuContext(stream->parent());
+  se::gpu::GpuGraphHandle graph;
+  if (se::gpu::GpuDriver::StreamEndCapture(
+          context, se::gpu::AsGpuStreamValue(stream), &graph)
+          .ok()) {
+    se::gpu::GpuDriver::DestroyGraph(context, &graph);
+  }
+}
+#else   // GOOGLE_CUDA
+StatusOr<bool> GpuExecutable::LaunchCudaGraph(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  return false;
+}
+
+Status GpuExecutable::BeginCudaGraphCapture(se::Stream* stream) {
+  return Unimplemented("CUDA graphs require CUDA");
+}
+
+Status GpuExecutable::EndCudaGraphCaptureAndLaunch(
+    se::Stream* stream, const BufferAllocations& buffer_allocations) {
+  return Unimplemented("CUDA graphs require CUDA");
+}
+
+void GpuExecutable::AbortCudaGraphCapture(se::Stream* stream) {}
+#endif  // GOOGLE_CUDA
+
 StatusOr<const GpuExecutable::BufferAllocToDeviceMemoryMap*>
 GpuExecutable::ResolveConstantGlobals(se::Stream* stream) {
   se::StreamExecutor* executor = stream->parent();
@@ -320,9 +517,45 @@ GpuExecutable::ResolveConstantGlobals(se::Stream* stream) {
   return &module_globals_.emplace(executor, std::move(globals)).first->second;
 }
 
+StatusOr<const GpuExecutable::BufferAllocToDeviceMemoryMap*>
+GpuExecutable::ResolveHostBuffers(se::StreamExecutor* executor) {
+  auto it = host_buffers_.find(executor);
+  if (it != host_buffers_.end()) {
+    return &it->second;
+  }
+
+  BufferAllocToDeviceMemoryMap buffers;
+  for (BufferAllocation::Index i = 0; i < assignment_->Allocations().size();
+       ++i) {
+    const BufferAllocation& allocation = assignment_->GetAllocation(i);
+    if (allocation.color() != kHostMemorySpace) {
+      continue;
+    }
+    se::DeviceMemoryBase buffer;
+    if (allocation.size() > 0) {
+      void* host_buffer = executor->HostMemoryAllocate(allocation.size());
+      if (host_buffer == nullptr) {
+        for (auto& pair : buffers) {
+          if (!pair.second.is_null()) {
+            executor->HostMemoryDeallocate(pair.second.opaque());
+          }
+        }
+        return ResourceExhausted(
+            "Failed to allocate %d bytes of pinned host memory for buffer "
+            "allocation %d",
+            allocation.size(), i);
+      }
+      buffer = se::DeviceMemoryBase(host_buffer, allocation.size());
+    }
+    InsertOrDie(&buffers, i, buffer);
+  }
+  return &host_buffers_.emplace(executor, std::move(buffers)).first->second;
+}
+
 StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
     absl::Span<ExecutionInput const> arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
+    const GpuExecutable::BufferAllocToDeviceMemoryMap* host_buffers,
     const BufferAllocation& allocation,
     se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
     int64 arg_idx) {
@@ -345,6 +578,8 @@ StatusOr<se::DeviceMemoryBase> GpuExecutable::BufferForAllocation(
     return registered_buffer;
   } else if (allocation.is_constant()) {
     return FindOrDie(*globals, arg_idx);
+  } else if (allocation.color() == kHostMemorySpace) {
+    return FindOrDie(*host_buffers, arg_idx);
   } else {
     // Allocate each allocation that might escape, or is the temp buffer.
     CHECK(allocation.maybe_live_out() || allocation.IsPreallocatedTempBuffer());
@@ -384,6 +619,7 @@ static Status CheckAlignment(const BufferAllocation& allocation,
 StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     absl::Span<ExecutionInput const> arguments,
     const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
+    const GpuExecutable::BufferAllocToDeviceMemoryMap* host_buffers,
     se::DeviceMemoryAllocator* const memory_allocator,
     se::StreamExecutor* executor) {
   tensorflow::profiler::TraceMe hlo_module_activity(
@@ -397,8 +633,8 @@ StatusOr<BufferAllocations> GpuExecutable::GenerateBufferAllocations(
     const BufferAllocation& allocation = assignment_->GetAllocation(i);
     TF_ASSIGN_OR_RETURN(
         se::DeviceMemoryBase buffer,
-        BufferForAllocation(arguments, globals, allocation, memory_allocator,
-                            executor->device_ordinal(), i));
+        BufferForAllocation(arguments, globals, host_buffers, allocation,
+                            memory_allocator, executor->device_ordinal(), i));
     buffers.push_back(buffer);
     TF_RETURN_IF_ERROR(CheckAlignment(allocation, buffer, i));
   }
@@ -437,9 +673,10 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStream(
   XLA_SCOPED_LOGGING_TIMER(absl::StrCat("GpuExecutable::ExecuteAsyncOnStream(",
                                         module().name(), ")"));
   se::DeviceMemoryAllocator* const memory_allocator = run_options->allocator();
-  // Force synchronous execution if the allocator requires it.
+  // Force synchronous execution if the allocator requires it, or if the
+  // execution uses the host buffers, which the next execution reuses.
   const bool block_host_until_done =
-      !memory_allocator->AllowsAsynchronousDeallocation();
+      !memory_allocator->AllowsAsynchronousDeallocation() || has_host_buffers_;
 
   if (GetRootValueSet().IsAmbiguous()) {
     return Unimplemented("Points-to set of root instruction is ambiguous");
@@ -462,9 +699,17 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStream(
                          /*on_device_shape=*/root->shape(), memory_allocator,
                          device_ordinal);
 
-  TF_ASSIGN_OR_RETURN(BufferAllocations buffer_allocations,
-                      GenerateBufferAllocations(arguments, globals,
-                                                memory_allocator, executor));
+  absl::optional<tensorflow::mutex_lock> host_buffers_lock;
+  const GpuExecutable::BufferAllocToDeviceMemoryMap* host_buffers = nullptr;
+  if (has_host_buffers_) {
+    host_buffers_lock.emplace(host_buffers_mutex_);
+    TF_ASSIGN_OR_RETURN(host_buffers, ResolveHostBuffers(executor));
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      BufferAllocations buffer_allocations,
+      GenerateBufferAllocations(arguments, globals, host_buffers,
+                                memory_allocator, executor));
   VLOG(2) << buffer_allocations.ToString();
   std::set<se::DeviceMemoryBase> buffers_in_result;
   for (auto& p : result.MutableResult()->buffers()) {
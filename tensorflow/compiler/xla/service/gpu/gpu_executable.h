@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_GPU_EXECUTABLE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
@@ -102,6 +104,25 @@ class GpuExecutable : public Executable {
                        bool block_host_until_done,
                        HloExecutionProfile* hlo_execution_profile);
 
+  // If the thunks have been captured into a CUDA graph on the executor of
+  // `stream` with the buffer addresses of `buffer_allocations`, launches the
+  // graph on `stream` and returns true.  Otherwise returns false.
+  StatusOr<bool> LaunchCudaGraph(se::Stream* stream,
+                                 const BufferAllocations& buffer_allocations);
+
+  // Starts capturing the work enqueued on `stream`, and on the streams that
+  // wait for it, into a CUDA graph.
+  Status BeginCudaGraphCapture(se::Stream* stream);
+
+  // Ends the capture started by BeginCudaGraphCapture, replaces the graph of
+  // the executor of `stream` with it, and launches it on `stream`.
+  Status EndCudaGraphCaptureAndLaunch(
+      se::Stream* stream, const BufferAllocations& buffer_allocations);
+
+  // Ends the capture started by BeginCudaGraphCapture and discards the graph,
+  // after a thunk failed.
+  void AbortCudaGraphCapture(se::Stream* stream);
+
   // Returns the value set of the root instruction of the entry
   // computation. Uses dataflow analysis from buffer assignment.
   const InstructionValueSet& GetRootValueSet() const;
@@ -123,15 +144,23 @@ class GpuExecutable : public Executable {
   Status CheckCompatibilityWithServiceExecutableRunOptions(
       const ServiceExecutableRunOptions* run_options);
 
+  // Returns the pinned host memory of the allocations in kHostMemorySpace on
+  // `executor`, which is allocated on the first execution and then shared by
+  // all the later ones.  host_buffers_mutex_ must be held.
+  StatusOr<const BufferAllocToDeviceMemoryMap*> ResolveHostBuffers(
+      se::StreamExecutor* executor);
+
   StatusOr<BufferAllocations> GenerateBufferAllocations(
       absl::Span<ExecutionInput const> arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
+      const GpuExecutable::BufferAllocToDeviceMemoryMap* host_buffers,
       se::DeviceMemoryAllocator* const memory_allocator,
       se::StreamExecutor* executor);
 
   StatusOr<se::DeviceMemoryBase> BufferForAllocation(
       absl::Span<ExecutionInput const> arguments,
       const GpuExecutable::BufferAllocToDeviceMemoryMap* globals,
+      const GpuExecutable::BufferAllocToDeviceMemoryMap* host_buffers,
       const BufferAllocation& allocation,
       se::DeviceMemoryAllocator* const memory_allocator, int device_ordinal,
       int64 arg_idx);
@@ -172,6 +201,31 @@ class GpuExecutable : public Executable {
   std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
       module_globals_ TF_GUARDED_BY(module_handle_mutex_);
 
+  // True if every thunk only enqueues device work, without synchronizing with
+  // the host or allocating memory, so that the thunks can be captured into a
+  // CUDA graph.
+  const bool thunks_capturable_;
+
+  // The CUDA graph that the thunks have been captured into on each executor,
+  // and the buffer addresses the graph was captured with.  A graph is
+  // recaptured when the addresses change.
+  struct CapturedCudaGraph {
+    std::vector<const void*> buffer_addresses;
+    void* graph_exec = nullptr;
+  };
+  tensorflow::mutex cuda_graph_mutex_;
+  std::map<stream_executor::StreamExecutor*, CapturedCudaGraph> cuda_graphs_
+      TF_GUARDED_BY(cuda_graph_mutex_);
+
+  // True if some allocations live in pinned host memory, see
+  // ResolveHostBuffers.  Since the host buffers are shared, the executions
+  // that use them hold host_buffers_mutex_ throughout, which also guards
+  // host_buffers_.
+  const bool has_host_buffers_;
+  tensorflow::mutex host_buffers_mutex_;
+  std::map<stream_executor::StreamExecutor*, BufferAllocToDeviceMemoryMap>
+      host_buffers_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GpuExecutable);
 };
 
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
 #include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
 #include "tensorflow/compiler/xla/service/hlo_schedule.h"
@@ -203,6 +204,11 @@ StatusOr<std::unique_ptr<GpuHloSchedule>> GpuHloSchedule::Build(
         HloInstructionSequence sequence,
         ScheduleComputation(
             entry_computation, [pointer_size](const BufferValue& buffer) {
+              // Buffers in host memory do not take device memory.
+              if (buffer.shape().has_layout() &&
+                  buffer.shape().layout().memory_space() == kHostMemorySpace) {
+                return int64{0};
+              }
               return ShapeUtil::ByteSizeOf(buffer.shape(), pointer_size);
             }));
     schedule->thunk_launch_order_ = sequence.instructions();
@@ -16,10 +16,13 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/horizontal_fusion.h"
 
 #include <algorithm>
+#include <map>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/layout_util.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_fusible.h"
 #include "tensorflow/compiler/xla/service/hlo_creation_utils.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/util/env_var.h"
@@ -78,6 +81,17 @@ class HorizontalFusionImpl {
  private:
   Status Fuse(absl::Span<HloInstruction*> fused_fusion_instrs);
 
+  // Horizontally fuses candidates that are at the same depth of the
+  // computation, i.e. whose longest paths from the parameters have the same
+  // length, wherever their consumers are.  Edges of the graph always go to a
+  // greater depth, so no candidate can reach another one at its depth, even
+  // through fusions created here, and fusing them never creates a cycle.
+  //
+  // Loop fusions are fused as in Fuse(); reduction input fusions with
+  // compatible shapes are merged into multi-output reduction fusions, which
+  // the reduction emitter lowers to one kernel.
+  StatusOr<bool> FuseByDepth();
+
   // Horizontally fuses `fused_fusion_instrs`. It is required that each of
   // `fused_fusion_instrs` is a kLoop fusion. Also, we require their numbers of
   // outputs to be the same, so that each output will be fused/concatenated with
@@ -101,11 +115,19 @@ class HorizontalFusionImpl {
       Initialize(consumer);
     }
 
+    // Uses the given candidates, which must be supported and profitable, and
+    // must not reach each other.
+    explicit FusionCandidates(std::vector<HloInstruction*> fusion_instrs)
+        : fusion_instrs_(std::move(fusion_instrs)), pos_(0) {
+      SortCandidates();
+    }
+
     // Gets a span of fusions to be fused.
     absl::Span<HloInstruction*> GetNextSpanOfFusions();
 
    private:
     void Initialize(HloInstruction*);
+    void SortCandidates();
 
     std::vector<HloInstruction*> fusion_instrs_;
     // `pos_` points to the start position of the next span.
@@ -203,6 +225,25 @@ bool IsProfitableFusionCandidate(const HloInstruction& instr) {
   return true;
 }
 
+// Returns whether `instr` is a reduction input fusion small enough to be
+// launch-latency-bound, by the same measure as IsProfitableFusionCandidate
+// applied to the inputs of its reductions.
+bool IsProfitableReductionCandidate(const HloInstruction& instr) {
+  constexpr int64 kShapeThreshold = 128 * 2048;
+  constexpr int64 kInstrCountThreshold = 30;
+  if (instr.opcode() != HloOpcode::kFusion || !IsReduceInputFusion(instr) ||
+      instr.user_count() == 0 ||
+      instr.fused_instruction_count() > kInstrCountThreshold) {
+    return false;
+  }
+  auto outputs = GetOutputsOfFusion(instr);
+  return absl::c_all_of(outputs, [](const HloInstruction* output) {
+    return output->opcode() != HloOpcode::kReduce ||
+           ShapeUtil::ElementsIn(output->operand(0)->shape()) <=
+               kShapeThreshold;
+  });
+}
+
 // Returns whether `fusion_instr` has only row-major layouts.
 // The horizontal fusion excludes computations with non-row-major layouts,
 // because fusing computations with different layouts can result in uncoalesced
@@ -254,11 +295,15 @@ void HorizontalFusionImpl::FusionCandidates::Initialize(
     }
   }
 
+  SortCandidates();
+}
+
+void HorizontalFusionImpl::FusionCandidates::SortCandidates() {
   // Sort `fusion_instrs` according to output types, the number of outputs,
   // and instruction counts, because we only fuse instructions with the same
   // number/type of outputs and whose computations have the same instruction
   // count.
-  std::sort(
+  std::stable_sort(
       fusion_instrs_.begin(), fusion_instrs_.end(),
       [&](const HloInstruction* a, const HloInstruction* b) {
         if (GetUniqueOutputTypeOfFusion(*a) !=
@@ -483,6 +528,80 @@ Status HorizontalFusionImpl::Fuse(
   return Status::OK();
 }
 
+StatusOr<bool> HorizontalFusionImpl::FuseByDepth() {
+  // Fusing too many reductions at a time makes the kernel large, as for loop
+  // fusions in GetNextSpanOfFusions.
+  constexpr int64 kMaxReductionBatchSize = 32;
+
+  absl::flat_hash_map<const HloInstruction*, int64> depths;
+  std::map<int64, std::vector<HloInstruction*>> loop_fusions_by_depth;
+  std::map<int64, std::vector<HloInstruction*>> reductions_by_depth;
+  for (HloInstruction* instr : computation_->MakeInstructionPostOrder()) {
+    int64 depth = 0;
+    for (const HloInstruction* operand : instr->operands()) {
+      depth = std::max(depth, depths.at(operand) + 1);
+    }
+    for (const HloInstruction* predecessor : instr->control_predecessors()) {
+      depth = std::max(depth, depths.at(predecessor) + 1);
+    }
+    depths[instr] = depth;
+    if (instr->opcode() != HloOpcode::kFusion) {
+      continue;
+    }
+    if (IsFusionSupported(*instr) && IsProfitableFusionCandidate(*instr) &&
+        HasOnlyRowMajorLayout(*instr)) {
+      loop_fusions_by_depth[depth].push_back(instr);
+    } else if (IsProfitableReductionCandidate(*instr)) {
+      reductions_by_depth[depth].push_back(instr);
+    }
+  }
+
+  bool changed = false;
+  for (auto& pair : loop_fusions_by_depth) {
+    FusionCandidates fusion_candidates(std::move(pair.second));
+    while (true) {
+      auto fusions = fusion_candidates.GetNextSpanOfFusions();
+      if (fusions.empty()) {
+        break;
+      } else if (fusions.size() == 1) {
+        continue;
+      }
+      VLOG(2) << "Horizontally fuse " << fusions.size()
+              << " loop fusions at depth " << pair.first;
+      changed = true;
+      TF_RETURN_IF_ERROR(Fuse(fusions));
+    }
+  }
+
+  for (auto& pair : reductions_by_depth) {
+    std::vector<HloInstruction*>& reductions = pair.second;
+    std::vector<bool> merged(reductions.size(), false);
+    for (size_t i = 0; i < reductions.size(); ++i) {
+      if (merged[i]) {
+        continue;
+      }
+      HloInstruction* remaining = reductions[i];
+      int64 batch_size = 1;
+      for (size_t j = i + 1;
+           j < reductions.size() && batch_size < kMaxReductionBatchSize; ++j) {
+        HloInstruction* fused = reductions[j];
+        if (merged[j] || fused->fusion_kind() != remaining->fusion_kind() ||
+            !ShapesCompatibleForMultiOutputFusion(*remaining, *fused) ||
+            FusionWouldBeTooLarge(*remaining, *fused)) {
+          continue;
+        }
+        VLOG(2) << "Horizontally fuse reduction " << fused->name() << " into "
+                << remaining->name() << " at depth " << pair.first;
+        remaining->MergeFusionInstructionIntoMultiOutput(fused);
+        merged[j] = true;
+        ++batch_size;
+        changed = true;
+      }
+    }
+  }
+  return changed;
+}
+
 StatusOr<bool> HorizontalFusionImpl::Run() {
   bool changed = false;
   XLA_VLOG_LINES(3, computation_->ToString());
@@ -507,6 +626,9 @@ StatusOr<bool> HorizontalFusionImpl::Run() {
     }
   }
 
+  TF_ASSIGN_OR_RETURN(bool fused_by_depth, FuseByDepth());
+  changed |= fused_by_depth;
+
   return changed;
 }
 
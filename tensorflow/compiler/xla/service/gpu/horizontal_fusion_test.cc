@@ -403,6 +403,102 @@ TEST_F(HorizontalFusionTest, NegativeTestForDynamicUpdateSlice) {
   EXPECT_FALSE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
 }
 
+TEST_F(HorizontalFusionTest, FusesIndependentFusionsWithDifferentConsumers) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+ HloModule FusesIndependentFusionsWithDifferentConsumers
+
+ fused_computation.1 {
+   arg.1 = f32[1024]{0} parameter(0)
+   arg.2 = f32[1024]{0} parameter(1)
+   ROOT mul.1 = f32[1024]{0} multiply(arg.1, arg.2)
+ }
+
+ fused_computation.2 {
+   arg.1 = f32[123]{0} parameter(0)
+   arg.2 = f32[123]{0} parameter(1)
+   ROOT add.1 = f32[123]{0} add(arg.1, arg.2)
+ }
+
+ ENTRY entry_computation {
+   arg.1 = f32[1024]{0} parameter(0)
+   arg.2 = f32[1024]{0} parameter(1)
+   arg.3 = f32[123]{0} parameter(2)
+   arg.4 = f32[123]{0} parameter(3)
+   fusion.1 = f32[1024]{0}
+       fusion(arg.1, arg.2), kind=kLoop, calls=fused_computation.1
+   fusion.2 = f32[123]{0}
+       fusion(arg.3, arg.4), kind=kLoop, calls=fused_computation.2
+   // The fusions have different consumers.
+   neg.1 = f32[1024]{0} negate(fusion.1)
+   neg.2 = f32[123]{0} negate(fusion.2)
+   ROOT tuple.1 = (f32[1024]{0}, f32[123]{0}) tuple(neg.1, neg.2)
+ }
+)")
+                    .ValueOrDie();
+
+  EXPECT_TRUE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+  EXPECT_TRUE(HloDCE().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* entry_root =
+      module->entry_computation()->root_instruction();
+  EXPECT_THAT(entry_root,
+              op::Tuple(op::Negate(op::Bitcast(op::GetTupleElement(
+                            op::Fusion(), 0))),
+                        op::Negate(op::Bitcast(op::GetTupleElement(
+                            op::Fusion(), 1)))));
+  EXPECT_EQ(entry_root->operand(0)->operand(0)->operand(0)->operand(0),
+            entry_root->operand(1)->operand(0)->operand(0)->operand(0));
+}
+
+TEST_F(HorizontalFusionTest, FusesIndependentReductions) {
+  auto module = ParseAndReturnVerifiedModule(R"(
+ HloModule FusesIndependentReductions
+
+ add {
+   lhs = f32[] parameter(0)
+   rhs = f32[] parameter(1)
+   ROOT add = f32[] add(lhs, rhs)
+ }
+
+ fused_reduce.1 {
+   arg.1 = f32[32,512]{1,0} parameter(0)
+   zero = f32[] constant(0)
+   ROOT reduce.1 = f32[32]{0} reduce(arg.1, zero), dimensions={1}, to_apply=add
+ }
+
+ fused_reduce.2 {
+   arg.1 = f32[32,512]{1,0} parameter(0)
+   mul = f32[32,512]{1,0} multiply(arg.1, arg.1)
+   zero = f32[] constant(0)
+   ROOT reduce.2 = f32[32]{0} reduce(mul, zero), dimensions={1}, to_apply=add
+ }
+
+ ENTRY entry_computation {
+   arg.1 = f32[32,512]{1,0} parameter(0)
+   arg.2 = f32[32,512]{1,0} parameter(1)
+   fusion.1 = f32[32]{0} fusion(arg.1), kind=kInput, calls=fused_reduce.1
+   fusion.2 = f32[32]{0} fusion(arg.2), kind=kInput, calls=fused_reduce.2
+   ROOT tuple.1 = (f32[32]{0}, f32[32]{0}) tuple(fusion.1, fusion.2)
+ }
+)")
+                    .ValueOrDie();
+
+  EXPECT_TRUE(GpuHorizontalFusion().Run(module.get()).ValueOrDie());
+
+  const HloInstruction* entry_root =
+      module->entry_computation()->root_instruction();
+  EXPECT_THAT(entry_root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                                    op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = entry_root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, entry_root->operand(1)->operand(0));
+  ASSERT_TRUE(fusion->IsMultiOutputFusion());
+  EXPECT_THAT(fusion->fused_expression_root(),
+              op::Tuple(op::Reduce(), op::Reduce()));
+
+  EXPECT_TRUE(
+      RunAndCompareNoHloPasses(std::move(module), ErrorSpec{1e-5, 1e-5}));
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
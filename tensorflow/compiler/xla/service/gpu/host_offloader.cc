@@ -0,0 +1,274 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_memory_scheduler.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/memory_space_assignment.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace xla {
+namespace gpu {
+
+namespace {
+
+// The device model of the cost-aware stream assignment.
+constexpr float kFlopsPerSecond = 1e13;
+constexpr float kTranscendentalsPerSecond = 1e12;
+constexpr float kDeviceBytesPerSecond = 5e11;
+
+// The bandwidth of copies between device memory and pinned host memory, about
+// that of a PCIe 3.0 x16 link.
+constexpr float kHostCopyBytesPerSecond = 1.2e10;
+
+// Smaller buffers do not save enough memory to be worth their copies.
+constexpr int64 kMinOffloadBytes = 1 << 20;
+
+// Returns true if `hlo` does not define a buffer of its own, but reuses those
+// of its operands.
+bool IsAliasing(const HloInstruction& hlo) {
+  return hlo.opcode() == HloOpcode::kBitcast ||
+         hlo.opcode() == HloOpcode::kGetTupleElement ||
+         hlo.opcode() == HloOpcode::kTuple;
+}
+
+// A buffer of the entry computation, live from the position of the instruction
+// that defines it in the schedule to the position of its last use, inclusive.
+struct Buffer {
+  HloInstruction* instruction;
+  int64 size;
+  int64 start;
+  int64 end;
+};
+
+// An offload of `buffer` to the host after its use at position `last_use`,
+// and back to the device after position `copy_back_after`, for its uses from
+// position `next_use` on.
+struct Offload {
+  const Buffer* buffer;
+  int64 last_use;
+  int64 copy_back_after;
+  int64 next_use;
+};
+
+}  // namespace
+
+StatusOr<bool> HostOffloader::Run(HloModule* module) {
+  HloComputation* entry = module->entry_computation();
+  TF_ASSIGN_OR_RETURN(
+      HloSchedule schedule,
+      ScheduleModule(module, [this](const BufferValue& buffer) {
+        return size_function_(buffer.shape());
+      }));
+  TF_RETURN_IF_ERROR(module->set_schedule(schedule));
+  auto clear_schedule =
+      tensorflow::gtl::MakeCleanup([module] { module->clear_schedule(); });
+
+  HloCostAnalysis cost_analysis(size_function_);
+  cost_analysis.set_flops_per_second(kFlopsPerSecond);
+  cost_analysis.set_transcendentals_per_second(kTranscendentalsPerSecond);
+  cost_analysis.set_bytes_per_second(kDeviceBytesPerSecond);
+  Status status = entry->Accept(&cost_analysis);
+  if (!status.ok()) {
+    VLOG(1) << "Not offloading buffers to the host: " << status;
+    return false;
+  }
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<MemorySpaceAssignmentCostAnalysis> msa_cost_analysis,
+      MemorySpaceAssignmentCostAnalysis::Create(
+          cost_analysis, kHostCopyBytesPerSecond, kDeviceBytesPerSecond,
+          *module));
+
+  const std::vector<HloInstruction*>& sequence =
+      schedule.sequence(entry).instructions();
+  const int64 num_positions = sequence.size();
+  absl::flat_hash_map<const HloInstruction*, int64> positions;
+  // elapsed_before[i] is the estimated time it takes to run the first i
+  // instructions of the schedule.
+  std::vector<float> elapsed_before(num_positions + 1, 0);
+  for (int64 i = 0; i < num_positions; ++i) {
+    const HloInstruction* hlo = sequence[i];
+    positions[hlo] = i;
+    float elapsed = 0;
+    if (!IsAliasing(*hlo) && hlo->opcode() != HloOpcode::kParameter &&
+        hlo->opcode() != HloOpcode::kConstant) {
+      elapsed = msa_cost_analysis->GetInstructionElapsed(*hlo);
+    }
+    elapsed_before[i + 1] = elapsed_before[i] + elapsed;
+  }
+  auto elapsed_between = [&](int64 first, int64 last) {
+    return first > last ? 0 : elapsed_before[last + 1] - elapsed_before[first];
+  };
+
+  // The end of the live range of the buffers defined by `hlo`, which are live
+  // out if `hlo` reaches the root through instructions that alias them.
+  std::function<int64(const HloInstruction*)> live_range_end =
+      [&](const HloInstruction* hlo) {
+        if (hlo == entry->root_instruction()) {
+          return num_positions;
+        }
+        int64 end = positions.at(hlo);
+        for (const HloInstruction* user : hlo->users()) {
+          end = std::max(end, IsAliasing(*user) ? live_range_end(user)
+                                                : positions.at(user));
+        }
+        return end;
+      };
+
+  std::vector<Buffer> buffers;
+  for (HloInstruction* hlo : sequence) {
+    if (IsAliasing(*hlo)) {
+      continue;
+    }
+    int64 size = 0;
+    ShapeUtil::ForEachSubshape(
+        hlo->shape(), [&](const Shape& subshape, const ShapeIndex& /*index*/) {
+          if (subshape.IsArray()) {
+            size += size_function_(subshape);
+          }
+        });
+    const bool whole_program = hlo->opcode() == HloOpcode::kParameter ||
+                               hlo->opcode() == HloOpcode::kConstant;
+    buffers.push_back(
+        {hlo, size, whole_program ? 0 : positions.at(hlo),
+         whole_program ? num_positions : live_range_end(hlo)});
+  }
+
+  // usage[i] is the estimated device memory in use while the instruction at
+  // position i runs.
+  std::vector<int64> usage(num_positions + 1, 0);
+  for (const Buffer& buffer : buffers) {
+    for (int64 i = buffer.start; i <= buffer.end; ++i) {
+      usage[i] += buffer.size;
+    }
+  }
+
+  // Returns the offload that moves `buffer` out of device memory while the
+  // instruction at `position` runs, if there is one worth its copies.
+  auto find_offload = [&](const Buffer& buffer,
+                          int64 position) -> absl::optional<Offload> {
+    const HloInstruction* hlo = buffer.instruction;
+    if (!hlo->shape().IsArray() || hlo->opcode() == HloOpcode::kParameter ||
+        hlo->opcode() == HloOpcode::kConstant ||
+        hlo->shape().layout().memory_space() != 0 ||
+        buffer.size < kMinOffloadBytes || buffer.end >= num_positions ||
+        absl::c_any_of(hlo->users(), [](const HloInstruction* user) {
+          return IsAliasing(*user);
+        })) {
+      return absl::nullopt;
+    }
+    // The gap between uses that `position` falls into.
+    int64 last_use = buffer.start;
+    int64 next_use = buffer.end;
+    for (const HloInstruction* user : hlo->users()) {
+      int64 use = positions.at(user);
+      if (use < position) {
+        last_use = std::max(last_use, use);
+      } else {
+        next_use = std::min(next_use, use);
+      }
+    }
+    const float copy_elapsed =
+        msa_cost_analysis->GetAsyncCopyElapsed(hlo->shape());
+    if (position <= last_use || position >= next_use ||
+        elapsed_between(last_use + 1, next_use - 1) < 2 * copy_elapsed) {
+      return absl::nullopt;
+    }
+    // Copy back as late as possible, but early enough that the instructions
+    // up to the next use hide the copy.
+    int64 copy_back_after = last_use + 1;
+    for (int64 i = next_use - 1; i > last_use + 1; --i) {
+      if (elapsed_between(i + 1, next_use - 1) >= copy_elapsed) {
+        copy_back_after = i;
+        break;
+      }
+    }
+    if (position > copy_back_after) {
+      return absl::nullopt;
+    }
+    return Offload{&buffer, last_use, copy_back_after, next_use};
+  };
+
+  std::vector<Offload> offloads;
+  absl::flat_hash_map<const Buffer*, bool> offloaded;
+  while (true) {
+    const int64 peak_position =
+        std::max_element(usage.begin(), usage.end()) - usage.begin();
+    if (usage[peak_position] <= memory_limit_bytes_) {
+      break;
+    }
+    absl::optional<Offload> best;
+    for (const Buffer& buffer : buffers) {
+      if (offloaded[&buffer]) {
+        continue;
+      }
+      absl::optional<Offload> offload = find_offload(buffer, peak_position);
+      if (offload && (!best || offload->buffer->size > best->buffer->size)) {
+        best = offload;
+      }
+    }
+    if (!best) {
+      VLOG(1) << "Estimated peak device memory of " << usage[peak_position]
+              << " bytes at " << sequence[peak_position]->name()
+              << " is over the limit of " << memory_limit_bytes_
+              << " bytes, but no buffer can be offloaded there";
+      break;
+    }
+    offloaded[best->buffer] = true;
+    for (int64 i = best->last_use + 1; i <= best->copy_back_after; ++i) {
+      usage[i] -= best->buffer->size;
+    }
+    offloads.push_back(*best);
+  }
+
+  for (const Offload& offload : offloads) {
+    HloInstruction* hlo = offload.buffer->instruction;
+    VLOG(2) << "Offloading " << hlo->name() << " to the host from "
+            << sequence[offload.last_use]->name() << " to "
+            << sequence[offload.next_use]->name();
+    const std::vector<HloInstruction*> users = hlo->users();
+    Shape host_shape = hlo->shape();
+    host_shape.mutable_layout()->set_memory_space(kHostMemorySpace);
+    HloInstruction* to_host = entry->AddInstruction(
+        HloInstruction::CreateUnary(host_shape, HloOpcode::kCopy, hlo));
+    HloInstruction* to_device = entry->AddInstruction(
+        HloInstruction::CreateUnary(hlo->shape(), HloOpcode::kCopy, to_host));
+    HloInstruction* copy_back_after = sequence[offload.copy_back_after];
+    TF_RETURN_IF_ERROR(copy_back_after->AddControlDependencyTo(to_device));
+    for (HloInstruction* user : users) {
+      if (positions.at(user) >= offload.next_use) {
+        TF_RETURN_IF_ERROR(hlo->ReplaceUseWith(user, to_device));
+      }
+    }
+  }
+  return !offloads.empty();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,62 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+namespace gpu {
+
+// Offloads buffers of the entry computation to pinned host memory
+// (kHostMemorySpace) while they are not used, until the estimated peak device
+// memory of the computation is at most `memory_limit_bytes`, as an
+// alternative to rematerialization for fitting bigger models.
+//
+// The pass simulates the memory-minimizing schedule that the GPU backend uses
+// for a single stream, and repeatedly offloads the largest buffer that is live
+// but unused at the peak.  A buffer is only offloaded across a gap between two
+// of its uses if the instructions in the gap take, according to
+// MemorySpaceAssignmentCostAnalysis, at least as long as copying the buffer
+// out and back in, so that the copies can be hidden behind them.  The buffer
+// is copied to the host after the use before the gap, and copied back once the
+// instructions that hide the copy back have run, which a control dependency
+// enforces.
+//
+// This pass must run after fusion, so that the copies are not fused into their
+// neighbours.
+class HostOffloader : public HloModulePass {
+ public:
+  HostOffloader(int64 memory_limit_bytes,
+                HloCostAnalysis::ShapeSizeFunction size_function)
+      : memory_limit_bytes_(memory_limit_bytes),
+        size_function_(std::move(size_function)) {}
+  ~HostOffloader() override = default;
+  absl::string_view name() const override { return "host-offloader"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+ private:
+  const int64 memory_limit_bytes_;
+  const HloCostAnalysis::ShapeSizeFunction size_function_;
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_HOST_OFFLOADER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/host_offloader.h"
+
+#include "tensorflow/compiler/xla/service/gpu/gpu_constants.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+namespace op = xla::testing::opcode_matchers;
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+}
+
+class HostOffloaderTest : public HloTestBase {};
+
+// `a` is used by the first dot and the root, and the four dots in between
+// take, in the cost model, longer than copying it out and back in.  All the
+// buffers take 4MiB, and the peak of 20MiB is while the dots run.
+const char* const kLongGapModule = R"(
+HloModule LongGap
+
+ENTRY entry {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  a = f32[1024,1024] exponential(p0)
+  d0 = f32[1024,1024] dot(a, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d1 = f32[1024,1024] dot(d0, d0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d2 = f32[1024,1024] dot(d1, d1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d3 = f32[1024,1024] dot(d2, d2), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d4 = f32[1024,1024] dot(d3, d3), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT r = f32[1024,1024] add(a, d4)
+}
+)";
+
+TEST_F(HostOffloaderTest, OffloadsBufferAcrossLongGap) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kLongGapModule));
+  HostOffloader offloader(/*memory_limit_bytes=*/17 << 20, ShapeSize);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_FALSE(module->has_schedule());
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  EXPECT_THAT(root, op::Add(op::Copy(op::Copy(op::Exp(op::Parameter(0)))),
+                            op::Dot()));
+  const HloInstruction* to_device = root->operand(0);
+  const HloInstruction* to_host = to_device->operand(0);
+  EXPECT_EQ(to_host->shape().layout().memory_space(), kHostMemorySpace);
+  EXPECT_EQ(to_device->shape().layout().memory_space(), 0);
+  // The copy back waits for a dot, rather than running right after the copy
+  // to the host.
+  ASSERT_EQ(to_device->control_predecessors().size(), 1);
+  EXPECT_EQ(to_device->control_predecessors()[0]->opcode(), HloOpcode::kDot);
+  // The first dot still reads `a` from device memory.
+  EXPECT_THAT(to_host->operand(0)->users(),
+              ::testing::UnorderedElementsAre(to_host, op::Dot()));
+}
+
+TEST_F(HostOffloaderTest, DoesNotOffloadUnderTheLimit) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kLongGapModule));
+  HostOffloader offloader(/*memory_limit_bytes=*/64 << 20, ShapeSize);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(HostOffloaderTest, DoesNotOffloadAcrossShortGap) {
+  // The single dot between the uses of `a` does not hide its copies.
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(R"(
+HloModule ShortGap
+
+ENTRY entry {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  a = f32[1024,1024] exponential(p0)
+  d0 = f32[1024,1024] dot(a, p1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  d1 = f32[1024,1024] dot(d0, d0), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT r = f32[1024,1024] add(a, d1)
+}
+)"));
+  HostOffloader offloader(/*memory_limit_bytes=*/1 << 20, ShapeSize);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, offloader.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
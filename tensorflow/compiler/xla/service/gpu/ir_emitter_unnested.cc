@@ -734,8 +734,10 @@ Status IrEmitterUnnested::HandleCopy(HloInstruction* copy) {
   CHECK(ShapeUtil::Compatible(copy->operand(0)->shape(), copy->shape()));
   const BufferAssignment& buffer_assignment =
       ir_emitter_context_->buffer_assignment();
-  if (LayoutUtil::Equal(copy->operand(0)->shape().layout(),
-                        copy->shape().layout()) &&
+  // Copies between memory spaces are plain copies too, since the host buffers
+  // are accessible from the device.
+  if (Layout::Equal().IgnoreMemorySpace()(copy->operand(0)->shape().layout(),
+                                          copy->shape().layout()) &&
       buffer_assignment.GetUniqueTopLevelSlice(copy->operand(0)).ok()) {
     // Copy the operand into the output if it's not the same buffer already.
     auto operand_buffer = GetAllocationSlice(*copy->operand(0));
@@ -20,6 +20,9 @@ limitations under the License.
 #include <fstream>
 
 #include "absl/base/call_once.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Config/llvm-config.h"
 #include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/gpu/cublas_gemm_pad_for_tensor_cores.h"
@@ -46,7 +49,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/cuda_libdevice_path.h"
+#include "tensorflow/core/platform/raw_coding.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/stream_executor/cuda/cuda_diagnostics.h"
@@ -272,6 +278,45 @@ bool MaybeLoadPtxFromFile(const HloModule* module, std::string* ptx) {
   return false;
 }
 
+// Returns the key of the persistent cache entry for the PTX and cubin of
+// `llvm_module`, which covers everything they are compiled from: the
+// unoptimized IR, the LLVM version, the compute capability, the libdevice
+// directory and the debug options.
+string DiskCacheKey(const llvm::Module& llvm_module,
+                    std::pair<int, int> compute_capability,
+                    const HloModuleConfig& config,
+                    const string& libdevice_dir) {
+  string debug_options;
+  tensorflow::SerializeToStringDeterministic(config.debug_options(),
+                                             &debug_options);
+  return absl::StrCat("nvptx;llvm=", LLVM_VERSION_STRING,
+                      ";sm=", compute_capability.first, ".",
+                      compute_capability.second, ";libdevice=", libdevice_dir,
+                      ";debug_options=", absl::CEscape(debug_options), ";\n",
+                      llvm_ir::DumpModuleToString(llvm_module));
+}
+
+// Persistent cache entries hold the size of the PTX, the PTX and the cubin.
+string EncodeDiskCacheValue(const string& ptx,
+                            const std::vector<uint8>& cubin) {
+  string value;
+  tensorflow::core::PutFixed64(&value, ptx.size());
+  absl::StrAppend(&value, ptx,
+                  absl::string_view(reinterpret_cast<const char*>(cubin.data()),
+                                    cubin.size()));
+  return value;
+}
+
+bool DecodeDiskCacheValue(const string& value, string* ptx,
+                          std::vector<uint8>* cubin) {
+  if (value.size() < sizeof(uint64)) return false;
+  const uint64 ptx_size = tensorflow::core::DecodeFixed64(value.data());
+  if (value.size() - sizeof(uint64) < ptx_size) return false;
+  *ptx = value.substr(sizeof(uint64), ptx_size);
+  cubin->assign(value.begin() + sizeof(uint64) + ptx_size, value.end());
+  return true;
+}
+
 }  // namespace
 
 NVPTXCompiler::NVPTXCompiler()
@@ -317,6 +362,26 @@ NVPTXCompiler::CompileTargetBinary(const HloModule* module,
   }
   VLOG(2) << "Libdevice dir = " << libdevice_dir << "\n";
 
+  // Modules whose PTX is loaded from a file, dumped or passed to a hook are
+  // always compiled, so that the files and the hook see the optimized module.
+  std::shared_ptr<DiskCompilationCache> disk_cache =
+      GetDiskCache(module->config());
+  string disk_cache_key;
+  if (disk_cache != nullptr &&
+      module->config().debug_options().xla_gpu_ptx_file().empty() &&
+      !DumpingEnabledForHloModule(*module) && !user_post_optimization_hook_) {
+    disk_cache_key = DiskCacheKey(*llvm_module, compute_capability,
+                                  module->config(), libdevice_dir);
+    absl::optional<string> value = disk_cache->Lookup(disk_cache_key);
+    std::pair<string, std::vector<uint8>> ptx_and_cubin;
+    if (value.has_value() && DecodeDiskCacheValue(*value, &ptx_and_cubin.first,
+                                                  &ptx_and_cubin.second)) {
+      VLOG(1) << "Loaded PTX and cubin of " << module->name()
+              << " from the persistent cache";
+      return std::move(ptx_and_cubin);
+    }
+  }
+
   string ptx;
   if (!MaybeLoadPtxFromFile(module, &ptx)) {
     XLA_SCOPED_LOGGING_TIMER(
@@ -340,10 +405,29 @@ NVPTXCompiler::CompileTargetBinary(const HloModule* module,
       stream_exec, ptx, compute_capability.first, compute_capability.second,
       module->config());
 
+  // Without a cubin, e.g. if ptxas was not found, the driver compiles the PTX;
+  // that is not persisted, so that a later process with ptxas uses it.
+  if (!disk_cache_key.empty() && !cubin.empty()) {
+    disk_cache->Insert(disk_cache_key, EncodeDiskCacheValue(ptx, cubin));
+  }
+
   return std::pair<std::string, std::vector<uint8>>(std::move(ptx),
                                                     std::move(cubin));
 }
 
+std::shared_ptr<DiskCompilationCache> NVPTXCompiler::GetDiskCache(
+    const HloModuleConfig& config) {
+  const string& dir = config.debug_options().xla_gpu_persistent_cache_dir();
+  if (dir.empty()) return nullptr;
+  tensorflow::mutex_lock lock(mutex_);
+  if (disk_cache_ == nullptr || disk_cache_dir_ != dir) {
+    disk_cache_ = std::make_shared<DiskCompilationCache>(
+        dir, config.debug_options().xla_gpu_persistent_cache_max_bytes());
+    disk_cache_dir_ = dir;
+  }
+  return disk_cache_;
+}
+
 std::vector<uint8> NVPTXCompiler::CompileGpuAsmOrGetCachedResult(
     se::StreamExecutor* stream_exec, const string& ptx, int cc_major,
     int cc_minor, const HloModuleConfig& hlo_module_config) {
@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "absl/container/node_hash_map.h"
 #include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/disk_compilation_cache.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_compiler.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/core/lib/hash/hash.h"
@@ -67,6 +68,15 @@ class NVPTXCompiler : public GpuCompiler {
 
   // Tries to compile the given ptx string to cubin.  Returns a vector with the
   // compiled cubin.  If compilation was unsuccessful, returns an empty vector.
+  // Returns the persistent cache configured by the debug options of `config`,
+  // or nullptr if there is none.
+  std::shared_ptr<DiskCompilationCache> GetDiskCache(
+      const HloModuleConfig& config);
+
+  // The persistent cache of PTX and cubin, and the directory it is in.
+  std::shared_ptr<DiskCompilationCache> disk_cache_ TF_GUARDED_BY(mutex_);
+  string disk_cache_dir_ TF_GUARDED_BY(mutex_);
+
   std::vector<uint8> CompileGpuAsmOrGetCachedResult(
       se::StreamExecutor* stream_exec, const string& ptx, int cc_major,
       int cc_minor, const HloModuleConfig& hlo_module_config);
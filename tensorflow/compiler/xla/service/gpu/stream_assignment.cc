@@ -15,12 +15,20 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/gpu/stream_assignment.h"
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_format.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/gpu/ir_emission_utils.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/core/platform/random.h"
 
 namespace xla {
@@ -44,6 +52,51 @@ void StreamAssignment::AssignStreamToHlo(const HloInstruction* hlo,
   VLOG(2) << "Assign stream #" << stream_num << " to " << hlo->ToString();
 }
 
+void StreamAssignment::SetEstimatedTime(const HloInstruction* hlo,
+                                        double start_us, double end_us) {
+  CHECK(HasStreamAssigned(*hlo));
+  hlo_to_estimated_time_[hlo] = {start_us, end_us};
+}
+
+std::string StreamAssignment::EstimatedTimelineToString() const {
+  if (hlo_to_estimated_time_.empty()) {
+    return "";
+  }
+  struct Interval {
+    double start_us;
+    double end_us;
+    const HloInstruction* hlo;
+  };
+  std::vector<std::vector<Interval>> timelines(stream_count_);
+  double total_us = 0;
+  for (const auto& pair : hlo_to_estimated_time_) {
+    timelines[StreamNumberForHlo(*pair.first)].push_back(
+        {pair.second.first, pair.second.second, pair.first});
+    total_us = std::max(total_us, pair.second.second);
+  }
+  std::string result =
+      absl::StrFormat("Estimated run time: %.2fus\n", total_us);
+  for (int stream_num = 0; stream_num < stream_count_; ++stream_num) {
+    std::vector<Interval>& timeline = timelines[stream_num];
+    absl::c_sort(timeline, [](const Interval& a, const Interval& b) {
+      return std::make_pair(a.start_us, a.hlo->name()) <
+             std::make_pair(b.start_us, b.hlo->name());
+    });
+    double busy_us = 0;
+    for (const Interval& interval : timeline) {
+      busy_us += interval.end_us - interval.start_us;
+    }
+    absl::StrAppendFormat(&result, "Stream %d (%.2fus busy):\n", stream_num,
+                          busy_us);
+    for (const Interval& interval : timeline) {
+      absl::StrAppendFormat(&result, "  [%10.2f, %10.2f) %s\n",
+                            interval.start_us, interval.end_us,
+                            interval.hlo->name());
+    }
+  }
+  return result;
+}
+
 namespace {
 
 // Returns whether the two HLOs can run concurrently, i.e., neither is a
@@ -122,9 +175,162 @@ int ComputeStreamToAssign(
   return stream_assignment.StreamCount();
 }
 
+// Nominal throughputs of a GPU, from which the run times of instructions are
+// estimated for stream assignment.  Only their ratios to each other and to the
+// overheads below matter.
+constexpr float kFlopsPerSecond = 1e13;
+constexpr float kTranscendentalsPerSecond = 1e12;
+constexpr float kBytesPerSecond = 5e11;
+
+// The cost of launching a thunk, and of making a stream wait for an event
+// recorded on another stream, in microseconds.
+constexpr double kLaunchOverheadUs = 5;
+constexpr double kCrossStreamWaitUs = 2;
+
+int64 ShapeSizeBytes(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, sizeof(void*));
+}
+
+// Returns the estimated run time of `hlo` in microseconds.
+double EstimateRunTimeUs(const HloInstruction& hlo,
+                         const HloCostAnalysis& cost_analysis) {
+  double seconds = cost_analysis.optimal_seconds(hlo);
+  if (seconds < 0) {
+    // HloCostAnalysis does not know what custom calls, e.g. library GEMMs and
+    // convolutions, do; assume that they read their operands and write their
+    // result once.
+    int64 bytes = 0;
+    for (const HloInstruction* operand : hlo.operands()) {
+      ShapeUtil::ForEachSubshape(
+          operand->shape(), [&](const Shape& subshape, const ShapeIndex&) {
+            if (subshape.IsArray()) {
+              bytes += ShapeSizeBytes(subshape);
+            }
+          });
+    }
+    ShapeUtil::ForEachSubshape(
+        hlo.shape(), [&](const Shape& subshape, const ShapeIndex&) {
+          if (subshape.IsArray()) {
+            bytes += ShapeSizeBytes(subshape);
+          }
+        });
+    seconds = bytes / kBytesPerSecond;
+  }
+  return kLaunchOverheadUs + seconds * 1e6;
+}
+
+// Assigns the instructions of the entry computation to at most `max_streams`
+// streams, by simulating their execution in post order: each instruction is
+// assigned to the stream on which it could start the earliest, given when its
+// operands finish and when the stream becomes idle.  Returns null if the run
+// times of the instructions cannot be estimated.
+std::unique_ptr<StreamAssignment> AssignStreamsByCost(const HloModule& module,
+                                                      int max_streams) {
+  const HloComputation& computation = *module.entry_computation();
+  HloCostAnalysis cost_analysis(ShapeSizeBytes);
+  cost_analysis.set_flops_per_second(kFlopsPerSecond);
+  cost_analysis.set_transcendentals_per_second(kTranscendentalsPerSecond);
+  cost_analysis.set_bytes_per_second(kBytesPerSecond);
+  Status status = computation.Accept(&cost_analysis);
+  if (!status.ok()) {
+    LOG(WARNING) << "Falling back to the default stream assignment: "
+                 << status;
+    return nullptr;
+  }
+
+  auto stream_assignment = absl::make_unique<StreamAssignment>();
+  // The time at which each stream finishes the instructions assigned to it so
+  // far, and at which each instruction finishes.
+  std::vector<double> stream_end_us;
+  absl::flat_hash_map<const HloInstruction*, double> hlo_end_us;
+  // All RNG instructions go to the same stream, see AssignStreams.
+  int stream_num_for_rng = kInvalidStreamNum;
+  for (const auto* hlo : computation.MakeInstructionPostOrder()) {
+    if (hlo->opcode() == HloOpcode::kParameter ||
+        hlo->opcode() == HloOpcode::kConstant) {
+      hlo_end_us[hlo] = 0;
+      continue;
+    }
+
+    std::vector<const HloInstruction*> predecessors(hlo->operands().begin(),
+                                                    hlo->operands().end());
+    absl::c_copy(hlo->control_predecessors(),
+                 std::back_inserter(predecessors));
+    // Prefer the stream of the operand that finishes last, which saves a wait.
+    int preferred_stream_num = 0;
+    double latest_predecessor_end_us = -1;
+    for (const HloInstruction* predecessor : predecessors) {
+      double end_us = FindOrDie(hlo_end_us, predecessor);
+      if (stream_assignment->HasStreamAssigned(*predecessor) &&
+          end_us > latest_predecessor_end_us) {
+        latest_predecessor_end_us = end_us;
+        preferred_stream_num =
+            stream_assignment->StreamNumberForHlo(*predecessor);
+      }
+    }
+    auto start_time_on_stream = [&](int stream_num) {
+      double start_us = stream_num < static_cast<int>(stream_end_us.size())
+                            ? stream_end_us[stream_num]
+                            : 0;
+      for (const HloInstruction* predecessor : predecessors) {
+        double ready_us = FindOrDie(hlo_end_us, predecessor);
+        if (stream_assignment->HasStreamAssigned(*predecessor) &&
+            stream_assignment->StreamNumberForHlo(*predecessor) !=
+                stream_num) {
+          ready_us += kCrossStreamWaitUs;
+        }
+        start_us = std::max(start_us, ready_us);
+      }
+      return start_us;
+    };
+
+    int stream_num = preferred_stream_num;
+    if (hlo->opcode() == HloOpcode::kRng &&
+        IsStreamNumValid(stream_num_for_rng)) {
+      stream_num = stream_num_for_rng;
+    } else {
+      // Opening a new stream is only worth it if it lets `hlo` start sooner.
+      int candidate_count =
+          std::min<int>(max_streams, stream_end_us.size() + 1);
+      double best_start_us = start_time_on_stream(stream_num);
+      for (int candidate = 0; candidate < candidate_count; ++candidate) {
+        double start_us = start_time_on_stream(candidate);
+        if (start_us < best_start_us) {
+          best_start_us = start_us;
+          stream_num = candidate;
+        }
+      }
+    }
+    if (hlo->opcode() == HloOpcode::kRng) {
+      stream_num_for_rng = stream_num;
+    }
+
+    double start_us = start_time_on_stream(stream_num);
+    double end_us = start_us + EstimateRunTimeUs(*hlo, cost_analysis);
+    if (stream_num >= static_cast<int>(stream_end_us.size())) {
+      stream_end_us.resize(stream_num + 1, 0);
+    }
+    stream_end_us[stream_num] = end_us;
+    hlo_end_us[hlo] = end_us;
+    stream_assignment->AssignStreamToHlo(hlo, stream_num);
+    stream_assignment->SetEstimatedTime(hlo, start_us, end_us);
+  }
+  return stream_assignment;
+}
+
 }  // namespace
 
 std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module) {
+  const auto& debug_options = module.config().debug_options();
+  if (debug_options.xla_gpu_max_streams() > 0 &&
+      !debug_options.xla_gpu_disable_multi_streaming() &&
+      !debug_options.xla_gpu_use_random_streams()) {
+    if (auto stream_assignment =
+            AssignStreamsByCost(module, debug_options.xla_gpu_max_streams())) {
+      return stream_assignment;
+    }
+  }
+
   auto stream_assignment = absl::make_unique<StreamAssignment>();
   const HloComputation& computation = *module.entry_computation();
   std::unique_ptr<HloReachabilityMap> reachability =
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_STREAM_ASSIGNMENT_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_STREAM_ASSIGNMENT_H_
 
+#include <string>
+
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -32,12 +34,29 @@ class StreamAssignment {
   // `hlo` needs to outlive this StreamAssignment object.
   void AssignStreamToHlo(const HloInstruction* hlo, int stream_num);
 
+  // Records that `hlo`, which must have a stream assigned, is estimated to run
+  // from `start_us` to `end_us` microseconds after the start of the program.
+  void SetEstimatedTime(const HloInstruction* hlo, double start_us,
+                        double end_us);
+
+  // Returns the estimated execution timeline of each stream, or an empty
+  // string if no times have been estimated.
+  std::string EstimatedTimelineToString() const;
+
  private:
   int stream_count_ = 1;  // At least the main stream.
   absl::flat_hash_map<const HloInstruction*, int> hlo_to_stream_number_;
+  absl::flat_hash_map<const HloInstruction*, std::pair<double, double>>
+      hlo_to_estimated_time_;
 };
 
 // Assigns GPU streams to instructions in `module`.
+//
+// If xla_gpu_max_streams is positive, the instructions are assigned to at most
+// that many streams by simulating their execution with the run times that
+// HloCostAnalysis estimates: each instruction goes to the stream on which it
+// could start the earliest, so that independent kernels, copies and
+// collectives overlap.  Otherwise only concurrent GEMMs get separate streams.
 std::unique_ptr<StreamAssignment> AssignStreams(const HloModule& module);
 
 }  // namespace gpu
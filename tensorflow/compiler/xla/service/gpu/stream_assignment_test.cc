@@ -139,5 +139,60 @@ TEST_F(StreamAssignmentTest, LatticeMatMul) {
             assignment->StreamNumberForHlo(*d31));
 }
 
+TEST_F(StreamAssignmentTest, CostAwareAssignmentOverlapsIndependentOps) {
+  const char* hlo_text = R"(
+HloModule m
+
+ENTRY main {
+  p0 = f32[1024,1024] parameter(0)
+  p1 = f32[1024,1024] parameter(1)
+  p2 = f32[1024,1024] parameter(2)
+  e0 = f32[1024,1024] exponential(p0)
+  e1 = f32[1024,1024] exponential(p1)
+  e2 = f32[1024,1024] exponential(p2)
+  a0 = f32[1024,1024] add(e0, e1)
+  ROOT a1 = f32[1024,1024] add(a0, e2)
+}
+)";
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  debug_options.set_xla_gpu_max_streams(2);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_EQ(assignment->StreamCount(), 2);
+  const HloInstruction* e0 = FindInstruction(module.get(), "e0");
+  const HloInstruction* e1 = FindInstruction(module.get(), "e1");
+  EXPECT_NE(assignment->StreamNumberForHlo(*e0),
+            assignment->StreamNumberForHlo(*e1));
+  EXPECT_FALSE(assignment->EstimatedTimelineToString().empty());
+}
+
+TEST_F(StreamAssignmentTest, CostAwareAssignmentKeepsChainsOnOneStream) {
+  const char* hlo_text = R"(
+HloModule m
+
+ENTRY main {
+  p0 = f32[1024] parameter(0)
+  e0 = f32[1024] exponential(p0)
+  e1 = f32[1024] exponential(e0)
+  ROOT e2 = f32[1024] exponential(e1)
+}
+)";
+  HloModuleConfig config;
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_disable_multi_streaming(false);
+  debug_options.set_xla_gpu_max_streams(4);
+  config.set_debug_options(debug_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_text, config));
+
+  std::unique_ptr<StreamAssignment> assignment = AssignStreams(*module);
+  EXPECT_EQ(assignment->StreamCount(), 1);
+}
+
 }  // namespace gpu
 }  // namespace xla
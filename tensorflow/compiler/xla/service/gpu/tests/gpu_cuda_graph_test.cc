@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class GpuCudaGraphTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_gpu_enable_cuda_graphs(true);
+    return debug_options;
+  }
+};
+
+const char* const kHloText = R"(
+HloModule m
+
+add {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  ROOT add = f32[] add(a, b)
+}
+
+ENTRY main {
+  p0 = f32[128] parameter(0)
+  p1 = f32[128] parameter(1)
+  mul = f32[128] multiply(p0, p1)
+  exp = f32[128] exponential(mul)
+  zero = f32[] constant(0)
+  sum = f32[] reduce(exp, zero), dimensions={0}, to_apply=add
+  ROOT tuple = (f32[128], f32[]) tuple(mul, sum)
+}
+)";
+
+TEST_F(GpuCudaGraphTest, Capture) {
+  EXPECT_TRUE(RunAndCompare(kHloText, ErrorSpec{1e-5, 1e-5}));
+}
+
+// Executes the same executable with the same buffers several times, so that
+// the later executions launch the captured graph.
+TEST_F(GpuCudaGraphTest, Replay) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  Literal p0 = LiteralUtil::CreateR1<float>(std::vector<float>(128, 0.5f));
+  Literal p1 = LiteralUtil::CreateR1<float>(std::vector<float>(128, 2.0f));
+  Literal expected = LiteralUtil::MakeTupleOwned(
+      LiteralUtil::CreateR1<float>(std::vector<float>(128, 1.0f)),
+      LiteralUtil::CreateR0<float>(128 * std::exp(1.0f)));
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Executable> executable,
+      test_runner_.CreateExecutable(std::move(module),
+                                    /*run_hlo_passes=*/true));
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<ScopedShapedBuffer> arguments,
+                          test_runner_.TransferLiteralsToDevice({&p0, &p1}));
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        ExecutionOutput output,
+        test_runner_.ExecuteWithDeviceBuffers(executable.get(), arguments));
+    TF_ASSERT_OK_AND_ASSIGN(
+        Literal result,
+        test_runner_.TransferLiteralFromDevice(output.Result()));
+    EXPECT_TRUE(LiteralTestUtil::Near(expected, result, ErrorSpec{1e-4}));
+  }
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
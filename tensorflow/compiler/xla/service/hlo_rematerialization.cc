@@ -30,6 +30,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/primitive_util.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
+#include "tensorflow/compiler/xla/service/heap_simulator.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_dce.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -135,6 +137,10 @@ struct Item {
   // The buffers used by this instruction.
   BufferIdList buffers_used;
 
+  // The flops and transcendental operations the instruction performs, which
+  // are only computed for the kMinimizeCompute objective.
+  int64 flops = 0;
+
  private:
   friend class InstructionList;
 
@@ -371,7 +377,8 @@ class MemoryUsageTracker {
       const HloRematerialization::CompactShapeFunction& compact_shape_function,
       const TuplePointsToAnalysis& points_to_analysis,
       const InstructionList& instruction_list,
-      HloRematerialization::RematerializationMode mode);
+      HloRematerialization::RematerializationMode mode,
+      HloRematerialization::RematerializationObjective objective);
 
   // Starts the placement of the given instruction. This adds the sizes of the
   // LogicalBuffers defined by the instruction to the current memory
@@ -381,19 +388,21 @@ class MemoryUsageTracker {
   // EndInstruction memory for dead operand(s) is freed.
   Status BeginInstruction(Item* item);
 
-  int64 RematerializationCost(const std::vector<Item*>& items,
-                              int64 memory_reduced, int64 memory_limit_bytes) {
+  double RematerializationCost(const std::vector<Item*>& items,
+                               int64 memory_reduced, int64 memory_limit_bytes) {
     // If none of the users of any 'item' have been placed in the
     // sequence (as tracked by memory_tracker), then rematerialization of
     // 'item' is a zero-cost move of 'item->instruction' in the sequence.
+    // Otherwise the items with placed users are recomputed.
     bool zero_cost_move = true;
+    int64 recomputed_flops = 0;
     for (auto* item : items) {
       auto* instruction = item->instruction;
       if (absl::c_any_of(
               instruction->users(),
               [this](const HloInstruction* inst) { return IsPlaced(inst); })) {
         zero_cost_move = false;
-        break;
+        recomputed_flops += item->flops;
       }
     }
     if (zero_cost_move) {
@@ -401,6 +410,11 @@ class MemoryUsageTracker {
     }
 
     CHECK_GT(memory_reduced, 0);
+    if (objective_ ==
+        HloRematerialization::RematerializationObjective::kMinimizeCompute) {
+      // Return the flops added per byte freed.
+      return static_cast<double>(recomputed_flops) / memory_reduced;
+    }
     // Return the inverse of the benefit of rematerialization.
     return memory_limit_bytes / memory_reduced;
   }
@@ -631,6 +645,7 @@ class MemoryUsageTracker {
   Item* in_progress_item_ = nullptr;
 
   HloRematerialization::RematerializationMode mode_;
+  HloRematerialization::RematerializationObjective objective_;
   // All buffers in the computation.
   std::vector<Buffer> buffers_;
 };
@@ -641,12 +656,14 @@ MemoryUsageTracker::MemoryUsageTracker(
     const HloRematerialization::CompactShapeFunction& compact_shape_function,
     const TuplePointsToAnalysis& points_to_analysis,
     const InstructionList& instruction_list,
-    HloRematerialization::RematerializationMode mode)
+    HloRematerialization::RematerializationMode mode,
+    HloRematerialization::RematerializationObjective objective)
     : computation_(computation),
       instruction_list_(instruction_list),
       size_function_(size_function),
       compact_shape_function_(compact_shape_function),
-      mode_(mode) {
+      mode_(mode),
+      objective_(objective) {
   PointsToSet::BufferSet live_out_set =
       points_to_analysis.GetPointsToSet(computation_->root_instruction())
           .CreateFlattenedSet();
@@ -1180,7 +1197,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
     absl::flat_hash_map<const HloInstruction*, bool>* rematerializable_map,
     int min_block_size, int max_block_size) {
   std::vector<Item*> best_items;
-  int64 best_cost = 0;
+  double best_cost = 0;
   RematStrategy best_strategy;
 
   VLOG(5) << "Picking candidate block with size in [" << min_block_size << ", "
@@ -1224,7 +1241,15 @@ MemoryUsageTracker::PickRematerializationCandidates(
               const int64 memory_reduced =
                   MemoryReducedIfCompressed(item, compact_shape);
               if (memory_reduced > 0) {
-                const int64 cost = memory_limit_bytes / memory_reduced;
+                // Compression copies each element to the compact shape and
+                // back, which is not recomputation, but is not free either.
+                const double cost =
+                    objective_ == HloRematerialization::
+                                      RematerializationObjective::
+                                          kMinimizeCompute
+                        ? 2.0 * ShapeUtil::ElementsIn(original_shape) /
+                              memory_reduced
+                        : memory_limit_bytes / memory_reduced;
                 if (best_items.empty() || cost < best_cost) {
                   VLOG(3) << "candidate " << candidate->name() << "("
                           << candidate->ToShortString() << ")"
@@ -1268,7 +1293,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
       const int64 memory_reduced = MemoryReducedIfRematerialized(block);
 
       if (memory_reduced > 0) {
-        const int cost =
+        const double cost =
             RematerializationCost(block, memory_reduced, memory_limit_bytes);
 
         VLOG(5) << "Candidate block of size " << block.size()
@@ -1312,10 +1337,12 @@ bool MemoryUsageTracker::HasUnplacedUsers(Item* item) const {
   return false;
 }
 
+// Rematerializes the given block of instructions, and adds the flops of the
+// instructions that are recomputed rather than moved to '*added_flops'.
 StatusOr<int64> RematerializeInstructions(
     MemoryUsageTracker* memory_tracker, std::vector<Item*>* best_items,
     absl::flat_hash_set<const HloInstruction*>* remat_move_instructions,
-    InstructionList* instruction_list) {
+    InstructionList* instruction_list, int64* added_flops) {
   int64 net_instructions_added = 0;
   int64 total_memory_saved =
       memory_tracker->MemoryReducedIfRematerialized(*best_items);
@@ -1347,6 +1374,7 @@ StatusOr<int64> RematerializeInstructions(
     }
 
     Item* remat_item = instruction_list->CreateItem(remat);
+    remat_item->flops = best_item->flops;
 
     // Replace each remaining use of 'best' with the rematerialization.
     std::vector<HloInstruction*> best_users_copy = best->users();
@@ -1409,6 +1437,7 @@ StatusOr<int64> RematerializeInstructions(
       remat_move_instructions->insert(remat);
     } else {
       net_instructions_added++;
+      *added_flops += remat_item->flops;
     }
   }
   VLOG(1) << "Rematerializing instructions ["
@@ -1478,6 +1507,8 @@ struct InstructionsAdded {
   // Total count of instructions rematerialized minus number of original
   // instructions that are now dead.
   int net_instructions_added;
+  // The flops of the instructions that are recomputed.
+  int64 added_flops;
 };
 
 // Rematerializes the best block of instructions of size between min_block_size
@@ -1498,6 +1529,7 @@ StatusOr<InstructionsAdded> RematerializeBestBlock(
           min_block_size, max_block_size);
   InstructionsAdded num_instructions_added;
   num_instructions_added.remat_count = best_items.size();
+  num_instructions_added.added_flops = 0;
   if (best_items.empty()) {
     num_instructions_added.net_instructions_added = 0;
     return num_instructions_added;
@@ -1520,7 +1552,8 @@ StatusOr<InstructionsAdded> RematerializeBestBlock(
     TF_ASSIGN_OR_RETURN(
         num_instructions_added.net_instructions_added,
         RematerializeInstructions(memory_tracker, &best_items,
-                                  remat_move_instructions, instruction_list));
+                                  remat_move_instructions, instruction_list,
+                                  &num_instructions_added.added_flops));
   }
   return num_instructions_added;
 }
@@ -1532,7 +1565,7 @@ StatusOr<int64> HloRematerialization::ComputePeakMemory(
   InstructionList instruction_list(order);
   MemoryUsageTracker tracker(computation, size_function_,
                              compact_shape_function_, *points_to_analysis_,
-                             instruction_list, mode_);
+                             instruction_list, mode_, objective_);
   int64 peak_memory = tracker.memory_usage();
   for (auto* item = instruction_list.first(); item != nullptr;
        item = instruction_list.next(item)) {
@@ -1574,9 +1607,20 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   CHECK(!ContainsKey(rematerialized_computations_, computation));
 
   InstructionList instruction_list(schedule->sequence(computation));
+  if (objective_ == RematerializationObjective::kMinimizeCompute) {
+    HloCostAnalysis cost_analysis(size_function_);
+    TF_RETURN_IF_ERROR(computation->Accept(&cost_analysis));
+    for (auto* item = instruction_list.first(); item != nullptr;
+         item = instruction_list.next(item)) {
+      // Unknown costs, such as those of custom calls, are negative.
+      const HloInstruction& hlo = *item->instruction;
+      item->flops = std::max<int64>(0, cost_analysis.flop_count(hlo)) +
+                    std::max<int64>(0, cost_analysis.transcendental_count(hlo));
+    }
+  }
   MemoryUsageTracker memory_tracker(
       computation, size_function_, compact_shape_function_,
-      *points_to_analysis_, instruction_list, mode_);
+      *points_to_analysis_, instruction_list, mode_, objective_);
   bool changed = false;
 
   // If the rematerialization makes the source instruction dead, then the
@@ -1637,6 +1681,7 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
                               &rematerializable_map, &remat_move_instructions));
       net_instructions_added += instructions_added.net_instructions_added;
       remat_count += instructions_added.remat_count;
+      added_flops_ += instructions_added.added_flops;
 
       VLOG(1) << "memory_usage after rematerialization = "
               << HumanReadableNumBytes(memory_tracker.memory_usage());
@@ -1740,6 +1785,7 @@ StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   rematerialized_computations_.clear();
   instructions_rematerialized_ = 0;
   net_instructions_added_ = 0;
+  added_flops_ = 0;
 
   TF_RET_CHECK(module->has_schedule());
   TF_ASSIGN_OR_RETURN(points_to_analysis_, TuplePointsToAnalysis::Run(module));
@@ -1810,7 +1856,8 @@ StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   TF_RETURN_IF_ERROR(module->set_schedule(std::move(saved_schedule)));
   VLOG(1) << "Rematerialized " << instructions_rematerialized_
           << " instructions in module " << module->name() << "; "
-          << net_instructions_added_ << " net instructions added";
+          << net_instructions_added_ << " net instructions added, which add "
+          << added_flops_ << " flops";
   const int64 current_peak_memory =
       computation_peak_memory_.at(module->entry_computation()) +
       module_output_size;
@@ -1842,4 +1889,38 @@ StatusOr<bool> HloRematerialization::Run(HloModule* module) {
   return changed;
 }
 
+StatusOr<std::vector<HloRematerialization::TradeoffPoint>>
+HloRematerialization::ComputeTradeoffCurve(
+    const HloModule& module,
+    absl::Span<const int64> memory_limits_bytes) const {
+  TF_RET_CHECK(module.has_schedule());
+  std::vector<TradeoffPoint> curve;
+  for (int64 memory_limit_bytes : memory_limits_bytes) {
+    std::unique_ptr<HloModule> clone = module.Clone();
+    HloRematerialization rematerialization(
+        size_function_, memory_limit_bytes, /*sizes=*/nullptr, pass_location_,
+        block_size_limit_, compact_shape_function_, mode_, objective_);
+    TF_RETURN_IF_ERROR(rematerialization.Run(clone.get()).status());
+    TF_ASSIGN_OR_RETURN(
+        int64 peak_memory_bytes,
+        HeapSimulator::MinimumMemoryForModule(
+            clone->schedule(), [this](const BufferValue& buffer) {
+              return size_function_(buffer.shape());
+            }));
+    curve.push_back({memory_limit_bytes, peak_memory_bytes,
+                     rematerialization.added_flops()});
+  }
+  return curve;
+}
+
+/* static */ std::string HloRematerialization::TradeoffCurveToString(
+    absl::Span<const TradeoffPoint> curve) {
+  std::string out = "memory limit bytes, peak memory bytes, added flops\n";
+  for (const TradeoffPoint& point : curve) {
+    absl::StrAppendFormat(&out, "%d, %d, %d\n", point.memory_limit_bytes,
+                          point.peak_memory_bytes, point.added_flops);
+  }
+  return out;
+}
+
 }  // namespace xla
@@ -17,6 +17,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/xla/service/call_graph.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
@@ -56,6 +57,28 @@ class HloRematerialization : public HloModulePass {
     kRecomputeAndCompress  // Consider both kRecompute and kRemat.
   };
 
+  // What the rematerialization algorithm minimizes when it picks, among the
+  // candidates that reduce memory use at a program point, the one to
+  // rematerialize.
+  enum class RematerializationObjective {
+    // Pick the candidate which frees the most memory.
+    kMaximizeMemoryReduced,
+    // Pick the candidate which adds the fewest flops, as given by
+    // HloCostAnalysis, per byte freed.
+    kMinimizeCompute
+  };
+
+  // A point of the trade-off between peak memory and recomputation, see
+  // ComputeTradeoffCurve.
+  struct TradeoffPoint {
+    int64 memory_limit_bytes;
+    // The peak memory of the rematerialized module, given by the heap
+    // simulator.
+    int64 peak_memory_bytes;
+    // The flops added by the rematerialized instructions.
+    int64 added_flops;
+  };
+
   // Enum to specify whether this rematerialization pass occurs before or after
   // multi-output fusion.
   enum class RematerializationPass {
@@ -80,12 +103,17 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   objective: What to minimize when picking instructions to
+  //     rematerialize.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64 memory_limit_bytes,
       RematerializationSizes* sizes, RematerializationPass pass_location,
       int block_size_limit,
       CompactShapeFunction compact_shape_function = nullptr,
-      RematerializationMode mode = RematerializationMode::kRecomputeAndCompress)
+      RematerializationMode mode = RematerializationMode::kRecomputeAndCompress,
+      RematerializationObjective objective =
+          RematerializationObjective::kMaximizeMemoryReduced)
       : size_function_(size_function),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
@@ -94,7 +122,8 @@ class HloRematerialization : public HloModulePass {
         compact_shape_function_(compact_shape_function == nullptr
                                     ? DefaultCompactShapeFunction
                                     : std::move(compact_shape_function)),
-        mode_(mode) {}
+        mode_(mode),
+        objective_(objective) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -107,6 +136,22 @@ class HloRematerialization : public HloModulePass {
   // false is returned.
   StatusOr<bool> Run(HloModule* module) override;
 
+  // Rematerializes a clone of `module`, which must have a schedule, for each
+  // of `memory_limits_bytes`, with the other parameters of this pass, and
+  // returns the resulting peak memory and added flops for each limit, from
+  // which a limit can be chosen.  `module` itself is not changed.
+  StatusOr<std::vector<TradeoffPoint>> ComputeTradeoffCurve(
+      const HloModule& module,
+      absl::Span<const int64> memory_limits_bytes) const;
+
+  // Returns `curve` formatted as a table with one point per line.
+  static std::string TradeoffCurveToString(
+      absl::Span<const TradeoffPoint> curve);
+
+  // Returns the flops added by the instructions that the last Run()
+  // rematerialized.
+  int64 added_flops() const { return added_flops_; }
+
  protected:
   // Rematerializes instructions within the given computation. 'order' is the
   // order in which the computation's instructions will be emitted in the
@@ -184,7 +229,13 @@ class HloRematerialization : public HloModulePass {
   // upper bound (within a factor of 2) on the block size.
   int max_rematerialized_block_size_ = 0;
 
+  // The flops added by the rematerialized instructions, excluding those that
+  // are only moved in the sequence.
+  int64 added_flops_ = 0;
+
   RematerializationMode mode_;
+
+  RematerializationObjective objective_;
 };
 
 }  // namespace xla
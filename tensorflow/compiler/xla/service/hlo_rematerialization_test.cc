@@ -444,6 +444,82 @@ TEST_F(HloRematerializationTest, CopyNotRematerialized) {
   EXPECT_EQ(count_copies(entry_computation), 1);
 }
 
+// `exp` and `bcast` take the same memory and are both live, but unused, across
+// `concat`, which is where the peak memory is.  Rematerializing either of them
+// brings the peak under 34KB, but only `exp` takes flops to recompute.
+const char* const kRecomputationCostModule = R"(
+HloModule RecomputationCost, is_scheduled=true
+
+ENTRY entry {
+  p0 = f32[] parameter(0)
+  p1 = f32[1024] parameter(1)
+  exp = f32[1024] exponential(p1)
+  bcast = f32[1024] broadcast(p0), dimensions={}
+  sum = f32[1024] add(exp, bcast)
+  concat = f32[4096] concatenate(sum, sum, sum, sum), dimensions={0}
+  slice = f32[1024] slice(concat), slice={[0:1024]}
+  add.1 = f32[1024] add(exp, slice)
+  ROOT add.2 = f32[1024] add(bcast, add.1)
+}
+)";
+
+TEST_F(HloRematerializationTest, MinimizeComputeObjective) {
+  using Objective = HloRematerialization::RematerializationObjective;
+  for (Objective objective :
+       {Objective::kMaximizeMemoryReduced, Objective::kMinimizeCompute}) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto module, ParseAndReturnVerifiedModule(kRecomputationCostModule));
+    HloRematerialization remat(
+        ByteSizeOf, /*memory_limit_bytes=*/34 * 1024, /*sizes=*/nullptr,
+        HloRematerialization::RematerializationPass::kPreFusion,
+        /*block_size_limit=*/1, /*compact_shape_function=*/nullptr,
+        HloRematerialization::RematerializationMode::kRecomputeOnly,
+        objective);
+    TF_ASSERT_OK_AND_ASSIGN(bool changed, remat.Run(module.get()));
+    EXPECT_TRUE(changed);
+
+    const HloInstruction* root =
+        module->entry_computation()->root_instruction();
+    const HloInstruction* bcast = root->operand(0);
+    const HloInstruction* exp = root->operand(1)->operand(0);
+    if (objective == Objective::kMinimizeCompute) {
+      // Recomputing the broadcast adds no flops.
+      EXPECT_EQ(bcast->name(), "bcast.remat");
+      EXPECT_EQ(exp->name(), "exp");
+      EXPECT_EQ(remat.added_flops(), 0);
+    } else {
+      // Both free as much memory, so the first one is rematerialized.
+      EXPECT_EQ(bcast->name(), "bcast");
+      EXPECT_EQ(exp->name(), "exp.remat");
+      EXPECT_EQ(remat.added_flops(), 1024);
+    }
+  }
+}
+
+TEST_F(HloRematerializationTest, TradeoffCurve) {
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto module, ParseAndReturnVerifiedModule(kRecomputationCostModule));
+  HloRematerialization remat(
+      ByteSizeOf, /*memory_limit_bytes=*/0, /*sizes=*/nullptr,
+      HloRematerialization::RematerializationPass::kPreFusion,
+      /*block_size_limit=*/1, /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly);
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<HloRematerialization::TradeoffPoint> curve,
+      remat.ComputeTradeoffCurve(*module, {64 * 1024, 34 * 1024}));
+  ASSERT_EQ(curve.size(), 2);
+  EXPECT_EQ(curve[0].memory_limit_bytes, 64 * 1024);
+  EXPECT_EQ(curve[0].added_flops, 0);
+  EXPECT_EQ(curve[1].memory_limit_bytes, 34 * 1024);
+  EXPECT_EQ(curve[1].added_flops, 1024);
+  EXPECT_LT(curve[1].peak_memory_bytes, curve[0].peak_memory_bytes);
+  EXPECT_THAT(HloRematerialization::TradeoffCurveToString(curve),
+              ::testing::HasSubstr("memory limit bytes"));
+
+  // The module itself is not rematerialized.
+  EXPECT_EQ(module->entry_computation()->instruction_count(), 9);
+}
+
 class IndirectUseTest : public HloRematerializationTest,
                         public ::testing::WithParamInterface<bool> {};
 
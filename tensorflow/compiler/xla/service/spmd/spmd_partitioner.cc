@@ -3877,6 +3877,155 @@ Status SpmdPartitioningVisitor::HandleDotHelper(
     });
     return Status::OK();
   };
+  // Try to emit windowed DotGeneral when both operands are partitioned in the
+  // same way along contracting dimensions, and the output is partitioned along
+  // the non-contracting dimensions of one of them. Instead of all-reducing the
+  // whole output and slicing it, each iteration computes the partial result of
+  // one output window, and adds it to a window buffer that travels around the
+  // partitions, so that each collective-permute can overlap with the dot of
+  // the next iteration. After the last iteration each partition holds the sum
+  // for its own window.
+  auto emit_windowed_reduce_scatter_dot_general = [&](int64 slicing_operand) {
+    auto zero = b_.AddInstruction(HloInstruction::CreateConstant(
+        LiteralUtil::Zero(hlo->shape().element_type())));
+    // Pad both sides with zero, since NaN at one side cannot be masked by zero
+    // on the other side.
+    lhs = lhs.PadWithValue(zero);
+    rhs = rhs.PadWithValue(zero);
+    auto result_buffer =
+        CreateZero(MakePartitionedShape(hlo->shape(), hlo->sharding()), &b_);
+    auto iteration = b_.AddInstruction(
+        HloInstruction::CreateConstant(LiteralUtil::CreateR0<uint32>(0)));
+
+    SpmdBuilder body_b("windowed_dot_general_body", visiting_hlo_);
+    auto param = body_b.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/0,
+        ShapeUtil::MakeTupleShape({lhs.hlo()->shape(), rhs.hlo()->shape(),
+                                   result_buffer->shape(), iteration->shape()}),
+        "param"));
+    auto l = body_b.AddInstruction(
+        HloInstruction::CreateGetTupleElement(lhs.hlo()->shape(), param, 0));
+    auto r = body_b.AddInstruction(
+        HloInstruction::CreateGetTupleElement(rhs.hlo()->shape(), param, 1));
+    auto o = body_b.AddInstruction(HloInstruction::CreateGetTupleElement(
+        result_buffer->shape(), param, 2));
+    auto i = body_b.AddInstruction(
+        HloInstruction::CreateGetTupleElement(iteration->shape(), param, 3));
+
+    // The window buffer moves from each partition to the previous one, so in
+    // iteration i a partition adds to the window of partition
+    // (partition_id + i + 1) % num_partitions, and the last iteration ends
+    // with its own window.
+    auto partition_id = collective_ops_creator_.create_partition_id(&body_b);
+    auto window_partition_id =
+        body_b.AddInstruction(HloInstruction::CreateBinary(
+            i->shape(), HloOpcode::kAdd, i,
+            body_b.AddInstruction(HloInstruction::CreateConstant(
+                LiteralUtil::CreateR0<uint32>(1)))));
+    window_partition_id = body_b.AddInstruction(HloInstruction::CreateBinary(
+        i->shape(), HloOpcode::kAdd, window_partition_id, partition_id));
+    auto partition_count = body_b.AddInstruction(HloInstruction::CreateConstant(
+        LiteralUtil::CreateR0<uint32>(num_partitions_)));
+    window_partition_id = body_b.AddInstruction(
+        HloInstruction::CreateBinary(i->shape(), HloOpcode::kRemainder,
+                                     window_partition_id, partition_count));
+
+    // Slice the rows of the window out of the operand whose non-contracting
+    // dimensions the output is partitioned along. We do this by treating the
+    // operand as replicated, and resharding it to match the output.
+    auto slice_operand = slicing_operand == 0 ? l : r;
+    slice_operand->set_sharding(HloSharding::Replicate());
+    auto state = MakePartitioningState();
+    state.b = &body_b;
+    state.partition_id = window_partition_id;
+    auto slice = PartitionedHlo(slice_operand, slice_operand->shape(), state)
+                     .Reshard(slicing_operand == 0
+                                  ? *output_sharding_transposed_to_match_lhs
+                                  : *output_sharding_transposed_to_match_rhs)
+                     .hlo();
+    slice_operand->clear_sharding();
+    TF_ASSIGN_OR_RETURN(
+        auto dot,
+        create_sharded_dot(slicing_operand == 0 ? slice : l,
+                           slicing_operand == 0 ? r : slice, &body_b));
+    o = body_b.AddInstruction(
+        HloInstruction::CreateBinary(o->shape(), HloOpcode::kAdd, o, dot));
+
+    // ++i
+    i = body_b.AddInstruction(HloInstruction::CreateBinary(
+        i->shape(), HloOpcode::kAdd, i,
+        body_b.AddInstruction(
+            HloInstruction::CreateConstant(LiteralUtil::CreateR0<uint32>(1)))));
+    auto has_more = body_b.AddInstruction(HloInstruction::CreateCompare(
+        ShapeUtil::MakeShape(PRED, {}), i,
+        body_b.AddInstruction(HloInstruction::CreateConstant(
+            LiteralUtil::CreateR0<uint32>(num_partitions_))),
+        ComparisonDirection::kLt));
+    // Collective-permute the window buffer for the next iteration. We don't
+    // need it after the last iteration, so we use a conditional around the
+    // collective-permute.
+    {
+      SpmdBuilder cp_b("window_collective_permute", visiting_hlo_);
+      {
+        auto p = cp_b.AddInstruction(
+            HloInstruction::CreateParameter(0, o->shape(), "window"));
+        std::vector<std::pair<int64, int64>> sd_pairs(num_partitions_);
+        for (int64 source = 0; source < num_partitions_; ++source) {
+          // 0 -> n-1, 1 -> 0, 2 -> 1, ...
+          sd_pairs[source] = {source,
+                              (source - 1 + num_partitions_) % num_partitions_};
+        }
+        collective_ops_creator_.create_cross_partition_collective_permute(
+            &cp_b, p, sd_pairs, (*next_channel_id_)++);
+      }
+      SpmdBuilder ncp_b("last_iteration_noop", visiting_hlo_);
+      {
+        ncp_b.AddInstruction(
+            HloInstruction::CreateParameter(0, o->shape(), "window"));
+      }
+      o = body_b.AddInstruction(HloInstruction::CreateConditional(
+          o->shape(), has_more, o,
+          module_->AddEmbeddedComputation(cp_b.Build()), o,
+          module_->AddEmbeddedComputation(ncp_b.Build())));
+    }
+    body_b.AddInstruction(HloInstruction::CreateTuple({l, r, o, i}));
+
+    SpmdBuilder cond_b("windowed_dot_general_cond", visiting_hlo_);
+    auto cond_param = cond_b.AddInstruction(HloInstruction::CreateParameter(
+        /*parameter_number=*/0,
+        ShapeUtil::MakeTupleShape({lhs.hlo()->shape(), rhs.hlo()->shape(),
+                                   result_buffer->shape(), iteration->shape()}),
+        "param"));
+    auto cond_i = cond_b.AddInstruction(HloInstruction::CreateGetTupleElement(
+        iteration->shape(), cond_param, 3));
+    cond_b.AddInstruction(HloInstruction::CreateCompare(
+        ShapeUtil::MakeShape(PRED, {}), cond_i,
+        cond_b.AddInstruction(HloInstruction::CreateConstant(
+            LiteralUtil::CreateR0<uint32>(num_partitions_))),
+        ComparisonDirection::kLt));
+    auto while_loop = b_.AddInstruction(HloInstruction::CreateWhile(
+        cond_param->shape(), module_->AddEmbeddedComputation(cond_b.Build()),
+        module_->AddEmbeddedComputation(body_b.Build()),
+        b_.AddInstruction(HloInstruction::CreateTuple(
+            {lhs.hlo(), rhs.hlo(), result_buffer, iteration}))));
+    SetPartitionedHlo(hlo, [&] {
+      return b_.AddInstruction(HloInstruction::CreateGetTupleElement(
+          result_buffer->shape(), while_loop, 2));
+    });
+    return Status::OK();
+  };
+  if (lhs_contracting_partitions == num_partitions_ &&
+      rhs_contracting_partitions == num_partitions_ &&
+      lhs_sharding_transposed_to_match_rhs == rhs_sharding &&
+      ShapeSizeInBytes(hlo->shape()) >=
+          options_.threshold_for_windowed_einsum_mib * 1024 * 1024) {
+    if (output_lhs_non_contracting_partitions == num_partitions_) {
+      return emit_windowed_reduce_scatter_dot_general(0);
+    }
+    if (output_rhs_non_contracting_partitions == num_partitions_) {
+      return emit_windowed_reduce_scatter_dot_general(1);
+    }
+  }
   if (output_lhs_non_contracting_partitions == num_partitions_ &&
       output_sharding_transposed_to_match_lhs == lhs_sharding &&
       ShapeSizeInBytes(hlo->operand(1)->shape()) >=
@@ -40,8 +40,9 @@ struct SpmdPartitionerOptions {
   // instructions.
   int64 report_instruction_count = 5;
 
-  // The minimum size in MiB of an einsum operand to be considered using
-  // windowed implementation in an HLO loop.
+  // The minimum size in MiB of an einsum operand, or of the output of an einsum
+  // that would otherwise be all-reduced, to be considered using windowed
+  // implementation in an HLO loop.
   int64 threshold_for_windowed_einsum_mib = 256;
 
   // Whether the entry computations' signature could change after partitioning.
@@ -3351,6 +3351,65 @@ ENTRY entry {
               op::Parameter(0));
 }
 
+TEST_F(SpmdPartitioningTest, EinsumWindowedContractingReduceScatter) {
+  const char* const hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  %lhs = f32[8192,64] parameter(0)
+  %lhs.copy = f32[8192,64] copy(%lhs), sharding={devices=[1,2]0,1}
+  %rhs = f32[64,8192] parameter(1)
+  %rhs.copy = f32[64,8192] copy(%rhs), sharding={devices=[2,1]0,1}
+  ROOT %dot = f32[8192,8192] dot(%lhs.copy, %rhs.copy),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0},
+    sharding={devices=[2,1]0,1}
+})";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, PartitionComputation(hlo_string,
+                                                            /*num_devices=*/2));
+  VLOG(1) << module->ToString();
+  auto root = module->entry_computation()->root_instruction();
+  auto lhs = AllOf(op::Copy(op::DynamicSlice(op::Parameter(0), op::Constant(),
+                                             op::Reshape())),
+                   op::Shape("f32[8192,32]"));
+  auto rhs = AllOf(op::Copy(op::DynamicSlice(op::Parameter(1), op::Reshape(),
+                                             op::Constant())),
+                   op::Shape("f32[32,8192]"));
+  EXPECT_THAT(root, AllOf(op::GetTupleElement(op::While(op::Tuple(
+                              lhs, rhs, op::Broadcast(), op::Constant()))),
+                          op::Shape("f32[4096,8192]")));
+  auto while_loop = root->operand(0);
+
+  // Check loop body. The partial output of each window is added to the
+  // window buffer before it moves to the next partition.
+  auto next_i = op::Add(op::GetTupleElement(op::Parameter(0)), op::Constant());
+  auto partial_output =
+      AllOf(op::Dot(op::DynamicSlice(op::GetTupleElement(op::Parameter(0)),
+                                     op::Reshape(), op::Constant()),
+                    op::GetTupleElement(op::Parameter(0))),
+            op::Shape("f32[4096,8192]"));
+  auto accumulated =
+      op::Add(op::GetTupleElement(op::Parameter(0)), partial_output);
+  EXPECT_THAT(while_loop->while_body()->root_instruction(),
+              op::Tuple(op::GetTupleElement(op::Parameter(0)),
+                        op::GetTupleElement(op::Parameter(0)),
+                        op::Conditional(op::Compare(next_i, op::Constant()),
+                                        accumulated, accumulated),
+                        next_i));
+
+  // Check the conditional that contains the collective permute.
+  auto cp_conditional =
+      while_loop->while_body()->root_instruction()->operand(2);
+  EXPECT_THAT(cp_conditional->true_computation()->root_instruction(),
+              op::CollectivePermute(op::Parameter(0)));
+  EXPECT_THAT(cp_conditional->false_computation()->root_instruction(),
+              op::Parameter(0));
+  for (const HloInstruction* instruction :
+       module->entry_computation()->instructions()) {
+    EXPECT_NE(instruction->opcode(), HloOpcode::kAllReduce);
+  }
+}
+
 TEST_F(SpmdPartitioningTest, EinsumRHSWindowedNonContractingReduce1) {
   const char* const hlo_string = R"(
 HloModule module
@@ -0,0 +1,193 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/topk_rewriter.h"
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/hlo_casting_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+
+namespace m = match;
+
+namespace {
+
+// Returns the number k of elements that `slice` keeps along `dimension` if it
+// keeps just a prefix of that dimension and all of the other dimensions, and
+// nullopt otherwise.
+absl::optional<int64> SlicedPrefix(const HloInstruction* slice,
+                                   int64 dimension) {
+  if (slice->opcode() != HloOpcode::kSlice) {
+    return absl::nullopt;
+  }
+  const Shape& shape = slice->operand(0)->shape();
+  for (int64 i = 0; i < shape.rank(); ++i) {
+    if (slice->slice_starts(i) != 0 || slice->slice_strides(i) != 1 ||
+        (i != dimension && slice->slice_limits(i) != shape.dimensions(i))) {
+      return absl::nullopt;
+    }
+  }
+  return slice->slice_limits(dimension);
+}
+
+// Returns true if `comparator` compares its first two F32 parameters with
+// greater-than, either directly or with the total order that
+// CreateScalarGtComputation builds, in which -0.0 is smaller than 0.0.
+bool IsGreaterThan(const HloComputation& comparator) {
+  auto total_order_key = [](int64 parameter_number) {
+    auto param = m::Parameter(parameter_number)
+                     .WithShape(m::Shape().WithElementType(F32));
+    auto param_s32 =
+        m::BitcastConvert(param).WithShape(m::Shape().WithElementType(S32));
+    auto param_u32 =
+        m::BitcastConvert(param).WithShape(m::Shape().WithElementType(U32));
+    return m::Select(
+        m::Lt(param_s32, m::ConstantScalar(0)),
+        m::BitcastConvert(
+            m::Subtract(m::ConstantScalar(std::numeric_limits<int32>::max()),
+                        param_u32))
+            .WithShape(m::Shape().WithElementType(S32)),
+        param_s32);
+  };
+  const HloInstruction* root = comparator.root_instruction();
+  return Match(root, m::Gt(m::Parameter(0), m::Parameter(1))) ||
+         Match(root, m::Gt(total_order_key(0), total_order_key(1)));
+}
+
+}  // namespace
+
+/* static */ absl::optional<int64> TopkRewriter::SortIsInTopK(
+    HloInstruction* inst) {
+  HloSortInstruction* sort = DynCast<HloSortInstruction>(inst);
+  if (sort == nullptr || sort->operand_count() > 2) {
+    return absl::nullopt;
+  }
+  const Shape& keys_shape = sort->keys()->shape();
+  const int64 sort_dim = sort->sort_dimension();
+  if (keys_shape.element_type() != F32 || keys_shape.rank() > 2 ||
+      sort_dim != keys_shape.rank() - 1) {
+    return absl::nullopt;
+  }
+  if (sort->operand_count() == 2) {
+    const HloInstruction* values = sort->operand(1);
+    if (values->opcode() != HloOpcode::kIota ||
+        values->shape().element_type() != S32 ||
+        Cast<HloIotaInstruction>(values)->iota_dimension() != sort_dim) {
+      return absl::nullopt;
+    }
+  }
+  if (!IsGreaterThan(*sort->to_apply())) {
+    return absl::nullopt;
+  }
+  if (sort->parent()->root_instruction() == sort) {
+    return absl::nullopt;
+  }
+
+  // All the results of the sort must be sliced to the same prefix.
+  std::vector<const HloInstruction*> results;
+  if (sort->operand_count() == 1) {
+    results.push_back(sort);
+  } else {
+    for (const HloInstruction* user : sort->users()) {
+      if (user->opcode() != HloOpcode::kGetTupleElement ||
+          user->parent()->root_instruction() == user) {
+        return absl::nullopt;
+      }
+      results.push_back(user);
+    }
+  }
+  absl::optional<int64> k;
+  for (const HloInstruction* result : results) {
+    for (const HloInstruction* user : result->users()) {
+      absl::optional<int64> sliced = SlicedPrefix(user, sort_dim);
+      if (!sliced || (k && *k != *sliced)) {
+        return absl::nullopt;
+      }
+      k = sliced;
+    }
+  }
+  return k;
+}
+
+StatusOr<bool> TopkRewriter::Run(HloModule* module) {
+  bool changed = false;
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    // Collect the sorts first, since rewriting one removes its users.
+    std::vector<std::pair<HloSortInstruction*, int64>> sorts;
+    for (HloInstruction* inst : computation->instructions()) {
+      absl::optional<int64> k = SortIsInTopK(inst);
+      if (k && is_profitable_to_convert_(Cast<HloSortInstruction>(inst), *k)) {
+        sorts.push_back({Cast<HloSortInstruction>(inst), *k});
+      }
+    }
+    for (const auto& sort_and_k : sorts) {
+      HloSortInstruction* sort = sort_and_k.first;
+      HloInstruction* keys = sort->mutable_operand(0);
+      const Shape& keys_shape = keys->shape();
+      std::vector<int64> topk_dims(keys_shape.dimensions().begin(),
+                                   keys_shape.dimensions().end());
+      topk_dims.back() = sort_and_k.second;
+      const Shape topk_shape = ShapeUtil::MakeTupleShape(
+          {ShapeUtil::MakeShapeWithDescendingLayout(F32, topk_dims),
+           ShapeUtil::MakeShapeWithDescendingLayout(S32, topk_dims)});
+      const Shape keys_shape_with_layout =
+          ShapeUtil::MakeShapeWithDescendingLayout(F32,
+                                                   keys_shape.dimensions());
+      HloInstruction* topk =
+          computation->AddInstruction(HloInstruction::CreateCustomCall(
+              topk_shape, {keys}, "TopK", {keys_shape_with_layout}));
+      HloInstruction* topk_values =
+          computation->AddInstruction(HloInstruction::CreateGetTupleElement(
+              topk_shape.tuple_shapes(0), topk, 0));
+      HloInstruction* topk_indices =
+          computation->AddInstruction(HloInstruction::CreateGetTupleElement(
+              topk_shape.tuple_shapes(1), topk, 1));
+
+      // Replace the slices of each result of the sort, and then remove the
+      // results that are left without users.
+      std::vector<HloInstruction*> results;
+      if (sort->operand_count() == 1) {
+        results.push_back(sort);
+      } else {
+        results = sort->users();
+      }
+      for (HloInstruction* result : results) {
+        HloInstruction* replacement =
+            result == sort || result->tuple_index() == 0 ? topk_values
+                                                         : topk_indices;
+        const std::vector<HloInstruction*> slices = result->users();
+        for (HloInstruction* slice : slices) {
+          TF_RETURN_IF_ERROR(slice->ReplaceAllUsesWith(replacement));
+          TF_RETURN_IF_ERROR(computation->RemoveInstruction(slice));
+        }
+        if (result != sort) {
+          TF_RETURN_IF_ERROR(computation->RemoveInstruction(result));
+        }
+      }
+      TF_RETURN_IF_ERROR(computation->RemoveInstructionAndUnusedOperands(sort));
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+}  // namespace xla
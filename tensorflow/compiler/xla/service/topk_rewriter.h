@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_TOPK_REWRITER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_TOPK_REWRITER_H_
+
+#include <functional>
+
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/service/hlo_instructions.h"
+#include "tensorflow/compiler/xla/service/hlo_module.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// HLO pass that rewrites a descending sort of F32 keys along their last
+// dimension, optionally with S32 iota values, of which only the first k
+// elements of that dimension are used, into a "TopK" custom call.
+//
+// The custom call takes the keys of shape [batch, n] or [n] and returns a
+// tuple of the k largest keys in descending order and their S32 indices, of
+// shape [batch, k] or [k]. Ties are broken by index, so that the result
+// matches a stable sort. Both the operand and the results have a
+// major-to-minor layout. Backends that run this pass must implement the
+// custom call.
+class TopkRewriter : public HloModulePass {
+ public:
+  // `is_profitable_to_convert` decides, given a sort that matches and the
+  // number k of elements kept, whether to rewrite it.
+  explicit TopkRewriter(
+      std::function<bool(const HloSortInstruction*, int64)>
+          is_profitable_to_convert)
+      : is_profitable_to_convert_(std::move(is_profitable_to_convert)) {}
+
+  absl::string_view name() const override { return "topk-rewriter"; }
+
+  StatusOr<bool> Run(HloModule* module) override;
+
+  // Returns the number k of elements kept if `sort` is a sort that this pass
+  // rewrites, and nullopt otherwise.
+  static absl::optional<int64> SortIsInTopK(HloInstruction* sort);
+
+ private:
+  std::function<bool(const HloSortInstruction*, int64)>
+      is_profitable_to_convert_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_TOPK_REWRITER_H_
@@ -0,0 +1,227 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/topk_rewriter.h"
+
+#include "tensorflow/compiler/xla/service/hlo_dce.h"
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher_gmock.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+namespace m = match;
+
+using TopkRewriterTest = HloTestBase;
+
+bool AlwaysConvert(const HloSortInstruction*, int64) { return true; }
+
+TEST_F(TopkRewriterTest, RewriteSortWithIndices) {
+  const char* const hlo_string = R"(
+HloModule module
+
+compare {
+  p.0.lhs = f32[] parameter(0)
+  p.0.rhs = f32[] parameter(1)
+  p.1.lhs = s32[] parameter(2)
+  p.1.rhs = s32[] parameter(3)
+  ROOT gt = pred[] compare(p.0.lhs, p.0.rhs), direction=GT
+}
+
+ENTRY entry {
+  keys = f32[8,1234] parameter(0)
+  iota = s32[8,1234] iota(), iota_dimension=1
+  sort = (f32[8,1234], s32[8,1234]) sort(keys, iota), dimensions={1},
+    to_apply=compare
+  gte.0 = f32[8,1234] get-tuple-element(sort), index=0
+  values = f32[8,5] slice(gte.0), slice={[0:8], [0:5]}
+  gte.1 = s32[8,1234] get-tuple-element(sort), index=1
+  indices = s32[8,5] slice(gte.1), slice={[0:8], [0:5]}
+  ROOT tuple = (f32[8,5], s32[8,5]) tuple(values, indices)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TopkRewriter rewriter(AlwaysConvert);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_TRUE(changed);
+  TF_ASSERT_OK(HloDCE().Run(module.get()).status());
+
+  const HloInstruction* topk = nullptr;
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(
+                  m::GetTupleElement(m::CustomCall(&topk, m::Parameter(0)), 0),
+                  m::GetTupleElement(m::CustomCall(m::Parameter(0)), 1))));
+  EXPECT_EQ(topk->custom_call_target(), "TopK");
+  EXPECT_TRUE(ShapeUtil::Equal(
+      topk->shape(),
+      ShapeUtil::MakeTupleShape({ShapeUtil::MakeShape(F32, {8, 5}),
+                                 ShapeUtil::MakeShape(S32, {8, 5})})));
+  EXPECT_EQ(module->entry_computation()->instruction_count(), 5);
+}
+
+TEST_F(TopkRewriterTest, RewriteSortWithTotalOrderComparator) {
+  // The comparator of CreateScalarGtComputation, after simplification.
+  const char* const hlo_string = R"(
+HloModule module
+
+%compare {
+  %p.0.lhs = f32[] parameter(0)
+  %bitcast-convert.0 = s32[] bitcast-convert(%p.0.lhs)
+  %zero = s32[] constant(0)
+  %lt.0 = pred[] compare(%bitcast-convert.0, %zero), direction=LT
+  %max = u32[] constant(2147483647)
+  %bitcast-convert.1 = u32[] bitcast-convert(%p.0.lhs)
+  %subtract.0 = u32[] subtract(%max, %bitcast-convert.1)
+  %bitcast-convert.2 = s32[] bitcast-convert(%subtract.0)
+  %select.0 = s32[] select(%lt.0, %bitcast-convert.2, %bitcast-convert.0)
+  %p.0.rhs = f32[] parameter(1)
+  %bitcast-convert.3 = s32[] bitcast-convert(%p.0.rhs)
+  %lt.1 = pred[] compare(%bitcast-convert.3, %zero), direction=LT
+  %bitcast-convert.4 = u32[] bitcast-convert(%p.0.rhs)
+  %subtract.1 = u32[] subtract(%max, %bitcast-convert.4)
+  %bitcast-convert.5 = s32[] bitcast-convert(%subtract.1)
+  %select.1 = s32[] select(%lt.1, %bitcast-convert.5, %bitcast-convert.3)
+  %p.1.lhs = s32[] parameter(2)
+  %p.1.rhs = s32[] parameter(3)
+  ROOT %gt = pred[] compare(%select.0, %select.1), direction=GT
+}
+
+ENTRY entry {
+  keys = f32[8,1234] parameter(0)
+  iota = s32[8,1234] iota(), iota_dimension=1
+  sort = (f32[8,1234], s32[8,1234]) sort(keys, iota), dimensions={1},
+    is_stable=true, to_apply=compare
+  gte.0 = f32[8,1234] get-tuple-element(sort), index=0
+  values = f32[8,5] slice(gte.0), slice={[0:8], [0:5]}
+  gte.1 = s32[8,1234] get-tuple-element(sort), index=1
+  indices = s32[8,5] slice(gte.1), slice={[0:8], [0:5]}
+  ROOT tuple = (f32[8,5], s32[8,5]) tuple(values, indices)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TopkRewriter rewriter(AlwaysConvert);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(
+                  m::GetTupleElement(m::CustomCall(m::Parameter(0)), 0),
+                  m::GetTupleElement(m::CustomCall(m::Parameter(0)), 1))));
+}
+
+TEST_F(TopkRewriterTest, RewriteSortOfKeysOnly) {
+  const char* const hlo_string = R"(
+HloModule module
+
+compare {
+  p.0.lhs = f32[] parameter(0)
+  p.0.rhs = f32[] parameter(1)
+  ROOT gt = pred[] compare(p.0.lhs, p.0.rhs), direction=GT
+}
+
+ENTRY entry {
+  keys = f32[1234] parameter(0)
+  sort = f32[1234] sort(keys), dimensions={0}, to_apply=compare
+  ROOT values = f32[5] slice(sort), slice={[0:5]}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TopkRewriter rewriter(AlwaysConvert);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::GetTupleElement(
+                  m::CustomCall(m::Parameter(0))
+                      .WithCustomCallTarget("TopK"),
+                  0)));
+}
+
+TEST_F(TopkRewriterTest, DoesNotRewriteAscendingSort) {
+  const char* const hlo_string = R"(
+HloModule module
+
+compare {
+  p.0.lhs = f32[] parameter(0)
+  p.0.rhs = f32[] parameter(1)
+  ROOT lt = pred[] compare(p.0.lhs, p.0.rhs), direction=LT
+}
+
+ENTRY entry {
+  keys = f32[1234] parameter(0)
+  sort = f32[1234] sort(keys), dimensions={0}, to_apply=compare
+  ROOT values = f32[5] slice(sort), slice={[0:5]}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TopkRewriter rewriter(AlwaysConvert);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(TopkRewriterTest, DoesNotRewriteSortWithOtherUsers) {
+  const char* const hlo_string = R"(
+HloModule module
+
+compare {
+  p.0.lhs = f32[] parameter(0)
+  p.0.rhs = f32[] parameter(1)
+  ROOT gt = pred[] compare(p.0.lhs, p.0.rhs), direction=GT
+}
+
+ENTRY entry {
+  keys = f32[1234] parameter(0)
+  sort = f32[1234] sort(keys), dimensions={0}, to_apply=compare
+  values = f32[5] slice(sort), slice={[0:5]}
+  rest = f32[5] slice(sort), slice={[5:10]}
+  ROOT tuple = (f32[5], f32[5]) tuple(values, rest)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TopkRewriter rewriter(AlwaysConvert);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(TopkRewriterTest, RespectsProfitability) {
+  const char* const hlo_string = R"(
+HloModule module
+
+compare {
+  p.0.lhs = f32[] parameter(0)
+  p.0.rhs = f32[] parameter(1)
+  ROOT gt = pred[] compare(p.0.lhs, p.0.rhs), direction=GT
+}
+
+ENTRY entry {
+  keys = f32[1234] parameter(0)
+  sort = f32[1234] sort(keys), dimensions={0}, to_apply=compare
+  ROOT values = f32[1000] slice(sort), slice={[0:1000]}
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  HloInstruction* sort =
+      module->entry_computation()->root_instruction()->mutable_operand(0);
+  EXPECT_EQ(TopkRewriter::SortIsInTopK(sort), 1000);
+  TopkRewriter rewriter(
+      [](const HloSortInstruction*, int64 k) { return k < 100; });
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, rewriter.Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 
 #include <atomic>
+#include <functional>
+#include <thread>  // NOLINT
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
@@ -225,9 +227,115 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
 }
 
+void BFCAllocator::EnableSmallAllocationCache(size_t arena_bytes) {
+  // Round the arena down to a whole number of slabs.
+  const size_t num_slabs = arena_bytes / kSmallAllocSlabBytes;
+  if (num_slabs == 0) return;
+  small_alloc_arena_bytes_ = num_slabs * kSmallAllocSlabBytes;
+  small_alloc_num_slabs_ = num_slabs;
+  small_alloc_slab_class_.reset(new int8[num_slabs]);
+  small_alloc_shards_.reset(new SmallAllocShard[kNumSmallAllocShards]);
+}
+
+BFCAllocator::SmallAllocShard* BFCAllocator::CurrentSmallAllocShard() {
+  const size_t hash = std::hash<std::thread::id>()(std::this_thread::get_id());
+  return &small_alloc_shards_[hash % kNumSmallAllocShards];
+}
+
+bool BFCAllocator::RefillSmallAllocBlocks(int size_class, size_t max_blocks,
+                                          std::vector<void*>* blocks) {
+  mutex_lock l(small_alloc_pool_mu_);
+  if (!small_alloc_arena_initialized_) {
+    small_alloc_arena_initialized_ = true;
+    void* arena = AllocateRawInternal(kAllocatorAlignment,
+                                      small_alloc_arena_bytes_,
+                                      /*dump_log_on_failure=*/false,
+                                      /*freed_before_count=*/0);
+    if (arena == nullptr) {
+      LOG(WARNING) << "Allocator (" << Name() << ") could not reserve "
+                   << strings::HumanReadableNumBytes(small_alloc_arena_bytes_)
+                   << " for its small-allocation cache.";
+    } else {
+      {
+        // The arena is not a user allocation.
+        mutex_lock l(lock_);
+        --stats_.num_allocs;
+      }
+      small_alloc_arena_chunk_bytes_ = AllocatedSize(arena);
+      small_alloc_arena_end_ =
+          static_cast<char*>(arena) + small_alloc_arena_bytes_;
+      small_alloc_arena_.store(static_cast<char*>(arena),
+                               std::memory_order_release);
+    }
+  }
+
+  std::vector<void*>& pool = small_alloc_pool_[size_class];
+  if (pool.empty()) {
+    char* arena = small_alloc_arena_.load(std::memory_order_relaxed);
+    if (arena == nullptr || small_alloc_next_slab_ == small_alloc_num_slabs_) {
+      return false;
+    }
+    const size_t slab = small_alloc_next_slab_++;
+    small_alloc_slab_class_[slab] = size_class;
+    const size_t block_bytes = kMinAllocationSize << size_class;
+    char* slab_begin = arena + slab * kSmallAllocSlabBytes;
+    // Push in reverse so that blocks are handed out in address order.
+    for (size_t offset = kSmallAllocSlabBytes; offset >= block_bytes;
+         offset -= block_bytes) {
+      pool.push_back(slab_begin + offset - block_bytes);
+    }
+  }
+
+  const size_t n = std::min(max_blocks, pool.size());
+  blocks->insert(blocks->end(), pool.end() - n, pool.end());
+  pool.resize(pool.size() - n);
+  return true;
+}
+
+void* BFCAllocator::AllocateSmall(size_t num_bytes) {
+  const int size_class = SmallAllocClassForSize(num_bytes);
+  SmallAllocShard* shard = CurrentSmallAllocShard();
+  mutex_lock l(shard->mu);
+  std::vector<void*>& free_blocks = shard->free_blocks[size_class];
+  if (free_blocks.empty() &&
+      !RefillSmallAllocBlocks(size_class, kMaxCachedBlocksPerShard / 4,
+                              &free_blocks)) {
+    return nullptr;
+  }
+  void* ptr = free_blocks.back();
+  free_blocks.pop_back();
+  ++shard->num_allocs;
+  shard->bytes_allocated += kMinAllocationSize << size_class;
+  return ptr;
+}
+
+void BFCAllocator::DeallocateSmall(void* ptr) {
+  const size_t block_bytes = SmallAllocationSize(ptr);
+  const int size_class = Log2FloorNonZero(block_bytes >> kMinAllocationBits);
+  SmallAllocShard* shard = CurrentSmallAllocShard();
+  mutex_lock l(shard->mu);
+  shard->bytes_freed += block_bytes;
+  std::vector<void*>& free_blocks = shard->free_blocks[size_class];
+  free_blocks.push_back(ptr);
+  if (free_blocks.size() > kMaxCachedBlocksPerShard) {
+    // Return the older half of the cached blocks to the shared pool, so that
+    // a thread that only frees blocks does not hoard them.
+    const size_t n = free_blocks.size() / 2;
+    mutex_lock pool_lock(small_alloc_pool_mu_);
+    std::vector<void*>& pool = small_alloc_pool_[size_class];
+    pool.insert(pool.end(), free_blocks.begin(), free_blocks.begin() + n);
+    free_blocks.erase(free_blocks.begin(), free_blocks.begin() + n);
+  }
+}
+
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  if (small_alloc_arena_bytes_ > 0 && num_bytes > 0 &&
+      num_bytes <= kSmallAllocMaxBytes && timing_counter_ == nullptr) {
+    void* ptr = AllocateSmall(num_bytes);
+    if (ptr != nullptr) return ptr;
+  }
   if (allocation_attr.no_retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -493,6 +601,50 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                            {"shape", tensor_shape}});
       },
       /*level=*/profiler::TraceMeLevel::kInfo);
+  MaybeAddBinOccupancyTraceMe();
+}
+
+void BFCAllocator::AddChunkTraceMe(absl::string_view traceme_name,
+                                   const void* chunk_ptr, int64 chunk_bytes) {
+  tensorflow::profiler::TraceMe::InstantActivity(
+      [this, traceme_name, chunk_ptr,
+       chunk_bytes]() TF_NO_THREAD_SAFETY_ANALYSIS {
+        return tensorflow::profiler::TraceMeEncode(
+            traceme_name, {{"allocator_name", name_},
+                           {"addr", reinterpret_cast<uint64>(chunk_ptr)},
+                           {"allocation_bytes", chunk_bytes}});
+      },
+      /*level=*/profiler::TraceMeLevel::kVerbose);
+}
+
+void BFCAllocator::MaybeAddBinOccupancyTraceMe() {
+  if (!profiler::TraceMe::Active(profiler::TraceMeLevel::kVerbose)) return;
+  if (++num_tracemes_since_bin_occupancy_ < kBinOccupancyTraceMeInterval) {
+    return;
+  }
+  num_tracemes_since_bin_occupancy_ = 0;
+  tensorflow::profiler::TraceMe::InstantActivity(
+      [this]() TF_NO_THREAD_SAFETY_ANALYSIS {
+        // Each non-empty bin is encoded as
+        // "bin:bytes_in_use:bytes_in_bin:chunks_in_use:chunks_in_bin".
+        const std::array<BinDebugInfo, kNumBins> bin_infos =
+            get_bin_debug_info();
+        std::string occupancy;
+        for (BinNum bin_num = 0; bin_num < kNumBins; bin_num++) {
+          const BinDebugInfo& bin_info = bin_infos[bin_num];
+          if (bin_info.total_chunks_in_bin == 0) continue;
+          strings::StrAppend(&occupancy, occupancy.empty() ? "" : ",",
+                             bin_num, ":", bin_info.total_bytes_in_use, ":",
+                             bin_info.total_bytes_in_bin, ":",
+                             bin_info.total_chunks_in_use, ":",
+                             bin_info.total_chunks_in_bin);
+        }
+        return tensorflow::profiler::TraceMeEncode(
+            "MemoryBinOccupancy", {{"allocator_name", name_},
+                                   {"fragmentation", GetFragmentation()},
+                                   {"bin_occupancy", occupancy}});
+      },
+      /*level=*/profiler::TraceMeLevel::kVerbose);
 }
 
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
@@ -610,11 +762,17 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 
   // Add the newly free chunk to the free bin.
   InsertFreeChunkIntoBin(h_new_chunk);
+
+  AddChunkTraceMe("MemoryChunkSplit", new_chunk->ptr, new_chunk->size);
 }
 
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (IsSmallAllocation(ptr)) {
+    DeallocateSmall(ptr);
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -686,6 +844,8 @@ void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
   c1->freed_at_count = std::max(c1->freed_at_count, c2->freed_at_count);
 
   DeleteChunk(h2);
+
+  AddChunkTraceMe("MemoryChunkMerge", c1->ptr, c1->size);
 }
 
 void BFCAllocator::DeleteChunk(ChunkHandle h) {
@@ -868,6 +1028,8 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  // The small-allocation cache does not track requested sizes.
+  if (IsSmallAllocation(ptr)) return SmallAllocationSize(ptr);
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -877,6 +1039,7 @@ size_t BFCAllocator::RequestedSize(const void* ptr) const {
 }
 
 size_t BFCAllocator::AllocatedSize(const void* ptr) const {
+  if (IsSmallAllocation(ptr)) return SmallAllocationSize(ptr);
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -886,6 +1049,8 @@ size_t BFCAllocator::AllocatedSize(const void* ptr) const {
 }
 
 int64 BFCAllocator::AllocationId(const void* ptr) const {
+  // Blocks from the small-allocation cache do not have unique ids.
+  if (IsSmallAllocation(ptr)) return 0;
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1138,11 +1303,35 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
-  mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats;
+  {
+    mutex_lock l(lock_);
+    stats = stats_;
+  }
+  if (small_alloc_arena_.load(std::memory_order_acquire) != nullptr) {
+    // Report the blocks handed out from the arena instead of the arena chunk.
+    int64 small_bytes_in_use = 0;
+    for (int i = 0; i < kNumSmallAllocShards; ++i) {
+      SmallAllocShard& shard = small_alloc_shards_[i];
+      mutex_lock l(shard.mu);
+      stats.num_allocs += shard.num_allocs;
+      stats.num_cached_allocs += shard.num_allocs;
+      small_bytes_in_use += shard.bytes_allocated - shard.bytes_freed;
+    }
+    stats.bytes_in_use += small_bytes_in_use - small_alloc_arena_chunk_bytes_;
+    stats.cached_free_bytes =
+        static_cast<int64>(small_alloc_arena_bytes_) - small_bytes_in_use;
+  }
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
+  if (small_alloc_shards_ != nullptr) {
+    for (int i = 0; i < kNumSmallAllocShards; ++i) {
+      mutex_lock l(small_alloc_shards_[i].mu);
+      small_alloc_shards_[i].num_allocs = 0;
+    }
+  }
   mutex_lock l(lock_);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
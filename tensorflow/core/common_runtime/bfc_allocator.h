@@ -85,6 +85,29 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Enables a cache of fixed-size blocks in front of the BFC bins for requests
+  // of at most `kSmallAllocMaxBytes` bytes. On first use, a single chunk of
+  // `arena_bytes` is allocated from this allocator and carved into slabs of
+  // blocks of one size class each. Freed blocks are kept on one of several
+  // sharded free lists (selected by the calling thread), and are returned in
+  // batches to a shared pool when a shard holds too many of them. Small
+  // requests therefore do not take the BFC mutex, search bins, or split and
+  // merge chunks. Memory in the arena is never returned to the BFC bins.
+  //
+  // `GetStats()` reports the blocks in use rather than the arena itself,
+  // except that `peak_bytes_in_use` and `largest_alloc_size` count the arena
+  // as a single allocation.
+  //
+  // Requests that cannot be served from the arena fall back to the regular
+  // BFC path. The cache is not used when a timing counter is set, because
+  // cached blocks are reused without regard to `freed_by_func`.
+  //
+  // REQUIRES: Called before the first allocation.
+  void EnableSmallAllocationCache(size_t arena_bytes);
+
+  // The largest request that may be served by the small-allocation cache.
+  static constexpr size_t kSmallAllocMaxBytes = 4096;
+
  private:
   struct Bin;
 
@@ -130,6 +153,16 @@ class BFCAllocator : public Allocator {
                   int64 req_bytes, int64 alloc_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Add a verbose TraceMe for a chunk split or merge, with the address and
+  // size of the chunk that results from it.
+  void AddChunkTraceMe(absl::string_view traceme_name, const void* chunk_ptr,
+                       int64 chunk_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Every kBinOccupancyTraceMeInterval allocations and deallocations traced at
+  // the verbose level, add a TraceMe with the occupancy of each non-empty bin,
+  // so that fragmentation can be followed at bin granularity over time.
+  void MaybeAddBinOccupancyTraceMe() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -549,12 +582,92 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+  // Number of memory TraceMes since the last bin occupancy TraceMe.
+  static constexpr int kBinOccupancyTraceMeInterval = 64;
+  int num_tracemes_since_bin_occupancy_ TF_GUARDED_BY(lock_) = 0;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
   int64 size_history_[MEM_DEBUG_SIZE_HISTORY_SIZE];
 #endif
 
+  // Small-allocation cache. See `EnableSmallAllocationCache()`.
+  //
+  // Size class `c` holds blocks of `kMinAllocationSize << c` bytes, so the
+  // classes cover 256B to 4KiB.
+  static constexpr int kNumSmallAllocClasses = 5;
+  static constexpr size_t kSmallAllocSlabBytes = 64 << 10;
+  static constexpr int kNumSmallAllocShards = 16;
+  // A shard returns half of its blocks of a class to the shared pool when it
+  // holds more than this many, and takes this many / 4 when it runs out.
+  static constexpr size_t kMaxCachedBlocksPerShard = 128;
+
+  struct SmallAllocShard {
+    mutex mu;
+    std::vector<void*> free_blocks[kNumSmallAllocClasses] TF_GUARDED_BY(mu);
+    int64 num_allocs TF_GUARDED_BY(mu) = 0;
+    // A block may be freed on a different shard than it was allocated on, so
+    // only the sum over all shards of `bytes_allocated - bytes_freed` is
+    // meaningful.
+    int64 bytes_allocated TF_GUARDED_BY(mu) = 0;
+    int64 bytes_freed TF_GUARDED_BY(mu) = 0;
+  };
+
+  // Returns the size class for a request of `num_bytes`.
+  // REQUIRES: 0 < num_bytes <= kSmallAllocMaxBytes.
+  int SmallAllocClassForSize(size_t num_bytes) {
+    const uint64 units =
+        (num_bytes + kMinAllocationSize - 1) >> kMinAllocationBits;
+    return units <= 1 ? 0 : Log2FloorNonZero(units - 1) + 1;
+  }
+
+  // Returns true if `ptr` was returned by `AllocateSmall()`.
+  bool IsSmallAllocation(const void* ptr) const {
+    const char* arena = small_alloc_arena_.load(std::memory_order_acquire);
+    return arena != nullptr && ptr >= arena && ptr < small_alloc_arena_end_;
+  }
+
+  // Returns the size of the block containing `ptr`.
+  // REQUIRES: IsSmallAllocation(ptr).
+  size_t SmallAllocationSize(const void* ptr) const {
+    const size_t slab = (static_cast<const char*>(ptr) -
+                         small_alloc_arena_.load(std::memory_order_relaxed)) /
+                        kSmallAllocSlabBytes;
+    return kMinAllocationSize << small_alloc_slab_class_[slab];
+  }
+
+  SmallAllocShard* CurrentSmallAllocShard();
+
+  // Returns nullptr if the request could not be served from the cache.
+  void* AllocateSmall(size_t num_bytes);
+  void DeallocateSmall(void* ptr);
+
+  // Moves up to `max_blocks` blocks of `size_class` from the shared pool into
+  // `*blocks`, carving a new slab out of the arena if the pool is empty.
+  // Returns false if no block is available.
+  bool RefillSmallAllocBlocks(int size_class, size_t max_blocks,
+                              std::vector<void*>* blocks);
+
+  // Zero if the small-allocation cache is disabled.
+  size_t small_alloc_arena_bytes_ = 0;
+  // The arena's bounds, published once it has been allocated.
+  std::atomic<char*> small_alloc_arena_{nullptr};
+  char* small_alloc_arena_end_ = nullptr;
+  std::unique_ptr<SmallAllocShard[]> small_alloc_shards_;
+
+  mutex small_alloc_pool_mu_;
+  // True once allocation of the arena has been attempted.
+  bool small_alloc_arena_initialized_ TF_GUARDED_BY(small_alloc_pool_mu_) =
+      false;
+  // The size of the arena chunk as accounted for in `stats_`.
+  int64 small_alloc_arena_chunk_bytes_ = 0;
+  size_t small_alloc_num_slabs_ = 0;
+  size_t small_alloc_next_slab_ TF_GUARDED_BY(small_alloc_pool_mu_) = 0;
+  // The size class of each carved slab.
+  std::unique_ptr<int8[]> small_alloc_slab_class_;
+  std::vector<void*> small_alloc_pool_[kNumSmallAllocClasses] TF_GUARDED_BY(
+      small_alloc_pool_mu_);
+
   friend class GPUBFCAllocatorPrivateMethodsTest;
   TF_DISALLOW_COPY_AND_ASSIGN(BFCAllocator);
 };
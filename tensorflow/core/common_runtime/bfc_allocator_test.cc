@@ -0,0 +1,204 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+SubAllocator* NewCPUSubAllocator() {
+  return new BasicCPUAllocator(port::kNUMANoAffinity, {}, {});
+}
+
+void CheckNoOverlap(const BFCAllocator& a, std::vector<void*> ptrs) {
+  std::sort(ptrs.begin(), ptrs.end());
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    ASSERT_NE(ptrs[i], ptrs[i - 1]);
+    ASSERT_GE(static_cast<char*>(ptrs[i]) - static_cast<char*>(ptrs[i - 1]),
+              a.RequestedSize(ptrs[i - 1]));
+  }
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheDisabledByDefault) {
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  void* p = a.AllocateRaw(64, 100);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 1);
+  EXPECT_EQ(stats->num_cached_allocs, 0);
+  EXPECT_EQ(stats->cached_free_bytes, 0);
+  a.DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCache) {
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  a.EnableSmallAllocationCache(1 << 20);
+
+  std::vector<void*> ptrs;
+  for (int s = 1; s <= BFCAllocator::kSmallAllocMaxBytes; s += 37) {
+    void* raw = a.AllocateRaw(64, s);
+    ASSERT_NE(raw, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(raw) % 64, 0);
+    EXPECT_GE(a.AllocatedSize(raw), s);
+    EXPECT_LE(a.AllocatedSize(raw), std::max(2 * s, 256));
+    ptrs.push_back(raw);
+  }
+  CheckNoOverlap(a, ptrs);
+
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, ptrs.size());
+  EXPECT_EQ(stats->num_cached_allocs, ptrs.size());
+  int64 expected_bytes_in_use = 0;
+  for (void* p : ptrs) expected_bytes_in_use += a.AllocatedSize(p);
+  EXPECT_EQ(stats->bytes_in_use, expected_bytes_in_use);
+  EXPECT_EQ(stats->cached_free_bytes, (1 << 20) - expected_bytes_in_use);
+
+  // Large requests bypass the cache.
+  void* large = a.AllocateRaw(64, 2 * BFCAllocator::kSmallAllocMaxBytes);
+  stats = a.GetStats();
+  EXPECT_EQ(stats->num_allocs, ptrs.size() + 1);
+  EXPECT_EQ(stats->num_cached_allocs, ptrs.size());
+  a.DeallocateRaw(large);
+
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  stats = a.GetStats();
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_EQ(stats->cached_free_bytes, 1 << 20);
+
+  // Freed blocks are reused.
+  void* p = a.AllocateRaw(64, 100);
+  EXPECT_NE(std::find(ptrs.begin(), ptrs.end(), p), ptrs.end());
+  a.DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheFallsBackWhenExhausted) {
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  // Room for a single slab of 256 blocks of 256 bytes.
+  a.EnableSmallAllocationCache(64 << 10);
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 300; ++i) {
+    void* raw = a.AllocateRaw(64, 200);
+    ASSERT_NE(raw, nullptr);
+    ptrs.push_back(raw);
+  }
+  CheckNoOverlap(a, ptrs);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(stats->num_allocs, 300);
+  EXPECT_EQ(stats->num_cached_allocs, 256);
+  EXPECT_EQ(stats->bytes_in_use, 300 * 256);
+
+  // Other size classes cannot carve a new slab, so they use the BFC bins too.
+  void* other = a.AllocateRaw(64, 1000);
+  stats = a.GetStats();
+  EXPECT_EQ(stats->num_cached_allocs, 256);
+  a.DeallocateRaw(other);
+
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  stats = a.GetStats();
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheMultithreaded) {
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  a.EnableSmallAllocationCache(4 << 20);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumIters = 1000;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumThreads);
+    for (int t = 0; t < kNumThreads; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> live;
+        for (int i = 0; i < kNumIters; ++i) {
+          const size_t size = 1 + (i * 131 + t * 17) % 4096;
+          char* p = static_cast<char*>(a.AllocateRaw(64, size));
+          CHECK(p != nullptr);
+          p[0] = p[size - 1] = static_cast<char>(t);
+          live.push_back(p);
+          if (live.size() > 32) {
+            // Free from the middle, so that blocks migrate between shards
+            // when threads are rescheduled.
+            a.DeallocateRaw(live[live.size() / 2]);
+            live.erase(live.begin() + live.size() / 2);
+          }
+        }
+        for (void* p : live) a.DeallocateRaw(p);
+      });
+    }
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  EXPECT_EQ(stats->num_allocs, kNumThreads * kNumIters);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+void BM_SmallAllocations(int iters, int arena_mb) {
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  if (arena_mb > 0) a.EnableSmallAllocationCache(arena_mb << 20);
+  std::vector<void*> ptrs(16);
+  for (int i = 0; i < iters; ++i) {
+    for (int j = 0; j < ptrs.size(); ++j) {
+      ptrs[j] = a.AllocateRaw(64, 64 * (j + 1));
+    }
+    for (void* p : ptrs) a.DeallocateRaw(p);
+  }
+}
+BENCHMARK(BM_SmallAllocations)->Arg(0)->Arg(16);
+
+// Measures contention on the allocator, with each of `num_threads` threads
+// running the loop of BM_SmallAllocations.
+void BM_ConcurrentSmallAllocations(int iters, int num_threads, int arena_mb) {
+  testing::StopTiming();
+  BFCAllocator a(NewCPUSubAllocator(), 1 << 30, true, "cpu_bfc");
+  if (arena_mb > 0) a.EnableSmallAllocationCache(arena_mb << 20);
+  const int iters_per_thread = std::max(1, iters / num_threads);
+  {
+    thread::ThreadPool pool(Env::Default(), "bench", num_threads);
+    testing::StartTiming();
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&a, iters_per_thread]() {
+        std::vector<void*> ptrs(16);
+        for (int i = 0; i < iters_per_thread; ++i) {
+          for (int j = 0; j < ptrs.size(); ++j) {
+            ptrs[j] = a.AllocateRaw(64, 64 * (j + 1));
+          }
+          for (void* p : ptrs) a.DeallocateRaw(p);
+        }
+      });
+    }
+  }
+  testing::StopTiming();
+}
+BENCHMARK(BM_ConcurrentSmallAllocations)
+    ->ArgPair(1, 0)
+    ->ArgPair(4, 0)
+    ->ArgPair(16, 0)
+    ->ArgPair(1, 16)
+    ->ArgPair(4, 16)
+    ->ArgPair(16, 16);
+
+}  // namespace
+}  // namespace tensorflow
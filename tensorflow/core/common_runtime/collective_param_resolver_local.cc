@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -40,10 +41,23 @@ void CollectiveParamResolverLocal::InstanceRec::WaitForOutMu(mutex_lock& lock) {
   while (!out_mu_available) out_cv.wait(lock);
 }
 
+namespace {
+bool ElasticGroupsEnabled() {
+  bool enabled = false;
+  Status s =
+      ReadBoolFromEnvVar("TF_COLLECTIVE_ELASTIC_GROUPS", false, &enabled);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+  return enabled;
+}
+}  // namespace
+
 CollectiveParamResolverLocal::CollectiveParamResolverLocal(
     const ConfigProto& config, const DeviceMgr* dev_mgr,
     DeviceResolverInterface* dev_resolver, const string& task_name)
     : nccl_(config.experimental().collective_nccl()),
+      elastic_groups_(ElasticGroupsEnabled()),
       dev_mgr_(dev_mgr),
       dev_resolver_(dev_resolver),
       task_name_(task_name) {}
@@ -85,8 +99,20 @@ void CollectiveParamResolverLocal::CompleteGroupLocal(
   {
     mutex_lock l(group_mu_);
     auto it = group_table_.find(cp->group.group_key);
+    int64 generation = 0;
+    if (it != group_table_.end() &&
+        GroupNeedsReform(it->second.get(), device, *cp)) {
+      VLOG(1) << "Re-forming group_key=" << cp->group.group_key
+              << " with group_size=" << cp->group.group_size << " for device "
+              << device;
+      generation = it->second->generation + 1;
+      retired_groups_.push_back(std::move(it->second));
+      group_table_.erase(it);
+      it = group_table_.end();
+    }
     if (it == group_table_.end()) {
       gr = new GroupRec;
+      gr->generation = generation;
       gr->group.group_key = cp->group.group_key;
       gr->group.group_size = cp->group.group_size;
       gr->group.device_type = cp->group.device_type;
@@ -208,6 +234,19 @@ void CollectiveParamResolverLocal::CompleteGroupLocal(
   }
 }
 
+bool CollectiveParamResolverLocal::GroupNeedsReform(
+    const GroupRec* gr, const string& device,
+    const CollectiveParams& cp) const {
+  if (!elastic_groups_) return false;
+  mutex_lock l(gr->mu);
+  if (!gr->status.ok()) return true;
+  // Members of a group that is still forming wait for it, so that the group is
+  // re-formed only once all its members joined.
+  if (gr->device_set.size() < gr->group.group_size) return false;
+  return cp.group.group_size != gr->group.group_size ||
+         gr->device_set.find(device) == gr->device_set.end();
+}
+
 namespace {
 struct DevRec {
   string task;
@@ -576,10 +615,28 @@ void CollectiveParamResolverLocal::FindInstanceRec(
     const GroupRec* gr, CollectiveParams* cp, const InstanceRecCallback& done) {
   InstanceRec* irec = nullptr;
   bool exit_outside_locks = false;
+  Status stale_group;
   {
     mutex_lock l(instance_mu_);
     auto it = instance_table_.find(cp->instance.instance_key);
-    if (it != instance_table_.end()) {
+    if (it != instance_table_.end() && it->second->group_rec != gr &&
+        it->second->group_rec->group.group_key == gr->group.group_key) {
+      if (it->second->group_rec->generation < gr->generation) {
+        // The group was re-formed since the instance was initialized.
+        VLOG(1) << "Re-initializing instance_key="
+                << cp->instance.instance_key
+                << " for re-formed group_key=" << cp->group.group_key;
+        retired_instances_.push_back(std::move(it->second));
+        instance_table_.erase(it);
+        it = instance_table_.end();
+      } else {
+        stale_group = errors::Aborted(
+            "Collective Op ", cp->name, " with instance_key ",
+            cp->instance.instance_key, " was resolved for group_key ",
+            cp->group.group_key, " before that group was re-formed");
+      }
+    }
+    if (stale_group.ok() && it != instance_table_.end()) {
       irec = it->second.get();
       {
         mutex_lock l(irec->in_mu);
@@ -592,12 +649,17 @@ void CollectiveParamResolverLocal::FindInstanceRec(
           return;
         }
       }
-    } else {
+    } else if (stale_group.ok()) {
       // Create new InstanceRec.
       irec = new InstanceRec;
+      irec->group_rec = gr;
       instance_table_[cp->instance.instance_key].reset(irec);
     }
   }
+  if (!stale_group.ok()) {
+    done(stale_group, nullptr);
+    return;
+  }
   if (exit_outside_locks) {
     CallbackWithStatus(done, irec);
     return;
@@ -695,7 +757,16 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
-  cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // The hierarchical ring needs the same number of CPU devices in every task;
+  // otherwise the hint falls back to the flat ring.
+  bool use_hierarchical =
+      !use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint == "hierarchical" &&
+      cp->group.device_type == DEVICE_CPU &&
+      cp->instance.same_num_devices_per_task;
+  cp->instance.impl_details.collective_name =
+      use_hierarchical ? "HierarchicalRingReduce"
+                       : GetCollectiveName(cp, use_nccl);
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
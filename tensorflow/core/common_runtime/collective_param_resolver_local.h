@@ -72,6 +72,9 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
     std::set<string> task_set TF_GUARDED_BY(mu);
     std::vector<string> task_list TF_GUARDED_BY(mu);
     std::vector<StatusCallback> waiting TF_GUARDED_BY(mu);
+    // Number of times the group with this group_key was re-formed before this
+    // record was created.  Constant after creation.
+    int64 generation = 0;
   };
 
   // Finds the GroupRec that corresponds to cp->group_key.
@@ -86,6 +89,13 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
                           const GroupRecCallback& done)
       TF_LOCKS_EXCLUDED(group_mu_);
 
+  // Returns true if elastic groups are enabled and `gr` has to be re-formed
+  // for `device` to join it with cp.group, i.e. if `gr` failed, or is complete
+  // but has another size or does not contain `device`.
+  bool GroupNeedsReform(const GroupRec* gr, const string& device,
+                        const CollectiveParams& cp) const
+      TF_LOCKS_EXCLUDED(gr->mu);
+
   // Used to complete/verify CollInstance.
   struct InstanceRec;
 
@@ -140,6 +150,11 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
     std::vector<bool> known TF_GUARDED_BY(out_mu);
     std::vector<IRConsumer> known_waiters TF_GUARDED_BY(out_mu);
 
+    // The group this instance was initialized for.  Set on creation, while
+    // holding instance_mu_.  An instance of a group that was re-formed since
+    // is initialized again for the new group.
+    const GroupRec* group_rec = nullptr;
+
     InstanceRec()
         : is_init(false),
           out_mu_available(true),
@@ -228,15 +243,26 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
       TF_LOCKS_EXCLUDED(irec->out_mu);
 
   const bool nccl_;
+  // If true, a group can be re-formed with other members or another size once
+  // it is complete, e.g. by the surviving members after a failure, or to add
+  // late joiners.  Set with TF_COLLECTIVE_ELASTIC_GROUPS.
+  const bool elastic_groups_;
   const DeviceMgr* dev_mgr_;
   DeviceResolverInterface* dev_resolver_;  // Not owned.
   string task_name_;
   mutex group_mu_;
   gtl::FlatMap<int32, std::unique_ptr<GroupRec>> group_table_
       TF_GUARDED_BY(group_mu_);
+  // Groups replaced in group_table_ by a re-formed group.  They are kept, like
+  // the records in the table, since callbacks may still hold them.
+  std::vector<std::unique_ptr<GroupRec>> retired_groups_
+      TF_GUARDED_BY(group_mu_);
   mutex instance_mu_;
   gtl::FlatMap<int32, std::unique_ptr<InstanceRec>> instance_table_
       TF_GUARDED_BY(instance_mu_);
+  // Instances replaced in instance_table_ after their group was re-formed.
+  std::vector<std::unique_ptr<InstanceRec>> retired_instances_
+      TF_GUARDED_BY(instance_mu_);
 };
 
 }  // namespace tensorflow
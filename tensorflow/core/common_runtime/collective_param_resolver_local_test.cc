@@ -201,6 +201,84 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+// Completes the params of a reduction over the first `group_size` devices.
+void CompleteReduction(ParamResolverInterface* prl, int group_size,
+                       std::vector<CollectiveParams>* cps,
+                       std::vector<Status>* statuses) {
+  cps->resize(group_size);
+  statuses->resize(group_size);
+  std::vector<Notification> note(group_size);
+  for (int i = 0; i < group_size; ++i) {
+    CollectiveParams* cp = &(*cps)[i];
+    cp->group.group_key = 1;
+    cp->group.group_size = group_size;
+    cp->group.device_type = DeviceType("CPU");
+    cp->group.num_tasks = 1;
+    cp->instance.instance_key = 7;
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.data_type = DataType(DT_FLOAT);
+    cp->instance.shape = TensorShape({5});
+    cp->instance.device_names.push_back(
+        strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i));
+    cp->instance.impl_details.subdiv_offsets.push_back(0);
+    cp->is_source = false;
+    Env::Default()->SchedClosure([prl, i, cp, &note, statuses]() {
+      prl->CompleteParamsAsync(cp->instance.device_names[0], cp,
+                               nullptr /*CancellationManager*/,
+                               [statuses, &note, i](const Status& s) {
+                                 (*statuses)[i] = s;
+                                 note[i].Notify();
+                               });
+    });
+  }
+  for (int i = 0; i < group_size; ++i) {
+    note[i].WaitForNotification();
+  }
+}
+
+TEST_F(CollectiveParamResolverLocalTest, ElasticGroupReformsWithSurvivors) {
+  setenv("TF_COLLECTIVE_ELASTIC_GROUPS", "true", 1);
+  prl_.reset(new CollectiveParamResolverLocal(
+      ConfigProto(), device_mgr_.get(), drl_.get(),
+      "/job:localhost/replica:0/task:0"));
+  unsetenv("TF_COLLECTIVE_ELASTIC_GROUPS");
+
+  std::vector<CollectiveParams> cps;
+  std::vector<Status> statuses;
+  CompleteReduction(prl_.get(), NUM_DEVS, &cps, &statuses);
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    EXPECT_EQ(cps[i].instance.device_names.size(), NUM_DEVS);
+  }
+
+  // The surviving devices re-form the group, and the instance is resolved
+  // again for the smaller group.
+  CompleteReduction(prl_.get(), NUM_DEVS - 1, &cps, &statuses);
+  for (int i = 0; i < NUM_DEVS - 1; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    ASSERT_EQ(cps[i].instance.device_names.size(), NUM_DEVS - 1);
+    for (int j = 0; j < NUM_DEVS - 1; ++j) {
+      EXPECT_EQ(
+          strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", j),
+          cps[i].instance.device_names[j]);
+    }
+    EXPECT_EQ(cps[i].default_rank, i);
+  }
+}
+
+TEST_F(CollectiveParamResolverLocalTest, GroupSizeChangeFailsWithoutElastic) {
+  std::vector<CollectiveParams> cps;
+  std::vector<Status> statuses;
+  CompleteReduction(prl_.get(), NUM_DEVS, &cps, &statuses);
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+  }
+  CompleteReduction(prl_.get(), NUM_DEVS - 1, &cps, &statuses);
+  for (int i = 0; i < NUM_DEVS - 1; ++i) {
+    EXPECT_EQ(error::INTERNAL, statuses[i].code());
+  }
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
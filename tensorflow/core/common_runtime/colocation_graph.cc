@@ -47,6 +47,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
@@ -60,6 +63,13 @@ namespace {
 const StringPiece kColocationAttrNameStringPiece(kColocationAttrName);
 const StringPiece kColocationGroupPrefixStringPiece(kColocationGroupPrefix);
 
+// Graphs with at least this many op nodes initialize their members on a
+// thread pool of at most kMaxParallelInitializationThreads threads.
+constexpr size_t kMinNodesForParallelInitialization = 4096;
+constexpr int kMaxParallelInitializationThreads = 16;
+// Rough cost of one InitializeMember() call, in cycles.
+constexpr int64 kInitializeMemberCost = 10000;
+
 // Using absl::StrJoin with lambda does not work in tf-lite builds.
 std::vector<string> DevicesToString(const std::vector<Device*> devices) {
   std::vector<string> v;
@@ -1291,10 +1301,42 @@ Status ColocationGraph::GetDevicesForNode(
 }
 
 Status ColocationGraph::InitializeMembers() {
+  std::vector<Node*> nodes;
+  nodes.reserve(graph_.num_op_nodes());
   for (Node* node : graph_.op_nodes()) {
-    Status status = InitializeMember(*node, &members_[node->id()]);
-    if (!status.ok()) {
-      return AttachDef(status, *node);
+    nodes.push_back(node);
+  }
+
+  // Initializing a member looks up the kernels registered for its node, and
+  // members are independent of each other, so large graphs do it in parallel.
+  const int num_threads =
+      std::min(port::MaxParallelism(), kMaxParallelInitializationThreads);
+  if (nodes.size() < kMinNodesForParallelInitialization || num_threads <= 1) {
+    for (Node* node : nodes) {
+      Status status = InitializeMember(*node, &members_[node->id()]);
+      if (!status.ok()) {
+        return AttachDef(status, *node);
+      }
+    }
+    return Status::OK();
+  }
+
+  std::vector<Status> statuses(nodes.size());
+  {
+    thread::ThreadPool pool(Env::Default(), "colocation_graph_init",
+                            num_threads);
+    pool.ParallelFor(nodes.size(), kInitializeMemberCost,
+                     [this, &nodes, &statuses](int64 begin, int64 end) {
+                       for (int64 i = begin; i < end; ++i) {
+                         statuses[i] = InitializeMember(
+                             *nodes[i], &members_[nodes[i]->id()]);
+                       }
+                     });
+  }
+  // Report the error of the first failing node, as the sequential loop does.
+  for (int i = 0; i < nodes.size(); ++i) {
+    if (!statuses[i].ok()) {
+      return AttachDef(statuses[i], *nodes[i]);
     }
   }
   return Status::OK();
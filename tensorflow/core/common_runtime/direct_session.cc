@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -1396,6 +1397,9 @@ Status DirectSession::CreateExecutors(
       if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
         delete kernel;
     };
+    params.use_static_memory_plan =
+        options_.config.experimental().use_static_memory_plan() &&
+        device->device_type() == DEVICE_CPU;
 
     optimizer.Optimize(lib, options_.env, device, &partition_graph,
                        /*shape_map=*/nullptr);
@@ -1850,6 +1854,15 @@ Status DirectSession::MakeCallable(const CallableOptions& callable_options,
   RunStateArgs run_state_args(callable_options.run_options().debug_options());
   TF_RETURN_IF_ERROR(
       CreateExecutors(callable_options, &ek, &func_info, &run_state_args));
+  if (callable_options.fetch_into_caller_buffers()) {
+    ek->fetch_into_caller_buffers.resize(ek->output_types.size());
+    for (int i = 0; i < ek->output_types.size(); ++i) {
+      ek->fetch_into_caller_buffers[i] =
+          DataTypeCanUseMemcpy(ek->output_types[i]) &&
+          callable_options.fetch_devices().count(callable_options.fetch(i)) ==
+              0;
+    }
+  }
   {
     mutex_lock l(callables_lock_);
     *out_handle = next_callable_handle_++;
@@ -1889,7 +1902,17 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     if (index > fetch_tensors_->size()) {
       return errors::Internal("RetVal index out of bounds: ", index);
     }
-    (*fetch_tensors_)[index] = val;
+    Tensor* fetch = &(*fetch_tensors_)[index];
+    if (!executors_and_keys_->fetch_into_caller_buffers.empty() &&
+        executors_and_keys_->fetch_into_caller_buffers[index] &&
+        CanWriteInPlace(*fetch, val)) {
+      // The caller owns the only reference to `fetch`, so it can be
+      // overwritten without affecting any other tensor.
+      std::memcpy(const_cast<char*>(fetch->tensor_data().data()),
+                  val.tensor_data().data(), val.TotalBytes());
+    } else {
+      *fetch = val;
+    }
     return Status::OK();
   }
 
@@ -1898,6 +1921,11 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
   const std::vector<Tensor>* const feed_tensors_;  // Not owned.
   std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+
+  static bool CanWriteInPlace(const Tensor& fetch, const Tensor& val) {
+    return fetch.IsInitialized() && fetch.dtype() == val.dtype() &&
+           fetch.shape() == val.shape() && fetch.RefCountIsOne();
+  }
 };
 
 ::tensorflow::Status DirectSession::RunCallable(
@@ -174,6 +174,9 @@ class DirectSession : public Session {
     DataTypeVector output_types;
 
     CallableOptions callable_options;
+    // For callables, whether the value of each fetch may be written in place
+    // into the caller's buffer. See CallableOptions.fetch_into_caller_buffers.
+    std::vector<bool> fetch_into_caller_buffers;
 
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
   };
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/function_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -198,6 +199,47 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   }
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_CallableFetchIntoBuffers) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({}, {y_ + ":0"}, {y_neg_});
+  callable_options.set_fetch_into_caller_buffers(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  // A matching caller buffer is written in place on every call.
+  std::vector<Tensor> outputs(1, Tensor(DT_FLOAT, TensorShape({2, 1})));
+  const char* buffer = outputs[0].tensor_data().data();
+  for (int i = 0; i < 2; ++i) {
+    outputs[0].matrix<float>()(0, 0) = 0;
+    TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(buffer, outputs[0].tensor_data().data());
+    EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+  }
+
+  // A buffer with the wrong shape is replaced.
+  outputs[0] = Tensor(DT_FLOAT, TensorShape({2}));
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  EXPECT_EQ(TensorShape({2, 1}), outputs[0].shape());
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  // A buffer shared with another tensor is replaced and left unchanged.
+  outputs[0] = Tensor(DT_FLOAT, TensorShape({2, 1}));
+  outputs[0].matrix<float>()(0, 0) = 0;
+  Tensor alias = outputs[0];
+  TF_ASSERT_OK(session->RunCallable(handle, {}, &outputs, nullptr));
+  EXPECT_FALSE(alias.SharesBufferWith(outputs[0]));
+  EXPECT_FLOAT_EQ(0.0, alias.matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_OptimizeForStaticGraph) {
   Initialize({3, 2, -1, 0});
   SessionOptions options(DefaultSessionOptions());
@@ -2701,6 +2743,111 @@ BENCHMARK(BM_FeedFetchCallableSingleThreadExecutor)
     ->Arg(5)
     ->Arg(10);
 
+// Returns options that keep the graph as built, so that the benchmarks below
+// measure the runtime rather than what Grappler and inlining remove.
+SessionOptions UnoptimizedSessionOptions() {
+  SessionOptions opts;
+  OptimizerOptions* optimizer_options =
+      opts.config.mutable_graph_options()->mutable_optimizer_options();
+  optimizer_options->set_opt_level(OptimizerOptions::L0);
+  optimizer_options->set_do_function_inlining(false);
+  opts.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+  return opts;
+}
+
+// Runs `handle` once to warm up, then `iters` times under the timer.
+void RunCallableBenchmark(int iters, Session* session,
+                          Session::CallableHandle handle,
+                          const std::vector<Tensor>& inputs) {
+  std::vector<Tensor> output_values;
+  TF_CHECK_OK(session->RunCallable(handle, inputs, &output_values, nullptr));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    output_values.clear();
+    TF_CHECK_OK(session->RunCallable(handle, inputs, &output_values, nullptr));
+  }
+  testing::StopTiming();
+}
+
+// Measures the per-node cost of a step, on a chain of `num_nodes` Identity
+// nodes between one feed and one fetch.
+void BM_SessionRunChain(int iters, int num_nodes) {
+  testing::StopTiming();
+  Graph g(OpRegistry::Global());
+  Node* placeholder;
+  TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                  .Attr("shape", TensorShape())
+                  .Attr("dtype", DT_FLOAT)
+                  .Device("/cpu:0")
+                  .Finalize(&g, &placeholder));
+  Node* last = placeholder;
+  for (int i = 0; i < num_nodes; ++i) {
+    TF_CHECK_OK(NodeBuilder(g.NewName("Identity"), "Identity")
+                    .Input(last)
+                    .Attr("T", DT_FLOAT)
+                    .Device("/cpu:0")
+                    .Finalize(&g, &last));
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  std::unique_ptr<Session> session(NewSession(UnoptimizedSessionOptions()));
+  TF_CHECK_OK(session->Create(gd));
+  CallableOptions callable_options;
+  callable_options.add_feed(placeholder->name() + ":0");
+  callable_options.add_fetch(last->name() + ":0");
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(callable_options, &handle));
+
+  Tensor value(DT_FLOAT, TensorShape());
+  value.flat<float>()(0) = 37.0;
+  RunCallableBenchmark(iters, session.get(), handle, {value});
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_nodes);
+}
+
+// Measures the cost of `num_calls` sequential calls to a function that is
+// not inlined, each of which runs on its own executor.
+void BM_SessionRunFunctionCall(int iters, int num_calls) {
+  testing::StopTiming();
+  FunctionDefLibrary library;
+  *library.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition flib(OpRegistry::Global(), library);
+  Graph g(&flib);
+  Node* placeholder;
+  TF_CHECK_OK(NodeBuilder(g.NewName("Placeholder"), "Placeholder")
+                  .Attr("shape", TensorShape())
+                  .Attr("dtype", DT_FLOAT)
+                  .Device("/cpu:0")
+                  .Finalize(&g, &placeholder));
+  Node* last = placeholder;
+  for (int i = 0; i < num_calls; ++i) {
+    TF_CHECK_OK(NodeBuilder(g.NewName("XTimesTwo"), "XTimesTwo", &flib)
+                    .Input(last)
+                    .Attr("T", DT_FLOAT)
+                    .Device("/cpu:0")
+                    .Finalize(&g, &last));
+  }
+  GraphDef gd;
+  g.ToGraphDef(&gd);
+  *gd.mutable_library() = library;
+  std::unique_ptr<Session> session(NewSession(UnoptimizedSessionOptions()));
+  TF_CHECK_OK(session->Create(gd));
+  CallableOptions callable_options;
+  callable_options.add_feed(placeholder->name() + ":0");
+  callable_options.add_fetch(last->name() + ":0");
+  Session::CallableHandle handle;
+  TF_CHECK_OK(session->MakeCallable(callable_options, &handle));
+
+  Tensor value(DT_FLOAT, TensorShape());
+  value.flat<float>()(0) = 1.0;
+  RunCallableBenchmark(iters, session.get(), handle, {value});
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_calls);
+}
+
+BENCHMARK(BM_SessionRunChain)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_SessionRunFunctionCall)->Arg(1)->Arg(10)->Arg(100);
+
 }  // namespace
 
 class DirectSessionCollectiveTest : public ::testing::Test {
@@ -208,7 +208,11 @@ void AttrBuilder::FillAttrValueMapWithoutDefaults(AttrValueMap* m) const {
 
 void AttrBuilder::AddAttrIfNotPresent(StringPiece attr_name,
                                       const AttrValue& value) {
-  encoded_attrs_.emplace(string(attr_name), value.SerializeAsString());
+  auto result =
+      encoded_attrs_.emplace(string(attr_name), value.SerializeAsString());
+  if (result.second) {
+    UpdateAttrsFingerprint(attr_name, result.first->second);
+  }
 }
 
 const NodeDef& AttrBuilder::BuildNodeDef() {
@@ -225,8 +229,11 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 }
 
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
-  encoded_attrs_.insert(other.encoded_attrs_.begin(),
-                        other.encoded_attrs_.end());
+  for (const auto& p : other.encoded_attrs_) {
+    if (encoded_attrs_.insert(p).second) {
+      UpdateAttrsFingerprint(p.first, p.second);
+    }
+  }
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -270,6 +277,14 @@ inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
 
 }  // namespace
 
+void AttrBuilder::UpdateAttrsFingerprint(StringPiece attr_name,
+                                         const string& encoded_value) {
+  CombineUnordered(
+      CacheKeyHelper(attr_name, tensorflow::Fingerprint128(encoded_value)),
+      &attrs_fingerprint_);
+  cached_cache_key_ = absl::nullopt;
+}
+
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
   if (!cached_cache_key_ || device != device_for_cached_cache_key_) {
     cached_cache_key_ = BuildCacheKeyForDevice(device);
@@ -281,13 +296,8 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
 
 tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
     const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
-  for (const auto& p : encoded_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
-  }
-  return f;
+  return tensorflow::FingerprintCat128(attrs_fingerprint_,
+                                       tensorflow::Fingerprint128(device));
 }
 
 void AttrBuilder::InitializeNodeDef() {
@@ -99,6 +99,7 @@ class AttrBuilder {
     encoded_attrs_.clear();
     node_def_initialized_ = false;
     node_def_finalized_ = false;
+    attrs_fingerprint_ = Fingerprint128(op_name_);
     cached_cache_key_ = absl::nullopt;
     device_for_cached_cache_key_.clear();
   }
@@ -112,7 +113,6 @@ class AttrBuilder {
   AttrBuilder& Set(StringPiece attr_name, T&& value) {
     SetAttrValue(value, &attr_tmp_);
     AddAttrIfNotPresent(attr_name, attr_tmp_);
-    cached_cache_key_ = absl::nullopt;
     return *this;
   }
 
@@ -120,7 +120,6 @@ class AttrBuilder {
 
   AttrBuilder& Set(StringPiece attr_name, const AttrValue& value) {
     AddAttrIfNotPresent(attr_name, value);
-    cached_cache_key_ = absl::nullopt;
     return *this;
   }
 
@@ -140,6 +139,9 @@ class AttrBuilder {
     return GetNodeAttr(AttrSlice(node_def_), attr_name, value);
   }
 
+  // Returns a fingerprint of the op name, `device` and the attributes set so
+  // far. The fingerprint of the attributes is maintained as they are added,
+  // so this is cheap when called repeatedly.
   tensorflow::Fprint128 CacheKey(const StringPiece device);
 
   // Fill `m` with the attr-value pairs set via AttrBuilder::Set() so far, as
@@ -164,6 +166,10 @@ class AttrBuilder {
  private:
   tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device) const;
 
+  // Adds the fingerprint of a newly added attribute to attrs_fingerprint_.
+  void UpdateAttrsFingerprint(StringPiece attr_name,
+                              const string& encoded_value);
+
   // Initialize the node_def_ object.
   // REQUIRES: node_def_initialized_ = false
   void InitializeNodeDef();
@@ -188,6 +194,8 @@ class AttrBuilder {
   bool node_def_initialized_;
   bool node_def_finalized_;
 
+  // Order independent fingerprint of the op name and encoded_attrs_.
+  tensorflow::Fprint128 attrs_fingerprint_ = {0, 0};
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
 };
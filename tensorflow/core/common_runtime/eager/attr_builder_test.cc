@@ -83,6 +83,30 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyIsIndependentOfAttrOrder) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  a.Set("x", 1.0);
+  AttrBuilder b("op_name");
+  b.Set("x", 1.0);
+  b.Set("T", TF_FLOAT);
+  ASSERT_TRUE(a.CacheKey("cpu:0") == b.CacheKey("cpu:0"));
+
+  // The first value set for an attribute prevails.
+  tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+  a.Set("x", 2.0);
+  ASSERT_TRUE(cache_key == a.CacheKey("cpu:0"));
+
+  AttrBuilder c("op_name");
+  c.Set("T", TF_FLOAT);
+  c.CopyAttributes(b);
+  ASSERT_TRUE(cache_key == c.CacheKey("cpu:0"));
+
+  c.Reset("op_name");
+  ASSERT_FALSE(cache_key == c.CacheKey("cpu:0"));
+  ASSERT_TRUE(AttrBuilder("op_name").CacheKey("cpu:0") == c.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
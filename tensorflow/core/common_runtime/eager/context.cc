@@ -385,6 +385,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
   mutex_lock ml(cache_mu_);
   default_executor_.WaitForAllPendingNodes().IgnoreError();
   kernel_cache_.clear();
+  ++kernel_cache_generation_;
   for (auto& entry : registered_functions_) {
     entry.second->cached_kernel_keys->clear();
   }
@@ -768,6 +769,7 @@ Status EagerContext::RemoveFunction(const string& func) {
       for (auto& key : *registered_function->cached_kernel_keys) {
         kernel_cache_.erase(key);
       }
+      ++kernel_cache_generation_;
       registered_functions_.erase(func);
     }
     registered_function->Unref();
@@ -839,12 +841,38 @@ core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
   return new_ref;
 }
 
+core::RefCountPtr<KernelAndDevice> EagerContext::GetCachedKernel(
+    Fprint128 cache_key, KernelCacheMemo* memo) {
+  tf_shared_lock l(cache_mu_);
+  KernelAndDevice* kernel = nullptr;
+  if (memo->kernel != nullptr && memo->cache_key == cache_key &&
+      memo->generation == kernel_cache_generation_) {
+    kernel = memo->kernel;
+  } else {
+    auto iter = kernel_cache_.find(cache_key);
+    if (iter == kernel_cache_.end()) {
+      return nullptr;
+    }
+    kernel = iter->second.get();
+    memo->cache_key = cache_key;
+    memo->kernel = kernel;
+    memo->generation = kernel_cache_generation_;
+  }
+  core::RefCountPtr<KernelAndDevice> new_ref(kernel);
+  new_ref->Ref();
+  return new_ref;
+}
+
 void EagerContext::AddKernelToCache(Fprint128 cache_key,
                                     KernelAndDevice* kernel) {
   mutex_lock ml(cache_mu_);
   core::RefCountPtr<KernelAndDevice> new_ref(kernel);
   new_ref->Ref();
-  kernel_cache_[cache_key] = std::move(new_ref);
+  auto& entry = kernel_cache_[cache_key];
+  if (entry != nullptr) {
+    ++kernel_cache_generation_;
+  }
+  entry = std::move(new_ref);
   auto* registered_function =
       gtl::FindPtrOrNull(registered_functions_, kernel->name());
   // The kernel name can be either a primitive op or a function.
@@ -115,6 +115,17 @@ class RunMetadataListener {
 class TensorHandle;
 class EagerOperation;
 
+// The kernel last found in an EagerContext's kernel cache for some cache key.
+// An EagerOperation keeps one to skip the kernel cache lookup when it is run
+// repeatedly with the same attributes and device. The memo does not hold a
+// reference to `kernel`: it is only valid while the context's kernel cache
+// has not dropped any kernel since, as tracked by `generation`.
+struct KernelCacheMemo {
+  Fprint128 cache_key = {0, 0};
+  KernelAndDevice* kernel = nullptr;
+  int64 generation = -1;
+};
+
 class CustomDevice {
  public:
   virtual ~CustomDevice() {}
@@ -293,6 +304,12 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key);
 
+  // Like GetCachedKernel(cache_key), but returns the kernel in `memo` without
+  // looking up the cache if `memo` is still valid for `cache_key`. Otherwise
+  // updates `memo` with the result of the lookup.
+  core::RefCountPtr<KernelAndDevice> GetCachedKernel(Fprint128 cache_key,
+                                                     KernelCacheMemo* memo);
+
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
 
   bool LogDevicePlacement() const { return log_device_placement_; }
@@ -620,6 +637,9 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       kernel_cache_ TF_GUARDED_BY(cache_mu_);
   std::unordered_map<string, RegisteredFunction*> registered_functions_
       TF_GUARDED_BY(cache_mu_);
+  // Incremented whenever a kernel is removed from kernel_cache_, which
+  // invalidates every KernelCacheMemo.
+  int64 kernel_cache_generation_ TF_GUARDED_BY(cache_mu_) = 0;
 
   // Whether we should compute RunMetadata.
   std::atomic<bool> should_store_graphs_{false};
@@ -29,18 +29,27 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64 MaxBatchSizeFromEnv() {
+  int64 max_batch_size = 16;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_EXECUTOR_MAX_BATCH_SIZE", 16,
+                                  &max_batch_size));
+  return std::max<int64>(max_batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async)
     : next_node_id_(0),
       ok_(true),
+      num_aborts_(0),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
                     : nullptr),
       last_eager_client_(nullptr),
       enable_async_wait_for_remote_function_(
-          IsAsyncWaitForRemoteFunctionEnabled()) {}
+          IsAsyncWaitForRemoteFunctionEnabled()),
+      max_batch_size_(MaxBatchSizeFromEnv()) {}
 
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -153,7 +162,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -235,7 +244,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -259,6 +268,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       need_notification = true;
       status_ = status;
       ok_ = false;
+      ++num_aborts_;
       if (Async()) {
         // We remove any pending ops so that we don't try to execute them if
         // ClearError is called.
@@ -269,7 +279,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -318,30 +328,114 @@ void EagerExecutor::NotifyWaiters(uint64 id) {
   }
 }
 
+void EagerExecutor::PopFinishedNodesLocked(
+    const std::vector<core::RefCountPtr<NodeItem>>& finished,
+    std::vector<core::RefCountPtr<NodeItem>>* popped) {
+  // If an error occurred in the meantime, node_queue_ has been cleared and the
+  // waiters notified already.
+  if (!status_.ok()) return;
+  const size_t first_popped = popped->size();
+  for (const auto& item : finished) {
+    if (node_queue_.empty() || node_queue_.front().get() != item.get()) break;
+    DVLOG(3) << "Node Done: [id " << item->id << "] "
+             << item->node->DebugString();
+    popped->push_back(std::move(node_queue_.front()));
+    node_queue_.pop_front();
+  }
+  if (popped->size() > first_popped) {
+    NotifyWaiters((*popped)[first_popped]->id);
+  }
+}
+
 void EagerExecutor::Run() {
   auto thread_exited_notifier =
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
+  // The nodes currently being run. The queue keeps its own reference to each
+  // of them until they are done, so that WaitForAllPendingNodes does not
+  // return too early.
+  std::vector<core::RefCountPtr<NodeItem>> batch;
+  // Nodes of `batch` that ran successfully but have not been popped from
+  // node_queue_ yet.
+  std::vector<core::RefCountPtr<NodeItem>> finished;
+  // References to destroy without holding node_queue_mutex_, since some
+  // nodes' destructors can enqueue more operations onto this executor.
+  std::vector<core::RefCountPtr<NodeItem>> to_destroy;
+  uint64 batch_aborts = 0;
   while (true) {
-    core::RefCountPtr<NodeItem> curr_item;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
+      PopFinishedNodesLocked(finished, &to_destroy);
+      for (auto& item : batch) {
+        to_destroy.push_back(std::move(item));
+      }
+      batch.clear();
+      finished.clear();
       while (node_queue_.empty() || !status_.ok()) {
         if (state_ == ExecutorState::kShutDown) return;
         nodes_pending_.wait(l);
       }
-      // Obtain raw pointer since we don't want to remove from the queue until
-      // the node has been run. Otherwise, WaitForAllPendingNodes can return
-      // too early.
-      // Note, we don't std::move from the here because the front of the queue
-      // will then contain a nullptr. This can be a problem in
-      // WaitForAllPendingNodes where we get the top EagerNode pointer
-      // and register a notification for its completion.
-      curr_item.reset(node_queue_.front().get());
-      curr_item->Ref();
+      batch_aborts = num_aborts_;
+      const size_t batch_size = std::min<size_t>(
+          node_queue_.size(), static_cast<size_t>(max_batch_size_));
+      for (size_t i = 0; i < batch_size; ++i) {
+        batch.emplace_back(node_queue_[i].get());
+        batch.back()->Ref();
+      }
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
-    if (!status.ok()) {
-      VLOG(1) << "Failed to run item: " << status;
+    to_destroy.clear();
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+      const core::RefCountPtr<NodeItem>& item = batch[i];
+      // Another node may have failed asynchronously, in which case the rest of
+      // the batch has been aborted.
+      if (!ok() || num_aborts_ != batch_aborts) break;
+      Status status;
+      if (item->node->AsAsync() == nullptr) {
+        DVLOG(3) << "Running Node: [id " << item->id << "] "
+                 << item->node->DebugString();
+        status = item->node->Run();
+        if (status.ok()) {
+          DCHECK(item->state != NodeState::kDONE);
+          item->state = NodeState::kDONE;
+          finished.emplace_back(item.get());
+          finished.back()->Ref();
+          continue;
+        }
+      }
+      // Both failed and async nodes expect to be at the front of node_queue_,
+      // so pop the finished nodes first.
+      if (!finished.empty()) {
+        {
+          tensorflow::mutex_lock l(node_queue_mutex_);
+          PopFinishedNodesLocked(finished, &to_destroy);
+        }
+        finished.clear();
+        to_destroy.clear();
+      }
+      std::vector<NodeItem*> remote_batch;
+      AsyncRemoteExecuteNode* remote_node =
+          item->node->AsAsyncRemoteExecuteNode();
+      if (status.ok() && remote_node != nullptr) {
+        remote_batch.push_back(item.get());
+        while (i + 1 < batch.size()) {
+          AsyncRemoteExecuteNode* next =
+              batch[i + 1]->node->AsAsyncRemoteExecuteNode();
+          if (next == nullptr || !remote_node->CanBatchWith(*next)) break;
+          remote_batch.push_back(batch[++i].get());
+        }
+      }
+      if (!status.ok()) {
+        NodeDone(item, status, /*from_queue=*/true);
+      } else if (remote_batch.size() > 1) {
+        status = RunRemoteBatch(remote_batch);
+      } else {
+        core::RefCountPtr<NodeItem> curr_item(item.get());
+        curr_item->Ref();
+        status = RunItem(std::move(curr_item), /*from_queue=*/true);
+      }
+      if (!status.ok()) {
+        VLOG(1) << "Failed to run item: " << status;
+      }
     }
   }
 }
@@ -352,28 +446,11 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
            << item->node->DebugString();
   AsyncRemoteExecuteNode* async_remote_node =
       item->node->AsAsyncRemoteExecuteNode();
-  if (enable_async_wait_for_remote_function_) {
-    if (async_remote_node != nullptr) {
-      if (last_eager_client_ != nullptr &&
-          async_remote_node->eager_client() != nullptr &&
-          last_eager_client_ != async_remote_node->eager_client()) {
-        // Running a remote function, need to sync if the function is going to
-        // different device than last time we run remote distributed function.
-        DVLOG(3) << "Executing Sync Executor for node" << item->id;
-        tensorflow::Status status = async_remote_node->SyncExecutors();
-        if (!status.ok()) {
-          NodeDone(item, status, from_queue);
-          return status;
-        }
-        last_eager_client_ = nullptr;
-      }
-      if (async_remote_node->eager_client() != nullptr &&
-          async_remote_node->needs_remote_inputs() &&
-          async_remote_node->allow_multiple_pending_requests()) {
-        // We are running remote distributed function, update
-        // last_remote_device_name_.
-        last_eager_client_ = async_remote_node->eager_client();
-      }
+  if (async_remote_node != nullptr) {
+    Status status = MaybeSyncExecutors(async_remote_node);
+    if (!status.ok()) {
+      NodeDone(item, status, from_queue);
+      return status;
     }
   }
 
@@ -399,6 +476,64 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+Status EagerExecutor::RunRemoteBatch(const std::vector<NodeItem*>& items) {
+  DVLOG(3) << "Running " << items.size() << " remote nodes from [id "
+           << items.front()->id << "] in one request";
+  AsyncRemoteExecuteNode* first_node =
+      items.front()->node->AsAsyncRemoteExecuteNode();
+  Status sync_status = MaybeSyncExecutors(first_node);
+  if (!sync_status.ok()) {
+    core::RefCountPtr<NodeItem> first_item(items.front());
+    first_item->Ref();
+    NodeDone(first_item, sync_status, /*from_queue=*/true);
+    return sync_status;
+  }
+
+  for (NodeItem* item : items) {
+    item->state = NodeState::kSCHEDULED;
+    core::RefCountPtr<NodeItem> curr_item(item);
+    curr_item->Ref();
+    TF_RETURN_IF_ERROR(
+        MoveToUnfinished(std::move(curr_item), /*from_queue=*/true));
+  }
+
+  std::vector<AsyncRemoteExecuteNode*> nodes;
+  std::vector<StatusCallback> done;
+  nodes.reserve(items.size());
+  done.reserve(items.size());
+  for (NodeItem* item : items) {
+    nodes.push_back(item->node->AsAsyncRemoteExecuteNode());
+    item->Ref();
+    done.push_back([this, item](const Status& status) {
+      core::RefCountPtr<NodeItem> async_item(item);
+      NodeDone(async_item, status, false);
+    });
+  }
+  first_node->RunBatchAsync(nodes, std::move(done));
+
+  // Return the status of the executor in case we are in an error state.
+  return status();
+}
+
+Status EagerExecutor::MaybeSyncExecutors(AsyncRemoteExecuteNode* node) {
+  if (!enable_async_wait_for_remote_function_) return Status::OK();
+  if (last_eager_client_ != nullptr && node->eager_client() != nullptr &&
+      last_eager_client_ != node->eager_client()) {
+    // Running a remote function, need to sync if the function is going to
+    // different device than last time we run remote distributed function.
+    DVLOG(3) << "Executing Sync Executor for node " << node->DebugString();
+    TF_RETURN_IF_ERROR(node->SyncExecutors());
+    last_eager_client_ = nullptr;
+  }
+  if (node->eager_client() != nullptr && node->needs_remote_inputs() &&
+      node->allow_multiple_pending_requests()) {
+    // We are running remote distributed function, update
+    // last_remote_device_name_.
+    last_eager_client_ = node->eager_client();
+  }
+  return Status::OK();
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -408,7 +543,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -17,9 +17,9 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <deque>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
@@ -99,6 +99,21 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
   virtual bool needs_remote_inputs() const = 0;
   virtual bool allow_multiple_pending_requests() const = 0;
   virtual Status SyncExecutors() = 0;
+
+  // Returns true if `next`, which is queued right after this node, can be sent
+  // to the remote worker in the same request as this node.
+  virtual bool CanBatchWith(const AsyncRemoteExecuteNode& next) const {
+    return false;
+  }
+
+  // Runs `nodes`, which start with this node and are batchable with it, with a
+  // single request.  `done[i]` is called when `nodes[i]` is done.
+  virtual void RunBatchAsync(const std::vector<AsyncRemoteExecuteNode*>& nodes,
+                             std::vector<StatusCallback> done) {
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      nodes[i]->RunAsync(std::move(done[i]));
+    }
+  }
 };
 
 // A class for handling async execution (see TFE_ContextSetAsync).
@@ -201,9 +216,30 @@ class EagerExecutor {
   // state_ is set to kShutDown. If any errors are encountered, these are set
   // inside `status_`. The loop blocks anytime there are no pending nodes, or if
   // `status_` is not ok.
+  //
+  // Nodes are taken from node_queue_ in batches of up to max_batch_size_.
+  // Consecutive synchronous nodes of a batch run without acquiring
+  // node_queue_mutex_, and are popped from node_queue_ together once the next
+  // node needs the queue.  Consecutive remote nodes of a batch that can be
+  // batched together are sent to their remote worker in a single request.
   void Run();
 
+  // Pops `finished`, a prefix of the nodes at the front of node_queue_ that
+  // ran successfully, from node_queue_ and notifies their waiters. The popped
+  // references are moved to `popped` so that they can be destroyed without
+  // holding node_queue_mutex_.
+  void PopFinishedNodesLocked(
+      const std::vector<core::RefCountPtr<NodeItem>>& finished,
+      std::vector<core::RefCountPtr<NodeItem>>* popped)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs `items`, consecutive nodes at the front of node_queue_ that the first
+  // of them can batch with, with AsyncRemoteExecuteNode::RunBatchAsync.
+  Status RunRemoteBatch(const std::vector<NodeItem*>& items);
+  // Syncs the executors before running `node` if it goes to another remote
+  // worker than the last remote function.
+  Status MaybeSyncExecutors(AsyncRemoteExecuteNode* node);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -221,7 +257,7 @@ class EagerExecutor {
   condition_variable nodes_pending_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -232,6 +268,10 @@ class EagerExecutor {
   // EagerNode.  It remains set until ClearError is called.
   Status status_ TF_GUARDED_BY(node_queue_mutex_);
   std::atomic<bool> ok_ TF_GUARDED_BY(node_queue_mutex_);
+  // Incremented whenever an error aborts the pending nodes, so that the async
+  // thread does not run the rest of a batch taken before the error, even if
+  // ClearError was called since.
+  std::atomic<uint64> num_aborts_;
 
   // Map from id of a EagerNode to condition_variables (not owned by the map).
   // These condition_variables are notified and removed when that EagerNode is
@@ -258,6 +298,10 @@ class EagerExecutor {
 
   const bool enable_async_wait_for_remote_function_;
 
+  // Maximum number of nodes that the async thread takes from node_queue_ at a
+  // time.
+  const int64 max_batch_size_;
+
   // Callbacks to run on destruction.
   std::unordered_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 };
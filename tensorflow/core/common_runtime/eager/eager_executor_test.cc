@@ -0,0 +1,232 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Records the order in which nodes run or are aborted.
+struct Trace {
+  mutex mu;
+  std::vector<int> ran TF_GUARDED_BY(mu);
+  std::vector<int> aborted TF_GUARDED_BY(mu);
+};
+
+class TestNode : public EagerNode {
+ public:
+  TestNode(int id, Trace* trace, Status status = Status::OK())
+      : id_(id), trace_(trace), status_(status) {}
+
+  Status Run() override {
+    mutex_lock l(trace_->mu);
+    trace_->ran.push_back(id_);
+    return status_;
+  }
+
+  void Abort(Status status) override {
+    mutex_lock l(trace_->mu);
+    trace_->aborted.push_back(id_);
+  }
+
+  string DebugString() const override { return "TestNode"; }
+
+ private:
+  const int id_;
+  Trace* const trace_;
+  const Status status_;
+};
+
+class TestAsyncNode : public AsyncEagerNode {
+ public:
+  TestAsyncNode(int id, Trace* trace) : id_(id), trace_(trace) {}
+
+  void RunAsync(StatusCallback done) override {
+    {
+      mutex_lock l(trace_->mu);
+      trace_->ran.push_back(id_);
+    }
+    done(Status::OK());
+  }
+
+  void Abort(Status status) override {
+    mutex_lock l(trace_->mu);
+    trace_->aborted.push_back(id_);
+  }
+
+  string DebugString() const override { return "TestAsyncNode"; }
+
+ private:
+  const int id_;
+  Trace* const trace_;
+};
+
+// A remote node that batches with the other remote nodes.
+class TestRemoteNode : public AsyncRemoteExecuteNode {
+ public:
+  TestRemoteNode(int id, Trace* trace, std::vector<std::vector<int>>* batches)
+      : id_(id), trace_(trace), batches_(batches) {}
+
+  void RunAsync(StatusCallback done) override {
+    RunBatchAsync({this}, {std::move(done)});
+  }
+
+  bool CanBatchWith(const AsyncRemoteExecuteNode& next) const override {
+    return true;
+  }
+
+  void RunBatchAsync(const std::vector<AsyncRemoteExecuteNode*>& nodes,
+                     std::vector<StatusCallback> done) override {
+    std::vector<int> batch;
+    for (AsyncRemoteExecuteNode* node : nodes) {
+      batch.push_back(static_cast<TestRemoteNode*>(node)->id_);
+    }
+    {
+      mutex_lock l(trace_->mu);
+      trace_->ran.insert(trace_->ran.end(), batch.begin(), batch.end());
+      batches_->push_back(batch);
+    }
+    for (StatusCallback& node_done : done) {
+      node_done(Status::OK());
+    }
+  }
+
+  void Abort(Status status) override {
+    mutex_lock l(trace_->mu);
+    trace_->aborted.push_back(id_);
+  }
+
+  const eager::EagerClient* eager_client() const override { return nullptr; }
+  bool needs_remote_inputs() const override { return false; }
+  bool allow_multiple_pending_requests() const override { return false; }
+  Status SyncExecutors() override { return Status::OK(); }
+
+  string DebugString() const override { return "TestRemoteNode"; }
+
+ private:
+  const int id_;
+  Trace* const trace_;
+  std::vector<std::vector<int>>* const batches_;
+};
+
+// A node that notifies `started` and blocks until `unblock` is notified.
+class BlockingNode : public EagerNode {
+ public:
+  BlockingNode(Notification* started, Notification* unblock)
+      : started_(started), unblock_(unblock) {}
+
+  Status Run() override {
+    started_->Notify();
+    unblock_->WaitForNotification();
+    return Status::OK();
+  }
+
+  void Abort(Status status) override {}
+
+  string DebugString() const override { return "BlockingNode"; }
+
+ private:
+  Notification* const started_;
+  Notification* const unblock_;
+};
+
+TEST(EagerExecutorTest, AsyncRunsNodesInOrder) {
+  Trace trace;
+  EagerExecutor executor(/*async=*/true);
+  std::vector<int> expected;
+  for (int i = 0; i < 100; ++i) {
+    if (i % 7 == 0) {
+      TF_ASSERT_OK(
+          executor.AddOrExecute(absl::make_unique<TestAsyncNode>(i, &trace)));
+    } else {
+      TF_ASSERT_OK(
+          executor.AddOrExecute(absl::make_unique<TestNode>(i, &trace)));
+    }
+    expected.push_back(i);
+  }
+  TF_ASSERT_OK(executor.WaitForAllPendingNodes());
+  {
+    mutex_lock l(trace.mu);
+    EXPECT_EQ(trace.ran, expected);
+    EXPECT_TRUE(trace.aborted.empty());
+  }
+  TF_ASSERT_OK(executor.ShutDown());
+}
+
+TEST(EagerExecutorTest, AsyncErrorAbortsRestOfBatch) {
+  Trace trace;
+  EagerExecutor executor(/*async=*/true);
+  for (int i = 0; i < 10; ++i) {
+    Status status = i == 3 ? errors::Internal("node failed") : Status::OK();
+    // Nodes may be aborted as soon as the error occurs.
+    executor.AddOrExecute(absl::make_unique<TestNode>(i, &trace, status))
+        .IgnoreError();
+  }
+  EXPECT_EQ(error::INTERNAL, executor.WaitForAllPendingNodes().code());
+  {
+    mutex_lock l(trace.mu);
+    EXPECT_EQ(trace.ran, std::vector<int>({0, 1, 2, 3}));
+  }
+
+  executor.ClearError();
+  TF_ASSERT_OK(executor.AddOrExecute(absl::make_unique<TestNode>(10, &trace)));
+  TF_ASSERT_OK(executor.WaitForAllPendingNodes());
+  {
+    mutex_lock l(trace.mu);
+    EXPECT_EQ(trace.ran, std::vector<int>({0, 1, 2, 3, 10}));
+  }
+  TF_ASSERT_OK(executor.ShutDown());
+}
+
+TEST(EagerExecutorTest, AsyncBatchesConsecutiveRemoteNodes) {
+  Trace trace;
+  std::vector<std::vector<int>> batches;
+  EagerExecutor executor(/*async=*/true);
+  // Queues the other nodes while the executor is blocked, so that they are
+  // taken in one batch.
+  Notification started;
+  Notification unblock;
+  TF_ASSERT_OK(executor.AddOrExecute(
+      absl::make_unique<BlockingNode>(&started, &unblock)));
+  started.WaitForNotification();
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(executor.AddOrExecute(
+        absl::make_unique<TestRemoteNode>(i, &trace, &batches)));
+  }
+  TF_ASSERT_OK(executor.AddOrExecute(absl::make_unique<TestNode>(3, &trace)));
+  for (int i = 4; i < 6; ++i) {
+    TF_ASSERT_OK(executor.AddOrExecute(
+        absl::make_unique<TestRemoteNode>(i, &trace, &batches)));
+  }
+  unblock.Notify();
+  TF_ASSERT_OK(executor.WaitForAllPendingNodes());
+  {
+    mutex_lock l(trace.mu);
+    EXPECT_EQ(trace.ran, std::vector<int>({0, 1, 2, 3, 4, 5}));
+    EXPECT_EQ(batches, std::vector<std::vector<int>>({{0, 1, 2}, {4, 5}}));
+  }
+  TF_ASSERT_OK(executor.ShutDown());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -133,6 +133,11 @@ class EagerOperation : public ImmediateExecutionOperation {
   AttrBuilder* MutableAttrs() { return &attrs_; }
   const AttrBuilder& Attrs() const { return attrs_; }
 
+  // The kernel this operation last ran with. It is kept across Reset() calls,
+  // so that an operation object that is reused for identical ops skips the
+  // kernel cache lookup.
+  KernelCacheMemo* MutableKernelCacheMemo() { return &kernel_cache_memo_; }
+
   const absl::InlinedVector<TensorHandle*, 4>& Inputs() const {
     return inputs_;
   }
@@ -194,6 +199,7 @@ class EagerOperation : public ImmediateExecutionOperation {
   const char* op_name_ = nullptr;
   AttrBuilder attrs_;
   const AttrTypeMap* attr_types_;
+  KernelCacheMemo kernel_cache_memo_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
 
   // The last device name given to SetDeviceName.
@@ -450,7 +450,8 @@ Status GetOrCreateKernelAndDevice(
     }
   }
 
-  core::RefCountPtr<KernelAndDevice> kernel = ctx.GetCachedKernel(cache_key);
+  core::RefCountPtr<KernelAndDevice> kernel =
+      ctx.GetCachedKernel(cache_key, op->MutableKernelCacheMemo());
   if (kernel == nullptr) {
     DVLOG(2) << "Creating new kernel for " << op->Name() << " on device "
              << DeviceNameOrUnspecified(op->Device());
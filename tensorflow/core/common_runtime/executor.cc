@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/executor.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/types/optional.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/ThreadPool"
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
 #include "tensorflow/core/common_runtime/entry.h"
 #include "tensorflow/core/common_runtime/executor_factory.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -54,12 +58,15 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/profile_utils/cpu_utils.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -132,13 +139,114 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// A set of per-worker deques used by the "WORK_STEALING" executor.
+//
+// Each invocation of `ExecutorState::Process()` may claim one queue for the
+// duration of its processing loop. The claiming thread is the only thread that
+// pushes to or pops from the front of that queue, so those operations are
+// lock-free. Other inter-op threads steal from the back of the queues when they
+// would otherwise be idle.
+template <class TaggedNode>
+class WorkStealingQueues {
+ public:
+  explicit WorkStealingQueues(int num_queues)
+      : num_queues_(num_queues), slots_(new Slot[num_queues]) {}
+
+  ~WorkStealingQueues() {
+    for (int i = 0; i < num_queues_; ++i) {
+      delete slots_[i].queue.load(std::memory_order_relaxed);
+    }
+  }
+
+  // Claims an unused queue for the calling thread and returns its index, or
+  // returns -1 if all queues are currently in use.
+  int Claim() {
+    for (int i = 0; i < num_queues_; ++i) {
+      Slot& slot = slots_[i];
+      bool expected = false;
+      if (!slot.claimed.load(std::memory_order_relaxed) &&
+          slot.claimed.compare_exchange_strong(expected, true,
+                                               std::memory_order_acquire)) {
+        if (slot.queue.load(std::memory_order_relaxed) == nullptr) {
+          slot.queue.store(new Queue, std::memory_order_release);
+        }
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  // Releases the queue at `index`, which must be empty.
+  void Release(int index) {
+    DCHECK(slots_[index].queue.load(std::memory_order_relaxed)->Empty());
+    slots_[index].claimed.store(false, std::memory_order_release);
+  }
+
+  // Pushes `node` to the front of the queue at `index`. Returns false if the
+  // queue is full. REQUIRES: the calling thread has claimed `index`.
+  bool Push(int index, const TaggedNode& node) {
+    return Get(index)->PushFront(node).node_item == nullptr;
+  }
+
+  // Pops the most recently pushed node from the queue at `index`. Returns
+  // false if the queue is empty. REQUIRES: the calling thread has claimed
+  // `index`.
+  bool Pop(int index, TaggedNode* node) {
+    *node = Get(index)->PopFront();
+    return node->node_item != nullptr;
+  }
+
+  // Steals the least recently pushed node from any queue other than
+  // `thief_index` (which may be -1). Returns false if no work was found.
+  bool Steal(int thief_index, TaggedNode* node) {
+    const int start = thief_index < 0 ? 0 : thief_index + 1;
+    for (int i = 0; i < num_queues_; ++i) {
+      const int victim = (start + i) % num_queues_;
+      if (victim == thief_index) continue;
+      Queue* queue = slots_[victim].queue.load(std::memory_order_acquire);
+      if (queue == nullptr || queue->Empty()) continue;
+      *node = queue->PopBack();
+      if (node->node_item != nullptr) return true;
+    }
+    return false;
+  }
+
+  int num_queues() const { return num_queues_; }
+
+ private:
+  // Queues are allocated lazily, so most steps only pay for as many queues as
+  // there are concurrently active inter-op threads.
+  static constexpr unsigned kQueueCapacity = 256;
+  typedef Eigen::RunQueue<TaggedNode, kQueueCapacity> Queue;
+
+  struct Slot {
+    std::atomic<bool> claimed{false};
+    std::atomic<Queue*> queue{nullptr};
+  };
+
+  Queue* Get(int index) const {
+    return slots_[index].queue.load(std::memory_order_relaxed);
+  }
+
+  const int num_queues_;
+  std::unique_ptr<Slot[]> slots_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingQueues);
+};
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p, bool work_stealing)
+      : immutable_state_(p), work_stealing_(work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
     kernel_stats_.Initialize(immutable_state_.graph_view());
+    if (immutable_state_.params().use_static_memory_plan) {
+      memory_plan_ = StaticMemoryPlan::Create(
+          graph, immutable_state_.params().device->GetAllocator(
+                     AllocatorAttributes()));
+    }
     return Status::OK();
   }
 
@@ -213,6 +321,12 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // Non-null iff node outputs are served from per-step arenas.
+  std::unique_ptr<StaticMemoryPlan> memory_plan_;
+
+  // If true, each step schedules ready nodes on per-worker work-stealing
+  // queues instead of dispatching every expensive node to `runner`.
+  const bool work_stealing_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -271,7 +385,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_, bool work_stealing,
+                StaticMemoryPlan* memory_plan);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -288,7 +403,9 @@ class ExecutorState {
   // Process a ready node in current thread.
   void Process(TaggedNode node, int64 scheduled_nsec);
 
-  Status ProcessSync(const NodeItem& item, OpKernelContext::Params* params,
+  // Runs the synchronous kernel of `item` in `ctx`, which must have been set
+  // up for it from the current compute params.
+  Status ProcessSync(const NodeItem& item, OpKernelContext* ctx,
                      EntryVector* outputs, NodeExecStatsInterface* stats);
   void ProcessAsync(const NodeItem& item, const OpKernelContext::Params& params,
                     const TaggedNode& tagged_node, Entry* first_input,
@@ -310,18 +427,46 @@ class ExecutorState {
   // Called after each node finishes. Takes ownership of "stats". Returns true
   // if execution has completed.
   //
+  // If `worker_queue` is not null, it points to the index of the work-stealing
+  // queue claimed by the calling thread (or -1 if none has been claimed yet).
+  //
   // This method will clear `*ready` before returning.
   bool NodeDone(const Status& s, TaggedNodeSeq* ready,
                 NodeExecStatsInterface* stats,
-                TaggedNodeReadyQueue* inline_ready);
+                TaggedNodeReadyQueue* inline_ready,
+                int* worker_queue = nullptr);
 
   // Schedule all the expensive nodes in '*ready', and put all the inexpensive
   // nodes in 'ready' into 'inline_ready'.
   //
+  // In work-stealing mode, expensive nodes are instead pushed onto the queue
+  // at `*worker_queue` (claiming one if necessary), where they are either run
+  // by the calling thread once 'inline_ready' drains, or stolen by another
+  // inter-op thread.
+  //
   // This method will clear `*ready` before returning.
   //
   // REQUIRES: `!ready->empty()`.
-  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
+  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+                     int* worker_queue = nullptr);
+
+  // Adds `tagged_node` to `inline_ready`.  A live node that feeds a
+  // collective goes to the front of the queue, so that the collective starts,
+  // and its communication overlaps with the remaining computation, as early
+  // as possible.
+  static void PushInline(const TaggedNode& tagged_node,
+                         TaggedNodeReadyQueue* inline_ready) {
+    if (tagged_node.node_item->is_any_consumer_collective &&
+        !tagged_node.get_is_dead()) {
+      inline_ready->push_front(tagged_node);
+    } else {
+      inline_ready->push_back(tagged_node);
+    }
+  }
+
+  // Schedules a closure on `runner_` that will try to steal a node from the
+  // work-stealing queues, unless enough such closures are already pending.
+  void MaybeScheduleSteal(int64 scheduled_nsec);
 
   // Clean up when this executor is done.
   void Finish();
@@ -365,6 +510,17 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Non-null iff this step runs in work-stealing mode.
+  std::unique_ptr<WorkStealingQueues<TaggedNode>> work_stealing_queues_;
+  // The number of steal closures that have been scheduled but not yet run.
+  std::atomic<int> num_pending_steals_{0};
+
+  // Not owned. Null if node outputs are allocated from the device allocator.
+  StaticMemoryPlan* const memory_plan_;
+  // The arena of this step, with one reference owned by this step. Null if
+  // the step runs unplanned.
+  StaticMemoryPlan::StepArena* step_arena_ = nullptr;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -383,7 +539,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool work_stealing,
+    StaticMemoryPlan* memory_plan)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -407,12 +564,22 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      memory_plan_(memory_plan),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  // Inline execution already runs every kernel on a single thread, so there is
+  // nothing to steal.
+  if (work_stealing && !run_all_kernels_inline_) {
+    work_stealing_queues_ = absl::make_unique<WorkStealingQueues<TaggedNode>>(
+        std::max(port::MaxParallelism(), 1));
+  }
+  if (memory_plan_ != nullptr) {
+    step_arena_ = memory_plan_->StartStep();
+  }
 }
 
 template <class PropagatorStateType>
@@ -483,6 +650,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   Entry* first_input;
   OpKernelContext ctx;
   NodeExecStatsInterface* stats;
+  // Start of ComputeAsync, if item->latency_cell is set.
+  uint64 latency_start_us = 0;
 
  private:
   OpKernelContext::Params* ParamsButClearingEigenGPUDevice(
@@ -516,15 +685,16 @@ bool MightTrace(const tracing::EventCollector* event_collector,
 
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::ProcessSync(
-    const NodeItem& item, OpKernelContext::Params* params, EntryVector* outputs,
+    const NodeItem& item, OpKernelContext* ctx, EntryVector* outputs,
     NodeExecStatsInterface* stats) {
   Status s;
-  OpKernelContext ctx(params, item.num_outputs);
   nodestats::SetOpStart(stats);
 
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const uint64 latency_start_us =
+      item.latency_cell != nullptr ? EnvTime::NowMicros() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -532,24 +702,27 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
     profiler::AnnotatedTraceMe activity(
         [&] {
           return op_kernel->TraceString(
-              &ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
+              ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(is_expensive));
-    device->Compute(op_kernel, &ctx);
+    device->Compute(op_kernel, ctx);
   } else {
     // In the common case, avoid creating any tracing objects.
     if (is_expensive) {
       KernelTimer timer;
-      device->Compute(op_kernel, &ctx);
+      device->Compute(op_kernel, ctx);
       kernel_stats_->UpdateCostEstimate(item, timer.ElapsedCycles());
     } else {
-      device->Compute(op_kernel, &ctx);
+      device->Compute(op_kernel, ctx);
     }
   }
+  if (item.latency_cell != nullptr) {
+    item.latency_cell->Add(EnvTime::NowMicros() - latency_start_us);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
-  s = ProcessOutputs(item, &ctx, outputs->data(), stats);
-  nodestats::SetMemory(stats, &ctx);
+  s = ProcessOutputs(item, ctx, outputs->data(), stats);
+  nodestats::SetMemory(stats, ctx);
   return s;
 }
 
@@ -568,6 +741,10 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     NodeExecStatsInterface* stats = state->stats;  // Shorthand
     Entry* first_input = state->first_input;       // Shorthand
 
+    if (state->item->latency_cell != nullptr) {
+      state->item->latency_cell->Add(EnvTime::NowMicros() -
+                                     state->latency_start_us);
+    }
     nodestats::SetOpEnd(stats);
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
@@ -595,6 +772,9 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     if (completed) ScheduleFinish();
   };
   nodestats::SetOpStart(stats);
+  if (item.latency_cell != nullptr) {
+    state->latency_start_us = EnvTime::NowMicros();
+  }
   {
     profiler::AnnotatedTraceMe activity(
         [&] {
@@ -703,12 +883,28 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
   NodeExecStatsInterface* stats = nullptr;
 
   EntryVector outputs(1);
+  outputs.reserve(immutable_state_.max_num_outputs());
+
+  // The context for synchronous kernels, reset rather than rebuilt for each
+  // node this loop runs.
+  absl::optional<OpKernelContext> ctx;
+
+  // The index of the work-stealing queue claimed by this thread, if any.
+  int worker_queue = -1;
 
   bool completed = false;
   inline_ready.push_back(tagged_node);
-  while (!inline_ready.empty()) {
-    tagged_node = inline_ready.front();
-    inline_ready.pop_front();
+  while (true) {
+    if (!inline_ready.empty()) {
+      tagged_node = inline_ready.front();
+      inline_ready.pop_front();
+    } else if (worker_queue < 0 ||
+               !work_stealing_queues_->Pop(worker_queue, &tagged_node)) {
+      // In work-stealing mode, this thread runs all of the expensive nodes
+      // that it deferred and that have not been stolen before giving up its
+      // queue.
+      break;
+    }
     const NodeItem& item = tagged_node.get_node_item();
     const int id = item.node_id;
 
@@ -757,7 +953,7 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         }
         propagator_.MaybeMarkCompleted(tagged_node);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, &ready, stats, &inline_ready);
+        completed = NodeDone(s, &ready, stats, &inline_ready, &worker_queue);
         continue;
       }
 
@@ -766,6 +962,8 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
       params.frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
+      params.output_allocator_array =
+          step_arena_ ? step_arena_->output_allocators(item.node_id) : nullptr;
       params.forward_from_array = item.forward_from();
       params.outputs_required_array = item.outputs_required.get();
 
@@ -773,10 +971,16 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         ProcessAsync(item, params, tagged_node, first_input, stats);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, &params, &outputs, stats);
+        if (!ctx.has_value()) {
+          ctx.emplace(&params, item.num_outputs);
+        } else {
+          ctx->ResetForKernel(item.num_outputs);
+        }
+        s = ProcessSync(item, &*ctx, &outputs, stats);
       }
     }
 
+
     if (!launched_asynchronously) {
       if (vlog_) {
         VLOG(2) << "Synchronous kernel done: " << id << " step "
@@ -806,9 +1010,16 @@ void ExecutorState<PropagatorStateType>::Process(TaggedNode tagged_node,
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
-      completed = NodeDone(s, &ready, stats, &inline_ready);
+      completed = NodeDone(s, &ready, stats, &inline_ready, &worker_queue);
     }
-  }  // while !inline_ready.empty()
+  }  // while (true)
+
+  if (worker_queue >= 0) {
+    // Drop the outstanding op that kept this ExecutorState alive while this
+    // thread held its queue.
+    work_stealing_queues_->Release(worker_queue);
+    completed = num_outstanding_ops_.fetch_sub(1) == 1;
+  }
 
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
@@ -1027,7 +1238,7 @@ Status ExecutorState<PropagatorStateType>::ProcessOutputs(
 template <class PropagatorStateType>
 bool ExecutorState<PropagatorStateType>::NodeDone(
     const Status& s, TaggedNodeSeq* ready, NodeExecStatsInterface* stats,
-    TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeReadyQueue* inline_ready, int* worker_queue) {
   if (stats) {
     nodestats::SetAllEnd(stats);
     DCHECK_NE(stats_collector_, nullptr);
@@ -1046,7 +1257,7 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
       }
 
       // Schedule the ready nodes in 'ready'.
-      ScheduleReady(ready, inline_ready);
+      ScheduleReady(ready, inline_ready, worker_queue);
 
       return false;
     }
@@ -1102,7 +1313,8 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
 
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleReady(
-    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready,
+    int* worker_queue) {
   DCHECK(!ready->empty());
 
   int64 scheduled_nsec = 0;
@@ -1123,7 +1335,38 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       });
     } else {
       for (auto& tagged_node : *ready) {
-        inline_ready->push_back(tagged_node);
+        PushInline(tagged_node, inline_ready);
+      }
+    }
+  } else if (work_stealing_queues_ != nullptr && inline_ready != nullptr &&
+             worker_queue != nullptr) {
+    for (auto& tagged_node : *ready) {
+      const NodeItem& item = *tagged_node.node_item;
+      if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+        // Inline this inexpensive node.
+        PushInline(tagged_node, inline_ready);
+        continue;
+      }
+      if (*worker_queue < 0) {
+        *worker_queue = work_stealing_queues_->Claim();
+        if (*worker_queue >= 0) {
+          // Holding a queue counts as an outstanding op, so that this
+          // ExecutorState cannot be destroyed while the calling thread is
+          // still accessing its queue.
+          num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      if (*worker_queue >= 0 &&
+          work_stealing_queues_->Push(*worker_queue, tagged_node)) {
+        // Keep the expensive node local, so that it runs on this thread once
+        // 'inline_ready' drains, and let an idle thread steal it if one is
+        // available sooner.
+        MaybeScheduleSteal(scheduled_nsec);
+      } else {
+        // All queues are in use or the local queue is full, so fall back to
+        // dispatching the node to another thread.
+        runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                          scheduled_nsec));
       }
     }
   } else {
@@ -1138,7 +1381,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
         const NodeItem& item = *tagged_node.node_item;
         if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
           // Inline this inexpensive node.
-          inline_ready->push_back(tagged_node);
+          PushInline(tagged_node, inline_ready);
         } else {
           if (curr_expensive_node) {
             // Dispatch to another thread since there is plenty of work to
@@ -1164,6 +1407,31 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeScheduleSteal(
+    int64 scheduled_nsec) {
+  // Keep at most one pending steal per queue: any more would find nothing to
+  // steal, since every queue owner is already running its own work.
+  if (num_pending_steals_.fetch_add(1, std::memory_order_relaxed) >=
+      work_stealing_queues_->num_queues()) {
+    num_pending_steals_.fetch_sub(1, std::memory_order_relaxed);
+    return;
+  }
+  // The pending steal counts as an outstanding op, which keeps this
+  // ExecutorState alive until the closure has run.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+  runner_([this, scheduled_nsec]() {
+    num_pending_steals_.fetch_sub(1, std::memory_order_relaxed);
+    TaggedNode tagged_node;
+    if (work_stealing_queues_->Steal(-1, &tagged_node)) {
+      Process(tagged_node, scheduled_nsec);
+    }
+    if (num_outstanding_ops_.fetch_sub(1) == 1) {
+      ScheduleFinish();
+    }
+  });
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1195,6 +1463,15 @@ void ExecutorState<PropagatorStateType>::Finish() {
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
 
+  // Tensors allocated from the arena keep it alive until they are released.
+  if (step_arena_ != nullptr) {
+    if (step_arena_->is_profiling()) {
+      memory_plan_->FinishProfilingStep(step_arena_, status.ok());
+    }
+    step_arena_->Unref();
+    step_arena_ = nullptr;
+  }
+
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
     // nodes in the propagator.
@@ -1299,20 +1576,21 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        work_stealing_, memory_plan_.get()))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, work_stealing_,
+         memory_plan_.get()))
         ->RunAsync(std::move(done));
   }
 }
 
-}  // namespace
-
-Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
-                        Executor** executor) {
-  ExecutorImpl* impl = new ExecutorImpl(params);
+Status NewLocalExecutorImpl(const LocalExecutorParams& params,
+                            const Graph& graph, bool work_stealing,
+                            Executor** executor) {
+  ExecutorImpl* impl = new ExecutorImpl(params, work_stealing);
   const Status s = impl->Initialize(graph);
   if (s.ok()) {
     *executor = impl;
@@ -1322,6 +1600,14 @@ Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
   return s;
 }
 
+}  // namespace
+
+Status NewLocalExecutor(const LocalExecutorParams& params, const Graph& graph,
+                        Executor** executor) {
+  return NewLocalExecutorImpl(params, graph, /*work_stealing=*/false,
+                              executor);
+}
+
 Status CreateNonCachedKernel(Device* device, FunctionLibraryRuntime* flib,
                              const std::shared_ptr<const NodeProperties>& props,
                              int graph_def_version, OpKernel** kernel) {
@@ -1357,6 +1643,29 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING" executor, which runs expensive successors of a
+// node on the same inter-op thread and lets idle inter-op threads steal them,
+// instead of dispatching each one through the runner.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret = nullptr;
+      TF_RETURN_IF_ERROR(NewLocalExecutorImpl(params, graph,
+                                              /*work_stealing=*/true, &ret));
+      out_executor->reset(ret);
+      return Status::OK();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -47,6 +47,7 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 // See core/kernels/function_ops.cc for related kernels.
 
@@ -411,12 +412,26 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     const FunctionLibraryDefinition* lib_def = nullptr;  // Not owned.
     FunctionBody* func_graph = nullptr;
     Executor* exec = nullptr;
+    // If non-null, a SingleThreadedExecutor for a small body, used instead
+    // of `exec` by calls that don't collect step stats.
+    Executor* single_threaded_exec = nullptr;
     FunctionLibraryRuntimeOverlay* overlay_flr = nullptr;
     string executor_type;
+    // False if no kernel of the body can use the rendezvous of a call, so
+    // that a local call needn't create one.
+    bool uses_rendezvous = true;
+
+    Executor* ExecutorFor(const Options& run_opts) const {
+      return single_threaded_exec != nullptr &&
+                     run_opts.stats_collector == nullptr
+                 ? single_threaded_exec
+                 : exec;
+    }
 
     ~Item() {
       delete this->func_graph;
       delete this->exec;
+      delete this->single_threaded_exec;
       delete this->overlay_flr;
     }
   };
@@ -436,6 +451,11 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
                            std::unique_ptr<FunctionBody>* fbody);
   Status CreateItem(Item** item);
   Status GetOrCreateItem(LocalHandle local_handle, Item** item);
+  // Creates the rendezvous requested by `run_opts->create_rendezvous`,
+  // unless the call runs `item` (if non-null) locally and its body doesn't
+  // use one. Returns the rendezvous, which the caller owns, or nullptr.
+  PrivateIntraProcessRendezvous* MaybeCreateRendezvous(const Item* item,
+                                                       Options* run_opts);
   Status InstantiateSymbolicGradient(const NameAttrList& func,
                                      const FunctionLibraryDefinition* lib_def,
                                      std::unique_ptr<FunctionBody>* g_body);
@@ -902,6 +922,60 @@ void PruneFunctionBody(const FunctionDef& fdef, Graph* g) {
     FixupSourceAndSinkEdges(g);
   }
 }
+
+// Returns true if `n` calls another function, either as a function op or
+// through a function-valued attr (e.g. If, While, or PartitionedCall).
+bool CallsFunction(const Node* n) {
+  if (n->IsFunctionCall()) return true;
+  for (const auto& attr : n->attrs()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if a kernel of `g` may send or receive tensors through the
+// rendezvous of the call, directly or from a nested function call.
+bool MayUseRendezvous(const Graph& g) {
+  for (const Node* n : g.op_nodes()) {
+    if (n->IsSend() || n->IsRecv() || CallsFunction(n)) return true;
+  }
+  return false;
+}
+
+// Returns the largest function body, in op nodes other than arguments and
+// return values, that runs through the SingleThreadedExecutor.
+int64 SingleThreadedExecutorMaxNodes() {
+  static const int64 max_nodes = [] {
+    int64 value;
+    Status status = ReadInt64FromEnvVar(
+        "TF_FUNCTION_SINGLE_THREADED_EXECUTOR_MAX_NODES", 16, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << "TF_FUNCTION_SINGLE_THREADED_EXECUTOR_MAX_NODES: "
+                 << status.error_message();
+      return int64{0};
+    }
+    return value;
+  }();
+  return max_nodes;
+}
+
+// Returns true if `g` is a small body of stateless ops, whose kernels can
+// run one after another on the calling thread without losing parallelism
+// or waiting on each other.
+bool IsSmallStatelessBody(const Graph& g) {
+  int64 num_nodes = 0;
+  for (const Node* n : g.op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    if (++num_nodes > SingleThreadedExecutorMaxNodes()) return false;
+    if (n->op_def().is_stateful() || n->IsControlFlow() || n->IsSend() ||
+        n->IsRecv() || n->IsCollective() || CallsFunction(n)) {
+      return false;
+    }
+  }
+  return true;
+}
 }  // namespace
 
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
@@ -946,11 +1020,29 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
   params.session_metadata = session_metadata_;
   std::unique_ptr<Executor> exec;
   TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, *g, &exec));
+
+  // Small CPU bodies also get a SingleThreadedExecutor, which runs a call
+  // inline without the per-call scheduling of the default executor. It is
+  // only available if linked in, so failing to create it isn't an error.
+  std::unique_ptr<Executor> single_threaded_exec;
+  if (executor_type.empty() && device()->device_type() == DEVICE_CPU &&
+      IsSmallStatelessBody(*g)) {
+    Status s = NewExecutor("SINGLE_THREADED_EXECUTOR", params, *g,
+                           &single_threaded_exec);
+    if (!s.ok()) {
+      VLOG(1) << "Not using the single-threaded executor for "
+              << fbody->fdef.signature().name() << ": " << s;
+      single_threaded_exec.reset();
+    }
+  }
+  const bool uses_rendezvous = MayUseRendezvous(*g);
   {
     // Guard item since it is already inserted in items_.
     mutex_lock l(mu_);
     if ((*item)->exec == nullptr) {
       (*item)->graph = std::move(g);
+      (*item)->single_threaded_exec = single_threaded_exec.release();
+      (*item)->uses_rendezvous = uses_rendezvous;
       (*item)->exec = exec.release();
     }
   }
@@ -976,6 +1068,20 @@ Status FunctionLibraryRuntimeImpl::GetOrCreateItem(LocalHandle local_handle,
   return CreateItem(item);
 }
 
+PrivateIntraProcessRendezvous*
+FunctionLibraryRuntimeImpl::MaybeCreateRendezvous(const Item* item,
+                                                  Options* run_opts) {
+  if (!run_opts->create_rendezvous) return nullptr;
+  run_opts->create_rendezvous = false;
+  if (item != nullptr && !item->uses_rendezvous &&
+      !run_opts->remote_execution) {
+    return nullptr;
+  }
+  auto* rendezvous = new PrivateIntraProcessRendezvous(device_mgr_);
+  run_opts->rendezvous = rendezvous;
+  return rendezvous;
+}
+
 void FunctionLibraryRuntimeImpl::ExecutorArgsFromOptions(
     const FunctionLibraryRuntime::Options& run_opts, CallFrameInterface* frame,
     Executor::Args* exec_args) {
@@ -1099,17 +1205,23 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     return;
   }
   Options run_opts = opts;
-  if (opts.create_rendezvous) {
-    auto* rendezvous = new PrivateIntraProcessRendezvous(device_mgr_);
-    run_opts.rendezvous = rendezvous;
-    run_opts.create_rendezvous = false;
+  LocalHandle local_handle = parent_->GetHandleOnDevice(device_name_, handle);
+  Item* item = nullptr;
+  if (local_handle != kInvalidLocalHandle) {
+    Status s = GetOrCreateItem(local_handle, &item);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+  }
+
+  if (auto* rendezvous = MaybeCreateRendezvous(item, &run_opts)) {
     done = [done = std::move(done), rendezvous](const Status& status) mutable {
       delete rendezvous;
       done(status);
     };
   }
 
-  LocalHandle local_handle = parent_->GetHandleOnDevice(device_name_, handle);
   if (local_handle == kInvalidLocalHandle) {
     parent_->Run(run_opts, handle, args, rets, done);
     return;
@@ -1120,13 +1232,6 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
   DCHECK(run_opts.runner != nullptr);
 
-  Item* item = nullptr;
-  Status s = GetOrCreateItem(local_handle, &item);
-  if (!s.ok()) {
-    done(s);
-    return;
-  }
-
   if (run_opts.remote_execution) {
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
     RunRemote(run_opts, handle, args, rets, item, std::move(done));
@@ -1136,7 +1241,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   const FunctionBody* fbody = GetFunctionBody(handle);
   FunctionCallFrame* frame =
       new FunctionCallFrame(fbody->arg_types, fbody->ret_types);
-  s = frame->SetArgs(args);
+  Status s = frame->SetArgs(args);
   if (!s.ok()) {
     delete frame;
     done(s);
@@ -1147,7 +1252,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   ExecutorArgsFromOptions(run_opts, frame, &exec_args);
 
   bool allow_dead_tensors = run_opts.allow_dead_tensors;
-  item->exec->RunAsync(
+  item->ExecutorFor(run_opts)->RunAsync(
       // Executor args
       exec_args,
       // Done callback.
@@ -1170,19 +1275,16 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
 
   Options run_opts = opts;
-  if (opts.create_rendezvous) {
-    auto* rendezvous = new PrivateIntraProcessRendezvous(device_mgr_);
-    run_opts.rendezvous = rendezvous;
-    run_opts.create_rendezvous = false;
-    done = [done = std::move(done), rendezvous](const Status& status) mutable {
-      delete rendezvous;
-      done(status);
-    };
-  }
-
   LocalHandle local_handle = parent_->GetHandleOnDevice(
       device_name_, handle, /*include_multi_device=*/true);
   if (local_handle == kInvalidLocalHandle) {
+    if (auto* rendezvous = MaybeCreateRendezvous(nullptr, &run_opts)) {
+      done = [done = std::move(done),
+              rendezvous](const Status& status) mutable {
+        delete rendezvous;
+        done(status);
+      };
+    }
     parent_->Run(run_opts, handle, frame, done);
     return;
   }
@@ -1202,6 +1304,12 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     done(s);
     return;
   }
+  if (auto* rendezvous = MaybeCreateRendezvous(item, &run_opts)) {
+    done = [done = std::move(done), rendezvous](const Status& status) mutable {
+      delete rendezvous;
+      done(status);
+    };
+  }
   if (run_opts.runner == nullptr) {
     run_opts.runner = &default_runner_;
   }
@@ -1209,7 +1317,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
 
   Executor::Args exec_args;
   ExecutorArgsFromOptions(run_opts, frame, &exec_args);
-  item->exec->RunAsync(exec_args, std::move(done));
+  item->ExecutorFor(run_opts)->RunAsync(exec_args, std::move(done));
 }
 
 Status FunctionLibraryRuntimeImpl::PrepareRunSync(
@@ -1228,21 +1336,16 @@ Status FunctionLibraryRuntimeImpl::PrepareRunSync(
     return errors::Unimplemented("Remote calling with RunSync()");
   }
 
-  if (run_opts->create_rendezvous) {
-    *out_rendezvous =
-        absl::make_unique<PrivateIntraProcessRendezvous>(device_mgr_);
-    run_opts->rendezvous = out_rendezvous->get();
-    run_opts->create_rendezvous = false;
-  }
-
   LocalHandle local_handle = parent_->GetHandleOnDevice(
       device_name_, handle, /*include_multi_device=*/true);
   if (local_handle == kInvalidLocalHandle) {
     *out_item = nullptr;
+    out_rendezvous->reset(MaybeCreateRendezvous(nullptr, run_opts));
     return Status::OK();
   }
 
   TF_RETURN_IF_ERROR(GetOrCreateItem(local_handle, out_item));
+  out_rendezvous->reset(MaybeCreateRendezvous(*out_item, run_opts));
 
   if (run_opts->runner == nullptr) {
     run_opts->runner = &default_runner_;
@@ -1268,7 +1371,7 @@ Status FunctionLibraryRuntimeImpl::RunSync(Options opts, Handle handle,
   TF_RETURN_IF_ERROR(frame.SetArgs(args));
   ExecutorArgsFromOptions(opts, &frame, &exec_args);
 
-  TF_RETURN_IF_ERROR(item->exec->Run(exec_args));
+  TF_RETURN_IF_ERROR(item->ExecutorFor(opts)->Run(exec_args));
   return frame.ConsumeRetvals(rets, opts.allow_dead_tensors);
 }
 
@@ -1283,7 +1386,7 @@ Status FunctionLibraryRuntimeImpl::RunSync(Options opts, Handle handle,
 
   Executor::Args exec_args;
   ExecutorArgsFromOptions(opts, call_frame, &exec_args);
-  return item->exec->Run(exec_args);
+  return item->ExecutorFor(opts)->Run(exec_args);
 }
 
 bool FunctionLibraryRuntimeImpl::IsStateful(const string& func) const {
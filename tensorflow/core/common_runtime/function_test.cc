@@ -2029,6 +2029,57 @@ TEST_F(FunctionLibraryRuntimeTest, RunAllKernelsInline) {
   }
 }
 
+class GetExecutorTypeOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, {}, &output));
+    output->scalar<tstring>()() = ctx->executor_type();
+  }
+};
+
+REGISTER_OP("GetExecutorType").Input("x: float").Output("type: string");
+REGISTER_OP("StatefulGetExecutorType")
+    .Input("x: float")
+    .Output("type: string")
+    .SetIsStateful();
+REGISTER_KERNEL_BUILDER(Name("GetExecutorType").Device(DEVICE_CPU),
+                        GetExecutorTypeOp);
+REGISTER_KERNEL_BUILDER(Name("StatefulGetExecutorType").Device(DEVICE_CPU),
+                        GetExecutorTypeOp);
+
+TEST_F(FunctionLibraryRuntimeTest, SmallStatelessBodyRunsSingleThreaded) {
+  auto make_function = [](const string& name, const string& op) {
+    return FDH::Create(name, {"x: float"}, {"ret: string"}, {},
+                       {{{"y"}, op, {"x"}, {}}}, {{"ret", "y:type:0"}});
+  };
+  Init({make_function("Stateless", "GetExecutorType"),
+        make_function("Stateful", "StatefulGetExecutorType")});
+  auto x = test::AsTensor<float>({1.0});
+
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "Stateless", {}, &handle));
+  Tensor type;
+  FunctionLibraryRuntime::Options opts;
+  opts.create_rendezvous = true;
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&type}));
+  EXPECT_EQ("SINGLE_THREADED_EXECUTOR", type.scalar<tstring>()());
+
+  // Calls that collect step stats use the default executor.
+  StepStats stats;
+  StepStatsCollector stats_collector(&stats);
+  opts.stats_collector = &stats_collector;
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&type}));
+  EXPECT_EQ("", type.scalar<tstring>()());
+
+  TF_CHECK_OK(Instantiate(flr0_, "Stateful", {}, &handle));
+  TF_CHECK_OK(Run(flr0_, handle, FunctionLibraryRuntime::Options(), {x},
+                  {&type}));
+  EXPECT_EQ("", type.scalar<tstring>()());
+}
+
 namespace {
 
 bool DoNothing(Graph* g) { return false; }
@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fuse_remote_variable_reads_pass.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsEnabled() {
+  static const bool enabled = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_FUSE_REMOTE_VARIABLE_READS",
+                                  /*default_val=*/true, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return true;
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Returns true if all the in-edges of `n` are control edges from the source
+// node.
+bool HasNoInputs(const Node* n) {
+  for (const Edge* e : n->in_edges()) {
+    if (!e->IsControlEdge() || !e->src()->IsSource()) return false;
+  }
+  return true;
+}
+
+// Returns true if `n` is a ReadVariableOp on a CPU device, of a VarHandleOp
+// without inputs, with no control inputs, and with a consumer in another task.
+bool IsFusibleRemoteRead(const Node* n) {
+  if (n->type_string() != "ReadVariableOp") return false;
+  DeviceNameUtils::ParsedName device;
+  if (!DeviceNameUtils::ParseFullName(n->assigned_device_name(), &device) ||
+      device.type != DEVICE_CPU) {
+    return false;
+  }
+  for (const Edge* e : n->in_edges()) {
+    if (e->IsControlEdge()) {
+      if (!e->src()->IsSource()) return false;
+    } else if (e->src()->type_string() != "VarHandleOp" ||
+               !HasNoInputs(e->src())) {
+      return false;
+    }
+  }
+  for (const Edge* e : n->out_edges()) {
+    DeviceNameUtils::ParsedName dst_device;
+    if (!e->IsControlEdge() &&
+        DeviceNameUtils::ParseFullName(e->dst()->assigned_device_name(),
+                                       &dst_device) &&
+        !DeviceNameUtils::IsSameAddressSpace(device, dst_device)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Replaces `reads`, all assigned to `device`, with one _ReadVariablesOp.
+Status FuseReads(const string& device, const std::vector<Node*>& reads,
+                 Graph* g) {
+  std::vector<NodeBuilder::NodeOut> resources;
+  DataTypeVector dtypes;
+  for (Node* read : reads) {
+    const Edge* input;
+    TF_RETURN_IF_ERROR(read->input_edge(0, &input));
+    resources.emplace_back(input->src(), input->src_output());
+    DataType dtype;
+    TF_RETURN_IF_ERROR(GetNodeAttr(read->attrs(), "dtype", &dtype));
+    dtypes.push_back(dtype);
+  }
+  Node* fused;
+  TF_RETURN_IF_ERROR(
+      NodeBuilder(g->NewName(strings::StrCat(reads[0]->name(), "/Fused")),
+                  "_ReadVariablesOp")
+          .Input(resources)
+          .Attr("dtypes", dtypes)
+          .Finalize(g, &fused));
+  fused->set_assigned_device_name(device);
+
+  for (int i = 0; i < reads.size(); ++i) {
+    std::vector<const Edge*> out_edges(reads[i]->out_edges().begin(),
+                                       reads[i]->out_edges().end());
+    for (const Edge* e : out_edges) {
+      if (e->IsControlEdge()) {
+        g->AddControlEdge(fused, e->dst());
+      } else {
+        TF_RETURN_IF_ERROR(g->UpdateEdge(fused, i, e->dst(), e->dst_input()));
+      }
+    }
+    g->RemoveNode(reads[i]);
+  }
+  VLOG(1) << "Fused " << reads.size() << " reads on " << device << " into "
+          << fused->name();
+  return Status::OK();
+}
+
+}  // namespace
+
+Status FuseRemoteVariableReadsPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr || !IsEnabled()) return Status::OK();
+  Graph* g = options.graph->get();
+
+  std::map<string, std::vector<Node*>> reads_by_device;
+  for (Node* n : g->op_nodes()) {
+    if (IsFusibleRemoteRead(n)) {
+      reads_by_device[n->assigned_device_name()].push_back(n);
+    }
+  }
+  for (const auto& p : reads_by_device) {
+    if (p.second.size() > 1) {
+      TF_RETURN_IF_ERROR(FuseReads(p.first, p.second, g));
+    }
+  }
+  return Status::OK();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 0,
+                      FuseRemoteVariableReadsPass);
+
+}  // namespace tensorflow
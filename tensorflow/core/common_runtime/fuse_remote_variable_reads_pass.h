@@ -0,0 +1,63 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_FUSE_REMOTE_VARIABLE_READS_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_FUSE_REMOTE_VARIABLE_READS_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Replaces the ReadVariableOps placed on a CPU device whose values are
+// consumed by another task, e.g. the reads of the variables of a parameter
+// server, with one _ReadVariablesOp per device.
+//
+// For example, the following reads on /job:ps/task:0, consumed on
+// /job:worker/task:0,
+//
+//   VarHandleOp a    VarHandleOp b
+//        |                |
+//   ReadVariableOp   ReadVariableOp
+//        |                |
+//        v                v
+//       MatMul (/job:worker/task:0)
+//
+// are transformed to
+//
+//   VarHandleOp a    VarHandleOp b
+//         \              /
+//          _ReadVariablesOp
+//         /              \
+//        v                v
+//       MatMul (/job:worker/task:0)
+//
+// The parameter server then runs a single kernel per step for all of them,
+// and all the values become ready at once, so that their recvs on the worker
+// are issued together and can share an RPC (see
+// TF_RPC_RECV_COALESCING_WINDOW_MICROS).
+//
+// Only reads of a VarHandleOp without inputs, which have no control inputs
+// themselves, are fused: nothing else can run before them, so fusing them
+// can neither create a cycle nor change the order of a read and a write.
+//
+// Set TF_FUSE_REMOTE_VARIABLE_READS=false to disable this pass.
+class FuseRemoteVariableReadsPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_FUSE_REMOTE_VARIABLE_READS_PASS_H_
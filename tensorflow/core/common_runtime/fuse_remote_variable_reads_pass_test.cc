@@ -0,0 +1,133 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/fuse_remote_variable_reads_pass.h"
+
+#include <map>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+
+constexpr char kPs[] = "/job:ps/replica:0/task:0/device:CPU:0";
+constexpr char kWorker[] = "/job:worker/replica:0/task:0/device:CPU:0";
+
+NodeDef VarHandle(const string& name) {
+  return NDef(name, "VarHandleOp", {},
+              {{"dtype", DT_FLOAT},
+               {"shape", TensorShape({})},
+               {"container", ""},
+               {"shared_name", name}},
+              kPs);
+}
+
+NodeDef Read(const string& name, const string& input) {
+  return NDef(name, "ReadVariableOp", {input}, {{"dtype", DT_FLOAT}}, kPs);
+}
+
+NodeDef Identity(const string& name, const string& input,
+                 const string& device) {
+  return NDef(name, "Identity", {input}, {{"T", DT_FLOAT}}, device);
+}
+
+// Runs the pass on `gdef` with every node assigned to its requested device,
+// and returns the number of nodes of each op in the result.
+std::map<string, int> RunPass(const GraphDef& gdef,
+                              std::unique_ptr<Graph>* graph) {
+  *graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TF_CHECK_OK(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), gdef, graph->get()));
+  for (Node* n : (*graph)->op_nodes()) {
+    n->set_assigned_device_name(n->requested_device());
+  }
+  GraphOptimizationPassOptions options;
+  options.graph = graph;
+  FuseRemoteVariableReadsPass pass;
+  TF_CHECK_OK(pass.Run(options));
+  std::map<string, int> op_counts;
+  for (Node* n : (*graph)->op_nodes()) ++op_counts[n->type_string()];
+  return op_counts;
+}
+
+Node* FindNode(const Graph& graph, const string& name) {
+  for (Node* n : graph.op_nodes()) {
+    if (n->name() == name) return n;
+  }
+  return nullptr;
+}
+
+TEST(FuseRemoteVariableReadsPassTest, FusesReadsConsumedByAnotherTask) {
+  std::unique_ptr<Graph> graph;
+  std::map<string, int> op_counts = RunPass(
+      GDef({VarHandle("a"), VarHandle("b"), Read("read_a", "a"),
+            Read("read_b", "b"), Identity("x", "read_a", kWorker),
+            Identity("y", "read_b", kWorker), Identity("z", "read_b", kPs)}),
+      &graph);
+  EXPECT_EQ(0, op_counts["ReadVariableOp"]);
+  EXPECT_EQ(1, op_counts["_ReadVariablesOp"]);
+
+  const Edge* edge;
+  TF_ASSERT_OK(FindNode(*graph, "x")->input_edge(0, &edge));
+  Node* fused = edge->src();
+  EXPECT_EQ("_ReadVariablesOp", fused->type_string());
+  EXPECT_EQ(kPs, fused->assigned_device_name());
+  EXPECT_EQ(0, edge->src_output());
+  TF_ASSERT_OK(FindNode(*graph, "y")->input_edge(0, &edge));
+  EXPECT_EQ(fused, edge->src());
+  EXPECT_EQ(1, edge->src_output());
+  TF_ASSERT_OK(FindNode(*graph, "z")->input_edge(0, &edge));
+  EXPECT_EQ(fused, edge->src());
+  EXPECT_EQ(1, edge->src_output());
+}
+
+TEST(FuseRemoteVariableReadsPassTest, KeepsLocalReads) {
+  std::unique_ptr<Graph> graph;
+  std::map<string, int> op_counts = RunPass(
+      GDef({VarHandle("a"), VarHandle("b"), Read("read_a", "a"),
+            Read("read_b", "b"), Identity("x", "read_a", kPs),
+            Identity("y", "read_b", kPs)}),
+      &graph);
+  EXPECT_EQ(2, op_counts["ReadVariableOp"]);
+  EXPECT_EQ(0, op_counts["_ReadVariablesOp"]);
+}
+
+TEST(FuseRemoteVariableReadsPassTest, KeepsOrderedReads) {
+  std::unique_ptr<Graph> graph;
+  std::map<string, int> op_counts = RunPass(
+      GDef({VarHandle("a"), VarHandle("b"), VarHandle("c"),
+            Read("read_a", "a"), Read("read_b", "b"),
+            NDef("read_c", "ReadVariableOp", {"c", "^read_a"},
+                 {{"dtype", DT_FLOAT}}, kPs),
+            Identity("x", "read_a", kWorker), Identity("y", "read_b", kWorker),
+            Identity("z", "read_c", kWorker)}),
+      &graph);
+  // Only the reads without control inputs are fused.
+  EXPECT_EQ(1, op_counts["ReadVariableOp"]);
+  EXPECT_EQ(1, op_counts["_ReadVariablesOp"]);
+  EXPECT_NE(nullptr, FindNode(*graph, "read_c"));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,219 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifdef GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda.h"
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
+#if CUDA_VERSION >= 11020
+#define TF_CUDA_MALLOC_ASYNC_SUPPORTED 1
+#endif
+#endif  // GOOGLE_CUDA
+
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+namespace {
+
+string GetCudaErrorMessage(CUresult result) {
+  const char* error = nullptr;
+  cuGetErrorString(result, &error);
+  const char* name = nullptr;
+  cuGetErrorName(result, &name);
+  return absl::StrCat("CUDA error: ", error ? error : "<unknown>", " (",
+                      name ? name : "Unknown", ")");
+}
+
+}  // namespace
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+
+GpuCudaMallocAsyncAllocator::GpuCudaMallocAsyncAllocator(
+    PlatformGpuId platform_gpu_id, size_t pool_size, const string& name)
+    : name_(name), pool_size_(pool_size) {
+  stream_exec_ =
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+  stats_.bytes_limit = static_cast<int64>(pool_size);
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUmemPoolProps props = {};
+  props.allocType = CU_MEM_ALLOCATION_TYPE_PINNED;
+  props.handleTypes = CU_MEM_HANDLE_TYPE_NONE;
+  props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  props.location.id = stream_exec_->device_ordinal();
+  CUmemoryPool pool;
+  CUresult res = cuMemPoolCreate(&pool, &props);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "cuMemPoolCreate failed for GPU " << platform_gpu_id.value()
+               << ": " << GetCudaErrorMessage(res);
+    return;
+  }
+  pool_ = pool;
+  // Keep the pool's memory reserved at stream synchronization points instead
+  // of returning it to the driver, as the BFC allocator does with its arena.
+  cuuint64_t release_threshold = pool_size;
+  res = cuMemPoolSetAttribute(pool, CU_MEMPOOL_ATTR_RELEASE_THRESHOLD,
+                              &release_threshold);
+  if (res != CUDA_SUCCESS) {
+    LOG(WARNING) << "Failed to set the release threshold of the memory pool: "
+                 << GetCudaErrorMessage(res);
+  }
+  VLOG(1) << name_ << " created a memory pool of " << pool_size << " bytes";
+#else
+  LOG(ERROR) << "GpuCudaMallocAsyncAllocator requires CUDA 11.2 or newer; "
+                "all allocations will fail.";
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+GpuCudaMallocAsyncAllocator::~GpuCudaMallocAsyncAllocator() {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  if (pool_ == nullptr) return;
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  // Frees are stream-ordered; wait for them before handing the memory back.
+  cuCtxSynchronize();
+  CUresult res = cuMemPoolDestroy(static_cast<CUmemoryPool>(pool_));
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "cuMemPoolDestroy failed: " << GetCudaErrorMessage(res);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+void* GpuCudaMallocAsyncAllocator::AllocateRaw(size_t alignment,
+                                               size_t num_bytes) {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  if (pool_ == nullptr) return nullptr;
+  // Pool allocations are aligned to at least 256 bytes, which covers
+  // Allocator::kAllocatorAlignment.
+  DCHECK_LE(alignment, 256);
+  {
+    mutex_lock l(lock_);
+    if (stats_.bytes_in_use + static_cast<int64>(num_bytes) >
+        static_cast<int64>(pool_size_)) {
+      LOG(WARNING) << name_ << " ran out of memory trying to allocate "
+                   << num_bytes << " bytes with " << stats_.bytes_in_use
+                   << " of " << pool_size_ << " bytes in use.";
+      return nullptr;
+    }
+    // Reserve the bytes now so that concurrent allocations see them.
+    stats_.bytes_in_use += num_bytes;
+  }
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUdeviceptr ptr = 0;
+  CUresult res =
+      cuMemAllocFromPoolAsync(&ptr, num_bytes, static_cast<CUmemoryPool>(pool_),
+                              static_cast<CUstream>(stream_));
+  mutex_lock l(lock_);
+  if (res != CUDA_SUCCESS) {
+    stats_.bytes_in_use -= num_bytes;
+    LOG(ERROR) << "cuMemAllocFromPoolAsync failed to allocate " << num_bytes
+               << " bytes: " << GetCudaErrorMessage(res);
+    return nullptr;
+  }
+  void* rv = reinterpret_cast<void*>(ptr);
+  size_map_[rv] = num_bytes;
+  ++stats_.num_allocs;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  return rv;
+#else
+  return nullptr;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+void GpuCudaMallocAsyncAllocator::DeallocateRaw(void* ptr) {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  if (ptr == nullptr) return;
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+  CUresult res = cuMemFreeAsync(reinterpret_cast<CUdeviceptr>(ptr),
+                                static_cast<CUstream>(stream_));
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "cuMemFreeAsync failed to free " << ptr << ": "
+               << GetCudaErrorMessage(res);
+  }
+  mutex_lock l(lock_);
+  auto it = size_map_.find(ptr);
+  DCHECK(it != size_map_.end()) << "Freeing unknown pointer " << ptr;
+  if (it != size_map_.end()) {
+    stats_.bytes_in_use -= it->second;
+    size_map_.erase(it);
+  }
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+size_t GpuCudaMallocAsyncAllocator::RequestedSize(const void* ptr) const {
+  mutex_lock l(lock_);
+  auto it = size_map_.find(ptr);
+  CHECK(it != size_map_.end()) << "Asked for the size of unknown pointer "
+                               << ptr;
+  return it->second;
+}
+
+size_t GpuCudaMallocAsyncAllocator::AllocatedSize(const void* ptr) const {
+  return RequestedSize(ptr);
+}
+
+absl::optional<AllocatorStats> GpuCudaMallocAsyncAllocator::GetStats() {
+  mutex_lock l(lock_);
+  return stats_;
+}
+
+void GpuCudaMallocAsyncAllocator::ClearStats() {
+  mutex_lock l(lock_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+}
+
+void GpuCudaMallocAsyncAllocator::SetStream(void* stream) {
+  stream_ = stream;
+}
+
+/*static*/ bool GpuCudaMallocAsyncAllocator::IsSupported(
+    PlatformGpuId platform_gpu_id) {
+#ifdef TF_CUDA_MALLOC_ASYNC_SUPPORTED
+  se::StreamExecutor* stream_exec =
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+  se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec};
+  int driver_version = 0;
+  if (cuDriverGetVersion(&driver_version) != CUDA_SUCCESS ||
+      driver_version < 11020) {
+    return false;
+  }
+  CUdevice device;
+  if (cuDeviceGet(&device, stream_exec->device_ordinal()) != CUDA_SUCCESS) {
+    return false;
+  }
+  int pools_supported = 0;
+  if (cuDeviceGetAttribute(&pools_supported,
+                           CU_DEVICE_ATTRIBUTE_MEMORY_POOLS_SUPPORTED,
+                           device) != CUDA_SUCCESS) {
+    return false;
+  }
+  return pools_supported != 0;
+#else
+  return false;
+#endif  // TF_CUDA_MALLOC_ASYNC_SUPPORTED
+}
+
+}  // namespace tensorflow
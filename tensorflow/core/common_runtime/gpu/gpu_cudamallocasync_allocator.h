@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that hands out device memory from a CUDA memory pool with
+// cuMemAllocFromPoolAsync / cuMemFreeAsync (CUDA 11.2+).
+//
+// Allocations and frees are ordered on the stream set with SetStream(),
+// normally the device's compute stream. As with the BFC allocator, a
+// buffer may be freed on the host as soon as its last use is enqueued on
+// that stream; the driver only reuses the memory once the stream gets
+// there, so no host synchronization is needed. The driver also coalesces
+// and reuses pool memory across allocation sizes, which keeps
+// fragmentation lower than a per-process BFC arena on a shared GPU.
+//
+// The pool keeps up to pool_size bytes reserved at stream synchronization
+// points, and allocations beyond pool_size bytes in use fail.
+//
+// Selected with GPUOptions.allocator_type = "cuda_malloc_async" or
+// TF_GPU_ALLOCATOR=cuda_malloc_async. Built without CUDA 11.2, the
+// allocator fails every allocation.
+class GpuCudaMallocAsyncAllocator : public Allocator {
+ public:
+  GpuCudaMallocAsyncAllocator(PlatformGpuId platform_gpu_id, size_t pool_size,
+                              const string& name);
+  ~GpuCudaMallocAsyncAllocator() override;
+
+  string Name() override { return name_; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override { return true; }
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  void ClearStats() override;
+
+  // Orders all later allocations and frees on `stream`, a CUstream. Until
+  // it is called the legacy default stream is used, which synchronizes
+  // with all other blocking streams.
+  void SetStream(void* stream);
+
+  // Returns true if this binary and the driver of `platform_gpu_id`
+  // support stream-ordered memory pools.
+  static bool IsSupported(PlatformGpuId platform_gpu_id);
+
+ private:
+  se::StreamExecutor* stream_exec_;  // Not owned.
+  const string name_;
+  const size_t pool_size_;
+
+  // A CUmemoryPool, kept opaque so the header doesn't need cuda.h.
+  void* pool_ = nullptr;
+  // A CUstream.
+  void* stream_ = nullptr;
+
+  mutable mutex lock_;
+  absl::flat_hash_map<const void*, size_t> size_map_ TF_GUARDED_BY(lock_);
+  AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuCudaMallocAsyncAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_CUDAMALLOCASYNC_ALLOCATOR_H_
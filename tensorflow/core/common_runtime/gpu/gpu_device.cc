@@ -36,6 +36,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
@@ -229,22 +230,28 @@ class EigenGpuStreamDevice : public ::Eigen::StreamInterface {
 // the same physical device and stream group id use the same stream group
 // object (and therefore the same CUDA streams). This is necessary since there
 // is a single memory allocator per device (see ProcessState::GetGPUAllocator)
-// and allocators must not be shared across streams.
+// and allocators must not be shared across streams. Sessions with a
+// session_stream_priority get their own stream group, and their own
+// allocator (see ProcessState::GetGPUAllocatorForStreamPriority).
 class BaseGPUDevice::StreamGroupFactory {
  public:
   // Returns the unique stream group for use with the stream defined by
-  // {tf_gpu_id, stream_group_within_gpu}, creating it if it does not yet
-  // exist.
+  // {tf_gpu_id, stream_group_within_gpu, session_stream_priority}, creating
+  // it if it does not yet exist.
   // This function is thread safe.
   BaseGPUDevice::StreamGroup* GetOrCreate(TfGpuId tf_gpu_id,
                                           int stream_group_within_gpu,
                                           se::StreamExecutor* executor,
                                           const GPUOptions& options) {
     mutex_lock guard(lock_);
-    StreamGroup* group =
-        &streams_[key_type(tf_gpu_id.value(), stream_group_within_gpu)];
+    const int session_priority =
+        options.experimental().session_stream_priority();
+    StreamGroup* group = &streams_[key_type(
+        tf_gpu_id.value(), stream_group_within_gpu, session_priority)];
     if (!group->compute) {
-      int priority = GetPriority(tf_gpu_id.value(), options);
+      int priority = session_priority != 0
+                         ? session_priority
+                         : GetPriority(tf_gpu_id.value(), options);
       group->priority = priority;
       group->compute = GetStream(executor, priority);
       group->compute->Init();
@@ -265,15 +272,27 @@ class BaseGPUDevice::StreamGroupFactory {
       group->nccl->ThenWaitFor(group->compute);
 #endif
 
-      group->host_to_device = GetStream(executor, priority);
-      group->host_to_device->Init();
-      VLOG(2) << "Created host_to_device_stream[" << stream_group_within_gpu
-              << "] = " << group->host_to_device;
+      int num_host_copy_streams =
+          options.experimental().num_host_copy_streams();
+      if (num_host_copy_streams == 0) num_host_copy_streams = 1;
+      if (num_host_copy_streams < 1 || num_host_copy_streams > 4) {
+        LOG(ERROR) << "Illegal GPUOptions.experimental.num_host_copy_streams="
+                   << num_host_copy_streams << " set to 1 instead.";
+        num_host_copy_streams = 1;
+      }
+      for (int i = 0; i < num_host_copy_streams; ++i) {
+        se::Stream* stream = GetStream(executor, priority);
+        stream->Init();
+        group->host_to_device.push_back(stream);
+        VLOG(2) << "Created host_to_device_stream[" << stream_group_within_gpu
+                << "] = " << group->host_to_device.back();
 
-      group->device_to_host = GetStream(executor, priority);
-      group->device_to_host->Init();
-      VLOG(2) << "Created device_to_host_stream[" << stream_group_within_gpu
-              << "] = " << group->device_to_host;
+        stream = GetStream(executor, priority);
+        stream->Init();
+        group->device_to_host.push_back(stream);
+        VLOG(2) << "Created device_to_host_stream[" << stream_group_within_gpu
+                << "] = " << group->device_to_host.back();
+      }
 
       int num_d2d_streams =
           options.experimental().num_dev_to_dev_copy_streams();
@@ -317,14 +336,14 @@ class BaseGPUDevice::StreamGroupFactory {
         stream.nccl = nullptr;
       }
 #endif
-      if (stream.host_to_device) {
-        delete stream.host_to_device;
-        stream.host_to_device = nullptr;
+      for (se::Stream* host_to_device : stream.host_to_device) {
+        delete host_to_device;
       }
-      if (stream.device_to_host) {
-        delete stream.device_to_host;
-        stream.device_to_host = nullptr;
+      stream.host_to_device.clear();
+      for (se::Stream* device_to_host : stream.device_to_host) {
+        delete device_to_host;
       }
+      stream.device_to_host.clear();
       while (!stream.device_to_device.empty()) {
         auto back = stream.device_to_device.back();
         if (back) {
@@ -367,7 +386,7 @@ class BaseGPUDevice::StreamGroupFactory {
   }
 
   mutex lock_;
-  using key_type = std::tuple<int, int>;
+  using key_type = std::tuple<int, int, int>;
   std::map<key_type, StreamGroup> streams_;
 
   // StreamGroupFactory cannot be created directly; Call
@@ -438,17 +457,41 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
                            stream_->nccl,
 #endif
                            stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device);
+                           stream_->device_to_device,
+                           options.config.gpu_options()
+                               .experimental()
+                               .host_copy_staging_chunk_bytes());
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
 
+  // The session's quota applies on top of the allocator shared with the
+  // other sessions. With its own streams the session has its own allocator,
+  // already sized to the quota.
+  const GPUOptions::Experimental& experimental =
+      options.config.gpu_options().experimental();
+  if (experimental.session_memory_limit_mb() > 0 &&
+      experimental.session_stream_priority() == 0) {
+    const int64 quota_bytes = static_cast<int64>(
+        experimental.session_memory_limit_mb() * (1ll << 20));
+    quota_allocator_.reset(new GPUQuotaAllocator(gpu_allocator_, quota_bytes));
+    gpu_allocator_ = quota_allocator_.get();
+  }
+
+  // Stream-ordered allocations follow the ops that use them on the compute
+  // stream.
+  if (auto* async_allocator =
+          dynamic_cast<GpuCudaMallocAsyncAllocator*>(gpu_allocator_)) {
+    async_allocator->SetStream(se::gpu::AsGpuStreamValue(stream_->compute));
+  }
+
   GPUKernelTracker::Params tracker_params(
       options.config.gpu_options().experimental().kernel_tracker_max_interval(),
       options.config.gpu_options().experimental().kernel_tracker_max_bytes(),
       options.config.gpu_options().experimental().kernel_tracker_max_pending());
   timestamped_allocator_ =
-      options.config.gpu_options().experimental().timestamped_allocator();
+      options.config.gpu_options().experimental().timestamped_allocator() &&
+      GPUProcessState::singleton()->GPUAllocatorCounter(tf_gpu_id_) != nullptr;
   pending_cap_ = tracker_params.max_pending;
   if (timestamped_allocator_ ||
       (tracker_params.max_interval > 0 || tracker_params.max_bytes > 0 ||
@@ -1277,6 +1320,25 @@ Status BaseGPUDeviceFactory::CreateDevices(
     }
   }
 
+  const int session_priority =
+      gpu_options.experimental().session_stream_priority();
+  if (session_priority != 0) {
+    if (gpu_options.experimental().session_memory_limit_mb() <= 0) {
+      return errors::InvalidArgument(
+          "GPUOptions.experimental.session_stream_priority requires "
+          "session_memory_limit_mb to size the session's own allocator.");
+    }
+    for (const auto& range : supported_priority_ranges) {
+      if (session_priority > range.second.first ||
+          session_priority < range.second.second) {
+        return errors::InvalidArgument(
+            "Session stream priority ", session_priority,
+            " is outside the range [", range.second.second, ",",
+            range.second.first, "] supported by GPU ", range.first);
+      }
+    }
+  }
+
   const auto& virtual_devices = gpu_options.experimental().virtual_devices();
   if (!virtual_devices.empty()) {
     TF_RETURN_IF_ERROR(VerifyVirtualDeviceSettings(
@@ -1375,8 +1437,18 @@ Status BaseGPUDeviceFactory::CreateGPUDevice(
   }
   auto desc = desc_status.ConsumeValueOrDie();
   GPUProcessState* process_state = GPUProcessState::singleton();
-  Allocator* gpu_allocator = process_state->GetGPUAllocator(
-      options.config.gpu_options(), tf_gpu_id, memory_limit);
+  const GPUOptions::Experimental& experimental =
+      options.config.gpu_options().experimental();
+  const int64 session_memory_limit = static_cast<int64>(
+      experimental.session_memory_limit_mb() * (1ll << 20));
+  // The allocator shared with other sessions keeps the device's size; one
+  // for the session's own streams is sized to its quota.
+  if (session_memory_limit > 0 && experimental.session_stream_priority() != 0) {
+    memory_limit = std::min(memory_limit, session_memory_limit);
+  }
+  Allocator* gpu_allocator = process_state->GetGPUAllocatorForStreamPriority(
+      options.config.gpu_options(), tf_gpu_id,
+      experimental.session_stream_priority(), memory_limit);
   if (gpu_allocator == nullptr) {
     return errors::Internal("Failed to get memory allocator for TF GPU ",
                             tf_gpu_id.value(), " with ", memory_limit,
@@ -1395,6 +1467,9 @@ Status BaseGPUDeviceFactory::CreateGPUDevice(
   // TODO(laigd): report error if memory_limit doesn't match
   // stats->bytes_limit.
   int64 bytes_limit = stats->bytes_limit ? *stats->bytes_limit : 0;
+  if (session_memory_limit > 0) {
+    bytes_limit = std::min(bytes_limit, session_memory_limit);
+  }
   std::unique_ptr<BaseGPUDevice> gpu_device = CreateGPUDevice(
       options, device_name, static_cast<Bytes>(bytes_limit), dev_locality,
       tf_gpu_id, GetShortDeviceDescription(platform_gpu_id, *desc),
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_quota_allocator.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
@@ -128,13 +129,16 @@ class BaseGPUDevice : public LocalDevice {
 
  private:
   friend class GPUDeviceTestHelper;
+  // Enforces GPUOptions.Experimental.session_memory_limit_mb on the shared
+  // allocator, if set. gpu_allocator_ then points to it.
+  std::unique_ptr<GPUQuotaAllocator> quota_allocator_;
   struct StreamGroup {
     se::Stream* compute = nullptr;
 #if TENSORFLOW_USE_ROCM
     se::Stream* nccl = nullptr;
 #endif
-    se::Stream* host_to_device = nullptr;
-    se::Stream* device_to_host = nullptr;
+    gtl::InlinedVector<se::Stream*, 4> host_to_device;
+    gtl::InlinedVector<se::Stream*, 4> device_to_host;
     gtl::InlinedVector<se::Stream*, 4> device_to_device;
     int priority = 0;
   };
@@ -34,7 +34,8 @@ class GPUDevice : public BaseGPUDevice {
             Allocator* gpu_allocator, Allocator* cpu_allocator)
       : BaseGPUDevice(options, name, memory_limit, locality, tf_gpu_id,
                       physical_device_desc, gpu_allocator, cpu_allocator,
-                      false /* sync every op */) {
+                      false /* sync every op */),
+        tf_gpu_id_(tf_gpu_id) {
     if (options.config.has_gpu_options()) {
       force_gpu_compatible_ =
           options.config.gpu_options().force_gpu_compatible();
@@ -50,6 +51,8 @@ class GPUDevice : public BaseGPUDevice {
       } else {
         return cpu_allocator_;
       }
+    } else if (attr.unified_memory()) {
+      return GPUProcessState::singleton()->GetGpuManagedAllocator(tf_gpu_id_);
     } else {
       return gpu_allocator_;
     }
@@ -57,6 +60,7 @@ class GPUDevice : public BaseGPUDevice {
 
  private:
   bool force_gpu_compatible_ = false;
+  const TfGpuId tf_gpu_id_;
 };
 
 class GPUDeviceFactory : public BaseGPUDeviceFactory {
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
@@ -287,6 +288,69 @@ TEST_F(GPUDeviceTest, SingleVirtualDeviceWithMemoryLimitAndPriority) {
   EXPECT_EQ(0, static_cast<BaseGPUDevice*>(devices[0].get())->priority());
 }
 
+TEST_F(GPUDeviceTest, SessionMemoryLimit) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()->set_allow_growth(true);
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_session_memory_limit_mb(1);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  EXPECT_EQ(1 << 20, devices[0]->attributes().memory_limit());
+
+  Allocator* allocator = devices[0]->GetAllocator(AllocatorAttributes());
+  EXPECT_EQ(1 << 20, *allocator->GetStats()->bytes_limit);
+  const int64 bytes_in_use = allocator->GetStats()->bytes_in_use;
+  void* ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                     (1 << 20) - bytes_in_use);
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(nullptr,
+            allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256));
+  allocator->DeallocateRaw(ptr);
+  EXPECT_EQ(bytes_in_use, allocator->GetStats()->bytes_in_use);
+  ptr = allocator->AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  EXPECT_NE(nullptr, ptr);
+  allocator->DeallocateRaw(ptr);
+}
+
+TEST_F(GPUDeviceTest, SessionStreamPriority) {
+#if TENSORFLOW_USE_ROCM
+  const int kPriority = 1;
+#else
+  const int kPriority = -1;
+#endif
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_session_stream_priority(kPriority);
+  {
+    std::vector<std::unique_ptr<Device>> devices;
+    Status status = DeviceFactory::GetFactory("GPU")->CreateDevices(
+        opts, kDeviceNamePrefix, &devices);
+    EXPECT_EQ(status.code(), error::INVALID_ARGUMENT);
+    ExpectErrorMessageSubstr(status, "requires session_memory_limit_mb");
+  }
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_session_memory_limit_mb(16);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  auto* device = static_cast<BaseGPUDevice*>(devices[0].get());
+  EXPECT_EQ(kPriority, device->priority());
+  EXPECT_EQ(16 << 20, device->attributes().memory_limit());
+
+  // A session without the option keeps the default streams and allocator.
+  std::vector<std::unique_ptr<Device>> default_devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      MakeSessionOptions("0"), kDeviceNamePrefix, &default_devices));
+  auto* default_device = static_cast<BaseGPUDevice*>(default_devices[0].get());
+  EXPECT_EQ(0, default_device->priority());
+  EXPECT_NE(device->GetAllocator(AllocatorAttributes()),
+            default_device->GetAllocator(AllocatorAttributes()));
+}
+
 TEST_F(GPUDeviceTest, MultipleVirtualDevices) {
 #if TENSORFLOW_USE_ROCM
   // Valid range for priority values on AMD GPUs in (0,2)
@@ -460,6 +524,76 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, StagedCopiesOverMultipleHostCopyStreams) {
+  SessionOptions opts = MakeSessionOptions("0");
+  auto* experimental =
+      opts.config.mutable_gpu_options()->mutable_experimental();
+  experimental->set_num_host_copy_streams(2);
+  experimental->set_host_copy_staging_chunk_bytes(1024);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_gpu_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  // 1000 floats span four chunks, the last of them partial. The tensors from
+  // cpu_allocator() are pageable, so they are copied through staging chunks.
+  constexpr int kNumElements = 1000;
+  for (int copy = 0; copy < 3; ++copy) {
+    Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+    auto input = cpu_tensor.tensor<float, 1>();
+    for (int i = 0; i < kNumElements; ++i) input(i) = copy * kNumElements + i;
+    Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+    CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+
+    Tensor output_cpu_tensor(cpu_allocator(), DT_FLOAT,
+                             TensorShape({kNumElements}));
+    CopyGPUToCPU(&gpu_tensor, &output_cpu_tensor, device, device_context);
+    auto output = output_cpu_tensor.tensor<float, 1>();
+    for (int i = 0; i < kNumElements; ++i) {
+      EXPECT_EQ(input(i), output(i)) << " for index " << i;
+    }
+  }
+}
+
+TEST_F(GPUDeviceTest, CudaMallocAsyncAllocator) {
+  if (!GpuCudaMallocAsyncAllocator::IsSupported(PlatformGpuId(0))) {
+    LOG(INFO) << "Skipping test: memory pools are not supported.";
+    return;
+  }
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()->set_allocator_type("cuda_malloc_async");
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  DeviceContext* device_context =
+      device->tensorflow_gpu_device_info()->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+  EXPECT_EQ("GPU_0_cuda_malloc_async", allocator->Name());
+  const int64 bytes_in_use = allocator->GetStats()->bytes_in_use;
+
+  constexpr int kNumElements = 1024;
+  Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+  InitCPUTensor(&cpu_tensor, kNumElements, 3);
+  {
+    Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+    EXPECT_EQ(bytes_in_use + kNumElements * static_cast<int64>(sizeof(float)),
+              allocator->GetStats()->bytes_in_use);
+    CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+    InitCPUTensor(&cpu_tensor, kNumElements, 0);
+    CopyGPUToCPU(&gpu_tensor, &cpu_tensor, device, device_context);
+  }
+  EXPECT_EQ(bytes_in_use, allocator->GetStats()->bytes_in_use);
+  auto cpu = cpu_tensor.tensor<float, 1>();
+  for (int i = 0; i < kNumElements; ++i) {
+    EXPECT_EQ(3, cpu(i)) << " for index " << i;
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
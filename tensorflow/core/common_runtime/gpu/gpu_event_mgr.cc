@@ -94,13 +94,19 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(
+          gpu_options.experimental().event_mgr_use_host_callbacks()),
       threadpool_(Env::Default(), "GPU_Event_Manager", kNumThreads) {
   gpu_event_mgr::InitThreadpoolLabels(&threadpool_);
-  StartPollingLoop();
+  if (!use_host_callbacks_) StartPollingLoop();
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(ready_mu_);
+    while (num_pending_host_callbacks_ > 0) host_callbacks_done_.wait(l);
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -165,6 +171,53 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::QueueHostCallback(se::Stream* stream,
+                                 std::function<void()> func) {
+  if (!stream->ok()) {
+    // The callback would never be entrained. func can check the stream
+    // status itself, as with an event recorded on a failed stream.
+    AddReadyFunc(std::move(func));
+    return;
+  }
+  {
+    mutex_lock l(ready_mu_);
+    ++num_pending_host_callbacks_;
+  }
+  // The host callback runs in a driver thread that must not be blocked, so
+  // it only hands func over to the threadpool.
+  stream->ThenDoHostCallback([this, func = std::move(func)]() mutable {
+    AddReadyFunc(std::move(func));
+    mutex_lock l(ready_mu_);
+    if (--num_pending_host_callbacks_ == 0) host_callbacks_done_.notify_all();
+  });
+}
+
+void EventMgr::AddReadyFunc(std::function<void()> func) {
+  {
+    mutex_lock l(ready_mu_);
+    ready_funcs_.push_back(std::move(func));
+    if (running_ready_funcs_) return;
+    running_ready_funcs_ = true;
+  }
+  threadpool_.Schedule([this]() { RunReadyFuncs(); });
+}
+
+void EventMgr::RunReadyFuncs() {
+  std::vector<std::function<void()>> funcs;
+  while (true) {
+    {
+      mutex_lock l(ready_mu_);
+      if (ready_funcs_.empty()) {
+        running_ready_funcs_ = false;
+        return;
+      }
+      funcs.swap(ready_funcs_);
+    }
+    for (auto& func : funcs) func();
+    funcs.clear();
+  }
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -68,6 +68,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      QueueHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -83,6 +87,9 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // If true, funcs are triggered by host callbacks entrained on the streams
+  // instead of polled events, and the polling loop isn't started.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -129,6 +136,18 @@ class EventMgr {
   void StartPollingLoop();
   void StopPollingLoop();
 
+  // Entrains a host callback onto stream that queues func to be run by
+  // RunReadyFuncs() once the pending stream actions have completed.
+  void QueueHostCallback(se::Stream* stream, std::function<void()> func);
+
+  // Adds func to ready_funcs_, and schedules RunReadyFuncs() on the
+  // threadpool unless it is already running.
+  void AddReadyFunc(std::function<void()> func);
+
+  // Runs the funcs in ready_funcs_, in batches, until none are left. Funcs
+  // whose host callbacks fire together are run by a single threadpool task.
+  void RunReadyFuncs();
+
   // A stack of unused events
   std::vector<se::Event*> free_events_ TF_GUARDED_BY(mu_);
 
@@ -138,6 +157,14 @@ class EventMgr {
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
+  mutex ready_mu_;
+  // Host callbacks entrained but not yet fired.
+  int64 num_pending_host_callbacks_ TF_GUARDED_BY(ready_mu_) = 0;
+  condition_variable host_callbacks_done_ TF_GUARDED_BY(ready_mu_);
+  // Funcs whose host callbacks have fired, in firing order.
+  std::vector<std::function<void()>> ready_funcs_ TF_GUARDED_BY(ready_mu_);
+  bool running_ready_funcs_ TF_GUARDED_BY(ready_mu_) = false;
+
   // The main PollLoop for the event manager runs in this threadpool.
   thread::ThreadPool threadpool_;
 };
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -138,6 +139,39 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that with host callbacks the funcs run in order, without events or
+// the polling loop.
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumFuncs = 100;
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(kNumFuncs);
+  for (int i = 0; i < kNumFuncs; ++i) {
+    em.ThenExecute(stream.get(), [i, &mu, &order, &counter]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(i);
+      }
+      counter.DecrementCount();
+    });
+  }
+  EXPECT_EQ(0, th.queue_size());
+  counter.Wait();
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+  mutex_lock l(mu);
+  ASSERT_EQ(kNumFuncs, order.size());
+  for (int i = 0; i < kNumFuncs; ++i) EXPECT_EQ(i, order[i]);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -157,8 +191,8 @@ class GPUDeviceTestHelper {
   Allocator* gpu_allocator() { return gpu_allocator_; }
   Allocator* host_allocator() { return host_allocator_; }
   se::Stream* compute_stream() { return gpu_->stream_->compute; }
-  se::Stream* h2d_stream() { return gpu_->stream_->host_to_device; }
-  se::Stream* d2h_stream() { return gpu_->stream_->device_to_host; }
+  se::Stream* h2d_stream() { return gpu_->stream_->host_to_device[0]; }
+  se::Stream* d2h_stream() { return gpu_->stream_->device_to_host[0]; }
   se::Stream* d2d_stream() { return gpu_->stream_->device_to_device[0]; }
   EventMgr* event_mgr() { return gpu_->em_; }
   int pending_cap() { return gpu_->pending_cap_; }
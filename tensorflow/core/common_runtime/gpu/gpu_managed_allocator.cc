@@ -15,6 +15,7 @@ limitations under the License.
 
 #if GOOGLE_CUDA
 #include "third_party/gpus/cuda/include/cuda.h"
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
 #define EIGEN_USE_GPU
 #endif
 
@@ -25,25 +26,72 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
+
 namespace tensorflow {
 
+GpuManagedAllocator::GpuManagedAllocator(PlatformGpuId platform_gpu_id)
+    : stream_exec_(
+          GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie()),
+      device_ordinal_(platform_gpu_id.value()) {}
+
 void* GpuManagedAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   void* ptr = nullptr;
 #if GOOGLE_CUDA
-  CUdeviceptr result = 0;
-  CHECK_EQ(cuMemAllocManaged(&result, num_bytes, CU_MEM_ATTACH_GLOBAL),
-           CUDA_SUCCESS);
-  ptr = reinterpret_cast<void*>(result);
+  if (stream_exec_ != nullptr) {
+    se::cuda::ScopedActivateExecutorContext scoped_activation{stream_exec_};
+    CUdeviceptr result = 0;
+    CUresult res = cuMemAllocManaged(&result, num_bytes, CU_MEM_ATTACH_GLOBAL);
+    if (res != CUDA_SUCCESS) {
+      LOG(ERROR) << "cuMemAllocManaged failed to allocate " << num_bytes;
+      return nullptr;
+    }
+    // Keep the pages on the device until it runs out of memory, rather than
+    // migrating them on every host touch.
+    res = cuMemAdvise(result, num_bytes, CU_MEM_ADVISE_SET_PREFERRED_LOCATION,
+                      device_ordinal_);
+    if (res != CUDA_SUCCESS) {
+      LOG(WARNING) << "cuMemAdvise failed for " << num_bytes
+                   << " bytes of managed memory";
+    }
+    ptr = reinterpret_cast<void*>(result);
+  } else {
+    CUdeviceptr result = 0;
+    CHECK_EQ(cuMemAllocManaged(&result, num_bytes, CU_MEM_ATTACH_GLOBAL),
+             CUDA_SUCCESS);
+    ptr = reinterpret_cast<void*>(result);
+  }
 #elif TENSORFLOW_USE_ROCM
   void** result = 0;
   CHECK_EQ(hipHostMalloc(&result, num_bytes, 0), 0);
   ptr = reinterpret_cast<void*>(result);
 #endif
   CHECK(!(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)));
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    sizes_[ptr] = num_bytes;
+    ++stats_.num_allocs;
+    stats_.bytes_in_use += num_bytes;
+    stats_.peak_bytes_in_use =
+        std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    stats_.largest_alloc_size =
+        std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  }
   return ptr;
 }
 
 void GpuManagedAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  {
+    mutex_lock l(mu_);
+    auto it = sizes_.find(ptr);
+    if (it != sizes_.end()) {
+      stats_.bytes_in_use -= it->second;
+      sizes_.erase(it);
+    }
+  }
 #if GOOGLE_CUDA
   CHECK_EQ(cudaFree(ptr), cudaSuccess);
 #elif TENSORFLOW_USE_ROCM
@@ -51,4 +99,9 @@ void GpuManagedAllocator::DeallocateRaw(void* ptr) {
 #endif
 }
 
+absl::optional<AllocatorStats> GpuManagedAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
 }  // namespace tensorflow
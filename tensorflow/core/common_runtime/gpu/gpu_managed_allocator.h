@@ -16,19 +16,47 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_MANAGED_ALLOCATOR_H_
 
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
 // An allocator for CUDA unified memory. Memory allocated with this allocator
 // can be accessed from both host and device. CUDA transparently migrates dirty
-// pages, which can be slow. Therefore, this allocator is intended for
-// convenience in functional tests only.
+// pages, which can be slow.
+//
+// The default constructor is intended for convenience in functional tests.
+// When constructed for a platform GPU, the memory is advised to live on that
+// GPU and the driver evicts pages to the host only under memory pressure.
+// GPU devices return this allocator for AllocatorAttributes with
+// unified_memory() set, so that variables larger than the device memory (e.g.
+// embedding tables) can be trained with the device memory acting as a cache;
+// the ResourceGatherPrefetch op migrates the rows of the next step ahead of
+// time.
 class GpuManagedAllocator : public Allocator {
  public:
+  GpuManagedAllocator() = default;
+  explicit GpuManagedAllocator(PlatformGpuId platform_gpu_id);
+
   string Name() override { return "GpuManagedAllocator"; }
   void* AllocateRaw(size_t alignment, size_t num_bytes) override;
   void DeallocateRaw(void* ptr) override;
+  absl::optional<AllocatorStats> GetStats() override;
+
+ private:
+  se::StreamExecutor* stream_exec_ = nullptr;  // Not owned.
+  int device_ordinal_ = -1;
+
+  mutex mu_;
+  std::unordered_map<void*, size_t> sizes_ TF_GUARDED_BY(mu_);
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuManagedAllocator);
 };
 
 }  // namespace tensorflow
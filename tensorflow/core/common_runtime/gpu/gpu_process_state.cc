@@ -20,12 +20,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamalloc_allocator.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_cudamallocasync_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_host_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_managed_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -53,6 +55,13 @@ bool useCudaMemoryGuardAllocator() {
          std::strcmp(debug_allocator_str, "memory_guard") == 0;
 }
 
+bool useCudaMallocAsyncAllocator(const string& allocator_type) {
+  if (allocator_type == "cuda_malloc_async") return true;
+  const char* allocator_str = std::getenv("TF_GPU_ALLOCATOR");
+  return allocator_type.empty() && allocator_str != nullptr &&
+         std::strcmp(allocator_str, "cuda_malloc_async") == 0;
+}
+
 }  // namespace
 
 /*static*/ GPUProcessState* GPUProcessState::singleton(GPUProcessState* ps) {
@@ -93,47 +102,69 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
   if (allocator_parts.allocator == nullptr) {
     // Validate allocator types.
-    if (!allocator_type.empty() && allocator_type != "BFC") {
+    if (!allocator_type.empty() && allocator_type != "BFC" &&
+        allocator_type != "cuda_malloc_async") {
       LOG(ERROR) << "Invalid allocator type: " << allocator_type;
       return nullptr;
     }
 
     PlatformGpuId platform_gpu_id;
     TF_CHECK_OK(GpuIdManager::TfToPlatformGpuId(tf_gpu_id, &platform_gpu_id));
-    int bus_id = BusIdForGPU(tf_gpu_id);
-    DCHECK_GE(bus_id, 0);
-    while (bus_id >= gpu_visitors_.size()) {
-      gpu_visitors_.push_back({});
-    }
-    GPUMemAllocator* sub_allocator = new GPUMemAllocator(
-        GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
-        platform_gpu_id,
-        (options.per_process_gpu_memory_fraction() > 1.0 ||
-         options.experimental().use_unified_memory()),
-        gpu_visitors_[bus_id], {});
-    GPUBFCAllocator* gpu_bfc_allocator =
-        new GPUBFCAllocator(sub_allocator, total_bytes, options,
-                            strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
-    Allocator* gpu_allocator = gpu_bfc_allocator;
+    Allocator* gpu_allocator = nullptr;
+    GPUBFCAllocator* gpu_bfc_allocator = nullptr;
+    GPUMemAllocator* sub_allocator = nullptr;
     SharedCounter* timing_counter = nullptr;
-    if (options.experimental().timestamped_allocator()) {
-      timing_counter = new SharedCounter;
-      gpu_bfc_allocator->SetTimingCounter(timing_counter);
-    }
-
-    // If true, checks for memory overwrites by writing
-    // distinctive patterns on both ends of allocated memory.
-    if (useCudaMemoryGuardAllocator()) {
-      LOG(INFO) << "Using memory guard allocator for GPU.";
-      gpu_allocator = new GPUDebugAllocator(gpu_allocator, platform_gpu_id);
-      gpu_allocator = new GPUNanResetAllocator(gpu_allocator, platform_gpu_id);
-    } else if (useCudaMallocAllocator()) {
-      LOG(INFO) << "Using CUDA malloc allocator for GPU.";
-      // If true, passes all allocation requests through to cudaMalloc
-      // useful for doing memory debugging with tools like cuda-memcheck
-      // **WARNING** probably will not work in a multi-gpu scenario
-      gpu_allocator =
-          new GPUcudaMallocAllocator(gpu_allocator, platform_gpu_id);
+    if (useCudaMallocAsyncAllocator(allocator_type)) {
+      if (!GpuCudaMallocAsyncAllocator::IsSupported(platform_gpu_id)) {
+        LOG(ERROR) << "The cuda_malloc_async allocator requires CUDA 11.2 "
+                      "and a GPU that supports memory pools.";
+        return nullptr;
+      }
+      if (options.experimental().timestamped_allocator()) {
+        LOG(WARNING) << "timestamped_allocator is ignored by the "
+                        "cuda_malloc_async allocator, whose frees are "
+                        "already stream-ordered.";
+      }
+      LOG(INFO) << "Using CUDA stream-ordered allocator for GPU.";
+      gpu_allocator = new GpuCudaMallocAsyncAllocator(
+          platform_gpu_id, total_bytes,
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_cuda_malloc_async"));
+    } else {
+      int bus_id = BusIdForGPU(tf_gpu_id);
+      DCHECK_GE(bus_id, 0);
+      while (bus_id >= gpu_visitors_.size()) {
+        gpu_visitors_.push_back({});
+      }
+      sub_allocator = new GPUMemAllocator(
+          GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+          platform_gpu_id,
+          (options.per_process_gpu_memory_fraction() > 1.0 ||
+           options.experimental().use_unified_memory()),
+          gpu_visitors_[bus_id], {});
+      gpu_bfc_allocator = new GPUBFCAllocator(
+          sub_allocator, total_bytes, options,
+          strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
+      gpu_allocator = gpu_bfc_allocator;
+      if (options.experimental().timestamped_allocator()) {
+        timing_counter = new SharedCounter;
+        gpu_bfc_allocator->SetTimingCounter(timing_counter);
+      }
+
+      // If true, checks for memory overwrites by writing
+      // distinctive patterns on both ends of allocated memory.
+      if (useCudaMemoryGuardAllocator()) {
+        LOG(INFO) << "Using memory guard allocator for GPU.";
+        gpu_allocator = new GPUDebugAllocator(gpu_allocator, platform_gpu_id);
+        gpu_allocator =
+            new GPUNanResetAllocator(gpu_allocator, platform_gpu_id);
+      } else if (useCudaMallocAllocator()) {
+        LOG(INFO) << "Using CUDA malloc allocator for GPU.";
+        // If true, passes all allocation requests through to cudaMalloc
+        // useful for doing memory debugging with tools like cuda-memcheck
+        // **WARNING** probably will not work in a multi-gpu scenario
+        gpu_allocator =
+            new GPUcudaMallocAllocator(gpu_allocator, platform_gpu_id);
+      }
     }
 
     Allocator* recording_allocator = nullptr;
@@ -163,6 +194,70 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+Allocator* GPUProcessState::GetGPUAllocatorForStreamPriority(
+    const GPUOptions& options, TfGpuId tf_gpu_id, int priority,
+    size_t total_bytes) {
+  if (priority == 0) return GetGPUAllocator(options, tf_gpu_id, total_bytes);
+  CHECK(process_state_);
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  mutex_lock lock(mu_);
+  GpuIdUtil::CheckValidTfGpuId(tf_gpu_id);
+  AllocatorParts& allocator_parts =
+      priority_gpu_allocators_[{tf_gpu_id.value(), priority}];
+  if (allocator_parts.allocator == nullptr) {
+    PlatformGpuId platform_gpu_id;
+    TF_CHECK_OK(GpuIdManager::TfToPlatformGpuId(tf_gpu_id, &platform_gpu_id));
+    int bus_id = BusIdForGPU(tf_gpu_id);
+    DCHECK_GE(bus_id, 0);
+    while (bus_id >= gpu_visitors_.size()) {
+      gpu_visitors_.push_back({});
+    }
+    GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+        GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+        platform_gpu_id, options.experimental().use_unified_memory(),
+        gpu_visitors_[bus_id], {});
+    GPUBFCAllocator* gpu_bfc_allocator = new GPUBFCAllocator(
+        sub_allocator, total_bytes, options,
+        strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc_priority_",
+                        priority));
+    LOG(INFO) << "Created a " << (total_bytes >> 20) << " MB allocator for "
+              << "GPU " << tf_gpu_id.value() << " streams with priority "
+              << priority;
+    allocator_parts = {std::unique_ptr<Allocator>(gpu_bfc_allocator),
+                       /*counter=*/nullptr, gpu_bfc_allocator, sub_allocator,
+                       /*recording_allocator=*/nullptr};
+  }
+  return allocator_parts.allocator.get();
+#else
+  LOG(FATAL) << "GPUAllocator unavailable. Not compiled with --config=cuda or "
+                "--config=rocm.";
+  return nullptr;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
+Allocator* GPUProcessState::GetGpuManagedAllocator(TfGpuId tf_gpu_id) {
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+  mutex_lock lock(mu_);
+  GpuIdUtil::CheckValidTfGpuId(tf_gpu_id);
+  std::unique_ptr<Allocator>& allocator =
+      gpu_managed_allocators_[tf_gpu_id.value()];
+  if (allocator == nullptr) {
+    PlatformGpuId platform_gpu_id;
+    TF_CHECK_OK(GpuIdManager::TfToPlatformGpuId(tf_gpu_id, &platform_gpu_id));
+    allocator.reset(new GpuManagedAllocator(platform_gpu_id));
+    LOG(INFO) << "Created a unified memory allocator for GPU "
+              << tf_gpu_id.value();
+  }
+  return allocator.get();
+#else
+  LOG(FATAL) << "GpuManagedAllocator unavailable. Not compiled with "
+                "--config=cuda or --config=rocm.";
+  return nullptr;
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+}
+
 SharedCounter* GPUProcessState::GPUAllocatorCounter(TfGpuId tf_gpu_id) {
   DCHECK(process_state_);
 #if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
@@ -176,6 +271,10 @@ SharedCounter* GPUProcessState::GPUAllocatorCounter(TfGpuId tf_gpu_id) {
   }
 
   AllocatorParts& allocator_parts = gpu_allocators_[tf_gpu_id.value()];
+  if (allocator_parts.bfc_allocator == nullptr) {
+    // The cuda_malloc_async allocator has no timing counter.
+    return nullptr;
+  }
   if (allocator_parts.counter.get() == nullptr) {
     SharedCounter* timing_counter = new SharedCounter;
     allocator_parts.bfc_allocator->SetTimingCounter(timing_counter);
@@ -338,6 +437,8 @@ void GPUProcessState::TestOnlyReset() {
     mutex_lock lock(mu_);
     gpu_device_enabled_ = false;
     gpu_allocators_.clear();
+    priority_gpu_allocators_.clear();
+    gpu_managed_allocators_.clear();
     gpu_visitors_.clear();
     gpu_host_allocators_.clear();
     gpu_host_alloc_visitors_.clear();
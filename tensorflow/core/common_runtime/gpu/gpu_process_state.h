@@ -84,6 +84,25 @@ class GPUProcessState {
   virtual Allocator* GetGPUAllocator(const GPUOptions& options,
                                      TfGpuId tf_gpu_id, size_t total_bytes);
 
+  // Returns the GPU allocator for devices of tf_gpu_id whose streams have
+  // the given session stream priority (see
+  // GPUOptions.Experimental.session_stream_priority). Such devices don't
+  // share their streams, and so can't share the allocator returned by
+  // GetGPUAllocator(). The first call for a {tf_gpu_id, priority} pair
+  // creates a BFC allocator of total_bytes, and later calls share it.
+  //
+  // Priority 0 is the default, and returns GetGPUAllocator().
+  virtual Allocator* GetGPUAllocatorForStreamPriority(const GPUOptions& options,
+                                                      TfGpuId tf_gpu_id,
+                                                      int priority,
+                                                      size_t total_bytes);
+
+  // Returns the allocator of CUDA unified memory for tf_gpu_id, which backs
+  // allocations with AllocatorAttributes::unified_memory() on that GPU. Its
+  // memory can exceed the device memory, and is migrated to the GPU on demand
+  // or by prefetching. The first call for a tf_gpu_id creates the allocator.
+  virtual Allocator* GetGpuManagedAllocator(TfGpuId tf_gpu_id);
+
   int NumGPUAllocators() {
     mutex_lock l(mu_);
     return gpu_allocators_.size();
@@ -150,6 +169,13 @@ class GPUProcessState {
   std::vector<AllocatorParts> gpu_allocators_ TF_GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_visitors_
       TF_GUARDED_BY(mu_);
+  // Keyed by {tf_gpu_id, session stream priority}.
+  std::map<std::pair<int, int>, AllocatorParts> priority_gpu_allocators_
+      TF_GUARDED_BY(mu_);
+
+  // Keyed by tf_gpu_id.
+  std::map<int, std::unique_ptr<Allocator>> gpu_managed_allocators_
+      TF_GUARDED_BY(mu_);
 
   std::vector<AllocatorParts> gpu_host_allocators_ TF_GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_host_alloc_visitors_
@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_quota_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+GPUQuotaAllocator::GPUQuotaAllocator(Allocator* allocator, int64 quota_bytes)
+    : AllocatorWrapper(allocator), quota_bytes_(quota_bytes) {
+  stats_.bytes_limit = quota_bytes;
+}
+
+GPUQuotaAllocator::~GPUQuotaAllocator() {
+  mutex_lock l(mu_);
+  if (!sizes_.empty()) {
+    LOG(ERROR) << sizes_.size() << " allocations of " << Name()
+               << " are still live when its quota is destroyed.";
+  }
+}
+
+void* GPUQuotaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (!Reserve(num_bytes)) return nullptr;
+  return Record(wrapped()->AllocateRaw(alignment, num_bytes), num_bytes);
+}
+
+void* GPUQuotaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (!Reserve(num_bytes)) return nullptr;
+  return Record(wrapped()->AllocateRaw(alignment, num_bytes, allocation_attr),
+                num_bytes);
+}
+
+void GPUQuotaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  {
+    mutex_lock l(mu_);
+    auto it = sizes_.find(ptr);
+    if (it != sizes_.end()) {
+      stats_.bytes_in_use -= it->second;
+      sizes_.erase(it);
+    }
+  }
+  wrapped()->DeallocateRaw(ptr);
+}
+
+bool GPUQuotaAllocator::Reserve(size_t num_bytes) {
+  mutex_lock l(mu_);
+  if (stats_.bytes_in_use + static_cast<int64>(num_bytes) > quota_bytes_) {
+    LOG(WARNING) << "Allocation of " << num_bytes << " bytes from " << Name()
+                 << " exceeds the session memory limit of " << quota_bytes_
+                 << " bytes, with " << stats_.bytes_in_use
+                 << " bytes in use.";
+    return false;
+  }
+  stats_.bytes_in_use += num_bytes;
+  return true;
+}
+
+void* GPUQuotaAllocator::Record(void* ptr, size_t num_bytes) {
+  mutex_lock l(mu_);
+  if (ptr == nullptr) {
+    stats_.bytes_in_use -= num_bytes;
+    return nullptr;
+  }
+  sizes_[ptr] = num_bytes;
+  ++stats_.num_allocs;
+  stats_.peak_bytes_in_use =
+      std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+  stats_.largest_alloc_size =
+      std::max<int64>(stats_.largest_alloc_size, num_bytes);
+  return ptr;
+}
+
+absl::optional<AllocatorStats> GPUQuotaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  return stats_;
+}
+
+void GPUQuotaAllocator::ClearStats() {
+  mutex_lock l(mu_);
+  stats_.num_allocs = 0;
+  stats_.peak_bytes_in_use = stats_.bytes_in_use;
+  stats_.largest_alloc_size = 0;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_QUOTA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_QUOTA_ALLOCATOR_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that wraps the GPU allocator shared by all sessions, and
+// fails the allocations of one session that would take its memory in use
+// past quota_bytes. This bounds what one model can take from the others
+// sharing the GPU (see GPUOptions.Experimental.session_memory_limit_mb).
+//
+// GetStats() reports this session's usage, with the quota as bytes_limit.
+class GPUQuotaAllocator : public AllocatorWrapper {
+ public:
+  GPUQuotaAllocator(Allocator* allocator, int64 quota_bytes);
+  ~GPUQuotaAllocator() override;
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  void ClearStats() override;
+
+ private:
+  // Returns false if num_bytes more would exceed the quota, and otherwise
+  // counts them as in use.
+  bool Reserve(size_t num_bytes);
+  // Records the allocation of ptr, or returns the bytes reserved for it if
+  // the wrapped allocator failed.
+  void* Record(void* ptr, size_t num_bytes);
+
+  const int64 quota_bytes_;
+
+  mutex mu_;
+  absl::flat_hash_map<void*, size_t> sizes_ TF_GUARDED_BY(mu_);
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GPUQuotaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_QUOTA_ALLOCATOR_H_
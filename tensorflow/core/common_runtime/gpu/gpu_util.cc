@@ -15,12 +15,17 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_reference.h"
@@ -109,6 +114,92 @@ void* GetBase(const Tensor* src) {
 
 void* GetBase(Tensor* dst) { return DMAHelper::base(dst); }
 
+// Returns the allocator of the pinned buffers to stage a copy to or from
+// host_tensor through, or nullptr if the tensor should be copied directly:
+// when staging is disabled, the tensor fits in one chunk, or it is already in
+// pinned memory.
+Allocator* GetHostCopyStagingAllocator(Device* gpu_device,
+                                       const GPUDeviceContext* device_context,
+                                       const Tensor& host_tensor) {
+  const int64 chunk_bytes = device_context->host_copy_staging_chunk_bytes();
+  if (chunk_bytes <= 0 || host_tensor.TotalBytes() <= chunk_bytes) {
+    return nullptr;
+  }
+  Allocator* allocator = GPUProcessState::singleton()->GetGpuHostAllocator(
+      gpu_device->attributes().locality().numa_node());
+  AllocationDescription allocation_description;
+  DMAHelper::buffer(&host_tensor)
+      ->FillAllocationDescription(&allocation_description);
+  if (allocation_description.allocator_name() == allocator->Name()) {
+    return nullptr;
+  }
+  return allocator;
+}
+
+// Copies total_bytes from pageable host memory to the device through pinned
+// chunks of chunk_bytes, so that the host copy of each chunk overlaps the DMA
+// of the previous one. The remaining bytes are copied directly if a chunk
+// can't be allocated. Returns the chunks to free once the stream is done.
+std::vector<void*> StagedCopyToDevice(Allocator* staging_allocator,
+                                      int64 chunk_bytes, const char* src,
+                                      void* dst, int64 total_bytes,
+                                      se::Stream* stream) {
+  std::vector<void*> chunks;
+  int64 offset = 0;
+  for (; offset < total_bytes; offset += chunk_bytes) {
+    const int64 bytes = std::min(chunk_bytes, total_bytes - offset);
+    void* chunk = staging_allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                                 bytes);
+    if (chunk == nullptr) break;
+    chunks.push_back(chunk);
+    memcpy(chunk, src + offset, bytes);
+    DeviceMemoryBase gpu_dst_ptr(static_cast<char*>(dst) + offset, bytes);
+    stream->ThenMemcpy(&gpu_dst_ptr, chunk, bytes);
+  }
+  if (offset < total_bytes) {
+    DeviceMemoryBase gpu_dst_ptr(static_cast<char*>(dst) + offset,
+                                 total_bytes - offset);
+    stream->ThenMemcpy(&gpu_dst_ptr, src + offset, total_bytes - offset);
+  }
+  return chunks;
+}
+
+// Copies total_bytes from the device to pageable host memory through pinned
+// chunks of chunk_bytes. Each chunk is copied to dst by the event manager as
+// soon as its DMA is done, overlapping the DMA of the next chunks. The
+// remaining bytes are copied directly if a chunk can't be allocated.
+// pending_callbacks is incremented for each chunk, whose callback calls
+// chunk_done once.
+void StagedCopyFromDevice(Allocator* staging_allocator, int64 chunk_bytes,
+                          const void* src, char* dst, int64 total_bytes,
+                          se::Stream* stream, EventMgr* event_mgr,
+                          std::atomic<int>* pending_callbacks,
+                          std::function<void()> chunk_done) {
+  int64 offset = 0;
+  for (; offset < total_bytes; offset += chunk_bytes) {
+    const int64 bytes = std::min(chunk_bytes, total_bytes - offset);
+    void* chunk = staging_allocator->AllocateRaw(Allocator::kAllocatorAlignment,
+                                                 bytes);
+    if (chunk == nullptr) break;
+    DeviceMemoryBase gpu_src_ptr(
+        const_cast<char*>(static_cast<const char*>(src)) + offset, bytes);
+    stream->ThenMemcpy(chunk, gpu_src_ptr, bytes);
+    ++*pending_callbacks;
+    event_mgr->ThenExecute(stream, [staging_allocator, chunk, bytes,
+                                    dst = dst + offset, chunk_done]() {
+      memcpy(dst, chunk, bytes);
+      staging_allocator->DeallocateRaw(chunk);
+      chunk_done();
+    });
+  }
+  if (offset < total_bytes) {
+    DeviceMemoryBase gpu_src_ptr(
+        const_cast<char*>(static_cast<const char*>(src)) + offset,
+        total_bytes - offset);
+    stream->ThenMemcpy(dst + offset, gpu_src_ptr, total_bytes - offset);
+  }
+}
+
 /*static*/
 void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
                               const DeviceContext* device_context,
@@ -265,9 +356,10 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
     return;
   }
 
-  auto send_device_to_host_stream =
-      static_cast<const GPUDeviceContext*>(device_context)
-          ->device_to_host_stream();
+  auto* gpu_device_context =
+      static_cast<const GPUDeviceContext*>(device_context);
+  auto send_device_to_host_stream = gpu_device_context->device_to_host_stream(
+      gpu_device_context->next_host_copy_stream_index());
   if (send_device_to_host_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -278,9 +370,29 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   const int64 total_bytes = gpu_tensor->TotalBytes();
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    Allocator* staging_allocator = GetHostCopyStagingAllocator(
+        gpu_device, gpu_device_context, *cpu_tensor);
+    if (staging_allocator != nullptr) {
+      // done is called once the chunk callbacks and the final callback below
+      // have all run. The extra count keeps it from being called while the
+      // chunks are still being enqueued.
+      auto pending_callbacks = std::make_shared<std::atomic<int>>(2);
+      StatusCallback staged_done = [pending_callbacks, done](const Status& s) {
+        if (--*pending_callbacks == 0) done(s);
+      };
+      StagedCopyFromDevice(
+          staging_allocator,
+          gpu_device_context->host_copy_staging_chunk_bytes(), src_ptr,
+          static_cast<char*>(dst_ptr), total_bytes, send_device_to_host_stream,
+          dev_info->event_mgr, pending_callbacks.get(),
+          [staged_done]() { staged_done(Status::OK()); });
+      staged_done(Status::OK());
+      done = std::move(staged_done);
+    } else {
+      DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
+      send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    }
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
@@ -310,9 +422,10 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     return;
   }
 
-  auto recv_host_to_device_stream =
-      static_cast<const GPUDeviceContext*>(device_context)
-          ->host_to_device_stream();
+  auto* gpu_device_context =
+      static_cast<const GPUDeviceContext*>(device_context);
+  auto recv_host_to_device_stream = gpu_device_context->host_to_device_stream(
+      gpu_device_context->next_host_copy_stream_index());
   if (recv_host_to_device_stream == nullptr) {
     done(errors::Internal("No send gpu copy-out-stream is available."));
     return;
@@ -323,19 +436,36 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   }
 
   const int64 total_bytes = cpu_tensor->TotalBytes();
+  Allocator* staging_allocator = nullptr;
+  std::vector<void*> staging_chunks;
   // Note that 0-size tensors have no backing buffer.
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
-    recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
+    staging_allocator = GetHostCopyStagingAllocator(
+        gpu_device, gpu_device_context, *cpu_tensor);
+    if (staging_allocator != nullptr) {
+      staging_chunks = StagedCopyToDevice(
+          staging_allocator,
+          gpu_device_context->host_copy_staging_chunk_bytes(),
+          static_cast<const char*>(src_ptr), dst_ptr, total_bytes,
+          recv_host_to_device_stream);
+    } else {
+      DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
+      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
+                                             total_bytes);
+    }
   }
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
-      [recv_host_to_device_stream, done, input_ref]() {
+      [recv_host_to_device_stream, done, input_ref, staging_allocator,
+       staging_chunks]() {
         input_ref.Unref();
+        for (void* chunk : staging_chunks) {
+          staging_allocator->DeallocateRaw(chunk);
+        }
         if (!recv_host_to_device_stream->ok()) {
           LOG(FATAL) << "CPU->GPU Memcpy failed";
         }
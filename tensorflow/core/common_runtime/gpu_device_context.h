@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -33,9 +35,10 @@ class GPUDeviceContext : public DeviceContext {
 #if TENSORFLOW_USE_ROCM
                    se::Stream* nccl_stream,
 #endif
-                   se::Stream* host_to_device_stream,
-                   se::Stream* device_to_host_stream,
-                   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream)
+                   gtl::InlinedVector<se::Stream*, 4> host_to_device_stream,
+                   gtl::InlinedVector<se::Stream*, 4> device_to_host_stream,
+                   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream,
+                   int64 host_copy_staging_chunk_bytes = 0)
       : stream_id_(stream_id),
         stream_(stream),
 #if TENSORFLOW_USE_ROCM
@@ -43,7 +46,8 @@ class GPUDeviceContext : public DeviceContext {
 #endif
         host_to_device_stream_(host_to_device_stream),
         device_to_host_stream_(device_to_host_stream),
-        device_to_device_stream_(device_to_device_stream) {
+        device_to_device_stream_(device_to_device_stream),
+        host_copy_staging_chunk_bytes_(host_copy_staging_chunk_bytes) {
   }
 
   ~GPUDeviceContext() override {}
@@ -52,8 +56,26 @@ class GPUDeviceContext : public DeviceContext {
 #if TENSORFLOW_USE_ROCM
   se::Stream* nccl_stream() const { return nccl_stream_; }
 #endif
-  se::Stream* host_to_device_stream() const { return host_to_device_stream_; }
-  se::Stream* device_to_host_stream() const { return device_to_host_stream_; }
+  se::Stream* host_to_device_stream() const {
+    return host_to_device_stream_[0];
+  }
+  se::Stream* host_to_device_stream(int index) const {
+    return host_to_device_stream_[index % host_to_device_stream_.size()];
+  }
+  se::Stream* device_to_host_stream() const {
+    return device_to_host_stream_[0];
+  }
+  se::Stream* device_to_host_stream(int index) const {
+    return device_to_host_stream_[index % device_to_host_stream_.size()];
+  }
+  // Returns an index that cycles over the host copy streams, so that
+  // concurrent copies to and from the host are spread over them.
+  int next_host_copy_stream_index() const {
+    return next_host_copy_stream_++ % host_to_device_stream_.size();
+  }
+  int64 host_copy_staging_chunk_bytes() const {
+    return host_copy_staging_chunk_bytes_;
+  }
   se::Stream* device_to_device_stream(int index) const {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
@@ -86,12 +108,16 @@ class GPUDeviceContext : public DeviceContext {
   // The stream to use for nccl operations.
   se::Stream* nccl_stream_;
 #endif
-  // The stream to use for copying data from host into GPU.
-  se::Stream* host_to_device_stream_;
-  // The stream to use for copying data from GPU to host.
-  se::Stream* device_to_host_stream_;
+  // Streams to use for copying data from host into GPU.
+  gtl::InlinedVector<se::Stream*, 4> host_to_device_stream_;
+  // Streams to use for copying data from GPU to host.
+  gtl::InlinedVector<se::Stream*, 4> device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  mutable std::atomic<uint32> next_host_copy_stream_{0};
+  // Size of the pinned chunks pageable host tensors are copied through, if
+  // > 0.
+  const int64 host_copy_staging_chunk_bytes_;
 };
 
 }  // namespace tensorflow
@@ -39,12 +39,15 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/public/version.h"
 
@@ -66,6 +69,10 @@ inline bool IsNextIteration(const NodeDef& node_def) {
          node_def.op() == "RefNextIteration";
 }
 
+// Graphs with fewer nodes than this are converted on a single thread, since
+// starting threads would cost more than it saves.
+constexpr int kMinNodesForParallelPreparation = 4096;
+
 bool IsValidNodeName(StringPiece s, bool allow_internal_ops) {
   using ::tensorflow::strings::Scanner;
   Scanner scanner(s);
@@ -226,6 +233,7 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(std::shared_ptr<NodeProperties> props, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -270,6 +278,22 @@ class GraphConstructor {
   // have all of their pending inputs satisfied to `ready_`.
   void UpdatePendingCountAndReady(int processed, bool is_next_iteration);
 
+  // When converting (not importing) a large graph, consumes every NodeDef and
+  // computes its NodeProperties on multiple threads, filling
+  // `prepared_nodes_` and `prepared_status_`. Nodes are validated
+  // independently of each other, so only adding them and their edges to g_
+  // remains sequential.
+  void MaybePrepareNodesInParallel();
+
+  // Adds default attributes to `node_def`, validates it and computes its
+  // NodeProperties, as Convert() and Graph::AddNode() do when converting.
+  Status PrepareNode(NodeDef node_def, std::shared_ptr<NodeProperties>* props);
+
+  // Returns the i^th node in the graph, for logging. Unlike get_node_def(), it
+  // can be called after the NodeDef was consumed by
+  // MaybePrepareNodesInParallel().
+  const NodeDef& get_node_def_for_logging(int i) const;
+
   // Subclasses override the following virtual methods to provide efficient
   // access to the original protocol buffer-based graph.
 
@@ -280,7 +304,7 @@ class GraphConstructor {
   virtual const NodeDef& get_node_def(int i) const = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
-  // undefined.
+  // undefined. Distinct nodes may be consumed concurrently.
   virtual NodeDef consume_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
@@ -351,6 +375,12 @@ class GraphConstructor {
   // still need to be converted.
   std::vector<int> pending_count_;
 
+  // Filled by MaybePrepareNodesInParallel(). The properties of each node, and
+  // the status of computing them. Entries of `prepared_nodes_` are moved out
+  // as the nodes are added to g_.
+  std::vector<std::shared_ptr<NodeProperties>> prepared_nodes_;
+  std::vector<Status> prepared_status_;
+
   // Mapping between index within node_defs_ and the index within node_defs_ of
   // all nodes it outputs to.
   std::vector<gtl::InlinedVector<int, 4>> outputs_;
@@ -435,7 +465,7 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
       : GraphConstructor(opts, g, refiner, return_tensors, return_nodes,
                          missing_unused_input_map_keys),
         graph_def_(std::move(graph_def)),
-        is_consumed_(graph_def_.node_size(), false) {}
+        is_consumed_(graph_def_.node_size(), 0) {}
 
  private:
   size_t node_def_count() const override { return graph_def_.node().size(); }
@@ -446,7 +476,7 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
   NodeDef consume_node_def(int i) override {
     CHECK(!is_consumed_[i]) << "NodeDef " << i << " consumed twice.";
-    is_consumed_[i] = true;
+    is_consumed_[i] = 1;
     return std::move(*graph_def_.mutable_node(i));
   }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
@@ -455,7 +485,9 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a std::vector<bool>, so that distinct entries can be written
+  // concurrently.
+  std::vector<uint8> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -782,6 +814,72 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   return Status::OK();
 }
 
+Status GraphConstructor::MakeNode(std::shared_ptr<NodeProperties> props,
+                                  Node** node) {
+  Status status;
+  *node = g_->AddNode(std::move(props), &status);
+  if (!status.ok()) return status;
+  if (opts_.expect_device_spec) {
+    (*node)->set_assigned_device_name((*node)->def().device());
+  }
+  return Status::OK();
+}
+
+Status GraphConstructor::PrepareNode(NodeDef node_def,
+                                     std::shared_ptr<NodeProperties>* props) {
+  const OpDef* op_def = nullptr;
+  DataTypeVector inputs;
+  DataTypeVector outputs;
+  Status status = g_->op_registry()->LookUpOpDef(node_def.op(), &op_def);
+  if (status.ok()) {
+    if (opts_.add_default_attributes) {
+      AddDefaultsToNodeDef(*op_def, &node_def);
+    }
+    if (opts_.validate_nodes) {
+      status = ValidateNodeDef(node_def, *op_def);
+    }
+  }
+  if (status.ok()) {
+    status = InOutTypesForNode(node_def, *op_def, &inputs, &outputs);
+    if (!status.ok()) status = AttachDef(status, node_def);
+  }
+  // The properties are kept on error as well, since the NodeDef has been
+  // consumed and may still be needed for logging.
+  *props = std::make_shared<NodeProperties>(op_def, std::move(node_def),
+                                            std::move(inputs),
+                                            std::move(outputs));
+  return status;
+}
+
+void GraphConstructor::MaybePrepareNodesInParallel() {
+  const int num_nodes = node_def_count();
+  const int num_threads =
+      std::min(port::MaxParallelism(),
+               num_nodes / (kMinNodesForParallelPreparation / 2));
+  if (opts_.importing || num_nodes < kMinNodesForParallelPreparation ||
+      num_threads <= 1) {
+    return;
+  }
+  prepared_nodes_.resize(num_nodes);
+  prepared_status_.resize(num_nodes);
+  thread::ThreadPool pool(Env::Default(), "graph_constructor", num_threads);
+  // Validating a NodeDef and inferring its types takes a few microseconds.
+  const int64 kCostPerNode = 10000;
+  pool.ParallelFor(num_nodes, kCostPerNode, [this](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      prepared_status_[i] =
+          PrepareNode(consume_node_def(i), &prepared_nodes_[i]);
+    }
+  });
+}
+
+const NodeDef& GraphConstructor::get_node_def_for_logging(int i) const {
+  if (!prepared_nodes_.empty() && prepared_nodes_[i] != nullptr) {
+    return prepared_nodes_[i]->node_def;
+  }
+  return get_node_def(i);
+}
+
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return Status::OK();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
@@ -1070,7 +1168,7 @@ void GraphConstructor::DFS(int cur_node, std::vector<int>* cur_branch,
             std::find(cur_branch->begin(), cur_branch->end(), next_node);
         LOG(WARNING) << "Cycle detected:";
         while (iter != cur_branch->end()) {
-          LOG(WARNING) << SummarizeNodeDef(get_node_def(*iter));
+          LOG(WARNING) << SummarizeNodeDef(get_node_def_for_logging(*iter));
           ++iter;
         }
         LOG(WARNING) << "End of cycle";
@@ -1113,6 +1211,8 @@ Status GraphConstructor::Convert() {
     TF_RETURN_IF_ERROR(g_->AddFunctionLibrary(*library()));
   }
 
+  MaybePrepareNodesInParallel();
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1129,7 +1229,16 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    // If the node was prepared in parallel, its NodeDef lives in its
+    // properties.
+    std::shared_ptr<NodeProperties> props;
+    NodeDef consumed_node_def;
+    if (!prepared_nodes_.empty()) {
+      props = std::move(prepared_nodes_[o]);
+    } else {
+      consumed_node_def = consume_node_def(o);
+    }
+    NodeDef& node_def = props ? props->node_def : consumed_node_def;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1230,6 +1339,8 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
+    } else if (props) {
+      TF_RETURN_IF_ERROR(prepared_status_[o]);
     } else {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
@@ -1242,7 +1353,11 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    if (props) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(props), &node));
+    } else {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    }
 
     if (opts_.importing) {
       // Use interned original node name so StringPiece remains valid.
@@ -1286,7 +1401,8 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64 i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        LOG(WARNING) << "PENDING: "
+                     << SummarizeNodeDef(get_node_def_for_logging(i))
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -923,6 +923,65 @@ TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
       {"Node 't2': Control dependencies must come after regular dependencies"});
 }
 
+// Returns a GraphDef large enough for its nodes to be prepared in parallel: a
+// chain of `num_nodes` TestMul nodes, followed by a TestDefaultAttr node.
+GraphDef LargeChainGraphDef(int num_nodes) {
+  GraphDef gdef;
+  NodeDef* input = gdef.add_node();
+  input->set_name("input");
+  input->set_op("TestInput");
+  string prev = "input";
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = gdef.add_node();
+    node->set_name(strings::StrCat("mul", i));
+    node->set_op("TestMul");
+    node->add_input(prev);
+    node->add_input("input:1");
+    prev = node->name();
+  }
+  NodeDef* last = gdef.add_node();
+  last->set_name("default_attr");
+  last->set_op("TestDefaultAttr");
+  last->add_input(strings::StrCat("^", prev));
+  return gdef;
+}
+
+TEST_F(GraphConstructorTest, LargeModel) {
+  const int kNumNodes = 20000;
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(
+      ConvertGraphDefToGraph(opts, LargeChainGraphDef(kNumNodes), &graph_));
+  // Source and sink, input, the chain and default_attr.
+  EXPECT_EQ(kNumNodes + 4, graph_.num_nodes());
+  EXPECT_TRUE(HasEdge("input", 0, "mul0", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "mul0", 1));
+  EXPECT_TRUE(HasEdge("mul0", 0, "mul1", 0));
+  EXPECT_TRUE(HasEdge(strings::StrCat("mul", kNumNodes - 2), 0,
+                      strings::StrCat("mul", kNumNodes - 1), 0));
+  EXPECT_TRUE(
+      HasControlEdge(strings::StrCat("mul", kNumNodes - 1), "default_attr"));
+
+  Node* node = FindNode("default_attr");
+  ASSERT_TRUE(node != nullptr);
+  int value = 0;
+  TF_ASSERT_OK(GetNodeAttr(node->attrs(), "default_int", &value));
+  EXPECT_EQ(31415, value);
+}
+
+TEST_F(GraphConstructorTest, LargeModelWithInvalidNode) {
+  GraphDef gdef = LargeChainGraphDef(20000);
+  (*gdef.mutable_node(100)->mutable_attr())["foo"].set_i(1);
+  const string original_graph_description = GraphDebugString();
+
+  GraphConstructorOptions opts;
+  opts.validate_nodes = true;
+  Status status = ConvertGraphDefToGraph(opts, std::move(gdef), &graph_);
+  EXPECT_FALSE(status.ok());
+  EXPECT_TRUE(status.error_message().find("attr 'foo'") != string::npos)
+      << status;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef) {
   GraphDef def;
   ImportGraphDefOptions opts;
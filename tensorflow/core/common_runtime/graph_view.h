@@ -35,6 +35,10 @@ class Node;
 class OpKernel;
 class Tensor;
 
+namespace monitoring {
+class SamplerCell;
+}  // namespace monitoring
+
 // Represents a single data edge in a `NodeItem`.
 struct EdgeInfo {
   // The node ID of the destination in the containing `GraphView`.
@@ -83,6 +87,9 @@ struct NodeItem {
                                                      // node.
   bool is_any_input_ref_typed : 1;  // True iff any IsRefType(dt) for dt in this
                                     // node's input types.
+  bool is_any_consumer_collective : 1;  // True iff the destination of any
+                                        // output edge is a collective or
+                                        // NCCL op.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -90,6 +97,9 @@ struct NodeItem {
   // If the kernel is a Const op, this containts points to the constant tensor.
   const Tensor* const_tensor = nullptr;
 
+  // If non-null, the latency of each execution of the kernel is added to it.
+  monitoring::SamplerCell* latency_cell = nullptr;
+
   // Cached values of node->num_inputs() and node->num_outputs(), to
   // avoid levels of indirection.
   int num_inputs;
@@ -0,0 +1,341 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+// Set true for greater intelligibility of debug mode log messages.
+#define READABLE_KEYS false
+
+namespace tensorflow {
+
+namespace {
+// Key to be used for BufRendezvous by HierarchicalRingReducer.  Within a
+// phase a device sends every chunk at most once.
+string HierarchicalRingBufKey(const string& exec_key, int phase, int chunk_idx,
+                              int src_dev_idx) {
+  if (READABLE_KEYS) {
+    return strings::StrCat("hierarchical_reduce(", exec_key, "):phase(", phase,
+                           "):chunk(", chunk_idx, "):src(", src_dev_idx, ")");
+  } else {
+    return strings::StrCat(exec_key, ":", phase, ":", chunk_idx, ":",
+                           src_dev_idx);
+  }
+}
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(-1),
+      num_devices_per_task_(-1),
+      task_idx_(-1),
+      local_rank_(-1) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalRingReduce");
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce supports only CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  // Precondition: device_names must be sorted so that all devices in the same
+  // task are adjacent.
+  const int group_size = col_params->group.group_size;
+  const int num_tasks = col_params->group.num_tasks;
+  if (num_tasks <= 0 || group_size % num_tasks != 0) {
+    return errors::InvalidArgument(
+        "HierarchicalRingReduce requires the same number of devices in every "
+        "task, got ",
+        group_size, " devices in ", num_tasks, " tasks");
+  }
+  const int dev_per_task = group_size / num_tasks;
+  for (int di = 0; di < group_size; ++di) {
+    if (col_params->instance.task_names[di] !=
+        col_params->instance.task_names[di - di % dev_per_task]) {
+      return errors::InvalidArgument(
+          "HierarchicalRingReduce requires the same number of devices in "
+          "every task, but task ",
+          col_params->instance.task_names[di - di % dev_per_task],
+          " does not have ", dev_per_task, " devices");
+    }
+  }
+
+  const int num_subdivs = num_tasks + dev_per_task;
+  col_params->instance.impl_details.subdiv_permutations.clear();
+  col_params->instance.impl_details.subdiv_permutations.resize(num_subdivs);
+  col_params->subdiv_rank.assign(num_subdivs, -1);
+  const int my_task = col_params->default_rank / dev_per_task;
+  const int my_local_rank = col_params->default_rank % dev_per_task;
+  // Intra-task subdivs: all devices of task ti, in device order.
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    std::vector<int>& perm =
+        col_params->instance.impl_details.subdiv_permutations[ti];
+    for (int di = 0; di < dev_per_task; ++di) {
+      perm.push_back(ti * dev_per_task + di);
+    }
+  }
+  col_params->subdiv_rank[my_task] = my_local_rank;
+  // Inter-task subdivs: the device at position di of every task.
+  for (int di = 0; di < dev_per_task; ++di) {
+    std::vector<int>& perm =
+        col_params->instance.impl_details.subdiv_permutations[num_tasks + di];
+    for (int ti = 0; ti < num_tasks; ++ti) {
+      perm.push_back(ti * dev_per_task + di);
+    }
+  }
+  col_params->subdiv_rank[num_tasks + my_local_rank] = my_task;
+
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalRingReducer` doesn't require non-overlapping
+  // collectives, unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  num_tasks_ = col_params_->group.num_tasks;
+  num_devices_per_task_ = col_params_->group.group_size / num_tasks_;
+  task_idx_ = col_params_->default_rank / num_devices_per_task_;
+  local_rank_ = col_params_->default_rank % num_devices_per_task_;
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    // We are running in a blockable thread and the callback can't block so
+    // just wait here on the copy.
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output,
+                                  col_params_->group.group_size,
+                                  col_ctx_->device->GetAllocator(attr)));
+  Status s = RunHierarchicalRing();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  } else {
+    // Cancel the transfers of the other devices, which may wait on ours.
+    col_ctx_->col_exec->StartAbort(s);
+  }
+  ca_.reset();
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << s;
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunHierarchicalRing() {
+  const int n = num_tasks_;
+  const int d = num_devices_per_task_;
+  // Chunk c belongs to slice c / n.  The intra-task rings move whole slices.
+  auto slice_chunks = [n](int slice) {
+    std::vector<int> chunks;
+    chunks.reserve(n);
+    for (int ci = 0; ci < n; ++ci) chunks.push_back(slice * n + ci);
+    return chunks;
+  };
+  // After the intra-task reduce-scatter this device holds the task-wide sum
+  // of `slice`, which the inter-task ring reduces one chunk at a time.
+  const int slice = (local_rank_ + 1) % d;
+  auto chunk_of_slice = [n, slice](int ci) {
+    return std::vector<int>({slice * n + ci});
+  };
+  const int intra_subdiv = task_idx_;
+  const int inter_subdiv = n + local_rank_;
+
+  TF_RETURN_IF_ERROR(RunRing(kIntraTaskReduceScatter, intra_subdiv,
+                             /*reduce=*/true, slice_chunks));
+  TF_RETURN_IF_ERROR(RunRing(kInterTaskReduceScatter, inter_subdiv,
+                             /*reduce=*/true, chunk_of_slice));
+  // This device now holds the group-wide sum of one chunk.
+  if (col_params_->final_op) {
+    int chunk_idx = slice * n + (task_idx_ + 1) % n;
+    if (ca_->ChunkBytes(chunk_idx) > 0) {
+      Tensor chunk = ca_->ChunkAlias(chunk_idx);
+      Tensor group_size_tensor = ca_->Scalar(col_params_->group.group_size);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->final_op.get(), &chunk, &group_size_tensor));
+    }
+  }
+  TF_RETURN_IF_ERROR(RunRing(kInterTaskAllGather, inter_subdiv,
+                             /*reduce=*/false, chunk_of_slice));
+  return RunRing(kIntraTaskAllGather, intra_subdiv, /*reduce=*/false,
+                 slice_chunks);
+}
+
+Status HierarchicalRingReducer::RunRing(
+    Phase phase, int subdiv, bool reduce,
+    const std::function<std::vector<int>(int)>& chunks_of_section) {
+  const int ring_size = static_cast<int>(
+      col_params_->instance.impl_details.subdiv_permutations[subdiv].size());
+  const int rank = col_params_->subdiv_rank[subdiv];
+  DCHECK_GE(rank, 0);
+  // A reduce-scatter starts by sending the section at this rank, and leaves
+  // this device with the fully reduced section at rank + 1, with which the
+  // matching all-gather starts.
+  const int first_section = reduce ? rank : rank + 1;
+  for (int step = 0; step < ring_size - 1; ++step) {
+    const int send_section = (first_section - step + ring_size) % ring_size;
+    const int recv_section =
+        (first_section - step - 1 + 2 * ring_size) % ring_size;
+    TF_RETURN_IF_ERROR(Exchange(phase, subdiv, chunks_of_section(send_section),
+                                chunks_of_section(recv_section), reduce));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::Exchange(Phase phase, int subdiv,
+                                         const std::vector<int>& send_chunks,
+                                         const std::vector<int>& recv_chunks,
+                                         bool reduce) {
+  const std::vector<int>& perm =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv];
+  const int ring_size = static_cast<int>(perm.size());
+  const int rank = col_params_->subdiv_rank[subdiv];
+  const int send_to_dev_idx = perm[(rank + 1) % ring_size];
+  const int recv_from_dev_idx = perm[(rank + ring_size - 1) % ring_size];
+
+  // Empty chunks are skipped by both ends of a transfer.
+  std::vector<Tensor> send_tensors;
+  for (int chunk_idx : send_chunks) {
+    if (ca_->ChunkBytes(chunk_idx) > 0) {
+      send_tensors.push_back(ca_->ChunkAlias(chunk_idx));
+    }
+  }
+  std::vector<int> recv_chunk_idxs;
+  std::vector<Tensor> recv_tensors;
+  for (int chunk_idx : recv_chunks) {
+    if (ca_->ChunkBytes(chunk_idx) > 0) {
+      recv_chunk_idxs.push_back(chunk_idx);
+      recv_tensors.push_back(reduce ? ca_->TempChunk(chunk_idx)
+                                    : ca_->ChunkAlias(chunk_idx));
+    }
+  }
+
+  mutex mu;
+  Status status;
+  BlockingCounter pending(
+      static_cast<int>(send_tensors.size() + recv_tensors.size()));
+  auto transfer_done = [&mu, &status, &pending](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  int send_idx = 0;
+  for (int chunk_idx : send_chunks) {
+    if (ca_->ChunkBytes(chunk_idx) == 0) continue;
+    string send_buf_key =
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, chunk_idx,
+                               col_params_->default_rank);
+    VLOG(3) << "DispatchSend " << send_buf_key << " to_device "
+            << col_params_->instance.device_names[send_to_dev_idx];
+    col_ctx_->col_exec->PostToPeer(
+        col_params_->instance.device_names[send_to_dev_idx],
+        col_params_->instance.task_names[send_to_dev_idx], send_buf_key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &send_tensors[send_idx++],
+        col_ctx_->device_locality, transfer_done);
+  }
+  for (int i = 0; i < recv_chunk_idxs.size(); ++i) {
+    string recv_buf_key = HierarchicalRingBufKey(
+        col_ctx_->exec_key, phase, recv_chunk_idxs[i], recv_from_dev_idx);
+    VLOG(3) << "DispatchRecv " << recv_buf_key << " from_device "
+            << col_params_->instance.device_names[recv_from_dev_idx];
+    col_ctx_->col_exec->RecvFromPeer(
+        col_params_->instance.device_names[recv_from_dev_idx],
+        col_params_->instance.task_names[recv_from_dev_idx],
+        col_params_->task.is_local[recv_from_dev_idx], recv_buf_key,
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &recv_tensors[i],
+        col_ctx_->device_locality, 0 /*stream_index*/, transfer_done);
+  }
+  {
+    profiler::TraceMe activity("WaitForTransfers",
+                               profiler::TraceMeLevel::kInfo);
+    pending.Wait();
+  }
+  TF_RETURN_IF_ERROR(status);
+
+  if (reduce) {
+    for (int i = 0; i < recv_chunk_idxs.size(); ++i) {
+      Tensor chunk = ca_->ChunkAlias(recv_chunk_idxs[i]);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op.get(), &chunk, &recv_tensors[i]));
+    }
+  }
+  return Status::OK();
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
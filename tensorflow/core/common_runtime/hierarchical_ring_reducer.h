@@ -0,0 +1,99 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical ring-algorithm implementation of collective all-reduce, for
+// groups in which every task has the same number of CPU devices.
+//
+// With n tasks of d devices each, the tensor is split into d slices of n
+// chunks.  Each task first runs a ring reduce-scatter over its own devices,
+// which leaves device r of every task with the task-wide sum of slice
+// (r + 1) % d.  The n devices holding the same slice then run a ring
+// all-reduce of that slice across tasks, and finally each task runs a ring
+// all-gather over its own devices.  The flat ring takes 2(nd - 1) steps, each
+// as slow as the inter-task links; here only 2(n - 1) of the steps cross
+// tasks, on d rings in parallel, and the remaining 2(d - 1) stay within a
+// task.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Establishes the subdiv permutations of the hierarchical ring.  Subdiv t,
+  // for t < n, is the intra-task ring of the devices of task t.  Subdiv n + r
+  // is the inter-task ring of the devices at position r in their task.  A
+  // device that does not participate in a subdiv has subdiv_rank -1 there.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  // No-op for hierarchical ring reducer.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins async execution of the hierarchical ring reduce algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Phases of the algorithm, used to tell apart the BufRendezvous keys.
+  enum Phase {
+    kIntraTaskReduceScatter = 0,
+    kInterTaskReduceScatter,
+    kInterTaskAllGather,
+    kIntraTaskAllGather,
+  };
+
+  // Executes the three stages of the all-reduce, returning the first error.
+  Status RunHierarchicalRing();
+
+  // Runs the n - 1 steps of a ring reduce-scatter (if `reduce`) or ring
+  // all-gather over `subdiv`.  `chunks_of_section` maps a section of the
+  // ring, i.e. a slice for the intra-task rings and a chunk for the
+  // inter-task rings, to its chunks.
+  Status RunRing(Phase phase, int subdiv, bool reduce,
+                 const std::function<std::vector<int>(int)>& chunks_of_section);
+
+  // Sends `send_chunks` to the device at the next rank in `subdiv` and
+  // receives `recv_chunks` from the device at the previous rank, reducing them
+  // into the local value if `reduce`.  Blocks until all transfers are done.
+  Status Exchange(Phase phase, int subdiv, const std::vector<int>& send_chunks,
+                  const std::vector<int>& recv_chunks, bool reduce);
+
+  CollectiveContext* col_ctx_;          // Not owned
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  int num_tasks_;
+  int num_devices_per_task_;
+  int task_idx_;
+  int local_rank_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
@@ -0,0 +1,326 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <atomic>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/device_resolver_local.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/common_runtime/test_collective_executor_mgr.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/unbounded_work_queue.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Wraps CollectiveRemoteAccessLocal with the ability to return an
+// error status to the N'th action.
+class FailTestRMA : public CollectiveRemoteAccessLocal {
+ public:
+  FailTestRMA(const DeviceMgr* dev_mgr, DeviceResolverInterface* dev_resolver,
+              std::shared_ptr<UnboundedWorkQueue> work_queue, int64 step_id,
+              int fail_after)
+      : CollectiveRemoteAccessLocal(dev_mgr, dev_resolver, work_queue, step_id),
+        fail_after_(fail_after) {}
+
+  bool MaybeFail(const StatusCallback& done) {
+    bool fail_now = false;
+    {
+      mutex_lock l(mu_);
+      if (fail_after_ > 0) {
+        fail_now = (--fail_after_ == 0);
+      }
+    }
+    if (fail_now) {
+      done(errors::Internal("Deliberate failure"));
+      return true;
+    }
+    return false;
+  }
+
+  void RecvFromPeer(const string& peer_device, const string& peer_task,
+                    bool peer_is_local, const string& key, Device* to_device,
+                    DeviceContext* to_device_ctx,
+                    const AllocatorAttributes& to_alloc_attr, Tensor* to_tensor,
+                    const DeviceLocality& client_locality,
+                    int dev_to_dev_stream_index,
+                    const StatusCallback& done) override {
+    if (MaybeFail(done)) return;
+    CollectiveRemoteAccessLocal::RecvFromPeer(
+        peer_device, peer_task, peer_is_local, key, to_device, to_device_ctx,
+        to_alloc_attr, to_tensor, client_locality, dev_to_dev_stream_index,
+        done);
+  }
+
+  mutex mu_;
+  int fail_after_ TF_GUARDED_BY(mu_);
+};
+
+std::unique_ptr<OpKernel> GetKernel(const NodeDef& node, DeviceBase* device) {
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()), node,
+      TF_GRAPH_DEF_VERSION, &status);
+  if (!status.ok()) {
+    LOG(FATAL) << status;
+  }
+  return k;
+}
+
+std::unique_ptr<OpKernel> GetBinOp(const string& op, DataType dtype,
+                                   DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder(strings::StrCat(op, "_node"), op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  return GetKernel(node_def, device);
+}
+
+static int64 kStepId = 123;
+
+CollectiveParams SetUpCollectiveParams(int num_tasks, int num_devs_per_task) {
+  CollectiveParams cp;
+  const int kNumDevs = num_tasks * num_devs_per_task;
+  cp.name = "test_collective";
+  cp.group.group_key = 5;
+  cp.group.group_size = kNumDevs;
+  cp.group.device_type = DEVICE_CPU;
+  cp.group.num_tasks = num_tasks;
+  cp.instance.instance_key = 17;
+  cp.instance.type = REDUCTION_COLLECTIVE;
+  cp.instance.data_type = DT_FLOAT;
+  cp.instance.impl_details.collective_name = "HierarchicalRingReduce";
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    string task_name = strings::StrCat("/job:worker/replica:0/task:", ti);
+    cp.instance.num_devices_per_task[task_name] = num_devs_per_task;
+    for (int di = 0; di < num_devs_per_task; ++di) {
+      cp.instance.task_names.push_back(task_name);
+      cp.instance.device_names.push_back(
+          strings::StrCat(task_name, "/cpu:", di));
+      // This test runs in a single process so is_local is always true.
+      cp.task.is_local.push_back(true);
+    }
+  }
+  return cp;
+}
+
+class HierarchicalRingReducerTest : public ::testing::Test {
+ protected:
+  ~HierarchicalRingReducerTest() override {
+    if (col_exec_) col_exec_->Unref();
+  }
+
+  void Init(int num_tasks, int num_devs_per_task, int fail_after) {
+    std::vector<std::unique_ptr<Device>> local_devices;
+    SessionOptions sess_opts;
+    sess_opts.env = Env::Default();
+    Bytes mem_limit(4 << 20);
+    DeviceLocality dev_locality;
+    col_params_ = SetUpCollectiveParams(num_tasks, num_devs_per_task);
+    for (const string& dev_name : col_params_.instance.device_names) {
+      local_devices.push_back(absl::make_unique<ThreadPoolDevice>(
+          sess_opts, dev_name, mem_limit, dev_locality, cpu_allocator()));
+    }
+    dev_mgr_ = absl::make_unique<StaticDeviceMgr>(std::move(local_devices));
+    dev_resolver_ = absl::make_unique<DeviceResolverLocal>(dev_mgr_.get());
+    work_queue_ = std::make_shared<UnboundedWorkQueue>(Env::Default(), "test");
+    rma_ = new FailTestRMA(dev_mgr_.get(), dev_resolver_.get(), work_queue_,
+                           kStepId, fail_after);
+    col_exec_ = new BaseCollectiveExecutor(&col_exec_mgr_, rma_, kStepId,
+                                           dev_mgr_.get(), &gpu_ring_order_);
+  }
+
+  // Runs an all-reduce of a tensor of `tensor_len` in which device di
+  // contributes di * 10 + i at index i, and checks the mean computed by every
+  // device.
+  void RunTest(int num_tasks, int num_devs_per_task, int tensor_len,
+               int fail_after) {
+    Init(num_tasks, num_devs_per_task, fail_after);
+    const int num_devs = num_tasks * num_devs_per_task;
+    std::vector<Tensor> tensors(num_devs);
+    std::vector<Status> statuses(num_devs);
+    std::atomic<int> done(0);
+    for (int di = 0; di < num_devs; ++di) {
+      SchedClosure([this, di, tensor_len, &tensors, &statuses, &done] {
+        statuses[di] = DoReduce(di, tensor_len, &tensors[di]);
+        ++done;
+      });
+    }
+    while (done < num_devs) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    for (int di = 0; di < num_devs; ++di) {
+      if (fail_after > 0) {
+        EXPECT_NE(statuses[di].error_message().find("Deliberate failure"),
+                  string::npos);
+        continue;
+      }
+      TF_EXPECT_OK(statuses[di]);
+      auto actual = tensors[di].flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        // The mean of d * 10 + i over all devices d.
+        float expected = 5.0f * (num_devs - 1) + i;
+        EXPECT_FLOAT_EQ(expected, actual(i))
+            << "Mismatch at device " << di << " index " << i;
+      }
+    }
+  }
+
+  Status DoReduce(int rank, int tensor_len, Tensor* tensor) {
+    Device* device = nullptr;
+    TF_CHECK_OK(dev_mgr_->LookupDevice(col_params_.instance.device_names[rank],
+                                       &device));
+    *tensor = Tensor(device->GetAllocator(AllocatorAttributes()), DT_FLOAT,
+                     TensorShape({tensor_len}));
+    for (int i = 0; i < tensor_len; ++i) {
+      tensor->flat<float>()(i) = rank * 10 + i;
+    }
+    CollectiveParams col_params;
+    col_params.name = col_params_.name;
+    col_params.group = col_params_.group;
+    col_params.instance = col_params_.instance;
+    col_params.instance.shape = tensor->shape();
+    col_params.task.is_local = col_params_.task.is_local;
+    col_params.default_rank = rank;
+    HierarchicalRingReducer param_reducer;
+    TF_RETURN_IF_ERROR(param_reducer.InitializeCollectiveParams(&col_params));
+    col_params.merge_op = GetBinOp("Add", DT_FLOAT, device);
+    col_params.final_op = GetBinOp("Div", DT_FLOAT, device);
+
+    // Prepare an OpKernelContext.
+    OpKernelContext::Params op_params;
+    op_params.step_id = kStepId;
+    op_params.device = device;
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    inputs.push_back(TensorValue(tensor));
+    op_params.inputs = &inputs;
+    gtl::InlinedVector<AllocatorAttributes, 4> input_aa(
+        {AllocatorAttributes()});
+    op_params.input_alloc_attrs = &input_aa;
+    DeviceContext* dev_ctx = new DeviceContext;
+    op_params.op_device_context = dev_ctx;
+    int forward_from = 0;
+    op_params.forward_from_array = &forward_from;
+    AllocatorAttributes generic_alloc_attr;
+    op_params.output_attr_array = &generic_alloc_attr;
+    NodeDef node_def;
+    TF_CHECK_OK(NodeDefBuilder(strings::StrCat("collective_reduce_", rank),
+                               "CollectiveReduce")
+                    .Attr("T", DT_FLOAT)
+                    .Attr("merge_op", "Add")
+                    .Attr("final_op", "Div")
+                    .Attr("group_size", col_params.group.group_size)
+                    .Attr("group_key", col_params.group.group_key)
+                    .Attr("instance_key", col_params.instance.instance_key)
+                    .Attr("subdiv_offsets", std::vector<int>())
+                    .Attr("communication_hint", "hierarchical")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Finalize(&node_def));
+    std::unique_ptr<OpKernel> op = GetKernel(node_def, device);
+    op_params.op_kernel = op.get();
+    OpKernelContext ctx(&op_params, 1);
+
+    // We never actually execute the kernel, so we need to do the output
+    // allocation it would do, ourselves.
+    Tensor* output_tensor_ptr = nullptr;
+    TF_CHECK_OK(ctx.forward_input_or_allocate_output({0}, 0, tensor->shape(),
+                                                     &output_tensor_ptr));
+
+    string exec_key = strings::StrCat(col_params.instance.instance_key, ":0:0");
+    HierarchicalRingReducer reducer;
+    CollectiveContext col_ctx(col_exec_, dev_mgr_.get(), &ctx, &op_params,
+                              col_params, exec_key, kStepId, tensor, tensor);
+    TF_CHECK_OK(reducer.InitializeCollectiveContext(&col_ctx));
+    Status status;
+    reducer.Run([&status](Status s) { status = s; });
+    if (status.ok()) {
+      CHECK(tensor->CopyFrom(*ctx.mutable_output(0), tensor->shape()));
+    }
+    dev_ctx->Unref();
+    return status;
+  }
+
+  TestCollectiveExecutorMgr col_exec_mgr_;
+  CollectiveExecutor* col_exec_ = nullptr;
+  CollectiveRemoteAccessLocal* rma_;
+  std::unique_ptr<DeviceResolverLocal> dev_resolver_;
+  std::shared_ptr<UnboundedWorkQueue> work_queue_;
+  std::unique_ptr<DeviceMgr> dev_mgr_;
+  string gpu_ring_order_;
+  CollectiveParams col_params_;
+};
+
+TEST_F(HierarchicalRingReducerTest, InitializeParams) {
+  CollectiveParams cp = SetUpCollectiveParams(3, 2);
+  cp.default_rank = 3;
+  HierarchicalRingReducer reducer;
+  TF_ASSERT_OK(reducer.InitializeCollectiveParams(&cp));
+  std::vector<std::vector<int>> expected_perms = {
+      {0, 1}, {2, 3}, {4, 5}, {0, 2, 4}, {1, 3, 5}};
+  EXPECT_EQ(expected_perms, cp.instance.impl_details.subdiv_permutations);
+  EXPECT_EQ(std::vector<int>({-1, 1, -1, -1, 1}), cp.subdiv_rank);
+}
+
+TEST_F(HierarchicalRingReducerTest, RejectsUnevenTasks) {
+  CollectiveParams cp = SetUpCollectiveParams(2, 2);
+  cp.default_rank = 0;
+  // Move device 1 to task 1, which then has 3 devices.
+  cp.instance.task_names[1] = cp.instance.task_names[2];
+  HierarchicalRingReducer reducer;
+  EXPECT_TRUE(
+      errors::IsInvalidArgument(reducer.InitializeCollectiveParams(&cp)));
+}
+
+TEST_F(HierarchicalRingReducerTest, SingleTask) { RunTest(1, 4, 1001, 0); }
+
+TEST_F(HierarchicalRingReducerTest, SingleDevicePerTask) {
+  RunTest(4, 1, 1001, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, TwoTasksTwoDevices) {
+  RunTest(2, 2, 4096, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, ThreeTasksFourDevices) {
+  RunTest(3, 4, 9408, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, ShorterThanGroup) {
+  // Most of the chunks are empty.
+  RunTest(2, 3, 2, 0);
+}
+
+TEST_F(HierarchicalRingReducerTest, Failure) { RunTest(2, 2, 4096, 3); }
+
+}  // namespace
+}  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -99,6 +101,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
+  const bool record_op_latency = metrics::IsOpLatencyRecordingEnabled();
   for (const Node* n : graph.nodes()) {
     if (IsSink(n)) continue;
     if (IsSwitch(n) || IsMerge(n) || IsEnter(n) || IsExit(n)) {
@@ -125,6 +128,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
     NodeItem* item = gview_.node(id);
     item->node_id = id;
+    max_num_outputs_ = std::max(max_num_outputs_, item->num_outputs);
 
     item->input_start = frame_info->total_inputs;
     frame_info->total_inputs += n->num_inputs();
@@ -145,6 +149,14 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
         break;
       }
     }
+    item->is_any_consumer_collective = false;
+    for (const Node* consumer : n->out_nodes()) {
+      if (consumer->IsCollective() ||
+          absl::StartsWith(consumer->type_string(), "Nccl")) {
+        item->is_any_consumer_collective = true;
+        break;
+      }
+    }
     const Tensor* const_tensor = item->kernel->const_tensor();
     if (const_tensor) {
       // Hold onto a shallow copy of the constant tensor in `*this` so that the
@@ -154,6 +166,10 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
     item->const_tensor = const_tensor;
     item->is_noop = (item->kernel->type_string_view() == "NoOp");
+    if (record_op_latency) {
+      item->latency_cell = metrics::GetOpLatencySamplerCell(
+          item->kernel->type_string(), params_.device->device_type());
+    }
     item->is_enter = IsEnter(n);
     if (item->is_enter) {
       bool is_constant_enter;
@@ -257,6 +273,10 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  if (!requires_control_flow_) {
+    // Must run after the `EdgeInfo::input_slot` rewrite above.
+    InitializeFrozenGraphLayout();
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -354,9 +374,7 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
   }
 
   if (!requires_control_flow_) {
-    atomic_pending_counts_.reset(new std::atomic<int32>[gview_.num_nodes()]);
-    std::fill(atomic_pending_counts_.get(),
-              atomic_pending_counts_.get() + gview_.num_nodes(), 0);
+    frozen_graph_layout_.initial_pending.assign(gview_.num_nodes(), 0);
   }
 
   for (const Node* n : graph->nodes()) {
@@ -368,8 +386,50 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     auto& counts = EnsureFrameInfo(name)->pending_counts;
     counts->set_initial_count(pending_ids_[id], max_pending);
     if (!requires_control_flow_) {
-      atomic_pending_counts_[id] = max_pending;
+      frozen_graph_layout_.initial_pending[id] = max_pending;
+    }
+  }
+}
+
+void ImmutableExecutorState::InitializeFrozenGraphLayout() {
+  DCHECK(!requires_control_flow_);
+  FrozenGraphLayout& layout = frozen_graph_layout_;
+  const int32 num_nodes = gview_.num_nodes();
+
+  size_t num_data_edges = 0;
+  size_t num_control_edges = 0;
+  for (int32 id = 0; id < num_nodes; ++id) {
+    const NodeItem* item = gview_.node(id);
+    if (item == nullptr) continue;
+    num_data_edges += item->num_output_edges;
+    num_control_edges += item->num_output_control_edges;
+  }
+
+  layout.data_edge_begin.resize(num_nodes + 1);
+  layout.data_dst_id.reserve(num_data_edges);
+  layout.data_src_slot.reserve(num_data_edges);
+  layout.data_input_loc.reserve(num_data_edges);
+  layout.data_is_last.reserve(num_data_edges);
+  layout.control_edge_begin.resize(num_nodes + 1);
+  layout.control_dst_id.reserve(num_control_edges);
+
+  for (int32 id = 0; id < num_nodes; ++id) {
+    layout.data_edge_begin[id] = layout.data_dst_id.size();
+    layout.control_edge_begin[id] = layout.control_dst_id.size();
+    const NodeItem* item = gview_.node(id);
+    // The sink node (and any removed node) has no `NodeItem`.
+    if (item == nullptr) continue;
+    for (const EdgeInfo& e : item->output_edges()) {
+      layout.data_dst_id.push_back(e.dst_id);
+      layout.data_src_slot.push_back(e.output_slot);
+      layout.data_input_loc.push_back(e.input_slot);
+      layout.data_is_last.push_back(e.is_last ? 1 : 0);
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      layout.control_dst_id.push_back(e.dst_id);
     }
   }
+  layout.data_edge_begin[num_nodes] = layout.data_dst_id.size();
+  layout.control_edge_begin[num_nodes] = layout.control_dst_id.size();
 }
 }  // namespace tensorflow
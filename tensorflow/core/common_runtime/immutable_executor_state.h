@@ -37,8 +37,6 @@ class Graph;
 
 // Represents the state of an executor (graph and control flow information)
 // that is immutable throughout execution.
-//
-// TODO(b/152651962): Add independent unit tests for this class.
 class ImmutableExecutorState {
  public:
   struct FrameInfo {
@@ -74,6 +72,38 @@ class ImmutableExecutorState {
     int32 parallel_iterations;
   };
 
+  // A contiguous, struct-of-arrays copy of the output edges of every node in
+  // a graph without "v1-style" control flow. `SimplePropagatorState` walks
+  // these arrays in `PropagateOutputs()` instead of chasing pointers into the
+  // variable-length `NodeItem` records, which keeps edge propagation on a few
+  // dense cache lines even for very large graphs.
+  //
+  // The data output edges of node `i` occupy indices
+  // `[data_edge_begin[i], data_edge_begin[i + 1])` of the `data_*` arrays, and
+  // its control output edges occupy indices
+  // `[control_edge_begin[i], control_edge_begin[i + 1])` of
+  // `control_dst_id`.
+  struct FrozenGraphLayout {
+    std::vector<int32> data_edge_begin;
+    // The node ID of the destination of each data edge.
+    std::vector<int32> data_dst_id;
+    // The output slot of the source that produces values on each data edge.
+    std::vector<int32> data_src_slot;
+    // The absolute location of the destination input in the step's input
+    // tensor array (i.e. `NodeItem::input_start` plus the input index).
+    std::vector<int32> data_input_loc;
+    // 1 if this is the last data edge out of its output slot, in which case the
+    // value can be moved rather than copied.
+    std::vector<uint8> data_is_last;
+
+    std::vector<int32> control_edge_begin;
+    // The node ID of the destination of each control edge.
+    std::vector<int32> control_dst_id;
+
+    // The initial pending count of each node, indexed by node ID.
+    std::vector<int32> initial_pending;
+  };
+
   explicit ImmutableExecutorState(const LocalExecutorParams& p)
       : params_(p), gview_() {}
   ~ImmutableExecutorState();
@@ -101,6 +131,18 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns the largest number of outputs of any node in the graph, so that
+  // executors can size their per-node output buffers once.
+  int32 max_num_outputs() const { return max_num_outputs_; }
+
+  // Returns the frozen edge layout of this graph.
+  //
+  // REQUIRES: `!requires_control_flow_support()`.
+  const FrozenGraphLayout& frozen_graph_layout() const {
+    DCHECK(!requires_control_flow_);
+    return frozen_graph_layout_;
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -111,7 +153,9 @@ class ImmutableExecutorState {
   // graph_view().num_nodes()`.
   void copy_pending_counts(std::atomic<int32>* dest) const {
     DCHECK(!requires_control_flow_);
-    memcpy(dest, atomic_pending_counts_.get(),
+    static_assert(sizeof(std::atomic<int32>) == sizeof(int32),
+                  "std::atomic<int32> must have the same layout as int32");
+    memcpy(dest, frozen_graph_layout_.initial_pending.data(),
            graph_view().num_nodes() * sizeof(std::atomic<int32>));
     std::atomic_thread_fence(std::memory_order_release);
   }
@@ -125,6 +169,7 @@ class ImmutableExecutorState {
   static Status BuildControlFlowInfo(const Graph* graph,
                                      ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeFrozenGraphLayout();
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -132,6 +177,7 @@ class ImmutableExecutorState {
   LocalExecutorParams params_;
   GraphView gview_;
   bool requires_control_flow_;
+  int32 max_num_outputs_ = 0;
   std::vector<PendingCounts::Handle> pending_ids_;
 
   // Root nodes (with no in edges) that should form the initial ready queue
@@ -148,9 +194,9 @@ class ImmutableExecutorState {
   // dense node IDs to the corresponding FrameInfo.
   std::vector<FrameInfo*> enter_frame_info_;
 
-  // If `requires_control_flow_` is false, this points to an array of initial
-  // pending counts for the nodes in the graph, indexed by node ID.
-  std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
+  // If `requires_control_flow_` is false, this holds the edges and initial
+  // pending counts of the graph in a contiguous layout.
+  FrozenGraphLayout frozen_graph_layout_;
 
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
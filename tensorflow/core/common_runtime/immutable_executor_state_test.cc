@@ -0,0 +1,140 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+class ImmutableExecutorStateTest : public ::testing::Test {
+ protected:
+  ImmutableExecutorStateTest()
+      : device_(DeviceFactory::NewDevice("CPU", {},
+                                         "/job:localhost/replica:0/task:0")) {}
+
+  std::unique_ptr<ImmutableExecutorState> Create(const Graph& graph) {
+    const int version = graph.versions().producer();
+    LocalExecutorParams params;
+    params.device = device_.get();
+    params.create_kernel =
+        [this, version](const std::shared_ptr<const NodeProperties>& props,
+                        OpKernel** kernel) {
+          return CreateNonCachedKernel(device_.get(), nullptr, props, version,
+                                       kernel);
+        };
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+    auto state = absl::make_unique<ImmutableExecutorState>(params);
+    TF_CHECK_OK(state->Initialize(graph));
+    return state;
+  }
+
+  std::unique_ptr<Device> device_;
+};
+
+Tensor Scalar(float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+TEST_F(ImmutableExecutorStateTest, FrozenGraphLayoutMatchesNodeItems) {
+  // a -> b, a -> c, {b, c} -> d, with a control edge from b to c.
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Identity(&g, a);
+  Node* c = test::graph::Identity(&g, a);
+  Node* d = test::graph::Add(&g, b, c);
+  g.AddControlEdge(b, c);
+  FixupSourceAndSinkEdges(&g);
+
+  auto state = Create(g);
+  ASSERT_FALSE(state->requires_control_flow_support());
+  const ImmutableExecutorState::FrozenGraphLayout& layout =
+      state->frozen_graph_layout();
+  const GraphView& gview = state->graph_view();
+  ASSERT_EQ(layout.data_edge_begin.size(), gview.num_nodes() + 1);
+  ASSERT_EQ(layout.control_edge_begin.size(), gview.num_nodes() + 1);
+  ASSERT_EQ(layout.initial_pending.size(), gview.num_nodes());
+
+  for (int32 id = 0; id < gview.num_nodes(); ++id) {
+    const NodeItem* item = gview.node(id);
+    if (item == nullptr) continue;
+
+    const int32 data_begin = layout.data_edge_begin[id];
+    ASSERT_EQ(layout.data_edge_begin[id + 1] - data_begin,
+              item->num_output_edges);
+    int32 e = data_begin;
+    for (const EdgeInfo& edge : item->output_edges()) {
+      EXPECT_EQ(layout.data_dst_id[e], edge.dst_id);
+      EXPECT_EQ(layout.data_src_slot[e], edge.output_slot);
+      EXPECT_EQ(layout.data_input_loc[e], edge.input_slot);
+      EXPECT_EQ(layout.data_is_last[e] != 0, edge.is_last);
+      ++e;
+    }
+
+    const int32 control_begin = layout.control_edge_begin[id];
+    ASSERT_EQ(layout.control_edge_begin[id + 1] - control_begin,
+              item->num_output_control_edges);
+    e = control_begin;
+    for (const ControlEdgeInfo& edge : item->output_control_edges()) {
+      EXPECT_EQ(layout.control_dst_id[e], edge.dst_id);
+      ++e;
+    }
+  }
+
+  EXPECT_EQ(layout.initial_pending[a->id()], 1);  // Control edge from _SOURCE.
+  EXPECT_EQ(layout.initial_pending[b->id()], 1);
+  EXPECT_EQ(layout.initial_pending[c->id()], 2);
+  EXPECT_EQ(layout.initial_pending[d->id()], 2);
+
+  // The input locations of `d` are rewritten relative to the whole graph.
+  const NodeItem& d_item = gview.node_ref(d->id());
+  const int32 b_begin = layout.data_edge_begin[b->id()];
+  EXPECT_EQ(layout.data_dst_id[b_begin], d->id());
+  EXPECT_EQ(layout.data_input_loc[b_begin], d_item.input_start);
+}
+
+TEST_F(ImmutableExecutorStateTest, CopyPendingCounts) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Add(&g, a, a);
+  FixupSourceAndSinkEdges(&g);
+
+  auto state = Create(g);
+  const int32 num_nodes = state->graph_view().num_nodes();
+  std::unique_ptr<std::atomic<int32>[]> pending(
+      new std::atomic<int32>[num_nodes]);
+  state->copy_pending_counts(pending.get());
+  EXPECT_EQ(pending[a->id()], 1);
+  EXPECT_EQ(pending[b->id()], 2);
+}
+
+}  // namespace
+}  // namespace tensorflow
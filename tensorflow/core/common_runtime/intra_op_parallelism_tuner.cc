@@ -0,0 +1,205 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/intra_op_parallelism_tuner.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+constexpr int IntraOpParallelismTuner::kTrialsPerCandidate;
+
+IntraOpParallelismTuner::IntraOpParallelismTuner(int max_parallelism)
+    : max_parallelism_(std::max(1, max_parallelism)) {
+  for (int parallelism = 1; parallelism < max_parallelism_; parallelism *= 2) {
+    candidates_.push_back(parallelism);
+  }
+  candidates_.push_back(max_parallelism_);
+}
+
+uint64 IntraOpParallelismTuner::Key(const string& op_type, int shape_class) {
+  return Hash64Combine(Hash64(op_type), shape_class);
+}
+
+int IntraOpParallelismTuner::ShapeClass(OpKernelContext* context) {
+  uint64 num_elements = 0;
+  for (int i = 0; i < context->num_inputs(); ++i) {
+    if (!context->input_is_ref(i)) {
+      num_elements += context->input(i).NumElements();
+    }
+  }
+  return num_elements == 0 ? 0 : Log2Floor64(num_elements) + 1;
+}
+
+void IntraOpParallelismTuner::Compute(OpKernel* op_kernel,
+                                      OpKernelContext* context) {
+  const int shape_class = ShapeClass(context);
+  bool measure = false;
+  const int parallelism =
+      ChooseParallelism(op_kernel->type_string(), shape_class, &measure);
+  ScopedPerThreadMaxParallelism scoped_parallelism(parallelism);
+  if (!measure) {
+    op_kernel->Compute(context);
+    return;
+  }
+  const uint64 start_nanos = Env::Default()->NowNanos();
+  op_kernel->Compute(context);
+  const uint64 elapsed_nanos = Env::Default()->NowNanos() - start_nanos;
+  if (context->status().ok()) {
+    RecordMeasurement(op_kernel->type_string(), shape_class, parallelism,
+                      elapsed_nanos);
+  }
+}
+
+int IntraOpParallelismTuner::ChooseParallelism(const string& op_type,
+                                               int shape_class,
+                                               bool* measure) {
+  *measure = false;
+  const uint64 key = Key(op_type, shape_class);
+  {
+    tf_shared_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end() && it->second.parallelism > 0) {
+      return it->second.parallelism;
+    }
+  }
+  mutex_lock l(mu_);
+  Entry& entry = entries_[key];
+  if (entry.candidates.empty() && entry.parallelism == 0) {
+    entry.op_type = op_type;
+    entry.shape_class = shape_class;
+    for (int parallelism : candidates_) {
+      entry.candidates.emplace_back();
+      entry.candidates.back().parallelism = parallelism;
+    }
+  }
+  if (entry.parallelism > 0 || entry.op_type != op_type) {
+    // Tuned concurrently, or a hash collision with another class.
+    return entry.parallelism > 0 ? entry.parallelism : max_parallelism_;
+  }
+  // Try out the candidate with the fewest measurements.
+  const Candidate* next = &entry.candidates.front();
+  for (const Candidate& candidate : entry.candidates) {
+    if (candidate.trials < next->trials) next = &candidate;
+  }
+  *measure = true;
+  return next->parallelism;
+}
+
+void IntraOpParallelismTuner::RecordMeasurement(const string& op_type,
+                                                int shape_class,
+                                                int parallelism,
+                                                uint64 elapsed_nanos) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(Key(op_type, shape_class));
+  if (it == entries_.end() || it->second.parallelism > 0 ||
+      it->second.op_type != op_type) {
+    return;
+  }
+  Entry& entry = it->second;
+  bool done = true;
+  const Candidate* best = nullptr;
+  for (Candidate& candidate : entry.candidates) {
+    if (candidate.parallelism == parallelism) {
+      // The minimum is the least noisy estimate of how fast the kernel can run.
+      if (candidate.trials == 0 || elapsed_nanos < candidate.min_nanos) {
+        candidate.min_nanos = elapsed_nanos;
+      }
+      ++candidate.trials;
+    }
+    if (candidate.trials < kTrialsPerCandidate) {
+      done = false;
+    } else if (best == nullptr || candidate.min_nanos < best->min_nanos) {
+      best = &candidate;
+    }
+  }
+  if (!done) return;
+  entry.parallelism = best->parallelism;
+  VLOG(1) << "Tuned intra-op parallelism of " << op_type << " with shape class "
+          << shape_class << " to " << entry.parallelism << " ("
+          << best->min_nanos << "ns)";
+  entry.candidates.clear();
+}
+
+string IntraOpParallelismTuner::Export() const {
+  std::vector<std::tuple<string, int, int>> tuned;
+  {
+    tf_shared_lock l(mu_);
+    for (const auto& it : entries_) {
+      const Entry& entry = it.second;
+      if (entry.parallelism > 0) {
+        tuned.emplace_back(entry.op_type, entry.shape_class,
+                           entry.parallelism);
+      }
+    }
+  }
+  std::sort(tuned.begin(), tuned.end());
+  string text;
+  for (const auto& entry : tuned) {
+    strings::StrAppend(&text, std::get<0>(entry), " ", std::get<1>(entry), " ",
+                       std::get<2>(entry), "\n");
+  }
+  return text;
+}
+
+Status IntraOpParallelismTuner::Import(const string& text) {
+  std::vector<std::tuple<string, int, int>> tuned;
+  for (const string& line :
+       str_util::Split(text, '\n', str_util::SkipEmpty())) {
+    const std::vector<string> fields =
+        str_util::Split(line, ' ', str_util::SkipEmpty());
+    int32 shape_class;
+    int32 parallelism;
+    if (fields.size() != 3 || !strings::safe_strto32(fields[1], &shape_class) ||
+        !strings::safe_strto32(fields[2], &parallelism) || parallelism <= 0) {
+      return errors::InvalidArgument(
+          "Malformed intra-op parallelism setting: '", line, "'");
+    }
+    tuned.emplace_back(fields[0], shape_class,
+                       std::min(parallelism, max_parallelism_));
+  }
+  mutex_lock l(mu_);
+  for (const auto& setting : tuned) {
+    Entry& entry = entries_[Key(std::get<0>(setting), std::get<1>(setting))];
+    entry.op_type = std::get<0>(setting);
+    entry.shape_class = std::get<1>(setting);
+    entry.parallelism = std::get<2>(setting);
+    entry.candidates.clear();
+  }
+  return Status::OK();
+}
+
+int IntraOpParallelismTuner::num_tuned() const {
+  tf_shared_lock l(mu_);
+  int num_tuned = 0;
+  for (const auto& it : entries_) {
+    if (it.second.parallelism > 0) ++num_tuned;
+  }
+  return num_tuned;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_INTRA_OP_PARALLELISM_TUNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_INTRA_OP_PARALLELISM_TUNER_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class OpKernel;
+class OpKernelContext;
+
+// Learns, online, the intra-op parallelism that each class of kernels runs
+// fastest with on a CPU device. A class is an op type together with a shape
+// class, the log2 of the number of elements in the kernel's inputs, so small
+// and large invocations of the same op are tuned separately.
+//
+// The tuned parallelism is applied through SetPerThreadMaxParallelism(), so it
+// caps both the number of shards of Shard() (and with it their block size) and
+// the Eigen device that the kernel gets. The first invocations of every class
+// try out each candidate parallelism (the powers of two up to the number of
+// intra-op threads, and that number itself) a few times, after which the
+// fastest one is used without measuring anymore.
+//
+// The learned settings can be exported and imported as text, so that, e.g.,
+// serving replicas can start tuned.
+//
+// This class is thread safe.
+class IntraOpParallelismTuner {
+ public:
+  // Number of times each candidate is measured before a class is tuned.
+  static constexpr int kTrialsPerCandidate = 3;
+
+  // `max_parallelism` is the number of intra-op threads of the device.
+  explicit IntraOpParallelismTuner(int max_parallelism);
+
+  // Runs `op_kernel` on `context` with the parallelism tuned for it, and
+  // measures it if that parallelism is still being tuned.
+  void Compute(OpKernel* op_kernel, OpKernelContext* context);
+
+  // Returns the parallelism to run the next invocation of the given class
+  // with. Sets `*measure` to true if the invocation must then be reported
+  // through RecordMeasurement().
+  int ChooseParallelism(const string& op_type, int shape_class,
+                        bool* measure);
+
+  // Records that an invocation of the given class ran for `elapsed_nanos`
+  // with `parallelism`.
+  void RecordMeasurement(const string& op_type, int shape_class,
+                         int parallelism, uint64 elapsed_nanos);
+
+  // Returns the shape class of the inputs of `context`.
+  static int ShapeClass(OpKernelContext* context);
+
+  // Returns the tuned classes as a text with one line per class, holding the
+  // op type, the shape class and the tuned parallelism.
+  string Export() const;
+
+  // Adds the classes of `text`, in the format returned by Export(), to the
+  // tuned classes. Parallelisms larger than the one of this tuner are capped.
+  Status Import(const string& text);
+
+  // Returns the number of tuned classes.
+  int num_tuned() const;
+
+ private:
+  struct Candidate {
+    int parallelism;
+    int trials = 0;
+    uint64 min_nanos = 0;
+  };
+  struct Entry {
+    string op_type;
+    int shape_class;
+    // The tuned parallelism, or 0 while the class is being tuned.
+    int parallelism = 0;
+    std::vector<Candidate> candidates;
+  };
+
+  static uint64 Key(const string& op_type, int shape_class);
+
+  const int max_parallelism_;
+  // The parallelisms that are tried out, in increasing order.
+  std::vector<int> candidates_;
+
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IntraOpParallelismTuner);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_INTRA_OP_PARALLELISM_TUNER_H_
@@ -0,0 +1,114 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/intra_op_parallelism_tuner.h"
+
+#include <set>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs invocations of the given class until it is tuned, pretending that the
+// kernel takes `nanos(parallelism)`. Returns the parallelisms that were tried.
+template <typename Nanos>
+std::set<int> Tune(IntraOpParallelismTuner* tuner, const string& op_type,
+                   int shape_class, Nanos nanos) {
+  std::set<int> tried;
+  for (int i = 0; i < 100; ++i) {
+    bool measure = false;
+    const int parallelism =
+        tuner->ChooseParallelism(op_type, shape_class, &measure);
+    if (!measure) break;
+    tried.insert(parallelism);
+    tuner->RecordMeasurement(op_type, shape_class, parallelism,
+                             nanos(parallelism));
+  }
+  return tried;
+}
+
+int Tuned(IntraOpParallelismTuner* tuner, const string& op_type,
+          int shape_class) {
+  bool measure = true;
+  const int parallelism =
+      tuner->ChooseParallelism(op_type, shape_class, &measure);
+  EXPECT_FALSE(measure);
+  return parallelism;
+}
+
+TEST(IntraOpParallelismTunerTest, PicksFastestCandidate) {
+  IntraOpParallelismTuner tuner(6);
+  const std::set<int> tried = Tune(&tuner, "MatMul", 10, [](int parallelism) {
+    return parallelism == 2 ? 100 : 1000;
+  });
+  EXPECT_EQ(tried, std::set<int>({1, 2, 4, 6}));
+  EXPECT_EQ(Tuned(&tuner, "MatMul", 10), 2);
+  EXPECT_EQ(tuner.num_tuned(), 1);
+}
+
+TEST(IntraOpParallelismTunerTest, UsesFastestMeasurement) {
+  IntraOpParallelismTuner tuner(2);
+  // The first measurement of a single thread is an outlier.
+  int num_measurements = 0;
+  Tune(&tuner, "Add", 3, [&num_measurements](int parallelism) {
+    return parallelism == 1 ? (num_measurements++ == 0 ? 10000 : 100) : 200;
+  });
+  EXPECT_EQ(Tuned(&tuner, "Add", 3), 1);
+}
+
+TEST(IntraOpParallelismTunerTest, TunesShapeClassesSeparately) {
+  IntraOpParallelismTuner tuner(4);
+  Tune(&tuner, "Relu", 4, [](int parallelism) { return 100 * parallelism; });
+  Tune(&tuner, "Relu", 20,
+       [](int parallelism) { return 1000 / parallelism; });
+  EXPECT_EQ(Tuned(&tuner, "Relu", 4), 1);
+  EXPECT_EQ(Tuned(&tuner, "Relu", 20), 4);
+
+  bool measure = false;
+  tuner.ChooseParallelism("Relu", 21, &measure);
+  EXPECT_TRUE(measure);
+  EXPECT_EQ(tuner.num_tuned(), 2);
+}
+
+TEST(IntraOpParallelismTunerTest, ExportAndImport) {
+  IntraOpParallelismTuner tuner(8);
+  Tune(&tuner, "Conv2D", 16,
+       [](int parallelism) { return 1000 / parallelism; });
+  Tune(&tuner, "Add", 2, [](int parallelism) { return parallelism; });
+  const string text = tuner.Export();
+  EXPECT_EQ(text, "Add 2 1\nConv2D 16 8\n");
+
+  // Settings are capped to the parallelism of the importing tuner.
+  IntraOpParallelismTuner other(4);
+  TF_ASSERT_OK(other.Import(text));
+  EXPECT_EQ(other.num_tuned(), 2);
+  EXPECT_EQ(Tuned(&other, "Add", 2), 1);
+  EXPECT_EQ(Tuned(&other, "Conv2D", 16), 4);
+  EXPECT_EQ(other.Export(), "Add 2 1\nConv2D 16 4\n");
+}
+
+TEST(IntraOpParallelismTunerTest, ImportRejectsMalformedSettings) {
+  IntraOpParallelismTuner tuner(4);
+  EXPECT_TRUE(errors::IsInvalidArgument(tuner.Import("Add 2\n")));
+  EXPECT_TRUE(errors::IsInvalidArgument(tuner.Import("Add two 1\n")));
+  EXPECT_TRUE(errors::IsInvalidArgument(tuner.Import("Add 2 0\n")));
+  EXPECT_EQ(tuner.num_tuned(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
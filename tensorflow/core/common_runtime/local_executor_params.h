@@ -47,6 +47,10 @@ struct LocalExecutorParams {
                        OpKernel**)>
       create_kernel;
   std::function<void(OpKernel*)> delete_kernel;
+
+  // If true, and the graph has no control flow, node outputs are served from
+  // a per-step arena laid out by a StaticMemoryPlan.
+  bool use_static_memory_plan = false;
 };
 
 }  // end namespace tensorflow
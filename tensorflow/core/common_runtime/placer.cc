@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/placer.h"
 
+#include <deque>
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "tensorflow/core/common_runtime/colocation_graph.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/attr_value_util.h"
@@ -28,6 +31,10 @@ limitations under the License.
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/port.h"
 
@@ -129,6 +136,56 @@ Status AssignAndLog(int assigned_device, Node* node,
   return Status::OK();
 }
 
+// Graphs with at least this many op nodes have their placement cached.
+// Fingerprinting a graph is much cheaper than placing it, but not free.
+constexpr int kMinNodesForPlacementCache = 1024;
+constexpr int kPlacementCacheCapacity = 8;
+
+// Caches the devices assigned by Placer::Run() to the op nodes of a graph, as
+// indices into the DeviceSet and in Graph::op_nodes() order, keyed by a
+// fingerprint of everything the placement depends on. This lets re-creating
+// a session for the same model skip placing its graph again.
+class PlacementCache {
+ public:
+  typedef std::vector<int32> Placement;
+
+  static PlacementCache* Global() {
+    static PlacementCache* cache = new PlacementCache;
+    return cache;
+  }
+
+  std::shared_ptr<const Placement> Lookup(const Fprint128& key) {
+    mutex_lock l(mu_);
+    auto it = placements_.find(key);
+    return it == placements_.end() ? nullptr : it->second;
+  }
+
+  void Insert(const Fprint128& key, std::shared_ptr<const Placement> value) {
+    mutex_lock l(mu_);
+    if (!placements_.emplace(key, std::move(value)).second) return;
+    insertion_order_.push_back(key);
+    if (insertion_order_.size() > kPlacementCacheCapacity) {
+      placements_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<Fprint128, std::shared_ptr<const Placement>,
+                      Fprint128Hasher>
+      placements_ TF_GUARDED_BY(mu_);
+  std::deque<Fprint128> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+void FingerprintAppend(StringPiece s, Fprint128* fingerprint) {
+  const Fprint128 s_fingerprint = Fingerprint128(s);
+  fingerprint->low64 =
+      FingerprintCat64(fingerprint->low64, s_fingerprint.low64);
+  fingerprint->high64 =
+      FingerprintCat64(fingerprint->high64, s_fingerprint.high64);
+}
+
 }  // namespace
 
 Placer::Placer(Graph* graph, const string& function_name,
@@ -171,6 +228,18 @@ Status Placer::Run() {
     }
   }
 
+  Fprint128 fingerprint = {0, 0};
+  const bool use_cache = graph_->num_op_nodes() >= kMinNodesForPlacementCache;
+  if (use_cache) {
+    fingerprint = PlacementFingerprint();
+    if (ApplyCachedPlacement(fingerprint)) {
+      if (VLOG_IS_ON(3)) {
+        DumpGraphToFile("placer_output", *graph_, nullptr);
+      }
+      return Status::OK();
+    }
+  }
+
   FunctionStack stack(function_name_);
   ColocationGraph colocation_graph(graph_, stack, flib_def_, devices_,
                                    default_local_device_, allow_soft_placement_,
@@ -291,9 +360,79 @@ Status Placer::Run() {
     DumpGraphToFile("placer_output", *graph_, nullptr);
     DumpColocationGraph("colocation_graph", colocation_graph);
   }
+  if (use_cache) {
+    CachePlacement(fingerprint);
+  }
   return Status::OK();
 }
 
+Fprint128 Placer::PlacementFingerprint() const {
+  Fprint128 fingerprint = {0, 0};
+  string buf = strings::StrCat(
+      function_name_, "|", allow_soft_placement_ ? "soft" : "hard", "|",
+      default_local_device_ ? default_local_device_->name() : "", "|",
+      devices_->client_device() ? devices_->client_device()->name() : "");
+  for (const Device* device : devices_->devices()) {
+    strings::StrAppend(&buf, "|", device->name(), ":", device->device_type());
+  }
+  FingerprintAppend(buf, &fingerprint);
+
+  for (const Node* node : graph_->op_nodes()) {
+    buf.clear();
+    SerializeToStringDeterministic(node->def(), &buf);
+    strings::StrAppend(&buf, "|", node->id(), "|",
+                       node->assigned_device_name());
+    for (const Edge* edge : node->in_edges()) {
+      strings::StrAppend(&buf, "|", edge->src()->id(), ":", edge->src_output(),
+                         ":", edge->dst_input());
+    }
+    FingerprintAppend(buf, &fingerprint);
+  }
+
+  // Placement looks into the functions called by the graph.
+  buf.clear();
+  SerializeToStringDeterministic(flib_def_->ToProto(), &buf);
+  FingerprintAppend(buf, &fingerprint);
+  return fingerprint;
+}
+
+bool Placer::ApplyCachedPlacement(const Fprint128& fingerprint) {
+  std::shared_ptr<const PlacementCache::Placement> placement =
+      PlacementCache::Global()->Lookup(fingerprint);
+  if (placement == nullptr ||
+      placement->size() != static_cast<size_t>(graph_->num_op_nodes())) {
+    return false;
+  }
+  const std::vector<Device*>& devices = devices_->devices();
+  int i = 0;
+  for (Node* node : graph_->op_nodes()) {
+    node->set_assigned_device_name_index(
+        graph_->InternDeviceName(devices[(*placement)[i++]]->name()));
+    LogDeviceAssignment(node, log_device_placement_);
+  }
+  VLOG(1) << "Reused the cached placement of " << graph_->num_op_nodes()
+          << " nodes";
+  return true;
+}
+
+void Placer::CachePlacement(const Fprint128& fingerprint) {
+  absl::flat_hash_map<string, int32> device_indices;
+  const std::vector<Device*>& devices = devices_->devices();
+  for (int32 i = 0; i < devices.size(); ++i) {
+    device_indices.emplace(devices[i]->name(), i);
+  }
+  auto placement = std::make_shared<PlacementCache::Placement>();
+  placement->reserve(graph_->num_op_nodes());
+  for (const Node* node : graph_->op_nodes()) {
+    auto it = device_indices.find(node->assigned_device_name());
+    if (it == device_indices.end()) {
+      return;
+    }
+    placement->push_back(it->second);
+  }
+  PlacementCache::Global()->Insert(fingerprint, std::move(placement));
+}
+
 bool Placer::CanAssignToDevice(const string& candidate_device_name,
                                const std::vector<Device*>& devices) const {
   if (!candidate_device_name.empty()) {
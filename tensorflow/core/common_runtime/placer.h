@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
@@ -83,6 +84,10 @@ class Placer {
   // Assigns each node in this Placer's graph to a device in its
   // set of devices.
   //
+  // The placement of large graphs is cached process-wide, keyed by a
+  // fingerprint of the graph, its function library, the devices and the
+  // placement options, so placing the same graph again reuses it.
+  //
   // This method is not thread-safe.
   // Run() may be invoked at most once.
   Status Run();
@@ -93,6 +98,16 @@ class Placer {
   bool CanAssignToDevice(const string& candidate_device_name,
                          const std::vector<Device*>& devices) const;
 
+  // Returns a fingerprint of everything the placement of graph_ depends on.
+  Fprint128 PlacementFingerprint() const;
+
+  // Assigns the op nodes of graph_ the devices cached for 'fingerprint'.
+  // Returns false, and leaves graph_ unchanged, if there are none.
+  bool ApplyCachedPlacement(const Fprint128& fingerprint);
+
+  // Caches the devices assigned to the op nodes of graph_ for 'fingerprint'.
+  void CachePlacement(const Fprint128& fingerprint);
+
   Graph* const graph_;  // Not owned.
   const string function_name_;
   const FunctionLibraryDefinition* const flib_def_;  // Not owned.
@@ -441,6 +441,42 @@ TEST_F(PlacerTest, TestNoConstraintsWithPrioritizedKernels) {
 
 // Test that if the node supports XLA_CPU and FakeCPU, it will be placed on
 // XLA_CPU if and only if the node is assigned to the XLA_CPU device.
+// Test that placing a large graph again reuses the cached placement, and that
+// a changed device request is not served from the cache.
+TEST_F(PlacerTest, TestLargeGraphPlacementIsCached) {
+  auto build_graph = [this](const string& n0_device, Graph* g) {
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    for (int i = 0; i < 5000; ++i) {
+      ops::UnaryOp("TestRelu", ops::NodeOut(input, i % 2),
+                   b.opts()
+                       .WithName(strings::StrCat("n", i))
+                       .WithDevice(i == 0 ? n0_device : ""));
+    }
+    return BuildGraph(b, g);
+  };
+
+  Graph g1(OpRegistry::Global());
+  TF_ASSERT_OK(build_graph("", &g1));
+  TF_ASSERT_OK(Place(&g1));
+  EXPECT_DEVICE_TYPE(g1, "in", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g1, "n0", "FakeGPU");
+
+  Graph g2(OpRegistry::Global());
+  TF_ASSERT_OK(build_graph("", &g2));
+  TF_ASSERT_OK(Place(&g2));
+  for (Node* node : g2.op_nodes()) {
+    EXPECT_EQ(GetNodeByName(g1, node->name())->assigned_device_name(),
+              node->assigned_device_name());
+  }
+
+  Graph g3(OpRegistry::Global());
+  TF_ASSERT_OK(build_graph("/device:FakeCPU:0", &g3));
+  TF_ASSERT_OK(Place(&g3));
+  EXPECT_DEVICE_TYPE(g3, "n0", "FakeCPU");
+  EXPECT_DEVICE_TYPE(g3, "n1", "FakeGPU");
+}
+
 TEST_F(PlacerTest, TestXlaOpPlacement) {
   Graph g(OpRegistry::Global());
   {  // Scope for temporary variables used to construct g.
@@ -24,12 +24,15 @@ limitations under the License.
 #include <map>
 #include <utility>
 
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
 
@@ -94,6 +97,7 @@ ChunkPrefix* FindPrefix(void* user_ptr) {
 
 void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   if (num_bytes == 0) return nullptr;
+  const size_t requested_bytes = num_bytes;
 
   // If alignment is larger than kPoolAlignment, increase num_bytes so that we
   // are guaranteed to be able to return an aligned ptr by advancing user_ptr
@@ -122,20 +126,32 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
       }
     }
   }
+  void* user_ptr;
   if (pr != nullptr) {
     void* r = pr->ptr;
     delete pr;
-    return PrepareChunk(r, alignment, num_bytes);
+    user_ptr = PrepareChunk(r, alignment, num_bytes);
   } else {
     void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes);
-    return PrepareChunk(ptr, alignment, num_bytes);
+    user_ptr = PrepareChunk(ptr, alignment, num_bytes);
   }
+  const int64 bytes_in_use = bytes_in_use_.fetch_add(num_bytes) + num_bytes;
+  int64 peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  while (bytes_in_use > peak &&
+         !peak_bytes_in_use_.compare_exchange_weak(peak, bytes_in_use)) {
+  }
+  AddTraceMe("MemoryAllocation", user_ptr, requested_bytes, num_bytes,
+             bytes_in_use);
+  return user_ptr;
 }
 
 void PoolAllocator::DeallocateRaw(void* ptr) {
   if (ptr == nullptr) return;
   ChunkPrefix* cp = FindPrefix(ptr);
   CHECK_LE((void*)cp, (void*)ptr);
+  const int64 num_bytes = cp->num_bytes;
+  AddTraceMe("MemoryDeallocation", ptr, num_bytes, num_bytes,
+             bytes_in_use_.fetch_sub(num_bytes) - num_bytes);
   if (!has_size_limit_ && !auto_resize_) {
     allocator_->Free(cp, cp->num_bytes);
   } else {
@@ -152,6 +168,36 @@ void PoolAllocator::DeallocateRaw(void* ptr) {
   }
 }
 
+void PoolAllocator::AddTraceMe(absl::string_view traceme_name,
+                               const void* ptr, int64 req_bytes,
+                               int64 alloc_bytes, int64 bytes_in_use) {
+  tensorflow::profiler::TraceMe::InstantActivity(
+      [this, traceme_name, ptr, req_bytes, alloc_bytes, bytes_in_use]() {
+        const auto& annotation =
+            ScopedMemoryDebugAnnotation::CurrentAnnotation();
+        std::string tensor_shape;
+        if (annotation.pending_shape) {
+          tensor_shape = annotation.pending_shape->DebugString();
+        }
+        // The pool has no memory limit and doesn't fragment, so only the
+        // bytes in use are reported.
+        return tensorflow::profiler::TraceMeEncode(
+            traceme_name,
+            {{"allocator_name", name_},
+             {"bytes_allocated", bytes_in_use},
+             {"peak_bytes_in_use", peak_bytes_in_use_.load()},
+             {"requested_bytes", req_bytes},
+             {"allocation_bytes", alloc_bytes},
+             {"addr", reinterpret_cast<uint64>(ptr)},
+             {"tf_op", annotation.pending_op_name},
+             {"id", annotation.pending_step_id},
+             {"region_type", annotation.pending_region_type},
+             {"data_type", annotation.pending_data_type},
+             {"shape", tensor_shape}});
+      },
+      /*level=*/profiler::TraceMeLevel::kInfo);
+}
+
 void PoolAllocator::Clear() {
   if (has_size_limit_) {
     mutex_lock lock(mutex_);
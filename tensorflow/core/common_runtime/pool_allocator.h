@@ -22,6 +22,8 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <vector>
+
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/platform/logging.h"
@@ -116,6 +118,12 @@ class PoolAllocator : public Allocator {
   // Delete the least recently used record.
   void EvictOne() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Add TraceMe (in memory allocation and deallocation) for memory stats
+  // profiling, in the same format as BFCAllocator's. bytes_in_use counts the
+  // chunks handed out to callers, after the activity.
+  void AddTraceMe(absl::string_view traceme_name, const void* ptr,
+                  int64 req_bytes, int64 alloc_bytes, int64 bytes_in_use);
+
   const string name_;
   const bool has_size_limit_;
   const bool auto_resize_;
@@ -130,6 +138,9 @@ class PoolAllocator : public Allocator {
   int64 put_count_ TF_GUARDED_BY(mutex_) = 0;
   int64 allocated_count_ TF_GUARDED_BY(mutex_) = 0;
   int64 evicted_count_ TF_GUARDED_BY(mutex_) = 0;
+  // Bytes of the chunks handed out to callers, and their peak.
+  std::atomic<int64> bytes_in_use_{0};
+  std::atomic<int64> peak_bytes_in_use_{0};
 };
 
 // Do-nothing rounder. Passes through sizes unchanged.
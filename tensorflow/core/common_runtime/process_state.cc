@@ -92,9 +92,21 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
       }
       int64 cpu_mem_limit = cpu_mem_limit_in_mb * (1LL << 20);
       DCHECK(sub_allocator);
-      allocator =
+      BFCAllocator* bfc_allocator =
           new BFCAllocator(sub_allocator, cpu_mem_limit, true /*allow_growth*/,
                            "bfc_cpu_allocator_for_gpu" /*name*/);
+      int64 small_alloc_cache_in_mb = 0;
+      status = ReadInt64FromEnvVar("TF_CPU_BFC_SMALL_ALLOC_CACHE_IN_MB",
+                                   0 /*disabled by default*/,
+                                   &small_alloc_cache_in_mb);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
+      }
+      if (small_alloc_cache_in_mb > 0) {
+        bfc_allocator->EnableSmallAllocationCache(small_alloc_cache_in_mb *
+                                                  (1LL << 20));
+      }
+      allocator = bfc_allocator;
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else if (sub_allocator) {
@@ -229,19 +229,17 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
   const ImmutableExecutorState::FrameInfo& frame_info =
       immutable_state_.get_enter_frame_info(node_item);
 
+  // Fast path: the frame was started by an earlier Enter in this iteration.
+  {
+    mutex_lock frame_lock(frame->mu);
+    *child = iter_state->FindChildFrame(&frame_info);
+    if (*child != nullptr) return;
+  }
+
   const uint64 child_id = Hash64Combine(
       frame->frame_id,
       Hash64Combine(iter_state->iter_num, Hash64(frame_info.name)));
 
-  {
-    tf_shared_lock executor_lock(mu_);
-    auto it = outstanding_frames_.find(child_id);
-    if (it != outstanding_frames_.end()) {
-      *child = it->second;
-      return;
-    }
-  }
-
   // Need to create a new frame instance.
   // Note that this new frame instance is created without any locks.
   if (vlog_) {
@@ -266,12 +264,11 @@ void PropagatorState::FindOrCreateChildFrame(FrameState* frame,
 
   {
     mutex_lock executor_lock(mu_);
-    auto it = outstanding_frames_.find(child_id);
-    if (it != outstanding_frames_.end()) {
-      *child = it->second;
-    } else {
-      mutex_lock frame_lock(frame->mu);
+    mutex_lock frame_lock(frame->mu);
+    *child = iter_state->FindChildFrame(&frame_info);
+    if (*child == nullptr) {
       iter_state->outstanding_frame_count++;
+      iter_state->child_frames.emplace_back(&frame_info, temp);
       outstanding_frames_[child_id] = temp;
       *child = temp;
       temp = nullptr;
@@ -286,6 +283,7 @@ void PropagatorState::DeleteFrame(FrameState* frame, TaggedNodeSeq* ready) {
   IterationState* parent_iter_state = frame->parent_iter;
   if (parent_frame != nullptr) {
     mutex_lock parent_frame_lock(parent_frame->mu);
+    parent_iter_state->RemoveChildFrame(frame);
     // Propagate all the dead exits to the parent frame.
     mutex_lock this_frame_lock(frame->mu);
 
@@ -616,8 +614,15 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter;
+  if (!spare_iterations.empty()) {
+    next_iter = spare_iterations.back();
+    spare_iterations.pop_back();
+    next_iter->Reset(iteration_count, pending_counts, total_input_tensors);
+  } else {
+    next_iter = new IterationState(iteration_count, pending_counts,
+                                   total_input_tensors);
+  }
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   dead_exits.clear();
@@ -635,7 +640,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64 curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    spare_iterations.push_back(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
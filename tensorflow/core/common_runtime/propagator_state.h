@@ -87,6 +87,13 @@ class PropagatorState {
     TaggedNodeReadyQueue() : front_index_(0) {}
 
     void push_back(const TaggedNode& node) { ready_.push_back(node); }
+    void push_front(const TaggedNode& node) {
+      if (front_index_ > 0) {
+        ready_[--front_index_] = node;
+      } else {
+        ready_.insert(ready_.begin(), node);
+      }
+    }
     TaggedNode front() const {
       DCHECK_LT(front_index_, ready_.size());
       return ready_[front_index_];
@@ -130,7 +137,7 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64 iter_num;  // The index of this iteration in the enclosing loop.
+    int64 iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -171,6 +178,44 @@ class PropagatorState {
       return counts.adjust_for_activation(h, increment_dead);
     }
 
+    // The child frames started in this iteration that are not yet done, so
+    // that Enter nodes find their frame without the executor-wide lock.
+    // Guarded by the `mu` of the frame this iteration belongs to.
+    gtl::InlinedVector<
+        std::pair<const ImmutableExecutorState::FrameInfo*, FrameState*>, 2>
+        child_frames;
+
+    FrameState* FindChildFrame(
+        const ImmutableExecutorState::FrameInfo* frame_info) const {
+      for (const auto& child : child_frames) {
+        if (child.first == frame_info) return child.second;
+      }
+      return nullptr;
+    }
+
+    void RemoveChildFrame(FrameState* frame) {
+      for (auto it = child_frames.begin(); it != child_frames.end(); ++it) {
+        if (it->second == frame) {
+          child_frames.erase(it);
+          return;
+        }
+      }
+    }
+
+    // Prepares this retired iteration state to be iteration `num` of its
+    // frame, keeping the storage of its inputs and pending counts.
+    void Reset(int64 num, const PendingCounts* pending_counts,
+               int total_input_tensors) {
+      iter_num = num;
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i].ClearVal();
+      }
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      child_frames.clear();
+      counts.CopyFrom(*pending_counts);
+    }
+
     ~IterationState() { delete[] input_tensors; }
 
    private:
@@ -271,6 +316,11 @@ class PropagatorState {
     // will only "execute" the dead exits of the final iteration.
     std::vector<const NodeItem*> dead_exits TF_GUARDED_BY(mu);
 
+    // Iteration states of completed iterations, which IncrementIteration()
+    // reuses rather than allocating a state for every iteration. There are
+    // never more than max_parallel_iterations + 1 states in a frame.
+    std::vector<IterationState*> spare_iterations TF_GUARDED_BY(mu);
+
     // Static information specific to this frame.
     PendingCounts* pending_counts = nullptr;
     int total_input_tensors = 0;
@@ -355,6 +405,7 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iteration : spare_iterations) delete iteration;
     }
 
    private:
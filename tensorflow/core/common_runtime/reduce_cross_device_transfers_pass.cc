@@ -0,0 +1,173 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/reduce_cross_device_transfers_pass.h"
+
+#include <map>
+#include <vector>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Consts larger than this are sent rather than replicated, to bound the
+// memory the replicas take on each device.
+constexpr int64 kMaxReplicatedConstBytes = 1024;
+
+bool IsEnabled() {
+  static const bool enabled = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_REDUCE_CROSS_DEVICE_TRANSFERS",
+                                  /*default_val=*/true, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return true;
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+// Returns true if a kernel for `n` is registered for the type of `device`.
+bool HasKernelOn(const Node* n, const string& device) {
+  DeviceNameUtils::ParsedName parsed;
+  return DeviceNameUtils::ParseFullName(device, &parsed) && parsed.has_type &&
+         KernelDefAvailable(DeviceType(parsed.type), n->def());
+}
+
+// Returns true if `n` is a Const of at most kMaxReplicatedConstBytes whose
+// only in-edge is the control edge from the source node.
+bool IsReplicableConst(const Node* n) {
+  if (n->type_string() != "Const") return false;
+  for (const Edge* e : n->in_edges()) {
+    if (!e->IsControlEdge() || !e->src()->IsSource()) return false;
+  }
+  const TensorProto* value;
+  if (!TryGetNodeAttr(n->attrs(), "value", &value) ||
+      !DataTypeCanUseMemcpy(value->dtype()) ||
+      !TensorShape::IsValid(value->tensor_shape())) {
+    return false;
+  }
+  return TensorShape(value->tensor_shape()).num_elements() *
+             DataTypeSize(value->dtype()) <=
+         kMaxReplicatedConstBytes;
+}
+
+// Replicates the Const `n` onto every other device that consumes it, and
+// returns the number of replicas.
+int ReplicateConst(Node* n, Graph* g) {
+  std::map<string, std::vector<const Edge*>> remote_edges;
+  for (const Edge* e : n->out_edges()) {
+    const string& device = e->dst()->assigned_device_name();
+    if (!e->IsControlEdge() && !device.empty() &&
+        device != n->assigned_device_name()) {
+      remote_edges[device].push_back(e);
+    }
+  }
+  int num_replicas = 0;
+  for (const auto& p : remote_edges) {
+    if (!HasKernelOn(n, p.first)) continue;
+    Node* replica = g->CopyNode(n);
+    replica->set_name(g->NewName(strings::StrCat(n->name(), "/_replica")));
+    replica->ClearAttr(kColocationAttrName);
+    replica->set_assigned_device_name(p.first);
+    g->AddControlEdge(g->source_node(), replica);
+    for (const Edge* e : p.second) {
+      TF_CHECK_OK(g->UpdateEdge(replica, 0, e->dst(), e->dst_input()));
+    }
+    ++num_replicas;
+  }
+  return num_replicas;
+}
+
+// Moves `n` onto the device of its consumers if it is a Cast to a wider type
+// whose input is on its own device and all of whose data consumers are on
+// one other device. Returns true if `n` was moved.
+bool MaybeMoveWideningCast(Node* n) {
+  if (n->type_string() != "Cast") return false;
+  DataType src_type, dst_type;
+  if (!TryGetNodeAttr(n->attrs(), "SrcT", &src_type) ||
+      !TryGetNodeAttr(n->attrs(), "DstT", &dst_type) ||
+      DataTypeSize(src_type) == 0 ||
+      DataTypeSize(dst_type) <= DataTypeSize(src_type)) {
+    return false;
+  }
+  const Edge* input;
+  if (!n->input_edge(0, &input).ok() ||
+      input->src()->assigned_device_name() != n->assigned_device_name()) {
+    return false;
+  }
+  string target;
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge()) continue;
+    const string& device = e->dst()->assigned_device_name();
+    if (device.empty() || device == n->assigned_device_name() ||
+        (!target.empty() && device != target)) {
+      return false;
+    }
+    target = device;
+  }
+  if (target.empty() || !HasKernelOn(n, target)) return false;
+  n->ClearAttr(kColocationAttrName);
+  n->set_assigned_device_name(target);
+  return true;
+}
+
+}  // namespace
+
+Status ReduceCrossDeviceTransfersPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  if (options.graph == nullptr || !IsEnabled()) return Status::OK();
+  Graph* g = options.graph->get();
+
+  // Collect the candidates first, since replicating adds nodes.
+  std::vector<Node*> consts;
+  std::vector<Node*> casts;
+  for (Node* n : g->op_nodes()) {
+    if (IsReplicableConst(n)) {
+      consts.push_back(n);
+    } else if (n->type_string() == "Cast") {
+      casts.push_back(n);
+    }
+  }
+  // Casts are moved first, so that the Consts they read are then replicated
+  // onto their new devices.
+  int num_moved_casts = 0;
+  for (Node* n : casts) {
+    if (MaybeMoveWideningCast(n)) ++num_moved_casts;
+  }
+  int num_replicas = 0;
+  for (Node* n : consts) {
+    num_replicas += ReplicateConst(n, g);
+  }
+  if (num_replicas > 0 || num_moved_casts > 0) {
+    VLOG(1) << "Added " << num_replicas << " Const replicas and moved "
+            << num_moved_casts << " Casts to their consumers' devices";
+  }
+  return Status::OK();
+}
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 1,
+                      ReduceCrossDeviceTransfersPass);
+
+}  // namespace tensorflow
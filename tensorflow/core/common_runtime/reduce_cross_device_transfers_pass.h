@@ -0,0 +1,51 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_REDUCE_CROSS_DEVICE_TRANSFERS_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_REDUCE_CROSS_DEVICE_TRANSFERS_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Changes the placement of cheap nodes whose outputs would otherwise be sent
+// to another device on every step, before the graph is partitioned.
+//
+// A small Const (of at most 1KB) consumed on other devices is replicated
+// onto each of them, so that its value is never sent:
+//
+//      c (Const, /device:CPU:0)           c (Const)    c/_0 (Const)
+//       /        \                 =>        |              |
+//      v          v                          v              v
+//    x (CPU:0)   y (GPU:0)                 x (CPU:0)      y (GPU:0)
+//
+// A Cast to a wider type, e.g. from int8 or half to float, all of whose
+// consumers are on one other device, is moved onto that device, so that the
+// narrower input is sent instead of the wider output.
+//
+// Partition() already sends each tensor at most once per destination, so
+// together this removes most of the transfers of values that are cheaper to
+// compute than to move. Nodes are only moved to devices that have a kernel
+// for them, and only Consts without inputs are replicated.
+//
+// Set TF_REDUCE_CROSS_DEVICE_TRANSFERS=false to disable this pass.
+class ReduceCrossDeviceTransfersPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_REDUCE_CROSS_DEVICE_TRANSFERS_PASS_H_
@@ -0,0 +1,143 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/reduce_cross_device_transfers_pass.h"
+
+#include <map>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::test::function::GDef;
+using ::tensorflow::test::function::NDef;
+
+constexpr char kCpu0[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+constexpr char kCpu1[] = "/job:localhost/replica:0/task:0/device:CPU:1";
+
+NodeDef Const(const string& name, const Tensor& value) {
+  return NDef(name, "Const", {}, {{"dtype", value.dtype()}, {"value", value}},
+              kCpu0);
+}
+
+NodeDef Cast(const string& name, const string& input, DataType src_type,
+             DataType dst_type) {
+  return NDef(name, "Cast", {input}, {{"SrcT", src_type}, {"DstT", dst_type}},
+              kCpu0);
+}
+
+NodeDef Identity(const string& name, const string& input, DataType type,
+                 const string& device) {
+  return NDef(name, "Identity", {input}, {{"T", type}}, device);
+}
+
+// Runs the pass on `gdef` with every node assigned to its requested device,
+// and returns the number of nodes of each op in the result.
+std::map<string, int> RunPass(const GraphDef& gdef,
+                              std::unique_ptr<Graph>* graph) {
+  *graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TF_CHECK_OK(
+      ConvertGraphDefToGraph(GraphConstructorOptions(), gdef, graph->get()));
+  for (Node* n : (*graph)->op_nodes()) {
+    n->set_assigned_device_name(n->requested_device());
+  }
+  GraphOptimizationPassOptions options;
+  options.graph = graph;
+  ReduceCrossDeviceTransfersPass pass;
+  TF_CHECK_OK(pass.Run(options));
+  std::map<string, int> op_counts;
+  for (Node* n : (*graph)->op_nodes()) ++op_counts[n->type_string()];
+  return op_counts;
+}
+
+Node* FindNode(const Graph& graph, const string& name) {
+  for (Node* n : graph.op_nodes()) {
+    if (n->name() == name) return n;
+  }
+  return nullptr;
+}
+
+Node* Input(const Graph& graph, const string& name) {
+  const Edge* edge;
+  TF_CHECK_OK(FindNode(graph, name)->input_edge(0, &edge));
+  return edge->src();
+}
+
+TEST(ReduceCrossDeviceTransfersPassTest, ReplicatesSmallConst) {
+  std::unique_ptr<Graph> graph;
+  std::map<string, int> op_counts = RunPass(
+      GDef({Const("c", test::AsScalar<float>(1.0f)),
+            Identity("x", "c", DT_FLOAT, kCpu0),
+            Identity("y", "c", DT_FLOAT, kCpu1),
+            Identity("z", "c", DT_FLOAT, kCpu1)}),
+      &graph);
+  EXPECT_EQ(2, op_counts["Const"]);
+
+  EXPECT_EQ(FindNode(*graph, "c"), Input(*graph, "x"));
+  Node* replica = Input(*graph, "y");
+  EXPECT_NE(FindNode(*graph, "c"), replica);
+  EXPECT_EQ("Const", replica->type_string());
+  EXPECT_EQ(kCpu1, replica->assigned_device_name());
+  EXPECT_EQ(replica, Input(*graph, "z"));
+}
+
+TEST(ReduceCrossDeviceTransfersPassTest, KeepsLargeConst) {
+  std::unique_ptr<Graph> graph;
+  std::map<string, int> op_counts =
+      RunPass(GDef({Const("c", test::AsTensor<float>(std::vector<float>(1024),
+                                                     TensorShape({1024}))),
+                    Identity("y", "c", DT_FLOAT, kCpu1)}),
+              &graph);
+  EXPECT_EQ(1, op_counts["Const"]);
+  EXPECT_EQ(FindNode(*graph, "c"), Input(*graph, "y"));
+}
+
+TEST(ReduceCrossDeviceTransfersPassTest, MovesWideningCast) {
+  std::unique_ptr<Graph> graph;
+  RunPass(GDef({NDef("p", "Placeholder", {}, {{"dtype", DT_INT32}}, kCpu0),
+                Cast("cast", "p", DT_INT32, DT_DOUBLE),
+                Identity("y", "cast", DT_DOUBLE, kCpu1)}),
+          &graph);
+  EXPECT_EQ(kCpu1, FindNode(*graph, "cast")->assigned_device_name());
+}
+
+TEST(ReduceCrossDeviceTransfersPassTest, KeepsNarrowingCast) {
+  std::unique_ptr<Graph> graph;
+  RunPass(GDef({NDef("p", "Placeholder", {}, {{"dtype", DT_DOUBLE}}, kCpu0),
+                Cast("cast", "p", DT_DOUBLE, DT_INT32),
+                Identity("y", "cast", DT_INT32, kCpu1)}),
+          &graph);
+  EXPECT_EQ(kCpu0, FindNode(*graph, "cast")->assigned_device_name());
+}
+
+TEST(ReduceCrossDeviceTransfersPassTest, KeepsCastWithLocalConsumer) {
+  std::unique_ptr<Graph> graph;
+  RunPass(GDef({NDef("p", "Placeholder", {}, {{"dtype", DT_INT32}}, kCpu0),
+                Cast("cast", "p", DT_INT32, DT_DOUBLE),
+                Identity("x", "cast", DT_DOUBLE, kCpu0),
+                Identity("y", "cast", DT_DOUBLE, kCpu1)}),
+          &graph);
+  EXPECT_EQ(kCpu0, FindNode(*graph, "cast")->assigned_device_name());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -102,7 +102,8 @@ RingAlg::RingAlg(CollectiveType type, const string& name)
       col_params_(nullptr),
       done_(nullptr),
       group_size_(-1),
-      num_subdivs_(-1) {}
+      num_subdivs_(-1),
+      wire_dtype_(DT_INVALID) {}
 
 namespace {
 Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
@@ -382,11 +383,21 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* send_tensor = &rf->chunk;
+  if (wire_dtype_ != DT_INVALID) {
+    CastChunk(rf->chunk, &rf->wire_chunk);
+    if (rf->second_pass && !rf->do_recv) {
+      // This device computed the final value of the chunk.  Round it the same
+      // way as the copies of the other devices, so that they all agree.
+      CastChunk(rf->wire_chunk, &rf->chunk);
+    }
+    send_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->PostToPeer(
       col_params_->instance.device_names[send_to_dev_idx],
       col_params_->instance.task_names[send_to_dev_idx], send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), send_tensor,
       col_ctx_->device_locality, done);
 }
 
@@ -401,13 +412,40 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  StatusCallback recv_done = done;
+  if (wire_dtype_ != DT_INVALID) {
+    // Receive the lower precision value and convert it to the destination.
+    recv_done = [rf, dst_tensor, done](const Status& s) {
+      if (s.ok()) CastChunk(rf->wire_chunk, dst_tensor);
+      done(s);
+    };
+    dst_tensor = &rf->wire_chunk;
+  }
   col_ctx_->col_exec->RecvFromPeer(
       col_params_->instance.device_names[rf->recv_dev_idx],
       col_params_->instance.task_names[rf->recv_dev_idx],
       col_params_->task.is_local[rf->recv_dev_idx], recv_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
-      col_ctx_->device_locality, rf->subdiv_idx, done);
+      col_ctx_->device_locality, rf->subdiv_idx, recv_done);
+}
+
+/* static */
+void RingAlg::CastChunk(const Tensor& src, Tensor* dst) {
+  DCHECK_EQ(src.NumElements(), dst->NumElements());
+  if (src.dtype() == DT_FLOAT && dst->dtype() == DT_HALF) {
+    dst->flat<Eigen::half>() = src.flat<float>().cast<Eigen::half>();
+  } else if (src.dtype() == DT_FLOAT && dst->dtype() == DT_BFLOAT16) {
+    dst->flat<bfloat16>() = src.flat<float>().cast<bfloat16>();
+  } else if (src.dtype() == DT_HALF && dst->dtype() == DT_FLOAT) {
+    dst->flat<float>() = src.flat<Eigen::half>().cast<float>();
+  } else if (src.dtype() == DT_BFLOAT16 && dst->dtype() == DT_FLOAT) {
+    dst->flat<float>() = src.flat<bfloat16>().cast<float>();
+  } else {
+    LOG(FATAL) << "Unsupported wire conversion from "
+               << DataTypeString(src.dtype()) << " to "
+               << DataTypeString(dst->dtype());
+  }
 }
 
 string RingAlg::FieldState() {
@@ -80,6 +80,7 @@ class RingAlg : public CollectiveImplementationInterface {
     bool is_final = false;  // is the last field in the pass for this rank
     Tensor chunk;           // alias to field values
     Tensor tmp_chunk;
+    Tensor wire_chunk;  // chunk in wire_dtype_, if set
     Status status;
     string DebugString() const;
   };
@@ -89,6 +90,10 @@ class RingAlg : public CollectiveImplementationInterface {
   void DispatchSend(RingField* rf, const StatusCallback& done);
   void DispatchRecv(RingField* rf, const StatusCallback& done);
 
+  // Converts the float values of `src` to the data type of `dst`, or back.
+  // Only supports CPU tensors of DT_FLOAT, DT_HALF and DT_BFLOAT16.
+  static void CastChunk(const Tensor& src, Tensor* dst);
+
   // For constructing log messages for debugging.
   string FieldState();
   string TensorDebugString(const Tensor& tensor);
@@ -113,6 +118,9 @@ class RingAlg : public CollectiveImplementationInterface {
   StatusCallback done_;
   int group_size_;
   int num_subdivs_;
+  // If not DT_INVALID, chunks are sent between devices in this lower
+  // precision data type, and converted back to float on receipt.
+  DataType wire_dtype_;
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
   std::unique_ptr<CollectiveAdapter> ca_;
@@ -64,6 +64,14 @@ void RingReducer::Run(StatusCallback done) {
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
+  const DataType wire_dtype = col_params_->instance.impl_details.wire_dtype;
+  if ((wire_dtype == DT_HALF || wire_dtype == DT_BFLOAT16) &&
+      col_params_->instance.data_type == DT_FLOAT &&
+      col_params_->group.device_type == DEVICE_CPU) {
+    // The partial sums are converted back to float before each merge_op, so
+    // only the transfers lose precision.
+    wire_dtype_ = wire_dtype;
+  }
 
   if (VLOG_IS_ON(1)) {
     string buf;
@@ -167,6 +175,11 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (wire_dtype_ != DT_INVALID && (rf->do_send || rf->do_recv)) {
+    rf->wire_chunk = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        wire_dtype_, rf->chunk.shape());
+  }
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -15,6 +15,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/ring_reducer.h"
 
 #include <algorithm>
+#include <cmath>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
@@ -321,6 +323,7 @@ class RingReducerTest : public ::testing::Test {
       for (int i = 0; i < tensor_len; ++i) {
         expected[i] /= (num_workers * num_devices);
       }
+      std::vector<T> first_actual;
       for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
         TF_EXPECT_OK(instances_[di]->status_);
         Tensor* inst = &instances_[di]->tensor_;
@@ -340,11 +343,27 @@ class RingReducerTest : public ::testing::Test {
         }
 
         auto alias = actual.template unaligned_flat<T>();
+        if (di == 0) {
+          first_actual.assign(alias.data(), alias.data() + tensor_len);
+        }
         for (int i = 0; i < tensor_len; ++i) {
           switch (dtype) {
             case DT_FLOAT:
-              EXPECT_FLOAT_EQ(expected[i], alias(i))
-                  << "Mismatch at device " << di << " index " << i;
+              if (wire_dtype_ == DT_INVALID) {
+                EXPECT_FLOAT_EQ(expected[i], alias(i))
+                    << "Mismatch at device " << di << " index " << i;
+              } else {
+                // Every partial sum is rounded once on the wire.
+                const double eps = wire_dtype_ == DT_HALF ? 1e-3 : 8e-3;
+                EXPECT_NEAR(expected[i], alias(i),
+                            eps * (num_workers * num_devices) *
+                                (std::abs(expected[i]) + 1))
+                    << "Mismatch at device " << di << " index " << i;
+                // All devices hold the same rounded values.
+                EXPECT_EQ(first_actual[i], alias(i))
+                    << "Mismatch with device 0 at device " << di << " index "
+                    << i;
+              }
               break;
             case DT_DOUBLE:
               EXPECT_DOUBLE_EQ(expected[i], alias(i))
@@ -419,6 +438,7 @@ class RingReducerTest : public ::testing::Test {
       col_params_.instance = parent->col_params_.instance;
       col_params_.task.is_local = parent_->col_params_.task.is_local;
       col_params_.subdiv_rank = parent_->col_params_.subdiv_rank;
+      col_params_.instance.impl_details.wire_dtype = parent_->wire_dtype_;
 
       int num_subdivs = static_cast<int>(col_params_.subdiv_rank.size());
       int group_size = col_params_.group.group_size;
@@ -537,6 +557,7 @@ class RingReducerTest : public ::testing::Test {
 
   bool stop_ = false;
   DeviceType device_type_;
+  DataType wire_dtype_ = DT_INVALID;
   TestCollectiveExecutorMgr col_exec_mgr_;
   CollectiveExecutor* col_exec_;
   CollectiveRemoteAccessLocal* rma_;
@@ -696,6 +717,16 @@ DEF_TEST(INT32, CPU, 2, 8, 3, 4095, 0)
 DEF_TEST(INT64, CPU, 1, 2, 1, 1001, 0)
 DEF_TEST(INT64, CPU, 2, 8, 3, 4095, 0)
 
+TEST_F(RingReducerTest, HalfOnTheWire) {
+  wire_dtype_ = DT_HALF;
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, 1, 2, 1, 1001, 0);
+}
+
+TEST_F(RingReducerTest, BFloat16OnTheWire) {
+  wire_dtype_ = DT_BFLOAT16;
+  RunTest<float>(DT_FLOAT, DEVICE_CPU, 2, 2, 2, 1001, 0);
+}
+
 // Failure tests
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 1)
 DEF_TEST(FLOAT, CPU, 2, 8, 1, 9408, 7)
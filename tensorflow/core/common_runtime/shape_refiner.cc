@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 
@@ -139,6 +140,28 @@ Status InferShapesForFunctionSubNode(const Node* node, ShapeRefiner* refiner,
 Status ShapeRefiner::InferShapesForFunction(
     const FunctionDef* function_def, AttrSlice attributes,
     ExtendedInferenceContext* outer_context) {
+  InferenceContext* c = outer_context->get_context();
+  const string key = FunctionCallKey(function_def, attributes, c);
+  auto memo = function_call_outputs_.find(key);
+  if (memo != function_call_outputs_.end()) {
+    for (int i = 0; i < memo->second.size(); ++i) {
+      const FunctionOutputShapes& output = memo->second[i];
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(output.shape, &handle));
+      c->set_output(i, handle);
+      if (output.has_handle_data) {
+        std::vector<ShapeAndType> shapes_and_types(output.handle_data.size());
+        for (int j = 0; j < output.handle_data.size(); ++j) {
+          TF_RETURN_IF_ERROR(c->MakeShapeFromShapeProto(
+              output.handle_data[j].first, &shapes_and_types[j].shape));
+          shapes_and_types[j].dtype = output.handle_data[j].second;
+        }
+        c->set_output_handle_shapes_and_types(i, shapes_and_types);
+      }
+    }
+    return Status::OK();
+  }
+
   const Graph* graph;
   auto it = functions_.find(function_def);
   if (it != functions_.end()) {
@@ -183,9 +206,47 @@ Status ShapeRefiner::InferShapesForFunction(
     node_to_context_.erase(node);
   }
 
+  if (inference_status.ok()) {
+    std::vector<FunctionOutputShapes> outputs(c->num_outputs());
+    for (int i = 0; i < c->num_outputs(); ++i) {
+      FunctionOutputShapes& output = outputs[i];
+      c->ShapeHandleToProto(c->output(i), &output.shape);
+      const std::vector<ShapeAndType>* handle_data =
+          c->output_handle_shapes_and_types(i);
+      output.has_handle_data = handle_data != nullptr;
+      if (output.has_handle_data) {
+        for (const ShapeAndType& shape_and_type : *handle_data) {
+          output.handle_data.emplace_back(TensorShapeProto(),
+                                          shape_and_type.dtype);
+          c->ShapeHandleToProto(shape_and_type.shape,
+                                &output.handle_data.back().first);
+        }
+      }
+    }
+    function_call_outputs_.emplace(key, std::move(outputs));
+  }
   return inference_status;
 }
 
+/* static */ string ShapeRefiner::FunctionCallKey(
+    const FunctionDef* function_def, AttrSlice attributes,
+    InferenceContext* c) {
+  // Shape inference of the function body only sees the shapes and handle
+  // data of its inputs, not their values.
+  string key = strings::StrCat(function_def->signature().name(), "@",
+                               reinterpret_cast<uintptr_t>(function_def),
+                               attributes.SummarizeNode());
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    strings::StrAppend(&key, "|", c->DebugString(c->input(i)));
+    const std::vector<ShapeAndType>* handle_data =
+        c->input_handle_shapes_and_types(i);
+    if (handle_data != nullptr) {
+      strings::StrAppend(&key, "&", c->DebugString(*handle_data));
+    }
+  }
+  return key;
+}
+
 Status ShapeRefiner::AddNode(const Node* node) {
   // Create the inference context for this node with the existing input shapes.
   std::unique_ptr<InferenceContext> ic(new InferenceContext(
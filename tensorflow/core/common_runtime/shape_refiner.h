@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SHAPE_REFINER_H_
 
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -184,6 +185,20 @@ class ShapeRefiner {
                                 AttrSlice attributes,
                                 ExtendedInferenceContext* outer_context);
 
+  // The shapes inferred for one output of a function call, stored as protos
+  // so that they can be copied into the InferenceContext of any call site.
+  struct FunctionOutputShapes {
+    TensorShapeProto shape;
+    bool has_handle_data = false;
+    std::vector<std::pair<TensorShapeProto, DataType>> handle_data;
+  };
+
+  // Returns the key under which the output shapes of a call to function_def
+  // with the given attributes and the input shapes of 'c' are memoized.
+  static string FunctionCallKey(const FunctionDef* function_def,
+                                AttrSlice attributes,
+                                shape_inference::InferenceContext* c);
+
   // Attempts to evaluate the 'dst_idx'-th input to 'node'. If the input edge
   // value can be evaluated, 'evaluated' is set to true and the value returned
   // in 'result'. Otherwise 'evaluated' is set to false.
@@ -265,6 +280,12 @@ class ShapeRefiner {
                       hash<const FunctionDef*>>
       functions_;
 
+  // Memoizes the output shapes inferred for function calls, keyed by
+  // FunctionCallKey(), so that calls with the same input shapes don't run
+  // shape inference on the function body again.
+  absl::flat_hash_map<string, std::vector<FunctionOutputShapes>>
+      function_call_outputs_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ShapeRefiner);
 };
 
@@ -59,6 +59,10 @@ class ShapeRefinerTest : public ::testing::Test {
     return ShapeRefiner::IsUpdatedShapesOrTypes(c, existing, updated);
   }
 
+  int NumMemoizedFunctionCalls(const ShapeRefiner& m) {
+    return m.function_call_outputs_.size();
+  }
+
   static constexpr int64 kMaxTensorSize = ShapeRefiner::kMaxTensorSize;
 
   void TestStridedSlice(const PartialTensorShape& input_shape, int begin,
@@ -1480,6 +1484,39 @@ TEST_F(ShapeRefinerTest, ChainedFunctionShapeInferenceWithMultipleInputs) {
   EXPECT_SHAPE("[3,3]", m, wxplusb16, 0);
 }
 
+TEST_F(ShapeRefinerTest, FunctionShapeInferenceIsMemoized) {
+  FunctionDefLibrary f_lib_proto;
+  *(f_lib_proto.add_function()) = test::function::XTimesTwo();
+  FunctionLibraryDefinition f_lib(OpRegistry::Global(), f_lib_proto);
+
+  Scope root = Scope::NewRootScope();
+  TF_ASSERT_OK(root.graph()->AddFunctionLibrary(f_lib_proto));
+  auto x = ops::Const(root, {{.0f, .0f}});
+  auto y = ops::Const(root, {{.0f, .0f}});
+  auto z = ops::Const(root, {{.0f}, {.0f}, {.0f}});
+  auto x2 = test::function::Call(&root, "x2", "XTimesTwo", {x});
+  auto y2 = test::function::Call(&root, "y2", "XTimesTwo", {y});
+  auto z2 = test::function::Call(&root, "z2", "XTimesTwo", {z});
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, &f_lib);
+  m.set_function_library_for_shape_inference(&f_lib);
+
+  TF_ASSERT_OK(m.AddNode(x.node()));
+  TF_ASSERT_OK(m.AddNode(y.node()));
+  TF_ASSERT_OK(m.AddNode(z.node()));
+  TF_ASSERT_OK(m.AddNode(x2.node()));
+  EXPECT_EQ(1, NumMemoizedFunctionCalls(m));
+  TF_ASSERT_OK(m.AddNode(y2.node()));
+  // The call with the same input shape reuses the memoized output shapes.
+  EXPECT_EQ(1, NumMemoizedFunctionCalls(m));
+  TF_ASSERT_OK(m.AddNode(z2.node()));
+  EXPECT_EQ(2, NumMemoizedFunctionCalls(m));
+
+  EXPECT_SHAPE("[1,2]", m, x2, 0);
+  EXPECT_SHAPE("[1,2]", m, y2, 0);
+  EXPECT_SHAPE("[3,1]", m, z2, 0);
+}
+
 TEST_F(ShapeRefinerTest, FunctionShapeInferenceWorksForResourceHandles) {
   FunctionDefLibrary f_lib_proto;
   *(f_lib_proto.add_function()) = test::function::Swap();
@@ -39,7 +39,8 @@ SimplePropagatorState::SimplePropagatorState(
       active_(vlog_ ? new std::vector<bool>(
                           immutable_state.graph_view().num_nodes())
                     : nullptr),
-      nodes_(finfo.nodes.get()) {
+      nodes_(finfo.nodes.get()),
+      layout_(&immutable_state.frozen_graph_layout()) {
   immutable_state_.copy_pending_counts(pending_.get());
 }
 
@@ -72,21 +73,29 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
   DCHECK(ready->empty());
 
   const GraphView& gview = immutable_state_.graph_view();
-  const NodeItem* item = tagged_node.node_item;
-
-  for (const EdgeInfo& e : item->output_edges()) {
-    const int dst_id = e.dst_id;
-    const int src_slot = e.output_slot;
-    const int dst_loc = e.input_slot;
+  const int32 id = tagged_node.node_item->node_id;
+  const ImmutableExecutorState::FrozenGraphLayout& layout = *layout_;
+  Entry* const input_tensors = input_tensors_.data();
+
+  const int32* const data_dst_id = layout.data_dst_id.data();
+  const int32* const data_src_slot = layout.data_src_slot.data();
+  const int32* const data_input_loc = layout.data_input_loc.data();
+  const uint8* const data_is_last = layout.data_is_last.data();
+  for (int32 e = layout.data_edge_begin[id],
+             end = layout.data_edge_begin[id + 1];
+       e < end; ++e) {
+    const int dst_id = data_dst_id[e];
+    const int src_slot = data_src_slot[e];
+    const int dst_loc = data_input_loc[e];
 
     // NOTE(mrry): The write to `input_tensors_[dst_loc]` must happen before
     // the pending count update, or else one thread might conclude that the
     // count has dropped to zero before another thread finishes updating the
     // input.
-    if (e.is_last) {
-      input_tensors_[dst_loc] = std::move((*outputs)[src_slot]);
+    if (data_is_last[e]) {
+      input_tensors[dst_loc] = std::move((*outputs)[src_slot]);
     } else {
-      input_tensors_[dst_loc] = (*outputs)[src_slot];
+      input_tensors[dst_loc] = (*outputs)[src_slot];
     }
 
     int32 previous_num_pending =
@@ -94,8 +103,11 @@ void SimplePropagatorState::PropagateOutputs(const TaggedNode& tagged_node,
     if (previous_num_pending == 1) ready->emplace_back(&gview.node_ref(dst_id));
   }
 
-  for (const ControlEdgeInfo& e : item->output_control_edges()) {
-    const int dst_id = e.dst_id;
+  const int32* const control_dst_id = layout.control_dst_id.data();
+  for (int32 e = layout.control_edge_begin[id],
+             end = layout.control_edge_begin[id + 1];
+       e < end; ++e) {
+    const int dst_id = control_dst_id[e];
 
     int32 previous_num_pending =
         pending_[dst_id].fetch_sub(1, std::memory_order_release);
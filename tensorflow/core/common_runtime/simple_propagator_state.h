@@ -55,6 +55,7 @@ class SimplePropagatorState {
   struct TaggedNode {
     const NodeItem* node_item;
 
+    TaggedNode() = default;
     explicit TaggedNode(const NodeItem* node_item) : node_item(node_item) {}
 
     const NodeItem& get_node_item() const { return *node_item; }
@@ -74,6 +75,13 @@ class SimplePropagatorState {
     TaggedNodeReadyQueue() : front_index_(0) {}
 
     void push_back(const TaggedNode& node) { ready_.push_back(node); }
+    void push_front(const TaggedNode& node) {
+      if (front_index_ > 0) {
+        ready_[--front_index_] = node;
+      } else {
+        ready_.insert(ready_.begin(), node);
+      }
+    }
     TaggedNode front() const {
       DCHECK_LT(front_index_, ready_.size());
       return ready_[front_index_];
@@ -182,6 +190,9 @@ class SimplePropagatorState {
   std::unique_ptr<std::vector<bool>> active_ TF_GUARDED_BY(mu_);
 
   const std::vector<const NodeItem*>* const nodes_;
+
+  // Not owned. The contiguous edge layout walked by `PropagateOutputs()`.
+  const ImmutableExecutorState::FrozenGraphLayout* const layout_;
 };
 
 }  // namespace tensorflow
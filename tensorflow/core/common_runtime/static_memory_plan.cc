@@ -0,0 +1,380 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// The ancestor sets used for planning take O(n^2) bits for n nodes, so larger
+// graphs run unplanned.
+constexpr int kMaxPlannedNodes = 1 << 14;
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  const size_t alignment = Allocator::kAllocatorAlignment;
+  return (num_bytes + alignment - 1) / alignment * alignment;
+}
+
+// Returns true if the given output of `n` may be placed in a per-step arena.
+// Outputs that are handed out of the step, or that stateful consumers may
+// retain across steps, would keep the whole arena of their step alive.
+bool CanPlanOutput(const Node* n, int output) {
+  const DataType dtype = n->output_type(output);
+  if (IsRefType(dtype) || !DataTypeCanUseMemcpy(dtype)) {
+    return false;
+  }
+  for (const Edge* e : n->out_edges()) {
+    if (e->src_output() != output) continue;
+    const Node* dst = e->dst();
+    if (dst->IsRetval() || dst->IsSend() || !dst->IsOp() ||
+        dst->op_def().is_stateful()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+struct StaticMemoryPlan::GraphInfo {
+  // Position of every node in a topological order of the graph.
+  std::vector<int> topo_position;
+  // Bit set of the ancestors of every node, `words_per_node` words each.
+  std::vector<uint64> ancestors;
+  int words_per_node = 0;
+  // Producer and data consumers of every output.
+  std::vector<int> producer;
+  std::vector<std::vector<int>> consumers;
+
+  bool IsAncestor(int ancestor, int node) const {
+    return (ancestors[node * words_per_node + ancestor / 64] >>
+            (ancestor % 64)) &
+           1;
+  }
+
+  // Returns true if the memory of output `prev` may be reused by an output of
+  // node `node`, i.e. if `prev` is dead before `node` can start.
+  bool CanReuse(int prev, int node) const {
+    if (consumers[prev].empty()) {
+      return IsAncestor(producer[prev], node);
+    }
+    for (int consumer : consumers[prev]) {
+      if (!IsAncestor(consumer, node)) return false;
+    }
+    return true;
+  }
+};
+
+struct StaticMemoryPlan::Layout {
+  // Arena slot of every output, or -1 if the output is not planned.
+  std::vector<int> slot_of_output;
+  // Offset and size of every slot, sorted by offset.
+  std::vector<size_t> slot_offset;
+  std::vector<size_t> slot_bytes;
+  size_t arena_bytes = 0;
+  int num_planned_outputs = 0;
+};
+
+class StaticMemoryPlan::StepArena::OutputAllocator : public Allocator {
+ public:
+  string Name() override { return "static_memory_plan"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return arena_->AllocateOutput(output_, alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override { arena_->DeallocateOutput(ptr); }
+
+ private:
+  friend class StepArena;
+
+  StepArena* arena_ = nullptr;
+  int output_ = -1;
+};
+
+std::unique_ptr<StaticMemoryPlan> StaticMemoryPlan::Create(
+    const Graph& graph, Allocator* allocator) {
+  const int num_node_ids = graph.num_node_ids();
+  if (num_node_ids > kMaxPlannedNodes) {
+    VLOG(1) << "Not planning memory for a graph with " << num_node_ids
+            << " nodes.";
+    return nullptr;
+  }
+  for (const Node* n : graph.nodes()) {
+    if (n->IsControlFlow()) {
+      VLOG(1) << "Not planning memory for a graph with control flow.";
+      return nullptr;
+    }
+  }
+
+  auto info = absl::make_unique<GraphInfo>();
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  info->topo_position.assign(num_node_ids, -1);
+  info->words_per_node = (num_node_ids + 63) / 64;
+  info->ancestors.assign(
+      static_cast<size_t>(num_node_ids) * info->words_per_node, 0);
+  for (int i = 0; i < order.size(); ++i) {
+    const int id = order[i]->id();
+    info->topo_position[id] = i;
+    uint64* row = &info->ancestors[id * info->words_per_node];
+    for (const Edge* e : order[i]->in_edges()) {
+      const int src = e->src()->id();
+      const uint64* src_row = &info->ancestors[src * info->words_per_node];
+      for (int w = 0; w < info->words_per_node; ++w) {
+        row[w] |= src_row[w];
+      }
+      row[src / 64] |= uint64{1} << (src % 64);
+    }
+  }
+
+  std::vector<int> output_base(num_node_ids, -1);
+  std::vector<bool> plannable;
+  for (const Node* n : graph.op_nodes()) {
+    const int num_outputs = n->num_outputs();
+    bool any_plannable = false;
+    for (int i = 0; i < num_outputs; ++i) {
+      any_plannable = any_plannable || CanPlanOutput(n, i);
+    }
+    if (!any_plannable) continue;
+
+    output_base[n->id()] = plannable.size();
+    for (int i = 0; i < num_outputs; ++i) {
+      plannable.push_back(CanPlanOutput(n, i));
+      info->producer.push_back(n->id());
+      info->consumers.emplace_back();
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge()) {
+        info->consumers[output_base[n->id()] + e->src_output()].push_back(
+            e->dst()->id());
+      }
+    }
+  }
+  if (plannable.empty()) {
+    return nullptr;
+  }
+  return absl::WrapUnique(new StaticMemoryPlan(allocator,
+                                               std::move(output_base),
+                                               std::move(plannable),
+                                               std::move(info)));
+}
+
+StaticMemoryPlan::StaticMemoryPlan(Allocator* allocator,
+                                   std::vector<int> output_base,
+                                   std::vector<bool> plannable,
+                                   std::unique_ptr<GraphInfo> graph_info)
+    : allocator_(allocator),
+      output_base_(std::move(output_base)),
+      plannable_(std::move(plannable)),
+      recorded_bytes_(new std::atomic<size_t>[plannable_.size()]),
+      graph_info_(std::move(graph_info)) {
+  for (int i = 0; i < plannable_.size(); ++i) {
+    recorded_bytes_[i] = 0;
+  }
+}
+
+StaticMemoryPlan::~StaticMemoryPlan() {}
+
+StaticMemoryPlan::StepArena* StaticMemoryPlan::StartStep() {
+  std::shared_ptr<const Layout> layout;
+  {
+    mutex_lock l(mu_);
+    if (fixed_) {
+      if (layout_ == nullptr) return nullptr;
+      layout = layout_;
+    } else if (profiling_) {
+      // Steps that run while another step is profiling stay unplanned.
+      return nullptr;
+    } else {
+      profiling_ = true;
+    }
+  }
+  return new StepArena(this, std::move(layout));
+}
+
+void StaticMemoryPlan::FinishProfilingStep(StepArena* arena, bool ok) {
+  DCHECK(arena->is_profiling());
+  mutex_lock l(mu_);
+  profiling_ = false;
+  if (ok) {
+    Fix();
+  }
+}
+
+bool StaticMemoryPlan::is_fixed() const {
+  mutex_lock l(mu_);
+  return fixed_;
+}
+
+size_t StaticMemoryPlan::arena_bytes() const {
+  mutex_lock l(mu_);
+  return layout_ == nullptr ? 0 : layout_->arena_bytes;
+}
+
+int StaticMemoryPlan::num_planned_outputs() const {
+  mutex_lock l(mu_);
+  return layout_ == nullptr ? 0 : layout_->num_planned_outputs;
+}
+
+void StaticMemoryPlan::Fix() {
+  const GraphInfo& info = *graph_info_;
+  const int num_outputs = plannable_.size();
+
+  // Visit the outputs that were allocated in topological order of their
+  // producers, and greedily place each one in a slot whose previous occupant
+  // is known to be dead. Among those, prefer the smallest slot that already
+  // fits, and otherwise grow the largest one.
+  std::vector<int> outputs;
+  for (int i = 0; i < num_outputs; ++i) {
+    if (plannable_[i] && recorded_bytes_[i].load() > 0) {
+      outputs.push_back(i);
+    }
+  }
+  std::stable_sort(outputs.begin(), outputs.end(), [&info](int a, int b) {
+    return info.topo_position[info.producer[a]] <
+           info.topo_position[info.producer[b]];
+  });
+
+  auto layout = std::make_shared<Layout>();
+  layout->slot_of_output.assign(num_outputs, -1);
+  std::vector<int> slot_last_output;
+  for (int output : outputs) {
+    const size_t num_bytes = RoundUpToAlignment(recorded_bytes_[output]);
+    const int node = info.producer[output];
+    int best = -1;
+    for (int slot = 0; slot < slot_last_output.size(); ++slot) {
+      if (!info.CanReuse(slot_last_output[slot], node)) continue;
+      if (best < 0) {
+        best = slot;
+        continue;
+      }
+      const size_t best_bytes = layout->slot_bytes[best];
+      const size_t slot_bytes = layout->slot_bytes[slot];
+      const bool best_fits = best_bytes >= num_bytes;
+      const bool slot_fits = slot_bytes >= num_bytes;
+      if (slot_fits ? (!best_fits || slot_bytes < best_bytes)
+                    : (!best_fits && slot_bytes > best_bytes)) {
+        best = slot;
+      }
+    }
+    if (best < 0) {
+      best = slot_last_output.size();
+      slot_last_output.push_back(output);
+      layout->slot_bytes.push_back(num_bytes);
+    } else {
+      slot_last_output[best] = output;
+      layout->slot_bytes[best] = std::max(layout->slot_bytes[best], num_bytes);
+    }
+    layout->slot_of_output[output] = best;
+    ++layout->num_planned_outputs;
+  }
+  for (size_t slot_bytes : layout->slot_bytes) {
+    layout->slot_offset.push_back(layout->arena_bytes);
+    layout->arena_bytes += slot_bytes;
+  }
+  VLOG(1) << "Planned " << layout->num_planned_outputs << " outputs into "
+          << layout->slot_bytes.size() << " slots of a " << layout->arena_bytes
+          << " byte arena.";
+
+  fixed_ = true;
+  graph_info_.reset();
+  if (layout->num_planned_outputs > 0) {
+    layout_ = std::move(layout);
+  }
+}
+
+StaticMemoryPlan::StepArena::StepArena(const StaticMemoryPlan* plan,
+                                       std::shared_ptr<const Layout> layout)
+    : plan_(plan), allocator_(plan->allocator_), layout_(std::move(layout)) {
+  const int num_outputs = plan->plannable_.size();
+  allocators_.reset(new OutputAllocator[num_outputs]);
+  output_allocators_.assign(num_outputs, nullptr);
+  for (int i = 0; i < num_outputs; ++i) {
+    if (layout_ == nullptr ? plan->plannable_[i]
+                           : layout_->slot_of_output[i] >= 0) {
+      allocators_[i].arena_ = this;
+      allocators_[i].output_ = i;
+      output_allocators_[i] = &allocators_[i];
+    }
+  }
+  if (layout_ != nullptr) {
+    const int num_slots = layout_->slot_bytes.size();
+    slot_in_use_.reset(new std::atomic<bool>[num_slots]);
+    for (int i = 0; i < num_slots; ++i) {
+      slot_in_use_[i] = false;
+    }
+    // If the arena cannot be allocated, every output falls back to
+    // `allocator_`.
+    base_ = static_cast<char*>(allocator_->AllocateRaw(
+        Allocator::kAllocatorAlignment, layout_->arena_bytes));
+  }
+}
+
+StaticMemoryPlan::StepArena::~StepArena() {
+  if (base_ != nullptr) {
+    allocator_->DeallocateRaw(base_);
+  }
+}
+
+void* StaticMemoryPlan::StepArena::AllocateOutput(int output, size_t alignment,
+                                                  size_t num_bytes) {
+  if (layout_ == nullptr) {
+    std::atomic<size_t>& recorded = plan_->recorded_bytes_[output];
+    size_t prev = recorded.load(std::memory_order_relaxed);
+    while (prev < num_bytes &&
+           !recorded.compare_exchange_weak(prev, num_bytes,
+                                           std::memory_order_relaxed)) {
+    }
+  } else if (base_ != nullptr) {
+    const int slot = layout_->slot_of_output[output];
+    if (num_bytes <= layout_->slot_bytes[slot] &&
+        alignment <= Allocator::kAllocatorAlignment &&
+        !slot_in_use_[slot].exchange(true, std::memory_order_acq_rel)) {
+      Ref();
+      return base_ + layout_->slot_offset[slot];
+    }
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr != nullptr) {
+    Ref();
+  }
+  return ptr;
+}
+
+void StaticMemoryPlan::StepArena::DeallocateOutput(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (base_ != nullptr && p >= base_ && p < base_ + layout_->arena_bytes) {
+    const std::vector<size_t>& offsets = layout_->slot_offset;
+    const int slot =
+        std::upper_bound(offsets.begin(), offsets.end(),
+                         static_cast<size_t>(p - base_)) -
+        offsets.begin() - 1;
+    slot_in_use_[slot].store(false, std::memory_order_release);
+  } else {
+    allocator_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Graph;
+
+// A StaticMemoryPlan packs the node outputs of a graph without control flow
+// into a single arena that is allocated once per step, in the spirit of
+// TFLite's ArenaPlanner. Kernels then allocate their outputs from fixed
+// offsets in that arena, without calling into the device allocator.
+//
+// Two outputs may share arena memory only if every consumer of the first one
+// is an ancestor of the producer of the second one in the graph, so the plan
+// stays valid under any schedule the executor chooses. Output sizes are not
+// known from the graph (partition graphs are fed through nodes without static
+// shapes), so they are recorded during the first step run with the plan, and
+// the plan is fixed after that step.
+//
+// A plan is never unsafe to use: every arena slot holds at most one buffer at
+// a time, and requests for a slot that is too small or still in use (e.g.
+// because a kernel forwarded the buffer to a longer lived tensor) fall back to
+// the underlying allocator.
+//
+// This class is thread safe.
+class StaticMemoryPlan {
+ public:
+  class StepArena;
+
+  // Returns a plan for the outputs of `graph` that are served from arenas
+  // allocated by `allocator`, or nullptr if `graph` cannot be planned, e.g.
+  // because it has control flow. `allocator` must outlive the plan and every
+  // tensor allocated through it.
+  static std::unique_ptr<StaticMemoryPlan> Create(const Graph& graph,
+                                                  Allocator* allocator);
+
+  ~StaticMemoryPlan();
+
+  // Returns the arena to use for a new step, with one reference owned by the
+  // caller, or nullptr if the step must run unplanned. While the plan is not
+  // fixed yet, the returned arena records output sizes instead, and the caller
+  // must call FinishProfilingStep() at the end of the step.
+  StepArena* StartStep();
+
+  // Fixes the plan from the sizes recorded by the step that got `arena` from
+  // StartStep(), if `ok`. Otherwise the next step profiles again.
+  void FinishProfilingStep(StepArena* arena, bool ok);
+
+  // Returns true once the plan is fixed.
+  bool is_fixed() const;
+
+  // Returns the size of the per-step arena, or 0 if the plan is not fixed.
+  size_t arena_bytes() const;
+
+  // Returns the number of outputs placed in the arena by the fixed plan.
+  int num_planned_outputs() const;
+
+ private:
+  struct GraphInfo;
+  struct Layout;
+
+  StaticMemoryPlan(Allocator* allocator, std::vector<int> output_base,
+                   std::vector<bool> plannable,
+                   std::unique_ptr<GraphInfo> graph_info);
+
+  // Computes the arena layout from the sizes recorded so far.
+  void Fix() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const allocator_;  // Not owned.
+
+  // Index of the first output of each node in the plan's flat array of
+  // outputs, or -1 if none of the node's outputs can be planned.
+  const std::vector<int> output_base_;
+  // Whether each output in the flat array may be placed in the arena.
+  const std::vector<bool> plannable_;
+
+  // The largest allocation made for every output during profiling.
+  std::unique_ptr<std::atomic<size_t>[]> recorded_bytes_;
+
+  mutable mutex mu_;
+  // Graph information used to compute the layout. Cleared once the plan is
+  // fixed.
+  std::unique_ptr<GraphInfo> graph_info_ TF_GUARDED_BY(mu_);
+  bool profiling_ TF_GUARDED_BY(mu_) = false;
+  bool fixed_ TF_GUARDED_BY(mu_) = false;
+  std::shared_ptr<const Layout> layout_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+// The arena of one step. Every tensor allocated through the arena holds a
+// reference to it, since such tensors may outlive the step (e.g. when they are
+// fetched).
+class StaticMemoryPlan::StepArena : public core::RefCounted {
+ public:
+  ~StepArena() override;
+
+  // Returns the allocators to use for the outputs of the node with the given
+  // id, indexed by output. An entry is nullptr if the output is not planned,
+  // and the returned pointer is nullptr if no output of the node is.
+  Allocator* const* output_allocators(int node_id) const {
+    const int base = plan_->output_base_[node_id];
+    return base < 0 ? nullptr : &output_allocators_[base];
+  }
+
+  bool is_profiling() const { return layout_ == nullptr; }
+
+ private:
+  friend class StaticMemoryPlan;
+  class OutputAllocator;
+
+  StepArena(const StaticMemoryPlan* plan, std::shared_ptr<const Layout> layout);
+
+  void* AllocateOutput(int output, size_t alignment, size_t num_bytes);
+  void DeallocateOutput(void* ptr);
+
+  const StaticMemoryPlan* const plan_;  // Only used during the step.
+  Allocator* const allocator_;          // Not owned.
+  const std::shared_ptr<const Layout> layout_;
+
+  char* base_ = nullptr;
+  std::unique_ptr<std::atomic<bool>[]> slot_in_use_;
+  std::unique_ptr<OutputAllocator[]> allocators_;
+  std::vector<Allocator*> output_allocators_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
@@ -0,0 +1,195 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Number of floats in every tensor allocated by these tests (256 bytes).
+constexpr int kNumElements = 64;
+
+Tensor Scalar(float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+// Allocates output 0 of `node` through `arena`, the way OpKernelContext does.
+Tensor AllocateOutput(StaticMemoryPlan::StepArena* arena, const Node* node) {
+  Allocator* const* allocators = arena->output_allocators(node->id());
+  CHECK(allocators != nullptr);
+  CHECK(allocators[0] != nullptr);
+  return Tensor(allocators[0], DT_FLOAT, TensorShape({kNumElements}));
+}
+
+// Runs one profiling step that allocates output 0 of every node in `nodes`.
+void Profile(StaticMemoryPlan* plan, const std::vector<Node*>& nodes) {
+  StaticMemoryPlan::StepArena* arena = plan->StartStep();
+  ASSERT_NE(arena, nullptr);
+  ASSERT_TRUE(arena->is_profiling());
+  for (const Node* node : nodes) {
+    AllocateOutput(arena, node);
+  }
+  plan->FinishProfilingStep(arena, /*ok=*/true);
+  arena->Unref();
+}
+
+const char* Data(const Tensor& t) { return t.tensor_data().data(); }
+
+TEST(StaticMemoryPlanTest, ChainReusesDeadOutputs) {
+  // a -> b -> c -> d -> e
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  Node* c = test::graph::Unary(&g, "Neg", b);
+  Node* d = test::graph::Unary(&g, "Neg", c);
+  Node* e = test::graph::Unary(&g, "Neg", d);
+  FixupSourceAndSinkEdges(&g);
+
+  auto plan = StaticMemoryPlan::Create(g, cpu_allocator());
+  ASSERT_NE(plan, nullptr);
+  EXPECT_FALSE(plan->is_fixed());
+  Profile(plan.get(), {b, c, d, e});
+  ASSERT_TRUE(plan->is_fixed());
+
+  // d reuses the memory of b and e the one of c.
+  EXPECT_EQ(plan->num_planned_outputs(), 4);
+  EXPECT_EQ(plan->arena_bytes(), 2 * kNumElements * sizeof(float));
+
+  StaticMemoryPlan::StepArena* arena = plan->StartStep();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_FALSE(arena->is_profiling());
+  Tensor tb = AllocateOutput(arena, b);
+  Tensor tc = AllocateOutput(arena, c);
+  EXPECT_NE(Data(tb), Data(tc));
+  const char* b_data = Data(tb);
+  tb = Tensor();
+  Tensor td = AllocateOutput(arena, d);
+  EXPECT_EQ(Data(td), b_data);
+  arena->Unref();
+}
+
+TEST(StaticMemoryPlanTest, ConcurrentOutputsDoNotShareMemory) {
+  // a -> {b, c} -> d
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  Node* c = test::graph::Unary(&g, "Neg", a);
+  Node* d = test::graph::Add(&g, b, c);
+  FixupSourceAndSinkEdges(&g);
+
+  auto plan = StaticMemoryPlan::Create(g, cpu_allocator());
+  ASSERT_NE(plan, nullptr);
+  Profile(plan.get(), {b, c, d});
+  EXPECT_EQ(plan->num_planned_outputs(), 3);
+  EXPECT_EQ(plan->arena_bytes(), 3 * kNumElements * sizeof(float));
+}
+
+TEST(StaticMemoryPlanTest, BusySlotFallsBackToAllocator) {
+  // a -> b -> c -> d
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  Node* c = test::graph::Unary(&g, "Neg", b);
+  Node* d = test::graph::Unary(&g, "Neg", c);
+  FixupSourceAndSinkEdges(&g);
+
+  auto plan = StaticMemoryPlan::Create(g, cpu_allocator());
+  ASSERT_NE(plan, nullptr);
+  Profile(plan.get(), {b, c, d});
+
+  StaticMemoryPlan::StepArena* arena = plan->StartStep();
+  ASSERT_NE(arena, nullptr);
+  // b is still alive (e.g. because it was forwarded), so d may not take its
+  // slot.
+  Tensor tb = AllocateOutput(arena, b);
+  Tensor tc = AllocateOutput(arena, c);
+  Tensor td = AllocateOutput(arena, d);
+  EXPECT_NE(Data(td), Data(tb));
+  EXPECT_NE(Data(td), Data(tc));
+
+  // A larger allocation than recorded falls back to the allocator as well.
+  tb = Tensor();
+  Tensor large(arena->output_allocators(b->id())[0], DT_FLOAT,
+               TensorShape({2 * kNumElements}));
+  ASSERT_TRUE(large.IsInitialized());
+
+  // Tensors may outlive the step.
+  arena->Unref();
+  tc.flat<float>().setZero();
+  td.flat<float>().setZero();
+}
+
+TEST(StaticMemoryPlanTest, ConcurrentStepsDuringProfilingRunUnplanned) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  FixupSourceAndSinkEdges(&g);
+
+  auto plan = StaticMemoryPlan::Create(g, cpu_allocator());
+  ASSERT_NE(plan, nullptr);
+  StaticMemoryPlan::StepArena* arena = plan->StartStep();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_EQ(plan->StartStep(), nullptr);
+
+  // A failed profiling step is retried by the next step.
+  plan->FinishProfilingStep(arena, /*ok=*/false);
+  arena->Unref();
+  EXPECT_FALSE(plan->is_fixed());
+  Profile(plan.get(), {b});
+  EXPECT_TRUE(plan->is_fixed());
+}
+
+TEST(StaticMemoryPlanTest, FetchedOutputsAreNotPlanned) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Node* b = test::graph::Unary(&g, "Neg", a);
+  test::graph::Retval(&g, 0, b);
+  FixupSourceAndSinkEdges(&g);
+
+  auto plan = StaticMemoryPlan::Create(g, cpu_allocator());
+  ASSERT_NE(plan, nullptr);
+  StaticMemoryPlan::StepArena* arena = plan->StartStep();
+  ASSERT_NE(arena, nullptr);
+  EXPECT_NE(arena->output_allocators(a->id()), nullptr);
+  EXPECT_EQ(arena->output_allocators(b->id()), nullptr);
+  plan->FinishProfilingStep(arena, /*ok=*/true);
+  arena->Unref();
+}
+
+TEST(StaticMemoryPlanTest, ControlFlowIsNotPlanned) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Scalar(1.0));
+  Tensor pred(DT_BOOL, TensorShape({}));
+  pred.scalar<bool>()() = true;
+  Node* p = test::graph::Constant(&g, pred);
+  Node* s = test::graph::Switch(&g, a, p);
+  test::graph::Unary(&g, "Neg", s);
+  FixupSourceAndSinkEdges(&g);
+
+  EXPECT_EQ(StaticMemoryPlan::Create(g, cpu_allocator()), nullptr);
+}
+
+}  // namespace
+}  // namespace tensorflow
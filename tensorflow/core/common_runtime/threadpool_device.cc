@@ -27,9 +27,11 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 #ifdef INTEL_MKL
@@ -50,6 +52,27 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
                                name, DEVICE_CPU, memory_limit, locality)),
       allocator_(allocator),
       scoped_allocator_mgr_(new ScopedAllocatorMgr(name)) {
+  bool autotune_parallelism = false;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_AUTOTUNE_INTRA_OP_PARALLELISM",
+                                 /*default_val=*/false, &autotune_parallelism));
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_INTRA_OP_PARALLELISM_TUNING_FILE",
+                                   /*default_val=*/"",
+                                   &parallelism_tuning_file_));
+  const int num_threads = tensorflow_cpu_worker_threads()->num_threads;
+  if (autotune_parallelism && num_threads > 1) {
+    parallelism_tuner_.reset(new IntraOpParallelismTuner(num_threads));
+    if (!parallelism_tuning_file_.empty() &&
+        Env::Default()->FileExists(parallelism_tuning_file_).ok()) {
+      string text;
+      Status s = ReadFileToString(Env::Default(), parallelism_tuning_file_,
+                                  &text);
+      if (s.ok()) s = parallelism_tuner_->Import(text);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to load the intra-op parallelism settings from "
+                     << parallelism_tuning_file_ << ": " << s;
+      }
+    }
+  }
 #if !defined(ENABLE_MKLDNN_THREADPOOL) && defined(INTEL_MKL)
   // Early return when MKL is disabled
   if (DisableMKL()) return;
@@ -72,7 +95,25 @@ ThreadPoolDevice::ThreadPoolDevice(const SessionOptions& options,
 #endif  // !defined(ENABLE_MKLDNN_THREADPOOL) && defined(INTEL_MKL)
 }
 
-ThreadPoolDevice::~ThreadPoolDevice() {}
+ThreadPoolDevice::~ThreadPoolDevice() {
+  if (parallelism_tuner_ != nullptr && !parallelism_tuning_file_.empty() &&
+      parallelism_tuner_->num_tuned() > 0) {
+    Status s = WriteStringToFile(Env::Default(), parallelism_tuning_file_,
+                                 parallelism_tuner_->Export());
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to save the intra-op parallelism settings to "
+                   << parallelism_tuning_file_ << ": " << s;
+    }
+  }
+}
+
+void ThreadPoolDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
+  if (parallelism_tuner_ == nullptr) {
+    op_kernel->Compute(context);
+    return;
+  }
+  parallelism_tuner_->Compute(op_kernel, context);
+}
 
 Allocator* ThreadPoolDevice::GetAllocator(AllocatorAttributes attr) {
   return allocator_;
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_THREADPOOL_DEVICE_H_
 
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/intra_op_parallelism_tuner.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 
 namespace tensorflow {
@@ -42,11 +43,20 @@ class ThreadPoolDevice : public LocalDevice {
                               const DeviceContext* device_context,
                               StatusCallback done) override;
 
+  void Compute(OpKernel* op_kernel, OpKernelContext* context) override;
+
   Status Sync() override { return Status::OK(); }
 
  private:
   Allocator* allocator_;  // Not owned
   std::unique_ptr<ScopedAllocatorMgr> scoped_allocator_mgr_;
+
+  // Tunes the intra-op parallelism of kernels if
+  // TF_AUTOTUNE_INTRA_OP_PARALLELISM is set, nullptr otherwise.
+  std::unique_ptr<IntraOpParallelismTuner> parallelism_tuner_;
+  // The file that the tuned settings are loaded from, and saved to when the
+  // device is destroyed. Set by TF_INTRA_OP_PARALLELISM_TUNING_FILE.
+  string parallelism_tuning_file_;
 };
 
 }  // namespace tensorflow
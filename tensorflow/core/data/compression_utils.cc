@@ -14,15 +14,53 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/platform/snappy.h"
 
 namespace tensorflow {
 namespace data {
+namespace {
+
+// Elements whose snappy-compressed size is above this fraction of their
+// uncompressed size are stored uncompressed.
+constexpr double kMaxCompressedFraction = 0.875;
+
+// Deserializes the components of `compressed` which are stored as tensor
+// protos, from `tensor_proto_strs`, into `out`.
+Status ParseNonMemcpyComponents(const CompressedElement& compressed,
+                                const std::vector<tstring>& tensor_proto_strs,
+                                std::vector<Tensor>* out) {
+  int tensor_proto_strs_index = 0;
+  for (int i = 0; i < compressed.component_metadata_size(); ++i) {
+    if (DataTypeCanUseMemcpy(compressed.component_metadata(i).dtype())) {
+      continue;
+    }
+    TensorProto tp;
+    if (!tp.ParseFromString(tensor_proto_strs[tensor_proto_strs_index++])) {
+      return errors::Internal("Could not parse TensorProto");
+    }
+    if (!out->at(i).FromProto(tp)) {
+      return errors::Internal("Could not parse Tensor");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+constexpr int64 ElementCompressor::kMinElementsToSkip;
+constexpr int64 ElementCompressor::kMaxElementsToSkip;
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, /*try_compression=*/true, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element,
+                       bool try_compression, CompressedElement* out) {
   // Step 1: Determine the total uncompressed size. This requires serializing
   // non-memcopyable tensors, which we save to use again later.
   std::vector<TensorProto> non_memcpy_components;
@@ -39,12 +77,20 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
   }
 
-  // Step 2: Write the tensor data to a buffer, and compress that buffer.
+  // Step 2: Write the tensor data to a buffer, and compress that buffer. When
+  // not compressing, the tensor data is written to the output directly.
   // We use tstring for access to resize_uninitialized.
   tstring uncompressed;
-  uncompressed.resize_uninitialized(total_size);
-  // Position in `uncompressed` to write the next component.
-  char* position = uncompressed.mdata();
+  char* begin;
+  if (try_compression) {
+    uncompressed.resize_uninitialized(total_size);
+    begin = uncompressed.mdata();
+  } else {
+    out->mutable_data()->resize(total_size);
+    begin = &(*out->mutable_data())[0];
+  }
+  // Position in the buffer to write the next component.
+  char* position = begin;
   int non_memcpy_component_index = 0;
   for (auto& component : element) {
     CompressedComponentMetadata* metadata =
@@ -62,14 +108,49 @@ Status CompressElement(const std::vector<Tensor>& element,
     }
     position += metadata->tensor_size_bytes();
   }
-  DCHECK_EQ(position, uncompressed.mdata() + total_size);
+  DCHECK_EQ(position, begin + total_size);
 
+  if (!try_compression) {
+    out->set_compression(CompressedElement::NONE);
+    return Status::OK();
+  }
   if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
                              out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
+  if (out->data().size() > kMaxCompressedFraction * total_size) {
+    VLOG(3) << "Storing element of " << total_size << " bytes uncompressed, "
+            << "since it compressed only to " << out->data().size() << " bytes";
+    out->set_data(uncompressed.data(), total_size);
+    out->set_compression(CompressedElement::NONE);
+    return Status::OK();
+  }
   VLOG(3) << "Compressed element from " << total_size << " bytes to "
           << out->data().size() << " bytes";
+  out->set_compression(CompressedElement::SNAPPY);
+  return Status::OK();
+}
+
+Status ElementCompressor::Compress(const std::vector<Tensor>& element,
+                                   CompressedElement* out) {
+  bool try_compression;
+  {
+    mutex_lock l(mu_);
+    try_compression = num_elements_to_skip_ == 0;
+    if (!try_compression) {
+      --num_elements_to_skip_;
+    }
+  }
+  TF_RETURN_IF_ERROR(CompressElement(element, try_compression, out));
+  if (try_compression) {
+    mutex_lock l(mu_);
+    if (out->compression() == CompressedElement::NONE) {
+      num_elements_to_skip_ = next_skip_length_;
+      next_skip_length_ = std::min(2 * next_skip_length_, kMaxElementsToSkip);
+    } else {
+      next_skip_length_ = kMinElementsToSkip;
+    }
+  }
   return Status::OK();
 }
 
@@ -111,6 +192,22 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
+  if (compressed.compression() == CompressedElement::NONE) {
+    if (compressed_data.size() != static_cast<size_t>(total_size)) {
+      return errors::Internal("Uncompressed size mismatch. The element has ",
+                              compressed_data.size(),
+                              " bytes whereas the tensor metadata suggests ",
+                              total_size);
+    }
+    const char* position = compressed_data.data();
+    for (const struct iovec& component_iov : iov) {
+      if (component_iov.iov_len > 0) {
+        memcpy(component_iov.iov_base, position, component_iov.iov_len);
+      }
+      position += component_iov.iov_len;
+    }
+    return ParseNonMemcpyComponents(compressed, tensor_proto_strs, out);
+  }
   size_t uncompressed_size;
   if (!port::Snappy_GetUncompressedLength(
           compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
@@ -128,20 +225,7 @@ Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
-  int tensor_proto_strs_index = 0;
-  for (int i = 0; i < num_components; ++i) {
-    if (DataTypeCanUseMemcpy(compressed.component_metadata(i).dtype())) {
-      continue;
-    }
-    TensorProto tp;
-    if (!tp.ParseFromString(tensor_proto_strs[tensor_proto_strs_index++])) {
-      return errors::Internal("Could not parse TensorProto");
-    }
-    if (!out->at(i).FromProto(tp)) {
-      return errors::Internal("Could not parse Tensor");
-    }
-  }
-  return Status::OK();
+  return ParseNonMemcpyComponents(compressed, tensor_proto_strs, out);
 }
 
 }  // namespace data
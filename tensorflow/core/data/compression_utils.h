@@ -17,7 +17,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/data/dataset.pb.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 namespace data {
@@ -25,14 +27,40 @@ namespace data {
 // Compresses the components of `element` into the `CompressedElement` proto.
 //
 // In addition to writing the actual compressed bytes, `Compress` fills
-// out the per-component metadata for the `CompressedElement`.
+// out the per-component metadata for the `CompressedElement`. If compressing
+// the bytes does not make them meaningfully smaller, or if `try_compression`
+// is false, the bytes are stored uncompressed, with the `NONE` compression.
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
+Status CompressElement(const std::vector<Tensor>& element,
+                       bool try_compression, CompressedElement* out);
 
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
 
+// Compresses the elements of a dataset, skipping the compression of elements
+// while the data does not compress. This saves the CPU time of compressing and
+// uncompressing incompressible data, such as encoded images. After an element
+// fails to compress, the following `kMinElementsToSkip` elements are stored
+// uncompressed, and each further failure doubles the number of elements to
+// skip, up to `kMaxElementsToSkip`. Thread-safe.
+class ElementCompressor {
+ public:
+  static constexpr int64 kMinElementsToSkip = 16;
+  static constexpr int64 kMaxElementsToSkip = 1024;
+
+  Status Compress(const std::vector<Tensor>& element, CompressedElement* out);
+
+ private:
+  mutex mu_;
+  // The number of elements to store uncompressed before trying to compress
+  // again.
+  int64 num_elements_to_skip_ TF_GUARDED_BY(mu_) = 0;
+  // The number of elements to skip after the next failure to compress.
+  int64 next_skip_length_ TF_GUARDED_BY(mu_) = kMinElementsToSkip;
+};
+
 }  // namespace data
 }  // namespace tensorflow
 
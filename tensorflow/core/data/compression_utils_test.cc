@@ -35,6 +35,18 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, UncompressedRoundTrip) {
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(
+      CompressElement(element, /*try_compression=*/false, &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64>(TensorShape{1}, {{1}}),             // int64
@@ -49,5 +61,60 @@ std::vector<std::vector<Tensor>> TestCases() {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+// Returns an element of pseudo-random bytes, which snappy cannot compress.
+std::vector<Tensor> IncompressibleElement() {
+  Tensor tensor(DT_UINT8, TensorShape({4096}));
+  auto values = tensor.flat<uint8>();
+  uint32 state = 1;
+  for (int i = 0; i < values.size(); ++i) {
+    state = state * 1664525 + 1013904223;
+    values(i) = state >> 24;
+  }
+  return {tensor};
+}
+
+std::vector<Tensor> CompressibleElement() {
+  Tensor tensor(DT_UINT8, TensorShape({4096}));
+  tensor.flat<uint8>().setZero();
+  return {tensor};
+}
+
+TEST(CompressionUtilsTest, IncompressibleElementIsStoredUncompressed) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(IncompressibleElement(), &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+      IncompressibleElement(), round_trip_element, /*compare_order=*/true));
+
+  TF_ASSERT_OK(CompressElement(CompressibleElement(), &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::SNAPPY);
+  EXPECT_LT(compressed.data().size(), 4096);
+}
+
+TEST(CompressionUtilsTest, ElementCompressorSkipsIncompressibleData) {
+  ElementCompressor compressor;
+  CompressedElement compressed;
+  TF_ASSERT_OK(compressor.Compress(IncompressibleElement(), &compressed));
+  EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  // The compressor doesn't try to compress the following elements.
+  for (int i = 0; i < ElementCompressor::kMinElementsToSkip; ++i) {
+    compressed.Clear();
+    TF_ASSERT_OK(compressor.Compress(CompressibleElement(), &compressed));
+    EXPECT_EQ(compressed.compression(), CompressedElement::NONE);
+  }
+  // Once the data compresses again, the compressor keeps compressing it.
+  for (int i = 0; i < 2; ++i) {
+    compressed.Clear();
+    TF_ASSERT_OK(compressor.Compress(CompressibleElement(), &compressed));
+    EXPECT_EQ(compressed.compression(), CompressedElement::SNAPPY);
+  }
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+      CompressibleElement(), round_trip_element, /*compare_order=*/true));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -176,6 +176,28 @@ Status DataServiceWorkerClient::GetElement(int64 task_id,
   return Status::OK();
 }
 
+Status DataServiceWorkerClient::GetElements(
+    int64 task_id, int64 max_elements, std::vector<CompressedElement>* elements,
+    bool* end_of_sequence) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetElementRequest req;
+  req.set_task_id(task_id);
+  req.set_max_elements(max_elements);
+  GetElementResponse resp;
+  grpc_impl::ClientContext ctx;
+  grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get elements", s);
+  }
+  *end_of_sequence = resp.end_of_sequence();
+  elements->clear();
+  elements->reserve(resp.compressed_elements_size());
+  for (CompressedElement& element : *resp.mutable_compressed_elements()) {
+    elements->push_back(std::move(element));
+  }
+  return Status::OK();
+}
+
 Status DataServiceWorkerClient::EnsureInitialized() {
   std::shared_ptr<grpc::ChannelCredentials> credentials;
   TF_RETURN_IF_ERROR(
@@ -120,6 +120,14 @@ class DataServiceWorkerClient : public DataServiceClientBase {
   Status GetElement(int64 task_id, CompressedElement* element,
                     bool* end_of_sequence);
 
+  // Fetches up to `max_elements` next elements for the specified task_id in a
+  // single request, and stores their compressed tensors in `*elements`. The
+  // worker only batches small elements, so fewer elements may be returned. If
+  // no element is available, `*end_of_sequence` will be `true`.
+  Status GetElements(int64 task_id, int64 max_elements,
+                     std::vector<CompressedElement>* elements,
+                     bool* end_of_sequence);
+
  protected:
   Status EnsureInitialized() override;
 
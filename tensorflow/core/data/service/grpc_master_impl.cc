@@ -40,6 +40,7 @@ GrpcMasterImpl::GrpcMasterImpl(ServerBuilder* server_builder,
   }
 HANDLER(RegisterWorker);
 HANDLER(WorkerUpdate);
+HANDLER(GetSplit);
 HANDLER(GetOrRegisterDataset);
 HANDLER(CreateJob);
 HANDLER(GetOrCreateJob);
@@ -44,6 +44,7 @@ class GrpcMasterImpl : public MasterService::Service {
                       method##Response* response) override;
   HANDLER(RegisterWorker);
   HANDLER(WorkerUpdate);
+  HANDLER(GetSplit);
   HANDLER(GetOrRegisterDataset);
   HANDLER(CreateJob);
   HANDLER(GetOrCreateJob);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/master_impl.h"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/public/session_options.h"
 
@@ -39,6 +41,12 @@ namespace tensorflow {
 namespace data {
 
 namespace {
+// The number of splits per registered worker that a ONE_EPOCH job divides its
+// dataset into. More splits balance the load between fast and slow workers
+// better, at the cost of more split requests and, for datasets that can only be
+// split by their elements, of more redundant upstream processing.
+constexpr int64 kSplitsPerWorker = 4;
+
 Status CreateWorkerStub(const std::string& address,
                         const std::string& protocol_,
                         std::unique_ptr<WorkerService::Stub>* stub) {
@@ -79,6 +87,7 @@ Status DataServiceMasterImpl::RegisterWorker(
     task_def->set_dataset_id(job->dataset_id());
     task_def->set_job_id(job->job_id());
     task_def->set_task_id(task.task_id());
+    task_def->set_num_splits(job->num_splits());
   }
 
   VLOG(1) << "Registered worker at address " << request->worker_address()
@@ -106,6 +115,61 @@ Status DataServiceMasterImpl::WorkerUpdate(const WorkerUpdateRequest* request,
   return Status::OK();
 }
 
+Status DataServiceMasterImpl::GetSplit(const GetSplitRequest* request,
+                                       GetSplitResponse* response) {
+  mutex_lock l(mu_);
+  int64 task_id = request->task_id();
+  auto it = tasks_.find(task_id);
+  if (it == tasks_.end()) {
+    return errors::NotFound("GetSplit failed. Task id <", task_id,
+                            "> not found.");
+  }
+  int64 job_id = it->second.job_id();
+  DCHECK(jobs_.contains(job_id));
+  std::shared_ptr<Job> job = jobs_.at(job_id);
+  if (job->num_splits() == 0) {
+    return errors::FailedPrecondition(
+        "GetSplit failed. Task <", task_id, "> belongs to job <", job_id,
+        ">, which does not divide its dataset into splits.");
+  }
+  int64 split_index;
+  bool end_of_splits;
+  job->GetNextSplit(task_id, Env::Default()->NowMicros(), &split_index,
+                    &end_of_splits);
+  if (end_of_splits) {
+    VLOG(3) << "No splits left for task " << task_id << " of job " << job_id;
+  } else {
+    VLOG(3) << "Handing out split " << split_index << " of job " << job_id
+            << " to task " << task_id;
+    response->set_split_index(split_index);
+  }
+  response->set_end_of_splits(end_of_splits);
+  return Status::OK();
+}
+
+void DataServiceMasterImpl::Job::GetNextSplit(int64 task_id, int64 now_micros,
+                                              int64* split_index,
+                                              bool* end_of_splits) {
+  SplitStats& stats = split_stats_[task_id];
+  if (stats.split_start_micros >= 0) {
+    ++stats.num_splits;
+    stats.processing_micros += now_micros - stats.split_start_micros;
+    stats.split_start_micros = -1;
+  }
+  *end_of_splits = next_split_ >= num_splits_;
+  if (*end_of_splits) {
+    if (stats.num_splits > 0) {
+      VLOG(1) << "Task " << task_id << " of job " << job_id_ << " processed "
+              << stats.num_splits << " of " << num_splits_ << " splits, taking "
+              << stats.processing_micros / stats.num_splits
+              << " microseconds per split";
+    }
+    return;
+  }
+  *split_index = next_split_++;
+  stats.split_start_micros = now_micros;
+}
+
 Status DataServiceMasterImpl::GetOrRegisterDataset(
     const GetOrRegisterDatasetRequest* request,
     GetOrRegisterDatasetResponse* response) {
@@ -220,11 +284,8 @@ Status DataServiceMasterImpl::CreateJob(int64 dataset_id,
                                         int64* out_job_id) LOCKS_EXCLUDED(mu_) {
   switch (processing_mode) {
     case ProcessingMode::PARALLEL_EPOCHS:
-      break;
     case ProcessingMode::ONE_EPOCH:
-      return errors::Unimplemented(
-          "CreateJob only supports the PARALLEL_EPOCHS job mode. "
-          "ONE_EPOCH is not currently supported.");
+      break;
     default:
       return errors::Unimplemented("ProcessingMode ",
                                    ProcessingModeToString(processing_mode),
@@ -240,7 +301,12 @@ Status DataServiceMasterImpl::CreateJob(int64 dataset_id,
 
     int64 job_id = next_job_id_++;
     DCHECK(!jobs_.contains(job_id));
-    job = std::make_shared<Job>(job_id, dataset_id, processing_mode, job_name);
+    int64 num_splits = 0;
+    if (processing_mode == ProcessingMode::ONE_EPOCH) {
+      num_splits = kSplitsPerWorker * std::max<int64>(1, workers_.size());
+    }
+    job = std::make_shared<Job>(job_id, dataset_id, processing_mode, job_name,
+                                num_splits);
     jobs_[job_id] = job;
 
     // Copy workers_ so that we can iterate through the workers without holding
@@ -306,11 +372,14 @@ Status DataServiceMasterImpl::AllocateTaskToWorker(const Task& task,
   grpc::ClientContext client_ctx;
   ProcessTaskRequest req;
   req.mutable_task()->set_dataset_id(task.dataset_id());
+  req.mutable_task()->set_job_id(task.job_id());
   {
     mutex_lock l(mu_);
     DCHECK(datasets_by_id_.contains(task.dataset_id()));
     *req.mutable_task()->mutable_dataset() =
         datasets_by_id_.at(task.dataset_id())->dataset_def();
+    DCHECK(jobs_.contains(task.job_id()));
+    req.mutable_task()->set_num_splits(jobs_.at(task.job_id())->num_splits());
   }
   req.mutable_task()->set_task_id(task.task_id());
   ProcessTaskResponse resp;
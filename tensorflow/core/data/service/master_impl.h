@@ -51,6 +51,7 @@ class DataServiceMasterImpl {
                         RegisterWorkerResponse* response);
   Status WorkerUpdate(const WorkerUpdateRequest* request,
                       WorkerUpdateResponse* response);
+  Status GetSplit(const GetSplitRequest* request, GetSplitResponse* response);
 
   /// Client-facing API.
   Status GetOrRegisterDataset(const GetOrRegisterDatasetRequest* request,
@@ -106,16 +107,20 @@ class DataServiceMasterImpl {
   class Job {
    public:
     Job(int64 job_id, int64 dataset_id, ProcessingMode processing_mode,
-        absl::optional<absl::string_view> job_name)
+        absl::optional<absl::string_view> job_name, int64 num_splits)
         : job_id_(job_id),
           dataset_id_(dataset_id),
           processing_mode_(processing_mode),
-          job_name_(job_name) {}
+          job_name_(job_name),
+          num_splits_(num_splits) {}
 
     int64 job_id() const { return job_id_; }
     int64 dataset_id() const { return dataset_id_; }
     ProcessingMode processing_mode() const { return processing_mode_; }
     absl::optional<std::string> name() const { return job_name_; }
+    // The number of splits that the dataset of the job is divided into, or
+    // zero if every task processes the entire dataset.
+    int64 num_splits() const { return num_splits_; }
     const std::vector<int64>& task_ids() const { return task_ids_; }
     void add_task_id(int64 task_id) { task_ids_.push_back(task_id); }
     void task_finished(int64 task_id) {
@@ -125,12 +130,29 @@ class DataServiceMasterImpl {
       }
     }
     bool finished() const { return finished_; }
+    // Hands out the next split of the job to `task_id`, recording that the
+    // task finished its previous split at `now_micros`. Splits are handed out
+    // one at a time, so faster tasks process more of them. Sets
+    // `*end_of_splits` once all splits are handed out.
+    void GetNextSplit(int64 task_id, int64 now_micros, int64* split_index,
+                      bool* end_of_splits);
 
    private:
+    // Throughput of a task which processes splits.
+    struct SplitStats {
+      int64 num_splits = 0;
+      int64 processing_micros = 0;
+      // When the task started its current split, or -1 if it has none.
+      int64 split_start_micros = -1;
+    };
+
     const int64 job_id_;
     const int64 dataset_id_;
     const ProcessingMode processing_mode_;
     const absl::optional<std::string> job_name_;
+    const int64 num_splits_;
+    int64 next_split_ = 0;
+    absl::flat_hash_map<int64, SplitStats> split_stats_;
     std::vector<int64> task_ids_;
     std::vector<int64> finished_tasks_;
     bool finished_ = false;
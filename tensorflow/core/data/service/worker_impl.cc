@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
+
 #include "grpcpp/create_channel.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -25,7 +27,9 @@ limitations under the License.
 #include "tensorflow/core/data/service/master.grpc.pb.h"
 #include "tensorflow/core/data/service/master.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
@@ -37,12 +41,101 @@ namespace tensorflow {
 namespace data {
 
 const constexpr uint64 kHeartbeatIntervalMicros = 5ull * 1000 * 1000;
+// The element data after which the worker stops adding elements to a
+// GetElement response.
+const constexpr int64 kMaxElementBatchBytes = 1 << 20;
 
 namespace {
 auto* tf_data_service_created =
     monitoring::Gauge<bool, 0>::New("/tensorflow/data/service/created",
                                     "Whether a tf.data service server "
                                     "has been created.");
+
+constexpr char kNumSplitsNodeName[] = "data_service/num_splits";
+constexpr char kSplitIndexNodeName[] = "data_service/split_index";
+constexpr char kSplitDatasetNodeName[] = "data_service/split_dataset";
+
+// Rewrites the dataset graph `graph_def` to produce only the split
+// `split_index` out of `num_splits` splits of the dataset. The dataset is split
+// with `AutoShardDataset`, which splits file-based datasets by their files, and
+// other datasets by their elements.
+Status MakeSplitGraph(const GraphDef& graph_def, int64 num_splits,
+                      int64 split_index, GraphDef* split_graph_def) {
+  *split_graph_def = graph_def;
+  int retval_index = -1;
+  for (int i = 0; i < split_graph_def->node_size(); ++i) {
+    if (split_graph_def->node(i).op() == "_Retval") {
+      retval_index = i;
+    }
+  }
+  if (retval_index < 0) {
+    return errors::NotFound("Failed to find a _Retval op in the given dataset");
+  }
+  const TensorId output = ParseTensorName(
+      split_graph_def->node(retval_index).input(0));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kNumSplitsNodeName, "Const")
+                         .Attr("dtype", DT_INT64)
+                         .Attr("value", Tensor(num_splits))
+                         .Finalize(split_graph_def->add_node()));
+  TF_RETURN_IF_ERROR(NodeDefBuilder(kSplitIndexNodeName, "Const")
+                         .Attr("dtype", DT_INT64)
+                         .Attr("value", Tensor(split_index))
+                         .Finalize(split_graph_def->add_node()));
+  TF_RETURN_IF_ERROR(
+      NodeDefBuilder(kSplitDatasetNodeName, "AutoShardDataset")
+          .Input(string(output.node()), output.index(), DT_VARIANT)
+          .Input(kNumSplitsNodeName, 0, DT_INT64)
+          .Input(kSplitIndexNodeName, 0, DT_INT64)
+          .Attr("output_types", {DT_VARIANT})
+          .Attr("output_shapes", {TensorShape({})})
+          .Finalize(split_graph_def->add_node()));
+  split_graph_def->mutable_node(retval_index)
+      ->set_input(0, kSplitDatasetNodeName);
+  return Status::OK();
+}
+
+// Validates that `element` is a single scalar `CompressedElement` variant
+// tensor, and stores a pointer to the `CompressedElement` in `*compressed`.
+Status GetCompressedElement(std::vector<Tensor>* element,
+                            CompressedElement** compressed) {
+  if (element->size() != 1) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a single scalar variant tensor, but the "
+        "dataset produced ",
+        element->size(), " outputs");
+  }
+  Tensor& tensor = (*element)[0];
+  if (tensor.dtype() != DT_VARIANT) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a single scalar variant tensor, but "
+        "the dataset produced a tensor with type ",
+        DataTypeString(tensor.dtype()));
+  }
+  if (!TensorShapeUtils::IsScalar(tensor.shape())) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a single scalar variant tensor, but "
+        "the dataset produced a tensor with shape ",
+        tensor.shape());
+  }
+  Variant& variant = tensor.scalar<Variant>()();
+  *compressed = variant.get<CompressedElement>();
+  if (*compressed == nullptr) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a CompressedElement variant tensor, but "
+        "it produced ",
+        variant.TypeName());
+  }
+  return Status::OK();
+}
+
+Status MakeDatasetIterator(const GraphDef& graph_def,
+                           std::unique_ptr<standalone::Dataset>* dataset,
+                           std::unique_ptr<standalone::Iterator>* iterator) {
+  standalone::Dataset::Params params;
+  TF_RETURN_IF_ERROR(
+      standalone::Dataset::FromGraph(params, graph_def, dataset));
+  return (*dataset)->MakeIterator(iterator);
+}
 }  // namespace
 
 DataServiceWorkerImpl::DataServiceWorkerImpl(const std::string& master_address,
@@ -86,13 +179,14 @@ Status DataServiceWorkerImpl::ProcessTask(const ProcessTaskRequest* request,
 Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
     EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   VLOG(3) << "Received request to process task " << task_def.task_id();
-  standalone::Dataset::Params params;
   std::unique_ptr<standalone::Dataset> dataset;
-  TF_RETURN_IF_ERROR(standalone::Dataset::FromGraph(
-      params, task_def.dataset().graph(), &dataset));
-
   std::unique_ptr<standalone::Iterator> iterator;
-  TF_RETURN_IF_ERROR(dataset->MakeIterator(&iterator));
+  // Tasks which process splits create an iterator for each split, as the
+  // master hands them out.
+  if (task_def.num_splits() == 0) {
+    TF_RETURN_IF_ERROR(MakeDatasetIterator(task_def.dataset().graph(),
+                                           &dataset, &iterator));
+  }
 
   if (tasks_.contains(task_def.task_id())) {
     return errors::AlreadyExists("A task with id ", task_def.task_id(),
@@ -100,6 +194,9 @@ Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
   }
   Task& task = tasks_[task_def.task_id()];
   task.id = task_def.task_id();
+  if (task_def.num_splits() > 0) {
+    task.task_def = task_def;
+  }
   task.dataset = std::move(dataset);
   task.iterator = std::move(iterator);
   VLOG(3) << "Began processing for task " << task_def.task_id();
@@ -109,8 +206,11 @@ Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
+  const int64 max_elements = std::max<int64>(1, request->max_elements());
   bool end_of_sequence = false;
-  std::vector<tensorflow::Tensor> outputs;
+  // The produced elements, and the compressed elements that they hold.
+  std::vector<std::vector<Tensor>> elements;
+  std::vector<CompressedElement*> compressed_elements;
   {
     mutex_lock l(mu_);
     auto it = tasks_.find(request->task_id());
@@ -118,54 +218,95 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
       return errors::NotFound("DataServiceWorkerImpl::GetElement failed. ",
                               "Task id ", request->task_id(), " not found");
     }
-    std::unique_ptr<standalone::Iterator>& iter = it->second.iterator;
-    if (iter == nullptr) {
+    Task& task = it->second;
+    if (task.finished) {
       VLOG(3) << "Task " << request->task_id() << " is already finished";
       response->set_end_of_sequence(true);
       return Status::OK();
     }
-    TF_RETURN_IF_ERROR(iter->GetNext(&outputs, &end_of_sequence));
-    if (end_of_sequence) {
-      VLOG(3) << "Reached end_of_sequence for task " << request->task_id();
-      // Release iterator memory and leave a null entry as a tombstone.
-      iter.reset();
-      pending_completed_tasks_.push_back(request->task_id());
-      heartbeat_cv_.notify_one();
+    int64 num_bytes = 0;
+    while (static_cast<int64>(elements.size()) < max_elements &&
+           num_bytes < kMaxElementBatchBytes) {
+      std::vector<Tensor> outputs;
+      TF_RETURN_IF_ERROR(GetNextFromTask(&task, &outputs, &end_of_sequence));
+      if (end_of_sequence) {
+        VLOG(3) << "Reached end_of_sequence for task " << request->task_id();
+        // Release iterator memory and leave the task as a tombstone.
+        task.iterator.reset();
+        task.dataset.reset();
+        task.finished = true;
+        pending_completed_tasks_.push_back(request->task_id());
+        heartbeat_cv_.notify_one();
+        break;
+      }
+      elements.push_back(std::move(outputs));
+      CompressedElement* compressed;
+      TF_RETURN_IF_ERROR(GetCompressedElement(&elements.back(), &compressed));
+      compressed_elements.push_back(compressed);
+      num_bytes += compressed->data().size();
     }
   }
 
-  if (!end_of_sequence) {
-    VLOG(3) << "Producing an element for task " << request->task_id();
-    if (outputs.size() != 1) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but the "
-          "dataset produced ",
-          outputs.size(), " outputs");
+  VLOG(3) << "Producing " << compressed_elements.size()
+          << " elements for task " << request->task_id();
+  if (request->max_elements() == 0) {
+    if (!compressed_elements.empty()) {
+      compressed_elements[0]->Swap(response->mutable_compressed_element());
     }
-    if (outputs[0].dtype() != DT_VARIANT) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with type ",
-          DataTypeString(outputs[0].dtype()));
+  } else {
+    for (CompressedElement* compressed : compressed_elements) {
+      compressed->Swap(response->add_compressed_elements());
     }
-    if (!TensorShapeUtils::IsScalar(outputs[0].shape())) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a single scalar variant tensor, but "
-          "the dataset produced a tensor with shape ",
-          outputs[0].shape());
+  }
+  response->set_end_of_sequence(compressed_elements.empty());
+  return Status::OK();
+}
+
+Status DataServiceWorkerImpl::GetNextFromTask(Task* task,
+                                              std::vector<Tensor>* outputs,
+                                              bool* end_of_sequence)
+    EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  while (true) {
+    if (task->iterator != nullptr) {
+      TF_RETURN_IF_ERROR(task->iterator->GetNext(outputs, end_of_sequence));
+      if (!*end_of_sequence || task->task_def.num_splits() == 0) {
+        return Status::OK();
+      }
     }
-    Variant& variant = outputs[0].scalar<Variant>()();
-    CompressedElement* compressed = variant.get<CompressedElement>();
-    if (compressed == nullptr) {
-      return errors::FailedPrecondition(
-          "Expected dataset to produce a CompressedElement variant tensor, but "
-          "it produced ",
-          variant.TypeName());
+    int64 split_index;
+    bool end_of_splits;
+    TF_RETURN_IF_ERROR(GetSplit(task->id, &split_index, &end_of_splits));
+    if (end_of_splits) {
+      *end_of_sequence = true;
+      return Status::OK();
     }
-    compressed->Swap(response->mutable_compressed_element());
+    VLOG(3) << "Processing split " << split_index << " for task " << task->id;
+    GraphDef split_graph_def;
+    TF_RETURN_IF_ERROR(MakeSplitGraph(task->task_def.dataset().graph(),
+                                      task->task_def.num_splits(),
+                                      split_index, &split_graph_def));
+    // The iterator of the previous split must be destroyed before its dataset.
+    task->iterator.reset();
+    task->dataset.reset();
+    TF_RETURN_IF_ERROR(
+        MakeDatasetIterator(split_graph_def, &task->dataset, &task->iterator));
   }
-  response->set_end_of_sequence(end_of_sequence);
+}
 
+Status DataServiceWorkerImpl::GetSplit(int64 task_id, int64* split_index,
+                                       bool* end_of_splits)
+    EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  TF_RETURN_IF_ERROR(EnsureMasterStubInitialized());
+  GetSplitRequest req;
+  req.set_task_id(task_id);
+  GetSplitResponse resp;
+  grpc::ClientContext ctx;
+  grpc::Status s = master_stub_->GetSplit(&ctx, req, &resp);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get a split", s);
+  }
+  *split_index = resp.split_index();
+  *end_of_splits = resp.end_of_splits();
   return Status::OK();
 }
 
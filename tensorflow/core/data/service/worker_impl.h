@@ -56,17 +56,28 @@ class DataServiceWorkerImpl {
   Status SendTaskUpdate();
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task);
+  // Asks the master for the next split to process for the given task.
+  Status GetSplit(int64 task_id, int64* split_index, bool* end_of_splits);
   // A thread for updating the master with worker status.
   void HeartbeatThread();
 
   typedef struct Task {
     int64 id;
+    // The definition of a task which processes splits, which is needed to
+    // create an iterator for each split that the master hands out.
+    TaskDef task_def;
     // TODO(aaudibert): Have standalone::Iterator own a reference to
     // standalone::Dataset so that we don't need to store the dataset here.
     std::unique_ptr<standalone::Dataset> dataset;
     std::unique_ptr<standalone::Iterator> iterator;
+    bool finished = false;
   } Task;
 
+  // Gets the next element of a task. For a task which processes splits, this
+  // moves on to the next split when the current split is exhausted.
+  Status GetNextFromTask(Task* task, std::vector<Tensor>* outputs,
+                         bool* end_of_sequence);
+
   const std::string master_address_;
   // Protocol for communicating with the master.
   const std::string protocol_;
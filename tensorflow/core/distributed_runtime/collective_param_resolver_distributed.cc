@@ -210,10 +210,12 @@ void CollectiveParamResolverDistributed::CompleteInstanceAsync(
       });
 }
 
-bool CollectiveParamResolverDistributed::GroupIsCached(int32 group_key) {
+bool CollectiveParamResolverDistributed::GroupIsCached(
+    const string& device, const CollectiveParams& cp) {
   mutex_lock l(group_mu_);
-  const auto& it = group_table_.find(group_key);
-  return it != group_table_.end();
+  auto it = group_table_.find(cp.group.group_key);
+  return it != group_table_.end() &&
+         !GroupNeedsReform(it->second.get(), device, cp);
 }
 
 Status CollectiveParamResolverDistributed::UpdateGroupCache(
@@ -246,14 +248,23 @@ Status CollectiveParamResolverDistributed::UpdateGroupCache(
   VLOG(2) << "Group communicator_key="
           << absl::CEscape(gr->group.runtime_details.communicator_key);
   {
-    // Group membership should never change. Once a record is in group_table_
-    // it never gets removed.
+    // Group membership changes only when elastic groups are enabled, and then
+    // the previous record is retired rather than removed.
     mutex_lock l(group_mu_);
     auto it = group_table_.find(gr->group.group_key);
     if (it == group_table_.end()) {
       VLOG(2) << "UpdateGroupCache: communicator_key="
               << absl::CEscape(gr->group.runtime_details.communicator_key);
       group_table_[gr->group.group_key] = std::move(gr);
+    } else if (elastic_groups_ &&
+               it->second->group.runtime_details.communicator_key !=
+                   gr->group.runtime_details.communicator_key) {
+      VLOG(1) << "UpdateGroupCache: re-formed group_key="
+              << gr->group.group_key
+              << " group_size=" << gr->group.group_size;
+      gr->generation = it->second->generation + 1;
+      retired_groups_.push_back(std::move(it->second));
+      it->second = std::move(gr);
     } else {
       auto& previous_gr = group_table_[gr->group.group_key];
       if (previous_gr->group.runtime_details.communicator_key !=
@@ -278,7 +289,7 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
   if (group_leader_.empty()) {
     // This is the group leader, so resolution is local.
     return CompleteGroupLocal(device, cp, done);
-  } else if (!GroupIsCached(cp->group.group_key)) {
+  } else if (!GroupIsCached(device, *cp)) {
     // Need to update Group cache from the leader.
     CompleteGroupCall* call =
         new CompleteGroupCall(cp->group, device, cp->instance.type, cancel_mgr,
@@ -302,10 +313,11 @@ void CollectiveParamResolverDistributed::CompleteGroupDistributed(
   }
 }
 
-bool CollectiveParamResolverDistributed::InstanceIsCached(int32 instance_key) {
+bool CollectiveParamResolverDistributed::InstanceIsCached(const GroupRec* gr,
+                                                          int32 instance_key) {
   mutex_lock l(instance_mu_);
-  const auto& it = instance_table_.find(instance_key);
-  return it != instance_table_.end();
+  auto it = instance_table_.find(instance_key);
+  return it != instance_table_.end() && it->second->group_rec == gr;
 }
 
 void CollectiveParamResolverDistributed::UpdateInstanceCache(
@@ -371,7 +383,7 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   if (group_leader_.empty()) {
     // This is the group leader so resolution is local.
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
-  } else if (InstanceIsCached(cp->instance.instance_key)) {
+  } else if (InstanceIsCached(gr, cp->instance.instance_key)) {
     return CompleteInstanceLocal(device, gr, cp, cp->is_source, done);
   } else {
     CompleteInstanceCall* call = new CompleteInstanceCall(
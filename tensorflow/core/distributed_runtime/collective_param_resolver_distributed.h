@@ -46,11 +46,13 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                              const StatusCallback& done) override;
 
  protected:
-  // Returns true iff there's an entry for this group_key in the
-  // local group_table_.
-  bool GroupIsCached(int32 group_key) TF_LOCKS_EXCLUDED(group_mu_);
+  // Returns true iff there's an entry for cp.group.group_key in the
+  // local group_table_ that `device` can join without re-forming it.
+  bool GroupIsCached(const string& device, const CollectiveParams& cp)
+      TF_LOCKS_EXCLUDED(group_mu_);
 
-  // Updates group_table_ with contents of resp.
+  // Updates group_table_ with contents of resp.  With elastic groups, a
+  // response for a re-formed group replaces the cached group.
   Status UpdateGroupCache(const CompleteGroupResponse& resp)
       TF_LOCKS_EXCLUDED(group_mu_);
 
@@ -64,8 +66,9 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                 const GroupRecCallback& done);
 
   // Returns true iff there's an entry for this instance_key in the
-  // local instance_table_.
-  bool InstanceIsCached(int32 instance_key) TF_LOCKS_EXCLUDED(instance_mu_);
+  // local instance_table_ that was initialized for group `gr`.
+  bool InstanceIsCached(const GroupRec* gr, int32 instance_key)
+      TF_LOCKS_EXCLUDED(instance_mu_);
 
   // Updates instance_table_ with contents of resp.
   void UpdateInstanceCache(const GroupRec* gr, CollectiveParams* cp,
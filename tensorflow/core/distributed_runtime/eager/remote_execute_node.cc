@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/eager/remote_execute_node.h"
 
+#include <memory>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -23,19 +24,90 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+namespace {
+
+// The state of a node whose request was issued, which its callback needs.
+struct IssuedNode {
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  gtl::InlinedVector<TensorHandle*, 2> retvals;
+  Device* device;
+  uint64 context_view_id;
+  // Index of the response to the operation of the node.
+  int response_index;
+  StatusCallback done;
+};
+
+}  // namespace
+
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
+  std::vector<StatusCallback> dones;
+  dones.push_back(std::move(done));
+  IssueRequest({this}, std::move(dones));
+}
+
+bool RemoteExecuteNode::CanBatchWith(const AsyncRemoteExecuteNode& next) const {
+  const RemoteExecuteNode* other =
+      dynamic_cast<const RemoteExecuteNode*>(&next);
+  // Nodes with inputs on other devices may have to wait for the remote
+  // executors to sync, so they keep their own requests.
+  return other != nullptr && other->eager_client_ == eager_client_ &&
+         other->context_view_id_ == context_view_id_ &&
+         other->request_->context_id() == request_->context_id() &&
+         !needs_remote_inputs_ && !other->needs_remote_inputs_;
+}
+
+void RemoteExecuteNode::RunBatchAsync(
+    const std::vector<AsyncRemoteExecuteNode*>& nodes,
+    std::vector<StatusCallback> done) {
+  std::vector<RemoteExecuteNode*> remote_nodes;
+  remote_nodes.reserve(nodes.size());
+  for (AsyncRemoteExecuteNode* node : nodes) {
+    remote_nodes.push_back(static_cast<RemoteExecuteNode*>(node));
+  }
+  IssueRequest(remote_nodes, std::move(done));
+}
+
+void RemoteExecuteNode::IssueRequest(
+    const std::vector<RemoteExecuteNode*>& nodes,
+    std::vector<StatusCallback> done) {
   EnqueueResponse* response = new EnqueueResponse;
 
-  const gtl::InlinedVector<TensorHandle*, 4>& inputs = inputs_;
-  const gtl::InlinedVector<TensorHandle*, 2>& retvals = retvals_;
-  Device* device = device_;
+  // A single node sends its own request, and a batch the concatenation of the
+  // requests of its nodes.
+  EnqueueRequest batch_request;
+  const EnqueueRequest* request = nodes.front()->request_.get();
+  if (nodes.size() > 1) {
+    batch_request.set_context_id(request->context_id());
+    request = &batch_request;
+  }
+  auto issued = std::make_shared<std::vector<IssuedNode>>();
+  issued->reserve(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    RemoteExecuteNode* node = nodes[i];
+    int response_index = 0;
+    if (nodes.size() > 1) {
+      response_index = batch_request.queue_size();
+      for (const QueueItem& item : node->request_->queue()) {
+        *batch_request.add_queue() = item;
+      }
+    }
+    for (auto handle : node->inputs_) {
+      handle->Ref();
+    }
+    for (auto handle : node->retvals_) {
+      handle->Ref();
+    }
+    issued->push_back({node->inputs_, node->retvals_, node->device_,
+                       node->context_view_id_, response_index,
+                       std::move(done[i])});
+  }
 
   // Filled and used only when VLOG(3) is on.
   string rpc_description;
   if (VLOG_IS_ON(3)) {
     std::vector<string> ops;
-    ops.reserve(request_->queue_size());
-    for (const QueueItem& item : request_->queue()) {
+    ops.reserve(request->queue_size());
+    for (const QueueItem& item : request->queue()) {
       if (item.has_operation()) {
         ops.push_back(item.operation().name());
       } else {
@@ -49,45 +121,41 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
   }
   VLOG(3) << "Issuing: " << rpc_description;
 
-  for (auto handle : inputs_) {
-    handle->Ref();
-  }
-  for (auto handle : retvals) {
-    handle->Ref();
-  }
-
-  eager_client_->StreamingEnqueueAsync(
-      request_.get(), response,
-      [inputs, retvals, response, device, context_view_id = context_view_id_,
-       rpc_description, done](const Status& status) {
-        for (auto handle : inputs) {
-          handle->Unref();
-        }
+  nodes.front()->eager_client_->StreamingEnqueueAsync(
+      request, response,
+      [issued, response, rpc_description](const Status& status) {
         if (status.ok()) {
           VLOG(3) << "Completed successfully: " << rpc_description;
         } else {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            Status s = retvals[i]->SetRemoteShape(
-                response->queue_response(0).shape(i), device, context_view_id);
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i]
-                         << " with execute status: " << status.ToString()
-                         << " and SetRemoteShape status: " << s.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
+        for (IssuedNode& node : *issued) {
+          for (auto handle : node.inputs) {
+            handle->Unref();
+          }
+          for (size_t i = 0; i < node.retvals.size(); ++i) {
+            if (status.ok()) {
+              Status s = node.retvals[i]->SetRemoteShape(
+                  response->queue_response(node.response_index).shape(i),
+                  node.device, node.context_view_id);
+              if (!s.ok()) {
+                LOG(ERROR) << "Ignoring an error encountered when setting "
+                              "remote shape of tensor handle: "
+                           << node.retvals[i]
+                           << " with execute status: " << status.ToString()
+                           << " and SetRemoteShape status: " << s.ToString()
+                           << "\nThis should never happen. "
+                              "Please file an issue with the TensorFlow Team.";
+              }
+            } else {
+              node.retvals[i]->PoisonRemote(status, node.device,
+                                            node.context_view_id);
             }
-          } else {
-            retvals[i]->PoisonRemote(status, device, context_view_id);
+            node.retvals[i]->Unref();
           }
-          retvals[i]->Unref();
+          node.done(status);
         }
-        done(status);
         delete response;
       });
 }
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_REMOTE_EXECUTE_NODE_H_
 
 #include <cstddef>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -93,6 +94,12 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
 
   void RunAsync(StatusCallback done) override;
 
+  // Batches the remote nodes of the same context that go to the same remote
+  // worker, so that a run of queued operations takes a single request.
+  bool CanBatchWith(const AsyncRemoteExecuteNode& next) const override;
+  void RunBatchAsync(const std::vector<AsyncRemoteExecuteNode*>& nodes,
+                     std::vector<StatusCallback> done) override;
+
   Status SyncExecutors() override { return eager_context_->SyncExecutors(); }
 
   void Abort(Status status) override {
@@ -119,6 +126,11 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
   }
 
  private:
+  // Sends the requests of `nodes`, which are batchable, to their remote worker
+  // in one request, and calls `done[i]` when `nodes[i]` is done.
+  static void IssueRequest(const std::vector<RemoteExecuteNode*>& nodes,
+                           std::vector<StatusCallback> done);
+
   EagerContext* eager_context_;  // Not owned, and must outlive this node.
   std::unique_ptr<EnqueueRequest> request_;
   Device* device_;             // Not owned
@@ -43,8 +43,10 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -65,10 +67,16 @@ GraphMgr::GraphMgr(const WorkerEnv* worker_env, const DeviceMgr* device_mgr)
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  status = ReadInt64FromEnvVar("TF_GRAPH_MGR_CACHE_SIZE", 0,
+                               &max_unused_items_);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+  }
 }
 
 GraphMgr::~GraphMgr() {
   for (const auto& p : table_) p.second->Unref();
+  for (const auto& p : cache_) p.second->Unref();
 }
 
 GraphMgr::Item::~Item() {
@@ -293,12 +301,53 @@ Status GraphMgr::InitItem(
   return Status::OK();
 }
 
+uint64 GraphMgr::Fingerprint(const string& handle, const GraphDef& gdef,
+                             const GraphOptions& graph_options,
+                             const DebugOptions& debug_options,
+                             const ConfigProto& config_proto,
+                             int64 collective_graph_key) const {
+  // tfdbg publishes the decorated graphs while they are built.
+  if (!debug_options.debug_tensor_watch_opts().empty()) return 0;
+  string serialized;
+  if (!SerializeToStringDeterministic(gdef, &serialized)) return 0;
+  uint64 fingerprint = Fingerprint64(serialized);
+  fingerprint = FingerprintCat64(fingerprint, Fingerprint64(handle));
+  for (const protobuf::MessageLite* options :
+       std::vector<const protobuf::MessageLite*>{&graph_options,
+                                                 &config_proto}) {
+    if (!SerializeToStringDeterministic(*options, &serialized)) return 0;
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(serialized));
+  }
+  fingerprint = FingerprintCat64(fingerprint, collective_graph_key);
+  // 0 means "not cached".
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+
 Status GraphMgr::Register(
     const string& handle, const GraphDef& gdef, WorkerSession* session,
     const GraphOptions& graph_options, const DebugOptions& debug_options,
     const ConfigProto& config_proto, int64 collective_graph_key,
     DistributedFunctionLibraryRuntime* cluster_flr, string* graph_handle) {
-  Item* item = new Item;
+  const uint64 fingerprint =
+      Fingerprint(handle, gdef, graph_options, debug_options, config_proto,
+                  collective_graph_key);
+  Item* item = nullptr;
+  if (fingerprint != 0) {
+    mutex_lock l(mu_);
+    auto iter = cache_.find(fingerprint);
+    if (iter != cache_.end()) {
+      item = iter->second;
+      item->Ref();
+      if (item->num_handles++ == 0) unused_.erase(item->unused_pos);
+      VLOG(1) << "Reusing the executors of graph " << item->handle;
+      *graph_handle =
+          strings::Printf("%016llx", static_cast<long long>(++next_id_));
+      CHECK(table_.insert({*graph_handle, item}).second);
+      return Status::OK();
+    }
+  }
+
+  item = new Item;
   Status s = InitItem(handle, gdef, session, graph_options, debug_options,
                       config_proto, collective_graph_key, cluster_flr, item);
   if (!s.ok()) {
@@ -306,19 +355,40 @@ Status GraphMgr::Register(
     return s;
   }
 
-  // Inserts one item into table_.
+  // Inserts one item into table_, and into cache_ unless an identical graph
+  // registered concurrently was cached first.
   {
     mutex_lock l(mu_);
     *graph_handle =
         strings::Printf("%016llx", static_cast<long long>(++next_id_));
     item->handle = *graph_handle;
+    item->num_handles = 1;
     CHECK(table_.insert({*graph_handle, item}).second);
+    if (fingerprint != 0 && cache_.insert({fingerprint, item}).second) {
+      item->fingerprint = fingerprint;
+      item->Ref();
+    }
   }
   return Status::OK();
 }
 
+std::vector<GraphMgr::Item*> GraphMgr::ReleaseHandle(Item* item) {
+  std::vector<Item*> evicted;
+  if (--item->num_handles > 0 || item->fingerprint == 0) return evicted;
+  unused_.push_front(item);
+  item->unused_pos = unused_.begin();
+  while (unused_.size() > static_cast<size_t>(max_unused_items_)) {
+    Item* lru = unused_.back();
+    unused_.pop_back();
+    cache_.erase(lru->fingerprint);
+    evicted.push_back(lru);
+  }
+  return evicted;
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
+  std::vector<Item*> evicted;
   // Removes one item from table_.
   {
     mutex_lock l(mu_);
@@ -329,20 +399,27 @@ Status GraphMgr::Deregister(const string& handle) {
     }
     item = iter->second;
     table_.erase(iter);
+    evicted = ReleaseHandle(item);
   }
   item->Unref();
+  for (Item* evicted_item : evicted) evicted_item->Unref();
   return Status::OK();
 }
 
 Status GraphMgr::DeregisterAll() {
   std::vector<Item*> items;
-  // Removes all items from table_.
+  // Removes all items from table_ and cache_.
   {
     mutex_lock l(mu_);
     for (const auto& entry : table_) {
       items.push_back(entry.second);
     }
     table_.clear();
+    for (const auto& entry : cache_) {
+      items.push_back(entry.second);
+    }
+    cache_.clear();
+    unused_.clear();
   }
   for (auto item : items) {
     item->Unref();
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_GRAPH_MGR_H_
 
+#include <list>
 #include <unordered_map>
 #include <vector>
 
@@ -57,6 +58,15 @@ class WorkerSession;
 //
 // Multiple threads can call GraphMgr methods concurrently.
 //
+// Registering a graph that is identical to one already registered, i.e. with
+// the same session handle, GraphDef and options, returns a new handle to the
+// existing executors instead of building them again.  Up to
+// TF_GRAPH_MGR_CACHE_SIZE (0 by default) graphs whose handles have all been
+// deregistered are kept as well, the least recently used being evicted first,
+// so that registering the same graph again later also reuses them.  Graphs are
+// never shared between session handles, each of which owns its stateful
+// kernels.
+//
 // E.g.,
 //   GraphMgr gmgr(worker_env);
 //   string handle;
@@ -142,6 +152,16 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64 collective_graph_key;
+
+    // Fingerprint of the arguments of the Register call that built this item,
+    // or 0 if the item is not cached.
+    uint64 fingerprint = 0;
+
+    // The number of handles in table_ that refer to this item, and, when there
+    // are none and the item is cached, its entry in unused_.  Guarded by the
+    // graph_mgr's mu_.
+    int num_handles = 0;
+    std::list<Item*>::iterator unused_pos;
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
@@ -163,6 +183,27 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Table mapping fingerprints to reusable registered graphs, each of which
+  // holds one reference for this table.  unused_ lists the items without any
+  // handle, most recently deregistered first, and holds at most
+  // max_unused_items_ of them.
+  std::unordered_map<uint64, Item*> cache_ TF_GUARDED_BY(mu_);
+  std::list<Item*> unused_ TF_GUARDED_BY(mu_);
+  int64 max_unused_items_ = 0;
+
+  // Returns the fingerprint under which the graph built by these Register
+  // arguments is cached, or 0 if it must not be shared.
+  uint64 Fingerprint(const string& handle, const GraphDef& gdef,
+                     const GraphOptions& graph_options,
+                     const DebugOptions& debug_options,
+                     const ConfigProto& config_proto,
+                     int64 collective_graph_key) const;
+
+  // Drops one handle to "item", which is then kept in unused_ or evicted.
+  // Returns the items whose cache reference the caller must release.
+  std::vector<Item*> ReleaseHandle(Item* item)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   void StartParallelExecutors(const string& handle, int64 step_id, Item* item,
                               Rendezvous* rendezvous,
                               CollectiveExecutor::Handle* ce_handle,
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "grpcpp/grpcpp.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc/shm_tensor_channel.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
@@ -33,19 +36,38 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 const int kMaxWorkerRpcRetries = 10;
 
+namespace {
+
+// Whether RunGraph requests are sent on StreamingRunGraph calls, which are
+// reused across steps to save the setup of a call per step.
+bool EnableStreamingRunGraph() {
+  static const bool enabled = [] {
+    bool result;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_GRPC_WORKER_STREAMING_RUN_GRAPH",
+                                   false, &result));
+    return result;
+  }();
+  return enabled;
+}
+
+}  // namespace
+
 class GrpcRemoteWorker : public WorkerInterface {
  public:
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
                             ::grpc::CompletionQueue* completion_queue,
                             thread::ThreadPool* callback_threadpool,
-                            WorkerCacheLogger* logger, const string& target)
+                            WorkerCacheLogger* logger, const string& target,
+                            std::shared_ptr<ShmTensorReader> shm_reader)
       : channel_(std::move(channel)),
         stub_(channel_),
         cq_(completion_queue),
@@ -66,8 +88,11 @@ class GrpcRemoteWorker : public WorkerInterface {
         instancesource_(Method(GrpcWorkerMethod::kCompleteInstance)),
         getstepsequence_(Method(GrpcWorkerMethod::kGetStepSequence)),
         markrecvfinished_(Method(GrpcWorkerMethod::kMarkRecvFinished)),
+        multirecvtensor_(Method(GrpcWorkerMethod::kMultiRecvTensor)),
+        streamingrungraph_(Method(GrpcWorkerMethod::kStreamingRunGraph)),
         logger_(logger),
-        target_(target) {}
+        target_(target),
+        shm_reader_(std::move(shm_reader)) {}
 
   ~GrpcRemoteWorker() override {}
 
@@ -106,11 +131,20 @@ class GrpcRemoteWorker : public WorkerInterface {
 
   void RunGraphAsync(CallOptions* call_opts, const RunGraphRequest* request,
                      RunGraphResponse* response, StatusCallback done) override {
+    if (CanStreamRunGraph(call_opts)) {
+      StreamRunGraph(call_opts, *request, response, std::move(done));
+      return;
+    }
     IssueRequest(request, response, rungraph_, std::move(done), call_opts);
   }
   void RunGraphAsync(CallOptions* call_opts, RunGraphRequestWrapper* request,
                      MutableRunGraphResponseWrapper* response,
                      StatusCallback done) override {
+    if (CanStreamRunGraph(call_opts)) {
+      StreamRunGraph(call_opts, request->ToProto(),
+                     get_proto_from_wrapper(response), std::move(done));
+      return;
+    }
     IssueRequest(&request->ToProto(), get_proto_from_wrapper(response),
                  rungraph_, std::move(done), call_opts);
   }
@@ -200,9 +234,19 @@ class GrpcRemoteWorker : public WorkerInterface {
     int64 start_usec = Env::Default()->NowMicros();
     // Type-specialized logging for this method.
     bool logging_active = logger_->LoggingActive() || VLOG_IS_ON(2);
-
-    auto callback = [this, request, response, done, start_usec,
-                     logging_active](Status s) {
+    // Spans the wait for the tensor. The step id and rendezvous key correlate
+    // it with the sender's RecvTensorService activity.
+    const uint64 activity_id = profiler::TraceMe::ActivityStart(
+        [request] {
+          return profiler::TraceMeEncode(
+              "RecvTensor", {{"id", request->step_id()},
+                             {"rendezvous_key", request->rendezvous_key()}});
+        },
+        profiler::TraceMeLevel::kInfo);
+
+    auto callback = [this, request, response, done, start_usec, logging_active,
+                     activity_id](Status s) {
+      profiler::TraceMe::ActivityEnd(activity_id);
       if (logging_active) {
         if (logger_->LoggingActive()) {
           int64 end_usec = Env::Default()->NowMicros();
@@ -252,9 +296,45 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
+    if (shm_reader_ != nullptr && !request->has_transport_options() &&
+        response->CanReadContentOnHost()) {
+      // The request is serialized before IssueRequest() returns.
+      RecvTensorRequest shm_request(*request);
+      shm_reader_->AddRequestOptions(&shm_request);
+      response->set_content_reader(
+          [shm_reader = shm_reader_](const RecvTensorResponse& metadata,
+                                     Tensor* tensor) {
+            return shm_reader->ReadContent(metadata, tensor);
+          });
+      IssueRequest(&shm_request, response, recvtensor_, callback, call_opts);
+      return;
+    }
     IssueRequest(request, response, recvtensor_, callback, call_opts);
   }
 
+  void MultiRecvTensorAsync(CallOptions* call_opts,
+                            const MultiRecvTensorRequest* request,
+                            MultiRecvTensorResponse* response,
+                            StatusCallback done) override {
+    VLOG(1) << "MultiRecvTensorAsync: " << request->request_size()
+            << " requests";
+    auto callback = [this, request, response, done](Status s) {
+      // Note done() can delete this worker object, so we need to call done()
+      // last.
+      if (s.ok()) {
+        for (int i = 0; i < response->response_size(); ++i) {
+          if (response->response(i).require_ack() &&
+              i < request->request_size()) {
+            IssueMarkRecvFinishedRequest(request->request(i).request_id());
+          }
+        }
+      }
+      done(s);
+    };
+
+    IssueRequest(request, response, multirecvtensor_, callback, call_opts);
+  }
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override {
     IssueRequest(request, response, logging_, done);
@@ -296,6 +376,54 @@ class GrpcRemoteWorker : public WorkerInterface {
     IssueRequest(&request, response, markrecvfinished_, done);
   }
 
+  // Streams do not support per-request deadlines, so requests with a timeout
+  // keep using unary calls.
+  bool CanStreamRunGraph(CallOptions* call_opts) {
+    return EnableStreamingRunGraph() &&
+           (call_opts == nullptr || call_opts->GetTimeout() <= 0);
+  }
+
+  // Sends a RunGraph request on an idle StreamingRunGraph call, or on a new
+  // one if all are busy.  A stream carries one step at a time, so that a
+  // slow step does not hold up the others, and cancelling "call_opts"
+  // cancels the whole stream, which is reopened by its next request.
+  void StreamRunGraph(CallOptions* call_opts, const RunGraphRequest& request,
+                      RunGraphResponse* response, StatusCallback done) {
+    StreamingRPCDispatcher<RunGraphResponse>* stream;
+    {
+      mutex_lock l(run_graph_streams_mu_);
+      if (idle_run_graph_streams_.empty()) {
+        run_graph_streams_.emplace_back(
+            new StreamingRPCDispatcher<RunGraphResponse>(&stub_, cq_,
+                                                         streamingrungraph_));
+        stream = run_graph_streams_.back().get();
+      } else {
+        stream = idle_run_graph_streams_.back();
+        idle_run_graph_streams_.pop_back();
+      }
+    }
+    if (call_opts != nullptr) {
+      call_opts->SetCancelCallback([stream]() { stream->CancelCall(); });
+    }
+    stream->SendNextRequest(
+        request, response,
+        [this, call_opts, stream, done = std::move(done)](const Status& s) {
+          if (call_opts != nullptr) {
+            call_opts->ClearCancelCallback();
+          }
+          {
+            mutex_lock l(run_graph_streams_mu_);
+            idle_run_graph_streams_.push_back(stream);
+          }
+          // As in RPCState, do not run `done` on the polling thread.
+          if (callback_threadpool_ != nullptr) {
+            callback_threadpool_->Schedule([done, s]() { done(s); });
+          } else {
+            done(s);
+          }
+        });
+  }
+
   // Helper function for initializing the RpcMethod objects below.
   const char* Method(GrpcWorkerMethod id) { return GrpcWorkerMethodName(id); }
 
@@ -320,21 +448,33 @@ class GrpcRemoteWorker : public WorkerInterface {
   const ::grpc::string instancesource_;
   const ::grpc::string getstepsequence_;
   const ::grpc::string markrecvfinished_;
+  const ::grpc::string multirecvtensor_;
+  const ::grpc::string streamingrungraph_;
+
+  mutex run_graph_streams_mu_;
+  std::vector<std::unique_ptr<StreamingRPCDispatcher<RunGraphResponse>>>
+      run_graph_streams_ TF_GUARDED_BY(run_graph_streams_mu_);
+  std::vector<StreamingRPCDispatcher<RunGraphResponse>*>
+      idle_run_graph_streams_ TF_GUARDED_BY(run_graph_streams_mu_);
 
   // Support for logging.
   WorkerCacheLogger* logger_;
   const string target_;
 
+  // The ring that the target writes the tensors of RecvTensor responses to,
+  // or nullptr.
+  const std::shared_ptr<ShmTensorReader> shm_reader_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcRemoteWorker);
 };
 
-WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                                     ::grpc::CompletionQueue* completion_queue,
-                                     thread::ThreadPool* callback_threadpool,
-                                     WorkerCacheLogger* logger,
-                                     const string& target) {
+WorkerInterface* NewGrpcRemoteWorker(
+    SharedGrpcChannelPtr channel, ::grpc::CompletionQueue* completion_queue,
+    thread::ThreadPool* callback_threadpool, WorkerCacheLogger* logger,
+    const string& target, std::shared_ptr<ShmTensorReader> shm_reader) {
   return new GrpcRemoteWorker(std::move(channel), completion_queue,
-                              callback_threadpool, logger, target);
+                              callback_threadpool, logger, target,
+                              std::move(shm_reader));
 }
 
 }  // namespace tensorflow
@@ -245,5 +245,29 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeMultiRecvTensorResponseToByteBuffer(
+    const std::vector<::grpc::ByteBuffer>& responses,
+    ::grpc::ByteBuffer* result) {
+  // Each response is a length-delimited MultiRecvTensorResponse::response
+  // field: a slice with its tag and length, followed by its own slices.
+  std::vector<::grpc::Slice> slices;
+  for (const ::grpc::ByteBuffer& response : responses) {
+    std::vector<::grpc::Slice> response_slices;
+    if (response.Length() > 0) {
+      (void)response.Dump(&response_slices);
+    }
+    char header[10];  // Max length of the tag and a varint32 length.
+    io::ProtoEncodeHelper e(header, sizeof(header));
+    e.WriteVarlengthBeginning(MultiRecvTensorResponse::kResponseFieldNumber,
+                              response.Length());
+    slices.emplace_back(e.data(), e.size());
+    for (::grpc::Slice& slice : response_slices) {
+      slices.push_back(std::move(slice));
+    }
+  }
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
@@ -100,4 +100,36 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, MultiRecvTensorResponse) {
+  // A small tensor, a large one whose buffer is shared, and a dead one.
+  Tensor small(DT_FLOAT, TensorShape({3}));
+  test::FillValues<float>(&small, {1, 2, 3});
+  Tensor large(DT_INT32, TensorShape({1000}));
+  test::FillIota<int32>(&large, 0);
+  std::vector<::grpc::ByteBuffer> responses(3);
+  grpc::EncodeTensorToByteBuffer(false, small, false, &responses[0]);
+  grpc::EncodeTensorToByteBuffer(false, large, true, &responses[1]);
+  grpc::EncodeTensorToByteBuffer(true, Tensor(DT_FLOAT), false, &responses[2]);
+
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeMultiRecvTensorResponseToByteBuffer(responses, &buf);
+  std::vector<::grpc::Slice> slices;
+  (void)buf.Dump(&slices);
+  string tmp;
+  for (const auto& s : slices) {
+    tmp.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+
+  MultiRecvTensorResponse response;
+  ASSERT_TRUE(response.ParseFromString(tmp));
+  ASSERT_EQ(3, response.response_size());
+  Tensor result;
+  EXPECT_TRUE(result.FromProto(response.response(0).tensor()));
+  test::ExpectTensorEqual<float>(small, result);
+  EXPECT_TRUE(result.FromProto(response.response(1).tensor()));
+  test::ExpectTensorEqual<int32>(large, result);
+  EXPECT_TRUE(response.response(1).require_ack());
+  EXPECT_TRUE(response.response(2).is_dead());
+}
+
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/rpc/shm_tensor_channel.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_logger.h"
 #include "tensorflow/core/distributed_runtime/worker_cache_partial.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
@@ -39,7 +40,13 @@ class GrpcWorkerCache : public WorkerCachePartial {
         local_worker_(local_worker),
         channel_cache_(channel_cache),
         worker_env_(worker_env),
-        next_round_robin_assignment_(0) {}
+        next_round_robin_assignment_(0) {
+    Status s = ReadInt64FromEnvVar("TF_GRPC_SHM_RING_BYTES", 0,
+                                   &shm_ring_bytes_);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+    }
+  }
 
   void ListWorkers(std::vector<string>* workers) const override {
     channel_cache_->ListWorkers(workers);
@@ -61,7 +68,8 @@ class GrpcWorkerCache : public WorkerCachePartial {
       size_t index = AssignWorkerToThread(target);
       return NewGrpcRemoteWorker(
           channel, worker_env_->GetCompletionQueue(index),
-          worker_env_->GetThreadPool(), &logger_, target);
+          worker_env_->GetThreadPool(), &logger_, target,
+          GetShmTensorReader(target));
     }
   }
 
@@ -104,6 +112,20 @@ class GrpcWorkerCache : public WorkerCachePartial {
     return it->second;
   }
 
+  // Returns the ring shared by the workers created for `target`, creating it
+  // on first use, or nullptr if shared memory transfers are disabled.
+  std::shared_ptr<ShmTensorReader> GetShmTensorReader(const string& target) {
+    if (shm_ring_bytes_ <= 0) return nullptr;
+    mutex_lock lock(shm_readers_mu_);
+    auto it = shm_readers_.find(target);
+    if (it == shm_readers_.end()) {
+      it = shm_readers_
+               .emplace(target, ShmTensorReader::Create(shm_ring_bytes_))
+               .first;
+    }
+    return it->second;
+  }
+
   const string local_target_;
   WorkerInterface* const local_worker_;  // Not owned.
   std::shared_ptr<GrpcChannelCache> channel_cache_;
@@ -114,6 +136,11 @@ class GrpcWorkerCache : public WorkerCachePartial {
   std::unordered_map<std::string, size_t> target_assignments_
       TF_GUARDED_BY(assignment_mu_);
   size_t next_round_robin_assignment_ TF_GUARDED_BY(assignment_mu_);
+
+  int64 shm_ring_bytes_ = 0;
+  mutex shm_readers_mu_;
+  std::unordered_map<string, std::shared_ptr<ShmTensorReader>> shm_readers_
+      TF_GUARDED_BY(shm_readers_mu_);
 };
 
 }  // namespace
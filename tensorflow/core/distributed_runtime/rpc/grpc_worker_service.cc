@@ -53,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/tracing.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -157,13 +158,25 @@ class GrpcWorkerServiceThread {
          ++i) {
       EnqueueRecvTensorRequestRaw();
     }
+    for (int i = 0;
+         i < gtl::FindWithDefault(
+                 queue_depth_,
+                 static_cast<int>(GrpcWorkerMethod::kMultiRecvTensor), 100);
+         ++i) {
+      EnqueueMultiRecvTensorRequestRaw();
+    }
+    // Each streaming call enqueues the next one once it is open.
+    StreamingCall<RunGraphRequest, RunGraphResponse>::EnqueueRequest(
+        worker_service_, cq_.get(),
+        &grpc::WorkerService::AsyncService::RequestStreamingRunGraph,
+        &GrpcWorkerServiceThread::StreamingRunGraphHandler);
 
     void* tag;
     bool ok;
 
     while (cq_->Next(&tag, &ok)) {
-      UntypedCall<GrpcWorkerServiceThread>::Tag* callback_tag =
-          static_cast<UntypedCall<GrpcWorkerServiceThread>::Tag*>(tag);
+      GrpcCallTag<GrpcWorkerServiceThread>* callback_tag =
+          static_cast<GrpcCallTag<GrpcWorkerServiceThread>*>(tag);
       CHECK(callback_tag);
       callback_tag->OnCompleted(this, ok);
     }
@@ -185,6 +198,12 @@ class GrpcWorkerServiceThread {
       Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
            RequestMessage, ResponseMessage>;
 
+  template <class RequestMessage, class ResponseMessage>
+  using StreamingCall =
+      ServerBidirectionalStreamingCall<GrpcWorkerServiceThread,
+                                       grpc::WorkerService::AsyncService,
+                                       RequestMessage, ResponseMessage>;
+
   // Handle all non-cancellable simple methods with a standard wrapper.
   // The boolean `may_block_on_compute_pool` indicates whether or not the
   // operation may block on activities (such as op execution) that run on the
@@ -263,6 +282,34 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RunGraph, true);
   }
 
+  // Handles one request of a StreamingRunGraph call.  The call reads the
+  // next request only once this one is answered, and is finished if it
+  // fails, so errors are best stored in the response body.
+  void StreamingRunGraphHandler(
+      StreamingCall<RunGraphRequest, RunGraphResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      ProtoRunGraphRequest* wrapped_request =
+          new ProtoRunGraphRequest(&call->request());
+      NonOwnedProtoRunGraphResponse* wrapped_response =
+          new NonOwnedProtoRunGraphResponse(call->mutable_response());
+      worker_->RunGraphAsync(call_opts, wrapped_request, wrapped_response,
+                             [call, call_opts, wrapped_request,
+                              wrapped_response](const Status& s) {
+                               delete call_opts;
+                               delete wrapped_request;
+                               delete wrapped_response;
+                               if (s.ok()) {
+                                 call->SendResponse();
+                               } else {
+                                 VLOG(1) << "Bad response from "
+                                         << "StreamingRunGraph:" << s;
+                                 call->Finish(ToGrpcStatus(s));
+                               }
+                             });
+    });
+  }
+
   void RecvTensorHandlerRaw(
       WorkerCall<RecvTensorRequest, ::grpc::ByteBuffer>* call) {
     Schedule([this, call]() {
@@ -283,6 +330,26 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void MultiRecvTensorHandlerRaw(
+      WorkerCall<MultiRecvTensorRequest, ::grpc::ByteBuffer>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+
+      worker_->GrpcMultiRecvTensorAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(1) << "Bad response from MultiRecvTensor:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    EnqueueMultiRecvTensorRequestRaw();
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -352,6 +419,19 @@ class GrpcWorkerServiceThread {
     }
   }
 
+  void EnqueueMultiRecvTensorRequestRaw() {
+    mutex_lock l(shutdown_mu_);
+    if (!is_shutdown_) {
+      Call<GrpcWorkerServiceThread, grpc::WorkerService::AsyncService,
+           MultiRecvTensorRequest, ::grpc::ByteBuffer>::
+          EnqueueRequestForMethod(
+              worker_service_, cq_.get(),
+              static_cast<int>(GrpcWorkerMethod::kMultiRecvTensor),
+              &GrpcWorkerServiceThread::MultiRecvTensorHandlerRaw,
+              true /* supports cancel*/);
+    }
+  }
+
   GrpcWorker* const worker_ = nullptr;  // Not owned.
   std::unique_ptr<::grpc::ServerCompletionQueue> cq_;
   std::unique_ptr<Thread> thread_;
@@ -445,13 +525,37 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
   const int64 request_id = request->request_id();
   const int64 step_id = request->step_id();
 
+  // Spans until the tensor is sent back, with the step id and rendezvous key
+  // of the caller's RecvTensor activity.
+  const uint64 activity_id = profiler::TraceMe::ActivityStart(
+      [request] {
+        return profiler::TraceMeEncode(
+            "RecvTensorService",
+            {{"id", request->step_id()},
+             {"rendezvous_key", request->rendezvous_key()}});
+      },
+      profiler::TraceMeLevel::kInfo);
+  done = [activity_id, done = std::move(done)](const Status& status) {
+    profiler::TraceMe::ActivityEnd(activity_id);
+    done(status);
+  };
+
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      // A cached response may be sent again, but its shared memory block can
+      // only be read once.
+      RecvTensorResponse shm_response;
+      if (!cache_enabled && !is_dead &&
+          shm_writer_.MaybeWrite(*request, tensor, &shm_response)) {
+        grpc::EncodeRecvTensorResponseToByteBuffer(shm_response, response);
+      } else {
+        grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled,
+                                       response);
+      }
     }
     done(status);
   };
@@ -555,6 +659,60 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+// GrpcMultiRecvTensorAsync: runs GrpcRecvTensorAsync() for each request, and
+// responds with the concatenation of their encoded responses.
+void GrpcWorker::GrpcMultiRecvTensorAsync(CallOptions* opts,
+                                          const MultiRecvTensorRequest* request,
+                                          ::grpc::ByteBuffer* response,
+                                          StatusCallback done) {
+  VLOG(1) << "GrpcMultiRecvTensorAsync: " << request->request_size()
+          << " requests";
+  const int num_requests = request->request_size();
+  if (num_requests == 0) {
+    grpc::EncodeMultiRecvTensorResponseToByteBuffer({}, response);
+    done(Status::OK());
+    return;
+  }
+
+  struct State {
+    explicit State(int num_requests)
+        : call_opts(new CallOptions[num_requests]),
+          responses(num_requests),
+          pending(num_requests) {}
+
+    std::unique_ptr<CallOptions[]> call_opts;
+    std::vector<::grpc::ByteBuffer> responses;
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<State>(num_requests);
+  opts->SetCancelCallback([state, num_requests]() {
+    for (int i = 0; i < num_requests; ++i) {
+      state->call_opts[i].StartCancel();
+    }
+  });
+  for (int i = 0; i < num_requests; ++i) {
+    GrpcRecvTensorAsync(
+        &state->call_opts[i], &request->request(i), &state->responses[i],
+        [opts, response, done, state](const Status& s) {
+          Status status;
+          {
+            mutex_lock l(state->mu);
+            state->status.Update(s);
+            if (--state->pending > 0) return;
+            status = state->status;
+          }
+          opts->ClearCancelCallback();
+          if (status.ok()) {
+            grpc::EncodeMultiRecvTensorResponseToByteBuffer(state->responses,
+                                                            response);
+          }
+          done(status);
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -21,6 +21,7 @@ limitations under the License.
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/rpc/shm_tensor_channel.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -46,6 +47,13 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Specialized version of MultiRecvTensor for gRPC, which shares the
+  // encodings of GrpcRecvTensorAsync() for each request.
+  virtual void GrpcMultiRecvTensorAsync(CallOptions* opts,
+                                        const MultiRecvTensorRequest* request,
+                                        ::grpc::ByteBuffer* response,
+                                        StatusCallback done);
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -65,6 +73,7 @@ class GrpcWorker : public Worker {
  private:
   std::unique_ptr<GrpcResponseCache> response_cache_;
   const int32 recv_buf_max_chunk_;
+  ShmTensorWriter shm_writer_;
 };
 
 std::unique_ptr<GrpcWorker> NewGrpcWorker(WorkerEnv* worker_env,
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -33,15 +35,27 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorCall;
+
+// A RecvTensor call waiting to be coalesced with the other calls of its step
+// to the same worker, and the callback to run once it is done.
+struct PendingRecvTensorCall {
+  RpcRecvTensorCall* call;
+  std::function<void()> recv_done;
+};
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      int64 coalescing_window_micros)
+      : BaseRemoteRendezvous(env, step_id),
+        coalescing_window_micros_(coalescing_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -51,6 +65,21 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Queues "call" until the coalescing window of its worker closes.
+  void CoalesceCall(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Starts the calls queued for "src_worker", as one RPC if there are
+  // several of them.
+  void FlushCalls(const string& src_worker);
+
+  // The most calls coalesced into one RPC.
+  static constexpr int kMaxCoalescedCalls = 256;
+
+  const int64 coalescing_window_micros_;
+  mutex coalescing_mu_;
+  std::unordered_map<string, std::vector<PendingRecvTensorCall>> pending_calls_
+      TF_GUARDED_BY(coalescing_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -133,6 +162,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
  private:
   friend class RpcRemoteRendezvous;
+  friend class RpcMultiRecvTensorCall;
 
   // Start the main RecvTensor call, checking for an async abort.
   void StartRTCall(std::function<void()> recv_done) {
@@ -185,6 +215,67 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
 
+// Issues the coalesced RecvTensor calls of a step to one worker as one
+// MultiRecvTensor RPC, and completes each of them from its response.
+class RpcMultiRecvTensorCall {
+ public:
+  explicit RpcMultiRecvTensorCall(std::vector<PendingRecvTensorCall> calls)
+      : calls_(std::move(calls)) {
+    for (const PendingRecvTensorCall& pending : calls_) {
+      *req_.add_request() = pending.call->req_;
+    }
+  }
+
+  // Starts the RPC, and deletes this object once it is done.
+  void Start() {
+    // The RPC is cancelled along with the first call.  The calls of a step
+    // are aborted together, while a call cancelled on its own still waits
+    // for the others but fails.
+    RpcRecvTensorCall* first = calls_.front().call;
+    auto abort_checked = std::make_shared<Notification>();
+    first->wi_->MultiRecvTensorAsync(
+        &first->opts_, &req_, &resp_, [this, abort_checked](const Status& s) {
+          abort_checked->WaitForNotification();
+          Done(s);
+        });
+    // See RpcRecvTensorCall::StartRTCall() for why this follows the RPC.
+    if (!first->status().ok()) {
+      first->opts_.StartCancel();
+    }
+    abort_checked->Notify();
+  }
+
+ private:
+  void Done(const Status& s) {
+    const int num_calls = calls_.size();
+    for (int i = 0; i < num_calls; ++i) {
+      RpcRecvTensorCall* call = calls_[i].call;
+      Status call_status = s;
+      if (call_status.ok() && i >= resp_.response_size()) {
+        call_status =
+            errors::Internal("MultiRecvTensor returned ", resp_.response_size(),
+                             " responses to ", num_calls, " requests");
+      }
+      if (call_status.ok()) {
+        call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+        call_status = call->resp_.InitFrom(resp_.mutable_response(i));
+      }
+      if (!call_status.ok()) {
+        mutex_lock l(call->mu_);
+        call->status_.Update(call_status);
+      }
+      calls_[i].recv_done();
+    }
+    delete this;
+  }
+
+  std::vector<PendingRecvTensorCall> calls_;
+  MultiRecvTensorRequest req_;
+  MultiRecvTensorResponse resp_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RpcMultiRecvTensorCall);
+};
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -289,7 +380,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, worker_cache]() {
+  auto recv_done = [this, call, worker_cache]() {
     // Removes "call" from active_. Prevent StartAbort().
     DeregisterCall(call);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -302,17 +393,70 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (coalescing_window_micros_ > 0) {
+    CoalesceCall(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::CoalesceCall(RpcRecvTensorCall* call,
+                                       std::function<void()> recv_done) {
+  const string src_worker = call->src_worker_;
+  bool open_window;
+  bool flush_now;
+  {
+    mutex_lock l(coalescing_mu_);
+    std::vector<PendingRecvTensorCall>& pending = pending_calls_[src_worker];
+    open_window = pending.empty();
+    pending.push_back({call, std::move(recv_done)});
+    flush_now = pending.size() >= kMaxCoalescedCalls;
+  }
+  if (open_window) {
+    Ref();
+    env_->env->SchedClosureAfter(coalescing_window_micros_,
+                                 [this, src_worker]() {
+                                   FlushCalls(src_worker);
+                                   Unref();
+                                 });
+  }
+  if (flush_now) {
+    FlushCalls(src_worker);
+  }
+}
+
+void RpcRemoteRendezvous::FlushCalls(const string& src_worker) {
+  std::vector<PendingRecvTensorCall> pending;
+  {
+    mutex_lock l(coalescing_mu_);
+    auto it = pending_calls_.find(src_worker);
+    if (it == pending_calls_.end()) return;
+    pending = std::move(it->second);
+    pending_calls_.erase(it);
+  }
+  if (pending.size() == 1) {
+    pending[0].call->Start(std::move(pending[0].recv_done));
+    return;
+  }
+  (new RpcMultiRecvTensorCall(std::move(pending)))->Start();
 }
 
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env) {
+  Status s = ReadInt64FromEnvVar("TF_RPC_RECV_COALESCING_WINDOW_MICROS", 0,
+                                 &coalescing_window_micros_);
+  if (!s.ok()) {
+    LOG(ERROR) << "Reading TF_RPC_RECV_COALESCING_WINDOW_MICROS failed: " << s;
+  }
+}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id,
+                                 coalescing_window_micros_);
 }
 
 }  // end namespace tensorflow
@@ -42,6 +42,13 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If the TF_RPC_RECV_COALESCING_WINDOW_MICROS environment variable is
+// positive, the RecvTensor calls of a step to the same worker that are issued
+// within that many microseconds of each other are coalesced into one
+// MultiRecvTensor RPC, which saves the per-RPC overhead of many small
+// tensors at the cost of that much latency.  The remote workers must
+// implement MultiRecvTensor.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
@@ -50,6 +57,8 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
   BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
 
  private:
+  int64 coalescing_window_micros_ = 0;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -66,8 +69,25 @@ class DummyWorker : public TestWorkerInterface {
       done(Status::OK());
     });
   }
+
+  // Responds to each request with its rendezvous key.
+  void MultiRecvTensorAsync(CallOptions* opts,
+                            const MultiRecvTensorRequest* request,
+                            MultiRecvTensorResponse* response,
+                            StatusCallback done) override {
+    ++num_multi_recv_tensor_calls;
+    for (const RecvTensorRequest& r : request->request()) {
+      V(r.rendezvous_key())
+          .AsProtoField(response->add_response()->mutable_tensor());
+    }
+    SchedClosure([done = std::move(done)]() { done(Status::OK()); });
+  }
+
+  static std::atomic<int> num_multi_recv_tensor_calls;
 };
 
+std::atomic<int> DummyWorker::num_multi_recv_tensor_calls(0);
+
 // Fake cache implementation for WorkerEnv.
 class DummyWorkerCache : public WorkerCacheInterface {
   void ListWorkers(std::vector<string>* workers) const override {}
@@ -100,7 +120,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return Status::OK(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -342,4 +364,49 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvCoalesced) {
+  setenv("TF_RPC_RECV_COALESCING_WINDOW_MICROS", "100000", 1);
+  RpcRendezvousMgr rmgr(&env);
+  unsetenv("TF_RPC_RECV_COALESCING_WINDOW_MICROS");
+  const int64 step_id = 123;
+  const int num_keys = 3;
+  const int num_multi_recv_tensor_calls =
+      DummyWorker::num_multi_recv_tensor_calls;
+  {
+    RemoteRendezvous* rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    mutex mu;
+    std::vector<string> keys;
+    std::vector<string> vals(num_keys);
+    Status status;
+    BlockingCounter counter(num_keys);
+    for (int i = 0; i < num_keys; ++i) {
+      keys.push_back(Rendezvous::CreateKey(
+          "/job:worker/replica:1/task:2/cpu:0", 7890,
+          "/job:mnist/replica:1/task:2/cpu:1", strings::StrCat("foo", i),
+          FrameAndIter(0, 0)));
+      rendez->RecvAsync(
+          MakeKey(keys[i]), args,
+          [&mu, &vals, &status, &counter, i](
+              const Status& s, const Rendezvous::Args&,
+              const Rendezvous::Args&, const Tensor& val, const bool) {
+            mutex_lock l(mu);
+            status.Update(s);
+            if (s.ok()) vals[i] = V(val);
+            counter.DecrementCount();
+          });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    // The three calls are answered by one RPC, each with its own tensor.
+    EXPECT_EQ(num_multi_recv_tensor_calls + 1,
+              DummyWorker::num_multi_recv_tensor_calls);
+    EXPECT_EQ(keys, vals);
+  }
+  rmgr.Cleanup(step_id);
+}
+
 }  // namespace tensorflow
@@ -0,0 +1,332 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/shm_tensor_channel.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// The region starts with a RegionHeader, padded to kAlignment bytes, which is
+// followed by the ring of blocks.  Each block is a BlockHeader followed by
+// the content of one tensor, padded to a multiple of kAlignment bytes.
+constexpr uint64 kAlignment = 64;
+constexpr uint64 kMagic = 0x7466736d72696e67;  // "tfsmring"
+
+struct RegionHeader {
+  uint64 magic;
+  uint64 capacity;
+  std::atomic<uint32> closed;
+};
+
+enum BlockState : uint32 {
+  // Reserved by the writer, which is copying the content in.
+  kWriting = 0,
+  // Holds content that the reader has not copied out yet.
+  kWritten = 1,
+  // May be reclaimed by the writer.
+  kFree = 2,
+};
+
+struct BlockHeader {
+  std::atomic<uint32> state;
+  uint32 reserved;
+  uint64 size;  // Of the whole block, header included.
+};
+
+static_assert(sizeof(RegionHeader) <= kAlignment, "RegionHeader too large");
+static_assert(std::atomic<uint32>::is_always_lock_free,
+              "Shared memory atomics must be lock-free");
+
+uint64 RoundUp(uint64 n) {
+  return (n + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+RegionHeader* GetRegionHeader(char* base) {
+  return reinterpret_cast<RegionHeader*>(base);
+}
+
+BlockHeader* GetBlockHeader(char* base, uint64 offset) {
+  return reinterpret_cast<BlockHeader*>(base + offset);
+}
+
+}  // namespace
+
+// A ring mapped by the writer.  Offsets count from the start of the region.
+class ShmTensorWriter::Ring {
+ public:
+  Ring(char* base, size_t size)
+      : base_(base),
+        size_(size),
+        begin_(kAlignment),
+        capacity_(GetRegionHeader(base)->capacity),
+        head_(0),
+        tail_(0),
+        used_(0) {}
+
+  ~Ring() {
+#if !defined(PLATFORM_WINDOWS)
+    munmap(base_, size_);
+#endif
+  }
+
+  bool closed() const {
+    return GetRegionHeader(base_)->closed.load(std::memory_order_acquire) != 0;
+  }
+
+  // Reserves a block for `num_bytes` of content.  Returns its offset, or -1
+  // if the ring has no space for it.
+  int64 Allocate(uint64 num_bytes) {
+    const uint64 block_size = RoundUp(sizeof(BlockHeader) + num_bytes);
+    mutex_lock l(mu_);
+    Reclaim();
+    if (used_ == 0) {
+      head_ = tail_ = 0;
+    } else if (head_ == tail_) {
+      return -1;
+    }
+    if (head_ >= tail_ && capacity_ - head_ < block_size) {
+      // Skip the end of the ring, unless the block does not fit at the start
+      // either.
+      if (tail_ < block_size) return -1;
+      BlockHeader* padding = GetBlockHeader(base_, begin_ + head_);
+      padding->size = capacity_ - head_;
+      padding->state.store(kFree, std::memory_order_relaxed);
+      used_ += capacity_ - head_;
+      head_ = 0;
+    } else if (head_ < tail_ && tail_ - head_ < block_size) {
+      return -1;
+    }
+    const uint64 offset = begin_ + head_;
+    BlockHeader* header = GetBlockHeader(base_, offset);
+    header->size = block_size;
+    header->state.store(kWriting, std::memory_order_relaxed);
+    head_ = (head_ + block_size) % capacity_;
+    used_ += block_size;
+    return offset;
+  }
+
+  char* base() const { return base_; }
+
+ private:
+  // Reclaims the blocks at the tail of the ring that the reader freed.
+  void Reclaim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (used_ > 0) {
+      BlockHeader* header = GetBlockHeader(base_, begin_ + tail_);
+      if (header->state.load(std::memory_order_acquire) != kFree) break;
+      const uint64 block_size = header->size;
+      tail_ = (tail_ + block_size) % capacity_;
+      used_ -= block_size;
+    }
+  }
+
+  char* const base_;
+  const size_t size_;
+  const uint64 begin_;
+  const uint64 capacity_;
+  mutex mu_;
+  // The ring holds the used_ bytes from tail_ to head_, relative to begin_.
+  uint64 head_ TF_GUARDED_BY(mu_);
+  uint64 tail_ TF_GUARDED_BY(mu_);
+  uint64 used_ TF_GUARDED_BY(mu_);
+};
+
+ShmTensorReader::ShmTensorReader(const string& region, char* base, size_t size)
+    : region_(region), base_(base), size_(size) {}
+
+std::unique_ptr<ShmTensorReader> ShmTensorReader::Create(int64 capacity) {
+#if defined(PLATFORM_WINDOWS)
+  return nullptr;
+#else
+  const uint64 rounded_capacity = RoundUp(capacity);
+  const size_t size = kAlignment + rounded_capacity;
+  const string region = strings::StrCat("/tf_recv_tensor_", getpid(), "_",
+                                        strings::Hex(random::New64()));
+  int fd = shm_open(region.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    LOG(WARNING) << "Cannot create shared memory region " << region << ": "
+                 << strerror(errno);
+    return nullptr;
+  }
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    LOG(WARNING) << "Cannot map shared memory region " << region << ": "
+                 << strerror(errno);
+    shm_unlink(region.c_str());
+    return nullptr;
+  }
+  RegionHeader* header = GetRegionHeader(static_cast<char*>(base));
+  header->capacity = rounded_capacity;
+  header->closed.store(0, std::memory_order_relaxed);
+  header->magic = kMagic;
+  VLOG(1) << "Created shared memory region " << region << " of " << size
+          << " bytes";
+  return std::unique_ptr<ShmTensorReader>(
+      new ShmTensorReader(region, static_cast<char*>(base), size));
+#endif
+}
+
+ShmTensorReader::~ShmTensorReader() {
+#if !defined(PLATFORM_WINDOWS)
+  GetRegionHeader(base_)->closed.store(1, std::memory_order_release);
+  munmap(base_, size_);
+  shm_unlink(region_.c_str());
+#endif
+}
+
+void ShmTensorReader::AddRequestOptions(RecvTensorRequest* request) const {
+  ShmRecvTensorOptions options;
+  options.set_host(port::Hostname());
+  options.set_region(region_);
+  request->mutable_transport_options()->PackFrom(options);
+}
+
+Status ShmTensorReader::ReadContent(const RecvTensorResponse& response,
+                                    Tensor* tensor) {
+  ShmTensorLocation location;
+  if (!response.transport_options().UnpackTo(&location) ||
+      location.region() != region_) {
+    return Status::OK();
+  }
+  StringPiece data = tensor->tensor_data();
+  if (location.size() != data.size() || location.offset() < kAlignment ||
+      location.offset() + sizeof(BlockHeader) + location.size() > size_) {
+    return errors::Internal("Invalid shared memory tensor location ",
+                            location.ShortDebugString(), " for a tensor of ",
+                            data.size(), " bytes");
+  }
+  BlockHeader* header = GetBlockHeader(base_, location.offset());
+  if (header->state.load(std::memory_order_acquire) != kWritten) {
+    return errors::Internal("Shared memory block at ", location.offset(),
+                            " was not written");
+  }
+  std::memcpy(const_cast<char*>(data.data()),
+              base_ + location.offset() + sizeof(BlockHeader), data.size());
+  header->state.store(kFree, std::memory_order_release);
+  return Status::OK();
+}
+
+ShmTensorWriter::ShmTensorWriter() : host_(port::Hostname()) {
+  Status s =
+      ReadInt64FromEnvVar("TF_GRPC_SHM_MIN_TENSOR_BYTES", 16384, &min_bytes_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+}
+
+ShmTensorWriter::~ShmTensorWriter() {}
+
+std::shared_ptr<ShmTensorWriter::Ring> ShmTensorWriter::GetRing(
+    const string& region) {
+  mutex_lock l(mu_);
+  auto it = rings_.find(region);
+  if (it != rings_.end()) {
+    if (it->second != nullptr && it->second->closed()) {
+      VLOG(1) << "Unmapping closed shared memory region " << region;
+      it->second.reset();
+    }
+    return it->second;
+  }
+  std::shared_ptr<Ring>& ring = rings_[region];
+#if !defined(PLATFORM_WINDOWS)
+  int fd = shm_open(region.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    VLOG(1) << "Cannot open shared memory region " << region << ": "
+            << strerror(errno);
+    return nullptr;
+  }
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size > static_cast<off_t>(kAlignment)) {
+    base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+                0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    VLOG(1) << "Cannot map shared memory region " << region;
+    return nullptr;
+  }
+  const RegionHeader* header = GetRegionHeader(static_cast<char*>(base));
+  if (header->magic != kMagic ||
+      header->capacity + kAlignment != static_cast<uint64>(st.st_size)) {
+    LOG(WARNING) << "Shared memory region " << region << " is not a ring";
+    munmap(base, st.st_size);
+    return nullptr;
+  }
+  ring = std::make_shared<Ring>(static_cast<char*>(base), st.st_size);
+#endif
+  return ring;
+}
+
+bool ShmTensorWriter::MaybeWrite(const RecvTensorRequest& request,
+                                 const Tensor& val,
+                                 RecvTensorResponse* response) {
+  ShmRecvTensorOptions options;
+  if (!request.has_transport_options() ||
+      !request.transport_options().UnpackTo(&options) ||
+      options.host() != host_ || !DataTypeCanUseMemcpy(val.dtype()) ||
+      val.TotalBytes() < static_cast<size_t>(min_bytes_)) {
+    return false;
+  }
+  std::shared_ptr<Ring> ring = GetRing(options.region());
+  if (ring == nullptr) return false;
+  StringPiece data = val.tensor_data();
+  const int64 offset = ring->Allocate(data.size());
+  if (offset < 0) {
+    VLOG(2) << "Shared memory region " << options.region() << " is full";
+    return false;
+  }
+  std::memcpy(ring->base() + offset + sizeof(BlockHeader), data.data(),
+              data.size());
+  GetBlockHeader(ring->base(), offset)
+      ->state.store(kWritten, std::memory_order_release);
+
+  response->Clear();
+  TensorProto* tensor = response->mutable_tensor();
+  tensor->set_dtype(val.dtype());
+  val.shape().AsProto(tensor->mutable_tensor_shape());
+  ShmTensorLocation location;
+  location.set_region(options.region());
+  location.set_offset(offset);
+  location.set_size(data.size());
+  response->mutable_transport_options()->PackFrom(location);
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_SHM_TENSOR_CHANNEL_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_SHM_TENSOR_CHANNEL_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// A shared memory channel for the tensor contents of RecvTensor responses
+// between two workers on the same host, which would otherwise cross the
+// loopback interface in protocol buffers.  gRPC still carries the requests
+// and the response metadata.
+//
+// The client creates, with ShmTensorReader, a POSIX shared memory ring for
+// each worker it receives tensors from, and names it in the
+// transport_options of its RecvTensorRequests.  A worker on the same host
+// that can map the ring writes large tensor contents into it with
+// ShmTensorWriter, and sends their location in the transport_options of the
+// response instead.  The client copies the content out, e.g. into the pinned
+// host memory that TensorResponse DMAs to a GPU, and frees its block.  Blocks
+// are reclaimed in the order they were written; a worker whose ring is full,
+// or that cannot map it, e.g. because it runs on another host, sends the
+// content in the response as usual.
+//
+// The gRPC worker cache creates the rings, of TF_GRPC_SHM_RING_BYTES bytes,
+// only if that variable is set.  Workers write tensors of at least
+// TF_GRPC_SHM_MIN_TENSOR_BYTES bytes (16KiB by default) to them.
+
+// The client side of the channel, which owns the ring.
+class ShmTensorReader {
+ public:
+  // Creates a ring with `capacity` bytes for tensor contents, or returns
+  // nullptr if shared memory is not available.
+  static std::unique_ptr<ShmTensorReader> Create(int64 capacity);
+
+  // Marks the ring closed, so that writers unmap it, and unlinks it.
+  ~ShmTensorReader();
+
+  // Sets the transport_options of `request` to ask for the content of the
+  // tensor in this ring.
+  void AddRequestOptions(RecvTensorRequest* request) const;
+
+  // If `response` locates the content of the tensor in this ring, copies it
+  // into `*tensor`, which has the dtype and shape of the response, and frees
+  // its block.
+  Status ReadContent(const RecvTensorResponse& response, Tensor* tensor);
+
+ private:
+  ShmTensorReader(const string& region, char* base, size_t size);
+
+  const string region_;
+  char* const base_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmTensorReader);
+};
+
+// The worker side of the channel, which writes into the rings of its
+// clients.
+class ShmTensorWriter {
+ public:
+  ShmTensorWriter();
+  ~ShmTensorWriter();
+
+  // If `request` asks for the content of the tensor in a ring that this
+  // process can map, and `val` is large enough and has space in it, writes
+  // its content to the ring and fills `response` with the metadata of the
+  // tensor and the location of its content.  Returns true if it did.
+  bool MaybeWrite(const RecvTensorRequest& request, const Tensor& val,
+                  RecvTensorResponse* response);
+
+ private:
+  class Ring;
+
+  // Returns the mapped ring named `region`, or nullptr if it cannot be
+  // mapped or was closed.
+  std::shared_ptr<Ring> GetRing(const string& region);
+
+  const string host_;
+  int64 min_bytes_ = 0;
+  mutex mu_;
+  // Maps region names to rings, or to nullptr for regions that could not be
+  // mapped.
+  std::unordered_map<string, std::shared_ptr<Ring>> rings_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShmTensorWriter);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_SHM_TENSOR_CHANNEL_H_
@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/shm_tensor_channel.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+namespace {
+
+// Sends `val` through the ring of `reader` and checks that it arrives.
+void ExpectTransferred(ShmTensorReader* reader, ShmTensorWriter* writer,
+                       const Tensor& val) {
+  RecvTensorRequest request;
+  reader->AddRequestOptions(&request);
+  RecvTensorResponse response;
+  ASSERT_TRUE(writer->MaybeWrite(request, val, &response));
+  EXPECT_TRUE(response.tensor().tensor_content().empty());
+
+  TensorShape shape(response.tensor().tensor_shape());
+  Tensor received(response.tensor().dtype(), shape);
+  TF_ASSERT_OK(reader->ReadContent(response, &received));
+  test::ExpectTensorEqual<float>(val, received);
+}
+
+TEST(ShmTensorChannelTest, TransfersLargeTensors) {
+  std::unique_ptr<ShmTensorReader> reader = ShmTensorReader::Create(1 << 20);
+  if (reader == nullptr) {
+    LOG(WARNING) << "Shared memory is not available, skipping test";
+    return;
+  }
+  ShmTensorWriter writer;
+  Tensor val(DT_FLOAT, TensorShape({64, 128}));
+  val.flat<float>().setRandom();
+  // Many more transfers than fit in the ring at once, so that blocks are
+  // reclaimed and the ring wraps around.
+  for (int i = 0; i < 100; ++i) {
+    ExpectTransferred(reader.get(), &writer, val);
+  }
+}
+
+TEST(ShmTensorChannelTest, KeepsSmallTensorsInResponse) {
+  std::unique_ptr<ShmTensorReader> reader = ShmTensorReader::Create(1 << 20);
+  if (reader == nullptr) return;
+  ShmTensorWriter writer;
+  RecvTensorRequest request;
+  reader->AddRequestOptions(&request);
+  RecvTensorResponse response;
+  Tensor val(DT_FLOAT, TensorShape({4}));
+  EXPECT_FALSE(writer.MaybeWrite(request, val, &response));
+}
+
+TEST(ShmTensorChannelTest, RequiresRequestOptions) {
+  ShmTensorWriter writer;
+  RecvTensorRequest request;
+  RecvTensorResponse response;
+  Tensor val(DT_FLOAT, TensorShape({64, 128}));
+  EXPECT_FALSE(writer.MaybeWrite(request, val, &response));
+}
+
+TEST(ShmTensorChannelTest, FallsBackWhenRingIsFull) {
+  std::unique_ptr<ShmTensorReader> reader = ShmTensorReader::Create(1 << 16);
+  if (reader == nullptr) return;
+  ShmTensorWriter writer;
+  RecvTensorRequest request;
+  reader->AddRequestOptions(&request);
+  Tensor val(DT_FLOAT, TensorShape({64, 128}));
+  val.flat<float>().setRandom();
+
+  // Two 32KiB tensors do not fit in a 64KiB ring with their block headers.
+  RecvTensorResponse first;
+  ASSERT_TRUE(writer.MaybeWrite(request, val, &first));
+  RecvTensorResponse second;
+  EXPECT_FALSE(writer.MaybeWrite(request, val, &second));
+
+  // Reading the first frees its block for the next transfer.
+  Tensor received(DT_FLOAT, val.shape());
+  TF_ASSERT_OK(reader->ReadContent(first, &received));
+  test::ExpectTensorEqual<float>(val, received);
+  ExpectTransferred(reader.get(), &writer, val);
+}
+
+TEST(ShmTensorChannelTest, IgnoresResponsesWithoutLocation) {
+  std::unique_ptr<ShmTensorReader> reader = ShmTensorReader::Create(1 << 16);
+  if (reader == nullptr) return;
+  RecvTensorResponse response;
+  Tensor received(DT_FLOAT, TensorShape({4}));
+  TF_EXPECT_OK(reader->ReadContent(response, &received));
+}
+
+}  // namespace
+}  // namespace tensorflow
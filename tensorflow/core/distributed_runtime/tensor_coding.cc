@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/platform/notification.h"
 
 namespace tensorflow {
 
@@ -30,7 +31,10 @@ void TensorResponse::Clear() {
   device_ = nullptr;
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
+  host_allocator_ = nullptr;
+  device_context_ = nullptr;
   already_used_ = false;
+  content_reader_ = nullptr;
   ClearTensor();
 }
 
@@ -48,6 +52,16 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
     on_host_ = true;
   }
   allocator_ = device_->GetAllocator(alloc_attrs_);
+  const DeviceBase::GpuDeviceInfo* gpu_device_info =
+      device_->tensorflow_gpu_device_info();
+  if (!on_host_ && gpu_device_info != nullptr &&
+      gpu_device_info->default_context != nullptr) {
+    AllocatorAttributes host_attrs;
+    host_attrs.set_on_host(true);
+    host_attrs.set_gpu_compatible(true);
+    host_allocator_ = device_->GetAllocator(host_attrs);
+    device_context_ = gpu_device_info->default_context;
+  }
 }
 
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
@@ -80,6 +94,20 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 }
 
 Status TensorResponse::ParseFrom(Source* source) {
+  if (!on_host_ && host_allocator_ != nullptr) {
+    // Parse the tensor content straight into pinned host memory, from which
+    // it is DMAed to the device, instead of into a TensorProto that
+    // MakeTensorFromProto() would copy again.
+    if (already_used_) {
+      ClearTensor();
+    }
+    already_used_ = true;
+    if (ParseFast(source, host_allocator_)) {
+      TF_RETURN_IF_ERROR(MaybeReadContent());
+      return CopyHostTensorToDevice();
+    }
+    meta_.Clear();
+  }
   if (!on_host_) {
     protobuf::io::CodedInputStream input(source->contents());
     input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
@@ -102,7 +130,7 @@ Status TensorResponse::ParseFrom(Source* source) {
     ClearTensor();
   }
   already_used_ = true;
-  if (ParseFast(source)) return Status::OK();
+  if (ParseFast(source, allocator_)) return MaybeReadContent();
   meta_.Clear();
   if (ParseSlow(source)) return Status::OK();
   return errors::InvalidArgument("Cannot parse tensor from response");
@@ -145,7 +173,8 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 }  // namespace
 
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta,
+    Allocator* allocator) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -156,7 +185,7 @@ bool TensorResponse::ParseTensorSubmessage(
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         tensor_ = std::move(t);
       }
       return ok;
@@ -196,12 +225,12 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        Tensor t(allocator, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
         // TODO(jeff,sanjay): Figure out a way to avoid this copy if
         // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
+        // and compatible with what allocator wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -216,7 +245,7 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
-bool TensorResponse::ParseFast(Source* source) {
+bool TensorResponse::ParseFast(Source* source, Allocator* allocator) {
   protobuf::io::CodedInputStream input(source->contents());
   input.SetTotalBytesLimit(INT_MAX, INT_MAX);  // Unlimited
   while (true) {
@@ -235,7 +264,8 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(&input, meta_.mutable_tensor(),
+                                   allocator)) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -277,6 +307,30 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+Status TensorResponse::MaybeReadContent() {
+  if (content_reader_ == nullptr || !meta_.has_transport_options()) {
+    return Status::OK();
+  }
+  return content_reader_(meta_, &tensor_);
+}
+
+Status TensorResponse::CopyHostTensorToDevice() {
+  Tensor host_tensor = std::move(tensor_);
+  Tensor device_tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  Notification n;
+  Status status;
+  device_context_->CopyCPUTensorToDevice(&host_tensor,
+                                         static_cast<Device*>(device_),
+                                         &device_tensor,
+                                         [&n, &status](const Status& s) {
+                                           status = s;
+                                           n.Notify();
+                                         });
+  n.WaitForNotification();
+  tensor_ = std::move(device_tensor);
+  return status;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
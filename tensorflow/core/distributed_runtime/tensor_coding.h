@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_CODING_H_
 
+#include <functional>
+
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -27,6 +29,7 @@ namespace tensorflow {
 
 class Allocator;
 class DeviceBase;
+class DeviceContext;
 class TensorProto;
 
 // TensorResponse can be used as the destination of an RPC that returns
@@ -91,17 +94,53 @@ class TensorResponse {
   // Return pointer to the device hosting the tensor.
   DeviceBase* device() const { return device_; }
 
+  // Reads into *host_tensor, which has the dtype and shape of the response,
+  // the content of a tensor that the sender handed over out of band and
+  // described in `response.transport_options()`.
+  typedef std::function<Status(const RecvTensorResponse& response,
+                               Tensor* host_tensor)>
+      ContentReader;
+
+  // Sets the reader called by ParseFrom() when the parsed response has
+  // transport_options, until the next Clear().  Only effective if
+  // CanReadContentOnHost().
+  void set_content_reader(ContentReader reader) {
+    content_reader_ = std::move(reader);
+  }
+
+  // Returns true if ParseFrom() parses the tensor into host memory, before
+  // copying it to the device if needed, so that a ContentReader can fill it.
+  bool CanReadContentOnHost() const {
+    return on_host_ || host_allocator_ != nullptr;
+  }
+
  private:
+  // The fast path allocates the tensor from "allocator" and reads the
+  // tensor content straight from the stream into it.
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
-                             TensorProto* tensor_meta);
-  bool ParseFast(Source* source);
+                             TensorProto* tensor_meta, Allocator* allocator);
+  bool ParseFast(Source* source, Allocator* allocator);
   bool ParseSlow(Source* source);
 
+  // Fills tensor_, which the fast path parsed, with content_reader_ if the
+  // response has transport_options.
+  Status MaybeReadContent();
+
+  // Copies tensor_, which the fast path parsed into host_allocator_, to
+  // device_.
+  Status CopyHostTensorToDevice();
+
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
+  // For a GPU device, the allocator of the pinned host memory the tensor
+  // content is parsed into before being copied to the device, and the
+  // context that copies it.  Otherwise nullptr.
+  Allocator* host_allocator_ = nullptr;
+  const DeviceContext* device_context_ = nullptr;
   bool already_used_ = false;
+  ContentReader content_reader_;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +158,69 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A device context that "copies to the device" with a memcpy.
+class MemcpyDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    StringPiece src = cpu_tensor->tensor_data();
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()), src.data(),
+           src.size());
+    done(Status::OK());
+  }
+
+  mutable int num_copies_ = 0;
+};
+
+// A GPU-like device, which does not implement MakeTensorFromProto().
+class DummyGpuDevice : public Device {
+ public:
+  DummyGpuDevice(Env* env, const DeviceAttributes& attr)
+      : Device(env, attr), context_(new MemcpyDeviceContext) {
+    gpu_device_info_.default_context = context_;
+    set_tensorflow_gpu_device_info(&gpu_device_info_);
+  }
+  ~DummyGpuDevice() override { context_->Unref(); }
+
+  Status Sync() override { return Status::OK(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (attr.on_host() && attr.gpu_compatible()) ++num_pinned_allocators_;
+    return cpu_allocator();
+  }
+
+  MemcpyDeviceContext* context_;
+  GpuDeviceInfo gpu_device_info_;
+  int num_pinned_allocators_ = 0;
+};
+
+TEST_F(TensorResponseTest, ParsesIntoPinnedMemoryForGpu) {
+  Tensor src(DT_FLOAT, TensorShape({2, 1000}));
+  test::FillIota<float>(&src, 1.0f);
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  DeviceAttributes attr;
+  attr.set_name("/job:a/replica:0/task:0/device:GPU:0");
+  attr.set_device_type("GPU");
+  DummyGpuDevice gpu_device(Env::Default(), attr);
+  TensorResponse response;
+  response.InitAlloc(&gpu_device, AllocatorAttributes());
+  EXPECT_EQ(1, gpu_device.num_pinned_allocators_);
+  for (int i = 0; i < 2; i++) {  // Twice so we exercise reuse of "response"
+    TF_EXPECT_OK(response.ParseFrom(&source));
+    EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+    test::ExpectTensorEqual<float>(src, response.tensor());
+    EXPECT_EQ(i + 1, gpu_device.context_->num_copies_);
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/call_options.h"
 #include "tensorflow/core/distributed_runtime/message_wrappers.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/types.h"
@@ -105,6 +106,16 @@ class WorkerInterface {
                                TensorResponse* response,
                                StatusCallback done) = 0;
 
+  // Receives the tensors of several RecvTensor requests of the same step in
+  // one call.  Implementations that do not coalesce them fail with
+  // Unimplemented.
+  virtual void MultiRecvTensorAsync(CallOptions* opts,
+                                    const MultiRecvTensorRequest* request,
+                                    MultiRecvTensorResponse* response,
+                                    StatusCallback done) {
+    done(errors::Unimplemented("MultiRecvTensorAsync()"));
+  }
+
   virtual void LoggingAsync(const LoggingRequest* request,
                             LoggingResponse* response, StatusCallback done) = 0;
 
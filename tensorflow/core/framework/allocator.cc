@@ -38,7 +38,9 @@ string AllocatorStats::DebugString() const {
       "MaxAllocSize:     %20lld\n"
       "Reserved:         %20lld\n"
       "PeakReserved:     %20lld\n"
-      "LargestFreeBlock: %20lld\n",
+      "LargestFreeBlock: %20lld\n"
+      "NumCachedAllocs:  %20lld\n"
+      "CachedFreeBytes:  %20lld\n",
       static_cast<long long>(this->bytes_limit ? *this->bytes_limit : 0),
       static_cast<long long>(this->bytes_in_use),
       static_cast<long long>(this->peak_bytes_in_use),
@@ -46,7 +48,9 @@ string AllocatorStats::DebugString() const {
       static_cast<long long>(this->largest_alloc_size),
       static_cast<long long>(this->bytes_reserved),
       static_cast<long long>(this->peak_bytes_reserved),
-      static_cast<long long>(this->largest_free_block_bytes));
+      static_cast<long long>(this->largest_free_block_bytes),
+      static_cast<long long>(this->num_cached_allocs),
+      static_cast<long long>(this->cached_free_bytes));
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -64,7 +68,8 @@ bool CPUAllocatorFullStatsEnabled() { return cpu_allocator_collect_full_stats; }
 string AllocatorAttributes::DebugString() const {
   return strings::StrCat("AllocatorAttributes(on_host=", on_host(),
                          " nic_compatible=", nic_compatible(),
-                         " gpu_compatible=", gpu_compatible(), ")");
+                         " gpu_compatible=", gpu_compatible(),
+                         " unified_memory=", unified_memory(), ")");
 }
 
 Allocator* cpu_allocator_base() {
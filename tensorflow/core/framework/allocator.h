@@ -162,6 +162,11 @@ struct AllocatorStats {
 
   int64 largest_free_block_bytes;  // Largest free block's size in heap.
 
+  // Stats for allocators that serve small requests from a cache of
+  // fixed-size blocks. `num_allocs` and `bytes_in_use` include these.
+  int64 num_cached_allocs;  // Number of allocations served from the cache.
+  int64 cached_free_bytes;  // Bytes held by the cache but not in use.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -169,7 +174,9 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        num_cached_allocs(0),
+        cached_free_bytes(0) {}
 
   std::string DebugString() const;
 };
@@ -367,6 +374,10 @@ struct AllocatorAttributes {
   bool nic_compatible() const { return value & (0x1 << 1); }
   void set_gpu_compatible(bool v) { value |= (static_cast<int>(v) << 2); }
   bool gpu_compatible() const { return value & (0x1 << 2); }
+  // Requests memory that the device can oversubscribe, e.g. CUDA unified
+  // memory for very large variables. Devices without such memory ignore it.
+  void set_unified_memory(bool v) { value |= (static_cast<int>(v) << 3); }
+  bool unified_memory() const { return value & (0x1 << 3); }
   void Merge(AllocatorAttributes other) {
     value |= other.value;
     if (scope_id != other.scope_id) {
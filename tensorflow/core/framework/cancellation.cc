@@ -28,11 +28,16 @@ const CancellationToken CancellationManager::kInvalidToken = -1;
 CancellationManager::CancellationManager()
     : is_cancelling_(false),
       is_cancelled_(false),
-      next_cancellation_token_(0) {}
+      next_cancellation_token_(0),
+      slots_closed_(false) {}
 
 CancellationManager::CancellationManager(CancellationManager* parent)
-    : is_cancelling_(false), next_cancellation_token_(0), parent_(parent) {
+    : is_cancelling_(false),
+      next_cancellation_token_(0),
+      slots_closed_(false),
+      parent_(parent) {
   is_cancelled_ = parent->RegisterChild(this);
+  slots_closed_ = is_cancelled_.load();
 }
 
 void CancellationManager::StartCancel() {
@@ -45,20 +50,24 @@ void CancellationManager::StartCancel() {
       return;
     }
     is_cancelling_ = true;
-    if (state_) {
-      std::swap(state_->callbacks, callbacks_to_run);
-
-      // Remove all children from the list of children.
-      CancellationManager* child = state_->first_child;
-      while (child != nullptr) {
-        children_to_cancel.push_front(child);
-        child->is_removed_from_parent_ = true;
-        child = child->next_sibling_;
-      }
-      state_->first_child = nullptr;
+    slots_closed_.store(true);
+    // A callback in a slot may be running below, so DeregisterCallback needs
+    // the notification to wait on.
+    if (!state_) {
+      state_ = absl::make_unique<State>();
+    }
+    std::swap(state_->callbacks, callbacks_to_run);
 
-      cancelled_notification = &state_->cancelled_notification;
+    // Remove all children from the list of children.
+    CancellationManager* child = first_child_;
+    while (child != nullptr) {
+      children_to_cancel.push_front(child);
+      child->is_removed_from_parent_ = true;
+      child = child->next_sibling_;
     }
+    first_child_ = nullptr;
+
+    cancelled_notification = &state_->cancelled_notification;
   }
   // We call these callbacks without holding mu_, so that concurrent
   // calls to DeregisterCallback, which can happen asynchronously, do
@@ -68,6 +77,7 @@ void CancellationManager::StartCancel() {
   for (auto key_and_value : callbacks_to_run) {
     key_and_value.second();
   }
+  RunSlotCallbacks();
   for (CancellationManager* child : children_to_cancel) {
     child->StartCancel();
   }
@@ -76,14 +86,86 @@ void CancellationManager::StartCancel() {
     is_cancelling_ = false;
     is_cancelled_.store(true, std::memory_order_release);
   }
-  if (cancelled_notification) {
-    cancelled_notification->Notify();
+  cancelled_notification->Notify();
+}
+
+bool CancellationManager::TryRegisterInSlot(CancellationToken token,
+                                            CancelCallback* callback,
+                                            bool* registered) {
+  CallbackSlot* slot = SlotFor(token);
+  int expected = kSlotFree;
+  if (!slot->state.compare_exchange_strong(expected, kSlotBusy,
+                                           std::memory_order_acquire)) {
+    return false;
+  }
+  slot->token.store(token, std::memory_order_relaxed);
+  std::swap(slot->callback, *callback);
+  // StartCancel() closes the slots before it runs the callbacks in them, and
+  // the registration publishes the slot before checking whether they were
+  // closed. So either StartCancel() runs the callback, or the check below sees
+  // the slots closed and takes the callback back.
+  slot->state.store(kSlotRegistered);
+  if (slots_closed_.load()) {
+    expected = kSlotRegistered;
+    if (slot->state.compare_exchange_strong(expected, kSlotBusy)) {
+      std::swap(slot->callback, *callback);
+      slot->state.store(kSlotFree, std::memory_order_release);
+      *registered = false;
+      return true;
+    }
+  }
+  *registered = true;
+  return true;
+}
+
+bool CancellationManager::TryDeregisterFromSlot(CancellationToken token) {
+  CallbackSlot* slot = SlotFor(token);
+  // Only the registered callback's owner frees its slot, so the slot can't
+  // be reused for another token while we check it.
+  if (slot->state.load(std::memory_order_acquire) != kSlotRegistered ||
+      slot->token.load(std::memory_order_relaxed) != token) {
+    return false;
+  }
+  int expected = kSlotRegistered;
+  if (!slot->state.compare_exchange_strong(expected, kSlotBusy,
+                                           std::memory_order_acquire)) {
+    // StartCancel() has taken the callback.
+    return false;
   }
+  slot->callback = nullptr;
+  slot->state.store(kSlotFree, std::memory_order_release);
+  return true;
+}
+
+void CancellationManager::RunSlotCallbacks() {
+  for (CallbackSlot& slot : callback_slots_) {
+    int expected = kSlotRegistered;
+    if (slot.state.compare_exchange_strong(expected, kSlotRunning)) {
+      CancelCallback callback;
+      std::swap(callback, slot.callback);
+      callback();
+      slot.state.store(kSlotFree, std::memory_order_release);
+    }
+  }
+}
+
+bool CancellationManager::HasSlotCallbacks() {
+  for (CallbackSlot& slot : callback_slots_) {
+    if (slot.state.load(std::memory_order_acquire) != kSlotFree) return true;
+  }
+  return false;
 }
 
 bool CancellationManager::RegisterCallback(CancellationToken token,
                                            CancelCallback callback) {
   DCHECK_LT(token, next_cancellation_token_) << "Invalid cancellation token";
+  if (slots_closed_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  bool registered;
+  if (TryRegisterInSlot(token, &callback, &registered)) {
+    return registered;
+  }
   mutex_lock l(mu_);
   bool should_register = !is_cancelled_ && !is_cancelling_;
   if (should_register) {
@@ -96,6 +178,9 @@ bool CancellationManager::RegisterCallback(CancellationToken token,
 }
 
 bool CancellationManager::DeregisterCallback(CancellationToken token) {
+  if (TryDeregisterFromSlot(token)) {
+    return true;
+  }
   mu_.lock();
   if (is_cancelled_) {
     mu_.unlock();
@@ -128,13 +213,9 @@ bool CancellationManager::RegisterChild(CancellationManager* child) {
     return true;
   }
 
-  if (!state_) {
-    state_ = absl::make_unique<State>();
-  }
-
   // Push `child` onto the front of the list of children.
-  CancellationManager* current_head = state_->first_child;
-  state_->first_child = child;
+  CancellationManager* current_head = first_child_;
+  first_child_ = child;
   child->prev_sibling_ = nullptr;
   child->next_sibling_ = current_head;
   if (current_head) {
@@ -151,12 +232,10 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
     mutex_lock l(mu_);
     if (!child->is_removed_from_parent_) {
       // Remove the child from this manager's list of children.
-      DCHECK(state_);
-
       if (child->prev_sibling_ == nullptr) {
         // The child was at the head of the list.
-        DCHECK_EQ(state_->first_child, child);
-        state_->first_child = child->next_sibling_;
+        DCHECK_EQ(first_child_, child);
+        first_child_ = child->next_sibling_;
       } else {
         child->prev_sibling_->next_sibling_ = child->next_sibling_;
       }
@@ -181,6 +260,9 @@ void CancellationManager::DeregisterChild(CancellationManager* child) {
 }
 
 bool CancellationManager::TryDeregisterCallback(CancellationToken token) {
+  if (TryDeregisterFromSlot(token)) {
+    return true;
+  }
   mutex_lock lock(mu_);
   if (is_cancelled_ || is_cancelling_) {
     return false;
@@ -196,7 +278,12 @@ CancellationManager::~CancellationManager() {
   if (parent_) {
     parent_->DeregisterChild(this);
   }
-  if (state_) {
+  bool has_callbacks;
+  {
+    mutex_lock l(mu_);
+    has_callbacks = state_ != nullptr || first_child_ != nullptr;
+  }
+  if (has_callbacks || HasSlotCallbacks()) {
     StartCancel();
   }
 }
@@ -150,12 +150,32 @@ class CancellationManager {
   struct State {
     Notification cancelled_notification;
     gtl::FlatMap<CancellationToken, CancelCallback> callbacks;
+  };
 
-    // If this CancellationManager has any children, this member points to the
-    // head of a doubly-linked list of its children.
-    CancellationManager* first_child = nullptr;  // Not owned.
+  // Most callbacks are registered and deregistered without the manager ever
+  // being cancelled. Such a callback goes into the slot indexed by its token if
+  // that slot is free, which avoids taking `mu_`. Otherwise it goes into
+  // `state_->callbacks`.
+  static constexpr int kNumCallbackSlots = 8;
+  enum SlotState : int { kSlotFree, kSlotBusy, kSlotRegistered, kSlotRunning };
+  struct CallbackSlot {
+    // A slot is written only by the thread that moved it out of kSlotFree or
+    // kSlotRegistered into kSlotBusy or kSlotRunning.
+    std::atomic<int> state{kSlotFree};
+    std::atomic<CancellationToken> token{kInvalidToken};
+    CancelCallback callback;
   };
 
+  CallbackSlot* SlotFor(CancellationToken token) {
+    return &callback_slots_[token % kNumCallbackSlots];
+  }
+  bool TryRegisterInSlot(CancellationToken token, CancelCallback* callback,
+                         bool* registered);
+  // Returns true iff `token` was in its slot and has been removed from it.
+  bool TryDeregisterFromSlot(CancellationToken token);
+  void RunSlotCallbacks();
+  bool HasSlotCallbacks();
+
   bool RegisterChild(CancellationManager* child);
   void DeregisterChild(CancellationManager* child);
 
@@ -163,6 +183,11 @@ class CancellationManager {
   std::atomic_bool is_cancelled_;
   std::atomic<CancellationToken> next_cancellation_token_;
 
+  // Set when StartCancel() begins, after which no more callbacks are
+  // registered in `callback_slots_`.
+  std::atomic_bool slots_closed_;
+  CallbackSlot callback_slots_[kNumCallbackSlots];
+
   CancellationManager* const parent_ = nullptr;  // Not owned.
 
   // If this CancellationManager is associated with a parent, this member will
@@ -180,6 +205,12 @@ class CancellationManager {
 
   mutex mu_;
   std::unique_ptr<State> state_ TF_GUARDED_BY(mu_);
+
+  // If this CancellationManager has any children, this member points to the
+  // head of a doubly-linked list of its children. It is kept outside of
+  // `state_`, so that creating a child manager doesn't allocate.
+  CancellationManager* first_child_ TF_GUARDED_BY(mu_) =
+      nullptr;  // Not owned.
 };
 
 }  // namespace tensorflow
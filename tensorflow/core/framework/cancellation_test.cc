@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <random>
 #include <vector>
@@ -196,6 +197,60 @@ TEST(Cancellation, TryDeregisterDuringCancel) {
   delete manager;
 }
 
+TEST(Cancellation, ManyCallbacks) {
+  // More callbacks than fit without taking the lock, so that some of both
+  // kinds are deregistered and some of both kinds are cancelled.
+  static const int N = 100;
+  std::vector<bool> is_cancelled(N, false);
+  CancellationManager* manager = new CancellationManager();
+  std::vector<CancellationToken> tokens;
+  for (int i = 0; i < N; ++i) {
+    tokens.push_back(manager->get_cancellation_token());
+    EXPECT_TRUE(manager->RegisterCallback(
+        tokens.back(), [&is_cancelled, i]() { is_cancelled[i] = true; }));
+  }
+  for (int i = 0; i < N; i += 2) {
+    EXPECT_TRUE(manager->DeregisterCallback(tokens[i]));
+  }
+  manager->StartCancel();
+  for (int i = 0; i < N; ++i) {
+    EXPECT_EQ(is_cancelled[i], i % 2 == 1) << i;
+  }
+  delete manager;
+}
+
+TEST(Cancellation, ConcurrentRegisterAndCancel) {
+  // Every callback is either not registered, deregistered before it runs, or
+  // run exactly once.
+  static const int kThreads = 8;
+  static const int kCallbacksPerThread = 1000;
+  for (int round = 0; round < 10; ++round) {
+    CancellationManager manager;
+    std::atomic<int> num_registered(0);
+    std::atomic<int> num_deregistered(0);
+    std::atomic<int> num_run(0);
+    {
+      thread::ThreadPool w(Env::Default(), "test", kThreads);
+      for (int t = 0; t < kThreads; ++t) {
+        w.Schedule([&]() {
+          for (int i = 0; i < kCallbacksPerThread; ++i) {
+            CancellationToken token = manager.get_cancellation_token();
+            if (!manager.RegisterCallback(token, [&num_run]() { ++num_run; })) {
+              continue;
+            }
+            ++num_registered;
+            if (i % 2 == 0 && manager.DeregisterCallback(token)) {
+              ++num_deregistered;
+            }
+          }
+        });
+      }
+      manager.StartCancel();
+    }
+    EXPECT_EQ(num_registered, num_deregistered + num_run);
+  }
+}
+
 TEST(Cancellation, Parent_CancelManyChildren) {
   CancellationManager parent;
   std::vector<std::unique_ptr<CancellationManager>> children;
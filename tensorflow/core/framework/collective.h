@@ -86,6 +86,9 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If not DT_INVALID, the lower precision data type in which a reduction of
+  // float values may be sent between devices.  Must agree across the group.
+  DataType wire_dtype = DT_INVALID;
 };
 
 // Data common to all members of a collective instance.
@@ -808,6 +808,27 @@ class DatasetBase : public core::RefCounted {
   // Returns the cardinality of this dataset.
   virtual int64 Cardinality() const { return kUnknownCardinality; }
 
+  // Sets `*num_elements` to the number of elements of a dataset whose
+  // elements can be read in any order with `Get()`. Unlike `Cardinality()`,
+  // this may read the files of the dataset, e.g. to count their records.
+  // Datasets that do not support random access return
+  // `errors::Unimplemented`.
+  virtual Status RandomAccessNumElements(IteratorContext* ctx,
+                                         int64* num_elements) const {
+    return errors::Unimplemented(DebugString(),
+                                 " does not support random access.");
+  }
+
+  // Sets `out_tensors` to the element at position `index`, which must be in
+  // `[0, n)` where `n` is set by `RandomAccessNumElements()`. This lets
+  // transformations such as a global shuffle fetch elements on demand. May be
+  // called concurrently.
+  virtual Status Get(IteratorContext* ctx, int64 index,
+                     std::vector<Tensor>* out_tensors) const {
+    return errors::Unimplemented(DebugString(),
+                                 " does not support random access.");
+  }
+
   // A human-readable debug string for this dataset.
   virtual string DebugString() const = 0;
 
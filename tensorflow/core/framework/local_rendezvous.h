@@ -62,10 +62,19 @@ class LocalRendezvous {
 
   typedef gtl::FlatMap<uint64, ItemQueue> Table;
 
-  // TODO(zhifengc): shard table_.
-  mutex mu_;
-  Table table_ TF_GUARDED_BY(mu_);
-  Status status_ TF_GUARDED_BY(mu_);
+  // Steps with many Send/Recv pairs contend on a single lock, so the table
+  // is sharded by ParsedKey::hash. Each shard records the abort status too,
+  // so that Send and Recv only take the lock of their key's shard.
+  static constexpr int kNumShards = 16;
+  struct Shard {
+    mutex mu;
+    Table table TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+
+  Shard* ShardFor(uint64 key_hash) { return &shards_[key_hash % kNumShards]; }
+
+  Shard shards_[kNumShards];
 
   TF_DISALLOW_COPY_AND_ASSIGN(LocalRendezvous);
 };
@@ -14,8 +14,13 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/framework/metrics.h"
+
+#include <atomic>
+
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -58,6 +63,38 @@ auto* graph_unused_outputs = monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* tensor_list_copies = monitoring::Counter<1>::New(
+    "/tensorflow/core/tensor_list_copies",
+    "The number of TensorLists copied because their input could not be "
+    "forwarded, by op type.",
+    "op_type");
+
+auto* tensor_list_copied_elements = monitoring::Counter<1>::New(
+    "/tensorflow/core/tensor_list_copied_elements",
+    "The number of elements in TensorLists copied because their input could "
+    "not be forwarded, by op type.",
+    "op_type");
+
+auto* op_latency_usecs = monitoring::Sampler<2>::New(
+    {"/tensorflow/core/op_latency_usecs",
+     "The wall-clock time spent executing kernels in microseconds.", "op_type",
+     "device_type"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
+std::atomic<bool>* OpLatencyRecordingEnabled() {
+  static std::atomic<bool>* enabled = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_RECORD_OP_LATENCY", false, &value);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring TF_RECORD_OP_LATENCY: " << s;
+      value = false;
+    }
+    return new std::atomic<bool>(value);
+  }();
+  return enabled;
+}
+
 auto* tf_data_autotune_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/autotune", "tf.data autotuning", "name");
 
@@ -121,6 +158,16 @@ auto* build_graph_time_usecs = monitoring::Counter<0>::New(
     "spent optimizing the graph with Grappler, and time spent pruning the "
     "sub-graph.");
 
+auto* grappler_graph_cache_lookups = monitoring::Counter<1>::New(
+    "/tensorflow/core/grappler_graph_cache_lookups",
+    "The number of lookups in the on-disk cache of Grappler-optimized graphs.",
+    "result");
+
+auto* grappler_graph_cache_saved_usecs = monitoring::Counter<0>::New(
+    "/tensorflow/core/grappler_graph_cache_saved_usecs",
+    "The amount of Grappler optimization time, in microseconds, saved by "
+    "reading optimized graphs from the on-disk cache.");
+
 auto* xla_compilations = monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilations",
     "The number of XLA compilations used to collect "
@@ -232,6 +279,17 @@ void UpdateGrapplerPassTime(const string& pass_name,
   }
 }
 
+void RecordGrapplerGraphCacheLookup(bool hit, const uint64 saved_usecs) {
+  static auto* hit_cell = grappler_graph_cache_lookups->GetCell("hit");
+  static auto* miss_cell = grappler_graph_cache_lookups->GetCell("miss");
+  if (hit) {
+    hit_cell->IncrementBy(1);
+    grappler_graph_cache_saved_usecs->GetCell()->IncrementBy(saved_usecs);
+  } else {
+    miss_cell->IncrementBy(1);
+  }
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -262,5 +320,23 @@ void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordTensorListCopy(const string& op_name, int64 num_elements) {
+  tensor_list_copies->GetCell(op_name)->IncrementBy(1);
+  tensor_list_copied_elements->GetCell(op_name)->IncrementBy(num_elements);
+}
+
+bool IsOpLatencyRecordingEnabled() {
+  return OpLatencyRecordingEnabled()->load(std::memory_order_relaxed);
+}
+
+void SetOpLatencyRecordingEnabled(bool enabled) {
+  OpLatencyRecordingEnabled()->store(enabled, std::memory_order_relaxed);
+}
+
+monitoring::SamplerCell* GetOpLatencySamplerCell(const string& op_type,
+                                                 const string& device_type) {
+  return op_latency_usecs->GetCell(op_type, device_type);
+}
+
 }  // namespace metrics
 }  // namespace tensorflow
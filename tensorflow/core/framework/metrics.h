@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_METRICS_H_
 
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -90,6 +91,25 @@ void UpdateGraphExecTime(const uint64 running_time_usecs);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that an op of type `op_name` could not update its input TensorList
+// in place and copied its `num_elements` elements into a new list instead.
+void RecordTensorListCopy(const string& op_name, int64 num_elements);
+
+// Returns whether executors record the latency of every kernel they run in
+// /tensorflow/core/op_latency_usecs. This is disabled unless the
+// TF_RECORD_OP_LATENCY environment variable is true, or it is enabled with
+// SetOpLatencyRecordingEnabled(). Executors check it when they are created.
+bool IsOpLatencyRecordingEnabled();
+void SetOpLatencyRecordingEnabled(bool enabled);
+
+// Returns a sampler that can be used to record the latency of kernels in
+// microseconds.
+//
+// The `op_type` argument identifies the op (e.g. "MatMul"), and `device_type`
+// the device it runs on (e.g. "CPU").
+monitoring::SamplerCell* GetOpLatencySamplerCell(const string& op_type,
+                                                 const string& device_type);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -111,6 +131,10 @@ void UpdateGraphOptimizationPassTime(const string& pass_name,
 void UpdateGrapplerPassTime(const string& pass_name,
                             const uint64 running_time_usecs);
 
+// Records a lookup in the on-disk cache of Grappler-optimized graphs. For a
+// hit, `saved_usecs` is the time it took to optimize the cached graph.
+void RecordGrapplerGraphCacheLookup(bool hit, const uint64 saved_usecs);
+
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
@@ -1262,16 +1262,90 @@ void Model::FlushMetrics() {
 
 void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
                      int64 ram_budget) {
-  switch (algorithm) {
+  OptimizationParams params;
+  params.algorithm = algorithm;
+  params.cpu_budget = cpu_budget;
+  params.ram_budget = ram_budget;
+  Optimize(params);
+}
+
+void Model::Optimize(const OptimizationParams& params) {
+  int64 cpu_budget = params.cpu_budget;
+  const int64 step_threads =
+      std::max(params.inter_op_threads, params.intra_op_threads);
+  if (step_threads > 0) {
+    cpu_budget = std::max<int64>(1, cpu_budget - step_threads);
+    VLOG(2) << "Reserving " << params.cpu_budget - cpu_budget
+            << " out of " << params.cpu_budget
+            << " cores for the threads of the step";
+  }
+  switch (params.algorithm) {
     case AutotuneAlgorithm::HILL_CLIMB:
-      OptimizeHillClimb(cpu_budget, ram_budget);
+      OptimizeHillClimb(cpu_budget, params.ram_budget);
       break;
     case AutotuneAlgorithm::GRADIENT_DESCENT:
-      OptimizeGradientDescent(cpu_budget, ram_budget);
+      OptimizeGradientDescent(cpu_budget, params.ram_budget);
       break;
   }
 }
 
+absl::flat_hash_map<string, double> Model::GetTunableParameterValues() {
+  std::shared_ptr<Node> output;
+  {
+    tf_shared_lock l(mu_);
+    output = output_;
+  }
+  absl::flat_hash_map<string, double> values;
+  if (!output) {
+    return values;
+  }
+  for (auto& pair : CollectTunableParameters(output)) {
+    const std::shared_ptr<Parameter>& parameter = pair.second;
+    mutex_lock l(*parameter->state->mu);
+    values[strings::StrCat(pair.first, ":", parameter->name)] =
+        parameter->state->value;
+  }
+  return values;
+}
+
+void Model::FreezeParameters(
+    const absl::flat_hash_map<string, double>& values) {
+  mutex_lock l(mu_);
+  for (const auto& pair : values) {
+    frozen_parameters_[pair.first] = pair.second;
+  }
+}
+
+void Model::ApplyFrozenParameters(
+    absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters) {
+  absl::flat_hash_map<string, double> frozen_parameters;
+  {
+    tf_shared_lock l(mu_);
+    if (frozen_parameters_.empty()) return;
+    frozen_parameters = frozen_parameters_;
+  }
+  std::vector<string> frozen_keys;
+  for (auto& pair : *parameters) {
+    auto& parameter = pair.second;
+    auto it = frozen_parameters.find(
+        strings::StrCat(pair.first, ":", parameter->name));
+    if (it == frozen_parameters.end()) {
+      continue;
+    }
+    parameter->value =
+        std::min(parameter->max, std::max(parameter->min, it->second));
+    VLOG(2) << "Setting frozen parameter " << pair.first << " to "
+            << parameter->value;
+    mutex_lock l(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+    frozen_keys.push_back(pair.first);
+  }
+  for (const string& key : frozen_keys) {
+    parameters->erase(key);
+  }
+}
+
 void Model::RemoveNode(std::shared_ptr<Node> node) {
   mutex_lock l(mu_);
   if (node) {
@@ -1321,6 +1395,7 @@ void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
   VLOG(2) << "Starting optimization of tunable parameters with GradientDescent";
   auto parameters = CollectTunableParameters(snapshot);
   auto essential_parameters = CollectEssentialParallelism(snapshot);
+  ApplyFrozenParameters(&parameters);
   // We add the number of model's buffered bytes because it is excluded from the
   // memory budget, but it is included in the maximum number of buffered bytes.
   ram_budget += TotalBufferedBytes(snapshot);
@@ -1397,6 +1472,7 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
   VLOG(2) << "Starting optimization of tunable parameters with HillClimb";
   const double processing_time = TotalProcessingTime(snapshot);
   auto parameters = CollectTunableParameters(snapshot);
+  ApplyFrozenParameters(&parameters);
   // We add the number of model's buffered bytes because it is excluded from the
   // memory budget, but it is included in the maximum number of buffered bytes.
   ram_budget += TotalBufferedBytes(snapshot);
@@ -50,6 +50,25 @@ enum class AutotuneAlgorithm {
   GRADIENT_DESCENT = 1,
 };
 
+// Resources and constraints of the autotuning optimization.
+struct OptimizationParams {
+  AutotuneAlgorithm algorithm = AutotuneAlgorithm::HILL_CLIMB;
+
+  // Number of CPU cores that the input pipeline may use.
+  int64 cpu_budget = 0;
+
+  // Number of bytes that the buffers of the input pipeline may use.
+  int64 ram_budget = 0;
+
+  // Sizes of the inter-op and intra-op thread pools running the ops of the
+  // step that consumes the input pipeline. If positive, the threads of the
+  // larger pool are assumed to compete with the input pipeline for the CPU
+  // budget, and are deducted from it (leaving at least one core to the input
+  // pipeline).
+  int64 inter_op_threads = 0;
+  int64 intra_op_threads = 0;
+};
+
 enum class TraversalOrder {
   BFS = 0,
   REVERSE_BFS = 1,
@@ -611,6 +630,25 @@ class Model {
   void Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget, int64 ram_budget)
       TF_LOCKS_EXCLUDED(mu_);
 
+  // Performs the autotuning optimization within the given constraints.
+  void Optimize(const OptimizationParams& params) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the current values of the tunable parameters, keyed by the long
+  // name of their node and the parameter name, e.g.
+  // "ParallelMap(id:2):parallelism". Node ids are assigned in the order in
+  // which the input pipeline creates its iterators, so the keys of the same
+  // input pipeline are stable across runs.
+  absl::flat_hash_map<string, double> GetTunableParameterValues()
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Freezes the tunable parameters with the given keys, in the format returned
+  // by `GetTunableParameterValues()`, to the given values: the optimization
+  // sets them to these values (projected on their feasible intervals) instead
+  // of tuning them. This makes it possible to deploy a known-good
+  // configuration. Keys of nodes that don't exist yet apply once they do.
+  void FreezeParameters(const absl::flat_hash_map<string, double>& values)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Removes the given node.
   void RemoveNode(std::shared_ptr<Node> node) TF_LOCKS_EXCLUDED(mu_);
 
@@ -620,6 +658,12 @@ class Model {
   absl::flat_hash_map<string, std::shared_ptr<Parameter>>
   CollectTunableParameters(std::shared_ptr<Node> node);
 
+  // Sets the frozen parameters among `parameters` to their frozen values and
+  // removes them from `parameters`, so they are no longer tuned.
+  void ApplyFrozenParameters(
+      absl::flat_hash_map<string, std::shared_ptr<Parameter>>* parameters)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Collects "essential" parallelism parameters of transformations in the tree
   // rooted in the given node. Which parameters are essential is determined by
   // comparison the processing time spent in the corresponding transformation
@@ -670,6 +714,8 @@ class Model {
   mutex mu_;
   int64 id_counter_ TF_GUARDED_BY(mu_) = 1;
   std::shared_ptr<Node> output_ TF_GUARDED_BY(mu_);
+  // Values of the parameters frozen by `FreezeParameters()`.
+  absl::flat_hash_map<string, double> frozen_parameters_ TF_GUARDED_BY(mu_);
 
   // Indicates whether the modeling framework should collect resource usage
   // (e.g. CPU, memory). The logic for collecting this information assumes that
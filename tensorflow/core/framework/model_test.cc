@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include <memory>
 
+#include "absl/memory/memory.h"
+
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -772,6 +774,77 @@ TEST(SnapshotTest, Model) {
   }
 }
 
+// Builds a model of a parallel map (with the given shared parallelism state)
+// reading from a source, with a history of one element each.
+std::unique_ptr<Model> MakeParallelMapModel(
+    std::shared_ptr<SharedState> parallelism) {
+  auto model = absl::make_unique<Model>();
+  std::shared_ptr<Node> parallel_map;
+  model->AddNode(
+      [&parallelism](Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter("parallelism", parallelism, /*min=*/1,
+                                  /*max=*/16)});
+      },
+      "parallel_map", nullptr, &parallel_map);
+  std::shared_ptr<Node> source;
+  model->AddNode(model::MakeSourceNode, "source", parallel_map, &source);
+  parallel_map->add_processing_time(100);
+  parallel_map->record_element();
+  source->add_processing_time(10);
+  source->record_element();
+  return model;
+}
+
+std::shared_ptr<SharedState> MakeTunableState() {
+  return std::make_shared<SharedState>(model::kAutotune,
+                                       std::make_shared<mutex>(),
+                                       std::make_shared<condition_variable>());
+}
+
+TEST(OptimizeTest, StepThreadsReduceCpuBudget) {
+  OptimizationParams params;
+  params.cpu_budget = 8;
+  params.ram_budget = 1 << 30;
+
+  auto uncontended_parallelism = MakeTunableState();
+  MakeParallelMapModel(uncontended_parallelism)->Optimize(params);
+
+  params.intra_op_threads = 6;
+  auto contended_parallelism = MakeTunableState();
+  MakeParallelMapModel(contended_parallelism)->Optimize(params);
+
+  EXPECT_GE(contended_parallelism->value, 1);
+  EXPECT_LT(contended_parallelism->value, uncontended_parallelism->value);
+}
+
+TEST(OptimizeTest, FrozenParameters) {
+  auto parallelism = MakeTunableState();
+  std::unique_ptr<Model> model = MakeParallelMapModel(parallelism);
+  OptimizationParams params;
+  params.cpu_budget = 8;
+  params.ram_budget = 1 << 30;
+  model->Optimize(params);
+
+  absl::flat_hash_map<string, double> values =
+      model->GetTunableParameterValues();
+  ASSERT_EQ(values.size(), 1);
+  ASSERT_TRUE(values.contains("parallel_map(id:0):parallelism"));
+  EXPECT_EQ(values["parallel_map(id:0):parallelism"], parallelism->value);
+
+  // Frozen values are clamped to the range of the parameter and are no longer
+  // changed by the optimization.
+  model->FreezeParameters({{"parallel_map(id:0):parallelism", 100}});
+  model->Optimize(params);
+  EXPECT_EQ(parallelism->value, 16);
+  model->FreezeParameters({{"parallel_map(id:0):parallelism", 3}});
+  model->Optimize(params);
+  EXPECT_EQ(parallelism->value, 3);
+  values = model->GetTunableParameterValues();
+  EXPECT_EQ(values["parallel_map(id:0):parallelism"], 3);
+}
+
 class ComputeWaitTimeTest
     : public ::testing::TestWithParam<std::tuple<double, double, double>> {};
 
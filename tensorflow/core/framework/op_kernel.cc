@@ -325,6 +325,24 @@ OpKernelContext::OpKernelContext(Params* params)
 
 OpKernelContext::OpKernelContext(Params* params, int num_outputs)
     : params_(params), outputs_(num_outputs) {
+  Initialize();
+}
+
+OpKernelContext::~OpKernelContext() { ReleaseOutputsAndTrackingState(); }
+
+void OpKernelContext::ResetForKernel(int num_outputs) {
+  ReleaseOutputsAndTrackingState();
+  // Unlike clear(), resizing keeps the storage of the outputs.
+  for (TensorValue& value : outputs_) value = TensorValue();
+  outputs_.resize(num_outputs);
+  status_ = Status::OK();
+  record_memory_consumption_ = false;
+  allocated_scope_ids_.reset();
+  tracking_state_.reset();
+  Initialize();
+}
+
+void OpKernelContext::Initialize() {
   if (params_->track_allocations) {
     tracking_state_ = absl::make_unique<TrackingState>();
   }
@@ -341,13 +359,13 @@ OpKernelContext::OpKernelContext(Params* params, int num_outputs)
   }
 }
 
-OpKernelContext::~OpKernelContext() {
+void OpKernelContext::ReleaseOutputsAndTrackingState() {
   for (TensorValue& value : outputs_) {
     if (!value.is_ref()) {
       delete value.tensor;
     }
   }
-  if (params_->track_allocations &&
+  if (tracking_state_ != nullptr &&
       !tracking_state_->wrapped_allocators.empty()) {
     LOG(WARNING) << "OpKernelContext is tracking allocations but they are not "
                  << "being consumed by the StepStatsCollector.";
@@ -703,7 +721,13 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
   Tensor new_tensor(a, type, shape,
                     AllocationAttributes(allocation_attr.no_retry_on_failure,
                                          /* allocation_will_be_logged= */ true,
@@ -760,7 +784,15 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
   ScopedMemoryDebugAnnotation op_annotation(op_kernel().name_view().data(),
                                             step_id(), "output", type, &shape);
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* planned_allocator = nullptr;
+  if (TF_PREDICT_FALSE(params_->output_allocator_array != nullptr) &&
+      attr.value == 0 && attr.scope_id == 0 && !track_allocations()) {
+    planned_allocator = params_->output_allocator_array[index];
+  }
+  Status s = planned_allocator == nullptr
+                 ? allocate_tensor(type, shape, output_tensor.get(), attr)
+                 : allocate_tensor(planned_allocator, type, shape,
+                                   output_tensor.get(), AllocationAttributes());
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -635,6 +635,12 @@ class OpKernelContext {
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, an array indexed by output number for this node. A non-null
+    // entry is the allocator that `allocate_output()` uses for that output
+    // instead of the device allocator, when the output is allocated with
+    // default attributes (e.g. by a StaticMemoryPlan).
+    Allocator* const* output_allocator_array = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -711,6 +717,14 @@ class OpKernelContext {
   OpKernelContext(Params* params, int num_outputs);
   ~OpKernelContext();
 
+  // Prepares this context to compute another kernel with num_outputs outputs,
+  // as if it had been newly constructed from the same Params object, whose
+  // per-kernel fields the caller has updated. Reusing a context keeps the
+  // storage of its outputs, so executors running many small kernels needn't
+  // allocate a context for each of them. Outputs that haven't been released
+  // are deleted.
+  void ResetForKernel(int num_outputs);
+
   Env* env() const { return params_->device->env(); }
 
   int64 step_id() const { return params_->step_id; }
@@ -1277,6 +1291,10 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
@@ -1291,6 +1309,10 @@ class OpKernelContext {
   // called.
   void maybe_initialize_scope_id_set();
 
+  // Helpers shared by the constructor, ResetForKernel() and the destructor.
+  void Initialize();
+  void ReleaseOutputsAndTrackingState();
+
   Status status_;
   friend class CollectiveExecutor;  // for access to params_
   Params* params_;                  // not owned
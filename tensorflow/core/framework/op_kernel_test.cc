@@ -382,6 +382,33 @@ TEST_F(OpKernelTest, InputDtype) {
   EXPECT_EQ(dtype, DT_INT32);
 }
 
+TEST_F(OpKernelTest, ResetForKernel) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  DummyDevice device(env);
+  params.device = &device;
+  Status status;
+  std::unique_ptr<OpKernel> op(
+      CreateOpKernel(DEVICE_CPU, params.device, cpu_allocator(),
+                     CreateNodeDef("Test1", {DT_FLOAT, DT_INT32}),
+                     TF_GRAPH_DEF_VERSION, &status));
+  TF_ASSERT_OK(status);
+  params.op_kernel = op.get();
+  OpKernelContext ctx(&params, 1);
+
+  Tensor* output = nullptr;
+  TF_ASSERT_OK(ctx.allocate_output(0, TensorShape({2}), &output));
+  ctx.SetStatus(errors::Internal("kernel failed"));
+
+  // The unreleased output is deleted, and the context looks new.
+  ctx.ResetForKernel(1);
+  EXPECT_TRUE(ctx.status().ok());
+  EXPECT_EQ(1, ctx.num_outputs());
+  EXPECT_EQ(nullptr, ctx.mutable_output(0));
+  TF_ASSERT_OK(ctx.allocate_output(0, TensorShape({}), &output));
+  EXPECT_EQ(output, ctx.mutable_output(0));
+}
+
 // A mock device that mimics the behavior of scoped allocator upon calling
 // GetAllocator with a positive scope_id.
 class ScopedAllocatorDevice : public DeviceBase {
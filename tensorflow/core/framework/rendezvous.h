@@ -63,6 +63,10 @@ class RendezvousInterface {
     StringPiece dst_device;
     DeviceNameUtils::ParsedName dst;
     StringPiece edge_name;
+    // Hash64 of FullKey(), so that rendezvous tables needn't rehash the key.
+    // SendOp and RecvOp parse their keys once, which precomputes it for
+    // every step outside of loops.
+    uint64 hash = 0;
 
     ParsedKey() {}
     ParsedKey(const ParsedKey& b) { *this = b; }
@@ -21,10 +21,12 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -55,6 +57,9 @@ TEST(RendezvousTest, Key) {
   EXPECT_EQ(parsed.src.type, "CPU");
   EXPECT_EQ(parsed.dst_device, "/job:mnist/replica:1/task:2/device:GPU:0");
   EXPECT_EQ(parsed.dst.type, "GPU");
+  EXPECT_EQ(parsed.hash, Hash64(key));
+  Rendezvous::ParsedKey copied = parsed;
+  EXPECT_EQ(copied.hash, parsed.hash);
 
   EXPECT_FALSE(Rendezvous::ParseKey("foo;bar;baz", &parsed).ok());
   EXPECT_FALSE(Rendezvous::ParseKey("/job:mnist/replica:1/task:2/CPU:0;"
@@ -394,6 +399,45 @@ TEST_F(LocalRendezvousTest, AbortThenRecvOrSend) {
       errors::IsAborted(rendez_->Recv(KeyFoo(), args, &val, &val_dead)));
 }
 
+TEST_F(LocalRendezvousTest, ManyKeys) {
+  // Enough keys to land in every shard of the table.
+  static const int N = 256;
+  std::vector<Rendezvous::ParsedKey> keys;
+  for (int i = 0; i < N; ++i) {
+    keys.push_back(MakeKey(strings::StrCat("key", i)));
+  }
+  SchedClosure([this, &keys]() {
+    Rendezvous::Args args;
+    for (int i = N - 1; i >= 0; --i) {
+      TF_ASSERT_OK(rendez_->Send(keys[i], args, V(strings::StrCat(i)), false));
+    }
+  });
+  Rendezvous::Args args;
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  for (int i = 0; i < N; ++i) {
+    TF_ASSERT_OK(rendez_->Recv(keys[i], args, &val, &val_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+}
+
+TEST_F(LocalRendezvousTest, AbortPendingRecvsOfAllKeys) {
+  static const int N = 64;
+  BlockingCounter counter(N);
+  Rendezvous::Args args;
+  for (int i = 0; i < N; ++i) {
+    rendez_->RecvAsync(MakeKey(strings::StrCat("key", i)), args,
+                       [&counter](const Status& s, const Rendezvous::Args&,
+                                  const Rendezvous::Args&, const Tensor&,
+                                  const bool) {
+                         EXPECT_TRUE(errors::IsAborted(s));
+                         counter.DecrementCount();
+                       });
+  }
+  rendez_->StartAbort(errors::Aborted(""));
+  counter.Wait();
+}
+
 class DummyDeviceContext : public DeviceContext {
  public:
   explicit DummyDeviceContext(int stream_id) : stream_id_(stream_id) {}
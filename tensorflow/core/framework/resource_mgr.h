@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -219,6 +220,13 @@ class ResourceMgr {
   // Returns a text description for all resources.
   string DebugString() const;
 
+  // Returns a counter that is incremented whenever resources are removed from
+  // *this. A resource found by a lookup is still in *this for as long as the
+  // counter has the value returned before that lookup.
+  int64 generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
  private:
   typedef std::pair<uint64, StringPiece> Key;
   struct KeyHash {
@@ -250,6 +258,8 @@ class ResourceMgr {
   const string default_container_;
   mutable mutex mu_;
   std::unordered_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  // Incremented with mu_ held exclusively, read without it.
+  std::atomic<int64> generation_{0};
 
   template <typename T, bool use_dynamic_cast = false>
   Status LookupInternal(const string& container, const string& name,
@@ -345,6 +355,37 @@ template <typename T>
 Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
                       core::RefCountPtr<T>* value);
 
+// Remembers the resource a kernel looked up last, so that a kernel that reads
+// the same resource on every execution does not take the ResourceMgr lock or
+// search its maps. The cached resource is only returned while
+// ResourceMgr::generation() is unchanged, so a resource that has been deleted
+// is looked up again rather than returned.
+//
+// The cache holds a ref on its resource until the next lookup of another
+// resource, or until the cache is destroyed. Thread-safe.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  ResourceLookupCache() {}
+  ~ResourceLookupCache() {
+    if (resource_ != nullptr) resource_->Unref();
+  }
+
+  // Like LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p,
+                core::RefCountPtr<T>* value);
+
+ private:
+  mutex mu_;
+  const ResourceMgr* resource_mgr_ TF_GUARDED_BY(mu_) = nullptr;
+  string container_ TF_GUARDED_BY(mu_);
+  string name_ TF_GUARDED_BY(mu_);
+  int64 generation_ TF_GUARDED_BY(mu_) = -1;
+  T* resource_ TF_GUARDED_BY(mu_) = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ResourceLookupCache);
+};
+
 // Looks up multiple resources pointed by a sequence of resource handles.  If
 // p[i] is uninitialized then values[i] is unmodified.
 template <typename T>
@@ -745,6 +786,43 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
   return Status::OK();
 }
 
+template <typename T>
+Status ResourceLookupCache<T>::Lookup(OpKernelContext* ctx,
+                                      const ResourceHandle& p,
+                                      core::RefCountPtr<T>* value) {
+  TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+  ResourceMgr* rm = ctx->resource_manager();
+  // Read before the lookup, so that any removal after it is noticed.
+  const int64 generation = rm->generation();
+  {
+    tf_shared_lock l(mu_);
+    if (resource_ != nullptr && resource_mgr_ == rm &&
+        generation_ == generation && name_ == p.name() &&
+        container_ == p.container()) {
+      resource_->Ref();
+      value->reset(resource_);
+      return Status::OK();
+    }
+  }
+  T* raw_ptr = nullptr;
+  TF_RETURN_IF_ERROR(rm->Lookup<T>(p.container(), p.name(), &raw_ptr));
+  value->reset(raw_ptr);
+  raw_ptr->Ref();
+  T* evicted;
+  {
+    mutex_lock l(mu_);
+    evicted = resource_;
+    resource_ = raw_ptr;
+    resource_mgr_ = rm;
+    container_ = p.container();
+    name_ = p.name();
+    generation_ = generation;
+  }
+  // Outside the lock, since this may run the evicted resource's destructor.
+  if (evicted != nullptr) evicted->Unref();
+  return Status::OK();
+}
+
 template <typename T>
 Status LookupResources(OpKernelContext* ctx,
                        absl::Span<ResourceHandle const* const> p,
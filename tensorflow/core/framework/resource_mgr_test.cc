@@ -352,4 +352,46 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   EXPECT_NE(LookupResource<StubResource>(&ctx, p, &lookup_r).ok(), true);
 }
 
+TEST(ResourceHandleTest, LookupCache) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  ResourceHandle q =
+      MakeResourceHandle<StubResource>(&ctx, "container", "other_name");
+  ResourceLookupCache<StubResource> cache;
+
+  core::RefCountPtr<StubResource> lookup_r;
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &lookup_r).ok());
+
+  StubResource* r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, p, r));
+  TF_EXPECT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+  TF_EXPECT_OK(cache.Lookup(&ctx, p, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), r);
+
+  // A different handle is looked up, not served from the cache.
+  EXPECT_FALSE(cache.Lookup(&ctx, q, &lookup_r).ok());
+  StubResource* other_r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, q, other_r));
+  TF_EXPECT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), other_r);
+
+  // A deleted resource is not returned, and a new one with the same name is.
+  const int64 generation = resource_mgr.generation();
+  TF_EXPECT_OK(DeleteResource(&ctx, q));
+  EXPECT_GT(resource_mgr.generation(), generation);
+  EXPECT_FALSE(cache.Lookup(&ctx, q, &lookup_r).ok());
+  StubResource* new_r = new StubResource;
+  TF_EXPECT_OK(CreateResource(&ctx, q, new_r));
+  TF_EXPECT_OK(cache.Lookup(&ctx, q, &lookup_r));
+  EXPECT_EQ(lookup_r.get(), new_r);
+}
+
 }  // end namespace tensorflow
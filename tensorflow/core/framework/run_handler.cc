@@ -44,6 +44,24 @@ static constexpr int32 kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+// Returns the number of NUMA partitions requested through the environment, or
+// 1 if the NUMA partitioned mode is disabled.
+int NumNumaPartitionsFromEnv(bool use_sub_thread_pool) {
+  if (!ParamFromEnvBoolWithDefault("TF_RUN_HANDLER_USE_NUMA_PARTITIONS",
+                                   false)) {
+    return 1;
+  }
+  if (use_sub_thread_pool) {
+    LOG(WARNING) << "TF_RUN_HANDLER_USE_NUMA_PARTITIONS is ignored since "
+                 << "TF_RUN_HANDLER_USE_SUB_THREAD_POOL is set.";
+    return 1;
+  }
+  // TF_RUN_HANDLER_NUM_NUMA_PARTITIONS overrides the detected number of nodes.
+  return std::max(1, static_cast<int>(ParamFromEnvWithDefault(
+                         "TF_RUN_HANDLER_NUM_NUMA_PARTITIONS",
+                         static_cast<double>(port::NUMANumNodes()))));
+}
+
 }  // namespace
 
 namespace internal {
@@ -131,6 +149,7 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      numa_node_(port::kNUMANoAffinity),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -260,6 +279,12 @@ int64 ThreadWorkSource::GetTracemeId() {
 
 void ThreadWorkSource::SetTracemeId(int64 value) { traceme_id_ = value; }
 
+int ThreadWorkSource::GetNumaNode() {
+  return numa_node_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetNumaNode(int numa_node) { numa_node_ = numa_node; }
+
 void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   {
     tf_shared_lock lock(run_handler_waiter_mu_);
@@ -334,11 +359,13 @@ RunHandlerThreadPool::RunHandlerThreadPool(
           std::vector<double>({0, 0.4}))),
       sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
           "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
-          std::vector<double>({0.4, 1}))) {
+          std::vector<double>({0.4, 1}))),
+      num_numa_partitions_(NumNumaPartitionsFromEnv(use_sub_thread_pool_)) {
   thread_data_.resize(num_threads_);
   VLOG(1) << "Creating RunHandlerThreadPool " << name << " with  "
           << num_blocking_threads_ << " blocking threads and "
-          << num_non_blocking_threads_ << " non-blocking threads.";
+          << num_non_blocking_threads_ << " non-blocking threads across "
+          << num_numa_partitions_ << " NUMA partitions.";
 }
 
 RunHandlerThreadPool::~RunHandlerThreadPool() {
@@ -366,6 +393,7 @@ void RunHandlerThreadPool::Start() {
       }
     }
     thread_data_[i].sub_thread_pool_id = sub_thread_pool_id;
+    thread_data_[i].numa_node = NumaNodeForThread(i);
     thread_data_[i].thread.reset(
         env_.CreateThread([this, i, num_blocking_threads]() {
           WorkerLoop(i, i < num_blocking_threads);
@@ -376,6 +404,7 @@ void RunHandlerThreadPool::Start() {
 void RunHandlerThreadPool::StartOneThreadForTesting() {
   cancelled_ = false;
   thread_data_[0].sub_thread_pool_id = 0;
+  thread_data_[0].numa_node = NumaNodeForThread(0);
   thread_data_[0].thread.reset(
       env_.CreateThread([this]() { WorkerLoop(0, true); }));
 }
@@ -413,6 +442,34 @@ void RunHandlerThreadPool::SetThreadWorkSources(
       thread_data_[tid].new_thread_work_sources->emplace_back(
           thread_work_sources[i]);
     }
+  } else if (num_numa_partitions_ > 1) {
+    // The primary work source is the highest priority request on the thread's
+    // own NUMA node, in the arrival order given by start_request_idx if that
+    // request is local. Requests on other nodes come last so that they are
+    // only stolen from once no local work is left. If there is no local
+    // request at all, start_request_idx stays primary to keep the thread busy.
+    const int numa_node = thread_data_[tid].numa_node;
+    int primary_idx = start_request_idx;
+    if (thread_work_sources[primary_idx]->GetNumaNode() != numa_node) {
+      for (int i = 0; i < thread_work_sources.size(); ++i) {
+        if (thread_work_sources[i]->GetNumaNode() == numa_node) {
+          primary_idx = i;
+          break;
+        }
+      }
+    }
+    thread_data_[tid].new_thread_work_sources->emplace_back(
+        thread_work_sources[primary_idx]);
+    for (bool local : {true, false}) {
+      for (int i = 0; i < thread_work_sources.size(); ++i) {
+        if (i != primary_idx &&
+            (thread_work_sources[i]->GetNumaNode() == numa_node) == local) {
+          thread_data_[tid].new_thread_work_sources->emplace_back(
+              thread_work_sources[i]);
+        }
+      }
+    }
+    thread_data_[tid].sources_not_empty.notify_all();
   } else {
     thread_data_[tid].new_thread_work_sources->emplace_back(
         thread_work_sources[start_request_idx]);
@@ -465,6 +522,22 @@ int RunHandlerThreadPool::NumNonBlockingThreads() const {
   return num_non_blocking_threads_;
 }
 
+int RunHandlerThreadPool::NumNumaPartitions() const {
+  return num_numa_partitions_;
+}
+
+int RunHandlerThreadPool::NumaNodeForThread(int tid) const {
+  if (num_numa_partitions_ <= 1) {
+    return port::kNUMANoAffinity;
+  }
+  // Distribute blocking and non-blocking threads separately so that every node
+  // gets its share of both kinds.
+  if (tid < num_blocking_threads_) {
+    return tid % num_numa_partitions_;
+  }
+  return (tid - num_blocking_threads_) % num_numa_partitions_;
+}
+
 RunHandlerThreadPool::ThreadData::ThreadData()
     : new_version(0),
       current_index(0),
@@ -524,6 +597,14 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
   pt->thread_id = thread_id;
   static constexpr int32 kMaxBlockingInflight = 10;
 
+  // A partition count forced through the environment may exceed the number of
+  // physical nodes, in which case the thread is left unpinned.
+  const int numa_node = thread_data_[thread_id].numa_node;
+  if (numa_node != port::kNUMANoAffinity && port::NUMAEnabled() &&
+      numa_node < port::NUMANumNodes()) {
+    port::NUMASetThreadNodeAffinity(numa_node);
+  }
+
   while (!cancelled_) {
     Task t;
     ThreadWorkSource* tws = nullptr;
@@ -799,6 +880,11 @@ class RunHandlerPool::Impl {
       queue_waiter.next = &queue_waiter;
       queue_waiter.prev = &queue_waiter;
     }
+    {
+      mutex_lock l(mu_);
+      num_active_handlers_per_numa_node_.resize(
+          run_handler_thread_pool_->NumNumaPartitions(), 0);
+    }
     run_handler_thread_pool_->Start();
   }
 
@@ -859,6 +945,18 @@ class RunHandlerPool::Impl {
       handler_impl = free_handlers_.back();
       handler_impl->Reset(step_id, options);
       free_handlers_.pop_back();
+      if (num_active_handlers_per_numa_node_.size() > 1) {
+        // Pin the request to the NUMA node with the fewest active requests.
+        int numa_node = 0;
+        for (int i = 1; i < num_active_handlers_per_numa_node_.size(); ++i) {
+          if (num_active_handlers_per_numa_node_[i] <
+              num_active_handlers_per_numa_node_[numa_node]) {
+            numa_node = i;
+          }
+        }
+        ++num_active_handlers_per_numa_node_[numa_node];
+        handler_impl->tws()->SetNumaNode(numa_node);
+      }
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
@@ -905,6 +1003,10 @@ class RunHandlerPool::Impl {
     // handlers.
     sorted_active_handlers_.erase(iter);
     free_handlers_.push_back(handler);
+    const int numa_node = handler->tws()->GetNumaNode();
+    if (numa_node != port::kNUMANoAffinity) {
+      --num_active_handlers_per_numa_node_[numa_node];
+    }
     DCHECK_LE(free_handlers_.size(), max_handlers_);
     LogInfo();
 
@@ -958,6 +1060,9 @@ class RunHandlerPool::Impl {
   mutex mu_;
   int64 version_ TF_GUARDED_BY(mu_);
   const std::vector<double> sub_thread_pool_end_request_percentage_;
+  // Number of active handlers pinned to each NUMA node. Has a single entry if
+  // the pool is not NUMA partitioned.
+  std::vector<int> num_active_handlers_per_numa_node_ TF_GUARDED_BY(mu_);
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
@@ -1070,6 +1175,7 @@ void RunHandler::Impl::Reset(
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetNumaNode(port::kNUMANoAffinity);
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1102,6 +1208,8 @@ thread::ThreadPoolInterface* RunHandler::AsIntraThreadPoolInterface() {
   return impl_->thread_pool_interface();
 }
 
+int RunHandler::numa_node() const { return impl_->tws()->GetNumaNode(); }
+
 RunHandler::~RunHandler() { impl_->pool_impl()->ReleaseHandler(impl_); }
 
 }  // namespace tensorflow
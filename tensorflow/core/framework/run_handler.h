@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 
@@ -47,6 +48,11 @@ class RunHandler;
 // * Use handler for scheduling all inter-op work by:
 // handler->ScheduleInterOpClosure(closure);
 //
+// When TF_RUN_HANDLER_USE_NUMA_PARTITIONS is set, the pool's threads are split
+// evenly across NUMA nodes and pinned to them. Every handler returned by Get()
+// is assigned to the least loaded node, and threads only steal work from
+// requests on other nodes once all requests on their own node have run dry.
+//
 // This class is thread safe.
 class RunHandlerPool {
  public:
@@ -96,6 +102,12 @@ class RunHandler {
   void ScheduleInterOpClosure(std::function<void()> fn);
   thread::ThreadPoolInterface* AsIntraThreadPoolInterface();
 
+  // Returns the NUMA node the work of this handler is preferably run on, or
+  // port::kNUMANoAffinity if the pool is not NUMA partitioned. Callers can use
+  // it to allocate step memory local to that node, e.g. via
+  // ProcessState::GetCPUAllocator(numa_node()).
+  int numa_node() const;
+
   ~RunHandler();
 
  private:
@@ -173,6 +185,12 @@ class ThreadWorkSource {
 
   void SetTracemeId(int64 value);
 
+  // NUMA node of the request owning this work source, or
+  // port::kNUMANoAffinity if the request is not pinned to a node.
+  int GetNumaNode();
+
+  void SetNumaNode(int numa_node);
+
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
   int64 GetInflightTaskCount(bool is_blocking);
@@ -204,6 +222,7 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64> traceme_id_;
+  std::atomic<int> numa_node_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -236,7 +255,9 @@ class RunHandlerThreadPool {
 
   // Set work queues from which the thread 'tid' can steal its work.
   // The request with start_request_idx will be attempted first. Other requests
-  // will be attempted in FIFO order based on their arrival time.
+  // will be attempted in FIFO order based on their arrival time. In the NUMA
+  // partitioned mode, requests on the thread's own NUMA node are attempted
+  // before requests on any other node.
   void SetThreadWorkSources(
       int tid, int start_request_idx, uint64 version,
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources);
@@ -251,6 +272,14 @@ class RunHandlerThreadPool {
 
   int NumNonBlockingThreads() const;
 
+  // Number of NUMA partitions the threads of this pool are split into. Returns
+  // 1 if the pool is not NUMA partitioned.
+  int NumNumaPartitions() const;
+
+  // NUMA node the thread 'tid' is pinned to, or port::kNUMANoAffinity if the
+  // pool is not NUMA partitioned.
+  int NumaNodeForThread(int tid) const;
+
   void WorkerLoop(int thread_id, bool may_steal_blocking_work);
 
   // Search tasks from Requets range searching_range_start to
@@ -285,6 +314,7 @@ class RunHandlerThreadPool {
         current_thread_work_sources;
 
     int sub_thread_pool_id;
+    int numa_node;
   };
 
   const int num_threads_;
@@ -305,6 +335,10 @@ class RunHandlerThreadPool {
   // fashion.
   std::vector<double> sub_thread_pool_start_request_percentage_;
   std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  // Blocking and non-blocking threads are each assigned round robin to
+  // num_numa_partitions_ NUMA nodes.
+  const int num_numa_partitions_;
 };
 
 }  // namespace internal
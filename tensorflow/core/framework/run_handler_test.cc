@@ -583,6 +583,100 @@ TEST(RunHandlerThreadPool, MultipleSubThreadPool) {
   delete run_handler_thread_pool;
 }
 
+TEST(RunHandlerThreadPool, NumaPartitionPrefersLocalRequests) {
+  // Force 2 NUMA partitions, independently of the host topology.
+  setenv("TF_RUN_HANDLER_USE_SUB_THREAD_POOL", "false", true);
+  setenv("TF_RUN_HANDLER_USE_NUMA_PARTITIONS", "true", true);
+  setenv("TF_RUN_HANDLER_NUM_NUMA_PARTITIONS", "2", true);
+
+  Eigen::MaxSizeVector<mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool* run_handler_thread_pool =
+      new internal::RunHandlerThreadPool(
+          /*num_blocking_threads=*/2, /*num_non_blocking_threads=*/0,
+          Env::Default(), ThreadOptions(), "tf_run_handler_pool", &waiters_mu,
+          &waiters);
+  EXPECT_EQ(run_handler_thread_pool->NumNumaPartitions(), 2);
+  EXPECT_EQ(run_handler_thread_pool->NumaNodeForThread(0), 0);
+  EXPECT_EQ(run_handler_thread_pool->NumaNodeForThread(1), 1);
+
+  // The highest priority request lives on node 1, the other one on node 0.
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(2);
+  thread_work_sources.resize(2);
+  internal::ThreadWorkSource tws[2];
+  for (int i = 0; i < 2; ++i) {
+    tws[i].SetWaiter(1, &waiters[0], &waiters_mu[0]);
+    tws[i].SetNumaNode(1 - i);
+    thread_work_sources[i] = &tws[i];
+  }
+
+  mutex mu;
+  std::vector<int> executed;
+  BlockingCounter counter(2);
+  for (int i = 0; i < 2; ++i) {
+    run_handler_thread_pool->AddWorkToQueue(
+        &tws[i], /*is_blocking=*/true, [&mu, &executed, &counter, i] {
+          {
+            mutex_lock l(mu);
+            executed.push_back(i);
+          }
+          counter.DecrementCount();
+        });
+  }
+  // Thread 0 is pinned to node 0, so it runs the local request first and only
+  // steals from the request on node 1 afterwards.
+  run_handler_thread_pool->StartOneThreadForTesting();
+  run_handler_thread_pool->SetThreadWorkSources(
+      /*tid=*/0, /*start_request_idx=*/0, /*version=*/1, thread_work_sources);
+  counter.Wait();
+  {
+    mutex_lock l(mu);
+    EXPECT_EQ(executed, std::vector<int>({1, 0}));
+  }
+
+  delete run_handler_thread_pool;
+  unsetenv("TF_RUN_HANDLER_USE_NUMA_PARTITIONS");
+  unsetenv("TF_RUN_HANDLER_NUM_NUMA_PARTITIONS");
+}
+
+TEST(RunHandlerUtilTest, NumaPartitionBalancesHandlers) {
+  setenv("TF_RUN_HANDLER_USE_SUB_THREAD_POOL", "false", true);
+  setenv("TF_RUN_HANDLER_USE_NUMA_PARTITIONS", "true", true);
+  setenv("TF_RUN_HANDLER_NUM_NUMA_PARTITIONS", "2", true);
+  {
+    std::unique_ptr<RunHandlerPool> pool(new RunHandlerPool(2, 2));
+    std::vector<std::unique_ptr<RunHandler>> handlers;
+    int num_handlers_per_node[2] = {0, 0};
+    for (int i = 0; i < 4; ++i) {
+      handlers.push_back(pool->Get(/*step_id=*/i));
+      ASSERT_GE(handlers.back()->numa_node(), 0);
+      ASSERT_LT(handlers.back()->numa_node(), 2);
+      ++num_handlers_per_node[handlers.back()->numa_node()];
+    }
+    EXPECT_EQ(num_handlers_per_node[0], 2);
+    EXPECT_EQ(num_handlers_per_node[1], 2);
+
+    // A new request goes to the node which just got a free slot.
+    const int released_node = handlers[1]->numa_node();
+    handlers[1].reset();
+    handlers[1] = pool->Get(/*step_id=*/4);
+    EXPECT_EQ(handlers[1]->numa_node(), released_node);
+
+    // Work scheduled on every node runs to completion.
+    BlockingCounter counter(8);
+    for (auto& handler : handlers) {
+      handler->ScheduleInterOpClosure([&counter] { counter.DecrementCount(); });
+      handler->AsIntraThreadPoolInterface()->Schedule(
+          [&counter] { counter.DecrementCount(); });
+    }
+    counter.Wait();
+  }
+  unsetenv("TF_RUN_HANDLER_USE_NUMA_PARTITIONS");
+  unsetenv("TF_RUN_HANDLER_NUM_NUMA_PARTITIONS");
+}
+
 SessionOptions DefaultSessionOptions() {
   SessionOptions options;
   (*options.config.mutable_device_count())["CPU"] = 2;
@@ -23,6 +23,9 @@ limitations under the License.
 //   default constructors and destructors when T is not a simple type
 //   (e.g., string.), and skips them otherwise.
 //
+// * SmallHostBuffer: holds the data of a tiny host tensor of a simple
+//   type inline, in a block recycled through a per-thread free list.
+//
 // * Helper<T>: provides various routines given type T.  The routines
 //   includes running the constructor and destructor of T[], encoding
 //   an decoding T[] into/from a Cord, etc.
@@ -50,6 +53,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -149,6 +153,115 @@ bool MemoryLoggingEnabled() {
   return memory_logging_enabled;
 }
 
+// Largest tensor, in bytes, whose data is held in a SmallHostBuffer.
+constexpr size_t kMaxSmallHostBufferBytes = 16;
+
+// A ref-counted buffer that holds up to kMaxSmallHostBufferBytes of data
+// inline, for scalars and short vectors such as loop counters and shapes.
+// Blocks come from a per-thread free list when possible, so creating and
+// destroying such tensors seldom reaches the allocator.
+class SmallHostBuffer : public TensorBuffer {
+ public:
+  explicit SmallHostBuffer(size_t size)
+      : TensorBuffer(storage_), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("SmallHostBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
+ private:
+  ~SmallHostBuffer() override {}
+
+  alignas(EIGEN_MAX_ALIGN_BYTES) char storage_[kMaxSmallHostBufferBytes];
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SmallHostBuffer);
+};
+
+// The blocks of destroyed SmallHostBuffers on one thread, kept for reuse.
+// Buffers released on another thread than they were created on land in the
+// releasing thread's list.
+class SmallHostBufferFreeList {
+ public:
+  ~SmallHostBufferFreeList() {
+    for (int i = 0; i < num_blocks_; ++i) port::AlignedFree(blocks_[i]);
+    destroyed_ = true;
+  }
+
+  static SmallHostBufferFreeList* Get() {
+    // Buffers released while the thread's locals are being torn down go
+    // straight back to the system.
+    if (TF_PREDICT_FALSE(destroyed_)) return nullptr;
+    thread_local SmallHostBufferFreeList free_list;
+    return &free_list;
+  }
+
+  void* Pop() { return num_blocks_ > 0 ? blocks_[--num_blocks_] : nullptr; }
+
+  bool Push(void* block) {
+    if (num_blocks_ == kMaxBlocks) return false;
+    blocks_[num_blocks_++] = block;
+    return true;
+  }
+
+ private:
+  static constexpr int kMaxBlocks = 64;
+  static thread_local bool destroyed_;
+
+  void* blocks_[kMaxBlocks];
+  int num_blocks_ = 0;
+};
+
+thread_local bool SmallHostBufferFreeList::destroyed_ = false;
+
+void* SmallHostBuffer::operator new(size_t size) {
+  DCHECK_EQ(size, sizeof(SmallHostBuffer));
+  SmallHostBufferFreeList* free_list = SmallHostBufferFreeList::Get();
+  void* block = free_list != nullptr ? free_list->Pop() : nullptr;
+  if (block == nullptr) {
+    block = port::AlignedMalloc(sizeof(SmallHostBuffer),
+                                alignof(SmallHostBuffer));
+    CHECK(block != nullptr) << "Failed to allocate a SmallHostBuffer";
+  }
+  return block;
+}
+
+void SmallHostBuffer::operator delete(void* ptr) {
+  SmallHostBufferFreeList* free_list = SmallHostBufferFreeList::Get();
+  if (free_list == nullptr || !free_list->Push(ptr)) port::AlignedFree(ptr);
+}
+
+// Returns true if a host tensor of `bytes` bytes would be allocated from
+// `a` in a way a SmallHostBuffer can stand in for: the process's default
+// CPU allocator, with nothing observing the individual allocations.
+bool UseSmallHostBuffer(Allocator* a, size_t bytes,
+                        const AllocationAttributes& allocation_attr) {
+  return bytes <= kMaxSmallHostBufferBytes && a == cpu_allocator_base() &&
+         !a->TracksAllocationSizes() && !CPUAllocatorStatsEnabled() &&
+         !MemoryLoggingEnabled() && allocation_attr.freed_by_func == nullptr;
+}
+
+// Allocates the buffer of a new T[n] tensor, inline if it is small enough.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64 n,
+                        const AllocationAttributes& allocation_attr) {
+  if (is_simple_type<T>::value &&
+      UseSmallHostBuffer(a, sizeof(T) * n, allocation_attr)) {
+    return new SmallHostBuffer(sizeof(T) * n);
+  }
+  return new Buffer<T>(a, n, allocation_attr);
+}
+
 // A set of helper functions depending on T.
 template <typename T>
 struct Helper {
@@ -774,7 +887,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements(),
+                                     AllocationAttributes()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -788,7 +902,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    CASES(type,
+          buf_ = NewBuffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
@@ -1145,6 +1147,43 @@ TEST(Tensor, SharesBufferWith) {
   EXPECT_TRUE(a.SharesBufferWith(copy));
 }
 
+TEST(Tensor, SmallHostBuffer) {
+  auto allocator_name = [](const Tensor& t) {
+    TensorDescription description;
+    t.FillDescription(&description);
+    return description.allocation_description().allocator_name();
+  };
+
+  // Tiny tensors from the default CPU allocator hold their data inline.
+  Tensor scalar(DT_INT32, TensorShape({}));
+  Tensor shape(DT_INT64, TensorShape({2}));
+  EXPECT_EQ("SmallHostBuffer", allocator_name(scalar));
+  EXPECT_EQ("SmallHostBuffer", allocator_name(shape));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(shape.tensor_data().data()) %
+                   EIGEN_MAX_ALIGN_BYTES);
+  shape.vec<int64>()(0) = 3;
+  shape.vec<int64>()(1) = 4;
+  Tensor copy(shape);
+  EXPECT_TRUE(copy.SharesBufferWith(shape));
+  EXPECT_EQ(4, copy.vec<int64>()(1));
+
+  // Larger tensors, tensors of non-simple types, and tensors from other
+  // allocators do not.
+  Tensor large(DT_INT64, TensorShape({3}));
+  Tensor str(DT_STRING, TensorShape({}));
+  DummyCPUAllocator dummy_allocator;
+  Tensor other(&dummy_allocator, DT_INT32, TensorShape({}));
+  EXPECT_NE("SmallHostBuffer", allocator_name(large));
+  EXPECT_NE("SmallHostBuffer", allocator_name(str));
+  EXPECT_FALSE(other.IsInitialized());
+
+  // A released block is reused by the next tiny tensor on this thread.
+  const char* data = scalar.tensor_data().data();
+  scalar = Tensor();
+  Tensor next(DT_FLOAT, TensorShape({1}));
+  EXPECT_EQ(data, next.tensor_data().data());
+}
+
 TEST(Tensor, FailureToAllocate) {
   TensorShape shape({1});
   DummyCPUAllocator allocator;
@@ -437,6 +437,19 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
   return node;
 }
 
+Node* Graph::AddNode(std::shared_ptr<NodeProperties> props, Status* status) {
+  const OpRegistrationData* op_reg_data;
+  status->Update(ops_.LookUp(props->node_def.op(), &op_reg_data));
+  if (!status->ok()) return nullptr;
+  DCHECK_EQ(props->op_def, &op_reg_data->op_def);
+
+  const Node::NodeClass node_class =
+      op_reg_data->is_function_op
+          ? Node::NC_FUNCTION_OP
+          : Node::GetNodeClassForOp(props->node_def.op());
+  return AllocateNode(std::move(props), nullptr, node_class);
+}
+
 Node* Graph::CopyNode(const Node* node) {
   DCHECK(!node->IsSource());
   DCHECK(!node->IsSink());
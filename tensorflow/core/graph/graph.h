@@ -503,6 +503,11 @@ class Graph {
   // Returns nullptr and sets *status on error.
   Node* AddNode(NodeDef node_def, Status* status);
 
+  // Same as above, but for a node whose properties (including its input and
+  // output types) were computed ahead of time, e.g. on another thread.
+  // `props->op_def` must come from this graph's op registry.
+  Node* AddNode(std::shared_ptr<NodeProperties> props, Status* status);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
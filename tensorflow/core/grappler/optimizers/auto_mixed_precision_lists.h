@@ -417,6 +417,146 @@ class AutoMixedPrecisionListsMkl : public AutoMixedPrecisionLists {
   }
 };
 
+class AutoMixedPrecisionListsCpu : public AutoMixedPrecisionLists {
+ public:
+  AutoMixedPrecisionListsCpu() {}
+
+  // Ops are only converted if a bfloat16 kernel is registered for their
+  // device, so these lists may name ops that have such kernels in some builds
+  // (e.g. with XLA CPU) but not others.
+  gtl::FlatSet<string> WhiteList() override {
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "Conv2D",
+        "Conv2DBackpropFilter",
+        "Conv2DBackpropInput",
+        "Conv3D",
+        "Conv3DBackpropFilterV2",
+        "Conv3DBackpropInputV2",
+        "Einsum",
+        "MatMul",
+    };
+    UpdateList("WHITELIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> GrayList() override {
+    auto list = gtl::FlatSet<string>{
+        "Add",
+        "AddV2",
+        "AvgPool",
+        "AvgPool3D",
+        "BiasAdd",
+        "BiasAddV1",
+        "Elu",
+        "EluGrad",
+        "FusedBatchNormV2",
+        "FusedBatchNormGradV2",
+        "FusedBatchNormV3",
+        "FusedBatchNormGradV3",
+        "LeakyRelu",
+        "LeakyReluGrad",
+        "Mul",
+        "RealDiv",
+        "Sigmoid",
+        "SigmoidGrad",
+        "Sqrt",
+        "Sub",
+        "Tanh",
+        "TanhGrad",
+    };
+    UpdateList("GRAYLIST", &list);
+    return list;
+  }
+
+  // Eigen reductions accumulate in their input type, so ops that reduce over
+  // many elements (including AddN and the gradients of BiasAdd and AvgPool)
+  // are kept in float32 here, unlike in the CUDA lists.
+  gtl::FlatSet<string> BlackList() override {
+    auto list = gtl::FlatSet<string>{
+        "AddN",
+        "AvgPool3DGrad",
+        "AvgPoolGrad",
+        "BiasAddGrad",
+        "Cumprod",
+        "Cumsum",
+        "EuclideanNorm",
+        "Exp",
+        "Expm1",
+        "L2Loss",
+        "Log",
+        "Log1p",
+        "LogSoftmax",
+        "Mean",
+        "Pow",
+        "Prod",
+        "SaveV2",
+        "Softmax",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+        "Sum",
+    };
+    UpdateList("BLACKLIST", &list);
+    return list;
+  }
+
+  gtl::FlatSet<string> ClearList() override {
+    auto list = gtl::FlatSet<string>{
+        "Concat",
+        "ConcatV2",
+        "EnsureShape",
+        "Enter",
+        "Equal",
+        "Exit",
+        "ExpandDims",
+        "Gather",
+        "GatherNd",
+        "GatherV2",
+        "Identity",
+        "IdentityN",
+        "Max",
+        "MaxPool",
+        "MaxPool3D",
+        "MaxPool3DGrad",
+        "MaxPoolGrad",
+        "MaxPoolV2",
+        "Maximum",
+        "Merge",
+        "Min",
+        "Minimum",
+        "NextIteration",
+        "Pack",
+        "Pad",
+        "PadV2",
+        "PreventGradient",
+        "Relu",
+        "Relu6",
+        "Relu6Grad",
+        "ReluGrad",
+        "Reshape",
+        "Select",
+        "SelectV2",
+        "Shape",
+        "ShapeN",
+        "Slice",
+        "Split",
+        "SplitV",
+        "Squeeze",
+        "StopGradient",
+        "StridedSlice",
+        "Switch",
+        "Tile",
+        "Transpose",
+        "Unpack",
+        "ZerosLike",
+    };
+    AddTensorListOps(&list);
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+};
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
@@ -40,11 +40,13 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -63,6 +65,34 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 const int64 kMaxConstantSize = 10 * 1024 * 1024;
 
 namespace {
+// Upper bound on the total size of the constants memoized by
+// ConstantFolding::EvaluateWithCache().
+constexpr size_t kMaxEvaluationCacheBytes = 256 * 1024 * 1024;
+
+// Returns a fingerprint of the computation performed by `node` on `inputs`,
+// which ignores the name, device and control inputs of the node.
+Fprint128 EvaluationFingerprint(const NodeDef& node,
+                                absl::Span<const TensorProto* const> inputs) {
+  NodeDef computation;
+  computation.set_op(node.op());
+  *computation.mutable_attr() = node.attr();
+  string serialized;
+  SerializeToStringDeterministic(computation, &serialized);
+  // Concatenate the fingerprints of the computation and of every input.
+  string key;
+  const auto append_fingerprint = [&key](const string& serialized) {
+    const Fprint128 fingerprint = Fingerprint128(serialized);
+    strings::StrAppend(&key, fingerprint.low64, ":", fingerprint.high64, ";");
+  };
+  append_fingerprint(serialized);
+  for (const TensorProto* input : inputs) {
+    serialized.clear();
+    SerializeToStringDeterministic(*input, &serialized);
+    append_fingerprint(serialized);
+  }
+  return Fingerprint128(key);
+}
+
 template <typename T>
 bool AllValuesAre(const TensorProto& proto, const T& value) {
   Tensor tensor;
@@ -1297,20 +1327,7 @@ Status ConstantFolding::EvaluateNode(const NodeDef& node,
 Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                                             std::vector<NodeDef>* outputs,
                                             bool* result_too_large) {
-  TensorVector inputs;
-  TensorVector output_tensors;
-  auto inputs_cleanup = gtl::MakeCleanup([&inputs, &output_tensors] {
-    for (const auto& input : inputs) {
-      delete input.tensor;
-    }
-    for (const auto& output : output_tensors) {
-      if (output.tensor) {
-        delete output.tensor;
-      }
-    }
-  });
-
-  size_t total_inputs_size = 0;
+  std::vector<const TensorProto*> input_values;
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
     if (input_tensor.index() < 0) {
@@ -1324,38 +1341,179 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                                     " isn't constant"));
     }
     TF_RETURN_IF_ERROR(CheckAttrExists(*input_node, "value"));
-    const TensorProto& raw_val = input_node->attr().at("value").tensor();
-    Tensor* value = new Tensor(raw_val.dtype(), raw_val.tensor_shape());
-    CHECK(value->FromProto(raw_val));
-    inputs.emplace_back(value);
-    total_inputs_size += value->TotalBytes();
-  }
-
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
-  if (output_tensors.empty()) {
-    return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
+    input_values.push_back(&input_node->attr().at("value").tensor());
   }
 
-  outputs->resize(output_tensors.size());
-  for (size_t i = 0; i < output_tensors.size(); i++) {
+  EvaluationResult result;
+  EvaluateWithCache(node, input_values, &result);
+  *result_too_large = result.result_too_large;
+  *outputs = std::move(result.outputs);
+  for (size_t i = 0; i < outputs->size(); i++) {
+    if (outputs->at(i).name().empty()) continue;  // Dead output.
     string node_name = OptimizedNodeName(node, "-folded");
-    if (output_tensors.size() > 1) {
+    if (outputs->size() > 1) {
       node_name = strings::StrCat(node_name, "-", i);
     }
-    if (output_tensors[i].tensor) {
-      Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
-                               total_inputs_size);
-      if (!s.ok()) {
-        *result_too_large = true;
-        return s;
+    outputs->at(i).set_name(node_name);
+  }
+  return result.status;
+}
+
+void ConstantFolding::EvaluateWithCache(
+    const NodeDef& node, absl::Span<const TensorProto* const> input_values,
+    EvaluationResult* result) {
+  const Fprint128 fingerprint = EvaluationFingerprint(node, input_values);
+  {
+    mutex_lock l(evaluation_cache_mu_);
+    auto it = evaluation_cache_.find(fingerprint);
+    if (it != evaluation_cache_.end()) {
+      VLOG(3) << "Reusing the evaluation of " << node.name();
+      *result = it->second;
+      return;
+    }
+  }
+
+  result->status = [&]() -> Status {
+    TensorVector inputs;
+    TensorVector output_tensors;
+    auto inputs_cleanup = gtl::MakeCleanup([&inputs, &output_tensors] {
+      for (const auto& input : inputs) {
+        delete input.tensor;
       }
-    } else {
-      // Create an empty NodeDef to identify dead outputs (e.g. the output of a
-      // switch that's not selected by the switch predicate).
-      outputs->at(i) = NodeDef();
+      for (const auto& output : output_tensors) {
+        if (output.tensor) {
+          delete output.tensor;
+        }
+      }
+    });
+
+    size_t total_inputs_size = 0;
+    for (const TensorProto* raw_val : input_values) {
+      Tensor* value = new Tensor(raw_val->dtype(), raw_val->tensor_shape());
+      CHECK(value->FromProto(*raw_val));
+      inputs.emplace_back(value);
+      total_inputs_size += value->TotalBytes();
+    }
+
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    if (output_tensors.empty()) {
+      return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
+    }
+
+    result->outputs.resize(output_tensors.size());
+    for (size_t i = 0; i < output_tensors.size(); i++) {
+      if (output_tensors[i].tensor) {
+        // The caller gives the node its final name.
+        Status s = CreateNodeDef("folded", output_tensors[i],
+                                 &result->outputs[i], total_inputs_size);
+        if (!s.ok()) {
+          result->result_too_large = true;
+          result->outputs.clear();
+          return s;
+        }
+      } else {
+        // Create an empty NodeDef to identify dead outputs (e.g. the output of
+        // a switch that's not selected by the switch predicate).
+        result->outputs[i] = NodeDef();
+      }
+    }
+    return Status::OK();
+  }();
+
+  size_t result_bytes = 0;
+  for (const NodeDef& output : result->outputs) {
+    result_bytes += output.ByteSizeLong();
+  }
+  mutex_lock l(evaluation_cache_mu_);
+  if (evaluation_cache_bytes_ + result_bytes <= kMaxEvaluationCacheBytes &&
+      evaluation_cache_.try_emplace(fingerprint, *result).second) {
+    evaluation_cache_bytes_ += result_bytes;
+  }
+}
+
+void ConstantFolding::PrefetchFoldableNodes(
+    const std::deque<NodeDef*>& nodes,
+    const std::unordered_set<string>& processed_nodes,
+    std::unique_ptr<thread::ThreadPool>* thread_pool) {
+  std::vector<const NodeDef*> pending_nodes;
+  absl::flat_hash_set<const NodeDef*> seen_nodes;
+  for (const NodeDef* node : nodes) {
+    if (!IsMerge(*node) && !processed_nodes.count(node->name()) &&
+        seen_nodes.insert(node).second) {
+      pending_nodes.push_back(node);
+    }
+  }
+
+  // Nodes of the frontier are usually folded in topological order, so a node
+  // often only becomes foldable once its inputs have been folded. We evaluate
+  // those in waves, using the outputs computed by the previous waves.
+  absl::flat_hash_map<string, EvaluationResult> prefetched;
+  const auto get_input_values =
+      [&](const NodeDef& node,
+          std::vector<const TensorProto*>* input_values) -> bool {
+    for (const string& input : node.input()) {
+      const TensorId input_tensor = ParseTensorName(input);
+      if (input_tensor.index() < 0) break;
+      const NodeDef* input_node = node_map_->GetNode(input);
+      if (IsReallyConstant(*input_node)) {
+        input_values->push_back(&input_node->attr().at("value").tensor());
+        continue;
+      }
+      auto it = prefetched.find(input_node->name());
+      if (it == prefetched.end() || !it->second.status.ok() ||
+          input_tensor.index() >= it->second.outputs.size()) {
+        return false;
+      }
+      const NodeDef& value = it->second.outputs[input_tensor.index()];
+      if (value.name().empty()) return false;  // Dead output.
+      input_values->push_back(&value.attr().at("value").tensor());
+    }
+    return true;
+  };
+
+  while (true) {
+    std::vector<const NodeDef*> wave;
+    std::vector<std::vector<const TensorProto*>> wave_inputs;
+    std::vector<const NodeDef*> remaining_nodes;
+    for (const NodeDef* node : pending_nodes) {
+      std::vector<const TensorProto*> input_values;
+      if (get_input_values(*node, &input_values)) {
+        wave.push_back(node);
+        wave_inputs.push_back(std::move(input_values));
+      } else {
+        remaining_nodes.push_back(node);
+      }
+    }
+    // Running a single node doesn't need the thread pool, and FoldNode() will
+    // evaluate it anyway.
+    if (wave.size() < 2) return;
+    pending_nodes.swap(remaining_nodes);
+
+    if (*thread_pool == nullptr) {
+      // Use a dedicated pool: the kernels we evaluate run their own work on
+      // the thread pool of cpu_device_, and must not wait behind our
+      // evaluations.
+      thread_pool->reset(new thread::ThreadPool(
+          Env::Default(), "constant_folding", port::MaxParallelism()));
+    }
+    VLOG(2) << "Evaluating " << wave.size() << " nodes in parallel";
+    std::vector<EvaluationResult> results(wave.size());
+    BlockingCounter counter(wave.size());
+    for (int i = 0; i < wave.size(); ++i) {
+      (*thread_pool)->Schedule([this, &wave, &wave_inputs, &results, &counter,
+                                i]() {
+        // Same as in Optimize(), since these are thread local.
+        port::ScopedFlushDenormal flush;
+        port::ScopedSetRound round(FE_TONEAREST);
+        EvaluateWithCache(*wave[i], wave_inputs[i], &results[i]);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    for (int i = 0; i < wave.size(); ++i) {
+      prefetched.emplace(wave[i]->name(), std::move(results[i]));
     }
   }
-  return Status::OK();
 }
 
 Status ConstantFolding::FoldMergeNode(NodeDef* node, GraphDef* output_graph) {
@@ -1588,29 +1746,38 @@ Status ConstantFolding::FoldGraph(
       queue.push_back(graph_->mutable_node(i));
     }
   }
+  std::unique_ptr<thread::ThreadPool> thread_pool;
   while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
-    }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    std::vector<NodeDef*> fanout =
-        node_map_->GetOutputsOrderedByNodeName(node->name());
-    bool result_too_large = false;
-    Status s = FoldNode(node, output, &result_too_large);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
-      if (result_too_large) {
-        nodes_to_not_simplify->emplace(node->name());
+    // Folding proceeds one frontier at a time. Evaluating the nodes of each
+    // frontier upfront doesn't change what gets folded below, it only makes
+    // sure that the evaluations are found in the cache.
+    PrefetchFoldableNodes(queue, processed_nodes, &thread_pool);
+    std::deque<NodeDef*> frontier;
+    frontier.swap(queue);
+    while (!frontier.empty()) {
+      NodeDef* node = frontier.front();
+      frontier.pop_front();
+      if (processed_nodes.count(node->name())) {
+        continue;
       }
-    } else {
-      for (auto& output : fanout) {
-        if (IsFoldable(*output, &properties)) {
-          queue.push_back(output);
+      // We need to record a copy of output nodes before FoldNode() modifies it.
+      // We also need to ensure that the fanout is sorted deterministically.
+      std::vector<NodeDef*> fanout =
+          node_map_->GetOutputsOrderedByNodeName(node->name());
+      bool result_too_large = false;
+      Status s = FoldNode(node, output, &result_too_large);
+      processed_nodes.insert(node->name());
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->DebugString()
+                << "\nError message: " << s;
+        if (result_too_large) {
+          nodes_to_not_simplify->emplace(node->name());
+        }
+      } else {
+        for (auto& output : fanout) {
+          if (IsFoldable(*output, &properties)) {
+            queue.push_back(output);
+          }
         }
       }
     }
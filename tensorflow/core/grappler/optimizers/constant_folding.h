@@ -26,6 +26,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -94,6 +98,25 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // Result of evaluating a node with EvaluateWithCache().
+  struct EvaluationResult {
+    Status status;
+    bool result_too_large = false;
+    // Unnamed constant nodes holding the outputs of the node.
+    std::vector<NodeDef> outputs;
+  };
+  // Evaluates `node` on `input_values`. Results are memoized by the op,
+  // attributes and input values of the node. Thread safe.
+  void EvaluateWithCache(const NodeDef& node,
+                         absl::Span<const TensorProto* const> input_values,
+                         EvaluationResult* result);
+
+  // Evaluates the foldable nodes in `nodes` in parallel, so that folding them
+  // finds their results in the cache.
+  void PrefetchFoldableNodes(const std::deque<NodeDef*>& nodes,
+                             const std::unordered_set<string>& processed_nodes,
+                             std::unique_ptr<thread::ThreadPool>* thread_pool);
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
                   bool* result_too_large);
@@ -327,6 +350,13 @@ class ConstantFolding : public GraphOptimizer {
   bool has_fetch_;
   bool graph_modified_;
   bool graph_contains_assign_or_inplace_op_;
+
+  // Results of past evaluations, kept across optimization passes and keyed by
+  // the fingerprint of the node's op, attributes and input values.
+  mutex evaluation_cache_mu_;
+  absl::flat_hash_map<Fprint128, EvaluationResult, Fprint128Hasher>
+      evaluation_cache_ TF_GUARDED_BY(evaluation_cache_mu_);
+  size_t evaluation_cache_bytes_ TF_GUARDED_BY(evaluation_cache_mu_) = 0;
 };
 
 }  // end namespace grappler
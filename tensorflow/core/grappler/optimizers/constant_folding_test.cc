@@ -254,6 +254,62 @@ TEST_F(ConstantFoldingTest, SimpleFolding) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, FoldsWideFrontiers) {
+  // Many independent foldable nodes, some of which perform the same
+  // computation, followed by a second level of foldable nodes.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(s.WithOpName("a"), 1.0f, {16});
+  Output b = ops::Const(s.WithOpName("b"), 2.0f, {16});
+  std::vector<Output> level_1;
+  std::vector<Output> level_2;
+  for (int i = 0; i < 8; ++i) {
+    Output c = ops::Const(s.WithOpName(strings::StrCat("c", i)),
+                          static_cast<float>(i % 4), {16});
+    level_1.push_back(
+        ops::AddN(s.WithOpName(strings::StrCat("add", i)), {a, c}));
+    level_2.push_back(ops::Mul(s.WithOpName(strings::StrCat("mul", i)),
+                               level_1.back(), b));
+  }
+  Output sum = ops::AddN(s.WithOpName("sum"), level_2);
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({16}));
+  Output out = ops::Mul(s.WithOpName("out"), sum, x);
+
+  GrapplerItem item;
+  item.fetch = {"out"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "sum") {
+      EXPECT_EQ("Const", node.op());
+      ++found;
+    } else if (node.name() == "out") {
+      EXPECT_EQ("Mul", node.op());
+      ++found;
+    }
+  }
+  EXPECT_EQ(2, found);
+
+  // Optimizing the same graph again reuses the memoized evaluations.
+  GraphDef second_output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &second_output));
+  CompareGraphs(output, second_output);
+
+  Tensor x_t(DT_FLOAT, TensorShape({16}));
+  test::FillIota<float>(&x_t, 1.0f);
+  auto tensors_expected =
+      EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors_expected.size());
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, AddTree) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
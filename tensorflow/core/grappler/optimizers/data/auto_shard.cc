@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/data/auto_shard.h"
 
+#include <algorithm>
+#include <numeric>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
@@ -30,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
 #include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
@@ -41,6 +48,7 @@ constexpr char kShardDatasetOpName[] = "ShardDataset";
 constexpr char kShuffleDatasetOpName[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2OpName[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3OpName[] = "ShuffleDatasetV3";
+constexpr char kTensorSliceDatasetOpName[] = "TensorSliceDataset";
 
 constexpr char kNumWorkersAttrName[] = "num_workers";
 constexpr char kIndexAttrName[] = "index";
@@ -195,6 +203,100 @@ Status AddShardNode(MutableGraphView* graph, const NodeDef& add_before,
   return Status::OK();
 }
 
+// Assigns each of the files with the given sizes to one of `num_workers`
+// workers, balancing the number of bytes each worker reads. Files are placed
+// from the largest to the smallest on the worker with the fewest bytes, and
+// ties are broken by the number of files and then the worker index, so the
+// assignment only depends on the sizes.
+std::vector<int64> BalanceFilesBySize(const std::vector<uint64>& file_sizes,
+                                      int64 num_workers) {
+  std::vector<int64> order(file_sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&file_sizes](int64 a, int64 b) {
+    return file_sizes[a] > file_sizes[b];
+  });
+  std::vector<std::pair<uint64, int64>> loads(num_workers, {0, 0});
+  std::vector<int64> assignment(file_sizes.size());
+  for (int64 file : order) {
+    const int64 worker =
+        std::min_element(loads.begin(), loads.end()) - loads.begin();
+    assignment[file] = worker;
+    loads[worker].first += file_sizes[file];
+    loads[worker].second++;
+  }
+  return assignment;
+}
+
+// Shards the files that `add_before` reads by size, if they are a constant
+// vector of file names sliced by a TensorSliceDataset: the vector is replaced
+// by the files that BalanceFilesBySize assigns to worker `index`. Otherwise,
+// or if a file size is unavailable, falls back to AddShardNode.
+Status AddFileSizeBalancedShard(MutableGraphView* graph,
+                                const NodeDef& add_before, int64 num_workers,
+                                int64 index) {
+  NodeDef* slice_node = graph->GetNode(add_before.input(0));
+  NodeDef* filenames_node =
+      slice_node != nullptr && slice_node->op() == kTensorSliceDatasetOpName &&
+              slice_node->input_size() == 1
+          ? graph->GetNode(slice_node->input(0))
+          : nullptr;
+  Tensor filenames;
+  if (filenames_node == nullptr || filenames_node->op() != "Const" ||
+      !GetNodeAttr(*filenames_node, "value", &filenames).ok() ||
+      filenames.dtype() != DT_STRING || filenames.dims() != 1 ||
+      filenames.NumElements() < num_workers) {
+    VLOG(1) << "Sharding the files of " << add_before.name()
+            << " round-robin, as they are not a constant vector of at least "
+            << num_workers << " file names.";
+    return AddShardNode(graph, add_before, num_workers, index);
+  }
+
+  const auto names = filenames.vec<tstring>();
+  std::vector<uint64> file_sizes(names.size());
+  for (int64 i = 0; i < names.size(); ++i) {
+    Status s = Env::Default()->GetFileSize(names(i), &file_sizes[i]);
+    if (!s.ok()) {
+      LOG(WARNING) << "Sharding the files of " << add_before.name()
+                   << " round-robin, as the size of " << names(i)
+                   << " is unavailable: " << s;
+      return AddShardNode(graph, add_before, num_workers, index);
+    }
+  }
+  const std::vector<int64> assignment =
+      BalanceFilesBySize(file_sizes, num_workers);
+
+  std::vector<string> worker_files;
+  uint64 worker_bytes = 0;
+  uint64 total_bytes = 0;
+  for (int64 i = 0; i < names.size(); ++i) {
+    total_bytes += file_sizes[i];
+    if (assignment[i] == index) {
+      worker_files.emplace_back(names(i));
+      worker_bytes += file_sizes[i];
+    }
+  }
+  LOG(INFO) << "Worker " << index << " of " << num_workers << " reads "
+            << worker_files.size() << " of " << names.size() << " files ("
+            << worker_bytes << " of " << total_bytes << " bytes) for "
+            << add_before.name();
+  VLOG(1) << "Files read by worker " << index << ": "
+          << absl::StrJoin(worker_files, ", ");
+
+  const int64 num_worker_files = worker_files.size();
+  Tensor worker_filenames(DT_STRING, TensorShape({num_worker_files}));
+  for (int64 i = 0; i < num_worker_files; ++i) {
+    worker_filenames.vec<tstring>()(i) = worker_files[i];
+  }
+  NodeDef new_node = *filenames_node;
+  graph_utils::SetUniqueGraphNodeName(filenames_node->name(), graph->graph(),
+                                      &new_node);
+  worker_filenames.AsProtoField(
+      (*new_node.mutable_attr())["value"].mutable_tensor());
+  NodeDef* new_node_graph = graph->AddNode(std::move(new_node));
+  return graph->UpdateRegularFaninByPort(slice_node->name(), 0,
+                                         {new_node_graph->name(), 0});
+}
+
 Status AddShuffleDataset(MutableGraphView* graph, const NodeDef& add_before,
                          const string& buffer_size_node,
                          const string& seed_node, const string& seed2_node,
@@ -372,7 +474,8 @@ Status RemoveShuffleDatasetV3(MutableGraphView* graph, const NodeDef& node,
 
 Status ProcessDatasetSourceNode(MutableGraphView* graph, const NodeDef& node,
                                 absl::flat_hash_set<string>* nodes_to_delete,
-                                int64 num_workers, int64 index) {
+                                int64 num_workers, int64 index,
+                                AutoShardPolicy policy) {
   string shuffle_op_name = "";
   string buffer_size_node = "";
   string seed_node = "";
@@ -380,7 +483,12 @@ Status ProcessDatasetSourceNode(MutableGraphView* graph, const NodeDef& node,
   string seed_generator_node = "";
   bool reshuffle_each_iteration;
 
-  TF_RETURN_IF_ERROR(AddShardNode(graph, node, num_workers, index));
+  if (policy == AutoShardPolicy::BALANCED_FILE) {
+    TF_RETURN_IF_ERROR(
+        AddFileSizeBalancedShard(graph, node, num_workers, index));
+  } else {
+    TF_RETURN_IF_ERROR(AddShardNode(graph, node, num_workers, index));
+  }
   TF_RETURN_IF_ERROR(RemoveShuffleDataset(
       graph, node, nodes_to_delete, &shuffle_op_name, &buffer_size_node,
       &seed_node, &seed2_node, &reshuffle_each_iteration));
@@ -413,6 +521,7 @@ Status ProcessDatasetSourceNode(MutableGraphView* graph, const NodeDef& node,
 }
 
 Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
+                           AutoShardPolicy policy,
                            FunctionLibraryDefinition* flib,
                            MutableGraphView* graph,
                            absl::flat_hash_set<string>* nodes_to_delete) {
@@ -422,8 +531,8 @@ Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
     nodes_to_delete->insert(node.name());
     TF_RETURN_IF_ERROR(graph->UpdateFanouts(node.name(), node.input(0)));
     const NodeDef* input_node = graph_utils::GetInputNode(node, *graph, 0);
-    return RecursivelyHandleOp(*input_node, num_workers, index, flib, graph,
-                               nodes_to_delete);
+    return RecursivelyHandleOp(*input_node, num_workers, index, policy, flib,
+                               graph, nodes_to_delete);
   }
 
   if (IsDatasetNodeOfType(node, kUnshardableSourceDatasetOps)) {
@@ -435,7 +544,8 @@ Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
     for (int i = 0; i < node.input_size(); ++i) {
       const NodeDef* input_node = graph_utils::GetInputNode(node, *graph, i);
       TF_RETURN_IF_ERROR(RecursivelyHandleOp(*input_node, num_workers, index,
-                                             flib, graph, nodes_to_delete));
+                                             policy, flib, graph,
+                                             nodes_to_delete));
     }
     return Status::OK();
   }
@@ -451,13 +561,13 @@ Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
   if (IsDatasetNodeOfType(node, kFuncDatasetOps) &&
       ReaderOpInFunction(node, *flib)) {
     return ProcessDatasetSourceNode(graph, node, nodes_to_delete, num_workers,
-                                    index);
+                                    index, policy);
   }
 
   if (IsDatasetNodeOfType(node, kReaderDatasetOps)) {
     // We reached a reader dataset directly and we try to shard input 0.
     return ProcessDatasetSourceNode(graph, node, nodes_to_delete, num_workers,
-                                    index);
+                                    index, policy);
   }
 
   if (!IsDatasetNodeOfType(node, kPassThroughOps)) {
@@ -473,8 +583,8 @@ Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
   }
 
   const NodeDef* input_node = graph_utils::GetInputNode(node, *graph, 0);
-  return RecursivelyHandleOp(*input_node, num_workers, index, flib, graph,
-                             nodes_to_delete);
+  return RecursivelyHandleOp(*input_node, num_workers, index, policy, flib,
+                             graph, nodes_to_delete);
 }
 
 Status OptimizeGraph(const GrapplerItem& item, int64 num_workers, int64 index,
@@ -504,8 +614,10 @@ Status OptimizeGraph(const GrapplerItem& item, int64 num_workers, int64 index,
       return Status::OK();
 
     case AutoShardPolicy::FILE:
+    case AutoShardPolicy::BALANCED_FILE:
       TF_RETURN_IF_ERROR(RecursivelyHandleOp(*sink_node, num_workers, index,
-                                             &flib, &graph, &nodes_to_delete));
+                                             policy, &flib, &graph,
+                                             &nodes_to_delete));
       return graph.DeleteNodes(nodes_to_delete);
       break;
 
@@ -515,8 +627,8 @@ Status OptimizeGraph(const GrapplerItem& item, int64 num_workers, int64 index,
 
     case AutoShardPolicy::AUTO:
     default:
-      Status s = RecursivelyHandleOp(*sink_node, num_workers, index, &flib,
-                                     &graph, &nodes_to_delete);
+      Status s = RecursivelyHandleOp(*sink_node, num_workers, index, policy,
+                                     &flib, &graph, &nodes_to_delete);
       if (!s.ok() && errors::IsNotFound(s)) {
         LOG(WARNING) << "In AUTO-mode, and switching to DATA-based sharding, "
                         "instead of FILE-based sharding as we cannot find "
@@ -557,7 +669,8 @@ Status AutoShard::Init(
   if (auto_shard_policy_ != AutoShardPolicy::OFF &&
       auto_shard_policy_ != AutoShardPolicy::AUTO &&
       auto_shard_policy_ != AutoShardPolicy::DATA &&
-      auto_shard_policy_ != AutoShardPolicy::FILE) {
+      auto_shard_policy_ != AutoShardPolicy::FILE &&
+      auto_shard_policy_ != AutoShardPolicy::BALANCED_FILE) {
     return errors::InvalidArgument(kAutoShardPolicyAttrName, " is invalid.");
   }
 
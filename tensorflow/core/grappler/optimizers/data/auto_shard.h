@@ -21,7 +21,15 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-enum class AutoShardPolicy { OFF = -1, AUTO = 0, FILE = 1, DATA = 2 };
+// BALANCED_FILE is like FILE, but assigns the files to workers by size
+// rather than round-robin when the file names are a constant.
+enum class AutoShardPolicy {
+  OFF = -1,
+  AUTO = 0,
+  FILE = 1,
+  DATA = 2,
+  BALANCED_FILE = 3
+};
 
 // AutoShard takes a Dataset graph and tries to insert a shard node
 // automatically before a ReaderDataset (e.g. a CSVDataset or a TFRecordDataset)
@@ -56,6 +56,7 @@ constexpr char kParallelMapOp[] = "ParallelMapDataset";
 constexpr char kParallelMapV2Op[] = "ParallelMapDatasetV2";
 constexpr char kChooseFastestOp[] = "ChooseFastestBranchDataset";
 constexpr char kPrefetchOp[] = "PrefetchDataset";
+constexpr char kUnbatchOp[] = "UnbatchDataset";
 
 // Returns a FunctionDef containing a MapDefun op that wraps the original
 // function.
@@ -526,6 +527,147 @@ bool FindMapAndBatchPattern(const MutableGraphView& graph, const NodeDef& node,
   return true;
 }
 
+// Given an input pipeline graph and a query node, tries to match the node to
+// a parallel 'map' node whose map_fn can be applied to micro-batches of its
+// input elements.
+bool FindStandaloneMapPattern(const MutableGraphView& graph,
+                              const NodeDef& node,
+                              const FunctionLibraryDefinition& function_library,
+                              const NodeDef** map_node_output,
+                              const NodeDef** input_node_output,
+                              const FunctionDef** map_fn_output) {
+  if (node.op() != kParallelMapOp && node.op() != kParallelMapV2Op) {
+    return false;
+  }
+  const NodeDef* map_node = &node;
+  if (!IsOutputShapesFullyDefined(*map_node)) {
+    VLOG(1) << "Cannot micro-batch dataset.map() because the map dataset "
+               "does not have fully defined output shapes.";
+    return false;
+  }
+  const NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+  DCHECK_NE(input_node, nullptr);
+  if (!IsOutputShapesFullyDefined(*input_node)) {
+    VLOG(1) << "Cannot micro-batch dataset.map() because the input dataset "
+               "does not have fully defined output shapes.";
+    return false;
+  }
+  const FunctionDef* map_fn =
+      function_library.Find(map_node->attr().at("f").func().name());
+  if (map_fn == nullptr ||
+      function_utils::IsFunctionStateful(function_library, *map_fn)) {
+    VLOG(1) << "Cannot micro-batch dataset.map() because the map function is "
+               "stateful.";
+    return false;
+  }
+  *map_node_output = map_node;
+  *input_node_output = input_node;
+  *map_fn_output = map_fn;
+  return true;
+}
+
+// Like `AddVectorizedFunction`, but only adds the vectorized function to
+// `library` if none of `orig_func` is left to a MapDefun op, which would run
+// the original function once per element anyway. Returns nullptr otherwise.
+FunctionDef* AddFullyVectorizedFunction(const NodeDef& map_node,
+                                        const FunctionDef& orig_func,
+                                        FunctionDefLibrary* library) {
+  FunctionDefLibrary scratch_library = *library;
+  FunctionDef* vectorized_func =
+      CreateMapDefunWrapper(map_node, orig_func, &scratch_library);
+  FunctionDef* result;
+  Status s = vectorization_utils::VectorizeMapDefun(
+      *vectorized_func, vectorized_func->node_def(0), &scratch_library,
+      &result);
+  if (!s.ok()) {
+    VLOG(1) << "Cannot micro-batch dataset.map() because VectorizeMapDefun "
+               "failed: "
+            << s;
+    return nullptr;
+  }
+  if (function_utils::ContainsFunctionNodeWithOp("MapDefun", *result)) {
+    VLOG(1) << "Cannot micro-batch dataset.map() because the map function "
+               "could only be vectorized partially.";
+    return nullptr;
+  }
+  const string result_name = result->signature().name();
+  library->Swap(&scratch_library);
+  int index = graph_utils::FindGraphFunctionWithName(result_name, *library);
+  DCHECK_NE(index, -1);
+  return library->mutable_function(index);
+}
+
+// Prepends an unknown batch dimension to each of the shapes in `shapes_attr`.
+void AddUnknownBatchDimension(AttrValue* shapes_attr) {
+  for (TensorShapeProto& shape :
+       *shapes_attr->mutable_list()->mutable_shape()) {
+    TensorShapeProto batched_shape;
+    batched_shape.add_dim()->set_size(-1);
+    batched_shape.MergeFrom(shape);
+    shape = std::move(batched_shape);
+  }
+}
+
+Status AddMicroBatchNode(const NodeDef& old_map_node, const NodeDef& input_node,
+                         const FunctionDef& vectorized_func,
+                         int64 micro_batch_size, MutableGraphView* graph,
+                         NodeDef** new_batch_node) {
+  NodeDef batch_node;
+  batch_node.set_op(kBatchV2Op);
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &batch_node);
+
+  // `input_dataset`
+  batch_node.add_input(input_node.name());
+
+  // `batch_size`
+  auto batch_size_val =
+      graph_utils::AddScalarConstNode(micro_batch_size, graph);
+  batch_node.add_input(batch_size_val->name());
+
+  // `drop_remainder` == false, so that the last micro-batch keeps the
+  // remaining elements.
+  auto drop_remainder_val = graph_utils::AddScalarConstNode(false, graph);
+  batch_node.add_input(drop_remainder_val->name());
+
+  // The input elements are the leading arguments of the map function, followed
+  // by its captured inputs.
+  auto& output_types = (*batch_node.mutable_attr())["output_types"];
+  int num_components = vectorized_func.signature().input_arg_size() -
+                       old_map_node.attr().at("Targuments").list().type_size();
+  for (int i = 0; i < num_components; ++i) {
+    output_types.mutable_list()->add_type(
+        vectorized_func.signature().input_arg(i).type());
+  }
+
+  // It is safe to assume that input_node has the "output_shapes" attr here,
+  // because FindStandaloneMapPattern checked that its shapes are fully defined.
+  auto& output_shapes = (*batch_node.mutable_attr())["output_shapes"];
+  output_shapes = input_node.attr().at("output_shapes");
+  AddUnknownBatchDimension(&output_shapes);
+
+  *new_batch_node = graph->AddNode(std::move(batch_node));
+  return Status::OK();
+}
+
+Status AddUnbatchNode(const NodeDef& old_map_node, const NodeDef& new_map_node,
+                      MutableGraphView* graph, NodeDef** new_unbatch_node) {
+  NodeDef unbatch_node;
+  unbatch_node.set_op(kUnbatchOp);
+  graph_utils::SetUniqueGraphNodeName(unbatch_node.op(), graph->graph(),
+                                      &unbatch_node);
+
+  // `input_dataset`
+  unbatch_node.add_input(new_map_node.name());
+
+  for (auto key : {"output_shapes", "output_types"}) {
+    graph_utils::CopyAttribute(key, old_map_node, &unbatch_node);
+  }
+
+  *new_unbatch_node = graph->AddNode(std::move(unbatch_node));
+  return Status::OK();
+}
+
 }  // namespace
 
 Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
@@ -618,6 +760,73 @@ Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
     TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
     stats->num_changes++;
   }
+
+  if (micro_batch_size_ <= 0) return Status::OK();
+
+  for (const NodeDef& node : item.graph.node()) {
+    // Skips the maps that were vectorized along with their batch above.
+    if (nodes_to_delete.contains(node.name())) continue;
+    FunctionLibraryDefinition function_library(OpRegistry::Global(), *library);
+    const NodeDef* map_node;
+    const NodeDef* input_node;
+    const FunctionDef* map_func;
+    if (!FindStandaloneMapPattern(graph, *graph.GetNode(node.name()),
+                                  function_library, &map_node, &input_node,
+                                  &map_func)) {
+      continue;
+    }
+
+    // Micro-batching only pays off if a micro-batch goes through the map
+    // function in one pass.
+    FunctionDef* vectorized_func =
+        AddFullyVectorizedFunction(*map_node, *map_func, library);
+    if (vectorized_func == nullptr) continue;
+
+    NodeDef* new_batch_node;
+    TF_RETURN_IF_ERROR(AddMicroBatchNode(*map_node, *input_node,
+                                         *vectorized_func, micro_batch_size_,
+                                         &graph, &new_batch_node));
+
+    // The new map produces the output types of the original map, with an
+    // additional batch dimension in the output shapes.
+    NodeDef* new_map_node;
+    TF_RETURN_IF_ERROR(AddNewMapNode(*map_node, /*old_batch_node=*/*map_node,
+                                     *new_batch_node, *vectorized_func, &graph,
+                                     &new_map_node));
+    AddUnknownBatchDimension(
+        &(*new_map_node->mutable_attr())["output_shapes"]);
+
+    NodeDef* new_unbatch_node;
+    TF_RETURN_IF_ERROR(
+        AddUnbatchNode(*map_node, *new_map_node, &graph, &new_unbatch_node));
+
+    std::vector<const NodeDef*> vectorized_branch(
+        {new_batch_node, new_map_node, new_unbatch_node});
+    std::vector<const NodeDef*> original_branch({map_node});
+    nodes_to_delete.insert(map_node->name());
+
+    if (use_choose_fastest_) {
+      for (const auto& n : vectorized_branch) {
+        nodes_to_delete.insert(n->name());
+      }
+      // Both branches produce one output element per input element.
+      auto ratio_numerator =
+          graph_utils::AddScalarConstNode(static_cast<int64>(1), &graph);
+      NodeDef* new_choose_fastest_node;
+      TF_RETURN_IF_ERROR(AddNewChooseFastestNode(
+          input_node, ratio_numerator->name(), std::move(original_branch),
+          std::move(vectorized_branch), &graph, library,
+          &new_choose_fastest_node));
+      TF_RETURN_IF_ERROR(graph.UpdateFanouts(map_node->name(),
+                                             new_choose_fastest_node->name()));
+    } else {
+      TF_RETURN_IF_ERROR(
+          graph.UpdateFanouts(map_node->name(), new_unbatch_node->name()));
+    }
+
+    TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+    stats->num_changes++;
+  }
   return Status::OK();
 }
 
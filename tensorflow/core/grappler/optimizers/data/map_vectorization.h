@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -40,6 +41,17 @@ namespace grappler {
 // ChooseFastestBranch dataset node to pick between the original map->batch
 // branch and the vectorized batch->map branch.
 //
+// If the "micro_batch_size" configuration is positive, it also rewrites
+// parallel maps that are not followed by a batch, provided that their map_fn
+// can be vectorized completely. Groups of "micro_batch_size" elements then go
+// through a single call of the vectorized map_fn:
+//
+// From:
+//      input --> parallel_map --> output
+//
+// To:
+//      input --> batch --> parallel_map --> unbatch --> output
+//
 class MapVectorization : public TFDataOptimizerBase {
  public:
   MapVectorization() = default;
@@ -64,6 +76,16 @@ class MapVectorization : public TFDataOptimizerBase {
           "Received an invalid value for parameter \"use_choose_fastest\"",
           choose_fastest_param);
     }
+
+    auto it = config->parameter_map().find("micro_batch_size");
+    if (it != config->parameter_map().end()) {
+      if (!strings::safe_strto64(it->second.s(), &micro_batch_size_) ||
+          micro_batch_size_ < 0) {
+        return errors::Internal(
+            "Received an invalid value for parameter \"micro_batch_size\"",
+            it->second.s());
+      }
+    }
     return Status::OK();
   }
 
@@ -76,6 +98,9 @@ class MapVectorization : public TFDataOptimizerBase {
 
  private:
   bool use_choose_fastest_ = false;
+  // Number of elements that a standalone parallel map processes per call of
+  // its vectorized function, or 0 to leave standalone maps as they are.
+  int64 micro_batch_size_ = 0;
 };
 
 }  // namespace grappler
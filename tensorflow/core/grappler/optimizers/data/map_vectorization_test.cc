@@ -41,6 +41,7 @@ constexpr char kMapOp[] = "MapDataset";
 constexpr char kParallelMapOp[] = "ParallelMapDatasetV2";
 constexpr char kChooseFastestOp[] = "ChooseFastestBranchDataset";
 constexpr char kPrefetchOp[] = "PrefetchDataset";
+constexpr char kUnbatchOp[] = "UnbatchDataset";
 constexpr char kAttrNameF[] = "f";
 constexpr char kAttrNameTarguments[] = "Targuments";
 constexpr char kAttrNameOutputTypes[] = "output_types";
@@ -66,6 +67,19 @@ Status OptimizeWithMapVectorization(const GrapplerItem& item, GraphDef* output,
   return optimizer.Optimize(nullptr, item, output);
 }
 
+Status OptimizeWithMicroBatching(const GrapplerItem& item, GraphDef* output,
+                                 int64 micro_batch_size,
+                                 bool use_choose_fastest) {
+  MapVectorization optimizer;
+  RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())["use_choose_fastest"].set_s(
+      use_choose_fastest ? "true" : "false");
+  (*config.mutable_parameter_map())["micro_batch_size"].set_s(
+      strings::StrCat(micro_batch_size));
+  TF_RETURN_IF_ERROR(optimizer.Init(&config));
+  return optimizer.Optimize(nullptr, item, output);
+}
+
 // Adds a simple vectorizable map function that is akin to
 // dataset.map(lambda x: tf.identity(x))
 FunctionDef* AddMapFn(MutableGraphView* graph) {
@@ -586,6 +600,116 @@ TEST(MapVectorizationTest, VectorizeWithUndefinedOutputTypes) {
       input_node->name());
 }
 
+TEST(MapVectorizationTest, MicroBatchStandaloneMap) {
+  // Tests that a parallel map that is not followed by a batch is rewritten to
+  // batch -> vectorized map -> unbatch.
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  auto range_node = AddRangeNode(&graph);
+  auto map_fn = AddMapFn(&graph);
+  auto map_node = AddMapNode(&graph, range_node->name(),
+                             map_fn->signature().name(), 4);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMicroBatching(item, &output, 16,
+                                         /*use_choose_fastest=*/false));
+  CheckVectorizedWithoutChooseFastest(
+      output, {kBatchV2Op, kParallelMapOp, kUnbatchOp}, range_node->name());
+
+  const NodeDef& batch_node =
+      output.node(graph_utils::FindGraphNodeWithOp(kBatchV2Op, output));
+  const NodeDef* batch_size_node = graph_utils::GetInputNode(
+      batch_node, MutableGraphView(&output), /*i=*/1);
+  ASSERT_NE(batch_size_node, nullptr);
+  EXPECT_EQ(batch_size_node->attr().at(kAttrNameValue).tensor().int64_val(0),
+            16);
+  const NodeDef& new_map_node =
+      output.node(graph_utils::FindGraphNodeWithOp(kParallelMapOp, output));
+  EXPECT_EQ(
+      PartialTensorShape(
+          new_map_node.attr().at(kAttrNameOutputShapes).list().shape(0))
+          .DebugString(),
+      "[?]");
+  const NodeDef& unbatch_node =
+      output.node(graph_utils::FindGraphNodeWithOp(kUnbatchOp, output));
+  EXPECT_EQ(unbatch_node.attr().at(kAttrNameOutputShapes).DebugString(),
+            map_node->attr().at(kAttrNameOutputShapes).DebugString());
+}
+
+TEST(MapVectorizationTest, MicroBatchStandaloneMapWithChooseFastest) {
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  auto range_node = AddRangeNode(&graph);
+  auto map_fn = AddMapFn(&graph);
+  auto map_node = AddMapNode(&graph, range_node->name(),
+                             map_fn->signature().name(), 4);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMicroBatching(item, &output, 16,
+                                         /*use_choose_fastest=*/true));
+  ASSERT_EQ(graph_utils::FindAllGraphNodesWithOp(kUnbatchOp, output).size(),
+            0);
+  CheckVectorizedWithChooseFastest(
+      output,
+      /*expected_vectorized_branch=*/{kBatchV2Op, map_node->op(), kUnbatchOp},
+      /*expected_original_branch=*/{map_node->op()}, range_node->name());
+}
+
+TEST(MapVectorizationTest, NoMicroBatchingByDefault) {
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  auto range_node = AddRangeNode(&graph);
+  auto map_fn = AddMapFn(&graph);
+  AddMapNode(&graph, range_node->name(), map_fn->signature().name(), 4);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapVectorization(item, &output, false));
+  EXPECT_EQ(graph_utils::FindAllGraphNodesWithOp(kBatchV2Op, output).size(),
+            0);
+  EXPECT_EQ(graph_utils::FindAllGraphNodesWithOp(kUnbatchOp, output).size(),
+            0);
+}
+
+TEST(MapVectorizationTest, MicroBatchingKeepsMapThenBatchVectorization) {
+  // Tests that a map followed by a batch is vectorized as before, rather than
+  // micro-batched.
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  auto range_node = AddRangeNode(&graph);
+  auto map_fn = AddMapFn(&graph);
+  auto map_node = AddMapNode(&graph, range_node->name(),
+                             map_fn->signature().name(), 4);
+  auto batch_node = AddBatchNode(&graph, map_node->name());
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMicroBatching(item, &output, 16,
+                                         /*use_choose_fastest=*/false));
+  CheckVectorizedWithoutChooseFastest(
+      output, {batch_node->op(), map_node->op()}, range_node->name());
+  EXPECT_EQ(graph_utils::FindAllGraphNodesWithOp(kUnbatchOp, output).size(),
+            0);
+}
+
+TEST(MapVectorizationTest, NoMicroBatchingOfPartiallyVectorizedFunction) {
+  // Tests that a map function that would still run per element in a MapDefun
+  // is left as it is.
+  GrapplerItem item;
+  MutableGraphView graph(&item.graph);
+  auto range_node = AddRangeNode(&graph);
+  FunctionDef* map_fn = graph.graph()->mutable_library()->add_function();
+  *map_fn = FunctionDefHelper::Create(
+      /*function_name=*/"map_fn",
+      /*in_def=*/{"x: int64"},
+      /*out_def=*/{"res: int64"},
+      /*attr_def=*/{},
+      /*node_def=*/{{{"node"}, "Snapshot", {"x"}, {{"T", DT_INT64}}}},
+      /*ret_def=*/{{"res", "node:output"}});
+  auto map_node = AddMapNode(&graph, range_node->name(),
+                             map_fn->signature().name(), 4);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMicroBatching(item, &output, 16,
+                                         /*use_choose_fastest=*/false));
+  EXPECT_EQ(graph_utils::FindAllGraphNodesWithOp(kUnbatchOp, output).size(),
+            0);
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName(map_node->name(), output));
+}
+
 // TODO(rachelim): Add test that has a polymorphic function.
 
 }  // namespace
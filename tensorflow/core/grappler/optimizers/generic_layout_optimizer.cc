@@ -403,9 +403,20 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   const auto num_gpus_and_num_volta = GetNumGPUs(*cluster);
   const int num_gpus = num_gpus_and_num_volta.first;
   if (num_gpus < 1) {
-    return errors::Aborted(
-        "No GPUs found: GenericLayoutOptimizer is currently only tuned for "
-        "GPU.");
+    switch (cpu_layout_conversion_) {
+      case RewriterConfig::NCHW_TO_NHWC:
+        // CPU kernels expect NHWC, so regions of NCHW layout sensitive ops
+        // are converted as a whole, with transposes only at their borders.
+        break;
+      case RewriterConfig::NHWC_TO_NCHW:
+        return errors::Aborted(
+            "Conversion from NHWC to NCHW is currently not available for "
+            "CPU.");
+      default:
+        return errors::Aborted(
+            "No GPUs found: GenericLayoutOptimizer is currently only tuned "
+            "for GPU, unless cpu_layout_conversion is set.");
+    }
   }
 
   const bool is_aggressive = opt_level_ == RewriterConfig::AGGRESSIVE;
@@ -414,10 +425,14 @@ Status GenericLayoutOptimizer::Optimize(Cluster* cluster,
   TF_RETURN_IF_ERROR(
       TransposeContext::InitializeTransposeContext(item, cluster, &context));
 
-  const auto src_dst_formats =
-      GetSrcAndDstDataFormats(context, num_gpus, num_gpus_and_num_volta.second);
-  context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
-                                     src_dst_formats.second);
+  if (num_gpus > 0) {
+    const auto src_dst_formats = GetSrcAndDstDataFormats(
+        context, num_gpus, num_gpus_and_num_volta.second);
+    context.AssignDeviceAndDataFormats(kGPU, src_dst_formats.first,
+                                       src_dst_formats.second);
+  } else {
+    context.AssignDeviceAndDataFormats(kCPU, kNCHW, kNHWC);
+  }
 
   TransposerFactory transposer_factory;
   TF_RETURN_IF_ERROR(ExpandLayoutSensitiveOp(&context, &transposer_factory));
@@ -27,7 +27,13 @@ class GenericLayoutOptimizer : public GraphOptimizer {
  public:
   GenericLayoutOptimizer() : GenericLayoutOptimizer(RewriterConfig::DEFAULT) {}
   explicit GenericLayoutOptimizer(RewriterConfig::Toggle opt_level)
-      : opt_level_(opt_level) {}
+      : GenericLayoutOptimizer(opt_level,
+                               RewriterConfig::NO_CONVERSION_ON_CPU) {}
+  // On clusters without GPUs, 'layout_conversion' selects the layout
+  // conversion applied to the nodes placed on CPU.
+  GenericLayoutOptimizer(RewriterConfig::Toggle opt_level,
+                         RewriterConfig::CpuLayout layout_conversion)
+      : opt_level_(opt_level), cpu_layout_conversion_(layout_conversion) {}
   ~GenericLayoutOptimizer() override = default;
 
   string name() const override { return "layout"; };
@@ -42,6 +48,7 @@ class GenericLayoutOptimizer : public GraphOptimizer {
 
  private:
   RewriterConfig::Toggle opt_level_;
+  RewriterConfig::CpuLayout cpu_layout_conversion_;
 };
 
 }  // namespace grappler
@@ -315,6 +315,61 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
   VerifyDataFormatAttributeMatch(conv_node, "NHWC");
 }
 
+TEST_F(GenericLayoutOptimizerTest, NCHWToNHWCOnCPUOnlyCluster) {
+  DeviceProperties cpu_device;
+  cpu_device.set_type("CPU");
+  cpu_device.set_frequency(1000);
+  cpu_device.set_num_cores(4);
+  VirtualCluster cpu_cluster({{"/CPU:0", cpu_device}});
+  TF_ASSERT_OK(cpu_cluster.Provision());
+
+  Scope s = Scope::NewRootScope();
+  Tensor input_data(DT_FLOAT, TensorShape({8, 3, 4, 4}));
+  test::FillIota<float>(&input_data, 1.0f);
+  Output input =
+      ops::Const(s.WithOpName("Input"), Input::Initializer(input_data));
+  Tensor filter_data(DT_FLOAT, TensorShape({2, 2, 3, 2}));
+  test::FillIota<float>(&filter_data, 1.0f);
+  Output filter =
+      ops::Const(s.WithOpName("Filter"), Input::Initializer(filter_data));
+  Output conv = ops::Conv2D(s.WithOpName("Conv2D").WithDevice("/CPU:0"),
+                            input, filter, {1, 1, 1, 1}, "VALID",
+                            ops::Conv2D::DataFormat("NCHW"));
+  Output relu = ops::Relu(s.WithOpName("Relu").WithDevice("/CPU:0"), conv);
+  Output fetch = ops::Identity(s.WithOpName("Fetch"), {relu});
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Without conversion selected, the optimizer is skipped on CPU.
+  GraphDef output;
+  EXPECT_FALSE(
+      GenericLayoutOptimizer().Optimize(&cpu_cluster, item, &output).ok());
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::AGGRESSIVE,
+                                   RewriterConfig::NCHW_TO_NHWC);
+  TF_ASSERT_OK(optimizer.Optimize(&cpu_cluster, item, &output));
+
+  Status status;
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  auto* conv_node = graph_view.GetNode("Conv2D");
+  ASSERT_NE(conv_node, nullptr);
+  VerifyDataFormatAttributeMatch(conv_node, "NHWC");
+  VerifyRegularFaninMatch(conv_node, 0,
+                          "Conv2D-0-TransposeNCHWToNHWC-LayoutOptimizer", 0);
+  // The layout agnostic Relu stays in NHWC, so the only transpose back to
+  // NCHW is after it.
+  auto* relu_node = graph_view.GetNode("Relu");
+  ASSERT_NE(relu_node, nullptr);
+  VerifyRegularFaninMatch(relu_node, 0, "Conv2D", 0);
+  auto* fetch_node = graph_view.GetNode("Fetch");
+  ASSERT_NE(fetch_node, nullptr);
+  VerifyRegularFaninMatch(fetch_node, 0,
+                          "Relu-0-0-TransposeNHWCToNCHW-LayoutOptimizer", 0);
+
+  TF_ASSERT_OK(cpu_cluster.Shutdown());
+}
+
 TEST_F(GenericLayoutOptimizerTest, Connectivity) {
 #if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
   GTEST_SKIP() << "Neither CUDA nor ROCm is enabled";
@@ -440,8 +440,104 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns the peak memory usage of `item` on the devices of `cluster` in bytes,
+// as estimated statically by `memory`, or -1 if it can't be estimated.
+int64 InferPeakMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                           GraphMemory* memory) {
+  if (cluster == nullptr || item.fetch.empty()) {
+    return -1;
+  }
+  Status s = memory->InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return -1;
+  }
+  return memory->GetWorstCaseMemoryUsage();
+}
+
+// Only keeps the subgraphs of `subgraphs` that need to be recomputed to bring
+// the peak memory usage of every device of `cluster` down to
+// `peak_memory_target` bytes. Recomputing a subgraph is assumed to free the
+// memory of the tensors it produces that are live at the peak, and subgraphs
+// are picked greedily, the ones freeing the most memory first, so that as few
+// of them as possible are recomputed. If the memory usage of `item` can't be
+// estimated, `subgraphs` is left as is.
+void SelectSubgraphsForPeakMemoryTarget(
+    Cluster* cluster, const GrapplerItem& item, int64 peak_memory_target,
+    std::vector<RecomputedSubGraph>* subgraphs) {
+  GraphMemory memory(item);
+  if (InferPeakMemoryUsage(cluster, item, &memory) < 0) {
+    return;
+  }
+  std::unordered_map<string, int> subgraph_ids;
+  for (int i = 0; i < subgraphs->size(); ++i) {
+    for (const NodeDef* node : (*subgraphs)[i].recomputed_source_nodes) {
+      subgraph_ids[node->name()] = i;
+    }
+  }
+  // The memory that each device still needs to free, and the memory that
+  // recomputing each subgraph frees on every such device.
+  std::unordered_map<string, int64> required_savings;
+  std::vector<std::unordered_map<string, int64>> savings(subgraphs->size());
+  for (const auto& device : cluster->GetDevices()) {
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= peak_memory_target) {
+      continue;
+    }
+    required_savings[device.first] =
+        mem_usage.used_memory - peak_memory_target;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      auto it = subgraph_ids.find(live_tensor.node);
+      if (it != subgraph_ids.end()) {
+        savings[it->second][device.first] += live_tensor.memory_used;
+      }
+    }
+  }
+
+  std::vector<RecomputedSubGraph> selected_subgraphs;
+  std::vector<bool> selected(subgraphs->size(), false);
+  while (!required_savings.empty()) {
+    int best_subgraph = -1;
+    int64 best_savings = 0;
+    for (int i = 0; i < subgraphs->size(); ++i) {
+      if (selected[i]) continue;
+      int64 subgraph_savings = 0;
+      for (const auto& device_savings : savings[i]) {
+        auto it = required_savings.find(device_savings.first);
+        if (it != required_savings.end()) {
+          subgraph_savings += std::min(device_savings.second, it->second);
+        }
+      }
+      if (subgraph_savings > best_savings) {
+        best_subgraph = i;
+        best_savings = subgraph_savings;
+      }
+    }
+    if (best_subgraph < 0) {
+      VLOG(1) << "Recomputation alone can't meet the peak memory target of "
+              << peak_memory_target << " bytes";
+      break;
+    }
+    selected[best_subgraph] = true;
+    selected_subgraphs.push_back((*subgraphs)[best_subgraph]);
+    for (const auto& device_savings : savings[best_subgraph]) {
+      auto it = required_savings.find(device_savings.first);
+      if (it == required_savings.end()) continue;
+      it->second -= device_savings.second;
+      if (it->second <= 0) {
+        required_savings.erase(it);
+      }
+    }
+  }
+  VLOG(1) << "Recomputing " << selected_subgraphs.size() << " out of "
+          << subgraphs->size() << " subgraphs to meet the peak memory target";
+  subgraphs->swap(selected_subgraphs);
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
+                                Cluster* cluster, int64 peak_memory_target,
                                 GraphDef* graph, const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
@@ -497,6 +593,12 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
         },
         is_target);
   }
+  if (!recomputed_subgraphs.empty() && peak_memory_target > 0) {
+    SelectSubgraphsForPeakMemoryTarget(cluster,
+                                       item.WithGraph(GraphDef(*graph)),
+                                       peak_memory_target,
+                                       &recomputed_subgraphs);
+  }
   if (!recomputed_subgraphs.empty()) {
     std::unordered_map<const NodeDef*, int> topological_numbering;
     for (int node_number = 0; node_number < graph->node().size();
@@ -978,7 +1080,7 @@ struct MemInfo {
 };
 
 static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
+    Cluster* cluster, int64 peak_memory_target, GrapplerItem* item,
     std::unique_ptr<GraphMemory>* memory_ptr,
     std::unordered_set<string>* skip_list,
     std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
@@ -1000,16 +1102,21 @@ static bool IdentifySwappingCandidates(
     if (prop.type() != "GPU") {
       continue;
     }
-    if (prop.memory_size() <= 0) {
+    int64 memory_limit = prop.memory_size();
+    if (peak_memory_target > 0 &&
+        (memory_limit <= 0 || peak_memory_target < memory_limit)) {
+      memory_limit = peak_memory_target;
+    }
+    if (memory_limit <= 0) {
       VLOG(1) << "Peak memory usage unknown for device " << name;
       continue;
     }
     const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
 
-    if (mem_usage.used_memory <= prop.memory_size()) {
+    if (mem_usage.used_memory <= memory_limit) {
       continue;
     }
-    int64 required_savings = mem_usage.used_memory - prop.memory_size();
+    int64 required_savings = mem_usage.used_memory - memory_limit;
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
     {
@@ -1147,15 +1254,16 @@ static bool IdentifySwappingCandidates(
 }
 
 bool SwappingPass(RewriterConfig::MemOptType optimization_level,
-                  Cluster* cluster, std::unique_ptr<GraphMemory>* memory,
-                  GrapplerItem* item, std::unordered_set<string>* skip_list) {
+                  Cluster* cluster, int64 peak_memory_target,
+                  std::unique_ptr<GraphMemory>* memory, GrapplerItem* item,
+                  std::unordered_set<string>* skip_list) {
   std::unordered_map<NodeDef*, SwapInfo> nodes_to_swap;
   if (optimization_level == RewriterConfig::DEFAULT_MEM_OPT ||
       optimization_level == RewriterConfig::SWAPPING_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
     // Use heuristics to figure out what needs to be swapped;
-    IdentifySwappingCandidates(cluster, item, memory, skip_list,
-                               &nodes_to_swap);
+    IdentifySwappingCandidates(cluster, peak_memory_target, item, memory,
+                               skip_list, &nodes_to_swap);
   }
   // Look for manual annotations in the graph.
   for (auto& node : *item->graph.mutable_node()) {
@@ -1391,13 +1499,19 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     return errors::Aborted("Nothing to do.");
   }
 
+  int64 peak_memory_usage_before = -1;
+  if (peak_memory_target_bytes_ > 0) {
+    GraphMemory memory(item);
+    peak_memory_usage_before = InferPeakMemoryUsage(cluster, item, &memory);
+  }
+
   GrapplerItem optimized_item(item);
   RelaxAssignNodes(nodes_to_relax, &optimized_item.graph);
 
   if (run_recomputation_pass) {
-    RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
-                               &optimized_item.graph, item);
+    RecomputationRewritingPass(
+        optimization_level_, recomputation_targets_name_scope_, cluster,
+        peak_memory_target_bytes_, &optimized_item.graph, item);
   }
 
   std::unordered_set<string> skip_list;
@@ -1428,7 +1542,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
            optimization_level_ == RewriterConfig::HEURISTICS ||
            optimization_level_ == RewriterConfig::MANUAL) &&
           cluster != nullptr) {
-        if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
+        if (SwappingPass(optimization_level_, cluster,
+                         peak_memory_target_bytes_, &memory, &optimized_item,
                          &skip_list)) {
           // Reset the inferred memory usage since the graph changed.
           memory.reset();
@@ -1438,6 +1553,16 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  if (peak_memory_usage_before >= 0) {
+    GraphMemory memory(optimized_item);
+    const int64 peak_memory_usage_after =
+        InferPeakMemoryUsage(cluster, optimized_item, &memory);
+    LOG(INFO) << "Projected peak memory usage of " << item.id << ": "
+              << peak_memory_usage_before << " bytes before and "
+              << peak_memory_usage_after << " bytes after memory optimization"
+              << " (target: " << peak_memory_target_bytes_ << " bytes)";
+  }
+
   optimized_graph->Swap(&optimized_item.graph);
   return Status::OK();
 }
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
@@ -448,6 +449,63 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, RecomputationForPeakMemoryTarget) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/cpu:0");
+  Output a = ops::RandomNormal(s.WithOpName("a"), {256, 256}, DT_FLOAT);
+  Output v = ops::RandomNormal(s.WithOpName("v"), {4, 4}, DT_FLOAT);
+  // Both activations are cheap to recompute and live until the end of the
+  // backward pass, but only the large one is worth recomputing.
+  Output large = ops::Relu(s.WithOpName("large"), a);
+  Output small = ops::Relu(s.WithOpName("small"), v);
+  Output forward = ops::MatMul(s.WithOpName("forward"), large, a);
+  Output grad_a = ops::MatMul(s.WithOpName("gradients/a"), forward, a);
+  Output grad_large = ops::Mul(s.WithOpName("gradients/large"), grad_a, large);
+  Output grad_sum =
+      ops::Sum(s.WithOpName("gradients/sum"), grad_large, {0, 1});
+  Output grad_small =
+      ops::Add(s.WithOpName("gradients/small"), small, grad_sum);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/small"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  GraphMemory memory(item);
+  TF_ASSERT_OK(memory.InferStatically(cluster->GetDevices()));
+  const int64 peak_memory_usage = memory.GetWorstCaseMemoryUsage();
+  ASSERT_GT(peak_memory_usage, 256 * 256 * sizeof(float));
+
+  // Without a target, every candidate is recomputed.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    EXPECT_NE(node_map.GetNode("Recomputed/large"), nullptr);
+    EXPECT_NE(node_map.GetNode("Recomputed/small"), nullptr);
+  }
+  // Recomputing the large activation is enough to meet the target.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", peak_memory_usage - 1024);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    NodeMap node_map(&output);
+    EXPECT_NE(node_map.GetNode("Recomputed/large"), nullptr);
+    EXPECT_EQ(node_map.GetNode("Recomputed/small"), nullptr);
+    EXPECT_EQ("Recomputed/large",
+              node_map.GetNode("gradients/large")->input(1));
+  }
+  // Nothing needs to be recomputed if the graph already meets the target.
+  {
+    MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS,
+                              "gradients/", peak_memory_usage);
+    GraphDef output;
+    TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+    EXPECT_EQ(item.graph.node_size(), output.node_size());
+  }
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/meta_optimizer.h"
 
+#include <unordered_map>
+
 #include "absl/strings/str_join.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/common_runtime/function.h"
@@ -52,6 +54,14 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -85,6 +95,14 @@ int NumIterations(const RewriterConfig& cfg) {
              : cfg.meta_optimizer_iterations();
 }
 
+// Returns a fingerprint of `graph` that changes whenever an optimizer changes
+// the graph.
+uint64 GraphFingerprint(const GraphDef& graph) {
+  string serialized;
+  SerializeToStringDeterministic(graph, &serialized);
+  return Fingerprint64(serialized);
+}
+
 // Check if optimizer is allowed to run only once.
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
@@ -167,6 +185,127 @@ bool MemoryOptimizerEnabled(
   return mem_opt_type != RewriterConfig::NO_MEM_OPT;
 }
 
+// Appends the fingerprint of the deterministic serialization of `proto` to
+// `key`.
+void AppendProtoFingerprint(const protobuf::MessageLite& proto, string* key) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  const Fprint128 fingerprint = Fingerprint128(serialized);
+  strings::StrAppend(key, fingerprint.low64, ":", fingerprint.high64, ";");
+}
+
+// Returns the name of the file that caches `item` optimized with `cfg` on
+// `cluster` in the optimized graph cache. The key covers everything the
+// meta-optimizer reads, except the item id, which is only used for logging.
+string OptimizedGraphCacheFileName(const GrapplerItem& item,
+                                   const ConfigProto& cfg,
+                                   const Cluster* cluster) {
+  string key = strings::StrCat(TF_VERSION_STRING, ";", tf_git_version(), ";");
+  AppendProtoFingerprint(item.graph, &key);
+
+  // The location of the cache does not change the optimized graph.
+  ConfigProto cfg_for_key = cfg;
+  cfg_for_key.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->clear_optimized_graph_cache_dir();
+  AppendProtoFingerprint(cfg_for_key, &key);
+
+  // Grappler only uses the shapes of fed tensors.
+  for (const auto& feed : item.feed) {
+    strings::StrAppend(&key, "feed:", feed.first, ":",
+                       DataTypeString(feed.second.dtype()), ":",
+                       feed.second.shape().DebugString(), ";");
+  }
+  for (const string& fetch : item.fetch) {
+    strings::StrAppend(&key, "fetch:", fetch, ";");
+  }
+  for (const string& op : item.init_ops) {
+    strings::StrAppend(&key, "init:", op, ";");
+  }
+  for (const string& op : item.keep_ops) {
+    strings::StrAppend(&key, "keep:", op, ";");
+  }
+  strings::StrAppend(&key, "save:", item.save_op, ":", item.restore_op, ":",
+                     item.save_restore_loc_tensor, ";");
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendProtoFingerprint(queue_runner, &key);
+  }
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  strings::StrAppend(&key, "options:",
+                     options.allow_non_differentiable_rewrites,
+                     options.allow_pruning_stateful_and_dataset_ops,
+                     options.optimize_function_library, options.is_eager_mode,
+                     ";");
+
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  for (const string& device : devices) {
+    strings::StrAppend(&key, "device:", device, ";");
+  }
+  if (cluster != nullptr) {
+    std::map<string, DeviceProperties> cluster_devices(
+        cluster->GetDevices().begin(), cluster->GetDevices().end());
+    for (const auto& device : cluster_devices) {
+      strings::StrAppend(&key, "cluster_device:", device.first, ";");
+      AppendProtoFingerprint(device.second, &key);
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return strings::Printf("%016llx%016llx.graph_def",
+                         static_cast<unsigned long long>(fingerprint.high64),
+                         static_cast<unsigned long long>(fingerprint.low64));
+}
+
+// Reads the optimized graph cached in `path`, and the time it took to optimize
+// it. Returns false if `path` is not a valid cache entry.
+bool ReadOptimizedGraphFromCache(const string& path, GraphDef* optimized_graph,
+                                 uint64* optimization_usecs) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) return false;
+  Status status = ReadBinaryProto(env, path, optimized_graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring invalid optimized graph cache entry " << path
+                 << ": " << status;
+    optimized_graph->Clear();
+    return false;
+  }
+  string usecs;
+  *optimization_usecs = 0;
+  if (ReadFileToString(env, strings::StrCat(path, ".usecs"), &usecs).ok()) {
+    strings::safe_strtou64(usecs, optimization_usecs);
+  }
+  return true;
+}
+
+// Writes an entry of the optimized graph cache to `path`. The graph is written
+// to a temporary file first, so that concurrent readers never see partially
+// written entries.
+void WriteOptimizedGraphToCache(const string& path,
+                                const GraphDef& optimized_graph,
+                                uint64 optimization_usecs) {
+  Env* env = Env::Default();
+  Status status = env->RecursivelyCreateDir(string(io::Dirname(path)));
+  if (status.ok()) {
+    status = WriteStringToFile(env, strings::StrCat(path, ".usecs"),
+                               strings::StrCat(optimization_usecs));
+  }
+  const string tmp_path =
+      strings::StrCat(path, ".tmp.", strings::Hex(random::New64()));
+  if (status.ok()) {
+    status = WriteBinaryProto(env, tmp_path, optimized_graph);
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write optimized graph cache entry " << path
+                 << ": " << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
 }  // namespace
 
 #define MK_OPT(NAME, VALUE) \
@@ -186,11 +325,14 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("constfold", new ConstantFolding(cpu_device_));
   MK_OPT("shape", new ShapeOptimizer());
   MK_OPT("remap", new Remapper(cfg_.remapping()));
-  MK_OPT("layout", new GenericLayoutOptimizer());
+  MK_OPT("layout", new GenericLayoutOptimizer(RewriterConfig::DEFAULT,
+                                              cfg_.cpu_layout_conversion()));
   MK_OPT("auto_mixed_precision",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CUDA));
   MK_OPT("auto_mixed_precision_mkl",
          new AutoMixedPrecision(AutoMixedPrecisionMode::MKL));
+  MK_OPT("auto_mixed_precision_cpu",
+         new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
   MK_OPT("memory", new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination",
          new CommonSubgraphElimination(cfg_.common_subgraph_elimination()));
@@ -257,6 +399,10 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::MKL));
   }
+  if (AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision_cpu())) {
+    optimizers->push_back(
+        MakeUnique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
+  }
   if (cfg_.pin_to_host_optimization() == RewriterConfig::ON) {
     optimizers->push_back(MakeUnique<PinToHostOptimizer>());
   }
@@ -265,7 +411,9 @@ Status MetaOptimizer::InitializeOptimizers(
         MakeUnique<ArithmeticOptimizer>(cfg_.arithmetic_optimization()));
   }
   if (cfg_.layout_optimizer() != RewriterConfig::OFF) {
-    optimizers->push_back(MakeUnique<GenericLayoutOptimizer>());
+    optimizers->push_back(MakeUnique<GenericLayoutOptimizer>(
+        /*opt_level=*/RewriterConfig::DEFAULT,
+        /*layout_conversion=*/cfg_.cpu_layout_conversion()));
   }
   if (cfg_.remapping() != RewriterConfig::OFF) {
     optimizers->push_back(MakeUnique<Remapper>(cfg_.remapping()));
@@ -281,15 +429,14 @@ Status MetaOptimizer::InitializeOptimizers(
   auto global_jit_level =
       config_proto_.graph_options().optimizer_options().global_jit_level();
   if (MemoryOptimizerEnabled(cfg_.memory_optimization(), global_jit_level)) {
-    if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
-      optimizers->push_back(
-          // Use the default target node name prefix "gradients/"
-          MakeUnique<MemoryOptimizer>(cfg_.memory_optimization()));
-    } else {
-      optimizers->push_back(MakeUnique<MemoryOptimizer>(
-          cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
-    }
+    // Use the default target node name prefix "gradients/" if none is set.
+    const string recomputation_targets_name_scope =
+        cfg_.memory_optimizer_target_node_name_scope().empty()
+            ? "gradients/"
+            : cfg_.memory_optimizer_target_node_name_scope();
+    optimizers->push_back(MakeUnique<MemoryOptimizer>(
+        cfg_.memory_optimization(), recomputation_targets_name_scope,
+        cfg_.memory_optimizer_peak_memory_target_bytes()));
   }
   if (cfg_.auto_parallel().enable()) {
     optimizers->push_back(
@@ -449,6 +596,16 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
     CompressConstants(optimized_graph);
   }
 
+  // Optimizers are deterministic, so an optimizer that left a graph unchanged
+  // would leave it unchanged again. For every such optimizer, we keep the
+  // fingerprint of the graph it last ran on, and skip it in later iterations
+  // until another optimizer changes the graph. This is only needed if we run
+  // more than one iteration.
+  const bool track_changes = NumIterations(cfg_) > 1;
+  std::unordered_map<const GraphOptimizer*, uint64> unchanged_graph_fingerprint;
+  uint64 graph_fingerprint =
+      track_changes ? GraphFingerprint(*optimized_graph) : 0;
+
   for (int iteration = 0; iteration < NumIterations(cfg_); ++iteration) {
     // Don't bother optimizing further if the graph is already tiny.
     if (optimized_graph->node_size() < min_graph_nodes) {
@@ -466,6 +623,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
           *optimized_graph);
     }
 
+    bool graph_changed = false;
     for (const auto& optimizer : optimizers) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
       // Some optimizers can run only once.
@@ -475,6 +633,15 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
         if (sa_optimizer == nullptr) sa_optimizer = optimizer.get();
         continue;
       }
+      if (track_changes) {
+        auto it = unchanged_graph_fingerprint.find(optimizer.get());
+        if (it != unchanged_graph_fingerprint.end() &&
+            it->second == graph_fingerprint) {
+          VLOG(3) << "Skipping " << optimizer->name()
+                  << ", the graph did not change since its last run.";
+          continue;
+        }
+      }
 
       TF_RETURN_IF_ERROR(RunOptimizer(optimizer.get(), cluster, &item,
                                       optimized_graph, &optimization_result));
@@ -483,6 +650,16 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
         CompressConstants(optimized_graph);
       }
 
+      if (track_changes) {
+        const uint64 fingerprint = GraphFingerprint(*optimized_graph);
+        if (fingerprint == graph_fingerprint) {
+          unchanged_graph_fingerprint[optimizer.get()] = fingerprint;
+        } else {
+          graph_fingerprint = fingerprint;
+          graph_changed = true;
+        }
+      }
+
       if (VLOG_IS_ON(4)) {
         DumpGraphDefToFile(
             strings::StrCat("after_MetaOptimizer_iteration_", iteration, "_",
@@ -505,6 +682,13 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
     for (const auto& verifier : post_optimization_verifiers) {
       TF_RETURN_IF_ERROR(verifier->Verify(*optimized_graph));
     }
+
+    // Every optimizer would be skipped in the next iteration.
+    if (track_changes && !graph_changed) {
+      VLOG(3) << "Stopping after iteration " << iteration
+              << ", no optimizer changed the graph";
+      break;
+    }
   }
 
   // ScopedAllocatorOptimizer must run last.
@@ -552,9 +736,12 @@ Status MetaOptimizer::RunOptimizer(
   }
 
   // This swaps the current optimized_graph into optimized item and
-  // resets optimized_graph to an empty graph.
+  // resets optimized_graph to an empty graph. Clear() keeps the NodeDefs of
+  // the graph the previous optimizer ran on allocated, and the next
+  // add_node() or copy of the graph reuses them, which is much cheaper than
+  // destroying and reallocating every node of a large graph in each pass.
   optimized_graph->Swap(&optimized_item->graph);
-  *optimized_graph = GraphDef();
+  optimized_graph->Clear();
   optimizer->set_deadline_usec(this->deadline_usec());
   Status status =
       optimizer->Optimize(cluster, *optimized_item, optimized_graph);
@@ -842,6 +1029,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
          rewrite_cfg.pin_to_host_optimization() == RewriterConfig::ON ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
+         AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
@@ -849,11 +1037,34 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
 Status RunMetaOptimizer(GrapplerItem&& item, const ConfigProto& cfg,
                         DeviceBase* cpu_device, Cluster* cluster,
                         GraphDef* optimized_graph) {
+  const string& cache_dir =
+      cfg.graph_options().rewrite_options().optimized_graph_cache_dir();
+  string cache_path;
+  if (!cache_dir.empty()) {
+    cache_path = io::JoinPath(
+        cache_dir, OptimizedGraphCacheFileName(item, cfg, cluster));
+    uint64 saved_usecs = 0;
+    if (ReadOptimizedGraphFromCache(cache_path, optimized_graph,
+                                    &saved_usecs)) {
+      VLOG(1) << "Read optimized graph for grappler item " << item.id
+              << " from " << cache_path;
+      metrics::RecordGrapplerGraphCacheLookup(/*hit=*/true, saved_usecs);
+      return Status::OK();
+    }
+    metrics::RecordGrapplerGraphCacheLookup(/*hit=*/false, 0);
+  }
+
+  const uint64 start_us = Env::Default()->NowMicros();
   MetaOptimizer optimizer(cpu_device, cfg);
   optimizer.set_deadline_usec(
       DeadlineMicroSeconds(cfg.graph_options().rewrite_options()));
-  return optimizer.OptimizeConsumeItem(cluster, std::move(item),
-                                       optimized_graph);
+  Status status = optimizer.OptimizeConsumeItem(cluster, std::move(item),
+                                                optimized_graph);
+  if (status.ok() && !cache_path.empty()) {
+    WriteOptimizedGraphToCache(cache_path, *optimized_graph,
+                               Env::Default()->NowMicros() - start_us);
+  }
+  return status;
 }
 
 Status OptimizeGraph(
@@ -29,6 +29,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -132,6 +134,45 @@ gtl::FlatMap<string, GrapplerItem::OptimizationOptions>*
 
 REGISTER_GRAPH_OPTIMIZER(GrapplerItemPropertiesAccumulator);
 
+// Counts its runs, and adds a NoOp node to the graph unless it already has
+// one.
+class AddNoOpOnceOptimizer : public CustomGraphOptimizer {
+ public:
+  static int NumRuns() { return num_runs_; }
+  static void ResetNumRuns() { num_runs_ = 0; }
+
+  string name() const override { return "add_noop_once_optimizer"; }
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    return Status::OK();
+  }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override {
+    ++num_runs_;
+    *optimized_graph = item.graph;
+    for (const NodeDef& node : item.graph.node()) {
+      if (node.name() == "added_noop") return Status::OK();
+    }
+    NodeDef* noop = optimized_graph->add_node();
+    noop->set_name("added_noop");
+    noop->set_op("NoOp");
+    return Status::OK();
+  }
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override {}
+
+ private:
+  static int num_runs_;
+};
+
+int AddNoOpOnceOptimizer::num_runs_;
+
+REGISTER_GRAPH_OPTIMIZER(AddNoOpOnceOptimizer);
+
 class MetaOptimizerTest : public GrapplerTest {};
 
 TEST_F(MetaOptimizerTest, RunsCustomOptimizer) {
@@ -214,6 +255,37 @@ TEST_F(MetaOptimizerTest, RunOptimizersTwice) {
   TF_EXPECT_OK(status);
 }
 
+TEST_F(MetaOptimizerTest, SkipsOptimizersThatDidNotChangeTheGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("AddNoOpOnceOptimizer");
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // The first run adds a node, so the optimizer runs again in the second
+  // iteration.
+  AddNoOpOnceOptimizer::ResetNumRuns();
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(2, AddNoOpOnceOptimizer::NumRuns());
+  EXPECT_EQ(item.graph.node_size() + 1, output.node_size());
+
+  // The graph already has the node, so the optimizer doesn't run again in the
+  // second iteration.
+  AddNoOpOnceOptimizer::ResetNumRuns();
+  item.graph = output;
+  MetaOptimizer second_optimizer(nullptr, config_proto);
+  TF_ASSERT_OK(second_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(1, AddNoOpOnceOptimizer::NumRuns());
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+}
+
 TEST_F(MetaOptimizerTest, RunToggleOptimizersAndCustomGraphOptimizerTwice) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -774,6 +846,57 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, CachesOptimizedGraphs) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache");
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(cache_dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_optimized_graph_cache_dir(cache_dir);
+
+  // The first run optimizes the graph and writes it to the cache.
+  TestOptimizer::SetOptimized(false);
+  GrapplerItem item_copy = item;
+  GraphDef output;
+  TF_ASSERT_OK(RunMetaOptimizer(std::move(item_copy), config, nullptr,
+                                nullptr, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  std::vector<string> entries;
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(cache_dir, "*.graph_def"), &entries));
+  ASSERT_EQ(1, entries.size());
+
+  // The second run reads the graph from the cache.
+  TestOptimizer::SetOptimized(false);
+  item_copy = item;
+  GraphDef cached_output;
+  TF_ASSERT_OK(RunMetaOptimizer(std::move(item_copy), config, nullptr,
+                                nullptr, &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+
+  // A different graph misses the cache.
+  item_copy = item;
+  item_copy.graph.mutable_node(0)->set_device(kDevice);
+  TF_ASSERT_OK(RunMetaOptimizer(std::move(item_copy), config, nullptr,
+                                nullptr, &cached_output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+  TF_ASSERT_OK(Env::Default()->GetMatchingPaths(
+      io::JoinPath(cache_dir, "*.graph_def"), &entries));
+  EXPECT_EQ(2, entries.size());
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <limits>
+
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/versions.pb.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/graph_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
@@ -27,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -51,6 +56,11 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// Chain of unary element-wise ops -> _FusedElementwiseChain
+//   (1) <Cwise> + <Cwise> + ... (on CPU, when the cost model predicts that
+//       the intermediate results are a large part of the memory traffic)
+//   (2) <Cwise> + <Cwise> + ... (on GPU, always)
+//
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
 // patterns are "ContractionWith...".
 namespace {
@@ -59,23 +69,38 @@ constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedElementwiseChain[] = "_FusedElementwiseChain";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
 
 constexpr int kMissingIndex = -1;
 
+// Fusing an element-wise chain saves the memory traffic of its intermediate
+// results, but hides the fused ops from later optimizers. Only fuse chains
+// where this saves at least this fraction of their estimated execution time.
+constexpr double kMinElementwiseChainSavings = 0.1;
+
+// The GPU kernel of _FusedElementwiseChain takes at most this many ops, see
+// FusedElementwiseOps in core/kernels/fused_elementwise_op.h.
+constexpr int kMaxGpuElementwiseChainLength = 16;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status)
       : nodes_to_preserve(item->NodesToPreserve()),
         graph_view(&item->graph, status),
         graph_properties(*item),
-        inferred_graph_properties(false) {}
+        inferred_graph_properties(false),
+        cpu_device(GetLocalCPUInfo()) {}
 
   std::unordered_set<string> nodes_to_preserve;
   utils::MutableGraphView graph_view;
   GraphProperties graph_properties;
   bool inferred_graph_properties;
+
+  // Used to decide whether element-wise chains are worth fusing.
+  OpLevelCostEstimator cost_estimator;
+  DeviceProperties cpu_device;
 };
 
 // FusedBatchNorm that can be replaced with a cheaper set of primitives.
@@ -197,6 +222,13 @@ struct ContractionWithBiasAndAddActivation {
 };
 #endif  // INTEL_MKL
 
+// Chain of unary element-wise ops, from the first to the last one.
+struct ElementwiseChain {
+  ElementwiseChain() = default;
+
+  std::vector<int> nodes;
+};
+
 bool IsInPreserveSet(const RemapperContext& ctx, const NodeDef* node) {
   return ctx.nodes_to_preserve.count(node->name()) > 0;
 }
@@ -914,6 +946,124 @@ bool FindFusedBatchNormEx(const RemapperContext& ctx, int node_index,
   return false;
 }
 
+// Returns true if `node` is an op that _FusedElementwiseChain can apply.
+bool IsSupportedElementwiseChainOp(const NodeDef& node) {
+  static const auto* supported_ops = new absl::flat_hash_set<string>{
+      "Ceil",    "Cos",   "Exp",   "Expm1",      "Floor",  "Inv",
+      "Log",     "Log1p", "Neg",   "Reciprocal", "Relu",   "Rsqrt",
+      "Sigmoid", "Sign",  "Sin",   "Sqrt",       "Square", "Tanh"};
+  if (!supported_ops->contains(node.op())) return false;
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  if (NodeIsOnGpu(&node)) {
+    return dtype == DT_HALF || dtype == DT_FLOAT || dtype == DT_DOUBLE;
+  }
+  return NodeIsOnCpu(&node) && (dtype == DT_FLOAT || dtype == DT_DOUBLE);
+}
+
+Costs PredictCosts(const RemapperContext& ctx, const NodeDef& node) {
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.device_name = node.device();
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op(node.op());
+  *op_info.mutable_attr() = node.attr();
+  *op_info.mutable_device() = ctx.cpu_device;
+  for (const auto& input : ctx.graph_properties.GetInputProperties(node.name()))
+    *op_info.add_inputs() = input;
+  for (const auto& output :
+       ctx.graph_properties.GetOutputProperties(node.name()))
+    *op_info.add_outputs() = output;
+  return ctx.cost_estimator.PredictCosts(op_context);
+}
+
+// Returns true if the cost model predicts that fusing `chain` saves enough
+// memory traffic.
+bool IsElementwiseChainFusionProfitable(const RemapperContext& ctx,
+                                        const std::vector<int>& chain) {
+  const GraphDef* graph = ctx.graph_view.graph();
+  // On GPU, each fused op saves a kernel launch on top of a round trip of its
+  // input and output through device memory, which always pays off.
+  if (NodeIsOnGpu(&graph->node(chain[0]))) return true;
+
+  // Without shapes the cost model can't estimate the memory traffic.
+  if (!ctx.inferred_graph_properties) return false;
+  // The cost model needs to know the speed of the CPU.
+  if (ctx.cpu_device.frequency() <= 0 || ctx.cpu_device.num_cores() <= 0) {
+    return false;
+  }
+
+  double execution_time = 0;
+  double memory_time = 0;
+  double fused_memory_time = 0;
+  for (int i = 0; i < chain.size(); ++i) {
+    const Costs costs = PredictCosts(ctx, graph->node(chain[i]));
+    execution_time += costs.execution_time.count();
+    memory_time += costs.memory_time.count();
+    // The fused op only reads the input of the first op and writes the output
+    // of the last one. All ops in the chain have inputs and outputs of the same
+    // size, so that's half of the traffic of each of them.
+    if (i == 0 || i == chain.size() - 1) {
+      fused_memory_time += costs.memory_time.count() / 2;
+    }
+  }
+  // Unknown dimensions are estimated as 1 by the cost model, which scales all
+  // of the above by the same factor.
+  return memory_time - fused_memory_time >=
+         kMinElementwiseChainSavings * execution_time;
+}
+
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  // Root of the pattern is the last op of the chain.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  if (HasControlFaninOrFanout(*node_view)) return false;
+  const auto* node_def = node_view->node();
+  if (!IsSupportedElementwiseChainOp(*node_def)) return false;
+
+  // Walk up the chain while the input is a supported op that is only read by
+  // the chain.
+  std::vector<int> chain = {node_index};
+  const auto* first_node_view = node_view;
+  const int max_chain_length = NodeIsOnGpu(node_def)
+                                   ? kMaxGpuElementwiseChainLength
+                                   : std::numeric_limits<int>::max();
+  while (first_node_view->NumRegularFanins() == 1 &&
+         chain.size() < max_chain_length) {
+    const auto* fanin_node_view =
+        first_node_view->GetRegularFanin(0).node_view();
+    const auto* fanin_node_def = fanin_node_view->node();
+    if (!IsSupportedElementwiseChainOp(*fanin_node_def) ||
+        !HaveSameDataType(node_def, fanin_node_def) ||
+        fanin_node_def->device() != node_def->device() ||
+        HasControlFaninOrFanout(*fanin_node_view) ||
+        !HasAtMostOneFanoutAtPort0(*fanin_node_view) ||
+        IsInPreserveSet(ctx, fanin_node_def))
+      break;
+
+    // Leave a Relu that follows a contraction or a batch norm to the other
+    // patterns, that fuse it into its input.
+    if (IsRelu(*fanin_node_def) && fanin_node_view->NumRegularFanins() > 0) {
+      const auto* relu_input =
+          fanin_node_view->GetRegularFanin(0).node_view()->node();
+      if (IsBiasAdd(*relu_input) || IsFusedBatchNorm(*relu_input) ||
+          IsAdd(*relu_input))
+        break;
+    }
+
+    chain.push_back(fanin_node_view->node_index());
+    first_node_view = fanin_node_view;
+  }
+  if (chain.size() < 2) return false;
+  std::reverse(chain.begin(), chain.end());
+
+  if (!IsElementwiseChainFusionProfitable(ctx, chain)) return false;
+
+  // We successfully found a chain of element-wise ops worth fusing.
+  matched->nodes = std::move(chain);
+
+  return true;
+}
+
 void CopyConv2DAttributes(const NodeDef& conv2d, NodeDef* fused_conv2d) {
   DCHECK(IsConv2D(conv2d)) << "Input node must be a Conv2D";
 
@@ -1365,6 +1515,45 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedElementwiseChainNode(RemapperContext* ctx,
+                                    const ElementwiseChain& matched,
+                                    std::vector<bool>* invalidated_nodes,
+                                    std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.nodes.front());
+  const NodeDef& last = graph->node(matched.nodes.back());
+
+  std::vector<string> fused_ops;
+  for (int node_index : matched.nodes) {
+    fused_ops.push_back(graph->node(node_index).op());
+  }
+  VLOG(2) << "Fuse element-wise chain: ops=" << str_util::Join(fused_ops, ",")
+          << " first=" << first.name() << " last=" << last.name();
+
+  NodeDef fused_op;
+  fused_op.set_op(kFusedElementwiseChain);
+  fused_op.set_name(last.name());
+  fused_op.set_device(last.device());
+  fused_op.add_input(first.input(0));
+
+  auto* attrs = fused_op.mutable_attr();
+  (*attrs)["T"] = last.attr().at("T");
+  SetAttrValue(fused_ops, &(*attrs)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (int i = 0; i < matched.nodes.size() - 1; ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+
+  return Status::OK();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1595,6 +1784,7 @@ bool IsConv2DWithAdd(const RemapperContext& ctx, int node_index) {
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
 //   (3) Fusing Conv2D biasadd and relu on GPU
 //   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
+//   (5) Fusing chains of element-wise ops.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1665,12 +1855,20 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
+  // Candidate for an element-wise chain fusion.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    if (!IsSupportedElementwiseChainOp(*node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    const auto& fanin_0 = node_view->GetRegularFanin(0);
+    return IsSupportedElementwiseChainOp(*fanin_0.node_view()->node());
+  };
+
 #ifdef INTEL_MKL
   return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
-         IsConv2DWithAdd(ctx, node_index);
+         IsConv2DWithAdd(ctx, node_index) || is_elementwise_chain_candidate();
 #else
   return is_relu_biasadd_conv2d_candidate() || is_batch_norm_candidate() ||
-         is_batch_norm_fusion_candidate();
+         is_batch_norm_fusion_candidate() || is_elementwise_chain_candidate();
 #endif  // INTEL_MKL
 }
 
@@ -1829,6 +2027,15 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap chains of unary element-wise ops into the _FusedElementwiseChain.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindElementwiseChain(ctx, i, &elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseChainNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
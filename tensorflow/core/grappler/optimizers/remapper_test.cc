@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 
 #if GOOGLE_CUDA
@@ -449,6 +450,141 @@ TEST_F(RemapperTest, FuseMatMulWithBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input_shape = ops::Placeholder::Shape({64, 1024});
+  auto input = Placeholder(s.WithOpName("input"), DT_FLOAT, input_shape);
+  auto neg = ops::Neg(s.WithOpName("neg"), input);
+  auto relu = ops::Relu(s.WithOpName("relu"), neg);
+  auto square = ops::Square(s.WithOpName("square"), relu);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), square);
+
+  // The second chain is cut in two by a node with two fanouts. Only cheap ops
+  // are used, so that the chains are memory bound on any CPU.
+  auto floor = ops::Floor(s.WithOpName("floor"), input);
+  auto ceil = ops::Ceil(s.WithOpName("ceil"), floor);
+  auto abs = ops::Abs(s.WithOpName("abs"), ceil);
+  auto neg_ceil = ops::Neg(s.WithOpName("neg_ceil"), ceil);
+  auto sign = ops::Sign(s.WithOpName("sign"), neg_ceil);
+  auto fetch_abs = ops::Identity(s.WithOpName("fetch_abs"), abs);
+  auto fetch_sign = ops::Identity(s.WithOpName("fetch_sign"), sign);
+
+  auto input_t = GenerateRandomTensor<DT_FLOAT>({64, 1024});
+
+  GrapplerItem item;
+  item.fetch = {"fetch", "fetch_abs", "fetch_sign"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "neg");
+    EXPECT_NE(node.name(), "relu");
+    EXPECT_NE(node.name(), "floor");
+    EXPECT_NE(node.name(), "neg_ceil");
+    if (node.name() == "square") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseChain");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "input");
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 3);
+      EXPECT_EQ(fused_ops[0], "Neg");
+      EXPECT_EQ(fused_ops[1], "Relu");
+      EXPECT_EQ(fused_ops[2], "Square");
+      found++;
+    }
+    if (node.name() == "ceil") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseChain");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "input");
+      const auto fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 2);
+      EXPECT_EQ(fused_ops[0], "Floor");
+      EXPECT_EQ(fused_ops[1], "Ceil");
+      found++;
+    }
+    if (node.name() == "sign") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseChain");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "ceil");
+      found++;
+    }
+    if (node.name() == "abs") {
+      EXPECT_EQ(node.op(), "Abs");
+      found++;
+    }
+  }
+  EXPECT_EQ(4, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 3);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-6);
+  }
+}
+
+TEST_F(RemapperTest, FuseElementwiseChainOnGPU) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // A chain of 20 ops is split into two, since the GPU kernel takes at most
+  // 16 ops. The shape is unknown, which doesn't matter on GPU.
+  auto input = Placeholder(s.WithOpName("input"), DT_HALF);
+  Output chain = input;
+  for (int i = 0; i < 20; ++i) {
+    chain = ops::Tanh(s.WithOpName(strings::StrCat("tanh_", i)), chain);
+  }
+  auto fetch = ops::Identity(s.WithOpName("fetch"), chain);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on GPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:GPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "tanh_19") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseChain");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "tanh_3");
+      EXPECT_EQ(node.attr().at("fused_ops").list().s_size(), 16);
+      found++;
+    } else if (node.name() == "tanh_3") {
+      EXPECT_EQ(node.op(), "_FusedElementwiseChain");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.attr().at("fused_ops").list().s_size(), 4);
+      found++;
+    } else {
+      EXPECT_NE(node.op(), "Tanh") << node.name();
+    }
+  }
+  EXPECT_EQ(2, found);
+}
+
 TEST_F(RemapperTest, FuseConv2DWithBiasAndActivationOnGPU) {
 #if !(GOOGLE_CUDA)
   GTEST_SKIP() << "No CUDA, skip FuseConv2DWithBiasAndActivation on GPU";
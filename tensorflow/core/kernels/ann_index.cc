@@ -0,0 +1,375 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/ann_index.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/top_n.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+
+namespace tensorflow {
+namespace {
+
+float SquaredDistance(const float* a, const float* b, int64 n) {
+  float sum = 0;
+  for (int64 i = 0; i < n; ++i) {
+    const float d = a[i] - b[i];
+    sum += d * d;
+  }
+  return sum;
+}
+
+// Returns the index of the row of the [k, dim] "centroids" nearest to "x".
+int32 Nearest(const float* x, const float* centroids, int64 k, int64 dim) {
+  int32 best = 0;
+  float best_distance = std::numeric_limits<float>::infinity();
+  for (int64 j = 0; j < k; ++j) {
+    const float distance = SquaredDistance(x, centroids + j * dim, dim);
+    if (distance < best_distance) {
+      best = j;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+// Sets "assignments" to the nearest of the [k, dim] "centroids" to each of the
+// [n, dim] "points".
+void Assign(const DeviceBase::CpuWorkerThreads& worker_threads,
+            const float* points, int64 n, const float* centroids, int64 k,
+            int64 dim, std::vector<int32>* assignments) {
+  assignments->resize(n);
+  Shard(worker_threads.num_threads, worker_threads.workers, n, 3 * k * dim,
+        [&](int64 begin, int64 end) {
+          for (int64 i = begin; i < end; ++i) {
+            (*assignments)[i] = Nearest(points + i * dim, centroids, k, dim);
+          }
+        });
+}
+
+// Clusters the [n, dim] "points" into the [k, dim] "centroids" with
+// "num_iterations" iterations of Lloyd's algorithm.  The centroids start as
+// distinct points drawn with "rng", or as all the points, repeated, if there
+// are at most k of them.  Centroids without points do not move.
+void KMeans(const DeviceBase::CpuWorkerThreads& worker_threads,
+            const float* points, int64 n, int64 dim, int64 k,
+            int64 num_iterations, random::SimplePhilox* rng,
+            float* centroids) {
+  if (n == 0) {
+    std::fill(centroids, centroids + k * dim, 0.0f);
+    return;
+  }
+  if (n <= k) {
+    for (int64 j = 0; j < k; ++j) {
+      std::copy(points + (j % n) * dim, points + (j % n + 1) * dim,
+                centroids + j * dim);
+    }
+    return;
+  }
+  std::vector<int64> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  for (int64 j = 0; j < k; ++j) {
+    std::swap(order[j], order[j + rng->Uniform64(n - j)]);
+    std::copy(points + order[j] * dim, points + (order[j] + 1) * dim,
+              centroids + j * dim);
+  }
+
+  std::vector<int32> assignments;
+  std::vector<double> sums(k * dim);
+  std::vector<int64> counts(k);
+  for (int64 iteration = 0; iteration < num_iterations; ++iteration) {
+    Assign(worker_threads, points, n, centroids, k, dim, &assignments);
+    std::fill(sums.begin(), sums.end(), 0.0);
+    std::fill(counts.begin(), counts.end(), 0);
+    for (int64 i = 0; i < n; ++i) {
+      double* sum = &sums[assignments[i] * dim];
+      const float* point = points + i * dim;
+      for (int64 d = 0; d < dim; ++d) sum[d] += point[d];
+      ++counts[assignments[i]];
+    }
+    for (int64 j = 0; j < k; ++j) {
+      if (counts[j] == 0) continue;
+      for (int64 d = 0; d < dim; ++d) {
+        centroids[j * dim + d] = sums[j * dim + d] / counts[j];
+      }
+    }
+  }
+}
+
+}  // namespace
+
+AnnIndex::AnnIndex(const AnnIndexOptions& options)
+    : options_(options),
+      centroids_(options.num_lists * options.dim, 0.0f),
+      codebooks_(options.num_codes * options.dim, 0.0f),
+      list_offsets_(options.num_lists + 1, 0) {}
+
+int64 AnnIndex::size() const {
+  tf_shared_lock l(mu_);
+  return SizeLocked();
+}
+
+Status AnnIndex::Build(const DeviceBase::CpuWorkerThreads& worker_threads,
+                       TTypes<float>::ConstMatrix vectors,
+                       TTypes<int64>::ConstVec ids) {
+  const int64 n = vectors.dimension(0);
+  const int64 dim = options_.dim;
+  const int64 num_lists = options_.num_lists;
+  const int64 num_subspaces = options_.num_subspaces;
+  const int64 num_codes = options_.num_codes;
+  const int64 sub_dim = subspace_dim();
+  if (vectors.dimension(1) != dim) {
+    return errors::InvalidArgument("Expected vectors of dimension ", dim,
+                                   ", got ", vectors.dimension(1));
+  }
+  if (ids.size() != n) {
+    return errors::InvalidArgument("Got ", n, " vectors but ", ids.size(),
+                                   " ids");
+  }
+  const float* data = vectors.data();
+
+  // Trains the quantizers on a sample of the vectors.
+  random::PhiloxRandom philox(options_.seed);
+  random::SimplePhilox rng(&philox);
+  const int64 num_training = std::min(n, options_.max_training_vectors);
+  std::vector<float> training(num_training * dim);
+  {
+    std::vector<int64> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    for (int64 i = 0; i < num_training; ++i) {
+      if (num_training < n) {
+        std::swap(order[i], order[i + rng.Uniform64(n - i)]);
+      }
+      std::copy(data + order[i] * dim, data + (order[i] + 1) * dim,
+                training.begin() + i * dim);
+    }
+  }
+  std::vector<float> centroids(num_lists * dim);
+  KMeans(worker_threads, training.data(), num_training, dim, num_lists,
+         options_.num_iterations, &rng, centroids.data());
+
+  // The subspaces of the residuals are quantized independently.
+  std::vector<int32> training_lists;
+  Assign(worker_threads, training.data(), num_training, centroids.data(),
+         num_lists, dim, &training_lists);
+  std::vector<float> codebooks(num_subspaces * num_codes * sub_dim);
+  std::vector<float> subvectors(num_training * sub_dim);
+  for (int64 m = 0; m < num_subspaces; ++m) {
+    for (int64 i = 0; i < num_training; ++i) {
+      const float* x = &training[i * dim + m * sub_dim];
+      const float* c = &centroids[training_lists[i] * dim + m * sub_dim];
+      for (int64 d = 0; d < sub_dim; ++d) {
+        subvectors[i * sub_dim + d] = x[d] - c[d];
+      }
+    }
+    KMeans(worker_threads, subvectors.data(), num_training, sub_dim, num_codes,
+           options_.num_iterations, &rng,
+           &codebooks[m * num_codes * sub_dim]);
+  }
+
+  // Encodes all the vectors.
+  std::vector<int32> lists;
+  Assign(worker_threads, data, n, centroids.data(), num_lists, dim, &lists);
+  std::vector<uint8> codes(n * num_subspaces);
+  Shard(worker_threads.num_threads, worker_threads.workers, n,
+        3 * num_codes * dim, [&](int64 begin, int64 end) {
+          std::vector<float> residual(dim);
+          for (int64 i = begin; i < end; ++i) {
+            const float* x = data + i * dim;
+            const float* c = &centroids[lists[i] * dim];
+            for (int64 d = 0; d < dim; ++d) residual[d] = x[d] - c[d];
+            for (int64 m = 0; m < num_subspaces; ++m) {
+              codes[i * num_subspaces + m] =
+                  Nearest(&residual[m * sub_dim],
+                          &codebooks[m * num_codes * sub_dim], num_codes,
+                          sub_dim);
+            }
+          }
+        });
+
+  return Import(TTypes<float>::ConstMatrix(centroids.data(), num_lists, dim),
+             TTypes<float, 3>::ConstTensor(codebooks.data(), num_subspaces,
+                                           num_codes, sub_dim),
+             TTypes<int32>::ConstVec(lists.data(), n), ids,
+             TTypes<uint8>::ConstMatrix(codes.data(), n, num_subspaces));
+}
+
+void AnnIndex::SearchOne(const float* query, int k, int nprobe,
+                         float* distances, int64* ids) const {
+  const int64 dim = options_.dim;
+  const int64 num_subspaces = options_.num_subspaces;
+  const int64 num_codes = options_.num_codes;
+  const int64 sub_dim = subspace_dim();
+
+  std::vector<std::pair<float, int64>> lists(options_.num_lists);
+  for (int64 l = 0; l < options_.num_lists; ++l) {
+    lists[l] = {SquaredDistance(query, &centroids_[l * dim], dim), l};
+  }
+  nprobe = std::min<int64>(nprobe, lists.size());
+  std::partial_sort(lists.begin(), lists.begin() + nprobe, lists.end());
+
+  // Orders the neighbors by increasing distance and then id.
+  const auto better = [](const std::pair<float, int64>& a,
+                         const std::pair<float, int64>& b) { return a < b; };
+  gtl::TopN<std::pair<float, int64>, decltype(better)> nearest(k, better);
+  std::vector<float> residual(dim);
+  std::vector<float> table(num_subspaces * num_codes);
+  for (int p = 0; p < nprobe; ++p) {
+    const int64 l = lists[p].second;
+    const int64 begin = list_offsets_[l];
+    const int64 end = list_offsets_[l + 1];
+    if (begin == end) continue;
+    const float* c = &centroids_[l * dim];
+    for (int64 d = 0; d < dim; ++d) residual[d] = query[d] - c[d];
+    for (int64 m = 0; m < num_subspaces; ++m) {
+      const float* codebook = &codebooks_[m * num_codes * sub_dim];
+      for (int64 j = 0; j < num_codes; ++j) {
+        table[m * num_codes + j] = SquaredDistance(
+            &residual[m * sub_dim], codebook + j * sub_dim, sub_dim);
+      }
+    }
+    for (int64 i = begin; i < end; ++i) {
+      const uint8* code = &codes_[i * num_subspaces];
+      float distance = 0;
+      for (int64 m = 0; m < num_subspaces; ++m) {
+        distance += table[m * num_codes + code[m]];
+      }
+      nearest.push({distance, ids_[i]});
+    }
+  }
+
+  std::unique_ptr<std::vector<std::pair<float, int64>>> result(
+      nearest.Extract());
+  for (int i = 0; i < k; ++i) {
+    if (i < static_cast<int>(result->size())) {
+      distances[i] = (*result)[i].first;
+      ids[i] = (*result)[i].second;
+    } else {
+      distances[i] = std::numeric_limits<float>::infinity();
+      ids[i] = -1;
+    }
+  }
+}
+
+void AnnIndex::Search(const DeviceBase::CpuWorkerThreads& worker_threads,
+                      TTypes<float>::ConstMatrix queries, int k, int nprobe,
+                      TTypes<float>::Matrix distances,
+                      TTypes<int64>::Matrix ids) const {
+  tf_shared_lock l(mu_);
+  const int64 num_queries = queries.dimension(0);
+  const int64 cost_per_query =
+      options_.num_lists * options_.dim * 3 +
+      nprobe * (SizeLocked() / options_.num_lists + 1) *
+          options_.num_subspaces * 2;
+  Shard(worker_threads.num_threads, worker_threads.workers, num_queries,
+        cost_per_query,
+        [&](int64 begin, int64 end) TF_NO_THREAD_SAFETY_ANALYSIS {
+          for (int64 q = begin; q < end; ++q) {
+            SearchOne(&queries(q, 0), k, nprobe, &distances(q, 0), &ids(q, 0));
+          }
+        });
+}
+
+void AnnIndex::ExportLocked(TTypes<float>::Matrix centroids,
+                            TTypes<float, 3>::Tensor codebooks,
+                            TTypes<int32>::Vec list_ids, TTypes<int64>::Vec ids,
+                            TTypes<uint8>::Matrix codes) const {
+  std::copy(centroids_.begin(), centroids_.end(), centroids.data());
+  std::copy(codebooks_.begin(), codebooks_.end(), codebooks.data());
+  std::copy(ids_.begin(), ids_.end(), ids.data());
+  std::copy(codes_.begin(), codes_.end(), codes.data());
+  for (int64 l = 0; l < options_.num_lists; ++l) {
+    for (int64 i = list_offsets_[l]; i < list_offsets_[l + 1]; ++i) {
+      list_ids(i) = l;
+    }
+  }
+}
+
+Status AnnIndex::Import(TTypes<float>::ConstMatrix centroids,
+                        TTypes<float, 3>::ConstTensor codebooks,
+                        TTypes<int32>::ConstVec list_ids,
+                        TTypes<int64>::ConstVec ids,
+                        TTypes<uint8>::ConstMatrix codes) {
+  const int64 num_lists = options_.num_lists;
+  const int64 num_subspaces = options_.num_subspaces;
+  const int64 num_codes = options_.num_codes;
+  if (centroids.dimension(0) != num_lists ||
+      centroids.dimension(1) != options_.dim) {
+    return errors::InvalidArgument(
+        "Expected centroids of shape [", num_lists, ", ", options_.dim,
+        "], got [", centroids.dimension(0), ", ", centroids.dimension(1), "]");
+  }
+  if (codebooks.dimension(0) != num_subspaces ||
+      codebooks.dimension(1) != num_codes ||
+      codebooks.dimension(2) != subspace_dim()) {
+    return errors::InvalidArgument(
+        "Expected codebooks of shape [", num_subspaces, ", ", num_codes, ", ",
+        subspace_dim(), "], got [", codebooks.dimension(0), ", ",
+        codebooks.dimension(1), ", ", codebooks.dimension(2), "]");
+  }
+  const int64 n = ids.size();
+  if (list_ids.size() != n || codes.dimension(0) != n ||
+      codes.dimension(1) != num_subspaces) {
+    return errors::InvalidArgument(
+        "Expected ", n, " list ids and codes of shape [", n, ", ",
+        num_subspaces, "], got ", list_ids.size(), " and [",
+        codes.dimension(0), ", ", codes.dimension(1), "]");
+  }
+
+  // Sorts the vectors by list, keeping their order within each list.
+  std::vector<int64> list_offsets(num_lists + 1, 0);
+  for (int64 i = 0; i < n; ++i) {
+    const int32 l = list_ids(i);
+    if (l < 0 || l >= num_lists) {
+      return errors::InvalidArgument("list_ids[", i, "] = ", l,
+                                     " is not in [0, ", num_lists, ")");
+    }
+    ++list_offsets[l + 1];
+  }
+  for (int64 i = 0; i < n * num_subspaces; ++i) {
+    if (codes.data()[i] >= num_codes) {
+      return errors::InvalidArgument("Code ", static_cast<int>(codes.data()[i]),
+                                     " is not in [0, ", num_codes, ")");
+    }
+  }
+  std::partial_sum(list_offsets.begin(), list_offsets.end(),
+                   list_offsets.begin());
+  std::vector<int64> next(list_offsets.begin(), list_offsets.end() - 1);
+  std::vector<int64> sorted_ids(n);
+  std::vector<uint8> sorted_codes(n * num_subspaces);
+  for (int64 i = 0; i < n; ++i) {
+    const int64 position = next[list_ids(i)]++;
+    sorted_ids[position] = ids(i);
+    std::copy(&codes(i, 0), &codes(i, 0) + num_subspaces,
+              &sorted_codes[position * num_subspaces]);
+  }
+
+  mutex_lock l(mu_);
+  centroids_.assign(centroids.data(), centroids.data() + centroids.size());
+  codebooks_.assign(codebooks.data(), codebooks.data() + codebooks.size());
+  list_offsets_.swap(list_offsets);
+  ids_.swap(sorted_ids);
+  codes_.swap(sorted_codes);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_ANN_INDEX_H_
+#define TENSORFLOW_CORE_KERNELS_ANN_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+struct AnnIndexOptions {
+  // The dimension of the vectors, a multiple of "num_subspaces".
+  int64 dim = 1;
+  // The number of inverted lists, each with a coarse centroid.
+  int64 num_lists = 1;
+  // The residual of a vector to its coarse centroid is split into
+  // "num_subspaces" subvectors, each quantized to one of "num_codes"
+  // centroids, so that a vector is stored as "num_subspaces" bytes.
+  int64 num_subspaces = 1;
+  int64 num_codes = 256;
+  // The number of k-means iterations for the coarse and the product
+  // quantizers, which are trained on at most "max_training_vectors" vectors
+  // sampled with "seed".
+  int64 num_iterations = 10;
+  int64 max_training_vectors = 1 << 16;
+  int64 seed = 0;
+};
+
+// An approximate nearest neighbor index over vectors with int64 ids, for
+// inverted file search with product quantization (IVF-PQ).
+//
+// Build() clusters the vectors into "num_lists" inverted lists with k-means,
+// and stores each vector in the list of its nearest coarse centroid as the
+// product-quantized codes of its residual.  Search() scans the "nprobe"
+// lists nearest to each query.  The squared distance from the query to a
+// vector is approximated by a sum of "num_subspaces" entries of a table of
+// distances from the residual of the query to the centroids of each
+// subspace, computed once per list.
+class AnnIndex : public ResourceBase {
+ public:
+  explicit AnnIndex(const AnnIndexOptions& options);
+
+  string DebugString() const override {
+    return strings::StrCat("AnnIndex(dim=", options_.dim,
+                           ", num_lists=", options_.num_lists,
+                           ", num_subspaces=", options_.num_subspaces, ")");
+  }
+
+  int64 dim() const { return options_.dim; }
+  int64 num_subspaces() const { return options_.num_subspaces; }
+  const AnnIndexOptions& options() const { return options_; }
+
+  // The number of indexed vectors.
+  int64 size() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Trains the quantizers on "vectors" and replaces the contents of the index
+  // with them.  The work is sharded over "worker_threads".
+  Status Build(const DeviceBase::CpuWorkerThreads& worker_threads,
+               TTypes<float>::ConstMatrix vectors,
+               TTypes<int64>::ConstVec ids) TF_LOCKS_EXCLUDED(mu_);
+
+  // Sets the rows of "distances" and "ids" to the (approximate) squared
+  // distances and the ids of the "k" nearest vectors to the rows of
+  // "queries", nearest first, searching the "nprobe" nearest lists.  Missing
+  // neighbors have an infinite distance and an id of -1.
+  void Search(const DeviceBase::CpuWorkerThreads& worker_threads,
+              TTypes<float>::ConstMatrix queries, int k, int nprobe,
+              TTypes<float>::Matrix distances,
+              TTypes<int64>::Matrix ids) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Exports the quantizers and the indexed vectors, as
+  // - "centroids":  [num_lists, dim] coarse centroids,
+  // - "codebooks":  [num_subspaces, num_codes, dim / num_subspaces]
+  //   centroids of the subspaces,
+  // - "list_ids":   [size] the list of each vector,
+  // - "ids":        [size] the id of each vector,
+  // - "codes":      [size, num_subspaces] the codes of each vector.
+  // The caller allocates the outputs with the shapes above while holding a
+  // shared lock on mu().
+  void ExportLocked(TTypes<float>::Matrix centroids,
+                    TTypes<float, 3>::Tensor codebooks,
+                    TTypes<int32>::Vec list_ids, TTypes<int64>::Vec ids,
+                    TTypes<uint8>::Matrix codes) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  int64 SizeLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return static_cast<int64>(list_offsets_.back());
+  }
+
+  // Replaces the contents of the index with the outputs of ExportLocked().
+  Status Import(TTypes<float>::ConstMatrix centroids,
+                TTypes<float, 3>::ConstTensor codebooks,
+                TTypes<int32>::ConstVec list_ids, TTypes<int64>::ConstVec ids,
+                TTypes<uint8>::ConstMatrix codes) TF_LOCKS_EXCLUDED(mu_);
+
+  mutex* mu() TF_LOCK_RETURNED(mu_) { return &mu_; }
+
+ private:
+  int64 subspace_dim() const { return options_.dim / options_.num_subspaces; }
+
+  // Searches a single query for Search().
+  void SearchOne(const float* query, int k, int nprobe, float* distances,
+                 int64* ids) const TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  const AnnIndexOptions options_;
+
+  mutable mutex mu_;
+  // [num_lists, dim] coarse centroids.
+  std::vector<float> centroids_ TF_GUARDED_BY(mu_);
+  // [num_subspaces, num_codes, subspace_dim] centroids of the subspaces.
+  std::vector<float> codebooks_ TF_GUARDED_BY(mu_);
+  // The vectors of list l are at positions [list_offsets_[l],
+  // list_offsets_[l + 1]) of "ids_" and, "num_subspaces" codes per vector,
+  // "codes_".
+  std::vector<int64> list_offsets_ TF_GUARDED_BY(mu_);
+  std::vector<int64> ids_ TF_GUARDED_BY(mu_);
+  std::vector<uint8> codes_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AnnIndex);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_ANN_INDEX_H_
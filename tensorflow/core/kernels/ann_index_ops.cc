@@ -0,0 +1,251 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/lookup_ops.cc.
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/ann_index.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+class AnnIndexHandleOp : public OpKernel {
+ public:
+  explicit AnnIndexHandleOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("container", &container_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &name_));
+    if (name_.empty()) name_ = name();
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dim", &options_.dim));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_lists", &options_.num_lists));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_subspaces", &options_.num_subspaces));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_codes", &options_.num_codes));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("num_iterations", &options_.num_iterations));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("max_training_vectors",
+                                     &options_.max_training_vectors));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("seed", &options_.seed));
+    OP_REQUIRES(ctx, options_.dim % options_.num_subspaces == 0,
+                errors::InvalidArgument("dim (", options_.dim,
+                                        ") must be a multiple of "
+                                        "num_subspaces (",
+                                        options_.num_subspaces, ")"));
+    OP_REQUIRES(ctx, options_.num_codes <= 256,
+                errors::InvalidArgument("num_codes must be at most 256, got ",
+                                        options_.num_codes));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    if (!handle_.IsInitialized()) {
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_RESOURCE, TensorShape({}),
+                                             &handle_, attr));
+      handle_.scalar<ResourceHandle>()() =
+          MakeResourceHandle<AnnIndex>(ctx, container_, name_);
+    }
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupOrCreateResource<AnnIndex>(
+                            ctx, handle_.scalar<ResourceHandle>()(), &index,
+                            [this](AnnIndex** ret) {
+                              *ret = new AnnIndex(options_);
+                              return Status::OK();
+                            }));
+    core::ScopedUnref unref(index);
+    OP_REQUIRES(ctx,
+                index->dim() == options_.dim &&
+                    index->num_subspaces() == options_.num_subspaces &&
+                    index->options().num_lists == options_.num_lists &&
+                    index->options().num_codes == options_.num_codes,
+                errors::InvalidArgument("Shared ", index->DebugString(),
+                                        " does not match the attrs of ",
+                                        name()));
+    ctx->set_output(0, handle_);
+  }
+
+  bool IsExpensive() override { return false; }
+
+ private:
+  string container_;
+  string name_;
+  AnnIndexOptions options_;
+  mutex mu_;
+  Tensor handle_ TF_GUARDED_BY(mu_);
+};
+
+class AnnIndexBuildOp : public OpKernel {
+ public:
+  explicit AnnIndexBuildOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    core::ScopedUnref unref(index);
+    const Tensor& vectors = ctx->input(1);
+    const Tensor& ids = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(vectors.shape()),
+                errors::InvalidArgument("vectors must be a matrix, got ",
+                                        vectors.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES_OK(ctx, index->Build(
+                            *ctx->device()->tensorflow_cpu_worker_threads(),
+                            vectors.matrix<float>(), ids.vec<int64>()));
+  }
+};
+
+class AnnIndexSearchOp : public OpKernel {
+ public:
+  explicit AnnIndexSearchOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    core::ScopedUnref unref(index);
+    const Tensor& queries = ctx->input(1);
+    const Tensor& k_in = ctx->input(2);
+    const Tensor& nprobe_in = ctx->input(3);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(queries.shape()) &&
+                    queries.dim_size(1) == index->dim(),
+                errors::InvalidArgument("queries must have shape [?, ",
+                                        index->dim(), "], got ",
+                                        queries.shape().DebugString()));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(k_in.shape()) &&
+                    TensorShapeUtils::IsScalar(nprobe_in.shape()),
+                errors::InvalidArgument("k and nprobe must be scalars"));
+    const int k = k_in.scalar<int32>()();
+    const int nprobe = nprobe_in.scalar<int32>()();
+    OP_REQUIRES(ctx, k >= 0,
+                errors::InvalidArgument("Need k >= 0, got ", k));
+    OP_REQUIRES(ctx, nprobe >= 1,
+                errors::InvalidArgument("Need nprobe >= 1, got ", nprobe));
+
+    const TensorShape output_shape({queries.dim_size(0), k});
+    Tensor* distances;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &distances));
+    Tensor* ids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, output_shape, &ids));
+    if (k == 0 || queries.dim_size(0) == 0) return;
+    index->Search(*ctx->device()->tensorflow_cpu_worker_threads(),
+                  queries.matrix<float>(), k, nprobe,
+                  distances->matrix<float>(), ids->matrix<int64>());
+  }
+};
+
+class AnnIndexSizeOp : public OpKernel {
+ public:
+  explicit AnnIndexSizeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    core::ScopedUnref unref(index);
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    output->scalar<int64>()() = index->size();
+  }
+};
+
+class AnnIndexExportOp : public OpKernel {
+ public:
+  explicit AnnIndexExportOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    core::ScopedUnref unref(index);
+    const AnnIndexOptions& options = index->options();
+    tf_shared_lock l(*index->mu());
+    const int64 size = index->SizeLocked();
+    Tensor* centroids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0, TensorShape({options.num_lists, options.dim}),
+                            &centroids));
+    Tensor* codebooks;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            1,
+                            TensorShape({options.num_subspaces,
+                                         options.num_codes,
+                                         options.dim / options.num_subspaces}),
+                            &codebooks));
+    Tensor* list_ids;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(2, TensorShape({size}), &list_ids));
+    Tensor* ids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(3, TensorShape({size}), &ids));
+    Tensor* codes;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            4, TensorShape({size, options.num_subspaces}),
+                            &codes));
+    index->ExportLocked(centroids->matrix<float>(),
+                        codebooks->tensor<float, 3>(), list_ids->vec<int32>(),
+                        ids->vec<int64>(), codes->matrix<uint8>());
+  }
+};
+
+class AnnIndexImportOp : public OpKernel {
+ public:
+  explicit AnnIndexImportOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    AnnIndex* index;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &index));
+    core::ScopedUnref unref(index);
+    const Tensor& centroids = ctx->input(1);
+    const Tensor& codebooks = ctx->input(2);
+    const Tensor& list_ids = ctx->input(3);
+    const Tensor& ids = ctx->input(4);
+    const Tensor& codes = ctx->input(5);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(centroids.shape()) &&
+                    codebooks.dims() == 3 &&
+                    TensorShapeUtils::IsVector(list_ids.shape()) &&
+                    TensorShapeUtils::IsVector(ids.shape()) &&
+                    TensorShapeUtils::IsMatrix(codes.shape()),
+                errors::InvalidArgument(
+                    "Expected centroids, codebooks, list_ids, ids and codes "
+                    "of ranks 2, 3, 1, 1 and 2, got ",
+                    centroids.shape().DebugString(), ", ",
+                    codebooks.shape().DebugString(), ", ",
+                    list_ids.shape().DebugString(), ", ",
+                    ids.shape().DebugString(), " and ",
+                    codes.shape().DebugString()));
+    OP_REQUIRES_OK(
+        ctx, index->Import(centroids.matrix<float>(),
+                           codebooks.tensor<float, 3>(), list_ids.vec<int32>(),
+                           ids.vec<int64>(), codes.matrix<uint8>()));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("AnnIndexHandleOp").Device(DEVICE_CPU),
+                        AnnIndexHandleOp);
+REGISTER_KERNEL_BUILDER(Name("AnnIndexBuild").Device(DEVICE_CPU),
+                        AnnIndexBuildOp);
+REGISTER_KERNEL_BUILDER(Name("AnnIndexSearch").Device(DEVICE_CPU),
+                        AnnIndexSearchOp);
+REGISTER_KERNEL_BUILDER(Name("AnnIndexSize").Device(DEVICE_CPU),
+                        AnnIndexSizeOp);
+REGISTER_KERNEL_BUILDER(Name("AnnIndexExport").Device(DEVICE_CPU),
+                        AnnIndexExportOp);
+REGISTER_KERNEL_BUILDER(Name("AnnIndexImport").Device(DEVICE_CPU),
+                        AnnIndexImportOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,168 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/ann_index.h"
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class AnnIndexTest : public ::testing::Test {
+ protected:
+  // Two clusters of 4 vectors.  Each subspace has at most 8 distinct
+  // residuals, so that 8 codes quantize them exactly.
+  AnnIndexTest()
+      : pool_(Env::Default(), "ann_index_test", 2),
+        vectors_(test::AsTensor<float>({0, 0, 0, 0,      //
+                                        1, 0, 0, 0,      //
+                                        0, 2, 0, 0,      //
+                                        0, 0, 3, 1,      //
+                                        10, 10, 10, 10,  //
+                                        11, 10, 10, 10,  //
+                                        10, 12, 10, 10,  //
+                                        10, 10, 13, 11},
+                                       {8, 4})),
+        ids_(test::AsTensor<int64>(
+            {100, 101, 102, 103, 104, 105, 106, 107})) {
+    worker_threads_.num_threads = 2;
+    worker_threads_.workers = &pool_;
+  }
+
+  AnnIndexOptions Options() {
+    AnnIndexOptions options;
+    options.dim = 4;
+    options.num_lists = 2;
+    options.num_subspaces = 2;
+    options.num_codes = 8;
+    return options;
+  }
+
+  void Search(const AnnIndex& index, const Tensor& queries, int k, int nprobe,
+              Tensor* distances, Tensor* ids) {
+    *distances = Tensor(DT_FLOAT, TensorShape({queries.dim_size(0), k}));
+    *ids = Tensor(DT_INT64, TensorShape({queries.dim_size(0), k}));
+    index.Search(worker_threads_, queries.matrix<float>(), k, nprobe,
+                 distances->matrix<float>(), ids->matrix<int64>());
+  }
+
+  // Returns the outputs of ExportLocked().
+  std::vector<Tensor> Export(AnnIndex* index) {
+    tf_shared_lock l(*index->mu());
+    const AnnIndexOptions& options = index->options();
+    const int64 size = index->SizeLocked();
+    std::vector<Tensor> exported = {
+        Tensor(DT_FLOAT, TensorShape({options.num_lists, options.dim})),
+        Tensor(DT_FLOAT,
+               TensorShape({options.num_subspaces, options.num_codes,
+                            options.dim / options.num_subspaces})),
+        Tensor(DT_INT32, TensorShape({size})),
+        Tensor(DT_INT64, TensorShape({size})),
+        Tensor(DT_UINT8, TensorShape({size, options.num_subspaces}))};
+    index->ExportLocked(exported[0].matrix<float>(),
+                        exported[1].tensor<float, 3>(),
+                        exported[2].vec<int32>(), exported[3].vec<int64>(),
+                        exported[4].matrix<uint8>());
+    return exported;
+  }
+
+  thread::ThreadPool pool_;
+  DeviceBase::CpuWorkerThreads worker_threads_;
+  const Tensor vectors_;
+  const Tensor ids_;
+};
+
+TEST_F(AnnIndexTest, SearchesExactlyWhenCodesAreExact) {
+  core::RefCountPtr<AnnIndex> index(new AnnIndex(Options()));
+  TF_ASSERT_OK(index->Build(worker_threads_, vectors_.matrix<float>(),
+                            ids_.vec<int64>()));
+  EXPECT_EQ(8, index->size());
+
+  Tensor distances, ids;
+  Search(*index, test::AsTensor<float>({0, 0, 3, 1, 11, 10, 10, 10}, {2, 4}),
+         3, 2, &distances, &ids);
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>({103, 100, 101, 105, 104, 106}, {2, 3}), ids);
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({0, 10, 11, 0, 1, 5}, {2, 3}), distances, 1e-4);
+}
+
+TEST_F(AnnIndexTest, ScansOnlyTheNearestLists) {
+  core::RefCountPtr<AnnIndex> index(new AnnIndex(Options()));
+  TF_ASSERT_OK(index->Build(worker_threads_, vectors_.matrix<float>(),
+                            ids_.vec<int64>()));
+
+  // The list of the query has 4 vectors, and the other neighbors are missing.
+  Tensor distances, ids;
+  Search(*index, test::AsTensor<float>({10, 10, 10, 10}, {1, 4}), 6, 1,
+         &distances, &ids);
+  test::ExpectTensorEqual<int64>(
+      test::AsTensor<int64>({104, 105, 106, 107, -1, -1}, {1, 6}), ids);
+  EXPECT_EQ(std::numeric_limits<float>::infinity(),
+            distances.matrix<float>()(0, 5));
+}
+
+TEST_F(AnnIndexTest, ExportsAndImports) {
+  core::RefCountPtr<AnnIndex> index(new AnnIndex(Options()));
+  TF_ASSERT_OK(index->Build(worker_threads_, vectors_.matrix<float>(),
+                            ids_.vec<int64>()));
+  const std::vector<Tensor> exported = Export(index.get());
+
+  core::RefCountPtr<AnnIndex> restored(new AnnIndex(Options()));
+  TF_ASSERT_OK(restored->Import(
+      exported[0].matrix<float>(), exported[1].tensor<float, 3>(),
+      exported[2].vec<int32>(), exported[3].vec<int64>(),
+      exported[4].matrix<uint8>()));
+  EXPECT_EQ(8, restored->size());
+
+  const Tensor queries =
+      test::AsTensor<float>({1, 2, 0, 0, 9, 9, 9, 9}, {2, 4});
+  Tensor expected_distances, expected_ids;
+  Search(*index, queries, 4, 2, &expected_distances, &expected_ids);
+  Tensor restored_distances, restored_ids;
+  Search(*restored, queries, 4, 2, &restored_distances, &restored_ids);
+  test::ExpectTensorEqual<int64>(expected_ids, restored_ids);
+  test::ExpectTensorEqual<float>(expected_distances, restored_distances);
+}
+
+TEST_F(AnnIndexTest, RejectsBadInputs) {
+  core::RefCountPtr<AnnIndex> index(new AnnIndex(Options()));
+  const Tensor vectors(DT_FLOAT, TensorShape({8, 3}));
+  EXPECT_FALSE(
+      index->Build(worker_threads_, vectors.matrix<float>(), ids_.vec<int64>())
+          .ok());
+
+  const Tensor list_ids = test::AsTensor<int32>({2});
+  const Tensor ids = test::AsTensor<int64>({0});
+  const Tensor codes = test::AsTensor<uint8>({0, 0}, {1, 2});
+  const Tensor centroids(DT_FLOAT, TensorShape({2, 4}));
+  const Tensor codebooks(DT_FLOAT, TensorShape({2, 8, 2}));
+  EXPECT_FALSE(index
+                   ->Import(centroids.matrix<float>(),
+                            codebooks.tensor<float, 3>(), list_ids.vec<int32>(),
+                            ids.vec<int64>(), codes.matrix<uint8>())
+                   .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <atomic>
+
 #include "absl/strings/str_cat.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/split_lib.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/monitoring/percentile_sampler.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/context.h"
@@ -84,6 +88,35 @@ void RecordBatchDelayMs(int64 batch_delay_ms, const string& model_name) {
   cell->GetCell(model_name)->Add(static_cast<double>(batch_delay_ms));
 }
 
+void RecordTunedBatchSize(int64 batch_size, const string& model_name) {
+  static auto* cell = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/tuned_batch_size",
+      "Tracks the batch size chosen to meet the latency target by model_name "
+      "(if available).",
+      "model_name");
+  cell->GetCell(model_name)->Set(batch_size);
+}
+
+void RecordTunedBatchTimeoutMicros(int64 batch_timeout_micros,
+                                   const string& model_name) {
+  static auto* cell = monitoring::Gauge<int64, 1>::New(
+      "/tensorflow/serving/batching/tuned_batch_timeout_micros",
+      "Tracks the batch timeout chosen to meet the latency target by "
+      "model_name (if available).",
+      "model_name");
+  cell->GetCell(model_name)->Set(batch_timeout_micros);
+}
+
+void RecordQueueDepth(int64 queue_depth, const string& model_name,
+                      const string& priority) {
+  static auto* cell = monitoring::Gauge<int64, 2>::New(
+      "/tensorflow/serving/batching/queue_depth",
+      "Tracks the number of enqueued inputs by model_name (if available) and "
+      "priority.",
+      "model_name", "priority");
+  cell->GetCell(model_name, priority)->Set(queue_depth);
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -314,6 +347,8 @@ class BatchResource : public ResourceBase {
                        const std::vector<int32>& allowed_batch_sizes,
                        FunctionLibraryRuntime::Handle fhandle,
                        bool enable_large_batch_splitting,
+                       int64 latency_target_micros, bool ragged_batching,
+                       const std::vector<int32>& ragged_length_buckets,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
 
@@ -331,8 +366,12 @@ class BatchResource : public ResourceBase {
     // Support for splitting large batch is still in progress.
     new_resource->batcher_queue_options_.enable_large_batch_splitting =
         enable_large_batch_splitting;
+    new_resource->batcher_queue_options_.latency_target_micros =
+        latency_target_micros;
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
+    new_resource->ragged_batching_ = ragged_batching;
+    new_resource->ragged_length_buckets_ = ragged_length_buckets;
 
     new_resource->fhandle_ = fhandle;
 
@@ -346,10 +385,12 @@ class BatchResource : public ResourceBase {
   // be combined with others into a batch, asynchronously.
   Status RegisterInput(int64 guid, OpKernelContext* context,
                        const string& batcher_queue_name,
+                       serving::BatchTaskPriority priority,
                        AsyncOpKernel::DoneCallback done_callback) {
     auto batch_components = MakeUnique<BatchTask>();
     batch_components->start_time = EnvTime::NowNanos();
     batch_components->guid = guid;
+    batch_components->task_priority = priority;
     batch_components->propagated_context = Context(ContextKind::kThread);
     OpInputList tensors;
     TF_RETURN_IF_ERROR(context->input_list("in_tensors", &tensors));
@@ -380,10 +421,29 @@ class BatchResource : public ResourceBase {
     batch_components->context = context;
     batch_components->done_callback = std::move(done_callback);
 
+    // With length buckets, inputs of similar lengths share a queue, and hence
+    // a batch.
+    string queue_name = batcher_queue_name;
+    if (!ragged_length_buckets_.empty()) {
+      const int bucket =
+          std::upper_bound(ragged_length_buckets_.begin(),
+                           ragged_length_buckets_.end(),
+                           static_cast<int64>(batch_components->size())) -
+          ragged_length_buckets_.begin();
+      absl::StrAppend(&queue_name, "/length_bucket_", bucket);
+    }
+    const string& model_name = GetModelName(context);
     BatcherQueue* batcher_queue;
     TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
-    return batcher_queue->Schedule(&batch_components);
+        LookupOrCreateBatcherQueue(queue_name, model_name, &batcher_queue));
+    // Counts the input before it is scheduled, since it may be processed
+    // before Schedule() returns.
+    UpdateQueueDepth(priority, 1, model_name);
+    const Status status = batcher_queue->Schedule(&batch_components);
+    if (!status.ok()) {
+      UpdateQueueDepth(priority, -1, model_name);
+    }
+    return status;
   }
 
  private:
@@ -403,7 +463,12 @@ class BatchResource : public ResourceBase {
 
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
+    serving::BatchTaskPriority priority() const override {
+      return task_priority;
+    }
+
     uint64 start_time;
+    serving::BatchTaskPriority task_priority;
   };
 
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
@@ -530,26 +595,38 @@ class BatchResource : public ResourceBase {
         return errors::FailedPrecondition(
             "Batched output tensor has 0 dimensions");
       }
-      if (output_tensor.shape().dim_size(0) != batch->size() + padding_size) {
+      // In ragged mode, an output either has a row per input value, or a row
+      // per task.
+      const bool one_row_per_task =
+          ragged_batching_ &&
+          output_tensor.shape().dim_size(0) == batch->num_tasks();
+      if (!one_row_per_task &&
+          output_tensor.shape().dim_size(0) != batch->size() + padding_size) {
         return errors::FailedPrecondition(
             "Batched output tensor's 0th dimension does not equal the sum of "
-            "the 0th dimension sizes of the input tensors");
+            "the 0th dimension sizes of the input tensors",
+            ragged_batching_ ? " or the number of batched inputs" : "");
       }
 
       std::vector<Tensor> split_tensor;
       const Status split_status = tensor::Split(
-          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+          output_tensor,
+          one_row_per_task ? std::vector<int64>(batch->num_tasks(), 1)
+                           : task_sizes_plus_optional_padding,
+          &split_tensor);
       DCHECK(split_status.ok()) << split_status.ToString();
       if (!split_status.ok()) {
         return errors::Internal("Tensor split operation failed: ",
                                 split_status.ToString());
       }
-      DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-      if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
+      const size_t expected_num_splits =
+          one_row_per_task ? batch->num_tasks()
+                           : task_sizes_plus_optional_padding.size();
+      DCHECK_EQ(split_tensor.size(), expected_num_splits);
+      if (split_tensor.size() != expected_num_splits) {
         return errors::Internal(
             "Tensor split operation did not work as expected; got ",
-            split_tensor.size(), " splits; expected ",
-            task_sizes_plus_optional_padding.size());
+            split_tensor.size(), " splits; expected ", expected_num_splits);
       }
 
       for (int j = 0; j < batch->num_tasks(); ++j) {
@@ -617,6 +694,17 @@ class BatchResource : public ResourceBase {
     Notification done;
     std::vector<Tensor> args(concatenated_tensors.begin(),
                              concatenated_tensors.end());
+    if (ragged_batching_) {
+      // The concatenated inputs are the values of a ragged tensor with a row
+      // per task, whose row splits follow them.
+      Tensor row_splits(DT_INT64, TensorShape({batch->num_tasks() + 1}));
+      auto row_splits_flat = row_splits.vec<int64>();
+      row_splits_flat(0) = 0;
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        row_splits_flat(i + 1) = row_splits_flat(i) + batch->task(i).size();
+      }
+      args.push_back(std::move(row_splits));
+    }
     const auto& captured_inputs =
         batch->task(batch->num_tasks() - 1).captured_inputs;
     args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
@@ -752,8 +840,9 @@ class BatchResource : public ResourceBase {
   }
 
   // Looks up the batcher queue for 'queue_name'. If it did't previously exist,
-  // creates it.
+  // creates it, reporting its tuning decisions under 'model_name'.
   Status LookupOrCreateBatcherQueue(const string& queue_name,
+                                    const string& model_name,
                                     BatcherQueue** queue) {
     mutex_lock l(batcher_queues_mu_);
 
@@ -764,20 +853,43 @@ class BatchResource : public ResourceBase {
     }
 
     std::unique_ptr<BatcherQueue> new_queue;
-    auto process_batch_callback = [this](std::unique_ptr<Batch> batch) {
+    auto process_batch_callback = [this,
+                                   model_name](std::unique_ptr<Batch> batch) {
+      for (int i = 0; i < batch->num_tasks(); ++i) {
+        UpdateQueueDepth(batch->task(i).priority(), -1, model_name);
+      }
       if (fhandle_ == kInvalidHandle) {
         ProcessBatch(std::move(batch));
       } else {
         ProcessFuncBatch(std::move(batch));
       }
     };
-    TF_RETURN_IF_ERROR(batcher_->AddQueue(batcher_queue_options_,
+    Batcher::QueueOptions queue_options = batcher_queue_options_;
+    if (queue_options.latency_target_micros > 0) {
+      queue_options.latency_tuning_callback =
+          [model_name](size_t batch_size, int64 batch_timeout_micros) {
+            RecordTunedBatchSize(batch_size, model_name);
+            RecordTunedBatchTimeoutMicros(batch_timeout_micros, model_name);
+          };
+    }
+    TF_RETURN_IF_ERROR(batcher_->AddQueue(queue_options,
                                           process_batch_callback, &new_queue));
     *queue = new_queue.get();
     batcher_queues_[queue_name] = std::move(new_queue);
     return Status::OK();
   }
 
+  // Adds 'delta' to the number of enqueued inputs of 'priority', and exports
+  // it.
+  void UpdateQueueDepth(serving::BatchTaskPriority priority, int64 delta,
+                        const string& model_name) const {
+    const bool low = priority == serving::BatchTaskPriority::kLow;
+    std::atomic<int64>& depth =
+        low ? num_enqueued_low_priority_ : num_enqueued_high_priority_;
+    RecordQueueDepth(depth.fetch_add(delta) + delta, model_name,
+                     low ? "low" : "high");
+  }
+
   // A batch scheduler, and options for creating queues.
   std::shared_ptr<Batcher> batcher_;
   Batcher::QueueOptions batcher_queue_options_;
@@ -791,6 +903,17 @@ class BatchResource : public ResourceBase {
 
   std::vector<int32> allowed_batch_sizes_;
   FunctionLibraryRuntime::Handle fhandle_;
+
+  // Whether batches are passed to the function as ragged values and row
+  // splits, without padding.
+  bool ragged_batching_ = false;
+  // The boundaries of the input lengths that are batched separately.
+  std::vector<int32> ragged_length_buckets_;
+
+  // The number of inputs of each priority accepted by a queue and not yet
+  // being processed.
+  mutable std::atomic<int64> num_enqueued_high_priority_{0};
+  mutable std::atomic<int64> num_enqueued_low_priority_{0};
 };
 
 class BatchFunctionKernel : public AsyncOpKernel {
@@ -826,6 +949,31 @@ class BatchFunctionKernel : public AsyncOpKernel {
     } else {
       enable_large_batch_splitting_ = false;
     }
+    if (c->HasAttr("latency_target_micros")) {
+      OP_REQUIRES_OK(
+          c, c->GetAttr("latency_target_micros", &latency_target_micros_));
+    } else {
+      latency_target_micros_ = 0;
+    }
+    OP_REQUIRES(c, latency_target_micros_ >= 0,
+                errors::InvalidArgument(
+                    "latency_target_micros must be non-negative, got ",
+                    latency_target_micros_));
+    ragged_batching_ = false;
+    if (c->HasAttr("ragged_batching")) {
+      OP_REQUIRES_OK(c, c->GetAttr("ragged_batching", &ragged_batching_));
+      OP_REQUIRES_OK(
+          c, c->GetAttr("ragged_length_buckets", &ragged_length_buckets_));
+    }
+    OP_REQUIRES_OK(c, ValidateRaggedBatching());
+    priority_ = serving::BatchTaskPriority::kHigh;
+    if (c->HasAttr("priority")) {
+      string priority;
+      OP_REQUIRES_OK(c, c->GetAttr("priority", &priority));
+      if (priority == "low") {
+        priority_ = serving::BatchTaskPriority::kLow;
+      }
+    }
   }
 
   bool IsExpensive() override { return false; }
@@ -837,7 +985,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, fhandle_,
-          enable_large_batch_splitting_, &new_resource));
+          enable_large_batch_splitting_, latency_target_micros_,
+          ragged_batching_, ragged_length_buckets_, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -846,7 +995,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
                              container_, shared_name_, &br, creator),
                          done);
     const Status status =
-        br->RegisterInput(random::New64(), c, batcher_queue_, done);
+        br->RegisterInput(random::New64(), c, batcher_queue_, priority_, done);
     br->Unref();
     OP_REQUIRES_OK_ASYNC(c, status, done);
     // Assume br calls done, so nothing to do here.
@@ -874,6 +1023,30 @@ class BatchFunctionKernel : public AsyncOpKernel {
     return Status::OK();
   }
 
+  // Validates 'ragged_length_buckets_', which must increase monotonically and
+  // only be set in ragged mode. Ragged batches are never padded, so
+  // 'allowed_batch_sizes_' must be empty.
+  Status ValidateRaggedBatching() const {
+    if (!ragged_batching_) {
+      if (!ragged_length_buckets_.empty()) {
+        return errors::InvalidArgument(
+            "ragged_length_buckets requires ragged_batching");
+      }
+      return Status::OK();
+    }
+    if (!allowed_batch_sizes_.empty()) {
+      return errors::InvalidArgument(
+          "allowed_batch_sizes must be empty with ragged_batching");
+    }
+    for (size_t i = 1; i < ragged_length_buckets_.size(); ++i) {
+      if (ragged_length_buckets_[i] <= ragged_length_buckets_[i - 1]) {
+        return errors::InvalidArgument(
+            "ragged_length_buckets entries must be monotonically increasing");
+      }
+    }
+    return Status::OK();
+  }
+
  private:
   string container_;
   string shared_name_;
@@ -885,6 +1058,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
   std::vector<int32> allowed_batch_sizes_;
   FunctionLibraryRuntime::Handle fhandle_;
   bool enable_large_batch_splitting_;
+  int64 latency_target_micros_;
+  bool ragged_batching_;
+  std::vector<int32> ragged_length_buckets_;
+  serving::BatchTaskPriority priority_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("BatchFunction").Device(DEVICE_CPU),
@@ -918,7 +1095,8 @@ class BatchKernel : public AsyncOpKernel {
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle, false,
-          &new_resource));
+          /*latency_target_micros=*/0, /*ragged_batching=*/false,
+          /*ragged_length_buckets=*/{}, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -927,7 +1105,8 @@ class BatchKernel : public AsyncOpKernel {
                              container_, shared_name_, &br, creator),
                          done);
     const Status status =
-        br->RegisterInput(random::New64(), c, batcher_queue_, done);
+        br->RegisterInput(random::New64(), c, batcher_queue_,
+                          serving::BatchTaskPriority::kHigh, done);
     br->Unref();
     OP_REQUIRES_OK_ASYNC(c, status, done);
     // Assume br calls done, so nothing to do here.
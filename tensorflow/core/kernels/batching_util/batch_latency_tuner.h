@@ -0,0 +1,223 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_TUNER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_TUNER_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Chooses the batch size and batch timeout of a batching queue so as to
+// maximize throughput while keeping the 99th percentile of the task latency
+// under a target.
+//
+// The latency of a task is at most the time it waits for its batch to close
+// (the timeout) plus the time to process the batch. The tuner measures the
+// processing time online, in buckets of batch sizes that are powers of two,
+// and estimates its 99th percentile from a decayed mean and variance. It then
+// picks the bucket with the highest measured throughput (tasks per
+// microsecond) whose estimated 99th percentile fits in the target, and gives
+// the rest of the target to the timeout.
+//
+// The tuner starts from a batch size of 1 and explores one unmeasured bucket
+// at a time, as long as the throughput grows with the batch size. The cost of
+// an unmeasured bucket is extrapolated along the line through the two buckets
+// below it. The statistics of a bucket expire when it has not been measured
+// for a while, so that a bucket left because of a transient slowdown is
+// explored again.
+//
+// The time a closed batch waits for a free batch thread is not modeled, so
+// queues should keep 'max_enqueued_batches' small in this mode.
+//
+// This class is not thread-safe.
+class BatchLatencyTuner {
+ public:
+  struct Options {
+    // The target of the 99th percentile of the latency of a task, in
+    // microseconds. Must be positive.
+    int64 latency_target_micros = 0;
+
+    // The largest batch size the tuner may pick. Must be positive.
+    size_t max_batch_size = 1000;
+
+    // The weight of a new measurement in the decayed statistics of its bucket.
+    double decay = 0.05;
+
+    // The number of measurements a bucket needs before its statistics are
+    // trusted.
+    int min_samples = 8;
+
+    // The number of batches after which the statistics of a bucket that has
+    // not been measured in the meantime expire.
+    int64 expiry_batches = 1000;
+  };
+
+  explicit BatchLatencyTuner(const Options& options);
+
+  // Records that a batch of 'batch_size' took 'processing_micros' to process,
+  // and updates the decision. Returns true iff the decision changed.
+  bool RecordBatch(size_t batch_size, int64 processing_micros);
+
+  // The batch size at which the queue should close a batch.
+  size_t batch_size() const { return batch_size_; }
+
+  // The time a batch may stay open waiting for more tasks.
+  int64 batch_timeout_micros() const { return batch_timeout_micros_; }
+
+ private:
+  struct Bucket {
+    // The largest batch size in the bucket.
+    size_t batch_size;
+    int num_samples = 0;
+    double mean_micros = 0;
+    double variance_micros = 0;
+    // The value of 'num_batches_' at the last measurement.
+    int64 last_batch = 0;
+  };
+
+  // Whether the statistics of 'bucket' are trusted.
+  bool IsMeasured(const Bucket& bucket) const {
+    return bucket.num_samples >= options_.min_samples &&
+           num_batches_ - bucket.last_batch <= options_.expiry_batches;
+  }
+
+  // Recomputes 'batch_size_' and 'batch_timeout_micros_' from the buckets.
+  void Decide();
+
+  const Options options_;
+  std::vector<Bucket> buckets_;
+  // The number of batches recorded so far.
+  int64 num_batches_ = 0;
+  size_t batch_size_;
+  int64 batch_timeout_micros_;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+inline BatchLatencyTuner::BatchLatencyTuner(const Options& options)
+    : options_(options) {
+  DCHECK_GT(options_.latency_target_micros, 0);
+  DCHECK_GT(options_.max_batch_size, 0);
+  for (size_t size = 1; size < options_.max_batch_size; size *= 2) {
+    buckets_.push_back(Bucket{size});
+  }
+  buckets_.push_back(Bucket{options_.max_batch_size});
+  Decide();
+}
+
+inline bool BatchLatencyTuner::RecordBatch(size_t batch_size,
+                                           int64 processing_micros) {
+  auto it = std::lower_bound(buckets_.begin(), buckets_.end(), batch_size,
+                             [](const Bucket& bucket, size_t size) {
+                               return bucket.batch_size < size;
+                             });
+  if (it == buckets_.end()) --it;
+  Bucket& bucket = *it;
+  ++num_batches_;
+  if (num_batches_ - bucket.last_batch > options_.expiry_batches) {
+    bucket.num_samples = 0;
+  }
+  bucket.last_batch = num_batches_;
+  const double x = processing_micros;
+  if (bucket.num_samples == 0) {
+    bucket.variance_micros = 0;
+    bucket.mean_micros = x;
+  } else {
+    // An exponentially weighted mean and variance.
+    const double delta = x - bucket.mean_micros;
+    bucket.mean_micros += options_.decay * delta;
+    bucket.variance_micros = (1 - options_.decay) *
+                             (bucket.variance_micros +
+                              options_.decay * delta * delta);
+  }
+  ++bucket.num_samples;
+
+  const size_t old_batch_size = batch_size_;
+  const int64 old_batch_timeout_micros = batch_timeout_micros_;
+  Decide();
+  return batch_size_ != old_batch_size ||
+         batch_timeout_micros_ != old_batch_timeout_micros;
+}
+
+inline void BatchLatencyTuner::Decide() {
+  // The 99th percentile of a normal distribution is 2.33 standard deviations
+  // above the mean.
+  constexpr double kP99Deviations = 2.33;
+  const double target = options_.latency_target_micros;
+
+  // Falls back to a batch size of 1, for which the timeout does not matter,
+  // when even that misses the target.
+  size_t best_size = buckets_.front().batch_size;
+  double best_p99 = 0;
+  double best_throughput = 0;
+  // The batch sizes and 99th percentiles of the last two measured buckets.
+  size_t previous_size[2] = {0, 0};
+  double previous_p99[2] = {0, 0};
+  for (const Bucket& bucket : buckets_) {
+    if (!IsMeasured(bucket)) {
+      // Explores the first unmeasured bucket while throughput still grows
+      // with the batch size.
+      double slope = 0;
+      if (previous_size[0] > 0) {
+        slope = std::max((previous_p99[1] - previous_p99[0]) /
+                             (previous_size[1] - previous_size[0]),
+                         0.0);
+      } else if (previous_size[1] > 0) {
+        slope = previous_p99[1] / previous_size[1];
+      }
+      const double p99 =
+          previous_p99[1] + slope * (bucket.batch_size - previous_size[1]);
+      if (previous_size[1] > 0 && best_size == previous_size[1] &&
+          p99 <= target) {
+        best_size = bucket.batch_size;
+        best_p99 = p99;
+      }
+      break;
+    }
+    const double mean = bucket.mean_micros;
+    const double p99 =
+        mean + kP99Deviations * std::sqrt(bucket.variance_micros);
+    if (p99 > target) break;
+    const double throughput = bucket.batch_size / std::max(mean, 1.0);
+    if (throughput >= best_throughput) {
+      best_size = bucket.batch_size;
+      best_p99 = p99;
+      best_throughput = throughput;
+    }
+    previous_size[0] = previous_size[1];
+    previous_p99[0] = previous_p99[1];
+    previous_size[1] = bucket.batch_size;
+    previous_p99[1] = p99;
+  }
+
+  batch_size_ = best_size;
+  batch_timeout_micros_ =
+      std::max<int64>(0, static_cast<int64>(target - best_p99));
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_TUNER_H_
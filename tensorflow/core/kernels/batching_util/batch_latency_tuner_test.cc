@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_tuner.h"
+
+#include <functional>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// Feeds 'tuner' batches of the size it picks, which take 'cost' to process.
+void RunBatches(const std::function<int64(size_t)>& cost, int num_batches,
+                BatchLatencyTuner* tuner) {
+  for (int i = 0; i < num_batches; ++i) {
+    tuner->RecordBatch(tuner->batch_size(), cost(tuner->batch_size()));
+  }
+}
+
+// A cost with a fixed overhead, in which batches of 1, 2, 4, 8 and 16 take
+// 120us, 140us, 180us, 260us and 420us.
+int64 AffineCost(size_t batch_size) { return 100 + 20 * batch_size; }
+
+BatchLatencyTuner::Options Options(int64 latency_target_micros) {
+  BatchLatencyTuner::Options options;
+  options.latency_target_micros = latency_target_micros;
+  options.max_batch_size = 16;
+  return options;
+}
+
+TEST(BatchLatencyTunerTest, StartsWithBatchesOfOne) {
+  BatchLatencyTuner tuner(Options(1000));
+  EXPECT_EQ(1, tuner.batch_size());
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_FALSE(tuner.RecordBatch(1, 100));
+  }
+  EXPECT_EQ(1, tuner.batch_size());
+  // Once batches of one are measured, batches of two are tried.
+  EXPECT_TRUE(tuner.RecordBatch(1, 100));
+  EXPECT_EQ(2, tuner.batch_size());
+  EXPECT_EQ(800, tuner.batch_timeout_micros());
+}
+
+TEST(BatchLatencyTunerTest, GrowsToMaxBatchSizeUnderLooseTarget) {
+  BatchLatencyTuner tuner(Options(1000));
+  RunBatches(AffineCost, 100, &tuner);
+  EXPECT_EQ(16, tuner.batch_size());
+  EXPECT_EQ(1000 - 420, tuner.batch_timeout_micros());
+}
+
+TEST(BatchLatencyTunerTest, StopsAtTarget) {
+  BatchLatencyTuner tuner(Options(300));
+  RunBatches(AffineCost, 100, &tuner);
+  // Batches of 16 would take 420us.
+  EXPECT_EQ(8, tuner.batch_size());
+  EXPECT_EQ(300 - 260, tuner.batch_timeout_micros());
+}
+
+TEST(BatchLatencyTunerTest, StopsWhenThroughputDrops) {
+  BatchLatencyTuner tuner(Options(100000));
+  RunBatches(
+      [](size_t batch_size) -> int64 { return 10 * batch_size * batch_size; },
+      100, &tuner);
+  EXPECT_EQ(1, tuner.batch_size());
+}
+
+TEST(BatchLatencyTunerTest, ShrinksWhenCostGrows) {
+  BatchLatencyTuner tuner(Options(1000));
+  RunBatches(AffineCost, 100, &tuner);
+  EXPECT_EQ(16, tuner.batch_size());
+  // Once the cost triples, batches of 16 take 1260us.
+  RunBatches([](size_t batch_size) { return 3 * AffineCost(batch_size); }, 100,
+             &tuner);
+  EXPECT_GT(16, tuner.batch_size());
+  // The buckets measured during the change expire, and the tuner settles on
+  // the largest batch size that meets the target.
+  RunBatches([](size_t batch_size) { return 3 * AffineCost(batch_size); }, 5000,
+             &tuner);
+  EXPECT_EQ(8, tuner.batch_size());
+  EXPECT_EQ(1000 - 780, tuner.batch_timeout_micros());
+}
+
+TEST(BatchLatencyTunerTest, AccountsForVariance) {
+  BatchLatencyTuner tuner(Options(300));
+  // Batches of 8 take 260us on average, but vary by 100us.
+  int i = 0;
+  RunBatches(
+      [&i](size_t batch_size) -> int64 {
+        const int64 mean = AffineCost(batch_size);
+        return batch_size == 8 ? mean + (++i % 2 == 0 ? 100 : -100) : mean;
+      },
+      100, &tuner);
+  EXPECT_EQ(4, tuner.batch_size());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -44,6 +44,11 @@ limitations under the License.
 namespace tensorflow {
 namespace serving {
 
+// The priority classes of tasks, for schedulers that support them (see
+// SharedBatchScheduler). Low-priority tasks, e.g. offline batch scoring, only
+// use the batch capacity that high-priority tasks leave.
+enum class BatchTaskPriority { kHigh, kLow };
+
 // The abstract superclass for a unit of work to be done as part of a batch.
 //
 // An implementing subclass typically contains (or points to):
@@ -62,6 +67,11 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the priority class of the task.
+  virtual BatchTaskPriority priority() const {
+    return BatchTaskPriority::kHigh;
+  }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
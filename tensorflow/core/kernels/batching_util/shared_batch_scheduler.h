@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
@@ -26,6 +27,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/kernels/batching_util/batch_latency_tuner.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -94,6 +96,12 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
+// Each queue keeps the tasks whose priority() is BatchTaskPriority::kLow in a
+// separate lane. A batch of low-priority tasks is only formed when the queue
+// holds no high-priority task, but a batch of high-priority tasks that closes
+// with room to spare may be topped up with low-priority tasks. Batches that
+// are already being processed are never interrupted.
+//
 // TODO(b/26539183): Support queue servicing policies other than round-robin.
 // E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
 // and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
@@ -165,6 +173,26 @@ class SharedBatchScheduler
     // If true, queue implementation would split one input batch task into
     // subtasks and fit them into different batches.
     bool enable_large_batch_splitting = false;
+
+    // If positive, the queue picks its batch size and timeout online to
+    // maximize throughput while keeping the 99th percentile of the task
+    // latency under this many microseconds (see batch_latency_tuner.h). The
+    // batch size then stays at most 'max_batch_size', and
+    // 'batch_timeout_micros' is ignored.
+    int64 latency_target_micros = 0;
+
+    // If set and 'latency_target_micros' is positive, invoked with the new
+    // batch size and timeout whenever the queue changes them, e.g. to export
+    // them as metrics. Invoked from a batch thread, without holding any lock.
+    std::function<void(size_t batch_size, int64 batch_timeout_micros)>
+        latency_tuning_callback;
+
+    // If true, a batch of high-priority tasks is topped up with low-priority
+    // tasks when it closes with room to spare. Low-priority batches never take
+    // high-priority tasks. The low-priority lane holds at most
+    // 'max_enqueued_batches' batches worth of tasks, and its batches close on
+    // the same size and timeout as the high-priority ones.
+    bool fill_with_low_priority_tasks = true;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -285,10 +313,32 @@ class Queue {
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Submits a low-priority task to 'low_priority_tasks_'. Sets
+  // '*notify_of_schedulable_batch' if a batch became schedulable.
+  Status ScheduleLowPriority(std::unique_ptr<TaskType>* task,
+                             bool* notify_of_schedulable_batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Determines whether a batch of low-priority tasks is schedulable, i.e.
+  // whether there are no high-priority tasks and the oldest low-priority task
+  // reached the timeout or there are enough of them to fill a batch.
+  bool IsLowPriorityBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Moves the oldest low-priority tasks that fit into 'batch', which must be
+  // open, up to a size of 'batch_size_limit()'.
+  void AddLowPriorityTasks(Batch<TaskType>* batch)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Determines whether the open batch residing at the back of 'batches_' is
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // The size at which the open batch is closed, and the time it may stay open.
+  // These come from 'latency_tuner_' if there is one, and from 'options_'
+  // otherwise.
+  size_t batch_size_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int64 batch_timeout_micros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -312,6 +362,15 @@ class Queue {
   // The enqueued batches. See the invariants in the class comments above.
   std::deque<std::unique_ptr<Batch<TaskType>>> batches_ TF_GUARDED_BY(mu_);
 
+  // The enqueued low-priority tasks, oldest first, with the times at which
+  // they were enqueued, and the sum of their sizes.
+  struct LowPriorityTask {
+    uint64 enqueue_time_micros;
+    std::unique_ptr<TaskType> task;
+  };
+  std::deque<LowPriorityTask> low_priority_tasks_ TF_GUARDED_BY(mu_);
+  size_t low_priority_tasks_size_ TF_GUARDED_BY(mu_) = 0;
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -327,6 +386,10 @@ class Queue {
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
 
+  // Picks the batch size and timeout if 'options_.latency_target_micros' is
+  // positive; null otherwise.
+  std::unique_ptr<BatchLatencyTuner> latency_tuner_ TF_GUARDED_BY(mu_);
+
   // Used by CloseAndWaitUntilEmpty() to wait until the queue is empty, for the
   // case in which the queue is not empty when CloseAndWaitUntilEmpty() starts.
   // When ProcessBatch() dequeues the last batch and makes the queue empty, if
@@ -415,6 +478,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_target_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_target_micros must be non-negative; was ",
+        options.latency_target_micros);
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -520,6 +588,13 @@ Queue<TaskType>::Queue(
       schedulable_batch_callback_(schedulable_batch_callback) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
+
+  if (options_.latency_target_micros > 0) {
+    BatchLatencyTuner::Options tuner_options;
+    tuner_options.latency_target_micros = options_.latency_target_micros;
+    tuner_options.max_batch_size = options_.max_batch_size;
+    latency_tuner_.reset(new BatchLatencyTuner(tuner_options));
+  }
 }
 
 template <typename TaskType>
@@ -545,27 +620,33 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
 
     DCHECK(!closed_);
 
-    if (batches_.back()->size() + (*task)->size() > options_.max_batch_size) {
-      if (batches_.size() >= options_.max_enqueued_batches) {
-        return errors::Unavailable(
-            "The batch scheduling queue to which this task was submitted is "
-            "full");
+    if ((*task)->priority() == BatchTaskPriority::kLow) {
+      TF_RETURN_IF_ERROR(
+          ScheduleLowPriority(task, &notify_of_schedulable_batch));
+    } else {
+      if (!batches_.back()->empty() &&
+          batches_.back()->size() + (*task)->size() > batch_size_limit()) {
+        if (batches_.size() >= options_.max_enqueued_batches) {
+          return errors::Unavailable(
+              "The batch scheduling queue to which this task was submitted is "
+              "full");
+        }
+        StartNewBatch();
       }
-      StartNewBatch();
-    }
-    if (batches_.back()->empty()) {
-      open_batch_start_time_micros_ = env_->NowMicros();
-    }
-    profiler::TraceMeProducer trace_me(
-        [&] { return strings::StrCat("Schedule:", (*task)->size()); },
-        profiler::ContextType::kSharedBatchScheduler,
-        batches_.back()->traceme_context_id());
-    batches_.back()->AddTask(std::move(*task));
-
-    if (!schedulable_batch_) {
-      if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
-        schedulable_batch_ = true;
-        notify_of_schedulable_batch = true;
+      if (batches_.back()->empty()) {
+        open_batch_start_time_micros_ = env_->NowMicros();
+      }
+      profiler::TraceMeProducer trace_me(
+          [&] { return strings::StrCat("Schedule:", (*task)->size()); },
+          profiler::ContextType::kSharedBatchScheduler,
+          batches_.back()->traceme_context_id());
+      batches_.back()->AddTask(std::move(*task));
+
+      if (!schedulable_batch_) {
+        if (batches_.size() > 1 || IsOpenBatchSchedulable()) {
+          schedulable_batch_ = true;
+          notify_of_schedulable_batch = true;
+        }
       }
     }
   }
@@ -584,7 +665,7 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
   for (const auto& batch : batches_) {
     num_enqueued_tasks += batch->num_tasks();
   }
-  return num_enqueued_tasks;
+  return num_enqueued_tasks + low_priority_tasks_.size();
 }
 
 template <typename TaskType>
@@ -592,10 +673,10 @@ size_t Queue<TaskType>::SchedulingCapacity() const {
   mutex_lock l(mu_);
   const int num_new_batches_schedulable =
       options_.max_enqueued_batches - batches_.size();
+  const size_t batch_size = batch_size_limit();
   const int open_batch_capacity =
-      options_.max_batch_size - batches_.back()->size();
-  return (num_new_batches_schedulable * options_.max_batch_size) +
-         open_batch_capacity;
+      batch_size - std::min(batch_size, batches_.back()->size());
+  return (num_new_batches_schedulable * batch_size) + open_batch_capacity;
 }
 
 template <typename TaskType>
@@ -617,6 +698,12 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+    } else if (IsLowPriorityBatchSchedulable()) {
+      ++num_batches_being_processed_;
+      batch_to_schedule.reset(
+          new Batch<TaskType>(++traceme_context_id_counter_));
+      AddLowPriorityTasks(batch_to_schedule.get());
+      batch_to_schedule->Close();
     } else {
       schedulable_batch_ = false;
     }
@@ -631,15 +718,32 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
       [&batch] { return strings::StrCat("ProcessBatch:", batch->size()); },
       profiler::ContextType::kSharedBatchScheduler,
       batch->traceme_context_id());
+  const size_t batch_size = batch->size();
+  const uint64 start_time_micros = env_->NowMicros();
   process_batch_callback_(std::move(batch));
+  const int64 processing_micros = env_->NowMicros() - start_time_micros;
 
+  bool notify_of_tuning = false;
+  size_t tuned_batch_size = 0;
+  int64 tuned_batch_timeout_micros = 0;
   {
     mutex_lock l(mu_);
     --num_batches_being_processed_;
+    if (latency_tuner_ != nullptr &&
+        latency_tuner_->RecordBatch(batch_size, processing_micros)) {
+      notify_of_tuning = options_.latency_tuning_callback != nullptr;
+      tuned_batch_size = latency_tuner_->batch_size();
+      tuned_batch_timeout_micros = latency_tuner_->batch_timeout_micros();
+    }
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
     }
   }
+
+  if (notify_of_tuning) {
+    options_.latency_tuning_callback(tuned_batch_size,
+                                     tuned_batch_timeout_micros);
+  }
 }
 
 template <typename TaskType>
@@ -667,11 +771,14 @@ void Queue<TaskType>::CloseAndWaitUntilEmpty() {
 template <typename TaskType>
 bool Queue<TaskType>::IsEmptyInternal() const {
   return num_batches_being_processed_ == 0 && batches_.size() == 1 &&
-         batches_.back()->empty();
+         batches_.back()->empty() && low_priority_tasks_.empty();
 }
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  if (options_.fill_with_low_priority_tasks) {
+    AddLowPriorityTasks(batches_.back().get());
+  }
   batches_.back()->Close();
   batches_.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
@@ -682,9 +789,63 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= options_.max_batch_size ||
+  return closed_ || open_batch->size() >= batch_size_limit() ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros();
+}
+
+template <typename TaskType>
+Status Queue<TaskType>::ScheduleLowPriority(std::unique_ptr<TaskType>* task,
+                                            bool* notify_of_schedulable_batch) {
+  if (low_priority_tasks_size_ + (*task)->size() >
+      options_.max_enqueued_batches * options_.max_batch_size) {
+    return errors::Unavailable(
+        "The low-priority lane of the batch scheduling queue to which this "
+        "task was submitted is full");
+  }
+  low_priority_tasks_size_ += (*task)->size();
+  low_priority_tasks_.push_back({env_->NowMicros(), std::move(*task)});
+  if (!schedulable_batch_ && IsLowPriorityBatchSchedulable()) {
+    schedulable_batch_ = true;
+    *notify_of_schedulable_batch = true;
+  }
+  return Status::OK();
+}
+
+template <typename TaskType>
+bool Queue<TaskType>::IsLowPriorityBatchSchedulable() const {
+  if (low_priority_tasks_.empty() || batches_.size() > 1 ||
+      !batches_.back()->empty()) {
+    return false;
+  }
+  return closed_ || low_priority_tasks_size_ >= batch_size_limit() ||
+         env_->NowMicros() >= low_priority_tasks_.front().enqueue_time_micros +
+                                  batch_timeout_micros();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::AddLowPriorityTasks(Batch<TaskType>* batch) {
+  const size_t limit = batch_size_limit();
+  while (!low_priority_tasks_.empty()) {
+    std::unique_ptr<TaskType>& task = low_priority_tasks_.front().task;
+    // A task larger than the limit still gets a batch of its own.
+    if (!batch->empty() && batch->size() + task->size() > limit) break;
+    low_priority_tasks_size_ -= task->size();
+    batch->AddTask(std::move(task));
+    low_priority_tasks_.pop_front();
+  }
+}
+
+template <typename TaskType>
+size_t Queue<TaskType>::batch_size_limit() const {
+  return latency_tuner_ != nullptr ? latency_tuner_->batch_size()
+                                   : options_.max_batch_size;
+}
+
+template <typename TaskType>
+int64 Queue<TaskType>::batch_timeout_micros() const {
+  return latency_tuner_ != nullptr ? latency_tuner_->batch_timeout_micros()
+                                   : options_.batch_timeout_micros;
 }
 
 template <typename TaskType>
@@ -28,22 +28,28 @@ namespace {
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size,
+                    BatchTaskPriority priority = BatchTaskPriority::kHigh)
+      : size_(size), priority_(priority) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  BatchTaskPriority priority() const override { return priority_; }
+
  private:
   const size_t size_;
+  const BatchTaskPriority priority_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(FakeTask);
 };
 
 // Creates a FakeTask of size 'task_size', and calls 'scheduler->Schedule()' on
 // that task. Returns the resulting status.
-Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler) {
-  std::unique_ptr<FakeTask> task(new FakeTask(task_size));
+Status ScheduleTask(size_t task_size, BatchScheduler<FakeTask>* scheduler,
+                    BatchTaskPriority priority = BatchTaskPriority::kHigh) {
+  std::unique_ptr<FakeTask> task(new FakeTask(task_size, priority));
   Status status = scheduler->Schedule(&task);
   // Schedule() should have consumed 'task' iff it returned Status::OK.
   CHECK_EQ(status.ok(), task == nullptr);
@@ -463,6 +469,120 @@ TEST(SharedBatchSchedulerTest, ConstMethods) {
   }
 }
 
+TEST(SharedBatchSchedulerTest, LatencyTargetGrowsBatchSize) {
+  mutex mu;
+  std::vector<int> batch_num_tasks;
+  Notification processed[8];
+  auto callback = [&mu, &batch_num_tasks,
+                   &processed](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    mutex_lock l(mu);
+    batch_num_tasks.push_back(batch->num_tasks());
+    if (batch_num_tasks.size() <= 8) {
+      processed[batch_num_tasks.size() - 1].Notify();
+    }
+  };
+  Notification tuned;
+  size_t tuned_batch_size = 0;
+  auto tuning_callback = [&tuned, &tuned_batch_size](
+                             size_t batch_size, int64 batch_timeout_micros) {
+    tuned_batch_size = batch_size;
+    tuned.Notify();
+  };
+
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 10;
+  queue_options.max_enqueued_batches = 2;
+  queue_options.latency_target_micros = 10 * 1000 * 1000;  // 10 seconds
+  queue_options.latency_tuning_callback = tuning_callback;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+  // The queue starts with batches of one task, until it has measured them.
+  for (int i = 0; i < 8; ++i) {
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    processed[i].WaitForNotification();
+  }
+  tuned.WaitForNotification();
+  EXPECT_EQ(2, tuned_batch_size);
+
+  // Batches of one task are fast enough to try batches of two.
+  TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+  queue = nullptr;
+  mutex_lock l(mu);
+  EXPECT_EQ(std::vector<int>({1, 1, 1, 1, 1, 1, 1, 1, 2}), batch_num_tasks);
+}
+
+// Runs batches of high-priority tasks of sizes 4 and 2, and three low-priority
+// tasks of size 1, on a single thread with a maximum batch size of 4. Returns
+// the sizes of the tasks of each batch, negated for low-priority tasks.
+std::vector<std::vector<int>> RunPriorityLanes(
+    bool fill_with_low_priority_tasks) {
+  mutex mu;
+  std::vector<std::vector<int>> batches;
+  Notification processing, proceed;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    CHECK(batch->IsClosed());
+    if (!processing.HasBeenNotified()) {
+      processing.Notify();
+    }
+    proceed.WaitForNotification();
+    std::vector<int> batch_data;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      const FakeTask& task = batch->task(i);
+      batch_data.push_back(task.priority() == BatchTaskPriority::kLow
+                               ? -static_cast<int>(task.size())
+                               : task.size());
+    }
+    mutex_lock l(mu);
+    batches.push_back(batch_data);
+  };
+
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_CHECK_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.max_batch_size = 4;
+  queue_options.batch_timeout_micros = 0;
+  queue_options.fill_with_low_priority_tasks = fill_with_low_priority_tasks;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  TF_CHECK_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+  // Keep the thread busy while the low-priority tasks, and then a smaller
+  // high-priority task, are enqueued.
+  TF_CHECK_OK(ScheduleTask(4, queue.get()));
+  processing.WaitForNotification();
+  for (int i = 0; i < 3; ++i) {
+    TF_CHECK_OK(ScheduleTask(1, queue.get(), BatchTaskPriority::kLow));
+  }
+  TF_CHECK_OK(ScheduleTask(2, queue.get()));
+  EXPECT_EQ(4, queue->NumEnqueuedTasks());
+  proceed.Notify();
+  queue = nullptr;
+
+  mutex_lock l(mu);
+  return batches;
+}
+
+TEST(SharedBatchSchedulerTest, TopsUpHighPriorityBatches) {
+  // The batch of the second high-priority task takes low-priority tasks to
+  // fill it, and the rest form a batch of their own.
+  EXPECT_EQ(std::vector<std::vector<int>>({{4}, {2, -1, -1}, {-1}}),
+            RunPriorityLanes(/*fill_with_low_priority_tasks=*/true));
+}
+
+TEST(SharedBatchSchedulerTest, HighPriorityTasksGoFirst) {
+  // Even though the low-priority tasks were enqueued first.
+  EXPECT_EQ(std::vector<std::vector<int>>({{4}, {2}, {-1, -1, -1}}),
+            RunPriorityLanes(/*fill_with_low_priority_tasks=*/false));
+}
+
 TEST(SharedBatchSchedulerTest, OneFullQueueDoesntBlockOtherQueues) {
   Notification queue_0_processing, queue_0_proceed;
   auto queue_0_callback = [&queue_0_processing, &queue_0_proceed](
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -100,82 +101,104 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
                    context->output_list("right_node_contribs_list",
                                         &output_right_node_contribs_list));
 
-    // Use identity later to convert float to Eigen::Matrix type for input to
-    // CalculateWeightsAndGains. This op only supports single dimension logits.
-    Eigen::MatrixXf identity;
-    identity.setIdentity(1, 1);
+    // Per-feature best splits, filled in parallel and copied to the outputs
+    // afterwards, since outputs must be allocated from one thread.
+    struct FeatureSplits {
+      std::vector<int32> node_ids;
+      std::vector<float> gains;
+      std::vector<int32> thresholds;
+      std::vector<float> left_node_contribs;
+      std::vector<float> right_node_contribs;
+    };
+    std::vector<FeatureSplits> feature_splits(num_features_);
+
     // Get the best split info per node for each feature.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+    auto do_features = [&](int64 start, int64 end) {
+      // Use identity later to convert float to Eigen::Matrix type for input to
+      // CalculateWeightsAndGains. This op only supports single dimension
+      // logits.
+      Eigen::MatrixXf identity;
+      identity.setIdentity(1, 1);
       std::vector<float> cum_grad;
       std::vector<float> cum_hess;
       cum_grad.reserve(num_buckets);
       cum_hess.reserve(num_buckets);
-
-      std::vector<int32> output_node_ids;
-      std::vector<float> output_gains;
-      std::vector<int32> output_thresholds;
-      std::vector<float> output_left_node_contribs;
-      std::vector<float> output_right_node_contribs;
-      for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
-        // Calculate gains.
-        cum_grad.clear();
-        cum_hess.clear();
-        float total_grad = 0.0;
-        float total_hess = 0.0;
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
-          total_grad += stats_summary[feature_idx](node_id, bucket, 0);
-          total_hess += stats_summary[feature_idx](node_id, bucket, 1);
-          cum_grad.push_back(total_grad);
-          cum_hess.push_back(total_hess);
-        }
-        // Check if node has enough of average hessian.
-        if (total_hess < min_node_weight) {
-          // Do not split the node because not enough avg hessian.
-          continue;
-        }
-        float best_gain = std::numeric_limits<float>::lowest();
-        float best_bucket = 0;
-        float best_contrib_for_left = 0.0;
-        float best_contrib_for_right = 0.0;
-        // Parent gain.
-        float parent_gain;
-        Eigen::VectorXf unused(1);
-        CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
-                                 l1, l2, &unused, &parent_gain);
-
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          const float cum_grad_bucket = cum_grad[bucket];
-          const float cum_hess_bucket = cum_hess[bucket];
-          // Left child.
-          Eigen::VectorXf contrib_for_left(1);
-          float gain_for_left;
-          CalculateWeightsAndGains(cum_grad_bucket * identity,
-                                   cum_hess_bucket * identity, l1, l2,
-                                   &contrib_for_left, &gain_for_left);
-          // Right child.
-          // use contrib_for_right.
-          Eigen::VectorXf contrib_for_right(1);
-          float gain_for_right;
-          CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
-                                   (total_hess - cum_hess_bucket) * identity,
-                                   l1, l2, &contrib_for_right, &gain_for_right);
-
-          if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
-            best_gain = gain_for_left + gain_for_right;
-            best_bucket = bucket;
-            best_contrib_for_left = contrib_for_left[0];
-            best_contrib_for_right = contrib_for_right[0];
+      for (int64 feature_idx = start; feature_idx < end; ++feature_idx) {
+        FeatureSplits* splits = &feature_splits[feature_idx];
+        for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
+          // Calculate gains.
+          cum_grad.clear();
+          cum_hess.clear();
+          float total_grad = 0.0;
+          float total_hess = 0.0;
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
+            total_grad += stats_summary[feature_idx](node_id, bucket, 0);
+            total_hess += stats_summary[feature_idx](node_id, bucket, 1);
+            cum_grad.push_back(total_grad);
+            cum_hess.push_back(total_hess);
+          }
+          // Check if node has enough of average hessian.
+          if (total_hess < min_node_weight) {
+            // Do not split the node because not enough avg hessian.
+            continue;
           }
-        }  // for bucket
-        output_node_ids.push_back(node_id);
-        // Remove the parent gain for the parent node.
-        output_gains.push_back(best_gain - parent_gain);
-        output_thresholds.push_back(best_bucket);
-        output_left_node_contribs.push_back(best_contrib_for_left);
-        output_right_node_contribs.push_back(best_contrib_for_right);
-      }  // for node_id
-      const int num_nodes = output_node_ids.size();
+          float best_gain = std::numeric_limits<float>::lowest();
+          float best_bucket = 0;
+          float best_contrib_for_left = 0.0;
+          float best_contrib_for_right = 0.0;
+          // Parent gain.
+          float parent_gain;
+          Eigen::VectorXf unused(1);
+          CalculateWeightsAndGains(total_grad * identity,
+                                   total_hess * identity, l1, l2, &unused,
+                                   &parent_gain);
+
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            const float cum_grad_bucket = cum_grad[bucket];
+            const float cum_hess_bucket = cum_hess[bucket];
+            // Left child.
+            Eigen::VectorXf contrib_for_left(1);
+            float gain_for_left;
+            CalculateWeightsAndGains(cum_grad_bucket * identity,
+                                     cum_hess_bucket * identity, l1, l2,
+                                     &contrib_for_left, &gain_for_left);
+            // Right child.
+            // use contrib_for_right.
+            Eigen::VectorXf contrib_for_right(1);
+            float gain_for_right;
+            CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
+                                     (total_hess - cum_hess_bucket) * identity,
+                                     l1, l2, &contrib_for_right,
+                                     &gain_for_right);
+
+            if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
+              best_gain = gain_for_left + gain_for_right;
+              best_bucket = bucket;
+              best_contrib_for_left = contrib_for_left[0];
+              best_contrib_for_right = contrib_for_right[0];
+            }
+          }  // for bucket
+          splits->node_ids.push_back(node_id);
+          // Remove the parent gain for the parent node.
+          splits->gains.push_back(best_gain - parent_gain);
+          splits->thresholds.push_back(best_bucket);
+          splits->left_node_contribs.push_back(best_contrib_for_left);
+          splits->right_node_contribs.push_back(best_contrib_for_right);
+        }  // for node_id
+      }    // for feature_idx
+    };
+    // Each bucket of each node costs two gain computations.
+    const int64 cost_per_feature =
+        (node_id_last - node_id_first) * num_buckets * 100;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          cost_per_feature, do_features);
+
+    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+      const FeatureSplits& splits = feature_splits[feature_idx];
+      const int num_nodes = splits.node_ids.size();
       // output_node_ids
       Tensor* output_node_ids_t;
       OP_REQUIRES_OK(context,
@@ -209,13 +232,14 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
           output_right_node_contribs_t->matrix<float>();
       // Sets output tensors from vectors.
       for (int i = 0; i < num_nodes; ++i) {
-        output_node_ids_vec(i) = output_node_ids[i];
+        output_node_ids_vec(i) = splits.node_ids[i];
         // Adjust the gains to penalize by tree complexity.
-        output_gains_vec(i) = output_gains[i] - tree_complexity;
-        output_thresholds_vec(i) = output_thresholds[i];
-        output_left_node_contribs_matrix(i, 0) = output_left_node_contribs[i];
+        output_gains_vec(i) = splits.gains[i] - tree_complexity;
+        output_thresholds_vec(i) = splits.thresholds[i];
+        output_left_node_contribs_matrix(i, 0) = splits.left_node_contribs[i];
         // This op only supports 1-dimensional logits.
-        output_right_node_contribs_matrix(i, 0) = output_right_node_contribs[i];
+        output_right_node_contribs_matrix(i, 0) =
+            splits.right_node_contribs[i];
       }
     }  // for f
   }
@@ -639,90 +663,95 @@ class BoostedTreesCalculateBestFeatureSplitV2 : public OpKernel {
                    context->input("min_node_weight", &min_node_weight_t));
     const auto min_node_weight = min_node_weight_t->scalar<float>()();
 
-    std::vector<int32> output_node_ids;
-    std::vector<float> output_gains;
-    std::vector<int32> output_feature_ids;
-    std::vector<int32> output_feature_dimensions;
-    std::vector<int32> output_thresholds;
-    std::vector<Eigen::VectorXf> output_left_node_contribs;
-    std::vector<Eigen::VectorXf> output_right_node_contribs;
-    std::vector<string> output_split_types;
+    // Best split per node in [node_id_first, node_id_last), found in
+    // parallel. Nodes without a split keep the lowest gain and are skipped
+    // when the outputs are filled in.
+    struct NodeSplit {
+      float gain = std::numeric_limits<float>::lowest();
+      float parent_gain;
+      int32 bucket;
+      int32 f_id;
+      int32 f_dim;
+      string split_type;
+      Eigen::VectorXf contrib_for_left;
+      Eigen::VectorXf contrib_for_right;
+    };
+    std::vector<NodeSplit> node_splits(node_id_last - node_id_first);
 
-    // TODO(tanzheny) parallelize the computation.
     // Iterate each node and find the best gain per node.
-    float parent_gain;
-    for (int32 node_id = node_id_first; node_id < node_id_last; ++node_id) {
-      float best_gain = std::numeric_limits<float>::lowest();
-      int32 best_bucket;
-      int32 best_f_id;
-      int32 best_f_dim;
-      string best_split_type;
-      Eigen::VectorXf best_contrib_for_left(logits_dim);
-      Eigen::VectorXf best_contrib_for_right(logits_dim);
-
-      // Sum of gradient and hessian. Compute parent gain using first feature.
-      ConstMatrixMap stats_mat(&stats_summaries[0](node_id, 0, 0, 0),
-                               num_buckets + 1,  // Including default bucket.
-                               logits_dim + hessian_dim);
-      const Eigen::VectorXf total_grad =
-          stats_mat.leftCols(logits_dim).colwise().sum();
-      const Eigen::VectorXf total_hess =
-          stats_mat.rightCols(hessian_dim).colwise().sum();
-      if (total_hess.norm() < min_node_weight) {
-        continue;
-      }
-      Eigen::VectorXf unused(logits_dim);
-      CalculateWeightsAndGains(total_grad, total_hess, l1, l2, &unused,
-                               &parent_gain);
-      for (int f_idx = 0; f_idx < num_features_; ++f_idx) {
-        const string split_type = split_types(f_idx);
-        TTypes<float, 4>::ConstTensor stats_summary = stats_summaries[f_idx];
-        float f_best_gain = std::numeric_limits<float>::lowest();
-        int32 f_best_bucket;
-        int32 f_best_f_dim;
-        string f_best_split_type;
-        Eigen::VectorXf f_best_contrib_for_left(logits_dim);
-        Eigen::VectorXf f_best_contrib_for_right(logits_dim);
-
-        if (split_type == kInequalitySplit) {
-          CalculateBestInequalitySplit(
-              stats_summary, node_id, feature_dims, logits_dim, hessian_dim,
-              num_buckets, min_node_weight, l1, l2, &f_best_gain,
-              &f_best_bucket, &f_best_f_dim, &f_best_split_type,
-              &f_best_contrib_for_left, &f_best_contrib_for_right);
-        } else {
-          CalculateBestEqualitySplit(
-              stats_summary, total_grad, total_hess, node_id, feature_dims,
-              logits_dim, hessian_dim, num_buckets, l1, l2, &f_best_gain,
-              &f_best_bucket, &f_best_f_dim, &f_best_split_type,
-              &f_best_contrib_for_left, &f_best_contrib_for_right);
-        }
-        if (f_best_gain > best_gain) {
-          best_gain = f_best_gain;
-          best_f_id = candidate_feature_ids(f_idx);
-          best_f_dim = f_best_f_dim;
-          best_split_type = f_best_split_type;
-          best_bucket = f_best_bucket;
-          best_contrib_for_left = f_best_contrib_for_left;
-          best_contrib_for_right = f_best_contrib_for_right;
+    auto do_nodes = [&](int64 start, int64 end) {
+      for (int64 i = start; i < end; ++i) {
+        const int32 node_id = node_id_first + i;
+        NodeSplit* best = &node_splits[i];
+        best->contrib_for_left.resize(logits_dim);
+        best->contrib_for_right.resize(logits_dim);
+
+        // Sum of gradient and hessian. Compute parent gain using first
+        // feature.
+        ConstMatrixMap stats_mat(&stats_summaries[0](node_id, 0, 0, 0),
+                                 num_buckets + 1,  // Including default bucket.
+                                 logits_dim + hessian_dim);
+        const Eigen::VectorXf total_grad =
+            stats_mat.leftCols(logits_dim).colwise().sum();
+        const Eigen::VectorXf total_hess =
+            stats_mat.rightCols(hessian_dim).colwise().sum();
+        if (total_hess.norm() < min_node_weight) {
+          continue;
         }
-      }  // For feature id.
-      if (best_gain == std::numeric_limits<float>::lowest()) {
-        // Do not add the node if no split is found.
-        continue;
+        Eigen::VectorXf unused(logits_dim);
+        CalculateWeightsAndGains(total_grad, total_hess, l1, l2, &unused,
+                                 &best->parent_gain);
+        for (int f_idx = 0; f_idx < num_features_; ++f_idx) {
+          const string split_type = split_types(f_idx);
+          TTypes<float, 4>::ConstTensor stats_summary = stats_summaries[f_idx];
+          float f_best_gain = std::numeric_limits<float>::lowest();
+          int32 f_best_bucket;
+          int32 f_best_f_dim;
+          string f_best_split_type;
+          Eigen::VectorXf f_best_contrib_for_left(logits_dim);
+          Eigen::VectorXf f_best_contrib_for_right(logits_dim);
+
+          if (split_type == kInequalitySplit) {
+            CalculateBestInequalitySplit(
+                stats_summary, node_id, feature_dims, logits_dim, hessian_dim,
+                num_buckets, min_node_weight, l1, l2, &f_best_gain,
+                &f_best_bucket, &f_best_f_dim, &f_best_split_type,
+                &f_best_contrib_for_left, &f_best_contrib_for_right);
+          } else {
+            CalculateBestEqualitySplit(
+                stats_summary, total_grad, total_hess, node_id, feature_dims,
+                logits_dim, hessian_dim, num_buckets, l1, l2, &f_best_gain,
+                &f_best_bucket, &f_best_f_dim, &f_best_split_type,
+                &f_best_contrib_for_left, &f_best_contrib_for_right);
+          }
+          if (f_best_gain > best->gain) {
+            best->gain = f_best_gain;
+            best->f_id = candidate_feature_ids(f_idx);
+            best->f_dim = f_best_f_dim;
+            best->split_type = f_best_split_type;
+            best->bucket = f_best_bucket;
+            best->contrib_for_left = f_best_contrib_for_left;
+            best->contrib_for_right = f_best_contrib_for_right;
+          }
+        }  // For feature id.
+      }    // for node id.
+    };
+    // Each bucket of each feature dimension costs up to four gain
+    // computations, each of which may solve a logits_dim system.
+    const int64 cost_per_node = static_cast<int64>(num_features_) *
+                                feature_dims * num_buckets * logits_dim * 400;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          node_splits.size(), cost_per_node, do_nodes);
+
+    // Do not add the nodes for which no split is found.
+    std::vector<int32> output_node_ids;
+    for (int32 i = 0; i < node_id_last - node_id_first; ++i) {
+      if (node_splits[i].gain != std::numeric_limits<float>::lowest()) {
+        output_node_ids.push_back(node_id_first + i);
       }
-      output_node_ids.push_back(node_id);
-      // Remove the parent gain for the parent node.
-      output_gains.push_back(best_gain - parent_gain);
-      output_feature_ids.push_back(best_f_id);
-      output_feature_dimensions.push_back(best_f_dim);
-      // Default direction is fixed for dense splits.
-      // TODO(tanzheny) account for default values.
-      output_split_types.push_back(best_split_type);
-      output_thresholds.push_back(best_bucket);
-      output_left_node_contribs.push_back(best_contrib_for_left);
-      output_right_node_contribs.push_back(best_contrib_for_right);
-    }  // for node id.
+    }
     const int num_nodes = output_node_ids.size();
     // output_node_ids
     Tensor* output_node_ids_t = nullptr;
@@ -781,19 +810,21 @@ class BoostedTreesCalculateBestFeatureSplitV2 : public OpKernel {
 
     // Sets output tensors from vectors.
     for (int i = 0; i < num_nodes; ++i) {
+      const NodeSplit& split = node_splits[output_node_ids[i] - node_id_first];
       output_node_ids_vec(i) = output_node_ids[i];
-      output_features_vec(i) = output_feature_ids[i];
-      // Adjust the gains to penalize by tree complexity.
-      output_gains_vec(i) = output_gains[i] - tree_complexity;
-      output_feature_dimensions_vec(i) = output_feature_dimensions[i];
-      output_thresholds_vec(i) = output_thresholds[i];
+      output_features_vec(i) = split.f_id;
+      // Remove the parent gain for the parent node, and adjust the gains to
+      // penalize by tree complexity.
+      output_gains_vec(i) = split.gain - split.parent_gain - tree_complexity;
+      output_feature_dimensions_vec(i) = split.f_dim;
+      output_thresholds_vec(i) = split.bucket;
       for (int j = 0; j < logits_dim; ++j) {
-        output_left_node_contribs_matrix(i, j) =
-            output_left_node_contribs[i][j];
-        output_right_node_contribs_matrix(i, j) =
-            output_right_node_contribs[i][j];
+        output_left_node_contribs_matrix(i, j) = split.contrib_for_left[j];
+        output_right_node_contribs_matrix(i, j) = split.contrib_for_right[j];
       }
-      output_split_types_vec(i) = output_split_types[i];
+      // Default direction is fixed for dense splits.
+      // TODO(tanzheny) account for default values.
+      output_split_types_vec(i) = split.split_type;
     }
   }
 
@@ -1277,16 +1308,26 @@ class BoostedTreesMakeStatsSummaryOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    // Partition by node, and then bucketize.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      const auto& features = bucketized_features_list[feature_idx].vec<int32>();
-      for (int i = 0; i < batch_size; ++i) {
-        const int32 node = node_ids(i);
-        const int32 bucket = features(i);
-        temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
-        temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+    // Partition by node, and then bucketize. Each feature owns a contiguous
+    // [max_splits, num_buckets, 2] slice, so features are accumulated in
+    // parallel without synchronization.
+    auto do_features = [&](int64 start, int64 end) {
+      for (int64 feature_idx = start; feature_idx < end; ++feature_idx) {
+        const auto& features =
+            bucketized_features_list[feature_idx].vec<int32>();
+        for (int i = 0; i < batch_size; ++i) {
+          const int32 node = node_ids(i);
+          const int32 bucket = features(i);
+          temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
+          temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+        }
       }
-    }
+    };
+    const int64 cost_per_feature = batch_size * 10;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          cost_per_feature, do_features);
 
     // Copy temp tensor over to output tensor.
     Tensor* output_stats_summary_t = nullptr;
@@ -1354,22 +1395,31 @@ class BoostedTreesAggregateStatsOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    for (int i = 0; i < batch_size; ++i) {
-      const int32 node = node_ids(i);
-      for (int feature_dim = 0; feature_dim < feature_dims; ++feature_dim) {
-        const int32 feature_value = feature(i, feature_dim);
-        const int32 bucket =
-            (feature_value == -1) ? num_buckets_ : feature_value;
-        for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              gradients(i, stat_dim);
-        }
-        for (int stat_dim = logits_dims; stat_dim < stats_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              hessians(i, stat_dim - logits_dims);
+    // Feature dimensions write disjoint entries, so they are accumulated in
+    // parallel without synchronization.
+    auto do_feature_dims = [&](int64 start, int64 end) {
+      for (int i = 0; i < batch_size; ++i) {
+        const int32 node = node_ids(i);
+        for (int64 feature_dim = start; feature_dim < end; ++feature_dim) {
+          const int32 feature_value = feature(i, feature_dim);
+          const int32 bucket =
+              (feature_value == -1) ? num_buckets_ : feature_value;
+          for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                gradients(i, stat_dim);
+          }
+          for (int stat_dim = logits_dims; stat_dim < stats_dims; ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                hessians(i, stat_dim - logits_dims);
+          }
         }
       }
-    }
+    };
+    const int64 cost_per_feature_dim = batch_size * stats_dims * 10;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, feature_dims,
+          cost_per_feature_dim, do_feature_dims);
 
     // Copy temp tensor over to output tensor, downcasting to float.
     Tensor* output_stats_summary_t = nullptr;
@@ -182,6 +182,13 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
     OP_REQUIRES_OK(
         c, c->GetAttr("timeout_seconds",
                       &col_params_.instance.impl_details.timeout_seconds));
+    if (c->HasAttr("wire_dtype")) {
+      DataType wire_dtype;
+      OP_REQUIRES_OK(c, c->GetAttr("wire_dtype", &wire_dtype));
+      if (wire_dtype != DT_FLOAT) {
+        col_params_.instance.impl_details.wire_dtype = wire_dtype;
+      }
+    }
     VLOG(2) << "CollectiveReduce instance " << col_params_.instance.instance_key
             << " merge_op " << merge_op_name << " final_op " << final_op_name
             << " communication_hint "
@@ -991,7 +991,8 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
   cudnn_use_autotune = true;
 #endif
   if (cudnn_use_autotune &&
-      !AutoTuneConv::GetInstance()->Find(conv_parameters, &algorithm_config)) {
+      !AutoTuneConv::GetInstance()->Find(conv_parameters, stream->parent(),
+                                         &algorithm_config)) {
 #if GOOGLE_CUDA
     std::vector<AlgorithmDesc> algorithms;
     OP_REQUIRES(
@@ -1113,7 +1114,8 @@ void LaunchConv2DOp<GPUDevice, T>::operator()(
                            output_tensor, input_desc, filter_desc, output_desc,
                            conv_desc, stream->parent(), results);
     OP_REQUIRES_OK(ctx, BestCudnnConvAlgorithm(results, &algorithm_config));
-    AutoTuneConv::GetInstance()->Insert(conv_parameters, algorithm_config);
+    AutoTuneConv::GetInstance()->Insert(conv_parameters, stream->parent(),
+                                        algorithm_config);
   }
 
   VLOG(4) << "Convolution Algorithm: "
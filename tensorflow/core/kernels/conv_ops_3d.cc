@@ -369,8 +369,9 @@ struct LaunchConvOp<GPUDevice, T, OpKernelContext> {
 #endif
     AlgorithmConfig algorithm_config;
 
-    if (cudnn_use_autotune && !AutoTuneConv3d::GetInstance()->Find(
-                                  conv_parameters, &algorithm_config)) {
+    if (cudnn_use_autotune &&
+        !AutoTuneConv3d::GetInstance()->Find(conv_parameters, stream->parent(),
+                                             &algorithm_config)) {
 #if GOOGLE_CUDA
       se::TfAllocatorAdapter tf_allocator_adapter(
           ctx->device()->GetAllocator({}), stream);
@@ -489,7 +490,8 @@ struct LaunchConvOp<GPUDevice, T, OpKernelContext> {
                              filter_ptr, output_ptr, input_desc, filter_desc,
                              output_desc, conv_desc, stream->parent(), results);
       OP_REQUIRES_OK(ctx, BestCudnnConvAlgorithm(results, &algorithm_config));
-      AutoTuneConv3d::GetInstance()->Insert(conv_parameters, algorithm_config);
+      AutoTuneConv3d::GetInstance()->Insert(conv_parameters, stream->parent(),
+                                            algorithm_config);
     }
 
     DnnScratchAllocator scratch_allocator(ConvolveScratchSize, ctx);
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/csv_utils.h"
+
+#include <cstring>
+
+namespace tensorflow {
+namespace csv_utils {
+namespace {
+
+constexpr uint64 kLowBits = 0x0101010101010101ULL;
+constexpr uint64 kHighBits = 0x8080808080808080ULL;
+
+// Returns a word whose bytes all equal `c`.
+inline uint64 Broadcast(char c) {
+  return kLowBits * static_cast<uint64>(static_cast<unsigned char>(c));
+}
+
+// Returns a non-zero value iff some byte of `word` is zero.
+inline uint64 HasZeroByte(uint64 word) {
+  return (word - kLowBits) & ~word & kHighBits;
+}
+
+}  // namespace
+
+FieldScanner::FieldScanner(char delim, bool use_quote_delim)
+    : delim_(delim), use_quote_delim_(use_quote_delim) {}
+
+uint64 FieldScanner::MatchWord(uint64 word) const {
+  uint64 match = HasZeroByte(word ^ Broadcast(delim_)) |
+                 HasZeroByte(word ^ Broadcast('\n')) |
+                 HasZeroByte(word ^ Broadcast('\r'));
+  if (use_quote_delim_) match |= HasZeroByte(word ^ Broadcast('"'));
+  return match;
+}
+
+size_t FieldScanner::FindSpecial(const char* data, size_t pos,
+                                 size_t size) const {
+  while (pos + sizeof(uint64) <= size) {
+    uint64 word;
+    std::memcpy(&word, data + pos, sizeof(word));
+    // Whether a word matches is exact, but which byte matched depends on the
+    // byte order, so the matching word is searched byte by byte below.
+    if (MatchWord(word) != 0) break;
+    pos += sizeof(uint64);
+  }
+  while (pos < size && !IsSpecial(data[pos])) ++pos;
+  return pos;
+}
+
+size_t FindQuote(const char* data, size_t pos, size_t size) {
+  if (pos >= size) return size;
+  const void* quote = std::memchr(data + pos, '"', size - pos);
+  return quote == nullptr ? size
+                          : static_cast<const char*>(quote) - data;
+}
+
+}  // namespace csv_utils
+}  // namespace tensorflow
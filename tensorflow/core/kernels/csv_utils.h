@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Helpers for the kernels that parse CSV records.
+#ifndef TENSORFLOW_CORE_KERNELS_CSV_UTILS_H_
+#define TENSORFLOW_CORE_KERNELS_CSV_UTILS_H_
+
+#include <cstddef>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace csv_utils {
+
+// Finds the bytes that end an unquoted CSV field: the field delimiter, '\r'
+// and '\n', and also '"' when quotes delimit fields.
+//
+// Fields are usually much longer than one byte, so instead of comparing every
+// byte with every special character, the scanner tests eight bytes at a time
+// with word-sized arithmetic and only looks at single bytes in the word that
+// holds a match.
+class FieldScanner {
+ public:
+  FieldScanner(char delim, bool use_quote_delim);
+
+  // Returns the index of the first special byte in `data[pos, size)`, or
+  // `size` if there is none.
+  size_t FindSpecial(const char* data, size_t pos, size_t size) const;
+
+  // Returns true if `c` is one of the special bytes.
+  bool IsSpecial(char c) const {
+    return c == delim_ || c == '\n' || c == '\r' ||
+           (use_quote_delim_ && c == '"');
+  }
+
+ private:
+  // Returns a word with the high bit of every byte of `word` that equals a
+  // special byte set. Bytes above the first match may be reported spuriously.
+  uint64 MatchWord(uint64 word) const;
+
+  const char delim_;
+  const bool use_quote_delim_;
+};
+
+// Returns the index of the first '"' in `data[pos, size)`, or `size` if there
+// is none.
+size_t FindQuote(const char* data, size_t pos, size_t size);
+
+}  // namespace csv_utils
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CSV_UTILS_H_
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/csv_utils.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace csv_utils {
+namespace {
+
+// Returns the index of the first special byte by looking at every byte.
+size_t FindSpecialSlowly(const FieldScanner& scanner, const std::string& s,
+                         size_t pos) {
+  while (pos < s.size() && !scanner.IsSpecial(s[pos])) ++pos;
+  return pos;
+}
+
+TEST(FieldScannerTest, FindsEverySpecialByte) {
+  const FieldScanner scanner(',', /*use_quote_delim=*/true);
+  const std::string s = "0123456789,abcdefghijklmnop\"qrstuvwxyz\r\n";
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 0, s.size()), 10);
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 11, s.size()), 27);
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 28, s.size()), 38);
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 39, s.size()), 39);
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 40, s.size()), s.size());
+}
+
+TEST(FieldScannerTest, QuotesAreOnlySpecialWhenTheyDelimitFields) {
+  const FieldScanner scanner('|', /*use_quote_delim=*/false);
+  const std::string s = "\"quoted, with commas\"|";
+  EXPECT_FALSE(scanner.IsSpecial('"'));
+  EXPECT_FALSE(scanner.IsSpecial(','));
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 0, s.size()), s.size() - 1);
+}
+
+TEST(FieldScannerTest, MatchesByteByByteSearch) {
+  const FieldScanner scanner('\t', /*use_quote_delim=*/true);
+  // Places one special byte at every offset of strings of every length up
+  // to a few words, so that matches fall at every position in a word and in
+  // the unaligned tail.
+  const char specials[] = {'\t', '\n', '\r', '"'};
+  for (size_t size = 0; size < 40; ++size) {
+    for (size_t at = 0; at < size; ++at) {
+      for (char special : specials) {
+        std::string s(size, 'x');
+        s[at] = special;
+        for (size_t pos = 0; pos <= size; ++pos) {
+          EXPECT_EQ(scanner.FindSpecial(s.data(), pos, s.size()),
+                    FindSpecialSlowly(scanner, s, pos))
+              << "size " << size << " at " << at << " pos " << pos;
+        }
+      }
+    }
+  }
+}
+
+TEST(FieldScannerTest, HighBytesAreNotSpecial) {
+  const FieldScanner scanner(',', /*use_quote_delim=*/true);
+  // Bytes with the high bit set must not be mistaken for special bytes.
+  const std::string s = "\xff\x80\xac\x8a\xa2\x8d\x89\xfe\xff\x80,";
+  EXPECT_EQ(scanner.FindSpecial(s.data(), 0, s.size()), s.size() - 1);
+}
+
+TEST(FindQuoteTest, FindsTheFirstQuote) {
+  const std::string s = "ab\"cd\"";
+  EXPECT_EQ(FindQuote(s.data(), 0, s.size()), 2);
+  EXPECT_EQ(FindQuote(s.data(), 3, s.size()), 5);
+  EXPECT_EQ(FindQuote(s.data(), 6, s.size()), s.size());
+  EXPECT_EQ(FindQuote(s.data(), 0, 2), 2);
+}
+
+}  // namespace
+}  // namespace csv_utils
+}  // namespace tensorflow
@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/cache_dataset_ops.h"
 
+#include <deque>
+
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/cache_ops.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/spilling_cache.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
@@ -36,6 +39,7 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kMemoryBudget;
 
 constexpr char kKeyStrFormat[] = "%%%zuzu_%%%zuzu";
 constexpr char kPaddingSizeStrFormat[] = "%zu";
@@ -56,6 +60,14 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+constexpr char kHybridDatasetPrefix[] = "Hybrid";
+
+// Number of bytes of spilled elements that a reader of a `HybridDataset` reads
+// ahead of its consumer.
+constexpr int64 kReadAheadBytes = 64 << 20;
+
+// Size of the read buffer for spill files.
+constexpr int64 kSpillReadBufferBytes = 4 << 20;
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
@@ -1054,16 +1066,410 @@ class CacheDatasetOp::MemoryDatasetV2
   ResourceMgr* const resource_mgr_;  // Not owned.
 };
 
+// This version of the cache keeps the leading elements of its input in memory
+// for as long as they fit in a memory budget, and spills the remaining
+// elements to a file. Readers serve the in-memory elements while a background
+// thread reads the spilled elements ahead of them. Like `MemoryDataset`, the
+// cache is owned by the dataset: it is shared across iterations of the
+// `repeat` transformation and discarded along with the dataset.
+class CacheDatasetOp::HybridDataset : public DatasetBase {
+ public:
+  HybridDataset(OpKernelContext* ctx, const DatasetBase* input,
+                string filename, int64 memory_budget, int op_version)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        env_(ctx->env()),
+        filename_(filename),
+        memory_budget_(memory_budget),
+        op_version_(op_version),
+        resource_handle_(op_version == 2 ? ctx->input(2) : Tensor()),
+        cache_(std::make_shared<SpillingCache>(ctx->env(), std::move(filename),
+                                               memory_budget)) {
+    input_->Ref();
+  }
+
+  ~HybridDataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    name_utils::IteratorPrefixParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return absl::make_unique<HybridIterator>(
+        HybridIterator::Params{
+            this, name_utils::IteratorPrefix(kDatasetType, prefix, params)},
+        cache_.get());
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.dataset_prefix = kHybridDatasetPrefix;
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64 Cardinality() const override { return input_->Cardinality(); }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+    Node* filename_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    std::vector<Node*> inputs = {input_node, filename_node};
+    if (op_version_ == 2) {
+      Node* resource_handle_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+      inputs.push_back(resource_handle_node);
+    }
+    AttrValue memory_budget_attr;
+    b->BuildAttrValue(memory_budget_, &memory_budget_attr);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, inputs, {{kMemoryBudget, memory_budget_attr}}, output));
+    return Status::OK();
+  }
+
+ private:
+  class HybridIterator : public DatasetIterator<HybridDataset> {
+   public:
+    explicit HybridIterator(const Params& params, SpillingCache* cache)
+        : DatasetIterator<HybridDataset>(params), cache_(cache) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      if (cache_->IsCompleted()) {
+        iterator_ = absl::make_unique<HybridReaderIterator>(
+            HybridReaderIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)},
+            cache_);
+      } else {
+        iterator_ = absl::make_unique<HybridWriterIterator>(
+            HybridWriterIterator::Params{dataset(),
+                                         strings::StrCat(prefix(), kImpl)},
+            cache_);
+      }
+      TF_RETURN_IF_ERROR(iterator_->InitializeBase(ctx, this));
+      return iterator_->Initialize(ctx);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      return iterator_->GetNext(ctx, out_tensors, end_of_sequence);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    // The spilled elements live in a file that is deleted with the dataset,
+    // so they cannot be part of a checkpoint.
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented(
+          "Checkpointing is not supported for caches with a memory budget.");
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented(
+          "Checkpointing is not supported for caches with a memory budget.");
+    }
+
+   private:
+    class HybridWriterIterator : public DatasetIterator<HybridDataset> {
+     public:
+      explicit HybridWriterIterator(const Params& params, SpillingCache* cache)
+          : DatasetIterator<HybridDataset>(params), cache_(cache) {}
+
+      ~HybridWriterIterator() override {
+        mutex_lock l(mu_);
+        if (completed_) return;
+        if (!memory_elements_.empty() || num_spilled_ > 0) {
+          LOG(WARNING)
+              << "The calling iterator did not fully read the dataset being "
+                 "cached. In order to avoid unexpected truncation of the "
+                 "dataset, the partially cached contents of the dataset "
+                 "will be discarded. This can happen if you have an input "
+                 "pipeline similar to `dataset.cache().take(k).repeat()`. "
+                 "You should use `dataset.take(k).cache().repeat()` instead.";
+        }
+        if (spill_writer_) {
+          spill_writer_->Close().IgnoreError();
+          Status s = dataset()->env_->DeleteFile(spill_filename_);
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to delete spill file " << spill_filename_
+                         << ": " << s;
+          }
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        return dataset()->input_->MakeIterator(ctx, this, prefix(),
+                                               &input_impl_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, out_tensors, end_of_sequence));
+        if (*end_of_sequence) {
+          VLOG(2) << "Finalizing the cache because EOF has been reached.";
+          return Complete();
+        }
+        const int64 bytes = GetTotalBytes(*out_tensors);
+        if (!spill_writer_ &&
+            memory_bytes_ + bytes <= dataset()->memory_budget_) {
+          RecordBufferEnqueue(ctx, *out_tensors);
+          memory_elements_.emplace_back(*out_tensors);
+          memory_bytes_ += bytes;
+        } else {
+          if (!spill_writer_) {
+            spill_filename_ = cache_->NewSpillFilename();
+            VLOG(2) << "Spilling the cache to " << spill_filename_ << " after "
+                    << memory_elements_.size() << " elements.";
+            TF_RETURN_IF_ERROR(SpillFileWriter::Create(
+                ctx->env(), spill_filename_, &spill_writer_));
+          }
+          TF_RETURN_IF_ERROR(spill_writer_->Append(*out_tensors));
+          ++num_spilled_;
+        }
+        if (memory_elements_.size() + num_spilled_ ==
+            dataset()->input_->Cardinality()) {
+          VLOG(2) << "Finalizing the cache because its size matches the "
+                     "expected input cardinality.";
+          return Complete();
+        }
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented("SaveInternal is not supported");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented("RestoreInternal is not supported");
+      }
+
+     private:
+      Status Complete() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (completed_) return Status::OK();
+        if (spill_writer_) {
+          TF_RETURN_IF_ERROR(spill_writer_->Close());
+          spill_writer_.reset();
+        }
+        // The cache takes over the spill file.
+        cache_->Complete(std::move(memory_elements_), spill_filename_,
+                         num_spilled_);
+        completed_ = true;
+        return Status::OK();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      SpillingCache* const cache_ TF_GUARDED_BY(mu_);  // not owned.
+      std::vector<std::vector<Tensor>> memory_elements_ TF_GUARDED_BY(mu_);
+      int64 memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<SpillFileWriter> spill_writer_ TF_GUARDED_BY(mu_);
+      string spill_filename_ TF_GUARDED_BY(mu_);
+      int64 num_spilled_ TF_GUARDED_BY(mu_) = 0;
+      bool completed_ TF_GUARDED_BY(mu_) = false;
+    };  // HybridWriterIterator
+
+    class HybridReaderIterator : public DatasetIterator<HybridDataset> {
+     public:
+      explicit HybridReaderIterator(const Params& params, SpillingCache* cache)
+          : DatasetIterator<HybridDataset>(params), cache_(cache) {}
+
+      ~HybridReaderIterator() override {
+        {
+          mutex_lock l(mu_);
+          cancelled_ = true;
+          cond_var_.notify_all();
+        }
+        // Joins the read-ahead thread.
+        read_ahead_thread_.reset();
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        // See `MemoryReaderIterator::Initialize` for the caveats of recording
+        // the memory of the cache here.
+        tf_shared_lock l(mu_);
+        for (size_t i = 0; i < cache_->memory_size(); ++i) {
+          RecordBufferEnqueue(ctx, cache_->at(i));
+        }
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        // The spilled elements are read while the in-memory ones are served.
+        if (cache_->num_spilled() > 0) {
+          EnsureReadAheadThreadStarted(ctx);
+        }
+        if (index_ < cache_->memory_size()) {
+          const std::vector<Tensor>& cache_tensors = cache_->at(index_);
+          out_tensors->insert(out_tensors->begin(), cache_tensors.begin(),
+                              cache_tensors.end());
+          index_++;
+          *end_of_sequence = false;
+          return Status::OK();
+        }
+        while (cache_->num_spilled() > 0 && buffer_.empty() &&
+               !read_ahead_finished_) {
+          cond_var_.wait(l);
+        }
+        if (buffer_.empty()) {
+          *end_of_sequence = true;
+          return read_ahead_status_;
+        }
+        *out_tensors = std::move(buffer_.front());
+        buffer_.pop_front();
+        buffered_bytes_ -= GetTotalBytes(*out_tensors);
+        RecordBufferDequeue(ctx, *out_tensors);
+        cond_var_.notify_all();
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeKnownRatioNode(std::move(args),
+                                         /*ratio=*/1);
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented("SaveInternal is not supported");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented("RestoreInternal is not supported");
+      }
+
+     private:
+      void EnsureReadAheadThreadStarted(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!read_ahead_thread_) {
+          std::shared_ptr<IteratorContext> new_ctx =
+              std::make_shared<IteratorContext>(*ctx);
+          read_ahead_thread_ = ctx->StartThread(
+              "tf_data_cache_read_ahead",
+              [this, new_ctx]() { ReadAheadThread(new_ctx); });
+        }
+      }
+
+      // Reads the spilled elements into `buffer_`, staying at most
+      // `kReadAheadBytes` ahead of the consumer.
+      void ReadAheadThread(const std::shared_ptr<IteratorContext>& ctx) {
+        std::unique_ptr<SpillFileReader> reader;
+        Status s =
+            SpillFileReader::Create(ctx->env(), cache_->spill_filename(),
+                                    kSpillReadBufferBytes, &reader);
+        while (s.ok()) {
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && buffered_bytes_ >= kReadAheadBytes) {
+              cond_var_.wait(l);
+            }
+            if (cancelled_) return;
+          }
+          std::vector<Tensor> element;
+          bool end_of_sequence;
+          s = reader->ReadNext(&element, &end_of_sequence);
+          if (!s.ok() || end_of_sequence) break;
+          mutex_lock l(mu_);
+          RecordBufferEnqueue(ctx.get(), element);
+          buffered_bytes_ += GetTotalBytes(element);
+          buffer_.push_back(std::move(element));
+          cond_var_.notify_all();
+        }
+        mutex_lock l(mu_);
+        read_ahead_status_ = s;
+        read_ahead_finished_ = true;
+        cond_var_.notify_all();
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      SpillingCache* const cache_;  // not owned.
+      size_t index_ TF_GUARDED_BY(mu_) = 0;
+      std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+      int64 buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+      Status read_ahead_status_ TF_GUARDED_BY(mu_);
+      bool read_ahead_finished_ TF_GUARDED_BY(mu_) = false;
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
+      std::unique_ptr<Thread> read_ahead_thread_ TF_GUARDED_BY(mu_);
+    };  // HybridReaderIterator
+
+    mutex mu_;
+    SpillingCache* cache_ TF_GUARDED_BY(mu_);  // not owned.
+    std::unique_ptr<IteratorBase> iterator_ TF_GUARDED_BY(mu_);
+  };  // HybridIterator
+
+  const DatasetBase* const input_;
+  Env* const env_;
+  const tstring filename_;
+  const int64 memory_budget_;
+  const int op_version_;
+  const Tensor resource_handle_;
+  const std::shared_ptr<SpillingCache> cache_;
+};  // HybridDataset
+
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kMemoryBudget, &memory_budget_));
+  OP_REQUIRES(ctx, memory_budget_ >= 0,
+              errors::InvalidArgument("`memory_budget` must be non-negative, "
+                                      "got ",
+                                      memory_budget_, "."));
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
   // Parse out the filenames tensor.
   tstring filename;
   OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kFileName, &filename));
-  if (filename.empty()) {
+  if (memory_budget_ > 0) {
+    OP_REQUIRES(
+        ctx, !filename.empty(),
+        errors::InvalidArgument("A cache with a memory budget needs a filename "
+                                "to spill the remaining elements to."));
+    *output = new HybridDataset(ctx, input, filename, memory_budget_,
+                                op_version_);
+  } else if (filename.empty()) {
     static std::atomic<int64> resource_id_counter(0);
     const string& container = ctx->resource_manager()->default_container();
     auto name = strings::StrCat(ctx->op_kernel().name(), "/", kMemoryCache, "_",
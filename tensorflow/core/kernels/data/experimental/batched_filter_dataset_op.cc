@@ -0,0 +1,323 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/captured_function.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kInputImplEmpty[] = "input_impl_empty";
+constexpr char kBufferSize[] = "buffer_size";
+constexpr char kBuffer[] = "buffer";
+
+// A filter whose predicate is evaluated on batches of elements. A function
+// call has a fixed cost, so a predicate that vectorizes over the batch, such
+// as a comparison of a feature with a threshold, is much cheaper to evaluate
+// on `batch_size` elements at once than on every element in turn. Only the
+// elements that match are produced, so the transformations that follow do not
+// run on the dropped ones.
+class BatchedFilterDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit BatchedFilterDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, FunctionMetadata::Create(
+                            ctx, "predicate", /*params=*/{}, &func_metadata_));
+    OP_REQUIRES(ctx, func_metadata_->short_circuit_info().indices.size() <= 1,
+                errors::InvalidArgument(
+                    "predicate function has more than one return value."));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(
+        ctx, batch_size > 0,
+        errors::InvalidArgument("batch_size must be greater than zero."));
+
+    std::unique_ptr<CapturedFunction> captured_func;
+    OP_REQUIRES_OK(
+        ctx, CapturedFunction::Create(ctx, func_metadata_, "other_arguments",
+                                      &captured_func));
+    *output = new Dataset(ctx, input, batch_size, std::move(captured_func));
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 batch_size,
+            std::unique_ptr<CapturedFunction> captured_func)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          batch_size_(batch_size),
+          captured_func_(std::move(captured_func)) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::BatchedFilter")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "BatchedFilterDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override {
+      TF_RETURN_IF_ERROR(captured_func_->CheckExternalState());
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_node;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
+      Node* batch_size_node;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size_node));
+
+      std::vector<Node*> other_arguments;
+      DataTypeVector other_arguments_types;
+      TF_RETURN_IF_ERROR(captured_func_->AddToGraph(ctx, b, &other_arguments,
+                                                    &other_arguments_types));
+      AttrValue f_attr;
+      b->BuildAttrValue(captured_func_->func(), &f_attr);
+
+      AttrValue other_arguments_types_attr;
+      b->BuildAttrValue(other_arguments_types, &other_arguments_types_attr);
+
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this,
+          {std::make_pair(0, input_node), std::make_pair(1, batch_size_node)},
+          {std::make_pair(2, other_arguments)},
+          {std::make_pair("predicate", f_attr),
+           std::make_pair("Targuments", other_arguments_types_attr)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        return dataset()->captured_func_->Instantiate(
+            ctx, &instantiated_captured_func_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        // A batch may match no element at all, so keep filtering batches
+        // until an element matches or the input is exhausted.
+        while (buffer_.empty()) {
+          if (!input_impl_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          TF_RETURN_IF_ERROR(FilterNextBatch(ctx));
+        }
+        *out_tensors = std::move(buffer_.front());
+        buffer_.pop_front();
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeUnknownRatioNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        TF_RETURN_IF_ERROR(ctx->HandleCheckExternalStateStatus(
+            dataset()->captured_func_->CheckExternalState()));
+        mutex_lock l(mu_);
+        if (input_impl_) {
+          TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+        } else {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name(kInputImplEmpty), ""));
+        }
+        // The elements of the last batch that matched but were not produced
+        // yet.
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kBufferSize), buffer_.size()));
+        for (size_t i = 0; i < buffer_.size(); ++i) {
+          for (size_t j = 0; j < buffer_[i].size(); ++j) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                full_name(strings::StrCat(kBuffer, "[", i, "][", j, "]")),
+                buffer_[i][j]));
+          }
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        if (reader->Contains(full_name(kInputImplEmpty))) {
+          input_impl_.reset();
+        } else {
+          TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+        }
+        buffer_.clear();
+        int64 buffer_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kBufferSize), &buffer_size));
+        const size_t num_components = dataset()->output_dtypes().size();
+        for (int64 i = 0; i < buffer_size; ++i) {
+          buffer_.emplace_back(num_components);
+          for (size_t j = 0; j < num_components; ++j) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                full_name(strings::StrCat(kBuffer, "[", i, "][", j, "]")),
+                &buffer_.back()[j]));
+          }
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Reads up to `batch_size` elements from the input, evaluates the
+      // predicate on all of them at once, and appends the elements that
+      // match to `buffer_`.
+      Status FilterNextBatch(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        std::vector<std::vector<Tensor>> batch_elements;
+        batch_elements.reserve(dataset()->batch_size_);
+        for (int64 i = 0; i < dataset()->batch_size_; ++i) {
+          std::vector<Tensor> element;
+          bool end_of_input;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            break;
+          }
+          batch_elements.push_back(std::move(element));
+        }
+        if (batch_elements.empty()) return Status::OK();
+
+        std::vector<Tensor> batch;
+        TF_RETURN_IF_ERROR(Stack(ctx, batch_elements, &batch));
+        std::vector<Tensor> result;
+        TF_RETURN_IF_ERROR(
+            instantiated_captured_func_->Run(ctx, std::move(batch), &result));
+        const int64 num_batch_elements = batch_elements.size();
+        if (result.size() != 1 || result[0].dtype() != DT_BOOL ||
+            result[0].dims() != 1 ||
+            result[0].dim_size(0) != num_batch_elements) {
+          return errors::InvalidArgument(
+              "`predicate` must return a bool vector with one value per "
+              "element of the batch.");
+        }
+        auto matched = result[0].vec<bool>();
+        for (int64 i = 0; i < num_batch_elements; ++i) {
+          if (matched(i)) buffer_.push_back(std::move(batch_elements[i]));
+        }
+        return Status::OK();
+      }
+
+      // Stacks every component of `batch_elements` along a new leading
+      // dimension. The elements are kept, so that the ones that match can be
+      // produced without slicing the batch.
+      Status Stack(IteratorContext* ctx,
+                   const std::vector<std::vector<Tensor>>& batch_elements,
+                   std::vector<Tensor>* batch) {
+        const int64 num_batch_elements = batch_elements.size();
+        const size_t num_components = batch_elements[0].size();
+        batch->reserve(num_components);
+        for (size_t component_index = 0; component_index < num_components;
+             ++component_index) {
+          const Tensor& first_element = batch_elements[0][component_index];
+          TensorShape batch_component_shape({num_batch_elements});
+          batch_component_shape.AppendShape(first_element.shape());
+          batch->emplace_back(ctx->allocator({}), first_element.dtype(),
+                              batch_component_shape);
+          if (!batch->back().IsInitialized()) {
+            return errors::ResourceExhausted(
+                "Failed to allocate memory for the batch of component ",
+                component_index);
+          }
+          for (int64 i = 0; i < num_batch_elements; ++i) {
+            const Tensor& element = batch_elements[i][component_index];
+            if (element.shape() != first_element.shape()) {
+              return errors::InvalidArgument(
+                  "Cannot batch tensors with different shapes in component ",
+                  component_index, ". First element had shape ",
+                  first_element.shape().DebugString(), " and element ", i,
+                  " had shape ", element.shape().DebugString(), ".");
+            }
+            TF_RETURN_IF_ERROR(
+                batch_util::CopyElementToSlice(element, &batch->back(), i));
+          }
+        }
+        return Status::OK();
+      }
+
+      mutex mu_;
+      std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+      std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+      std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
+    };
+
+    const DatasetBase* const input_;
+    const int64 batch_size_;
+    const std::unique_ptr<CapturedFunction> captured_func_;
+  };
+
+  std::shared_ptr<FunctionMetadata> func_metadata_ = nullptr;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BatchedFilterDataset").Device(DEVICE_CPU),
+                        BatchedFilterDatasetOp);
+
+REGISTER_INPUT_COLOCATION_EXEMPTION("BatchedFilterDataset");
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,463 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_dataset_op.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in columnar_dataset_op.h and used both here and in test
+// cases.
+/* static */ constexpr const char* const ColumnarDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ColumnarDatasetOp::kFileNames;
+/* static */ constexpr const char* const ColumnarDatasetOp::kColumns;
+/* static */ constexpr const char* const ColumnarDatasetOp::kPredicateColumn;
+/* static */ constexpr const char* const ColumnarDatasetOp::kPredicateMin;
+/* static */ constexpr const char* const ColumnarDatasetOp::kPredicateMax;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const ColumnarDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kCurrentFileIndex[] = "current_file_index";
+constexpr char kChunkIndex[] = "chunk_index";
+constexpr char kRowIndex[] = "row_index";
+
+}  // namespace
+
+class ColumnarDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+          std::vector<int64> columns, int64 predicate_column,
+          double predicate_min, double predicate_max,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        filenames_(std::move(filenames)),
+        columns_(std::move(columns)),
+        predicate_column_(predicate_column),
+        predicate_min_(predicate_min),
+        predicate_max_(predicate_max),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status RandomAccessNumElements(IteratorContext* ctx,
+                                 int64* num_elements) const override {
+    mutex_lock l(random_access_mu_);
+    TF_RETURN_IF_ERROR(InitializeRandomAccess(ctx->env()));
+    *num_elements = file_end_rows_.empty() ? 0 : file_end_rows_.back();
+    return Status::OK();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    const ColumnarFileReader* reader;
+    int64 row;
+    {
+      mutex_lock l(random_access_mu_);
+      TF_RETURN_IF_ERROR(InitializeRandomAccess(ctx->env()));
+      const int64 num_elements =
+          file_end_rows_.empty() ? 0 : file_end_rows_.back();
+      if (index < 0 || index >= num_elements) {
+        return errors::OutOfRange("Index out of range [0, ", num_elements,
+                                  "): ", index);
+      }
+      const size_t file_index =
+          std::upper_bound(file_end_rows_.begin(), file_end_rows_.end(),
+                           index) -
+          file_end_rows_.begin();
+      row = index - (file_index == 0 ? 0 : file_end_rows_[file_index - 1]);
+      reader = readers_[file_index].get();
+    }
+
+    // The readers are not modified once opened, and reading them is
+    // thread-safe. Reading a single row of a file that is not memory-mapped
+    // reads the whole column chunk holding it.
+    int64 chunk = 0;
+    while (row >= reader->num_rows(chunk)) {
+      row -= reader->num_rows(chunk);
+      ++chunk;
+    }
+    out_tensors->clear();
+    out_tensors->reserve(columns_.size());
+    ColumnChunk column_chunk;
+    for (const int64 column : columns_) {
+      TF_RETURN_IF_ERROR(reader->ReadColumnChunk(chunk, column, &column_chunk));
+      out_tensors->emplace_back();
+      TF_RETURN_IF_ERROR(column_chunk.GetValue(row, &out_tensors->back()));
+    }
+    return Status::OK();
+  }
+
+  Status CheckExternalState() const override { return Status::OK(); }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* filenames = nullptr;
+    Node* columns = nullptr;
+    Node* predicate_column = nullptr;
+    Node* predicate_min = nullptr;
+    Node* predicate_max = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+    TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+    TF_RETURN_IF_ERROR(b->AddScalar(predicate_column_, &predicate_column));
+    TF_RETURN_IF_ERROR(b->AddScalar(predicate_min_, &predicate_min));
+    TF_RETURN_IF_ERROR(b->AddScalar(predicate_max_, &predicate_max));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {filenames, columns, predicate_column, predicate_min, predicate_max},
+        output));
+    return Status::OK();
+  }
+
+ private:
+  // Opens every file, the first time the dataset is accessed by index.
+  Status InitializeRandomAccess(Env* env) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(random_access_mu_) {
+    if (random_access_initialized_) {
+      return Status::OK();
+    }
+    if (predicate_column_ >= 0) {
+      return errors::Unimplemented(
+          "Columnar datasets with a predicate do not support random access.");
+    }
+    std::vector<std::unique_ptr<ColumnarFileReader>> readers;
+    std::vector<int64> file_end_rows;
+    readers.reserve(filenames_.size());
+    file_end_rows.reserve(filenames_.size());
+    int64 num_rows = 0;
+    for (const string& filename : filenames_) {
+      readers.emplace_back();
+      TF_RETURN_IF_ERROR(
+          ColumnarFileReader::Open(env, filename, &readers.back()));
+      TF_RETURN_IF_ERROR(CheckFile(filename, *readers.back()));
+      for (int64 chunk = 0; chunk < readers.back()->num_chunks(); ++chunk) {
+        num_rows += readers.back()->num_rows(chunk);
+      }
+      file_end_rows.push_back(num_rows);
+    }
+    readers_ = std::move(readers);
+    file_end_rows_ = std::move(file_end_rows);
+    random_access_initialized_ = true;
+    return Status::OK();
+  }
+
+  // Checks that the columns of `reader`, which reads `filename`, match the
+  // dataset.
+  Status CheckFile(const string& filename,
+                   const ColumnarFileReader& reader) const {
+    const int64 num_columns = reader.dtypes().size();
+    for (int64 i = 0; i < columns_.size(); ++i) {
+      const int64 column = columns_[i];
+      if (column >= num_columns) {
+        return errors::InvalidArgument("Column ", column,
+                                       " is out of range, since ", filename,
+                                       " has ", num_columns, " columns.");
+      }
+      if (reader.dtypes()[column] != output_types_[i] ||
+          !output_shapes_[i].IsCompatibleWith(reader.shapes()[column])) {
+        return errors::InvalidArgument(
+            "Column ", column, " of ", filename, " holds ",
+            DataTypeString(reader.dtypes()[column]), " tensors of shape ",
+            reader.shapes()[column].DebugString(), ", but the dataset ",
+            "expects ", DataTypeString(output_types_[i]), " tensors of shape ",
+            output_shapes_[i].DebugString(), ".");
+      }
+    }
+    if (predicate_column_ >= 0 &&
+        (predicate_column_ >= num_columns ||
+         !ColumnarTypeHasStatistics(reader.dtypes()[predicate_column_]) ||
+         reader.shapes()[predicate_column_].dims() != 0)) {
+      return errors::InvalidArgument(
+          "The predicate column ", predicate_column_, " of ", filename,
+          " must exist and hold numeric scalars.");
+    }
+    return Status::OK();
+  }
+
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          column_chunks_(params.dataset->columns_.size()) {}
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      do {
+        if (reader_) {
+          if (!chunk_loaded_) {
+            TF_RETURN_IF_ERROR(LoadChunk());
+          }
+          while (chunk_loaded_ &&
+                 row_index_ < reader_->num_rows(chunk_index_)) {
+            const int64 row = row_index_++;
+            if (!RowMatches(row)) {
+              continue;
+            }
+            out_tensors->clear();
+            out_tensors->reserve(column_chunks_.size());
+            for (const ColumnChunk& column_chunk : column_chunks_) {
+              out_tensors->emplace_back();
+              TF_RETURN_IF_ERROR(
+                  column_chunk.GetValue(row, &out_tensors->back()));
+            }
+            *end_of_sequence = false;
+            return Status::OK();
+          }
+          if (chunk_loaded_) {
+            chunk_loaded_ = false;
+            ++chunk_index_;
+            row_index_ = 0;
+            continue;
+          }
+          // We have reached the end of the current file, so move on to the
+          // next one.
+          reader_.reset();
+          ++current_file_index_;
+        }
+
+        if (current_file_index_ == dataset()->filenames_.size()) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+        TF_RETURN_IF_ERROR(SetupReader(ctx->env()));
+      } while (true);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
+                                             current_file_index_));
+      // `reader_` is empty if `GetNext` has not been called yet, or if all
+      // files have been read.
+      const int64 chunk_index = reader_ ? chunk_index_ : -1;
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kChunkIndex), chunk_index));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kRowIndex), row_index_));
+      return Status::OK();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64 current_file_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kCurrentFileIndex),
+                                            &current_file_index));
+      current_file_index_ = size_t(current_file_index);
+      int64 chunk_index;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kChunkIndex), &chunk_index));
+      int64 row_index;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRowIndex), &row_index));
+      reader_.reset();
+      chunk_loaded_ = false;
+      if (chunk_index >= 0) {  // There was an active reader.
+        TF_RETURN_IF_ERROR(SetupReader(ctx->env()));
+        chunk_index_ = chunk_index;
+        row_index_ = row_index;
+        // The chunk being read when the iterator was saved matched the
+        // predicate, so `LoadChunk()` reads it again without touching
+        // `row_index_`.
+        TF_RETURN_IF_ERROR(LoadChunk());
+      }
+      return Status::OK();
+    }
+
+   private:
+    // Opens the current file and checks that its columns match the dataset.
+    Status SetupReader(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (current_file_index_ >= dataset()->filenames_.size()) {
+        return errors::InvalidArgument(
+            "current_file_index_:", current_file_index_,
+            " >= filenames_.size():", dataset()->filenames_.size());
+      }
+      const string& filename = dataset()->filenames_[current_file_index_];
+      TF_RETURN_IF_ERROR(ColumnarFileReader::Open(env, filename, &reader_));
+      TF_RETURN_IF_ERROR(dataset()->CheckFile(filename, *reader_));
+      chunk_index_ = 0;
+      row_index_ = 0;
+      chunk_loaded_ = false;
+      return Status::OK();
+    }
+
+    // Skips the chunks whose statistics rule out rows that match the
+    // predicate, and reads the projected columns of the next chunk, if any.
+    Status LoadChunk() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 predicate_column = dataset()->predicate_column_;
+      if (predicate_column >= 0) {
+        while (chunk_index_ < reader_->num_chunks() &&
+               !reader_->ChunkMayMatch(chunk_index_, predicate_column,
+                                       dataset()->predicate_min_,
+                                       dataset()->predicate_max_)) {
+          ++chunk_index_;
+          row_index_ = 0;
+        }
+      }
+      if (chunk_index_ >= reader_->num_chunks()) {
+        return Status::OK();
+      }
+      for (int64 i = 0; i < dataset()->columns_.size(); ++i) {
+        TF_RETURN_IF_ERROR(reader_->ReadColumnChunk(
+            chunk_index_, dataset()->columns_[i], &column_chunks_[i]));
+      }
+      if (predicate_column >= 0) {
+        TF_RETURN_IF_ERROR(reader_->ReadColumnChunk(
+            chunk_index_, predicate_column, &predicate_chunk_));
+      }
+      chunk_loaded_ = true;
+      return Status::OK();
+    }
+
+    // Returns whether `row` of the loaded chunk matches the predicate. The
+    // chunk statistics only rule out whole chunks, so every row of a chunk
+    // that may match is checked.
+    bool RowMatches(int64 row) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->predicate_column_ < 0) {
+        return true;
+      }
+      const double value = predicate_chunk_.GetScalarAsDouble(row);
+      return value >= dataset()->predicate_min_ &&
+             value <= dataset()->predicate_max_;
+    }
+
+    mutex mu_;
+    size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<ColumnarFileReader> reader_ TF_GUARDED_BY(mu_);
+    int64 chunk_index_ TF_GUARDED_BY(mu_) = 0;
+    int64 row_index_ TF_GUARDED_BY(mu_) = 0;
+    bool chunk_loaded_ TF_GUARDED_BY(mu_) = false;
+    std::vector<ColumnChunk> column_chunks_ TF_GUARDED_BY(mu_);
+    ColumnChunk predicate_chunk_ TF_GUARDED_BY(mu_);
+  };
+
+  const std::vector<string> filenames_;
+  const std::vector<int64> columns_;
+  const int64 predicate_column_;
+  const double predicate_min_;
+  const double predicate_max_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+
+  // State for `Get()`.
+  mutable mutex random_access_mu_;
+  mutable bool random_access_initialized_ TF_GUARDED_BY(random_access_mu_) =
+      false;
+  mutable std::vector<std::unique_ptr<ColumnarFileReader>> readers_
+      TF_GUARDED_BY(random_access_mu_);
+  // The number of rows in the first `i + 1` files.
+  mutable std::vector<int64> file_end_rows_ TF_GUARDED_BY(random_access_mu_);
+};
+
+ColumnarDatasetOp::ColumnarDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ColumnarDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                    DatasetBase** output) {
+  const Tensor* filenames_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kFileNames, &filenames_tensor));
+  OP_REQUIRES(
+      ctx, filenames_tensor->dims() <= 1,
+      errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+  std::vector<string> filenames;
+  filenames.reserve(filenames_tensor->NumElements());
+  for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+    filenames.push_back(filenames_tensor->flat<tstring>()(i));
+  }
+
+  const Tensor* columns_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kColumns, &columns_tensor));
+  OP_REQUIRES(ctx, columns_tensor->dims() == 1,
+              errors::InvalidArgument("`columns` must be a vector."));
+  std::vector<int64> columns;
+  columns.reserve(columns_tensor->NumElements());
+  for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+    const int64 column = columns_tensor->flat<int64>()(i);
+    OP_REQUIRES(ctx, column >= 0,
+                errors::InvalidArgument("`columns` must be non-negative, got ",
+                                        column, "."));
+    columns.push_back(column);
+  }
+  OP_REQUIRES(ctx, columns.size() == output_types_.size(),
+              errors::InvalidArgument(
+                  "Got ", columns.size(), " columns but ",
+                  output_types_.size(), " output types."));
+
+  int64 predicate_column;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kPredicateColumn,
+                                                 &predicate_column));
+  double predicate_min;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<double>(ctx, kPredicateMin, &predicate_min));
+  double predicate_max;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<double>(ctx, kPredicateMax, &predicate_max));
+
+  *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                        predicate_column, predicate_min, predicate_max,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,500 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Size of the trailer: the size of the footer and the magic.
+constexpr int64 kTrailerBytes = sizeof(uint64) + kColumnarMagicBytes;
+
+int64 PaddingBytes(int64 offset) {
+  return (kColumnarAlignment - offset % kColumnarAlignment) %
+         kColumnarAlignment;
+}
+
+void PutDouble(string* dst, double value) {
+  uint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  core::PutFixed64(dst, bits);
+}
+
+double DecodeDouble(const char* src) {
+  const uint64 bits = core::DecodeFixed64(src);
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+#define TF_COLUMNAR_STATISTICS_TYPES(m)                                      \
+  m(int8) m(int16) m(int32) m(int64) m(uint8) m(uint16) m(uint32) m(uint64) \
+      m(float) m(double)
+
+double ValueAsDouble(DataType dtype, const char* data) {
+  switch (dtype) {
+#define HANDLE_TYPE(T)                          \
+  case DataTypeToEnum<T>::value: {              \
+    T value;                                    \
+    std::memcpy(&value, data, sizeof(value));   \
+    return static_cast<double>(value);          \
+  }
+    TF_COLUMNAR_STATISTICS_TYPES(HANDLE_TYPE)
+#undef HANDLE_TYPE
+    default:
+      return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+// Reads a little-endian integer from `*input`, advancing it.
+template <typename T>
+bool ConsumeFixed(StringPiece* input, T* value) {
+  if (input->size() < sizeof(T)) return false;
+  *value = sizeof(T) == sizeof(uint32) ? core::DecodeFixed32(input->data())
+                                       : core::DecodeFixed64(input->data());
+  input->remove_prefix(sizeof(T));
+  return true;
+}
+
+bool ConsumeDouble(StringPiece* input, double* value) {
+  if (input->size() < sizeof(uint64)) return false;
+  *value = DecodeDouble(input->data());
+  input->remove_prefix(sizeof(uint64));
+  return true;
+}
+
+// A tensor buffer which points into a memory-mapped columnar file.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(const char* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : TensorBuffer(const_cast<char*>(data)),
+        size_(size),
+        region_(std::move(region)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("ColumnarFileReader");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  // Keeps the file mapped while the tensor is referenced.
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+}  // namespace
+
+bool ColumnarTypeHasStatistics(DataType dtype) {
+  switch (dtype) {
+#define HANDLE_TYPE(T)           \
+  case DataTypeToEnum<T>::value: \
+    return true;
+    TF_COLUMNAR_STATISTICS_TYPES(HANDLE_TYPE)
+#undef HANDLE_TYPE
+    default:
+      return false;
+  }
+}
+
+ColumnarFileWriter::ColumnarFileWriter(std::unique_ptr<WritableFile> file,
+                                       DataTypeVector dtypes,
+                                       std::vector<TensorShape> shapes,
+                                       int64 rows_per_chunk)
+    : file_(std::move(file)),
+      dtypes_(std::move(dtypes)),
+      shapes_(std::move(shapes)),
+      rows_per_chunk_(rows_per_chunk) {}
+
+Status ColumnarFileWriter::Create(Env* env, const string& filename,
+                                  const DataTypeVector& dtypes,
+                                  const std::vector<TensorShape>& shapes,
+                                  int64 rows_per_chunk,
+                                  std::unique_ptr<ColumnarFileWriter>* out) {
+  if (dtypes.size() != shapes.size()) {
+    return errors::InvalidArgument("Got ", dtypes.size(), " column types but ",
+                                   shapes.size(), " column shapes.");
+  }
+  if (rows_per_chunk <= 0) {
+    return errors::InvalidArgument("`rows_per_chunk` must be positive, got ",
+                                   rows_per_chunk, ".");
+  }
+  for (DataType dtype : dtypes) {
+    if (!DataTypeCanUseMemcpy(dtype) && dtype != DT_STRING) {
+      return errors::InvalidArgument("Columns of type ", DataTypeString(dtype),
+                                     " are not supported.");
+    }
+  }
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  out->reset(new ColumnarFileWriter(std::move(file), dtypes, shapes,
+                                    rows_per_chunk));
+  return (*out)->Write(StringPiece(kColumnarMagic, kColumnarMagicBytes));
+}
+
+Status ColumnarFileWriter::Write(StringPiece data) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  offset_ += data.size();
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::WritePadding() {
+  static const char kZeros[kColumnarAlignment] = {};
+  return Write(StringPiece(kZeros, PaddingBytes(offset_)));
+}
+
+Status ColumnarFileWriter::Append(const std::vector<Tensor>& row) {
+  if (row.size() != dtypes_.size()) {
+    return errors::InvalidArgument("Expected a row with ", dtypes_.size(),
+                                   " columns, got ", row.size(), ".");
+  }
+  for (size_t i = 0; i < row.size(); ++i) {
+    if (row[i].dtype() != dtypes_[i] || row[i].shape() != shapes_[i]) {
+      return errors::InvalidArgument(
+          "Expected a ", DataTypeString(dtypes_[i]), " tensor of shape ",
+          shapes_[i].DebugString(), " in column ", i, ", got a ",
+          DataTypeString(row[i].dtype()), " tensor of shape ",
+          row[i].shape().DebugString(), ".");
+    }
+  }
+  rows_.push_back(row);
+  if (rows_.size() >= rows_per_chunk_) {
+    return FlushChunk();
+  }
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::WriteColumnChunk(int64 column,
+                                            ColumnChunkInfo* info) {
+  TF_RETURN_IF_ERROR(WritePadding());
+  info->offset = offset_;
+  info->min = -std::numeric_limits<double>::infinity();
+  info->max = std::numeric_limits<double>::infinity();
+  const DataType dtype = dtypes_[column];
+  if (DataTypeCanUseMemcpy(dtype)) {
+    for (const std::vector<Tensor>& row : rows_) {
+      TF_RETURN_IF_ERROR(Write(row[column].tensor_data()));
+    }
+    if (ColumnarTypeHasStatistics(dtype) && shapes_[column].dims() == 0) {
+      // NaNs are left out, since no range predicate selects them.
+      info->min = std::numeric_limits<double>::infinity();
+      info->max = -std::numeric_limits<double>::infinity();
+      for (const std::vector<Tensor>& row : rows_) {
+        const double value =
+            ValueAsDouble(dtype, row[column].tensor_data().data());
+        info->min = std::min(info->min, value);
+        info->max = std::max(info->max, value);
+      }
+    }
+  } else {
+    string offsets;
+    uint64 string_offset = 0;
+    core::PutFixed64(&offsets, string_offset);
+    for (const std::vector<Tensor>& row : rows_) {
+      auto values = row[column].flat<tstring>();
+      for (int64 i = 0; i < values.size(); ++i) {
+        string_offset += values(i).size();
+        core::PutFixed64(&offsets, string_offset);
+      }
+    }
+    TF_RETURN_IF_ERROR(Write(offsets));
+    for (const std::vector<Tensor>& row : rows_) {
+      auto values = row[column].flat<tstring>();
+      for (int64 i = 0; i < values.size(); ++i) {
+        TF_RETURN_IF_ERROR(
+            Write(StringPiece(values(i).data(), values(i).size())));
+      }
+    }
+  }
+  info->size = offset_ - info->offset;
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::FlushChunk() {
+  if (rows_.empty()) {
+    return Status::OK();
+  }
+  std::vector<ColumnChunkInfo> columns(dtypes_.size());
+  for (int64 i = 0; i < dtypes_.size(); ++i) {
+    TF_RETURN_IF_ERROR(WriteColumnChunk(i, &columns[i]));
+  }
+  chunk_num_rows_.push_back(rows_.size());
+  chunk_columns_.push_back(std::move(columns));
+  rows_.clear();
+  return Status::OK();
+}
+
+Status ColumnarFileWriter::Close() {
+  TF_RETURN_IF_ERROR(FlushChunk());
+  string footer;
+  core::PutFixed32(&footer, dtypes_.size());
+  for (int64 i = 0; i < dtypes_.size(); ++i) {
+    core::PutFixed32(&footer, dtypes_[i]);
+    core::PutFixed32(&footer, shapes_[i].dims());
+    for (int64 dim : shapes_[i].dim_sizes()) {
+      core::PutFixed64(&footer, dim);
+    }
+  }
+  core::PutFixed64(&footer, chunk_num_rows_.size());
+  for (int64 i = 0; i < chunk_num_rows_.size(); ++i) {
+    core::PutFixed64(&footer, chunk_num_rows_[i]);
+    for (const ColumnChunkInfo& info : chunk_columns_[i]) {
+      core::PutFixed64(&footer, info.offset);
+      core::PutFixed64(&footer, info.size);
+      PutDouble(&footer, info.min);
+      PutDouble(&footer, info.max);
+    }
+  }
+  core::PutFixed64(&footer, footer.size());
+  footer.append(kColumnarMagic, kColumnarMagicBytes);
+  TF_RETURN_IF_ERROR(Write(footer));
+  TF_RETURN_IF_ERROR(file_->Flush());
+  return file_->Close();
+}
+
+Status ColumnChunk::GetValue(int64 row, Tensor* value) const {
+  const StringPiece bytes = data();
+  const int64 num_elements = shape_.num_elements();
+  if (DataTypeCanUseMemcpy(dtype_)) {
+    const int64 value_bytes = num_elements * DataTypeSize(dtype_);
+    const char* src = bytes.data() + row * value_bytes;
+#if EIGEN_MAX_ALIGN_BYTES > 0
+    const bool aligned =
+        reinterpret_cast<intptr_t>(src) % EIGEN_MAX_ALIGN_BYTES == 0;
+#else
+    const bool aligned = true;
+#endif
+    if (!owned_ && aligned && value_bytes > 0) {
+      auto* buffer = new MappedTensorBuffer(src, value_bytes, region_);
+      *value = Tensor(dtype_, shape_, buffer);
+      buffer->Unref();
+      return Status::OK();
+    }
+    *value = Tensor(dtype_, shape_);
+    if (value_bytes > 0) {
+      std::memcpy(const_cast<char*>(value->tensor_data().data()), src,
+                  value_bytes);
+    }
+    return Status::OK();
+  }
+  const int64 num_strings = num_rows_ * num_elements;
+  const char* offsets = bytes.data();
+  const uint64 strings_bytes =
+      bytes.size() - (num_strings + 1) * sizeof(uint64);
+  const char* strings = offsets + (num_strings + 1) * sizeof(uint64);
+  *value = Tensor(DT_STRING, shape_);
+  auto flat = value->flat<tstring>();
+  for (int64 i = 0; i < num_elements; ++i) {
+    const int64 index = row * num_elements + i;
+    const uint64 start = core::DecodeFixed64(offsets + index * sizeof(uint64));
+    const uint64 end =
+        core::DecodeFixed64(offsets + (index + 1) * sizeof(uint64));
+    if (start > end || end > strings_bytes) {
+      return errors::DataLoss("Corrupted string in row ", row,
+                              " of a columnar file chunk.");
+    }
+    flat(i).assign(strings + start, end - start);
+  }
+  return Status::OK();
+}
+
+double ColumnChunk::GetScalarAsDouble(int64 row) const {
+  return ValueAsDouble(dtype_, data().data() + row * DataTypeSize(dtype_));
+}
+
+Status ColumnarFileReader::Open(Env* env, const string& filename,
+                                std::unique_ptr<ColumnarFileReader>* out) {
+  std::unique_ptr<ColumnarFileReader> reader(new ColumnarFileReader());
+  reader->filename_ = filename;
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size < kColumnarMagicBytes + kTrailerBytes) {
+    return errors::DataLoss("Columnar file ", filename, " is too short.");
+  }
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  if (env->NewReadOnlyMemoryRegionFromFile(filename, &region).ok() &&
+      region->length() == file_size) {
+    reader->region_ = std::move(region);
+  } else {
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &reader->file_));
+  }
+  // Reads `n` bytes at `offset` into `*result`, which may point into
+  // `scratch`.
+  auto read = [&reader](uint64 offset, size_t n, StringPiece* result,
+                        string* scratch) -> Status {
+    if (reader->region_) {
+      *result = StringPiece(
+          static_cast<const char*>(reader->region_->data()) + offset, n);
+      return Status::OK();
+    }
+    scratch->resize(n);
+    TF_RETURN_IF_ERROR(reader->file_->Read(offset, n, result, &(*scratch)[0]));
+    if (result->size() != n) {
+      return errors::DataLoss("Unexpected end of columnar file ",
+                              reader->filename_, ".");
+    }
+    return Status::OK();
+  };
+  StringPiece header;
+  string header_scratch;
+  TF_RETURN_IF_ERROR(read(0, kColumnarMagicBytes, &header, &header_scratch));
+  StringPiece trailer;
+  string trailer_scratch;
+  TF_RETURN_IF_ERROR(read(file_size - kTrailerBytes, kTrailerBytes, &trailer,
+                          &trailer_scratch));
+  const StringPiece magic(kColumnarMagic, kColumnarMagicBytes);
+  if (header != magic || trailer.substr(sizeof(uint64)) != magic) {
+    return errors::DataLoss(filename, " is not a columnar file.");
+  }
+  const uint64 footer_size = core::DecodeFixed64(trailer.data());
+  if (footer_size > file_size - kColumnarMagicBytes - kTrailerBytes) {
+    return errors::DataLoss("Corrupted footer in columnar file ", filename,
+                            ".");
+  }
+  StringPiece footer;
+  string footer_scratch;
+  TF_RETURN_IF_ERROR(read(file_size - kTrailerBytes - footer_size,
+                          footer_size, &footer, &footer_scratch));
+  Status s = reader->ParseFooter(footer, file_size - kTrailerBytes -
+                                             footer_size);
+  if (!s.ok()) {
+    return errors::DataLoss("Corrupted footer in columnar file ", filename,
+                            ": ", s.error_message());
+  }
+  *out = std::move(reader);
+  return Status::OK();
+}
+
+Status ColumnarFileReader::ParseFooter(StringPiece footer, uint64 data_end) {
+  uint32 num_columns;
+  if (!ConsumeFixed(&footer, &num_columns)) {
+    return errors::DataLoss("Missing the number of columns.");
+  }
+  for (uint32 i = 0; i < num_columns; ++i) {
+    uint32 dtype, rank;
+    if (!ConsumeFixed(&footer, &dtype) || !ConsumeFixed(&footer, &rank)) {
+      return errors::DataLoss("Missing the schema of column ", i, ".");
+    }
+    dtypes_.push_back(static_cast<DataType>(dtype));
+    if (!DataTypeCanUseMemcpy(dtypes_.back()) && dtypes_.back() != DT_STRING) {
+      return errors::DataLoss("Unsupported type ", dtype, " of column ", i,
+                              ".");
+    }
+    if (rank > TensorShape::MaxDimensions()) {
+      return errors::DataLoss("Invalid rank ", rank, " of column ", i, ".");
+    }
+    std::vector<int64> dims(rank);
+    for (uint32 j = 0; j < rank; ++j) {
+      uint64 dim;
+      if (!ConsumeFixed(&footer, &dim)) {
+        return errors::DataLoss("Missing the shape of column ", i, ".");
+      }
+      dims[j] = dim;
+    }
+    shapes_.emplace_back();
+    TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(dims, &shapes_.back()));
+  }
+  uint64 num_chunks;
+  if (!ConsumeFixed(&footer, &num_chunks)) {
+    return errors::DataLoss("Missing the number of chunks.");
+  }
+  for (uint64 i = 0; i < num_chunks; ++i) {
+    uint64 num_rows;
+    if (!ConsumeFixed(&footer, &num_rows)) {
+      return errors::DataLoss("Missing the number of rows of chunk ", i, ".");
+    }
+    std::vector<ColumnChunkInfo> columns(num_columns);
+    for (uint32 j = 0; j < num_columns; ++j) {
+      ColumnChunkInfo& info = columns[j];
+      if (!ConsumeFixed(&footer, &info.offset) ||
+          !ConsumeFixed(&footer, &info.size) ||
+          !ConsumeDouble(&footer, &info.min) ||
+          !ConsumeDouble(&footer, &info.max)) {
+        return errors::DataLoss("Missing column ", j, " of chunk ", i, ".");
+      }
+      const uint64 num_values = num_rows * shapes_[j].num_elements();
+      const uint64 min_size =
+          DataTypeCanUseMemcpy(dtypes_[j])
+              ? num_values * DataTypeSize(dtypes_[j])
+              : (num_values + 1) * sizeof(uint64);
+      if (info.offset < kColumnarMagicBytes || info.offset > data_end ||
+          info.size > data_end - info.offset || info.size < min_size ||
+          (DataTypeCanUseMemcpy(dtypes_[j]) && info.size != min_size)) {
+        return errors::DataLoss("Column ", j, " of chunk ", i,
+                                " is out of bounds.");
+      }
+    }
+    chunk_num_rows_.push_back(num_rows);
+    chunk_columns_.push_back(std::move(columns));
+  }
+  if (!footer.empty()) {
+    return errors::DataLoss("Unexpected trailing bytes.");
+  }
+  return Status::OK();
+}
+
+bool ColumnarFileReader::ChunkMayMatch(int64 chunk, int64 column,
+                                       double min_value,
+                                       double max_value) const {
+  const ColumnChunkInfo& info = chunk_columns_[chunk][column];
+  return info.max >= min_value && info.min <= max_value;
+}
+
+Status ColumnarFileReader::ReadColumnChunk(int64 chunk, int64 column,
+                                           ColumnChunk* out) const {
+  const ColumnChunkInfo& info = chunk_columns_[chunk][column];
+  out->dtype_ = dtypes_[column];
+  out->shape_ = shapes_[column];
+  out->num_rows_ = chunk_num_rows_[chunk];
+  if (region_) {
+    out->owned_ = false;
+    out->region_ = region_;
+    out->data_ = StringPiece(
+        static_cast<const char*>(region_->data()) + info.offset, info.size);
+    out->storage_.clear();
+    return Status::OK();
+  }
+  out->owned_ = true;
+  out->region_.reset();
+  out->data_ = StringPiece();
+  out->storage_.resize(info.size);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file_->Read(info.offset, info.size, &result, &out->storage_[0]));
+  if (result.size() != info.size) {
+    return errors::DataLoss("Unexpected end of columnar file ", filename_,
+                            ".");
+  }
+  if (result.data() != out->storage_.data()) {
+    out->storage_.assign(result.data(), result.size());
+  }
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
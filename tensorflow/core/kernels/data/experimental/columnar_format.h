@@ -0,0 +1,176 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A columnar file stores the elements of a dataset whose components have fully
+// defined shapes. Component `i` of every element is stored in column `i`, and
+// the elements, or rows, are grouped in chunks. Within a chunk, the values of
+// a column are stored contiguously, so reading a subset of the columns only
+// touches their bytes, and no record needs to be parsed.
+//
+// The file starts with `kColumnarMagic`, followed by the column chunks, each
+// of which starts at a multiple of `kColumnarAlignment` so that the file can be
+// memory-mapped. A column chunk of a memcpy-able column holds the tensor bytes
+// of its rows back to back. A column chunk of a string column holds one
+// `uint64` offset per string, plus one for the end, followed by the string
+// bytes. The file ends with a footer, the size of the footer as a `uint64`,
+// and `kColumnarMagic` again. The footer holds the schema of the columns and,
+// for every chunk, the number of its rows and the location of its column
+// chunks. For columns of numeric scalars, it also holds the minimum and the
+// maximum value of every column chunk, so that readers can skip chunks which
+// hold no row that a predicate selects.
+constexpr char kColumnarMagic[] = "TFCOLMN1";
+constexpr int64 kColumnarMagicBytes = 8;
+constexpr int64 kColumnarAlignment = 64;
+
+// Returns whether `dtype` can be the type of a column with statistics.
+bool ColumnarTypeHasStatistics(DataType dtype);
+
+// Writes the elements of a dataset to a columnar file.
+class ColumnarFileWriter {
+ public:
+  // Creates a new columnar file with columns of the given types and shapes,
+  // replacing any existing file at `filename`.
+  static Status Create(Env* env, const string& filename,
+                       const DataTypeVector& dtypes,
+                       const std::vector<TensorShape>& shapes,
+                       int64 rows_per_chunk,
+                       std::unique_ptr<ColumnarFileWriter>* out);
+
+  // Appends a row, which holds one tensor per column.
+  Status Append(const std::vector<Tensor>& row);
+
+  // Writes the remaining rows and the footer, and closes the file.
+  Status Close();
+
+ private:
+  struct ColumnChunkInfo {
+    int64 offset;
+    int64 size;
+    double min;
+    double max;
+  };
+
+  ColumnarFileWriter(std::unique_ptr<WritableFile> file, DataTypeVector dtypes,
+                     std::vector<TensorShape> shapes, int64 rows_per_chunk);
+
+  Status Write(StringPiece data);
+  Status WritePadding();
+  Status WriteColumnChunk(int64 column, ColumnChunkInfo* info);
+  Status FlushChunk();
+
+  std::unique_ptr<WritableFile> file_;
+  const DataTypeVector dtypes_;
+  const std::vector<TensorShape> shapes_;
+  const int64 rows_per_chunk_;
+  int64 offset_ = 0;
+  // The rows of the chunk being written.
+  std::vector<std::vector<Tensor>> rows_;
+  // The number of rows and the column chunks of the written chunks.
+  std::vector<int64> chunk_num_rows_;
+  std::vector<std::vector<ColumnChunkInfo>> chunk_columns_;
+};
+
+// The values of a column within a chunk.
+class ColumnChunk {
+ public:
+  int64 num_rows() const { return num_rows_; }
+
+  // Sets `value` to the value of the column in `row`. Values of memcpy-able
+  // columns of a memory-mapped file point into the mapping when they are
+  // aligned, and are copied otherwise.
+  Status GetValue(int64 row, Tensor* value) const;
+
+  // Returns the value of a numeric scalar column in `row`, as a double.
+  double GetScalarAsDouble(int64 row) const;
+
+ private:
+  friend class ColumnarFileReader;
+
+  StringPiece data() const { return owned_ ? StringPiece(storage_) : data_; }
+
+  DataType dtype_ = DT_INVALID;
+  TensorShape shape_;
+  int64 num_rows_ = 0;
+  // Whether the bytes are held in `storage_`, rather than in the memory
+  // mapping of the file that `data_` points into.
+  bool owned_ = false;
+  StringPiece data_;
+  string storage_;
+  // The region that `data_` points into, kept alive by the chunk.
+  std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
+// Reads the chunks of a columnar file. The file is memory-mapped if its file
+// system supports it, and otherwise the column chunks are read on demand.
+class ColumnarFileReader {
+ public:
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnarFileReader>* out);
+
+  const DataTypeVector& dtypes() const { return dtypes_; }
+  const std::vector<TensorShape>& shapes() const { return shapes_; }
+  int64 num_chunks() const { return chunk_num_rows_.size(); }
+  int64 num_rows(int64 chunk) const { return chunk_num_rows_[chunk]; }
+
+  // Returns whether the statistics of `chunk` allow it to hold a row whose
+  // value in `column` is in `[min_value, max_value]`. Returns true if the
+  // column has no statistics.
+  bool ChunkMayMatch(int64 chunk, int64 column, double min_value,
+                     double max_value) const;
+
+  // Reads the values of `column` in `chunk`.
+  Status ReadColumnChunk(int64 chunk, int64 column, ColumnChunk* out) const;
+
+ private:
+  struct ColumnChunkInfo {
+    uint64 offset;
+    uint64 size;
+    double min;
+    double max;
+  };
+
+  ColumnarFileReader() = default;
+
+  Status ParseFooter(StringPiece footer, uint64 file_size);
+
+  string filename_;
+  std::unique_ptr<RandomAccessFile> file_;
+  std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  DataTypeVector dtypes_;
+  std::vector<TensorShape> shapes_;
+  std::vector<int64> chunk_num_rows_;
+  std::vector<std::vector<ColumnChunkInfo>> chunk_columns_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
@@ -0,0 +1,153 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Writes `num_rows` rows of an int64 scalar, a float vector and a string
+// vector column, with `rows_per_chunk` rows per chunk.
+Status WriteTestFile(const string& filename, int64 num_rows,
+                     int64 rows_per_chunk) {
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_RETURN_IF_ERROR(ColumnarFileWriter::Create(
+      Env::Default(), filename, {DT_INT64, DT_FLOAT, DT_STRING},
+      {TensorShape({}), TensorShape({2}), TensorShape({2})}, rows_per_chunk,
+      &writer));
+  for (int64 i = 0; i < num_rows; ++i) {
+    TF_RETURN_IF_ERROR(writer->Append(
+        {test::AsScalar<int64>(i), test::AsTensor<float>({1.0f * i, -1.0f}),
+         test::AsTensor<tstring>({strings::StrCat("row", i), ""})}));
+  }
+  return writer->Close();
+}
+
+TEST(ColumnarFormatTest, WriteAndRead) {
+  const string filename = io::JoinPath(testing::TmpDir(), "WriteAndRead");
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_rows=*/10,
+                             /*rows_per_chunk=*/4));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->dtypes(), DataTypeVector({DT_INT64, DT_FLOAT, DT_STRING}));
+  ASSERT_EQ(reader->shapes().size(), 3);
+  EXPECT_EQ(reader->shapes()[1], TensorShape({2}));
+  ASSERT_EQ(reader->num_chunks(), 3);
+  EXPECT_EQ(reader->num_rows(2), 2);
+
+  int64 i = 0;
+  for (int64 chunk = 0; chunk < reader->num_chunks(); ++chunk) {
+    std::vector<ColumnChunk> columns(3);
+    for (int64 column = 0; column < 3; ++column) {
+      TF_ASSERT_OK(reader->ReadColumnChunk(chunk, column, &columns[column]));
+    }
+    for (int64 row = 0; row < reader->num_rows(chunk); ++row, ++i) {
+      Tensor value;
+      TF_ASSERT_OK(columns[0].GetValue(row, &value));
+      test::ExpectTensorEqual<int64>(value, test::AsScalar<int64>(i));
+      EXPECT_EQ(columns[0].GetScalarAsDouble(row), i);
+      TF_ASSERT_OK(columns[1].GetValue(row, &value));
+      test::ExpectTensorEqual<float>(value,
+                                     test::AsTensor<float>({1.0f * i, -1.0f}));
+      TF_ASSERT_OK(columns[2].GetValue(row, &value));
+      test::ExpectTensorEqual<tstring>(
+          value, test::AsTensor<tstring>({strings::StrCat("row", i), ""}));
+    }
+  }
+  EXPECT_EQ(i, 10);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(ColumnarFormatTest, ColumnChunksAreAligned) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "ColumnChunksAreAligned");
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(
+      Env::Default(), filename, {DT_INT8, DT_INT8},
+      {TensorShape({}), TensorShape({})}, /*rows_per_chunk=*/1, &writer));
+  TF_ASSERT_OK(writer->Append({test::AsScalar<int8>(1),
+                               test::AsScalar<int8>(2)}));
+  TF_ASSERT_OK(writer->Close());
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  EXPECT_EQ(contents.substr(0, kColumnarMagicBytes), kColumnarMagic);
+  EXPECT_EQ(contents[kColumnarAlignment], 1);
+  EXPECT_EQ(contents[2 * kColumnarAlignment], 2);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(ColumnarFormatTest, StatisticsRuleOutChunks) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "StatisticsRuleOutChunks");
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_rows=*/10,
+                             /*rows_per_chunk=*/4));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  TF_ASSERT_OK(ColumnarFileReader::Open(Env::Default(), filename, &reader));
+  // The chunks hold the rows [0, 3], [4, 7] and [8, 9].
+  EXPECT_TRUE(reader->ChunkMayMatch(0, 0, 3, 5));
+  EXPECT_TRUE(reader->ChunkMayMatch(1, 0, 3, 5));
+  EXPECT_FALSE(reader->ChunkMayMatch(2, 0, 3, 5));
+  EXPECT_FALSE(reader->ChunkMayMatch(0, 0, 3.5, 3.75));
+  // Columns that are not numeric scalars have no statistics.
+  EXPECT_TRUE(reader->ChunkMayMatch(0, 1, 100, 200));
+  EXPECT_TRUE(reader->ChunkMayMatch(0, 2, 100, 200));
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(ColumnarFormatTest, RowsMustMatchTheSchema) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "RowsMustMatchTheSchema");
+  std::unique_ptr<ColumnarFileWriter> writer;
+  TF_ASSERT_OK(ColumnarFileWriter::Create(Env::Default(), filename,
+                                          {DT_INT64}, {TensorShape({})},
+                                          /*rows_per_chunk=*/4, &writer));
+  Status s = writer->Append({test::AsTensor<int64>({1, 2})});
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  s = writer->Append({test::AsScalar<float>(1)});
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  TF_ASSERT_OK(writer->Close());
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(ColumnarFormatTest, TruncatedFile) {
+  const string filename = io::JoinPath(testing::TmpDir(), "TruncatedFile");
+  TF_ASSERT_OK(WriteTestFile(filename, /*num_rows=*/10,
+                             /*rows_per_chunk=*/4));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents.resize(contents.size() - 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  std::unique_ptr<ColumnarFileReader> reader;
+  Status s = ColumnarFileReader::Open(Env::Default(), filename, &reader);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/csv_utils.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -154,7 +155,8 @@ class CSVDatasetOp : public DatasetOpKernel {
           na_value_(std::move(na_value)),
           use_compression_(!compression_type.empty()),
           compression_type_(std::move(compression_type)),
-          options_(options) {}
+          options_(options),
+          scanner_(delim, use_quote_delim) {}
 
     std::unique_ptr<IteratorBase> MakeIteratorInternal(
         const string& prefix) const override {
@@ -445,7 +447,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter reads 1 quote, filling buffer if necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -457,6 +459,10 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip to the next quote; the buffer is refilled if there is none.
+          pos_ = csv_utils::FindQuote(buffer_.data(), pos_, buffer_.size());
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
           if (ch == '"') {
             // When we encounter a quote, we look ahead to the next character to
@@ -578,7 +584,8 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        // Each iter skips to the next special char, filling buffer if necessary
+        while (true) {
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -594,8 +601,11 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
-          char ch = buffer_[pos_];
+          pos_ = dataset()->scanner_.FindSpecial(buffer_.data(), pos_,
+                                                 buffer_.size());
+          if (pos_ >= buffer_.size()) continue;
 
+          char ch = buffer_[pos_];
           if (ch == dataset()->delim_) {
             parse_result.Update(UnquotedFieldToOutput(
                 ctx, StringPiece(&buffer_[start], pos_ - start), out_tensors,
@@ -619,7 +629,7 @@ class CSVDatasetOp : public DatasetOpKernel {
             parse_result.Update(errors::InvalidArgument(
                 "Unquoted fields cannot have quotes inside"));
           }
-          // Otherwise, go to next character
+          // Otherwise, go past the quote
           pos_++;
         }
       }
@@ -855,6 +865,7 @@ class CSVDatasetOp : public DatasetOpKernel {
     const bool use_compression_;
     const tstring compression_type_;
     const io::ZlibCompressionOptions options_;
+    const csv_utils::FieldScanner scanner_;
   };  // class Dataset
 
   DataTypeVector output_types_;
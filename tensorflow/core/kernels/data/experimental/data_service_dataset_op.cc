@@ -64,6 +64,11 @@ const int64 kRetryTimeoutMicros = 1000LL * 1000 * 60 * 60;  // 60 minutes.
 // Default interval between task list refreshes.
 const int64 kDefaultTaskRefreshIntervalMs = 1000;  // 1 second.
 
+// The maximum number of elements to fetch from a worker in one request. Workers
+// only batch small elements, so that batching amortizes the latency of a
+// request over small elements, while a request holds at most one large element.
+const int64 kMaxElementsPerRequest = 16;
+
 }  // namespace
 
 // Dataset for reading data from the tf.data service non-deterministically.
@@ -439,7 +444,8 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       }
     }
 
-    // Gets an element from a task and adds the element to `results_`.
+    // Gets a batch of elements from a task and adds the elements to
+    // `results_`.
     //
     // If the task reaches end_of_sequence or is cancelled (e.g. due to a
     // worker dying), GetElement returns Status::OK() without adding to
@@ -449,11 +455,13 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
       VLOG(3) << "Getting an element for task id " << task->task_id;
       tensorflow::profiler::TraceMe activity(
           "GetDataServiceElement", tensorflow::profiler::TraceMeLevel::kInfo);
-      CompressedElement compressed;
+      std::vector<CompressedElement> compressed_elements;
       bool end_of_sequence;
       for (int num_retries = 0;; ++num_retries) {
-        Status s = task->worker->GetElement(task->task_id, &compressed,
-                                            &end_of_sequence);
+        Status s = task->worker->GetElements(task->task_id,
+                                             kMaxElementsPerRequest,
+                                             &compressed_elements,
+                                             &end_of_sequence);
         if (s.ok()) {
           break;
         }
@@ -494,11 +502,12 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         Env::Default()->SleepForMicroseconds(backoff_until - now_micros);
       }
 
-      std::vector<Tensor> element;
-      if (!end_of_sequence) {
+      std::vector<std::vector<Tensor>> elements;
+      elements.reserve(compressed_elements.size());
+      for (CompressedElement& compressed : compressed_elements) {
         Tensor tensor(DT_VARIANT, TensorShape{});
         tensor.scalar<Variant>()() = std::move(compressed);
-        element.push_back(tensor);
+        elements.push_back({std::move(tensor)});
       }
       mutex_lock l(mu_);
       if (end_of_sequence) {
@@ -506,9 +515,12 @@ class DataServiceDatasetOp::Dataset : public DatasetBase {
         finished_tasks_++;
         return Status::OK();
       }
-      results_.push(std::move(element));
+      for (std::vector<Tensor>& element : elements) {
+        results_.push(std::move(element));
+      }
       get_next_cv_.notify_all();
-      VLOG(3) << "Got an element for task id " << task->task_id;
+      VLOG(3) << "Got " << elements.size() << " elements for task id "
+              << task->task_id;
       return Status::OK();
     }
 
@@ -0,0 +1,227 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/index_permutation.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/hash.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kEpoch[] = "epoch";
+constexpr char kPosition[] = "position";
+constexpr char kSeed[] = "seed";
+constexpr char kSeed2[] = "seed2";
+
+// Shuffles all the elements of a dataset that supports random access, by
+// reading them in the order of a pseudo-random permutation of their indices.
+// Unlike `ShuffleDataset`, which samples from a buffer of elements, this
+// dataset holds no elements, so its memory use does not depend on the size of
+// the dataset.
+class GlobalShuffleDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reshuffle_each_iteration",
+                                     &reshuffle_each_iteration_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64 seed;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed", &seed));
+    int64 seed2;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, "seed2", &seed2));
+    *output = new Dataset(ctx, input, RandomSeeds(seed, seed2),
+                          reshuffle_each_iteration_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input, RandomSeeds seeds,
+            bool reshuffle_each_iteration)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          seeds_(std::move(seeds)),
+          reshuffle_each_iteration_(reshuffle_each_iteration) {
+      input_->Ref();
+    }
+
+    ~Dataset() override { input_->Unref(); }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::GlobalShuffle")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return input_->output_dtypes();
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return input_->output_shapes();
+    }
+
+    string DebugString() const override {
+      return "GlobalShuffleDatasetOp::Dataset";
+    }
+
+    int64 Cardinality() const override { return input_->Cardinality(); }
+
+    Status CheckExternalState() const override {
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      Node* seed = nullptr;
+      Node* seed2 = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed(), &seed));
+      TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2));
+      AttrValue reshuffle_each_iteration;
+      b->BuildAttrValue(reshuffle_each_iteration_, &reshuffle_each_iteration);
+      TF_RETURN_IF_ERROR(b->AddDataset(
+          this, {input_graph_node, seed, seed2},
+          {std::make_pair("reshuffle_each_iteration",
+                          reshuffle_each_iteration)},
+          output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params),
+            seed_(params.dataset->seeds_.seed()),
+            seed2_(params.dataset->seeds_.seed2()) {}
+
+      Status Initialize(IteratorContext* ctx) override {
+        Status s =
+            dataset()->input_->RandomAccessNumElements(ctx, &num_elements_);
+        if (errors::IsUnimplemented(s)) {
+          return errors::InvalidArgument(
+              "A global shuffle requires a dataset whose elements can be "
+              "read in any order: ",
+              s.error_message());
+        }
+        TF_RETURN_IF_ERROR(s);
+        mutex_lock l(mu_);
+        // Every iterator, e.g. every epoch of a repeated dataset, visits the
+        // elements in a different order if `reshuffle_each_iteration` is set.
+        if (dataset()->reshuffle_each_iteration_) {
+          epoch_ = dataset()->num_iterators_.fetch_add(1);
+        }
+        ResetPermutation();
+        return Status::OK();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        int64 index;
+        {
+          mutex_lock l(mu_);
+          if (position_ >= num_elements_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
+          index = (*permutation_)(position_++);
+        }
+        *end_of_sequence = false;
+        return dataset()->input_->Get(ctx, index, out_tensors);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        // The seeds are saved, since they are chosen at random when both are
+        // 0.
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kEpoch), epoch_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kPosition), position_));
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpoch), &epoch_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kPosition), &position_));
+        ResetPermutation();
+        return Status::OK();
+      }
+
+     private:
+      void ResetPermutation() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        permutation_ = absl::make_unique<IndexPermutation>(
+            num_elements_, seed_, Hash64Combine(seed2_, epoch_));
+      }
+
+      // Set by `Initialize()`.
+      int64 num_elements_ = 0;
+      mutex mu_;
+      int64 seed_ TF_GUARDED_BY(mu_);
+      int64 seed2_ TF_GUARDED_BY(mu_);
+      int64 epoch_ TF_GUARDED_BY(mu_) = 0;
+      // The number of elements produced so far.
+      int64 position_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<IndexPermutation> permutation_ TF_GUARDED_BY(mu_);
+    };
+
+    const DatasetBase* const input_;
+    const RandomSeeds seeds_;
+    const bool reshuffle_each_iteration_;
+    // The number of iterators created so far, which numbers the epochs.
+    mutable std::atomic<int64> num_iterators_{0};
+  };
+
+  bool reshuffle_each_iteration_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,74 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/index_permutation.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// The finalizer of SplitMix64, which mixes every bit of `x` into every bit of
+// the result.
+uint64 Mix(uint64 x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+IndexPermutation::IndexPermutation(int64 num_elements, uint64 seed,
+                                   uint64 seed2)
+    : num_elements_(num_elements) {
+  DCHECK_GE(num_elements, 0);
+  half_bits_ = 1;
+  while (half_bits_ < 32 &&
+         (uint64{1} << (2 * half_bits_)) < static_cast<uint64>(num_elements)) {
+    ++half_bits_;
+  }
+  half_mask_ = (uint64{1} << half_bits_) - 1;
+  const uint64 key = Mix(seed) ^ Mix(Mix(seed2) + 1);
+  for (int i = 0; i < kNumRounds; ++i) {
+    keys_[i] = Mix(key + i);
+  }
+}
+
+uint64 IndexPermutation::Encrypt(uint64 value) const {
+  uint64 left = value >> half_bits_;
+  uint64 right = value & half_mask_;
+  for (int i = 0; i < kNumRounds; ++i) {
+    const uint64 next_right = left ^ (Mix(right ^ keys_[i]) & half_mask_);
+    left = right;
+    right = next_right;
+  }
+  return (left << half_bits_) | right;
+}
+
+int64 IndexPermutation::operator()(int64 position) const {
+  DCHECK_GE(position, 0);
+  DCHECK_LT(position, num_elements_);
+  uint64 value = static_cast<uint64>(position);
+  do {
+    value = Encrypt(value);
+  } while (value >= static_cast<uint64>(num_elements_));
+  return static_cast<int64>(value);
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_INDEX_PERMUTATION_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_INDEX_PERMUTATION_H_
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A pseudo-random permutation of `[0, num_elements)` that maps each position
+// to an index on demand, without materializing the permutation.
+//
+// The permutation is a Feistel network over the smallest domain of `2 * k`
+// bits that holds `num_elements` values, keyed by the seeds. Positions whose
+// image falls outside `[0, num_elements)` are mapped again until it falls
+// inside ("cycle walking"), which keeps the mapping a bijection. Since the
+// domain holds fewer than `4 * num_elements` values, a position is mapped at
+// most a few times on average.
+class IndexPermutation {
+ public:
+  IndexPermutation(int64 num_elements, uint64 seed, uint64 seed2);
+
+  int64 num_elements() const { return num_elements_; }
+
+  // Returns the index at `position`, which must be in `[0, num_elements)`.
+  int64 operator()(int64 position) const;
+
+ private:
+  static constexpr int kNumRounds = 6;
+
+  uint64 Encrypt(uint64 value) const;
+
+  const int64 num_elements_;
+  // The number of bits of each half of a domain value.
+  int half_bits_;
+  uint64 half_mask_;
+  uint64 keys_[kNumRounds];
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_INDEX_PERMUTATION_H_
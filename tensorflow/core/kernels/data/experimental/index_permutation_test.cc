@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/index_permutation.h"
+
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+std::vector<int64> Permute(const IndexPermutation& permutation) {
+  std::vector<int64> indices;
+  for (int64 i = 0; i < permutation.num_elements(); ++i) {
+    indices.push_back(permutation(i));
+  }
+  return indices;
+}
+
+TEST(IndexPermutationTest, IsABijection) {
+  for (int64 num_elements : {0, 1, 2, 3, 4, 5, 7, 16, 17, 100, 1000, 4097}) {
+    const IndexPermutation permutation(num_elements, /*seed=*/1, /*seed2=*/2);
+    std::vector<bool> seen(num_elements, false);
+    for (int64 index : Permute(permutation)) {
+      ASSERT_GE(index, 0);
+      ASSERT_LT(index, num_elements);
+      EXPECT_FALSE(seen[index]) << index << " of " << num_elements;
+      seen[index] = true;
+    }
+  }
+}
+
+TEST(IndexPermutationTest, IsDeterministic) {
+  const IndexPermutation permutation(1000, /*seed=*/7, /*seed2=*/11);
+  const IndexPermutation same_permutation(1000, /*seed=*/7, /*seed2=*/11);
+  EXPECT_EQ(Permute(permutation), Permute(same_permutation));
+}
+
+TEST(IndexPermutationTest, DependsOnTheSeeds) {
+  const IndexPermutation permutation(1000, /*seed=*/7, /*seed2=*/11);
+  const IndexPermutation other_seed(1000, /*seed=*/8, /*seed2=*/11);
+  const IndexPermutation other_seed2(1000, /*seed=*/7, /*seed2=*/12);
+  EXPECT_NE(Permute(permutation), Permute(other_seed));
+  EXPECT_NE(Permute(permutation), Permute(other_seed2));
+}
+
+TEST(IndexPermutationTest, ShufflesTheIndices) {
+  const int64 kNumElements = 10000;
+  const IndexPermutation permutation(kNumElements, /*seed=*/3, /*seed2=*/5);
+  // A shuffled sequence rarely keeps an index in place, or keeps neighbors
+  // next to each other.
+  int64 fixed_points = 0;
+  int64 adjacent_pairs = 0;
+  for (int64 i = 0; i < kNumElements; ++i) {
+    if (permutation(i) == i) ++fixed_points;
+    if (i > 0 && permutation(i) == permutation(i - 1) + 1) ++adjacent_pairs;
+  }
+  EXPECT_LT(fixed_points, 10);
+  EXPECT_LT(adjacent_pairs, 10);
+}
+
+TEST(IndexPermutationTest, LargeDomain) {
+  const int64 kNumElements = int64{1} << 40;
+  const IndexPermutation permutation(kNumElements, /*seed=*/1, /*seed2=*/1);
+  for (int64 i = 0; i < 1000; ++i) {
+    const int64 index = permutation(kNumElements - 1 - i);
+    EXPECT_GE(index, 0);
+    EXPECT_LT(index, kNumElements);
+  }
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -12,9 +12,13 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
 #include <deque>
 
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -52,6 +56,151 @@ REGISTER_KERNEL_BUILDER(
     Name("ExperimentalIteratorGetDevice").Device(DEVICE_CPU),
     IteratorGetDeviceOp);
 
+// Returns the offset of every component in a packed element, and the size of
+// the packed element. Components start at multiples of the allocator
+// alignment, so that they can be used in place.
+int64 PackedOffsets(const DataTypeVector& dtypes,
+                    const std::vector<TensorShape>& shapes,
+                    std::vector<int64>* offsets) {
+  int64 size = 0;
+  offsets->clear();
+  offsets->reserve(dtypes.size());
+  for (int i = 0; i < dtypes.size(); ++i) {
+    size = (size + Allocator::kAllocatorAlignment - 1) /
+           Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+    offsets->push_back(size);
+    size += shapes[i].num_elements() * DataTypeSize(dtypes[i]);
+  }
+  return size;
+}
+
+// Packs the components of an element into a single buffer, so that it can be
+// copied to a device with a single memcpy. The buffer is allocated in
+// GPU-compatible host memory, which on GPU builds is pinned memory from the
+// `GpuHostAllocator`, so that the copy is asynchronous and runs at full
+// bandwidth on the host-to-device stream.
+class PackElementOp : public OpKernel {
+ public:
+  using OpKernel::OpKernel;
+
+  void Compute(OpKernelContext* ctx) override {
+    DataTypeVector dtypes;
+    std::vector<TensorShape> shapes;
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      const Tensor& component = ctx->input(i);
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(component.dtype()),
+                  errors::InvalidArgument(
+                      "Cannot pack a component of type ",
+                      DataTypeString(component.dtype()), "."));
+      dtypes.push_back(component.dtype());
+      shapes.push_back(component.shape());
+    }
+    std::vector<int64> offsets;
+    const int64 size = PackedOffsets(dtypes, shapes, &offsets);
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    attr.set_gpu_compatible(true);
+    Tensor* packed;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(0, TensorShape({size}), &packed, attr));
+    char* data = reinterpret_cast<char*>(packed->flat<uint8>().data());
+    for (int i = 0; i < ctx->num_inputs(); ++i) {
+      const StringPiece bytes = ctx->input(i).tensor_data();
+      if (!bytes.empty()) {
+        std::memcpy(data + offsets[i], bytes.data(), bytes.size());
+      }
+    }
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("PackElement").Device(DEVICE_CPU),
+                        PackElementOp);
+
+// A view of a range of a packed element, which keeps the packed buffer alive.
+class PackedComponentBuffer : public TensorBuffer {
+ public:
+  PackedComponentBuffer(TensorBuffer* root, int64 offset, size_t size)
+      : TensorBuffer(root->base<char>() + offset), root_(root), size_(size) {
+    root_->Ref();
+  }
+
+  ~PackedComponentBuffer() override { root_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return root_->root_buffer(); }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    root_->FillAllocationDescription(proto);
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  TensorBuffer* const root_;
+  const size_t size_;
+};
+
+// Unpacks an element packed by `PackElementOp`, without copying: the
+// components alias the packed buffer, which is returned to the device
+// allocator for reuse by the next element once all of them are released.
+class UnpackElementOp : public OpKernel {
+ public:
+  explicit UnpackElementOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    std::vector<PartialTensorShape> output_shapes;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes));
+    OP_REQUIRES(ctx, output_shapes.size() == output_types_.size(),
+                errors::InvalidArgument(
+                    "Got ", output_types_.size(), " output types but ",
+                    output_shapes.size(), " output shapes."));
+    for (const PartialTensorShape& partial_shape : output_shapes) {
+      TensorShape shape;
+      OP_REQUIRES(ctx, partial_shape.AsTensorShape(&shape),
+                  errors::InvalidArgument(
+                      "Packed components must have fully defined shapes, "
+                      "got ",
+                      partial_shape.DebugString(), "."));
+      output_shapes_.push_back(shape);
+    }
+    size_ = PackedOffsets(output_types_, output_shapes_, &offsets_);
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& packed = ctx->input(0);
+    OP_REQUIRES(ctx, packed.dims() == 1 && packed.NumElements() == size_,
+                errors::InvalidArgument(
+                    "Expected a packed element of ", size_, " bytes, got ",
+                    packed.shape().DebugString(), "."));
+    // The components only read the packed buffer, but `TensorBuffer` exposes
+    // its root as mutable.
+    TensorBuffer* root = const_cast<TensorBuffer*>(DMAHelper::buffer(&packed));
+    for (int i = 0; i < output_types_.size(); ++i) {
+      const int64 bytes =
+          output_shapes_[i].num_elements() * DataTypeSize(output_types_[i]);
+      if (bytes == 0) {
+        Tensor* unused;
+        OP_REQUIRES_OK(ctx,
+                       ctx->allocate_output(i, output_shapes_[i], &unused));
+        continue;
+      }
+      auto* buffer = new PackedComponentBuffer(root, offsets_[i], bytes);
+      ctx->set_output(i, Tensor(output_types_[i], output_shapes_[i], buffer));
+      buffer->Unref();
+    }
+  }
+
+ private:
+  DataTypeVector output_types_;
+  std::vector<TensorShape> output_shapes_;
+  std::vector<int64> offsets_;
+  int64 size_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("UnpackElement").Device(DEVICE_CPU),
+                        UnpackElementOp);
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNEL_BUILDER(Name("UnpackElement").Device(DEVICE_GPU),
+                        UnpackElementOp);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
 }  // namespace
 }  // namespace experimental
 }  // namespace data
@@ -0,0 +1,226 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_dataset_op.h"
+
+#include <atomic>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+#include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in shared_memory_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const SharedMemoryDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    SharedMemoryDatasetOp::kSharedMemoryName;
+/* static */ constexpr const char* const SharedMemoryDatasetOp::kNumConsumers;
+/* static */ constexpr const char* const SharedMemoryDatasetOp::kIndex;
+/* static */ constexpr const char* const SharedMemoryDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const SharedMemoryDatasetOp::kOutputShapes;
+
+namespace {
+
+// How long to wait before trying again to open a shared memory segment that
+// the producer did not create yet.
+constexpr int64 kOpenRetryMicros = 1000;
+
+}  // namespace
+
+class SharedMemoryDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const tstring& shared_memory_name,
+          int64 num_consumers, int64 index, const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        shared_memory_name_(shared_memory_name),
+        num_consumers_(num_consumers),
+        index_(index),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return absl::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    return name_utils::DatasetDebugString(kDatasetType);
+  }
+
+  Status CheckExternalState() const override {
+    return errors::FailedPrecondition(
+        DebugString(), " depends on the elements of another process.");
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* shared_memory_name = nullptr;
+    Node* num_consumers = nullptr;
+    Node* index = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(shared_memory_name_, &shared_memory_name));
+    TF_RETURN_IF_ERROR(b->AddScalar(num_consumers_, &num_consumers));
+    TF_RETURN_IF_ERROR(b->AddScalar(index_, &index));
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this, {shared_memory_name, num_consumers, index}, output));
+    return Status::OK();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      if (deregister_fn_) deregister_fn_();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(), [this]() { cancelled_ = true; },
+          &deregister_fn_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      auto is_cancelled = [this]() { return cancelled_.load(); };
+      if (!ring_buffer_) {
+        string segment_name;
+        TF_RETURN_IF_ERROR(SharedMemorySegmentName(
+            dataset()->shared_memory_name_, dataset()->index_,
+            &segment_name));
+        // The producer may not have started yet.
+        Status s = SharedMemoryRingBuffer::Open(segment_name, &ring_buffer_);
+        while (errors::IsUnavailable(s)) {
+          if (is_cancelled()) {
+            return errors::Cancelled("Iterator was cancelled");
+          }
+          ctx->env()->SleepForMicroseconds(kOpenRetryMicros);
+          s = SharedMemoryRingBuffer::Open(segment_name, &ring_buffer_);
+        }
+        TF_RETURN_IF_ERROR(s);
+      }
+      TF_RETURN_IF_ERROR(
+          ring_buffer_->Read(is_cancelled, out_tensors, end_of_sequence));
+      if (*end_of_sequence) {
+        return Status::OK();
+      }
+      if (out_tensors->size() != dataset()->output_types_.size()) {
+        return errors::InvalidArgument(
+            "Expected elements with ", dataset()->output_types_.size(),
+            " components from the shared memory, got ", out_tensors->size());
+      }
+      for (int i = 0; i < out_tensors->size(); ++i) {
+        if ((*out_tensors)[i].dtype() != dataset()->output_types_[i]) {
+          return errors::InvalidArgument(
+              "Expected component ", i, " of type ",
+              DataTypeString(dataset()->output_types_[i]),
+              " from the shared memory, got ",
+              DataTypeString((*out_tensors)[i].dtype()));
+        }
+      }
+      return Status::OK();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeSourceNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      return errors::Unimplemented("SaveInternal is not supported");
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      return errors::Unimplemented("RestoreInternal is not supported");
+    }
+
+   private:
+    mutex mu_;
+    std::unique_ptr<SharedMemoryRingBuffer> ring_buffer_ TF_GUARDED_BY(mu_);
+    std::atomic<bool> cancelled_{false};
+    std::function<void()> deregister_fn_;
+  };
+
+  const tstring shared_memory_name_;
+  const int64 num_consumers_;
+  const int64 index_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+SharedMemoryDatasetOp::SharedMemoryDatasetOp(OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void SharedMemoryDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                        DatasetBase** output) {
+  tstring shared_memory_name;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kSharedMemoryName,
+                                                   &shared_memory_name));
+  int64 num_consumers;
+  OP_REQUIRES_OK(
+      ctx, ParseScalarArgument<int64>(ctx, kNumConsumers, &num_consumers));
+  OP_REQUIRES(
+      ctx, num_consumers > 0,
+      errors::InvalidArgument("Number of consumers must be greater than zero "
+                              "(currently num_consumers = ",
+                              num_consumers, ")."));
+  int64 index;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kIndex, &index));
+  OP_REQUIRES(
+      ctx, index >= 0 && index < num_consumers,
+      errors::InvalidArgument("Index must be between 0 and ", num_consumers - 1,
+                              " (currently index = ", index, ")."));
+  *output = new Dataset(ctx, shared_memory_name, num_consumers, index,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("SharedMemoryDataset").Device(DEVICE_CPU),
+                        SharedMemoryDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,447 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _MSC_VER
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/error.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "Atomics in shared memory must be lock free.");
+
+constexpr uint64 kMagic = 0x7466646174617368;  // "tfdatash"
+// Marks a slot that does not hold an element.
+constexpr int64 kEmptySlot = -1;
+constexpr int64 kPollMicros = 50;
+constexpr int kMaxErrorMessageBytes = 1024;
+// Tensor data must be aligned as if it came from an allocator.
+constexpr int64 kAlignment = Allocator::kAllocatorAlignment;
+
+constexpr int64 RoundUp(int64 bytes) {
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Precedes the dimensions and data of every component in a slot.
+struct ComponentHeader {
+  int32 dtype;
+  int32 rank;
+  int64 num_bytes;
+};
+
+int64 ComponentMetadataBytes(int rank) {
+  return RoundUp(sizeof(ComponentHeader) + rank * sizeof(int64));
+}
+
+Status WaitFor(const std::function<bool()>& condition,
+               const SharedMemoryRingBuffer::IsCancelledFn& is_cancelled) {
+  while (!condition()) {
+    if (is_cancelled()) {
+      return errors::Cancelled("Waiting on the shared memory was cancelled");
+    }
+    Env::Default()->SleepForMicroseconds(kPollMicros);
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+struct SharedMemoryRingBuffer::Mapping {
+  ~Mapping() {
+#ifndef _MSC_VER
+    if (base != nullptr) munmap(base, size);
+    if (owner) shm_unlink(name.c_str());
+#endif  // _MSC_VER
+  }
+
+  string name;
+  char* base = nullptr;
+  size_t size = 0;
+  // Whether this is the mapping of the producer, which unlinks the segment.
+  bool owner = false;
+};
+
+struct SharedMemoryRingBuffer::Header {
+  // Written last by the producer, once the segment is initialized.
+  std::atomic<uint64> magic;
+  int64 num_slots;
+  int64 slot_bytes;
+  // Set by the producer once it wrote all `num_elements` elements.
+  std::atomic<int32> finished;
+  // Set by the consumer once it read all elements.
+  std::atomic<int32> consumed;
+  int64 num_elements;
+  int32 error_code;
+  char error_message[kMaxErrorMessageBytes];
+};
+
+struct SharedMemoryRingBuffer::SlotHeader {
+  // The index of the element in the slot, or `kEmptySlot`.
+  std::atomic<int64> index;
+  int64 num_components;
+};
+
+int64 SharedMemoryRingBuffer::HeaderBytes() { return RoundUp(sizeof(Header)); }
+
+int64 SharedMemoryRingBuffer::SlotHeaderBytes() {
+  return RoundUp(sizeof(SlotHeader));
+}
+
+int64 SharedMemoryRingBuffer::SegmentBytes(int64 num_slots, int64 slot_bytes) {
+  return HeaderBytes() + num_slots * (SlotHeaderBytes() + slot_bytes);
+}
+
+// Hands the slot of an element back to the producer once the last tensor of
+// the element is destroyed.
+class SharedMemoryRingBuffer::SlotReference {
+ public:
+  SlotReference(std::shared_ptr<Mapping> mapping, SlotHeader* slot)
+      : mapping_(std::move(mapping)), slot_(slot) {}
+
+  ~SlotReference() {
+    slot_->index.store(kEmptySlot, std::memory_order_release);
+  }
+
+ private:
+  // Keeps the segment mapped while the slot is referenced.
+  const std::shared_ptr<Mapping> mapping_;
+  SlotHeader* const slot_;
+};
+
+class SharedMemoryRingBuffer::SlotTensorBuffer : public TensorBuffer {
+ public:
+  SlotTensorBuffer(void* data, size_t size, std::shared_ptr<SlotReference> slot)
+      : TensorBuffer(data), size_(size), slot_(std::move(slot)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("SharedMemoryRingBuffer");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<SlotReference> slot_;
+};
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(std::shared_ptr<Mapping> mapping,
+                                               int64 num_slots,
+                                               int64 slot_bytes)
+    : mapping_(std::move(mapping)),
+      num_slots_(num_slots),
+      slot_bytes_(slot_bytes) {}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() {}
+
+Status SharedMemoryRingBuffer::Create(
+    const string& name, int64 num_slots, int64 slot_bytes,
+    std::unique_ptr<SharedMemoryRingBuffer>* out) {
+#ifdef _MSC_VER
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on this platform");
+#else
+  if (name.size() < 2 || name[0] != '/' ||
+      name.find('/', 1) != string::npos) {
+    return errors::InvalidArgument("Invalid shared memory name: ", name);
+  }
+  if (num_slots <= 0 || slot_bytes <= 0) {
+    return errors::InvalidArgument(
+        "The number and size of slots must be positive, got ", num_slots,
+        " and ", slot_bytes);
+  }
+  slot_bytes = RoundUp(slot_bytes);
+  auto mapping = std::make_shared<Mapping>();
+  mapping->name = name;
+  mapping->size = SegmentBytes(num_slots, slot_bytes);
+
+  shm_unlink(name.c_str());
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return IOError(strings::StrCat("Creating shared memory ", name), errno);
+  }
+  mapping->owner = true;
+  if (ftruncate(fd, mapping->size) != 0) {
+    const int saved_errno = errno;
+    close(fd);
+    return IOError(strings::StrCat("Resizing shared memory ", name),
+                   saved_errno);
+  }
+  void* base = mmap(nullptr, mapping->size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  const int saved_errno = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return IOError(strings::StrCat("Mapping shared memory ", name),
+                   saved_errno);
+  }
+  mapping->base = static_cast<char*>(base);
+
+  out->reset(
+      new SharedMemoryRingBuffer(std::move(mapping), num_slots, slot_bytes));
+  Header* header = (*out)->header();
+  header->num_slots = num_slots;
+  header->slot_bytes = slot_bytes;
+  header->finished.store(0, std::memory_order_relaxed);
+  header->consumed.store(0, std::memory_order_relaxed);
+  header->num_elements = 0;
+  header->error_code = error::OK;
+  header->error_message[0] = '\0';
+  for (int64 i = 0; i < num_slots; ++i) {
+    (*out)->slot(i)->index.store(kEmptySlot, std::memory_order_relaxed);
+  }
+  header->magic.store(kMagic, std::memory_order_release);
+  return Status::OK();
+#endif  // _MSC_VER
+}
+
+Status SharedMemoryRingBuffer::Open(
+    const string& name, std::unique_ptr<SharedMemoryRingBuffer>* out) {
+#ifdef _MSC_VER
+  return errors::Unimplemented(
+      "Shared memory ring buffers are not supported on this platform");
+#else
+  const int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return errors::Unavailable("Shared memory ", name, " does not exist");
+    }
+    return IOError(strings::StrCat("Opening shared memory ", name), errno);
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    const int saved_errno = errno;
+    close(fd);
+    return IOError(strings::StrCat("Opening shared memory ", name),
+                   saved_errno);
+  }
+  if (stat_buf.st_size < HeaderBytes()) {
+    close(fd);
+    return errors::Unavailable("Shared memory ", name, " is not ready");
+  }
+  auto mapping = std::make_shared<Mapping>();
+  mapping->name = name;
+  mapping->size = stat_buf.st_size;
+  void* base = mmap(nullptr, mapping->size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  const int saved_errno = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    return IOError(strings::StrCat("Mapping shared memory ", name),
+                   saved_errno);
+  }
+  mapping->base = static_cast<char*>(base);
+
+  const Header* header = reinterpret_cast<const Header*>(mapping->base);
+  if (header->magic.load(std::memory_order_acquire) != kMagic) {
+    return errors::Unavailable("Shared memory ", name, " is not ready");
+  }
+  if (header->num_slots <= 0 || header->slot_bytes <= 0 ||
+      SegmentBytes(header->num_slots, header->slot_bytes) != mapping->size) {
+    return errors::DataLoss("Shared memory ", name, " is corrupted");
+  }
+  const int64 num_slots = header->num_slots;
+  const int64 slot_bytes = header->slot_bytes;
+  out->reset(
+      new SharedMemoryRingBuffer(std::move(mapping), num_slots, slot_bytes));
+  return Status::OK();
+#endif  // _MSC_VER
+}
+
+SharedMemoryRingBuffer::Header* SharedMemoryRingBuffer::header() const {
+  return reinterpret_cast<Header*>(mapping_->base);
+}
+
+SharedMemoryRingBuffer::SlotHeader* SharedMemoryRingBuffer::slot(
+    int64 index) const {
+  return reinterpret_cast<SlotHeader*>(
+      mapping_->base + HeaderBytes() +
+      index * (SlotHeaderBytes() + slot_bytes_));
+}
+
+int64 SharedMemoryRingBuffer::EncodedBytes(
+    const std::vector<Tensor>& components) {
+  int64 bytes = 0;
+  for (const Tensor& component : components) {
+    bytes += ComponentMetadataBytes(component.dims()) +
+             RoundUp(component.tensor_data().size());
+  }
+  return bytes;
+}
+
+Status SharedMemoryRingBuffer::Write(const std::vector<Tensor>& components,
+                                     const IsCancelledFn& is_cancelled) {
+  for (const Tensor& component : components) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return errors::Unimplemented(
+          "Elements with components of type ",
+          DataTypeString(component.dtype()),
+          " cannot be passed through shared memory.");
+    }
+  }
+  const int64 bytes = EncodedBytes(components);
+  if (bytes > slot_bytes_) {
+    return errors::InvalidArgument("An element of ", bytes,
+                                   " bytes does not fit into a slot of ",
+                                   slot_bytes_, " bytes.");
+  }
+  SlotHeader* slot_header = slot(next_index_ % num_slots_);
+  TF_RETURN_IF_ERROR(WaitFor(
+      [slot_header]() {
+        return slot_header->index.load(std::memory_order_acquire) ==
+               kEmptySlot;
+      },
+      is_cancelled));
+
+  char* cursor = reinterpret_cast<char*>(slot_header) + SlotHeaderBytes();
+  for (const Tensor& component : components) {
+    const StringPiece data = component.tensor_data();
+    ComponentHeader* component_header =
+        reinterpret_cast<ComponentHeader*>(cursor);
+    component_header->dtype = component.dtype();
+    component_header->rank = component.dims();
+    component_header->num_bytes = data.size();
+    int64* dims = reinterpret_cast<int64*>(component_header + 1);
+    for (int i = 0; i < component.dims(); ++i) {
+      dims[i] = component.dim_size(i);
+    }
+    cursor += ComponentMetadataBytes(component.dims());
+    std::memcpy(cursor, data.data(), data.size());
+    cursor += RoundUp(data.size());
+  }
+  slot_header->num_components = components.size();
+  slot_header->index.store(next_index_, std::memory_order_release);
+  ++next_index_;
+  return Status::OK();
+}
+
+void SharedMemoryRingBuffer::Finish(const Status& status) {
+  Header* header = this->header();
+  header->num_elements = next_index_;
+  header->error_code = status.code();
+  const size_t message_bytes = std::min<size_t>(
+      status.error_message().size(), kMaxErrorMessageBytes - 1);
+  std::memcpy(header->error_message, status.error_message().data(),
+              message_bytes);
+  header->error_message[message_bytes] = '\0';
+  header->finished.store(1, std::memory_order_release);
+}
+
+Status SharedMemoryRingBuffer::WaitForConsumer(
+    const IsCancelledFn& is_cancelled) {
+  Header* header = this->header();
+  return WaitFor(
+      [header]() {
+        return header->consumed.load(std::memory_order_acquire) != 0;
+      },
+      is_cancelled);
+}
+
+Status SharedMemoryRingBuffer::Read(const IsCancelledFn& is_cancelled,
+                                    std::vector<Tensor>* components,
+                                    bool* end_of_sequence) {
+  *end_of_sequence = false;
+  Header* header = this->header();
+  SlotHeader* slot_header = slot(next_index_ % num_slots_);
+  bool finished = false;
+  TF_RETURN_IF_ERROR(WaitFor(
+      [this, header, slot_header, &finished]() {
+        if (slot_header->index.load(std::memory_order_acquire) ==
+            next_index_) {
+          return true;
+        }
+        // The producer publishes all elements before finishing, so the
+        // element is either published by now or there is none.
+        finished = header->finished.load(std::memory_order_acquire) != 0 &&
+                   next_index_ >= header->num_elements;
+        return finished;
+      },
+      is_cancelled));
+  if (finished) {
+    header->consumed.store(1, std::memory_order_release);
+    if (header->error_code != error::OK) {
+      return Status(static_cast<error::Code>(header->error_code),
+                    header->error_message);
+    }
+    *end_of_sequence = true;
+    return Status::OK();
+  }
+
+  auto reference = std::make_shared<SlotReference>(mapping_, slot_header);
+  const char* const end =
+      reinterpret_cast<char*>(slot_header) + SlotHeaderBytes() + slot_bytes_;
+  char* cursor = reinterpret_cast<char*>(slot_header) + SlotHeaderBytes();
+  components->reserve(components->size() + slot_header->num_components);
+  for (int64 i = 0; i < slot_header->num_components; ++i) {
+    const ComponentHeader* component_header =
+        reinterpret_cast<const ComponentHeader*>(cursor);
+    const DataType dtype = static_cast<DataType>(component_header->dtype);
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShapeUtils::MakeShape(
+        reinterpret_cast<const int64*>(component_header + 1),
+        component_header->rank, &shape));
+    const int64 num_bytes = component_header->num_bytes;
+    cursor += ComponentMetadataBytes(component_header->rank);
+    if (!DataTypeCanUseMemcpy(dtype) ||
+        num_bytes != shape.num_elements() * DataTypeSize(dtype) ||
+        cursor + num_bytes > end) {
+      return errors::DataLoss("Element ", next_index_,
+                              " in shared memory is corrupted");
+    }
+    auto* buffer = new SlotTensorBuffer(cursor, num_bytes, reference);
+    components->emplace_back(dtype, shape, buffer);
+    buffer->Unref();
+    cursor += RoundUp(num_bytes);
+  }
+  ++next_index_;
+  return Status::OK();
+}
+
+Status SharedMemorySegmentName(const string& name, int64 index,
+                               string* segment_name) {
+  if (name.empty() || name.find('/') != string::npos) {
+    return errors::InvalidArgument(
+        "The name of the shared memory must be non-empty and must not contain "
+        "'/', got '",
+        name, "'.");
+  }
+  *segment_name = strings::StrCat("/tf_data_", name, "_", index);
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A ring of fixed-size slots in a POSIX shared-memory segment, through which
+// one producer process hands dataset elements to one consumer process.
+//
+// The producer copies the components of every element into the next slot.
+// The consumer reads them without copying: the tensors it gets point into the
+// slot, and the slot is handed back to the producer once all of them are
+// destroyed. Consequently, the number of slots bounds the number of elements
+// that the consumer can keep alive at the same time.
+//
+// Only types that can be copied with memcpy (i.e. no strings, variants or
+// resources) are supported.
+//
+// Both sides poll the segment, so that no process-shared synchronization
+// primitives are needed. Waiting calls take a function that is polled too,
+// and return `Cancelled` once it returns true.
+class SharedMemoryRingBuffer {
+ public:
+  using IsCancelledFn = std::function<bool()>;
+
+  // Creates the segment `name`, with `num_slots` slots that hold up to
+  // `slot_bytes` bytes each, as the producer. A stale segment of the same
+  // name, e.g. left behind by a crashed producer, is replaced. The segment
+  // is unlinked when the returned ring buffer is destroyed.
+  //
+  // `name` must be a valid POSIX shared-memory object name, i.e. it must
+  // start with a '/' and not contain any other '/'.
+  static Status Create(const string& name, int64 num_slots, int64 slot_bytes,
+                       std::unique_ptr<SharedMemoryRingBuffer>* out);
+
+  // Opens the segment `name` as the consumer. Returns `Unavailable` if the
+  // producer did not create it (yet).
+  static Status Open(const string& name,
+                     std::unique_ptr<SharedMemoryRingBuffer>* out);
+
+  ~SharedMemoryRingBuffer();
+
+  // Returns the number of bytes that `components` take up in a slot.
+  static int64 EncodedBytes(const std::vector<Tensor>& components);
+
+  // Producer: copies `components` into the next slot, waiting for the
+  // consumer to release it first.
+  Status Write(const std::vector<Tensor>& components,
+               const IsCancelledFn& is_cancelled);
+
+  // Producer: ends the sequence of elements with `status`, which the
+  // consumer gets once it read all elements.
+  void Finish(const Status& status);
+
+  // Producer: waits until the consumer reached the end of the sequence.
+  Status WaitForConsumer(const IsCancelledFn& is_cancelled);
+
+  // Consumer: reads the next element into `components`, or sets
+  // `*end_of_sequence` if the producer finished successfully.
+  Status Read(const IsCancelledFn& is_cancelled,
+              std::vector<Tensor>* components, bool* end_of_sequence);
+
+  int64 num_slots() const { return num_slots_; }
+  int64 slot_bytes() const { return slot_bytes_; }
+
+ private:
+  struct Mapping;
+  struct Header;
+  struct SlotHeader;
+  class SlotReference;
+  class SlotTensorBuffer;
+
+  SharedMemoryRingBuffer(std::shared_ptr<Mapping> mapping, int64 num_slots,
+                         int64 slot_bytes);
+
+  static int64 HeaderBytes();
+  static int64 SlotHeaderBytes();
+  static int64 SegmentBytes(int64 num_slots, int64 slot_bytes);
+
+  Header* header() const;
+  SlotHeader* slot(int64 index) const;
+
+  const std::shared_ptr<Mapping> mapping_;
+  const int64 num_slots_;
+  const int64 slot_bytes_;
+  // The index of the next element to write or read.
+  int64 next_index_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedMemoryRingBuffer);
+};
+
+// Returns the name of the segment through which the producer of the shared
+// memory `name` hands elements to the consumer with index `index`.
+Status SharedMemorySegmentName(const string& name, int64 index,
+                               string* segment_name);
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_SHARED_MEMORY_RING_BUFFER_H_
@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+string SegmentName(const string& test_name) {
+  return strings::StrCat("/shared_memory_ring_buffer_test_",
+                         random::New64(), "_", test_name);
+}
+
+bool NotCancelled() { return false; }
+
+TEST(SharedMemoryRingBufferTest, WriteAndRead) {
+  const string name = SegmentName("WriteAndRead");
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/2,
+                                              /*slot_bytes=*/1000, &producer));
+  EXPECT_EQ(producer->slot_bytes(), 1024);
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Open(name, &consumer));
+  EXPECT_EQ(consumer->num_slots(), 2);
+
+  for (int64 i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(producer->Write(
+        {test::AsScalar<int64>(i), test::AsTensor<float>({1, 2, 3}, {3, 1})},
+        NotCancelled));
+    std::vector<Tensor> components;
+    bool end_of_sequence = true;
+    TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+    EXPECT_FALSE(end_of_sequence);
+    ASSERT_EQ(components.size(), 2);
+    test::ExpectTensorEqual<int64>(components[0], test::AsScalar<int64>(i));
+    test::ExpectTensorEqual<float>(components[1],
+                                   test::AsTensor<float>({1, 2, 3}, {3, 1}));
+  }
+
+  producer->Finish(Status::OK());
+  std::vector<Tensor> components;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  TF_EXPECT_OK(producer->WaitForConsumer(NotCancelled));
+}
+
+TEST(SharedMemoryRingBufferTest, SlotsAreReleasedWithTheirTensors) {
+  const string name = SegmentName("SlotsAreReleasedWithTheirTensors");
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/1,
+                                              /*slot_bytes=*/1024, &producer));
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Open(name, &consumer));
+
+  TF_ASSERT_OK(producer->Write({test::AsScalar<int32>(1)}, NotCancelled));
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+
+  // The only slot is still in use by `components`.
+  int polls = 0;
+  Status s = producer->Write({test::AsScalar<int32>(2)},
+                             [&polls]() { return ++polls > 10; });
+  EXPECT_TRUE(errors::IsCancelled(s)) << s;
+
+  components.clear();
+  TF_ASSERT_OK(producer->Write({test::AsScalar<int32>(2)}, NotCancelled));
+  TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+  test::ExpectTensorEqual<int32>(components[0], test::AsScalar<int32>(2));
+}
+
+TEST(SharedMemoryRingBufferTest, ConsumerOutlivesProducer) {
+  const string name = SegmentName("ConsumerOutlivesProducer");
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/1,
+                                              /*slot_bytes=*/1024, &producer));
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Open(name, &consumer));
+  TF_ASSERT_OK(producer->Write({test::AsScalar<int32>(7)}, NotCancelled));
+  producer.reset();
+
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+  consumer.reset();
+  // The tensors keep the segment mapped.
+  test::ExpectTensorEqual<int32>(components[0], test::AsScalar<int32>(7));
+
+  std::unique_ptr<SharedMemoryRingBuffer> late_consumer;
+  Status s = SharedMemoryRingBuffer::Open(name, &late_consumer);
+  EXPECT_TRUE(errors::IsUnavailable(s)) << s;
+}
+
+TEST(SharedMemoryRingBufferTest, ProducerError) {
+  const string name = SegmentName("ProducerError");
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/4,
+                                              /*slot_bytes=*/1024, &producer));
+  std::unique_ptr<SharedMemoryRingBuffer> consumer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Open(name, &consumer));
+  TF_ASSERT_OK(producer->Write({test::AsScalar<int32>(1)}, NotCancelled));
+  producer->Finish(errors::DataLoss("Corrupted record"));
+
+  // Elements that were published before the error are still read.
+  std::vector<Tensor> components;
+  bool end_of_sequence;
+  TF_ASSERT_OK(consumer->Read(NotCancelled, &components, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  Status s = consumer->Read(NotCancelled, &components, &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  EXPECT_EQ(s.error_message(), "Corrupted record");
+}
+
+TEST(SharedMemoryRingBufferTest, UnsupportedElements) {
+  const string name = SegmentName("UnsupportedElements");
+  std::unique_ptr<SharedMemoryRingBuffer> producer;
+  TF_ASSERT_OK(SharedMemoryRingBuffer::Create(name, /*num_slots=*/1,
+                                              /*slot_bytes=*/256, &producer));
+  Status s = producer->Write({test::AsScalar<tstring>("a")}, NotCancelled);
+  EXPECT_TRUE(errors::IsUnimplemented(s)) << s;
+  s = producer->Write({Tensor(DT_FLOAT, TensorShape({100}))}, NotCancelled);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST(SharedMemoryRingBufferTest, InvalidNames) {
+  std::unique_ptr<SharedMemoryRingBuffer> ring_buffer;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      SharedMemoryRingBuffer::Create("no_slash", 1, 1, &ring_buffer)));
+  EXPECT_TRUE(errors::IsUnavailable(SharedMemoryRingBuffer::Open(
+      SegmentName("DoesNotExist"), &ring_buffer)));
+  string segment_name;
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      SharedMemorySegmentName("a/b", 0, &segment_name)));
+  TF_EXPECT_OK(SharedMemorySegmentName("pipeline", 3, &segment_name));
+  EXPECT_EQ(segment_name, "/tf_data_pipeline_3");
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/compression_codec.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/platform/errors.h"
@@ -905,9 +906,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         ctx,
         compression_ == io::compression::kNone ||
             compression_ == io::compression::kGzip ||
-            compression_ == io::compression::kSnappy,
-        errors::InvalidArgument("compression must be either '', 'GZIP' or "
-                                "'SNAPPY'."));
+            compression_ == io::compression::kSnappy ||
+            io::CompressionCodecRegistry::Lookup(compression_) != nullptr,
+        errors::InvalidArgument("compression must be either '', 'GZIP', "
+                                "'SNAPPY' or a registered codec."));
 
     OP_REQUIRES(
         ctx, pending_snapshot_expiry_seconds_ >= 1,
@@ -1489,9 +1491,11 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         // Reads one file end to end.
         Status ReadFile(Env* env, const string& filename) {
           std::unique_ptr<snapshot_util::Reader> reader;
-          TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+          TF_RETURN_IF_ERROR(snapshot_util::Reader::CreatePipelined(
               env, filename, dataset()->compression_, version_,
-              dataset()->output_dtypes(), &reader));
+              dataset()->output_dtypes(),
+              snapshot_util::PipelinedReader::kDefaultReadAhead,
+              snapshot_util::DecompressionRunner(), &reader));
           while (true) {
             // Wait for a slot in the buffer.
             {
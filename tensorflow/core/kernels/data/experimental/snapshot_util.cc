@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/compression_codec.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/lib/io/snappy/snappy_inputbuffer.h"
@@ -32,11 +33,13 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/data/experimental/snapshot.pb.h"
 
@@ -48,6 +51,91 @@ namespace snapshot_util {
     CustomReader::kSnappyReaderInputBufferSizeBytes;
 /* static */ constexpr const int64
     CustomReader::kSnappyReaderOutputBufferSizeBytes;
+/* static */ constexpr const int64 PipelinedReader::kDefaultReadAhead;
+
+namespace {
+
+// Reads a file through a read-only memory region, e.g. a memory-mapped file.
+class MemoryRegionInputStream : public io::InputStreamInterface {
+ public:
+  explicit MemoryRegionInputStream(
+      std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override {
+    StringPiece data;
+    TF_RETURN_IF_ERROR(Consume(bytes_to_read, &data));
+    result->assign(data.data(), data.size());
+    return data.size() < bytes_to_read
+               ? errors::OutOfRange("Reached end of file")
+               : Status::OK();
+  }
+
+#if defined(PLATFORM_GOOGLE)
+  Status ReadNBytes(int64 bytes_to_read, absl::Cord* cord) override {
+    StringPiece data;
+    TF_RETURN_IF_ERROR(Consume(bytes_to_read, &data));
+    cord->Append(absl::string_view(data.data(), data.size()));
+    return data.size() < bytes_to_read
+               ? errors::OutOfRange("Reached end of file")
+               : Status::OK();
+  }
+#endif  // PLATFORM_GOOGLE
+
+  Status SkipNBytes(int64 bytes_to_skip) override {
+    StringPiece data;
+    TF_RETURN_IF_ERROR(Consume(bytes_to_skip, &data));
+    return data.size() < bytes_to_skip
+               ? errors::OutOfRange("Reached end of file")
+               : Status::OK();
+  }
+
+  int64 Tell() const override { return position_; }
+
+  Status Reset() override {
+    position_ = 0;
+    return Status::OK();
+  }
+
+ private:
+  // Advances the stream by up to `bytes` bytes, and points `data` to them.
+  Status Consume(int64 bytes, StringPiece* data) {
+    if (bytes < 0) {
+      return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                     bytes);
+    }
+    const int64 available = region_->length() - position_;
+    const int64 consumed = std::min(bytes, available);
+    *data = StringPiece(static_cast<const char*>(region_->data()) + position_,
+                        consumed);
+    position_ += consumed;
+    return Status::OK();
+  }
+
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  int64 position_ = 0;
+};
+
+thread::ThreadPool* DecompressionThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), ThreadOptions(), "tf_data_snapshot_decompression",
+      port::MaxParallelism(), /*low_latency_hint=*/false);
+  return pool;
+}
+
+Status SnapshotRecordToTensors(const experimental::SnapshotRecord& record,
+                               std::vector<Tensor>* read_tensors) {
+  read_tensors->reserve(record.tensor_size());
+  for (int i = 0; i < record.tensor_size(); ++i) {
+    read_tensors->emplace_back();
+    if (!read_tensors->back().FromProto(record.tensor(i))) {
+      return errors::DataLoss("Unable to parse tensor from proto.");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
 
 std::string HashDirectory(const std::string& path, uint64 hash) {
   return io::JoinPath(
@@ -165,15 +253,20 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
   }
 #else   // IS_SLIM_BUILD
   if (compression_type_ == io::compression::kGzip) {
-    zlib_underlying_dest_.swap(dest_);
+    underlying_dest_.swap(dest_);
     io::ZlibCompressionOptions zlib_options;
     zlib_options = io::ZlibCompressionOptions::GZIP();
 
     io::ZlibOutputBuffer* zlib_output_buffer = new io::ZlibOutputBuffer(
-        zlib_underlying_dest_.get(), zlib_options.input_buffer_size,
+        underlying_dest_.get(), zlib_options.input_buffer_size,
         zlib_options.output_buffer_size, zlib_options);
     TF_CHECK_OK(zlib_output_buffer->Init());
     dest_.reset(zlib_output_buffer);
+  } else if (const io::CompressionCodec* codec =
+                 io::CompressionCodecRegistry::Lookup(compression_type_)) {
+    underlying_dest_.swap(dest_);
+    TF_RETURN_IF_ERROR(
+        codec->NewCompressingFile(underlying_dest_.get(), &dest_));
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -275,9 +368,9 @@ Status CustomWriter::Close() {
     TF_RETURN_IF_ERROR(dest_->Close());
     dest_ = nullptr;
   }
-  if (zlib_underlying_dest_ != nullptr) {
-    TF_RETURN_IF_ERROR(zlib_underlying_dest_->Close());
-    zlib_underlying_dest_ = nullptr;
+  if (underlying_dest_ != nullptr) {
+    TF_RETURN_IF_ERROR(underlying_dest_->Close());
+    underlying_dest_ = nullptr;
   }
   return Status::OK();
 }
@@ -330,6 +423,30 @@ Status Reader::Create(Env* env, const std::string& filename,
   return (*out_reader)->Initialize(env);
 }
 
+std::function<void(std::function<void()>)> DecompressionRunner() {
+  return [](std::function<void()> fn) {
+    DecompressionThreadPool()->Schedule(std::move(fn));
+  };
+}
+
+Status Reader::CreatePipelined(
+    Env* env, const std::string& filename, const string& compression_type,
+    int version, const DataTypeVector& dtypes, int64 read_ahead,
+    std::function<void(std::function<void()>)> runner,
+    std::unique_ptr<Reader>* out_reader) {
+  TF_RETURN_IF_ERROR(
+      Create(env, filename, compression_type, version, dtypes, out_reader));
+  if (read_ahead <= 0 || (version != 0 && version != 1)) {
+    return Status::OK();
+  }
+  // Versions 0 and 1 are read by `CustomReader`, see `Create`.
+  std::unique_ptr<CustomReader> reader(
+      static_cast<CustomReader*>(out_reader->release()));
+  *out_reader = absl::make_unique<PipelinedReader>(
+      std::move(reader), read_ahead, std::move(runner));
+  return (*out_reader)->Initialize(env);
+}
+
 Status Reader::SkipRecords(int64 num_records) {
   // TODO(frankchn): Optimize to not parse the entire Tensor and actually skip.
   for (int i = 0; i < num_records; ++i) {
@@ -387,9 +504,7 @@ class Reader::Dataset : public DatasetBase {
         : DatasetIterator<Dataset>(params), current_checkpoint_id_(0) {}
 
     Status Initialize(IteratorContext* ctx) override {
-      TF_RETURN_IF_ERROR(Reader::Create(
-          ctx->env(), GetCurrentFilename(), dataset()->compression_,
-          dataset()->version_, dataset()->dtypes_, &reader_));
+      TF_RETURN_IF_ERROR(CreateReader(ctx->env()));
       bool end_of_sequence;
       for (int64 i = 0; i < dataset()->start_index_; ++i) {
         // TODO(frankchn): Optimize this to not parse every single element.
@@ -442,8 +557,17 @@ class Reader::Dataset : public DatasetBase {
     Status AdvanceToNextFile(Env* env) {
       current_checkpoint_id_++;
       TF_RETURN_IF_ERROR(env->FileExists(GetCurrentFilename()));
-      return Reader::Create(env, GetCurrentFilename(), dataset()->compression_,
-                            dataset()->version_, dataset()->dtypes_, &reader_);
+      return CreateReader(env);
+    }
+
+    Status CreateReader(Env* env) {
+      // Destroy the previous reader first, which stops its background thread.
+      reader_.reset();
+      return Reader::CreatePipelined(
+          env, GetCurrentFilename(), dataset()->compression_,
+          dataset()->version_, dataset()->dtypes_,
+          PipelinedReader::kDefaultReadAhead, DecompressionRunner(),
+          &reader_);
     }
 
     std::unique_ptr<Reader> reader_;
@@ -632,7 +756,21 @@ CustomReader::CustomReader(const std::string& filename,
 
 Status CustomReader::Initialize(Env* env) {
   TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename_, &file_));
-  input_stream_ = std::make_unique<io::RandomAccessInputStream>(file_.get());
+  // The legacy snappy format is read through `file_` by `SnappyInputBuffer`.
+  bool memory_mapped = false;
+  if (version_ != 0 || compression_type_ != io::compression::kSnappy) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    // Not all file systems support memory regions, in which case we fall back
+    // to buffered reads.
+    if (env->NewReadOnlyMemoryRegionFromFile(filename_, &region).ok()) {
+      input_stream_ =
+          absl::make_unique<MemoryRegionInputStream>(std::move(region));
+      memory_mapped = true;
+    }
+  }
+  if (!memory_mapped) {
+    input_stream_ = std::make_unique<io::RandomAccessInputStream>(file_.get());
+  }
 
 #if defined(IS_SLIM_BUILD)
   if (compression_type_ != io::compression::kNone) {
@@ -652,10 +790,16 @@ Status CustomReader::Initialize(Env* env) {
       input_stream_ = absl::make_unique<io::SnappyInputBuffer>(
           file_.get(), /*input_buffer_bytes=*/kSnappyReaderInputBufferSizeBytes,
           /*output_buffer_bytes=*/kSnappyReaderOutputBufferSizeBytes);
-    } else {
+    } else if (!memory_mapped) {
       input_stream_ =
           absl::make_unique<io::BufferedInputStream>(file_.get(), 64 << 20);
     }
+  } else if (const io::CompressionCodec* codec =
+                 io::CompressionCodecRegistry::Lookup(compression_type_)) {
+    std::unique_ptr<io::InputStreamInterface> compressed_stream(
+        input_stream_.release());
+    TF_RETURN_IF_ERROR(codec->NewDecompressingStream(
+        std::move(compressed_stream), &input_stream_));
   }
 #endif  // IS_SLIM_BUILD
   simple_tensor_mask_.reserve(dtypes_.size());
@@ -679,18 +823,37 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   if (version_ == 0 || compression_type_ != io::compression::kSnappy) {
     return ReadTensorsV0(read_tensors);
   }
+  RawElement element;
+  TF_RETURN_IF_ERROR(ReadRawElement(&element));
+  return DecodeRawElement(element, read_tensors);
+}
+
+Status CustomReader::ReadRawElement(RawElement* element) {
+  if (version_ == 0 || compression_type_ != io::compression::kSnappy) {
+    element->metadata.clear();
+    return ReadRecord(&element->data);
+  }
   if (version_ != 1) {
     return errors::InvalidArgument("Version: ", version_, " is not supported.");
   }
-  if (compression_type_ != io::compression::kSnappy) {
-    return errors::InvalidArgument("Compression ", compression_type_,
-                                   " is not supported.");
+  TF_RETURN_IF_ERROR(ReadRecord(&element->metadata));
+  return ReadRecord(&element->data);
+}
+
+Status CustomReader::DecodeRawElement(const RawElement& element,
+                                      std::vector<Tensor>* read_tensors) const {
+  if (version_ == 0 || compression_type_ != io::compression::kSnappy) {
+    experimental::SnapshotRecord record;
+    record.ParseFromArray(element.data.data(), element.data.size());
+    return SnapshotRecordToTensors(record, read_tensors);
+  }
+  if (version_ != 1) {
+    return errors::InvalidArgument("Version: ", version_, " is not supported.");
   }
 
   experimental::SnapshotTensorMetadata metadata;
-  tstring metadata_str;
-  TF_RETURN_IF_ERROR(ReadRecord(&metadata_str));
-  if (!metadata.ParseFromArray(metadata_str.data(), metadata_str.size())) {
+  if (!metadata.ParseFromArray(element.metadata.data(),
+                               element.metadata.size())) {
     return errors::DataLoss("Could not parse SnapshotTensorMetadata");
   }
   read_tensors->reserve(metadata.tensor_metadata_size());
@@ -699,8 +862,8 @@ Status CustomReader::ReadTensors(std::vector<Tensor>* read_tensors) {
   simple_tensors.reserve(num_simple_);
   std::vector<std::pair<std::unique_ptr<char[]>, size_t>> tensor_proto_strs;
   tensor_proto_strs.reserve(num_complex_);
-  TF_RETURN_IF_ERROR(
-      SnappyUncompress(&metadata, &simple_tensors, &tensor_proto_strs));
+  TF_RETURN_IF_ERROR(SnappyUncompress(&metadata, element.data, &simple_tensors,
+                                      &tensor_proto_strs));
 
   int simple_index = 0;
   int complex_index = 0;
@@ -747,23 +910,14 @@ Status CustomReader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
   TF_RETURN_IF_ERROR(ReadRecord(&record_bytes));
   record.ParseFromArray(record_bytes.data(), record_bytes.size());
 #endif  // PLATFORM_GOOGLE
-  read_tensors->reserve(record.tensor_size());
-  for (int i = 0; i < record.tensor_size(); ++i) {
-    read_tensors->emplace_back();
-    if (!read_tensors->back().FromProto(record.tensor(i))) {
-      return errors::DataLoss("Unable to parse tensor from proto.");
-    }
-  }
-  return Status::OK();
+  return SnapshotRecordToTensors(record, read_tensors);
 }
 
 Status CustomReader::SnappyUncompress(
     const experimental::SnapshotTensorMetadata* metadata,
-    std::vector<Tensor>* simple_tensors,
+    const tstring& compressed, std::vector<Tensor>* simple_tensors,
     std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-        tensor_proto_strs) {
-  tstring compressed;
-  TF_RETURN_IF_ERROR(ReadRecord(&compressed));
+        tensor_proto_strs) const {
   size_t size;
   if (!port::Snappy_GetUncompressedLength(compressed.data(), compressed.size(),
                                           &size)) {
@@ -831,6 +985,102 @@ Status CustomReader::ReadRecord(absl::Cord* record) {
 }
 #endif
 
+PipelinedReader::PipelinedReader(
+    std::unique_ptr<CustomReader> reader, int64 read_ahead,
+    std::function<void(std::function<void()>)> runner)
+    : reader_(std::move(reader)),
+      read_ahead_(read_ahead),
+      runner_(std::move(runner)) {}
+
+PipelinedReader::~PipelinedReader() {
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cond_var_.notify_all();
+    while (num_decoding_ > 0) {
+      cond_var_.wait(l);
+    }
+  }
+  thread_.reset();
+}
+
+Status PipelinedReader::Initialize(Env* env) {
+  thread_ = absl::WrapUnique(env->StartThread(
+      ThreadOptions(), "tf_data_snapshot_pipelined_reader",
+      [this]() { ReadingLoop(); }));
+  return Status::OK();
+}
+
+Status PipelinedReader::ReadTensors(std::vector<Tensor>* read_tensors) {
+  profiler::TraceMe activity("PipelinedReader::ReadTensors",
+                             profiler::TraceMeLevel::kInfo);
+  std::shared_ptr<Slot> slot;
+  {
+    mutex_lock l(mu_);
+    while (slots_.empty() ? !reading_finished_ : !slots_.front()->done) {
+      cond_var_.wait(l);
+    }
+    if (slots_.empty()) {
+      return read_status_;
+    }
+    slot = std::move(slots_.front());
+    slots_.pop_front();
+    cond_var_.notify_all();
+  }
+  TF_RETURN_IF_ERROR(slot->status);
+  read_tensors->reserve(read_tensors->size() + slot->tensors.size());
+  for (auto& tensor : slot->tensors) {
+    read_tensors->push_back(std::move(tensor));
+  }
+  return Status::OK();
+}
+
+void PipelinedReader::ReadingLoop() {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && slots_.size() >= read_ahead_) {
+        cond_var_.wait(l);
+      }
+      if (cancelled_) {
+        read_status_ = errors::Cancelled("PipelinedReader was cancelled.");
+        reading_finished_ = true;
+        cond_var_.notify_all();
+        return;
+      }
+    }
+    auto slot = std::make_shared<Slot>();
+    Status s = reader_->ReadRawElement(&slot->raw_element);
+    {
+      mutex_lock l(mu_);
+      if (!s.ok() || cancelled_) {
+        read_status_ =
+            s.ok() ? errors::Cancelled("PipelinedReader was cancelled.") : s;
+        reading_finished_ = true;
+        cond_var_.notify_all();
+        return;
+      }
+      slots_.push_back(slot);
+      ++num_decoding_;
+    }
+    // The runner may run the decoding inline, so it is scheduled without
+    // holding `mu_`.
+    runner_([this, slot]() { Decode(slot); });
+  }
+}
+
+void PipelinedReader::Decode(const std::shared_ptr<Slot>& slot) {
+  std::vector<Tensor> tensors;
+  Status s = reader_->DecodeRawElement(slot->raw_element, &tensors);
+  mutex_lock l(mu_);
+  slot->raw_element = RawElement();
+  slot->status = s;
+  slot->tensors = std::move(tensors);
+  slot->done = true;
+  --num_decoding_;
+  cond_var_.notify_all();
+}
+
 Status WriteMetadataFile(Env* env, const string& dir,
                          const experimental::SnapshotMetadataRecord* metadata) {
   string metadata_filename = io::JoinPath(dir, kMetadataFilename);
@@ -25,8 +25,10 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -154,10 +156,10 @@ class CustomWriter : public Writer {
   const std::string filename_;
   const std::string compression_type_;
   const DataTypeVector dtypes_;
-  // We hold zlib_dest_ because we may create a ZlibOutputBuffer and put that
-  // in dest_ if we want compression. ZlibOutputBuffer doesn't own the original
-  // dest_ and so we need somewhere to store the original one.
-  std::unique_ptr<WritableFile> zlib_underlying_dest_;
+  // We hold underlying_dest_ because we may create a ZlibOutputBuffer or a
+  // codec's compressing file and put that in dest_ if we want compression.
+  // Neither owns the original dest_ and so we need somewhere to store it.
+  std::unique_ptr<WritableFile> underlying_dest_;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
   int num_simple_ = 0;
   int num_complex_ = 0;
@@ -174,6 +176,17 @@ class Reader {
                        const DataTypeVector& dtypes,
                        std::unique_ptr<Reader>* out_reader);
 
+  // Like `Create`, but returns a reader that reads up to `read_ahead` elements
+  // ahead of the caller on a background thread, and decodes (e.g.
+  // decompresses) them in parallel on `runner`. Returns a reader equivalent to
+  // `Create` if `read_ahead` is not positive or if `version` is not supported
+  // by `PipelinedReader`.
+  static Status CreatePipelined(
+      Env* env, const std::string& filename, const string& compression_type,
+      int version, const DataTypeVector& dtypes, int64 read_ahead,
+      std::function<void(std::function<void()>)> runner,
+      std::unique_ptr<Reader>* out_reader);
+
   // Returns a nested dataset for a set of given snapshot file names.
   //
   // This function takes a vector of snapshot files, and returns a nested
@@ -226,7 +239,20 @@ class TFRecordReader : public Reader {
   const DataTypeVector dtypes_;
 };
 
+// An element of a snapshot file that has been read, but not decoded yet.
+struct RawElement {
+  // The serialized `SnapshotTensorMetadata` of the element. Empty for the
+  // formats that do not store a separate metadata record.
+  tstring metadata;
+  // The (possibly compressed) serialized tensors of the element.
+  tstring data;
+};
+
 // Reads snapshots previously written with `CustomWriter`.
+//
+// Local files are read through a memory-mapped region when the file system
+// supports it, which avoids copying large compressed records through an
+// intermediate read buffer.
 class CustomReader : public Reader {
  public:
   // The reader input buffer size is deliberately large because the input reader
@@ -249,6 +275,14 @@ class CustomReader : public Reader {
 
   Status ReadTensors(std::vector<Tensor>* read_tensors) override;
 
+  // Reads the next element without decoding it. Must not be called
+  // concurrently with `ReadTensors` or itself.
+  Status ReadRawElement(RawElement* element);
+
+  // Decodes an element previously read with `ReadRawElement`. Thread-safe.
+  Status DecodeRawElement(const RawElement& element,
+                          std::vector<Tensor>* read_tensors) const;
+
   ~CustomReader() override {}
 
  protected:
@@ -259,9 +293,9 @@ class CustomReader : public Reader {
 
   Status SnappyUncompress(
       const experimental::SnapshotTensorMetadata* metadata,
-      std::vector<Tensor>* simple_tensors,
+      const tstring& compressed, std::vector<Tensor>* simple_tensors,
       std::vector<std::pair<std::unique_ptr<char[]>, size_t>>*
-          tensor_proto_strs);
+          tensor_proto_strs) const;
 
   Status ReadRecord(tstring* record);
 
@@ -280,6 +314,65 @@ class CustomReader : public Reader {
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
 };
 
+// Returns a runner that schedules functions on a process-wide thread pool
+// dedicated to decoding snapshot elements. Using a separate pool ensures that
+// decoding makes progress even when the threads that consume the elements
+// belong to the inter-op thread pool.
+std::function<void(std::function<void()>)> DecompressionRunner();
+
+// Reads snapshots previously written with `CustomWriter`, pipelining the reads
+// with the decoding of the elements.
+//
+// A background thread reads up to `read_ahead` raw elements ahead of the
+// caller, and schedules the decoding of each of them on `runner`, so that both
+// the reads and the (snappy) decompression of consecutive elements overlap.
+// `ReadTensors` returns the decoded elements in file order.
+class PipelinedReader : public Reader {
+ public:
+  static constexpr const int64 kDefaultReadAhead = 16;
+
+  PipelinedReader(std::unique_ptr<CustomReader> reader, int64 read_ahead,
+                  std::function<void(std::function<void()>)> runner);
+
+  // Blocks until the background thread and pending decodes are finished.
+  ~PipelinedReader() override;
+
+  Status ReadTensors(std::vector<Tensor>* read_tensors) override
+      TF_LOCKS_EXCLUDED(mu_);
+
+ protected:
+  Status Initialize(Env* env) override;
+
+ private:
+  struct Slot {
+    RawElement raw_element;
+    bool done = false;
+    Status status;
+    std::vector<Tensor> tensors;
+  };
+
+  void ReadingLoop() TF_LOCKS_EXCLUDED(mu_);
+  void Decode(const std::shared_ptr<Slot>& slot) TF_LOCKS_EXCLUDED(mu_);
+
+  const std::unique_ptr<CustomReader> reader_;
+  const int64 read_ahead_;
+  const std::function<void(std::function<void()>)> runner_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  std::deque<std::shared_ptr<Slot>> slots_ TF_GUARDED_BY(mu_);
+  // The status that ended the reading loop, e.g. `OutOfRange` at the end of
+  // the file.
+  Status read_status_ TF_GUARDED_BY(mu_);
+  bool reading_finished_ TF_GUARDED_BY(mu_) = false;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  int64 num_decoding_ TF_GUARDED_BY(mu_) = 0;
+
+  // This has to be last, so that the thread is joined before the other
+  // members are destroyed.
+  std::unique_ptr<Thread> thread_;
+};
+
 // Writes snapshot metadata to the given directory.
 Status WriteMetadataFile(Env* env, const string& dir,
                          const experimental::SnapshotMetadataRecord* metadata);
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/platform/env.h"
@@ -38,7 +39,8 @@ void GenerateTensorVector(tensorflow::DataTypeVector& dtypes,
   }
 }
 
-void SnapshotRoundTrip(std::string compression_type, int version) {
+void SnapshotRoundTrip(std::string compression_type, int version,
+                       bool pipelined = false) {
   // Generate ground-truth tensors for writing and reading.
   std::vector<Tensor> tensors;
   tensorflow::DataTypeVector dtypes;
@@ -57,8 +59,14 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
   TF_ASSERT_OK(writer->Close());
 
   std::unique_ptr<Reader> reader;
-  TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
-                              version, dtypes, &reader));
+  if (pipelined) {
+    TF_ASSERT_OK(Reader::CreatePipelined(
+        Env::Default(), filename, compression_type, version, dtypes,
+        /*read_ahead=*/4, DecompressionRunner(), &reader));
+  } else {
+    TF_ASSERT_OK(Reader::Create(Env::Default(), filename, compression_type,
+                                version, dtypes, &reader));
+  }
 
   for (int i = 0; i < 100; ++i) {
     std::vector<Tensor> read_tensors;
@@ -77,6 +85,8 @@ void SnapshotRoundTrip(std::string compression_type, int version) {
       EXPECT_EQ(proto_serialized, read_proto_serialized);
     }
   }
+  std::vector<Tensor> read_tensors;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadTensors(&read_tensors)));
 
   TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
 }
@@ -91,6 +101,44 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+TEST(SnapshotUtilTest, PipelinedRoundTripTest) {
+  SnapshotRoundTrip(io::compression::kNone, 1, /*pipelined=*/true);
+  SnapshotRoundTrip(io::compression::kGzip, 1, /*pipelined=*/true);
+  SnapshotRoundTrip(io::compression::kSnappy, 1, /*pipelined=*/true);
+
+  // Falls back to a regular reader.
+  SnapshotRoundTrip(io::compression::kSnappy, 2, /*pipelined=*/true);
+}
+
+TEST(SnapshotUtilTest, PipelinedReaderDestroyedBeforeEndOfFile) {
+  std::vector<Tensor> tensors;
+  tensorflow::DataTypeVector dtypes;
+  GenerateTensorVector(dtypes, tensors);
+  std::string filename;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&filename));
+  std::unique_ptr<Writer> writer;
+  TF_ASSERT_OK(Writer::Create(Env::Default(), filename,
+                              io::compression::kSnappy, /*version=*/1, dtypes,
+                              &writer));
+  for (int i = 0; i < 100; ++i) {
+    TF_ASSERT_OK(writer->WriteTensors(tensors));
+  }
+  TF_ASSERT_OK(writer->Close());
+
+  // Decodes inline, on the reading thread of the pipelined reader.
+  auto inline_runner = [](std::function<void()> fn) { fn(); };
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::CreatePipelined(
+      Env::Default(), filename, io::compression::kSnappy, /*version=*/1,
+      dtypes, /*read_ahead=*/2, inline_runner, &reader));
+  std::vector<Tensor> read_tensors;
+  TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+  EXPECT_EQ(read_tensors.size(), tensors.size());
+  reader.reset();
+
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
 void SnapshotReaderBenchmarkLoop(int iters, std::string compression_type,
                                  int version) {
   tensorflow::testing::StopTiming();
@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Writes the elements of a dataset to a columnar file, which a
+// `ColumnarDataset` reads.
+class ToColumnarOp : public AsyncOpKernel {
+ public:
+  explicit ToColumnarOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_columnar") {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("rows_per_chunk", &rows_per_chunk_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule([this, ctx, done = std::move(done)]() {
+      OP_REQUIRES_OK_ASYNC(ctx, DoCompute(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status DoCompute(OpKernelContext* ctx) {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag,
+                                   ctx->op_kernel().type_string());
+    tstring filename;
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<tstring>(ctx, "filename", &filename));
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    // Every row of a chunk has the same layout, so the shapes of the columns
+    // must be known up front.
+    std::vector<TensorShape> shapes;
+    for (const PartialTensorShape& shape : dataset->output_shapes()) {
+      shapes.emplace_back();
+      if (!shape.AsTensorShape(&shapes.back())) {
+        return errors::InvalidArgument(
+            "Columnar files require fully defined component shapes, got ",
+            shape.DebugString(), ".");
+      }
+    }
+
+    IteratorContext::Params params(ctx);
+    FunctionHandleCache function_handle_cache(params.flr);
+    params.function_handle_cache = &function_handle_cache;
+    ResourceMgr resource_mgr;
+    params.resource_mgr = &resource_mgr;
+    CancellationManager cancellation_manager(ctx->cancellation_manager());
+    params.cancellation_manager = &cancellation_manager;
+
+    IteratorContext iter_ctx(std::move(params));
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(dataset->MakeIterator(
+        &iter_ctx, /*parent=*/nullptr, "ToColumnarOpIterator", &iterator));
+
+    std::unique_ptr<ColumnarFileWriter> writer;
+    TF_RETURN_IF_ERROR(ColumnarFileWriter::Create(
+        ctx->env(), filename, dataset->output_dtypes(), shapes,
+        rows_per_chunk_, &writer));
+    std::vector<Tensor> components;
+    components.reserve(dataset->output_dtypes().size());
+    bool end_of_sequence;
+    do {
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+      if (!end_of_sequence) {
+        TF_RETURN_IF_ERROR(writer->Append(components));
+        components.clear();
+      }
+    } while (!end_of_sequence);
+    return writer->Close();
+  }
+
+  BackgroundWorker background_worker_;
+  int64 rows_per_chunk_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToColumnar").Device(DEVICE_CPU),
+                        ToColumnarOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
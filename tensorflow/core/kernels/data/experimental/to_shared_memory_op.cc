@@ -0,0 +1,135 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/experimental/shared_memory_ring_buffer.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Publishes the elements of a dataset to the consumer processes of a
+// `SharedMemoryDataset`, handing element `i` to the consumer with index
+// `i % num_consumers`.
+class ToSharedMemoryOp : public AsyncOpKernel {
+ public:
+  explicit ToSharedMemoryOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_shared_memory") {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_slots", &num_slots_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("slot_bytes", &slot_bytes_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule([this, ctx, done = std::move(done)]() {
+      OP_REQUIRES_OK_ASYNC(ctx, DoCompute(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status DoCompute(OpKernelContext* ctx) {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag,
+                                   ctx->op_kernel().type_string());
+    tstring shared_memory_name;
+    TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, "shared_memory_name",
+                                                    &shared_memory_name));
+    int64 num_consumers;
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<int64>(ctx, "num_consumers", &num_consumers));
+    if (num_consumers <= 0) {
+      return errors::InvalidArgument(
+          "Number of consumers must be greater than zero (currently "
+          "num_consumers = ",
+          num_consumers, ").");
+    }
+
+    // Every consumer gets a ring buffer of its own, so that it reads its
+    // shard of the elements without synchronizing with the others.
+    std::vector<std::unique_ptr<SharedMemoryRingBuffer>> ring_buffers(
+        num_consumers);
+    for (int64 i = 0; i < num_consumers; ++i) {
+      string segment_name;
+      TF_RETURN_IF_ERROR(
+          SharedMemorySegmentName(shared_memory_name, i, &segment_name));
+      TF_RETURN_IF_ERROR(SharedMemoryRingBuffer::Create(
+          segment_name, num_slots_, slot_bytes_, &ring_buffers[i]));
+    }
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+
+    IteratorContext::Params params(ctx);
+    FunctionHandleCache function_handle_cache(params.flr);
+    params.function_handle_cache = &function_handle_cache;
+    ResourceMgr resource_mgr;
+    params.resource_mgr = &resource_mgr;
+    CancellationManager cancellation_manager(ctx->cancellation_manager());
+    params.cancellation_manager = &cancellation_manager;
+    auto is_cancelled = [&cancellation_manager]() {
+      return cancellation_manager.IsCancelled();
+    };
+
+    IteratorContext iter_ctx(std::move(params));
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(dataset->MakeIterator(
+        &iter_ctx, /*parent=*/nullptr, "ToSharedMemoryOpIterator", &iterator));
+
+    std::vector<Tensor> components;
+    components.reserve(dataset->output_dtypes().size());
+    bool end_of_sequence = false;
+    Status status;
+    for (int64 index = 0; status.ok(); ++index) {
+      status = iterator->GetNext(&iter_ctx, &components, &end_of_sequence);
+      if (!status.ok() || end_of_sequence) {
+        break;
+      }
+      status = ring_buffers[index % num_consumers]->Write(components,
+                                                           is_cancelled);
+      components.clear();
+    }
+
+    // The consumers get the status of the producer once they read all their
+    // elements. The segments must stay until then, so that consumers that
+    // start late still find them.
+    for (auto& ring_buffer : ring_buffers) {
+      ring_buffer->Finish(status);
+    }
+    for (auto& ring_buffer : ring_buffers) {
+      TF_RETURN_IF_ERROR(ring_buffer->WaitForConsumer(is_cancelled));
+    }
+    return status;
+  }
+
+  BackgroundWorker background_worker_;
+  int64 num_slots_;
+  int64 slot_bytes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DatasetToSharedMemory").Device(DEVICE_CPU),
+                        ToSharedMemoryOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -126,6 +126,16 @@ class UnbatchDatasetOp : public UnaryDatasetOpKernel {
             out_tensors->clear();
             out_tensors->reserve(tensors_.size());
             for (int i = 0; i < tensors_.size(); ++i) {
+              // Slices of plain-old-data batches share the buffer of the
+              // batch, as long as they are aligned. Other slices are copied,
+              // or moved if the batch is not referenced elsewhere.
+              if (DataTypeCanUseMemcpy(tensors_[i].dtype())) {
+                Tensor slice = tensors_[i].SubSlice(current_index_);
+                if (slice.IsAligned()) {
+                  out_tensors->push_back(std::move(slice));
+                  continue;
+                }
+              }
               out_tensors->emplace_back(ctx->allocator({}), tensors_[i].dtype(),
                                         shapes_[i]);
               TF_RETURN_IF_ERROR(batch_util::MaybeMoveSliceToElement(
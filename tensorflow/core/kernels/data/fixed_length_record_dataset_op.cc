@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -93,6 +95,60 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     return name_utils::DatasetDebugString(kDatasetType, params);
   }
 
+  Status RandomAccessNumElements(IteratorContext* ctx,
+                                 int64* num_elements) const override {
+    mutex_lock l(random_access_mu_);
+    TF_RETURN_IF_ERROR(InitializeRandomAccess(ctx->env()));
+    *num_elements = file_end_records_.empty() ? 0 : file_end_records_.back();
+    return Status::OK();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    RandomAccessFile* file;
+    uint64 offset;
+    {
+      mutex_lock l(random_access_mu_);
+      TF_RETURN_IF_ERROR(InitializeRandomAccess(ctx->env()));
+      const int64 num_elements =
+          file_end_records_.empty() ? 0 : file_end_records_.back();
+      if (index < 0 || index >= num_elements) {
+        return errors::OutOfRange("Index out of range [0, ", num_elements,
+                                  "): ", index);
+      }
+      const size_t file_index =
+          std::upper_bound(file_end_records_.begin(), file_end_records_.end(),
+                           index) -
+          file_end_records_.begin();
+      const int64 file_begin_record =
+          file_index == 0 ? 0 : file_end_records_[file_index - 1];
+      offset = header_bytes_ + (index - file_begin_record) * record_bytes_;
+      if (!files_[file_index]) {
+        TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
+            filenames_[file_index], &files_[file_index]));
+      }
+      file = files_[file_index].get();
+    }
+
+    // `RandomAccessFile::Read()` is thread-safe, so records are read without
+    // holding `random_access_mu_`.
+    Tensor record_tensor(ctx->allocator({}), DT_STRING, {});
+    tstring& record = record_tensor.scalar<tstring>()();
+    record.resize_uninitialized(record_bytes_);
+    StringPiece result;
+    TF_RETURN_IF_ERROR(
+        file->Read(offset, record_bytes_, &result, record.mdata()));
+    if (result.data() != record.data()) {
+      record.assign(result.data(), result.size());
+    }
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(record_bytes_);
+    out_tensors->clear();
+    out_tensors->emplace_back(std::move(record_tensor));
+    return Status::OK();
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -119,6 +175,44 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
     return Status::OK();
   }
 
+ private:
+  // Counts the records of every file, the first time the dataset is accessed
+  // by index.
+  Status InitializeRandomAccess(Env* env) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(random_access_mu_) {
+    if (random_access_initialized_) {
+      return Status::OK();
+    }
+    if (!compression_type_.empty()) {
+      return errors::Unimplemented(
+          "Compressed fixed-length record files do not support random "
+          "access.");
+    }
+    std::vector<int64> file_end_records;
+    file_end_records.reserve(filenames_.size());
+    int64 num_records = 0;
+    for (const string& filename : filenames_) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+      const int64 body_size =
+          static_cast<int64>(file_size) - (header_bytes_ + footer_bytes_);
+      if (body_size < 0 || body_size % record_bytes_ != 0) {
+        return errors::InvalidArgument(
+            "Excluding the header (", header_bytes_, " bytes) and footer (",
+            footer_bytes_, " bytes), input file \"", filename,
+            "\" has body length ", body_size,
+            " bytes, which is not an exact multiple of the record length (",
+            record_bytes_, " bytes).");
+      }
+      num_records += body_size / record_bytes_;
+      file_end_records.push_back(num_records);
+    }
+    file_end_records_ = std::move(file_end_records);
+    files_.resize(filenames_.size());
+    random_access_initialized_ = true;
+    return Status::OK();
+  }
+
  private:
   class UncompressedIterator : public DatasetIterator<Dataset> {
    public:
@@ -448,6 +542,18 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   const int64 buffer_size_;
   const tstring compression_type_;
   const int op_version_;
+
+  // State for `Get()`, which reads records at computed offsets.
+  mutable mutex random_access_mu_;
+  mutable bool random_access_initialized_ TF_GUARDED_BY(random_access_mu_) =
+      false;
+  // The number of records in the first `i + 1` files.
+  mutable std::vector<int64> file_end_records_
+      TF_GUARDED_BY(random_access_mu_);
+  // The files opened so far, which are kept open until the dataset is
+  // destroyed.
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(random_access_mu_);
 };
 
 FixedLengthRecordDatasetOp::FixedLengthRecordDatasetOp(
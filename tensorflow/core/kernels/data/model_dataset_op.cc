@@ -50,25 +50,44 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     OP_REQUIRES(ctx, cpu_budget_ > 0,
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
-    ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    ram_budget_ = 0;
+    if (ctx->HasAttr("ram_budget")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("ram_budget", &ram_budget_));
+    }
+    if (ram_budget_ == 0) {
+      ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    }
+    OP_REQUIRES(ctx, ram_budget_ > 0,
+                errors::InvalidArgument("RAM budget must be positive but is ",
+                                        ram_budget_, "."));
+    account_for_step_threads_ = false;
+    if (ctx->HasAttr("account_for_step_threads")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("account_for_step_threads",
+                                       &account_for_step_threads_));
+    }
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
-    *output = new Dataset(ctx, input, algorithm_, cpu_budget_, ram_budget_);
+    model::OptimizationParams params;
+    params.algorithm = algorithm_;
+    params.cpu_budget = cpu_budget_;
+    params.ram_budget = ram_budget_;
+    if (account_for_step_threads_) {
+      // The intra-op threads of the device run the compute-heavy part of the
+      // step. The size of the inter-op thread pool is not visible to kernels.
+      params.intra_op_threads =
+          ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    }
+    *output = new Dataset(ctx, input, params);
   }
 
  private:
   class Dataset : public DatasetBase {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input,
-            model::AutotuneAlgorithm algorithm, int64 cpu_budget,
-            int64 ram_budget)
-        : DatasetBase(DatasetContext(ctx)),
-          input_(input),
-          algorithm_(algorithm),
-          cpu_budget_(cpu_budget),
-          ram_budget_(ram_budget) {
+            const model::OptimizationParams& params)
+        : DatasetBase(DatasetContext(ctx)), input_(input), params_(params) {
       input_->Ref();
     }
 
@@ -192,8 +211,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
             }
             if (cancelled_) return;
           }
-          model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
-                           dataset()->ram_budget_);
+          model_->Optimize(dataset()->params_);
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
           if (optimization_period_ms != kOptimizationPeriodThresholdMs) {
@@ -215,14 +233,13 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     };
 
     const DatasetBase* input_;
-    const model::AutotuneAlgorithm algorithm_;
-    const int64 cpu_budget_;
-    const int64 ram_budget_;
+    const model::OptimizationParams params_;
   };
 
   model::AutotuneAlgorithm algorithm_;
   int64 cpu_budget_;
   int64 ram_budget_;
+  bool account_for_step_threads_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ModelDataset").Device(DEVICE_CPU),
@@ -112,6 +112,13 @@ constexpr double kDefaultCyclePrefetchFactor = 2.0L;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// When the number of per-iterator results is autotuned, current workers that
+// have no element to process may keep producing results for the elements of
+// the cycle, up to `kWorkStealingBufferFactor` times the default number of
+// per-iterator results. This lets the other elements of the cycle absorb the
+// latency spikes of a slow element, e.g. a remote file.
+constexpr int64 kWorkStealingBufferFactor = 4;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -127,6 +134,16 @@ int64 ComputeBufferOutputElements(int64 configured_buffer_output_elements,
   return kDefaultPerIteratorPrefetchFactor * block_length + 1;
 }
 
+int64 ComputeMaxBufferOutputElements(int64 configured_buffer_output_elements,
+                                     int64 block_length) {
+  const int64 buffer_output_elements = ComputeBufferOutputElements(
+      configured_buffer_output_elements, block_length);
+  if (configured_buffer_output_elements != model::kAutotune) {
+    return buffer_output_elements;
+  }
+  return kWorkStealingBufferFactor * buffer_output_elements;
+}
+
 int64 ComputePrefetchInputElements(int64 configured_prefetch_input_elements,
                                    int64 cycle_length) {
   if (configured_prefetch_input_elements != model::kAutotune) {
@@ -168,6 +185,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         block_length_(block_length),
         buffer_output_elements_(
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
+        max_buffer_output_elements_(ComputeMaxBufferOutputElements(
+            buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length)),
         num_parallel_calls_(num_parallel_calls),
@@ -783,6 +802,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // claim the element by setting `element->active`, then continue to produce
     // results for the element until enough results have been computed for the
     // current cycle and the results buffer is full.
+    //
+    // A worker that finds no element that needs processing steals work
+    // instead: it keeps producing results for the next element of the cycle
+    // whose buffer holds fewer than `max_buffer_output_elements_` results.
     void CurrentWorkerThread() TF_LOCKS_EXCLUDED(mu_) {
       RecordStart(ctx_.get());
       auto done = [this]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -795,6 +818,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       while (true) {
         int element_index;
         std::shared_ptr<Element> element;
+        int64 buffer_limit = dataset()->buffer_output_elements_;
         // Find an element to process.
         {
           mutex_lock l(*mu_);
@@ -819,6 +843,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             if (element) {
               break;
             }
+            if (!wait_for_checkpoint_ && FindElementToSteal(&element_index)) {
+              element = current_elements_[element_index];
+              buffer_limit = dataset()->max_buffer_output_elements_;
+              break;
+            }
             DecrementCurrentActiveWorkers();
             WaitWorkerThread(&current_workers_cond_var_, &l);
             IncrementCurrentActiveWorkers();
@@ -833,12 +862,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // Loop on the element until we fill its results buffer or reach end of
         // input for the element.
         while (true) {
-          ProcessElement(element);
+          ProcessElement(element, buffer_limit);
           {
             mutex_lock l(*mu_);
             // Check whether we have produced enough results for the current
             // cycle.
-            if (!NeedsProcessing(element)) {
+            if (!NeedsProcessing(element, buffer_limit)) {
               element->active = false;
               break;
             }
@@ -889,13 +918,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           element->active = true;
           future_elements_.push_back(element);
         }
-        ProcessElement(element);
+        ProcessElement(element, dataset()->buffer_output_elements_);
       }
     }
 
     // Generates results for the given element until the element's results
-    // buffer is full or the element is done producing results.
-    void ProcessElement(std::shared_ptr<Element> element)
+    // buffer holds `buffer_limit` results or the element is done producing
+    // results.
+    void ProcessElement(std::shared_ptr<Element> element, int64 buffer_limit)
         TF_LOCKS_EXCLUDED(mu_) {
       DCHECK(element != nullptr);
       IteratorBase* iterator;
@@ -932,7 +962,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= buffer_limit) {
           break;
         }
       }
@@ -1018,14 +1048,40 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     bool NeedsProcessing(const std::shared_ptr<Element>& element)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      return NeedsProcessing(element, dataset()->buffer_output_elements_);
+    }
+
+    bool NeedsProcessing(const std::shared_ptr<Element>& element,
+                         int64 buffer_limit) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!element) {
         return false;
       }
       if (!element->initialized) {
         return true;
       }
-      return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+      return element->iterator && element->results.size() < buffer_limit;
+    }
+
+    // Looks for a current element that an idle current worker can produce
+    // additional results for, starting from the current position in the cycle
+    // so that the elements that will be consumed next are buffered first.
+    bool FindElementToSteal(int* element_index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->max_buffer_output_elements_ <=
+              dataset()->buffer_output_elements_ ||
+          last_valid_current_element_ == -1) {
+        return false;
+      }
+      for (int64 i = 0; i <= last_valid_current_element_; ++i) {
+        int64 index = (cycle_index_ + i) % (last_valid_current_element_ + 1);
+        const auto& element = current_elements_[index];
+        if (element && !element->active && element->initialized &&
+            NeedsProcessing(element, dataset()->max_buffer_output_elements_)) {
+          *element_index = index;
+          return true;
+        }
+      }
+      return false;
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1498,6 +1554,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64 cycle_length_;
   const int64 block_length_;
   const int64 buffer_output_elements_;
+  // The number of per-iterator results that idle current workers may buffer.
+  const int64 max_buffer_output_elements_;
   const int64 prefetch_input_elements_;
   const int64 num_parallel_calls_;
   const DeterminismPolicy deterministic_;
@@ -14,7 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/prefetch_dataset_op.h"
 
-#include <deque>
+#include <atomic>
+#include <thread>  // NOLINT
 
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
+#include "tensorflow/core/kernels/data/ring_buffer.h"
 #include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -137,6 +139,11 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       if (buffer_size_->value == model::kAutotune) {
         buffer_size_->value = 0;
       }
+      if (legacy_autotune_) {
+        // The prefetch thread reads the limit of the legacy autotuner from
+        // `buffer_size_`, which `Consume()` keeps up to date.
+        buffer_size_->value = auto_tuner_.buffer_limit();
+      }
       TF_RETURN_IF_ERROR(RegisterCancellationCallback(
           ctx->cancellation_manager(), [this]() { CancelThreads(); },
           &deregister_fn_));
@@ -147,58 +154,83 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
                            std::vector<Tensor>* out_tensors,
                            bool* end_of_sequence) override {
       const auto& stats_aggregator = ctx->stats_aggregator();
-      {
+      mutex_lock consumer_l(consumer_mu_);
+      if (!prefetch_thread_started_) {
         mutex_lock l(*mu_);
         TF_RETURN_IF_ERROR(EnsurePrefetchThreadStarted(ctx));
+        prefetch_thread_started_ = true;
+      }
+
+      // Take the next element without locking `mu_` if it is buffered, or
+      // about to be.
+      BufferElement buffer_element;
+      for (int i = 0; i < kSpinIterations; ++i) {
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (buffer_.TryPop(&buffer_element)) {
+          return Consume(ctx, &buffer_element, out_tensors, end_of_sequence);
+        }
+        if (prefetch_thread_finished_) break;
+        std::this_thread::yield();
+      }
+
+      {
+        mutex_lock l(*mu_);
         // Wait until the next element in the buffer has been
         // produced, or we are shutting down.
-        if (legacy_autotune_) {
-          while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
-                 auto_tuner_.buffer_limit() != 0) {
-            auto_tuner_.RecordEmpty();
-            buffer_size_->value = auto_tuner_.buffer_limit();
-            RecordStop(ctx);
-            cond_var_->wait(l);
-            RecordStart(ctx);
+        bool found = false;
+        while (true) {
+          // The prefetch thread only signals `cond_var_` while the consumer
+          // waits, so announce the wait before checking the buffer again.
+          consumer_waiting_ = true;
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (cancelled_) break;
+          if (buffer_.TryPop(&buffer_element)) {
+            found = true;
+            break;
           }
-        } else {
-          while (!cancelled_ && buffer_.empty() && !prefetch_thread_finished_ &&
-                 buffer_size_->value != 0) {
-            RecordStop(ctx);
-            cond_var_->wait(l);
-            RecordStart(ctx);
+          if (prefetch_thread_finished_) break;
+          if (legacy_autotune_) {
+            if (auto_tuner_.buffer_limit() == 0) break;
+            auto_tuner_.RecordEmpty();
+            SetLegacyBufferLimit();
+          } else if (buffer_size_->value == 0) {
+            break;
           }
+          RecordStop(ctx);
+          cond_var_->wait(l);
+          RecordStart(ctx);
         }
+        consumer_waiting_ = false;
 
         if (cancelled_) {
           return errors::Cancelled("Iterator was cancelled");
         }
 
-        if (!buffer_.empty()) {
-          return Consume(ctx, out_tensors, end_of_sequence);
-        }
+        if (!found) {
+          if (prefetch_thread_finished_) {
+            *end_of_sequence = true;
+            return Status::OK();
+          }
 
-        if (prefetch_thread_finished_) {
-          *end_of_sequence = true;
-          return Status::OK();
+          DCHECK_EQ(buffer_limit(), 0);
+          if (stats_aggregator) {
+            stats_aggregator->AddScalar(
+                stats_utils::BufferSizeScalarName(dataset()->node_name()),
+                static_cast<float>(buffer_.size()), num_elements());
+            stats_aggregator->AddScalar(
+                stats_utils::BufferCapacityScalarName(dataset()->node_name()),
+                static_cast<float>(buffer_limit()), num_elements());
+          }
         }
-
-        DCHECK_EQ(buffer_limit(), 0);
+        // Release mu_
+      }
+      if (!buffer_element.value.empty() || !buffer_element.status.ok()) {
+        return Consume(ctx, &buffer_element, out_tensors, end_of_sequence);
       }
 
       mutex_lock input_l(input_mu_);
-      {
-        mutex_lock l(*mu_);
-        if (stats_aggregator) {
-          stats_aggregator->AddScalar(
-              stats_utils::BufferSizeScalarName(dataset()->node_name()),
-              static_cast<float>(buffer_.size()), num_elements());
-          stats_aggregator->AddScalar(
-              stats_utils::BufferCapacityScalarName(dataset()->node_name()),
-              static_cast<float>(buffer_limit()), num_elements());
-        }
-        // Release mu_
-      }
       return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
     }
 
@@ -214,35 +246,29 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
 
     Status SaveInternal(SerializationContext* ctx,
                         IteratorStateWriter* writer) override {
-      // Acquire both locks to ensure that the prefetch thread and
+      // Acquire all locks to ensure that the prefetch thread and
       // all GetNext threads are blocked.
+      mutex_lock consumer_l(consumer_mu_);
       mutex_lock input_l(input_mu_);
       mutex_lock l(*mu_);
       TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kBufferSize, buffer_.size()));
-      for (size_t i = 0; i < buffer_.size(); i++) {
-        auto& buffer_element = buffer_[i];
-        TF_RETURN_IF_ERROR(WriteStatus(writer, i, buffer_element.status));
-        if (buffer_element.status.ok()) {
-          TF_RETURN_IF_ERROR(writer->WriteScalar(
-              absl::StrCat(prefix(), "::", i),
-              absl::StrCat(kBuffer, kSizeSuffix), buffer_element.value.size()));
-          for (size_t j = 0; j < buffer_element.value.size(); j++) {
-            TF_RETURN_IF_ERROR(writer->WriteTensor(
-                absl::StrCat(prefix(), "::", i),
-                absl::StrCat(kBuffer, "[", j, "]"), buffer_element.value[j]));
-          }
-        }
-      }
-      return Status::OK();
+      size_t i = 0;
+      Status s;
+      buffer_.ForEach([this, writer, &i, &s](const BufferElement& element) {
+        if (s.ok()) s = WriteBufferElement(writer, i, element);
+        ++i;
+      });
+      return s;
     }
 
     Status RestoreInternal(IteratorContext* ctx,
                            IteratorStateReader* reader) override {
+      mutex_lock consumer_l(consumer_mu_);
       mutex_lock input_l(input_mu_);
       mutex_lock l(*mu_);
-      buffer_.clear();
+      buffer_.Clear();
       TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
       size_t buffer_size;
       {
@@ -251,8 +277,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         buffer_size = static_cast<size_t>(temp);
       }
       for (size_t i = 0; i < buffer_size; i++) {
-        buffer_.emplace_back();
-        auto& buffer_element = buffer_.back();
+        BufferElement buffer_element;
         TF_RETURN_IF_ERROR(ReadStatus(reader, i, &buffer_element.status));
         if (buffer_element.status.ok()) {
           size_t value_size;
@@ -272,6 +297,8 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
                                    &buffer_element.value.back()));
           }
         }
+        // The prefetch thread is blocked, so this thread may push.
+        buffer_.Push(std::move(buffer_element), buffer_size);
       }
       return Status::OK();
     }
@@ -297,6 +324,10 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // The number of times a consumer that finds the buffer empty checks it
+    // again, yielding its thread in between, before it blocks on `cond_var_`.
+    static constexpr int kSpinIterations = 16;
+
     // A buffer element comprises a status and (if that status is
     // OK) a vector of tensors, representing an element of the input dataset.
     struct BufferElement {
@@ -308,41 +339,55 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       int64 id;
     };
 
+    // In legacy autotuning mode, `buffer_size_` mirrors the limit of
+    // `auto_tuner_`.
     int64 buffer_limit() const TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
-      if (legacy_autotune_) {
-        return auto_tuner_.buffer_limit();
-      }
       return buffer_size_->value;
     }
 
+    // Publishes the limit of the legacy autotuner to the prefetch thread.
+    void SetLegacyBufferLimit()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(consumer_mu_, *mu_) {
+      legacy_buffer_limit_ = auto_tuner_.buffer_limit();
+      buffer_size_->value = legacy_buffer_limit_;
+      cond_var_->notify_all();
+    }
+
     void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
       mutex_lock l(*mu_);
       cancelled_ = true;
       cond_var_->notify_all();
     }
 
-    Status Consume(IteratorContext* ctx, std::vector<Tensor>* out_tensors,
-                   bool* end_of_sequence) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    Status Consume(IteratorContext* ctx, BufferElement* buffer_element,
+                   std::vector<Tensor>* out_tensors, bool* end_of_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(consumer_mu_) TF_LOCKS_EXCLUDED(*mu_) {
+      // The number of buffered elements, including the one being consumed.
+      const size_t buffer_size = buffer_.size() + 1;
       const auto& stats_aggregator = ctx->stats_aggregator();
       if (stats_aggregator) {
-        double buffer_limit_ = buffer_limit();
+        double buffer_limit_;
+        {
+          mutex_lock l(*mu_);
+          buffer_limit_ = buffer_limit();
+        }
         stats_aggregator->AddToHistogram(
             stats_utils::BufferUtilizationHistogramName(dataset()->node_name()),
-            {static_cast<float>(buffer_.size()) /
+            {static_cast<float>(buffer_size) /
              static_cast<float>(buffer_limit_)},
             num_elements());
         stats_aggregator->AddScalar(
             stats_utils::BufferSizeScalarName(dataset()->node_name()),
-            static_cast<float>(buffer_.size()), num_elements());
+            static_cast<float>(buffer_size), num_elements());
         stats_aggregator->AddScalar(
             stats_utils::BufferCapacityScalarName(dataset()->node_name()),
             static_cast<float>(buffer_limit_), num_elements());
       }
       // A new element is available. Forward the status from computing it, and
       // (if we successfully got an element) the output values.
-      Status s = buffer_.front().status;
+      Status s = buffer_element->status;
       if (s.ok()) {
-        int64 buffer_element_id = buffer_.front().id;
+        int64 buffer_element_id = buffer_element->id;
         profiler::TraceMe traceme(
             [&] {
               return profiler::TraceMeEncode(
@@ -353,7 +398,7 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
             (num_elements() + 1) % dataset()->slack_period_ == 0) {
           // TODO(rachelim): Consider doing something more sophisticated
           // to decide how long to sleep for; e.g. using a kalman filter.
-          int64 slack_us = EnvTime::NowMicros() - buffer_.front().created_us;
+          int64 slack_us = EnvTime::NowMicros() - buffer_element->created_us;
           // Every slack_period_-th element, update the most recent slack time,
           // measured by the duration between when the element is prefetched
           // and when it is consumed. We add kSleepFactor * slack_us_ to the
@@ -362,22 +407,27 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
           slack_us_ = kSleepFactor * slack_us_ + slack_us;
           VLOG(2) << "Setting slack_us_: " << slack_us_;
         }
-        *out_tensors = std::move(buffer_.front().value);
+        *out_tensors = std::move(buffer_element->value);
         RecordBufferDequeue(ctx, *out_tensors);
       }
+      *end_of_sequence = false;
+
       if (legacy_autotune_) {
-        auto_tuner_.RecordConsumption(buffer_.size());
-        buffer_size_->value = auto_tuner_.buffer_limit();
+        auto_tuner_.RecordConsumption(buffer_size);
+        if (auto_tuner_.buffer_limit() != legacy_buffer_limit_) {
+          mutex_lock l(*mu_);
+          SetLegacyBufferLimit();
+          return s;
+        }
       }
-      buffer_.pop_front();
-      *end_of_sequence = false;
 
       // Wake the prefetch thread, in case it has been waiting for space
-      // in the buffer. Also wake up threads from other calls to GetNext.
-      //
-      // TODO(mrry): Consider using different condition variables for
-      // GetNext and Prefetch.
-      cond_var_->notify_all();
+      // in the buffer.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (producer_waiting_) {
+        mutex_lock l(*mu_);
+        cond_var_->notify_all();
+      }
       return s;
     }
 
@@ -400,21 +450,31 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
       auto cleanup = gtl::MakeCleanup([this, ctx] { RecordStop(ctx.get()); });
       // Keep track of where we are in an iteration "burst"
       int num_produced = 0;
+      // The limit on the buffer size, as of the last time this thread waited.
+      // The limit is only read again when the buffer reaches it, so that
+      // elements are produced without locking `mu_`.
+      int64 limit = 0;
       while (true) {
         // 1. Wait for a slot in the buffer.
-        {
+        if (cancelled_ || buffer_.size() >= limit) {
           mutex_lock l(*mu_);
+          // The consumer only signals `cond_var_` while this thread waits, so
+          // announce the wait before checking the buffer again.
+          producer_waiting_ = true;
+          std::atomic_thread_fence(std::memory_order_seq_cst);
           while (!cancelled_ && buffer_.size() >= buffer_limit()) {
             RecordStop(ctx.get());
             cond_var_->wait(l);
             RecordStart(ctx.get());
           }
+          producer_waiting_ = false;
 
           if (cancelled_) {
             prefetch_thread_finished_ = true;
             cond_var_->notify_all();
             return;
           }
+          limit = buffer_limit();
         }
 
         if (dataset()->slack_period_ > 0 &&
@@ -451,18 +511,36 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
         }
 
         // 3. Signal that the element has been produced.
-        {
+        RecordBufferEnqueue(ctx.get(), buffer_element.value);
+        buffer_element.created_us = EnvTime::NowMicros();
+        buffer_element.id = num_produced;
+        buffer_.Push(std::move(buffer_element), limit);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (consumer_waiting_) {
           mutex_lock l(*mu_);
-          RecordBufferEnqueue(ctx.get(), buffer_element.value);
-          buffer_element.created_us = EnvTime::NowMicros();
-          buffer_element.id = num_produced;
-          buffer_.push_back(std::move(buffer_element));
           cond_var_->notify_all();
         }
         ++num_produced;
       }
     }
 
+    Status WriteBufferElement(IteratorStateWriter* writer, size_t index,
+                              const BufferElement& buffer_element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
+      TF_RETURN_IF_ERROR(WriteStatus(writer, index, buffer_element.status));
+      if (buffer_element.status.ok()) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            absl::StrCat(prefix(), "::", index),
+            absl::StrCat(kBuffer, kSizeSuffix), buffer_element.value.size()));
+        for (size_t j = 0; j < buffer_element.value.size(); j++) {
+          TF_RETURN_IF_ERROR(writer->WriteTensor(
+              absl::StrCat(prefix(), "::", index),
+              absl::StrCat(kBuffer, "[", j, "]"), buffer_element.value[j]));
+        }
+      }
+      return Status::OK();
+    }
+
     Status WriteStatus(IteratorStateWriter* writer, size_t index,
                        const Status& status) TF_EXCLUSIVE_LOCKS_REQUIRED(*mu_) {
       TF_RETURN_IF_ERROR(
@@ -506,22 +584,36 @@ class PrefetchDatasetOp::Dataset : public DatasetBase {
     //
     // NOTE: We should never call GetNext on the input while holding this mutex.
     const std::shared_ptr<mutex> mu_;
+    // This mutex serializes the GetNext calls, so that there is a single
+    // consumer of `buffer_` at a time.
+    mutex consumer_mu_ TF_ACQUIRED_BEFORE(input_mu_);
     // This mutex is used to ensure exclusivity between multiple threads
     // accessing the input iterator. We keep this separate from `mu_` to allow
     // prefetching to run in parallel with GetNext calls.
     mutex input_mu_ TF_ACQUIRED_BEFORE(*mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(input_mu_);
     const std::shared_ptr<condition_variable> cond_var_;
-    PrefetchAutotuner auto_tuner_ TF_GUARDED_BY(*mu_);
-    std::deque<BufferElement> buffer_ TF_GUARDED_BY(*mu_);
+    PrefetchAutotuner auto_tuner_ TF_GUARDED_BY(consumer_mu_);
+    // The limit of `auto_tuner_` that was last published to `buffer_size_`.
+    int64 legacy_buffer_limit_ TF_GUARDED_BY(consumer_mu_) = -1;
+    // The prefetch thread pushes to the buffer and GetNext pops from it
+    // without locking `mu_`; they only lock it to wait on `cond_var_`, or to
+    // signal a thread that announced it is waiting.
+    SpscRingBuffer<BufferElement> buffer_;
+    std::atomic<bool> consumer_waiting_{false};
+    std::atomic<bool> producer_waiting_{false};
     std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(*mu_);
-    bool cancelled_ TF_GUARDED_BY(*mu_) = false;
-    bool prefetch_thread_finished_ TF_GUARDED_BY(*mu_) = false;
+    bool prefetch_thread_started_ TF_GUARDED_BY(consumer_mu_) = false;
+    // Only written while holding `mu_`.
+    std::atomic<bool> cancelled_{false};
+    // Only written while holding `mu_`.
+    std::atomic<bool> prefetch_thread_finished_{false};
     const bool legacy_autotune_;
 
     std::atomic<int64> slack_us_;
 
     // If legacy_autotune_ is false, identifies the maximum size of the buffer.
+    // Otherwise, mirrors the limit of `auto_tuner_`.
     const std::shared_ptr<model::SharedState> buffer_size_;
 
     // Method for deregistering the cancellation callback.
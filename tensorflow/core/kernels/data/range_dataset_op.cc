@@ -34,6 +34,27 @@ namespace data {
 
 constexpr char kNext[] = "next";
 
+namespace {
+
+Status ConvertOutputType(DataType dtype, int64 value,
+                         std::vector<Tensor>* out_tensors) {
+  switch (dtype) {
+#define HANDLE_TYPE(type)                                \
+  case DataTypeToEnum<type>::value: {                    \
+    out_tensors->emplace_back(static_cast<type>(value)); \
+    break;                                               \
+  }
+    TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
+#undef HANDLE_TYPE
+    default:
+      return errors::InvalidArgument("Unsupported data type: ",
+                                     DataTypeString(dtype));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 class RangeDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, int64 start, int64 stop, int64 step,
@@ -74,6 +95,23 @@ class RangeDatasetOp::Dataset : public DatasetBase {
     }
   }
 
+  Status RandomAccessNumElements(IteratorContext* ctx,
+                                 int64* num_elements) const override {
+    *num_elements = Cardinality();
+    return Status::OK();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index out of range [0, ", Cardinality(),
+                                "): ", index);
+    }
+    out_tensors->clear();
+    return ConvertOutputType(output_dtypes_[0], start_ + index * step_,
+                             out_tensors);
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -107,19 +145,8 @@ class RangeDatasetOp::Dataset : public DatasetBase {
         return Status::OK();
       }
       out_tensors->reserve(1);
-      switch (dataset()->output_dtypes()[0]) {
-#define HANDLE_TYPE(type)                                \
-  case DataTypeToEnum<type>::value: {                    \
-    out_tensors->emplace_back(static_cast<type>(next_)); \
-    break;                                               \
-  }
-        TF_CALL_NUMBER_TYPES(HANDLE_TYPE);
-#undef HANDLE_TYPE
-        default:
-          return errors::InvalidArgument(
-              "Unsupported data type: ",
-              DataTypeString(dataset()->output_dtypes()[0]));
-      }
+      TF_RETURN_IF_ERROR(
+          ConvertOutputType(dataset()->output_dtypes()[0], next_, out_tensors));
       *end_of_sequence = false;
       next_ += dataset()->step_;
 
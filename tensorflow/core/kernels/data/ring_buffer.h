@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_RING_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_RING_BUFFER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+namespace data {
+
+// A lock-free queue for one producer thread and one consumer thread.
+//
+// Elements are stored in a ring of slots. When the producer finds the ring
+// full, it starts a larger ring and links it after the current one, and the
+// consumer moves to the new ring once it has drained the old one. The queue
+// thus grows without the producer ever waiting for the consumer, and how many
+// elements may be queued is left to the caller, which can change its limit at
+// any time.
+//
+// `Push()` must only be called by the producer and `TryPop()` by the
+// consumer; the threads that play these roles may change if the calls are
+// ordered by some other synchronization, such as a mutex. `size()` may be
+// called by any thread. `ForEach()` and `Clear()` require that no other
+// thread pushes or pops concurrently.
+template <typename T>
+class SpscRingBuffer {
+ public:
+  explicit SpscRingBuffer(size_t capacity = 1)
+      : producer_segment_(new Segment(RoundUpToPowerOfTwo(capacity))),
+        consumer_segment_(producer_segment_) {}
+
+  ~SpscRingBuffer() {
+    Segment* segment = consumer_segment_;
+    while (segment != nullptr) {
+      Segment* next = segment->next.load(std::memory_order_relaxed);
+      delete segment;
+      segment = next;
+    }
+  }
+
+  // Appends `value`. If the ring is full, the new ring holds at least
+  // `capacity_hint` elements.
+  void Push(T value, size_t capacity_hint) {
+    Segment* segment = producer_segment_;
+    const size_t tail = segment->tail.load(std::memory_order_relaxed);
+    const size_t capacity = segment->mask + 1;
+    if (tail - segment->head.load(std::memory_order_acquire) < capacity) {
+      segment->slots[tail & segment->mask] = std::move(value);
+      segment->tail.store(tail + 1, std::memory_order_release);
+    } else {
+      Segment* next = new Segment(
+          RoundUpToPowerOfTwo(std::max(2 * capacity, capacity_hint)));
+      next->slots[0] = std::move(value);
+      next->tail.store(1, std::memory_order_relaxed);
+      // The producer never writes to `segment` again, so once the consumer
+      // sees `next` it sees the final `tail` of `segment`.
+      segment->next.store(next, std::memory_order_release);
+      producer_segment_ = next;
+    }
+    size_.fetch_add(1, std::memory_order_seq_cst);
+  }
+
+  // Removes the oldest element into `*value` and returns true, or returns
+  // false if the buffer is empty.
+  bool TryPop(T* value) {
+    while (true) {
+      Segment* segment = consumer_segment_;
+      const size_t head = segment->head.load(std::memory_order_relaxed);
+      if (head != segment->tail.load(std::memory_order_acquire)) {
+        *value = std::move(segment->slots[head & segment->mask]);
+        segment->head.store(head + 1, std::memory_order_release);
+        size_.fetch_sub(1, std::memory_order_seq_cst);
+        return true;
+      }
+      Segment* next = segment->next.load(std::memory_order_acquire);
+      if (next == nullptr) return false;
+      // The producer may have filled `segment` before moving on.
+      if (head != segment->tail.load(std::memory_order_acquire)) continue;
+      consumer_segment_ = next;
+      delete segment;
+    }
+  }
+
+  // Returns the number of elements in the buffer.
+  size_t size() const { return size_.load(std::memory_order_seq_cst); }
+
+  bool empty() const { return size() == 0; }
+
+  // Calls `fn` on every element, oldest first.
+  template <typename F>
+  void ForEach(F fn) const {
+    for (const Segment* segment = consumer_segment_; segment != nullptr;
+         segment = segment->next.load(std::memory_order_acquire)) {
+      const size_t tail = segment->tail.load(std::memory_order_acquire);
+      for (size_t i = segment->head.load(std::memory_order_relaxed); i != tail;
+           ++i) {
+        fn(segment->slots[i & segment->mask]);
+      }
+    }
+  }
+
+  // Removes all elements.
+  void Clear() {
+    T value;
+    while (TryPop(&value)) {
+    }
+  }
+
+ private:
+  // One ring of slots. `head` and `tail` count the elements ever popped from
+  // and pushed to the ring, and are kept on different cache lines so that the
+  // producer and the consumer do not invalidate each other's line on every
+  // element.
+  struct Segment {
+    explicit Segment(size_t capacity)
+        : slots(new T[capacity]), mask(capacity - 1) {}
+
+    const std::unique_ptr<T[]> slots;
+    const size_t mask;
+    std::atomic<Segment*> next{nullptr};
+    char head_padding[64];
+    std::atomic<size_t> head{0};
+    char tail_padding[64];
+    std::atomic<size_t> tail{0};
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t n) {
+    size_t result = 1;
+    while (result < n) result <<= 1;
+    return result;
+  }
+
+  // Only accessed by the producer.
+  Segment* producer_segment_;
+  // Only accessed by the consumer.
+  Segment* consumer_segment_;
+  std::atomic<size_t> size_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SpscRingBuffer);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_RING_BUFFER_H_
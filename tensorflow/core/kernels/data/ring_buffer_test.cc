@@ -0,0 +1,105 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/ring_buffer.h"
+
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(SpscRingBufferTest, PushAndPop) {
+  SpscRingBuffer<int> buffer(/*capacity=*/4);
+  int value;
+  EXPECT_FALSE(buffer.TryPop(&value));
+  for (int i = 0; i < 3; ++i) {
+    buffer.Push(i, /*capacity_hint=*/4);
+  }
+  EXPECT_EQ(buffer.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(buffer.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_FALSE(buffer.TryPop(&value));
+}
+
+TEST(SpscRingBufferTest, GrowsWhenFull) {
+  SpscRingBuffer<int> buffer(/*capacity=*/2);
+  for (int i = 0; i < 100; ++i) {
+    buffer.Push(i, /*capacity_hint=*/i);
+  }
+  EXPECT_EQ(buffer.size(), 100);
+  std::vector<int> values;
+  buffer.ForEach([&values](int value) { values.push_back(value); });
+  ASSERT_EQ(values.size(), 100);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+  int value;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(buffer.TryPop(&value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(buffer.TryPop(&value));
+}
+
+TEST(SpscRingBufferTest, ClearReleasesElements) {
+  SpscRingBuffer<std::shared_ptr<int>> buffer;
+  auto element = std::make_shared<int>(0);
+  for (int i = 0; i < 10; ++i) {
+    buffer.Push(element, /*capacity_hint=*/1);
+  }
+  EXPECT_EQ(element.use_count(), 11);
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(element.use_count(), 1);
+}
+
+TEST(SpscRingBufferTest, ConcurrentProducerAndConsumer) {
+  constexpr int kNumElements = 100000;
+  SpscRingBuffer<int> buffer(/*capacity=*/16);
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      {}, "producer", [&buffer]() {
+        for (int i = 0; i < kNumElements; ++i) {
+          // Keep the buffer bounded, growing it now and then.
+          while (buffer.size() >= 1 + i / 1000) {
+            std::this_thread::yield();
+          }
+          buffer.Push(i, /*capacity_hint=*/1 + i / 1000);
+        }
+      }));
+  int expected = 0;
+  while (expected < kNumElements) {
+    int value;
+    if (buffer.TryPop(&value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.reset();
+  EXPECT_TRUE(buffer.empty());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
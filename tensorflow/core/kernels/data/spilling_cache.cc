@@ -0,0 +1,255 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/spilling_cache.h"
+
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Size of the element header: the number of components.
+constexpr int64 kElementHeaderBytes = sizeof(uint64);
+
+// Size of the fixed part of the component header: dtype, rank and the number
+// of bytes. The dimensions follow, one `uint64` each.
+constexpr int64 kComponentHeaderBytes = 2 * sizeof(uint32) + sizeof(uint64);
+
+int64 PaddingBytes(int64 offset) {
+  return (kSpillFileAlignment - offset % kSpillFileAlignment) %
+         kSpillFileAlignment;
+}
+
+}  // namespace
+
+SpillFileWriter::SpillFileWriter(std::unique_ptr<WritableFile> file)
+    : file_(std::move(file)) {}
+
+Status SpillFileWriter::Create(Env* env, const string& filename,
+                               std::unique_ptr<SpillFileWriter>* out) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  out->reset(new SpillFileWriter(std::move(file)));
+  return Status::OK();
+}
+
+Status SpillFileWriter::Write(StringPiece data) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  offset_ += data.size();
+  return Status::OK();
+}
+
+Status SpillFileWriter::WritePadding() {
+  static const char kZeros[kSpillFileAlignment] = {};
+  return Write(StringPiece(kZeros, PaddingBytes(offset_)));
+}
+
+Status SpillFileWriter::Append(const std::vector<Tensor>& element) {
+  string header;
+  core::PutFixed64(&header, element.size());
+  TF_RETURN_IF_ERROR(Write(header));
+  for (const Tensor& component : element) {
+    string serialized;
+    StringPiece data;
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      data = component.tensor_data();
+    } else {
+      TensorProto proto;
+      component.AsProtoTensorContent(&proto);
+      if (!proto.SerializeToString(&serialized)) {
+        return errors::Internal("Failed to serialize a ",
+                                DataTypeString(component.dtype()),
+                                " tensor for the spill file.");
+      }
+      data = serialized;
+    }
+    header.clear();
+    core::PutFixed32(&header, component.dtype());
+    core::PutFixed32(&header, component.dims());
+    core::PutFixed64(&header, data.size());
+    for (int i = 0; i < component.dims(); ++i) {
+      core::PutFixed64(&header, component.dim_size(i));
+    }
+    TF_RETURN_IF_ERROR(Write(header));
+    TF_RETURN_IF_ERROR(WritePadding());
+    TF_RETURN_IF_ERROR(Write(data));
+  }
+  return Status::OK();
+}
+
+Status SpillFileWriter::Close() {
+  TF_RETURN_IF_ERROR(file_->Flush());
+  return file_->Close();
+}
+
+SpillFileReader::SpillFileReader(std::unique_ptr<RandomAccessFile> file,
+                                 int64 buffer_bytes)
+    : file_(std::move(file)), input_(file_.get(), buffer_bytes) {}
+
+Status SpillFileReader::Create(Env* env, const string& filename,
+                               int64 buffer_bytes,
+                               std::unique_ptr<SpillFileReader>* out) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  out->reset(new SpillFileReader(std::move(file), buffer_bytes));
+  return Status::OK();
+}
+
+Status SpillFileReader::Read(int64 bytes, char* result) {
+  size_t bytes_read;
+  Status s = input_.ReadNBytes(bytes, result, &bytes_read);
+  offset_ += bytes_read;
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Unexpected end of the spill file.");
+  }
+  return s;
+}
+
+Status SpillFileReader::SkipPadding() {
+  int64 padding_bytes = PaddingBytes(offset_);
+  TF_RETURN_IF_ERROR(input_.SkipNBytes(padding_bytes));
+  offset_ += padding_bytes;
+  return Status::OK();
+}
+
+Status SpillFileReader::ReadNext(std::vector<Tensor>* element,
+                                 bool* end_of_sequence) {
+  char buffer[kComponentHeaderBytes];
+  size_t bytes_read;
+  Status s = input_.ReadNBytes(kElementHeaderBytes, buffer, &bytes_read);
+  offset_ += bytes_read;
+  if (errors::IsOutOfRange(s) && bytes_read == 0) {
+    *end_of_sequence = true;
+    return Status::OK();
+  }
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Unexpected end of the spill file.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  *end_of_sequence = false;
+  const uint64 num_components = core::DecodeFixed64(buffer);
+  element->clear();
+  element->reserve(num_components);
+  for (uint64 i = 0; i < num_components; ++i) {
+    TF_RETURN_IF_ERROR(Read(kComponentHeaderBytes, buffer));
+    const DataType dtype = static_cast<DataType>(core::DecodeFixed32(buffer));
+    const uint32 rank = core::DecodeFixed32(buffer + sizeof(uint32));
+    const uint64 num_bytes = core::DecodeFixed64(buffer + 2 * sizeof(uint32));
+    TensorShape shape;
+    for (uint32 j = 0; j < rank; ++j) {
+      char dim[sizeof(uint64)];
+      TF_RETURN_IF_ERROR(Read(sizeof(dim), dim));
+      shape.AddDim(core::DecodeFixed64(dim));
+    }
+    TF_RETURN_IF_ERROR(SkipPadding());
+    if (DataTypeCanUseMemcpy(dtype)) {
+      element->emplace_back(dtype, shape);
+      StringPiece data = element->back().tensor_data();
+      if (data.size() != num_bytes) {
+        return errors::DataLoss("Corrupted tensor of shape ",
+                                shape.DebugString(), " in the spill file.");
+      }
+      if (num_bytes > 0) {
+        TF_RETURN_IF_ERROR(Read(num_bytes, const_cast<char*>(data.data())));
+      }
+    } else {
+      string serialized(num_bytes, '\0');
+      TF_RETURN_IF_ERROR(Read(num_bytes, &serialized[0]));
+      TensorProto proto;
+      element->emplace_back();
+      if (!proto.ParseFromString(serialized) ||
+          !element->back().FromProto(proto)) {
+        return errors::DataLoss("Corrupted ", DataTypeString(dtype),
+                                " tensor in the spill file.");
+      }
+    }
+  }
+  return Status::OK();
+}
+
+SpillingCache::SpillingCache(Env* env, string filename, int64 memory_budget)
+    : env_(env),
+      filename_(std::move(filename)),
+      memory_budget_(memory_budget) {}
+
+SpillingCache::~SpillingCache() {
+  if (!spill_filename_.empty()) {
+    Status s = env_->DeleteFile(spill_filename_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete spill file " << spill_filename_ << ": "
+                   << s;
+    }
+  }
+}
+
+string SpillingCache::NewSpillFilename() {
+  mutex_lock l(mu_);
+  return strings::StrCat(filename_, "_", num_writers_++, ".spill");
+}
+
+void SpillingCache::Complete(std::vector<std::vector<Tensor>>&& memory_elements,
+                             const string& spill_filename, int64 num_spilled) {
+  mutex_lock l(mu_);
+  if (!completed_) {
+    memory_elements_ = std::move(memory_elements);
+    if (num_spilled > 0) {
+      spill_filename_ = spill_filename;
+      num_spilled_ = num_spilled;
+    }
+    completed_ = true;
+    return;
+  }
+  if (num_spilled > 0) {
+    Status s = env_->DeleteFile(spill_filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete spill file " << spill_filename << ": "
+                   << s;
+    }
+  }
+}
+
+bool SpillingCache::IsCompleted() {
+  tf_shared_lock l(mu_);
+  return completed_;
+}
+
+const std::vector<Tensor>& SpillingCache::at(int64 index) {
+  tf_shared_lock l(mu_);
+  DCHECK(index < memory_elements_.size());
+  return memory_elements_[index];
+}
+
+size_t SpillingCache::memory_size() {
+  tf_shared_lock l(mu_);
+  return memory_elements_.size();
+}
+
+int64 SpillingCache::num_spilled() {
+  tf_shared_lock l(mu_);
+  return num_spilled_;
+}
+
+string SpillingCache::spill_filename() {
+  tf_shared_lock l(mu_);
+  return spill_filename_;
+}
+
+}  // namespace data
+}  // namespace tensorflow
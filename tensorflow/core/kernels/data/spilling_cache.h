@@ -0,0 +1,139 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_SPILLING_CACHE_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_SPILLING_CACHE_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Alignment, in bytes, of the tensor buffers within a spill file.
+constexpr int64 kSpillFileAlignment = 64;
+
+// Writes dataset elements to a spill file, in a streaming layout.
+//
+// Each element is a header with the number of its components, followed by
+// the components. Each component is a header with its dtype, shape and size,
+// followed by its bytes. The bytes of memcpy-able tensors are the tensor
+// buffer, which starts at a multiple of `kSpillFileAlignment`, so that the file
+// can be memory-mapped. Other tensors are stored as a serialized `TensorProto`.
+class SpillFileWriter {
+ public:
+  // Creates a new spill file, replacing any existing file at `filename`.
+  static Status Create(Env* env, const string& filename,
+                       std::unique_ptr<SpillFileWriter>* out);
+
+  // Appends an element to the file.
+  Status Append(const std::vector<Tensor>& element);
+
+  // Flushes and closes the file.
+  Status Close();
+
+ private:
+  explicit SpillFileWriter(std::unique_ptr<WritableFile> file);
+
+  Status Write(StringPiece data);
+  Status WritePadding();
+
+  std::unique_ptr<WritableFile> file_;
+  int64 offset_ = 0;
+};
+
+// Reads the elements of a spill file in order, with buffered sequential reads.
+class SpillFileReader {
+ public:
+  static Status Create(Env* env, const string& filename, int64 buffer_bytes,
+                       std::unique_ptr<SpillFileReader>* out);
+
+  // Reads the next element, or sets `end_of_sequence` at the end of the file.
+  Status ReadNext(std::vector<Tensor>* element, bool* end_of_sequence);
+
+ private:
+  SpillFileReader(std::unique_ptr<RandomAccessFile> file, int64 buffer_bytes);
+
+  Status Read(int64 bytes, char* result);
+  Status SkipPadding();
+
+  const std::unique_ptr<RandomAccessFile> file_;
+  io::InputBuffer input_;
+  int64 offset_ = 0;
+};
+
+// A thread-safe cache of dataset elements with a memory budget.
+//
+// The expected use is that a single writer iterator keeps the leading
+// elements of the dataset in memory for as long as they fit in
+// `memory_budget` bytes, and writes the remaining elements to a spill file
+// with a `SpillFileWriter`. Once all elements are cached, reader iterators
+// serve the in-memory prefix, followed by the elements of the spill file.
+class SpillingCache {
+ public:
+  SpillingCache(Env* env, string filename, int64 memory_budget);
+
+  // Deletes the spill file of the cache.
+  ~SpillingCache();
+
+  int64 memory_budget() const { return memory_budget_; }
+
+  // Returns a name for the spill file of a new writer, which no other writer
+  // of this cache uses.
+  string NewSpillFilename();
+
+  // Marks the cache as completed, with `memory_elements` in memory, followed
+  // by `num_spilled` elements in the spill file `spill_filename`. If the cache
+  // is already completed, the spill file is deleted instead.
+  void Complete(std::vector<std::vector<Tensor>>&& memory_elements,
+                const string& spill_filename, int64 num_spilled);
+
+  // Returns whether the cache is completed.
+  bool IsCompleted();
+
+  // Returns the in-memory element at the given index.
+  const std::vector<Tensor>& at(int64 index);
+
+  // Returns the number of elements in memory.
+  size_t memory_size();
+
+  // Returns the number of elements in the spill file.
+  int64 num_spilled();
+
+  // Returns the name of the spill file, if any elements were spilled.
+  string spill_filename();
+
+ private:
+  Env* const env_;
+  const string filename_;
+  const int64 memory_budget_;
+  mutex mu_;
+  int64 num_writers_ TF_GUARDED_BY(mu_) = 0;
+  bool completed_ TF_GUARDED_BY(mu_) = false;
+  std::vector<std::vector<Tensor>> memory_elements_ TF_GUARDED_BY(mu_);
+  string spill_filename_ TF_GUARDED_BY(mu_);
+  int64 num_spilled_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_SPILLING_CACHE_H_
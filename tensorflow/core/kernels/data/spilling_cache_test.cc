@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/spilling_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64 kBufferBytes = 1024;
+
+TEST(SpillFileTest, WriteAndRead) {
+  const string filename = io::JoinPath(testing::TmpDir(), "WriteAndRead");
+  std::unique_ptr<SpillFileWriter> writer;
+  TF_ASSERT_OK(SpillFileWriter::Create(Env::Default(), filename, &writer));
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(writer->Append(
+        {test::AsScalar<int64>(i), test::AsTensor<float>({1, 2, 3}, {3, 1}),
+         test::AsTensor<tstring>({"a", "bc"}, {2}),
+         Tensor(DT_INT32, TensorShape({0}))}));
+  }
+  TF_ASSERT_OK(writer->Append({}));
+  TF_ASSERT_OK(writer->Close());
+
+  std::unique_ptr<SpillFileReader> reader;
+  TF_ASSERT_OK(SpillFileReader::Create(Env::Default(), filename, kBufferBytes,
+                                       &reader));
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  for (int64 i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(reader->ReadNext(&element, &end_of_sequence));
+    ASSERT_FALSE(end_of_sequence);
+    ASSERT_EQ(element.size(), 4);
+    test::ExpectTensorEqual<int64>(element[0], test::AsScalar<int64>(i));
+    test::ExpectTensorEqual<float>(element[1],
+                                   test::AsTensor<float>({1, 2, 3}, {3, 1}));
+    test::ExpectTensorEqual<tstring>(element[2],
+                                     test::AsTensor<tstring>({"a", "bc"}, {2}));
+    EXPECT_EQ(element[3].shape(), TensorShape({0}));
+  }
+  TF_ASSERT_OK(reader->ReadNext(&element, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  EXPECT_TRUE(element.empty());
+  TF_ASSERT_OK(reader->ReadNext(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(SpillFileTest, BuffersAreAligned) {
+  const string filename = io::JoinPath(testing::TmpDir(), "BuffersAreAligned");
+  std::unique_ptr<SpillFileWriter> writer;
+  TF_ASSERT_OK(SpillFileWriter::Create(Env::Default(), filename, &writer));
+  TF_ASSERT_OK(writer->Append({test::AsScalar<int8>(1)}));
+  TF_ASSERT_OK(writer->Append({test::AsScalar<int8>(2)}));
+  TF_ASSERT_OK(writer->Close());
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  // Each one-byte buffer starts at the next multiple of the alignment.
+  ASSERT_EQ(contents.size(), 2 * kSpillFileAlignment + 1);
+  EXPECT_EQ(contents[kSpillFileAlignment], 1);
+  EXPECT_EQ(contents[2 * kSpillFileAlignment], 2);
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(SpillFileTest, TruncatedFile) {
+  const string filename = io::JoinPath(testing::TmpDir(), "TruncatedFile");
+  std::unique_ptr<SpillFileWriter> writer;
+  TF_ASSERT_OK(SpillFileWriter::Create(Env::Default(), filename, &writer));
+  TF_ASSERT_OK(writer->Append({test::AsTensor<int64>({1, 2, 3}, {3})}));
+  TF_ASSERT_OK(writer->Close());
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+  contents.resize(contents.size() - 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, contents));
+
+  std::unique_ptr<SpillFileReader> reader;
+  TF_ASSERT_OK(SpillFileReader::Create(Env::Default(), filename, kBufferBytes,
+                                       &reader));
+  std::vector<Tensor> element;
+  bool end_of_sequence;
+  Status s = reader->ReadNext(&element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+  TF_ASSERT_OK(Env::Default()->DeleteFile(filename));
+}
+
+TEST(SpillingCacheTest, FirstWriterCompletesTheCache) {
+  const string prefix =
+      io::JoinPath(testing::TmpDir(), "FirstWriterCompletesTheCache");
+  auto cache = absl::make_unique<SpillingCache>(Env::Default(), prefix,
+                                                /*memory_budget=*/1024);
+  const string first_filename = cache->NewSpillFilename();
+  const string second_filename = cache->NewSpillFilename();
+  EXPECT_NE(first_filename, second_filename);
+  for (const string& filename : {first_filename, second_filename}) {
+    std::unique_ptr<SpillFileWriter> writer;
+    TF_ASSERT_OK(SpillFileWriter::Create(Env::Default(), filename, &writer));
+    TF_ASSERT_OK(writer->Append({test::AsScalar<int64>(1)}));
+    TF_ASSERT_OK(writer->Close());
+  }
+
+  EXPECT_FALSE(cache->IsCompleted());
+  cache->Complete({{test::AsScalar<int64>(0)}}, first_filename,
+                  /*num_spilled=*/1);
+  // The second writer loses the race, so its spill file is deleted.
+  cache->Complete({}, second_filename, /*num_spilled=*/1);
+  EXPECT_TRUE(cache->IsCompleted());
+  EXPECT_EQ(cache->memory_size(), 1);
+  test::ExpectTensorEqual<int64>(cache->at(0)[0], test::AsScalar<int64>(0));
+  EXPECT_EQ(cache->num_spilled(), 1);
+  EXPECT_EQ(cache->spill_filename(), first_filename);
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(second_filename)));
+
+  // The cache deletes its spill file.
+  cache.reset();
+  EXPECT_TRUE(errors::IsNotFound(Env::Default()->FileExists(first_filename)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -69,6 +69,21 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
 
   int64 Cardinality() const override { return tensors_[0].dim_size(0); }
 
+  Status RandomAccessNumElements(IteratorContext* ctx,
+                                 int64* num_elements) const override {
+    *num_elements = Cardinality();
+    return Status::OK();
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    if (index < 0 || index >= Cardinality()) {
+      return errors::OutOfRange("Index out of range [0, ", Cardinality(),
+                                "): ", index);
+    }
+    return GetSlice(ctx, index, out_tensors);
+  }
+
   Status CheckExternalState() const override { return Status::OK(); }
 
  protected:
@@ -95,6 +110,20 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
     return Status::OK();
   }
 
+ private:
+  Status GetSlice(IteratorContext* ctx, int64 index,
+                  std::vector<Tensor>* out_tensors) const {
+    out_tensors->clear();
+    out_tensors->reserve(tensors_.size());
+    for (size_t i = 0; i < tensors_.size(); ++i) {
+      const Tensor& t = tensors_[i];
+      out_tensors->emplace_back(ctx->allocator({}), t.dtype(), shapes_[i]);
+      TF_RETURN_IF_ERROR(
+          batch_util::CopySliceToElement(t, &out_tensors->back(), index));
+    }
+    return Status::OK();
+  }
+
  private:
   class Iterator : public DatasetIterator<Dataset> {
    public:
@@ -117,15 +146,7 @@ class TensorSliceDatasetOp::Dataset : public DatasetBase {
           return Status::OK();
         }
       }
-      out_tensors->clear();
-      out_tensors->reserve(dataset()->tensors_.size());
-      for (size_t i = 0; i < dataset()->tensors_.size(); ++i) {
-        const Tensor& t = dataset()->tensors_[i];
-        out_tensors->emplace_back(ctx->allocator({}), t.dtype(),
-                                  dataset()->shapes_[i]);
-        TF_RETURN_IF_ERROR(
-            batch_util::CopySliceToElement(t, &out_tensors->back(), index));
-      }
+      TF_RETURN_IF_ERROR(dataset()->GetSlice(ctx, index, out_tensors));
       *end_of_sequence = false;
       return Status::OK();
     }
@@ -19,11 +19,14 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
+#include "tensorflow/core/lib/io/compression.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -53,10 +56,12 @@ bool is_cloud_tpu_gcs_fs() {
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   bool use_mmap)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
+        use_mmap_(use_mmap),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)) {
     if (buffer_size > 0) {
@@ -201,6 +206,19 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+      if (dataset()->use_mmap_) {
+        // Records are then checksummed and copied straight from the mapping.
+        // Files that cannot be mapped, e.g. empty ones, are read instead.
+        Status s =
+            env->NewReadOnlyMemoryRegionFromFile(next_filename, &region_);
+        if (s.ok()) {
+          reader_ =
+              absl::make_unique<io::SequentialRecordReader>(region_.get());
+          return Status::OK();
+        }
+        VLOG(2) << "Reading " << next_filename
+                << " instead of mapping it: " << s;
+      }
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
@@ -211,19 +229,23 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      region_.reset();
     }
 
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
-    // `reader_` will borrow the object that `file_` points to, so
-    // we must destroy `reader_` before `file_`.
+    // `reader_` will borrow the object that `file_` or `region_` points to,
+    // so we must destroy `reader_` before them.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
+  // Whether uncompressed local files are memory-mapped rather than read.
+  const bool use_mmap_;
   io::RecordReaderOptions options_;
 };
 
@@ -240,6 +262,7 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
 
   bool is_gcs_fs = true;
   bool is_s3_fs = true;
+  bool is_local_fs = true;
   std::vector<string> filenames;
   filenames.reserve(filenames_tensor->NumElements());
   for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
@@ -247,6 +270,9 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     filenames.push_back(filenames_tensor->flat<tstring>()(i));
     is_gcs_fs &= absl::StartsWith(filenames[i], kGcsFsPrefix);
     is_s3_fs &= absl::StartsWith(filenames[i], kS3FsPrefix);
+    StringPiece scheme, host, path;
+    io::ParseURI(filenames[i], &scheme, &host, &path);
+    is_local_fs &= scheme.empty() || scheme == "file";
   }
 
   tstring compression_type;
@@ -275,8 +301,17 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kS3BlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  // Memory-mapping local files avoids copying every record through a buffered
+  // input stream. It is opt-in, since a file that is truncated while it is
+  // mapped makes the reads of its mapping crash the process.
+  bool use_mmap = false;
+  OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_RECORD_DATASET_USE_MMAP",
+                                         /*default_val=*/false, &use_mmap));
+  use_mmap &= is_local_fs && (compression_type.empty() ||
+                              compression_type == io::compression::kNone);
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, use_mmap);
 }
 
 namespace {
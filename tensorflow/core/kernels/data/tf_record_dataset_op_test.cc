@@ -225,6 +225,40 @@ IteratorSaveAndRestoreTestCases() {
 ITERATOR_SAVE_AND_RESTORE_TEST_P(TFRecordDatasetOpTest, TFRecordDatasetParams,
                                  IteratorSaveAndRestoreTestCases())
 
+// Test case 4: uncompressed files read through a memory mapping, one of which
+// is empty and cannot be mapped.
+TFRecordDatasetParams MemoryMappedTFRecordDatasetParams() {
+  std::vector<tstring> filenames = {
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_1"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_2"),
+      absl::StrCat(testing::TmpDir(), "/tf_record_MMAP_3")};
+  std::vector<std::vector<string>> contents = {
+      {"1", "22", "333"}, {}, {"a", "bb", "ccc"}};
+  CompressionType compression_type = CompressionType::UNCOMPRESSED;
+  if (!CreateTestFiles(filenames, contents, compression_type).ok()) {
+    VLOG(WARNING) << "Failed to create the test files: "
+                  << absl::StrJoin(filenames, ", ");
+  }
+  return TFRecordDatasetParams(filenames,
+                               /*compression_type=*/compression_type,
+                               /*buffer_size=*/10,
+                               /*node_name=*/kNodeName);
+}
+
+TEST_F(TFRecordDatasetOpTest, MemoryMappedFiles) {
+  setenv("TF_RECORD_DATASET_USE_MMAP", "1", /*overwrite=*/1);
+  auto dataset_params = MemoryMappedTFRecordDatasetParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  unsetenv("TF_RECORD_DATASET_USE_MMAP");
+  std::vector<Tensor> expected_outputs = CreateTensors<tstring>(
+      TensorShape({}), {{"1"}, {"22"}, {"333"}, {"a"}, {"bb"}, {"ccc"}});
+  TF_ASSERT_OK(CheckIteratorGetNext(expected_outputs, /*compare_order=*/true));
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(dataset_params.iterator_prefix(),
+                                           expected_outputs,
+                                           /*breakpoints=*/{0, 2, 4, 7},
+                                           /*compare_order=*/true));
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
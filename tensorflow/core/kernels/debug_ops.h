@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DEBUG_OPS_H_
 
+#include <atomic>
 #include <numeric>
 
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
@@ -39,6 +40,8 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/util/debug_events_writer.h"
 
@@ -133,9 +136,28 @@ class BaseDebugOp : public OpKernel {
  public:
   explicit BaseDebugOp(const string& debug_op_name,
                        OpKernelConstruction* context)
-      : OpKernel(context), debug_op_name_(debug_op_name) {
+      : OpKernel(context),
+        debug_op_name_(debug_op_name),
+        philox_(random::New64()),
+        rng_(&philox_) {
     OP_REQUIRES_OK(context, context->GetAttr("debug_urls", &debug_urls_));
     OP_REQUIRES_OK(context, context->GetAttr("gated_grpc", &gated_grpc_));
+    if (context->HasAttr("sample_stride")) {
+      OP_REQUIRES_OK(context,
+                     context->GetAttr("sample_stride", &sample_stride_));
+      OP_REQUIRES(context, sample_stride_ >= 1,
+                  errors::InvalidArgument("sample_stride must be >= 1, got ",
+                                          sample_stride_));
+    }
+    if (context->HasAttr("sample_probability")) {
+      OP_REQUIRES_OK(context, context->GetAttr("sample_probability",
+                                               &sample_probability_));
+      OP_REQUIRES(context,
+                  sample_probability_ >= 0.0f && sample_probability_ <= 1.0f,
+                  errors::InvalidArgument(
+                      "sample_probability must be in [0, 1], got ",
+                      sample_probability_));
+    }
 
     string device_name;
     string tensor_name;
@@ -175,19 +197,42 @@ class BaseDebugOp : public OpKernel {
                            debug_watch_key_->debug_node_name, debug_urls_)) {
       // The entire node is gated off: Output an empty tensor and avoid
       // expensive computation.
-      Tensor* output_tensor;
-      TensorShape shape({0});
-      if (!context->allocate_output(0, shape, &output_tensor).ok()) {
-        LOG(ERROR) << "Debug node of watch key "
-                   << debug_watch_key_->debug_node_name
-                   << " failed to allocate empty tensor under gated-off state.";
-      }
+      AllocateEmptyOutput(context);
       return false;
     } else {
       return true;
     }
   }
 
+  // Apply sampling (if the sample_stride or sample_probability attributes are
+  // set on the debug op, e.g., "DebugNumericSummary(sample_stride=100)").
+  //
+  // Only every sample_stride-th execution of the debug op is a candidate,
+  // and each candidate is taken with probability sample_probability. Returns
+  // false for executions that are not taken, in which case the debug op
+  // emits an empty tensor as if it were gated off.
+  bool ApplySampling(OpKernelContext* context) {
+    if (sample_stride_ > 1 &&
+        num_executions_.fetch_add(1, std::memory_order_relaxed) %
+                sample_stride_ !=
+            0) {
+      AllocateEmptyOutput(context);
+      return false;
+    }
+    if (sample_probability_ < 1.0f) {
+      float r;
+      {
+        mutex_lock l(rng_mu_);
+        r = rng_.RandFloat();
+      }
+      if (r >= sample_probability_) {
+        AllocateEmptyOutput(context);
+        return false;
+      }
+    }
+    return true;
+  }
+
   // Publish a tensor to all debug URLs of the debug op.
   // Log an error if the publishing failed.
   Status PublishTensor(const Tensor& tensor) {
@@ -209,10 +254,27 @@ class BaseDebugOp : public OpKernel {
   }
 
  private:
+  void AllocateEmptyOutput(OpKernelContext* context) {
+    Tensor* output_tensor;
+    TensorShape shape({0});
+    if (!context->allocate_output(0, shape, &output_tensor).ok()) {
+      LOG(ERROR) << "Debug node of watch key "
+                 << debug_watch_key_->debug_node_name
+                 << " failed to allocate empty tensor under gated-off state.";
+    }
+  }
+
   const string debug_op_name_;
   std::unique_ptr<DebugNodeKey> debug_watch_key_;
   std::vector<string> debug_urls_;
   bool gated_grpc_;
+
+  int64 sample_stride_ = 1;
+  float sample_probability_ = 1.0f;
+  std::atomic<int64> num_executions_{0};
+  mutex rng_mu_;
+  random::PhiloxRandom philox_ TF_GUARDED_BY(rng_mu_);
+  random::SimplePhilox rng_ TF_GUARDED_BY(rng_mu_);
 };
 
 // Identity op for debugging.
@@ -225,7 +287,7 @@ class DebugIdentityOp : public BaseDebugOp {
       : BaseDebugOp("DebugIdentity", context) {}
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplyGrpcGating(context) || !ApplySampling(context)) {
       return;
     }
 
@@ -242,7 +304,7 @@ class DebugNanCountOp : public BaseDebugOp {
       : BaseDebugOp("DebugNanCount", context) {}
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplyGrpcGating(context) || !ApplySampling(context)) {
       return;
     }
 
@@ -285,7 +347,7 @@ class DebugNumericSummaryOp : public BaseDebugOp {
   }
 
   void Compute(OpKernelContext* context) override {
-    if (!ApplyGrpcGating(context)) {
+    if (!ApplyGrpcGating(context) || !ApplySampling(context)) {
       return;
     }
 
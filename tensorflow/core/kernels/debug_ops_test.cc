@@ -175,6 +175,44 @@ TEST_F(DebugIdentityOpTest, StringSuccess) {
   test::ExpectTensorEqual<tstring>(expected, *GetOutput(0));
 }
 
+TEST_F(DebugIdentityOpTest, SampleStride) {
+  TF_CHECK_OK(NodeDefBuilder("op", "DebugIdentity")
+                  .Input(FakeInput(DT_INT32))
+                  .Attr("tensor_name", "FakeTensor:0")
+                  .Attr("sample_stride", 3)
+                  .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<int32>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  for (int i = 0; i < 7; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+    // Executions that are not sampled output an empty tensor.
+    EXPECT_EQ(GetOutput(0)->NumElements(), i % 3 == 0 ? 6 : 0) << i;
+  }
+}
+
+TEST_F(DebugIdentityOpTest, SampleProbabilityZero) {
+  TF_CHECK_OK(NodeDefBuilder("op", "DebugIdentity")
+                  .Input(FakeInput(DT_INT32))
+                  .Attr("tensor_name", "FakeTensor:0")
+                  .Attr("sample_probability", 0.0f)
+                  .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<int32>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+    EXPECT_EQ(GetOutput(0)->NumElements(), 0);
+  }
+}
+
+TEST_F(DebugIdentityOpTest, InvalidSampleStride) {
+  TF_CHECK_OK(NodeDefBuilder("op", "DebugIdentity")
+                  .Input(FakeInput(DT_INT32))
+                  .Attr("tensor_name", "FakeTensor:0")
+                  .Attr("sample_stride", 0)
+                  .Finalize(node_def()));
+  EXPECT_TRUE(errors::IsInvalidArgument(InitOp()));
+}
+
 // Tests for DebugNanCountOp
 class DebugNanCountOpTest : public OpsTestBase {
  protected:
@@ -0,0 +1,194 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/image_resizer_state.h"
+#include "tensorflow/core/kernels/resize_bilinear_op.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest libjpeg scaling denominator that decodes an image of
+// size "width" x "height" to at least "out_width" x "out_height".  libjpeg
+// rounds the scaled sizes up.
+int ChooseRatio(int width, int height, int out_width, int out_height) {
+  for (int ratio = 8; ratio > 1; ratio /= 2) {
+    if ((width + ratio - 1) / ratio >= out_width &&
+        (height + ratio - 1) / ratio >= out_height) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+}  // namespace
+
+// Decodes a batch of JPEG images and resizes them bilinearly to a common
+// size.  Each image is decoded at the smallest libjpeg scale that is at least
+// as large as the output, so that the DCT does most of the downsampling and
+// the resize runs on a smaller image.  The images are sharded over the CPU
+// worker threads.
+class DecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    // As in DecodeJpeg, the default sacrifices image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be a vector, got shape ",
+                                        contents.shape().DebugString()));
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsVector(size.shape()) && size.dim_size(0) == 2,
+        errors::InvalidArgument("size must be 1-D with 2 elements, got shape ",
+                                size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got [",
+                                        out_height, ", ", out_width, "]"));
+
+    const int64 batch_size = contents.dim_size(0);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    static_cast<int64>(channels_)}),
+                       &output));
+    if (batch_size == 0) return;
+
+    const auto inputs = contents.vec<tstring>();
+    typename TTypes<float, 4>::Tensor output_data = output->tensor<float, 4>();
+    const int64 image_size =
+        static_cast<int64>(out_height) * out_width * channels_;
+
+    mutex mu;
+    Status status;
+    auto decode_and_resize = [&](int64 start, int64 limit) {
+      std::vector<uint8> decoded;
+      for (int64 i = start; i < limit; ++i) {
+        const Status s = DecodeAndResize(inputs(i), out_height, out_width,
+                                         &decoded,
+                                         output_data.data() + i * image_size);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          status.Update(s);
+          return;
+        }
+      }
+    };
+
+    // Decoding costs roughly a few cycles per compressed byte, and the
+    // resize a few per output value.
+    int64 input_bytes = 0;
+    for (int64 i = 0; i < batch_size; ++i) input_bytes += inputs(i).size();
+    const int64 cost_per_image = 50 * (input_bytes / batch_size) +
+                                 10 * image_size;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_image, decode_and_resize);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  // Decodes "input" into "decoded" and resizes it to "out_height" x
+  // "out_width" into "output".
+  Status DecodeAndResize(StringPiece input, int out_height, int out_width,
+                         std::vector<uint8>* decoded, float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG contents are too large for int: ",
+                                     input.size());
+    }
+    int width, height;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data, data size ",
+                                     input.size());
+    }
+
+    // Use a local copy of the flags, which are shared among invocations.
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ChooseRatio(width, height, out_width, out_height);
+    int in_width = 0, in_height = 0;
+    if (!jpeg::Uncompress(input.data(), input.size(), flags,
+                          nullptr /* nwarn */,
+                          [&](int w, int h, int channels) -> uint8* {
+                            in_width = w;
+                            in_height = h;
+                            decoded->resize(static_cast<size_t>(w) * h *
+                                            channels);
+                            return decoded->data();
+                          })) {
+      return errors::InvalidArgument("Invalid JPEG data, data size ",
+                                     input.size());
+    }
+
+    typename TTypes<uint8, 4>::ConstTensor image(decoded->data(), 1,
+                                                 in_height, in_width,
+                                                 channels_);
+    typename TTypes<float, 4>::Tensor resized(output, 1, out_height, out_width,
+                                              channels_);
+    ResizeBilinearCpu<uint8>(
+        image, CalculateResizeScale(in_height, out_height, false),
+        CalculateResizeScale(in_width, out_width, false),
+        true /* half_pixel_centers */, resized);
+    return Status::OK();
+  }
+
+  int channels_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        DecodeAndResizeJpegOp);
+
+}  // namespace tensorflow
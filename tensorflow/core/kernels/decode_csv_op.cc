@@ -14,13 +14,19 @@ limitations under the License.
 ==============================================================================*/
 
 // See docs in ../ops/parsing_ops.cc.
+#include <memory>
 #include <vector>
+
+#include "absl/memory/memory.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/csv_utils.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -51,6 +57,8 @@ class DecodeCSVOp : public OpKernel {
                 errors::InvalidArgument("field_delim should be only 1 char"));
     delim_ = delim[0];
     OP_REQUIRES_OK(ctx, ctx->GetAttr("na_value", &na_value_));
+    scanner_ = absl::make_unique<csv_utils::FieldScanner>(delim_,
+                                                          use_quote_delim_);
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -76,220 +84,252 @@ class DecodeCSVOp : public OpKernel {
     OpOutputList output;
     OP_REQUIRES_OK(ctx, ctx->output_list("output", &output));
 
+    std::vector<Tensor*> outputs(out_type_.size());
     for (int i = 0; i < static_cast<int>(out_type_.size()); ++i) {
-      Tensor* out = nullptr;
-      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &out));
+      OP_REQUIRES_OK(ctx, output.allocate(i, records->shape(), &outputs[i]));
     }
 
+    // Records are independent, so they are decoded in parallel, and every
+    // field is parsed straight from the record into its output.
+    mutex mu;
+    int64 first_error_record = records_size;
+    Status first_error;
+    auto decode_records = [&](int64 start, int64 limit) {
+      std::vector<Field> fields;
+      for (int64 i = start; i < limit; ++i) {
+        Status s = DecodeRecord(records_t(i), i, record_defaults, outputs,
+                                &fields);
+        if (!s.ok()) {
+          // Report the error of the first bad record, as a sequential decoder
+          // would.
+          mutex_lock l(mu);
+          if (i < first_error_record) {
+            first_error_record = i;
+            first_error = s;
+          }
+          return;
+        }
+      }
+    };
+    int64 total_bytes = 0;
     for (int64 i = 0; i < records_size; ++i) {
-      const StringPiece record(records_t(i));
-      std::vector<string> fields;
-      ExtractFields(ctx, record, &fields);
-      OP_REQUIRES(ctx, fields.size() == out_type_.size(),
-                  errors::InvalidArgument("Expect ", out_type_.size(),
-                                          " fields but have ", fields.size(),
-                                          " in record ", i));
+      total_bytes += records_t(i).size();
+    }
+    const int64 cost_per_record =
+        kCostPerByte * (records_size > 0 ? total_bytes / records_size : 0) +
+        kCostPerField * out_type_.size();
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, records_size,
+          cost_per_record, decode_records);
+    OP_REQUIRES_OK(ctx, first_error);
+  }
+
+ private:
+  // The approximate number of cycles spent on every byte and every field of
+  // a record, used to shard the records between threads.
+  static constexpr int64 kCostPerByte = 4;
+  static constexpr int64 kCostPerField = 50;
 
-      // Check each field in the record
-      for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
-        const DataType& dtype = out_type_[f];
-        switch (dtype) {
-          case DT_INT32: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+  // A field of a record. Most fields are a piece of the record; only quoted
+  // fields with escaped quotes need their own unescaped copy.
+  struct Field {
+    StringPiece piece;
+    string unescaped;
+    bool is_unescaped = false;
 
-              output[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
-            } else {
-              int32 value;
-              OP_REQUIRES(ctx, strings::safe_strto32(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int32: ", fields[f]));
-              output[f]->flat<int32>()(i) = value;
-            }
-            break;
-          }
-          case DT_INT64: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
+    StringPiece value() const {
+      return is_unescaped ? StringPiece(unescaped) : piece;
+    }
+  };
 
-              output[f]->flat<int64>()(i) = record_defaults[f].flat<int64>()(0);
-            } else {
-              int64 value;
-              OP_REQUIRES(ctx, strings::safe_strto64(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid int64: ", fields[f]));
-              output[f]->flat<int64>()(i) = value;
+  std::vector<DataType> out_type_;
+  std::vector<int64> select_cols_;
+  char delim_;
+  bool use_quote_delim_;
+  bool select_all_cols_;
+  string na_value_;
+  std::unique_ptr<csv_utils::FieldScanner> scanner_;
+
+  // Decodes the record at index `i` into the outputs. `fields` is scratch
+  // space that is reused between records.
+  Status DecodeRecord(StringPiece record, int64 i,
+                      const OpInputList& record_defaults,
+                      const std::vector<Tensor*>& outputs,
+                      std::vector<Field>* fields) const {
+    fields->clear();
+    TF_RETURN_IF_ERROR(ExtractFields(record, fields));
+    if (fields->size() != out_type_.size()) {
+      return errors::InvalidArgument("Expect ", out_type_.size(),
+                                     " fields but have ", fields->size(),
+                                     " in record ", i);
+    }
+
+    // Check each field in the record
+    for (int f = 0; f < static_cast<int>(out_type_.size()); ++f) {
+      const StringPiece field = (*fields)[f].value();
+      // If this field is empty or NA value, check if default is given:
+      // If yes, use default value; Otherwise report error.
+      const bool use_default = field.empty() || field == na_value_;
+      if (use_default && record_defaults[f].NumElements() != 1) {
+        return errors::InvalidArgument("Field ", f,
+                                       " is required but missing in record ",
+                                       i, "!");
+      }
+      switch (out_type_[f]) {
+        case DT_INT32: {
+          if (use_default) {
+            outputs[f]->flat<int32>()(i) = record_defaults[f].flat<int32>()(0);
+          } else {
+            int32 value;
+            if (!strings::safe_strto32(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int32: ", field);
             }
-            break;
+            outputs[f]->flat<int32>()(i) = value;
           }
-          case DT_FLOAT: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
-            } else {
-              float value;
-              OP_REQUIRES(ctx, strings::safe_strtof(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid float: ", fields[f]));
-              output[f]->flat<float>()(i) = value;
+          break;
+        }
+        case DT_INT64: {
+          if (use_default) {
+            outputs[f]->flat<int64>()(i) = record_defaults[f].flat<int64>()(0);
+          } else {
+            int64 value;
+            if (!strings::safe_strto64(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid int64: ", field);
             }
-            break;
+            outputs[f]->flat<int64>()(i) = value;
           }
-          case DT_DOUBLE: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<double>()(i) =
-                  record_defaults[f].flat<double>()(0);
-            } else {
-              double value;
-              OP_REQUIRES(ctx, strings::safe_strtod(fields[f], &value),
-                          errors::InvalidArgument(
-                              "Field ", f, " in record ", i,
-                              " is not a valid double: ", fields[f]));
-              output[f]->flat<double>()(i) = value;
+          break;
+        }
+        case DT_FLOAT: {
+          if (use_default) {
+            outputs[f]->flat<float>()(i) = record_defaults[f].flat<float>()(0);
+          } else {
+            float value;
+            if (!strings::safe_strtof(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid float: ", field);
             }
-            break;
+            outputs[f]->flat<float>()(i) = value;
           }
-          case DT_STRING: {
-            // If this field is empty or NA value, check if default is given:
-            // If yes, use default value; Otherwise report error.
-            if (fields[f].empty() || fields[f] == na_value_) {
-              OP_REQUIRES(ctx, record_defaults[f].NumElements() == 1,
-                          errors::InvalidArgument(
-                              "Field ", f,
-                              " is required but missing in record ", i, "!"));
-              output[f]->flat<tstring>()(i) =
-                  record_defaults[f].flat<tstring>()(0);
-            } else {
-              output[f]->flat<tstring>()(i) = std::move(fields[f]);
+          break;
+        }
+        case DT_DOUBLE: {
+          if (use_default) {
+            outputs[f]->flat<double>()(i) =
+                record_defaults[f].flat<double>()(0);
+          } else {
+            double value;
+            if (!strings::safe_strtod(field, &value)) {
+              return errors::InvalidArgument("Field ", f, " in record ", i,
+                                             " is not a valid double: ",
+                                             field);
             }
-            break;
+            outputs[f]->flat<double>()(i) = value;
+          }
+          break;
+        }
+        case DT_STRING: {
+          if (use_default) {
+            outputs[f]->flat<tstring>()(i) =
+                record_defaults[f].flat<tstring>()(0);
+          } else if ((*fields)[f].is_unescaped) {
+            outputs[f]->flat<tstring>()(i) = std::move((*fields)[f].unescaped);
+          } else {
+            outputs[f]->flat<tstring>()(i).assign(field.data(), field.size());
           }
-          default:
-            OP_REQUIRES(ctx, false,
-                        errors::InvalidArgument("csv: data type ", dtype,
-                                                " not supported in field ", f));
+          break;
         }
+        default:
+          return errors::InvalidArgument("csv: data type ", out_type_[f],
+                                         " not supported in field ", f);
       }
     }
+    return Status::OK();
   }
 
- private:
-  std::vector<DataType> out_type_;
-  std::vector<int64> select_cols_;
-  char delim_;
-  bool use_quote_delim_;
-  bool select_all_cols_;
-  string na_value_;
-
-  void ExtractFields(OpKernelContext* ctx, StringPiece input,
-                     std::vector<string>* result) {
-    int64 current_idx = 0;
+  // Splits `input` into the selected fields. The delimiters of unquoted
+  // fields are found with `scanner_`, and the closing quotes of quoted fields
+  // with `csv_utils::FindQuote`, so bytes inside fields are not visited one
+  // at a time.
+  Status ExtractFields(StringPiece input, std::vector<Field>* result) const {
+    const size_t size = input.size();
+    size_t current_idx = 0;
     int64 num_fields_parsed = 0;
     int64 selector_idx = 0;  // Keep track of index into select_cols
 
-    if (!input.empty()) {
-      while (static_cast<size_t>(current_idx) < input.size()) {
-        if (input[current_idx] == '\n' || input[current_idx] == '\r') {
-          current_idx++;
-          continue;
-        }
+    if (input.empty()) return Status::OK();
 
-        bool quoted = false;
-        bool include =
-            (select_all_cols_ || select_cols_[selector_idx] ==
-                                     static_cast<size_t>(num_fields_parsed));
+    while (current_idx < size) {
+      if (input[current_idx] == '\n' || input[current_idx] == '\r') {
+        current_idx++;
+        continue;
+      }
 
-        if (use_quote_delim_ && input[current_idx] == '"') {
-          quoted = true;
-          current_idx++;
-        }
+      bool include = (select_all_cols_ ||
+                      select_cols_[selector_idx] == num_fields_parsed);
+      Field field;
 
-        // This is the body of the field;
-        string field;
-        if (!quoted) {
-          while (static_cast<size_t>(current_idx) < input.size() &&
-                 input[current_idx] != delim_) {
-            OP_REQUIRES(ctx,
-                        (!use_quote_delim_ || input[current_idx] != '"') &&
-                            input[current_idx] != '\n' &&
-                            input[current_idx] != '\r',
-                        errors::InvalidArgument(
-                            "Unquoted fields cannot have quotes/CRLFs inside"));
-            if (include) field += input[current_idx];
-            current_idx++;
+      if (!use_quote_delim_ || input[current_idx] != '"') {
+        const size_t end =
+            scanner_->FindSpecial(input.data(), current_idx, size);
+        if (end < size && input[end] != delim_) {
+          return errors::InvalidArgument(
+              "Unquoted fields cannot have quotes/CRLFs inside");
+        }
+        field.piece = input.substr(current_idx, end - current_idx);
+        // Go to next field or the end
+        current_idx = end + 1;
+      } else {
+        // Quoted field needs to be ended with '"' and delim or end
+        current_idx++;
+        size_t start = current_idx;
+        while (true) {
+          const size_t quote =
+              csv_utils::FindQuote(input.data(), current_idx, size);
+          if (quote == size) {
+            return errors::InvalidArgument(
+                "Quoted field has to end with quote followed by delim or end");
           }
-
-          // Go to next field or the end
-          current_idx++;
-        } else if (use_quote_delim_) {
-          // Quoted field needs to be ended with '"' and delim or end
-          while (
-              (static_cast<size_t>(current_idx) < input.size() - 1) &&
-              (input[current_idx] != '"' || input[current_idx + 1] != delim_)) {
-            if (input[current_idx] != '"') {
-              if (include) field += input[current_idx];
-              current_idx++;
-            } else {
-              OP_REQUIRES(
-                  ctx, input[current_idx + 1] == '"',
-                  errors::InvalidArgument("Quote inside a string has to be "
-                                          "escaped by another quote"));
-              if (include) field += '"';
-              current_idx += 2;
-            }
+          if (quote == size - 1 || input[quote + 1] == delim_) {
+            current_idx = quote;
+            break;
           }
-
-          OP_REQUIRES(
-              ctx,
-              (static_cast<size_t>(current_idx) < input.size() &&
-               input[current_idx] == '"' &&
-               (static_cast<size_t>(current_idx) == input.size() - 1 ||
-                input[current_idx + 1] == delim_)),
-              errors::InvalidArgument("Quoted field has to end with quote "
-                                      "followed by delim or end"));
-
-          current_idx += 2;
+          if (input[quote + 1] != '"') {
+            return errors::InvalidArgument(
+                "Quote inside a string has to be escaped by another quote");
+          }
+          // An escaped quote: keep the text up to and including the first
+          // quote of the pair.
+          if (include) {
+            field.unescaped.append(input.data() + start, quote + 1 - start);
+            field.is_unescaped = true;
+          }
+          current_idx = quote + 2;
+          start = current_idx;
         }
-
-        num_fields_parsed++;
-        if (include) {
-          result->push_back(field);
-          selector_idx++;
-          if (selector_idx == select_cols_.size()) return;
+        if (field.is_unescaped) {
+          field.unescaped.append(input.data() + start, current_idx - start);
+        } else {
+          field.piece = input.substr(start, current_idx - start);
         }
+        current_idx += 2;
       }
 
-      bool include =
-          (select_all_cols_ || select_cols_[selector_idx] ==
-                                   static_cast<size_t>(num_fields_parsed));
-      // Check if the last field is missing
-      if (include && input[input.size() - 1] == delim_)
-        result->push_back(string());
+      num_fields_parsed++;
+      if (include) {
+        result->push_back(std::move(field));
+        selector_idx++;
+        if (selector_idx == select_cols_.size()) return Status::OK();
+      }
     }
+
+    bool include =
+        (select_all_cols_ || select_cols_[selector_idx] == num_fields_parsed);
+    // Check if the last field is missing
+    if (include && input[size - 1] == delim_) result->emplace_back();
+    return Status::OK();
   }
 };
 
@@ -0,0 +1,324 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_H_
+#define TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_H_
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// How a full DynamicEmbedding picks the row to evict for a new id.
+enum class EmbeddingEvictionPolicy {
+  kLeastRecentlyUsed,
+  kLeastFrequentlyUsed,
+};
+
+// Parses "lru" or "lfu".
+inline Status ParseEmbeddingEvictionPolicy(const string& name,
+                                           EmbeddingEvictionPolicy* policy) {
+  if (name == "lru") {
+    *policy = EmbeddingEvictionPolicy::kLeastRecentlyUsed;
+  } else if (name == "lfu") {
+    *policy = EmbeddingEvictionPolicy::kLeastFrequentlyUsed;
+  } else {
+    return errors::InvalidArgument("Unknown eviction policy '", name,
+                                   "', expected 'lru' or 'lfu'");
+  }
+  return Status::OK();
+}
+
+struct DynamicEmbeddingOptions {
+  int64 embedding_dim = 1;
+  // New rows hold "initial_value", plus normal noise with standard deviation
+  // "initial_stddev" drawn from a generator seeded with "seed".
+  float initial_value = 0;
+  float initial_stddev = 0;
+  int64 seed = 0;
+  // Ids get a row on their "min_frequency"-th lookup.  Lookups of ids without
+  // a row return "initial_value".
+  int64 min_frequency = 1;
+  // Once "max_rows" ids have a row, a row is evicted for each new one.  0
+  // means the number of rows is not bounded.
+  int64 max_rows = 0;
+  EmbeddingEvictionPolicy eviction_policy =
+      EmbeddingEvictionPolicy::kLeastRecentlyUsed;
+};
+
+// An embedding whose rows are allocated for ids as they are looked up, so that
+// its memory scales with the number of live ids instead of the range of ids.
+//
+// Rows are stored in an arena indexed by a hash map from ids.  Ids are only
+// admitted once they were looked up "min_frequency" times, which keeps rare
+// ids from taking rows, and the table evicts the least recently or least
+// frequently used rows once it holds "max_rows" of them.
+template <typename T>
+class DynamicEmbedding : public ResourceBase {
+ public:
+  explicit DynamicEmbedding(const DynamicEmbeddingOptions& options)
+      : options_(options),
+        philox_(options.seed),
+        max_pending_(std::max<int64>(options.max_rows, 1 << 16)) {}
+
+  string DebugString() const override {
+    return strings::StrCat("DynamicEmbedding of ", size(), " rows of ",
+                           options_.embedding_dim);
+  }
+
+  int64 MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(*this) + values_.capacity() * sizeof(T) +
+           rows_info_.capacity() * sizeof(RowInfo) +
+           (rows_.size() + pending_.size()) * 2 * sizeof(int64);
+  }
+
+  const DynamicEmbeddingOptions& options() const { return options_; }
+  int64 embedding_dim() const { return options_.embedding_dim; }
+
+  // The number of ids with a row.
+  int64 size() const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return rows_.size();
+  }
+  int64 SizeLocked() const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return rows_.size();
+  }
+
+  mutex* mu() TF_LOCK_RETURNED(mu_) { return &mu_; }
+
+  // Copies the rows of "ids" to the rows of "values", counting the lookups
+  // towards the admission of ids without a row and allocating the rows of
+  // ids once they are admitted.
+  void Lookup(gtl::ArraySlice<int64> ids, typename TTypes<T>::Matrix values)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    const int64 dim = options_.embedding_dim;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      const T* row = LookupRowLocked(ids[i]);
+      for (int64 j = 0; j < dim; ++j) {
+        values(i, j) = row == nullptr ? T(options_.initial_value) : row[j];
+      }
+    }
+  }
+
+  // Returns the row of "id", or nullptr if "id" has none.  Does not count as
+  // a use of the row.
+  T* FindRowLocked(int64 id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto it = rows_.find(id);
+    return it == rows_.end() ? nullptr : Row(it->second);
+  }
+
+  // Returns the row of "id", allocating it regardless of admission if needed.
+  T* FindOrAllocateRowLocked(int64 id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto it = rows_.find(id);
+    if (it != rows_.end()) return Row(it->second);
+    return Row(AllocateRowLocked(id));
+  }
+
+  // Copies the ids with a row and their rows to "ids" and "values", which
+  // must have size() and size() x embedding_dim() elements.
+  void ExportLocked(typename TTypes<int64>::Flat ids,
+                    typename TTypes<T>::Matrix values)
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    int64 i = 0;
+    for (const auto& id_and_row : rows_) {
+      ids(i) = id_and_row.first;
+      const T* row = Row(id_and_row.second);
+      for (int64 j = 0; j < options_.embedding_dim; ++j) values(i, j) = row[j];
+      ++i;
+    }
+  }
+
+  // Replaces the rows with the rows of "values" for "ids".
+  Status Import(typename TTypes<int64>::ConstFlat ids,
+                typename TTypes<T>::ConstMatrix values) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (options_.max_rows > 0 && ids.size() > options_.max_rows) {
+      return errors::InvalidArgument("Cannot import ", ids.size(),
+                                     " rows into a DynamicEmbedding of at "
+                                     "most ",
+                                     options_.max_rows, " rows");
+    }
+    rows_.clear();
+    pending_.clear();
+    values_.clear();
+    rows_info_.clear();
+    by_frequency_.clear();
+    lru_head_ = lru_tail_ = -1;
+    for (int64 i = 0; i < ids.size(); ++i) {
+      T* row = FindOrAllocateRowLocked(ids(i));
+      for (int64 j = 0; j < options_.embedding_dim; ++j) row[j] = values(i, j);
+    }
+    return Status::OK();
+  }
+
+ private:
+  struct RowInfo {
+    int64 id;
+    int64 frequency;
+    // The neighbours of the row in the recency list, or -1.
+    int64 prev;
+    int64 next;
+  };
+
+  T* Row(int64 row) TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return values_.data() + row * options_.embedding_dim;
+  }
+
+  // Returns the row of "id" after counting the lookup, or nullptr if "id" is
+  // not admitted yet.
+  T* LookupRowLocked(int64 id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto it = rows_.find(id);
+    if (it != rows_.end()) {
+      TouchLocked(it->second);
+      return Row(it->second);
+    }
+    if (options_.min_frequency > 1) {
+      int64& frequency = pending_[id];
+      if (++frequency < options_.min_frequency) {
+        // The counts of ids that are not admitted are dropped once there are
+        // too many of them, which bounds their memory.
+        if (pending_.size() > max_pending_) pending_.clear();
+        return nullptr;
+      }
+      pending_.erase(id);
+    }
+    return Row(AllocateRowLocked(id));
+  }
+
+  void TouchLocked(int64 row) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    RowInfo& info = rows_info_[row];
+    if (options_.eviction_policy ==
+        EmbeddingEvictionPolicy::kLeastFrequentlyUsed) {
+      by_frequency_.erase({info.frequency, row});
+      ++info.frequency;
+      by_frequency_.insert({info.frequency, row});
+    } else {
+      ++info.frequency;
+      UnlinkLocked(row);
+      LinkFrontLocked(row);
+    }
+  }
+
+  void UnlinkLocked(int64 row) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    RowInfo& info = rows_info_[row];
+    if (info.prev >= 0) {
+      rows_info_[info.prev].next = info.next;
+    } else {
+      lru_head_ = info.next;
+    }
+    if (info.next >= 0) {
+      rows_info_[info.next].prev = info.prev;
+    } else {
+      lru_tail_ = info.prev;
+    }
+    info.prev = info.next = -1;
+  }
+
+  void LinkFrontLocked(int64 row) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    RowInfo& info = rows_info_[row];
+    info.prev = -1;
+    info.next = lru_head_;
+    if (lru_head_ >= 0) rows_info_[lru_head_].prev = row;
+    lru_head_ = row;
+    if (lru_tail_ < 0) lru_tail_ = row;
+  }
+
+  // Evicts the least recently or least frequently used row and returns it.
+  int64 EvictLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    int64 row;
+    if (options_.eviction_policy ==
+        EmbeddingEvictionPolicy::kLeastFrequentlyUsed) {
+      row = by_frequency_.begin()->second;
+      by_frequency_.erase(by_frequency_.begin());
+    } else {
+      row = lru_tail_;
+      UnlinkLocked(row);
+    }
+    rows_.erase(rows_info_[row].id);
+    return row;
+  }
+
+  int64 AllocateRowLocked(int64 id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64 dim = options_.embedding_dim;
+    int64 row;
+    if (options_.max_rows > 0 &&
+        static_cast<int64>(rows_.size()) >= options_.max_rows) {
+      row = EvictLocked();
+    } else {
+      row = rows_info_.size();
+      rows_info_.emplace_back();
+      values_.resize(values_.size() + dim);
+    }
+    rows_[id] = row;
+    rows_info_[row] = RowInfo{id, 1, -1, -1};
+    if (options_.eviction_policy ==
+        EmbeddingEvictionPolicy::kLeastFrequentlyUsed) {
+      by_frequency_.insert({1, row});
+    } else {
+      LinkFrontLocked(row);
+    }
+
+    T* values = Row(row);
+    for (int64 j = 0; j < dim; ++j) values[j] = T(options_.initial_value);
+    if (options_.initial_stddev > 0) {
+      random::NormalDistribution<random::PhiloxRandom, float> normal;
+      for (int64 j = 0; j < dim;) {
+        const auto samples = normal(&philox_);
+        for (int k = 0; k < samples.kElementCount && j < dim; ++k, ++j) {
+          values[j] += T(samples[k] * options_.initial_stddev);
+        }
+      }
+    }
+    return row;
+  }
+
+  const DynamicEmbeddingOptions options_;
+
+  mutable mutex mu_;
+  // The row of each admitted id.
+  std::unordered_map<int64, int64> rows_ TF_GUARDED_BY(mu_);
+  // The values of row r are values_[r * dim, (r + 1) * dim).
+  std::vector<T> values_ TF_GUARDED_BY(mu_);
+  std::vector<RowInfo> rows_info_ TF_GUARDED_BY(mu_);
+  // The rows by frequency, for kLeastFrequentlyUsed.
+  std::set<std::pair<int64, int64>> by_frequency_ TF_GUARDED_BY(mu_);
+  // The most and least recently used rows, for kLeastRecentlyUsed.
+  int64 lru_head_ TF_GUARDED_BY(mu_) = -1;
+  int64 lru_tail_ TF_GUARDED_BY(mu_) = -1;
+  // The number of lookups of the ids that are not admitted yet.
+  std::unordered_map<int64, int64> pending_ TF_GUARDED_BY(mu_);
+  random::PhiloxRandom philox_ TF_GUARDED_BY(mu_);
+  const size_t max_pending_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DYNAMIC_EMBEDDING_H_
@@ -0,0 +1,317 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/resource_variable_ops.cc.
+
+#include <memory>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/dynamic_embedding.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+template <typename T>
+class DynamicEmbeddingHandleOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingHandleOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("container", &container_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &name_));
+    if (name_.empty()) name_ = name();
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("embedding_dim", &options_.embedding_dim));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("initial_value", &options_.initial_value));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("initial_stddev", &options_.initial_stddev));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("seed", &options_.seed));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("min_frequency", &options_.min_frequency));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("max_rows", &options_.max_rows));
+    string eviction_policy;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("eviction_policy", &eviction_policy));
+    OP_REQUIRES_OK(ctx, ParseEmbeddingEvictionPolicy(
+                            eviction_policy, &options_.eviction_policy));
+    OP_REQUIRES(ctx, options_.embedding_dim > 0,
+                errors::InvalidArgument("embedding_dim must be positive, got ",
+                                        options_.embedding_dim));
+    OP_REQUIRES(ctx, options_.max_rows >= 0,
+                errors::InvalidArgument("max_rows must not be negative, got ",
+                                        options_.max_rows));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    mutex_lock l(mu_);
+    if (!handle_.IsInitialized()) {
+      AllocatorAttributes attr;
+      attr.set_on_host(true);
+      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_RESOURCE, TensorShape({}),
+                                             &handle_, attr));
+      handle_.scalar<ResourceHandle>()() =
+          MakeResourceHandle<DynamicEmbedding<T>>(ctx, container_, name_);
+    }
+    DynamicEmbedding<T>* embedding;
+    OP_REQUIRES_OK(ctx,
+                   LookupOrCreateResource<DynamicEmbedding<T>>(
+                       ctx, handle_.scalar<ResourceHandle>()(), &embedding,
+                       [this](DynamicEmbedding<T>** ret) {
+                         *ret = new DynamicEmbedding<T>(options_);
+                         return Status::OK();
+                       }));
+    core::ScopedUnref unref(embedding);
+    OP_REQUIRES(ctx,
+                embedding->embedding_dim() == options_.embedding_dim,
+                errors::InvalidArgument(
+                    "Shared DynamicEmbedding ", name_, " has embedding_dim ",
+                    embedding->embedding_dim(), ", not ",
+                    options_.embedding_dim));
+    ctx->set_output(0, handle_);
+  }
+
+  bool IsExpensive() override { return false; }
+
+ private:
+  string container_;
+  string name_;
+  DynamicEmbeddingOptions options_;
+  mutex mu_;
+  Tensor handle_ TF_GUARDED_BY(mu_);
+};
+
+template <typename T>
+class DynamicEmbeddingLookupOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingLookupOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("embedding_dim", &embedding_dim_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    DynamicEmbedding<T>* embedding;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &embedding));
+    core::ScopedUnref unref(embedding);
+    OP_REQUIRES(ctx, embedding->embedding_dim() == embedding_dim_,
+                errors::InvalidArgument("Expected a DynamicEmbedding with "
+                                        "embedding_dim ",
+                                        embedding_dim_, ", got ",
+                                        embedding->embedding_dim()));
+
+    const Tensor& ids = ctx->input(1);
+    TensorShape output_shape = ids.shape();
+    output_shape.AddDim(embedding->embedding_dim());
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    const auto ids_flat = ids.flat<int64>();
+    embedding->Lookup(
+        gtl::ArraySlice<int64>(ids_flat.data(), ids_flat.size()),
+        output->shaped<T, 2>({ids_flat.size(), embedding->embedding_dim()}));
+  }
+
+ private:
+  int64 embedding_dim_;
+};
+
+template <typename T>
+class DynamicEmbeddingSparseApplyAdagradOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingSparseApplyAdagradOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    DynamicEmbedding<T>* var;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0), &var));
+    core::ScopedUnref unref_var(var);
+    DynamicEmbedding<T>* accum;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 1), &accum));
+    core::ScopedUnref unref_accum(accum);
+    OP_REQUIRES(ctx, var != accum,
+                errors::InvalidArgument("var and accum must differ"));
+    OP_REQUIRES(
+        ctx, var->embedding_dim() == accum->embedding_dim(),
+        errors::InvalidArgument("var and accum do not have the same "
+                                "embedding_dim: ",
+                                var->embedding_dim(), " vs. ",
+                                accum->embedding_dim()));
+
+    const Tensor& lr = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr.shape().DebugString()));
+    const Tensor& grad = ctx->input(3);
+    const Tensor& indices = ctx->input(4);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be one-dimensional"));
+    const int64 dim = var->embedding_dim();
+    const int64 n = indices.dim_size(0);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(grad.shape()) &&
+                    grad.dim_size(0) == n && grad.dim_size(1) == dim,
+                errors::InvalidArgument("grad must have shape [", n, ", ",
+                                        dim, "], got ",
+                                        grad.shape().DebugString()));
+
+    const auto indices_vec = indices.vec<int64>();
+    const auto grad_matrix = grad.matrix<T>();
+    const T lr_scalar = lr.scalar<T>()();
+
+    // The rows may move as rows are allocated, so both embeddings stay locked
+    // for the whole update.  They are locked in a fixed order, which keeps
+    // concurrent updates from deadlocking.
+    mutex* first = var->mu();
+    mutex* second = accum->mu();
+    if (second < first) std::swap(first, second);
+    mutex_lock l1(*first);
+    mutex_lock l2(*second);
+    for (int64 i = 0; i < n; ++i) {
+      const int64 id = internal::SubtleMustCopy(indices_vec(i));
+      // Ids without a row were not admitted yet, and are not updated.
+      T* v = var->FindRowLocked(id);
+      if (v == nullptr) continue;
+      T* a = accum->FindOrAllocateRowLocked(id);
+      for (int64 j = 0; j < dim; ++j) {
+        const T g = grad_matrix(i, j);
+        if (update_slots_) {
+          a[j] += g * g;
+        }
+        v[j] -= lr_scalar * g / Eigen::numext::sqrt(a[j]);
+      }
+    }
+  }
+
+ private:
+  bool update_slots_;
+};
+
+template <typename T>
+class DynamicEmbeddingSizeOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingSizeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    DynamicEmbedding<T>* embedding;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &embedding));
+    core::ScopedUnref unref(embedding);
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    output->scalar<int64>()() = embedding->size();
+  }
+};
+
+template <typename T>
+class DynamicEmbeddingExportOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingExportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("embedding_dim", &embedding_dim_));
+  }
+
+  void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
+    DynamicEmbedding<T>* embedding;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &embedding));
+    core::ScopedUnref unref(embedding);
+    OP_REQUIRES(ctx, embedding->embedding_dim() == embedding_dim_,
+                errors::InvalidArgument("Expected a DynamicEmbedding with "
+                                        "embedding_dim ",
+                                        embedding_dim_, ", got ",
+                                        embedding->embedding_dim()));
+    tf_shared_lock l(*embedding->mu());
+    const int64 size = embedding->SizeLocked();
+    Tensor* ids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({size}), &ids));
+    Tensor* values;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            1, TensorShape({size, embedding->embedding_dim()}),
+                            &values));
+    embedding->ExportLocked(ids->flat<int64>(), values->matrix<T>());
+  }
+
+ private:
+  int64 embedding_dim_;
+};
+
+template <typename T>
+class DynamicEmbeddingImportOp : public OpKernel {
+ public:
+  explicit DynamicEmbeddingImportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    DynamicEmbedding<T>* embedding;
+    OP_REQUIRES_OK(ctx, LookupResource(ctx, HandleFromInput(ctx, 0),
+                                       &embedding));
+    core::ScopedUnref unref(embedding);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& values = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(ids.shape()),
+                errors::InvalidArgument("ids must be a vector, got ",
+                                        ids.shape().DebugString()));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(values.shape()) &&
+                    values.dim_size(0) == ids.dim_size(0) &&
+                    values.dim_size(1) == embedding->embedding_dim(),
+                errors::InvalidArgument(
+                    "values must have shape [", ids.dim_size(0), ", ",
+                    embedding->embedding_dim(), "], got ",
+                    values.shape().DebugString()));
+    OP_REQUIRES_OK(ctx,
+                   embedding->Import(ids.flat<int64>(), values.matrix<T>()));
+  }
+};
+
+#define REGISTER_KERNELS(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingHandleOp")           \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("dtype"),           \
+                          DynamicEmbeddingHandleOp<T>);              \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingLookup")             \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("dtype"),           \
+                          DynamicEmbeddingLookupOp<T>);              \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingSparseApplyAdagrad") \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T"),               \
+                          DynamicEmbeddingSparseApplyAdagradOp<T>);  \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingSize")               \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("dtype"),           \
+                          DynamicEmbeddingSizeOp<T>);                \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingExport")             \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("dtype"),           \
+                          DynamicEmbeddingExportOp<T>);              \
+  REGISTER_KERNEL_BUILDER(Name("DynamicEmbeddingImport")             \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("dtype"),           \
+                          DynamicEmbeddingImportOp<T>);
+
+TF_CALL_half(REGISTER_KERNELS);
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
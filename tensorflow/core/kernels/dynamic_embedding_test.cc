@@ -0,0 +1,148 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/dynamic_embedding.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Embedding = DynamicEmbedding<float>;
+
+Tensor Lookup(Embedding* embedding, const std::vector<int64>& ids) {
+  Tensor values(DT_FLOAT, TensorShape({static_cast<int64>(ids.size()),
+                                       embedding->embedding_dim()}));
+  embedding->Lookup(ids, values.matrix<float>());
+  return values;
+}
+
+std::vector<int64> Ids(Embedding* embedding) {
+  tf_shared_lock l(*embedding->mu());
+  Tensor ids(DT_INT64, TensorShape({embedding->SizeLocked()}));
+  Tensor values(DT_FLOAT, TensorShape({embedding->SizeLocked(),
+                                       embedding->embedding_dim()}));
+  embedding->ExportLocked(ids.flat<int64>(), values.matrix<float>());
+  std::vector<int64> result(ids.flat<int64>().data(),
+                            ids.flat<int64>().data() + ids.NumElements());
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+TEST(DynamicEmbeddingTest, AllocatesRowsOnLookup) {
+  DynamicEmbeddingOptions options;
+  options.embedding_dim = 2;
+  options.initial_value = 0.5;
+  core::RefCountPtr<Embedding> embedding(new Embedding(options));
+  EXPECT_EQ(0, embedding->size());
+
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0.5, 0.5, 0.5, 0.5}, {2, 2}),
+      Lookup(embedding.get(), {7, 1LL << 40}));
+  EXPECT_EQ((std::vector<int64>{7, 1LL << 40}), Ids(embedding.get()));
+
+  {
+    mutex_lock l(*embedding->mu());
+    embedding->FindRowLocked(7)[1] = 2;
+    EXPECT_EQ(nullptr, embedding->FindRowLocked(3));
+  }
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({0.5, 2}, {1, 2}),
+                                 Lookup(embedding.get(), {7}));
+  EXPECT_EQ(2, embedding->size());
+}
+
+TEST(DynamicEmbeddingTest, AdmitsFrequentIds) {
+  DynamicEmbeddingOptions options;
+  options.min_frequency = 3;
+  core::RefCountPtr<Embedding> embedding(new Embedding(options));
+  Lookup(embedding.get(), {1, 2, 1});
+  EXPECT_EQ(0, embedding->size());
+  Lookup(embedding.get(), {1, 2});
+  EXPECT_EQ((std::vector<int64>{1}), Ids(embedding.get()));
+  Lookup(embedding.get(), {2});
+  EXPECT_EQ((std::vector<int64>{1, 2}), Ids(embedding.get()));
+}
+
+TEST(DynamicEmbeddingTest, EvictsLeastRecentlyUsedRows) {
+  DynamicEmbeddingOptions options;
+  options.max_rows = 2;
+  core::RefCountPtr<Embedding> embedding(new Embedding(options));
+  Lookup(embedding.get(), {1, 2, 1, 3});
+  EXPECT_EQ((std::vector<int64>{1, 3}), Ids(embedding.get()));
+  Lookup(embedding.get(), {1, 4});
+  EXPECT_EQ((std::vector<int64>{1, 4}), Ids(embedding.get()));
+}
+
+TEST(DynamicEmbeddingTest, EvictsLeastFrequentlyUsedRows) {
+  DynamicEmbeddingOptions options;
+  options.max_rows = 2;
+  options.eviction_policy = EmbeddingEvictionPolicy::kLeastFrequentlyUsed;
+  core::RefCountPtr<Embedding> embedding(new Embedding(options));
+  Lookup(embedding.get(), {1, 1, 1, 2, 2, 3});
+  EXPECT_EQ((std::vector<int64>{1, 3}), Ids(embedding.get()));
+  Lookup(embedding.get(), {3, 3, 4});
+  EXPECT_EQ((std::vector<int64>{3, 4}), Ids(embedding.get()));
+}
+
+TEST(DynamicEmbeddingTest, InitializesRowsWithNoise) {
+  DynamicEmbeddingOptions options;
+  options.embedding_dim = 64;
+  options.initial_value = 1;
+  options.initial_stddev = 0.1;
+  options.seed = 17;
+  core::RefCountPtr<Embedding> a(new Embedding(options));
+  core::RefCountPtr<Embedding> b(new Embedding(options));
+  const Tensor values = Lookup(a.get(), {5});
+  test::ExpectTensorEqual<float>(values, Lookup(b.get(), {5}));
+  float sum = 0;
+  for (int i = 0; i < 64; ++i) sum += values.flat<float>()(i);
+  EXPECT_NEAR(64, sum, 4);
+  EXPECT_NE(1, values.flat<float>()(0));
+}
+
+TEST(DynamicEmbeddingTest, ImportsRows) {
+  DynamicEmbeddingOptions options;
+  options.embedding_dim = 2;
+  options.max_rows = 2;
+  core::RefCountPtr<Embedding> embedding(new Embedding(options));
+  Lookup(embedding.get(), {1});
+  const Tensor ids = test::AsTensor<int64>({3, 4});
+  const Tensor values = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  TF_ASSERT_OK(embedding->Import(ids.flat<int64>(), values.matrix<float>()));
+  EXPECT_EQ((std::vector<int64>{3, 4}), Ids(embedding.get()));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({3, 4, 1, 2}, {2, 2}),
+                                 Lookup(embedding.get(), {4, 3}));
+
+  const Tensor too_many_ids = test::AsTensor<int64>({1, 2, 3});
+  const Tensor too_many_values = test::AsTensor<float>({0, 0, 0, 0, 0, 0},
+                                                       {3, 2});
+  EXPECT_FALSE(embedding
+                   ->Import(too_many_ids.flat<int64>(),
+                            too_many_values.matrix<float>())
+                   .ok());
+
+  EmbeddingEvictionPolicy policy;
+  TF_EXPECT_OK(ParseEmbeddingEvictionPolicy("lfu", &policy));
+  EXPECT_EQ(EmbeddingEvictionPolicy::kLeastFrequentlyUsed, policy);
+  EXPECT_FALSE(ParseEmbeddingEvictionPolicy("fifo", &policy).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
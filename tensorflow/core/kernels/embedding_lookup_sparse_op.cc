@@ -0,0 +1,545 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/embedding_lookup_sparse_op.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
+#include "tensorflow/core/kernels/cuda_solvers.h"
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#if GOOGLE_CUDA
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
+using stream_executor::cuda::ScopedActivateExecutorContext;
+#elif TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/rocm.h"
+using stream_executor::rocm::ScopedActivateExecutorContext;
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+Status ParseEmbeddingCombiner(const string& name, EmbeddingCombiner* combiner) {
+  if (name == "sum") {
+    *combiner = EmbeddingCombiner::kSum;
+  } else if (name == "mean") {
+    *combiner = EmbeddingCombiner::kMean;
+  } else if (name == "sqrtn") {
+    *combiner = EmbeddingCombiner::kSqrtN;
+  } else {
+    return errors::InvalidArgument("Unknown combiner '", name,
+                                   "', expected 'sum', 'mean' or 'sqrtn'");
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Sets (*starts)[s] to the index of the first segment id of "segment_ids"
+// that is at least s, for s in [0, num_rows].
+template <typename Tsegmentids>
+Status SegmentStarts(typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                     int64 num_rows, std::vector<int64>* starts) {
+  starts->resize(num_rows + 1);
+  const int64 num_ids = segment_ids.size();
+  int64 row = 0;
+  int64 previous = 0;
+  for (int64 i = 0; i < num_ids; ++i) {
+    const int64 segment = internal::SubtleMustCopy(segment_ids(i));
+    if (segment < previous) {
+      return errors::InvalidArgument("segment ids are not increasing");
+    }
+    if (segment >= num_rows) {
+      return errors::InvalidArgument("Segment id ", segment,
+                                     " out of range [0, ", num_rows, ")");
+    }
+    while (row <= segment) (*starts)[row++] = i;
+    previous = segment;
+  }
+  while (row <= num_rows) (*starts)[row++] = num_ids;
+  return Status::OK();
+}
+
+// The factor by which the weighted sum of a segment is scaled, for the sum
+// of the weights or of the squares of the weights of the segment.
+template <typename T>
+T CombinerScale(EmbeddingCombiner combiner, T total) {
+  switch (combiner) {
+    case EmbeddingCombiner::kMean:
+      return T(1) / total;
+    case EmbeddingCombiner::kSqrtN:
+      return T(1) / std::sqrt(total);
+    default:
+      return T(1);
+  }
+}
+
+// Records the smallest out-of-range index across shards.
+class BadIndex {
+ public:
+  void Record(int64 i) {
+    int64 current = index_.load(std::memory_order_relaxed);
+    while ((current < 0 || i < current) &&
+           !index_.compare_exchange_weak(current, i)) {
+    }
+  }
+  int64 index() const { return index_.load(); }
+
+ private:
+  std::atomic<int64> index_{-1};
+};
+
+template <typename T>
+using RowMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+template <typename T>
+using ConstRowMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+}  // namespace
+
+namespace functor {
+
+template <typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseFunctor<CPUDevice, T, Tidx, Tsegmentids> {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::Tensor output) {
+    const int64 num_rows = output.dimension(0);
+    const int64 num_params = params.dimension(0);
+    const int64 dim = params.dimension(1);
+    const bool has_weights = weights.size() > 0;
+    std::vector<int64> starts;
+    TF_RETURN_IF_ERROR(
+        SegmentStarts<Tsegmentids>(segment_ids, num_rows, &starts));
+
+    // Each row of the output is accumulated in place from the rows of its
+    // ids, without gathering the rows first.
+    BadIndex bad_index;
+    auto combine_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        RowMap<T> out(&output(row, 0), dim);
+        out.setZero();
+        T total(0);
+        for (int64 i = starts[row]; i < starts[row + 1]; ++i) {
+          const Tidx id = internal::SubtleMustCopy(ids(i));
+          if (!FastBoundsCheck(id, num_params)) {
+            bad_index.Record(i);
+            continue;
+          }
+          const T weight = has_weights ? weights(i) : T(1);
+          out += weight * ConstRowMap<T>(&params(id, 0), dim);
+          total += combiner == EmbeddingCombiner::kMean ? weight
+                                                        : weight * weight;
+        }
+        if (combiner != EmbeddingCombiner::kSum &&
+            starts[row] < starts[row + 1]) {
+          out *= CombinerScale(combiner, total);
+        }
+      }
+    };
+    const int64 ids_per_row =
+        num_rows > 0 ? std::max<int64>(1, ids.size() / num_rows) : 1;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          ids_per_row * dim * 2, combine_rows);
+
+    if (bad_index.index() >= 0) {
+      return errors::InvalidArgument(
+          "ids[", bad_index.index(), "] = ", ids(bad_index.index()),
+          " is not in [0, ", num_params, ")");
+    }
+    return Status::OK();
+  }
+};
+
+template <typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseGradFunctor<CPUDevice, T, Tidx, Tsegmentids> {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor grad,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::ConstTensor output,
+                    typename TTypes<T, 2>::Tensor params_grad,
+                    typename TTypes<T>::Flat weights_grad) {
+    const int64 num_rows = grad.dimension(0);
+    const int64 num_params = params.dimension(0);
+    const int64 dim = grad.dimension(1);
+    const bool has_weights = weights.size() > 0;
+    std::vector<int64> starts;
+    TF_RETURN_IF_ERROR(
+        SegmentStarts<Tsegmentids>(segment_ids, num_rows, &starts));
+
+    BadIndex bad_index;
+    auto grad_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        if (starts[row] == starts[row + 1]) continue;
+        const ConstRowMap<T> g(&grad(row, 0), dim);
+        T total(0);
+        for (int64 i = starts[row]; i < starts[row + 1]; ++i) {
+          const T weight = has_weights ? weights(i) : T(1);
+          total += combiner == EmbeddingCombiner::kMean ? weight
+                                                        : weight * weight;
+        }
+        const T scale = CombinerScale(combiner, total);
+        T g_dot_output(0);
+        if (has_weights && combiner != EmbeddingCombiner::kSum) {
+          g_dot_output = (g * ConstRowMap<T>(&output(row, 0), dim)).sum();
+        }
+        for (int64 i = starts[row]; i < starts[row + 1]; ++i) {
+          const T weight = has_weights ? weights(i) : T(1);
+          RowMap<T>(&params_grad(i, 0), dim) = g * (weight * scale);
+          if (!has_weights) continue;
+          const Tidx id = internal::SubtleMustCopy(ids(i));
+          if (!FastBoundsCheck(id, num_params)) {
+            bad_index.Record(i);
+            continue;
+          }
+          const T g_dot_params =
+              (g * ConstRowMap<T>(&params(id, 0), dim)).sum();
+          switch (combiner) {
+            case EmbeddingCombiner::kSum:
+              weights_grad(i) = g_dot_params;
+              break;
+            case EmbeddingCombiner::kMean:
+              weights_grad(i) = (g_dot_params - g_dot_output) * scale;
+              break;
+            case EmbeddingCombiner::kSqrtN:
+              weights_grad(i) = g_dot_params * scale -
+                                g_dot_output * weight * scale * scale;
+              break;
+          }
+        }
+      }
+    };
+    const int64 ids_per_row =
+        num_rows > 0 ? std::max<int64>(1, ids.size() / num_rows) : 1;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+          ids_per_row * dim * (has_weights ? 4 : 1), grad_rows);
+
+    if (bad_index.index() >= 0) {
+      return errors::InvalidArgument(
+          "ids[", bad_index.index(), "] = ", ids(bad_index.index()),
+          " is not in [0, ", num_params, ")");
+    }
+    return Status::OK();
+  }
+};
+
+}  // namespace functor
+
+namespace {
+
+Status ValidateEmbeddingLookupSparseInputs(const Tensor& params,
+                                           const Tensor& ids,
+                                           const Tensor& weights,
+                                           const Tensor& segment_ids) {
+  if (!TensorShapeUtils::IsVectorOrHigher(params.shape())) {
+    return errors::InvalidArgument("params must be at least 1 dimensional, ",
+                                   "got ", params.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(ids.shape())) {
+    return errors::InvalidArgument("ids must be a vector, got ",
+                                   ids.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(segment_ids.shape()) ||
+      segment_ids.NumElements() != ids.NumElements()) {
+    return errors::InvalidArgument(
+        "segment_ids must be a vector of the size of ids, got ",
+        segment_ids.shape().DebugString(), " for ", ids.NumElements(),
+        " ids");
+  }
+  if (!TensorShapeUtils::IsVector(weights.shape()) ||
+      (weights.NumElements() != 0 &&
+       weights.NumElements() != ids.NumElements())) {
+    return errors::InvalidArgument(
+        "weights must be empty or a vector of the size of ids, got ",
+        weights.shape().DebugString(), " for ", ids.NumElements(), " ids");
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+template <typename Device, typename T, typename Tidx, typename Tsegmentids>
+class EmbeddingLookupSparseOp : public OpKernel {
+ public:
+  explicit EmbeddingLookupSparseOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    string combiner;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(ctx, ParseEmbeddingCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& params = ctx->input(0);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& weights = ctx->input(2);
+    const Tensor& segment_ids = ctx->input(3);
+    OP_REQUIRES_OK(ctx, ValidateEmbeddingLookupSparseInputs(params, ids,
+                                                            weights,
+                                                            segment_ids));
+    const int64 num_ids = ids.NumElements();
+    // The segment ids are sorted, so the last one gives the number of rows.
+    const int64 num_rows =
+        num_ids > 0 ? internal::SubtleMustCopy(
+                          segment_ids.vec<Tsegmentids>()(num_ids - 1)) +
+                          1
+                    : 0;
+    OP_REQUIRES(ctx, num_rows >= 0,
+                errors::InvalidArgument("segment ids must be >= 0"));
+    TensorShape output_shape = params.shape();
+    output_shape.set_dim(0, num_rows);
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &output));
+    OP_REQUIRES_OK(ctx,
+                   functor::EmbeddingLookupSparseFunctor<Device, T, Tidx,
+                                                         Tsegmentids>()(
+                       ctx, combiner_, params.flat_outer_dims<T>(),
+                       ids.flat<Tidx>(), weights.flat<T>(),
+                       segment_ids.flat<Tsegmentids>(),
+                       output->flat_outer_dims<T>()));
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+template <typename Device, typename T, typename Tidx, typename Tsegmentids>
+class EmbeddingLookupSparseGradOp : public OpKernel {
+ public:
+  explicit EmbeddingLookupSparseGradOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    string combiner;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(ctx, ParseEmbeddingCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& grad = ctx->input(0);
+    const Tensor& params = ctx->input(1);
+    const Tensor& ids = ctx->input(2);
+    const Tensor& weights = ctx->input(3);
+    const Tensor& segment_ids = ctx->input(4);
+    const Tensor& output = ctx->input(5);
+    OP_REQUIRES_OK(ctx, ValidateEmbeddingLookupSparseInputs(params, ids,
+                                                            weights,
+                                                            segment_ids));
+    OP_REQUIRES(ctx,
+                grad.shape() == output.shape() && grad.dims() == params.dims(),
+                errors::InvalidArgument(
+                    "grad and output must have the same shape with the inner "
+                    "dimensions of params, got ",
+                    grad.shape().DebugString(), ", ",
+                    output.shape().DebugString(), " and ",
+                    params.shape().DebugString()));
+    for (int d = 1; d < params.dims(); ++d) {
+      OP_REQUIRES(ctx, grad.dim_size(d) == params.dim_size(d),
+                  errors::InvalidArgument(
+                      "grad must have the inner dimensions of params, got ",
+                      grad.shape().DebugString(), " and ",
+                      params.shape().DebugString()));
+    }
+
+    TensorShape params_grad_shape = params.shape();
+    params_grad_shape.set_dim(0, ids.NumElements());
+    Tensor* params_grad;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, params_grad_shape, &params_grad));
+    Tensor* weights_grad;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(1, weights.shape(), &weights_grad));
+    OP_REQUIRES_OK(ctx,
+                   functor::EmbeddingLookupSparseGradFunctor<Device, T, Tidx,
+                                                             Tsegmentids>()(
+                       ctx, combiner_, grad.flat_outer_dims<T>(),
+                       params.flat_outer_dims<T>(), ids.flat<Tidx>(),
+                       weights.flat<T>(), segment_ids.flat<Tsegmentids>(),
+                       output.flat_outer_dims<T>(),
+                       params_grad->flat_outer_dims<T>(),
+                       weights_grad->flat<T>()));
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+#define REGISTER_CPU_KERNELS_WITH_INDICES(T, Tidx, Tsegmentids)             \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingLookupSparse")                     \
+                              .Device(DEVICE_CPU)                           \
+                              .TypeConstraint<T>("T")                       \
+                              .TypeConstraint<Tidx>("Tidx")                 \
+                              .TypeConstraint<Tsegmentids>("Tsegmentids"),  \
+                          EmbeddingLookupSparseOp<CPUDevice, T, Tidx,       \
+                                                  Tsegmentids>);            \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingLookupSparseGrad")                 \
+                              .Device(DEVICE_CPU)                           \
+                              .TypeConstraint<T>("T")                       \
+                              .TypeConstraint<Tidx>("Tidx")                 \
+                              .TypeConstraint<Tsegmentids>("Tsegmentids"),  \
+                          EmbeddingLookupSparseGradOp<CPUDevice, T, Tidx,   \
+                                                      Tsegmentids>);
+
+#define REGISTER_CPU_KERNELS(T)                           \
+  REGISTER_CPU_KERNELS_WITH_INDICES(T, int32, int32);     \
+  REGISTER_CPU_KERNELS_WITH_INDICES(T, int32, int64);     \
+  REGISTER_CPU_KERNELS_WITH_INDICES(T, int64, int32);     \
+  REGISTER_CPU_KERNELS_WITH_INDICES(T, int64, int64);
+
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNELS_WITH_INDICES
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+// The number of output rows is the last segment id plus one, which has to be
+// copied from the device before the output can be allocated.
+template <typename T, typename Tidx, typename Tsegmentids>
+class EmbeddingLookupSparseGpuOp : public AsyncOpKernel {
+ public:
+  explicit EmbeddingLookupSparseGpuOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx) {
+    string combiner;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(ctx, ParseEmbeddingCombiner(combiner, &combiner_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    const Tensor& params = ctx->input(0);
+    const Tensor& ids = ctx->input(1);
+    const Tensor& weights = ctx->input(2);
+    const Tensor& segment_ids = ctx->input(3);
+    OP_REQUIRES_OK_ASYNC(ctx,
+                         ValidateEmbeddingLookupSparseInputs(
+                             params, ids, weights, segment_ids),
+                         done);
+    const int64 num_ids = ids.NumElements();
+    if (num_ids == 0) {
+      TensorShape output_shape = params.shape();
+      output_shape.set_dim(0, 0);
+      Tensor* output;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ctx->allocate_output(0, output_shape, &output), done);
+      done();
+      return;
+    }
+
+    se::DeviceMemoryBase last_segment_id_device(
+        const_cast<Tensor&>(segment_ids).flat<Tsegmentids>().data() +
+        (num_ids - 1));
+    ScratchSpace<Tsegmentids> last_segment_id_host(ctx, 1, /*on_host=*/true);
+    auto stream = ctx->op_device_context()->stream();
+    OP_REQUIRES_ASYNC(
+        ctx,
+        stream
+            ->ThenMemcpy(last_segment_id_host.mutable_data(),
+                         last_segment_id_device, sizeof(Tsegmentids))
+            .ok(),
+        errors::Internal("EmbeddingLookupSparse: failed to copy the number "
+                         "of output rows from device"),
+        done);
+
+    const EmbeddingCombiner combiner = combiner_;
+    auto compute = [ctx, last_segment_id_host, combiner, done]() {
+      auto stream = ctx->op_device_context()->stream();
+      ScopedActivateExecutorContext scoped_activation{stream->parent()};
+
+      const Tensor& params = ctx->input(0);
+      const int64 num_rows = *last_segment_id_host.data() + 1;
+      OP_REQUIRES_ASYNC(ctx, num_rows > 0,
+                        errors::InvalidArgument("segment ids must be >= 0"),
+                        done);
+      TensorShape output_shape = params.shape();
+      output_shape.set_dim(0, num_rows);
+      Tensor* output;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, ctx->allocate_output(0, output_shape, &output), done);
+      OP_REQUIRES_OK_ASYNC(
+          ctx,
+          functor::EmbeddingLookupSparseFunctor<GPUDevice, T, Tidx,
+                                                Tsegmentids>()(
+              ctx, combiner, params.flat_outer_dims<T>(),
+              ctx->input(1).flat<Tidx>(), ctx->input(2).flat<T>(),
+              ctx->input(3).flat<Tsegmentids>(),
+              output->flat_outer_dims<T>()),
+          done);
+      done();
+    };
+    ctx->device()->tensorflow_gpu_device_info()->event_mgr->ThenExecute(
+        stream, compute);
+  }
+
+ private:
+  EmbeddingCombiner combiner_;
+};
+
+#define REGISTER_GPU_KERNELS_WITH_INDICES(T, Tidx, Tsegmentids)             \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingLookupSparse")                     \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<T>("T")                       \
+                              .TypeConstraint<Tidx>("Tidx")                 \
+                              .TypeConstraint<Tsegmentids>("Tsegmentids"),  \
+                          EmbeddingLookupSparseGpuOp<T, Tidx, Tsegmentids>); \
+  REGISTER_KERNEL_BUILDER(Name("EmbeddingLookupSparseGrad")                 \
+                              .Device(DEVICE_GPU)                           \
+                              .TypeConstraint<T>("T")                       \
+                              .TypeConstraint<Tidx>("Tidx")                 \
+                              .TypeConstraint<Tsegmentids>("Tsegmentids"),  \
+                          EmbeddingLookupSparseGradOp<GPUDevice, T, Tidx,   \
+                                                      Tsegmentids>);
+
+#define REGISTER_GPU_KERNELS(T)                           \
+  REGISTER_GPU_KERNELS_WITH_INDICES(T, int32, int32);     \
+  REGISTER_GPU_KERNELS_WITH_INDICES(T, int32, int64);     \
+  REGISTER_GPU_KERNELS_WITH_INDICES(T, int64, int32);     \
+  REGISTER_GPU_KERNELS_WITH_INDICES(T, int64, int64);
+
+TF_CALL_float(REGISTER_GPU_KERNELS);
+TF_CALL_double(REGISTER_GPU_KERNELS);
+
+#undef REGISTER_GPU_KERNELS
+#undef REGISTER_GPU_KERNELS_WITH_INDICES
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
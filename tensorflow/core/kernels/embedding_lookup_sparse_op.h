@@ -0,0 +1,70 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_EMBEDDING_LOOKUP_SPARSE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_EMBEDDING_LOOKUP_SPARSE_OP_H_
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// How the weighted rows of a segment are combined: their weighted sum,
+// divided by 1, the sum of the weights or the square root of the sum of the
+// squares of the weights.
+enum class EmbeddingCombiner { kSum, kMean, kSqrtN };
+
+Status ParseEmbeddingCombiner(const string& name, EmbeddingCombiner* combiner);
+
+namespace functor {
+
+// Sets row s of "output" to the combination of the rows "ids" of "params"
+// weighted by "weights" that have segment id s.  "weights" is either empty,
+// for weights of 1, or has one weight per id.  "segment_ids" is sorted and
+// its ids are less than the number of rows of "output".
+template <typename Device, typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseFunctor {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::Tensor output);
+};
+
+// Computes the gradients of EmbeddingLookupSparse for its "output" and the
+// gradient "grad" of the output: "params_grad" gets one row of gradient for
+// each of "ids", and "weights_grad" the gradient of each weight if "weights"
+// is not empty.
+template <typename Device, typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseGradFunctor {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor grad,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::ConstTensor output,
+                    typename TTypes<T, 2>::Tensor params_grad,
+                    typename TTypes<T>::Flat weights_grad);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_EMBEDDING_LOOKUP_SPARSE_OP_H_
@@ -0,0 +1,264 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/embedding_lookup_sparse_op.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace functor {
+
+namespace {
+
+template <typename T>
+__device__ T CombinerScale(EmbeddingCombiner combiner, T total) {
+  switch (combiner) {
+    case EmbeddingCombiner::kMean:
+      return T(1) / total;
+    case EmbeddingCombiner::kSqrtN:
+      return T(1) / Eigen::numext::sqrt(total);
+    default:
+      return T(1);
+  }
+}
+
+// Adds the weight, or the square of the weight, of each id to the total of
+// its segment.  Ids of out-of-range segments are skipped.
+template <typename T, typename Tsegmentids>
+__global__ void SegmentTotalsKernel(const int num_ids, const T* weights,
+                                    const Tsegmentids* segment_ids,
+                                    const int64 num_rows,
+                                    EmbeddingCombiner combiner, T* totals) {
+  GPU_1D_KERNEL_LOOP(i, num_ids) {
+    const Tsegmentids row = ldg(segment_ids + i);
+    if (row < 0 || row >= num_rows) continue;
+    const T weight = weights == nullptr ? T(1) : ldg(weights + i);
+    GpuAtomicAdd(totals + row,
+                 combiner == EmbeddingCombiner::kMean ? weight
+                                                      : weight * weight);
+  }
+}
+
+// Accumulates the scaled and weighted rows of the ids into the rows of their
+// segments.  Like Gather on GPU, out-of-range ids contribute zeros.
+template <typename T, typename Tidx, typename Tsegmentids>
+__global__ void EmbeddingLookupSparseKernel(
+    const int size, const int64 dim, const T* params, const int64 num_params,
+    const Tidx* ids, const T* weights, const Tsegmentids* segment_ids,
+    const int64 num_rows, EmbeddingCombiner combiner, const T* totals,
+    T* output) {
+  GPU_1D_KERNEL_LOOP(index, size) {
+    const int64 i = index / dim;
+    const int64 j = index % dim;
+    const Tsegmentids row = ldg(segment_ids + i);
+    const Tidx id = ldg(ids + i);
+    if (row < 0 || row >= num_rows || id < 0 || id >= num_params) continue;
+    T weight = weights == nullptr ? T(1) : ldg(weights + i);
+    if (combiner != EmbeddingCombiner::kSum) {
+      weight *= CombinerScale(combiner, ldg(totals + row));
+    }
+    GpuAtomicAdd(output + row * dim + j, weight * ldg(params + id * dim + j));
+  }
+}
+
+template <typename T, typename Tsegmentids>
+__global__ void EmbeddingLookupSparseParamsGradKernel(
+    const int size, const int64 dim, const T* grad, const T* weights,
+    const Tsegmentids* segment_ids, const int64 num_rows,
+    EmbeddingCombiner combiner, const T* totals, T* params_grad) {
+  GPU_1D_KERNEL_LOOP(index, size) {
+    const int64 i = index / dim;
+    const int64 j = index % dim;
+    const Tsegmentids row = ldg(segment_ids + i);
+    if (row < 0 || row >= num_rows) {
+      params_grad[index] = T(0);
+      continue;
+    }
+    T weight = weights == nullptr ? T(1) : ldg(weights + i);
+    if (combiner != EmbeddingCombiner::kSum) {
+      weight *= CombinerScale(combiner, ldg(totals + row));
+    }
+    params_grad[index] = weight * ldg(grad + row * dim + j);
+  }
+}
+
+template <typename T, typename Tidx, typename Tsegmentids>
+__global__ void EmbeddingLookupSparseWeightsGradKernel(
+    const int num_ids, const int64 dim, const T* grad, const T* params,
+    const int64 num_params, const Tidx* ids, const T* weights,
+    const Tsegmentids* segment_ids, const T* output, const int64 num_rows,
+    EmbeddingCombiner combiner, const T* totals, T* weights_grad) {
+  GPU_1D_KERNEL_LOOP(i, num_ids) {
+    const Tsegmentids row = ldg(segment_ids + i);
+    const Tidx id = ldg(ids + i);
+    if (row < 0 || row >= num_rows || id < 0 || id >= num_params) {
+      weights_grad[i] = T(0);
+      continue;
+    }
+    T g_dot_params(0);
+    T g_dot_output(0);
+    for (int64 j = 0; j < dim; ++j) {
+      const T g = ldg(grad + row * dim + j);
+      g_dot_params += g * ldg(params + id * dim + j);
+      g_dot_output += g * ldg(output + row * dim + j);
+    }
+    const T scale = CombinerScale(combiner, ldg(totals + row));
+    switch (combiner) {
+      case EmbeddingCombiner::kSum:
+        weights_grad[i] = g_dot_params;
+        break;
+      case EmbeddingCombiner::kMean:
+        weights_grad[i] = (g_dot_params - g_dot_output) * scale;
+        break;
+      case EmbeddingCombiner::kSqrtN:
+        weights_grad[i] = g_dot_params * scale -
+                          g_dot_output * ldg(weights + i) * scale * scale;
+        break;
+    }
+  }
+}
+
+// Allocates and computes the totals of the segments, unless "combiner" does
+// not need them.
+template <typename T, typename Tsegmentids>
+Status SegmentTotals(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                     typename TTypes<T>::ConstFlat weights,
+                     typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                     int64 num_rows, Tensor* totals) {
+  if (combiner == EmbeddingCombiner::kSum) return Status::OK();
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                        TensorShape({num_rows}), totals));
+  const GPUDevice& d = ctx->eigen_gpu_device();
+  auto totals_flat = totals->flat<T>();
+  totals_flat.device(d) = totals_flat.constant(T(0));
+  const int num_ids = segment_ids.size();
+  if (num_ids == 0) return Status::OK();
+  GpuLaunchConfig config = GetGpuLaunchConfig(num_ids, d);
+  return GpuLaunchKernel(SegmentTotalsKernel<T, Tsegmentids>,
+                         config.block_count, config.thread_per_block, 0,
+                         d.stream(), num_ids,
+                         weights.size() == 0 ? nullptr : weights.data(),
+                         segment_ids.data(), num_rows, combiner,
+                         totals_flat.data());
+}
+
+}  // namespace
+
+template <typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseFunctor<GPUDevice, T, Tidx, Tsegmentids> {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::Tensor output) {
+    const GPUDevice& d = ctx->eigen_gpu_device();
+    output.device(d) = output.constant(T(0));
+    const int64 num_rows = output.dimension(0);
+    const int64 dim = params.dimension(1);
+    const int size = ids.size() * dim;
+    if (size == 0) return Status::OK();
+    Tensor totals;
+    TF_RETURN_IF_ERROR((SegmentTotals<T, Tsegmentids>(
+        ctx, combiner, weights, segment_ids, num_rows, &totals)));
+    GpuLaunchConfig config = GetGpuLaunchConfig(size, d);
+    return GpuLaunchKernel(
+        EmbeddingLookupSparseKernel<T, Tidx, Tsegmentids>, config.block_count,
+        config.thread_per_block, 0, d.stream(), size, dim, params.data(),
+        params.dimension(0), ids.data(),
+        weights.size() == 0 ? nullptr : weights.data(), segment_ids.data(),
+        num_rows, combiner,
+        combiner == EmbeddingCombiner::kSum ? nullptr : totals.flat<T>().data(),
+        output.data());
+  }
+};
+
+template <typename T, typename Tidx, typename Tsegmentids>
+struct EmbeddingLookupSparseGradFunctor<GPUDevice, T, Tidx, Tsegmentids> {
+  Status operator()(OpKernelContext* ctx, EmbeddingCombiner combiner,
+                    typename TTypes<T, 2>::ConstTensor grad,
+                    typename TTypes<T, 2>::ConstTensor params,
+                    typename TTypes<Tidx>::ConstFlat ids,
+                    typename TTypes<T>::ConstFlat weights,
+                    typename TTypes<Tsegmentids>::ConstFlat segment_ids,
+                    typename TTypes<T, 2>::ConstTensor output,
+                    typename TTypes<T, 2>::Tensor params_grad,
+                    typename TTypes<T>::Flat weights_grad) {
+    const GPUDevice& d = ctx->eigen_gpu_device();
+    const int64 num_rows = grad.dimension(0);
+    const int64 dim = grad.dimension(1);
+    const int num_ids = ids.size();
+    if (num_ids == 0) return Status::OK();
+    Tensor totals;
+    TF_RETURN_IF_ERROR((SegmentTotals<T, Tsegmentids>(
+        ctx, combiner, weights, segment_ids, num_rows, &totals)));
+    const T* totals_data =
+        combiner == EmbeddingCombiner::kSum ? nullptr : totals.flat<T>().data();
+    const T* weights_data = weights.size() == 0 ? nullptr : weights.data();
+
+    const int size = num_ids * dim;
+    if (size > 0) {
+      GpuLaunchConfig config = GetGpuLaunchConfig(size, d);
+      TF_RETURN_IF_ERROR(GpuLaunchKernel(
+          EmbeddingLookupSparseParamsGradKernel<T, Tsegmentids>,
+          config.block_count, config.thread_per_block, 0, d.stream(), size,
+          dim, grad.data(), weights_data, segment_ids.data(), num_rows,
+          combiner, totals_data, params_grad.data()));
+    }
+    if (weights_data == nullptr) return Status::OK();
+    GpuLaunchConfig config = GetGpuLaunchConfig(num_ids, d);
+    return GpuLaunchKernel(
+        EmbeddingLookupSparseWeightsGradKernel<T, Tidx, Tsegmentids>,
+        config.block_count, config.thread_per_block, 0, d.stream(), num_ids,
+        dim, grad.data(), params.data(), params.dimension(0), ids.data(),
+        weights_data, segment_ids.data(), output.data(), num_rows, combiner,
+        totals_data, weights_grad.data());
+  }
+};
+
+}  // namespace functor
+
+#define DEFINE_GPU_SPECS_WITH_INDICES(T, Tidx, Tsegmentids)                  \
+  template struct functor::EmbeddingLookupSparseFunctor<GPUDevice, T, Tidx,  \
+                                                        Tsegmentids>;       \
+  template struct functor::EmbeddingLookupSparseGradFunctor<GPUDevice, T,    \
+                                                            Tidx,           \
+                                                            Tsegmentids>;
+
+#define DEFINE_GPU_SPECS(T)                           \
+  DEFINE_GPU_SPECS_WITH_INDICES(T, int32, int32);     \
+  DEFINE_GPU_SPECS_WITH_INDICES(T, int32, int64);     \
+  DEFINE_GPU_SPECS_WITH_INDICES(T, int64, int32);     \
+  DEFINE_GPU_SPECS_WITH_INDICES(T, int64, int64);
+
+TF_CALL_float(DEFINE_GPU_SPECS);
+TF_CALL_double(DEFINE_GPU_SPECS);
+
+#undef DEFINE_GPU_SPECS
+#undef DEFINE_GPU_SPECS_WITH_INDICES
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
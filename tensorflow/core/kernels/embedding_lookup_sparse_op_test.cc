@@ -0,0 +1,168 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class EmbeddingLookupSparseOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& combiner) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "EmbeddingLookupSparse")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("combiner", combiner)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void MakeGradOp(const string& combiner) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "EmbeddingLookupSparseGrad")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("combiner", combiner)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  void AddParams() {
+    AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8});
+  }
+  // Segment 2 has no ids.
+  void AddIdsAndWeights(bool weighted) {
+    AddInputFromArray<int64>(TensorShape({4}), {1, 3, 0, 1});
+    if (weighted) {
+      AddInputFromArray<float>(TensorShape({4}), {2, 0.5, 1, 3});
+    } else {
+      AddInputFromArray<float>(TensorShape({0}), {});
+    }
+    AddInputFromArray<int32>(TensorShape({4}), {0, 0, 1, 3});
+  }
+};
+
+TEST_F(EmbeddingLookupSparseOpTest, WeightedSum) {
+  MakeOp("sum");
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/true);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({9.5, 12, 1, 2, 0, 0, 9, 12}, {4, 2}),
+      *GetOutput(0), 1e-5);
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, WeightedMean) {
+  MakeOp("mean");
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/true);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({3.8, 4.8, 1, 2, 0, 0, 3, 4}, {4, 2}),
+      *GetOutput(0), 1e-5);
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, UnweightedSqrtN) {
+  MakeOp("sqrtn");
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/false);
+  TF_ASSERT_OK(RunOpKernel());
+  const float s = 1 / std::sqrt(2.0f);
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({10 * s, 12 * s, 1, 2, 0, 0, 3, 4}, {4, 2}),
+      *GetOutput(0), 1e-5);
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, RejectsOutOfRangeIds) {
+  MakeOp("sum");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({2}), {1, 4});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  AddInputFromArray<int32>(TensorShape({2}), {0, 1});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "is not in [0, 4)")) << s;
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, RejectsUnsortedSegments) {
+  MakeOp("sum");
+  AddParams();
+  AddInputFromArray<int64>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({0}), {});
+  AddInputFromArray<int32>(TensorShape({2}), {1, 0});
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.ToString(), "not increasing")) << s;
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, WeightedSumGrad) {
+  MakeGradOp("sum");
+  AddInputFromArray<float>(TensorShape({4, 2}), {1, 1, 1, 1, 1, 1, 1, 1});
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/true);
+  AddInputFromArray<float>(TensorShape({4, 2}), {9.5, 12, 1, 2, 0, 0, 9, 12});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({2, 2, 0.5, 0.5, 1, 1, 3, 3}, {4, 2}),
+      *GetOutput(0), 1e-5);
+  test::ExpectTensorNear<float>(test::AsTensor<float>({7, 15, 3, 7}),
+                                *GetOutput(1), 1e-5);
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, WeightedMeanGrad) {
+  MakeGradOp("mean");
+  AddInputFromArray<float>(TensorShape({4, 2}), {1, 1, 1, 1, 1, 1, 1, 1});
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/true);
+  AddInputFromArray<float>(TensorShape({4, 2}), {3.8, 4.8, 1, 2, 0, 0, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({0.8, 0.8, 0.2, 0.2, 1, 1, 1, 1}, {4, 2}),
+      *GetOutput(0), 1e-5);
+  test::ExpectTensorNear<float>(test::AsTensor<float>({-0.64, 2.56, 0, 0}),
+                                *GetOutput(1), 1e-5);
+}
+
+TEST_F(EmbeddingLookupSparseOpTest, UnweightedGrad) {
+  MakeGradOp("sqrtn");
+  AddInputFromArray<float>(TensorShape({4, 2}), {1, 2, 3, 4, 0, 0, 5, 6});
+  AddParams();
+  AddIdsAndWeights(/*weighted=*/false);
+  AddInputFromArray<float>(TensorShape({4, 2}), {0, 0, 0, 0, 0, 0, 0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  const float s = 1 / std::sqrt(2.0f);
+  test::ExpectTensorNear<float>(
+      test::AsTensor<float>({s, 2 * s, s, 2 * s, 3, 4, 5, 6}, {4, 2}),
+      *GetOutput(0), 1e-5);
+  EXPECT_EQ(0, GetOutput(1)->NumElements());
+}
+
+}  // namespace
+}  // namespace tensorflow
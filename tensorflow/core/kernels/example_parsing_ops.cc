@@ -15,7 +15,9 @@ limitations under the License.
 
 // See docs in ../ops/parsing_ops.cc.
 
+#include <algorithm>
 #include <numeric>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -28,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
@@ -1191,6 +1195,375 @@ class ParseSingleSequenceExampleOp : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("ParseSingleSequenceExample").Device(DEVICE_CPU),
                         ParseSingleSequenceExampleOp);
 
+// Parses serialized Example protos and transforms their features into the
+// sparse ids and weights that embedding lookups consume.  This fuses
+// ParseExampleV2 with the StringToHashBucketFast, Bucketize, SparseCross and
+// SparseFillEmptyRows ops that feature columns add after it, without the
+// intermediate tensors of the unfused graph.
+class ParseExampleFeatureIdsOp : public OpKernel {
+ public:
+  explicit ParseExampleFeatureIdsOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    std::vector<string> keys, transforms;
+    std::vector<int64> num_buckets;
+    std::vector<float> boundaries;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("feature_keys", &keys));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("feature_transforms", &transforms));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_buckets", &num_buckets));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("boundaries", &boundaries));
+    OP_REQUIRES(ctx,
+                transforms.size() == keys.size() &&
+                    num_buckets.size() == keys.size(),
+                errors::InvalidArgument(
+                    "feature_keys, feature_transforms and num_buckets must "
+                    "have the same length, got ",
+                    keys.size(), ", ", transforms.size(), " and ",
+                    num_buckets.size()));
+
+    // Features that share a key are parsed once.
+    std::unordered_map<string, int> ragged_index;
+    int64 num_boundaries = 0;
+    for (size_t i = 0; i < keys.size(); ++i) {
+      Feature feature;
+      feature.num_buckets = num_buckets[i];
+      DataType dtype;
+      if (transforms[i] == "hash_bucket") {
+        feature.transform = Transform::kHashBucket;
+        dtype = DT_STRING;
+      } else if (transforms[i] == "identity") {
+        feature.transform = Transform::kIdentity;
+        dtype = DT_INT64;
+      } else if (transforms[i] == "bucketize") {
+        feature.transform = Transform::kBucketize;
+        dtype = DT_FLOAT;
+      } else {
+        OP_REQUIRES(ctx, false,
+                    errors::InvalidArgument(
+                        "Unknown transform of feature ", keys[i], ": ",
+                        transforms[i],
+                        ", expected hash_bucket, identity or bucketize"));
+      }
+      OP_REQUIRES(ctx, feature.num_buckets > 0,
+                  errors::InvalidArgument("num_buckets of feature ", keys[i],
+                                          " must be positive, got ",
+                                          feature.num_buckets));
+      if (feature.transform == Transform::kBucketize) {
+        // A bucketized feature has one more bucket than boundaries.
+        OP_REQUIRES(
+            ctx, num_boundaries + feature.num_buckets - 1 <= boundaries.size(),
+            errors::InvalidArgument("Not enough boundaries for feature ",
+                                    keys[i]));
+        feature.boundaries.assign(
+            boundaries.begin() + num_boundaries,
+            boundaries.begin() + num_boundaries + feature.num_buckets - 1);
+        num_boundaries += feature.num_buckets - 1;
+        OP_REQUIRES(ctx,
+                    std::is_sorted(feature.boundaries.begin(),
+                                   feature.boundaries.end()),
+                    errors::InvalidArgument("Boundaries of feature ", keys[i],
+                                            " must be sorted"));
+      }
+
+      auto it = ragged_index.find(keys[i]);
+      if (it == ragged_index.end()) {
+        it = ragged_index.emplace(keys[i], config_.ragged.size()).first;
+        config_.ragged.emplace_back(keys[i], dtype, DT_INT64);
+      }
+      OP_REQUIRES(ctx, config_.ragged[it->second].dtype == dtype,
+                  errors::InvalidArgument("Feature ", keys[i],
+                                          " is used with different types"));
+      feature.ragged_index = it->second;
+      features_.push_back(std::move(feature));
+    }
+    OP_REQUIRES(ctx, num_boundaries == boundaries.size(),
+                errors::InvalidArgument("Got ", boundaries.size(),
+                                        " boundaries but the bucketized "
+                                        "features use ",
+                                        num_boundaries));
+
+    std::vector<int32> cross_sizes, cross_features;
+    std::vector<int64> cross_num_buckets;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("cross_sizes", &cross_sizes));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("cross_features", &cross_features));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("cross_num_buckets", &cross_num_buckets));
+    OP_REQUIRES(ctx, cross_num_buckets.size() == cross_sizes.size(),
+                errors::InvalidArgument(
+                    "cross_sizes and cross_num_buckets must have the same "
+                    "length, got ",
+                    cross_sizes.size(), " and ", cross_num_buckets.size()));
+    size_t num_crossed = 0;
+    for (size_t i = 0; i < cross_sizes.size(); ++i) {
+      OP_REQUIRES(ctx,
+                  cross_sizes[i] > 0 &&
+                      num_crossed + cross_sizes[i] <= cross_features.size(),
+                  errors::InvalidArgument("Invalid size of cross ", i, ": ",
+                                          cross_sizes[i]));
+      Cross cross;
+      cross.num_buckets = cross_num_buckets[i];
+      OP_REQUIRES(ctx, cross.num_buckets > 0,
+                  errors::InvalidArgument("num_buckets of cross ", i,
+                                          " must be positive, got ",
+                                          cross.num_buckets));
+      for (int j = 0; j < cross_sizes[i]; ++j) {
+        const int feature = cross_features[num_crossed++];
+        OP_REQUIRES(ctx, feature >= 0 && feature < features_.size(),
+                    errors::InvalidArgument("Cross ", i,
+                                            " uses an invalid feature ",
+                                            feature));
+        cross.features.push_back(feature);
+      }
+      crosses_.push_back(std::move(cross));
+    }
+    OP_REQUIRES(ctx, num_crossed == cross_features.size(),
+                errors::InvalidArgument(
+                    "cross_features has ", cross_features.size(),
+                    " elements but the crosses use ", num_crossed));
+
+    int64 hash_key;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("hash_key", &hash_key));
+    hash_key_ = hash_key;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("fill_empty_rows", &fill_empty_rows_));
+    int num_outputs;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_outputs", &num_outputs));
+    OP_REQUIRES(ctx, num_outputs == features_.size() + crosses_.size(),
+                errors::InvalidArgument(
+                    "num_outputs must be the number of features plus the "
+                    "number of crosses, got ",
+                    num_outputs, " for ", features_.size(), " features and ",
+                    crosses_.size(), " crosses"));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* serialized;
+    OP_REQUIRES_OK(ctx, ctx->input("serialized", &serialized));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(serialized->shape()),
+                errors::InvalidArgument(
+                    "Expected serialized to be a vector, got shape: ",
+                    serialized->shape().DebugString()));
+    const int64 batch_size = serialized->NumElements();
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+
+    example::Result result;
+    OP_REQUIRES_OK(
+        ctx, FastParseExample(
+                 config_,
+                 gtl::ArraySlice<tstring>(serialized->flat<tstring>().data(),
+                                          batch_size),
+                 {}, worker_threads.workers, &result));
+
+    // The ids of every feature, in the ragged layout of the parsed values.
+    std::vector<std::vector<int64>> feature_ids(features_.size());
+    std::vector<const int64*> feature_splits(features_.size());
+    for (size_t i = 0; i < features_.size(); ++i) {
+      const int r = features_[i].ragged_index;
+      feature_splits[i] = result.ragged_splits[r].vec<int64>().data();
+      OP_REQUIRES_OK(ctx, TransformFeature(worker_threads, features_[i],
+                                           result.ragged_values[r],
+                                           &feature_ids[i]));
+    }
+
+    OpOutputList indices, ids, weights, shapes;
+    OP_REQUIRES_OK(ctx, ctx->output_list("indices", &indices));
+    OP_REQUIRES_OK(ctx, ctx->output_list("ids", &ids));
+    OP_REQUIRES_OK(ctx, ctx->output_list("weights", &weights));
+    OP_REQUIRES_OK(ctx, ctx->output_list("dense_shapes", &shapes));
+    int output = 0;
+    for (size_t i = 0; i < features_.size(); ++i) {
+      OP_REQUIRES_OK(ctx, EmitOutput(output++, batch_size, feature_splits[i],
+                                     feature_ids[i].data(), &indices, &ids,
+                                     &weights, &shapes));
+    }
+    for (const Cross& cross : crosses_) {
+      std::vector<int64> splits, cross_ids;
+      CrossFeatures(worker_threads, cross, batch_size, feature_splits,
+                    feature_ids, &splits, &cross_ids);
+      OP_REQUIRES_OK(ctx, EmitOutput(output++, batch_size, splits.data(),
+                                     cross_ids.data(), &indices, &ids,
+                                     &weights, &shapes));
+    }
+  }
+
+ private:
+  enum class Transform { kHashBucket, kIdentity, kBucketize };
+
+  struct Feature {
+    int ragged_index;
+    Transform transform;
+    int64 num_buckets;
+    std::vector<float> boundaries;
+  };
+
+  struct Cross {
+    std::vector<int> features;
+    int64 num_buckets;
+  };
+
+  // Computes the ids of the parsed "values" of "feature", as
+  // StringToHashBucketFast, the identity or Bucketize would.
+  Status TransformFeature(const DeviceBase::CpuWorkerThreads& worker_threads,
+                          const Feature& feature, const Tensor& values,
+                          std::vector<int64>* ids) const {
+    const int64 num_values = values.NumElements();
+    ids->resize(num_values);
+    int64* out = ids->data();
+    mutex mu;
+    Status status;
+    auto transform = [&](int64 start, int64 limit) {
+      switch (feature.transform) {
+        case Transform::kHashBucket: {
+          const tstring* in = values.flat<tstring>().data();
+          for (int64 j = start; j < limit; ++j) {
+            out[j] = Fingerprint64(in[j]) % feature.num_buckets;
+          }
+          break;
+        }
+        case Transform::kIdentity: {
+          const int64* in = values.flat<int64>().data();
+          for (int64 j = start; j < limit; ++j) {
+            if (TF_PREDICT_FALSE(in[j] < 0 || in[j] >= feature.num_buckets)) {
+              mutex_lock l(mu);
+              status.Update(errors::InvalidArgument(
+                  "Feature ", config_.ragged[feature.ragged_index].feature_name,
+                  " has the id ", in[j], ", which is not in [0, ",
+                  feature.num_buckets, ")"));
+              return;
+            }
+            out[j] = in[j];
+          }
+          break;
+        }
+        case Transform::kBucketize: {
+          const float* in = values.flat<float>().data();
+          for (int64 j = start; j < limit; ++j) {
+            out[j] = std::upper_bound(feature.boundaries.begin(),
+                                      feature.boundaries.end(), in[j]) -
+                     feature.boundaries.begin();
+          }
+          break;
+        }
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, num_values,
+          /*cost_per_unit=*/50, transform);
+    return status;
+  }
+
+  // Crosses the ids of the features of "cross" in every example, hashing
+  // them as SparseCrossHashed does.  The id of the last feature varies
+  // fastest.
+  void CrossFeatures(const DeviceBase::CpuWorkerThreads& worker_threads,
+                     const Cross& cross, int64 batch_size,
+                     const std::vector<const int64*>& feature_splits,
+                     const std::vector<std::vector<int64>>& feature_ids,
+                     std::vector<int64>* splits,
+                     std::vector<int64>* ids) const {
+    const int num_crossed = cross.features.size();
+    splits->assign(batch_size + 1, 0);
+    for (int64 b = 0; b < batch_size; ++b) {
+      int64 count = 1;
+      for (const int f : cross.features) {
+        count *= feature_splits[f][b + 1] - feature_splits[f][b];
+      }
+      (*splits)[b + 1] = (*splits)[b] + count;
+    }
+    ids->resize(splits->back());
+
+    auto cross_rows = [&](int64 start, int64 limit) {
+      std::vector<int64> position(num_crossed);
+      for (int64 b = start; b < limit; ++b) {
+        if ((*splits)[b + 1] == (*splits)[b]) continue;
+        std::fill(position.begin(), position.end(), 0);
+        for (int64 k = (*splits)[b]; k < (*splits)[b + 1]; ++k) {
+          uint64 hash = hash_key_;
+          for (int i = 0; i < num_crossed; ++i) {
+            const int f = cross.features[i];
+            hash = FingerprintCat64(
+                hash, feature_ids[f][feature_splits[f][b] + position[i]]);
+          }
+          (*ids)[k] = hash % cross.num_buckets;
+          // Advances to the next element of the product.
+          for (int i = num_crossed - 1; i >= 0; --i) {
+            const int f = cross.features[i];
+            const int64 row_size =
+                feature_splits[f][b + 1] - feature_splits[f][b];
+            if (++position[i] < row_size) break;
+            position[i] = 0;
+          }
+        }
+      }
+    };
+    const int64 cost_per_example =
+        50 * num_crossed * std::max<int64>(1, ids->size() / batch_size);
+    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+          cost_per_example, cross_rows);
+  }
+
+  // Allocates output "output" for the ids "ids" of the examples, whose ranges
+  // are given by "splits", and fills the empty rows if requested.
+  Status EmitOutput(int output, int64 batch_size, const int64* splits,
+                    const int64* ids, OpOutputList* indices,
+                    OpOutputList* id_values, OpOutputList* weights,
+                    OpOutputList* shapes) const {
+    int64 num_empty_rows = 0;
+    int64 max_row_size = 0;
+    for (int64 b = 0; b < batch_size; ++b) {
+      const int64 row_size = splits[b + 1] - splits[b];
+      if (row_size == 0) ++num_empty_rows;
+      max_row_size = std::max(max_row_size, row_size);
+    }
+    if (!fill_empty_rows_) num_empty_rows = 0;
+    if (num_empty_rows > 0) max_row_size = std::max<int64>(max_row_size, 1);
+    const int64 nnz = splits[batch_size] + num_empty_rows;
+
+    Tensor* indices_t;
+    TF_RETURN_IF_ERROR(
+        indices->allocate(output, TensorShape({nnz, 2}), &indices_t));
+    Tensor* ids_t;
+    TF_RETURN_IF_ERROR(id_values->allocate(output, TensorShape({nnz}), &ids_t));
+    Tensor* weights_t;
+    TF_RETURN_IF_ERROR(
+        weights->allocate(output, TensorShape({nnz}), &weights_t));
+    Tensor* shape_t;
+    TF_RETURN_IF_ERROR(shapes->allocate(output, TensorShape({2}), &shape_t));
+    shape_t->vec<int64>()(0) = batch_size;
+    shape_t->vec<int64>()(1) = max_row_size;
+
+    auto indices_m = indices_t->matrix<int64>();
+    auto ids_v = ids_t->vec<int64>();
+    auto weights_v = weights_t->vec<float>();
+    int64 k = 0;
+    for (int64 b = 0; b < batch_size; ++b) {
+      if (splits[b + 1] == splits[b] && fill_empty_rows_) {
+        // As SparseFillEmptyRows with a default id of 0 and a zero weight,
+        // so that the row does not contribute to an embedding combiner.
+        indices_m(k, 0) = b;
+        indices_m(k, 1) = 0;
+        ids_v(k) = 0;
+        weights_v(k) = 0.0f;
+        ++k;
+        continue;
+      }
+      for (int64 j = splits[b]; j < splits[b + 1]; ++j, ++k) {
+        indices_m(k, 0) = b;
+        indices_m(k, 1) = j - splits[b];
+        ids_v(k) = ids[j];
+        weights_v(k) = 1.0f;
+      }
+    }
+    return Status::OK();
+  }
+
+  example::FastParseExampleConfig config_;
+  std::vector<Feature> features_;
+  std::vector<Cross> crosses_;
+  uint64 hash_key_;
+  bool fill_empty_rows_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParseExampleFeatureIds").Device(DEVICE_CPU),
+                        ParseExampleFeatureIdsOp);
+
 #ifndef IS_MOBILE_PLATFORM
 // when using lite protos on mobile, decoding JSON is not available.
 
@@ -50,6 +50,30 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  // Fast path: if no other enqueue is waiting and there is room, enqueue
+  // right away instead of queueing an attempt and registering for
+  // cancellation. Only ops that would otherwise block take the attempt path.
+  if (!cm->IsCancelled()) {
+    bool enqueued = false;
+    bool has_dequeue_attempts = false;
+    {
+      mutex_lock l(mu_);
+      if (!closed_ && enqueue_attempts_.empty() &&
+          queues_[0].size() < static_cast<size_t>(capacity_)) {
+        for (int i = 0; i < num_components(); ++i) {
+          queues_[i].push_back(PersistentTensor(tuple[i]));
+        }
+        enqueued = true;
+        has_dequeue_attempts = !dequeue_attempts_.empty();
+      }
+    }
+    if (enqueued) {
+      if (has_dequeue_attempts) FlushUnlocked();
+      callback();
+      return;
+    }
+  }
+
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
@@ -154,6 +178,27 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
   CancellationManager* cm = ctx->cancellation_manager();
+  // Fast path: if no other dequeue is waiting and an element is available,
+  // dequeue it right away (see TryEnqueue).
+  if (!cm->IsCancelled()) {
+    Tuple tuple;
+    bool dequeued = false;
+    bool has_enqueue_attempts = false;
+    {
+      mutex_lock l(mu_);
+      if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+        DequeueLocked(ctx, &tuple);
+        dequeued = true;
+        has_enqueue_attempts = !enqueue_attempts_.empty();
+      }
+    }
+    if (dequeued) {
+      if (has_enqueue_attempts) FlushUnlocked();
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
   {
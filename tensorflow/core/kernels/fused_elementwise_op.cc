@@ -0,0 +1,199 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedElementwiseChain op, which Grappler's remapper creates
+// from chains of unary element-wise ops. On CPU the chain is applied to one
+// cache-sized block at a time, and on GPU by a single kernel that keeps the
+// intermediate results in registers.
+
+#define EIGEN_USE_THREADS
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define EIGEN_USE_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+// Number of elements that every op of the chain processes before the next op
+// runs. Two blocks (the input and the output) fit into the L1 cache of the
+// machines we care about.
+constexpr int64 kBlockSize = 2048;
+
+// Parses `name` into `op`, and adds the cost per element of the op to `cost`.
+template <typename T>
+Status ParseFusedElementwiseOp(const string& name, FusedElementwiseOp* op,
+                               int64* cost) {
+#define PARSE_OP(op_name, functor_name)                 \
+  if (name == #op_name) {                               \
+    *op = FusedElementwiseOp::k##op_name;               \
+    *cost += Eigen::internal::functor_traits<           \
+        typename functor::functor_name<T>::func>::Cost; \
+    return Status::OK();                                \
+  }
+  TF_CALL_FUSED_ELEMENTWISE_OPS(PARSE_OP)
+#undef PARSE_OP
+  if (name == "Relu") {
+    *op = FusedElementwiseOp::kRelu;
+    *cost += Eigen::internal::functor_traits<
+        Eigen::internal::scalar_max_op<T>>::Cost;
+    return Status::OK();
+  }
+  return errors::Unimplemented("Unsupported fused element-wise op: ", name);
+}
+
+template <typename T>
+void ApplyFusedElementwiseOp(FusedElementwiseOp op,
+                             typename TTypes<T>::ConstFlat in,
+                             typename TTypes<T>::Flat out) {
+  switch (op) {
+#define APPLY_OP(op_name, functor_name)                            \
+  case FusedElementwiseOp::k##op_name:                             \
+    out = in.unaryExpr(typename functor::functor_name<T>::func()); \
+    return;
+    TF_CALL_FUSED_ELEMENTWISE_OPS(APPLY_OP)
+#undef APPLY_OP
+    case FusedElementwiseOp::kRelu:
+      out = in.cwiseMax(static_cast<T>(0));
+      return;
+  }
+}
+
+template <typename Device, typename T>
+struct LaunchFusedElementwiseChain;
+
+template <typename T>
+struct LaunchFusedElementwiseChain<CPUDevice, T> {
+  static void Run(OpKernelContext* context,
+                  const std::vector<FusedElementwiseOp>& fused_ops, int64 cost,
+                  const T* in, T* out, int64 num_elements) {
+    auto apply_chain = [&fused_ops, in, out](int64 start, int64 limit) {
+      for (int64 begin = start; begin < limit; begin += kBlockSize) {
+        const int64 size = std::min(kBlockSize, limit - begin);
+        typename TTypes<T>::Flat block(out + begin, size);
+        ApplyFusedElementwiseOp<T>(
+            fused_ops[0], typename TTypes<T>::ConstFlat(in + begin, size),
+            block);
+        for (int i = 1; i < fused_ops.size(); ++i) {
+          ApplyFusedElementwiseOp<T>(
+              fused_ops[i], typename TTypes<T>::ConstFlat(out + begin, size),
+              block);
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_elements,
+          cost, apply_chain);
+  }
+};
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+template <typename T>
+struct LaunchFusedElementwiseChain<GPUDevice, T> {
+  static void Run(OpKernelContext* context,
+                  const std::vector<FusedElementwiseOp>& fused_ops, int64 cost,
+                  const T* in, T* out, int64 num_elements) {
+    OP_REQUIRES(context, fused_ops.size() <= FusedElementwiseOps::kMaxOps,
+                errors::InvalidArgument(
+                    "At most ", FusedElementwiseOps::kMaxOps,
+                    " ops can be fused on GPU, got ", fused_ops.size()));
+    FusedElementwiseOps ops;
+    ops.num_ops = fused_ops.size();
+    std::copy(fused_ops.begin(), fused_ops.end(), ops.ops);
+    functor::FusedElementwiseChain<GPUDevice, T>()(
+        context->eigen_device<GPUDevice>(), ops, in, out, num_elements);
+  }
+};
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedElementwiseChainOp : public OpKernel {
+ public:
+  explicit FusedElementwiseChainOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument("fused_ops must not be empty"));
+    fused_ops_.resize(fused_ops.size());
+    for (int i = 0; i < fused_ops.size(); ++i) {
+      OP_REQUIRES_OK(context, ParseFusedElementwiseOp<T>(
+                                  fused_ops[i], &fused_ops_[i], &cost_));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& input = context->input(0);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, input.shape(), &output));
+    const int64 num_elements = input.NumElements();
+    if (num_elements == 0) return;
+
+    LaunchFusedElementwiseChain<Device, T>::Run(
+        context, fused_ops_, cost_, input.flat<T>().data(),
+        output->flat<T>().data(), num_elements);
+  }
+
+ private:
+  std::vector<FusedElementwiseOp> fused_ops_;
+  // Estimated cost of the whole chain per element, in cycles.
+  int64 cost_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedElementwiseChainOp);
+};
+
+#define REGISTER_CPU(T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwiseChain")  \
+                              .Device(DEVICE_CPU)         \
+                              .TypeConstraint<T>("T"),    \
+                          FusedElementwiseChainOp<CPUDevice, T>);
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+#undef REGISTER_CPU
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GPU(T)                                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedElementwiseChain")  \
+                              .Device(DEVICE_GPU)         \
+                              .TypeConstraint<T>("T"),    \
+                          FusedElementwiseChainOp<GPUDevice, T>);
+TF_CALL_half(REGISTER_GPU);
+TF_CALL_float(REGISTER_GPU);
+TF_CALL_double(REGISTER_GPU);
+#undef REGISTER_GPU
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
+#define TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
+// Functor definition for FusedElementwiseChainOp, must be compilable by nvcc.
+
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// The ops that can be fused, with the functor from cwise_ops.h that
+// implements them. Relu is not a cwise op and is handled separately.
+#define TF_CALL_FUSED_ELEMENTWISE_OPS(m)                                \
+  m(Ceil, ceil) m(Cos, cos) m(Exp, exp) m(Expm1, expm1) m(Floor, floor) \
+  m(Inv, inverse) m(Log, log) m(Log1p, log1p) m(Neg, neg)               \
+  m(Reciprocal, inverse) m(Rsqrt, rsqrt) m(Sigmoid, sigmoid)            \
+  m(Sign, sign) m(Sin, sin) m(Sqrt, sqrt) m(Square, square) m(Tanh, tanh)
+
+enum class FusedElementwiseOp {
+#define DECLARE_OP(name, functor_name) k##name,
+  TF_CALL_FUSED_ELEMENTWISE_OPS(DECLARE_OP)
+#undef DECLARE_OP
+  kRelu,
+};
+
+// The chain of a FusedElementwiseChainOp, passed by value to the GPU kernel.
+struct FusedElementwiseOps {
+  // Grappler's remapper doesn't create longer chains on GPU.
+  static constexpr int kMaxOps = 16;
+
+  int num_ops = 0;
+  FusedElementwiseOp ops[kMaxOps];
+};
+
+namespace functor {
+
+// Applies `ops` to the `size` elements of `in`, in a single pass that keeps
+// the intermediate results in registers. `in` and `out` may alias.
+template <typename Device, typename T>
+struct FusedElementwiseChain {
+  void operator()(const Device& d, const FusedElementwiseOps& ops,
+                  const T* in, T* out, int64 size);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_FUSED_ELEMENTWISE_OP_H_
@@ -0,0 +1,91 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#define EIGEN_USE_GPU
+
+#include <algorithm>
+#include <limits>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/kernels/fused_elementwise_op.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
+#include "tensorflow/core/util/gpu_launch_config.h"
+
+namespace tensorflow {
+
+typedef Eigen::GpuDevice GPUDevice;
+
+namespace {
+
+template <typename T>
+__device__ T ApplyFusedElementwiseOp(FusedElementwiseOp op, T x) {
+  switch (op) {
+#define APPLY_OP(op_name, functor_name)                  \
+  case FusedElementwiseOp::k##op_name:                   \
+    return typename functor::functor_name<T>::func()(x);
+    TF_CALL_FUSED_ELEMENTWISE_OPS(APPLY_OP)
+#undef APPLY_OP
+    case FusedElementwiseOp::kRelu:
+      return Eigen::numext::maxi(x, static_cast<T>(0));
+  }
+  return x;
+}
+
+// `ops` is a kernel parameter, so every thread reads it from constant memory.
+// `in` is not read through the read-only cache since it may alias `out`.
+template <typename T>
+__global__ void FusedElementwiseChainKernel(FusedElementwiseOps ops,
+                                            const T* in, T* out, int64 size) {
+  for (int64 i : GpuGridRangeX(size)) {
+    T x = in[i];
+    for (int j = 0; j < ops.num_ops; ++j) {
+      x = ApplyFusedElementwiseOp(ops.ops[j], x);
+    }
+    out[i] = x;
+  }
+}
+
+}  // namespace
+
+namespace functor {
+
+template <typename T>
+struct FusedElementwiseChain<GPUDevice, T> {
+  void operator()(const GPUDevice& d, const FusedElementwiseOps& ops,
+                  const T* in, T* out, int64 size) {
+    if (size == 0) return;
+    // The kernel loops over the elements, so the number of blocks doesn't
+    // need to cover all of them.
+    const int count = static_cast<int>(
+        std::min<int64>(size, std::numeric_limits<int>::max()));
+    GpuLaunchConfig config =
+        GetGpuLaunchConfig(count, d, FusedElementwiseChainKernel<T>, 0, 0);
+    TF_CHECK_OK(GpuLaunchKernel(FusedElementwiseChainKernel<T>,
+                                config.block_count, config.thread_per_block, 0,
+                                d.stream(), ops, in, out, size));
+  }
+};
+
+template struct FusedElementwiseChain<GPUDevice, Eigen::half>;
+template struct FusedElementwiseChain<GPUDevice, float>;
+template struct FusedElementwiseChain<GPUDevice, double>;
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseChainOpTest : public OpsTestBase {
+ protected:
+  Status Init(const std::vector<string>& fused_ops) {
+    TF_CHECK_OK(NodeDefBuilder("op", "_FusedElementwiseChain")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("fused_ops", fused_ops)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseChainOpTest, AppliesOpsInOrder) {
+  TF_ASSERT_OK(Init({"Neg", "Relu", "Square"}));
+  AddInputFromArray<float>(TensorShape({2, 3}), {-3, -2, -1, 0, 1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {9, 4, 1, 0, 0, 0});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseChainOpTest, SpansSeveralBlocks) {
+  TF_ASSERT_OK(Init({"Exp", "Tanh", "Sigmoid"}));
+  const int num_elements = 10000;
+  std::vector<float> input(num_elements);
+  std::vector<float> expected_values(num_elements);
+  for (int i = 0; i < num_elements; ++i) {
+    input[i] = (i % 200 - 100) / 25.0f;
+    const float tanh_exp = std::tanh(std::exp(input[i]));
+    expected_values[i] = 1.0f / (1.0f + std::exp(-tanh_exp));
+  }
+  AddInputFromArray<float>(TensorShape({num_elements}), input);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({num_elements}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedElementwiseChainOpTest, UnsupportedOp) {
+  const Status status = Init({"Exp", "Softplus"});
+  EXPECT_TRUE(errors::IsUnimplemented(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/gather_nd_op.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
 
@@ -81,6 +82,20 @@ class GatherNdSliceGenerator {
     return static_cast<int32>(0);  // Return something...
   }
 
+  // Prefetches the first "num_bytes" of the slice of params that row "loc" of
+  // the indices points to, if it is in bounds.
+  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE void Prefetch(
+      const Index loc, const int num_bytes) const {
+    Eigen::array<Eigen::DenseIndex, IXDIM + 1> ix;
+    if (TF_PREDICT_FALSE(GenerateIndices(loc, &ix))) return;
+    const char* slice = reinterpret_cast<const char*>(&Tparams_(ix));
+    for (int offset = 0; offset < num_bytes; offset += kCacheLineSize) {
+      port::prefetch<port::PREFETCH_HINT_T0>(slice + offset);
+    }
+  }
+
+  static constexpr int kCacheLineSize = 64;
+
  private:
   const Index slice_size_;
   const typename TTypes<Index>::ConstMatrix Tindices_;
@@ -105,8 +120,18 @@ struct GatherNdSlice<CPUDevice, T, Index, IXDIM> {
     generator::GatherNdSliceGenerator<T, Index, IXDIM> gather_nd_generator(
         slice_size, Tindices, Tparams, Tout, &error_loc);
 
+    // Copies of slices that span only a few cache lines are bound by the
+    // latency of loading them when the indices are random, so the slice of a
+    // later index row is prefetched while the current one is copied.
+    constexpr Eigen::Index kPrefetchDistance = 8;
+    constexpr Eigen::Index kMaxPrefetchBytes = 512;
+    const Eigen::Index slice_bytes = slice_size * sizeof(T);
+    const bool prefetch = slice_bytes > 0 && slice_bytes <= kMaxPrefetchBytes;
     auto compute_shard = [&](Eigen::Index begin, Eigen::Index end) {
       for (Eigen::Index i = begin; i < end; ++i) {
+        if (prefetch && i + kPrefetchDistance < end) {
+          gather_nd_generator.Prefetch(i + kPrefetchDistance, slice_bytes);
+        }
         const Eigen::array<Eigen::Index, 1> loc{i};
         gather_nd_generator(loc);
       }
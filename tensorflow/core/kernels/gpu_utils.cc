@@ -22,9 +22,12 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/logger.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
 #include "tensorflow/core/protobuf/conv_autotuning.pb.h"
+#include "tensorflow/core/util/autotune_results_file.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 #include "tensorflow/stream_executor/gpu/asm_compiler.h"
@@ -121,8 +124,108 @@ tensorflow::ComputeCapability GetComputeCapability(
   return cc;
 }
 
+// The autotune results file, from TF_GPU_AUTOTUNE_RESULTS_PATH.
+const string& GpuAutotuneResultsPath() {
+  static const string* path = [] {
+    string* path = new string;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GPU_AUTOTUNE_RESULTS_PATH",
+                                     /*default_val=*/"", path));
+    return path;
+  }();
+  return *path;
+}
+
+// Returns AutotuneDeviceKey(stream_exec), which queries the libraries, once
+// per StreamExecutor.
+string CachedAutotuneDeviceKey(se::StreamExecutor* stream_exec) {
+  static mutex mu(LINKER_INITIALIZED);
+  static auto& keys = *new absl::flat_hash_map<se::StreamExecutor*, string>();
+  mutex_lock lock(mu);
+  auto it = keys.find(stream_exec);
+  if (it == keys.end()) {
+    it = keys.emplace(stream_exec, AutotuneDeviceKey(stream_exec)).first;
+  }
+  return it->second;
+}
+
 }  // namespace
 
+bool LookupGpuAutotuneResult(se::StreamExecutor* stream_exec, const string& key,
+                             AutotuneResult* result) {
+  const string& path = GpuAutotuneResultsPath();
+  if (path.empty()) {
+    return false;
+  }
+  absl::optional<AutotuneResult> stored =
+      LookupAutotuneResult(path, CachedAutotuneDeviceKey(stream_exec), key);
+  if (!stored.has_value()) {
+    return false;
+  }
+  *result = *stored;
+  return true;
+}
+
+void StoreGpuAutotuneResult(se::StreamExecutor* stream_exec, const string& key,
+                            const AutotuneResult& result) {
+  const string& path = GpuAutotuneResultsPath();
+  if (!path.empty()) {
+    StoreAutotuneResult(path, CachedAutotuneDeviceKey(stream_exec), key,
+                        result);
+  }
+}
+
+bool ToAutotuneResult(const se::dnn::AlgorithmConfig& config,
+                      AutotuneResult* result) {
+  if (!config.algorithm().has_value()) {
+    return false;
+  }
+  result->mutable_conv()->set_algorithm(config.algorithm()->algo_id());
+  result->mutable_conv()->set_tensor_ops_enabled(
+      config.algorithm()->tensor_ops_enabled());
+  if (config.algorithm_no_scratch().has_value()) {
+    result->mutable_conv_no_scratch()->set_algorithm(
+        config.algorithm_no_scratch()->algo_id());
+    result->mutable_conv_no_scratch()->set_tensor_ops_enabled(
+        config.algorithm_no_scratch()->tensor_ops_enabled());
+  }
+  if (config.scratch_size().has_value()) {
+    result->set_scratch_bytes(*config.scratch_size());
+  }
+  return true;
+}
+
+bool FromAutotuneResult(const AutotuneResult& result,
+                        se::dnn::AlgorithmConfig* config) {
+  if (!result.has_conv()) {
+    return false;
+  }
+  *config = se::dnn::AlgorithmConfig(
+      se::dnn::AlgorithmDesc(result.conv().algorithm(),
+                             result.conv().tensor_ops_enabled()),
+      result.scratch_bytes());
+  if (result.has_conv_no_scratch()) {
+    config->set_algorithm_no_scratch(se::dnn::AlgorithmDesc(
+        result.conv_no_scratch().algorithm(),
+        result.conv_no_scratch().tensor_ops_enabled()));
+  }
+  return true;
+}
+
+bool ToAutotuneResult(const se::blas::AlgorithmConfig& config,
+                      AutotuneResult* result) {
+  result->mutable_gemm()->set_algorithm(config.algorithm());
+  return true;
+}
+
+bool FromAutotuneResult(const AutotuneResult& result,
+                        se::blas::AlgorithmConfig* config) {
+  if (!result.has_gemm()) {
+    return false;
+  }
+  config->set_algorithm(result.gemm().algorithm());
+  return true;
+}
+
 void LogConvAutotuneResults(se::dnn::ConvolutionKind kind,
                             se::dnn::DataType element_type,
                             se::DeviceMemoryBase input_buffer,
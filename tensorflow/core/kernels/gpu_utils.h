@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
 
 namespace stream_executor {
 class RedzoneAllocator;
@@ -36,7 +37,6 @@ class RedzoneAllocator;
 namespace tensorflow {
 
 class NodeDef;
-class AutotuneResult;
 
 // Return whether the redzone check is disabled.
 //
@@ -66,6 +66,38 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Looks up the autotune result stored for `key` on `stream_exec` in the file
+// named by the TF_GPU_AUTOTUNE_RESULTS_PATH environment variable. Returns false
+// if the variable is unset or the file has no such result. The file format is
+// described in tensorflow/core/util/autotune_results_file.h, and can be shared
+// with XLA's xla_gpu_autotune_results_path.
+bool LookupGpuAutotuneResult(se::StreamExecutor* stream_exec, const string& key,
+                             AutotuneResult* result);
+
+// Stores `result` for `key` on `stream_exec` in the file named by the
+// TF_GPU_AUTOTUNE_RESULTS_PATH environment variable, if it is set.
+void StoreGpuAutotuneResult(se::StreamExecutor* stream_exec, const string& key,
+                            const AutotuneResult& result);
+
+// Convert between the configs of an AutoTuneMap and the results stored by
+// StoreGpuAutotuneResult. Return false for configs that can't be stored.
+bool ToAutotuneResult(const se::dnn::AlgorithmConfig& config,
+                      AutotuneResult* result);
+bool FromAutotuneResult(const AutotuneResult& result,
+                        se::dnn::AlgorithmConfig* config);
+bool ToAutotuneResult(const se::blas::AlgorithmConfig& config,
+                      AutotuneResult* result);
+bool FromAutotuneResult(const AutotuneResult& result,
+                        se::blas::AlgorithmConfig* config);
+template <typename Config>
+bool ToAutotuneResult(const Config& config, AutotuneResult* result) {
+  return false;
+}
+template <typename Config>
+bool FromAutotuneResult(const AutotuneResult& result, Config* config) {
+  return false;
+}
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -145,6 +177,49 @@ class AutoTuneMap {
     autotune_global_count_++;
   }
 
+  // Like Find above, but if `params` has not been autotuned in this process,
+  // loads its config on `stream_exec` from the TF_GPU_AUTOTUNE_RESULTS_PATH
+  // file. Loaded configs are accepted right away.
+  bool Find(const Parameters& params, se::StreamExecutor* stream_exec,
+            Config* config) {
+    if (Find(params, config)) {
+      return true;
+    }
+    AutotuneResult result;
+    if (!LookupGpuAutotuneResult(stream_exec, FileKey(params), &result) ||
+        !FromAutotuneResult(result, config)) {
+      return false;
+    }
+    mutex_lock lock(mu_);
+    VLOG(1) << GetActionSummary("loads", params, *config);
+    params_config_map_[params] =
+        ValueType{*config, min_score_threshold_, 1, /*stored=*/true};
+    return true;
+  }
+
+  // Like Insert above, and once the config of `params` is accepted, stores it
+  // on `stream_exec` in the TF_GPU_AUTOTUNE_RESULTS_PATH file.
+  void Insert(const Parameters& params, se::StreamExecutor* stream_exec,
+              const Config& config) {
+    Insert(params, config);
+    Config accepted;
+    {
+      mutex_lock lock(mu_);
+      auto iter = params_config_map_.find(params);
+      if (iter == params_config_map_.end() || iter->second.stored ||
+          (iter->second.score < min_score_threshold_ &&
+           iter->second.count <= max_autotune_count_)) {
+        return;
+      }
+      iter->second.stored = true;
+      accepted = iter->second.config;
+    }
+    AutotuneResult result;
+    if (ToAutotuneResult(accepted, &result)) {
+      StoreGpuAutotuneResult(stream_exec, FileKey(params), result);
+    }
+  }
+
  private:
   AutoTuneMap(const string& name) : name_(name) {
     min_score_threshold_ = 1;
@@ -181,11 +256,18 @@ class AutoTuneMap {
                            config.ToString().c_str());
   }
 
+  // The key of the config of `params` in the autotune results file.
+  string FileKey(const Parameters& params) const {
+    return strings::StrCat(name_, ": ", params.ToString());
+  }
+
   mutable mutex mu_;
   struct ValueType {
     Config config;
     int32 score;
     int32 count;
+    // Whether the config is in the autotune results file.
+    bool stored = false;
   };
   std::unordered_map<Parameters, ValueType, Hasher> params_config_map_
       TF_GUARDED_BY(mu_);
@@ -25,6 +25,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -115,7 +116,14 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32 input_index,
   }
 
   // If forwarding is not possible allocate a new output tensor and copy
-  // the `input_list` to it.
+  // the `input_list` to it. The copy is O(n) in the length of the list, so
+  // one in every iteration of a loop makes the loop quadratic; count them so
+  // such graphs can be found.
+  const int64 num_elements = input_list.tensors().size();
+  VLOG(2) << "Copying TensorList of " << num_elements << " elements in "
+          << c->op_kernel().name() << " (" << c->op_kernel().type_string()
+          << ") because its input could not be forwarded";
+  metrics::RecordTensorListCopy(c->op_kernel().type_string(), num_elements);
   AllocatorAttributes attr;
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
@@ -16,25 +16,138 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 
 namespace tensorflow {
 namespace lookup {
 
+// A hash map split into shards with a lock each, so that concurrent steps that
+// look up or update keys of different shards do not wait on each other.
+template <class K, class M>
+class ShardedHashMap {
+ public:
+  static constexpr int kNumShardBits = 4;
+  static constexpr int kNumShards = 1 << kNumShardBits;
+
+  struct Shard {
+    mutable mutex mu;
+    std::unordered_map<K, M> map TF_GUARDED_BY(mu);
+  };
+
+  Shard* shard(int i) { return &shards_[i]; }
+  const Shard* shard(int i) const { return &shards_[i]; }
+
+  // Returns the shard of "key".  The hash is mixed since std::hash is the
+  // identity for integers, whose low bits also pick the buckets of the maps.
+  static int ShardOf(const K& key) {
+    const uint64 hash = static_cast<uint64>(std::hash<K>()(key));
+    return static_cast<int>((hash * 0x9E3779B97F4A7C15ull) >>
+                            (64 - kNumShardBits));
+  }
+
+  // Calls `fn(shard, indices)` once for each shard that holds some of `keys`,
+  // with the indices of those keys in increasing order.  The shards are not
+  // locked.
+  template <typename KeyFlat, typename Fn>
+  static void ForEachShard(const KeyFlat& keys, Shard* shards, Fn fn) {
+    const int64 num_keys = keys.size();
+    if (num_keys == 1) {
+      const int64 index = 0;
+      fn(&shards[ShardOf(keys(0))], gtl::ArraySlice<int64>(&index, 1));
+      return;
+    }
+    // Sorts the indices by shard, keeping their order within each shard.
+    std::vector<uint8> key_shards(num_keys);
+    int64 starts[kNumShards + 1] = {};
+    for (int64 i = 0; i < num_keys; ++i) {
+      key_shards[i] = ShardOf(keys(i));
+      ++starts[key_shards[i] + 1];
+    }
+    for (int s = 0; s < kNumShards; ++s) starts[s + 1] += starts[s];
+    std::vector<int64> indices(num_keys);
+    int64 next[kNumShards];
+    std::copy(starts, starts + kNumShards, next);
+    for (int64 i = 0; i < num_keys; ++i) indices[next[key_shards[i]]++] = i;
+    for (int s = 0; s < kNumShards; ++s) {
+      if (starts[s] == starts[s + 1]) continue;
+      fn(&shards[s], gtl::ArraySlice<int64>(indices.data() + starts[s],
+                                            starts[s + 1] - starts[s]));
+    }
+  }
+  template <typename KeyFlat, typename Fn>
+  void ForEachShard(const KeyFlat& keys, Fn fn) {
+    ForEachShard(keys, shards_, fn);
+  }
+
+  // Locks all shards, in order, for operations on the whole map.
+  void LockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.mu.lock();
+  }
+  void UnlockAll() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.mu.unlock();
+  }
+  void LockAllShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+  }
+  void UnlockAllShared() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+  }
+
+  // REQUIRES: all shards are locked by LockAll().
+  void ClearLocked() TF_NO_THREAD_SAFETY_ANALYSIS {
+    for (Shard& shard : shards_) shard.map.clear();
+  }
+
+  size_t size() const {
+    size_t ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      ret += shard.map.size();
+    }
+    return ret;
+  }
+
+  // The number of entries and empty buckets of the maps.
+  int64 NumSlots() const {
+    int64 ret = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      for (unsigned i = 0; i < shard.map.bucket_count(); ++i) {
+        size_t bucket_size = shard.map.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
+      }
+    }
+    return ret;
+  }
+
+ private:
+  Shard shards_[kNumShards];
+};
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The keys are split into shards with a lock each, so concurrent lookups and
+// inserts only wait on each other for the shards they have keys in common.
 //
 // Sample use case:
 //
@@ -49,10 +162,7 @@ class MutableHashTableOfScalars final : public LookupInterface {
  public:
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -60,11 +170,15 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
-    }
+    table_.ForEachShard(
+        key_values, [&](const Shard* shard, gtl::ArraySlice<int64> indices) {
+          tf_shared_lock l(shard->mu);
+          for (int64 i : indices) {
+            value_values(i) = gtl::FindWithDefault(
+                shard->map, SubtleMustCopyIfIntegral(key_values(i)),
+                default_val);
+          }
+        });
 
     return Status::OK();
   }
@@ -73,13 +187,27 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    // REQUIRES: shard->mu is held.
+    const auto insert = [&](Shard* shard, gtl::ArraySlice<int64> indices)
+                            TF_NO_THREAD_SAFETY_ANALYSIS {
+          for (int64 i : indices) {
+            gtl::InsertOrUpdate(&shard->map,
+                                SubtleMustCopyIfIntegral(key_values(i)),
+                                SubtleMustCopyIfIntegral(value_values(i)));
+          }
+        };
     if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+      // Replaces the contents of all shards at once.
+      table_.LockAll();
+      table_.ClearLocked();
+      table_.ForEachShard(key_values, insert);
+      table_.UnlockAll();
+    } else {
+      table_.ForEachShard(
+          key_values, [&](Shard* shard, gtl::ArraySlice<int64> indices) {
+            mutex_lock l(shard->mu);
+            insert(shard, indices);
+          });
     }
     return Status::OK();
   }
@@ -92,10 +220,13 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachShard(
+        key_values, [&](Shard* shard, gtl::ArraySlice<int64> indices) {
+          mutex_lock l(shard->mu);
+          for (int64 i : indices) {
+            shard->map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+          }
+        });
     return Status::OK();
   }
 
@@ -105,24 +236,10 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
-    }
-    return Status::OK();
+    table_.LockAllShared();
+    Status s = ExportValuesLocked(ctx);
+    table_.UnlockAllShared();
+    return s;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -134,22 +251,42 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64 MemoryUsed() const override {
-    int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
+    return sizeof(MutableHashTableOfScalars) + table_.NumSlots();
+  }
+
+ private:
+  typedef ShardedHashMap<K, V> Table;
+  typedef typename Table::Shard Shard;
+
+  // REQUIRES: all shards of table_ are locked.
+  Status ExportValuesLocked(OpKernelContext* ctx)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    int64 size = 0;
+    for (int s = 0; s < Table::kNumShards; ++s) {
+      size += table_.shard(s)->map.size();
+    }
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    int64 i = 0;
+    for (int s = 0; s < Table::kNumShards; ++s) {
+      const auto& map = table_.shard(s)->map;
+      for (auto it = map.begin(); it != map.end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
       }
     }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return Status::OK();
   }
 
- private:
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -166,10 +303,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -178,20 +312,23 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto value_values = value->flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64 j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        for (int64 j = 0; j < value_dim; j++) {
-          value_values(i, j) = default_flat(j);
-        }
-      }
-    }
+    table_.ForEachShard(
+        key_values, [&](const Shard* shard, gtl::ArraySlice<int64> indices) {
+          tf_shared_lock l(shard->mu);
+          for (int64 i : indices) {
+            const ValueArray* value_vec = gtl::FindOrNull(
+                shard->map, SubtleMustCopyIfIntegral(key_values(i)));
+            if (value_vec != nullptr) {
+              for (int64 j = 0; j < value_dim; j++) {
+                value_values(i, j) = value_vec->at(j);
+              }
+            } else {
+              for (int64 j = 0; j < value_dim; j++) {
+                value_values(i, j) = default_flat(j);
+              }
+            }
+          }
+        });
 
     return Status::OK();
   }
@@ -201,18 +338,32 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64 value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
+    // REQUIRES: shard->mu is held.
+    const auto insert = [&](Shard* shard, gtl::ArraySlice<int64> indices)
+                            TF_NO_THREAD_SAFETY_ANALYSIS {
+          for (int64 i : indices) {
+            ValueArray value_vec;
+            for (int64 j = 0; j < value_dim; j++) {
+              V value = value_values(i, j);
+              value_vec.push_back(value);
+            }
+            gtl::InsertOrUpdate(&shard->map,
+                                SubtleMustCopyIfIntegral(key_values(i)),
+                                value_vec);
+          }
+        };
     if (clear) {
-      table_.clear();
-    }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      ValueArray value_vec;
-      for (int64 j = 0; j < value_dim; j++) {
-        V value = value_values(i, j);
-        value_vec.push_back(value);
-      }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      // Replaces the contents of all shards at once.
+      table_.LockAll();
+      table_.ClearLocked();
+      table_.ForEachShard(key_values, insert);
+      table_.UnlockAll();
+    } else {
+      table_.ForEachShard(
+          key_values, [&](Shard* shard, gtl::ArraySlice<int64> indices) {
+            mutex_lock l(shard->mu);
+            insert(shard, indices);
+          });
     }
     return Status::OK();
   }
@@ -225,10 +376,13 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachShard(
+        key_values, [&](Shard* shard, gtl::ArraySlice<int64> indices) {
+          mutex_lock l(shard->mu);
+          for (int64 i : indices) {
+            shard->map.erase(SubtleMustCopyIfIntegral(key_values(i)));
+          }
+        });
     return Status::OK();
   }
 
@@ -238,8 +392,36 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
+    table_.LockAllShared();
+    Status s = ExportValuesLocked(ctx);
+    table_.UnlockAllShared();
+    return s;
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64 MemoryUsed() const override {
+    return sizeof(MutableHashTableOfTensors) + table_.NumSlots();
+  }
+
+ private:
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  typedef ShardedHashMap<K, ValueArray> Table;
+  typedef typename Table::Shard Shard;
+
+  // REQUIRES: all shards of table_ are locked.
+  Status ExportValuesLocked(OpKernelContext* ctx)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    int64 size = 0;
+    for (int s = 0; s < Table::kNumShards; ++s) {
+      size += table_.shard(s)->map.size();
+    }
     int64 value_dim = value_shape_.dim_size(0);
 
     Tensor* keys;
@@ -252,44 +434,22 @@ class MutableHashTableOfTensors final : public LookupInterface {
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64 j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (int s = 0; s < Table::kNumShards; ++s) {
+      const auto& map = table_.shard(s)->map;
+      for (auto it = map.begin(); it != map.end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64 j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
     return Status::OK();
   }
 
-  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
-
-  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
-
-  TensorShape key_shape() const final { return TensorShape(); }
-
-  TensorShape value_shape() const override { return value_shape_; }
-
-  int64 MemoryUsed() const override {
-    int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
-  }
-
- private:
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  Table table_;
 };
 
 namespace {
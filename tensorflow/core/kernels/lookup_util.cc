@@ -20,7 +20,10 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -29,6 +32,10 @@ namespace {
 static const int kInputBufferSize = 1 * 1024 * 1024; /* bytes */
 static const int kLineNumber = -1;
 static const int kWholeLine = -2;
+// Lines read from a text file and parsed at a time.
+static const int64 kLinesPerBatch = 64 * 1024;
+// Rough cost of parsing one line, in cycles.
+static const int64 kCostPerLine = 1000;
 
 Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
                              int64* num_lines) {
@@ -50,9 +57,10 @@ Status GetNumLinesInTextFile(Env* env, const string& vocab_file,
   return Status::OK();
 }
 
-// Iterator that reads a text file. Each iteration process one line, it parses
-// the line and populates the keys and values tensors used for initialization
-// with a single key and corresponding value.
+// Iterator that reads a text file. Each iteration reads a batch of up to
+// kLinesPerBatch lines, parses them and populates the keys and values tensors
+// used for initialization with one key and corresponding value per line. If a
+// thread pool is given, the lines of a batch are parsed on it in parallel.
 //
 // What information of the line to populate the key or values is specified by
 // providing key_index and value_index.
@@ -76,15 +84,16 @@ class TextFileLineIterator
   //   delimiter.
   Status Init(const string& filename, int64 vocab_size, char delimiter,
               DataType key_dtype, int64 key_index, DataType value_dtype,
-              int64 value_index, Env* env) {
+              int64 value_index, Env* env, thread::ThreadPool* thread_pool) {
     filename_ = filename;
     vocab_size_ = vocab_size;
     delimiter_ = delimiter;
-    key_ = Tensor(key_dtype, TensorShape({}));
-    value_ = Tensor(value_dtype, TensorShape({}));
+    key_dtype_ = key_dtype;
+    value_dtype_ = value_dtype;
     key_index_ = key_index;
     value_index_ = value_index;
     env_ = env;
+    thread_pool_ = thread_pool;
 
     status_ = env->NewRandomAccessFile(filename_, &file_);
     if (!status_.ok()) return status_;
@@ -92,6 +101,7 @@ class TextFileLineIterator
     input_buffer_.reset(new io::InputBuffer(file_.get(), kInputBufferSize));
     valid_ = true;
     next_id_ = 0;
+    read_status_ = Status::OK();
     ignore_split_ = std::max(key_index_, value_index_) < 0;
     Next();
     return status_;
@@ -100,59 +110,18 @@ class TextFileLineIterator
   void Next() override {
     if (!valid_) return;
 
-    string line;
-    status_ = input_buffer_->ReadLine(&line);
-    if (!status_.ok()) {
-      if (errors::IsOutOfRange(status_) && vocab_size_ != -1 &&
-          next_id_ != vocab_size_) {
-        status_ = errors::InvalidArgument("Invalid vocab_size in ", filename_,
-                                          ": expected ", vocab_size_,
-                                          " but got ", next_id_);
-      }
-      valid_ = false;
-      return;
-    }
-    if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
-      LOG(WARNING) << "Truncated " << filename_ << " before its end at "
-                   << vocab_size_ << " records.";
-      LOG(WARNING) << "next_id_  : " << next_id_;
-      status_ = errors::OutOfRange("Finished reading ", vocab_size_,
-                                   " of lines from ", filename_);
+    const int64 first_id = next_id_;
+    std::vector<string> lines;
+    ReadLines(&lines);
+    if (lines.empty()) {
+      status_ = read_status_;
       valid_ = false;
       return;
     }
-    if (line.empty()) {
-      status_ = errors::InvalidArgument("Invalid content in ", filename_,
-                                        ": empty line found at position ",
-                                        input_buffer_->Tell(), ".");
-      valid_ = false;
-      return;
-    }
-
-    std::vector<string> tokens;
-    if (!ignore_split_) {
-      tokens = str_util::Split(line, delimiter_);
-      if (std::max(key_index_, value_index_) >= tokens.size()) {
-        status_ = errors::InvalidArgument(
-            "Invalid number of columns in ", filename_, " line ", next_id_,
-            " (", line, ") : expected ", std::max(key_index_, value_index_),
-            " got ", tokens.size());
-        valid_ = false;
-        return;
-      }
-    }
-    status_ = SetValue(line, tokens, key_index_, &key_);
-    if (!status_.ok()) {
-      valid_ = false;
-      return;
-    }
-    status_ = SetValue(line, tokens, value_index_, &value_);
+    status_ = ParseLines(lines, first_id);
     if (!status_.ok()) {
       valid_ = false;
-      return;
     }
-
-    next_id_++;
   }
 
   bool Valid() const override { return valid_; }
@@ -179,25 +148,116 @@ class TextFileLineIterator
  private:
   Tensor key_;
   Tensor value_;
+  DataType key_dtype_;
+  DataType value_dtype_;
   bool valid_;  // true if the iterator points to an existing range.
   int64 key_index_;
   int64 value_index_;
   Env* env_;
-  int64 next_id_;
+  thread::ThreadPool* thread_pool_;  // not owned, may be null
+  int64 next_id_;  // id of the next line to read
   int64 vocab_size_;
   string filename_;
   char delimiter_;
   Status status_;
+  // Status to report once the lines read so far have been returned.
+  Status read_status_;
   bool ignore_split_;
   std::unique_ptr<RandomAccessFile> file_;  // must outlive input_buffer_
   std::unique_ptr<io::InputBuffer> input_buffer_;
 
-  // Set the corresponding value from line or tokens based on 'index' into the
-  // tensor 't'. The value is transformed to the given data type 'dtype'.
+  // Reads up to kLinesPerBatch lines into 'lines'. Reading stops early at the
+  // end of the file, after vocab_size_ lines or at an empty line, in which
+  // case read_status_ holds the status to report after 'lines'.
+  void ReadLines(std::vector<string>* lines) {
+    if (!read_status_.ok()) return;
+    string line;
+    while (lines->size() < kLinesPerBatch) {
+      read_status_ = input_buffer_->ReadLine(&line);
+      if (!read_status_.ok()) {
+        if (errors::IsOutOfRange(read_status_) && vocab_size_ != -1 &&
+            next_id_ != vocab_size_) {
+          read_status_ = errors::InvalidArgument(
+              "Invalid vocab_size in ", filename_, ": expected ", vocab_size_,
+              " but got ", next_id_);
+        }
+        return;
+      }
+      if (vocab_size_ != -1 && next_id_ >= vocab_size_) {
+        LOG(WARNING) << "Truncated " << filename_ << " before its end at "
+                     << vocab_size_ << " records.";
+        LOG(WARNING) << "next_id_  : " << next_id_;
+        read_status_ = errors::OutOfRange("Finished reading ", vocab_size_,
+                                          " of lines from ", filename_);
+        return;
+      }
+      if (line.empty()) {
+        read_status_ = errors::InvalidArgument(
+            "Invalid content in ", filename_,
+            ": empty line found at position ", input_buffer_->Tell(), ".");
+        return;
+      }
+      lines->push_back(std::move(line));
+      next_id_++;
+    }
+  }
+
+  // Parses 'lines', the first of which has id 'first_id', into key_ and
+  // value_. Returns the error of the earliest line that fails to parse, as a
+  // serial parse would.
+  Status ParseLines(const std::vector<string>& lines, int64 first_id) {
+    const int64 num_lines = lines.size();
+    key_ = Tensor(key_dtype_, TensorShape({num_lines}));
+    value_ = Tensor(value_dtype_, TensorShape({num_lines}));
+
+    mutex mu;
+    int64 error_index = num_lines;
+    Status error;
+    auto parse = [&](int64 begin, int64 end) {
+      for (int64 i = begin; i < end; ++i) {
+        Status s = ParseLine(lines[i], first_id + i, i);
+        if (!s.ok()) {
+          mutex_lock l(mu);
+          if (i < error_index) {
+            error_index = i;
+            error = s;
+          }
+          return;
+        }
+      }
+    };
+    if (thread_pool_ == nullptr) {
+      parse(0, num_lines);
+    } else {
+      Shard(thread_pool_->NumThreads(), thread_pool_, num_lines,
+            kCostPerLine, parse);
+    }
+    return error;
+  }
+
+  // Parses the line with id 'line_id' into element 'i' of key_ and value_.
+  Status ParseLine(const string& line, int64 line_id, int64 i) {
+    std::vector<string> tokens;
+    if (!ignore_split_) {
+      tokens = str_util::Split(line, delimiter_);
+      if (std::max(key_index_, value_index_) >= tokens.size()) {
+        return errors::InvalidArgument(
+            "Invalid number of columns in ", filename_, " line ", line_id,
+            " (", line, ") : expected ", std::max(key_index_, value_index_),
+            " got ", tokens.size());
+      }
+    }
+    TF_RETURN_IF_ERROR(SetValue(line, tokens, key_index_, line_id, i, &key_));
+    return SetValue(line, tokens, value_index_, line_id, i, &value_);
+  }
+
+  // Set the corresponding value from line or tokens based on 'index' into
+  // element 'i' of the tensor 't'. The value is transformed to the given data
+  // type 'dtype'.
   Status SetValue(const string& line, const std::vector<string>& tokens,
-                  int64 index, Tensor* tensor) {
+                  int64 index, int64 line_id, int64 i, Tensor* tensor) {
     if (index == kLineNumber) {
-      tensor->flat<int64>()(0) = next_id_;
+      tensor->flat<int64>()(i) = line_id;
       return Status::OK();
     }
     const string& token = (index == kWholeLine) ? line : tokens[index];
@@ -206,44 +266,39 @@ class TextFileLineIterator
       case DT_INT32: {
         int32 value;
         if (!strings::safe_strto32(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int32.");
         }
-        tensor->flat<int32>()(0) = value;
+        tensor->flat<int32>()(i) = value;
       } break;
       case DT_INT64: {
         int64 value;
         if (!strings::safe_strto64(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid int64.");
         }
-        tensor->flat<int64>()(0) = value;
+        tensor->flat<int64>()(i) = value;
       } break;
       case DT_FLOAT: {
         float value;
         if (!strings::safe_strtof(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid float.");
         }
-        tensor->flat<float>()(0) = value;
+        tensor->flat<float>()(i) = value;
       } break;
       case DT_DOUBLE: {
         double value;
         if (!strings::safe_strtod(token.c_str(), &value)) {
-          valid_ = false;
-          return errors::InvalidArgument("Field ", token, " in line ", next_id_,
+          return errors::InvalidArgument("Field ", token, " in line ", line_id,
                                          " is not a valid double.");
         }
-        tensor->flat<double>()(0) = value;
+        tensor->flat<double>()(i) = value;
       } break;
       case DT_STRING:
-        tensor->flat<tstring>()(0) = token;
+        tensor->flat<tstring>()(i) = token;
         break;
       default:
-        valid_ = false;
         return errors::InvalidArgument("Data type ", DataTypeString(dtype),
                                        " not supported.");
     }
@@ -352,6 +407,16 @@ Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
                                    char delimiter, int32 key_index,
                                    int32 value_index, Env* env,
                                    InitializableLookupTable* table) {
+  return InitializeTableFromTextFile(filename, vocab_size, delimiter,
+                                     key_index, value_index, env,
+                                     /*thread_pool=*/nullptr, table);
+}
+
+Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
+                                   char delimiter, int32 key_index,
+                                   int32 value_index, Env* env,
+                                   thread::ThreadPool* thread_pool,
+                                   InitializableLookupTable* table) {
   if (key_index == kLineNumber && table->key_dtype() != DT_INT64) {
     return errors::InvalidArgument(
         "Key index for line number requires table key dtype of int64, got ",
@@ -378,7 +443,8 @@ Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
 
   TextFileLineIterator iter;
   TF_RETURN_IF_ERROR(iter.Init(filename, vocab_size, delimiter, key_dtype,
-                               key_index, value_dtype, value_index, env));
+                               key_index, value_dtype, value_index, env,
+                               thread_pool));
   // For initialization from files, ignore if the table is already
   // initialized. The table shared name should contain the filename to
   // avoid trying to initialize the same table from the same file at the same
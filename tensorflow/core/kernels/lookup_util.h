@@ -24,6 +24,9 @@ namespace tensorflow {
 namespace data {
 class DatasetBase;
 }  // namespace data
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 }  // namespace tensorflow
 
 namespace tensorflow {
@@ -56,6 +59,15 @@ Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
                                    int32 value_index, Env* env,
                                    InitializableLookupTable* table);
 
+// Like above, but parses the lines of each batch read from `filename` in
+// parallel on `thread_pool` when it is not null. Caller retains ownership of
+// `thread_pool`.
+Status InitializeTableFromTextFile(const string& filename, int64 vocab_size,
+                                   char delimiter, int32 key_index,
+                                   int32 value_index, Env* env,
+                                   thread::ThreadPool* thread_pool,
+                                   InitializableLookupTable* table);
+
 // Initializes `table` from `dataset` by iterating over it. Caller retains
 // ownership of `dataset`.
 Status InitializeTableFromDataset(OpKernelContext* ctx,
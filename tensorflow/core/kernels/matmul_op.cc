@@ -299,8 +299,8 @@ struct LaunchMatMul<GPUDevice, T, true /* USE_CUBLAS */> {
     if (use_autotune && compute_type_supported && !algorithms->empty()) {
       ProfileResult best_result;
       // TODO(yangzihao): Unify this code with conv autotuning.
-      if (!AutoTuneMatmul::GetInstance()->Find(matmul_parameters,
-                                               &algorithm_config)) {
+      if (!AutoTuneMatmul::GetInstance()->Find(
+              matmul_parameters, stream->parent(), &algorithm_config)) {
         ProfileResult profile_result;
         for (auto profile_algorithm : (*algorithms)) {
           // Cublas does
@@ -362,7 +362,7 @@ struct LaunchMatMul<GPUDevice, T, true /* USE_CUBLAS */> {
       if (best_result.is_valid()) {
         algorithm_config.set_algorithm(best_result.algorithm());
       }
-      AutoTuneMatmul::GetInstance()->Insert(matmul_parameters,
+      AutoTuneMatmul::GetInstance()->Insert(matmul_parameters, stream->parent(),
                                             algorithm_config);
       if (algorithm_config.algorithm() != kNoAlgorithm &&
           algorithm_config.algorithm() != kDefaultBlasGemm &&
@@ -0,0 +1,235 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements an eight-bit matmul with per-channel weights, fused with the
+// dequantization of its output, a bias and an activation.  The integer matmul
+// runs on ruy, the GEMM library of TensorFlow Lite.
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
+#include "ruy/matrix.h"  // from @ruy
+#include "ruy/ruy.h"  // from @ruy
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+enum class Activation { kNone, kRelu, kRelu6 };
+
+// Returns the scale of a qint8 tensor quantized in SCALED mode to the range
+// ["min_range", "max_range"], as Dequantize computes it.
+float ScaledModeScale(float min_range, float max_range) {
+  return std::max(min_range / std::numeric_limits<int8>::min(),
+                  max_range / std::numeric_limits<int8>::max());
+}
+
+template <Activation activation>
+void DequantizeRows(const int32* acc, int64 n, float scale_a,
+                    const float* scales_b, const float* bias, int64 start_row,
+                    int64 limit_row, float* out) {
+  for (int64 i = start_row; i < limit_row; ++i) {
+    const int32* acc_row = acc + i * n;
+    float* out_row = out + i * n;
+    for (int64 j = 0; j < n; ++j) {
+      float value = acc_row[j] * (scale_a * scales_b[j]) + bias[j];
+      if (activation == Activation::kRelu) {
+        value = std::max(value, 0.0f);
+      } else if (activation == Activation::kRelu6) {
+        value = std::min(std::max(value, 0.0f), 6.0f);
+      }
+      out_row[j] = value;
+    }
+  }
+}
+
+}  // namespace
+
+class QuantizedMatMulPerChannelOp : public OpKernel {
+ public:
+  explicit QuantizedMatMulPerChannelOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_a", &transpose_a_));
+    OP_REQUIRES_OK(context, context->GetAttr("transpose_b", &transpose_b_));
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    if (fused_ops == std::vector<string>({"BiasAdd"})) {
+      activation_ = Activation::kNone;
+    } else if (fused_ops == std::vector<string>({"BiasAdd", "Relu"})) {
+      activation_ = Activation::kRelu;
+    } else if (fused_ops == std::vector<string>({"BiasAdd", "Relu6"})) {
+      activation_ = Activation::kRelu6;
+    } else {
+      OP_REQUIRES(context, false,
+                  errors::Unimplemented(
+                      "Fusion is not implemented: [",
+                      absl::StrJoin(fused_ops, ","), "], expected one of "
+                      "[BiasAdd], [BiasAdd,Relu] or [BiasAdd,Relu6]"));
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& a = context->input(0);
+    const Tensor& b = context->input(1);
+    const Tensor& bias = context->input(2);
+    const Tensor& min_a = context->input(3);
+    const Tensor& max_a = context->input(4);
+    const Tensor& min_b = context->input(5);
+    const Tensor& max_b = context->input(6);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("In[0] is not a matrix"));
+    OP_REQUIRES(context, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("In[1] is not a matrix"));
+    const int64 m = a.dim_size(transpose_a_ ? 1 : 0);
+    const int64 k = a.dim_size(transpose_a_ ? 0 : 1);
+    const int64 n = b.dim_size(transpose_b_ ? 0 : 1);
+    OP_REQUIRES(context, k == b.dim_size(transpose_b_ ? 1 : 0),
+                errors::InvalidArgument("Matrix size-incompatible: In[0]: ",
+                                        a.shape().DebugString(),
+                                        ", In[1]: ", b.shape().DebugString()));
+    OP_REQUIRES(context, bias.NumElements() == n,
+                errors::InvalidArgument("bias must have ", n,
+                                        " elements, got shape ",
+                                        bias.shape().DebugString()));
+    OP_REQUIRES(context, min_a.NumElements() == 1 && max_a.NumElements() == 1,
+                errors::InvalidArgument("min_a and max_a must be scalars"));
+    // The ranges of "b" are either per tensor or per output channel.
+    const int64 num_ranges_b = min_b.NumElements();
+    OP_REQUIRES(context,
+                (num_ranges_b == 1 || num_ranges_b == n) &&
+                    max_b.NumElements() == num_ranges_b,
+                errors::InvalidArgument(
+                    "min_b and max_b must both have 1 or ", n,
+                    " elements, got shapes ", min_b.shape().DebugString(),
+                    " and ", max_b.shape().DebugString()));
+
+    const float scale_a =
+        ScaledModeScale(min_a.flat<float>()(0), max_a.flat<float>()(0));
+    std::vector<float> scales_b(n);
+    for (int64 j = 0; j < n; ++j) {
+      const int64 r = num_ranges_b == 1 ? 0 : j;
+      scales_b[j] =
+          ScaledModeScale(min_b.flat<float>()(r), max_b.flat<float>()(r));
+    }
+
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({m, n}), &out));
+    if (m == 0 || n == 0) return;
+    Tensor acc;
+    OP_REQUIRES_OK(context,
+                   context->allocate_temp(DT_INT32, TensorShape({m, n}), &acc));
+
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    if (k == 0) {
+      acc.flat<int32>().setZero();
+    } else {
+      // qint8 has the same representation as int8.
+      ruy::Matrix<std::int8_t> lhs;
+      ruy::MakeSimpleLayout(
+          m, k, transpose_a_ ? ruy::Order::kColMajor : ruy::Order::kRowMajor,
+          lhs.mutable_layout());
+      lhs.set_data(
+          reinterpret_cast<const std::int8_t*>(a.flat<qint8>().data()));
+      ruy::Matrix<std::int8_t> rhs;
+      ruy::MakeSimpleLayout(
+          k, n, transpose_b_ ? ruy::Order::kColMajor : ruy::Order::kRowMajor,
+          rhs.mutable_layout());
+      rhs.set_data(
+          reinterpret_cast<const std::int8_t*>(b.flat<qint8>().data()));
+      ruy::Matrix<std::int32_t> dst;
+      ruy::MakeSimpleLayout(m, n, ruy::Order::kRowMajor, dst.mutable_layout());
+      dst.set_data(acc.flat<int32>().data());
+      // Without a multiplier, ruy returns the raw int32 accumulators.
+      ruy::MulParams<std::int32_t, std::int32_t> mul_params;
+
+      std::unique_ptr<ruy::Context> ruy_context = AcquireRuyContext();
+      ruy_context->set_max_num_threads(worker_threads.num_threads);
+      ruy::Mul(lhs, rhs, mul_params, ruy_context.get(), &dst);
+      ReleaseRuyContext(std::move(ruy_context));
+    }
+
+    const int32* acc_data = acc.flat<int32>().data();
+    const float* bias_data = bias.flat<float>().data();
+    float* out_data = out->flat<float>().data();
+    auto dequantize = [&](int64 start_row, int64 limit_row) {
+      switch (activation_) {
+        case Activation::kNone:
+          DequantizeRows<Activation::kNone>(acc_data, n, scale_a,
+                                            scales_b.data(), bias_data,
+                                            start_row, limit_row, out_data);
+          break;
+        case Activation::kRelu:
+          DequantizeRows<Activation::kRelu>(acc_data, n, scale_a,
+                                            scales_b.data(), bias_data,
+                                            start_row, limit_row, out_data);
+          break;
+        case Activation::kRelu6:
+          DequantizeRows<Activation::kRelu6>(acc_data, n, scale_a,
+                                             scales_b.data(), bias_data,
+                                             start_row, limit_row, out_data);
+          break;
+      }
+    };
+    Shard(worker_threads.num_threads, worker_threads.workers, m, 4 * n,
+          dequantize);
+  }
+
+ private:
+  // A ruy::Context may only be used by one thread at a time, so concurrent
+  // calls to Compute() each take one from a pool.
+  std::unique_ptr<ruy::Context> AcquireRuyContext() TF_LOCKS_EXCLUDED(mu_) {
+    {
+      mutex_lock l(mu_);
+      if (!ruy_contexts_.empty()) {
+        std::unique_ptr<ruy::Context> ruy_context =
+            std::move(ruy_contexts_.back());
+        ruy_contexts_.pop_back();
+        return ruy_context;
+      }
+    }
+    return absl::make_unique<ruy::Context>();
+  }
+
+  void ReleaseRuyContext(std::unique_ptr<ruy::Context> ruy_context)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    ruy_contexts_.push_back(std::move(ruy_context));
+  }
+
+  bool transpose_a_;
+  bool transpose_b_;
+  Activation activation_;
+
+  mutex mu_;
+  std::vector<std::unique_ptr<ruy::Context>> ruy_contexts_ TF_GUARDED_BY(mu_);
+};
+
+REGISTER_KERNEL_BUILDER(Name("QuantizedMatMulPerChannel").Device(DEVICE_CPU),
+                        QuantizedMatMulPerChannelOp);
+
+}  // namespace tensorflow
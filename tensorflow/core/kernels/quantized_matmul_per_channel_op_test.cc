@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class QuantizedMatMulPerChannelTest : public OpsTestBase {
+ protected:
+  void MakeOp(bool transpose_b, const std::vector<string>& fused_ops) {
+    TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_per_channel_op",
+                                "QuantizedMatMulPerChannel")
+                     .Input(FakeInput(DT_QINT8))
+                     .Input(FakeInput(DT_QINT8))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("transpose_b", transpose_b)
+                     .Attr("fused_ops", fused_ops)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+// With a range of [-128, 127] for "a" and [-256, 254] and [-12.8, 12.7] for
+// the columns of "b", the scales are 1, 2 and 0.1.
+TEST_F(QuantizedMatMulPerChannelTest, PerChannelWithBias) {
+  MakeOp(false, {"BiasAdd"});
+  // A matrix is:
+  // |  1 |  2 |  3 |
+  // | -4 |  5 | -6 |
+  AddInputFromArray<qint8>(TensorShape({2, 3}), {1, 2, 3, -4, 5, -6});
+  // B matrix is:
+  // |  7 | 10 |
+  // |  8 | 20 |
+  // | -9 | 30 |
+  AddInputFromArray<qint8>(TensorShape({3, 2}), {7, 10, 8, 20, -9, 30});
+  AddInputFromArray<float>(TensorShape({2}), {0.5f, -1.0f});
+  AddInputFromArray<float>(TensorShape({}), {-128.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.0f});
+  AddInputFromArray<float>(TensorShape({2}), {-256.0f, -12.8f});
+  AddInputFromArray<float>(TensorShape({2}), {254.0f, 12.7f});
+  TF_ASSERT_OK(RunOpKernel());
+  // The integer products are:
+  // | -4 | 140 |
+  // | 66 | -120 |
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {-7.5f, 13.0f, 132.5f, -13.0f});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(QuantizedMatMulPerChannelTest, TransposedWithRelu) {
+  MakeOp(true, {"BiasAdd", "Relu"});
+  AddInputFromArray<qint8>(TensorShape({2, 3}), {1, 2, 3, -4, 5, -6});
+  // B is the transpose of the one above.
+  AddInputFromArray<qint8>(TensorShape({2, 3}), {7, 8, -9, 10, 20, 30});
+  AddInputFromArray<float>(TensorShape({2}), {0.5f, -1.0f});
+  AddInputFromArray<float>(TensorShape({}), {-128.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.0f});
+  AddInputFromArray<float>(TensorShape({}), {-256.0f});
+  AddInputFromArray<float>(TensorShape({}), {254.0f});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0.0f, 279.0f, 132.5f, 0.0f});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(QuantizedMatMulPerChannelTest, RejectsBadRanges) {
+  MakeOp(false, {"BiasAdd"});
+  AddInputFromArray<qint8>(TensorShape({1, 1}), {1});
+  AddInputFromArray<qint8>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2}), {0.0f, 0.0f});
+  AddInputFromArray<float>(TensorShape({}), {-128.0f});
+  AddInputFromArray<float>(TensorShape({}), {127.0f});
+  AddInputFromArray<float>(TensorShape({3}), {-1.0f, -1.0f, -1.0f});
+  AddInputFromArray<float>(TensorShape({3}), {1.0f, 1.0f, 1.0f});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace tensorflow
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/kernels/redux_functor.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -279,6 +280,81 @@ struct ReduceFunctorBase {
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
     : ReduceFunctorBase<CPUDevice, Reducer> {};
+
+// Sums and means of float and double tensors over the outer dimension of a
+// matrix, the middle dimension of a 3-D tensor or all elements use the
+// cache-blocked kernels of redux_functor.h, which vectorize and parallelize
+// these patterns better than Eigen's generic reductions on the CPU.
+template <typename Reducer, typename T, bool is_mean>
+struct BlockedSumReduceFunctor : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    if (in.size() == 0 ||
+        !ReduceBlocked(d, out, in, reduction_axes,
+                       std::integral_constant<int, IN_T::NumDimensions>())) {
+      ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in,
+                                                    reduction_axes, reducer);
+      return;
+    }
+    if (is_mean) {
+      out.device(d) = out / static_cast<T>(in.size() / out.size());
+    }
+  }
+
+ private:
+  template <typename OUT_T, typename IN_T, typename ReductionAxes, int rank>
+  static bool ReduceBlocked(const CPUDevice& d, OUT_T out, IN_T in,
+                            const ReductionAxes& reduction_axes,
+                            std::integral_constant<int, rank>) {
+    return false;
+  }
+
+  // Reduces all elements of a vector.
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool ReduceBlocked(const CPUDevice& d, OUT_T out, IN_T in,
+                            const ReductionAxes& reduction_axes,
+                            std::integral_constant<int, 1>) {
+    if (OUT_T::NumDimensions != 0) return false;
+    out.data()[0] = SumAllElements<T>()(d, in.data(), in.size());
+    return true;
+  }
+
+  // Reduces the outer dimension of a matrix.
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool ReduceBlocked(const CPUDevice& d, OUT_T out, IN_T in,
+                            const ReductionAxes& reduction_axes,
+                            std::integral_constant<int, 2>) {
+    if (OUT_T::NumDimensions != 1 || reduction_axes[0] != 0) return false;
+    SumMiddleDimension<T>()(d, in.data(), 1, in.dimension(0), in.dimension(1),
+                            out.data());
+    return true;
+  }
+
+  // Reduces the middle dimension of a 3-D tensor.
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool ReduceBlocked(const CPUDevice& d, OUT_T out, IN_T in,
+                            const ReductionAxes& reduction_axes,
+                            std::integral_constant<int, 3>) {
+    if (OUT_T::NumDimensions != 2 || reduction_axes[0] != 1) return false;
+    SumMiddleDimension<T>()(d, in.data(), in.dimension(0), in.dimension(1),
+                            in.dimension(2), out.data());
+    return true;
+  }
+};
+
+#define BLOCKED_REDUCE_FUNCTOR(T)                                            \
+  template <>                                                                \
+  struct ReduceFunctor<CPUDevice, Eigen::internal::SumReducer<T>>            \
+      : BlockedSumReduceFunctor<Eigen::internal::SumReducer<T>, T, false> {}; \
+  template <>                                                                \
+  struct ReduceFunctor<CPUDevice, MeanReducer<T>>                            \
+      : BlockedSumReduceFunctor<MeanReducer<T>, T, true> {};
+BLOCKED_REDUCE_FUNCTOR(float);
+BLOCKED_REDUCE_FUNCTOR(double);
+#undef BLOCKED_REDUCE_FUNCTOR
 #if TENSORFLOW_USE_SYCL
 template <typename Reducer>
 struct ReduceFunctor<SYCLDevice, Reducer>
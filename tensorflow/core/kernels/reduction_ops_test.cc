@@ -189,4 +189,27 @@ static void BM_Bool2DToScalarGPU(int iters, int num_x, int num_y) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+static void BM_Sum2DToScalarCPU(int iters, int num_x, int num_y) {
+  ReduceToScalar<float>(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DToScalarCPU)->ArgPair(4096, 4096)->ArgPair(1 << 20, 64);
+
+static void BM_Sum2DColumnReduceCPU(int iters, int num_x, int num_y) {
+  DoColReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DColumnReduceCPU)
+    ->ArgPair(1 << 20, 64)
+    ->ArgPair(8192, 8192)
+    ->ArgPair(1 << 16, 1024);
+
+static void BM_Mean2DColumnReduceCPU(int iters, int num_x, int num_y) {
+  DoColReduce(iters, "cpu", "Mean", num_x, num_y);
+}
+BENCHMARK(BM_Mean2DColumnReduceCPU)->ArgPair(1 << 20, 64);
+
+static void BM_Sum3DYReduceCPU(int iters, int num_x, int num_y) {
+  Do3DYReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum3DYReduceCPU)->ArgPair(1 << 16, 64)->ArgPair(1024, 1024);
+
 }  // end namespace tensorflow
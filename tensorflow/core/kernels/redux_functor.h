@@ -18,6 +18,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
@@ -336,6 +339,193 @@ struct ReduceMiddleDimensions {
   }
 };
 
+// Adds the "rows" x "cols" row-major matrix "input", whose rows are "stride"
+// elements apart, to the "cols" elements of "output".  The rows are added in
+// tiles that stay in the L1 cache, and within a tile every block of columns is
+// accumulated in packet registers, so that "output" is loaded and stored once
+// per tile instead of once per row.
+template <typename T>
+void AccumulateRows(const T* input, Eigen::Index stride, Eigen::Index rows,
+                    Eigen::Index cols, T* output) {
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  constexpr Eigen::Index kPacketSize = Eigen::internal::packet_traits<T>::size;
+  constexpr Eigen::Index kTileBytes = 16 * 1024;
+  const Eigen::Index tile_rows = std::max<Eigen::Index>(
+      1, kTileBytes / (std::max<Eigen::Index>(cols, 1) * sizeof(T)));
+
+  for (Eigen::Index tile = 0; tile < rows; tile += tile_rows) {
+    const T* tile_input = input + tile * stride;
+    const Eigen::Index num_rows = std::min(tile_rows, rows - tile);
+    Eigen::Index j = 0;
+    for (; j + 4 * kPacketSize <= cols; j += 4 * kPacketSize) {
+      T* out = output + j;
+      Packet p0 = Eigen::internal::ploadu<Packet>(out);
+      Packet p1 = Eigen::internal::ploadu<Packet>(out + kPacketSize);
+      Packet p2 = Eigen::internal::ploadu<Packet>(out + 2 * kPacketSize);
+      Packet p3 = Eigen::internal::ploadu<Packet>(out + 3 * kPacketSize);
+      for (Eigen::Index i = 0; i < num_rows; ++i) {
+        const T* in = tile_input + i * stride + j;
+        p0 = Eigen::internal::padd(p0, Eigen::internal::ploadu<Packet>(in));
+        p1 = Eigen::internal::padd(
+            p1, Eigen::internal::ploadu<Packet>(in + kPacketSize));
+        p2 = Eigen::internal::padd(
+            p2, Eigen::internal::ploadu<Packet>(in + 2 * kPacketSize));
+        p3 = Eigen::internal::padd(
+            p3, Eigen::internal::ploadu<Packet>(in + 3 * kPacketSize));
+      }
+      Eigen::internal::pstoreu(out, p0);
+      Eigen::internal::pstoreu(out + kPacketSize, p1);
+      Eigen::internal::pstoreu(out + 2 * kPacketSize, p2);
+      Eigen::internal::pstoreu(out + 3 * kPacketSize, p3);
+    }
+    for (; j + kPacketSize <= cols; j += kPacketSize) {
+      Packet p = Eigen::internal::ploadu<Packet>(output + j);
+      for (Eigen::Index i = 0; i < num_rows; ++i) {
+        p = Eigen::internal::padd(
+            p, Eigen::internal::ploadu<Packet>(tile_input + i * stride + j));
+      }
+      Eigen::internal::pstoreu(output + j, p);
+    }
+    for (; j < cols; ++j) {
+      T sum = output[j];
+      for (Eigen::Index i = 0; i < num_rows; ++i) {
+        sum += tile_input[i * stride + j];
+      }
+      output[j] = sum;
+    }
+  }
+}
+
+// Returns the sum of the "size" elements of "input", accumulated in packet
+// registers.
+template <typename T>
+T SumElements(const T* input, Eigen::Index size) {
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+  constexpr Eigen::Index kPacketSize = Eigen::internal::packet_traits<T>::size;
+  Eigen::Index i = 0;
+  T sum(0);
+  if (size >= 4 * kPacketSize) {
+    Packet p0 = Eigen::internal::ploadu<Packet>(input);
+    Packet p1 = Eigen::internal::ploadu<Packet>(input + kPacketSize);
+    Packet p2 = Eigen::internal::ploadu<Packet>(input + 2 * kPacketSize);
+    Packet p3 = Eigen::internal::ploadu<Packet>(input + 3 * kPacketSize);
+    for (i = 4 * kPacketSize; i + 4 * kPacketSize <= size;
+         i += 4 * kPacketSize) {
+      const T* in = input + i;
+      p0 = Eigen::internal::padd(p0, Eigen::internal::ploadu<Packet>(in));
+      p1 = Eigen::internal::padd(
+          p1, Eigen::internal::ploadu<Packet>(in + kPacketSize));
+      p2 = Eigen::internal::padd(
+          p2, Eigen::internal::ploadu<Packet>(in + 2 * kPacketSize));
+      p3 = Eigen::internal::padd(
+          p3, Eigen::internal::ploadu<Packet>(in + 3 * kPacketSize));
+    }
+    sum = Eigen::internal::predux(Eigen::internal::padd(
+        Eigen::internal::padd(p0, p1), Eigen::internal::padd(p2, p3)));
+  }
+  for (; i < size; ++i) sum += input[i];
+  return sum;
+}
+
+// Sums the middle dimension of the row-major [outer, middle, inner] tensor
+// "input" into the [outer, inner] tensor "output".  With outer == 1 this is
+// the reduction of the outer dimension of a matrix, e.g. its column sums.
+//
+// When there are enough columns, every block of the output columns is
+// reduced by a single thread.  Otherwise the middle dimension is split into
+// blocks of rows whose partial sums are added at the end, so that tall and
+// narrow inputs such as [1M, 64] still use all threads.
+template <typename T>
+struct SumMiddleDimension {
+  void operator()(const CPUDevice& device, const T* input, Eigen::Index outer,
+                  Eigen::Index middle, Eigen::Index inner, T* output) const {
+    std::fill(output, output + outer * inner, T(0));
+    if (outer * middle * inner == 0) return;
+
+    const Eigen::Index num_threads = device.numThreads();
+    // Minimum number of columns and elements reduced by one block.
+    constexpr Eigen::Index kMinBlockCols = 256;
+    constexpr Eigen::Index kMinBlockSize = 16 * 1024;
+    const Eigen::Index add_cost = Eigen::TensorOpCost::AddCost<T>();
+
+    const Eigen::Index col_blocks = Eigen::divup(inner, kMinBlockCols);
+    if (outer * col_blocks >= num_threads || middle * inner < kMinBlockSize) {
+      const Eigen::Index block_cols = Eigen::divup(inner, col_blocks);
+      const auto compute = [=](Eigen::Index start, Eigen::Index limit) {
+        for (Eigen::Index b = start; b < limit; ++b) {
+          const Eigen::Index o = b / col_blocks;
+          const Eigen::Index col = (b % col_blocks) * block_cols;
+          const Eigen::Index cols = std::min(block_cols, inner - col);
+          AccumulateRows(input + o * middle * inner + col, inner, middle, cols,
+                         output + o * inner + col);
+        }
+      };
+      const Eigen::Index block_size = middle * block_cols;
+      device.parallelFor(outer * col_blocks,
+                         Eigen::TensorOpCost(block_size * sizeof(T),
+                                             block_cols * sizeof(T),
+                                             block_size * add_cost),
+                         compute);
+      return;
+    }
+
+    const Eigen::Index row_blocks = std::min(
+        Eigen::divup(num_threads, outer),
+        std::max<Eigen::Index>(1, middle * inner / kMinBlockSize));
+    const Eigen::Index block_rows = Eigen::divup(middle, row_blocks);
+    // Partial sums of each block of rows, as [outer, row_blocks, inner].
+    std::vector<T> partials(outer * row_blocks * inner, T(0));
+    const auto compute = [&](Eigen::Index start, Eigen::Index limit) {
+      for (Eigen::Index b = start; b < limit; ++b) {
+        const Eigen::Index o = b / row_blocks;
+        const Eigen::Index row = (b % row_blocks) * block_rows;
+        if (row >= middle) continue;
+        AccumulateRows(input + (o * middle + row) * inner, inner,
+                       std::min(block_rows, middle - row), inner,
+                       partials.data() + b * inner);
+      }
+    };
+    const Eigen::Index block_size = block_rows * inner;
+    device.parallelFor(
+        outer * row_blocks,
+        Eigen::TensorOpCost(block_size * sizeof(T), inner * sizeof(T),
+                            block_size * add_cost),
+        compute);
+    for (Eigen::Index o = 0; o < outer; ++o) {
+      AccumulateRows(partials.data() + o * row_blocks * inner, inner,
+                     row_blocks, inner, output + o * inner);
+    }
+  }
+};
+
+// Returns the sum of the "size" elements of "input".  Blocks of a fixed size
+// are summed in parallel and their partial sums are added at the end, so the
+// result does not depend on the number of threads.
+template <typename T>
+struct SumAllElements {
+  T operator()(const CPUDevice& device, const T* input,
+               Eigen::Index size) const {
+    constexpr Eigen::Index kBlockSize = 16 * 1024;
+    const Eigen::Index num_blocks = Eigen::divup(size, kBlockSize);
+    if (num_blocks <= 1) return SumElements(input, size);
+
+    std::vector<T> partials(num_blocks);
+    const auto compute = [&](Eigen::Index start, Eigen::Index limit) {
+      for (Eigen::Index b = start; b < limit; ++b) {
+        const Eigen::Index offset = b * kBlockSize;
+        partials[b] =
+            SumElements(input + offset, std::min(kBlockSize, size - offset));
+      }
+    };
+    device.parallelFor(
+        num_blocks,
+        Eigen::TensorOpCost(kBlockSize * sizeof(T), sizeof(T),
+                            kBlockSize * Eigen::TensorOpCost::AddCost<T>()),
+        compute);
+    return SumElements(partials.data(), num_blocks);
+  }
+};
+
 }  // namespace functor
 }  // namespace tensorflow
 
@@ -21,6 +21,16 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 
 namespace tensorflow {
+
+// Resizes "images" into "resized_images" on the calling thread.  This is the
+// CPU implementation of the ResizeBilinear functor, for CPU kernels that
+// resize images as part of their own sharded work.
+template <typename T>
+void ResizeBilinearCpu(typename TTypes<T, 4>::ConstTensor images,
+                       const float height_scale, const float width_scale,
+                       const bool half_pixel_centers,
+                       typename TTypes<float, 4>::Tensor resized_images);
+
 namespace functor {
 
 template <typename Device, typename T>
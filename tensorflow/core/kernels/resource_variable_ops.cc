@@ -53,6 +53,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/resource_variable_ops.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -79,6 +80,12 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/util.h"
 
+#if GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/stream_executor/cuda/cuda_activation.h"
+#endif  // GOOGLE_CUDA
+
 namespace tensorflow {
 
 REGISTER_KERNEL_BUILDER(Name("_VarHandlesOp").Device(DEVICE_CPU),
@@ -133,7 +140,7 @@ Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   core::RefCountPtr<Var> variable;
   const ResourceHandle& handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Error while reading resource variable ", handle.name(),
@@ -399,12 +406,14 @@ class AssignVariableOp : public OpKernel {
                     "Trying to assign variable with wrong dtype. Expected ",
                     DataTypeString(variable->tensor()->dtype()), " got ",
                     DataTypeString(dtype_)));
-    if (variable->copy_on_read_mode.load()) {
+    // Variables designated for unified memory are copied there, as the value
+    // was allocated in the device memory.
+    if (variable->copy_on_read_mode.load() ||
+        UseUnifiedMemoryForVariable(context, value.TotalBytes())) {
       PersistentTensor unused;
       Tensor* tmp;
-      AllocatorAttributes attr;
-      attr.set_gpu_compatible(true);
-      attr.set_nic_compatible(true);
+      AllocatorAttributes attr =
+          VariableAllocatorAttributes(context, value.TotalBytes());
       OP_REQUIRES_OK(context,
                      context->allocate_persistent(value.dtype(), value.shape(),
                                                   &unused, &tmp, attr));
@@ -629,7 +638,7 @@ class ResourceGatherOp : public OpKernel {
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
-    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+    OP_REQUIRES_OK(c, variable_cache_.Lookup(c, HandleFromInput(c, 0), &v));
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
@@ -737,6 +746,7 @@ class ResourceGatherOp : public OpKernel {
   }
 
   int32 batch_dims_ = 0;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 #define REGISTER_GATHER_FULL(dev, type, index_type)                    \
@@ -788,6 +798,109 @@ REGISTER_KERNEL_BUILDER(Name("ResourceGather")
 #undef REGISTER_GATHER_ALL_INDICES
 #undef REGISTER_GATHER_FULL
 
+// Migrates the rows of a variable in unified memory (see
+// VariableAllocatorAttributes) that the next step is going to gather to the
+// device, ahead of the gather. Does nothing for variables in device memory, and
+// on devices without unified memory.
+template <typename Index>
+class ResourceGatherPrefetchOp : public OpKernel {
+ public:
+  explicit ResourceGatherPrefetchOp(OpKernelConstruction* c) : OpKernel(c) {}
+
+  void Compute(OpKernelContext* c) override {
+    core::RefCountPtr<Var> v;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+#if GOOGLE_CUDA
+    if (c->device()->tensorflow_gpu_device_info() == nullptr) return;
+    tf_shared_lock ml(*v->mu());
+    const Tensor& params = *v->tensor();
+    const Tensor& indices = c->input(1);
+    if (params.dims() == 0 || params.dim_size(0) == 0 ||
+        indices.NumElements() == 0 || params.dtype() == DT_VARIANT) {
+      return;
+    }
+    const CUdeviceptr base =
+        reinterpret_cast<CUdeviceptr>(params.tensor_data().data());
+    se::Stream* stream = c->op_device_context()->stream();
+    OP_REQUIRES(c, stream, errors::Internal("No GPU stream available."));
+    se::cuda::ScopedActivateExecutorContext scoped_activation{stream->parent()};
+    unsigned int is_managed = 0;
+    if (cuPointerGetAttribute(&is_managed, CU_POINTER_ATTRIBUTE_IS_MANAGED,
+                              base) != CUDA_SUCCESS ||
+        !is_managed) {
+      return;
+    }
+
+    // Out of range indices are left for the gather to report.
+    const int64 num_rows = params.dim_size(0);
+    const int64 total_bytes = params.TotalBytes();
+    const int64 row_bytes = total_bytes / num_rows;
+    const auto indices_flat = indices.flat<Index>();
+    std::vector<int64> rows;
+    rows.reserve(indices_flat.size());
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      const Index index = indices_flat(i);
+      if (index >= 0 && index < num_rows) rows.push_back(index);
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // Pages are migrated whole, so rows closer than a page apart are
+    // prefetched together.
+    constexpr int64 kPageBytes = 4096;
+    const CUstream cu_stream = *reinterpret_cast<const CUstream*>(
+        stream->implementation()->GpuStreamMemberHack());
+    const int device = stream->parent()->device_ordinal();
+    auto prefetch = [&](int64 from, int64 to) {
+      from -= from % kPageBytes;
+      CUresult res =
+          cuMemPrefetchAsync(base + from, to - from, device, cu_stream);
+      if (res != CUDA_SUCCESS) {
+        LOG_FIRST_N(WARNING, 1) << "cuMemPrefetchAsync failed with " << res;
+      }
+    };
+    int64 begin = -1;
+    int64 end = -1;
+    for (const int64 row : rows) {
+      const int64 row_begin = row * row_bytes;
+      if (begin >= 0 && row_begin <= end + kPageBytes) {
+        end = row_begin + row_bytes;
+        continue;
+      }
+      if (begin >= 0) prefetch(begin, end);
+      begin = row_begin;
+      end = row_begin + row_bytes;
+    }
+    if (begin >= 0) prefetch(begin, end);
+#endif  // GOOGLE_CUDA
+  }
+};
+
+#define REGISTER_GATHER_PREFETCH_CPU(index_type)                       \
+  REGISTER_KERNEL_BUILDER(Name("ResourceGatherPrefetch")               \
+                              .Device(DEVICE_CPU)                      \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          ResourceGatherPrefetchOp<index_type>)
+
+REGISTER_GATHER_PREFETCH_CPU(int32);
+REGISTER_GATHER_PREFETCH_CPU(int64);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define REGISTER_GATHER_PREFETCH_GPU(index_type)                       \
+  REGISTER_KERNEL_BUILDER(Name("ResourceGatherPrefetch")               \
+                              .Device(DEVICE_GPU)                      \
+                              .HostMemory("resource")                  \
+                              .HostMemory("indices")                   \
+                              .TypeConstraint<index_type>("Tindices"), \
+                          ResourceGatherPrefetchOp<index_type>)
+
+REGISTER_GATHER_PREFETCH_GPU(int32);
+REGISTER_GATHER_PREFETCH_GPU(int64);
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#undef REGISTER_GATHER_PREFETCH_CPU
+#undef REGISTER_GATHER_PREFETCH_GPU
+
 template <typename Device, typename T, typename Index>
 class ResourceGatherNdOp : public OpKernel {
  public:
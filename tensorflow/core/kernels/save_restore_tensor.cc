@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
@@ -30,6 +31,9 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/shared_tensor_cache.h"
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -274,7 +278,22 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && use_mmap) {
+      // Lookup the full tensor, mapped in place where possible.
+      Tensor mapped_tensor;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped_tensor));
+      context->set_output(idx, mapped_tensor);
+    } else if (shape_and_slice.empty() &&
+               SharedTensorCache::Global()->enabled()) {
+      // Lookup the full tensor, sharing its buffer with equal tensors that
+      // were restored or loaded before.
+      Tensor full_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_temp(
+          context->expected_output_dtype(idx), restored_full_shape,
+          &full_tensor));
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &full_tensor));
+      context->set_output(idx, SharedTensorCache::Global()->Share(full_tensor));
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -309,10 +328,74 @@ struct RestoreOp {
   string tensor_name;
   string shape_and_slice;
   string reader_prefix;
+  // Whether full tensors are restored as read-only memory mappings of the
+  // checkpoint, where possible, instead of copies.
+  bool use_mmap;
 
   ::tensorflow::Status status;
 };
 
+// Runs of small tensors holding more bytes than this are restored from the
+// thread-pool too, by one BundleReader per run, so that restoring many small
+// tensors is not limited by a single thread.
+const int64 kMinRestoreGroupBytes = 64 << 20;  // 64MB
+
+// A run of small restore operations that are restored one after the other
+// with one BundleReader.
+struct RestoreOpGroup {
+  void run_with_new_reader() {
+    BundleReader reader(Env::Default(), ops.front()->reader_prefix);
+    if (!reader.status().ok()) {
+      status = reader.status();
+      return;
+    }
+    for (RestoreOp* op : ops) {
+      status = op->run(&reader);
+      if (!status.ok()) return;
+    }
+  }
+
+  std::vector<RestoreOp*> ops;
+  int64 bytes = 0;
+
+  ::tensorflow::Status status;
+};
+
+// Restores full tensors from the chain of delta bundles ending at "prefix".
+Status RestoreTensorsFromDeltaBundles(OpKernelContext* context,
+                                      const string& prefix,
+                                      const Tensor& tensor_names,
+                                      const Tensor& shape_and_slices,
+                                      gtl::ArraySlice<DataType> dtypes) {
+  const auto& tensor_names_flat = tensor_names.flat<tstring>();
+  const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+  DeltaBundleReader reader(Env::Default(), prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  for (int i = 0; i < tensor_names_flat.size(); ++i) {
+    const string& tensor_name = tensor_names_flat(i);
+    if (!shape_and_slices_flat(i).empty()) {
+      return errors::Unimplemented(
+          "tensor_name = ", tensor_name,
+          "; restoring slices from delta checkpoints is not supported");
+    }
+    DataType original_dtype;
+    TensorShape restored_full_shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(
+        tensor_name, &original_dtype, &restored_full_shape));
+    if (dtypes[i] != original_dtype) {
+      return errors::InvalidArgument(
+          "tensor_name = ", tensor_name, "; expected dtype ",
+          DataTypeString(dtypes[i]), " does not equal original dtype ",
+          DataTypeString(original_dtype));
+    }
+    Tensor* restored_tensor;
+    TF_RETURN_IF_ERROR(
+        context->allocate_output(i, restored_full_shape, &restored_tensor));
+    TF_RETURN_IF_ERROR(reader.Lookup(tensor_name, restored_tensor));
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
@@ -332,19 +415,33 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
               return tensor_names_flat(a) < tensor_names_flat(b);
             });
 
+  // Setting TF_RESTORE_V2_USE_MMAP restores suitably aligned tensors as
+  // memory mappings of the checkpoint, see BundleReader::LookupMapped().
+  bool use_mmap;
+  TF_RETURN_IF_ERROR(
+      ReadBoolFromEnvVar("TF_RESTORE_V2_USE_MMAP", false, &use_mmap));
+
   std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
   std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
 
   BundleReader default_reader(Env::Default(), prefix_string);
   TF_RETURN_IF_ERROR(default_reader.status());
+  if (!default_reader.base_prefix().empty()) {
+    return RestoreTensorsFromDeltaBundles(context, prefix_string, tensor_names,
+                                          shape_and_slices, dtypes);
+  }
 
   std::vector<string> mismatched_errors;
+  std::vector<int64> restored_bytes(tensor_names_flat.size());
   for (const size_t i : sorted_name_idx) {
     TensorShape restored_full_shape;
     DataType original_dtype;
     const string& tensor_name = tensor_names_flat(i);
     TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
         tensor_name, &original_dtype, &restored_full_shape));
+    // Strings are counted as one byte per element.
+    restored_bytes[i] = restored_full_shape.num_elements() *
+                        std::max(DataTypeSize(original_dtype), 1);
     if (dtypes[i] != original_dtype) {
       string error_msg = strings::StrCat(
           "tensor_name = ", tensor_name, "; expected dtype ",
@@ -358,15 +455,23 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // The small tensors are split into runs of consecutive names.  The first
+  // run is restored from the op thread, and the others from the thread-pool.
+  std::vector<RestoreOpGroup> direct_restore_groups(1);
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
+    auto op = new RestoreOp{context, i, tensor_name, shape_and_slice,
+                            prefix_string, use_mmap};
     if (op->should_run_in_pool(&default_reader)) {
       pool_restore_ops.emplace_back(op);
     } else {
       direct_restore_ops.emplace_back(op);
+      if (direct_restore_groups.back().bytes >= kMinRestoreGroupBytes) {
+        direct_restore_groups.emplace_back();
+      }
+      direct_restore_groups.back().ops.push_back(op);
+      direct_restore_groups.back().bytes += restored_bytes[i];
     }
   }
 
@@ -374,16 +479,20 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     // Schedule any threaded operations first, skipping thread pool creation if
     // we don't have any expensive operations.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
+    if (!pool_restore_ops.empty() || direct_restore_groups.size() > 1) {
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto& op : pool_restore_ops) {
         reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
       }
+      for (size_t i = 1; i < direct_restore_groups.size(); ++i) {
+        RestoreOpGroup* group = &direct_restore_groups[i];
+        reader_pool->Schedule([group]() { group->run_with_new_reader(); });
+      }
     }
 
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
+    // Read the first run of small tensors from the op thread
+    for (RestoreOp* op : direct_restore_groups.front().ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
   }
@@ -392,6 +501,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   for (auto& op : pool_restore_ops) {
     TF_RETURN_IF_ERROR(op->status);
   }
+  for (size_t i = 1; i < direct_restore_groups.size(); ++i) {
+    TF_RETURN_IF_ERROR(direct_restore_groups[i].status);
+  }
 
   for (auto i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
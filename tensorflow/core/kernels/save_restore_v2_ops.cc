@@ -29,7 +29,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 
@@ -90,7 +92,29 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    // Setting TF_SAVE_V2_NUM_DATA_STRIPES spreads the tensors across that many
+    // data files, which are written concurrently.
+    int64 num_stripes;
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_SAVE_V2_NUM_DATA_STRIPES",
+                                                1, &num_stripes));
+    OP_REQUIRES(context, num_stripes >= 1,
+                errors::InvalidArgument(
+                    "TF_SAVE_V2_NUM_DATA_STRIPES must be at least 1, got ",
+                    num_stripes));
+    writer_options_.num_stripes = num_stripes;
+    // Setting TF_SAVE_V2_DATA_ALIGNMENT to a multiple of 64, such as the page
+    // size, lets readers map the saved tensors in place instead of copying
+    // them (see TF_RESTORE_V2_USE_MMAP).
+    int64 data_alignment;
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_SAVE_V2_DATA_ALIGNMENT", 1,
+                                                &data_alignment));
+    OP_REQUIRES(context, data_alignment >= 1,
+                errors::InvalidArgument(
+                    "TF_SAVE_V2_DATA_ALIGNMENT must be at least 1, got ",
+                    data_alignment));
+    writer_options_.data_alignment = data_alignment;
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -105,7 +129,7 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    BundleWriter writer(Env::Default(), prefix_string, writer_options_);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
@@ -136,6 +160,9 @@ class SaveV2 : public OpKernel {
     }
     OP_REQUIRES_OK(context, writer.Finish());
   }
+
+ private:
+  BundleWriter::Options writer_options_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -239,4 +266,69 @@ class MergeV2Checkpoints : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
 
+// Saves a list of named tensors as a delta over a base V2 checkpoint.
+class SaveDeltaV2 : public OpKernel {
+ public:
+  explicit SaveDeltaV2(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& base_prefix = context->input(1);
+    const Tensor& tensor_names = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsScalar(prefix.shape()) &&
+                    TensorShapeUtils::IsScalar(base_prefix.shape()),
+                errors::InvalidArgument(
+                    "Inputs prefix and base_prefix should be scalars, got ",
+                    prefix.shape().DebugString(), " and ",
+                    base_prefix.shape().DebugString(), " instead."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(tensor_names.shape()),
+                errors::InvalidArgument(
+                    "Input tensor_names should be a 1-D tensor, got ",
+                    tensor_names.shape().DebugString(), " instead."));
+    const int kFixedInputs = 3;  // Prefix, base prefix, tensor names.
+    const int num_tensors = static_cast<int>(tensor_names.NumElements());
+    OP_REQUIRES(context, context->num_inputs() == num_tensors + kFixedInputs,
+                errors::InvalidArgument(
+                    "Got ", num_tensors, " tensor names but ",
+                    context->num_inputs() - kFixedInputs, " tensors."));
+
+    const auto& tensor_names_flat = tensor_names.flat<tstring>();
+    DeltaBundleWriter writer(Env::Default(), prefix.scalar<tstring>()(),
+                             base_prefix.scalar<tstring>()());
+    OP_REQUIRES_OK(context, writer.status());
+    for (int i = 0; i < num_tensors; ++i) {
+      OP_REQUIRES_OK(context, writer.Add(tensor_names_flat(i),
+                                         context->input(i + kFixedInputs)));
+    }
+    OP_REQUIRES_OK(context, writer.Finish());
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveDeltaV2").Device(DEVICE_CPU), SaveDeltaV2);
+
+// Rewrites a chain of delta checkpoints as a full V2 checkpoint.
+class CompactDeltaCheckpoint : public OpKernel {
+ public:
+  explicit CompactDeltaCheckpoint(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& compacted_prefix = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsScalar(prefix.shape()) &&
+                    TensorShapeUtils::IsScalar(compacted_prefix.shape()),
+                errors::InvalidArgument(
+                    "Inputs prefix and compacted_prefix should be scalars, "
+                    "got ",
+                    prefix.shape().DebugString(), " and ",
+                    compacted_prefix.shape().DebugString(), " instead."));
+    OP_REQUIRES_OK(context, CompactDeltaBundles(
+                                Env::Default(), prefix.scalar<tstring>()(),
+                                compacted_prefix.scalar<tstring>()()));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("CompactDeltaCheckpoint").Device(DEVICE_CPU),
+                        CompactDeltaCheckpoint);
+
 }  // namespace tensorflow
@@ -20,7 +20,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <atomic>
+#include <utility>
+#include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -131,6 +134,13 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
+    if (d.numThreads() > 1 && batch_size > 1 &&
+        batch_size * slice_size >= kMinGroupedScatterSize &&
+        slice_size <= kMaxGroupedScatterSliceSize) {
+      return GroupedScatter(d, slice_size, output_shape_prefix, batch_strides,
+                            Tindices, Tupdates, Toutput);
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
@@ -155,6 +165,73 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
 
     return error_loc;
   }
+
+ private:
+  // Scatters of fewer elements, or of larger slices, whose updates are
+  // parallelized by Eigen, apply the updates one at a time.
+  static constexpr Eigen::DenseIndex kMinGroupedScatterSize = 16 * 1024;
+  static constexpr Eigen::DenseIndex kMaxGroupedScatterSliceSize = 4 * 1024;
+
+  // Groups the updates by the row of the output they write to, and applies
+  // the groups in parallel.  The updates of a group are applied by a single
+  // thread in their original order, so the result is the same as applying
+  // them one at a time, and only the last update of a group is applied for
+  // ASSIGN.  Nothing is written if an index is out of bounds.
+  Index GroupedScatter(
+      const CPUDevice& d, const Index slice_size,
+      const Eigen::array<Eigen::DenseIndex, IXDIM>& output_shape_prefix,
+      const Index* batch_strides,
+      typename TTypes<Index, 2>::ConstTensor Tindices,
+      typename TTypes<T, 2>::ConstTensor Tupdates,
+      typename TTypes<T, 2>::Tensor Toutput) {
+    const Eigen::DenseIndex batch_size = Tindices.dimension(0);
+    // Pairs of the output row and the location of the update.
+    std::vector<std::pair<Index, Index>> rows(batch_size);
+    for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
+      Index i = 0;
+      bool out_of_bounds = false;
+      for (int dim = 0; dim < IXDIM; ++dim) {
+        const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+        out_of_bounds |= !FastBoundsCheck(ix_d, output_shape_prefix[dim]);
+        i += ix_d * batch_strides[dim];
+      }
+      if (TF_PREDICT_FALSE(out_of_bounds)) return loc;
+      rows[loc] = {i, static_cast<Index>(loc)};
+    }
+    std::sort(rows.begin(), rows.end());
+
+    std::vector<Eigen::DenseIndex> group_starts;
+    for (Eigen::DenseIndex k = 0; k < batch_size; ++k) {
+      if (k == 0 || rows[k].first != rows[k - 1].first) {
+        group_starts.push_back(k);
+      }
+    }
+    const Eigen::DenseIndex num_groups = group_starts.size();
+    group_starts.push_back(batch_size);
+
+    auto apply_groups = [&](Eigen::DenseIndex begin, Eigen::DenseIndex end) {
+      const Eigen::DefaultDevice device;
+      for (Eigen::DenseIndex g = begin; g < end; ++g) {
+        Eigen::DenseIndex k = group_starts[g];
+        if (OP == scatter_nd_op::UpdateOp::ASSIGN) k = group_starts[g + 1] - 1;
+        for (; k < group_starts[g + 1]; ++k) {
+          auto input_chip = Toutput.template chip<0>(rows[k].first);
+          auto output_chip = input_chip;
+          auto update_chip = Tupdates.template chip<0>(rows[k].second);
+          update_executor::UpdateExecutor<
+              Eigen::DefaultDevice, decltype(input_chip),
+              decltype(update_chip), decltype(output_chip),
+              OP>::Execute(device, input_chip, update_chip, output_chip);
+        }
+      }
+    };
+    const Eigen::DenseIndex group_size =
+        slice_size * Eigen::divup<Eigen::DenseIndex>(batch_size, num_groups);
+    const Eigen::TensorOpCost cost(2 * sizeof(T) * group_size,
+                                   sizeof(T) * slice_size, group_size);
+    d.parallelFor(num_groups, cost, apply_groups);
+    return -1;
+  }
 };
 
 #define REGISTER_SCATTER_ND_FULL(T, Index, op)                               \
@@ -237,6 +237,65 @@ TEST_F(ScatterNdUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+class ScatterNdAddOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType variable_ref_type, DataType index_type) {
+    TF_ASSERT_OK(NodeDefBuilder("myop", "ScatterNdAdd")
+                     .Input(FakeInput(variable_ref_type))
+                     .Input(FakeInput(index_type))
+                     .Input(FakeInput(RemoveRefType(variable_ref_type)))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+// Large enough for the updates to be grouped by row and applied in parallel.
+TEST_F(ScatterNdAddOpTest, ManyDuplicateIndices) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  const int kRows = 64;
+  const int kCols = 512;
+  const int kUpdates = 256;
+  std::vector<float> params(kRows * kCols, 1.0f);
+  std::vector<int32> indices(kUpdates);
+  std::vector<float> updates(kUpdates * kCols);
+  std::vector<float> expected_values = params;
+  for (int i = 0; i < kUpdates; ++i) {
+    // Every row but the last one is updated 4 or 5 times, out of order.
+    indices[i] = (i * 7) % (kRows - 1);
+    for (int j = 0; j < kCols; ++j) {
+      updates[i * kCols + j] = (i + j) % 10;
+      expected_values[indices[i] * kCols + j] += (i + j) % 10;
+    }
+  }
+  AddInputFromArray<float>(TensorShape({kRows, kCols}), params);
+  AddInputFromArray<int32>(TensorShape({kUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kUpdates, kCols}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({kRows, kCols}));
+  test::FillValues<float>(&expected, expected_values);
+  test::ExpectTensorEqual<float>(expected, params_tensor);
+}
+
+TEST_F(ScatterNdAddOpTest, Error_IndexOutOfRangeInLargeScatter) {
+  MakeOp(DT_FLOAT_REF, DT_INT32);
+  const int kRows = 64;
+  const int kCols = 512;
+  const int kUpdates = 256;
+  std::vector<int32> indices(kUpdates, 3);
+  indices[100] = kRows;
+  AddInputFromArray<float>(TensorShape({kRows, kCols}),
+                           std::vector<float>(kRows * kCols, 0.0f));
+  AddInputFromArray<int32>(TensorShape({kUpdates, 1}), indices);
+  AddInputFromArray<float>(TensorShape({kUpdates, kCols}),
+                           std::vector<float>(kUpdates * kCols, 1.0f));
+  Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(
+      s.ToString(), "indices[100] = [64] does not index into shape [64,512]"))
+      << s;
+}
+
 class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
  public:
   void TestBody() override {}
@@ -42,9 +42,10 @@ void FeatureWeightsDenseStorage::UpdateDenseDeltaWeights(
     const std::vector<double>& normalized_bounded_dual_delta) {
   const size_t num_weight_vectors = normalized_bounded_dual_delta.size();
   if (num_weight_vectors == 1) {
-    deltas_.device(device) =
-        deltas_ + dense_vector.RowAsMatrix() *
-                      deltas_.constant(normalized_bounded_dual_delta[0]);
+    // Evaluated on the calling thread: this runs once per example, from
+    // threads that already each work on their own examples.
+    deltas_ += dense_vector.RowAsMatrix() *
+               deltas_.constant(normalized_bounded_dual_delta[0]);
   } else {
     // Transform the dual vector into a column matrix.
     const Eigen::TensorMap<Eigen::Tensor<const double, 2, Eigen::RowMajor>>
@@ -190,27 +191,24 @@ const ExampleStatistics Example::ComputeWxAndWeightedExampleNorm(
     const FeatureWeightsDenseStorage& dense_weights =
         model_weights.dense_weights()[j];
 
-    const Eigen::Tensor<float, 2, Eigen::RowMajor> feature_weights =
-        dense_weights.nominals() +
-        dense_weights.deltas() *
-            dense_weights.deltas().constant(num_loss_partitions);
     if (num_weight_vectors == 1) {
-      const Eigen::Tensor<float, 0, Eigen::RowMajor> prev_prediction =
-          (dense_vector.Row() *
-           regularization.EigenShrinkVector(
-               Eigen::TensorMap<Eigen::Tensor<const float, 1, Eigen::RowMajor>>(
-                   dense_weights.nominals().data(),
-                   dense_weights.nominals().dimension(1))))
-              .sum();
-      const Eigen::Tensor<float, 0, Eigen::RowMajor> prediction =
-          (dense_vector.Row() *
-           regularization.EigenShrinkVector(
-               Eigen::TensorMap<Eigen::Tensor<const float, 1, Eigen::RowMajor>>(
-                   feature_weights.data(), feature_weights.dimension(1))))
-              .sum();
-      result.prev_wx[0] += prev_prediction();
-      result.wx[0] += prediction();
+      // Accumulated feature by feature, rather than with Eigen expressions
+      // that would allocate the weights and their shrunk copies per example.
+      const auto features = dense_vector.Row();
+      const auto nominals = dense_weights.nominals();
+      const auto deltas = dense_weights.deltas();
+      for (int64 k = 0; k < features.size(); ++k) {
+        const double nominal = nominals(0, k);
+        const double feature_weight =
+            nominal + deltas(0, k) * num_loss_partitions;
+        result.prev_wx[0] += features(k) * regularization.Shrink(nominal);
+        result.wx[0] += features(k) * regularization.Shrink(feature_weight);
+      }
     } else {
+      const Eigen::Tensor<float, 2, Eigen::RowMajor> feature_weights =
+          dense_weights.nominals() +
+          dense_weights.deltas() *
+              dense_weights.deltas().constant(num_loss_partitions);
       const Eigen::array<Eigen::IndexPair<int>, 1> product_dims = {
           Eigen::IndexPair<int>(1, 1)};
       const Eigen::Tensor<float, 2, Eigen::RowMajor> prev_prediction =
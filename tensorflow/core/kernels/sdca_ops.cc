@@ -170,6 +170,8 @@ void DoCompute(const ComputeOptions& options, OpKernelContext* const context) {
   } train_step_status;
   std::atomic<std::int64_t> atomic_index(-1);
   auto train_step = [&](const int64 begin, const int64 end) {
+    // Reused for every example of this shard.
+    std::vector<double> normalized_bounded_dual_delta(1);
     // The static_cast here is safe since begin and end can be at most
     // num_examples which is an int.
     for (int id = static_cast<int>(begin); id < end; ++id) {
@@ -201,12 +203,11 @@ void DoCompute(const ComputeOptions& options, OpKernelContext* const context) {
           example_statistics.wx[0], example_statistics.normalized_squared_norm);
 
       // Compute new weights.
-      const double normalized_bounded_dual_delta =
+      normalized_bounded_dual_delta[0] =
           (new_dual - dual) * example_weight /
           options.regularizations.symmetric_l2();
-      model_weights.UpdateDeltaWeights(
-          context->eigen_cpu_device(), example,
-          std::vector<double>{normalized_bounded_dual_delta});
+      model_weights.UpdateDeltaWeights(context->eigen_cpu_device(), example,
+                                       normalized_bounded_dual_delta);
 
       // Update example data.
       example_state_data(example_index, 0) = new_dual;
@@ -23,6 +23,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -38,7 +39,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -514,22 +517,21 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    // Validates the segment ids and records the first index of each segment,
+    // so that the segments can be reduced independently.
+    std::vector<int64> segment_starts;
+    std::vector<SegmentId> segment_rows;
+    SegmentId out_index = internal::SubtleMustCopy(segment_vec(0));
+    segment_starts.push_back(0);
+    segment_rows.push_back(out_index);
+    for (int64 end = 1; end <= num_indices; ++end) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
       SegmentId next_index = 0;
       if (end < num_indices) {
         next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
+        if (out_index == next_index) continue;
         // We have a new segment here.  Verify that the segment ids are growing.
         OP_REQUIRES(context, out_index < next_index,
                     errors::InvalidArgument("segment ids are not increasing"));
@@ -541,34 +543,56 @@ class SparseSegmentReductionOpBase : public OpKernel {
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
-      }
-
-      auto out = output_flat.template chip<0>(out_index);
-      auto temp = temp_flat.template chip<0>(out_index);
-      const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
+      segment_starts.push_back(end);
+      if (end < num_indices) segment_rows.push_back(next_index);
       out_index = next_index;
-      if (end > num_indices) break;
     }
+    const int64 num_segments = segment_rows.size();
+
+    // The segments are reduced in parallel.  Each shard also fills the gaps
+    // before its segments with the default value.
+    mutex mu;
+    int64 bad_position = num_indices;
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      for (int64 s = begin; s < end; ++s) {
+        const SegmentId row = segment_rows[s];
+        const SegmentId uninitialized_index =
+            s == 0 ? 0 : segment_rows[s - 1] + 1;
+        if (row > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              row - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
+
+        const int64 start = segment_starts[s];
+        const int64 num = segment_starts[s + 1] - start;
+        const int64 bad_offset = ReduceSegment(input_flat, indices_vec, start,
+                                               num, row, output_flat,
+                                               temp_flat);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_position = std::min(bad_position, start + bad_offset);
+        }
+      }
+    };
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    const int64 cost_per_segment =
+        (num_indices / num_segments + 1) * num_col *
+        (Eigen::TensorOpCost::AddCost<T>() + sizeof(T));
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_position == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_position,
+                    "] == ", indices_vec(bad_position), " out of range [0, ",
+                    input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = segment_rows.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -610,6 +634,63 @@ class SparseSegmentReductionOpBase : public OpKernel {
     return Tout(1) / m;
   }
 
+  // Reduces the rows `indices_vec[start:start + num]` of `input_flat` into row
+  // `row` of `output_flat`, and returns the offset from `start` of the first
+  // out-of-range index, or -1.
+  int64 ReduceSegment(const typename TTypes<T>::ConstMatrix& input_flat,
+                      const typename TTypes<Index>::ConstVec& indices_vec,
+                      int64 start, int64 num, SegmentId row,
+                      typename TTypes<T>::Matrix output_flat,
+                      typename TTypes<float>::Matrix temp_flat) {
+    if (std::is_floating_point<T>::value) {
+      T* out = &output_flat(row, 0);
+      switch (input_flat.dimension(1)) {
+        case 4:
+          return ReduceFixedCols<4>(input_flat, indices_vec, start, num, out);
+        case 8:
+          return ReduceFixedCols<8>(input_flat, indices_vec, start, num, out);
+        case 16:
+          return ReduceFixedCols<16>(input_flat, indices_vec, start, num, out);
+        case 32:
+          return ReduceFixedCols<32>(input_flat, indices_vec, start, num, out);
+        case 64:
+          return ReduceFixedCols<64>(input_flat, indices_vec, start, num, out);
+        default:
+          break;
+      }
+    }
+    return Reduce<T, Index>(input_flat, indices_vec, start, num,
+                            output_flat.template chip<0>(row),
+                            temp_flat.template chip<0>(row));
+  }
+
+  // Same as Reduce, for rows of `kNumCol` columns.  The rows are accumulated
+  // in a fixed-size buffer, which the compiler keeps in vector registers.
+  template <int kNumCol>
+  int64 ReduceFixedCols(const typename TTypes<T>::ConstMatrix& input_flat,
+                        const typename TTypes<Index>::ConstVec& indices_vec,
+                        int64 start, int64 num, T* out) {
+    const Index num_rows = input_flat.dimension(0);
+    T acc[kNumCol];
+    for (int j = 0; j < kNumCol; ++j) acc[j] = T(0);
+    for (int64 i = 0; i < num; ++i) {
+      const Index index = indices_vec(start + i);
+      if (!FastBoundsCheck(index, num_rows)) return i;
+      const T* in = &input_flat(index, 0);
+      for (int j = 0; j < kNumCol; ++j) acc[j] += in[j];
+    }
+    if (num < 10) {
+      const T scaling_factor = get_scaling_factor<T>(num);
+      for (int j = 0; j < kNumCol; ++j) out[j] = acc[j] * scaling_factor;
+    } else {
+      T divisor(1);
+      if (is_mean_) divisor = static_cast<T>(num);
+      if (is_sqrtn_) divisor = static_cast<T>(sqrt(num));
+      for (int j = 0; j < kNumCol; ++j) out[j] = acc[j] / divisor;
+    }
+    return -1;
+  }
+
   template <typename Tin, typename Tindex, EnableIfNotBfloat16<Tin> = 0>
   int64 Reduce(
       const typename TTypes<Tin>::ConstMatrix& input_flat,
@@ -15,6 +15,7 @@ limitations under the License.
 
 // See docs in ../ops/string_ops.cc.
 
+#include <cstring>
 #include <string>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -62,12 +63,28 @@ class StringJoinOp : public OpKernel {
                                                      &output_tensor));
     auto output_flat = output_tensor->flat<tstring>();
 
+    // Each output is written in place, after computing its size, rather than
+    // joined into a temporary string and copied.
     std::vector<StringPiece> strings(input_list.size());
     for (size_t i = 0; i < input_shape.num_elements(); ++i) {
+      size_t size =
+          input_list.size() > 1 ? separator_.size() * (input_list.size() - 1)
+                                : 0;
       for (int j = 0; j < input_list.size(); ++j) {
         strings[j] = (is_scalar[j]) ? inputs[j](0) : inputs[j](i);
+        size += strings[j].size();
+      }
+      tstring& output = output_flat(i);
+      output.resize_uninitialized(size);
+      char* out = output.mdata();
+      for (int j = 0; j < input_list.size(); ++j) {
+        if (j > 0) {
+          memcpy(out, separator_.data(), separator_.size());
+          out += separator_.size();
+        }
+        memcpy(out, strings[j].data(), strings[j].size());
+        out += strings[j].size();
       }
-      output_flat(i) = absl::StrJoin(strings, separator_);
     }
   }
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace {
@@ -239,9 +240,12 @@ class StringSplitOp : public OpKernel {
   bool skip_empty_;
 };
 
-class StringSplitV2Op : public OpKernel {
+// Base class of the kernels that split a vector of strings with SplitV2 and
+// output the tokens as a SparseTensor.  Subclasses define how the tokens are
+// stored in the values output.
+class StringSplitV2OpBase : public OpKernel {
  public:
-  explicit StringSplitV2Op(OpKernelConstruction* context)
+  explicit StringSplitV2OpBase(OpKernelConstruction* context)
       : OpKernel(context), maxsplit_(-1) {
     OP_REQUIRES_OK(context, context->GetAttr("maxsplit", &maxsplit_));
   }
@@ -290,7 +294,6 @@ class StringSplitV2Op : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
 
     auto sp_indices = sp_indices_t->matrix<int64>();
-    auto sp_tokens = sp_tokens_t->vec<tstring>();
     auto sp_shape = sp_shape_t->vec<int64>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
@@ -299,18 +302,62 @@ class StringSplitV2Op : public OpKernel {
       for (size_t j = 0; j < num_indices[i]; ++j) {
         sp_indices(c, 0) = i;
         sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
         ++c;
       }
     }
+    OutputTokens(tokens, sp_tokens_t);
   }
 
+ protected:
+  // Stores "tokens" in the "values" output.
+  virtual void OutputTokens(const std::vector<StringPiece>& tokens,
+                            Tensor* values) = 0;
+
  private:
   int maxsplit_;
 };
 
+class StringSplitV2Op : public StringSplitV2OpBase {
+ public:
+  using StringSplitV2OpBase::StringSplitV2OpBase;
+
+ protected:
+  void OutputTokens(const std::vector<StringPiece>& tokens,
+                    Tensor* values) override {
+    auto sp_tokens = values->vec<tstring>();
+    for (size_t c = 0; c < tokens.size(); ++c) {
+      sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
+    }
+  }
+};
+
+// Hashes the tokens where they are in the input, instead of copying each of
+// them into a string of the output of StringSplitV2 first.
+class StringSplitToHashBucketFastOp : public StringSplitV2OpBase {
+ public:
+  explicit StringSplitToHashBucketFastOp(OpKernelConstruction* context)
+      : StringSplitV2OpBase(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("num_buckets", &num_buckets_));
+  }
+
+ protected:
+  void OutputTokens(const std::vector<StringPiece>& tokens,
+                    Tensor* values) override {
+    auto buckets = values->vec<int64>();
+    for (size_t c = 0; c < tokens.size(); ++c) {
+      // Same as StringToHashBucketFast.
+      buckets(c) = static_cast<int64>(Fingerprint64(tokens[c]) % num_buckets_);
+    }
+  }
+
+ private:
+  int64 num_buckets_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("StringSplit").Device(DEVICE_CPU), StringSplitOp);
 REGISTER_KERNEL_BUILDER(Name("StringSplitV2").Device(DEVICE_CPU),
                         StringSplitV2Op);
+REGISTER_KERNEL_BUILDER(Name("StringSplitToHashBucketFast").Device(DEVICE_CPU),
+                        StringSplitToHashBucketFastOp);
 
 }  // namespace tensorflow
@@ -97,6 +97,54 @@ class TopK : public OpKernel {
   bool sorted_;
 };
 
+namespace {
+
+// Rows with at least this many columns are split across the worker threads
+// when there are fewer rows than threads.
+constexpr int64 kParallelTopKMinCols = 1 << 16;
+
+// Pushes the columns [begin, end) of a row to `filter`, a TopN of capacity
+// `k` that orders the columns by decreasing value and then increasing index.
+//
+// Once `filter` is full, a column enters it only if its value is greater than
+// the value of the bottom column, since the columns are pushed in increasing
+// order.  Blocks of columns are compared with that threshold in a loop that
+// the compiler vectorizes, and most blocks are skipped without touching the
+// heap.
+template <typename T, typename Filter>
+void PushColumns(const T* input_data, int32 begin, int32 end, int k,
+                 Filter* filter) {
+  constexpr int32 kBlockSize = 16;
+  int32 c = begin;
+  for (; c < end && filter->size() < static_cast<size_t>(k); ++c) {
+    filter->push(c);
+  }
+  if (c == end) return;
+  T threshold = input_data[filter->peek_bottom()];
+  for (; c + kBlockSize <= end; c += kBlockSize) {
+    const T* block = input_data + c;
+    bool any_above = false;
+    for (int32 i = 0; i < kBlockSize; ++i) {
+      any_above |= block[i] > threshold;
+    }
+    if (!any_above) continue;
+    for (int32 i = 0; i < kBlockSize; ++i) {
+      if (block[i] > threshold) {
+        filter->push(c + i);
+        threshold = input_data[filter->peek_bottom()];
+      }
+    }
+  }
+  for (; c < end; ++c) {
+    if (input_data[c] > threshold) {
+      filter->push(c);
+      threshold = input_data[filter->peek_bottom()];
+    }
+  }
+}
+
+}  // namespace
+
 namespace functor {
 
 template <typename T>
@@ -181,10 +229,8 @@ struct TopKFunctor<CPUDevice, T> {
         } else {
           // Use the TopN heap object to sort.
           gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
-          filter.reserve(num_cols);
-          for (int32 c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
+          filter.reserve(std::min<int64>(num_cols, k + 1));
+          PushColumns(input_data, 0, num_cols, k, &filter);
 
           int32 i = 0;
           if (sorted) {
@@ -207,6 +253,60 @@ struct TopKFunctor<CPUDevice, T> {
       }  // for (int32 b = ...
     };
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // Splits large rows across the worker threads when there are too few rows
+    // to keep them busy.  Each shard computes the top k of its columns, and
+    // the top k of these candidates are those of the row, since the columns
+    // are totally ordered by value and then index.
+    const int64 num_col_shards =
+        std::min<int64>(worker_threads.num_threads,
+                        num_cols / std::max<int64>(4 * k, 1 << 14));
+    if (k < num_cols && num_cols >= kParallelTopKMinCols &&
+        num_rows < worker_threads.num_threads && num_col_shards > 1) {
+      for (int64 b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const int32 a, const int32 b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        std::vector<std::vector<int32>> candidates(num_col_shards);
+        auto shard_top_k = [&](int64 start_shard, int64 limit_shard) {
+          for (int64 s = start_shard; s < limit_shard; ++s) {
+            gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+            filter.reserve(k + 1);
+            PushColumns(input_data, num_cols * s / num_col_shards,
+                        num_cols * (s + 1) / num_col_shards, k, &filter);
+            std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+            candidates[s].swap(*top_k);
+          }
+        };
+        const int64 cost_per_shard =
+            (num_cols / num_col_shards) *
+            (Eigen::TensorOpCost::AddCost<T>() + sizeof(T));
+        Shard(worker_threads.num_threads, worker_threads.workers,
+              num_col_shards, cost_per_shard, shard_top_k);
+
+        std::vector<int32> merged;
+        merged.reserve(num_col_shards * k);
+        for (const auto& shard_candidates : candidates) {
+          merged.insert(merged.end(), shard_candidates.begin(),
+                        shard_candidates.end());
+        }
+        std::partial_sort(merged.begin(), merged.begin() + k, merged.end(),
+                          stable_comp);
+        std::copy(merged.begin(), merged.begin() + k, &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const int32 loc) { return input(b, loc); });
+      }
+      return Status::OK();
+    }
+
     // Guesstimate of cost; 4*N*log(K) where N == num_cols.
     // If K == N, assume the cost is N*log(K + 1).
     const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
@@ -221,7 +321,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
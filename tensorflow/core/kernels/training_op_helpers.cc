@@ -15,10 +15,32 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
 
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 
+bool UseUnifiedMemoryForVariable(OpKernelContext* ctx, int64 num_bytes) {
+  static const int64 min_bytes = [] {
+    int64 value = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_GPU_UNIFIED_MEMORY_MIN_VARIABLE_BYTES",
+                                    /*default_val=*/0, &value));
+    return value;
+  }();
+  return min_bytes > 0 && num_bytes >= min_bytes &&
+         ctx->device()->tensorflow_gpu_device_info() != nullptr;
+}
+
+AllocatorAttributes VariableAllocatorAttributes(OpKernelContext* ctx,
+                                                int64 num_bytes) {
+  AllocatorAttributes attr;
+  attr.set_gpu_compatible(true);
+  attr.set_nic_compatible(true);
+  attr.set_unified_memory(UseUnifiedMemoryForVariable(ctx, num_bytes));
+  return attr;
+}
+
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output) {
@@ -27,4 +49,12 @@ void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
   }
 }
 
+mutex* GetRowMutex(const void* base, int64 row) {
+  static constexpr int kNumRowMutexes = 1024;
+  static mutex* row_mutexes = new mutex[kNumRowMutexes];
+  const uint64 hash = Hash64Combine(reinterpret_cast<uintptr_t>(base),
+                                    static_cast<uint64>(row));
+  return &row_mutexes[hash % kNumRowMutexes];
+}
+
 }  // end namespace tensorflow
@@ -25,6 +25,18 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Returns the attributes for allocating the buffer of a resource variable
+// whose value has num_bytes bytes. On GPU, variables of at least
+// TF_GPU_UNIFIED_MEMORY_MIN_VARIABLE_BYTES bytes (unset or 0 disables this)
+// are placed in unified memory, so that e.g. embedding tables can be larger
+// than the device memory.
+AllocatorAttributes VariableAllocatorAttributes(OpKernelContext* ctx,
+                                                int64 num_bytes);
+
+// Returns true if VariableAllocatorAttributes() places a variable of
+// num_bytes bytes in unified memory.
+bool UseUnifiedMemoryForVariable(OpKernelContext* ctx, int64 num_bytes);
+
 // Must be called before performing a sparse operation on a variable. Ensures
 // that no concurrent dense operations can happen while holding the variable's
 // lock.
@@ -55,9 +67,8 @@ Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
       elements_out(i) = elements_in(i);
     }
   } else {
-    AllocatorAttributes attr;
-    attr.set_gpu_compatible(true);
-    attr.set_nic_compatible(true);
+    AllocatorAttributes attr =
+        VariableAllocatorAttributes(ctx, var->tensor()->TotalBytes());
     TF_RETURN_IF_ERROR(ctx->allocate_persistent(
         var->tensor()->dtype(), var->tensor()->shape(), &unused, &tmp, attr));
     functor::DenseUpdate<Device, T, ASSIGN> copy_functor;
@@ -152,30 +163,31 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
     return VariableInputLockHolder({}, {}, {});
   }
   std::vector<Var*> vars;
-  std::vector<mutex*> mutexes;
-  std::vector<int> acquire_order;
+  // The mutex of each input, with the input, sorted by address so that each
+  // distinct mutex is locked once and in a consistent order.
+  std::vector<std::pair<mutex*, int>> mutexes;
+  mutexes.reserve(input_ids.size());
   for (auto input : input_ids) {
     Var* var;
     mutex* mutex =
         GetTrainingVariableMutex<Device, T>(ctx, input, sparse, &var);
     if (var) vars.push_back(var);
-    // Only lock each mutex once if duplicates exist (n^2 but n is 2 or 3).
-    if (std::find(mutexes.begin(), mutexes.end(), mutex) == mutexes.end()) {
-      acquire_order.push_back(mutexes.size());
-      mutexes.push_back(mutex);
-    }
+    mutexes.emplace_back(mutex, input);
   }
-  std::sort(acquire_order.begin(), acquire_order.end(),
-            [&mutexes](int a, int b) { return mutexes[a] < mutexes[b]; });
+  std::sort(mutexes.begin(), mutexes.end());
+  mutexes.erase(std::unique(mutexes.begin(), mutexes.end(),
+                            [](const std::pair<mutex*, int>& a,
+                               const std::pair<mutex*, int>& b) {
+                              return a.first == b.first;
+                            }),
+                mutexes.end());
 
   auto locks = absl::make_unique<std::vector<mutex_lock>>();
   auto shared_locks = absl::make_unique<std::vector<tf_shared_lock>>();
-  locks->reserve(acquire_order.size());
+  locks->reserve(mutexes.size());
 
-  for (auto input : acquire_order) {
-    Var* var;
-    mutex* mu = GetTrainingVariableMutex<Device, T>(ctx, input, sparse, &var);
-    core::ScopedUnref scoped_unref(var);
+  for (const auto& mutex_and_input : mutexes) {
+    mutex* mu = mutex_and_input.first;
     if (mu != nullptr) {
       if (!sparse || do_lock) {
         locks->emplace_back(*mu);
@@ -191,6 +203,25 @@ VariableInputLockHolder MaybeLockVariableInputMutexesInOrder(
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output);
 
+// Returns the mutex that guards row "row" of the variable whose buffer starts
+// at "base", for sparse updates that hold only a shared lock on the variable.
+// The rows of all variables are striped over a fixed pool of mutexes, so
+// concurrent updates of disjoint rows seldom contend.
+mutex* GetRowMutex(const void* base, int64 row);
+
+// Runs "update" on row "row" of the variable whose buffer starts at "base",
+// holding the mutex of the row if "lock_row" is true.
+template <typename Update>
+void MaybeLockRowForUpdate(bool lock_row, const void* base, int64 row,
+                           const Update& update) {
+  if (lock_row) {
+    mutex_lock l(*GetRowMutex(base, row));
+    update();
+  } else {
+    update();
+  }
+}
+
 // This is for use with ResourceVariables to ensure *tensor has a
 // reference count of 1 before you update it.
 // REQUIRES: If you pass in variable->tensor(), *variable->mu() must be held.
@@ -214,9 +245,8 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
         elements_out(i) = elements_in(i);
       }
     } else {
-      AllocatorAttributes attr;
-      attr.set_gpu_compatible(true);
-      attr.set_nic_compatible(true);
+      AllocatorAttributes attr =
+          VariableAllocatorAttributes(ctx, tensor->TotalBytes());
       TF_RETURN_IF_ERROR(ctx->allocate_persistent(
           tensor->dtype(), tensor->shape(), &unused, &tmp, attr));
       functor::DenseUpdate<Device, T, ASSIGN> copy_functor;
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #ifdef TENSORFLOW_USE_SYCL
 #include "tensorflow/core/common_runtime/sycl/sycl_util.h"
@@ -1631,18 +1633,24 @@ class SparseApplyAdagradOp : public OpKernel {
   explicit SparseApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    if (ctx->HasAttr("use_row_locking")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("use_row_locking", &use_row_locking_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // In row-locking mode the variables are only locked shared, and every row
+    // update holds the mutex of its row instead.
+    const bool exclusive_lock = use_exclusive_lock_ && !use_row_locking_;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, exclusive_lock, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 0, use_exclusive_lock_, sparse, &var));
+                            ctx, 0, exclusive_lock, sparse, &var));
     Tensor accum;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 1, use_exclusive_lock_, sparse, &accum));
+                            ctx, 1, exclusive_lock, sparse, &accum));
     OP_REQUIRES(
         ctx, var.IsInitialized(),
         errors::FailedPrecondition(
@@ -1694,6 +1702,7 @@ class SparseApplyAdagradOp : public OpKernel {
       const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 2 +
                                       Eigen::TensorOpCost::MulCost<T>() * 2);
       const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
+      const void* var_base = var.tensor_data().data();
 
       if (inner_dim > 1) {
         const Tindex first_dim_size = var.dim_size(0);
@@ -1714,13 +1723,15 @@ class SparseApplyAdagradOp : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-            auto a = accum_flat.template chip<0>(index);
-            auto g = grad_flat.template chip<0>(i);
-            auto v = var_flat.template chip<0>(index);
-            if (update_slots_) {
-              a += g.square();
-            }
-            v -= g.constant(lr_scalar) * g * a.rsqrt();
+            MaybeLockRowForUpdate(use_row_locking_, var_base, index, [&] {
+              auto a = accum_flat.template chip<0>(index);
+              auto g = grad_flat.template chip<0>(i);
+              auto v = var_flat.template chip<0>(index);
+              if (update_slots_) {
+                a += g.square();
+              }
+              v -= g.constant(lr_scalar) * g * a.rsqrt();
+            });
           }
         };
 
@@ -1745,12 +1756,14 @@ class SparseApplyAdagradOp : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-            T& a = accum_flat(index);
-            const T& g = grad_flat(i);
-            if (update_slots_) {
-              a += g * g;
-            }
-            var_flat(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
+            MaybeLockRowForUpdate(use_row_locking_, var_base, index, [&] {
+              T& a = accum_flat(index);
+              const T& g = grad_flat(i);
+              if (update_slots_) {
+                a += g * g;
+              }
+              var_flat(index) -= lr_scalar * g / Eigen::numext::sqrt(a);
+            });
           }
         };
 
@@ -1764,6 +1777,7 @@ class SparseApplyAdagradOp : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool use_row_locking_ = false;
 };
 
 #define REGISTER_KERNELS(T, Tindices)                                \
@@ -1794,18 +1808,24 @@ class SparseApplyAdagradV2Op : public OpKernel {
   explicit SparseApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    if (ctx->HasAttr("use_row_locking")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("use_row_locking", &use_row_locking_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // In row-locking mode the variables are only locked shared, and every row
+    // update holds the mutex of its row instead.
+    const bool exclusive_lock = use_exclusive_lock_ && !use_row_locking_;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, exclusive_lock, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 0, use_exclusive_lock_, sparse, &var));
+                            ctx, 0, exclusive_lock, sparse, &var));
     Tensor accum;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 1, use_exclusive_lock_, sparse, &accum));
+                            ctx, 1, exclusive_lock, sparse, &accum));
     OP_REQUIRES(
         ctx, var.IsInitialized(),
         errors::FailedPrecondition(
@@ -1861,6 +1881,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
       const int cycles = inner_dim * (Eigen::TensorOpCost::AddCost<T>() * 2 +
                                       Eigen::TensorOpCost::MulCost<T>() * 2);
       const Eigen::TensorOpCost cost(in_bytes, out_bytes, cycles);
+      const void* var_base = var.tensor_data().data();
 
       if (inner_dim > 1) {
         const Tindex first_dim_size = var.dim_size(0);
@@ -1882,14 +1903,16 @@ class SparseApplyAdagradV2Op : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-            auto a = accum_flat.template chip<0>(index);
-            auto g = grad_flat.template chip<0>(i);
-            auto v = var_flat.template chip<0>(index);
-            if (update_slots_) {
-              a += g.square();
-            }
-            v -= g.constant(lr_scalar) * g /
-                 (a.sqrt() + a.constant(epsilon_scalar));
+            MaybeLockRowForUpdate(use_row_locking_, var_base, index, [&] {
+              auto a = accum_flat.template chip<0>(index);
+              auto g = grad_flat.template chip<0>(i);
+              auto v = var_flat.template chip<0>(index);
+              if (update_slots_) {
+                a += g.square();
+              }
+              v -= g.constant(lr_scalar) * g /
+                   (a.sqrt() + a.constant(epsilon_scalar));
+            });
           }
         };
 
@@ -1915,13 +1938,15 @@ class SparseApplyAdagradV2Op : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
-            T& a = accum_flat(index);
-            const T& g = grad_flat(i);
-            if (update_slots_) {
-              a += g * g;
-            }
-            var_flat(index) -=
-                lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon_scalar);
+            MaybeLockRowForUpdate(use_row_locking_, var_base, index, [&] {
+              T& a = accum_flat(index);
+              const T& g = grad_flat(i);
+              if (update_slots_) {
+                a += g * g;
+              }
+              var_flat(index) -=
+                  lr_scalar * g / (Eigen::numext::sqrt(a) + epsilon_scalar);
+            });
           }
         };
 
@@ -1935,6 +1960,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool use_row_locking_ = false;
 };
 
 #define REGISTER_KERNELS(T, Tindices)                                \
@@ -3707,6 +3733,239 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// Looks up the first "num_inputs" inputs of a grouped apply op, which are
+// lists of resource variables, locked by the caller.
+template <typename T>
+Status GetGroupedVariables(OpKernelContext* ctx, int num_inputs,
+                           bool use_exclusive_lock,
+                           std::vector<Tensor>* tensors) {
+  tensors->resize(num_inputs);
+  for (int i = 0; i < num_inputs; ++i) {
+    TF_RETURN_IF_ERROR(GetInputTensorFromVariable<CPUDevice, T>(
+        ctx, i, use_exclusive_lock, /*sparse=*/false, &(*tensors)[i]));
+    if (!(*tensors)[i].IsInitialized()) {
+      return errors::FailedPrecondition(
+          "Attempting to use uninitialized variables: ",
+          ctx->op_kernel().requested_input(i));
+    }
+  }
+  return Status::OK();
+}
+
+// Calls "fn(i, begin, end)" on the ranges [begin, end) of the elements of
+// variable "i" of a group, where variable "i" has "sizes[i]" elements.  The
+// elements of all the variables are sharded as one range, so that a group of
+// many small variables is updated in a single parallel pass.
+template <typename Fn>
+void ShardGroupedVariables(OpKernelContext* ctx,
+                           const std::vector<int64>& sizes,
+                           int64 cost_per_element, const Fn& fn) {
+  std::vector<int64> offsets(sizes.size() + 1, 0);
+  std::partial_sum(sizes.begin(), sizes.end(), offsets.begin() + 1);
+  auto work = [&](int64 begin, int64 end) {
+    int i = std::upper_bound(offsets.begin(), offsets.end(), begin) -
+            offsets.begin() - 1;
+    while (begin < end) {
+      const int64 limit = std::min(end, offsets[i + 1]);
+      if (limit > begin) fn(i, begin - offsets[i], limit - offsets[i]);
+      begin = limit;
+      ++i;
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, offsets.back(),
+        cost_per_element, work);
+}
+
+}  // namespace
+
+// Applies Adam to a group of N resource variables with shared
+// hyperparameters, as N ResourceApplyAdam ops would.
+template <typename T>
+class ResourceApplyAdamGroupOp : public OpKernel {
+ public:
+  explicit ResourceApplyAdamGroupOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> input_ids(3 * n);
+    std::iota(input_ids.begin(), input_ids.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false, input_ids);
+    // The variables, then the m and v slots.
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(
+        ctx, GetGroupedVariables<T>(ctx, 3 * n, use_exclusive_lock_, &vars));
+
+    static const char* const kScalarNames[] = {
+        "beta1_power", "beta2_power", "lr", "beta1", "beta2", "epsilon"};
+    T scalars[6];
+    for (int i = 0; i < 6; ++i) {
+      const Tensor& scalar = ctx->input(3 * n + i);
+      OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(scalar.shape()),
+                  errors::InvalidArgument(kScalarNames[i], " is not a scalar: ",
+                                          scalar.shape().DebugString()));
+      scalars[i] = scalar.scalar<T>()();
+    }
+    const T beta1_power = scalars[0];
+    const T beta2_power = scalars[1];
+    const T lr = scalars[2];
+    const T beta1 = scalars[3];
+    const T beta2 = scalars[4];
+    const T epsilon = scalars[5];
+
+    std::vector<int64> sizes(n);
+    for (int i = 0; i < n; ++i) {
+      const Tensor& var = vars[i];
+      const Tensor& grad = ctx->input(3 * n + 6 + i);
+      OP_REQUIRES(ctx,
+                  var.shape().IsSameSize(vars[n + i].shape()) &&
+                      var.shape().IsSameSize(vars[2 * n + i].shape()),
+                  errors::InvalidArgument(
+                      "var, m and v ", i, " do not have the same shape",
+                      var.shape().DebugString(), " ",
+                      vars[n + i].shape().DebugString(), " ",
+                      vars[2 * n + i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad ", i,
+                                  " do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      sizes[i] = var.NumElements();
+    }
+
+    const T alpha = lr * Eigen::numext::sqrt(T(1) - beta2_power) /
+                    (T(1) - beta1_power);
+    const bool use_nesterov = use_nesterov_;
+    auto update = [&](int i, int64 begin, int64 end) {
+      const int64 size = end - begin;
+      auto var = typename TTypes<T>::UnalignedTensor(
+          vars[i].flat<T>().data() + begin, size);
+      auto m = typename TTypes<T>::UnalignedTensor(
+          vars[n + i].flat<T>().data() + begin, size);
+      auto v = typename TTypes<T>::UnalignedTensor(
+          vars[2 * n + i].flat<T>().data() + begin, size);
+      auto g = typename TTypes<T>::UnalignedConstTensor(
+          ctx->input(3 * n + 6 + i).flat<T>().data() + begin, size);
+      m += (g - m) * (T(1) - beta1);
+      v += (g.square() - v) * (T(1) - beta2);
+      if (use_nesterov) {
+        var -= ((g * (T(1) - beta1) + beta1 * m) * alpha) /
+               (v.sqrt() + epsilon);
+      } else {
+        var -= (m * alpha) / (v.sqrt() + epsilon);
+      }
+    };
+    const int64 cost_per_element = 7 * sizeof(T) +
+                                   Eigen::TensorOpCost::AddCost<T>() * 10 +
+                                   Eigen::TensorOpCost::MulCost<T>() * 6 +
+                                   Eigen::TensorOpCost::DivCost<T>();
+    ShardGroupedVariables(ctx, sizes, cost_per_element, update);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+};
+
+// Applies Adagrad to a group of N resource variables with a shared learning
+// rate, as N ResourceApplyAdagrad ops would.
+template <typename T>
+class ResourceApplyAdagradGroupOp : public OpKernel {
+ public:
+  explicit ResourceApplyAdagradGroupOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const int n = num_vars_;
+    std::vector<int> input_ids(2 * n);
+    std::iota(input_ids.begin(), input_ids.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
+        ctx, use_exclusive_lock_, /*sparse=*/false, input_ids);
+    // The variables, then the accum slots.
+    std::vector<Tensor> vars;
+    OP_REQUIRES_OK(
+        ctx, GetGroupedVariables<T>(ctx, 2 * n, use_exclusive_lock_, &vars));
+
+    const Tensor& lr_tensor = ctx->input(2 * n);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr_tensor.shape()),
+                errors::InvalidArgument("lr is not a scalar: ",
+                                        lr_tensor.shape().DebugString()));
+    const T lr = lr_tensor.scalar<T>()();
+
+    std::vector<int64> sizes(n);
+    for (int i = 0; i < n; ++i) {
+      const Tensor& var = vars[i];
+      const Tensor& grad = ctx->input(2 * n + 1 + i);
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(vars[n + i].shape()),
+          errors::InvalidArgument("var and accum ", i,
+                                  " do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  vars[n + i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var.shape().IsSameSize(grad.shape()),
+          errors::InvalidArgument("var and grad ", i,
+                                  " do not have the same shape",
+                                  var.shape().DebugString(), " ",
+                                  grad.shape().DebugString()));
+      sizes[i] = var.NumElements();
+    }
+
+    const bool update_slots = update_slots_;
+    auto update = [&](int i, int64 begin, int64 end) {
+      const int64 size = end - begin;
+      auto var = typename TTypes<T>::UnalignedTensor(
+          vars[i].flat<T>().data() + begin, size);
+      auto accum = typename TTypes<T>::UnalignedTensor(
+          vars[n + i].flat<T>().data() + begin, size);
+      auto g = typename TTypes<T>::UnalignedConstTensor(
+          ctx->input(2 * n + 1 + i).flat<T>().data() + begin, size);
+      if (update_slots) {
+        accum += g.square();
+      }
+      var -= g * lr * accum.rsqrt();
+    };
+    const int64 cost_per_element = 4 * sizeof(T) +
+                                   Eigen::TensorOpCost::AddCost<T>() * 2 +
+                                   Eigen::TensorOpCost::MulCost<T>() * 3 +
+                                   Eigen::TensorOpCost::DivCost<T>();
+    ShardGroupedVariables(ctx, sizes, cost_per_element, update);
+  }
+
+ private:
+  int num_vars_;
+  bool use_exclusive_lock_;
+  bool update_slots_;
+};
+
+#define REGISTER_CPU_KERNELS(T)                                     \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamGroup")            \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T"),              \
+                          ResourceApplyAdamGroupOp<T>);             \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdagradGroup")         \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T"),              \
+                          ResourceApplyAdagradGroupOp<T>);
+
+TF_CALL_FLOAT_TYPES(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/bfloat16/bfloat16.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +73,180 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Integer inputs with at least this many elements are uniquified in parallel.
+constexpr int64 kParallelUniqueMinSize = 1 << 16;
+
+// Computes the unique elements of `input` in parallel, in the order of their
+// first occurrence like the serial implementation.
+//
+// The elements are radix-partitioned by the high bits of a multiplicative
+// hash, so that equal elements land in the same partition, and each partition
+// is uniquified with its own hash map.  The position of each unique element in
+// the output is the number of first occurrences before its own, which is a
+// prefix sum over the input.  If `counts` is not null, it gets the number of
+// occurrences of each unique element, which saves a pass over `idx`.
+template <typename T, typename TIndex>
+void ParallelUnique(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx, std::vector<T>* uniq,
+                    std::vector<TIndex>* counts) {
+  const int64 n = input.size();
+  int num_partitions = 2;
+  while (num_partitions < 2 * worker_threads.num_threads &&
+         num_partitions < 256) {
+    num_partitions *= 2;
+  }
+  int shift = 64;
+  for (int p = num_partitions; p > 1; p /= 2) --shift;
+  const auto partition_of = [shift](T value) -> int {
+    return (static_cast<uint64>(value) * 0x9E3779B97F4A7C15ULL) >> shift;
+  };
+  // The input is split into as many chunks as there are partitions.
+  const int num_chunks = num_partitions;
+  const auto chunk_begin = [n, num_chunks](int64 c) {
+    return n * c / num_chunks;
+  };
+  const auto run_in_parallel = [&worker_threads](
+                                   int64 total,
+                                   const std::function<void(int64, int64)>&
+                                       work) {
+    Shard(worker_threads.num_threads, worker_threads.workers, total,
+          kParallelUniqueMinSize, work);
+  };
+
+  // Scatters the indices of the elements of each partition to consecutive
+  // positions of `order`, in increasing order.
+  std::vector<int64> offsets(num_chunks * num_partitions, 0);
+  run_in_parallel(num_chunks, [&](int64 begin, int64 end) {
+    for (int64 c = begin; c < end; ++c) {
+      int64* chunk_offsets = &offsets[c * num_partitions];
+      for (int64 i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        ++chunk_offsets[partition_of(input(i))];
+      }
+    }
+  });
+  std::vector<int64> partition_begin(num_partitions + 1);
+  int64 offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_begin[p] = offset;
+    for (int c = 0; c < num_chunks; ++c) {
+      const int64 count = offsets[c * num_partitions + p];
+      offsets[c * num_partitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_begin[num_partitions] = n;
+  std::vector<int32> order(n);
+  run_in_parallel(num_chunks, [&](int64 begin, int64 end) {
+    for (int64 c = begin; c < end; ++c) {
+      int64* chunk_offsets = &offsets[c * num_partitions];
+      for (int64 i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        order[chunk_offsets[partition_of(input(i))]++] = i;
+      }
+    }
+  });
+
+  // Uniquifies each partition.  `position` is -1 for the elements that are
+  // not first occurrences.
+  std::vector<int32> local_idx(n);
+  std::vector<int32> position(n, -1);
+  std::vector<std::vector<int32>> first_occurrences(num_partitions);
+  std::vector<std::vector<TIndex>> local_counts(num_partitions);
+  run_in_parallel(num_partitions, [&](int64 begin, int64 end) {
+    for (int64 p = begin; p < end; ++p) {
+      absl::flat_hash_map<T, int32> local_uniq;
+      local_uniq.reserve(partition_begin[p + 1] - partition_begin[p]);
+      std::vector<int32>& firsts = first_occurrences[p];
+      for (int64 k = partition_begin[p]; k < partition_begin[p + 1]; ++k) {
+        const int32 i = order[k];
+        auto it = local_uniq.emplace(input(i), firsts.size());
+        local_idx[i] = it.first->second;
+        if (it.second) {
+          firsts.push_back(i);
+          position[i] = 0;
+          if (counts != nullptr) local_counts[p].push_back(1);
+        } else if (counts != nullptr) {
+          ++local_counts[p][it.first->second];
+        }
+      }
+    }
+  });
+
+  // Numbers the first occurrences in input order.
+  std::vector<int64> chunk_firsts(num_chunks + 1, 0);
+  run_in_parallel(num_chunks, [&](int64 begin, int64 end) {
+    for (int64 c = begin; c < end; ++c) {
+      int64 count = 0;
+      for (int64 i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        count += position[i] == 0;
+      }
+      chunk_firsts[c + 1] = count;
+    }
+  });
+  for (int c = 0; c < num_chunks; ++c) chunk_firsts[c + 1] += chunk_firsts[c];
+  run_in_parallel(num_chunks, [&](int64 begin, int64 end) {
+    for (int64 c = begin; c < end; ++c) {
+      int32 next = chunk_firsts[c];
+      for (int64 i = chunk_begin(c); i < chunk_begin(c + 1); ++i) {
+        if (position[i] == 0) position[i] = next++;
+      }
+    }
+  });
+
+  const int64 uniq_size = chunk_firsts[num_chunks];
+  uniq->resize(uniq_size);
+  if (counts != nullptr) counts->resize(uniq_size);
+  run_in_parallel(num_partitions, [&](int64 begin, int64 end) {
+    for (int64 p = begin; p < end; ++p) {
+      const std::vector<int32>& firsts = first_occurrences[p];
+      std::vector<int32> local_to_global(firsts.size());
+      for (size_t u = 0; u < firsts.size(); ++u) {
+        const int32 global = position[firsts[u]];
+        local_to_global[u] = global;
+        (*uniq)[global] = input(firsts[u]);
+        if (counts != nullptr) (*counts)[global] = local_counts[p][u];
+      }
+      for (int64 k = partition_begin[p]; k < partition_begin[p + 1]; ++k) {
+        const int32 i = order[k];
+        idx(i) = local_to_global[local_idx[i]];
+      }
+    }
+  });
+}
+
+// Whether the elements of type `T` can be uniquified by `ParallelUnique`.
+template <typename T>
+struct UseParallelUnique {
+  static constexpr bool value =
+      std::is_integral<T>::value && !std::is_same<T, bool>::value;
+};
+
+// Runs `ParallelUnique` and returns true if it supports `T` and `input` is
+// large enough to be worth it, otherwise returns false.
+template <typename T, typename TIndex>
+typename std::enable_if<UseParallelUnique<T>::value, bool>::type
+MaybeParallelUnique(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx, std::vector<T>* uniq,
+                    std::vector<TIndex>* counts) {
+  if (input.size() < kParallelUniqueMinSize ||
+      input.size() > std::numeric_limits<int32>::max() ||
+      worker_threads.num_threads <= 1) {
+    return false;
+  }
+  ParallelUnique<T, TIndex>(worker_threads, input, idx, uniq, counts);
+  return true;
+}
+
+template <typename T, typename TIndex>
+typename std::enable_if<!UseParallelUnique<T>::value, bool>::type
+MaybeParallelUnique(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    typename TTypes<T>::ConstFlat input,
+                    typename TTypes<TIndex>::Vec idx, std::vector<T>* uniq,
+                    std::vector<TIndex>* counts) {
+  return false;
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -142,8 +321,26 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    // The counts of UniqueWithCounts are computed along with the indices.
+    std::vector<TIndex> counts;
+    std::vector<TIndex>* counts_ptr = num_outputs() > 2 ? &counts : nullptr;
+    const auto* worker_threads =
+        context->device()->tensorflow_cpu_worker_threads();
+
     int64 uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    std::vector<T> parallel_uniq;
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        MaybeParallelUnique<T, TIndex>(*worker_threads, input.flat<T>(),
+                                       idx_vec, &parallel_uniq, counts_ptr)) {
+      const std::vector<T>& uniq = parallel_uniq;
+      uniq_size = static_cast<int64>(uniq.size());
+      TensorShape output_shape(input.shape());
+      output_shape.set_dim(axis, uniq_size);
+      Tensor* output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(0, output_shape, &output));
+      std::copy(uniq.begin(), uniq.end(), output->flat<T>().data());
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -157,6 +354,9 @@ class UniqueOp : public OpKernel {
         idx_vec(i) = it.first->second;
         if (it.second) {
           ++j;
+          if (counts_ptr != nullptr) counts.push_back(1);
+        } else if (counts_ptr != nullptr) {
+          ++counts[it.first->second];
         }
       }
 
@@ -208,6 +408,9 @@ class UniqueOp : public OpKernel {
         idx_vec(i) = it.first->second;
         if (it.second) {
           ++j;
+          if (counts_ptr != nullptr) counts.push_back(1);
+        } else if (counts_ptr != nullptr) {
+          ++counts[it.first->second];
         }
       }
 
@@ -229,12 +432,8 @@ class UniqueOp : public OpKernel {
       Tensor* output = nullptr;
       OP_REQUIRES_OK(context, context->allocate_output(
                                   2, TensorShape({uniq_size}), &output));
-      auto count_output_vec = output->template vec<TIndex>();
-      count_output_vec.setZero();
-      const int N = idx_vec.size();
-      for (int64 i = 0; i < N; ++i) {
-        count_output_vec(idx_vec(i))++;
-      }
+      std::copy(counts.begin(), counts.end(),
+                output->template vec<TIndex>().data());
     }
   }
 };
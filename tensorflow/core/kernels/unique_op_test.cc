@@ -15,11 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -64,6 +69,61 @@ TensorProto GetRandomInt32TensorProtoWithRepeat(int dim, int repeat,
   return tensor_proto;
 }
 
+class UniqueWithCountsOpTest : public OpsTestBase {
+ protected:
+  // Runs UniqueWithCounts on `input` and checks its outputs against a serial
+  // reference: the unique elements in order of first occurrence.
+  void RunAndCheck(const std::vector<int64>& input) {
+    TF_ASSERT_OK(NodeDefBuilder("op", "UniqueWithCounts")
+                     .Input(FakeInput(DT_INT64))
+                     .Attr("out_idx", DT_INT32)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<int64>(TensorShape({static_cast<int64>(input.size())}),
+                             input);
+    TF_ASSERT_OK(RunOpKernel());
+
+    std::unordered_map<int64, int32> index;
+    std::vector<int64> expected_uniq;
+    std::vector<int32> expected_idx;
+    std::vector<int32> expected_counts;
+    for (const int64 value : input) {
+      auto it = index.emplace(value, expected_uniq.size());
+      if (it.second) {
+        expected_uniq.push_back(value);
+        expected_counts.push_back(0);
+      }
+      expected_idx.push_back(it.first->second);
+      ++expected_counts[it.first->second];
+    }
+    test::ExpectTensorEqual<int64>(test::AsTensor<int64>(expected_uniq),
+                                   *GetOutput(0));
+    test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_idx),
+                                   *GetOutput(1));
+    test::ExpectTensorEqual<int32>(test::AsTensor<int32>(expected_counts),
+                                   *GetOutput(2));
+  }
+};
+
+TEST_F(UniqueWithCountsOpTest, Small) {
+  RunAndCheck({7, -1, 7, 3, -1, 7, 0});
+}
+
+// Large enough inputs are uniquified in parallel.
+TEST_F(UniqueWithCountsOpTest, LargeFewUnique) {
+  std::vector<int64> input(1 << 18);
+  for (int64& value : input) value = std::rand() % 1000 - 500;
+  RunAndCheck(input);
+}
+
+TEST_F(UniqueWithCountsOpTest, LargeManyUnique) {
+  std::vector<int64> input(1 << 18);
+  for (int64& value : input) {
+    value = (static_cast<int64>(std::rand()) << 20) ^ (std::rand() % 50000);
+  }
+  RunAndCheck(input);
+}
+
 static void BM_Unique_INT32(int iters, int dim, int max_int) {
   testing::StopTiming();
   Graph* g = new Graph(OpRegistry::Global());
@@ -103,6 +103,28 @@ void RunWithFixedBlockSize(int64 block_size, int64 total, ThreadPool* threads) {
 }
 
 // Adapted from work_sharder_test.cc
+TEST(ThreadPool, ScheduleHighPriority) {
+  std::vector<int> order;
+  {
+    ThreadPool pool(Env::Default(), "test", 1);
+    // Keeps the only thread busy until all the functions are queued.
+    absl::BlockingCounter blocker(1);
+    pool.Schedule([&blocker]() { blocker.Wait(); });
+    for (int i = 0; i < 5; i++) {
+      pool.Schedule([&order, i]() { order.push_back(i); });
+    }
+    pool.ScheduleHighPriority([&order]() { order.push_back(100); });
+    pool.ScheduleHighPriority([&order]() { order.push_back(101); });
+    blocker.DecrementCount();
+  }
+  ASSERT_EQ(order.size(), 7);
+  EXPECT_EQ(order[0], 100);
+  EXPECT_EQ(order[1], 101);
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(order[i + 2], i);
+  }
+}
+
 TEST(ThreadPoolTest, ParallelForFixedBlockSizeScheduling) {
   ThreadPool threads(Env::Default(), "test", 16);
   for (auto block_size : {1, 7, 10, 64, 100, 256, 1000, 9999}) {
@@ -20,7 +20,9 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -292,6 +294,35 @@ TEST(FlatMap, AlternatingInsertRemove) {
   }
 }
 
+// Hashes many keys to the same bucket, so that lookups have to probe over
+// several full buckets and deletion markers.
+struct HashCollide {
+  size_t operator()(int64 x) const { return (x % 5) << 8; }
+};
+
+TEST(FlatMap, CollidingInsertRemove) {
+  FlatMap<int64, int64, HashCollide> map;
+  std::unordered_map<int64, int64> expected;
+  for (int64 i = 0; i < 2000; i++) {
+    const int64 k = (i * 37) % 101;
+    if (i % 3 == 0) {
+      EXPECT_EQ(map.erase(k), expected.erase(k));
+    } else {
+      map[k] = i;
+      expected[k] = i;
+    }
+    ASSERT_EQ(map.size(), expected.size());
+  }
+  for (int64 k = 0; k < 101; k++) {
+    auto iter = map.find(k);
+    auto expected_iter = expected.find(k);
+    ASSERT_EQ(iter == map.end(), expected_iter == expected.end());
+    if (iter != map.end()) {
+      EXPECT_EQ(iter->second, expected_iter->second);
+    }
+  }
+}
+
 TEST(FlatMap, ClearNoResize) {
   NumMap map;
   Fill(&map, 0, 100);
@@ -702,6 +733,127 @@ TEST(FlatMap, UniqueMapIter) {
   EXPECT_EQ(val_sum, key_sum + (kCount * kValueDelta));
 }
 
+// Random keys for the benchmarks below.
+std::vector<int64> BenchmarkKeys(int n) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = rnd.Rand64();
+  }
+  return keys;
+}
+
+template <typename Map>
+void BM_Insert(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<int64> keys = BenchmarkKeys(n);
+  testing::StartTiming();
+  for (int i = 0; i < iters; i++) {
+    Map map;
+    for (int64 k : keys) {
+      map[k] = k;
+    }
+    testing::DoNotOptimize(map);
+  }
+  testing::ItemsProcessed(static_cast<int64>(iters) * n);
+}
+
+template <typename Map>
+void BM_FindHit(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<int64> keys = BenchmarkKeys(n);
+  Map map;
+  for (int64 k : keys) {
+    map[k] = k;
+  }
+  testing::StartTiming();
+  int64 sum = 0;
+  for (int i = 0, j = 0; i < iters; i++, j = (j + 1 == n) ? 0 : j + 1) {
+    sum += map.find(keys[j])->second;
+  }
+  testing::DoNotOptimize(sum);
+  testing::ItemsProcessed(iters);
+}
+
+template <typename Map>
+void BM_FindMiss(int iters, int n) {
+  testing::StopTiming();
+  // Only the first n keys are inserted, the others are looked up.
+  const std::vector<int64> keys = BenchmarkKeys(2 * n);
+  Map map;
+  for (int i = 0; i < n; i++) {
+    map[keys[i]] = keys[i];
+  }
+  testing::StartTiming();
+  int64 sum = 0;
+  for (int i = 0, j = 0; i < iters; i++, j = (j + 1 == n) ? 0 : j + 1) {
+    sum += map.count(keys[n + j]);
+  }
+  testing::DoNotOptimize(sum);
+  testing::ItemsProcessed(iters);
+}
+
+template <typename Map>
+void BM_EraseInsert(int iters, int n) {
+  testing::StopTiming();
+  const std::vector<int64> keys = BenchmarkKeys(n);
+  Map map;
+  for (int64 k : keys) {
+    map[k] = k;
+  }
+  testing::StartTiming();
+  for (int i = 0, j = 0; i < iters; i++, j = (j + 1 == n) ? 0 : j + 1) {
+    const int64 k = keys[j];
+    map.erase(k);
+    map[k] = k;
+  }
+  testing::DoNotOptimize(map);
+  testing::ItemsProcessed(iters);
+}
+
+// The sizes fill the tables to about three quarters of their capacity, where
+// probe sequences are longest.  std::unordered_map is benchmarked alongside
+// FlatMap as a reference point.
+typedef FlatMap<int64, int64> BenchFlatMap;
+typedef std::unordered_map<int64, int64> BenchStdMap;
+
+static void BM_FlatMapInsert(int iters, int n) {
+  BM_Insert<BenchFlatMap>(iters, n);
+}
+BENCHMARK(BM_FlatMapInsert)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+static void BM_StdMapInsert(int iters, int n) {
+  BM_Insert<BenchStdMap>(iters, n);
+}
+BENCHMARK(BM_StdMapInsert)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+
+static void BM_FlatMapFindHit(int iters, int n) {
+  BM_FindHit<BenchFlatMap>(iters, n);
+}
+BENCHMARK(BM_FlatMapFindHit)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+static void BM_StdMapFindHit(int iters, int n) {
+  BM_FindHit<BenchStdMap>(iters, n);
+}
+BENCHMARK(BM_StdMapFindHit)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+
+static void BM_FlatMapFindMiss(int iters, int n) {
+  BM_FindMiss<BenchFlatMap>(iters, n);
+}
+BENCHMARK(BM_FlatMapFindMiss)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+static void BM_StdMapFindMiss(int iters, int n) {
+  BM_FindMiss<BenchStdMap>(iters, n);
+}
+BENCHMARK(BM_StdMapFindMiss)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+
+static void BM_FlatMapEraseInsert(int iters, int n) {
+  BM_EraseInsert<BenchFlatMap>(iters, n);
+}
+BENCHMARK(BM_FlatMapEraseInsert)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+static void BM_StdMapEraseInsert(int iters, int n) {
+  BM_EraseInsert<BenchStdMap>(iters, n);
+}
+BENCHMARK(BM_StdMapEraseInsert)->Arg(12)->Arg(100)->Arg(780)->Arg(6000)->Arg(50000);
+
 }  // namespace
 }  // namespace gtl
 }  // namespace tensorflow
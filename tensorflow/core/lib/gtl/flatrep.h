@@ -21,10 +21,82 @@ limitations under the License.
 #include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/types.h"
 
+#if defined(__SSE2__)
+#define TF_FLATREP_USE_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+#define TF_FLATREP_USE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace tensorflow {
 namespace gtl {
 namespace internal {
 
+// Returns a bitmask with bit i set iff marker[i] == m, for the 16 markers
+// starting at marker.  All 16 are compared at once when SSE2 or NEON is
+// available.
+inline uint32 MatchMarkers16(const uint8* marker, uint8 m) {
+#if defined(TF_FLATREP_USE_SSE2)
+  const __m128i ctrl =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(marker));
+  return static_cast<uint32>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(m))));
+#elif defined(TF_FLATREP_USE_NEON)
+  // NEON has no movemask: weight each matching lane by its bit and add the
+  // lanes of each half.
+  static const uint8 kLaneBits[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t bits = vandq_u8(vceqq_u8(vld1q_u8(marker), vdupq_n_u8(m)),
+                                   vld1q_u8(kLaneBits));
+  return static_cast<uint32>(vaddv_u8(vget_low_u8(bits))) |
+         (static_cast<uint32>(vaddv_u8(vget_high_u8(bits))) << 8);
+#else
+  uint32 result = 0;
+  for (uint32 i = 0; i < 16; i++) {
+    result |= static_cast<uint32>(marker[i] == m) << i;
+  }
+  return result;
+#endif
+}
+
+// Sets marker[i] to m.  The 16 markers are rewritten together where SSE2 or
+// NEON is available: a following MatchMarkers16 on the same markers can then
+// be served by store forwarding, which a single byte store defeats.
+inline void SetMarker16(uint8* marker, uint32 i, uint8 m) {
+#if defined(TF_FLATREP_USE_SSE2)
+  __m128i* p = reinterpret_cast<__m128i*>(marker);
+  const __m128i select = _mm_cmpeq_epi8(
+      _mm_set1_epi8(static_cast<char>(i)),
+      _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+  const __m128i ctrl = _mm_loadu_si128(p);
+  _mm_storeu_si128(p, _mm_or_si128(_mm_andnot_si128(select, ctrl),
+                                   _mm_and_si128(select, _mm_set1_epi8(m))));
+#elif defined(TF_FLATREP_USE_NEON)
+  static const uint8 kLanes[16] = {0, 1, 2,  3,  4,  5,  6,  7,
+                                   8, 9, 10, 11, 12, 13, 14, 15};
+  const uint8x16_t select =
+      vceqq_u8(vdupq_n_u8(static_cast<uint8>(i)), vld1q_u8(kLanes));
+  vst1q_u8(marker, vbslq_u8(select, vdupq_n_u8(m), vld1q_u8(marker)));
+#else
+  marker[i] = m;
+#endif
+}
+
+// Returns the index of the lowest set bit of the non-zero mask.
+inline uint32 LowestBit(uint32 mask) {
+#if defined(__GNUC__)
+  return __builtin_ctz(mask);
+#else
+  uint32 i = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+
 // Internal representation for FlatMap and FlatSet.
 //
 // The representation is an open-addressed hash table.  Conceptually,
@@ -39,14 +111,21 @@ namespace internal {
 //      These hash bits can be used to avoid potentially expensive
 //      key comparisons.
 //
+// Probing is done a bucket at a time: all kWidth markers of a bucket are
+// compared against the marker of the key being looked up in one step (see
+// MatchMarkers16), and only the matching entries have their keys compared.
+// A lookup stops at the first bucket on its probe sequence that has an empty
+// entry.
+//
 // FlatMap passes in a bucket that contains keys and values, FlatSet
 // passes in a bucket that does not contain values.
 template <typename Key, typename Bucket, class Hash, class Eq>
 class FlatRep {
  public:
   // kWidth is the number of entries stored in a bucket.
-  static constexpr uint32 kBase = 3;
+  static constexpr uint32 kBase = 4;
   static constexpr uint32 kWidth = (1 << kBase);
+  static_assert(kWidth == 16, "MatchMarkers16 compares 16 markers");
 
   FlatRep(size_t N, const Hash& hf, const Eq& eq) : hash_(hf), equal_(eq) {
     Init(N);
@@ -136,22 +215,23 @@ class FlatRep {
 
   // Hash value is partitioned as follows:
   // 1. Bottom 8 bits are stored in bucket to help speed up comparisons.
-  // 2. Next 3 bits give index inside bucket.
-  // 3. Remaining bits give bucket number.
+  // 2. Remaining bits give the first bucket to probe.
 
   // Find bucket/index for key k.
   SearchResult Find(const Key& k) const {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t index = (h >> 8) & bucket_mask();  // Holds bucket num
+    uint32 num_probes = 1;                    // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (x == kEmpty) {
+      Bucket* b = &array_[index];
+      for (uint32 m = Match(b, marker); m != 0; m &= m - 1) {
+        const uint32 bi = LowestBit(m);
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (Match(b, kEmpty) != 0) {
         return {false, nullptr, 0};
       }
       index = NextIndex(index, num_probes);
@@ -168,30 +248,39 @@ class FlatRep {
   SearchResult FindOrInsert(KeyType&& k) {
     size_t h = hash_(k);
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
-    Bucket* del = nullptr;            // First encountered deletion for kInsert
+    size_t index = (h >> 8) & bucket_mask();  // Holds bucket num
+    uint32 num_probes = 1;                    // Needed for quadratic probing
+    Bucket* del = nullptr;                    // First encountered deletion
     uint32 di = 0;
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == marker && equal_(b->key(bi), k)) {
-        return {true, b, bi};
-      } else if (!del && x == kDeleted) {
-        // Remember deleted index to use for insertion.
-        del = b;
-        di = bi;
-      } else if (x == kEmpty) {
+      Bucket* b = &array_[index];
+      for (uint32 m = Match(b, marker); m != 0; m &= m - 1) {
+        const uint32 bi = LowestBit(m);
+        if (equal_(b->key(bi), k)) {
+          return {true, b, bi};
+        }
+      }
+      if (!del && deleted_ > 0) {
+        const uint32 deleted = Match(b, kDeleted);
+        if (deleted != 0) {
+          // Remember deleted index to use for insertion.
+          del = b;
+          di = LowestBit(deleted);
+        }
+      }
+      const uint32 empty = Match(b, kEmpty);
+      if (empty != 0) {
+        uint32 bi;
         if (del) {
           // Store in the first deleted slot we encountered
           b = del;
           bi = di;
           deleted_--;  // not_empty_ does not change
         } else {
+          bi = LowestBit(empty);
           not_empty_++;
         }
-        b->marker[bi] = marker;
+        SetMarker16(b->marker, bi, marker);
         new (&b->key(bi)) Key(std::forward<KeyType>(k));
         return {false, b, bi};
       }
@@ -202,18 +291,24 @@ class FlatRep {
 
   void Erase(Bucket* b, uint32 i) {
     b->Destroy(i);
-    b->marker[i] = kDeleted;
-    deleted_++;
+    if (Match(b, kEmpty) != 0) {
+      // No lookup probes past a bucket with an empty entry, so this entry
+      // can become empty again instead of leaving a deletion marker.
+      SetMarker16(b->marker, i, kEmpty);
+      not_empty_--;
+    } else {
+      SetMarker16(b->marker, i, kDeleted);
+      deleted_++;
+    }
     grow_ = 0;  // Consider shrinking on next insert
   }
 
   void Prefetch(const Key& k) const {
     size_t h = hash_(k);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 bi = index & (kWidth - 1);
-    Bucket* b = &array_[index >> kBase];
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[bi]);
-    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[bi]);
+    size_t index = (h >> 8) & bucket_mask();  // Holds bucket num
+    Bucket* b = &array_[index];
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->marker[0]);
+    port::prefetch<port::PREFETCH_HINT_T0>(&b->storage.key[0]);
   }
 
   inline void MaybeResize() {
@@ -257,6 +352,13 @@ class FlatRep {
   // store in Bucket::marker[].
   static uint32 Marker(uint32 hb) { return hb + (hb < 2 ? 2 : 0); }
 
+  // Returns the entries of b whose marker is m, as a bitmask.
+  static uint32 Match(const Bucket* b, uint32 m) {
+    return MatchMarkers16(b->marker, static_cast<uint8>(m));
+  }
+
+  size_t bucket_mask() const { return mask_ >> kBase; }
+
   void Init(size_t N) {
     // Make enough room for N elements.
     size_t lg = 0;  // Smallest table is just one bucket.
@@ -320,14 +422,14 @@ class FlatRep {
   void FreshInsert(Bucket* src, uint32 src_index, Copier copier) {
     size_t h = hash_(src->key(src_index));
     const uint32 marker = Marker(h & 0xff);
-    size_t index = (h >> 8) & mask_;  // Holds bucket num and index-in-bucket
-    uint32 num_probes = 1;            // Needed for quadratic probing
+    size_t index = (h >> 8) & bucket_mask();  // Holds bucket num
+    uint32 num_probes = 1;                    // Needed for quadratic probing
     while (true) {
-      uint32 bi = index & (kWidth - 1);
-      Bucket* b = &array_[index >> kBase];
-      const uint32 x = b->marker[bi];
-      if (x == 0) {
-        b->marker[bi] = marker;
+      Bucket* b = &array_[index];
+      const uint32 empty = Match(b, kEmpty);
+      if (empty != 0) {
+        const uint32 bi = LowestBit(empty);
+        SetMarker16(b->marker, bi, marker);
         not_empty_++;
         copier(b, bi, src, src_index);
         return;
@@ -338,8 +440,8 @@ class FlatRep {
   }
 
   inline size_t NextIndex(size_t i, uint32 num_probes) const {
-    // Quadratic probing.
-    return (i + num_probes) & mask_;
+    // Quadratic probing over buckets.
+    return (i + num_probes) & bucket_mask();
   }
 };
 
@@ -0,0 +1,108 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/bloom_filter.h"
+
+#include <algorithm>
+
+#include "absl/base/attributes.h"
+#include "tensorflow/core/lib/core/coding.h"
+
+namespace tensorflow {
+namespace table {
+
+const char kBloomFilterMetaKey[] = "filter.tensorflow.BuiltinBloomFilter";
+
+uint32 BloomHash(const StringPiece& key) {
+  // Similar to murmur hash
+  const uint32 m = 0xc6a4a793;
+  const uint32 r = 24;
+  const char* data = key.data();
+  const char* limit = data + key.size();
+  uint32 h = 0xbc9f1d34 ^ (key.size() * m);
+
+  // Pick up four bytes at a time
+  while (data + 4 <= limit) {
+    uint32 w = core::DecodeFixed32(data);
+    data += 4;
+    h += w;
+    h *= m;
+    h ^= (h >> 16);
+  }
+
+  // Pick up remaining bytes
+  switch (limit - data) {
+    case 3:
+      h += static_cast<uint8>(data[2]) << 16;
+      ABSL_FALLTHROUGH_INTENDED;
+    case 2:
+      h += static_cast<uint8>(data[1]) << 8;
+      ABSL_FALLTHROUGH_INTENDED;
+    case 1:
+      h += static_cast<uint8>(data[0]);
+      h *= m;
+      h ^= (h >> r);
+      break;
+  }
+  return h;
+}
+
+// The filter holds the bits followed by one byte with the number of probes.
+// Each probe after the first adds a rotation of the hash to it, which
+// simulates independent hash functions (Kirsch and Mitzenmacher, 2006).
+void BuildBloomFilter(const std::vector<uint32>& hashes, int bits_per_key,
+                      string* dst) {
+  // 0.69 =~ ln(2) minimizes the false positive rate.
+  const size_t num_probes = std::min(
+      30, std::max(1, static_cast<int>(bits_per_key * 0.69)));
+  // Small filters have a high false positive rate, so use at least 64 bits.
+  const size_t bytes =
+      (std::max<size_t>(hashes.size() * bits_per_key, 64) + 7) / 8;
+  const size_t bits = bytes * 8;
+
+  const size_t init_size = dst->size();
+  dst->resize(init_size + bytes, 0);
+  dst->push_back(static_cast<char>(num_probes));
+  char* array = &(*dst)[init_size];
+  for (uint32 h : hashes) {
+    const uint32 delta = (h >> 17) | (h << 15);
+    for (size_t j = 0; j < num_probes; ++j) {
+      const uint32 bitpos = h % bits;
+      array[bitpos / 8] |= (1 << (bitpos % 8));
+      h += delta;
+    }
+  }
+}
+
+bool BloomFilterMayMatch(uint32 hash, const StringPiece& filter) {
+  if (filter.size() < 2) return true;
+  const char* array = filter.data();
+  const size_t bits = (filter.size() - 1) * 8;
+  const size_t num_probes = static_cast<uint8>(filter[filter.size() - 1]);
+  // Reserved for other encodings.
+  if (num_probes > 30) return true;
+
+  uint32 h = hash;
+  const uint32 delta = (h >> 17) | (h << 15);
+  for (size_t j = 0; j < num_probes; ++j) {
+    const uint32 bitpos = h % bits;
+    if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) return false;
+    h += delta;
+  }
+  return true;
+}
+
+}  // namespace table
+}  // namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+#define TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace table {
+
+// The key in the metaindex block of the handle of the bloom filter over all
+// the keys of a table.
+extern const char kBloomFilterMetaKey[];
+
+// Returns the hash of "key" that bloom filters are built from.  The hash is
+// part of the persistent format on disk and must not change.
+uint32 BloomHash(const StringPiece& key);
+
+// Appends to "*dst" a bloom filter over the keys with "hashes" that uses
+// "bits_per_key" bits per key.
+void BuildBloomFilter(const std::vector<uint32>& hashes, int bits_per_key,
+                      string* dst);
+
+// Returns false if the key with "hash" is definitely not one of the keys
+// "filter" was built from.
+bool BloomFilterMayMatch(uint32 hash, const StringPiece& filter);
+
+}  // namespace table
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_LIB_IO_BLOOM_FILTER_H_
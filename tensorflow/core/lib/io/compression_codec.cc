@@ -0,0 +1,59 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/compression_codec.h"
+
+#include <unordered_map>
+
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+
+mutex* RegistryMutex() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+
+std::unordered_map<string, std::unique_ptr<CompressionCodec>>* Registry() {
+  static auto* registry =
+      new std::unordered_map<string, std::unique_ptr<CompressionCodec>>;
+  return registry;
+}
+
+}  // namespace
+
+void CompressionCodecRegistry::Register(
+    const string& name, std::unique_ptr<CompressionCodec> codec) {
+  CHECK(name != compression::kNone && name != compression::kGzip &&
+        name != compression::kSnappy && name != compression::kZlib)
+      << "Compression codec " << name << " is built in.";
+  mutex_lock l(*RegistryMutex());
+  CHECK(Registry()->emplace(name, std::move(codec)).second)
+      << "Compression codec " << name << " is already registered.";
+}
+
+const CompressionCodec* CompressionCodecRegistry::Lookup(const string& name) {
+  mutex_lock l(*RegistryMutex());
+  auto it = Registry()->find(name);
+  return it == Registry()->end() ? nullptr : it->second.get();
+}
+
+}  // namespace io
+}  // namespace tensorflow
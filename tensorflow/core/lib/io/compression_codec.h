@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_COMPRESSION_CODEC_H_
+#define TENSORFLOW_CORE_LIB_IO_COMPRESSION_CODEC_H_
+
+#include <memory>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class WritableFile;
+
+namespace io {
+
+// A compression format, such as Zstd or LZ4, that is linked into the binary
+// and registered with REGISTER_COMPRESSION_CODEC rather than built into the
+// readers and writers of records.
+//
+// The registered name of a codec is a compression type, like "ZLIB", "GZIP"
+// and "SNAPPY": RecordReaderOptions::CreateRecordReaderOptions(),
+// RecordWriterOptions::CreateRecordWriterOptions() and the custom snapshot
+// format resolve it to the codec.
+class CompressionCodec {
+ public:
+  virtual ~CompressionCodec() = default;
+
+  // Creates a file that compresses the data appended to it into `dest`.
+  // `*result` does not own `dest`: closing `*result` writes the rest of the
+  // compressed data to `dest`, but does not close `dest`.
+  virtual Status NewCompressingFile(
+      WritableFile* dest, std::unique_ptr<WritableFile>* result) const = 0;
+
+  // Creates a stream of the data decompressed from `input`.
+  virtual Status NewDecompressingStream(
+      std::unique_ptr<InputStreamInterface> input,
+      std::unique_ptr<InputStreamInterface>* result) const = 0;
+};
+
+// The codecs registered so far, by name. Thread-safe.
+class CompressionCodecRegistry {
+ public:
+  // Registers `codec` as `name`, which must not already be registered or be
+  // one of the built-in compression types.
+  static void Register(const string& name,
+                       std::unique_ptr<CompressionCodec> codec);
+
+  // Returns the codec registered as `name`, or null if there is none. The
+  // codec lives as long as the process.
+  static const CompressionCodec* Lookup(const string& name);
+};
+
+namespace compression_codec_registration {
+
+class CompressionCodecRegistration {
+ public:
+  CompressionCodecRegistration(const string& name, CompressionCodec* codec) {
+    CompressionCodecRegistry::Register(
+        name, std::unique_ptr<CompressionCodec>(codec));
+  }
+};
+
+}  // namespace compression_codec_registration
+
+// Registers an instance of `codec_class` as the compression type `name`, e.g.
+//   REGISTER_COMPRESSION_CODEC("ZSTD", ZstdCodec);
+#define REGISTER_COMPRESSION_CODEC(name, codec_class) \
+  REGISTER_COMPRESSION_CODEC_UNIQ_HELPER(__COUNTER__, name, codec_class)
+#define REGISTER_COMPRESSION_CODEC_UNIQ_HELPER(ctr, name, codec_class) \
+  REGISTER_COMPRESSION_CODEC_UNIQ(ctr, name, codec_class)
+#define REGISTER_COMPRESSION_CODEC_UNIQ(ctr, name, codec_class)        \
+  static ::tensorflow::io::compression_codec_registration::            \
+      CompressionCodecRegistration compression_codec_registration_##ctr \
+          TF_ATTRIBUTE_UNUSED(name, new codec_class)
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_COMPRESSION_CODEC_H_
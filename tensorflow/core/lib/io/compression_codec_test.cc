@@ -0,0 +1,143 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/compression_codec.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+constexpr char kMask = 0x5a;
+
+std::string Mask(StringPiece data) {
+  std::string masked(data);
+  for (char& c : masked) c ^= kMask;
+  return masked;
+}
+
+class MaskingFile : public WritableFile {
+ public:
+  explicit MaskingFile(WritableFile* dest) : dest_(dest) {}
+
+  Status Append(StringPiece data) override { return dest_->Append(Mask(data)); }
+  Status Close() override { return dest_->Flush(); }
+  Status Flush() override { return dest_->Flush(); }
+  Status Sync() override { return dest_->Sync(); }
+
+ private:
+  WritableFile* const dest_;
+};
+
+class UnmaskingStream : public InputStreamInterface {
+ public:
+  explicit UnmaskingStream(std::unique_ptr<InputStreamInterface> input)
+      : input_(std::move(input)) {}
+
+  Status ReadNBytes(int64 bytes_to_read, tstring* result) override {
+    Status s = input_->ReadNBytes(bytes_to_read, result);
+    char* data = result->mdata();
+    for (size_t i = 0; i < result->size(); ++i) data[i] ^= kMask;
+    return s;
+  }
+  int64 Tell() const override { return input_->Tell(); }
+  Status Reset() override { return input_->Reset(); }
+
+ private:
+  std::unique_ptr<InputStreamInterface> input_;
+};
+
+// A "compression" that masks every byte, so that reading the file without
+// the codec fails.
+class MaskingCodec : public CompressionCodec {
+ public:
+  Status NewCompressingFile(
+      WritableFile* dest,
+      std::unique_ptr<WritableFile>* result) const override {
+    result->reset(new MaskingFile(dest));
+    return Status::OK();
+  }
+
+  Status NewDecompressingStream(
+      std::unique_ptr<InputStreamInterface> input,
+      std::unique_ptr<InputStreamInterface>* result) const override {
+    result->reset(new UnmaskingStream(std::move(input)));
+    return Status::OK();
+  }
+};
+
+REGISTER_COMPRESSION_CODEC("TEST_MASK", MaskingCodec);
+
+TEST(CompressionCodecTest, Lookup) {
+  EXPECT_NE(CompressionCodecRegistry::Lookup("TEST_MASK"), nullptr);
+  EXPECT_EQ(CompressionCodecRegistry::Lookup("NOT_REGISTERED"), nullptr);
+  EXPECT_EQ(CompressionCodecRegistry::Lookup(""), nullptr);
+}
+
+TEST(CompressionCodecTest, RecordsRoundTrip) {
+  Env* env = Env::Default();
+  const string fname = io::JoinPath(testing::TmpDir(), "codec_records");
+  const std::vector<string> records = {"abc", "", "hello, world",
+                                       string(10000, 'x')};
+
+  RecordWriterOptions writer_options =
+      RecordWriterOptions::CreateRecordWriterOptions("TEST_MASK");
+  EXPECT_NE(writer_options.codec, nullptr);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(env->NewWritableFile(fname, &file));
+    RecordWriter writer(file.get(), writer_options);
+    for (const string& record : records) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  {
+    RecordReader reader(file.get(), RecordReaderOptions::
+                                        CreateRecordReaderOptions("TEST_MASK"));
+    uint64 offset = 0;
+    tstring record;
+    for (const string& expected : records) {
+      TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ(record, expected);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+  }
+  {
+    // The records were masked on their way to the file.
+    RecordReader reader(file.get());
+    uint64 offset = 0;
+    tstring record;
+    EXPECT_FALSE(reader.ReadRecord(&offset, &record).ok());
+  }
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
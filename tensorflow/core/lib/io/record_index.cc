@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace io {
+
+namespace {
+constexpr char kIndexSuffix[] = ".tfrecord_index";
+}  // namespace
+
+string RecordIndex::IndexFilename(const string& filename) {
+  return strings::StrCat(filename, kIndexSuffix);
+}
+
+Status RecordIndex::Build(Env* env, const string& filename,
+                          const RecordReaderOptions& options,
+                          RecordIndex* index) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  SequentialRecordReader reader(file.get(), options);
+  *index = RecordIndex();
+  tstring record;
+  while (true) {
+    Status s = reader.ReadRecord(&record);
+    if (errors::IsOutOfRange(s)) {
+      break;
+    }
+    TF_RETURN_IF_ERROR(s);
+    index->AddRecord(record.size());
+  }
+  return Status::OK();
+}
+
+Status RecordIndex::Read(Env* env, const string& index_filename,
+                         RecordIndex* index) {
+  string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() < 2 * sizeof(uint64) + sizeof(uint32)) {
+    return errors::DataLoss("truncated record index ", index_filename);
+  }
+  const size_t data_size = contents.size() - sizeof(uint32);
+  const uint32 masked_crc = core::DecodeFixed32(contents.data() + data_size);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(contents.data(), data_size)) {
+    return errors::DataLoss("corrupted record index ", index_filename);
+  }
+  const uint64 num_records = core::DecodeFixed64(contents.data());
+  if (data_size != (num_records + 2) * sizeof(uint64)) {
+    return errors::DataLoss("record index ", index_filename, " of ",
+                            num_records, " records has ", data_size,
+                            " bytes");
+  }
+  index->offsets_.resize(num_records + 1);
+  for (size_t i = 0; i <= num_records; ++i) {
+    index->offsets_[i] =
+        core::DecodeFixed64(contents.data() + (i + 1) * sizeof(uint64));
+  }
+  return Status::OK();
+}
+
+Status RecordIndex::Write(Env* env, const string& index_filename) const {
+  string contents;
+  core::PutFixed64(&contents, num_records());
+  for (uint64 offset : offsets_) {
+    core::PutFixed64(&contents, offset);
+  }
+  const uint32 crc = crc32c::Value(contents.data(), contents.size());
+  core::PutFixed32(&contents, crc32c::Mask(crc));
+  return WriteStringToFile(env, index_filename, contents);
+}
+
+void RecordIndex::AddRecord(uint64 length) {
+  offsets_.push_back(offsets_.back() + RecordReader::kHeaderSize + length +
+                     RecordReader::kFooterSize);
+}
+
+void RecordIndex::Shard(int64 num_shards, int64 shard_index, size_t* begin,
+                        size_t* end) const {
+  DCHECK_GT(num_shards, 0);
+  DCHECK_GE(shard_index, 0);
+  DCHECK_LT(shard_index, num_shards);
+  // The first `num_records() % num_shards` shards have one more record.
+  const size_t shard_size = num_records() / num_shards;
+  const size_t remainder = num_records() % num_shards;
+  const size_t index = static_cast<size_t>(shard_index);
+  *begin = index * shard_size + std::min(index, remainder);
+  *end = *begin + shard_size + (index < remainder ? 1 : 0);
+}
+
+}  // namespace io
+}  // namespace tensorflow
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Env;
+
+namespace io {
+
+// The offsets of the records of a TFRecord file, by ordinal.
+//
+// With an index, a reader seeks to any record in constant time, by passing
+// its offset to RecordReader::ReadRecord(), and a file can be split into
+// shards of records without scanning the length of every record before them.
+// Offsets are the ones RecordReader::ReadRecord() takes, i.e. offsets in the
+// uncompressed stream of records of compressed files.
+//
+// Indexes are stored next to their TFRecord file, in a file named by
+// IndexFilename() with the format:
+//  uint64    number of records N
+//  uint64    offset[N + 1], where offset[N] is the end of the last record
+//  uint32    masked crc of the above
+//
+// Indexes are written by RecordWriter when RecordWriterOptions::index_filename
+// is set, or built from existing files with Build().
+class RecordIndex {
+ public:
+  // Creates the index of an empty file.
+  RecordIndex() : offsets_({0}) {}
+
+  // Returns the name of the index of the TFRecord file `filename`.
+  static string IndexFilename(const string& filename);
+
+  // Builds the index of the TFRecord file `filename` by reading it with
+  // `options`.
+  static Status Build(Env* env, const string& filename,
+                      const RecordReaderOptions& options, RecordIndex* index);
+
+  // Reads the index stored in `index_filename`.
+  static Status Read(Env* env, const string& index_filename,
+                     RecordIndex* index);
+
+  // Writes the index to `index_filename`.
+  Status Write(Env* env, const string& index_filename) const;
+
+  // Appends a record of `length` bytes after the records of the index.
+  void AddRecord(uint64 length);
+
+  size_t num_records() const { return offsets_.size() - 1; }
+
+  // Returns the offset of the record `i`, or the end of the last record if
+  // `i` is `num_records()`.
+  uint64 offset(size_t i) const { return offsets_[i]; }
+
+  // Returns the length of the data of the record `i`.
+  uint64 length(size_t i) const {
+    return offsets_[i + 1] - offsets_[i] - RecordReader::kHeaderSize -
+           RecordReader::kFooterSize;
+  }
+
+  // Returns the records `[*begin, *end)` of the shard `shard_index` out of
+  // `num_shards` shards of about the same number of records.
+  void Shard(int64 num_shards, int64 shard_index, size_t* begin,
+             size_t* end) const;
+
+ private:
+  std::vector<uint64> offsets_;
+};
+
+}  // namespace io
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_LIB_IO_RECORD_INDEX_H_
@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/lib/io/record_index.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace io {
+namespace {
+
+// Writes `num_records` records of increasing sizes to `fname`, with `options`,
+// and returns them.
+std::vector<string> WriteRecords(const string& fname, int num_records,
+                                 const RecordWriterOptions& options) {
+  std::vector<string> records;
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+  RecordWriter writer(file.get(), options);
+  for (int i = 0; i < num_records; ++i) {
+    records.push_back(string(i, 'a' + i % 26));
+    TF_CHECK_OK(writer.WriteRecord(records.back()));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return records;
+}
+
+TEST(RecordIndexTest, WrittenByRecordWriter) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_written";
+  RecordWriterOptions options;
+  options.index_filename = RecordIndex::IndexFilename(fname);
+  const std::vector<string> records = WriteRecords(fname, 20, options);
+
+  RecordIndex index;
+  TF_ASSERT_OK(RecordIndex::Read(env, options.index_filename, &index));
+  ASSERT_EQ(records.size(), index.num_records());
+  uint64 file_size;
+  TF_ASSERT_OK(env->GetFileSize(fname, &file_size));
+  EXPECT_EQ(file_size, index.offset(index.num_records()));
+
+  // Records are read in any order by their offsets.
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+  RecordReader reader(file.get());
+  for (int i = records.size() - 1; i >= 0; --i) {
+    uint64 offset = index.offset(i);
+    tstring record;
+    TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+    EXPECT_EQ(records[i], record);
+    EXPECT_EQ(records[i].size(), index.length(i));
+    EXPECT_EQ(index.offset(i + 1), offset);
+  }
+}
+
+TEST(RecordIndexTest, BuiltFromCompressedFile) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_built";
+  RecordWriterOptions options =
+      RecordWriterOptions::CreateRecordWriterOptions("GZIP");
+  options.index_filename = RecordIndex::IndexFilename(fname);
+  WriteRecords(fname, 10, options);
+  RecordIndex written;
+  TF_ASSERT_OK(RecordIndex::Read(env, options.index_filename, &written));
+
+  RecordIndex built;
+  TF_ASSERT_OK(RecordIndex::Build(
+      env, fname, RecordReaderOptions::CreateRecordReaderOptions("GZIP"),
+      &built));
+  ASSERT_EQ(written.num_records(), built.num_records());
+  for (size_t i = 0; i <= built.num_records(); ++i) {
+    EXPECT_EQ(written.offset(i), built.offset(i));
+  }
+}
+
+TEST(RecordIndexTest, EmptyFile) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_empty";
+  RecordWriterOptions options;
+  options.index_filename = RecordIndex::IndexFilename(fname);
+  WriteRecords(fname, 0, options);
+  RecordIndex index;
+  TF_ASSERT_OK(RecordIndex::Read(env, options.index_filename, &index));
+  EXPECT_EQ(0, index.num_records());
+  EXPECT_EQ(0, index.offset(0));
+}
+
+TEST(RecordIndexTest, CorruptedIndex) {
+  Env* env = Env::Default();
+  const string fname = testing::TmpDir() + "/record_index_corrupted";
+  RecordIndex index;
+  index.AddRecord(3);
+  TF_ASSERT_OK(index.Write(env, fname));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(env, fname, &contents));
+
+  string corrupted = contents;
+  corrupted[10] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(env, fname, corrupted));
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, fname, &index)));
+  TF_ASSERT_OK(
+      WriteStringToFile(env, fname, contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(errors::IsDataLoss(RecordIndex::Read(env, fname, &index)));
+}
+
+TEST(RecordIndexTest, Shard) {
+  RecordIndex index;
+  for (int i = 0; i < 10; ++i) {
+    index.AddRecord(i);
+  }
+  size_t begin, end;
+  std::vector<size_t> shard_sizes;
+  size_t next = 0;
+  for (int shard = 0; shard < 4; ++shard) {
+    index.Shard(4, shard, &begin, &end);
+    EXPECT_EQ(next, begin);
+    shard_sizes.push_back(end - begin);
+    next = end;
+  }
+  EXPECT_EQ(10, next);
+  EXPECT_EQ(std::vector<size_t>({3, 3, 2, 2}), shard_sizes);
+
+  // Shards past the number of records are empty.
+  index.Shard(20, 15, &begin, &end);
+  EXPECT_EQ(begin, end);
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tensorflow
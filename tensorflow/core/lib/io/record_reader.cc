@@ -47,8 +47,11 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
   } else if (compression_type != compression::kNone) {
-    LOG(ERROR) << "Unsupported compression_type:" << compression_type
-               << ". No compression will be used.";
+    options.codec = CompressionCodecRegistry::Lookup(compression_type);
+    if (options.codec == nullptr) {
+      LOG(ERROR) << "Unsupported compression_type:" << compression_type
+                 << ". No compression will be used.";
+    }
   }
 #endif
   return options;
@@ -77,6 +80,15 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.codec != nullptr) {
+    std::unique_ptr<InputStreamInterface> compressed_stream(
+        input_stream_.release());
+    Status s = options.codec->NewDecompressingStream(
+        std::move(compressed_stream), &input_stream_);
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize the compression codec. Error: "
+                 << s.ToString();
+    }
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -85,6 +97,10 @@ RecordReader::RecordReader(RandomAccessFile* file,
 #endif
 }
 
+RecordReader::RecordReader(ReadOnlyMemoryRegion* region)
+    : region_(static_cast<const char*>(region->data()), region->length()),
+      last_read_failed_(false) {}
+
 // Read n+4 bytes from file, verify that checksum of first n bytes is
 // stored in the last 4 bytes and store the first n bytes in *result.
 //
@@ -114,6 +130,27 @@ Status RecordReader::ReadChecksummed(uint64 offset, size_t n, tstring* result) {
   return Status::OK();
 }
 
+Status RecordReader::ReadChecksummedFromRegion(uint64 offset, size_t n,
+                                               StringPiece* result) {
+  if (n >= SIZE_MAX - sizeof(uint32)) {
+    return errors::DataLoss("record size too large");
+  }
+  if (offset >= region_.size()) {
+    return errors::OutOfRange("eof");
+  }
+  if (region_.size() - offset < n + sizeof(uint32)) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+
+  const char* data = region_.data() + offset;
+  const uint32 masked_crc = core::DecodeFixed32(data + n);
+  if (crc32c::Unmask(masked_crc) != crc32c::Value(data, n)) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  *result = StringPiece(data, n);
+  return Status::OK();
+}
+
 Status RecordReader::GetMetadata(Metadata* md) {
   if (!md) {
     return errors::InvalidArgument(
@@ -122,7 +159,9 @@ Status RecordReader::GetMetadata(Metadata* md) {
 
   // Compute the metadata of the TFRecord file if not cached.
   if (!cached_metadata_) {
-    TF_RETURN_IF_ERROR(input_stream_->Reset());
+    if (input_stream_ != nullptr) {
+      TF_RETURN_IF_ERROR(input_stream_->Reset());
+    }
 
     int64 data_size = 0;
     int64 entries = 0;
@@ -134,7 +173,14 @@ Status RecordReader::GetMetadata(Metadata* md) {
     tstring record;
     while (true) {
       // Read header, containing size of data.
-      Status s = ReadChecksummed(offset, sizeof(uint64), &record);
+      StringPiece header;
+      Status s;
+      if (input_stream_ != nullptr) {
+        s = ReadChecksummed(offset, sizeof(uint64), &record);
+        header = record;
+      } else {
+        s = ReadChecksummedFromRegion(offset, sizeof(uint64), &header);
+      }
       if (!s.ok()) {
         if (errors::IsOutOfRange(s)) {
           // We should reach out of range when the record file is complete.
@@ -144,11 +190,13 @@ Status RecordReader::GetMetadata(Metadata* md) {
       }
 
       // Read the length of the data.
-      const uint64 length = core::DecodeFixed64(record.data());
+      const uint64 length = core::DecodeFixed64(header.data());
 
       // Skip reading the actual data since we just want the number
       // of records and the size of the data.
-      TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(length + kFooterSize));
+      if (input_stream_ != nullptr) {
+        TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(length + kFooterSize));
+      }
       offset += kHeaderSize + length + kFooterSize;
 
       // Increment running stats.
@@ -168,6 +216,13 @@ Status RecordReader::GetMetadata(Metadata* md) {
 }
 
 Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
+  if (input_stream_ == nullptr) {
+    StringPiece view;
+    TF_RETURN_IF_ERROR(ReadRecord(offset, &view));
+    record->assign(view.data(), view.size());
+    return Status::OK();
+  }
+
   // Position the input stream.
   int64 curr_pos = input_stream_->Tell();
   int64 desired_pos = static_cast<int64>(*offset);
@@ -204,9 +259,37 @@ Status RecordReader::ReadRecord(uint64* offset, tstring* record) {
   return Status::OK();
 }
 
+Status RecordReader::ReadRecord(uint64* offset, StringPiece* record) {
+  if (input_stream_ != nullptr) {
+    return errors::Unimplemented(
+        "Only readers of a ReadOnlyMemoryRegion return records as views.");
+  }
+
+  // Read header data.
+  StringPiece header;
+  TF_RETURN_IF_ERROR(
+      ReadChecksummedFromRegion(*offset, sizeof(uint64), &header));
+  const uint64 length = core::DecodeFixed64(header.data());
+
+  // Read data
+  Status s = ReadChecksummedFromRegion(*offset + kHeaderSize, length, record);
+  if (!s.ok()) {
+    if (errors::IsOutOfRange(s)) {
+      s = errors::DataLoss("truncated record at ", *offset);
+    }
+    return s;
+  }
+
+  *offset += kHeaderSize + length + kFooterSize;
+  return Status::OK();
+}
+
 SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+SequentialRecordReader::SequentialRecordReader(ReadOnlyMemoryRegion* region)
+    : underlying_(region), offset_(0) {}
+
 }  // namespace io
 }  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/io/compression_codec.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
@@ -31,6 +32,7 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -50,6 +52,10 @@ struct RecordReaderOptions {
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
+  // If set, records are decompressed with this registered codec instead, and
+  // `compression_type` must be NONE.
+  const CompressionCodec* codec = nullptr;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
@@ -90,6 +96,14 @@ class RecordReader {
       RandomAccessFile* file,
       const RecordReaderOptions& options = RecordReaderOptions());
 
+  // Create a reader that will return records straight from "*region",
+  // which holds an uncompressed TFRecord file, e.g. one memory-mapped with
+  // Env::NewReadOnlyMemoryRegionFromFile(). The checksum of each record is
+  // computed over the region in one pass, and no input stream copies it.
+  // "*region" must remain live while this Reader, or a record it returned
+  // as a StringPiece, is in use.
+  explicit RecordReader(ReadOnlyMemoryRegion* region);
+
   virtual ~RecordReader() = default;
 
   // Read the record at "*offset" into *record and update *offset to
@@ -97,6 +111,11 @@ class RecordReader {
   // OUT_OF_RANGE for end of file, or something else for an error.
   Status ReadRecord(uint64* offset, tstring* record);
 
+  // Like ReadRecord() above, but sets *record to point at the record in the
+  // memory region of the reader instead of copying it. Only supported by
+  // readers created from a ReadOnlyMemoryRegion.
+  Status ReadRecord(uint64* offset, StringPiece* record);
+
   // Return the metadata of the Record file.
   //
   // The current implementation scans the file to completion,
@@ -111,8 +130,15 @@ class RecordReader {
  private:
   Status ReadChecksummed(uint64 offset, size_t n, tstring* result);
 
+  // Like ReadChecksummed(), but from the memory region of the reader.
+  Status ReadChecksummedFromRegion(uint64 offset, size_t n,
+                                   StringPiece* result);
+
   RecordReaderOptions options_;
   std::unique_ptr<InputStreamInterface> input_stream_;
+  // The contents of the memory region the reader was created from, if any,
+  // in which case there is no `input_stream_`.
+  StringPiece region_;
   bool last_read_failed_;
 
   std::unique_ptr<Metadata> cached_metadata_;
@@ -131,6 +157,10 @@ class SequentialRecordReader {
       RandomAccessFile* file,
       const RecordReaderOptions& options = RecordReaderOptions());
 
+  // Create a reader that will return records straight from "*region",
+  // as RecordReader(ReadOnlyMemoryRegion*) does.
+  explicit SequentialRecordReader(ReadOnlyMemoryRegion* region);
+
   virtual ~SequentialRecordReader() = default;
 
   // Reads the next record in the file into *record. Returns OK on success,
@@ -139,6 +169,12 @@ class SequentialRecordReader {
     return underlying_.ReadRecord(&offset_, record);
   }
 
+  // Sets *record to point at the next record in the memory region of the
+  // reader. Only supported by readers created from a ReadOnlyMemoryRegion.
+  Status ReadRecord(StringPiece* record) {
+    return underlying_.ReadRecord(&offset_, record);
+  }
+
   // Returns the current offset in the file.
   uint64 TellOffset() { return offset_; }
 
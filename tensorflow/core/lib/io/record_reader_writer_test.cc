@@ -234,6 +234,90 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+// A memory region over the contents of a string.
+class StringRegion : public ReadOnlyMemoryRegion {
+ public:
+  explicit StringRegion(string data) : data_(std::move(data)) {}
+  const void* data() override { return data_.data(); }
+  uint64 length() override { return data_.size(); }
+
+ private:
+  const string data_;
+};
+
+TEST(RecordReaderWriterTest, TestMemoryRegion) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_region_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord(""));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Close());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::RecordReader reader(region.get());
+  uint64 offset = 0;
+  StringPiece view;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &view));
+  EXPECT_EQ("abc", view);
+  // The record points into the region.
+  EXPECT_EQ(static_cast<const char*>(region->data()) + 12, view.data());
+  TF_CHECK_OK(reader.ReadRecord(&offset, &view));
+  EXPECT_EQ("", view);
+  tstring record;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("defg", record);
+  EXPECT_EQ(region->length(), offset);
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &view)));
+
+  offset = 0;
+  TF_CHECK_OK(reader.ReadRecord(&offset, &view));
+  EXPECT_EQ("abc", view);
+
+  io::RecordReader::Metadata md;
+  TF_ASSERT_OK(reader.GetMetadata(&md));
+  EXPECT_EQ(3, md.stats.entries);
+  EXPECT_EQ(7, md.stats.data_size);
+  EXPECT_EQ(region->length(), md.stats.file_size);
+
+  io::SequentialRecordReader sequential_reader(region.get());
+  TF_CHECK_OK(sequential_reader.ReadRecord(&view));
+  EXPECT_EQ("abc", view);
+  TF_CHECK_OK(sequential_reader.ReadRecord(&record));
+  EXPECT_EQ("", record);
+
+  const string contents(static_cast<const char*>(region->data()),
+                        region->length());
+  // Truncated records are data loss.
+  StringRegion truncated(contents.substr(0, contents.size() - 1));
+  io::RecordReader truncated_reader(&truncated);
+  offset = 19;
+  TF_CHECK_OK(truncated_reader.ReadRecord(&offset, &view));
+  EXPECT_EQ(error::DATA_LOSS,
+            truncated_reader.ReadRecord(&offset, &view).code());
+  // So are records that do not match their checksum.
+  string corrupted_contents = contents;
+  corrupted_contents[13] = 'x';
+  StringRegion corrupted(corrupted_contents);
+  io::RecordReader corrupted_reader(&corrupted);
+  offset = 0;
+  EXPECT_EQ(error::DATA_LOSS,
+            corrupted_reader.ReadRecord(&offset, &view).code());
+
+  // Readers of files do not return views.
+  std::unique_ptr<RandomAccessFile> read_file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+  io::RecordReader file_reader(read_file.get());
+  offset = 0;
+  EXPECT_TRUE(
+      errors::IsUnimplemented(file_reader.ReadRecord(&offset, &view)));
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -30,6 +30,10 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsCodecCompressed(const RecordWriterOptions& options) {
+  return options.codec != nullptr;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -50,8 +54,11 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
   } else if (compression_type != compression::kNone) {
-    LOG(ERROR) << "Unsupported compression_type:" << compression_type
-               << ". No compression will be used.";
+    options.codec = CompressionCodecRegistry::Lookup(compression_type);
+    if (options.codec == nullptr) {
+      LOG(ERROR) << "Unsupported compression_type:" << compression_type
+                 << ". No compression will be used.";
+    }
   }
 #endif
   return options;
@@ -79,6 +86,14 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsCodecCompressed(options)) {
+    std::unique_ptr<WritableFile> compressed_dest;
+    Status s = options.codec->NewCompressingFile(dest, &compressed_dest);
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize the compression codec. Error: "
+                 << s.ToString();
+    }
+    dest_ = compressed_dest.release();
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -112,7 +127,11 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (!options_.index_filename.empty()) {
+    index_.AddRecord(data.size());
+  }
+  return Status::OK();
 }
 
 #if defined(PLATFORM_GOOGLE)
@@ -132,19 +151,29 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  if (!options_.index_filename.empty()) {
+    index_.AddRecord(data.size());
+  }
+  return Status::OK();
 }
 #endif
 
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return Status::OK();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
-    Status s = dest_->Close();
+  Status s;
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsCodecCompressed(options_)) {
+    s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
-    return s;
   }
-  return Status::OK();
+  // The index is written once all records were written.
+  if (s.ok() && !options_.index_filename.empty() && !index_written_) {
+    s = index_.Write(Env::Default(), options_.index_filename);
+    index_written_ = s.ok();
+  }
+  return s;
 }
 
 Status RecordWriter::Flush() {
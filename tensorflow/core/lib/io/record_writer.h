@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/compression_codec.h"
+#include "tensorflow/core/lib/io/record_index.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/core/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/core/lib/io/snappy/snappy_outputbuffer.h"
@@ -48,6 +50,14 @@ struct RecordWriterOptions {
   static RecordWriterOptions CreateRecordWriterOptions(
       const string& compression_type);
 
+  // If set, records are compressed with this registered codec instead, and
+  // `compression_type` must be NONE.
+  const CompressionCodec* codec = nullptr;
+
+  // If not empty, Close() writes the index of the records written to this
+  // file, which is usually RecordIndex::IndexFilename() of the file written.
+  string index_filename;
+
 #if !defined(IS_SLIM_BUILD)
   // Options specific to compression.
   tensorflow::io::ZlibCompressionOptions zlib_options;
@@ -110,6 +120,10 @@ class RecordWriter {
  private:
   WritableFile* dest_;
   RecordWriterOptions options_;
+  // The records written so far, if `options_.index_filename` is set, and
+  // whether the index was written by Close().
+  RecordIndex index_;
+  bool index_written_ = false;
 
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
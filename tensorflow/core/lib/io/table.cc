@@ -15,9 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/table.h"
 
+#include <memory>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/block.h"
+#include "tensorflow/core/lib/io/bloom_filter.h"
 #include "tensorflow/core/lib/io/cache.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/table_options.h"
@@ -28,7 +31,10 @@ namespace tensorflow {
 namespace table {
 
 struct Table::Rep {
-  ~Rep() { delete index_block; }
+  ~Rep() {
+    delete index_block;
+    if (filter_heap_allocated) delete[] filter.data();
+  }
 
   Options options;
   Status status;
@@ -37,8 +43,36 @@ struct Table::Rep {
 
   BlockHandle metaindex_handle;  // Handle to metaindex_block: saved from footer
   Block* index_block;
+
+  // The bloom filter over all keys, empty if the table has none.
+  StringPiece filter;
+  bool filter_heap_allocated = false;
 };
 
+namespace {
+
+// Reads the bloom filter registered in the metaindex block of a table, if
+// any, into "*filter".  Leaves "*filter" empty otherwise.
+Status ReadFilter(RandomAccessFile* file, const BlockHandle& metaindex_handle,
+                  BlockContents* filter) {
+  filter->data = StringPiece();
+  filter->heap_allocated = false;
+  BlockContents contents;
+  TF_RETURN_IF_ERROR(ReadBlock(file, metaindex_handle, &contents));
+  Block metaindex_block(contents);
+  std::unique_ptr<Iterator> iter(metaindex_block.NewIterator());
+  iter->Seek(kBloomFilterMetaKey);
+  if (!iter->Valid() || iter->key() != kBloomFilterMetaKey) {
+    return iter->status();
+  }
+  BlockHandle filter_handle;
+  StringPiece input = iter->value();
+  TF_RETURN_IF_ERROR(filter_handle.DecodeFrom(&input));
+  return ReadBlock(file, filter_handle, filter);
+}
+
+}  // namespace
+
 Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
                    Table** table) {
   *table = nullptr;
@@ -63,6 +97,14 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     s = ReadBlock(file, footer.index_handle(), &contents);
   }
 
+  // Read the filter block, if any.  The filter is not needed to read the
+  // table, so the table is read without one if the filter cannot be read.
+  BlockContents filter;
+  if (s.ok() && !ReadFilter(file, footer.metaindex_handle(), &filter).ok()) {
+    filter.data = StringPiece();
+    filter.heap_allocated = false;
+  }
+
   if (s.ok()) {
     // We've successfully read the footer and the index block: we're
     // ready to serve requests.
@@ -72,6 +114,8 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
     rep->file = file;
     rep->metaindex_handle = footer.metaindex_handle();
     rep->index_block = index_block;
+    rep->filter = filter.data;
+    rep->filter_heap_allocated = filter.heap_allocated;
     rep->cache_id = (options.block_cache ? options.block_cache->NewId() : 0);
     *table = new Table(rep);
   } else {
@@ -153,13 +197,25 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
 }
 
 Iterator* Table::NewIterator() const {
+  if (rep_->options.prefetch_pool != nullptr) {
+    return NewPrefetchingTwoLevelIterator(
+        rep_->index_block->NewIterator(), &Table::BlockReader,
+        const_cast<Table*>(this), rep_->options.prefetch_pool,
+        rep_->index_block->NewIterator());
+  }
   return NewTwoLevelIterator(rep_->index_block->NewIterator(),
                              &Table::BlockReader, const_cast<Table*>(this));
 }
 
+bool Table::KeyMayMatch(const StringPiece& key) const {
+  return rep_->filter.empty() || BloomFilterMayMatch(BloomHash(key),
+                                                     rep_->filter);
+}
+
 Status Table::InternalGet(const StringPiece& k, void* arg,
                           void (*saver)(void*, const StringPiece&,
                                         const StringPiece&)) {
+  if (!KeyMayMatch(k)) return Status::OK();
   Status s;
   Iterator* iiter = rep_->index_block->NewIterator();
   iiter->Seek(k);
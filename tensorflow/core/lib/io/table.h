@@ -61,6 +61,11 @@ class Table {
   // be close to the file length.
   uint64 ApproximateOffsetOf(const StringPiece& key) const;
 
+  // Returns false if the table definitely does not contain "key", which is
+  // known without reading data blocks if the table has a bloom filter (see
+  // Options::filter_bits_per_key).  Returns true otherwise.
+  bool KeyMayMatch(const StringPiece& key) const;
+
  private:
   struct Rep;
   Rep* rep_;
@@ -16,9 +16,13 @@ limitations under the License.
 #include "tensorflow/core/lib/io/table_builder.h"
 
 #include <assert.h>
+
+#include <vector>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/lib/io/bloom_filter.h"
 #include "tensorflow/core/lib/io/block_builder.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/table_options.h"
@@ -93,6 +97,10 @@ struct TableBuilder::Rep {
 
   string compressed_output;
 
+  // The hashes of the keys for the bloom filter, if options.filter_bits_per_key
+  // is positive.
+  std::vector<uint32> key_hashes;
+
   Rep(const Options& opt, WritableFile* f)
       : options(opt),
         index_block_options(opt),
@@ -141,6 +149,9 @@ void TableBuilder::Add(const StringPiece& key, const StringPiece& value) {
 
   r->last_key.assign(key.data(), key.size());
   r->num_entries++;
+  if (r->options.filter_bits_per_key > 0) {
+    r->key_hashes.push_back(BloomHash(key));
+  }
   r->data_block.Add(key, value);
 
   const size_t estimated_block_size = r->data_block.CurrentSizeEstimate();
@@ -225,11 +236,25 @@ Status TableBuilder::Finish() {
   assert(!r->closed);
   r->closed = true;
 
-  BlockHandle metaindex_block_handle, index_block_handle;
+  BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
+
+  // Write filter block
+  const bool has_filter =
+      r->options.filter_bits_per_key > 0 && !r->key_hashes.empty();
+  if (ok() && has_filter) {
+    string filter;
+    BuildBloomFilter(r->key_hashes, r->options.filter_bits_per_key, &filter);
+    WriteRawBlock(filter, kNoCompression, &filter_block_handle);
+  }
 
   // Write metaindex block
   if (ok()) {
     BlockBuilder meta_index_block(&r->options);
+    if (has_filter) {
+      string handle_encoding;
+      filter_block_handle.EncodeTo(&handle_encoding);
+      meta_index_block.Add(kBloomFilterMetaKey, handle_encoding);
+    }
     // TODO(postrelease): Add stats and other meta blocks
     WriteBlock(&meta_index_block, &metaindex_block_handle);
   }
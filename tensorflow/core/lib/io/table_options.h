@@ -19,6 +19,9 @@ limitations under the License.
 #include <stddef.h>
 
 namespace tensorflow {
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 namespace table {
 
 class Cache;
@@ -68,6 +71,18 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If positive, the builder writes a bloom filter over all keys that uses
+  // this many bits per key, and Table::KeyMayMatch() uses the filter to tell
+  // most missing keys apart without reading data blocks.  10 bits per key
+  // give a false positive rate of about 1%.  Tables with a filter can be read
+  // by releases that do not know about filters.
+  int filter_bits_per_key = 0;
+
+  // If non-null, iterators read the data block after the current one on this
+  // pool while the current block is iterated, as long as they move through
+  // the table in order, either by Next() or by seeking to increasing keys.
+  thread::ThreadPool* prefetch_pool = nullptr;
 };
 
 }  // namespace table
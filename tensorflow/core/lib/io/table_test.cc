@@ -17,20 +17,25 @@ limitations under the License.
 
 #include <algorithm>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/strings/escaping.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/block_builder.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table_builder.h"
+#include "tensorflow/core/lib/io/table_options.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/snappy.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace table {
@@ -633,5 +638,91 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+static string NumberedKey(int i) { return strings::Printf("k%05d", i); }
+
+// Writes a table of "num_keys" numbered keys with 100 byte values.
+static string BuildNumberedTable(const Options& options, int num_keys) {
+  StringSink sink;
+  TableBuilder builder(options, &sink);
+  for (int i = 0; i < num_keys; ++i) {
+    builder.Add(NumberedKey(i), string(100, 'a' + i % 26));
+  }
+  TF_CHECK_OK(builder.Finish());
+  return sink.contents();
+}
+
+TEST(TableTest, BloomFilter) {
+  Options options;
+  options.block_size = 1024;
+  options.filter_bits_per_key = 10;
+  StringSource source(BuildNumberedTable(options, 2000));
+  Table* table;
+  TF_ASSERT_OK(Table::Open(Options(), &source, source.Size(), &table));
+  std::unique_ptr<Table> table_deleter(table);
+
+  for (int i = 0; i < 2000; ++i) {
+    EXPECT_TRUE(table->KeyMayMatch(NumberedKey(i)));
+  }
+  int false_positives = 0;
+  for (int i = 2000; i < 4000; ++i) {
+    if (table->KeyMayMatch(NumberedKey(i))) ++false_positives;
+  }
+  // The false positive rate is about 1%.
+  EXPECT_LT(false_positives, 100);
+
+  // Tables without a filter may contain any key.
+  StringSource unfiltered_source(BuildNumberedTable(Options(), 10));
+  Table* unfiltered;
+  TF_ASSERT_OK(Table::Open(Options(), &unfiltered_source,
+                           unfiltered_source.Size(), &unfiltered));
+  std::unique_ptr<Table> unfiltered_deleter(unfiltered);
+  EXPECT_TRUE(unfiltered->KeyMayMatch(NumberedKey(20)));
+}
+
+TEST(TableTest, PrefetchingIterator) {
+  Options options;
+  options.block_size = 1024;
+  StringSource source(BuildNumberedTable(options, 2000));
+  thread::ThreadPool pool(Env::Default(), "prefetch", 2);
+  Options table_options;
+  table_options.prefetch_pool = &pool;
+  Table* table;
+  TF_ASSERT_OK(Table::Open(table_options, &source, source.Size(), &table));
+  std::unique_ptr<Table> table_deleter(table);
+
+  // Iterating in order.
+  std::unique_ptr<Iterator> iter(table->NewIterator());
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    EXPECT_EQ(NumberedKey(i), iter->key());
+    EXPECT_EQ(string(100, 'a' + i % 26), iter->value());
+  }
+  TF_EXPECT_OK(iter->status());
+  EXPECT_EQ(2000, i);
+
+  // Seeking to increasing keys.
+  for (i = 0; i < 2000; i += 7) {
+    iter->Seek(NumberedKey(i));
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_EQ(NumberedKey(i), iter->key());
+  }
+
+  // Seeking to random keys.
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int j = 0; j < 200; ++j) {
+    i = rnd.Uniform(2000);
+    iter->Seek(NumberedKey(i));
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_EQ(NumberedKey(i), iter->key());
+    iter->Next();
+    if (i + 1 < 2000) {
+      ASSERT_TRUE(iter->Valid());
+      EXPECT_EQ(NumberedKey(i + 1), iter->key());
+    }
+  }
+  TF_EXPECT_OK(iter->status());
+}
+
 }  // namespace table
 }  // namespace tensorflow
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/lib/io/two_level_iterator.h"
 
+#include <memory>
+
 #include "tensorflow/core/lib/io/block.h"
 #include "tensorflow/core/lib/io/format.h"
 #include "tensorflow/core/lib/io/iterator.h"
 #include "tensorflow/core/lib/io/table.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 namespace table {
@@ -30,7 +34,8 @@ typedef Iterator* (*BlockFunction)(void*, const StringPiece&);
 class TwoLevelIterator : public Iterator {
  public:
   TwoLevelIterator(Iterator* index_iter, BlockFunction block_function,
-                   void* arg);
+                   void* arg, thread::ThreadPool* prefetch_pool,
+                   Iterator* peek_index_iter);
 
   ~TwoLevelIterator() override;
 
@@ -67,7 +72,21 @@ class TwoLevelIterator : public Iterator {
   }
   void SkipEmptyDataBlocksForward();
   void SetDataIterator(Iterator* data_iter);
-  void InitDataBlock();
+  // "in_order" is true if the block is known to follow the previous one.
+  void InitDataBlock(bool in_order);
+
+  // A block read on prefetch_pool_.
+  struct Prefetch {
+    mutex mu;
+    condition_variable cv;
+    bool done TF_GUARDED_BY(mu) = false;
+    Iterator* iter TF_GUARDED_BY(mu) = nullptr;
+  };
+  // Starts reading the block of "handle" on prefetch_pool_.
+  void StartPrefetch(const StringPiece& handle);
+  // Waits for the pending prefetch, if any, and returns its iterator if it
+  // read the block of "handle".  Returns nullptr otherwise.
+  Iterator* FinishPrefetch(const StringPiece& handle);
 
   BlockFunction block_function_;
   void* arg_;
@@ -77,30 +96,46 @@ class TwoLevelIterator : public Iterator {
   // If data_iter_ is non-NULL, then "data_block_handle_" holds the
   // "index_value" passed to block_function_ to create the data_iter_.
   string data_block_handle_;
+
+  // Prefetching is disabled if prefetch_pool_ is NULL.
+  thread::ThreadPool* prefetch_pool_;
+  Iterator* peek_index_iter_;  // May be NULL
+  // The handle of the block after the one of data_iter_, if known.
+  string next_block_handle_;
+  // The handle of the block of prefetch_, if non-NULL.
+  string prefetch_handle_;
+  std::shared_ptr<Prefetch> prefetch_;
 };
 
 TwoLevelIterator::TwoLevelIterator(Iterator* index_iter,
-                                   BlockFunction block_function, void* arg)
+                                   BlockFunction block_function, void* arg,
+                                   thread::ThreadPool* prefetch_pool,
+                                   Iterator* peek_index_iter)
     : block_function_(block_function),
       arg_(arg),
       index_iter_(index_iter),
-      data_iter_(nullptr) {}
+      data_iter_(nullptr),
+      prefetch_pool_(peek_index_iter == nullptr ? nullptr : prefetch_pool),
+      peek_index_iter_(peek_index_iter) {}
 
 TwoLevelIterator::~TwoLevelIterator() {
+  // The prefetch may use "arg_", which may not outlive the iterator.
+  delete FinishPrefetch(StringPiece());
   delete index_iter_;
+  delete peek_index_iter_;
   delete data_iter_;
 }
 
 void TwoLevelIterator::Seek(const StringPiece& target) {
   index_iter_->Seek(target);
-  InitDataBlock();
+  InitDataBlock(/*in_order=*/false);
   if (data_iter_ != nullptr) data_iter_->Seek(target);
   SkipEmptyDataBlocksForward();
 }
 
 void TwoLevelIterator::SeekToFirst() {
   index_iter_->SeekToFirst();
-  InitDataBlock();
+  InitDataBlock(/*in_order=*/true);
   if (data_iter_ != nullptr) data_iter_->SeekToFirst();
   SkipEmptyDataBlocksForward();
 }
@@ -119,7 +154,7 @@ void TwoLevelIterator::SkipEmptyDataBlocksForward() {
       return;
     }
     index_iter_->Next();
-    InitDataBlock();
+    InitDataBlock(/*in_order=*/true);
     if (data_iter_ != nullptr) data_iter_->SeekToFirst();
   }
 }
@@ -132,7 +167,7 @@ void TwoLevelIterator::SetDataIterator(Iterator* data_iter) {
   data_iter_ = data_iter;
 }
 
-void TwoLevelIterator::InitDataBlock() {
+void TwoLevelIterator::InitDataBlock(bool in_order) {
   if (!index_iter_->Valid()) {
     SetDataIterator(nullptr);
   } else {
@@ -141,18 +176,76 @@ void TwoLevelIterator::InitDataBlock() {
       // data_iter_ is already constructed with this iterator, so
       // no need to change anything
     } else {
-      Iterator* iter = (*block_function_)(arg_, handle);
+      // Seeking to the block after the current one continues in order.
+      in_order = in_order || handle.compare(next_block_handle_) == 0;
+      Iterator* iter = FinishPrefetch(handle);
+      if (iter == nullptr) iter = (*block_function_)(arg_, handle);
       data_block_handle_.assign(handle.data(), handle.size());
       SetDataIterator(iter);
+
+      if (prefetch_pool_ != nullptr) {
+        next_block_handle_.clear();
+        peek_index_iter_->Seek(index_iter_->key());
+        if (peek_index_iter_->Valid()) peek_index_iter_->Next();
+        if (peek_index_iter_->Valid()) {
+          const StringPiece next_handle = peek_index_iter_->value();
+          next_block_handle_.assign(next_handle.data(), next_handle.size());
+          if (in_order) StartPrefetch(next_block_handle_);
+        }
+      }
     }
   }
 }
 
+void TwoLevelIterator::StartPrefetch(const StringPiece& handle) {
+  delete FinishPrefetch(StringPiece());
+  prefetch_handle_.assign(handle.data(), handle.size());
+  prefetch_ = std::make_shared<Prefetch>();
+  std::shared_ptr<Prefetch> prefetch = prefetch_;
+  BlockFunction block_function = block_function_;
+  void* arg = arg_;
+  string block_handle = prefetch_handle_;
+  prefetch_pool_->Schedule([prefetch, block_function, arg, block_handle]() {
+    Iterator* iter = (*block_function)(arg, block_handle);
+    mutex_lock l(prefetch->mu);
+    prefetch->iter = iter;
+    prefetch->done = true;
+    prefetch->cv.notify_all();
+  });
+}
+
+Iterator* TwoLevelIterator::FinishPrefetch(const StringPiece& handle) {
+  if (prefetch_ == nullptr) return nullptr;
+  Iterator* iter;
+  {
+    mutex_lock l(prefetch_->mu);
+    while (!prefetch_->done) prefetch_->cv.wait(l);
+    iter = prefetch_->iter;
+  }
+  prefetch_.reset();
+  if (handle.compare(prefetch_handle_) != 0) {
+    delete iter;
+    return nullptr;
+  }
+  return iter;
+}
+
 }  // namespace
 
 Iterator* NewTwoLevelIterator(Iterator* index_iter,
                               BlockFunction block_function, void* arg) {
-  return new TwoLevelIterator(index_iter, block_function, arg);
+  return new TwoLevelIterator(index_iter, block_function, arg,
+                              /*prefetch_pool=*/nullptr,
+                              /*peek_index_iter=*/nullptr);
+}
+
+Iterator* NewPrefetchingTwoLevelIterator(Iterator* index_iter,
+                                         BlockFunction block_function,
+                                         void* arg,
+                                         thread::ThreadPool* prefetch_pool,
+                                         Iterator* peek_index_iter) {
+  return new TwoLevelIterator(index_iter, block_function, arg, prefetch_pool,
+                              peek_index_iter);
 }
 
 }  // namespace table
@@ -19,6 +19,9 @@ limitations under the License.
 #include "tensorflow/core/lib/io/iterator.h"
 
 namespace tensorflow {
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 namespace table {
 
 // Return a new two level iterator.  A two-level iterator contains an
@@ -35,6 +38,16 @@ extern Iterator* NewTwoLevelIterator(
     Iterator* (*block_function)(void* arg, const StringPiece& index_value),
     void* arg);
 
+// Like NewTwoLevelIterator(), but while the iterator moves through the blocks
+// in order it reads the next block with "block_function" on "prefetch_pool".
+// "peek_index_iter" must be a second iterator over the index of "index_iter",
+// which is used to find the next block; takes ownership of it as well.
+// "block_function" must be safe to call concurrently with the iterator.
+extern Iterator* NewPrefetchingTwoLevelIterator(
+    Iterator* index_iter,
+    Iterator* (*block_function)(void* arg, const StringPiece& index_value),
+    void* arg, thread::ThreadPool* prefetch_pool, Iterator* peek_index_iter);
+
 }  // namespace table
 }  // namespace tensorflow
 
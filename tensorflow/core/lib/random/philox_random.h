@@ -190,6 +190,44 @@ class PhiloxRandom {
     return counter;
   }
 
+  // Fills `results` with the next kLanes groups of four random numbers,
+  // exactly as kLanes calls to operator() would. The counters of all lanes go
+  // through the rounds together, in structure-of-arrays form, so that the
+  // compiler can vectorize the rounds across lanes.
+  template <int kLanes>
+  PHILOX_DEVICE_INLINE void GenerateBlocks(ResultType* results) {
+    uint32 c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+    for (int lane = 0; lane < kLanes; ++lane) {
+      c0[lane] = counter_[0];
+      c1[lane] = counter_[1];
+      c2[lane] = counter_[2];
+      c3[lane] = counter_[3];
+      SkipOne();
+    }
+    Key key = key_;
+    for (int round = 0; round < 10; ++round) {
+      for (int lane = 0; lane < kLanes; ++lane) {
+        uint32 lo0;
+        uint32 hi0;
+        MultiplyHighLow(kPhiloxM4x32A, c0[lane], &lo0, &hi0);
+        uint32 lo1;
+        uint32 hi1;
+        MultiplyHighLow(kPhiloxM4x32B, c2[lane], &lo1, &hi1);
+        c0[lane] = hi1 ^ c1[lane] ^ key[0];
+        c1[lane] = lo1;
+        c2[lane] = hi0 ^ c3[lane] ^ key[1];
+        c3[lane] = lo0;
+      }
+      RaiseKey(&key);
+    }
+    for (int lane = 0; lane < kLanes; ++lane) {
+      results[lane][0] = c0[lane];
+      results[lane][1] = c1[lane];
+      results[lane][2] = c2[lane];
+      results[lane][3] = c3[lane];
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static constexpr uint32 kPhiloxW32A = 0x9E3779B9;
@@ -252,6 +290,35 @@ class PhiloxRandom {
   Key key_;
 };
 
+// Returns the same stream of groups as the PhiloxRandom it is created from,
+// but computes them kLanes at a time with PhiloxRandom::GenerateBlocks. Meant
+// for consumers that read long sequential runs of the stream, such as the CPU
+// random kernels.
+template <int kLanes>
+class BatchedPhiloxRandom {
+ public:
+  using ResultType = PhiloxRandom::ResultType;
+  using ResultElementType = PhiloxRandom::ResultElementType;
+  static constexpr int kResultElementCount = PhiloxRandom::kResultElementCount;
+  static constexpr int kElementCost = PhiloxRandom::kElementCost;
+
+  PHILOX_DEVICE_INLINE
+  explicit BatchedPhiloxRandom(const PhiloxRandom& gen) : gen_(gen) {}
+
+  PHILOX_DEVICE_INLINE ResultType operator()() {
+    if (next_ == kLanes) {
+      gen_.GenerateBlocks<kLanes>(blocks_);
+      next_ = 0;
+    }
+    return blocks_[next_++];
+  }
+
+ private:
+  PhiloxRandom gen_;
+  ResultType blocks_[kLanes];
+  int next_ = kLanes;
+};
+
 }  // namespace random
 }  // namespace tensorflow
 
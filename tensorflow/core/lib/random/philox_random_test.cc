@@ -68,6 +68,45 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating blocks in batches, directly or through
+// BatchedPhiloxRandom, produces the same stream as sequential generation.
+TEST(PhiloxRandomTest, BatchedMatchTest) {
+  constexpr int kLanes = 8;
+  constexpr int kBlocks = 4 * kLanes;
+
+  // Start close to a carry into counter_[1].
+  PhiloxRandom::ResultType counter;
+  counter[0] = 0xFFFFFFF0;
+  counter[1] = 0;
+  counter[2] = 0;
+  counter[3] = 0;
+  PhiloxRandom::Key key;
+  key[0] = static_cast<uint32>(GetTestSeed());
+  key[1] = static_cast<uint32>(GetTestSeed() >> 32);
+
+  PhiloxRandom sequential(counter, key);
+  PhiloxRandom blocks_gen(counter, key);
+  BatchedPhiloxRandom<kLanes> batched(PhiloxRandom(counter, key));
+  for (int i = 0; i < kBlocks; i += kLanes) {
+    PhiloxRandom::ResultType blocks[kLanes];
+    blocks_gen.GenerateBlocks<kLanes>(blocks);
+    for (int lane = 0; lane < kLanes; ++lane) {
+      const PhiloxRandom::ResultType expected = sequential();
+      const PhiloxRandom::ResultType from_adapter = batched();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(expected[j], blocks[lane][j]);
+        ASSERT_EQ(expected[j], from_adapter[j]);
+      }
+    }
+  }
+  // GenerateBlocks advances the stream like the equivalent calls.
+  const PhiloxRandom::ResultType next = sequential();
+  const PhiloxRandom::ResultType next_after_blocks = blocks_gen();
+  for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+    EXPECT_EQ(next[j], next_after_blocks[j]);
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
@@ -24,8 +24,10 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #include "tensorflow/stream_executor/cuda/cuda_activation.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
 #elif TENSORFLOW_USE_ROCM
 #include "tensorflow/core/platform/rocm.h"
 #endif
@@ -144,6 +146,40 @@ void StringToNcclUniqueId(const string& str_id, ncclUniqueId* nccl_id) {
   }
 }
 
+#if GOOGLE_CUDA
+// Returns true unless TF_NCCL_HIGH_PRIORITY_STREAM is set to false.
+bool UseHighPriorityStream() {
+  static const bool use_high_priority = [] {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_NCCL_HIGH_PRIORITY_STREAM",
+                                  /*default_val=*/true, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return true;
+    }
+    return value;
+  }();
+  return use_high_priority;
+}
+
+// Sets `*priority` to the highest stream priority supported by
+// `gpu_device_id`.  The communication streams run at this priority so that
+// the kernels of a collective are scheduled ahead of the compute kernels that
+// are queued when it is launched, instead of waiting behind them.
+Status GetHighestStreamPriority(int gpu_device_id, int* priority) {
+  int saved_device = 0;
+  CUDA_RETURN_IF_ERROR(cudaGetDevice(&saved_device));
+  CUDA_RETURN_IF_ERROR(cudaSetDevice(gpu_device_id));
+  int priority_low, priority_high;
+  const cudaError_t err =
+      cudaDeviceGetStreamPriorityRange(&priority_low, &priority_high);
+  CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
+  CUDA_RETURN_IF_ERROR(err);
+  *priority = priority_high;
+  return Status::OK();
+}
+#endif
+
 }  // namespace
 
 // A `Collective` encapsulates state for a collective instance at one node.
@@ -353,12 +389,21 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
       }
     }
     if (nccl_stream == nullptr) {
+#if GOOGLE_CUDA
+      int priority = 0;
+      if (UseHighPriorityStream()) {
+        TF_RETURN_IF_ERROR(GetHighestStreamPriority(
+            collective->participants[i]->gpu_device_id, &priority));
+      }
+#endif
       nccl_stream = new NcclStream();
       nccl_stream->executor = executor;
 #if TENSORFLOW_USE_ROCM
       nccl_stream->stream = collective->participants[i]->context->nccl_stream();
 #else
       nccl_stream->stream.reset(new se::Stream(executor));
+      static_cast<se::gpu::GpuStream*>(nccl_stream->stream->implementation())
+          ->SetPriority(priority);
       nccl_stream->stream->Init();
 #endif
 
@@ -54,6 +54,19 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If 'latency_target_micros' is positive, the batch size (up to
+    // 'max_batch_size') and timeout are tuned online to keep the 99th
+    // percentile latency under it, and 'batch_timeout_micros' is ignored.
+    .Attr("latency_target_micros: int = 0")
+    // If 'ragged_batching' is true, the inputs of the tasks in a batch are
+    // concatenated without padding, and 'f' is called with an extra int64
+    // row_splits argument after 'in_tensors'. Inputs are grouped by length
+    // into the buckets delimited by 'ragged_length_buckets'.
+    .Attr("ragged_batching: bool = false")
+    .Attr("ragged_length_buckets: list(int) = []")
+    // Inputs of 'low' priority are only batched into the room left by inputs
+    // of 'high' priority in the same queue.
+    .Attr("priority: {'high', 'low'} = 'high'")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape);
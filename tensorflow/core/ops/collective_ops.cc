@@ -32,6 +32,7 @@ REGISTER_OP("CollectiveReduce")
     .Attr("wait_for: list(int) = []")
     .Attr("communication_hint: string = 'auto'")
     .Attr("timeout_seconds: float = 0")
+    .Attr("wire_dtype: {float, half, bfloat16} = DT_FLOAT")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnchangedShape);
 
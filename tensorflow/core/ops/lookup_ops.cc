@@ -515,4 +515,106 @@ REGISTER_OP("InitializeTableFromDataset")
       return Status::OK();
     });
 
+REGISTER_OP("AnnIndexHandleOp")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("dim: int >= 1")
+    .Attr("num_lists: int >= 1")
+    .Attr("num_subspaces: int >= 1")
+    .Attr("num_codes: int >= 1 = 256")
+    .Attr("num_iterations: int >= 0 = 10")
+    .Attr("max_training_vectors: int >= 1 = 65536")
+    .Attr("seed: int = 0")
+    .Output("index: resource")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("AnnIndexBuild")
+    .Input("index: resource")
+    .Input("vectors: float")
+    .Input("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle vectors;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &vectors));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &ids));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(vectors, 0), c->Dim(ids, 0), &unused_dim));
+      return Status::OK();
+    });
+
+REGISTER_OP("AnnIndexSearch")
+    .Input("index: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("nprobe: int32")
+    .Output("distances: float")
+    .Output("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &handle));
+      ShapeHandle out = c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, out);
+      c->set_output(1, out);
+      return Status::OK();
+    });
+
+REGISTER_OP("AnnIndexSize")
+    .Input("index: resource")
+    .Output("size: int64")
+    .SetShapeFn(ScalarAndTwoElementVectorInputsAndScalarOutputs);
+
+REGISTER_OP("AnnIndexExport")
+    .Input("index: resource")
+    .Output("centroids: float")
+    .Output("codebooks: float")
+    .Output("list_ids: int32")
+    .Output("ids: int64")
+    .Output("codes: uint8")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      c->set_output(0, c->Matrix(InferenceContext::kUnknownDim,
+                                 InferenceContext::kUnknownDim));
+      c->set_output(1, c->UnknownShapeOfRank(3));
+      DimensionHandle size = c->UnknownDim();
+      c->set_output(2, c->Vector(size));
+      c->set_output(3, c->Vector(size));
+      c->set_output(4, c->Matrix(size, InferenceContext::kUnknownDim));
+      return Status::OK();
+    });
+
+REGISTER_OP("AnnIndexImport")
+    .Input("index: resource")
+    .Input("centroids: float")
+    .Input("codebooks: float")
+    .Input("list_ids: int32")
+    .Input("ids: int64")
+    .Input("codes: uint8")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 3, &unused));
+      ShapeHandle list_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &list_ids));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &ids));
+      ShapeHandle codes;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(5), 2, &codes));
+      DimensionHandle size;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(list_ids, 0), c->Dim(ids, 0), &size));
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(codes, 0), size, &size));
+      return Status::OK();
+    });
+
 }  // namespace tensorflow
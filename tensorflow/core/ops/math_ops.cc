@@ -984,6 +984,30 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwiseChain")
+    .Input("x: T")
+    .Output("y: T")
+    .Attr("T: {half, float, double}")
+    .Attr("fused_ops: list(string) >= 1")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of unary element-wise ops to `x`.
+
+The ops are specified by the `fused_ops` attribute, which is a list of TF op
+names (e.g. ["Exp", "Relu"]). They are applied in order, where the input to each
+op is the output of the preceding op. On CPU, the chain is applied to one
+cache-sized block of `x` at a time, and on GPU (where at most 16 ops can be
+fused) every element goes through the whole chain in one kernel, so
+intermediate results never go to main memory.
+
+Currently supported fused_ops are: "Ceil", "Cos", "Exp", "Expm1", "Floor",
+"Inv", "Log", "Log1p", "Neg", "Reciprocal", "Relu", "Rsqrt", "Sigmoid", "Sign",
+"Sin", "Sqrt", "Square" and "Tanh".
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
@@ -1407,6 +1431,60 @@ REGISTER_OP("SparseSegmentSqrtNGrad")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradShapeFn);
 
+REGISTER_OP("EmbeddingLookupSparse")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("weights: T")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &params));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      ShapeHandle segment_ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids));
+      TF_RETURN_IF_ERROR(c->Merge(ids, segment_ids, &unused));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(params, 0, c->UnknownDim(), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    });
+
+REGISTER_OP("EmbeddingLookupSparseGrad")
+    .Input("grad: T")
+    .Input("params: T")
+    .Input("ids: Tidx")
+    .Input("weights: T")
+    .Input("segment_ids: Tsegmentids")
+    .Input("output: T")
+    .Output("params_grad: T")
+    .Output("weights_grad: T")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'mean'")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle params;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &params));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &ids));
+      ShapeHandle weights;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &weights));
+      ShapeHandle params_grad;
+      TF_RETURN_IF_ERROR(
+          c->ReplaceDim(params, 0, c->Dim(ids, 0), &params_grad));
+      c->set_output(0, params_grad);
+      c->set_output(1, weights);
+      return Status::OK();
+    });
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
@@ -3298,6 +3298,29 @@ REGISTER_OP("QuantizedMatMulWithBiasAndRequantize")
       return Status::OK();
     });
 
+REGISTER_OP("QuantizedMatMulPerChannel")
+    .Input("a: qint8")
+    .Input("b: qint8")
+    .Input("bias: float")
+    .Input("min_a: float")
+    .Input("max_a: float")
+    .Input("min_b: float")
+    .Input("max_b: float")
+    .Output("out: float")
+    .Attr("transpose_a: bool = false")
+    .Attr("transpose_b: bool = false")
+    .Attr("fused_ops: list(string) = ['BiasAdd']")
+    .SetShapeFn([](InferenceContext* c) {
+      TF_RETURN_IF_ERROR(shape_inference::MatMulShape(c));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(5), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRankAtMost(c->input(6), 1, &unused));
+      return Status::OK();
+    });
+
 REGISTER_OP("QuantizedConv2DPerChannel")
     .Input("input: Tinput")
     .Input("filter: Tfilter")
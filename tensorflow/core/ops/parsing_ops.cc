@@ -224,6 +224,40 @@ REGISTER_OP("ParseExampleV2")
       return Status::OK();
     });
 
+REGISTER_OP("ParseExampleFeatureIds")
+    .Input("serialized: string")
+    .Output("indices: num_outputs * int64")
+    .Output("ids: num_outputs * int64")
+    .Output("weights: num_outputs * float")
+    .Output("dense_shapes: num_outputs * int64")
+    .Attr("num_outputs: int >= 1")
+    .Attr("feature_keys: list(string) >= 0")
+    .Attr("feature_transforms: list(string) >= 0")
+    .Attr("num_buckets: list(int) >= 0")
+    .Attr("boundaries: list(float) = []")
+    .Attr("cross_sizes: list(int) = []")
+    .Attr("cross_features: list(int) = []")
+    .Attr("cross_num_buckets: list(int) = []")
+    .Attr("hash_key: int = 956888297470")
+    .Attr("fill_empty_rows: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      int num_outputs;
+      TF_RETURN_IF_ERROR(c->GetAttr("num_outputs", &num_outputs));
+      int output_idx = 0;
+      for (int i = 0; i < num_outputs; ++i) {  // indices
+        c->set_output(output_idx++, c->Matrix(c->UnknownDim(), 2));
+      }
+      for (int i = 0; i < 2 * num_outputs; ++i) {  // ids and weights
+        c->set_output(output_idx++, c->Vector(c->UnknownDim()));
+      }
+      for (int i = 0; i < num_outputs; ++i) {  // dense_shapes
+        c->set_output(output_idx++, c->Vector(2));
+      }
+      return Status::OK();
+    });
+
 REGISTER_OP("ParseSingleExample")
     .Input("serialized: string")
     .Input("dense_defaults: Tdense")
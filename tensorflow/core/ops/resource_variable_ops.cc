@@ -21,6 +21,7 @@
 #include "tensorflow/core/framework/shape_inference.h"
 #include "tensorflow/core/lib/core/errors.h"
 
+using ::tensorflow::shape_inference::DimensionHandle;
 using ::tensorflow::shape_inference::InferenceContext;
 using ::tensorflow::shape_inference::ShapeAndType;
 using ::tensorflow::shape_inference::ShapeHandle;
@@ -293,6 +294,18 @@ REGISTER_OP("ResourceGather")
       return Status::OK();
     });
 
+REGISTER_OP("ResourceGatherPrefetch")
+    .Input("resource: resource")
+    .Input("indices: Tindices")
+    .Attr("Tindices: {int32,int64}")
+    .SetShapeFn([](InferenceContext* c) {
+      std::vector<ShapeAndType> handle_shape_and_type;
+      TF_RETURN_IF_ERROR(shape_inference::ValidateVariableResourceHandle(
+          c, &handle_shape_and_type));
+      ShapeHandle unused;
+      return c->WithRankAtLeast(handle_shape_and_type[0].shape, 1, &unused);
+    });
+
 REGISTER_OP("ResourceGatherNd")
     .Input("resource: resource")
     .Input("indices: Tindices")
@@ -393,6 +406,103 @@ REGISTER_OP("ResourceScatterUpdate")
     .Attr("Tindices: {int32, int64}")
     .SetShapeFn(ResourceScatterUpdateShape);
 
+REGISTER_OP("DynamicEmbeddingHandleOp")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("dtype: {half, float, double}")
+    .Attr("embedding_dim: int >= 1")
+    .Attr("initial_value: float = 0")
+    .Attr("initial_stddev: float = 0")
+    .Attr("seed: int = 0")
+    .Attr("min_frequency: int >= 1 = 1")
+    .Attr("max_rows: int >= 0 = 0")
+    .Attr("eviction_policy: {'lru', 'lfu'} = 'lru'")
+    .Output("resource: resource")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("DynamicEmbeddingLookup")
+    .Input("resource: resource")
+    .Input("ids: int64")
+    .Attr("dtype: {half, float, double}")
+    .Attr("embedding_dim: int >= 1")
+    .Output("values: dtype")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      int64 embedding_dim;
+      TF_RETURN_IF_ERROR(c->GetAttr("embedding_dim", &embedding_dim));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(c->input(1), c->Vector(embedding_dim), &out));
+      c->set_output(0, out);
+      return Status::OK();
+    });
+
+REGISTER_OP("DynamicEmbeddingSparseApplyAdagrad")
+    .Input("var: resource")
+    .Input("accum: resource")
+    .Input("lr: T")
+    .Input("grad: T")
+    .Input("indices: int64")
+    .Attr("T: {half, float, double}")
+    .Attr("use_locking: bool = false")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &unused));
+      ShapeHandle indices;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(4), 1, &indices));
+      ShapeHandle grad;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 2, &grad));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(grad, 0), c->Dim(indices, 0), &unused_dim));
+      return Status::OK();
+    });
+
+REGISTER_OP("DynamicEmbeddingSize")
+    .Input("resource: resource")
+    .Attr("dtype: {half, float, double}")
+    .Output("size: int64")
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("DynamicEmbeddingExport")
+    .Input("resource: resource")
+    .Attr("dtype: {half, float, double}")
+    .Attr("embedding_dim: int >= 1")
+    .Output("ids: int64")
+    .Output("values: dtype")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      int64 embedding_dim;
+      TF_RETURN_IF_ERROR(c->GetAttr("embedding_dim", &embedding_dim));
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(1, c->Matrix(InferenceContext::kUnknownDim, embedding_dim));
+      return Status::OK();
+    });
+
+REGISTER_OP("DynamicEmbeddingImport")
+    .Input("resource: resource")
+    .Input("ids: int64")
+    .Input("values: dtype")
+    .Attr("dtype: {half, float, double}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &unused));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &values));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(values, 0), c->Dim(ids, 0), &unused_dim));
+      return Status::OK();
+    });
+
 REGISTER_OP("MutexV2")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
@@ -70,6 +70,29 @@ static Status HandleGradAndIndicesInputs(InferenceContext* c, int grad_idx,
   return Status::OK();
 }
 
+// Shape function for the grouped apply ops, whose inputs are "num_lists"
+// lists of N resource variables, "num_scalars" scalars and a list of N
+// gradients.
+static Status ApplyGroupShapeFn(InferenceContext* c, int num_lists,
+                                int num_scalars) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 0; i < num_scalars; ++i) {
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(num_lists * n + i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);
+    for (int l = 1; l < num_lists; ++l) {
+      TF_RETURN_IF_ERROR(c->Merge(
+          s, ShapeOrHandleShape</*is_resource=*/true>(c, l * n + i), &s));
+    }
+    TF_RETURN_IF_ERROR(
+        c->Merge(s, c->input(num_lists * n + num_scalars + i), &s));
+  }
+  return Status::OK();
+}
+
 template <bool is_resource>
 static Status ApplyGradientDescentShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -277,6 +300,19 @@ REGISTER_OP("ResourceApplyAdagrad")
     .Attr("update_slots: bool = true")
     .SetShapeFn(ApplyAdagradShapeFn</*is_sparse=*/false, /*is_resource=*/true>);
 
+REGISTER_OP("ResourceApplyAdagradGroup")
+    .Input("var: N * resource")
+    .Input("accum: N * resource")
+    .Input("lr: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("update_slots: bool = true")
+    .SetShapeFn([](InferenceContext* c) {
+      return ApplyGroupShapeFn(c, 2 /* num_lists */, 1 /* num_scalars */);
+    });
+
 REGISTER_OP("SparseApplyAdagrad")
     .Input("var: Ref(T)")
     .Input("accum: Ref(T)")
@@ -300,6 +336,7 @@ REGISTER_OP("ResourceSparseApplyAdagrad")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
     .Attr("update_slots: bool = true")
+    .Attr("use_row_locking: bool = false")
     .SetShapeFn(ApplyAdagradShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
 template <bool is_sparse, bool is_resource>
@@ -369,6 +406,7 @@ REGISTER_OP("ResourceSparseApplyAdagradV2")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
     .Attr("update_slots: bool = true")
+    .Attr("use_row_locking: bool = false")
     .SetShapeFn(
         ApplyAdagradV2ShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
@@ -826,6 +864,25 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+REGISTER_OP("ResourceApplyAdamGroup")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn([](InferenceContext* c) {
+      return ApplyGroupShapeFn(c, 3 /* num_lists */, 6 /* num_scalars */);
+    });
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cloud/curl_http_request.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/util/env_var.h"
 
 #define CHECK_CURL_OK(expr) CHECK_EQ(expr, CURLE_OK)
+#define CHECK_CURLSH_OK(expr) CHECK_EQ(expr, CURLSHE_OK)
 
 namespace tensorflow {
 
@@ -114,13 +116,88 @@ class LibCurlProxy : public LibCurl {
   }
 
   void curl_free(void* p) override { ::curl_free(p); }
+
+  CURLSH* curl_share_init() override { return ::curl_share_init(); }
+
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               uint64 param) override {
+    return ::curl_share_setopt(share, option, param);
+  }
+
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void* param) override {
+    return ::curl_share_setopt(share, option, param);
+  }
+
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void (*param)(CURL*, curl_lock_data,
+                                             curl_lock_access,
+                                             void*)) override {
+    return ::curl_share_setopt(share, option, param);
+  }
+
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void (*param)(CURL*, curl_lock_data,
+                                             void*)) override {
+    return ::curl_share_setopt(share, option, param);
+  }
+
+  CURLSHcode curl_share_cleanup(CURLSH* share) override {
+    return ::curl_share_cleanup(share);
+  }
 };
 }  // namespace
 
+CurlConnectionPool::CurlConnectionPool(LibCurl* libcurl) : libcurl_(libcurl) {
+  share_ = libcurl_->curl_share_init();
+  CHECK(share_ != nullptr) << "Couldn't initialize a curl share.";
+  CHECK_CURLSH_OK(libcurl_->curl_share_setopt(share_, CURLSHOPT_LOCKFUNC,
+                                              &CurlConnectionPool::Lock));
+  CHECK_CURLSH_OK(libcurl_->curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC,
+                                              &CurlConnectionPool::Unlock));
+  CHECK_CURLSH_OK(libcurl_->curl_share_setopt(share_, CURLSHOPT_USERDATA,
+                                              reinterpret_cast<void*>(this)));
+  for (const curl_lock_data data :
+       {CURL_LOCK_DATA_CONNECT, CURL_LOCK_DATA_SSL_SESSION,
+        CURL_LOCK_DATA_DNS}) {
+    CHECK_CURLSH_OK(libcurl_->curl_share_setopt(share_, CURLSHOPT_SHARE,
+                                                static_cast<uint64>(data)));
+  }
+}
+
+CurlConnectionPool::~CurlConnectionPool() {
+  if (share_) {
+    CHECK_CURLSH_OK(libcurl_->curl_share_cleanup(share_));
+  }
+}
+
+void CurlConnectionPool::Lock(CURL* handle, curl_lock_data data,
+                              curl_lock_access access, void* this_object) {
+  static_cast<CurlConnectionPool*>(this_object)->locks_[data].lock();
+}
+
+void CurlConnectionPool::Unlock(CURL* handle, curl_lock_data data,
+                                void* this_object) {
+  static_cast<CurlConnectionPool*>(this_object)->locks_[data].unlock();
+}
+
+CurlHttpRequest::Factory::Factory()
+    : connection_pool_(
+          std::make_shared<CurlConnectionPool>(LibCurlProxy::Load())) {}
+
+HttpRequest* CurlHttpRequest::Factory::Create() {
+  return new CurlHttpRequest(LibCurlProxy::Load(), Env::Default(),
+                             connection_pool_);
+}
+
 CurlHttpRequest::CurlHttpRequest() : CurlHttpRequest(LibCurlProxy::Load()) {}
 
-CurlHttpRequest::CurlHttpRequest(LibCurl* libcurl, Env* env)
-    : libcurl_(libcurl), env_(env) {
+CurlHttpRequest::CurlHttpRequest(
+    LibCurl* libcurl, Env* env,
+    std::shared_ptr<CurlConnectionPool> connection_pool)
+    : libcurl_(libcurl),
+      env_(env),
+      connection_pool_(std::move(connection_pool)) {
   default_response_buffer_.reserve(CURL_MAX_WRITE_SIZE);
 
   curl_ = libcurl_->curl_easy_init();
@@ -144,9 +221,20 @@ CurlHttpRequest::CurlHttpRequest(LibCurl* libcurl, Env* env)
   // Do not use signals for timeouts - does not work in multi-threaded programs.
   CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L));
 
-  // TODO(b/74351157): Enable HTTP/2.
-  CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
-                                           CURL_HTTP_VERSION_1_1));
+  if (connection_pool_) {
+    CHECK_CURL_OK(libcurl_->curl_easy_setopt(
+        curl_, CURLOPT_SHARE,
+        reinterpret_cast<void*>(connection_pool_->share())));
+  }
+  // Requests on a pool negotiate HTTP/2 over TLS with the server, and fall
+  // back to HTTP/1.1 if libcurl was built without HTTP/2 support.
+  // TODO(b/74351157): Enable HTTP/2 for all requests.
+  if (!connection_pool_ ||
+      libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
+                                 CURL_HTTP_VERSION_2TLS) != CURLE_OK) {
+    CHECK_CURL_OK(libcurl_->curl_easy_setopt(curl_, CURLOPT_HTTP_VERSION,
+                                             CURL_HTTP_VERSION_1_1));
+  }
 
   // Set up the progress meter.
   CHECK_CURL_OK(
@@ -451,6 +539,15 @@ Status CurlHttpRequest::Send() {
   const CURLcode curl_result = libcurl_->curl_easy_perform(curl_);
   TF_RETURN_IF_ERROR(CURLcodeToStatus(curl_result, error_buffer));
 
+  if (stats_ != nullptr) {
+    // libcurl counts the connections it had to open for the transfer.
+    uint64 num_connects = 0;
+    if (libcurl_->curl_easy_getinfo(curl_, CURLINFO_NUM_CONNECTS,
+                                    &num_connects) == CURLE_OK) {
+      stats_->RecordConnection(this, /*reused=*/num_connects == 0);
+    }
+  }
+
   double written_size = 0;
   CHECK_CURL_OK(libcurl_->curl_easy_getinfo(curl_, CURLINFO_SIZE_DOWNLOAD,
                                             &written_size));
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_CURL_HTTP_REQUEST_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_CURL_HTTP_REQUEST_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -25,15 +26,49 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
 
 class LibCurl;  // libcurl interface as a class, for dependency injection.
 
+/// \brief Connections, TLS sessions and DNS entries shared between requests.
+///
+/// libcurl keeps the connections that a handle opened in that handle, so
+/// without sharing, every request connects and negotiates TLS from scratch.
+/// Requests attached to the same pool take an idle connection to the same host
+/// from a common cache instead, and the new connections they open resume
+/// earlier TLS sessions.
+///
+/// The pool is thread-safe, and must outlive the requests attached to it.
+class CurlConnectionPool {
+ public:
+  explicit CurlConnectionPool(LibCurl* libcurl);
+  ~CurlConnectionPool();
+
+  /// Returns the libcurl share handle to attach requests to.
+  CURLSH* share() const { return share_; }
+
+ private:
+  /// Lock callbacks in the form which can be accepted by libcurl.
+  static void Lock(CURL* handle, curl_lock_data data, curl_lock_access access,
+                   void* this_object) TF_NO_THREAD_SAFETY_ANALYSIS;
+  static void Unlock(CURL* handle, curl_lock_data data,
+                     void* this_object) TF_NO_THREAD_SAFETY_ANALYSIS;
+
+  LibCurl* libcurl_;
+  CURLSH* share_ = nullptr;
+  // One lock for every kind of data that libcurl may share.
+  mutex locks_[CURL_LOCK_DATA_LAST];
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CurlConnectionPool);
+};
+
 /// \brief A basic HTTP client based on the libcurl library.
 ///
 /// The usage pattern for the class reflects the one of the libcurl library:
@@ -46,16 +81,28 @@ class LibCurl;  // libcurl interface as a class, for dependency injection.
 ///   request->Send();
 class CurlHttpRequest : public HttpRequest {
  public:
+  /// Creates requests that share one `CurlConnectionPool`.
   class Factory : public HttpRequest::Factory {
    public:
+    Factory();
     virtual ~Factory() {}
-    virtual HttpRequest* Create() { return new CurlHttpRequest(); }
+    virtual HttpRequest* Create();
+
+   private:
+    const std::shared_ptr<CurlConnectionPool> connection_pool_;
   };
 
   CurlHttpRequest();
   explicit CurlHttpRequest(LibCurl* libcurl)
       : CurlHttpRequest(libcurl, Env::Default()) {}
-  CurlHttpRequest(LibCurl* libcurl, Env* env);
+  CurlHttpRequest(LibCurl* libcurl, Env* env)
+      : CurlHttpRequest(libcurl, env, nullptr) {}
+  /// \brief Creates a request that uses the connections of `connection_pool`,
+  /// if not null.
+  ///
+  /// Requests on a pool prefer HTTP/2 when the server and libcurl support it.
+  CurlHttpRequest(LibCurl* libcurl, Env* env,
+                  std::shared_ptr<CurlConnectionPool> connection_pool);
   ~CurlHttpRequest() override;
 
   /// Sets the request URI.
@@ -174,6 +221,8 @@ class CurlHttpRequest : public HttpRequest {
 
   LibCurl* libcurl_;
   Env* env_;
+  // The pool of `curl_`, if any, which must outlive it.
+  std::shared_ptr<CurlConnectionPool> connection_pool_;
 
   FILE* put_body_ = nullptr;
 
@@ -267,6 +316,20 @@ class LibCurl {
   virtual void curl_slist_free_all(curl_slist* list) = 0;
   virtual char* curl_easy_escape(CURL* curl, const char* str, int length) = 0;
   virtual void curl_free(void* p) = 0;
+  virtual CURLSH* curl_share_init() = 0;
+  virtual CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                                       uint64 param) TF_MUST_USE_RESULT = 0;
+  virtual CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                                       void* param) TF_MUST_USE_RESULT = 0;
+  virtual CURLSHcode curl_share_setopt(
+      CURLSH* share, CURLSHoption option,
+      void (*param)(CURL* handle, curl_lock_data data, curl_lock_access access,
+                    void* userptr)) TF_MUST_USE_RESULT = 0;
+  virtual CURLSHcode curl_share_setopt(
+      CURLSH* share, CURLSHoption option,
+      void (*param)(CURL* handle, curl_lock_data data,
+                    void* userptr)) TF_MUST_USE_RESULT = 0;
+  virtual CURLSHcode curl_share_cleanup(CURLSH* share) = 0;
 };
 
 }  // namespace tensorflow
@@ -67,6 +67,12 @@ class FakeLibCurl : public LibCurl {
       case CURLOPT_PUT:
         is_put_ = param;
         break;
+      case CURLOPT_HTTP_VERSION:
+        if (param >= CURL_HTTP_VERSION_2 && !supports_http2_) {
+          return CURLE_UNSUPPORTED_PROTOCOL;
+        }
+        http_version_ = param;
+        break;
       default:
         break;
     }
@@ -110,6 +116,9 @@ class FakeLibCurl : public LibCurl {
       case CURLOPT_XFERINFODATA:
         progress_data_ = param;
         break;
+      case CURLOPT_SHARE:
+        share_ = reinterpret_cast<CURLSH*>(param);
+        break;
       default:
         break;
     }
@@ -183,6 +192,9 @@ class FakeLibCurl : public LibCurl {
       case CURLINFO_RESPONSE_CODE:
         *value = response_code_;
         break;
+      case CURLINFO_NUM_CONNECTS:
+        *value = num_connects_;
+        break;
       default:
         break;
     }
@@ -228,11 +240,48 @@ class FakeLibCurl : public LibCurl {
     delete reinterpret_cast<std::vector<string>*>(list);
   }
   void curl_free(void* p) override { port::Free(p); }
+  CURLSH* curl_share_init() override {
+    // The result just needs to be non-null.
+    return reinterpret_cast<CURLSH*>(&shared_data_);
+  }
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               uint64 param) override {
+    if (option == CURLSHOPT_SHARE) {
+      shared_data_.push_back(static_cast<curl_lock_data>(param));
+    }
+    return CURLSHE_OK;
+  }
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void* param) override {
+    if (option == CURLSHOPT_USERDATA) {
+      share_user_data_ = param;
+    }
+    return CURLSHE_OK;
+  }
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void (*param)(CURL*, curl_lock_data,
+                                             curl_lock_access,
+                                             void*)) override {
+    lock_function_ = param;
+    return CURLSHE_OK;
+  }
+  CURLSHcode curl_share_setopt(CURLSH* share, CURLSHoption option,
+                               void (*param)(CURL*, curl_lock_data,
+                                             void*)) override {
+    unlock_function_ = param;
+    return CURLSHE_OK;
+  }
+  CURLSHcode curl_share_cleanup(CURLSH* share) override {
+    is_share_cleaned_up_ = true;
+    return CURLSHE_OK;
+  }
 
   // Variables defining the behavior of this fake.
   string response_content_;
   uint64 response_code_;
   std::vector<string> response_headers_;
+  uint64 num_connects_ = 1;
+  bool supports_http2_ = true;
 
   // Internal variables to store the libcurl state.
   string url_;
@@ -257,6 +306,15 @@ class FakeLibCurl : public LibCurl {
   int (*progress_callback_)(void* clientp, curl_off_t dltotal, curl_off_t dlnow,
                             curl_off_t ultotal, curl_off_t ulnow) = nullptr;
   void* progress_data_ = nullptr;
+  uint64 http_version_ = CURL_HTTP_VERSION_NONE;
+  CURLSH* share_ = nullptr;
+  std::vector<curl_lock_data> shared_data_;
+  void* share_user_data_ = nullptr;
+  void (*lock_function_)(CURL* handle, curl_lock_data data,
+                         curl_lock_access access, void* userptr) = nullptr;
+  void (*unlock_function_)(CURL* handle, curl_lock_data data,
+                           void* userptr) = nullptr;
+  bool is_share_cleaned_up_ = false;
   // Outcome of performing the request.
   string posted_content_;
   CURLcode curl_easy_perform_result_ = CURLE_OK;
@@ -777,6 +835,11 @@ class TestStats : public HttpRequest::RequestStats {
     record_response_result_ = result;
   }
 
+  void RecordConnection(const HttpRequest* request, bool reused) override {
+    ++num_recorded_connections_;
+    if (reused) ++num_reused_connections_;
+  }
+
   const HttpRequest* record_request_request_ = nullptr;
   string record_request_uri_ = "http://www.testuri.com";
   HttpRequest::RequestMethod record_request_method_ =
@@ -790,6 +853,8 @@ class TestStats : public HttpRequest::RequestStats {
 
   bool has_recorded_request_ = false;
   bool has_recorded_response_ = false;
+  int num_recorded_connections_ = 0;
+  int num_reused_connections_ = 0;
 };
 
 class StatsTestFakeLibCurl : public FakeLibCurl {
@@ -958,5 +1023,67 @@ TEST(CurlHttpRequestTest, StatsPut) {
   TF_EXPECT_OK(stats.record_response_result_);
 }
 
+TEST(CurlHttpRequestTest, StatsConnectionReuse) {
+  TestStats stats;
+  for (const uint64 num_connects : {1, 0, 0}) {
+    FakeLibCurl libcurl("get response", 200);
+    libcurl.num_connects_ = num_connects;
+    CurlHttpRequest http_request(&libcurl);
+    http_request.SetRequestStats(&stats);
+    http_request.SetUri("http://www.testuri.com");
+    TF_EXPECT_OK(http_request.Send());
+  }
+  EXPECT_EQ(3, stats.num_recorded_connections_);
+  EXPECT_EQ(2, stats.num_reused_connections_);
+}
+
+TEST(CurlHttpRequestTest, ConnectionPool) {
+  FakeLibCurl libcurl("get response", 200);
+  {
+    auto connection_pool = std::make_shared<CurlConnectionPool>(&libcurl);
+    EXPECT_EQ(std::vector<curl_lock_data>({CURL_LOCK_DATA_CONNECT,
+                                           CURL_LOCK_DATA_SSL_SESSION,
+                                           CURL_LOCK_DATA_DNS}),
+              libcurl.shared_data_);
+    ASSERT_NE(nullptr, libcurl.lock_function_);
+    ASSERT_NE(nullptr, libcurl.unlock_function_);
+    // The lock callbacks guard the shared data.
+    libcurl.lock_function_(nullptr, CURL_LOCK_DATA_CONNECT,
+                           CURL_LOCK_ACCESS_SINGLE, libcurl.share_user_data_);
+    libcurl.unlock_function_(nullptr, CURL_LOCK_DATA_CONNECT,
+                             libcurl.share_user_data_);
+
+    CurlHttpRequest http_request(&libcurl, Env::Default(), connection_pool);
+    connection_pool.reset();
+    http_request.SetUri("http://www.testuri.com");
+    TF_EXPECT_OK(http_request.Send());
+    EXPECT_EQ(reinterpret_cast<CURLSH*>(&libcurl.shared_data_),
+              libcurl.share_);
+    EXPECT_EQ(CURL_HTTP_VERSION_2TLS, libcurl.http_version_);
+    // The pool outlives the requests attached to it.
+    EXPECT_FALSE(libcurl.is_share_cleaned_up_);
+  }
+  EXPECT_TRUE(libcurl.is_share_cleaned_up_);
+}
+
+TEST(CurlHttpRequestTest, ConnectionPoolWithoutHttp2) {
+  FakeLibCurl libcurl("get response", 200);
+  libcurl.supports_http2_ = false;
+  CurlHttpRequest http_request(&libcurl, Env::Default(),
+                               std::make_shared<CurlConnectionPool>(&libcurl));
+  http_request.SetUri("http://www.testuri.com");
+  TF_EXPECT_OK(http_request.Send());
+  EXPECT_EQ(CURL_HTTP_VERSION_1_1, libcurl.http_version_);
+}
+
+TEST(CurlHttpRequestTest, NoConnectionPool) {
+  FakeLibCurl libcurl("get response", 200);
+  CurlHttpRequest http_request(&libcurl);
+  http_request.SetUri("http://www.testuri.com");
+  TF_EXPECT_OK(http_request.Send());
+  EXPECT_EQ(nullptr, libcurl.share_);
+  EXPECT_EQ(CURL_HTTP_VERSION_1_1, libcurl.http_version_);
+}
+
 }  // namespace
 }  // namespace tensorflow
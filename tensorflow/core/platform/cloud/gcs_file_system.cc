@@ -23,6 +23,7 @@ limitations under the License.
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/platform/strcat.h"
@@ -47,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 #ifdef _WIN32
 #ifdef DeleteFile
@@ -141,6 +143,21 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // objects.
 constexpr char kComposeAppend[] = "compose";
 
+// The environment variable that makes writable files upload their content in
+// parts of this many MB as it is written (format: <int64>). The parts are
+// uploaded in parallel as temporary objects and composed into the file on
+// Flush() and Close(). Disabled (0) by default, which uploads the whole file
+// on Flush() and Close().
+constexpr char kParallelUploadPartSize[] = "GCS_PARALLEL_UPLOAD_PART_SIZE_MB";
+// The environment variable that controls how many parts are uploaded at once
+// (format: <int>). Every writable file buffers at most this many parts plus
+// one in memory.
+constexpr char kParallelUploadMaxConcurrency[] =
+    "GCS_PARALLEL_UPLOAD_MAX_CONCURRENCY";
+constexpr int kDefaultParallelUploadMaxConcurrency = 4;
+// The maximum number of source objects of a GCS compose request.
+constexpr size_t kMaxComposeSources = 32;
+
 Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
   return Status::OK();
@@ -752,6 +769,317 @@ class GcsWritableFile : public WritableFile {
   uint64 start_offset_;
 };
 
+/// \brief GCS-based implementation of a writeable file that uploads its
+/// content in parts while it is written.
+///
+/// Every `part_size` bytes appended are uploaded as a temporary object on
+/// `upload_pool`, and Append() waits while `max_concurrency` parts of the file
+/// are being uploaded, so that at most `max_concurrency + 1` parts are held in
+/// memory. Sync() uploads the rest of the content and composes the parts,
+/// after the content synced before, into the object.
+class GcsParallelWritableFile : public WritableFile {
+ public:
+  GcsParallelWritableFile(const string& bucket, const string& object,
+                          GcsFileSystem* filesystem,
+                          GcsFileSystem::TimeoutConfig* timeouts,
+                          std::function<void()> file_cache_erase,
+                          RetryConfig retry_config, size_t part_size,
+                          int max_concurrency, thread::ThreadPool* upload_pool)
+      : bucket_(bucket),
+        object_(object),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        retry_config_(retry_config),
+        part_size_(part_size),
+        max_concurrency_(max_concurrency),
+        upload_pool_(upload_pool) {
+    VLOG(3) << "GcsParallelWritableFile: " << GetGcsPath();
+  }
+
+  ~GcsParallelWritableFile() override {
+    if (!Close().ok()) {
+      {
+        mutex_lock l(mu_);
+        WaitForUploads(&l);
+      }
+      // Do not strand the parts that were not composed into the object.
+      for (const string& name : pending_parts_) {
+        filesystem_->DeleteFile(GetGcsPathWithObject(name)).IgnoreError();
+      }
+    }
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    VLOG(3) << "Append: " << GetGcsPath() << " size " << data.length();
+    sync_needed_ = true;
+    while (!data.empty()) {
+      if (buffer_.size() == part_size_) {
+        TF_RETURN_IF_ERROR(UploadBuffer());
+      }
+      const size_t n = std::min(data.size(), part_size_ - buffer_.size());
+      buffer_.append(data.data(), n);
+      data.remove_prefix(n);
+      size_ += n;
+    }
+    if (buffer_.size() == part_size_) {
+      return UploadBuffer();
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    VLOG(3) << "Close:" << GetGcsPath();
+    if (closed_) {
+      return Status::OK();
+    }
+    TF_RETURN_IF_ERROR(Sync());
+    closed_ = true;
+    mutex_lock l(mu_);
+    WaitForUploads(&l);
+    return Status::OK();
+  }
+
+  Status Flush() override {
+    VLOG(3) << "Flush:" << GetGcsPath();
+    return Sync();
+  }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented("GCSWritableFile does not support Name()");
+  }
+
+  Status Sync() override {
+    VLOG(3) << "Sync started:" << GetGcsPath();
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return Status::OK();
+    }
+    Status status = SyncImpl();
+    VLOG(3) << "Sync finished " << GetGcsPath();
+    if (status.ok()) {
+      sync_needed_ = false;
+    }
+    return status;
+  }
+
+  Status Tell(int64* position) override {
+    *position = size_;
+    return Status::OK();
+  }
+
+ private:
+  // A part of the content that is uploaded to the temporary object `name`.
+  struct Part {
+    string name;
+    std::shared_ptr<const string> data;
+  };
+
+  Status SyncImpl() {
+    std::vector<Part> failed_parts;
+    {
+      mutex_lock l(mu_);
+      WaitForUploads(&l);
+      // Upload the parts that failed again, since RetryingFileSystem retries
+      // Sync() on UNAVAILABLE errors.
+      failed_parts.swap(failed_parts_);
+      upload_status_ = Status::OK();
+    }
+    for (Part& part : failed_parts) {
+      TF_RETURN_IF_ERROR(UploadPart(std::move(part)));
+    }
+    if (!object_exists_ && pending_parts_.empty()) {
+      // The whole content fits in one part, which is uploaded as the object.
+      TF_RETURN_IF_ERROR(UploadObject(object_, buffer_));
+      buffer_.clear();
+      object_exists_ = true;
+      file_cache_erase_();
+      return Status::OK();
+    }
+    if (!buffer_.empty()) {
+      TF_RETURN_IF_ERROR(UploadBuffer());
+    }
+    {
+      mutex_lock l(mu_);
+      WaitForUploads(&l);
+      TF_RETURN_IF_ERROR(upload_status_);
+    }
+    return ComposeParts();
+  }
+
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file is closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Starts the upload of the buffered content as the next part.
+  Status UploadBuffer() {
+    Part part;
+    part.name = strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                                io::Basename(object_), ".",
+                                size_ - buffer_.size());
+    part.data = std::make_shared<const string>(std::move(buffer_));
+    buffer_.clear();
+    pending_parts_.push_back(part.name);
+    return UploadPart(std::move(part));
+  }
+
+  /// Starts the upload of `part`, once fewer than `max_concurrency_` parts
+  /// are being uploaded.
+  Status UploadPart(Part part) {
+    mutex_lock l(mu_);
+    while (num_uploads_ >= max_concurrency_ && upload_status_.ok()) {
+      uploads_cond_var_.wait(l);
+    }
+    if (!upload_status_.ok()) {
+      // Keep the part to upload it again on the next Sync().
+      failed_parts_.push_back(std::move(part));
+      return upload_status_;
+    }
+    ++num_uploads_;
+    upload_pool_->Schedule([this, part]() {
+      const Status status = UploadObject(part.name, *part.data);
+      mutex_lock l(mu_);
+      if (!status.ok()) {
+        failed_parts_.push_back(part);
+        upload_status_.Update(status);
+      }
+      --num_uploads_;
+      uploads_cond_var_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  void WaitForUploads(mutex_lock* l) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (num_uploads_ > 0) {
+      uploads_cond_var_.wait(*l);
+    }
+  }
+
+  /// Uploads `data` as the object `name` with a single request.
+  Status UploadObject(const string& name, const string& data) {
+    return RetryingUtils::CallWithRetries(
+        [&name, &data, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                          "/o?uploadType=media&name=",
+                                          request->EscapeString(name)));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->write);
+          request->SetPostFromBuffer(data.data(), data.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          GetGcsPathWithObject(name));
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
+  /// Composes the uploaded parts, in order, into the object, and deletes them.
+  ///
+  /// A compose request takes at most kMaxComposeSources objects, so the parts
+  /// are appended to the object in batches.
+  Status ComposeParts() {
+    while (!pending_parts_.empty()) {
+      std::vector<string> sources;
+      if (object_exists_) {
+        sources.push_back(object_);
+      }
+      const size_t num_parts = std::min(pending_parts_.size(),
+                                        kMaxComposeSources - sources.size());
+      sources.insert(sources.end(), pending_parts_.begin(),
+                     pending_parts_.begin() + num_parts);
+      TF_RETURN_IF_ERROR(ComposeObject(sources));
+      object_exists_ = true;
+      file_cache_erase_();
+      for (size_t i = 0; i < num_parts; ++i) {
+        const string path = GetGcsPathWithObject(pending_parts_[i]);
+        mutex_lock l(mu_);
+        ++num_uploads_;
+        upload_pool_->Schedule([this, path]() {
+          const Status status = filesystem_->DeleteFile(path);
+          if (!status.ok()) {
+            LOG(WARNING) << "Could not delete " << path << ": " << status;
+          }
+          mutex_lock l(mu_);
+          --num_uploads_;
+          uploads_cond_var_.notify_all();
+        });
+      }
+      pending_parts_.erase(pending_parts_.begin(),
+                           pending_parts_.begin() + num_parts);
+    }
+    return Status::OK();
+  }
+
+  /// Replaces the object with the concatenation of `sources`.
+  Status ComposeObject(const std::vector<string>& sources) {
+    VLOG(3) << "ComposeObject: " << sources.size() << " objects to "
+            << GetGcsPath();
+    std::vector<string> source_names;
+    for (const string& source : sources) {
+      source_names.push_back(strings::StrCat("{'name': '", source, "'}"));
+    }
+    const string request_body =
+        strings::StrCat("{'sourceObjects': [",
+                        str_util::Join(source_names, ","), "]}");
+    return RetryingUtils::CallWithRetries(
+        [&request_body, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(),
+                                     request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return Status::OK();
+        },
+        retry_config_);
+  }
+
+  string GetGcsPathWithObject(string object) const {
+    return strings::StrCat("gs://", bucket_, "/", object);
+  }
+  string GetGcsPath() const { return GetGcsPathWithObject(object_); }
+
+  const string bucket_;
+  const string object_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  const RetryConfig retry_config_;
+  const size_t part_size_;
+  const int max_concurrency_;
+  thread::ThreadPool* const upload_pool_;  // Not owned.
+
+  // The content that is not part of an upload yet.
+  string buffer_;
+  // The number of bytes appended.
+  uint64 size_ = 0;
+  // Whether the object holds the content that was synced.
+  bool object_exists_ = false;
+  bool sync_needed_ = true;
+  bool closed_ = false;
+  // The parts to compose into the object, in order.
+  std::vector<string> pending_parts_;
+
+  mutex mu_;
+  condition_variable uploads_cond_var_;
+  // The number of uploads and deletions of parts in flight.
+  int num_uploads_ TF_GUARDED_BY(mu_) = 0;
+  // The parts whose upload failed, and the first error.
+  std::vector<Part> failed_parts_ TF_GUARDED_BY(mu_);
+  Status upload_status_ TF_GUARDED_BY(mu_);
+};
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -817,12 +1145,24 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kParallelUploadPartSize, strings::safe_strtou64, &value)) {
+    int max_concurrency = kDefaultParallelUploadMaxConcurrency;
+    GetEnvVar(kParallelUploadMaxConcurrency, strings::safe_strto32,
+              &max_concurrency);
+    SetParallelUploads(value * 1024 * 1024, max_concurrency);
+  }
+
+  if (GetEnvVar(kMaxReadAheadBlocks, strings::safe_strtou64, &value)) {
+    max_read_ahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max read-ahead blocks = " << max_read_ahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -1054,7 +1394,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_read_ahead_blocks_));
   return file_block_cache;
 }
 
@@ -1148,10 +1489,30 @@ void GcsFileSystem::ClearFileCaches(const string& fname) {
   // MatchingPathsCache as well.
 }
 
+void GcsFileSystem::SetParallelUploads(size_t part_size_bytes,
+                                       int max_concurrency) {
+  parallel_upload_part_size_ = part_size_bytes;
+  parallel_upload_max_concurrency_ = std::max(max_concurrency, 1);
+  upload_pool_.reset();
+  if (parallel_upload_part_size_ > 0) {
+    upload_pool_.reset(new thread::ThreadPool(
+        Env::Default(), "gcs_parallel_upload",
+        parallel_upload_max_concurrency_));
+  }
+}
+
 Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (parallel_upload_part_size_ > 0) {
+    result->reset(new GcsParallelWritableFile(
+        bucket, object, this, &timeouts_,
+        [this, fname]() { ClearFileCaches(fname); }, retry_config_,
+        parallel_upload_part_size_, parallel_upload_max_concurrency_,
+        upload_pool_.get()));
+    return Status::OK();
+  }
   result->reset(new GcsWritableFile(
       bucket, object, this, &timeouts_,
       [this, fname]() { ClearFileCaches(fname); }, retry_config_,
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -50,6 +51,12 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that sets how many blocks past a sequential read
+// may be fetched from GCS in the background, with concurrent range requests.
+// The read-ahead starts at one block and deepens while reads have to wait for
+// blocks still being fetched. Only used when the block cache is enabled.
+constexpr char kMaxReadAheadBlocks[] = "GCS_READ_CACHE_MAX_READ_AHEAD_BLOCKS";
+constexpr size_t kDefaultMaxReadAheadBlocks = 0;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -93,7 +100,8 @@ class GcsStatsInterface {
   virtual void RecordStatObjectRequest() = 0;
 
   /// HttpStats is called to optionally provide a RequestStats listener
-  /// to be annotated on every HTTP request made to the GCS API.
+  /// to be annotated on every HTTP request made to the GCS API. The listener
+  /// is also told whether each request reused a pooled connection.
   ///
   /// HttpStats() may return nullptr.
   virtual HttpRequest::RequestStats* HttpStats() = 0;
@@ -184,6 +192,13 @@ class GcsFileSystem : public FileSystem {
     tf_shared_lock l(block_cache_lock_);
     return file_block_cache_->max_staleness();
   }
+  size_t max_read_ahead_blocks() const { return max_read_ahead_blocks_; }
+  size_t parallel_upload_part_size() const {
+    return parallel_upload_part_size_;
+  }
+  int parallel_upload_max_concurrency() const {
+    return parallel_upload_max_concurrency_;
+  }
   TimeoutConfig timeouts() const { return timeouts_; }
   std::unordered_set<string> allowed_locations() const {
     return allowed_locations_;
@@ -259,6 +274,15 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Makes new writable files upload their content in parts of
+  /// `part_size_bytes` while it is written, with up to `max_concurrency`
+  /// parts uploaded at once, and compose the parts on flush/close.
+  ///
+  /// A `part_size_bytes` of 0 makes writable files upload their whole content
+  /// on flush/close, as by default. Must not be called while writable files
+  /// are open.
+  void SetParallelUploads(size_t part_size_bytes, int max_concurrency);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -359,6 +383,9 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The most blocks that the block cache reads ahead of sequential reads.
+  size_t max_read_ahead_blocks_ = kDefaultMaxReadAheadBlocks;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -388,6 +415,13 @@ class GcsFileSystem : public FileSystem {
   // Additional header material to be transmitted with all GCS requests
   std::unique_ptr<std::pair<const string, const string>> additional_header_;
 
+  // The size of the parts that writable files upload while they are written,
+  // or 0 to upload files whole on flush/close.
+  size_t parallel_upload_part_size_ = 0;
+  int parallel_upload_max_concurrency_ = 1;
+  // Uploads the parts of all writable files.
+  std::unique_ptr<thread::ThreadPool> upload_pool_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GcsFileSystem);
 };
 
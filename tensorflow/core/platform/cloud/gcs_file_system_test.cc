@@ -1302,6 +1302,114 @@ TEST(GcsFileSystemTest, NewWritableFile_UploadReturns410) {
   EXPECT_EQ(tmp_files_before, results.size());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUploads) {
+  auto upload_part = [](const string& name, const string& content) {
+    return strings::StrCat(
+        "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+        "uploadType=media&name=path%2F.tmpcompose%2Fwriteable.",
+        name,
+        "\n"
+        "Auth Token: fake_token\n"
+        "Timeouts: 5 1 30\n"
+        "Post body: ",
+        content, "\n");
+  };
+  auto delete_part = [](const string& name) {
+    return strings::StrCat(
+        "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+        "path%2F.tmpcompose%2Fwriteable.",
+        name,
+        "\n"
+        "Auth Token: fake_token\n"
+        "Timeouts: 5 1 10\n"
+        "Delete: yes\n");
+  };
+  auto compose = [](const string& sources) {
+    return strings::StrCat(
+        "Uri: https://www.googleapis.com/storage/v1/b/bucket/o/"
+        "path%2Fwriteable/compose\n"
+        "Auth Token: fake_token\n"
+        "Timeouts: 5 1 10\n"
+        "Header content-type: application/json\n"
+        "Post body: {'sourceObjects': [",
+        sources, "]}\n");
+  };
+  std::vector<HttpRequest*> requests({
+      new FakeHttpRequest(upload_part("0", "01234567"), ""),
+      // A failed upload of a part is retried.
+      new FakeHttpRequest(upload_part("8", "89abcdef"), "",
+                          errors::Unavailable("503"), 503),
+      new FakeHttpRequest(upload_part("8", "89abcdef"), ""),
+      new FakeHttpRequest(upload_part("16", "gh"), ""),
+      new FakeHttpRequest(
+          compose("{'name': 'path/.tmpcompose/writeable.0'},"
+                  "{'name': 'path/.tmpcompose/writeable.8'},"
+                  "{'name': 'path/.tmpcompose/writeable.16'}"),
+          ""),
+      new FakeHttpRequest(delete_part("0"), ""),
+      new FakeHttpRequest(delete_part("8"), ""),
+      new FakeHttpRequest(delete_part("16"), ""),
+      // New content is appended to the object synced before.
+      new FakeHttpRequest(upload_part("18", "ijk"), ""),
+      new FakeHttpRequest(compose("{'name': 'path/writeable'},"
+                                  "{'name': 'path/.tmpcompose/writeable.18'}"),
+                          ""),
+      new FakeHttpRequest(delete_part("18"), ""),
+  });
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // A single upload thread makes the order of the requests deterministic.
+  fs.SetParallelUploads(8 /* part size */, 1 /* max concurrency */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable", &file));
+
+  TF_EXPECT_OK(file->Append("0123456789"));
+  TF_EXPECT_OK(file->Append("abcdefgh"));
+  int64 position;
+  TF_EXPECT_OK(file->Tell(&position));
+  EXPECT_EQ(18, position);
+  TF_EXPECT_OK(file->Flush());
+  TF_EXPECT_OK(file->Append("ijk"));
+  TF_EXPECT_OK(file->Close());
+}
+
+TEST(GcsFileSystemTest, NewWritableFile_ParallelUploadsOfASinglePart) {
+  std::vector<HttpRequest*> requests({new FakeHttpRequest(
+      "Uri: https://www.googleapis.com/upload/storage/v1/b/bucket/o?"
+      "uploadType=media&name=path%2Fwriteable\n"
+      "Auth Token: fake_token\n"
+      "Timeouts: 5 1 30\n"
+      "Post body: content\n",
+      "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 8 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetParallelUploads(8 /* part size */, 4 /* max concurrency */);
+
+  // Content that fits in a part is uploaded as the object, without composing.
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(fs.NewWritableFile("gs://bucket/path/writeable", &file));
+  TF_EXPECT_OK(file->Append("content"));
+  TF_EXPECT_OK(file->Close());
+  EXPECT_EQ(errors::Code::FAILED_PRECONDITION, file->Append("more").code());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_NoObjectName) {
   std::vector<HttpRequest*> requests;
   GcsFileSystem fs(
@@ -3562,6 +3670,8 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(16 * 1024 * 1024, fs1.block_size());
   EXPECT_EQ(128 * 1024 * 1024, fs1.max_bytes());
   EXPECT_EQ(0, fs1.max_staleness());
+  EXPECT_EQ(0, fs1.max_read_ahead_blocks());
+  EXPECT_EQ(0, fs1.parallel_upload_part_size());
   EXPECT_EQ(120, fs1.timeouts().connect);
   EXPECT_EQ(60, fs1.timeouts().idle);
   EXPECT_EQ(3600, fs1.timeouts().metadata);
@@ -3578,10 +3688,16 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   setenv("GCS_READ_CACHE_BLOCK_SIZE_MB", "1", 1);
   setenv("GCS_READ_CACHE_MAX_SIZE_MB", "16", 1);
   setenv("GCS_READ_CACHE_MAX_STALENESS", "60", 1);
+  setenv("GCS_READ_CACHE_MAX_READ_AHEAD_BLOCKS", "4", 1);
+  setenv("GCS_PARALLEL_UPLOAD_PART_SIZE_MB", "8", 1);
+  setenv("GCS_PARALLEL_UPLOAD_MAX_CONCURRENCY", "2", 1);
   GcsFileSystem fs3;
   EXPECT_EQ(1048576L, fs3.block_size());
   EXPECT_EQ(16 * 1024 * 1024, fs3.max_bytes());
   EXPECT_EQ(60, fs3.max_staleness());
+  EXPECT_EQ(4, fs3.max_read_ahead_blocks());
+  EXPECT_EQ(8 * 1024 * 1024, fs3.parallel_upload_part_size());
+  EXPECT_EQ(2, fs3.parallel_upload_max_concurrency());
 
   // Verify StatCache and MatchingPathsCache overrides.
   setenv("GCS_STAT_CACHE_MAX_AGE", "60", 1);
@@ -86,6 +86,13 @@ class HttpRequest {
     /// RecordResponse is called after the response has been received.
     virtual void RecordResponse(const HttpRequest* request, const string& uri,
                                 RequestMethod method, const Status& result) = 0;
+
+    /// \brief RecordConnection is called once a request has been sent, with
+    /// whether it was sent on an open connection rather than a new one.
+    ///
+    /// Counting the reused connections gives the hit rate of the connection
+    /// pool of the requests.
+    virtual void RecordConnection(const HttpRequest* request, bool reused) {}
   };
 
   HttpRequest() {}
@@ -14,12 +14,24 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
+namespace {
+
+// The maximum number of files whose reads are tracked to detect sequential
+// reads.
+constexpr size_t kMaxReadAheadStates = 1024;
+
+}  // namespace
 
 bool RamFileBlockCache::BlockNotStale(const std::shared_ptr<Block>& block) {
   mutex_lock l(block->mu);
@@ -39,6 +51,15 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
+      if (entry->second->read_ahead) {
+        entry->second->read_ahead = false;
+        // Read ahead further if the read has to wait for the block.
+        mutex_lock l(entry->second->mu);
+        if (entry->second->state != FetchState::FINISHED) {
+          ReadAheadState& state = read_ahead_states_[key.first];
+          state.depth = std::min(2 * state.depth, max_read_ahead_blocks_);
+        }
+      }
       return entry->second;
     } else {
       // Remove the stale block and continue.
@@ -46,6 +67,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert_Locked(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -58,6 +84,94 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   return new_entry;
 }
 
+void RamFileBlockCache::MaybeReadAhead(const string& filename, size_t start,
+                                       size_t finish) {
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks;
+  {
+    mutex_lock lock(mu_);
+    if (read_ahead_states_.size() >= kMaxReadAheadStates &&
+        read_ahead_states_.find(filename) == read_ahead_states_.end()) {
+      read_ahead_states_.clear();
+    }
+    ReadAheadState& state = read_ahead_states_[filename];
+    auto read_ahead = [this, &filename, &blocks](size_t pos) {
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) != block_map_.end()) {
+        return;
+      }
+      std::shared_ptr<Block> block = Insert_Locked(key);
+      block->read_ahead = true;
+      blocks.emplace_back(std::move(key), std::move(block));
+    };
+    // The blocks of a read past its first one are fetched in parallel with
+    // it, up to the number of fetches that may be in flight.
+    const size_t in_read_end =
+        std::min(finish, start + (max_read_ahead_blocks_ + 1) * block_size_);
+    for (size_t pos = start + block_size_; pos < in_read_end;
+         pos += block_size_) {
+      read_ahead(pos);
+    }
+    // A read continues the last one if it starts in the last block of that
+    // read, or right after it.
+    const bool sequential =
+        state.read_end > 0 &&
+        (start == state.read_end || start + block_size_ == state.read_end);
+    state.read_end = finish;
+    if (!sequential) {
+      state.read_ahead_end = finish;
+      state.depth = 1;
+    } else {
+      const size_t read_ahead_end = finish + state.depth * block_size_;
+      for (size_t pos = std::max(finish, state.read_ahead_end);
+           pos < read_ahead_end; pos += block_size_) {
+        read_ahead(pos);
+      }
+      state.read_ahead_end = std::max(state.read_ahead_end, read_ahead_end);
+    }
+  }
+  for (auto& key_and_block : blocks) {
+    read_ahead_pool_->Schedule([this, key_and_block]() {
+      FetchReadAheadBlock(key_and_block.first, key_and_block.second);
+    });
+  }
+}
+
+void RamFileBlockCache::FetchReadAheadBlock(
+    const Key& key, const std::shared_ptr<Block>& block) {
+  {
+    mutex_lock lock(mu_);
+    if (stop_read_ahead_ || block->timestamp == 0) {
+      // The cache is being destroyed, or the block was evicted before it was
+      // fetched.
+      return;
+    }
+  }
+  // A failed fetch leaves the block in the ERROR state, so that a read of the
+  // block fetches it again and returns the error.
+  if (!MaybeFetch(key, block).ok()) {
+    return;
+  }
+  mutex_lock lock(mu_);
+  if (block->timestamp == 0) {
+    return;
+  }
+  if (block->data.size() < block_size_) {
+    RemoveReadAheadBlocksAfter_Locked(key);
+  }
+  Trim();
+}
+
+void RamFileBlockCache::RemoveReadAheadBlocksAfter_Locked(const Key& key) {
+  auto it = block_map_.upper_bound(key);
+  while (it != block_map_.end() && it->first.first == key.first) {
+    auto next = std::next(it);
+    if (it->second->read_ahead) {
+      RemoveBlock(it);
+    }
+    it = next;
+  }
+}
+
 // Remove blocks from the cache until we do not exceed our maximum size.
 void RamFileBlockCache::Trim() {
   while (!lru_list_.empty() && cache_size_ > max_bytes_) {
@@ -84,6 +198,8 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
   // we have inconsistent state within the cache. Note: it's possible some
   // incomplete reads may still go undetected.
   if (block->data.size() < block_size_) {
+    // The blocks read ahead past the end of the file are not inconsistent.
+    RemoveReadAheadBlocksAfter_Locked(key);
     Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
     auto fcmp = block_map_.upper_bound(fmax);
     if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
@@ -182,6 +298,9 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (read_ahead_pool_) {
+    MaybeReadAhead(filename, start, finish);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -268,9 +387,15 @@ void RamFileBlockCache::Prune() {
 
 void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
+  // Signal that the blocks are removed, so that blocks still being fetched are
+  // not accounted in the cache size.
+  for (auto& entry : block_map_) {
+    entry.second->timestamp = 0;
+  }
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  read_ahead_states_.clear();
   cache_size_ = 0;
 }
 
@@ -280,6 +405,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  read_ahead_states_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,6 +40,14 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `max_read_ahead_blocks` is positive, the cache also detects sequential
+/// reads of a file and fetches the blocks that follow them in the background,
+/// issuing up to `max_read_ahead_blocks` fetches at once. The number of blocks
+/// read ahead of a file starts at one, and doubles every time a read has to
+/// wait for a block that is still being read ahead, so that enough fetches are
+/// in flight to hide their latency. The blocks of a read that spans several
+/// blocks are fetched from the same pool while the first one is fetched.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +61,40 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_read_ahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_read_ahead_blocks_(
+            IsCacheEnabled()
+                ? std::min(max_read_ahead_blocks,
+                           std::max<size_t>(1, max_bytes / block_size / 2))
+                : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_read_ahead_blocks_ > 0) {
+      read_ahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_read_ahead_FBC", static_cast<int>(max_read_ahead_blocks_)));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    if (read_ahead_pool_) {
+      {
+        mutex_lock lock(mu_);
+        stop_read_ahead_ = true;
+      }
+      // Destroying read_ahead_pool_ will block until the fetches in flight
+      // complete. The fetches that have not started yet are skipped.
+      read_ahead_pool_.reset();
+    }
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -131,6 +160,9 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks of a file read ahead of sequential reads.
+  /// At most half the cache is used for blocks read ahead of a file.
+  const size_t max_read_ahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -175,6 +207,8 @@ class RamFileBlockCache : public FileBlockCache {
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was read ahead, and has not been read since.
+    bool read_ahead = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -188,6 +222,16 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The read-ahead state of a file.
+  struct ReadAheadState {
+    /// The block-aligned end of the last read of the file.
+    size_t read_end = 0;
+    /// The end of the blocks read ahead of the file so far.
+    size_t read_ahead_end = 0;
+    /// The number of blocks to read ahead of sequential reads.
+    size_t depth = 1;
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -197,6 +241,26 @@ class RamFileBlockCache : public FileBlockCache {
   /// Look up a Key in the block cache.
   std::shared_ptr<Block> Lookup(const Key& key) TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for a Key that is not in the block cache.
+  std::shared_ptr<Block> Insert_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Start fetching the blocks of the block-aligned range `[start, finish)`
+  /// of `filename` past the first one, and the blocks that follow the range
+  /// if it continues the last read of the file.
+  void MaybeReadAhead(const string& filename, size_t start, size_t finish)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch a block that was read ahead, on a thread of `read_ahead_pool_`.
+  void FetchReadAheadBlock(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Remove the blocks of the file of `key` past `key` that were read ahead and
+  /// have not been read. A partial block ends the file, so these blocks were
+  /// read past its end.
+  void RemoveReadAheadBlocksAfter_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
@@ -243,6 +307,15 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// The read-ahead state of the files read so far.
+  std::map<string, ReadAheadState> read_ahead_states_ TF_GUARDED_BY(mu_);
+
+  /// Set when the cache is destroyed, to skip the pending read-ahead fetches.
+  bool stop_read_ahead_ TF_GUARDED_BY(mu_) = false;
+
+  /// The threads that fetch the blocks read ahead, if read-ahead is enabled.
+  std::unique_ptr<thread::ThreadPool> read_ahead_pool_;
 };
 
 }  // namespace tensorflow
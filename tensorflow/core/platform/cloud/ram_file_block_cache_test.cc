@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
+#include <functional>
+#include <map>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cloud/now_seconds_env.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -566,5 +570,187 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+// Serves a file of `file_size` bytes, whose byte at offset `i` is `i % 256`.
+Status FetchFile(size_t file_size, size_t offset, size_t n, char* buffer,
+                 size_t* bytes_transferred) {
+  *bytes_transferred = offset < file_size ? std::min(n, file_size - offset) : 0;
+  for (size_t i = 0; i < *bytes_transferred; ++i) {
+    buffer[i] = static_cast<char>((offset + i) % 256);
+  }
+  return Status::OK();
+}
+
+void ExpectFileContents(const std::vector<char>& out, size_t offset) {
+  for (size_t i = 0; i < out.size(); ++i) {
+    ASSERT_EQ(out[i], static_cast<char>((offset + i) % 256)) << offset + i;
+  }
+}
+
+// Waits for up to 10 seconds until `done` returns true.
+bool WaitUntil(const std::function<bool()>& done) {
+  for (int i = 0; i < 10000; ++i) {
+    if (done()) return true;
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+  return done();
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadFetchesTheNextBlock) {
+  const size_t block_size = 16;
+  const size_t file_size = 32 * block_size;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++fetches[offset];
+    }
+    return FetchFile(file_size, offset, n, buffer, bytes_transferred);
+  };
+  auto num_fetches = [&](size_t offset) {
+    mutex_lock l(mu);
+    return fetches[offset];
+  };
+  RamFileBlockCache cache(block_size, file_size, 0, fetcher, Env::Default(),
+                          /*max_read_ahead_blocks=*/4);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+  // The second read continues the first one, so the next block is read ahead.
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  EXPECT_TRUE(WaitUntil([&]() { return num_fetches(2 * block_size) == 1; }));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, block_size, &out));
+  ExpectFileContents(out, 2 * block_size);
+  EXPECT_EQ(num_fetches(2 * block_size), 1);
+  // Reading the block read ahead keeps the reads sequential.
+  EXPECT_TRUE(WaitUntil([&]() { return num_fetches(3 * block_size) == 1; }));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 3 * block_size, block_size, &out));
+  ExpectFileContents(out, 3 * block_size);
+  EXPECT_EQ(num_fetches(3 * block_size), 1);
+}
+
+TEST(RamFileBlockCacheTest, RandomReadsAreNotReadAhead) {
+  const size_t block_size = 16;
+  const size_t file_size = 32 * block_size;
+  mutex mu;
+  int calls = 0;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++calls;
+    }
+    return FetchFile(file_size, offset, n, buffer, bytes_transferred);
+  };
+  {
+    RamFileBlockCache cache(block_size, file_size, 0, fetcher, Env::Default(),
+                            /*max_read_ahead_blocks=*/4);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 4 * block_size, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 8 * block_size, block_size, &out));
+    // Reads of different files are tracked separately.
+    TF_EXPECT_OK(ReadCache(&cache, "b", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+  }
+  mutex_lock l(mu);
+  EXPECT_EQ(calls, 5);
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadDeepensWhenReadsWait) {
+  const size_t block_size = 16;
+  const size_t num_blocks = 64;
+  const size_t file_size = num_blocks * block_size;
+  mutex mu;
+  int in_flight = 0;
+  int max_in_flight = 0;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++in_flight;
+      max_in_flight = std::max(max_in_flight, in_flight);
+    }
+    // Every fetch takes long enough for the reads to catch up with the blocks
+    // read ahead.
+    Env::Default()->SleepForMicroseconds(10000);
+    {
+      mutex_lock l(mu);
+      --in_flight;
+    }
+    return FetchFile(file_size, offset, n, buffer, bytes_transferred);
+  };
+  RamFileBlockCache cache(block_size, file_size, 0, fetcher, Env::Default(),
+                          /*max_read_ahead_blocks=*/4);
+  std::vector<char> out;
+  for (size_t i = 0; i < num_blocks; ++i) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", i * block_size, block_size, &out));
+    ExpectFileContents(out, i * block_size);
+  }
+  mutex_lock l(mu);
+  EXPECT_GT(max_in_flight, 1);
+  EXPECT_LE(max_in_flight, 5);
+}
+
+TEST(RamFileBlockCacheTest, LargeReadsFetchTheirBlocksInParallel) {
+  const size_t block_size = 16;
+  const size_t num_blocks = 8;
+  const size_t file_size = num_blocks * block_size;
+  mutex mu;
+  int in_flight = 0;
+  int max_in_flight = 0;
+  int calls = 0;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      ++calls;
+      ++in_flight;
+      max_in_flight = std::max(max_in_flight, in_flight);
+    }
+    Env::Default()->SleepForMicroseconds(10000);
+    {
+      mutex_lock l(mu);
+      --in_flight;
+    }
+    return FetchFile(file_size, offset, n, buffer, bytes_transferred);
+  };
+  RamFileBlockCache cache(block_size, file_size, 0, fetcher, Env::Default(),
+                          /*max_read_ahead_blocks=*/3);
+  std::vector<char> out;
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, file_size, &out));
+  EXPECT_EQ(out.size(), file_size);
+  ExpectFileContents(out, 0);
+  mutex_lock l(mu);
+  EXPECT_GT(max_in_flight, 1);
+  EXPECT_LE(max_in_flight, 4);
+  EXPECT_EQ(calls, num_blocks);
+}
+
+TEST(RamFileBlockCacheTest, ReadAheadStopsAtTheEndOfTheFile) {
+  const size_t block_size = 16;
+  const size_t file_size = 2 * block_size + 8;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    return FetchFile(file_size, offset, n, buffer, bytes_transferred);
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(), /*max_read_ahead_blocks=*/4);
+  std::vector<char> out;
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", block_size, block_size, &out));
+    // The blocks read ahead past the end of the file do not make the last,
+    // partial block inconsistent.
+    TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, block_size, &out));
+    EXPECT_EQ(out.size(), 8);
+    ExpectFileContents(out, 2 * block_size);
+    EXPECT_TRUE(errors::IsOutOfRange(
+        ReadCache(&cache, "a", file_size, block_size, &out)));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, file_size, &out));
+    EXPECT_EQ(out.size(), file_size);
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
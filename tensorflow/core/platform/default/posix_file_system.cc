@@ -28,6 +28,24 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(IORING_OFF_SQ_RING)
+#define TF_POSIX_USE_IO_URING 1
+#endif
+#endif
+#endif
+
 #include "tensorflow/core/platform/default/posix_file_system.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
@@ -42,6 +60,151 @@ namespace tensorflow {
 // 128KB of copy buffer
 constexpr size_t kPosixCopyFileBufferSize = 128 * 1024;
 
+#if defined(TF_POSIX_USE_IO_URING)
+// The largest number of reads an io_uring keeps in flight.
+constexpr unsigned kIoUringMaxEntries = 64;
+
+// A submission queue and a completion queue shared with the kernel, through
+// which many reads are in flight at once (see io_uring(7)). Only one thread may
+// use an `IoUring` at a time.
+class IoUring {
+ public:
+  // Returns null if the kernel does not support io_uring, or does not allow
+  // this process to use it.
+  static std::unique_ptr<IoUring> Create(unsigned entries) {
+    // Once setting up a ring failed, it is not retried for every read.
+    static std::atomic<bool> unsupported(false);
+    if (unsupported.load(std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring);
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ring->fd_ = syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd_ < 0) {
+      VLOG(1) << "io_uring is not available: " << strerror(errno);
+      unsupported.store(true, std::memory_order_relaxed);
+      return nullptr;
+    }
+    ring->sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sq_ring_ = Map(ring->fd_, ring->sq_ring_size_, IORING_OFF_SQ_RING);
+    ring->cq_ring_ = Map(ring->fd_, ring->cq_ring_size_, IORING_OFF_CQ_RING);
+    ring->sqes_ = static_cast<struct io_uring_sqe*>(
+        Map(ring->fd_, ring->sqes_size_, IORING_OFF_SQES));
+    if (ring->sq_ring_ == nullptr || ring->cq_ring_ == nullptr ||
+        ring->sqes_ == nullptr) {
+      return nullptr;
+    }
+    char* sq = static_cast<char*>(ring->sq_ring_);
+    ring->sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(ring->cq_ring_);
+    ring->cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes_ =
+        reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    ring->entries_ = params.sq_entries;
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != nullptr) munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+    if (fd_ >= 0) close(fd_);
+  }
+
+  // The number of reads that may be in flight at once.
+  unsigned entries() const { return entries_; }
+
+  // Queues a read of `iov` at `offset` of `fd`, which completes with
+  // `user_data`. The submission queue must not be full.
+  void PrepareRead(int fd, struct iovec* iov, uint64 offset, uint64 user_data) {
+    const unsigned tail = *sq_tail_;
+    const unsigned index = tail & sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->addr = reinterpret_cast<uint64>(iov);
+    sqe->len = 1;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    // The kernel reads the entry once it sees the new tail.
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    ++num_unsubmitted_;
+  }
+
+  // Submits the queued reads, and waits until at least one read completed.
+  // Returns 0, or the errno of the failure.
+  int SubmitAndWait() {
+    while (true) {
+      const int r = syscall(__NR_io_uring_enter, fd_, num_unsubmitted_, 1,
+                            IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (r >= 0) {
+        num_unsubmitted_ -= std::min<unsigned>(r, num_unsubmitted_);
+        return 0;
+      }
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        return errno;
+      }
+    }
+  }
+
+  // Pops a completed read into `*user_data` and `*res`, the number of bytes
+  // read or minus an errno. Returns false if no read completed.
+  bool PopCompletion(uint64* user_data, int* res) {
+    const unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    *user_data = cqe.user_data;
+    *res = cqe.res;
+    // The kernel may reuse the entry once it sees the new head.
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  IoUring() = default;
+
+  static void* Map(int fd, size_t size, off_t offset) {
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd, offset);
+    return address == MAP_FAILED ? nullptr : address;
+  }
+
+  int fd_ = -1;
+  unsigned entries_ = 0;
+  unsigned num_unsubmitted_ = 0;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IoUring);
+};
+#endif  // defined(TF_POSIX_USE_IO_URING)
+
 // pread() based random-access
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
@@ -92,6 +255,90 @@ class PosixRandomAccessFile : public RandomAccessFile {
     *result = StringPiece(scratch, dst - scratch);
     return s;
   }
+
+  Status ReadV(std::vector<ReadRequest>* requests) const override {
+#if defined(TF_POSIX_USE_IO_URING)
+    if (requests->size() > 1) {
+      std::unique_ptr<IoUring> ring = IoUring::Create(static_cast<unsigned>(
+          std::min<size_t>(requests->size(), kIoUringMaxEntries)));
+      if (ring != nullptr) {
+        return ReadVWithIoUring(ring.get(), requests);
+      }
+    }
+#endif
+    return RandomAccessFile::ReadV(requests);
+  }
+
+ private:
+#if defined(TF_POSIX_USE_IO_URING)
+  // Keeps up to `ring->entries()` of `requests` in flight until all of them
+  // are read. Like `Read()`, resubmits the rest of short and interrupted reads.
+  Status ReadVWithIoUring(IoUring* ring,
+                          std::vector<ReadRequest>* requests) const {
+    std::vector<ReadRequest>& reqs = *requests;
+    std::vector<struct iovec> iovecs(reqs.size());
+    std::vector<size_t> bytes_read(reqs.size(), 0);
+    std::deque<size_t> to_resubmit;
+    size_t next = 0;
+    unsigned in_flight = 0;
+    for (ReadRequest& request : reqs) {
+      request.status = Status::OK();
+    }
+    while (true) {
+      while (in_flight < ring->entries()) {
+        size_t i;
+        if (!to_resubmit.empty()) {
+          i = to_resubmit.front();
+          to_resubmit.pop_front();
+        } else if (next < reqs.size()) {
+          i = next++;
+          if (reqs[i].n == 0) continue;
+        } else {
+          break;
+        }
+        iovecs[i].iov_base = reqs[i].scratch + bytes_read[i];
+        // As in `Read()`, a single read is kept under 2GB.
+        iovecs[i].iov_len =
+            std::min<size_t>(reqs[i].n - bytes_read[i], INT32_MAX);
+        ring->PrepareRead(fd_, &iovecs[i], reqs[i].offset + bytes_read[i], i);
+        ++in_flight;
+      }
+      if (in_flight == 0) {
+        break;
+      }
+      const int error = ring->SubmitAndWait();
+      if (error != 0) {
+        // The reads in flight may still write to the buffers of `requests`,
+        // so they cannot be reissued one at a time.
+        LOG(FATAL) << "io_uring_enter() failed: " << strerror(error);
+      }
+      uint64 i;
+      int res;
+      while (ring->PopCompletion(&i, &res)) {
+        --in_flight;
+        if (res > 0) {
+          bytes_read[i] += res;
+          if (bytes_read[i] < reqs[i].n) {
+            to_resubmit.push_back(i);
+          }
+        } else if (res == 0) {
+          reqs[i].status =
+              Status(error::OUT_OF_RANGE, "Read less bytes than requested");
+        } else if (res == -EINTR || res == -EAGAIN) {
+          to_resubmit.push_back(i);
+        } else {
+          reqs[i].status = IOError(filename_, -res);
+        }
+      }
+    }
+    Status status;
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      reqs[i].result = StringPiece(reqs[i].scratch, bytes_read[i]);
+      status.Update(reqs[i].status);
+    }
+    return status;
+  }
+#endif  // defined(TF_POSIX_USE_IO_URING)
 };
 
 class PosixWritableFile : public WritableFile {
@@ -90,6 +90,48 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadV) {
+  const string filename = io::JoinPath(BaseDir(), "read_v");
+  const int length = 100000;
+  const string input = CreateTestFile(env_, filename, length);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Reads of every size at scattered offsets, more than are kept in flight at
+  // once.
+  const int num_requests = 300;
+  std::vector<RandomAccessFile::ReadRequest> requests(num_requests);
+  std::vector<string> buffers(num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    requests[i].offset = (i * 7919) % (length - 1000);
+    requests[i].n = i * 3;
+    buffers[i].resize(requests[i].n);
+    requests[i].scratch = &buffers[i][0];
+  }
+  TF_EXPECT_OK(f->ReadV(&requests));
+  for (int i = 0; i < num_requests; ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(requests[i].offset, requests[i].n),
+              requests[i].result);
+  }
+
+  // Reads past EOF fail with OUT_OF_RANGE, and do not affect the others.
+  requests.resize(3);
+  requests[0].offset = length - 2;
+  requests[1].offset = 0;
+  requests[2].offset = length + 10;
+  for (auto& request : requests) {
+    request.n = 3;
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, f->ReadV(&requests).code());
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[0].status.code());
+  EXPECT_EQ(input.substr(length - 2), requests[0].result);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_EQ(input.substr(0, 3), requests[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+  EXPECT_TRUE(requests[2].result.empty());
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
@@ -377,6 +377,36 @@ class RandomAccessFile {
   virtual tensorflow::Status Read(uint64 offset, size_t n, StringPiece* result,
                                   char* scratch) const = 0;
 
+  /// \brief One of the reads of a `ReadV()` call: up to `n` bytes of the
+  /// file starting at `offset`, into `scratch[0..n-1]`.
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    char* scratch = nullptr;
+    /// Set by `ReadV()` to what `Read()` stores in `*result` and returns.
+    StringPiece result;
+    tensorflow::Status status;
+  };
+
+  /// \brief Reads every request of `*requests` as `Read()` would, and stores
+  /// the result and the status of each read in its request.
+  ///
+  /// Returns OK if every read succeeded, and otherwise the status of the first
+  /// request that failed. Implementations may issue the reads concurrently,
+  /// which keeps devices with deep queues busy; the default implementation
+  /// issues them one at a time.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual tensorflow::Status ReadV(std::vector<ReadRequest>* requests) const {
+    tensorflow::Status status;
+    for (ReadRequest& request : *requests) {
+      request.status =
+          Read(request.offset, request.n, &request.result, request.scratch);
+      status.Update(request.status);
+    }
+    return status;
+  }
+
   // TODO(ebrevdo): Remove this ifdef when absl is updated.
 #if defined(PLATFORM_GOOGLE)
   /// \brief Read up to `n` bytes from the file starting at `offset`.
@@ -39,7 +39,9 @@ limitations under the License.
 #include <cmath>
 #include <cstdlib>
 
+#include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 #include "tensorflow/core/platform/file_system_helper.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/s3/aws_crypto.h"
@@ -71,6 +73,31 @@ static const int kUploadRetries = 3;
 static const int kDownloadRetries = 3;
 static const char* kExecutorTag = "TransferManagerExecutor";
 
+// The environment variables that configure the block cache of random access
+// files. The cache is disabled unless both its block size and its maximum
+// size are positive.
+static const char* kReadCacheBlockSize = "S3_READ_CACHE_BLOCK_SIZE_MB";
+static const char* kReadCacheMaxSize = "S3_READ_CACHE_MAX_SIZE_MB";
+static const char* kReadCacheMaxStaleness = "S3_READ_CACHE_MAX_STALENESS";
+// The number of blocks fetched ahead of sequential reads, and in parallel with
+// the first block of reads that span several blocks, with concurrent ranged
+// GETs.
+static const char* kReadCacheMaxReadAheadBlocks =
+    "S3_READ_CACHE_MAX_READ_AHEAD_BLOCKS";
+static const uint64 kDefaultReadCacheBlockSizeMb = 64;
+static const uint64 kDefaultReadCacheMaxReadAheadBlocks = 4;
+
+// Returns the value of the environment variable `varname`, or `default_value`
+// if it is not set to an unsigned integer.
+uint64 GetEnvVarOrDefault(const char* varname, uint64 default_value) {
+  const char* value_str = getenv(varname);
+  uint64 value;
+  if (value_str && strings::safe_strtou64(value_str, &value)) {
+    return value;
+  }
+  return default_value;
+}
+
 Aws::Client::ClientConfiguration& GetDefaultClientConfig() {
   static mutex cfg_lock(LINKER_INITIALIZED);
   static bool init(false);
@@ -234,12 +261,15 @@ class S3RandomAccessFile : public RandomAccessFile {
       const string& bucket, const string& object,
       const bool use_multi_part_download,
       std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager,
-      std::shared_ptr<Aws::S3::S3Client> s3_client)
+      std::shared_ptr<Aws::S3::S3Client> s3_client,
+      const string& fname = "", FileBlockCache* file_block_cache = nullptr)
       : bucket_(bucket),
         object_(object),
         use_multi_part_download_(use_multi_part_download),
         transfer_manager_(transfer_manager),
-        s3_client_(s3_client) {}
+        s3_client_(s3_client),
+        fname_(fname),
+        file_block_cache_(file_block_cache) {}
 
   Status Name(StringPiece* result) const override {
     return errors::Unimplemented("S3RandomAccessFile does not support Name()");
@@ -249,6 +279,9 @@ class S3RandomAccessFile : public RandomAccessFile {
               char* scratch) const override {
     VLOG(1) << "ReadFilefromS3 s3://" << bucket_ << "/" << object_ << " from "
             << offset << " for n:" << n;
+    if (file_block_cache_ != nullptr) {
+      return ReadFileBlockCache(offset, n, result, scratch);
+    }
     if (use_multi_part_download_) {
       return ReadS3TransferManager(offset, n, result, scratch);
     } else {
@@ -256,6 +289,21 @@ class S3RandomAccessFile : public RandomAccessFile {
     }
   }
 
+  Status ReadFileBlockCache(uint64 offset, size_t n, StringPiece* result,
+                            char* scratch) const {
+    VLOG(3) << "Using the block cache";
+    size_t bytes_transferred;
+    TF_RETURN_IF_ERROR(file_block_cache_->Read(fname_, offset, n, scratch,
+                                               &bytes_transferred));
+    *result = StringPiece(scratch, bytes_transferred);
+    if (bytes_transferred < n) {
+      return errors::OutOfRange("EOF reached, ", result->size(),
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  }
+
   Status ReadS3TransferManager(uint64 offset, size_t n, StringPiece* result,
                                char* scratch) const {
     VLOG(3) << "Using TransferManager";
@@ -342,6 +390,10 @@ class S3RandomAccessFile : public RandomAccessFile {
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
   bool use_multi_part_download_;
+  // The name of the file, and the block cache its reads go through if the
+  // cache is enabled.
+  const string fname_;
+  FileBlockCache* file_block_cache_;
 };
 
 class S3WritableFile : public WritableFile {
@@ -349,11 +401,13 @@ class S3WritableFile : public WritableFile {
   S3WritableFile(
       const string& bucket, const string& object,
       std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager,
-      std::shared_ptr<Aws::S3::S3Client> s3_client)
+      std::shared_ptr<Aws::S3::S3Client> s3_client,
+      std::function<void()> file_cache_erase)
       : bucket_(bucket),
         object_(object),
         s3_client_(s3_client),
         transfer_manager_(transfer_manager),
+        file_cache_erase_(std::move(file_cache_erase)),
         sync_needed_(true),
         outfile_(Aws::MakeShared<Aws::Utils::TempFile>(
             kS3FileSystemAllocationTag, kS3TempFileTemplate,
@@ -403,6 +457,9 @@ class S3WritableFile : public WritableFile {
             outfile_, bucket_.c_str(), object_.c_str(),
             "application/octet-stream", Aws::Map<Aws::String, Aws::String>());
     handle->WaitUntilFinished();
+    // The cached blocks of the object are stale whether or not the upload
+    // succeeds.
+    file_cache_erase_();
     int retries = 0;
 
     while (handle->GetStatus() == Aws::Transfer::TransferStatus::FAILED &&
@@ -432,6 +489,7 @@ class S3WritableFile : public WritableFile {
   string object_;
   std::shared_ptr<Aws::S3::S3Client> s3_client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
+  std::function<void()> file_cache_erase_;
   bool sync_needed_;
   std::shared_ptr<Aws::Utils::TempFile> outfile_;
 };
@@ -500,6 +558,25 @@ S3FileSystem::S3FileSystem()
 
   this->transfer_managers_.insert(upload_pair);
   this->transfer_managers_.insert(download_pair);
+
+  const uint64 block_size =
+      GetEnvVarOrDefault(kReadCacheBlockSize, kDefaultReadCacheBlockSizeMb) *
+      1024 * 1024;
+  const uint64 max_bytes =
+      GetEnvVarOrDefault(kReadCacheMaxSize, 0) * 1024 * 1024;
+  const uint64 max_staleness = GetEnvVarOrDefault(kReadCacheMaxStaleness, 0);
+  const uint64 max_read_ahead_blocks = GetEnvVarOrDefault(
+      kReadCacheMaxReadAheadBlocks, kDefaultReadCacheMaxReadAheadBlocks);
+  if (block_size > 0 && max_bytes > 0) {
+    file_block_cache_.reset(new RamFileBlockCache(
+        block_size, max_bytes, max_staleness,
+        [this](const string& filename, size_t offset, size_t n, char* buffer,
+               size_t* bytes_transferred) {
+          return LoadBufferFromS3(filename, offset, n, buffer,
+                                  bytes_transferred);
+        },
+        Env::Default(), max_read_ahead_blocks));
+  }
 }
 
 S3FileSystem::~S3FileSystem() {}
@@ -580,13 +657,62 @@ Status S3FileSystem::NewRandomAccessFile(
 
   // check if an override was defined for this file. used for testing
   bool use_mpd = this->use_multi_part_download_ && use_multi_part_download;
+  if (file_block_cache_ != nullptr) {
+    // Drop the cached blocks of the file if it changed since they were read.
+    FileStatistics stat;
+    TF_RETURN_IF_ERROR(Stat(fname, &stat));
+    file_block_cache_->ValidateAndUpdateFileSignature(
+        fname, Hash64Combine(stat.length, stat.mtime_nsec));
+  }
   result->reset(new S3RandomAccessFile(
       bucket, object, use_mpd,
       this->GetTransferManager(Aws::Transfer::TransferDirection::DOWNLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), fname, file_block_cache_.get()));
+  return Status::OK();
+}
+
+Status S3FileSystem::LoadBufferFromS3(const string& fname, size_t offset,
+                                      size_t n, char* buffer,
+                                      size_t* bytes_transferred) {
+  *bytes_transferred = 0;
+  string bucket, object;
+  TF_RETURN_IF_ERROR(ParseS3Path(fname, false, &bucket, &object));
+  VLOG(1) << "LoadBufferFromS3 s3://" << bucket << "/" << object << " from "
+          << offset << " for n:" << n;
+
+  Aws::S3::Model::GetObjectRequest getObjectRequest;
+  getObjectRequest.WithBucket(bucket.c_str()).WithKey(object.c_str());
+  string bytes = strings::StrCat("bytes=", offset, "-", offset + n - 1);
+  getObjectRequest.SetRange(bytes.c_str());
+  getObjectRequest.SetResponseStreamFactory(
+      []() { return Aws::New<Aws::StringStream>(kS3FileSystemAllocationTag); });
+
+  auto getObjectOutcome = this->GetS3Client()->GetObject(getObjectRequest);
+  if (!getObjectOutcome.IsSuccess()) {
+    auto error = getObjectOutcome.GetError();
+    if (error.GetResponseCode() ==
+        Aws::Http::HttpResponseCode::REQUESTED_RANGE_NOT_SATISFIABLE) {
+      // The block starts at or past the end of the file.
+      return Status::OK();
+    }
+    return CreateStatusFromAwsError(error);
+  }
+  size_t length = getObjectOutcome.GetResult().GetContentLength();
+  if (length > n) {
+    return errors::Internal("Read ", length, " bytes of s3://", bucket, "/",
+                            object, " at offset ", offset, " instead of ", n);
+  }
+  getObjectOutcome.GetResult().GetBody().read(buffer, length);
+  *bytes_transferred = length;
   return Status::OK();
 }
 
+void S3FileSystem::FileCacheErase(const string& fname) {
+  if (file_block_cache_ != nullptr) {
+    file_block_cache_->RemoveFile(fname);
+  }
+}
+
 Status S3FileSystem::NewWritableFile(const string& fname,
                                      std::unique_ptr<WritableFile>* result) {
   string bucket, object;
@@ -594,7 +720,7 @@ Status S3FileSystem::NewWritableFile(const string& fname,
   result->reset(new S3WritableFile(
       bucket, object,
       this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), [this, fname]() { FileCacheErase(fname); }));
 
   return Status::OK();
 }
@@ -613,7 +739,7 @@ Status S3FileSystem::NewAppendableFile(const string& fname,
   result->reset(new S3WritableFile(
       bucket, object,
       this->GetTransferManager(Aws::Transfer::TransferDirection::UPLOAD),
-      this->GetS3Client()));
+      this->GetS3Client(), [this, fname]() { FileCacheErase(fname); }));
 
   while (true) {
     status = reader->Read(offset, kS3ReadAppendableFileBufferSize, &read_chunk,
@@ -780,6 +906,7 @@ Status S3FileSystem::DeleteFile(const string& fname) {
 
   auto deleteObjectOutcome =
       this->GetS3Client()->DeleteObject(deleteObjectRequest);
+  FileCacheErase(fname);
   if (!deleteObjectOutcome.IsSuccess()) {
     return CreateStatusFromAwsError(deleteObjectOutcome.GetError());
   }
@@ -1166,6 +1293,10 @@ Status S3FileSystem::RenameFile(const string& src, const string& target) {
       TF_RETURN_IF_ERROR(CopyFile(Aws::String(src_bucket.c_str()), src_key,
                                   Aws::String(target_bucket.c_str()),
                                   target_key));
+      FileCacheErase(
+          strings::StrCat("s3://", target_bucket, "/", target_key.c_str()));
+      FileCacheErase(
+          strings::StrCat("s3://", src_bucket, "/", src_key.c_str()));
 
       deleteObjectRequest.SetBucket(src_bucket.c_str());
       deleteObjectRequest.SetKey(src_key.c_str());
@@ -22,6 +22,7 @@ limitations under the License.
 #include <aws/s3/model/CompletedMultipartUpload.h>
 #include <aws/transfer/TransferManager.h>
 
+#include "tensorflow/core/platform/cloud/file_block_cache.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/retrying_file_system.h"
@@ -137,6 +138,15 @@ class S3FileSystem : public FileSystem {
       const std::shared_ptr<const Aws::Client::AsyncCallerContext>&
           multiPartContext);
 
+  // Reads the range `[offset, offset + n)` of the object `fname` into
+  // `buffer`, with a ranged GET. Reading past the end of the object is not an
+  // error, and transfers fewer bytes.
+  Status LoadBufferFromS3(const string& fname, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred);
+
+  // Removes the cached blocks of `fname`, if the block cache is enabled.
+  void FileCacheErase(const string& fname);
+
   // Lock held when checking for s3_client_ and transfer_manager_ initialization
   mutex initialization_lock_;
 
@@ -144,6 +154,12 @@ class S3FileSystem : public FileSystem {
   std::map<Aws::Transfer::TransferDirection, uint64> multi_part_chunk_size_;
 
   bool use_multi_part_download_;
+
+  // The block cache of random access files, which fetches blocks ahead of
+  // sequential reads. Null unless enabled by S3_READ_CACHE_MAX_SIZE_MB.
+  // Declared last, so that the fetches it has in flight finish before the
+  // other members are destroyed.
+  std::unique_ptr<FileBlockCache> file_block_cache_;
 };
 
 /// S3 implementation of a file system with retry on failures.
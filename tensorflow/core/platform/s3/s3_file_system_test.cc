@@ -180,6 +180,32 @@ TEST_F(S3FileSystemTest, NewRandomAccessFile) {
   EXPECT_EQ(content.substr(2, 4), result);
 }
 
+TEST_F(S3FileSystemTest, NewRandomAccessFile_BlockCache) {
+  setenv("S3_READ_CACHE_BLOCK_SIZE_MB", "1", 1);
+  setenv("S3_READ_CACHE_MAX_SIZE_MB", "16", 1);
+  S3FileSystem cached_s3fs;
+  unsetenv("S3_READ_CACHE_BLOCK_SIZE_MB");
+  unsetenv("S3_READ_CACHE_MAX_SIZE_MB");
+
+  const string fname = TmpDir("RandomAccessFile_BlockCache");
+  TF_ASSERT_OK(WriteString(fname, "abcdefghijklmn"));
+
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_EXPECT_OK(cached_s3fs.NewRandomAccessFile(fname, &reader));
+  char scratch[16];
+  StringPiece result;
+  TF_EXPECT_OK(reader->Read(2, 4, &result, scratch));
+  EXPECT_EQ("cdef", result);
+  EXPECT_TRUE(errors::IsOutOfRange(reader->Read(10, 8, &result, scratch)));
+  EXPECT_EQ("klmn", result);
+
+  // Files that changed since they were cached are read again.
+  TF_ASSERT_OK(WriteString(fname, "ABCDEFGHIJKLMNOP"));
+  TF_EXPECT_OK(cached_s3fs.NewRandomAccessFile(fname, &reader));
+  TF_EXPECT_OK(reader->Read(2, 4, &result, scratch));
+  EXPECT_EQ("CDEF", result);
+}
+
 TEST_F(S3FileSystemTest, NewWritableFile) {
   std::unique_ptr<WritableFile> writer;
   const string fname = TmpDir("WritableFile");
@@ -17,6 +17,8 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <deque>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -45,10 +47,14 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  HighPriorityQueue* const high_priority_queue_;  // not owned
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, HighPriorityQueue* high_priority_queue)
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        high_priority_queue_(high_priority_queue) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
     return env_->StartThread(thread_options_, name_, [=]() {
@@ -63,7 +69,7 @@ struct EigenEnvironment {
     });
   }
 
-  Task CreateTask(std::function<void()> f) {
+  static Task CreateTask(std::function<void()> f) {
     uint64 id = 0;
     if (tracing::EventCollector::IsEnabled()) {
       id = tracing::GetUniqueArg();
@@ -79,13 +85,46 @@ struct EigenEnvironment {
   }
 
   void ExecuteTask(const Task& t) {
+    RunHighPriorityTasks();
+    RunTask(t);
+  }
+
+  void RunTask(const Task& t) {
     WithContext wc(t.f->context);
     tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                  t.f->trace_id);
     t.f->f();
   }
+
+  // Runs the functions scheduled with ThreadPool::ScheduleHighPriority until
+  // none is pending.
+  void RunHighPriorityTasks();
 };
 
+// Functions scheduled with ThreadPool::ScheduleHighPriority. Every task the
+// Eigen pool runs first runs all of these that are pending, so they start
+// before the tasks already queued in the pool.
+struct HighPriorityQueue {
+  mutex mu;
+  std::deque<EigenEnvironment::Task> tasks TF_GUARDED_BY(mu);
+  // The size of `tasks`, read without `mu` before each task is run.
+  std::atomic<int64> size{0};
+};
+
+void EigenEnvironment::RunHighPriorityTasks() {
+  while (high_priority_queue_->size.load(std::memory_order_relaxed) > 0) {
+    Task t;
+    {
+      mutex_lock l(high_priority_queue_->mu);
+      if (high_priority_queue_->tasks.empty()) return;
+      t = std::move(high_priority_queue_->tasks.front());
+      high_priority_queue_->tasks.pop_front();
+      high_priority_queue_->size.fetch_sub(1, std::memory_order_relaxed);
+    }
+    RunTask(t);
+  }
+}
+
 ThreadPool::ThreadPool(Env* env, const string& name, int num_threads)
     : ThreadPool(env, ThreadOptions(), name, num_threads, true, nullptr) {}
 
@@ -97,9 +136,11 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
                        bool low_latency_hint, Eigen::Allocator* allocator) {
   CHECK_GE(num_threads, 1);
+  high_priority_queue_.reset(new HighPriorityQueue);
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name,
+                       high_priority_queue_.get())));
   underlying_threadpool_ = eigen_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
@@ -118,6 +159,23 @@ void ThreadPool::Schedule(std::function<void()> fn) {
   underlying_threadpool_->Schedule(std::move(fn));
 }
 
+void ThreadPool::ScheduleHighPriority(std::function<void()> fn) {
+  CHECK(fn != nullptr);
+  if (eigen_threadpool_ == nullptr) {
+    underlying_threadpool_->Schedule(std::move(fn));
+    return;
+  }
+  EigenEnvironment::Task t = EigenEnvironment::CreateTask(std::move(fn));
+  {
+    mutex_lock l(high_priority_queue_->mu);
+    high_priority_queue_->tasks.push_back(std::move(t));
+    high_priority_queue_->size.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Makes sure that a task starts after `fn` was queued. It runs `fn`, unless
+  // a task that started earlier already has.
+  underlying_threadpool_->Schedule([] {});
+}
+
 int ThreadPool::NumShardsUsedByFixedBlockSizeScheduling(
     const int64 total, const int64 block_size) {
   if (block_size <= 0 || total <= 1 || total <= block_size ||
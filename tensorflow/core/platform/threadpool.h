@@ -38,6 +38,7 @@ namespace tensorflow {
 namespace thread {
 
 struct EigenEnvironment;
+struct HighPriorityQueue;
 
 class ThreadPool {
  public:
@@ -138,6 +139,12 @@ class ThreadPool {
   // Schedules fn() for execution in the pool of threads.
   void Schedule(std::function<void()> fn);
 
+  // Like Schedule(), but fn() starts before the functions already scheduled
+  // with Schedule() that have not started yet. Functions scheduled with this
+  // method start in the order they were scheduled. Pools that wrap a
+  // user_threadpool have no priorities, and call Schedule() instead.
+  void ScheduleHighPriority(std::function<void()> fn);
+
   void SetStealPartitions(
       const std::vector<std::pair<unsigned, unsigned>>& partitions);
 
@@ -230,6 +237,9 @@ class ThreadPool {
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
+  // Functions scheduled with ScheduleHighPriority(). Created with
+  // eigen_threadpool_, whose threads use it until they are joined.
+  std::unique_ptr<HighPriorityQueue> high_priority_queue_;
   // eigen_threadpool_ is instantiated and owned by thread::ThreadPool if
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
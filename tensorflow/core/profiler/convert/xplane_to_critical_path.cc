@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/tf_op_utils.h"
+#include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_visitor.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+uint64 EndPs(const CriticalPathOp& op) { return op.start_ps + op.duration_ps; }
+
+bool Overlap(const CriticalPathOp& a, const CriticalPathOp& b) {
+  return a.start_ps < EndPs(b) && b.start_ps < EndPs(a);
+}
+
+// Fills in the critical path, slacks and projected speedups of `step`, whose
+// ops are sorted by start time.
+void AnalyzeStep(StepCriticalPath* step) {
+  std::vector<CriticalPathOp>& ops = step->ops;
+  const int num_ops = ops.size();
+  if (num_ops == 0) return;
+
+  // longest_to[i] is the longest chain ending with op i, and longest_from[i]
+  // the longest one starting with it. In the inferred graph, the predecessors
+  // of an op are the ops that ended before it started, so both are computed
+  // in one sweep with a running maximum over the ops sorted by end time.
+  std::vector<int> by_end(num_ops);
+  std::iota(by_end.begin(), by_end.end(), 0);
+  absl::c_stable_sort(by_end, [&ops](int a, int b) {
+    return EndPs(ops[a]) < EndPs(ops[b]);
+  });
+  std::vector<uint64> longest_to(num_ops);
+  std::vector<int> longest_predecessor(num_ops, -1);
+  int best_ended = -1;
+  for (int i = 0, next_ended = 0; i < num_ops; ++i) {
+    while (next_ended < num_ops &&
+           EndPs(ops[by_end[next_ended]]) <= ops[i].start_ps) {
+      const int j = by_end[next_ended++];
+      if (best_ended < 0 || longest_to[j] > longest_to[best_ended]) {
+        best_ended = j;
+      }
+    }
+    longest_predecessor[i] = best_ended;
+    longest_to[i] =
+        ops[i].duration_ps + (best_ended < 0 ? 0 : longest_to[best_ended]);
+  }
+  std::vector<uint64> longest_from(num_ops);
+  uint64 best_started = 0;
+  for (int k = num_ops - 1, next_started = num_ops - 1; k >= 0; --k) {
+    const int i = by_end[k];
+    while (next_started >= 0 && ops[next_started].start_ps >= EndPs(ops[i])) {
+      best_started = std::max(best_started, longest_from[next_started--]);
+    }
+    longest_from[i] = ops[i].duration_ps + best_started;
+  }
+
+  std::vector<uint64> longest_through(num_ops);
+  for (int i = 0; i < num_ops; ++i) {
+    longest_through[i] = longest_to[i] + longest_from[i] - ops[i].duration_ps;
+  }
+  const int last = absl::c_max_element(longest_to) - longest_to.begin();
+  const uint64 critical_path_ps = longest_to[last];
+  step->critical_path_ps = critical_path_ps;
+  for (int i = last; i >= 0; i = longest_predecessor[i]) {
+    step->critical_path.push_back(i);
+  }
+  absl::c_reverse(step->critical_path);
+
+  for (int i = 0; i < num_ops; ++i) {
+    CriticalPathOp& op = ops[i];
+    op.slack_ps = critical_path_ps - longest_through[i];
+    // Another chain as long as the critical path doesn't include the op.
+    if (op.slack_ps > 0) continue;
+    // Without the op, the longest chain is either the one through it, or one
+    // through an op that overlaps it, since any other chain could include it.
+    uint64 without_op_ps = longest_through[i] - op.duration_ps;
+    for (int j = 0; j < num_ops; ++j) {
+      if (j != i && Overlap(ops[i], ops[j])) {
+        without_op_ps = std::max(without_op_ps, longest_through[j]);
+      }
+    }
+    op.projected_speedup =
+        without_op_ps == 0
+            ? std::numeric_limits<double>::infinity()
+            : static_cast<double>(critical_path_ps) / without_op_ps;
+  }
+}
+
+}  // namespace
+
+StepCriticalPaths ConvertHostThreadsXPlaneToCriticalPaths(
+    const XPlane& host_trace) {
+  StepCriticalPaths result;
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&host_trace);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      absl::optional<XStatVisitor> group_id = event.GetStat(StatType::kGroupId);
+      if (!group_id.has_value() || event.DurationPs() <= 0) return;
+      TfOp tf_op = ParseTfOpFullname(event.Name());
+      if (tf_op.category != Category::kTensorFlow) return;
+      CriticalPathOp op;
+      op.name = std::string(tf_op.name);
+      op.type = std::string(tf_op.type);
+      op.start_ps = event.TimestampPs();
+      op.duration_ps = event.DurationPs();
+      result[group_id->IntValue()].ops.push_back(std::move(op));
+    });
+  });
+  for (auto& id_and_step : result) {
+    StepCriticalPath& step = id_and_step.second;
+    absl::c_stable_sort(step.ops,
+                        [](const CriticalPathOp& a, const CriticalPathOp& b) {
+                          return a.start_ps < b.start_ps;
+                        });
+    AnalyzeStep(&step);
+  }
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
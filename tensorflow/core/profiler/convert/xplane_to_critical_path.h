@@ -0,0 +1,69 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// A TF op executed during a step.
+struct CriticalPathOp {
+  std::string name;  // e.g. "dense/MatMul"
+  std::string type;  // e.g. "MatMul"
+  uint64 start_ps = 0;
+  uint64 duration_ps = 0;
+  // How much the op can be delayed without making the critical path longer.
+  // Ops with no slack are on a critical path.
+  uint64 slack_ps = 0;
+  // Ratio of the critical path length to its length if the op took no time,
+  // i.e. the upper bound of the step speedup from accelerating the op. This is
+  // infinite if the op is the only one left on the critical path.
+  double projected_speedup = 1.0;
+};
+
+// The critical path of a step.
+struct StepCriticalPath {
+  uint64 critical_path_ps = 0;
+  // The ops of the step, sorted by start time.
+  std::vector<CriticalPathOp> ops;
+  // Indices into ops of one critical path, in execution order.
+  std::vector<int> critical_path;
+};
+
+// Map from step (i.e. group_id) to its critical path.
+using StepCriticalPaths = absl::flat_hash_map<int64, StepCriticalPath>;
+
+// Reconstructs the dependency graph of the TF ops of each step from a host
+// plane grouped by GroupTfEvents, and computes its critical path.
+//
+// Traces don't record the edges of the executor graph. Instead, an op is
+// assumed to depend on every op of the same step that ended before it started.
+// This includes every real dependency, so the critical path (the longest chain
+// of ops that don't overlap in time) is never shorter than the real one.
+StepCriticalPaths ConvertHostThreadsXPlaneToCriticalPaths(
+    const XPlane& host_trace);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include <limits>
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/group_events.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_test_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using ::testing::ElementsAre;
+
+// One step runs a:MatMul then c:AddV2 on one executor thread, and b:Relu on
+// another one, concurrently with a:MatMul.
+TEST(ConvertXPlaneToCriticalPaths, ConcurrentOps) {
+  constexpr int64 kStepNum = 123;
+  constexpr int64 kStepId = 0;
+
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(3);
+
+  auto main_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kTraceContext,
+               0, 100, {{StatType::kStepNum, kStepNum}});
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kFunctionRun,
+               10, 90, {{StatType::kStepId, kStepId}});
+
+  auto executor_thread_0 = host_plane_builder.GetOrCreateLine(1);
+  CreateXEvent(&host_plane_builder, &executor_thread_0,
+               HostEventType::kExecutorStateProcess, 20, 60,
+               {{StatType::kStepId, kStepId}});
+  CreateXEvent(&host_plane_builder, &executor_thread_0, "a:MatMul", 20, 20);
+  CreateXEvent(&host_plane_builder, &executor_thread_0, "c:AddV2", 50, 20);
+
+  auto executor_thread_1 = host_plane_builder.GetOrCreateLine(2);
+  CreateXEvent(&host_plane_builder, &executor_thread_1,
+               HostEventType::kExecutorStateProcess, 25, 10,
+               {{StatType::kStepId, kStepId}});
+  CreateXEvent(&host_plane_builder, &executor_thread_1, "b:Relu", 25, 10);
+
+  GroupTfEvents(&space, nullptr);
+  StepCriticalPaths critical_paths =
+      ConvertHostThreadsXPlaneToCriticalPaths(*host_plane);
+  ASSERT_EQ(critical_paths.size(), 1);
+  const StepCriticalPath& step = critical_paths.begin()->second;
+  EXPECT_EQ(step.critical_path_ps, 40);
+  ASSERT_EQ(step.ops.size(), 3);
+  EXPECT_EQ(step.ops[0].name, "a");
+  EXPECT_EQ(step.ops[1].name, "b");
+  EXPECT_EQ(step.ops[2].name, "c");
+  EXPECT_THAT(step.critical_path, ElementsAre(0, 2));
+
+  // Without a:MatMul, b:Relu -> c:AddV2 becomes the critical path.
+  EXPECT_EQ(step.ops[0].slack_ps, 0);
+  EXPECT_DOUBLE_EQ(step.ops[0].projected_speedup, 40.0 / 30.0);
+  EXPECT_EQ(step.ops[1].slack_ps, 10);
+  EXPECT_DOUBLE_EQ(step.ops[1].projected_speedup, 1.0);
+  EXPECT_EQ(step.ops[2].slack_ps, 0);
+  EXPECT_DOUBLE_EQ(step.ops[2].projected_speedup, 2.0);
+}
+
+TEST(ConvertXPlaneToCriticalPaths, SingleOp) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  auto main_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kTraceContext,
+               0, 100, {{StatType::kStepNum, 1}});
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kFunctionRun,
+               10, 90, {{StatType::kStepId, 0}});
+  auto executor_thread = host_plane_builder.GetOrCreateLine(1);
+  CreateXEvent(&host_plane_builder, &executor_thread,
+               HostEventType::kExecutorStateProcess, 20, 20,
+               {{StatType::kStepId, 0}});
+  CreateXEvent(&host_plane_builder, &executor_thread, "a:MatMul", 20, 20);
+
+  GroupTfEvents(&space, nullptr);
+  StepCriticalPaths critical_paths =
+      ConvertHostThreadsXPlaneToCriticalPaths(*host_plane);
+  ASSERT_EQ(critical_paths.size(), 1);
+  const StepCriticalPath& step = critical_paths.begin()->second;
+  EXPECT_EQ(step.critical_path_ps, 20);
+  ASSERT_EQ(step.ops.size(), 1);
+  EXPECT_EQ(step.ops[0].projected_speedup,
+            std::numeric_limits<double>::infinity());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -63,6 +63,9 @@ KernelStatsDb ConvertDeviceTraceXPlaneToKernelStatsDb(
             kernel.set_max_duration_ns(event.DurationNs());
             ParseKernelLaunchParams(stat.StrOrRefValue(), &kernel);
             break;
+          case StatType::kKernelMetrics:
+            ParseKernelMetrics(stat.StrOrRefValue(), &kernel);
+            break;
           case StatType::kEquation:
             equation = stat.StrOrRefValue();
             break;
@@ -15,11 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/xplane_to_kernel_stats_db.h"
 
+#include <vector>
+
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/kernel_stats.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/kernel_stats_utils.h"
 #include "tensorflow/core/profiler/utils/xplane_builder.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_test_utils.h"
@@ -133,6 +136,50 @@ block_z:1)MULTI"},
   EXPECT_EQ(kernel2.op_name(), "Einsum_80");
 }
 
+TEST(ConvertXplaneToKernelStats, SampledKernelMetrics) {
+  XSpace space;
+  XPlane* device_trace = space.add_planes();
+  XPlaneBuilder device_trace_builder(device_trace);
+  XLineBuilder line_builder = device_trace_builder.GetOrCreateLine(0);
+  constexpr absl::string_view kKernelDetails = R"MULTI(registers_per_thread:16
+grid_x:1
+block_x:1)MULTI";
+  CreateXEvent(&device_trace_builder, &line_builder, "kernel_name",
+               /*offset_ps=*/10000, /*duration_ps=*/1000,
+               {{StatType::kLevel0, "mul_786"},
+                {StatType::kKernelDetails, kKernelDetails},
+                {StatType::kKernelMetrics,
+                 "sm_efficiency:90,dram_read_throughput:2e+09"}});
+  CreateXEvent(&device_trace_builder, &line_builder, "kernel_name",
+               /*offset_ps=*/20000, /*duration_ps=*/1000,
+               {{StatType::kLevel0, "mul_786"},
+                {StatType::kKernelDetails, kKernelDetails}});
+  CreateXEvent(&device_trace_builder, &line_builder, "kernel_name",
+               /*offset_ps=*/30000, /*duration_ps=*/1000,
+               {{StatType::kLevel0, "mul_786"},
+                {StatType::kKernelDetails, kKernelDetails},
+                {StatType::kKernelMetrics,
+                 "sm_efficiency:60,dram_read_throughput:1e+09"}});
+  KernelStatsDb kernel_stats =
+      ConvertDeviceTraceXPlaneToKernelStatsDb(*device_trace, {});
+  ASSERT_EQ(kernel_stats.reports_size(), 3);
+  const KernelReport& sampled = kernel_stats.reports(0);
+  EXPECT_EQ(sampled.num_metric_samples(), 1);
+  EXPECT_DOUBLE_EQ(sampled.sampled_metrics().at("sm_efficiency"), 90);
+  EXPECT_EQ(kernel_stats.reports(1).num_metric_samples(), 0);
+
+  std::vector<KernelReport> reports(kernel_stats.reports().begin(),
+                                    kernel_stats.reports().end());
+  KernelStatsDb grouped;
+  GroupKernelReports(&reports, &grouped);
+  ASSERT_EQ(grouped.reports_size(), 1);
+  const KernelReport& kernel = grouped.reports(0);
+  EXPECT_EQ(kernel.occurrences(), 3);
+  EXPECT_EQ(kernel.num_metric_samples(), 2);
+  EXPECT_DOUBLE_EQ(kernel.sampled_metrics().at("sm_efficiency"), 75);
+  EXPECT_DOUBLE_EQ(kernel.sampled_metrics().at("dram_read_throughput"), 1.5e9);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
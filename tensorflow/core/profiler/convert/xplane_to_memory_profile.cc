@@ -24,7 +24,9 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/framework/types.h"
@@ -79,6 +81,75 @@ bool IsMemoryDeallocation(int64 event_type) {
   return event_type == HostEventType::kMemoryDeallocation;
 }
 
+// Parses the bin_occupancy stat of a BFC allocator, a comma-separated list of
+// "bin:bytes_in_use:bytes_in_bin:chunks_in_use:chunks_in_bin".
+void ParseBinOccupancy(absl::string_view bin_occupancy,
+                       BinOccupancySnapshot* snapshot) {
+  for (absl::string_view bin_str :
+       absl::StrSplit(bin_occupancy, ',', absl::SkipEmpty())) {
+    std::vector<absl::string_view> fields = absl::StrSplit(bin_str, ':');
+    int32 bin_index;
+    int64 bytes_in_use, bytes_in_bin, chunks_in_use, chunks_in_bin;
+    if (fields.size() != 5 || !absl::SimpleAtoi(fields[0], &bin_index) ||
+        !absl::SimpleAtoi(fields[1], &bytes_in_use) ||
+        !absl::SimpleAtoi(fields[2], &bytes_in_bin) ||
+        !absl::SimpleAtoi(fields[3], &chunks_in_use) ||
+        !absl::SimpleAtoi(fields[4], &chunks_in_bin)) {
+      VLOG(2) << "Malformed bin occupancy: " << bin_str;
+      continue;
+    }
+    BinOccupancy* bin = snapshot->add_bins();
+    bin->set_bin_index(bin_index);
+    bin->set_bytes_in_use(bytes_in_use);
+    bin->set_bytes_in_bin(bytes_in_bin);
+    bin->set_chunks_in_use(chunks_in_use);
+    bin->set_chunks_in_bin(chunks_in_bin);
+  }
+}
+
+// Adds the chunk split/merge and bin occupancy events of BFC allocators to
+// the memory profile.
+void AddChunkEvent(int64 event_type, const XEventVisitor& event,
+                   MemoryProfile* memory_profile) {
+  std::string memory_id;
+  double fragmentation = 0;
+  absl::string_view bin_occupancy;
+  event.ForEachStat([&](const XStatVisitor& stat) {
+    if (!stat.Type().has_value()) return;
+    switch (stat.Type().value()) {
+      case StatType::kAllocatorName:
+        memory_id = std::string(stat.StrOrRefValue());
+        break;
+      case StatType::kFragmentation:
+        fragmentation = stat.DoubleValue();
+        break;
+      case StatType::kBinOccupancy:
+        bin_occupancy = stat.StrOrRefValue();
+        break;
+    }
+  });
+  PerAllocatorMemoryProfile* allocator_profile =
+      &(*memory_profile->mutable_memory_profile_per_allocator())[memory_id];
+  switch (event_type) {
+    case HostEventType::kMemoryChunkSplit:
+      allocator_profile->set_num_chunk_splits(
+          allocator_profile->num_chunk_splits() + 1);
+      break;
+    case HostEventType::kMemoryChunkMerge:
+      allocator_profile->set_num_chunk_merges(
+          allocator_profile->num_chunk_merges() + 1);
+      break;
+    case HostEventType::kMemoryBinOccupancy: {
+      BinOccupancySnapshot* snapshot =
+          allocator_profile->add_bin_occupancy_snapshots();
+      snapshot->set_time_offset_ps(event.OffsetPs());
+      snapshot->set_fragmentation(fragmentation);
+      ParseBinOccupancy(bin_occupancy, snapshot);
+      break;
+    }
+  }
+}
+
 void FillAggregationStats(const AggregationStats& src,
                           MemoryAggregationStats* dst) {
   dst->set_stack_reserved_bytes(src.bytes_reserved);
@@ -137,6 +208,12 @@ MemoryProfile GenerateMemoryProfile(const XPlane* host_trace) {
   plane.ForEachLine([&](const XLineVisitor& line) {
     line.ForEachEvent([&](const XEventVisitor& event) {
       int64 event_type = event.Type().value_or(kUnknownHostEventType);
+      if (event_type == HostEventType::kMemoryChunkSplit ||
+          event_type == HostEventType::kMemoryChunkMerge ||
+          event_type == HostEventType::kMemoryBinOccupancy) {
+        AddChunkEvent(event_type, event, &memory_profile);
+        return;
+      }
       if (!(IsMemoryAllocation(event_type) ||
             IsMemoryDeallocation(event_type))) {
         return;
@@ -337,6 +414,92 @@ void InsertSpecialAllocations(int64 unmapped_allocation_bytes, int64 step_id,
   }
 }
 
+// Returns the time from each allocation to its matching deallocation, keyed by
+// the index of the allocation in the time-sorted snapshots. Allocations that
+// are not freed within the profiling window are left out.
+absl::flat_hash_map<int64 /*index*/, int64 /*lifetime_ps*/>
+GetAllocationLifetimes(const PerAllocatorMemoryProfile& memory_profile) {
+  absl::flat_hash_map<uint64 /*address*/, int64 /*index*/> alloc_index_map;
+  absl::flat_hash_map<int64, int64> lifetimes;
+  const auto& snapshots = memory_profile.memory_profile_snapshots();
+  for (int i = 0; i < snapshots.size(); i++) {
+    const MemoryActivityMetadata& metadata = snapshots[i].activity_metadata();
+    if (metadata.memory_activity() == ALLOCATION) {
+      // As in UpdateDeallocation, a second allocation recorded for the same
+      // address is ignored.
+      alloc_index_map.emplace(metadata.address(), i);
+    } else if (metadata.memory_activity() == DEALLOCATION) {
+      auto it = alloc_index_map.find(metadata.address());
+      if (it == alloc_index_map.end()) continue;
+      lifetimes[it->second] = snapshots[i].time_offset_ps() -
+                              snapshots[it->second].time_offset_ps();
+      alloc_index_map.erase(it);
+    }
+  }
+  return lifetimes;
+}
+
+// Returns the lifetime range of an allocation, from its lifetime in ps.
+absl::string_view GetLifetimeRange(absl::optional<int64> lifetime_ps) {
+  constexpr int64 kMillisToPs = 1000000000;
+  if (!lifetime_ps.has_value()) return "not freed";
+  if (*lifetime_ps < kMillisToPs) return "< 1 ms";
+  if (*lifetime_ps < 100 * kMillisToPs) return "1 ms to 100 ms";
+  return ">= 100 ms";
+}
+
+void AddToBreakdown(
+    absl::string_view key, const MemoryActivityMetadata& metadata,
+    absl::flat_hash_map<std::string, PeakMemoryBreakdown>* breakdown_map) {
+  if (key.empty()) key = "unknown";
+  PeakMemoryBreakdown& breakdown = (*breakdown_map)[key];
+  breakdown.set_allocation_bytes(breakdown.allocation_bytes() +
+                                 metadata.allocation_bytes());
+  breakdown.set_requested_bytes(breakdown.requested_bytes() +
+                                metadata.requested_bytes());
+  breakdown.set_num_allocations(breakdown.num_allocations() + 1);
+}
+
+void FillBreakdown(
+    absl::flat_hash_map<std::string, PeakMemoryBreakdown>* breakdown_map,
+    protobuf::RepeatedPtrField<PeakMemoryBreakdown>* breakdowns) {
+  for (auto& key_and_breakdown : *breakdown_map) {
+    PeakMemoryBreakdown* breakdown = breakdowns->Add();
+    *breakdown = std::move(key_and_breakdown.second);
+    breakdown->set_key(key_and_breakdown.first);
+  }
+  absl::c_sort(*breakdowns, [](const PeakMemoryBreakdown& a,
+                               const PeakMemoryBreakdown& b) {
+    return std::make_tuple(-a.allocation_bytes(), a.key()) <
+           std::make_tuple(-b.allocation_bytes(), b.key());
+  });
+}
+
+// Sums the active allocations at peak memory usage by TF Op name, tensor shape
+// and lifetime range. The special allocations are persistent, so they are
+// counted as not freed.
+void ProcessPeakMemoryBreakdowns(
+    const std::vector<IndexMetaPair>& active_allocs,
+    PerAllocatorMemoryProfile* memory_profile) {
+  const absl::flat_hash_map<int64, int64> lifetimes =
+      GetAllocationLifetimes(*memory_profile);
+  absl::flat_hash_map<std::string, PeakMemoryBreakdown> by_op, by_shape,
+      by_lifetime;
+  for (const IndexMetaPair& index_and_meta : active_allocs) {
+    const MemoryActivityMetadata& metadata = *index_and_meta.second;
+    AddToBreakdown(metadata.tf_op_name(), metadata, &by_op);
+    AddToBreakdown(metadata.tensor_shape(), metadata, &by_shape);
+    absl::optional<int64> lifetime_ps;
+    auto it = lifetimes.find(index_and_meta.first);
+    if (it != lifetimes.end()) lifetime_ps = it->second;
+    AddToBreakdown(GetLifetimeRange(lifetime_ps), metadata, &by_lifetime);
+  }
+  FillBreakdown(&by_op, memory_profile->mutable_peak_breakdown_by_op());
+  FillBreakdown(&by_shape, memory_profile->mutable_peak_breakdown_by_shape());
+  FillBreakdown(&by_lifetime,
+                memory_profile->mutable_peak_breakdown_by_lifetime());
+}
+
 bool operator==(const IndexMetaPair& a, const IndexMetaPair& b) {
   const MemoryActivityMetadata* a_meta = a.second;
   const MemoryActivityMetadata* b_meta = b.second;
@@ -399,6 +562,8 @@ void ProcessActiveAllocations(int64 peak_bytes_profile_step_id,
                            peak_bytes_profile_step_id, memory_profile,
                            &active_allocs);
 
+  ProcessPeakMemoryBreakdowns(active_allocs, memory_profile);
+
   std::sort(active_allocs.begin(), active_allocs.end(), MetadataComparator());
 
   // Fill the sorted active_allocations proto messages at peak memory usage.
@@ -436,6 +601,24 @@ void SampleSnapshots(
   snapshots->erase(snapshots->begin() + max_num_snapshots, snapshots->end());
 }
 
+// Keeps at most max_num_snapshots time-sorted bin occupancy snapshots, evenly
+// spaced so that the timeline is preserved.
+void SampleBinOccupancySnapshots(
+    int64 max_num_snapshots,
+    protobuf::RepeatedPtrField<BinOccupancySnapshot>* snapshots) {
+  absl::c_sort(*snapshots, [](const BinOccupancySnapshot& a,
+                              const BinOccupancySnapshot& b) {
+    return a.time_offset_ps() < b.time_offset_ps();
+  });
+  if (snapshots->size() <= max_num_snapshots || max_num_snapshots <= 0) return;
+  const double stride =
+      static_cast<double>(snapshots->size()) / max_num_snapshots;
+  for (int64 i = 0; i < max_num_snapshots; i++) {
+    snapshots->SwapElements(i, static_cast<int64>(i * stride));
+  }
+  snapshots->erase(snapshots->begin() + max_num_snapshots, snapshots->end());
+}
+
 // Post-process the memory profile to correctly update proto fields, and break
 // down peak memory usage for each allocator.
 void ProcessMemoryProfileProto(int64 max_num_snapshots,
@@ -472,6 +655,9 @@ void ProcessMemoryProfileProto(int64 max_num_snapshots,
                           allocator_memory_profile);
     ProcessActiveAllocations(peak_step_id, allocator_memory_profile);
     SampleSnapshots(max_num_snapshots, snapshots);
+    SampleBinOccupancySnapshots(
+        max_num_snapshots,
+        allocator_memory_profile->mutable_bin_occupancy_snapshots());
   }
 }
 
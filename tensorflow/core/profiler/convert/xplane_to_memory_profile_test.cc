@@ -115,6 +115,101 @@ TEST(ConvertXPlaneToMemoryProfile, OneAllocatorMultiActivitiesTest) {
       2000);
 }
 
+// Tests the peak memory breakdowns and the BFC chunk and bin events.
+TEST(ConvertXPlaneToMemoryProfile, PeakBreakdownsAndChunkEventsTest) {
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryAllocation",
+               0, 1000,
+               {{StatType::kBytesAllocated, 256LL},
+                {StatType::kPeakBytesInUse, 256LL},
+                {StatType::kRequestedBytes, 200LL},
+                {StatType::kAllocationBytes, 256LL},
+                {StatType::kAddress, 1000LL},
+                {StatType::kAllocatorName, "GPU_0_bfc"},
+                {StatType::kTfOp, "foo"},
+                {StatType::kTensorShapes, "[50]"}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryChunkSplit",
+               5000, 0,
+               {{StatType::kAddress, 2024LL},
+                {StatType::kAllocationBytes, 1024LL},
+                {StatType::kAllocatorName, "GPU_0_bfc"}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryAllocation",
+               10000, 1000,
+               {{StatType::kBytesAllocated, 768LL},
+                {StatType::kPeakBytesInUse, 768LL},
+                {StatType::kRequestedBytes, 400LL},
+                {StatType::kAllocationBytes, 512LL},
+                {StatType::kAddress, 2000LL},
+                {StatType::kAllocatorName, "GPU_0_bfc"},
+                {StatType::kTfOp, "bar"},
+                {StatType::kTensorShapes, "[50]"}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread,
+               "MemoryBinOccupancy", 10000, 0,
+               {{StatType::kAllocatorName, "GPU_0_bfc"},
+                {StatType::kBinOccupancy, "0:256:256:1:1,1:512:1536:1:2"}});
+  // Freed 2 ms after it was allocated.
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryDeallocation",
+               2000000000, 1000,
+               {{StatType::kBytesAllocated, 512LL},
+                {StatType::kPeakBytesInUse, 768LL},
+                {StatType::kRequestedBytes, 200LL},
+                {StatType::kAllocationBytes, 256LL},
+                {StatType::kAddress, 1000LL},
+                {StatType::kAllocatorName, "GPU_0_bfc"}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "MemoryChunkMerge",
+               2000000000, 0,
+               {{StatType::kAddress, 1000LL},
+                {StatType::kAllocationBytes, 1280LL},
+                {StatType::kAllocatorName, "GPU_0_bfc"}});
+
+  MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  EXPECT_EQ(memory_profile.memory_profile_per_allocator().size(), 1);
+  const auto& allocator_memory_profile =
+      memory_profile.memory_profile_per_allocator().at("GPU_0_bfc");
+  EXPECT_EQ(allocator_memory_profile.memory_profile_snapshots_size(), 3);
+  EXPECT_EQ(allocator_memory_profile.special_allocations_size(), 0);
+
+  const auto& by_op = allocator_memory_profile.peak_breakdown_by_op();
+  ASSERT_EQ(by_op.size(), 2);
+  EXPECT_EQ(by_op.at(0).key(), "bar");
+  EXPECT_EQ(by_op.at(0).allocation_bytes(), 512);
+  EXPECT_EQ(by_op.at(0).requested_bytes(), 400);
+  EXPECT_EQ(by_op.at(1).key(), "foo");
+  EXPECT_EQ(by_op.at(1).allocation_bytes(), 256);
+
+  const auto& by_shape = allocator_memory_profile.peak_breakdown_by_shape();
+  ASSERT_EQ(by_shape.size(), 1);
+  EXPECT_EQ(by_shape.at(0).key(), "[50]");
+  EXPECT_EQ(by_shape.at(0).allocation_bytes(), 768);
+  EXPECT_EQ(by_shape.at(0).num_allocations(), 2);
+
+  const auto& by_lifetime =
+      allocator_memory_profile.peak_breakdown_by_lifetime();
+  ASSERT_EQ(by_lifetime.size(), 2);
+  EXPECT_EQ(by_lifetime.at(0).key(), "not freed");
+  EXPECT_EQ(by_lifetime.at(0).allocation_bytes(), 512);
+  EXPECT_EQ(by_lifetime.at(1).key(), "1 ms to 100 ms");
+  EXPECT_EQ(by_lifetime.at(1).allocation_bytes(), 256);
+
+  EXPECT_EQ(allocator_memory_profile.num_chunk_splits(), 1);
+  EXPECT_EQ(allocator_memory_profile.num_chunk_merges(), 1);
+  ASSERT_EQ(allocator_memory_profile.bin_occupancy_snapshots_size(), 1);
+  const auto& bin_snapshot =
+      allocator_memory_profile.bin_occupancy_snapshots(0);
+  EXPECT_EQ(bin_snapshot.time_offset_ps(), 10000);
+  ASSERT_EQ(bin_snapshot.bins_size(), 2);
+  EXPECT_EQ(bin_snapshot.bins(1).bin_index(), 1);
+  EXPECT_EQ(bin_snapshot.bins(1).bytes_in_use(), 512);
+  EXPECT_EQ(bin_snapshot.bins(1).bytes_in_bin(), 1536);
+  EXPECT_EQ(bin_snapshot.bins(1).chunks_in_use(), 1);
+  EXPECT_EQ(bin_snapshot.bins(1).chunks_in_bin(), 2);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
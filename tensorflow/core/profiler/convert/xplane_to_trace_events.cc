@@ -72,7 +72,10 @@ void ConvertXPlaneToTraceEvents(uint32 device_id, const XPlaneVisitor& xplane,
           int64 event_type =
               xevent.Type().value_or(HostEventType::kUnknownHostEventType);
           if (event_type == HostEventType::kMemoryAllocation ||
-              event_type == HostEventType::kMemoryDeallocation) {
+              event_type == HostEventType::kMemoryDeallocation ||
+              event_type == HostEventType::kMemoryChunkSplit ||
+              event_type == HostEventType::kMemoryChunkMerge ||
+              event_type == HostEventType::kMemoryBinOccupancy) {
             return;
           }
           auto* event = trace->add_trace_events();
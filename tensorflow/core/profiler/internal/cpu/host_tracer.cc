@@ -17,12 +17,15 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
-#include "absl/strings/str_split.h"
-#include "absl/strings/string_view.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/internal/cpu/host_tracer_utils.h"
 #include "tensorflow/core/profiler/internal/profiler_factory.h"
@@ -32,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_utils.h"
+#include "tensorflow/core/profiler/utils/xplane_visitor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -39,9 +43,16 @@ namespace tensorflow {
 namespace profiler {
 namespace {
 
+// Interval at which recorded events are converted while tracing.
+constexpr int64 kStreamingIntervalMs = 100;
+
 // Controls TraceMeRecorder and converts TraceMeRecorder::Events into
 // RunMetadata messages.
 //
+// While recording, events are periodically consumed from TraceMeRecorder and
+// converted into an XPlane, so that their names are interned, their memory is
+// released early, and Stop() only has to convert the most recent events.
+//
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public ProfilerInterface {
  public:
@@ -61,6 +72,9 @@ class HostTracer : public ProfilerInterface {
   Status CollectData(XSpace* space) override;
 
  private:
+  // Converts events every kStreamingIntervalMs until Stop() is called.
+  void StreamEvents();
+
   // Level of host tracing.
   const int host_trace_level_;
 
@@ -70,8 +84,14 @@ class HostTracer : public ProfilerInterface {
   // Timestamp at the start of tracing.
   uint64 start_timestamp_ns_ = 0;
 
-  // Container of all traced events.
-  TraceMeRecorder::Events events_;
+  // Traced events, converted to XPlane format.
+  XPlane plane_;
+  std::unique_ptr<StreamingEventsConverter> converter_;
+
+  mutex mutex_;
+  condition_variable stop_cv_;
+  bool stopping_ TF_GUARDED_BY(mutex_) = false;
+  std::unique_ptr<Thread> streaming_thread_;
 };
 
 HostTracer::HostTracer(int host_trace_level)
@@ -88,6 +108,15 @@ Status HostTracer::Start() {
     return errors::Internal("Failed to start TraceMeRecorder");
   }
   start_timestamp_ns_ = EnvTime::NowNanos();
+  plane_.Clear();
+  converter_ =
+      absl::make_unique<StreamingEventsConverter>(start_timestamp_ns_, &plane_);
+  {
+    mutex_lock lock(mutex_);
+    stopping_ = false;
+  }
+  streaming_thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "host_tracer_streaming", [this] { StreamEvents(); }));
   return Status::OK();
 }
 
@@ -95,49 +124,62 @@ Status HostTracer::Stop() {
   if (!recording_) {
     return errors::Internal("TraceMeRecorder not started");
   }
-  events_ = TraceMeRecorder::Stop();
+  {
+    mutex_lock lock(mutex_);
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  streaming_thread_.reset();  // Joins the thread.
+  converter_->Convert(TraceMeRecorder::Stop());
+  converter_->Finish();
+  converter_.reset();
   recording_ = false;
   return Status::OK();
 }
 
+void HostTracer::StreamEvents() {
+  for (;;) {
+    {
+      mutex_lock lock(mutex_);
+      if (!stopping_) {
+        WaitForMilliseconds(&lock, &stop_cv_, kStreamingIntervalMs);
+      }
+      if (stopping_) return;
+    }
+    converter_->Convert(TraceMeRecorder::Consume());
+  }
+}
+
 Status HostTracer::CollectData(RunMetadata* run_metadata) {
   if (recording_) {
     return errors::Internal("TraceMeRecorder not stopped");
   }
-  MakeCompleteEvents(&events_);
-
   StepStats* step_stats = run_metadata->mutable_step_stats();
   DeviceStepStats* dev_stats = step_stats->add_dev_stats();
   dev_stats->set_device("/host:CPU");
   auto* thread_names = dev_stats->mutable_thread_names();
 
-  constexpr char kUserMetadataMarker = '#';
-  for (TraceMeRecorder::ThreadEvents& thread : events_) {
-    thread_names->insert({thread.thread.tid, thread.thread.name});
-    for (TraceMeRecorder::Event& event : thread.events) {
-      if (event.start_time && event.end_time) {
-        NodeExecStats* ns = dev_stats->add_node_stats();
-        if (event.name.back() != kUserMetadataMarker) {
-          ns->set_node_name(std::move(event.name));
-        } else {
-          // Expect the format will be "<name>#<metadata>#"
-          std::vector<absl::string_view> parts =
-              absl::StrSplit(event.name, kUserMetadataMarker);
-          if (parts.size() >= 2) {
-            ns->set_node_name(std::string(parts[0]));
-            ns->set_timeline_label(std::string(parts[1]));
-          } else {
-            ns->set_node_name(std::move(event.name));
-          }
-        }
-        ns->set_all_start_micros(event.start_time / EnvTime::kMicrosToNanos);
-        ns->set_all_end_rel_micros((event.end_time - event.start_time) /
-                                   EnvTime::kMicrosToNanos);
-        ns->set_thread_id(thread.thread.tid);
+  XPlaneVisitor plane(&plane_);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    thread_names->insert(
+        {static_cast<uint32>(line.Id()), std::string(line.Name())});
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      NodeExecStats* ns = dev_stats->add_node_stats();
+      ns->set_node_name(std::string(event.Name()));
+      // The metadata of "<name>#<metadata>#" was parsed into stats.
+      std::vector<std::string> metadata;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        metadata.push_back(absl::StrCat(stat.Name(), "=", stat.ToString()));
+      });
+      if (!metadata.empty()) {
+        ns->set_timeline_label(absl::StrJoin(metadata, ","));
       }
-    }
-  }
-  events_.clear();
+      ns->set_all_start_micros(event.TimestampPs() / EnvTime::kMicrosToPicos);
+      ns->set_all_end_rel_micros(event.DurationPs() / EnvTime::kMicrosToPicos);
+      ns->set_thread_id(line.Id());
+    });
+  });
+  plane_.Clear();
   return Status::OK();
 }
 
@@ -145,10 +187,18 @@ Status HostTracer::CollectData(XSpace* space) {
   if (recording_) {
     return errors::Internal("TraceMeRecorder not stopped");
   }
-  MakeCompleteEvents(&events_);
   XPlane* plane = FindOrAddMutablePlaneWithName(space, kHostThreadsPlaneName);
-  ConvertCompleteEventsToXPlane(start_timestamp_ns_, events_, plane);
-  events_.clear();
+  if (plane->lines_size() == 0 && plane->event_metadata_size() == 0 &&
+      plane->stat_metadata_size() == 0 && plane->stats_size() == 0) {
+    // Hand over the converted events without copying them.
+    plane_.set_id(plane->id());
+    plane_.set_name(plane->name());
+    plane->Swap(&plane_);
+  } else {
+    MergePlanes(plane_, plane);
+    SortXLinesBy(plane, XLinesComparatorByName());
+  }
+  plane_.Clear();
   return Status::OK();
 }
 
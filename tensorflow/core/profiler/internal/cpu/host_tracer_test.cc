@@ -109,8 +109,9 @@ TEST(HostTracerTest, CollectsTraceMeEventsAsRunMetadata) {
           EqualsNodeStats(MakeNodeStats("good", thread_id, "key1=value1")),
           EqualsNodeStats(
               MakeNodeStats("morning", thread_id, "key1=value1,key2=value2")),
+          // Metadata that isn't a key=value pair is dropped.
           EqualsNodeStats(
-              MakeNodeStats("incomplete", thread_id, "key1=value1,key2"))));
+              MakeNodeStats("incomplete", thread_id, "key1=value1"))));
 }
 
 TEST(HostTracerTest, CollectsTraceMeEventsAsXSpace) {
@@ -224,6 +225,31 @@ TEST(HostTracerTest, CollectsTraceMeEventsAsXSpace) {
   EXPECT_EQ(e6.DisplayName(), "Iterator::ParallelMap");
 }
 
+TEST(HostTracerTest, ConvertsEventsWhileRecording) {
+  uint32 thread_id = Env::Default()->GetCurrentThreadId();
+
+  auto tracer = CreateHostTracer(ProfilerSession::DefaultOptions());
+
+  TF_ASSERT_OK(tracer->Start());
+  { TraceMe traceme("before"); }
+  uint64 activity_id = TraceMe::ActivityStart("across");
+  // Let the tracer convert the events recorded so far.
+  Env::Default()->SleepForMicroseconds(300 * 1000);
+  TraceMe::ActivityEnd(activity_id);
+  { TraceMe traceme("after"); }
+  TF_ASSERT_OK(tracer->Stop());
+
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(tracer->CollectData(&run_metadata));
+
+  EXPECT_EQ(run_metadata.step_stats().dev_stats_size(), 1);
+  EXPECT_THAT(run_metadata.step_stats().dev_stats(0).node_stats(),
+              UnorderedElementsAre(
+                  EqualsNodeStats(MakeNodeStats("before", thread_id)),
+                  EqualsNodeStats(MakeNodeStats("across", thread_id)),
+                  EqualsNodeStats(MakeNodeStats("after", thread_id))));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
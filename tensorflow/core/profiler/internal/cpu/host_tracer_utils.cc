@@ -30,6 +30,29 @@ limitations under the License.
 
 namespace tensorflow {
 namespace profiler {
+namespace {
+
+void AddCompleteEvent(const TraceMeRecorder::Event& event,
+                      XPlaneBuilder* xplane, XLineBuilder* xline) {
+  Annotation annotation = ParseAnnotation(event.name);
+  XEventMetadata* xevent_metadata =
+      xplane->GetOrCreateEventMetadata(annotation.name);
+  std::string tf_op_event_name = TfOpEventName(annotation.name);
+  if (tf_op_event_name != annotation.name) {
+    xevent_metadata->set_display_name(std::move(tf_op_event_name));
+  }
+  XEventBuilder xevent = xline->AddEvent(*xevent_metadata);
+  xevent.SetTimestampNs(event.start_time);
+  xevent.SetEndTimestampNs(event.end_time);
+  xevent.ReserveStats(annotation.metadata.size());
+  for (const auto& metadata : annotation.metadata) {
+    XStatMetadata* xstat_metadata =
+        xplane->GetOrCreateStatMetadata(metadata.key);
+    xevent.ParseAndAddStatValue(*xstat_metadata, metadata.value);
+  }
+}
+
+}  // namespace
 
 void MakeCompleteEvents(TraceMeRecorder::Events* events) {
   // Track events created by ActivityStart and copy their data to events created
@@ -79,26 +102,47 @@ void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
     xline.SetTimestampNs(start_timestamp_ns);
     xline.ReserveEvents(thread.events.size());
     for (const auto& event : thread.events) {
-      if (!IsCompleteEvent(event)) continue;
-      Annotation annotation = ParseAnnotation(event.name);
-      XEventMetadata* xevent_metadata =
-          xplane.GetOrCreateEventMetadata(annotation.name);
-      std::string tf_op_event_name = TfOpEventName(annotation.name);
-      if (tf_op_event_name != annotation.name) {
-        xevent_metadata->set_display_name(std::move(tf_op_event_name));
+      if (IsCompleteEvent(event)) AddCompleteEvent(event, &xplane, &xline);
+    }
+  }
+  SortXLinesBy(raw_plane, XLinesComparatorByName());
+}
+
+StreamingEventsConverter::StreamingEventsConverter(uint64 start_timestamp_ns,
+                                                   XPlane* raw_plane)
+    : start_timestamp_ns_(start_timestamp_ns),
+      raw_plane_(raw_plane),
+      xplane_(raw_plane) {}
+
+void StreamingEventsConverter::Convert(TraceMeRecorder::Events events) {
+  // Collect the start events first, since their end event may have been
+  // recorded by any thread.
+  for (auto& thread : events) {
+    for (auto& event : thread.events) {
+      if (IsStartEvent(event)) {
+        start_events_.emplace(event.activity_id, std::move(event));
       }
-      XEventBuilder xevent = xline.AddEvent(*xevent_metadata);
-      xevent.SetTimestampNs(event.start_time);
-      xevent.SetEndTimestampNs(event.end_time);
-      xevent.ReserveStats(annotation.metadata.size());
-      for (const auto& metadata : annotation.metadata) {
-        XStatMetadata* xstat_metadata =
-            xplane.GetOrCreateStatMetadata(metadata.key);
-        xevent.ParseAndAddStatValue(*xstat_metadata, metadata.value);
+    }
+  }
+  for (auto& thread : events) {
+    XLineBuilder xline = xplane_.GetOrCreateLine(thread.thread.tid);
+    xline.SetName(thread.thread.name);
+    xline.SetTimestampNs(start_timestamp_ns_);
+    for (auto& event : thread.events) {
+      if (IsEndEvent(event)) {
+        auto iter = start_events_.find(event.activity_id);
+        if (iter == start_events_.end()) continue;
+        event.name = std::move(iter->second.name);
+        event.start_time = iter->second.start_time;
+        start_events_.erase(iter);
       }
+      if (IsCompleteEvent(event)) AddCompleteEvent(event, &xplane_, &xline);
     }
   }
-  SortXLinesBy(raw_plane, XLinesComparatorByName());
+}
+
+void StreamingEventsConverter::Finish() {
+  SortXLinesBy(raw_plane_, XLinesComparatorByName());
 }
 
 }  // namespace profiler
@@ -15,9 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_HOST_TRACER_UTILS_H_
 #define TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_HOST_TRACER_UTILS_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/internal/traceme_recorder.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
 
 namespace tensorflow {
 namespace profiler {
@@ -47,6 +49,29 @@ void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
                                    const TraceMeRecorder::Events& events,
                                    XPlane* raw_plane);
 
+// Converts events to XPlane format in batches, e.g. as they are consumed from
+// TraceMeRecorder while recording. Event names are interned as XPlane event
+// metadata, so the plane grows by a small fixed-size XEvent per event.
+// Events created by TraceMe::ActivityStart are kept until the matching event
+// created by TraceMe::ActivityEnd is converted, possibly in a later batch.
+class StreamingEventsConverter {
+ public:
+  StreamingEventsConverter(uint64 start_timestamp_ns, XPlane* raw_plane);
+
+  // Converts the complete events in `events`.
+  void Convert(TraceMeRecorder::Events events);
+
+  // Sorts the lines of the plane. Call after the last Convert().
+  void Finish();
+
+ private:
+  const uint64 start_timestamp_ns_;
+  XPlane* raw_plane_;
+  XPlaneBuilder xplane_;
+  // Events created by TraceMe::ActivityStart, by activity_id.
+  absl::flat_hash_map<uint64, TraceMeRecorder::Event> start_events_;
+};
+
 }  // namespace profiler
 }  // namespace tensorflow
 
@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/cpu/sampling_host_tracer.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/internal/cpu/host_tracer_utils.h"
+#include "tensorflow/core/profiler/internal/traceme_recorder.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+SamplingHostTracer::SamplingHostTracer(const Options& options)
+    : options_(options) {
+  if (options_.period_ms > 0) {
+    sampling_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "sampling_host_tracer", [this] { SamplingLoop(); }));
+  }
+}
+
+SamplingHostTracer::~SamplingHostTracer() {
+  {
+    mutex_lock lock(mutex_);
+    stopping_ = true;
+  }
+  stop_cv_.notify_all();
+  sampling_thread_.reset();  // Joins the thread.
+  StopSlice();
+}
+
+bool SamplingHostTracer::StartSlice() {
+  mutex_lock slice_lock(slice_mutex_);
+  if (recording_) return false;
+  recording_ = TraceMeRecorder::Start(options_.host_trace_level,
+                                      options_.max_events_per_thread);
+  slice_start_timestamp_ns_ = EnvTime::NowNanos();
+  return recording_;
+}
+
+void SamplingHostTracer::StopSlice() {
+  mutex_lock slice_lock(slice_mutex_);
+  if (!recording_) return;
+  TraceMeRecorder::Events events = TraceMeRecorder::Stop();
+  recording_ = false;
+
+  // Converting is done without holding mutex_, so readers aren't blocked.
+  MakeCompleteEvents(&events);
+  XPlane plane;
+  ConvertCompleteEventsToXPlane(slice_start_timestamp_ns_, events, &plane);
+  OpMetricsDb slice_db = ConvertHostThreadsXPlaneToOpMetricsDb(plane);
+
+  mutex_lock lock(mutex_);
+  combiner_.Combine(slice_db);
+  ++num_slices_;
+}
+
+OpMetricsDb SamplingHostTracer::GetOpMetricsDb() const {
+  mutex_lock lock(mutex_);
+  return op_metrics_db_;
+}
+
+int64 SamplingHostTracer::NumSlices() const {
+  mutex_lock lock(mutex_);
+  return num_slices_;
+}
+
+void SamplingHostTracer::SamplingLoop() {
+  // Waits until deadline_ns, returning false if the tracer is being destroyed.
+  auto wait_until = [this](uint64 deadline_ns) {
+    mutex_lock lock(mutex_);
+    while (!stopping_) {
+      const uint64 now_ns = EnvTime::NowNanos();
+      if (now_ns >= deadline_ns) return true;
+      WaitForMilliseconds(&lock, &stop_cv_,
+                          (deadline_ns - now_ns) / EnvTime::kMillisToNanos + 1);
+    }
+    return false;
+  };
+  const uint64 slice_ns = options_.slice_ms * EnvTime::kMillisToNanos;
+  const uint64 period_ns = options_.period_ms * EnvTime::kMillisToNanos;
+  for (;;) {
+    const uint64 period_start_ns = EnvTime::NowNanos();
+    StartSlice();
+    const bool running = wait_until(period_start_ns + slice_ns);
+    StopSlice();
+    if (!running || !wait_until(period_start_ns + period_ns)) return;
+  }
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
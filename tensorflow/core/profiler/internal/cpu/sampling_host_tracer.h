@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_SAMPLING_HOST_TRACER_H_
+#define TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_SAMPLING_HOST_TRACER_H_
+
+#include <memory>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Records host TraceMes for short slices of time and aggregates them into a
+// cumulative OpMetricsDb, so that it can be left on in production.
+//
+// By default a background thread records one slice of slice_ms at the start
+// of every period_ms, which bounds the overhead by slice_ms / period_ms (the
+// defaults sample 0.5s per minute). Each thread keeps at most
+// max_events_per_thread events per slice, so memory is bounded too.
+//
+// With period_ms = 0 no thread is started, and the caller brackets the work
+// to sample with StartSlice() / StopSlice(), e.g. once every N steps.
+//
+// A slice is skipped while another profiler (e.g. a ProfilerSession) is
+// recording TraceMes, and such a profiler can't start during a slice.
+//
+// Thread-safety: This class is thread-safe.
+class SamplingHostTracer {
+ public:
+  struct Options {
+    // Time between the starts of two consecutive slices.
+    int64 period_ms = 60000;
+    // Time recorded per slice.
+    int64 slice_ms = 500;
+    // Only TraceMes <= host_trace_level are recorded.
+    int host_trace_level = 1;
+    // Events recorded past this many on one thread during a slice are
+    // dropped.
+    size_t max_events_per_thread = 1 << 16;
+  };
+
+  explicit SamplingHostTracer(const Options& options);
+
+  // Stops the background thread and any slice being recorded.
+  ~SamplingHostTracer();
+
+  // Starts recording a slice. Returns false if a slice is already being
+  // recorded, or another profiler is active.
+  bool StartSlice();
+
+  // Stops recording the current slice and folds its TF ops into the
+  // aggregated OpMetricsDb. Does nothing if no slice is being recorded.
+  void StopSlice();
+
+  // Returns the op metrics aggregated over all slices so far.
+  OpMetricsDb GetOpMetricsDb() const;
+
+  // Returns the number of slices aggregated so far.
+  int64 NumSlices() const;
+
+ private:
+  void SamplingLoop();
+
+  const Options options_;
+
+  mutable mutex mutex_;
+  condition_variable stop_cv_;
+  bool stopping_ TF_GUARDED_BY(mutex_) = false;
+
+  // Serializes StartSlice/StopSlice, which convert events outside mutex_.
+  mutex slice_mutex_;
+  bool recording_ TF_GUARDED_BY(slice_mutex_) = false;
+  uint64 slice_start_timestamp_ns_ TF_GUARDED_BY(slice_mutex_) = 0;
+
+  OpMetricsDb op_metrics_db_ TF_GUARDED_BY(mutex_);
+  // Indexes op_metrics_db_, so each slice adds to the existing entries.
+  OpMetricsDbCombiner combiner_ TF_GUARDED_BY(mutex_){&op_metrics_db_};
+  int64 num_slices_ TF_GUARDED_BY(mutex_) = 0;
+
+  std::unique_ptr<Thread> sampling_thread_;
+};
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_INTERNAL_CPU_SAMPLING_HOST_TRACER_H_
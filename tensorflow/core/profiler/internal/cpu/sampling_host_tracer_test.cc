@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/internal/cpu/sampling_host_tracer.h"
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/traceme_recorder.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Returns the occurrences of the op named `name` in `db`.
+uint32 Occurrences(const OpMetricsDb& db, absl::string_view name) {
+  for (const OpMetrics& metrics : db.metrics_db()) {
+    if (metrics.name() == name) return metrics.occurrences();
+  }
+  return 0;
+}
+
+SamplingHostTracer::Options ManualOptions() {
+  SamplingHostTracer::Options options;
+  options.period_ms = 0;
+  return options;
+}
+
+TEST(SamplingHostTracerTest, SamplesEveryOtherStep) {
+  SamplingHostTracer tracer(ManualOptions());
+  for (int step = 0; step < 4; ++step) {
+    const bool sampled = step % 2 == 0 && tracer.StartSlice();
+    { TraceMe traceme("matmul:MatMul"); }
+    if (sampled) tracer.StopSlice();
+  }
+  EXPECT_EQ(tracer.NumSlices(), 2);
+  EXPECT_EQ(Occurrences(tracer.GetOpMetricsDb(), "matmul"), 2);
+}
+
+TEST(SamplingHostTracerTest, BoundsEventsPerThread) {
+  SamplingHostTracer::Options options = ManualOptions();
+  options.max_events_per_thread = 2;
+  SamplingHostTracer tracer(options);
+  ASSERT_TRUE(tracer.StartSlice());
+  for (int i = 0; i < 5; ++i) {
+    TraceMe traceme("add:AddV2");
+  }
+  tracer.StopSlice();
+  EXPECT_EQ(Occurrences(tracer.GetOpMetricsDb(), "add"), 2);
+}
+
+TEST(SamplingHostTracerTest, SkipsSliceWhileAnotherProfilerIsActive) {
+  SamplingHostTracer tracer(ManualOptions());
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  EXPECT_FALSE(tracer.StartSlice());
+  tracer.StopSlice();
+  TraceMeRecorder::Stop();
+  EXPECT_EQ(tracer.NumSlices(), 0);
+}
+
+TEST(SamplingHostTracerTest, SamplesInBackground) {
+  SamplingHostTracer::Options options;
+  options.period_ms = 20;
+  options.slice_ms = 10;
+  SamplingHostTracer tracer(options);
+  while (tracer.NumSlices() < 2) {
+    TraceMe traceme("relu:Relu");
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_GT(Occurrences(tracer.GetOpMetricsDb(), "relu"), 0);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/internal/gpu/cupti_tracer.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
@@ -419,6 +421,8 @@ void AddKernelActivityEvent(CuptiTraceCollector *collector,
   event.correlation_id = kernel->correlationId;
   event.annotation = collector->annotation_map()->LookUp(event.device_id,
                                                          event.correlation_id);
+  event.kernel_metrics = collector->kernel_metrics_map()->LookUp(
+      event.device_id, event.correlation_id);
   event.kernel_info.registers_per_thread = kernel->registersPerThread;
   event.kernel_info.static_shared_memory_usage = kernel->staticSharedMemory;
   event.kernel_info.dynamic_shared_memory_usage = kernel->dynamicSharedMemory;
@@ -947,6 +951,8 @@ class CudaEventRecorder {
     event.correlation_id = record.correlation_id;
     event.annotation =
         annotation_map->LookUp(event.device_id, event.correlation_id);
+    event.kernel_metrics = collector_->kernel_metrics_map()->LookUp(
+        event.device_id, event.correlation_id);
     event.kernel_info = record.details;
     collector_->AddEvent(std::move(event));
     return Status::OK();
@@ -1264,6 +1270,268 @@ class CuptiDriverApiHookWithCudaEvent : public CuptiDriverApiHook {
 
 }  // namespace
 
+// Collects CUPTI metrics for one kernel launch out of every sampling period.
+// The context is synchronized before the sampled launch, so that the counters
+// only see that kernel, and after it, so that they can be read. Kernels
+// launched concurrently from other threads are still counted, since CUPTI
+// counters are per context.
+class CuptiKernelMetricSampler {
+ public:
+  CuptiKernelMetricSampler(const std::vector<std::string> &metric_names,
+                           int sampling_period, CuptiInterface *cupti_interface,
+                           CuptiTraceCollector *collector)
+      : metric_names_(metric_names),
+        sampling_period_(std::max(sampling_period, 1)),
+        cupti_interface_(cupti_interface),
+        collector_(collector) {}
+
+  ~CuptiKernelMetricSampler() {
+    for (auto &context_and_metrics : context_metrics_) {
+      if (context_and_metrics.second.event_group_sets != nullptr) {
+        cupti_interface_->EventGroupSetsDestroy(
+            context_and_metrics.second.event_group_sets);
+      }
+    }
+  }
+
+  // Starts collecting the metrics if this launch is sampled.
+  Status OnKernelLaunchEnter(uint32 device_id,
+                             const CUpti_CallbackData *cbdata) {
+    absl::MutexLock lock(&mutex_);
+    if (sampled_metrics_ != nullptr) return Status::OK();
+    if (num_launches_++ % sampling_period_ != 0) return Status::OK();
+    ContextMetrics *metrics = GetContextMetrics(device_id, cbdata->context);
+    if (metrics->metric_ids.empty()) return Status::OK();
+
+    CuptiApiTracingDisabler disabler;
+    TF_RETURN_IF_ERROR(ToStatus(cuCtxSynchronize()));
+    if (metrics->event_group_sets->numSets > 1) {
+      RETURN_IF_CUPTI_ERROR(
+          cupti_interface_->EnableKernelReplayMode(cbdata->context));
+    }
+    Status status = SetEventGroupsEnabled(*metrics, true);
+    if (!status.ok()) {
+      DisableEventGroups(*metrics, cbdata->context);
+      return status;
+    }
+    sampled_metrics_ = metrics;
+    sampled_correlation_id_ = cbdata->correlationId;
+    sample_start_tsc_ = CuptiTracer::GetTimestamp();
+    return Status::OK();
+  }
+
+  // Reads the metrics of the sampled launch and adds them to the collector's
+  // kernel metrics map.
+  Status OnKernelLaunchExit(uint32 device_id,
+                            const CUpti_CallbackData *cbdata) {
+    absl::MutexLock lock(&mutex_);
+    if (sampled_metrics_ == nullptr ||
+        sampled_correlation_id_ != cbdata->correlationId) {
+      return Status::OK();
+    }
+    const ContextMetrics &metrics = *sampled_metrics_;
+    sampled_metrics_ = nullptr;
+
+    CuptiApiTracingDisabler disabler;
+    Status status = ToStatus(cuCtxSynchronize());
+    uint64 duration_ns = CuptiTracer::GetTimestamp() - sample_start_tsc_;
+    std::string metric_values;
+    if (status.ok()) status = ReadMetrics(metrics, duration_ns, &metric_values);
+    DisableEventGroups(metrics, cbdata->context);
+    TF_RETURN_IF_ERROR(status);
+    collector_->kernel_metrics_map()->Add(device_id, cbdata->correlationId,
+                                          metric_values);
+    return Status::OK();
+  }
+
+ private:
+  struct ContextMetrics {
+    CUdevice device;
+    // The supported metrics, with the events each one is computed from.
+    std::vector<std::string> metric_names;
+    std::vector<CUpti_MetricID> metric_ids;
+    std::vector<CUpti_MetricValueKind> metric_kinds;
+    std::vector<std::vector<CUpti_EventID>> metric_events;
+    CUpti_EventGroupSets *event_group_sets = nullptr;
+  };
+
+  // Returns the metrics of the given context, setting up its event groups the
+  // first time. No metrics are collected for a context whose set up failed.
+  ContextMetrics *GetContextMetrics(uint32 device_id, CUcontext context)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    auto it = context_metrics_.find(context);
+    if (it != context_metrics_.end()) return &it->second;
+    ContextMetrics *metrics = &context_metrics_[context];
+    Status status = InitContextMetrics(device_id, context, metrics);
+    if (!status.ok()) {
+      LOG(ERROR) << "Kernel metrics disabled for device " << device_id << ": "
+                 << status.error_message();
+      metrics->metric_ids.clear();
+    }
+    return metrics;
+  }
+
+  Status InitContextMetrics(uint32 device_id, CUcontext context,
+                            ContextMetrics *metrics) {
+    CuptiApiTracingDisabler disabler;
+    TF_RETURN_IF_ERROR(ToStatus(cuCtxGetDevice(&metrics->device)));
+    std::vector<CUpti_EventID> all_events;
+    for (const std::string &name : metric_names_) {
+      CUpti_MetricID metric_id;
+      if (cupti_interface_->MetricGetIdFromName(metrics->device, name.c_str(),
+                                                &metric_id) != CUPTI_SUCCESS) {
+        LOG(WARNING) << "CUPTI metric " << name
+                     << " is not supported on device " << device_id;
+        continue;
+      }
+      CUpti_MetricValueKind kind;
+      size_t size = sizeof(kind);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->MetricGetAttribute(
+          metric_id, CUPTI_METRIC_ATTR_VALUE_KIND, &size, &kind));
+      uint32_t num_events = 0;
+      RETURN_IF_CUPTI_ERROR(
+          cupti_interface_->MetricGetNumEvents(metric_id, &num_events));
+      std::vector<CUpti_EventID> events(num_events);
+      size = num_events * sizeof(CUpti_EventID);
+      RETURN_IF_CUPTI_ERROR(
+          cupti_interface_->MetricEnumEvents(metric_id, &size, events.data()));
+      all_events.insert(all_events.end(), events.begin(), events.end());
+      metrics->metric_names.push_back(name);
+      metrics->metric_ids.push_back(metric_id);
+      metrics->metric_kinds.push_back(kind);
+      metrics->metric_events.push_back(std::move(events));
+    }
+    if (metrics->metric_ids.empty()) return Status::OK();
+
+    std::sort(all_events.begin(), all_events.end());
+    all_events.erase(std::unique(all_events.begin(), all_events.end()),
+                     all_events.end());
+    RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupSetsCreate(
+        context, all_events.size() * sizeof(CUpti_EventID), all_events.data(),
+        &metrics->event_group_sets));
+    // Count over all the instances of each event domain, not only those of
+    // the first SM.
+    uint32_t profile_all_instances = 1;
+    for (const CUpti_EventGroup &group : EventGroups(*metrics)) {
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupSetAttribute(
+          group, CUPTI_EVENT_GROUP_ATTR_PROFILE_ALL_DOMAIN_INSTANCES,
+          sizeof(profile_all_instances), &profile_all_instances));
+    }
+    return Status::OK();
+  }
+
+  static std::vector<CUpti_EventGroup> EventGroups(
+      const ContextMetrics &metrics) {
+    std::vector<CUpti_EventGroup> groups;
+    const CUpti_EventGroupSets *sets = metrics.event_group_sets;
+    for (uint32_t i = 0; i < sets->numSets; ++i) {
+      const CUpti_EventGroupSet &set = sets->sets[i];
+      groups.insert(groups.end(), set.eventGroups,
+                    set.eventGroups + set.numEventGroups);
+    }
+    return groups;
+  }
+
+  Status SetEventGroupsEnabled(const ContextMetrics &metrics, bool enabled) {
+    for (const CUpti_EventGroup &group : EventGroups(metrics)) {
+      RETURN_IF_CUPTI_ERROR(enabled
+                                ? cupti_interface_->EventGroupEnable(group)
+                                : cupti_interface_->EventGroupDisable(group));
+    }
+    return Status::OK();
+  }
+
+  void DisableEventGroups(const ContextMetrics &metrics, CUcontext context) {
+    LogIfError(SetEventGroupsEnabled(metrics, false));
+    if (metrics.event_group_sets->numSets > 1) {
+      cupti_interface_->DisableKernelReplayMode(context);
+    }
+  }
+
+  // Appends "name:value" for each metric to metric_values, computed from the
+  // events counted for the duration_ns long sample.
+  Status ReadMetrics(const ContextMetrics &metrics, uint64 duration_ns,
+                     std::string *metric_values) {
+    absl::flat_hash_map<CUpti_EventID, uint64_t> event_values;
+    for (const CUpti_EventGroup &group : EventGroups(metrics)) {
+      uint32_t num_instances = 0;
+      size_t size = sizeof(num_instances);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+          group, CUPTI_EVENT_GROUP_ATTR_INSTANCE_COUNT, &size, &num_instances));
+      uint32_t num_events = 0;
+      size = sizeof(num_events);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+          group, CUPTI_EVENT_GROUP_ATTR_NUM_EVENTS, &size, &num_events));
+      std::vector<CUpti_EventID> events(num_events);
+      size = num_events * sizeof(CUpti_EventID);
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupGetAttribute(
+          group, CUPTI_EVENT_GROUP_ATTR_EVENTS, &size, events.data()));
+      std::vector<uint64_t> instance_values(num_instances);
+      for (CUpti_EventID event : events) {
+        size = num_instances * sizeof(uint64_t);
+        RETURN_IF_CUPTI_ERROR(cupti_interface_->EventGroupReadEvent(
+            group, CUPTI_EVENT_READ_FLAG_NONE, event, &size,
+            instance_values.data()));
+        uint64_t &value = event_values[event];
+        for (uint64_t instance_value : instance_values) value += instance_value;
+      }
+    }
+
+    for (size_t i = 0; i < metrics.metric_ids.size(); ++i) {
+      std::vector<CUpti_EventID> events = metrics.metric_events[i];
+      std::vector<uint64_t> values;
+      values.reserve(events.size());
+      for (CUpti_EventID event : events) values.push_back(event_values[event]);
+      CUpti_MetricValue value;
+      RETURN_IF_CUPTI_ERROR(cupti_interface_->MetricGetValue(
+          metrics.device, metrics.metric_ids[i],
+          events.size() * sizeof(CUpti_EventID), events.data(),
+          values.size() * sizeof(uint64_t), values.data(), duration_ns,
+          &value));
+      absl::StrAppend(metric_values, metric_values->empty() ? "" : ",",
+                      metrics.metric_names[i], ":",
+                      MetricValueToDouble(metrics.metric_kinds[i], value));
+    }
+    return Status::OK();
+  }
+
+  static double MetricValueToDouble(CUpti_MetricValueKind kind,
+                                    const CUpti_MetricValue &value) {
+    switch (kind) {
+      case CUPTI_METRIC_VALUE_KIND_DOUBLE:
+        return value.metricValueDouble;
+      case CUPTI_METRIC_VALUE_KIND_UINT64:
+        return value.metricValueUint64;
+      case CUPTI_METRIC_VALUE_KIND_INT64:
+        return value.metricValueInt64;
+      case CUPTI_METRIC_VALUE_KIND_PERCENT:
+        return value.metricValuePercent;
+      case CUPTI_METRIC_VALUE_KIND_THROUGHPUT:
+        return value.metricValueThroughput;
+      case CUPTI_METRIC_VALUE_KIND_UTILIZATION_LEVEL:
+        return value.metricValueUtilizationLevel;
+      default:
+        return 0;
+    }
+  }
+
+  const std::vector<std::string> metric_names_;
+  const int sampling_period_;
+  CuptiInterface *cupti_interface_;
+  CuptiTraceCollector *collector_;
+
+  absl::Mutex mutex_;
+  uint64 num_launches_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::node_hash_map<CUcontext, ContextMetrics> context_metrics_
+      ABSL_GUARDED_BY(mutex_);
+  // The metrics being collected, if a launch is being sampled.
+  const ContextMetrics *sampled_metrics_ ABSL_GUARDED_BY(mutex_) = nullptr;
+  uint32 sampled_correlation_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64 sample_start_tsc_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CuptiKernelMetricSampler);
+};
+
 /*static*/ Status CuptiDriverApiHook::AddDriverApiCallbackEvent(
     CuptiTraceCollector *collector, CuptiInterface *cupti_interface,
     int device_id, uint64 start_tsc, uint64 end_tsc,
@@ -1370,6 +1638,11 @@ absl::string_view AnnotationMap::LookUp(uint32 device_id,
                                                     : absl::string_view();
 }
 
+CuptiTracer::CuptiTracer(CuptiInterface *cupti_interface)
+    : num_gpus_(NumGpus()), cupti_interface_(cupti_interface) {}
+
+CuptiTracer::~CuptiTracer() {}
+
 /* static */ CuptiTracer *CuptiTracer::GetCuptiTracerSingleton() {
   static auto *singleton = new CuptiTracer(GetCuptiInterface());
   return singleton;
@@ -1407,6 +1680,12 @@ void CuptiTracer::Enable(const CuptiTracerOptions &option,
         option, cupti_interface_, collector));
   }
 
+  if (!option_->kernel_metrics.empty()) {
+    kernel_metric_sampler_ = absl::make_unique<CuptiKernelMetricSampler>(
+        option_->kernel_metrics, option_->kernel_metrics_sampling_period,
+        cupti_interface_, collector);
+  }
+
   Status status = EnableApiTracing();
   need_root_access_ |= status.code() == error::PERMISSION_DENIED;
   if (!status.ok()) return;
@@ -1428,6 +1707,7 @@ void CuptiTracer::Disable() {
   collector_ = nullptr;
   option_.reset();
   cupti_driver_api_hook_.reset();
+  kernel_metric_sampler_.reset();
 }
 
 Status CuptiTracer::EnableApiTracing() {
@@ -1557,7 +1837,17 @@ Status CuptiTracer::HandleCallback(CUpti_CallbackDomain domain,
     return errors::Internal("Invalid device id:", device_id);
   }
 
+  // The kernel metrics are collected inside the driver API events, so that the
+  // synchronizations needed to sample a launch are not counted in them.
+  bool sample_kernel_metrics =
+      kernel_metric_sampler_ &&
+      (cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchKernel ||
+       cbid == CUPTI_DRIVER_TRACE_CBID_cuLaunchCooperativeKernel);
   if (cbdata->callbackSite == CUPTI_API_ENTER) {
+    if (sample_kernel_metrics) {
+      LogIfError(
+          kernel_metric_sampler_->OnKernelLaunchEnter(device_id, cbdata));
+    }
     TF_RETURN_IF_ERROR(cupti_driver_api_hook_->OnDriverApiEnter(
         device_id, domain, cbid, cbdata));
   } else if (cbdata->callbackSite == CUPTI_API_EXIT) {
@@ -1568,8 +1858,12 @@ Status CuptiTracer::HandleCallback(CUpti_CallbackDomain domain,
                                         annotation);
     }
 
-    TF_RETURN_IF_ERROR(cupti_driver_api_hook_->OnDriverApiExit(
-        device_id, domain, cbid, cbdata));
+    Status status = cupti_driver_api_hook_->OnDriverApiExit(device_id, domain,
+                                                            cbid, cbdata);
+    if (sample_kernel_metrics) {
+      LogIfError(kernel_metric_sampler_->OnKernelLaunchExit(device_id, cbdata));
+    }
+    return status;
   }
   return Status::OK();
 }
@@ -113,6 +113,10 @@ struct CuptiTracerEvent {
   // This points to strings in AnnotationMap, which should outlive the point
   // where serialization happens.
   absl::string_view annotation;
+  // For kernels sampled by CuptiTracerOptions::kernel_metrics, the metric
+  // values as "name:value,...". Points to strings in the kernel metrics
+  // AnnotationMap, like annotation.
+  absl::string_view kernel_metrics;
   uint64 start_time_ns;
   uint64 end_time_ns;
   uint32 device_id;
@@ -149,6 +153,13 @@ struct CuptiTracerOptions {
   bool cupti_finalize = false;
   // Whether to call cuCtxSynchronize for each device before Stop().
   bool sync_devices_before_stop = false;
+  // CUPTI metrics (e.g. "dram_read_throughput", "sm_efficiency") to collect
+  // for one kernel launch out of every kernel_metrics_sampling_period. The
+  // sampled launches are serialized with the rest of the device work, and
+  // replayed if the metrics need more than one pass. If empty, no metrics
+  // are collected.
+  std::vector<std::string> kernel_metrics;
+  int kernel_metrics_sampling_period = 100;
 };
 
 struct CuptiTracerCollectorOptions {
@@ -192,7 +203,9 @@ class CuptiTraceCollector {
  public:
   explicit CuptiTraceCollector(const CuptiTracerCollectorOptions& options)
       : options_(options),
-        annotation_map_(options.max_annotation_strings, options.num_gpus) {}
+        annotation_map_(options.max_annotation_strings, options.num_gpus),
+        kernel_metrics_map_(options.max_annotation_strings, options.num_gpus) {
+  }
   virtual ~CuptiTraceCollector() {}
 
   virtual void AddEvent(CuptiTracerEvent&& event) = 0;
@@ -201,12 +214,14 @@ class CuptiTraceCollector {
   virtual void Flush() = 0;
 
   AnnotationMap* annotation_map() { return &annotation_map_; }
+  AnnotationMap* kernel_metrics_map() { return &kernel_metrics_map_; }
 
  protected:
   CuptiTracerCollectorOptions options_;
 
  private:
   AnnotationMap annotation_map_;
+  AnnotationMap kernel_metrics_map_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(CuptiTraceCollector);
 };
@@ -231,6 +246,8 @@ class CuptiDriverApiHook {
       const CUpti_CallbackData* callback_info);
 };
 
+class CuptiKernelMetricSampler;
+
 // The class use to enable cupti callback/activity API and forward the collected
 // trace events to CuptiTraceCollector. There should be only one CuptiTracer
 // per process.
@@ -260,8 +277,8 @@ class CuptiTracer {
 
  protected:
   // protected constructor for injecting mock cupti interface for testing.
-  explicit CuptiTracer(CuptiInterface* cupti_interface)
-      : num_gpus_(NumGpus()), cupti_interface_(cupti_interface) {}
+  explicit CuptiTracer(CuptiInterface* cupti_interface);
+  ~CuptiTracer();
 
  private:
   Status EnableApiTracing();
@@ -288,6 +305,8 @@ class CuptiTracer {
   bool activity_tracing_enabled_ = false;
 
   std::unique_ptr<CuptiDriverApiHook> cupti_driver_api_hook_;
+  // Set when option_->kernel_metrics is not empty.
+  std::unique_ptr<CuptiKernelMetricSampler> kernel_metric_sampler_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(CuptiTracer);
 };
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/platform/abi.h"
@@ -106,6 +107,11 @@ void CreateXEvent(const CuptiTracerEvent& event, XPlaneBuilder* plane,
     xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
                             GetStatTypeStr(StatType::kKernelDetails)),
                         *plane->GetOrCreateStatMetadata(kernel_details));
+    if (!event.kernel_metrics.empty()) {
+      xevent.AddStatValue(*plane->GetOrCreateStatMetadata(
+                              GetStatTypeStr(StatType::kKernelMetrics)),
+                          event.kernel_metrics);
+    }
   } else if (event.type == CuptiTracerEventType::MemcpyH2D ||
              event.type == CuptiTracerEventType::MemcpyD2H ||
              event.type == CuptiTracerEventType::MemcpyD2D ||
@@ -612,6 +618,21 @@ Status GpuTracer::DoStart() {
   options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_MEMCPY2);
   options_.activities_selected.push_back(CUPTI_ACTIVITY_KIND_OVERHEAD);
 
+  // Comma-separated CUPTI metrics to sample kernels for, e.g.
+  // "dram_read_throughput,dram_write_throughput,sm_efficiency".
+  std::string kernel_metrics;
+  ReadStringFromEnvVar("TF_GPU_CUPTI_KERNEL_METRICS", "", &kernel_metrics)
+      .IgnoreError();
+  std::vector<std::string> kernel_metric_names =
+      absl::StrSplit(kernel_metrics, ',', absl::SkipWhitespace());
+  options_.kernel_metrics = std::move(kernel_metric_names);
+  int64 kernel_metrics_sampling_period;
+  ReadInt64FromEnvVar("TF_GPU_CUPTI_KERNEL_METRICS_SAMPLING_PERIOD",
+                      options_.kernel_metrics_sampling_period,
+                      &kernel_metrics_sampling_period)
+      .IgnoreError();
+  options_.kernel_metrics_sampling_period = kernel_metrics_sampling_period;
+
 // CUDA/CUPTI 10 have issues (leaks and crashes) with CuptiFinalize.
 #if CUDA_VERSION < 10000
   if (!trace_concurrent_kernels) options_.cupti_finalize = true;
@@ -44,6 +44,10 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// Maximum number of events a thread keeps between Start() and Stop(), or 0
+// if unbounded. Only modified while tracing is disabled.
+std::atomic<size_t> g_max_events_per_thread(0);
+
 // A single-producer single-consumer queue of Events.
 //
 // Implemented as a linked-list of blocks containing numbered slots, with start
@@ -56,7 +60,9 @@ namespace {
 //
 // Push writes at end_, and then advances it, allocating a block if needed.
 // PopAll takes ownership of events in the range [start_, end_).
-// The end_ pointer is atomic so Push and PopAll can be concurrent.
+// The end_ pointer is atomic so Push and PopAll can be concurrent. The start_
+// pointer is atomic so Push can drop events once the queue holds
+// g_max_events_per_thread of them.
 //
 // Push and PopAll are lock free and each might be called from at most one
 // thread. Push is only called by the owner thread. PopAll is called by the
@@ -73,7 +79,7 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_block_->start) {}
 
   // REQUIRES: PopAll() was called since the last Push().
   // Memory should be deallocated and trace events destroyed on destruction.
@@ -88,6 +94,12 @@ class EventQueue {
   // Add a new event to the back of the queue. Fast and lock-free.
   void Push(TraceMeRecorder::Event&& event) {
     size_t end = end_.load(std::memory_order_relaxed);
+    const size_t max_events =
+        g_max_events_per_thread.load(std::memory_order_relaxed);
+    if (max_events != 0 &&
+        end - start_.load(std::memory_order_relaxed) >= max_events) {
+      return;  // Full: drop the event rather than grow.
+    }
     new (&end_block_->events[end++ - end_block_->start].event)
         TraceMeRecorder::Event(std::move(event));
     if (TF_PREDICT_FALSE(end - end_block_->start == Block::kNumSlots)) {
@@ -108,8 +120,8 @@ class EventQueue {
     // Read index before contents.
     size_t end = end_.load(std::memory_order_acquire);
     std::vector<TraceMeRecorder::Event> result;
-    result.reserve(end - start_);
-    while (start_ != end) {
+    result.reserve(end - start_.load(std::memory_order_relaxed));
+    while (start_.load(std::memory_order_relaxed) != end) {
       result.emplace_back(Pop());
     }
     return result;
@@ -118,7 +130,8 @@ class EventQueue {
  private:
   // Returns true if the queue is empty at the time of invocation.
   bool Empty() const {
-    return (start_ == end_.load(std::memory_order_acquire));
+    return (start_.load(std::memory_order_relaxed) ==
+            end_.load(std::memory_order_acquire));
   }
 
   // Remove one event off the front of the queue and return it.
@@ -126,17 +139,19 @@ class EventQueue {
   TraceMeRecorder::Event Pop() {
     DCHECK(!Empty());
     // Move the next event into the output.
-    auto& event = start_block_->events[start_++ - start_block_->start].event;
+    size_t start = start_.load(std::memory_order_relaxed);
+    auto& event = start_block_->events[start++ - start_block_->start].event;
     TraceMeRecorder::Event out = std::move(event);
     event.~Event();  // Events must be individually destroyed.
     // If we reach the end of a block, we own it and should delete it.
     // The next block is present: end always points to something.
-    if (TF_PREDICT_FALSE(start_ - start_block_->start == Block::kNumSlots)) {
+    if (TF_PREDICT_FALSE(start - start_block_->start == Block::kNumSlots)) {
       auto* next_block = start_block_->next;
       delete start_block_;
       start_block_ = next_block;
-      DCHECK_EQ(start_, start_block_->start);
+      DCHECK_EQ(start, start_block_->start);
     }
+    start_.store(start, std::memory_order_relaxed);
     return out;
   }
 
@@ -162,7 +177,7 @@ class EventQueue {
 
   // Head of list for reading. Only accessed by consumer thread.
   Block* start_block_;
-  size_t start_;
+  std::atomic<size_t> start_;  // Atomic: also read by producer thread.
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
@@ -240,9 +255,16 @@ TraceMeRecorder::Events TraceMeRecorder::Clear() {
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level,
+                                     size_t max_events_per_thread) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    return false;
+  }
+  g_max_events_per_thread.store(max_events_per_thread,
+                                std::memory_order_relaxed);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
@@ -270,6 +292,16 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return events;
 }
 
+TraceMeRecorder::Events TraceMeRecorder::ConsumeRecording() {
+  TraceMeRecorder::Events events;
+  mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    events = Clear();
+  }
+  return events;
+}
+
 /*static*/ uint64 TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
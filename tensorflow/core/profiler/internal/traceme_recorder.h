@@ -70,12 +70,23 @@ class TraceMeRecorder {
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  // If max_events_per_thread is non-zero, each thread keeps at most that many
+  // events until Stop() or Consume(), and further events are dropped. This
+  // bounds the memory and time spent by always-on sampling.
+  static bool Start(int level, size_t max_events_per_thread = 0) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
   static Events Stop() { return Get()->StopRecording(); }
 
+  // Returns events recorded since Start() or the previous Consume(), without
+  // stopping. Lets the profiler convert events while they are being recorded,
+  // so that Stop() only has to collect the most recent ones.
+  // Returns no events if not recording.
+  static Events Consume() { return Get()->ConsumeRecording(); }
+
   // Returns whether we're currently recording. Racy, but cheap!
   static inline bool Active(int level = 1) {
     return internal::g_trace_level.load(std::memory_order_acquire) >= level;
@@ -103,8 +114,9 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, ThreadLocalRecorder* thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
+  Events ConsumeRecording();
 
   // Gathers events from all active threads, and clears their buffers.
   Events Clear() TF_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
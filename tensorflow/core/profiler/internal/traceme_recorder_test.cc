@@ -57,6 +57,47 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, BoundedPerThread) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({1, "kept1", start_time, end_time});
+  TraceMeRecorder::Record({2, "kept2", start_time, end_time});
+  TraceMeRecorder::Record({3, "dropped", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("kept1"), Named("kept2")));
+
+  // The bound only applies to the session it was given to.
+  TraceMeRecorder::Start(/*level=*/1);
+  for (int i = 0; i < 3; ++i) {
+    TraceMeRecorder::Record({4, "unbounded", start_time, end_time});
+  }
+  results = TraceMeRecorder::Stop();
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].events.size(), 3);
+}
+
+TEST(RecorderTest, ConsumeWhileRecording) {
+  uint64 start_time = Env::Default()->NowNanos();
+  uint64 end_time = start_time + kNanosInSec;
+
+  TraceMeRecorder::Start(/*level=*/1);
+  TraceMeRecorder::Record({1, "first", start_time, end_time});
+  auto consumed = TraceMeRecorder::Consume();
+  EXPECT_TRUE(TraceMeRecorder::Active());
+  TraceMeRecorder::Record({2, "second", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(consumed.size(), 1);
+  EXPECT_THAT(consumed[0].events, ElementsAre(Named("first")));
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("second")));
+  EXPECT_TRUE(TraceMeRecorder::Consume().empty());
+}
+
 void SpinNanos(int nanos) {
   uint64 deadline = Env::Default()->NowNanos() + nanos;
   while (Env::Default()->NowNanos() < deadline) {
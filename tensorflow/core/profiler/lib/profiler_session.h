@@ -65,6 +65,10 @@ class ProfilerSession {
   tensorflow::Status CollectData(RunMetadata* run_metadata)
       TF_LOCKS_EXCLUDED(mutex_);
 
+  // Returns the time profiling started, which the timestamps collected into an
+  // XSpace are relative to.
+  uint64 start_time_ns() const { return start_time_ns_; }
+
  private:
   // Constructs an instance of the class and starts profiling
   explicit ProfilerSession(const ProfileOptions& options);
@@ -213,6 +213,28 @@ class TraceMe {
     return kUntracedActivity;
   }
 
+  // This overload is necessary to make ActivityStart with string literals
+  // work, as the name_generator overload below would be picked otherwise.
+  static uint64 ActivityStart(const char* name, int level = 1) {
+    return ActivityStart(absl::string_view(name), level);
+  }
+
+  // This overload only generates the name (and possibly metadata) if tracing is
+  // enabled, like the name_generator constructor.
+  template <typename NameGeneratorT>
+  static uint64 ActivityStart(NameGeneratorT name_generator, int level = 1) {
+#if !defined(IS_MOBILE_PLATFORM)
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+      uint64 activity_id = TraceMeRecorder::NewActivityId();
+      TraceMeRecorder::Record({activity_id, name_generator(),
+                               /*start_time=*/EnvTime::NowNanos(),
+                               /*end_time=*/0});
+      return activity_id;
+    }
+#endif
+    return kUntracedActivity;
+  }
+
   // Record the end time of an activity started by ActivityStart().
   static void ActivityEnd(uint64 activity_id) {
 #if !defined(IS_MOBILE_PLATFORM)
@@ -23,7 +23,9 @@ limitations under the License.
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/profiler_analysis.grpc.pb.h"
@@ -78,6 +80,36 @@ inline bool ShouldRetryTracing(Status status) {
           status.error_message() == "Stream removed");
 }
 
+// Estimates the clock offset to the server (server clock minus local clock) in
+// an NTP-like way: each ClockSync round trip gives an estimate whose error is
+// bounded by half of its network delay, so the round with the smallest delay
+// is kept.
+Status EstimateClockOffset(grpc::ProfilerService::Stub* stub,
+                           int64* clock_offset_ns) {
+  constexpr int kNumClockSyncRounds = 8;
+  int64 min_delay_ns = std::numeric_limits<int64>::max();
+  for (int i = 0; i < kNumClockSyncRounds; ++i) {
+    ::grpc::ClientContext context;
+    ClockSyncRequest request;
+    ClockSyncResponse response;
+    const int64 send_time_ns = EnvTime::NowNanos();
+    TF_RETURN_IF_ERROR(
+        FromGrpcStatus(stub->ClockSync(&context, request, &response)));
+    const int64 receive_time_ns = EnvTime::NowNanos();
+    const int64 server_receive_time_ns = response.receive_time_ns();
+    const int64 server_send_time_ns = response.send_time_ns();
+    const int64 delay_ns = (receive_time_ns - send_time_ns) -
+                           (server_send_time_ns - server_receive_time_ns);
+    if (delay_ns < min_delay_ns) {
+      min_delay_ns = delay_ns;
+      *clock_offset_ns = ((server_receive_time_ns - send_time_ns) +
+                          (server_send_time_ns - receive_time_ns)) /
+                         2;
+    }
+  }
+  return Status::OK();
+}
+
 // Returns whether the returned trace is empty.
 // Failure are handled by CHECK, i.e. abort()
 Status Profile(const string& service_addr, const string& logdir,
@@ -97,6 +129,15 @@ Status Profile(const string& service_addr, const string& logdir,
       grpc::ProfilerService::NewStub(::grpc::CreateCustomChannel(
           "dns:///" + service_addr, ::grpc::InsecureChannelCredentials(),
           channel_args));
+  int64 clock_offset_ns = 0;
+  Status clock_sync_status = EstimateClockOffset(stub.get(), &clock_offset_ns);
+  if (clock_sync_status.ok()) {
+    request.set_clock_offset_ns(clock_offset_ns);
+  } else {
+    // Servers predating ClockSync can still be profiled, without alignment.
+    LOG(WARNING) << "Failed to estimate the clock offset to " << service_addr
+                 << ": " << clock_sync_status;
+  }
   ProfileResponse response;
   TF_RETURN_IF_ERROR(
       FromGrpcStatus(stub->Profile(&context, request, &response)));
@@ -33,6 +33,9 @@ limitations under the License.
 #include "tensorflow/core/profiler/profiler_service.grpc.pb.h"
 #include "tensorflow/core/profiler/profiler_service.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
 
 namespace tensorflow {
 namespace {
@@ -42,6 +45,14 @@ Status CollectDataToResponse(const ProfileRequest& req,
                              ProfileResponse* response) {
   profiler::XSpace xspace;
   TF_RETURN_IF_ERROR(profiler->CollectData(&xspace));
+  // Record the profiling start in the caller's clock, so that the traces of
+  // several hosts can be aligned with AlignXSpacesBySessionStart.
+  profiler::XPlaneBuilder host_plane(profiler::FindOrAddMutablePlaneWithName(
+      &xspace, profiler::kHostThreadsPlaneName));
+  host_plane.AddStatValue(
+      *host_plane.GetOrCreateStatMetadata(
+          profiler::GetStatTypeStr(profiler::StatType::kSessionStartTimeNs)),
+      static_cast<int64>(profiler->start_time_ns()) - req.clock_offset_ns());
   TF_RETURN_IF_ERROR(
       profiler::ConvertXSpaceToProfileResponse(xspace, req, response));
   return Status::OK();
@@ -87,6 +98,14 @@ class ProfilerServiceImpl : public grpc::ProfilerService::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status ClockSync(::grpc::ServerContext* ctx,
+                           const ClockSyncRequest* req,
+                           ClockSyncResponse* response) override {
+    response->set_receive_time_ns(EnvTime::NowNanos());
+    response->set_send_time_ns(EnvTime::NowNanos());
+    return ::grpc::Status::OK;
+  }
+
   ::grpc::Status Terminate(::grpc::ServerContext* ctx,
                            const TerminateRequest* req,
                            TerminateResponse* response) override {
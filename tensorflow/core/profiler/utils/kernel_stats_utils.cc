@@ -76,6 +76,21 @@ void ParseKernelLaunchParams(absl::string_view xstat_kernel_details,
   }
 }
 
+void ParseKernelMetrics(absl::string_view xstat_kernel_metrics,
+                        KernelReport* kernel) {
+  for (absl::string_view metric : absl::StrSplit(
+           xstat_kernel_metrics, ',', absl::SkipWhitespace())) {
+    std::pair<absl::string_view, absl::string_view> name_value =
+        absl::StrSplit(metric, ':');
+    double value;
+    if (absl::SimpleAtod(name_value.second, &value)) {
+      (*kernel->mutable_sampled_metrics())[std::string(name_value.first)] =
+          value;
+    }
+  }
+  if (!kernel->sampled_metrics().empty()) kernel->set_num_metric_samples(1);
+}
+
 bool IsKernelUsingTensorCore(absl::string_view kernel_name) {
   // Some examples: volta_h884gemm, volta_fp16_s884gemm,
   // turing_fp16_s1688cudnn_fp16
@@ -213,6 +228,30 @@ void SortKernelsByTotalDurationDesc(KernelStatsDb* kernel_stats_db) {
             });
 }
 
+namespace {
+
+// Folds the sampled metrics of src into the averages of dst.
+void AddSampledMetrics(const KernelReport& src, KernelReport* dst) {
+  if (src.num_metric_samples() == 0) return;
+  const uint32 num_samples =
+      dst->num_metric_samples() + src.num_metric_samples();
+  auto* dst_metrics = dst->mutable_sampled_metrics();
+  for (auto& name_and_value : *dst_metrics) {
+    auto it = src.sampled_metrics().find(name_and_value.first);
+    if (it == src.sampled_metrics().end()) continue;
+    name_and_value.second =
+        (name_and_value.second * dst->num_metric_samples() +
+         it->second * src.num_metric_samples()) /
+        num_samples;
+  }
+  for (const auto& name_and_value : src.sampled_metrics()) {
+    dst_metrics->insert(name_and_value);
+  }
+  dst->set_num_metric_samples(num_samples);
+}
+
+}  // namespace
+
 void GroupKernelReports(std::vector<KernelReport>* reports,
                         KernelStatsDb* dst) {
   // Sort reports by grouping criteria.
@@ -233,6 +272,7 @@ void GroupKernelReports(std::vector<KernelReport>* reports,
           std::min(prev->min_duration_ns(), report.min_duration_ns()));
       prev->set_total_duration_ns(prev->total_duration_ns() +
                                   report.total_duration_ns());
+      AddSampledMetrics(report, prev);
     } else {
       // Current element does not exist yet.
       prev = dst->add_reports();
@@ -28,6 +28,11 @@ namespace profiler {
 void ParseKernelLaunchParams(absl::string_view xstat_kernel_details,
                              KernelReport* kernel);
 
+// Populates the sampled metrics of a kernel from a KernelMetrics XStat, which
+// lists them as "name:value,...".
+void ParseKernelMetrics(absl::string_view xstat_kernel_metrics,
+                        KernelReport* kernel);
+
 // Returns true if kernel uses TensorCores.
 bool IsKernelUsingTensorCore(absl::string_view kernel_name);
 
@@ -67,6 +67,9 @@ const HostEventTypeMap& GetHostEventTypeMap() {
       {"ExecutorDoneCallback", kExecutorDoneCallback},
       {"MemoryAllocation", kMemoryAllocation},
       {"MemoryDeallocation", kMemoryDeallocation},
+      {"MemoryChunkSplit", kMemoryChunkSplit},
+      {"MemoryChunkMerge", kMemoryChunkMerge},
+      {"MemoryBinOccupancy", kMemoryBinOccupancy},
       // Performance counter related.
       {"RemotePerfCounter", kRemotePerf},
       // tf data captured function events.
@@ -132,6 +135,8 @@ const StatTypeMap& GetStatTypeMap() {
       {"region_type", kRegionType},
       {"data_type", kDataType},
       {"shape", kTensorShapes},
+      {"bin_occupancy", kBinOccupancy},
+      {"rendezvous_key", kRendezvousKey},
       {"kpi_name", kKpiName},
       {"kpi_value", kKpiValue},
       // XPlane semantics related.
@@ -148,6 +153,7 @@ const StatTypeMap& GetStatTypeMap() {
       {"memcpy_details", kMemcpyDetails},
       {"memalloc_details", kMemallocDetails},
       {"kernel_details", kKernelDetails},
+      {"kernel_metrics", kKernelMetrics},
       {"annotation", kKernelAnnotation},
       {"stream", kStream},
       // Stats added when processing traces.
@@ -164,6 +170,7 @@ const StatTypeMap& GetStatTypeMap() {
       {"tracing_count", kTfFunctionTracingCount},
       {"flops", kFlops},
       {"bytes_accessed", kBytesAccessed},
+      {"session_start_time_ns", kSessionStartTimeNs},
       // Performance counter related.
       {"Raw Value", kRawValue},
       {"Scaled Value", kScaledValue},
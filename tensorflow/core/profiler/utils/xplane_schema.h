@@ -60,6 +60,9 @@ enum HostEventType {
   kExecutorDoneCallback,
   kMemoryAllocation,
   kMemoryDeallocation,
+  kMemoryChunkSplit,
+  kMemoryChunkMerge,
+  kMemoryBinOccupancy,
   // Performance counter related.
   kRemotePerf,
   // tf.data captured function events.
@@ -120,6 +123,8 @@ enum StatType {
   kRegionType,
   kDataType,
   kTensorShapes,
+  kBinOccupancy,
+  kRendezvousKey,
   kKpiName,
   kKpiValue,
   // XPlane semantics related.
@@ -137,6 +142,7 @@ enum StatType {
   kMemallocDetails,
   kKernelAnnotation,
   kKernelDetails,
+  kKernelMetrics,
   kStream,
   // Stats added when processing traces.
   kGroupId,
@@ -152,6 +158,7 @@ enum StatType {
   kTfFunctionTracingCount,
   kFlops,
   kBytesAccessed,
+  kSessionStartTimeNs,
   // Performance counter related.
   kRawValue,
   kScaledValue,
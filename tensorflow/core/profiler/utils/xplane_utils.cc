@@ -22,12 +22,15 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
 #include "tensorflow/core/profiler/utils/timespan.h"
 #include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_visitor.h"
 
 namespace tensorflow {
@@ -226,6 +229,34 @@ void MergePlanes(const XPlane& src_plane, XPlane* dst_plane) {
   });
 }
 
+void AlignXSpacesBySessionStart(const std::vector<XSpace*>& spaces) {
+  std::vector<absl::optional<int64>> start_times;
+  start_times.reserve(spaces.size());
+  absl::optional<int64> min_start_time;
+  for (const XSpace* space : spaces) {
+    absl::optional<int64> start_time;
+    if (const XPlane* host_plane =
+            FindPlaneWithName(*space, kHostThreadsPlaneName)) {
+      XPlaneVisitor plane = CreateTfXPlaneVisitor(host_plane);
+      if (auto stat = plane.GetStat(StatType::kSessionStartTimeNs)) {
+        start_time = stat->IntValue();
+        min_start_time = std::min(min_start_time.value_or(*start_time),
+                                  *start_time);
+      }
+    }
+    start_times.push_back(start_time);
+  }
+  for (int i = 0; i < spaces.size(); ++i) {
+    if (!start_times[i].has_value()) continue;
+    int64 shift_ns = *start_times[i] - *min_start_time;
+    for (XPlane& plane : *spaces[i]->mutable_planes()) {
+      for (XLine& line : *plane.mutable_lines()) {
+        line.set_timestamp_ns(line.timestamp_ns() + shift_ns);
+      }
+    }
+  }
+}
+
 uint64 GetStartTimestampNs(const XPlane& plane) {
   int64 plane_timestamp = 0;
   for (const auto& line : plane.lines()) {
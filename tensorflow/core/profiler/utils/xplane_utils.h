@@ -89,6 +89,13 @@ void MergePlanes(const XPlane& src_plane, XPlane* dst_plane);
 // timestamps. If zero line exists, return 0;
 uint64 GetStartTimestampNs(const XPlane& plane);
 
+// Aligns XSpaces profiled on several hosts, whose timestamps are relative to
+// their own profiling start, by making them all relative to the earliest one.
+// The profiling start of each XSpace is read from the session_start_time_ns
+// stat of its host plane, which must be in a common clock. XSpaces without it
+// are left unchanged.
+void AlignXSpacesBySessionStart(const std::vector<XSpace*>& spaces);
+
 }  // namespace profiler
 }  // namespace tensorflow
 
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_visitor.h"
 
 namespace tensorflow {
@@ -305,6 +306,33 @@ TEST(XPlaneUtilsTest, MergeXPlaneTest) {
   }
 }
 
+TEST(XPlaneUtilsTest, AlignXSpacesBySessionStart) {
+  XSpace spaces[3];
+  const int64 kSessionStartTimesNs[] = {5000, 2000, 0};
+  for (int i = 0; i < 3; ++i) {
+    XPlane* host_plane = spaces[i].add_planes();
+    host_plane->set_name(std::string(kHostThreadsPlaneName));
+    XPlaneBuilder host_plane_builder(host_plane);
+    if (i < 2) {
+      host_plane_builder.AddStatValue(
+          *host_plane_builder.GetOrCreateStatMetadata(
+              GetStatTypeStr(StatType::kSessionStartTimeNs)),
+          kSessionStartTimesNs[i]);
+    }
+    host_plane_builder.GetOrCreateLine(0).SetTimestampNs(100);
+    XPlane* device_plane = spaces[i].add_planes();
+    XPlaneBuilder(device_plane).GetOrCreateLine(0).SetTimestampNs(10);
+  }
+
+  AlignXSpacesBySessionStart({&spaces[0], &spaces[1], &spaces[2]});
+  EXPECT_EQ(spaces[0].planes(0).lines(0).timestamp_ns(), 3100);
+  EXPECT_EQ(spaces[0].planes(1).lines(0).timestamp_ns(), 3010);
+  EXPECT_EQ(spaces[1].planes(0).lines(0).timestamp_ns(), 100);
+  EXPECT_EQ(spaces[1].planes(1).lines(0).timestamp_ns(), 10);
+  // Left unchanged without the session start stat.
+  EXPECT_EQ(spaces[2].planes(0).lines(0).timestamp_ns(), 100);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
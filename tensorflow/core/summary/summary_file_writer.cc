@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -27,6 +29,11 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// Events are dropped once this many full queues are waiting to be written.
+constexpr int kMaxPendingQueues = 100;
+
+// Writes events from a background thread, so that neither serialization nor
+// file system latency is paid by the thread that calls WriteEvent.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -34,6 +41,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
         is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
+        max_pending_(kMaxPendingQueues * (std::max(max_queue, 0) + 1)),
         env_(env) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
@@ -44,26 +52,51 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock wl(writer_mu_);
+      mutex_lock ml(mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
+  // Writes and flushes all events enqueued so far, including the ones the
+  // writer thread is working on, and returns the first error since the last
+  // call.
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
     }
-    return InternalFlush();
+    const Status s = WriteQueue();
+    mutex_lock ml(mu_);
+    Status status = write_status_;
+    write_status_ = Status::OK();
+    status.Update(s);
+    return status;
   }
 
   ~SummaryFileWriter() override {
+    if (writer_thread_ != nullptr) {
+      {
+        mutex_lock ml(mu_);
+        stopping_ = true;
+      }
+      write_cv_.notify_one();
+      writer_thread_.reset();  // Joins the thread.
+    }
     (void)Flush();  // Ignore errors.
   }
 
@@ -140,12 +173,25 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    if (queue_.size() >= max_pending_) {
+      // The writer thread has fallen far behind; rather than block the
+      // caller or grow without bound, drop the newest event.
+      ++num_dropped_;
+      LOG_EVERY_N_SEC(WARNING, 60)
+          << "Summary writer queue is full; dropped " << num_dropped_
+          << " events so far.";
+      return Status::OK();
+    }
     queue_.emplace_back(std::move(event));
     if (queue_.size() > max_queue_ ||
         env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+      write_requested_ = true;
+      write_cv_.notify_one();
     }
-    return Status::OK();
+    // Report errors from the writer thread to the next caller.
+    Status status = write_status_;
+    write_status_ = Status::OK();
+    return status;
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,28 +201,74 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Waits until WriteEvent asks for a write, or until flush_millis have
+  // passed with events in the queue, and writes the queue.
+  void WriterLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        while (!stopping_ && !write_requested_) {
+          if (WaitForMilliseconds(&ml, &write_cv_,
+                                  std::max(flush_millis_, 1)) ==
+                  kCond_Timeout &&
+              !queue_.empty()) {
+            break;
+          }
+        }
+        // The destructor writes whatever is left.
+        if (stopping_) return;
+        write_requested_ = false;
+      }
+      const Status s = WriteQueue();
+      if (!s.ok()) {
+        mutex_lock ml(mu_);
+        write_status_.Update(s);
+      }
+    }
+  }
+
+  // Takes the whole queue, appends it to the events file and flushes it.
+  // Holding writer_mu_ while taking the queue keeps batches in order.
+  Status WriteQueue() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> batch;
+    {
+      mutex_lock ml(mu_);
+      batch.swap(queue_);
+    }
+    for (const std::unique_ptr<Event>& e : batch) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
-                                    "Could not flush events file.");
-    last_flush_ = env_->NowMicros();
+    const Status s = events_writer_->Flush();
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+    }
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(s, "Could not flush events file.");
     return Status::OK();
   }
 
-  bool is_initialized_;
+  bool is_initialized_ TF_GUARDED_BY(mu_);
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  const size_t max_pending_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  condition_variable write_cv_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  bool write_requested_ TF_GUARDED_BY(mu_) = false;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  // The first error from the writer thread not yet returned to a caller.
+  Status write_status_ TF_GUARDED_BY(mu_);
+  int64 num_dropped_ TF_GUARDED_BY(mu_) = 0;
+  // Serializes writes to events_writer_, which happen outside mu_.
+  mutex writer_mu_;
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
+  std::unique_ptr<Thread> writer_thread_;
 };
 
 }  // namespace
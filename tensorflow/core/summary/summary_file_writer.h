@@ -33,6 +33,10 @@ namespace tensorflow {
 /// filename_suffix. The caller owns a reference to result if the
 /// returned status is ok. The Env object must not be destroyed until
 /// after the returned writer.
+///
+/// Summaries are written and flushed on a background thread, so writing one
+/// does not wait on the file system; Flush() does. If 100 full queues are
+/// waiting to be written, further summaries are dropped.
 Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& logdir,
                                const string& filename_suffix, Env* env,
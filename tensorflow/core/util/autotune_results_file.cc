@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_results_file.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+
+namespace tensorflow {
+namespace {
+
+using ResultsMap =
+    absl::flat_hash_map<std::pair<std::string, std::string>,
+                        AutotuneResult>;
+
+// Adds the entries of the file at `path`, if it exists, to `results`, without
+// replacing the results already there.
+void ReadResultsFile(const std::string& path, ResultsMap* results) {
+  Env* env = Env::Default();
+  if (!env->FileExists(path).ok()) {
+    return;
+  }
+  AutotuneResults proto;
+  Status status = ReadTextProto(env, path, &proto);
+  if (!status.ok()) {
+    LOG(WARNING) << "Ignoring the autotuning results in " << path << ": "
+                 << status;
+    return;
+  }
+  for (const AutotuneResultsEntry& entry : proto.entries()) {
+    results->emplace(std::make_pair(entry.device(), entry.key()),
+                     entry.result());
+  }
+}
+
+mutex results_mu(LINKER_INITIALIZED);
+
+// The results of each file, read on its first use.
+absl::flat_hash_map<std::string, ResultsMap>& ResultsByPath()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(results_mu) {
+  static auto& results_by_path =
+      *new absl::flat_hash_map<std::string, ResultsMap>();
+  return results_by_path;
+}
+
+ResultsMap& GetResults(const std::string& path)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(results_mu) {
+  auto it = ResultsByPath().find(path);
+  if (it == ResultsByPath().end()) {
+    it = ResultsByPath().emplace(path, ResultsMap()).first;
+    ReadResultsFile(path, &it->second);
+    VLOG(1) << "Loaded " << it->second.size() << " autotuning results from "
+            << path;
+  }
+  return it->second;
+}
+
+}  // namespace
+
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  int cc_major = 0, cc_minor = 0;
+  desc.cuda_compute_capability(&cc_major, &cc_minor);
+  std::string device_key =
+      absl::StrCat(desc.name(), ", sm_", cc_major, cc_minor, ", driver ",
+                   desc.driver_version(), ", runtime ", desc.runtime_version());
+  if (auto* dnn = stream_exec->AsDnn()) {
+    se::port::StatusOr<se::dnn::VersionInfo> version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const se::dnn::VersionInfo& version = version_or.ValueOrDie();
+      absl::StrAppend(&device_key, ", cudnn ", version.major_version(), ".",
+                      version.minor_version(), ".", version.patch());
+    }
+  }
+  if (auto* blas = stream_exec->AsBlas()) {
+    std::string blas_version;
+    if (blas->GetVersion(&blas_version).ok()) {
+      absl::StrAppend(&device_key, ", cublas ", blas_version);
+    }
+  }
+  return device_key;
+}
+
+absl::optional<AutotuneResult> LookupAutotuneResult(
+    const std::string& path, const std::string& device,
+    const std::string& key) {
+  mutex_lock lock(results_mu);
+  const ResultsMap& results = GetResults(path);
+  auto it = results.find(std::make_pair(device, key));
+  if (it == results.end()) {
+    return absl::nullopt;
+  }
+  return it->second;
+}
+
+void StoreAutotuneResult(const std::string& path, const std::string& device,
+                         const std::string& key, const AutotuneResult& result) {
+  mutex_lock lock(results_mu);
+  ResultsMap& results = GetResults(path);
+  results[std::make_pair(device, key)] = result;
+
+  // Pick up what other processes stored since the file was read, so that they
+  // are not overwritten.
+  ReadResultsFile(path, &results);
+  AutotuneResults proto;
+  for (const auto& pair : results) {
+    AutotuneResultsEntry* entry = proto.add_entries();
+    entry->set_device(pair.first.first);
+    entry->set_key(pair.first.second);
+    *entry->mutable_result() = pair.second;
+  }
+  Env* env = Env::Default();
+  const std::string tmp_path =
+      absl::StrCat(path, ".tmp.", absl::Hex(random::New64()));
+  Status status = WriteTextProto(env, tmp_path, proto);
+  if (status.ok()) {
+    status = env->RenameFile(tmp_path, path);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to store autotuning results in " << path << ": "
+                 << status;
+    env->DeleteFile(tmp_path).IgnoreError();
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,56 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_RESULTS_FILE_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_RESULTS_FILE_H_
+
+#include <string>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace tensorflow {
+
+// Persists autotuning results in a text AutotuneResults proto at the path
+// given by xla_gpu_autotune_results_path for XLA, or by the
+// TF_GPU_AUTOTUNE_RESULTS_PATH environment variable for the TensorFlow GPU
+// kernels, so that processes can reuse the results of earlier ones, and a
+// pre-tuned file can be shipped with a model. Both can share one file.
+//
+// Results are keyed by the device they were measured on, as returned by
+// AutotuneDeviceKey, and by a string describing what was tuned.  The
+// file is read once per process; stores merge with the entries other
+// processes wrote since, and replace the file atomically.
+
+// Returns the key of the results measured on `stream_exec`: its model,
+// compute capability and driver, runtime, cuDNN and cuBLAS versions.
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec);
+
+// Returns the result stored for `key` on `device` in the file at `path`, if
+// any.
+absl::optional<AutotuneResult> LookupAutotuneResult(
+    const std::string& path, const std::string& device,
+    const std::string& key);
+
+// Stores `result` for `key` on `device` in the file at `path`.  Failures to
+// write the file are logged and otherwise ignored, so that read-only files
+// can be shipped.
+void StoreAutotuneResult(const std::string& path, const std::string& device,
+                         const std::string& key, const AutotuneResult& result);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_RESULTS_FILE_H_
@@ -0,0 +1,79 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_results_file.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace tensorflow {
+namespace {
+
+std::string TestPath() {
+  return io::JoinPath(
+      testing::TmpDir(),
+      absl::StrCat(
+          ::testing::UnitTest::GetInstance()->current_test_info()->name(),
+          ".pbtxt"));
+}
+
+TEST(AutotuneResultsFileTest, LoadsShippedResults) {
+  const std::string path = TestPath();
+  AutotuneResults proto;
+  AutotuneResultsEntry* entry = proto.add_entries();
+  entry->set_device("device");
+  entry->set_key("conv hlo");
+  entry->mutable_result()->mutable_conv()->set_algorithm(3);
+  TF_ASSERT_OK(
+      WriteTextProto(Env::Default(), path, proto));
+
+  absl::optional<AutotuneResult> result =
+      LookupAutotuneResult(path, "device", "conv hlo");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->conv().algorithm(), 3);
+  EXPECT_FALSE(LookupAutotuneResult(path, "other device", "conv hlo"));
+  EXPECT_FALSE(LookupAutotuneResult(path, "device", "other hlo"));
+}
+
+TEST(AutotuneResultsFileTest, StoresResults) {
+  const std::string path = TestPath();
+  EXPECT_FALSE(LookupAutotuneResult(path, "device", "gemm hlo"));
+
+  AutotuneResult result;
+  result.mutable_gemm()->set_algorithm(5);
+  StoreAutotuneResult(path, "device", "gemm hlo", result);
+  absl::optional<AutotuneResult> stored =
+      LookupAutotuneResult(path, "device", "gemm hlo");
+  ASSERT_TRUE(stored.has_value());
+  EXPECT_EQ(stored->gemm().algorithm(), 5);
+
+  // The file holds the result, for other processes.
+  AutotuneResults proto;
+  TF_ASSERT_OK(
+      ReadTextProto(Env::Default(), path, &proto));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).device(), "device");
+  EXPECT_EQ(proto.entries(0).key(), "gemm hlo");
+  EXPECT_EQ(proto.entries(0).result().gemm().algorithm(), 5);
+}
+
+}  // namespace
+}  // namespace tensorflow
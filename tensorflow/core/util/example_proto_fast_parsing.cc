@@ -113,6 +113,73 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Packed varints are decoded straight from the underlying buffer, which avoids
+// the per-value bookkeeping of `CodedInputStream::ReadVarint64`.
+
+// Points `[begin, end)` to the bytes between the position of `stream` and its
+// current limit. Returns false if they are not contiguous in memory.
+bool GetBytesUntilLimit(protobuf::io::CodedInputStream* stream,
+                        const uint8** begin, const uint8** end) {
+  const int bytes = stream->BytesUntilLimit();
+  if (bytes <= 0) {
+    *begin = *end = nullptr;
+    return bytes == 0;
+  }
+  const void* ptr;
+  int size;
+  if (!stream->GetDirectBufferPointer(&ptr, &size) || size < bytes) {
+    return false;
+  }
+  *begin = static_cast<const uint8*>(ptr);
+  *end = *begin + bytes;
+  return true;
+}
+
+// Returns the number of varints in `[begin, end)`, i.e. the number of bytes
+// without a continuation bit. Counts eight bytes at a time.
+inline size_t CountPackedVarints(const uint8* begin, const uint8* end) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  constexpr uint64 kLowBits = 0x0101010101010101ULL;
+  size_t count = 0;
+  const uint8* p = begin;
+  for (; end - p >= static_cast<ptrdiff_t>(sizeof(uint64));
+       p += sizeof(uint64)) {
+    uint64 word;
+    memcpy(&word, p, sizeof(word));
+    // Moves the inverted continuation bit of each byte to its lowest bit, then
+    // sums the eight bytes into the highest one.
+    count += ((((~word & kContinuationBits) >> 7) * kLowBits) >> 56);
+  }
+  for (; p < end; ++p) {
+    count += *p < 0x80;
+  }
+  return count;
+}
+
+// Decodes the varints in `[begin, end)`, and stores the first `max_values` of
+// them in `out`. Returns false if a varint is truncated or longer than the
+// 10 bytes of a 64-bit varint.
+inline bool DecodePackedVarints(const uint8* begin, const uint8* end,
+                                int64* out, size_t max_values) {
+  size_t index = 0;
+  const uint8* p = begin;
+  while (p < end) {
+    uint64 value = *p++;
+    if (value >= 0x80) {
+      value &= 0x7F;
+      for (int shift = 7;; shift += 7) {
+        if (p == end || shift >= 70) return false;
+        const uint8 byte = *p++;
+        value |= static_cast<uint64>(byte & 0x7F) << shift;
+        if (byte < 0x80) break;
+      }
+    }
+    if (index < max_values) out[index] = static_cast<int64>(value);
+    ++index;
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -297,10 +364,26 @@ class Feature {
         if (!stream.ReadVarint32(&packed_length)) return false;
         auto packed_limit = stream.PushLimit(packed_length);
 
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        const uint8* begin;
+        const uint8* end;
+        if (GetBytesUntilLimit(&stream, &begin, &end)) {
+          const size_t initial_size = int64_list->size();
+          int64_list->resize(initial_size + CountPackedVarints(begin, end));
+          // This can be less than the number of values in case of a
+          // LimitedArraySlice.
+          const size_t available = int64_list->size() - initial_size;
+          if (!DecodePackedVarints(begin, end,
+                                   int64_list->data() + initial_size,
+                                   available)) {
+            return false;
+          }
+          if (!stream.Skip(end - begin)) return false;
+        } else {
+          while (!stream.ExpectAtEnd()) {
+            protobuf_uint64 n;  // There is no API for int64
+            if (!stream.ReadVarint64(&n)) return false;
+            int64_list->push_back(static_cast<int64>(n));
+          }
         }
 
         stream.PopLimit(packed_limit);
@@ -1952,15 +2035,31 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
         return -1;
       }
       auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
+      const uint8* begin;
+      const uint8* end;
+      if (GetBytesUntilLimit(stream, &begin, &end)) {
+        num_elements = CountPackedVarints(begin, end);
+        if (begin != end && end[-1] >= 0x80) {
+          return -1;  // Truncated varint.
+        }
+        if (out != nullptr &&
+            !DecodePackedVarints(begin, end, out, num_elements)) {
           return -1;
         }
-        if (out != nullptr) {
-          *out++ = n;
+        if (!stream->Skip(end - begin)) {
+          return -1;
+        }
+      } else {
+        while (!stream->ExpectAtEnd()) {
+          protobuf_uint64 n;  // There is no API for int64
+          if (!stream->ReadVarint64(&n)) {
+            return -1;
+          }
+          if (out != nullptr) {
+            *out++ = n;
+          }
+          num_elements++;
         }
-        num_elements++;
       }
       stream->PopLimit(packed_limit);
     } else if (peek_tag == kVarintTag(1)) {
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -170,6 +171,65 @@ TEST(FastParse, Packed) {
       "\x0a\x0d\x0a\x0b\x0a\x03\x61\x67\x65\x12\x04\x1a\x02\x08\x0d");
 }
 
+TEST(FastParse, PackedMultiByteInt64s) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["age"]
+                         .mutable_int64_list();
+  // Values of all varint lengths, in numbers that exercise both the word at a
+  // time and the byte at a time paths.
+  for (int64 value : {int64{0}, int64{127}, int64{128}, int64{300},
+                      int64{-1}, std::numeric_limits<int64>::max(),
+                      std::numeric_limits<int64>::min()}) {
+    for (int i = 0; i < 5; ++i) {
+      int64_list->add_value(value);
+    }
+  }
+  TestCorrectness(Serialize(example));
+}
+
+TEST(FastParse, TruncatedPackedInt64) {
+  // A packed int64 list whose only byte has a continuation bit.
+  Example fast_example;
+  EXPECT_FALSE(TestFastParse(
+      "\x0a\x0e\x0a\x0c\x0a\x03\x61\x67\x65\x12\x05\x1a\x03\x0a\x01\x8d",
+      &fast_example));
+}
+
+TEST(FastParse, DensePackedInt64s) {
+  Example example;
+  auto* int64_list = (*example.mutable_features()->mutable_feature())["age"]
+                         .mutable_int64_list();
+  int64_list->add_value(1);
+  int64_list->add_value(-300);
+  int64_list->add_value(1LL << 40);
+  const tstring serialized = Serialize(example);
+
+  FastParseExampleConfig config;
+  config.dense.emplace_back("age", DT_INT64, PartialTensorShape({3}),
+                            Tensor(DT_INT64, TensorShape({0})),
+                            /*variable_length=*/false,
+                            /*elements_per_stride=*/3);
+  Result result;
+  TF_EXPECT_OK(FastParseExample(config,
+                                gtl::ArraySlice<tstring>(&serialized, 1),
+                                gtl::ArraySlice<tstring>(), nullptr, &result));
+  ASSERT_EQ(result.dense_values.size(), 1);
+  const auto values = result.dense_values[0].flat<int64>();
+  ASSERT_EQ(values.size(), 3);
+  EXPECT_EQ(values(0), 1);
+  EXPECT_EQ(values(1), -300);
+  EXPECT_EQ(values(2), 1LL << 40);
+
+  // Parsing fails if the feature has more values than the dense shape.
+  int64_list->add_value(4);
+  const tstring too_many = Serialize(example);
+  Result too_many_result;
+  EXPECT_FALSE(FastParseExample(config, gtl::ArraySlice<tstring>(&too_many, 1),
+                                gtl::ArraySlice<tstring>(), nullptr,
+                                &too_many_result)
+                   .ok());
+}
+
 TEST(FastParse, EmptyFeatures) {
   Example example;
   example.mutable_features();
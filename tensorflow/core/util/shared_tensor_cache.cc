@@ -0,0 +1,102 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/shared_tensor_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+uint64 TensorFingerprint(const Tensor& tensor) {
+  uint64 fingerprint = Fingerprint64(tensor.tensor_data());
+  fingerprint = FingerprintCat64(fingerprint, tensor.dtype());
+  for (int64 dim : tensor.shape().dim_sizes()) {
+    fingerprint = FingerprintCat64(fingerprint, dim);
+  }
+  return fingerprint;
+}
+
+bool SameContents(const Tensor& a, const Tensor& b) {
+  if (a.dtype() != b.dtype() || a.shape() != b.shape()) return false;
+  const StringPiece a_data = a.tensor_data();
+  const StringPiece b_data = b.tensor_data();
+  return a_data.size() == b_data.size() &&
+         (a_data.data() == b_data.data() ||
+          std::memcmp(a_data.data(), b_data.data(), a_data.size()) == 0);
+}
+
+}  // namespace
+
+SharedTensorCache* SharedTensorCache::Global() {
+  static SharedTensorCache* cache = [] {
+    int64 min_bytes;
+    Status s = ReadInt64FromEnvVar("TF_SHARED_TENSOR_CACHE_MIN_BYTES", 0,
+                                   &min_bytes);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      min_bytes = 0;
+    }
+    return new SharedTensorCache(min_bytes);
+  }();
+  return cache;
+}
+
+SharedTensorCache::SharedTensorCache(int64 min_bytes) : min_bytes_(min_bytes) {}
+
+Tensor SharedTensorCache::Share(const Tensor& tensor) {
+  if (!enabled() || !tensor.IsInitialized() ||
+      !DataTypeCanUseMemcpy(tensor.dtype()) ||
+      tensor.TotalBytes() < static_cast<size_t>(min_bytes_)) {
+    return tensor;
+  }
+  // The fingerprint is computed outside the lock since it reads every byte.
+  const uint64 fingerprint = TensorFingerprint(tensor);
+  mutex_lock l(mu_);
+  const auto range = tensors_.equal_range(fingerprint);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (SameContents(it->second, tensor)) return it->second;
+  }
+  if (tensors_.size() >= next_eviction_size_) EvictUnusedLocked();
+  tensors_.emplace(fingerprint, tensor);
+  VLOG(2) << "Sharing " << tensor.TotalBytes() << " bytes of "
+          << tensor.DebugString(0) << ", " << tensors_.size()
+          << " shared tensors.";
+  return tensor;
+}
+
+size_t SharedTensorCache::size() const {
+  mutex_lock l(mu_);
+  return tensors_.size();
+}
+
+void SharedTensorCache::EvictUnusedLocked() {
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    if (it->second.RefCountIsOne()) {
+      it = tensors_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  next_eviction_size_ = std::max<size_t>(16, 2 * tensors_.size());
+}
+
+}  // namespace tensorflow
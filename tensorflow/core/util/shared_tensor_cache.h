@@ -0,0 +1,73 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_SHARED_TENSOR_CACHE_H_
+#define TENSORFLOW_CORE_UTIL_SHARED_TENSOR_CACHE_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A process-wide cache of host tensors keyed by their contents, which lets
+// the constants and restored variables of different models that hold the
+// same values share one buffer.
+//
+// The cache is disabled unless TF_SHARED_TENSOR_CACHE_MIN_BYTES is set to the
+// size in bytes above which tensors are shared.  Callers must only share
+// tensors that are never modified in place: ops only update inputs whose
+// buffer they hold the only reference to, and resource and ref variables copy
+// shared buffers before updating them.
+class SharedTensorCache {
+ public:
+  // Returns the process-wide cache.
+  static SharedTensorCache* Global();
+
+  // `min_bytes` <= 0 disables the cache.
+  explicit SharedTensorCache(int64 min_bytes);
+
+  bool enabled() const { return min_bytes_ > 0; }
+
+  // Returns a tensor with the same contents as `tensor`, whose buffer is
+  // shared with the earlier tensors of the same contents if `tensor` is large
+  // enough and its type can be compared bytewise.  Otherwise returns `tensor`.
+  Tensor Share(const Tensor& tensor) TF_LOCKS_EXCLUDED(mu_);
+
+  // The number of buffers in the cache.
+  size_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Drops the entries that nothing but the cache refers to.
+  void EvictUnusedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 min_bytes_;
+
+  mutable mutex mu_;
+  // Tensors by the fingerprint of their dtype, shape and contents.
+  std::unordered_multimap<uint64, Tensor> tensors_ TF_GUARDED_BY(mu_);
+  // The cache is swept when it grows to this many entries, which keeps the
+  // cost of eviction proportional to the number of insertions.
+  size_t next_eviction_size_ TF_GUARDED_BY(mu_) = 16;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedTensorCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_SHARED_TENSOR_CACHE_H_
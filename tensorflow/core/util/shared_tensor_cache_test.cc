@@ -0,0 +1,78 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/shared_tensor_cache.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor Values(float v, int64 n) {
+  Tensor t(DT_FLOAT, TensorShape({n}));
+  t.flat<float>().setConstant(v);
+  return t;
+}
+
+TEST(SharedTensorCacheTest, SharesEqualTensors) {
+  SharedTensorCache cache(64);
+  const Tensor a = cache.Share(Values(1.f, 32));
+  const Tensor b = cache.Share(Values(1.f, 32));
+  EXPECT_EQ(a.tensor_data().data(), b.tensor_data().data());
+  test::ExpectTensorEqual<float>(Values(1.f, 32), b);
+
+  const Tensor c = cache.Share(Values(2.f, 32));
+  EXPECT_NE(a.tensor_data().data(), c.tensor_data().data());
+  test::ExpectTensorEqual<float>(Values(2.f, 32), c);
+
+  // Tensors of the same bytes but another shape are not shared.
+  Tensor reshaped(DT_FLOAT, TensorShape({4, 8}));
+  CHECK(reshaped.CopyFrom(Values(1.f, 32), TensorShape({4, 8})));
+  const Tensor d = cache.Share(reshaped);
+  EXPECT_NE(a.tensor_data().data(), d.tensor_data().data());
+  EXPECT_EQ(3, cache.size());
+}
+
+TEST(SharedTensorCacheTest, SkipsIneligibleTensors) {
+  SharedTensorCache cache(64);
+  // Too small.
+  cache.Share(Values(1.f, 4));
+  // Not comparable bytewise.
+  cache.Share(test::AsTensor<tstring>(std::vector<tstring>(16, "a")));
+  EXPECT_EQ(0, cache.size());
+
+  SharedTensorCache disabled(0);
+  EXPECT_FALSE(disabled.enabled());
+  const Tensor a = disabled.Share(Values(1.f, 32));
+  const Tensor b = disabled.Share(Values(1.f, 32));
+  EXPECT_NE(a.tensor_data().data(), b.tensor_data().data());
+  EXPECT_EQ(0, disabled.size());
+}
+
+TEST(SharedTensorCacheTest, EvictsUnusedTensors) {
+  SharedTensorCache cache(4);
+  for (int i = 0; i < 100; ++i) cache.Share(Values(i, 4));
+  // Only the cache refers to the tensors, so they are dropped as it grows.
+  EXPECT_LT(cache.size(), 32);
+
+  const Tensor kept = cache.Share(Values(-1.f, 4));
+  for (int i = 100; i < 200; ++i) cache.Share(Values(i, 4));
+  EXPECT_EQ(kept.tensor_data().data(),
+            cache.Share(Values(-1.f, 4)).tensor_data().data());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,318 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include <algorithm>
+#include <cstring>
+#include <set>
+
+#include "absl/strings/match.h"
+#include "absl/strings/strip.h"
+
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+
+const int64 kDeltaBlockBytes = 64 << 10;  // 64KB
+
+namespace {
+
+// Chains longer than this are assumed to be cyclic.
+const int kMaxChainLength = 10000;
+
+const char kFingerprintsSuffix[] = "/.DELTA_FINGERPRINTS";
+const char kBlocksSuffix[] = "/.DELTA_BLOCKS";
+const char kRowsSuffix[] = "/.DELTA_ROWS";
+
+bool CanSplitIntoBlocks(const Tensor& val) {
+  return DataTypeCanUseMemcpy(val.dtype()) && val.dims() >= 1;
+}
+
+int64 RowBytes(const Tensor& val) {
+  if (val.dim_size(0) == 0) return 0;
+  return val.TotalBytes() / val.dim_size(0);
+}
+
+int64 RowsPerBlock(const Tensor& val) {
+  return std::max<int64>(1,
+                         kDeltaBlockBytes / std::max<int64>(1, RowBytes(val)));
+}
+
+int64 NumBlocks(const Tensor& val) {
+  const int64 rows_per_block = RowsPerBlock(val);
+  return (val.dim_size(0) + rows_per_block - 1) / rows_per_block;
+}
+
+// Returns the fingerprints of the blocks of rows of "val".
+Tensor BlockFingerprints(const Tensor& val) {
+  const int64 num_blocks = NumBlocks(val);
+  const int64 rows_per_block = RowsPerBlock(val);
+  const int64 row_bytes = RowBytes(val);
+  const StringPiece data = val.tensor_data();
+  Tensor fingerprints(DT_INT64, TensorShape({num_blocks}));
+  auto fingerprints_flat = fingerprints.flat<int64>();
+  for (int64 block = 0; block < num_blocks; ++block) {
+    const int64 begin = block * rows_per_block;
+    const int64 rows = std::min(rows_per_block, val.dim_size(0) - begin);
+    fingerprints_flat(block) = static_cast<int64>(Fingerprint64(
+        data.substr(begin * row_bytes, rows * row_bytes)));
+  }
+  return fingerprints;
+}
+
+BundleWriter::Options WithBasePrefix(const BundleWriter::Options& options,
+                                     StringPiece base_prefix) {
+  BundleWriter::Options result = options;
+  result.base_prefix = string(base_prefix);
+  return result;
+}
+
+// Looks up the tensor "key" of "reader", allocating it.
+Status LookupNew(BundleReader* reader, const string& key, Tensor* val) {
+  DataType dtype;
+  TensorShape shape;
+  TF_RETURN_IF_ERROR(reader->LookupDtypeAndShape(key, &dtype, &shape));
+  Tensor result(dtype, shape);
+  TF_RETURN_IF_ERROR(reader->Lookup(key, &result));
+  *val = result;
+  return Status::OK();
+}
+
+}  // namespace
+
+DeltaBundleReader::DeltaBundleReader(Env* env, StringPiece prefix) {
+  string current(prefix);
+  while (true) {
+    readers_.emplace_back(new BundleReader(env, current));
+    status_ = readers_.back()->status();
+    if (!status_.ok()) return;
+    if (readers_.back()->base_prefix().empty()) return;
+    if (readers_.size() >= kMaxChainLength) {
+      status_ = errors::DataLoss("The chain of delta bundles ending at ",
+                                 prefix, " has more than ", kMaxChainLength,
+                                 " bundles; is it cyclic?");
+      return;
+    }
+    current = readers_.back()->base_prefix();
+  }
+}
+
+int DeltaBundleReader::FindWhole(StringPiece key) {
+  for (int i = 0; i < readers_.size(); ++i) {
+    if (readers_[i]->Contains(key)) return i;
+  }
+  return -1;
+}
+
+bool DeltaBundleReader::Contains(StringPiece key) {
+  return FindWhole(key) >= 0;
+}
+
+Status DeltaBundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
+                                              TensorShape* shape) {
+  const int whole = FindWhole(key);
+  if (whole < 0) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
+  return readers_[whole]->LookupDtypeAndShape(key, dtype, shape);
+}
+
+Status DeltaBundleReader::Lookup(StringPiece key, Tensor* val) {
+  const int whole = FindWhole(key);
+  if (whole < 0) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
+  TF_RETURN_IF_ERROR(readers_[whole]->Lookup(key, val));
+  if (whole == 0 || !CanSplitIntoBlocks(*val)) return Status::OK();
+
+  // Applies the deltas of the newer bundles, oldest first.
+  const string blocks_key = strings::StrCat(key, kBlocksSuffix);
+  const string rows_key = strings::StrCat(key, kRowsSuffix);
+  const int64 num_blocks = NumBlocks(*val);
+  const int64 rows_per_block = RowsPerBlock(*val);
+  const int64 row_bytes = RowBytes(*val);
+  char* data = const_cast<char*>(val->tensor_data().data());
+  for (int i = whole - 1; i >= 0; --i) {
+    BundleReader* reader = readers_[i].get();
+    if (!reader->Contains(blocks_key)) continue;
+    Tensor blocks, rows;
+    TF_RETURN_IF_ERROR(LookupNew(reader, blocks_key, &blocks));
+    TF_RETURN_IF_ERROR(LookupNew(reader, rows_key, &rows));
+    if (blocks.dtype() != DT_INT64 || rows.dtype() != val->dtype()) {
+      return errors::DataLoss("Invalid delta of key ", key);
+    }
+    const StringPiece rows_data = rows.tensor_data();
+    const auto blocks_flat = blocks.flat<int64>();
+    int64 offset = 0;
+    for (int64 j = 0; j < blocks_flat.size(); ++j) {
+      const int64 block = blocks_flat(j);
+      if (block < 0 || block >= num_blocks) {
+        return errors::DataLoss("Delta of key ", key, " has block ", block,
+                                " but the tensor only has ", num_blocks);
+      }
+      const int64 begin = block * rows_per_block;
+      const int64 bytes =
+          std::min(rows_per_block, val->dim_size(0) - begin) * row_bytes;
+      if (offset + bytes > rows_data.size()) {
+        return errors::DataLoss("Delta of key ", key, " is truncated");
+      }
+      memcpy(data + begin * row_bytes, rows_data.data() + offset, bytes);
+      offset += bytes;
+    }
+    if (offset != rows_data.size()) {
+      return errors::DataLoss("Delta of key ", key, " has ",
+                              rows_data.size() - offset, " unused bytes");
+    }
+  }
+  return Status::OK();
+}
+
+Status DeltaBundleReader::LookupFingerprints(StringPiece key,
+                                             Tensor* fingerprints) {
+  const string fingerprints_key = strings::StrCat(key, kFingerprintsSuffix);
+  if (!readers_.front()->Contains(fingerprints_key)) {
+    return errors::NotFound("Key ", key, " has no block fingerprints");
+  }
+  return LookupNew(readers_.front().get(), fingerprints_key, fingerprints);
+}
+
+std::vector<string> DeltaBundleReader::Keys() {
+  std::set<string> keys;
+  for (const auto& reader : readers_) {
+    reader->Seek(kHeaderEntryKey);
+    for (reader->Next(); reader->Valid(); reader->Next()) {
+      StringPiece key = reader->key();
+      // Skips the slices of partitioned tensors, whose keys start with 0.
+      if (key.empty() || key[0] == '\0') continue;
+      if (absl::EndsWith(key, kBlocksSuffix) ||
+          absl::EndsWith(key, kRowsSuffix)) {
+        continue;
+      }
+      absl::ConsumeSuffix(&key, kFingerprintsSuffix);
+      keys.emplace(key);
+    }
+  }
+  return std::vector<string>(keys.begin(), keys.end());
+}
+
+DeltaBundleWriter::DeltaBundleWriter(Env* env, StringPiece prefix,
+                                     StringPiece base_prefix,
+                                     const BundleWriter::Options& options)
+    : writer_(env, prefix, WithBasePrefix(options, base_prefix)) {
+  status_ = writer_.status();
+  if (!status_.ok() || base_prefix.empty()) return;
+  base_.reset(new DeltaBundleReader(env, base_prefix));
+  status_ = base_->status();
+}
+
+Status DeltaBundleWriter::Add(StringPiece key, const Tensor& val) {
+  if (!status_.ok()) return status_;
+  if (!CanSplitIntoBlocks(val)) {
+    status_ = writer_.Add(key, val);
+    return status_;
+  }
+
+  // Compares the blocks of "val" with those of the base.
+  const Tensor fingerprints = BlockFingerprints(val);
+  const int64 num_blocks = fingerprints.NumElements();
+  std::vector<int64> changed_blocks;
+  bool whole = true;
+  if (base_ != nullptr) {
+    DataType base_dtype;
+    TensorShape base_shape;
+    Tensor base_fingerprints;
+    if (base_->LookupDtypeAndShape(key, &base_dtype, &base_shape).ok() &&
+        base_dtype == val.dtype() && base_shape == val.shape() &&
+        base_->LookupFingerprints(key, &base_fingerprints).ok() &&
+        base_fingerprints.NumElements() == num_blocks) {
+      const auto current = fingerprints.flat<int64>();
+      const auto previous = base_fingerprints.flat<int64>();
+      for (int64 block = 0; block < num_blocks; ++block) {
+        if (current(block) != previous(block)) changed_blocks.push_back(block);
+      }
+      // Writing most blocks one by one is no cheaper than the whole tensor,
+      // and would make restores slower.
+      whole = 2 * changed_blocks.size() > num_blocks;
+    }
+  }
+
+  if (whole) {
+    status_ = writer_.Add(key, val);
+  } else if (!changed_blocks.empty()) {
+    const int64 rows_per_block = RowsPerBlock(val);
+    const int64 row_bytes = RowBytes(val);
+    int64 num_rows = 0;
+    for (const int64 block : changed_blocks) {
+      num_rows += std::min(rows_per_block,
+                           val.dim_size(0) - block * rows_per_block);
+    }
+    TensorShape rows_shape = val.shape();
+    rows_shape.set_dim(0, num_rows);
+    Tensor blocks(DT_INT64, TensorShape({static_cast<int64>(
+                                changed_blocks.size())}));
+    Tensor rows(val.dtype(), rows_shape);
+    const char* src = val.tensor_data().data();
+    char* dst = const_cast<char*>(rows.tensor_data().data());
+    for (int i = 0; i < changed_blocks.size(); ++i) {
+      const int64 begin = changed_blocks[i] * rows_per_block;
+      const int64 bytes =
+          std::min(rows_per_block, val.dim_size(0) - begin) * row_bytes;
+      memcpy(dst, src + begin * row_bytes, bytes);
+      dst += bytes;
+      blocks.flat<int64>()(i) = changed_blocks[i];
+    }
+    status_ = writer_.Add(strings::StrCat(key, kBlocksSuffix), blocks);
+    if (status_.ok()) {
+      status_ = writer_.Add(strings::StrCat(key, kRowsSuffix), rows);
+    }
+  }
+  if (status_.ok()) {
+    status_ =
+        writer_.Add(strings::StrCat(key, kFingerprintsSuffix), fingerprints);
+  }
+  return status_;
+}
+
+Status DeltaBundleWriter::Finish() {
+  if (!status_.ok()) return status_;
+  status_ = writer_.Finish();
+  return status_;
+}
+
+Status CompactDeltaBundles(Env* env, StringPiece prefix,
+                           StringPiece compacted_prefix) {
+  if (prefix == compacted_prefix) {
+    return errors::InvalidArgument(
+        "Cannot compact delta bundles in place, at ", prefix);
+  }
+  DeltaBundleReader reader(env, prefix);
+  TF_RETURN_IF_ERROR(reader.status());
+  DeltaBundleWriter writer(env, compacted_prefix, /*base_prefix=*/"");
+  for (const string& key : reader.Keys()) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupDtypeAndShape(key, &dtype, &shape));
+    Tensor val(dtype, shape);
+    TF_RETURN_IF_ERROR(reader.Lookup(key, &val));
+    TF_RETURN_IF_ERROR(writer.Add(key, val));
+  }
+  return writer.Finish();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,145 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta bundles: tensor bundles that only store what changed since a base.
+//
+// A delta bundle is a regular tensor bundle whose header names the bundle it
+// is a delta over, its "base", which may be a delta bundle itself.  A chain of
+// deltas ends at a full bundle.
+//
+// DeltaBundleWriter splits each tensor of a memcpy-able dtype along its first
+// dimension into blocks of about kDeltaBlockBytes, and stores the
+// fingerprints of the blocks next to the tensor.  In a delta bundle, a tensor
+// is then stored as the blocks whose fingerprints differ from those of the
+// base, unless most of them do, in which case it is stored whole:
+//
+//   <key>                        The whole tensor, if stored whole.
+//   <key>/.DELTA_FINGERPRINTS    The fingerprints of all blocks, as int64.
+//   <key>/.DELTA_BLOCKS          The indices of the blocks stored, if any.
+//   <key>/.DELTA_ROWS            The rows of those blocks, concatenated.
+//
+// Comparing fingerprints, rather than tracking the rows that ops write,
+// catches every kind of update, whichever kernel or device made it.
+//
+// DeltaBundleReader reads the tensors of a chain as if it were one bundle, and
+// CompactDeltaBundles() rewrites a chain as a full bundle, which bounds the
+// length of the chain that restores walk.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// Approximate size of the blocks of rows that deltas are made of.
+extern const int64 kDeltaBlockBytes;
+
+// Reads a chain of delta bundles, ending at a full bundle.
+class DeltaBundleReader {
+ public:
+  // Opens the bundle "prefix" and the bundles it is a delta over.
+  DeltaBundleReader(Env* env, StringPiece prefix);
+
+  // Is ok() iff all bundles of the chain were opened.
+  Status status() const { return status_; }
+
+  // Number of bundles in the chain, including the full bundle at its end.
+  // REQUIRES: status().ok()
+  int chain_length() const { return readers_.size(); }
+
+  // Queries whether the chain contains a tensor keyed by "key".
+  // REQUIRES: status().ok()
+  bool Contains(StringPiece key);
+
+  // Looks up the dtype and the shape of the tensor keyed by "key".
+  // REQUIRES: status().ok()
+  Status LookupDtypeAndShape(StringPiece key, DataType* dtype,
+                             TensorShape* shape) TF_MUST_USE_RESULT;
+
+  // Looks up the tensor keyed by "key", applying the deltas of the chain to
+  // the newest bundle that stores it whole.  As in BundleReader::Lookup(),
+  // "val" must have the dtype and shape of the tensor.
+  // REQUIRES: status().ok()
+  Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
+  // Looks up the block fingerprints of "key" in the newest bundle of the
+  // chain.  Returns NotFound if it has none.
+  // REQUIRES: status().ok()
+  Status LookupFingerprints(StringPiece key,
+                            Tensor* fingerprints) TF_MUST_USE_RESULT;
+
+  // Returns the keys of all tensors of the chain, in order.
+  // REQUIRES: status().ok()
+  std::vector<string> Keys();
+
+ private:
+  // Returns the index in "readers_" of the newest bundle that stores "key"
+  // whole, or -1 if there is none.
+  int FindWhole(StringPiece key);
+
+  Status status_;
+  // The bundles of the chain, newest first.
+  std::vector<std::unique_ptr<BundleReader>> readers_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleReader);
+};
+
+// Writes a bundle as a delta over a base bundle, or as a full bundle whose
+// tensors later deltas can be compared against.
+class DeltaBundleWriter {
+ public:
+  // Writes the bundle "prefix" as a delta over the bundle "base_prefix", or as
+  // a full bundle if "base_prefix" is empty.
+  DeltaBundleWriter(Env* env, StringPiece prefix, StringPiece base_prefix,
+                    const BundleWriter::Options& options =
+                        BundleWriter::Options());
+
+  // Adds the tensor "val" under key "key", storing only the blocks that
+  // changed since the base where possible.  Keys must be unique.
+  Status Add(StringPiece key, const Tensor& val);
+
+  // Finishes the writer and flushes.
+  Status Finish() TF_MUST_USE_RESULT;
+
+  Status status() const { return status_; }
+
+ private:
+  // Null if writing a full bundle.
+  std::unique_ptr<DeltaBundleReader> base_;
+  BundleWriter writer_;
+  Status status_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeltaBundleWriter);
+};
+
+// Rewrites the chain of delta bundles ending at "prefix" as the full bundle
+// "compacted_prefix", which later deltas can use as their base.
+Status CompactDeltaBundles(Env* env, StringPiece prefix,
+                           StringPiece compacted_prefix);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_BUNDLE_H_
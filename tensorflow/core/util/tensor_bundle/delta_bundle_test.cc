@@ -0,0 +1,158 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_bundle.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+string Prefix(const string& prefix) {
+  return strings::StrCat(testing::TmpDir(), "/", prefix);
+}
+
+// 4096 rows of 256 bytes, which make 16 blocks of 256 rows.
+Tensor Embedding(float v) {
+  Tensor t(DT_FLOAT, TensorShape({4096, 64}));
+  t.flat<float>().setConstant(v);
+  return t;
+}
+
+void SetRow(Tensor* t, int64 row, float v) {
+  t->matrix<float>().chip<0>(row).setConstant(v);
+}
+
+void ExpectLookup(DeltaBundleReader* reader, const string& key,
+                  const Tensor& expected) {
+  DataType dtype;
+  TensorShape shape;
+  TF_ASSERT_OK(reader->LookupDtypeAndShape(key, &dtype, &shape));
+  EXPECT_EQ(expected.dtype(), dtype);
+  EXPECT_EQ(expected.shape(), shape);
+  Tensor val(dtype, shape);
+  TF_ASSERT_OK(reader->Lookup(key, &val));
+  test::ExpectTensorEqual<float>(expected, val);
+}
+
+Status Write(const string& prefix, const string& base_prefix,
+             const Tensor& emb, const Tensor& bias) {
+  DeltaBundleWriter writer(Env::Default(), prefix, base_prefix);
+  TF_RETURN_IF_ERROR(writer.Add("bias", bias));
+  TF_RETURN_IF_ERROR(writer.Add("emb", emb));
+  return writer.Finish();
+}
+
+TEST(DeltaBundleTest, Basic) {
+  Tensor emb = Embedding(1.f);
+  const Tensor bias = test::AsTensor<float>({1.f, 2.f});
+  TF_ASSERT_OK(Write(Prefix("full"), "", emb, bias));
+
+  SetRow(&emb, 0, 2.f);
+  SetRow(&emb, 3000, 3.f);
+  TF_ASSERT_OK(Write(Prefix("delta1"), Prefix("full"), emb, bias));
+  const Tensor emb1 = tensor::DeepCopy(emb);
+
+  SetRow(&emb, 100, 4.f);
+  TF_ASSERT_OK(Write(Prefix("delta2"), Prefix("delta1"), emb, bias));
+
+  // Only the changed blocks are stored.
+  {
+    BundleReader reader(Env::Default(), Prefix("delta1"));
+    TF_ASSERT_OK(reader.status());
+    EXPECT_EQ(Prefix("full"), reader.base_prefix());
+    EXPECT_FALSE(reader.Contains("emb"));
+    EXPECT_FALSE(reader.Contains("bias"));
+    EXPECT_FALSE(reader.Contains("bias/.DELTA_BLOCKS"));
+    Tensor blocks(DT_INT64, TensorShape({2}));
+    TF_ASSERT_OK(reader.Lookup("emb/.DELTA_BLOCKS", &blocks));
+    test::ExpectTensorEqual<int64>(test::AsTensor<int64>({0, 11}), blocks);
+  }
+
+  DeltaBundleReader reader(Env::Default(), Prefix("delta2"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(3, reader.chain_length());
+  EXPECT_EQ(std::vector<string>({"bias", "emb"}), reader.Keys());
+  ExpectLookup(&reader, "emb", emb);
+  ExpectLookup(&reader, "bias", bias);
+  EXPECT_FALSE(reader.Contains("missing"));
+
+  DeltaBundleReader reader1(Env::Default(), Prefix("delta1"));
+  TF_ASSERT_OK(reader1.status());
+  ExpectLookup(&reader1, "emb", emb1);
+}
+
+TEST(DeltaBundleTest, MostlyChanged) {
+  const Tensor bias = test::AsTensor<float>({1.f, 2.f});
+  TF_ASSERT_OK(Write(Prefix("mostly_full"), "", Embedding(1.f), bias));
+  // Tensors whose shape or most blocks changed are stored whole.
+  const Tensor new_bias = test::AsTensor<float>({1.f, 2.f, 3.f});
+  TF_ASSERT_OK(Write(Prefix("mostly_delta"), Prefix("mostly_full"),
+                     Embedding(2.f), new_bias));
+
+  BundleReader reader(Env::Default(), Prefix("mostly_delta"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_TRUE(reader.Contains("emb"));
+  EXPECT_TRUE(reader.Contains("bias"));
+
+  DeltaBundleReader delta_reader(Env::Default(), Prefix("mostly_delta"));
+  TF_ASSERT_OK(delta_reader.status());
+  ExpectLookup(&delta_reader, "emb", Embedding(2.f));
+  ExpectLookup(&delta_reader, "bias", new_bias);
+}
+
+TEST(DeltaBundleTest, Compact) {
+  Tensor emb = Embedding(1.f);
+  const Tensor bias = test::AsTensor<float>({1.f, 2.f});
+  TF_ASSERT_OK(Write(Prefix("compact_full"), "", emb, bias));
+  SetRow(&emb, 1000, 5.f);
+  TF_ASSERT_OK(
+      Write(Prefix("compact_delta"), Prefix("compact_full"), emb, bias));
+
+  TF_ASSERT_OK(CompactDeltaBundles(Env::Default(), Prefix("compact_delta"),
+                                   Prefix("compacted")));
+  DeltaBundleReader reader(Env::Default(), Prefix("compacted"));
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(1, reader.chain_length());
+  ExpectLookup(&reader, "emb", emb);
+  ExpectLookup(&reader, "bias", bias);
+
+  // The compacted bundle can be the base of later deltas.
+  SetRow(&emb, 2000, 6.f);
+  TF_ASSERT_OK(Write(Prefix("after_compact"), Prefix("compacted"), emb, bias));
+  BundleReader delta(Env::Default(), Prefix("after_compact"));
+  TF_ASSERT_OK(delta.status());
+  EXPECT_FALSE(delta.Contains("emb"));
+  DeltaBundleReader chain(Env::Default(), Prefix("after_compact"));
+  TF_ASSERT_OK(chain.status());
+  ExpectLookup(&chain, "emb", emb);
+
+  EXPECT_TRUE(errors::IsInvalidArgument(CompactDeltaBundles(
+      Env::Default(), Prefix("compacted"), Prefix("compacted"))));
+}
+
+TEST(DeltaBundleTest, MissingBase) {
+  DeltaBundleWriter writer(Env::Default(), Prefix("orphan"),
+                           Prefix("no_such_bundle"));
+  EXPECT_FALSE(writer.status().ok());
+  EXPECT_FALSE(writer.Finish().ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
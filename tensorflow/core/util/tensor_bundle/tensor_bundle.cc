@@ -21,6 +21,8 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -41,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -379,9 +382,29 @@ table::Options TableBuilderOptions() {
   // (version 1.2) with the intention that they will be enabled again at
   // some point (perhaps the 1.3 release?).
   o.compression = table::kNoCompression;
+  // Lets readers tell most missing keys apart without reading data blocks.
+  o.filter_bits_per_key = 10;
   return o;
 }
 
+// Returns the pool on which bundle readers prefetch metadata blocks, or
+// nullptr if TF_TABLE_PREFETCH_NUM_THREADS is not set.
+thread::ThreadPool* MetadataPrefetchPool() {
+  static thread::ThreadPool* pool = []() -> thread::ThreadPool* {
+    int64 num_threads;
+    Status s =
+        ReadInt64FromEnvVar("TF_TABLE_PREFETCH_NUM_THREADS", 0, &num_threads);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return nullptr;
+    }
+    if (num_threads <= 0) return nullptr;
+    return new thread::ThreadPool(Env::Default(), "bundle_metadata_prefetch",
+                                  num_threads);
+  }();
+  return pool;
+}
+
 // Writes zeros to output buffer to align the next write to the requested
 // alignment. "size" is the current size of the buffer and is updated to the
 // new size.
@@ -398,21 +421,43 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// A tensor buffer in a memory mapping of a data file, which it keeps alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(const char* data, size_t size,
+                     std::shared_ptr<ReadOnlyMemoryRegion> region)
+      : TensorBuffer(const_cast<char*>(data)),
+        size_(size),
+        region_(std::move(region)) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleReaderMapping");
+  }
+  // The mapping is read-only, so the buffer must never be written in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const size_t size_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env),
-      options_(options),
-      prefix_(prefix),
-      out_(nullptr),
-      size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
+  if (options_.num_stripes < 1) {
+    status_ = errors::InvalidArgument("num_stripes must be at least 1, got ",
+                                      options_.num_stripes);
+    return;
+  }
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
 
-  data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -422,13 +467,30 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::unique_ptr<FileOutputBuffer>(
-      new FileOutputBuffer(wrapper.release(), 8 << 20 /* 8MB write buffer */));
+  stripes_.resize(options_.num_stripes);
+  for (int i = 0; i < options_.num_stripes; ++i) {
+    Stripe* stripe = &stripes_[i];
+    stripe->data_path = DataFilename(prefix_, i, options_.num_stripes);
+    if (use_temp_file_) {
+      stripe->data_path =
+          strings::StrCat(stripe->data_path, ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(stripe->data_path, &wrapper);
+    if (!status_.ok()) {
+      // Removes the data files created so far.
+      for (int j = 0; j < i; ++j) {
+        stripes_[j].out = nullptr;
+        Env::Default()->DeleteFile(stripes_[j].data_path).IgnoreError();
+      }
+      stripes_.clear();
+      return;
+    }
+    stripe->out = std::unique_ptr<FileOutputBuffer>(new FileOutputBuffer(
+        wrapper.release(), 8 << 20 /* 8MB write buffer */));
 
-  VLOG(1) << "Writing to file " << data_path_;
+    VLOG(1) << "Writing to file " << stripe->data_path;
+  }
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
@@ -443,29 +505,72 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
+
+  if (stripes_.size() == 1) {
+    entry->set_shard_id(0);
+    status_ = WriteToStripe(val, &stripes_[0], entry);
+    return status_;
+  }
+
+  // Defers the write to Finish(), which writes all stripes concurrently.
+  auto stripe = std::min_element(stripes_.begin(), stripes_.end(),
+                                 [](const Stripe& a, const Stripe& b) {
+                                   return a.pending_bytes < b.pending_bytes;
+                                 });
+  entry->set_shard_id(stripe - stripes_.begin());
+  stripe->pending.emplace_back(entry, val);
+  stripe->pending_bytes += val.TotalBytes();
+  return status_;
+}
+
+Status BundleWriter::WriteToStripe(const Tensor& val, Stripe* stripe,
+                                   BundleEntryProto* entry) {
+  FileOutputBuffer* out = stripe->out.get();
+  entry->set_offset(stripe->size);
 
   // Updates the data file.
   size_t data_bytes_written = 0;
   uint32 crc32c = 0;
-  out_->clear_crc32c();
+  out->clear_crc32c();
+  Status status;
   if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    status = WriteStringTensor(val, out, &data_bytes_written, &crc32c);
   } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
+    status = WriteVariantTensor(val, out, &data_bytes_written, &crc32c);
   } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
+    status = WriteTensor(val, out, &data_bytes_written);
+    crc32c = out->crc32c();
   }
 
-  if (status_.ok()) {
+  if (status.ok()) {
     entry->set_size(data_bytes_written);
     entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+    stripe->size += data_bytes_written;
+    status = PadAlignment(out, options_.data_alignment, &stripe->size);
   }
-  return status_;
+  return status;
+}
+
+Status BundleWriter::WritePendingTensors() {
+  // Each thread only touches its own stripe and the entries of the tensors in
+  // it.
+  std::vector<Status> statuses(stripes_.size());
+  {
+    thread::ThreadPool pool(env_, "bundle_writer", stripes_.size());
+    for (size_t i = 0; i < stripes_.size(); ++i) {
+      pool.Schedule([this, i, &statuses]() {
+        Stripe* stripe = &stripes_[i];
+        for (const auto& pending : stripe->pending) {
+          statuses[i] = WriteToStripe(pending.second, stripe, pending.first);
+          if (!statuses[i].ok()) break;
+        }
+        stripe->pending.clear();
+      });
+    }
+  }
+  Status status;
+  for (const Status& s : statuses) status.Update(s);
+  return status;
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -512,17 +617,25 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
+  if (!stripes_.empty()) {
+    if (status_.ok() && stripes_.size() > 1) {
+      status_ = WritePendingTensors();
+    }
+    for (Stripe& stripe : stripes_) {
+      status_.Update(stripe.out->Close());
+      stripe.out = nullptr;
+    }
+    for (int i = 0; i < stripes_.size(); ++i) {
+      if (status_.ok()) {
+        if (use_temp_file_) {
+          status_ = Env::Default()->RenameFile(
+              stripes_[i].data_path, DataFilename(prefix_, i, stripes_.size()));
+        }
+      } else {
+        Env::Default()->DeleteFile(stripes_[i].data_path).IgnoreError();
       }
-    } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
     }
+    stripes_.clear();
   }
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
@@ -532,12 +645,11 @@ Status BundleWriter::Finish() {
   {
     // N.B.: the default use of Snappy compression may not be supported on all
     // platforms (e.g. Android).  The metadata file is small, so this is fine.
-    table::Options options;
-    options.compression = table::kNoCompression;
-    table::TableBuilder builder(options, file.get());
+    table::TableBuilder builder(TableBuilderOptions(), file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(options_.num_stripes);
+    header.set_base_prefix(options_.base_prefix);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -577,6 +689,7 @@ struct MergeState {
   bool seen_first_bundle = false;
   BundleHeaderProto_Endianness endianness;
   VersionDef version;
+  string base_prefix;
 
   // Tensor key -> BundleEntryProto.
   std::map<string, BundleEntryProto> entries;
@@ -618,6 +731,7 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
       merge_state->seen_first_bundle = true;
       merge_state->endianness = header.endianness();
       merge_state->version = header.version();
+      merge_state->base_prefix = header.base_prefix();
     } else {
       // Validates "endianness".
       if (merge_state->endianness != header.endianness()) {
@@ -633,6 +747,12 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
             "Merging bundles with different format versions: merged ",
             merge_version, " vs. curr ", curr_version);
       }
+      // Validates "base_prefix".
+      if (merge_state->base_prefix != header.base_prefix()) {
+        return errors::InvalidArgument(
+            "Merging delta bundles over different bases: merged ",
+            merge_state->base_prefix, " vs. curr ", header.base_prefix());
+      }
     }
     num_shards = header.num_shards();
     iter->Next();
@@ -714,6 +834,7 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     // Header entry.
     BundleHeaderProto header;
     header.set_num_shards(merge.num_shards);
+    header.set_base_prefix(merge.base_prefix);
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
@@ -763,6 +884,7 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
     index_cache_ = table::NewLRUCache(cache_size << 20);
     o.block_cache = index_cache_;
   }
+  o.prefetch_pool = MetadataPrefetchPool();
 
   status_ = table::Table::Open(o, metadata_, file_size, &table_);
   if (!status_.ok()) return;
@@ -782,6 +904,7 @@ BundleReader::BundleReader(Env* env, StringPiece prefix)
     return;
   }
   num_shards_ = header.num_shards();
+  base_prefix_ = header.base_prefix();
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -818,6 +941,9 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
                                          BundleEntryProto* entry) {
   entry->Clear();
   TF_CHECK_OK(status_);
+  if (!table_->KeyMayMatch(key)) {
+    return errors::NotFound("Key ", key, " not found in checkpoint");
+  }
   Seek(key);
   if (!iter_->Valid() || iter_->key() != key) {
     return errors::NotFound("Key ", key, " not found in checkpoint");
@@ -944,6 +1070,75 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+
+  std::shared_ptr<ReadOnlyMemoryRegion> region;
+  if (entry.slices().empty() && DataTypeCanUseMemcpy(entry.dtype()) &&
+      !need_to_swap_bytes_ &&
+      entry.offset() % Allocator::kAllocatorAlignment == 0) {
+    auto it = mapped_data_.find(entry.shard_id());
+    if (it == mapped_data_.end()) {
+      std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+      if (env_->NewReadOnlyMemoryRegionFromFile(
+                  DataFilename(prefix_, entry.shard_id(), num_shards_),
+                  &new_region)
+              .ok()) {
+        it = mapped_data_.emplace(entry.shard_id(), std::move(new_region))
+                 .first;
+      } else {
+        it = mapped_data_.emplace(entry.shard_id(), nullptr).first;
+      }
+    }
+    region = it->second;
+  }
+  if (region == nullptr) {
+    Tensor copy(entry.dtype(), shape);
+    if (entry.slices().empty()) {
+      TF_RETURN_IF_ERROR(GetValue(entry, &copy));
+    } else {
+      TF_RETURN_IF_ERROR(GetSliceValue(
+          key, entry, /* a full slice */ TensorSlice(shape.dims()), &copy));
+    }
+    *val = copy;
+    return Status::OK();
+  }
+
+  const size_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(), "; expected size ",
+                            expected_size);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("Bundle entry of key ", key, " at offset ",
+                            entry.offset(), " of size ", entry.size(),
+                            " is past the end of its data file");
+  }
+  if (entry.size() == 0) {
+    *val = Tensor(entry.dtype(), shape);
+    return Status::OK();
+  }
+  const char* data =
+      static_cast<const char*>(region->data()) + entry.offset();
+  const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the mapped bytes ", actual_crc32c);
+  }
+  TensorBuffer* buffer =
+      new MappedTensorBuffer(data, entry.size(), std::move(region));
+  *val = Tensor(entry.dtype(), shape, buffer);
+  buffer->Unref();
+  return Status::OK();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1098,6 +1293,7 @@ Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
 }
 
 bool BundleReader::Contains(StringPiece key) {
+  if (!table_->KeyMayMatch(key)) return false;
   Seek(key);
   return Valid() && (this->key() == key);
 }
@@ -62,8 +62,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -112,6 +115,16 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files ("stripes") across which tensors are spread.
+    // With more than one, Add() only assigns each tensor to the stripe with
+    // the fewest bytes so far, and Finish() writes and checksums the stripes
+    // concurrently, one thread per stripe.  The added tensors must then not
+    // be modified until Finish() returns.
+    // Must be >= 1.
+    int num_stripes{1};
+    // Prefix of the bundle that this bundle is a delta over, recorded in the
+    // header.  Only meaningful to the readers in delta_bundle.h.
+    string base_prefix;
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
@@ -146,14 +159,30 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // One data file of the bundle.
+  struct Stripe {
+    string data_path;
+    std::unique_ptr<FileOutputBuffer> out;
+    int64 size = 0;  // Number of bytes written into out.
+    // With more than one stripe, the tensors that Finish() writes to this
+    // stripe, and their total size.
+    std::vector<std::pair<BundleEntryProto*, Tensor>> pending;
+    int64 pending_bytes = 0;
+  };
+
+  // Appends "val" to the data file of "stripe", and records where in "entry".
+  Status WriteToStripe(const Tensor& val, Stripe* stripe,
+                       BundleEntryProto* entry);
+
+  // Writes the pending tensors of all stripes concurrently.
+  Status WritePendingTensors();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
   string metadata_path_;
-  string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<FileOutputBuffer> out_;
-  int64 size_;  // Number of bytes written into out_.
+  std::vector<Stripe> stripes_;
   std::map<string, BundleEntryProto> entries_;
   Status status_;
 
@@ -219,6 +248,21 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but replaces "val" with a tensor that, where possible, is
+  // backed in place by a read-only memory mapping of the data file instead of
+  // a copy.  The mapping lives as long as any tensor sharing it, and is
+  // shared by all processes mapping the same file.  Ops that update such a
+  // tensor in place copy it first, as its buffer does not own its memory.
+  //
+  // Only tensors of memcpy-able dtypes, stored whole, in this machine's byte
+  // order, at offsets aligned to Allocator::kAllocatorAlignment (see
+  // BundleWriter::Options::data_alignment) are mapped; others, and all
+  // tensors of file systems that cannot map files, are copied as by Lookup().
+  //
+  // Validates the stored crc32c checksum against the mapped bytes.
+  // REQUIRES: status().ok()
+  Status LookupMapped(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -263,6 +307,11 @@ class BundleReader {
 
   string DebugString();
 
+  // Returns the prefix of the bundle that this bundle is a delta over, or the
+  // empty string if it is a full bundle.
+  // REQUIRES: status().ok()
+  const string& base_prefix() const { return base_prefix_; }
+
  private:
   // Seeks for "key" and reads the metadata proto.
   // On non-OK return, clears "entry" for the caller.
@@ -293,6 +342,10 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // Memory mappings of the data files used by LookupMapped(), which are null
+  // for files that cannot be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -302,6 +355,9 @@ class BundleReader {
   // the header entry in the metadata table.
   int num_shards_;
 
+  // Extracted from the header entry too.
+  string base_prefix_;
+
   // Flag that this class sets to true when the endianness of the target bundle
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
@@ -882,6 +882,85 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, Stripes) {
+  Env* env = Env::Default();
+  BundleWriter::Options opts;
+  opts.num_stripes = 3;
+  {
+    BundleWriter writer(env, Prefix("striped"), opts);
+    TF_EXPECT_OK(writer.Add("big", Constant(1.f, TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("small0", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("small1", Constant_2x3<double>(3.)));
+    TF_EXPECT_OK(writer.Add("strs", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.AddSlice("part", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant(4.f, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("striped"), i, 3)));
+  }
+
+  BundleReader reader(env, Prefix("striped"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "big", Constant(1.f, TensorShape({1000})));
+  Expect<int32>(&reader, "small0", Constant_2x3<int32>(2));
+  Expect<double>(&reader, "small1", Constant_2x3<double>(3.));
+  Expect<tstring>(&reader, "strs", Constant_2x3<tstring>("hello"));
+  Tensor part(DT_FLOAT, TensorShape({2}));
+  TF_ASSERT_OK(
+      reader.LookupSlice("part", TensorSlice::ParseOrDie("0,2"), &part));
+  test::ExpectTensorEqual<float>(part, Constant(4.f, TensorShape({2})));
+
+  // Striped bundles merge like any other multi-shard bundle.
+  TF_ASSERT_OK(
+      MergeBundles(env, {Prefix("striped")}, Prefix("merged_stripes")));
+  BundleReader merged_reader(env, Prefix("merged_stripes"));
+  TF_ASSERT_OK(merged_reader.status());
+  Expect<float>(&merged_reader, "big", Constant(1.f, TensorShape({1000})));
+  Expect<tstring>(&merged_reader, "strs", Constant_2x3<tstring>("hello"));
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  BundleWriter::Options opts;
+  opts.data_alignment = 4096;
+  {
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("floats", Constant(1.f, TensorShape({1000}))));
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int32>(2)));
+    TF_EXPECT_OK(writer.Add("strs", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.AddSlice("halves", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant(5.f, TensorShape({2}))));
+    TF_EXPECT_OK(writer.AddSlice("halves", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("2,2"),
+                                 Constant(6.f, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(Env::Default(), Prefix("mapped"));
+  TF_ASSERT_OK(reader.status());
+  Tensor floats, same_floats, ints;
+  TF_ASSERT_OK(reader.LookupMapped("floats", &floats));
+  test::ExpectTensorEqual<float>(floats, Constant(1.f, TensorShape({1000})));
+  TF_ASSERT_OK(reader.LookupMapped("ints", &ints));
+  test::ExpectTensorEqual<int32>(ints, Constant_2x3<int32>(2));
+  // Both lookups see the same mapped bytes.
+  TF_ASSERT_OK(reader.LookupMapped("floats", &same_floats));
+  EXPECT_EQ(floats.tensor_data().data(), same_floats.tensor_data().data());
+
+  // Tensors that cannot be mapped are copied.
+  Tensor strs, halves;
+  TF_ASSERT_OK(reader.LookupMapped("strs", &strs));
+  test::ExpectTensorEqual<tstring>(strs, Constant_2x3<tstring>("hello"));
+  TF_ASSERT_OK(reader.LookupMapped("halves", &halves));
+  test::ExpectTensorEqual<float>(
+      halves, test::AsTensor<float>({5.f, 5.f, 6.f, 6.f}, TensorShape({4})));
+
+  Tensor missing;
+  EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &missing)));
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
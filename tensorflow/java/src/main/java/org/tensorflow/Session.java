@@ -158,6 +158,20 @@ public final class Session implements AutoCloseable {
       return this;
     }
 
+    /**
+     * Replaces the Tensor fed by the {@code index}-th call to a {@code feed} method with {@code t}.
+     *
+     * <p>A Runner can be run any number of times. Setting up its feeds, fetches and targets once
+     * and only replacing the fed Tensors between runs avoids looking up operations and
+     * rebuilding the Runner for every request.
+     *
+     * @throws IndexOutOfBoundsException if fewer than {@code index + 1} feeds were added
+     */
+    public Runner setFeed(int index, Tensor<?> t) {
+      inputTensors.set(index, t);
+      return this;
+    }
+
     /**
      * Make {@link #run()} return the output of {@code operation}.
      *
@@ -266,6 +266,51 @@ public final class Tensor<T> implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Create a Tensor of any type that uses the memory of a direct buffer, without copying it.
+   *
+   * <p>Like {@link #create(Class, long[], ByteBuffer)}, the remaining bytes of {@code data} hold
+   * the tensor data as per the specification of the TensorFlow <a
+   * href="https://www.tensorflow.org/code/tensorflow/c/c_api.h">C API</a>, in native byte order.
+   * Unlike it, the Tensor refers to the buffer's memory instead of holding a copy, so a service
+   * can reuse a pool of direct buffers for its feeds and avoid a copy per request. The data is
+   * only copied if the buffer's address is not aligned the way TensorFlow requires, which {@link
+   * ByteBuffer#allocateDirect} does not guarantee.
+   *
+   * <p>The buffer is kept alive as long as the Tensor, or any Tensor computed from it that shares
+   * its memory, exists. It must not be modified during that time.
+   *
+   * @param <T> the tensor element type
+   * @param type the tensor element type, represented as a class object.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If {@code data} is not a direct buffer, or the tensor
+   *     datatype or shape is not compatible with the buffer
+   */
+  public static <T> Tensor<T> createFromDirectBuffer(
+      Class<T> type, long[] shape, ByteBuffer data) {
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("createFromDirectBuffer requires a direct ByteBuffer");
+    }
+    DataType dtype = DataType.fromClass(type);
+    if (dtype != DataType.STRING) {
+      int nbytes = numElements(shape) * elemByteSize(dtype);
+      if (data.remaining() != nbytes) {
+        throw new IllegalArgumentException(
+            String.format(
+                "ByteBuffer with %d bytes is not compatible with a %s Tensor with shape %s",
+                data.remaining(), dtype.toString(), Arrays.toString(shape)));
+      }
+    }
+    Tensor<T> t = new Tensor<T>(dtype);
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    long nativeHandle =
+        allocateFromDirectBuffer(
+            t.dtype.c(), t.shapeCopy, data, data.position(), data.remaining());
+    t.nativeRef = new NativeReference(nativeHandle);
+    return t;
+  }
+
   /**
    * Returns this Tensor object with the type {@code Tensor<U>}. This method is useful when given a
    * value of type {@code Tensor<?>}.
@@ -806,6 +851,9 @@ public final class Tensor<T> implements AutoCloseable {
 
   private static native long allocate(int dtype, long[] shape, long byteSize);
 
+  private static native long allocateFromDirectBuffer(
+      int dtype, long[] shape, ByteBuffer buffer, int offset, long byteSize);
+
   private static native long allocateScalarBytes(byte[] value);
 
   private static native long allocateNonScalarBytes(long[] shape, Object[] value);
@@ -321,6 +321,36 @@ void readNDStringArray(JNIEnv* env, StringTensorReader* reader, int dims_left,
     if (TF_GetCode(status) != TF_OK) return;
   }
 }
+// Keeps a direct ByteBuffer alive while a TF_Tensor uses its memory.
+struct DirectBufferReference {
+  JavaVM* vm;
+  jobject buffer;
+};
+
+// TF_Tensor deallocator for tensors created by allocateFromDirectBuffer. It may
+// run on any thread, e.g. one of a session's threads, so it attaches to the JVM
+// if needed.
+void releaseDirectBuffer(void* data, size_t len, void* arg) {
+  DirectBufferReference* ref = static_cast<DirectBufferReference*>(arg);
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (ref->vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) ==
+      JNI_EDETACHED) {
+#ifdef __ANDROID__
+    attached = ref->vm->AttachCurrentThread(&env, nullptr) == JNI_OK;
+#else
+    attached = ref->vm->AttachCurrentThread(reinterpret_cast<void**>(&env),
+                                            nullptr) == JNI_OK;
+#endif
+  }
+  if (env != nullptr) {
+    env->DeleteGlobalRef(ref->buffer);
+  }
+  if (attached) {
+    ref->vm->DetachCurrentThread();
+  }
+  delete ref;
+}
 }  // namespace
 
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
@@ -362,6 +392,45 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
   return reinterpret_cast<jlong>(t);
 }
 
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateFromDirectBuffer(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer,
+    jint offset, jlong sizeInBytes) {
+  char* data = static_cast<char*>(env->GetDirectBufferAddress(buffer));
+  if (data == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the ByteBuffer is not a direct buffer");
+    return 0;
+  }
+  JavaVM* vm = nullptr;
+  if (env->GetJavaVM(&vm) != JNI_OK) {
+    throwException(env, kIllegalStateException, "unable to get the JavaVM");
+    return 0;
+  }
+  int num_dims = static_cast<int>(env->GetArrayLength(shape));
+  std::unique_ptr<int64_t[]> dims(new int64_t[num_dims]);
+  if (num_dims > 0) {
+    jlong* shape_elems = env->GetLongArrayElements(shape, nullptr);
+    for (int i = 0; i < num_dims; ++i) {
+      dims[i] = static_cast<int64_t>(shape_elems[i]);
+    }
+    env->ReleaseLongArrayElements(shape, shape_elems, JNI_ABORT);
+  }
+  // The TF_Tensor, and any tensor sharing its memory, holds on to the buffer
+  // until it is released by releaseDirectBuffer.
+  DirectBufferReference* ref =
+      new DirectBufferReference{vm, env->NewGlobalRef(buffer)};
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.get(),
+                              num_dims, data + offset,
+                              static_cast<size_t>(sizeInBytes),
+                              releaseDirectBuffer, ref);
+  if (t == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the ByteBuffer is not compatible with the Tensor shape");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(t);
+}
+
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateScalarBytes(
     JNIEnv* env, jclass clazz, jbyteArray value) {
   // TF_STRING tensors are encoded with a table of 8-byte offsets followed by
@@ -31,6 +31,14 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv *, jclass,
                                                             jint, jlongArray,
                                                             jlong);
 
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    allocateFromDirectBuffer
+ * Signature: (I[JLjava/nio/ByteBuffer;IJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateFromDirectBuffer(
+    JNIEnv *, jclass, jint, jlongArray, jobject, jint, jlong);
+
 /*
  * Class:     org_tensorflow_Tensor
  * Method:    allocateScalarBytes
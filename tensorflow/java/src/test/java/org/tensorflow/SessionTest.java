@@ -43,6 +43,26 @@ public class SessionTest {
     }
   }
 
+  @Test
+  public void runnerCanBeReusedWithNewFeeds() {
+    try (Graph g = new Graph();
+        Session s = new Session(g)) {
+      TestUtil.transpose_A_times_X(g, new int[][] {{2}, {3}});
+      try (Tensor<Integer> x1 = Tensors.create(new int[][] {{5}, {7}});
+          Tensor<Integer> x2 = Tensors.create(new int[][] {{1}, {1}})) {
+        Session.Runner runner = s.runner().feed("X", x1).fetch("Y");
+        try (TestUtil.AutoCloseableList<Tensor<?>> outputs =
+            new TestUtil.AutoCloseableList<Tensor<?>>(runner.run())) {
+          assertArrayEquals(new int[][] {{31}}, outputs.get(0).copyTo(new int[1][1]));
+        }
+        try (TestUtil.AutoCloseableList<Tensor<?>> outputs =
+            new TestUtil.AutoCloseableList<Tensor<?>>(runner.setFeed(0, x2).run())) {
+          assertArrayEquals(new int[][] {{5}}, outputs.get(0).copyTo(new int[1][1]));
+        }
+      }
+    }
+  }
+
   @Test
   public void runUsingOperationHandles() {
     try (Graph g = new Graph();
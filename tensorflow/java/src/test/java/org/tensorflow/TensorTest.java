@@ -110,6 +110,34 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void createFromDirectBuffer() {
+    double[] doubles = {1d, 2d, 3d, 4d};
+    ByteBuffer buf = ByteBuffer.allocateDirect(8 * doubles.length).order(ByteOrder.nativeOrder());
+    buf.asDoubleBuffer().put(doubles);
+    try (Tensor<Double> t =
+        Tensor.createFromDirectBuffer(Double.class, new long[] {2, 2}, buf)) {
+      assertArrayEquals(new long[] {2, 2}, t.shape());
+      double[][] actual = new double[2][2];
+      t.copyTo(actual);
+      assertArrayEquals(new double[] {1d, 2d}, actual[0], EPSILON);
+      assertArrayEquals(new double[] {3d, 4d}, actual[1], EPSILON);
+    }
+
+    try {
+      Tensor.createFromDirectBuffer(Double.class, new long[] {2, 2}, ByteBuffer.allocate(32));
+      fail("heap buffers should not be accepted");
+    } catch (IllegalArgumentException e) {
+      // The expected exception.
+    }
+    try {
+      Tensor.createFromDirectBuffer(Double.class, new long[] {3}, buf);
+      fail("mismatched shape should not be accepted");
+    } catch (IllegalArgumentException e) {
+      // The expected exception.
+    }
+  }
+
   @Test
   public void createWithTypedBuffer() {
     int[] ints = {1, 2, 3, 4};
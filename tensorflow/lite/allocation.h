@@ -48,6 +48,16 @@ class Allocation {
   // Return the type of the Allocation.
   Type type() const { return type_; }
 
+  enum class Advice {
+    kWillNeed,
+    kDontNeed,
+  };
+
+  // Hints how the bytes [ptr, ptr + bytes) of the allocation are about to be
+  // accessed. Only mmap'd allocations act on it, so that pages hinted as not
+  // needed can be dropped and read back from the file when next touched.
+  virtual void Advise(const void* ptr, size_t bytes, Advice advice) const {}
+
  protected:
   Allocation(ErrorReporter* error_reporter, Type type)
       : error_reporter_(error_reporter), type_(type) {}
@@ -64,6 +74,7 @@ class MMAPAllocation : public Allocation {
   const void* base() const override;
   size_t bytes() const override;
   bool valid() const override;
+  void Advise(const void* ptr, size_t bytes, Advice advice) const override;
 
   int fd() const { return mmap_fd_; }
 
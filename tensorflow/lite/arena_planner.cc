@@ -31,10 +31,13 @@ constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_inputs, bool preserve_intermediates,
-                           int tensor_alignment)
+                           int tensor_alignment,
+                           SharedMemoryArena* shared_arena)
     : context_(context),
       graph_info_(std::move(graph_info)),
-      arena_(kDefaultArenaAlignment),
+      arena_(kDefaultArenaAlignment, shared_arena),
+      io_arena_(kDefaultArenaAlignment),
+      has_shared_arena_(shared_arena != nullptr),
       persistent_arena_(kDefaultArenaAlignment),
       preserve_inputs_(preserve_inputs),
       preserve_intermediates_(preserve_intermediates),
@@ -52,8 +55,26 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
   return 0;
 }
 
+void ArenaPlanner::SetMaxCachedPlans(int max_cached_plans) {
+  max_cached_plans_ = std::max(max_cached_plans, 0);
+  if (static_cast<int>(cached_plans_.size()) > max_cached_plans_) {
+    cached_plans_.erase(cached_plans_.begin(),
+                        cached_plans_.end() - max_cached_plans_);
+  }
+}
+
+SimpleMemoryArena& ArenaPlanner::ArenaOf(int tensor_index) {
+  if (has_shared_arena_ &&
+      tensor_index < static_cast<int>(is_input_or_output_.size()) &&
+      is_input_or_output_[tensor_index]) {
+    return io_arena_;
+  }
+  return arena_;
+}
+
 TfLiteStatus ArenaPlanner::ResetAllocations() {
   TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
+  TF_LITE_ENSURE_STATUS(io_arena_.ClearPlan());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
   allocs_.clear();
   allocs_.resize(graph_info_->num_tensors());
@@ -65,7 +86,7 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
     if (allocs_[i].first_node > node && allocs_[i].size > 0) {
       TfLiteTensor& tensor = *graph_info_->tensor(i);
       if (tensor.allocation_type == kTfLiteArenaRw) {
-        TF_LITE_ENSURE_STATUS(arena_.Deallocate(context_, allocs_[i]));
+        TF_LITE_ENSURE_STATUS(ArenaOf(i).Deallocate(context_, allocs_[i]));
         allocs_[i].reset();
         tensor.data.raw = nullptr;
       }
@@ -78,9 +99,19 @@ TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   TF_LITE_ENSURE_STATUS(ResetAllocations());
+  cached_plans_.clear();
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
   dealloc_node_.assign(graph_info_->num_tensors(), kNodeNotAssigned);
+  is_input_or_output_.assign(graph_info_->num_tensors(), false);
+  for (int tensor_index : graph_info_->inputs()) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      is_input_or_output_[tensor_index] = true;
+    }
+  }
+  for (int tensor_index : graph_info_->outputs()) {
+    is_input_or_output_[tensor_index] = true;
+  }
 
   // Keeps track of references to each tensor.
   std::vector<int> refcounts(graph_info_->num_tensors(), 0);
@@ -209,7 +240,36 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     }
   }
 
-  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  // A plan of the whole graph only depends on the tensors, so it may be one
+  // that has been computed before.
+  const bool plans_whole_graph =
+      max_cached_plans_ > 0 && first_node == 0 &&
+      last_node >= static_cast<int>(graph_info_->num_nodes()) - 1;
+  if (plans_whole_graph) {
+    std::vector<size_t> key = PlanCacheKey();
+    auto cached = std::find_if(
+        cached_plans_.begin(), cached_plans_.end(),
+        [&key](const CachedPlan& plan) { return plan.key == key; });
+    if (cached != cached_plans_.end()) {
+      allocs_ = cached->allocs;
+      TF_LITE_ENSURE_STATUS(arena_.RestorePlan(cached->arena_plan));
+      TF_LITE_ENSURE_STATUS(io_arena_.RestorePlan(cached->io_arena_plan));
+      TF_LITE_ENSURE_STATUS(
+          persistent_arena_.RestorePlan(cached->persistent_arena_plan));
+      // Make it the most recently used.
+      std::rotate(cached, cached + 1, cached_plans_.end());
+    } else {
+      TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+      if (static_cast<int>(cached_plans_.size()) == max_cached_plans_) {
+        cached_plans_.erase(cached_plans_.begin());
+      }
+      cached_plans_.push_back({std::move(key), allocs_, arena_.GetPlan(),
+                               io_arena_.GetPlan(),
+                               persistent_arena_.GetPlan()});
+    }
+  } else {
+    TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node, last_node));
+  }
   TF_LITE_ENSURE_STATUS(Commit());
 
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
@@ -226,6 +286,9 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
 TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
   // Clear non-persistent arena's buffer.
   TF_LITE_ENSURE_STATUS(arena_.ReleaseBuffer());
+  if (has_shared_arena_) {
+    TF_LITE_ENSURE_STATUS(io_arena_.ReleaseBuffer());
+  }
   // Set data pointers for all non-persistent tensors to nullptr.
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
     TfLiteTensor& tensor = *graph_info_->tensor(i);
@@ -239,6 +302,9 @@ TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
 TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
   // First commit arena_ to allocate underlying buffer.
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
+  if (has_shared_arena_) {
+    TF_LITE_ENSURE_STATUS(io_arena_.Commit(context_));
+  }
   // Resolve allocations for all tensors not on the persistent arena.
   for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
     TfLiteTensor& tensor = *graph_info_->tensor(i);
@@ -253,8 +319,15 @@ bool ArenaPlanner::HasNonPersistentMemory() {
   return arena_.GetBufferSize() != 0;
 }
 
+bool ArenaPlanner::NonPersistentMemoryMoved() {
+  return arena_.SharedBufferMoved();
+}
+
 TfLiteStatus ArenaPlanner::Commit() {
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
+  if (has_shared_arena_) {
+    TF_LITE_ENSURE_STATUS(io_arena_.Commit(context_));
+  }
   TF_LITE_ENSURE_STATUS(persistent_arena_.Commit(context_));
   return kTfLiteOk;
 }
@@ -310,7 +383,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     if (tensor.allocation_type == kTfLiteArenaRw &&
         allocs_[tensor_index].size != 0) {
-      TF_LITE_ENSURE_STATUS(arena_.Deallocate(context_, allocs_[tensor_index]));
+      TF_LITE_ENSURE_STATUS(
+          ArenaOf(tensor_index).Deallocate(context_, allocs_[tensor_index]));
     }
   }
 
@@ -318,10 +392,16 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      // Tensors of nodes that may run concurrently are live for all of them.
+      const int32_t first_node = graph_info_->first_concurrent_node(
+          alloc_node_[tensor_index]);
+      int32_t last_node = dealloc_node_[tensor_index];
+      if (last_node != kNodeNotAssigned) {
+        last_node = graph_info_->last_concurrent_node(last_node);
+      }
+      TF_LITE_ENSURE_STATUS(ArenaOf(tensor_index).Allocate(
+          context_, tensor_alignment_, tensor.bytes, tensor_index, first_node,
+          last_node, &allocs_[tensor_index]));
     }
     if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
       TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
@@ -334,14 +414,27 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+std::vector<size_t> ArenaPlanner::PlanCacheKey() {
+  std::vector<size_t> key;
+  key.reserve(4 * graph_info_->num_tensors());
+  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    key.push_back(tensor.allocation_type);
+    key.push_back(tensor.bytes);
+    key.push_back(alloc_node_[i]);
+    key.push_back(dealloc_node_[i]);
+  }
+  return key;
+}
+
 TfLiteStatus ArenaPlanner::ResolveTensorAllocation(int tensor_index) {
   TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
   if (tensor.allocation_type == kTfLiteArenaRw) {
     // Skip resolution if the size of the tensor is zero, leaving it as a
     // nullptr.
     if (allocs_[tensor_index].size != 0) {
-      TF_LITE_ENSURE_STATUS(arena_.ResolveAlloc(context_, allocs_[tensor_index],
-                                                &tensor.data.raw));
+      TF_LITE_ENSURE_STATUS(ArenaOf(tensor_index).ResolveAlloc(
+          context_, allocs_[tensor_index], &tensor.data.raw));
     }
   }
   if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
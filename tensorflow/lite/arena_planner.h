@@ -50,10 +50,14 @@ class ArenaPlanner : public MemoryPlanner {
   // Ownership of 'context' is not taken and it must remain util the
   // ArenaPlanner is destroyed. If 'preserve_inputs' is true the inputs to the
   // graph will not share memory with any other tensor, effectively preserving
-  // them until the end of inference.
+  // them until the end of inference. If 'shared_arena' is not null, the
+  // intermediate tensors are allocated in its buffer, which must outlive the
+  // ArenaPlanner, while the inputs and outputs of the graph keep an arena of
+  // their own so that they survive the use of the buffer by others.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_inputs, bool preserve_intermediates,
-               int tensor_alignment = kDefaultTensorAlignment);
+               int tensor_alignment = kDefaultTensorAlignment,
+               SharedMemoryArena* shared_arena = nullptr);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -65,10 +69,20 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
+  bool NonPersistentMemoryMoved() override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // Keeps the plans of up to 'max_cached_plans' sets of tensor sizes, e.g. of
+  // the input shapes that a model is resized to in turn, so that
+  // ExecuteAllocations() over the whole graph reuses the plan of sizes that it
+  // has already seen instead of computing it again. Since the arenas never
+  // shrink, they end up sized for the largest of the plans, and switching
+  // between them only resolves the tensor pointers again. The cache is cleared
+  // by PlanAllocations(). The default of zero keeps no plans.
+  void SetMaxCachedPlans(int max_cached_plans);
+
  private:
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
@@ -100,6 +114,22 @@ class ArenaPlanner : public MemoryPlanner {
   // 'node_index'.
   TfLiteStatus CalculateDeallocationOfInternalTensors(int node_index);
 
+  // Returns the arena of a kTfLiteArenaRw tensor.
+  SimpleMemoryArena& ArenaOf(int tensor_index);
+
+  // Returns what the plan of the whole graph depends on: the allocation type,
+  // size and usage interval of every tensor.
+  std::vector<size_t> PlanCacheKey();
+
+  // The plan of the whole graph for the tensors described by 'key'.
+  struct CachedPlan {
+    std::vector<size_t> key;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    SimpleMemoryArena::Plan arena_plan;
+    SimpleMemoryArena::Plan io_arena_plan;
+    SimpleMemoryArena::Plan persistent_arena_plan;
+  };
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -118,6 +148,13 @@ class ArenaPlanner : public MemoryPlanner {
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
 
+  // Raw memory buffer for the inputs and outputs of the graph that are
+  // declared kTfLiteArenaRw, if 'arena_' commits into a shared buffer.
+  SimpleMemoryArena io_arena_;
+  const bool has_shared_arena_;
+  // Whether each tensor is an input or an output of the graph.
+  std::vector<bool> is_input_or_output_;
+
   // Raw memory buffer that is allocated for persistent tensors that are
   // declared as kTfLiteArenaRwPersistent.
   SimpleMemoryArena persistent_arena_;
@@ -133,6 +170,10 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
+
+  // The cached plans, the least recently used first.
+  int max_cached_plans_ = 0;
+  std::vector<CachedPlan> cached_plans_;
 };
 
 }  // namespace tflite
@@ -105,16 +105,28 @@ class TestGraph {
   const std::vector<int>& outputs() { return outputs_; }
   const std::vector<int>& variables() { return variables_; }
 
+  const std::vector<std::pair<int, int>>& concurrent_nodes() {
+    return concurrent_nodes_;
+  }
+
   void SetVariables(const std::vector<int>& variables) {
     variables_ = variables;
   }
 
+  // Sets, for each node, the first and the last node that may run
+  // concurrently with it.
+  void SetConcurrentNodes(
+      const std::vector<std::pair<int, int>>& concurrent_nodes) {
+    concurrent_nodes_ = concurrent_nodes;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
     std::swap(inputs_, other->inputs_);
     std::swap(outputs_, other->outputs_);
     std::swap(variables_, other->variables_);
+    std::swap(concurrent_nodes_, other->concurrent_nodes_);
   }
 
  private:
@@ -123,6 +135,7 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<std::pair<int, int>> concurrent_nodes_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -144,6 +157,16 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    return graph_->concurrent_nodes().empty()
+               ? index
+               : graph_->concurrent_nodes()[index].first;
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    return graph_->concurrent_nodes().empty()
+               ? index
+               : graph_->concurrent_nodes()[index].second;
+  }
 
  private:
   TestGraph* graph_;
@@ -324,6 +347,146 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(1), 0);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithTemporariesOfConcurrentNodes) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {4}},     // First op
+                      {{0}, {2}, {5}},     // Second op
+                      {{1, 2}, {3}, {}}  // Third op
+                  },
+                  {3});
+  // The first two ops may run concurrently.
+  graph.SetConcurrentNodes({{0, 1}, {0, 1}, {2, 2}});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // Alloc(+) and dealloc(-) order, with the first two ops in one step:
+  // +0 +1 +4 +2 +5 -4 -5 -0 +3 -1 -2
+  // The temporaries do not share memory, as they would if the ops ran one
+  // after the other.
+  EXPECT_EQ(GetOffset(5), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(5));
+  EXPECT_EQ(GetOffset(3), 0);
+  EXPECT_EQ(GetOffset(2), GetOffsetAfter(4));
+  EXPECT_EQ(GetOffset(1), GetOffsetAfter(2));
+  EXPECT_EQ(GetOffset(0), GetOffsetAfter(1));
+}
+
+TEST_F(ArenaPlannerTest, SharedArena) {
+  auto make_graph = [] {
+    return std::unique_ptr<TestGraph>(
+        new TestGraph({0, 1},
+                      {
+                          /* in, out, tmp */
+                          {{0, 1}, {2}, {}},     // First op
+                          {{2, 0}, {4, 5}, {}},  // Second op
+                          {{4, 5}, {3}, {}}      // Third op
+                      },
+                      {3}));
+  };
+  std::unique_ptr<TestGraph> graph1 = make_graph();
+  std::unique_ptr<TestGraph> graph2 = make_graph();
+  // The intermediates of the second graph are larger.
+  for (int i : {2, 4, 5}) {
+    (*graph2->tensors())[i].bytes = 1024;
+  }
+
+  context_.ReportError = ReportError;
+  SharedMemoryArena shared_arena;
+  auto make_planner = [&](TestGraph* graph) {
+    std::unique_ptr<ArenaPlanner> planner(new ArenaPlanner(
+        &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
+        /*preserve_inputs=*/false, /*preserve_intermediates=*/false,
+        kTensorAlignment, &shared_arena));
+    CHECK(planner->ResetAllocations() == kTfLiteOk);
+    CHECK(planner->PlanAllocations() == kTfLiteOk);
+    return planner;
+  };
+  std::unique_ptr<ArenaPlanner> planner1 = make_planner(graph1.get());
+  std::unique_ptr<ArenaPlanner> planner2 = make_planner(graph2.get());
+
+  ASSERT_EQ(planner1->ExecuteAllocations(0, 10), kTfLiteOk);
+  EXPECT_FALSE(planner1->NonPersistentMemoryMoved());
+  // The second planner grows the shared buffer and moves it.
+  ASSERT_EQ(planner2->ExecuteAllocations(0, 10), kTfLiteOk);
+  EXPECT_TRUE(planner1->NonPersistentMemoryMoved());
+  EXPECT_FALSE(planner2->NonPersistentMemoryMoved());
+  ASSERT_EQ(planner1->AcquireNonPersistentMemory(), kTfLiteOk);
+  EXPECT_FALSE(planner1->NonPersistentMemoryMoved());
+
+  // The intermediates of both graphs are in the shared buffer, but their
+  // inputs and outputs are not.
+  const auto* shared_begin = shared_arena.AlignedPointer();
+  const auto* shared_end = shared_begin + shared_arena.GetBufferSize();
+  auto is_shared = [&](TestGraph* graph, int tensor_index) {
+    const char* data = (*graph->tensors())[tensor_index].data.raw;
+    return data >= shared_begin && data < shared_end;
+  };
+  for (TestGraph* graph : {graph1.get(), graph2.get()}) {
+    EXPECT_FALSE(is_shared(graph, 0));
+    EXPECT_FALSE(is_shared(graph, 1));
+    EXPECT_TRUE(is_shared(graph, 2));
+    EXPECT_FALSE(is_shared(graph, 3));
+    EXPECT_TRUE(is_shared(graph, 4));
+    EXPECT_TRUE(is_shared(graph, 5));
+  }
+  // Both graphs plan their intermediates from the start of the buffer.
+  EXPECT_EQ((*graph1->tensors())[5].data.raw, shared_begin);
+  EXPECT_EQ((*graph2->tensors())[2].data.raw, shared_begin);
+}
+
+TEST_F(ArenaPlannerTest, CachedPlans) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  planner_->SetMaxCachedPlans(2);
+  auto offsets = [this]() {
+    std::vector<std::ptrdiff_t> result;
+    for (int i = 0; i < 6; ++i) {
+      result.push_back(GetOffset(i));
+    }
+    return result;
+  };
+  // Resizes the input and the tensors that depend on it, and plans again.
+  auto resize = [&](size_t input_bytes) {
+    (*graph.tensors())[0].bytes = input_bytes;
+    for (int i : {2, 4, 5}) {
+      (*graph.tensors())[i].bytes = 2 * input_bytes;
+    }
+    CHECK(planner_->ResetAllocations() == kTfLiteOk);
+    Execute(0, 10);
+  };
+
+  resize(100);
+  const std::vector<std::ptrdiff_t> small_offsets = offsets();
+  resize(1000);
+  const std::vector<std::ptrdiff_t> large_offsets = offsets();
+  const std::intptr_t base = planner_->BasePointer(kTfLiteArenaRw);
+  EXPECT_NE(small_offsets, large_offsets);
+
+  // The cached plans are the ones computed for the same sizes before, in the
+  // arena that is already large enough for both.
+  resize(100);
+  EXPECT_EQ(offsets(), small_offsets);
+  EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base);
+  resize(1000);
+  EXPECT_EQ(offsets(), large_offsets);
+  EXPECT_EQ(planner_->BasePointer(kTfLiteArenaRw), base);
+
+  // Sizes that are not cached are planned as usual.
+  resize(10);
+  EXPECT_NE(offsets(), small_offsets);
+  EXPECT_EQ(GetOffset(2), 0);
+  EXPECT_EQ(GetOffset(4), GetOffsetAfter(2));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithResetAllocationsAfter) {
   TestGraph graph({0, 1},
                   {
@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <numeric>
 
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/common.h"
@@ -140,6 +142,28 @@ const char* GetTFLiteOpName(const TfLiteRegistration& op_reg) {
   return tflite::EnumNamesBuiltinOperator()[op_reg.builtin_code];
 }
 
+// Returns true if the node must not run concurrently with other nodes: nodes
+// of delegates, which may share state, control flow nodes, which invoke other
+// subgraphs, custom nodes, whose kernels are not known to allow it, and nodes
+// that use variable tensors, which they update in place.
+bool MustRunAlone(const TfLiteContext& context, const TfLiteNode& node,
+                  const TfLiteRegistration& registration) {
+  if (node.delegate != nullptr ||
+      registration.builtin_code == tflite::BuiltinOperator_WHILE ||
+      registration.builtin_code == tflite::BuiltinOperator_IF ||
+      registration.builtin_code == tflite::BuiltinOperator_CUSTOM ||
+      registration.builtin_code == tflite::BuiltinOperator_DELEGATE) {
+    return true;
+  }
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index != kTfLiteOptionalTensor &&
+        context.tensors[tensor_index].is_variable) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 // A trivial implementation of GraphInfo around the Interpreter.
@@ -174,6 +198,14 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  size_t first_concurrent_node(size_t index) const override {
+    const auto& stages = subgraph_->execution_stages();
+    return stages.size() == num_nodes() ? stages[index].first : index;
+  }
+  size_t last_concurrent_node(size_t index) const override {
+    const auto& stages = subgraph_->execution_stages();
+    return stages.size() == num_nodes() ? stages[index].second : index;
+  }
 
  public:
   Subgraph* subgraph_;
@@ -366,6 +398,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
       node_subsets.size());
 
   execution_plan_.clear();
+  execution_stages_.clear();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -420,6 +453,16 @@ TfLiteExternalContext* Subgraph::GetExternalContext(
   return static_cast<Subgraph*>(context->impl_)->GetExternalContext(type);
 }
 
+TfLiteExternalContext* Subgraph::GetWorkerExternalContext(
+    struct TfLiteContext* context, TfLiteExternalContextType type) {
+  auto* subgraph = static_cast<Subgraph*>(context->impl_);
+  if (type == kTfLiteCpuBackendContext) {
+    const std::ptrdiff_t worker = context - subgraph->worker_contexts_.data();
+    return subgraph->worker_cpu_backend_contexts_[worker].get();
+  }
+  return subgraph->GetExternalContext(type);
+}
+
 void Subgraph::SetExternalContext(TfLiteExternalContextType type,
                                   TfLiteExternalContext* ctx) {
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
@@ -533,6 +576,48 @@ void Subgraph::SetCancellationFunction(void* data,
   check_cancelled_func_ = check_cancelled_func;
 }
 
+void Subgraph::SetAllowConcurrentNodeExecution(bool allow) {
+  if (allow == allow_concurrent_node_execution_) {
+    return;
+  }
+  allow_concurrent_node_execution_ = allow;
+  execution_stages_.clear();
+  // Force the execution plan and the memory to be planned again.
+  if (state_ == kStateInvokable) {
+    state_ = kStateUninvokable;
+  }
+}
+
+TfLiteStatus Subgraph::SetSharedMemoryArena(SharedMemoryArena* shared_arena) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError("SetSharedMemoryArena is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  if (shared_arena == shared_memory_arena_) {
+    return kTfLiteOk;
+  }
+  shared_memory_arena_ = shared_arena;
+  // The memory has to be planned again, into the new arena.
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetMaxCachedAllocationPlans(int max_cached_plans) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetMaxCachedAllocationPlans is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  if (max_cached_plans == max_cached_allocation_plans_) {
+    return kTfLiteOk;
+  }
+  max_cached_allocation_plans_ = max_cached_plans;
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
 bool Subgraph::IsCancelled() {
   return (check_cancelled_func_ != nullptr) &&
          (*check_cancelled_func_)(cancellation_data_);
@@ -632,6 +717,10 @@ TfLiteStatus Subgraph::AllocateTensors() {
     return kTfLiteOk;
   }
 
+  if (allow_concurrent_node_execution_ && execution_stages_.empty()) {
+    TF_LITE_ENSURE_STATUS(PlanExecutionStages());
+  }
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   if (memory_planner_) {
@@ -640,6 +729,15 @@ TfLiteStatus Subgraph::AllocateTensors() {
 
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
+  // Preparing may have read the weights, or copied them into buffers of the
+  // kernels, so none of them need to stay resident until used.
+  if (page_mmapped_weights_) {
+    for (int node_index : execution_plan_) {
+      AdviseMmappedInputs(nodes_and_registration_[node_index].first,
+                          Allocation::Advice::kDontNeed);
+    }
+  }
+
   state_ = kStateInvokable;
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
@@ -730,6 +828,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  execution_stages_.clear();
   return kTfLiteOk;
 }
 
@@ -857,9 +956,12 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
-    memory_planner_.reset(new ArenaPlanner(
+    ArenaPlanner* planner = new ArenaPlanner(
         &context_, std::unique_ptr<GraphInfo>(new InterpreterInfo(this)),
-        /*preserve_inputs=*/true, /*preserve_intermediates*/ false));
+        /*preserve_inputs=*/true, /*preserve_intermediates*/ false,
+        kDefaultTensorAlignment, shared_memory_arena_);
+    planner->SetMaxCachedPlans(max_cached_allocation_plans_);
+    memory_planner_.reset(planner);
     memory_planner_->PlanAllocations();
   }
 
@@ -892,6 +994,11 @@ TfLiteStatus Subgraph::Invoke() {
     ReportError("Non-persistent memory is not available.");
     return kTfLiteError;
   }
+  // Another subgraph that shares the arena may have grown, and so moved, it
+  // since the tensors were last allocated.
+  if (memory_planner_ && memory_planner_->NonPersistentMemoryMoved()) {
+    TF_LITE_ENSURE_STATUS(memory_planner_->AcquireNonPersistentMemory());
+  }
 
   // This is only needed for UseNNAPI(true);
   if (should_apply_nnapi_delegate_ && !applied_nnapi_delegate_) {
@@ -900,7 +1007,8 @@ TfLiteStatus Subgraph::Invoke() {
     applied_nnapi_delegate_ = true;
   }
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, but the nodes of a stage may
+  // run concurrently if SetAllowConcurrentNodeExecution(true) was called.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
@@ -911,6 +1019,13 @@ TfLiteStatus Subgraph::Invoke() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    const int stage_end = ConcurrentStageEnd(execution_plan_index);
+    if (stage_end > 0) {
+      TF_LITE_ENSURE_STATUS(
+          InvokeConcurrently(execution_plan_index, stage_end));
+      execution_plan_index = stage_end - 1;
+      continue;
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -942,12 +1057,28 @@ TfLiteStatus Subgraph::Invoke() {
       return kTfLiteError;
     }
 
+    // Start reading the weights of the next node while this one runs.
+    if (page_mmapped_weights_) {
+      if (execution_plan_index == 0) {
+        AdviseMmappedInputs(node, Allocation::Advice::kWillNeed);
+      }
+      if (execution_plan_index + 1 < execution_plan_.size()) {
+        AdviseMmappedInputs(
+            nodes_and_registration_[execution_plan_[execution_plan_index + 1]]
+                .first,
+            Allocation::Advice::kWillNeed);
+      }
+    }
+
     EnsureTensorsVectorCapacity();
     tensor_resized_since_op_invoke_ = false;
     if (OpInvoke(registration, &node) != kTfLiteOk) {
       return ReportOpError(&context_, node, registration, node_index,
                            "failed to invoke");
     }
+    if (page_mmapped_weights_) {
+      AdviseMmappedInputs(node, Allocation::Advice::kDontNeed);
+    }
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -973,6 +1104,166 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::PlanExecutionStages() {
+  // Each node goes into the stage after the latest one of the nodes that
+  // produce its inputs, and nodes that must run alone go into a stage of their
+  // own, after that of every node before them and before that of every node
+  // after them.
+  std::vector<int> producer_stage(tensors_.size(), -1);
+  std::vector<int> stages(execution_plan_.size());
+  int last_stage = -1;
+  int last_alone_stage = -1;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const auto& node_and_reg = nodes_and_registration_[execution_plan_[i]];
+    const TfLiteNode& node = node_and_reg.first;
+    int stage = last_alone_stage + 1;
+    if (MustRunAlone(context_, node, node_and_reg.second)) {
+      stage = last_stage + 1;
+      last_alone_stage = stage;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index != kTfLiteOptionalTensor) {
+          stage = std::max(stage, producer_stage[tensor_index] + 1);
+        }
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      producer_stage[tensor_index] = stage;
+    }
+    stages[i] = stage;
+    last_stage = std::max(last_stage, stage);
+  }
+
+  // Order the nodes by stage, keeping the order of the nodes within a stage.
+  std::vector<int> order(execution_plan_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](int a, int b) { return stages[a] < stages[b]; });
+  std::vector<int> new_plan(execution_plan_.size());
+  execution_stages_.resize(execution_plan_.size());
+  for (int i = 0; i < order.size();) {
+    int end = i;
+    while (end < order.size() && stages[order[end]] == stages[order[i]]) {
+      new_plan[end] = execution_plan_[order[end]];
+      ++end;
+    }
+    for (int j = i; j < end; ++j) {
+      execution_stages_[j] = {i, end - 1};
+    }
+    i = end;
+  }
+
+  if (new_plan != execution_plan_) {
+    execution_plan_ = std::move(new_plan);
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::AdviseMmappedInputs(const TfLiteNode& node,
+                                   Allocation::Advice advice) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (tensor.allocation_type != kTfLiteMmapRo || !tensor.allocation ||
+        !tensor.data.raw) {
+      continue;
+    }
+    static_cast<const Allocation*>(tensor.allocation)
+        ->Advise(tensor.data.raw, tensor.bytes, advice);
+  }
+}
+
+int Subgraph::ConcurrentStageEnd(int execution_plan_index) {
+  if (execution_stages_.size() != execution_plan_.size() ||
+      execution_stages_[execution_plan_index].first != execution_plan_index) {
+    return 0;
+  }
+  const int end = execution_stages_[execution_plan_index].second + 1;
+  // Without threads to spare there is nothing to gain, node profiling needs
+  // serial execution, and nodes that have not yet been prepared, or that may
+  // resize their outputs, need the serial bookkeeping of Invoke().
+  if (end - execution_plan_index < 2 || context_.recommended_num_threads < 2 ||
+      profiler_ || end > next_execution_plan_index_to_prepare_) {
+    return 0;
+  }
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      GetExternalContext(kTfLiteCpuBackendContext));
+  if (cpu_backend_context == nullptr ||
+      cpu_backend_context->internal_backend_context() == nullptr) {
+    return 0;
+  }
+  for (int i = execution_plan_index; i < end; ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    if (HasDynamicTensor(context_, node.outputs)) {
+      return 0;
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) {
+        continue;
+      }
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.delegate && tensor.data_is_stale) {
+        return 0;
+      }
+    }
+  }
+  return end;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrently(int first_execution_plan_index,
+                                          int end_execution_plan_index) {
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+
+  // Workers run at most one node at a time, so there are at most as many of
+  // them as nodes.
+  const int num_nodes = end_execution_plan_index - first_execution_plan_index;
+  worker_contexts_.assign(num_nodes, context_);
+  for (TfLiteContext& worker_context : worker_contexts_) {
+    worker_context.GetExternalContext = GetWorkerExternalContext;
+    worker_context.recommended_num_threads = 1;
+  }
+  while (worker_cpu_backend_contexts_.size() < num_nodes) {
+    worker_cpu_backend_contexts_.emplace_back(new ExternalCpuBackendContext());
+  }
+
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  auto invoke_node = [&](int i, int worker) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    auto& node_and_reg = nodes_and_registration_[node_index];
+    statuses[i] = OpInvoke(&worker_contexts_[worker], node_and_reg.second,
+                           &node_and_reg.first);
+  };
+  auto* cpu_backend_context = static_cast<ExternalCpuBackendContext*>(
+      GetExternalContext(kTfLiteCpuBackendContext));
+  if (!cpu_backend_context->internal_backend_context()->ExecuteTasks(
+          num_nodes, invoke_node)) {
+    for (int i = 0; i < num_nodes; ++i) {
+      invoke_node(i, /*worker=*/0);
+    }
+  }
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (statuses[i] != kTfLiteOk) {
+      const int node_index = execution_plan_[first_execution_plan_index + i];
+      const auto& node_and_reg = nodes_and_registration_[node_index];
+      return ReportOpError(&context_, node_and_reg.first, node_and_reg.second,
+                           node_index, "failed to invoke");
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1180,6 +1471,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  execution_stages_.clear();
   return kTfLiteOk;
 }
 
@@ -1283,6 +1575,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  execution_stages_.clear();
 
   // Delegate nodes are appended to nodes_and_registration_. Therefore,
   // cleanup nodes_and_registration_ to only contain nodes from
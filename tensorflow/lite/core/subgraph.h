@@ -27,7 +27,9 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/memory_planner.h"
+#include "tensorflow/lite/simple_memory_arena.h"
 #include "tensorflow/lite/util.h"
 
 #if TFLITE_EXPERIMENTAL_RUNTIME_EAGER
@@ -190,6 +192,14 @@ class Subgraph {
   // Return read-only vector of node indices in the order of execution.
   const std::vector<int>& execution_plan() const { return execution_plan_; }
 
+  // Return, for each node of the execution plan, the execution plan indices of
+  // the first and the last node of the stage of nodes that may run
+  // concurrently with it, or an empty vector if there are no such stages.
+  // WARNING: This is an experimental API and subject to change.
+  const std::vector<std::pair<int, int>>& execution_stages() const {
+    return execution_stages_;
+  }
+
   // Mutable form of tensors (TEMPORARY for refactor).
   // TODO(b/119495520): remove when refactoring complete.
   std::vector<TfLiteTensor>& tensors() { return tensors_; }
@@ -276,6 +286,41 @@ class Subgraph {
   // WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  // Allows Invoke() to run nodes that do not depend on each other concurrently
+  // on the thread pool of the CPU backend context, e.g. the branches of an
+  // inception block. AllocateTensors() then reorders the execution plan into
+  // stages of independent nodes, and plans the memory of their tensors so that
+  // the nodes of a stage do not share it. The kernels of such nodes each get a
+  // single-threaded CPU backend context of their own, but must otherwise be
+  // safe to invoke concurrently. Delegated, control flow and custom nodes, and
+  // nodes that use variable tensors, always run alone.
+  // WARNING: This is an experimental API and subject to change.
+  void SetAllowConcurrentNodeExecution(bool allow);
+
+  // Plans the intermediate tensors of the subgraph into `shared_arena`, which
+  // other subgraphs may use as well, instead of an arena of their own. The
+  // inputs and outputs keep memory of their own. Subgraphs that share an arena
+  // must not be invoked at the same time. `shared_arena` must outlive the
+  // subgraph, and nullptr goes back to an arena of its own.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetSharedMemoryArena(SharedMemoryArena* shared_arena);
+
+  // Keeps the memory plans of up to `max_cached_plans` sets of tensor sizes,
+  // so that AllocateTensors() after resizing the inputs to shapes that have
+  // been allocated before reuses their plan. See
+  // ArenaPlanner::SetMaxCachedPlans().
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetMaxCachedAllocationPlans(int max_cached_plans);
+
+  // Hints the OS, for the constant tensors that are mmap'd from the model
+  // file, to read those of the next node ahead while a node runs and to drop
+  // those of a node once it has run, as well as all of them once
+  // AllocateTensors() has prepared the nodes. Only the weights of the running
+  // nodes then stay resident; the others are read back from the file, often
+  // from the page cache, when next needed.
+  // WARNING: This is an experimental API and subject to change.
+  void SetMmapWeightPaging(bool enable) { page_mmapped_weights_ = enable; }
+
   // Ensure the data in `tensor.data` is readable. In case delegate is used,
   // it might require to copy the data from delegate buffer to raw memory.
   // WARNING: This is an experimental API and subject to change.
@@ -404,8 +449,15 @@ class Subgraph {
 
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node) {
+    return OpInvoke(&context_, op_reg, node);
+  }
+
+  // Invoke the operator represented by 'node' with the given context.
+  static TfLiteStatus OpInvoke(TfLiteContext* context,
+                               const TfLiteRegistration& op_reg,
+                               TfLiteNode* node) {
     if (op_reg.invoke == nullptr) return kTfLiteError;
-    return op_reg.invoke(&context_, node);
+    return op_reg.invoke(context, node);
   }
 
   // Call OpPrepare() for as many ops as possible, allocating memory for their
@@ -414,6 +466,24 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Reorders the execution plan into stages of nodes that may run concurrently,
+  // and fills `execution_stages_`.
+  TfLiteStatus PlanExecutionStages();
+
+  // Returns one past the execution plan index of the last node of the stage
+  // that starts at 'execution_plan_index' if Invoke() can run its nodes
+  // concurrently, or 0 otherwise.
+  int ConcurrentStageEnd(int execution_plan_index);
+
+  // Invokes the nodes in [first_execution_plan_index, end_execution_plan_index)
+  // concurrently.
+  TfLiteStatus InvokeConcurrently(int first_execution_plan_index,
+                                  int end_execution_plan_index);
+
+  // Passes `advice` on to the mmap'd allocation of each constant input of
+  // `node`, see SetMmapWeightPaging().
+  void AdviseMmappedInputs(const TfLiteNode& node, Allocation::Advice advice);
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -521,6 +591,11 @@ class Subgraph {
   static TfLiteExternalContext* GetExternalContext(
       struct TfLiteContext* context, TfLiteExternalContextType type);
 
+  // The GetExternalContext of `worker_contexts_`, which returns the CPU backend
+  // context of the worker.
+  static TfLiteExternalContext* GetWorkerExternalContext(
+      struct TfLiteContext* context, TfLiteExternalContextType type);
+
   // Set the value of an external context.
   static void SetExternalContext(struct TfLiteContext* context,
                                  TfLiteExternalContextType type,
@@ -674,6 +749,13 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The arena that the intermediate tensors are planned into, if it is shared
+  // with other subgraphs. Not owned.
+  SharedMemoryArena* shared_memory_arena_ = nullptr;
+
+  // The number of memory plans that the memory planner keeps.
+  int max_cached_allocation_plans_ = 0;
+
   // Tracking bit for whether a tensor was resized in the course of an op
   // invocation. This is a useful hint to ensure that dynamic tensor outputs
   // trigger downstream reallocation after op invocation.
@@ -702,6 +784,24 @@ class Subgraph {
 
   // A map of resources. Owned by interpreter and shared by multiple subgraphs.
   resource::ResourceMap* resources_ = nullptr;
+
+  // Whether Invoke() may run independent nodes concurrently.
+  bool allow_concurrent_node_execution_ = false;
+
+  // Whether SetMmapWeightPaging(true) was called.
+  bool page_mmapped_weights_ = false;
+
+  // For each node of the execution plan, the execution plan indices of the
+  // first and the last node of its stage, or empty if the execution plan has
+  // not been planned into stages.
+  std::vector<std::pair<int, int>> execution_stages_;
+
+  // The contexts that nodes invoked concurrently get, one per worker of the
+  // thread pool, which differ from `context_` only in their CPU backend
+  // context.
+  std::vector<TfLiteContext> worker_contexts_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
 };
 
 }  // namespace impl
@@ -91,6 +91,37 @@ class Delegate {
   }
   int num_delegate_kernels() const { return num_delegate_kernels_; }
 
+  absl::Status SetOpenClEnvironment(cl_device_id device, cl_context context,
+                                    cl_command_queue command_queue) {
+    if (num_delegate_kernels_ > 0) {
+      return absl::FailedPreconditionError(
+          "OpenCL environment must be set before the graph is delegated.");
+    }
+    cl_device_ = device;
+    cl_context_ = context;
+    cl_command_queue_ = command_queue;
+    return absl::OkStatus();
+  }
+
+  absl::Status BindOpenClBufferToTensor(cl_mem buffer, int tensor_index) {
+    if (num_delegate_kernels_ > 0) {
+      return absl::FailedPreconditionError(
+          "Buffers must be bound before the graph is delegated.");
+    }
+    if (!buffer) {
+      return absl::InvalidArgumentError("OpenCL buffer is null.");
+    }
+    bound_cl_buffers_[tensor_index] = buffer;
+    return absl::OkStatus();
+  }
+
+  // Returns the OpenCL buffer bound to the tensor or nullptr.
+  cl_mem FindBoundOpenClBuffer(int tensor_index) const {
+    auto it = bound_cl_buffers_.find(tensor_index);
+    return it == bound_cl_buffers_.end() ? nullptr : it->second;
+  }
+  bool HasBoundBuffers() const { return !bound_cl_buffers_.empty(); }
+
  private:
   TfLiteDelegate delegate_ = {
       .data_ = reinterpret_cast<void*>(this),
@@ -104,6 +135,14 @@ class Delegate {
   TfLiteGpuDelegateOptionsV2 options_;
   int num_delegate_kernels_ = 0;
 
+  // OpenCL objects shared with the application. When unset, the delegate
+  // creates its own.
+  cl_device_id cl_device_ = nullptr;
+  cl_context cl_context_ = nullptr;
+  cl_command_queue cl_command_queue_ = nullptr;
+  // Maps a tensor index to the application-owned buffer holding its data.
+  std::unordered_map<int, cl_mem> bound_cl_buffers_;
+
   friend class DelegateKernel;
 };
 
@@ -130,7 +169,9 @@ class DelegateKernel {
     std::unique_ptr<InferenceBuilder> builder;
     bool graph_is_destroyed;
     const int experimental_flags = delegate_->options().experimental_flags;
-    if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) {
+    // Bound OpenCL buffers can't be consumed by the OpenGL backend.
+    if ((experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY) ||
+        delegate_->HasBoundBuffers()) {
       RETURN_IF_ERROR(
           InitializeOpenClApi(&graph, &builder, &graph_is_destroyed));
     } else if (experimental_flags & TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY) {
@@ -240,12 +281,17 @@ class DelegateKernel {
     ObjectDef default_object_def;
     default_object_def.data_type = DataType::FLOAT32;
     default_object_def.data_layout = DataLayout::BHWC;
-    default_object_def.object_type = ObjectType::CPU_MEMORY;
+    default_object_def.object_type = delegate_->FindBoundOpenClBuffer(index)
+                                         ? ObjectType::OPENCL_BUFFER
+                                         : ObjectType::CPU_MEMORY;
     default_object_def.user_provided = true;
     return default_object_def;
   }
 
   TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+    // Bound buffers stay on the GPU, so no CPU round trip is needed for them.
+    cl_mem buffer = delegate_->FindBoundOpenClBuffer(index);
+    if (buffer) return OpenClBuffer(buffer);
     auto& tensor = context->tensors[index];
     return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
   }
@@ -285,6 +331,9 @@ class DelegateKernel {
                                    bool* graph_is_destroyed) {
     *graph_is_destroyed = false;
     cl::InferenceEnvironmentOptions env_options;
+    env_options.device = delegate_->cl_device_;
+    env_options.context = delegate_->cl_context_;
+    env_options.command_queue = delegate_->cl_command_queue_;
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
@@ -458,3 +507,33 @@ TfLiteDelegate* TfLiteGpuDelegateV2Create(
 void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate) {
   delete tflite::gpu::GetDelegate(delegate);
 }
+
+TfLiteStatus TfLiteGpuDelegateV2SetOpenClEnvironment(TfLiteDelegate* delegate,
+                                                     void* cl_device,
+                                                     void* cl_context,
+                                                     void* cl_command_queue) {
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  if (!gpu_delegate) return kTfLiteError;
+  const auto status = gpu_delegate->SetOpenClEnvironment(
+      reinterpret_cast<cl_device_id>(cl_device),
+      reinterpret_cast<cl_context>(cl_context),
+      reinterpret_cast<cl_command_queue>(cl_command_queue));
+  if (status.ok()) return kTfLiteOk;
+  TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+             "TfLiteGpuDelegateV2SetOpenClEnvironment: %s",
+             std::string(status.message()).c_str());
+  return kTfLiteError;
+}
+
+TfLiteStatus TfLiteGpuDelegateV2BindOpenClBufferToTensor(
+    TfLiteDelegate* delegate, void* cl_buffer, int tensor_index) {
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  if (!gpu_delegate) return kTfLiteError;
+  const auto status = gpu_delegate->BindOpenClBufferToTensor(
+      reinterpret_cast<cl_mem>(cl_buffer), tensor_index);
+  if (status.ok()) return kTfLiteOk;
+  TFLITE_LOG(tflite::TFLITE_LOG_ERROR,
+             "TfLiteGpuDelegateV2BindOpenClBufferToTensor: %s",
+             std::string(status.message()).c_str());
+  return kTfLiteError;
+}
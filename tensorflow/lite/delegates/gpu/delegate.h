@@ -137,6 +137,30 @@ TFL_CAPI_EXPORT TfLiteDelegate* TfLiteGpuDelegateV2Create(
 // Destroys a delegate created with `TfLiteGpuDelegateV2Create` call.
 TFL_CAPI_EXPORT void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate);
 
+// Makes the delegate run on the application's OpenCL objects instead of
+// creating its own. `cl_device`, `cl_context` and `cl_command_queue` are
+// `cl_device_id`, `cl_context` and `cl_command_queue` respectively; any of
+// them may be null. The objects are not owned and must outlive the delegate.
+// Sharing the context is required for buffers bound with
+// `TfLiteGpuDelegateV2BindOpenClBufferToTensor`.
+//
+// *** Must be called *before* `Interpreter::ModifyGraphWithDelegate`. ***
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2SetOpenClEnvironment(
+    TfLiteDelegate* delegate, void* cl_device, void* cl_context,
+    void* cl_command_queue);
+
+// Binds an OpenCL buffer (`cl_mem`) to a float32 input or output tensor. The
+// buffer holds the tensor in BHWC layout and must be large enough for all of
+// its elements. Data of bound tensors never goes through CPU memory: when all
+// inputs and outputs are bound, `Interpreter::Invoke` returns as soon as the
+// work is enqueued, and the application synchronizes with it through the
+// shared command queue, e.g. by enqueueing dependent work or calling
+// `clFinish`. Binding a buffer forces the OpenCL backend.
+//
+// *** Must be called *before* `Interpreter::ModifyGraphWithDelegate`. ***
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2BindOpenClBufferToTensor(
+    TfLiteDelegate* delegate, void* cl_buffer, int tensor_index);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -21,6 +21,7 @@ limitations under the License.
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -35,6 +36,61 @@ limitations under the License.
 #include "tensorflow/lite/minimal_logging.h"
 #include "tensorflow/lite/tools/optimize/sparsity/format_converter.h"
 
+struct TfLiteXNNPackDelegateWeightsCache {
+ public:
+  // Returns the weights unpacked by the operator `builtin_code` from the
+  // `packed_bytes` static bytes at `packed_data` into `unpacked_bytes`, or
+  // nullptr if they are not in the cache.
+  const char* Lookup(const void* packed_data, size_t packed_bytes,
+                     size_t unpacked_bytes, int builtin_code) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = weights_.find(
+        {packed_data, packed_bytes, unpacked_bytes, builtin_code});
+    return it != weights_.end() ? it->second.data() : nullptr;
+  }
+
+  // Adds the `unpacked` weights to the cache, and returns them, or the weights
+  // that another delegate has added first.
+  const char* Insert(const void* packed_data, size_t packed_bytes,
+                     size_t unpacked_bytes, int builtin_code,
+                     std::vector<char> unpacked) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return weights_
+        .emplace(Key{packed_data, packed_bytes, unpacked_bytes, builtin_code},
+                 std::move(unpacked))
+        .first->second.data();
+  }
+
+ private:
+  struct Key {
+    const void* packed_data;
+    size_t packed_bytes;
+    size_t unpacked_bytes;
+    int builtin_code;
+
+    bool operator==(const Key& other) const {
+      return packed_data == other.packed_data &&
+             packed_bytes == other.packed_bytes &&
+             unpacked_bytes == other.unpacked_bytes &&
+             builtin_code == other.builtin_code;
+    }
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      size_t hash = std::hash<const void*>()(key.packed_data);
+      hash = hash * 31 + key.packed_bytes;
+      hash = hash * 31 + key.unpacked_bytes;
+      return hash * 31 + static_cast<size_t>(key.builtin_code);
+    }
+  };
+
+  std::mutex mutex_;
+  // The elements of an unordered_map, and so the data of the vectors, stay in
+  // place as it grows.
+  std::unordered_map<Key, std::vector<char>, KeyHash> weights_;
+};
+
 namespace tflite {
 namespace xnnpack {
 namespace {
@@ -47,6 +103,9 @@ class Delegate {
 
  public:
   explicit Delegate(const TfLiteXNNPackDelegateOptions* options) {
+    if (options != nullptr) {
+      weights_cache_ = options->weights_cache;
+    }
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
     if (options != nullptr && options->num_threads > 1) {
       threadpool_.reset(
@@ -79,11 +138,13 @@ class Delegate {
   };
 
   // Unpacked data for quasi-static tensors, i.e. tensors produced by
-  // dequantizing or unpacking static buffers.
+  // dequantizing or unpacking static buffers, unless it is in weights_cache_.
   std::vector<char> static_unpacked_data_;
-  // Mapping from a tensor index for a quasi-static tensor to the offset to
-  // its unpacked data within static_unpacked_data_.
-  std::unordered_map<int, size_t> static_unpacked_data_map_;
+  // Mapping from a tensor index for a quasi-static tensor to its unpacked
+  // data, within static_unpacked_data_ or weights_cache_.
+  std::unordered_map<int, const char*> static_unpacked_data_map_;
+  // Cache of unpacked data shared with other delegates, if not null.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_ = nullptr;
   // Set of indices of nodes which unpack static data, e.g. Dequantize
   // operators which convert FP16 static weights to FP32. These nodes are simply
   // ignored in the delegate implementation, because their outputs are
@@ -201,7 +262,7 @@ class Subgraph {
         // Check for quasi-static data.
         const auto it = delegate->static_unpacked_data_map_.find(t);
         if (it != delegate->static_unpacked_data_map_.end()) {
-          data = delegate->static_unpacked_data_.data() + it->second;
+          data = it->second;
         }
       }
       if (inputs.count(t) != 0) {
@@ -230,7 +291,7 @@ class Subgraph {
 
     // Create a set of quasi-static tensors for VisitNode function
     std::unordered_set<int> quasi_static_tensors;
-    for (const std::pair<const int, size_t>& entry :
+    for (const std::pair<const int, const char*>& entry :
          delegate->static_unpacked_data_map_) {
       quasi_static_tensors.insert(entry.first);
     }
@@ -2662,6 +2723,10 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     nodes_to_delegate->data[nodes_to_delegate->size++] = node_index;
   }
 
+  // Offsets of the unpacked data of quasi-static tensors within
+  // static_unpacked_data_, which may move while the tensors are unpacked.
+  std::unordered_map<int, size_t> static_unpacked_data_offsets;
+
   // Unpack static data of all tensors
   for (int t : quasi_static_tensors_to_unpack) {
     const int producer_index = quasi_static_tensors_producers[t];
@@ -2712,15 +2777,31 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     }
     const size_t tensor_elements = output_tensor.bytes / sizeof(float);
 
-    // Align to XNN_EXTRA_BYTES bytes
-    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
-      static_unpacked_data_.push_back(0);
+    float* unpacked_data = nullptr;
+    size_t tensor_offset = 0;
+    // Data to add to weights_cache_.
+    std::vector<char> cached_unpacked_data;
+    if (weights_cache_ != nullptr) {
+      const char* cached_data = weights_cache_->Lookup(
+          input_tensor.data.raw_const, input_tensor.bytes, output_tensor.bytes,
+          registration->builtin_code);
+      if (cached_data != nullptr) {
+        static_unpacked_data_map_[t] = cached_data;
+        continue;
+      }
+      // XNNPACK may read up to XNN_EXTRA_BYTES past the end of the data.
+      cached_unpacked_data.resize(output_tensor.bytes + XNN_EXTRA_BYTES);
+      unpacked_data = reinterpret_cast<float*>(cached_unpacked_data.data());
+    } else {
+      // Align to XNN_EXTRA_BYTES bytes
+      while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
+        static_unpacked_data_.push_back(0);
+      }
+      tensor_offset = static_unpacked_data_.size();
+      static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
+      unpacked_data = reinterpret_cast<float*>(static_unpacked_data_.data() +
+                                               tensor_offset);
     }
-    const size_t tensor_offset = static_unpacked_data_.size();
-    static_unpacked_data_.resize(tensor_offset + context->tensors[t].bytes);
-
-    float* unpacked_data =
-        reinterpret_cast<float*>(static_unpacked_data_.data() + tensor_offset);
     switch (registration->builtin_code) {
       case kTfLiteBuiltinDequantize: {
         if (input_tensor.type != kTfLiteFloat16) {
@@ -2787,7 +2868,18 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
         return nullptr;  // Hard error.
     }
 
-    static_unpacked_data_map_[t] = tensor_offset;
+    if (weights_cache_ != nullptr) {
+      static_unpacked_data_map_[t] = weights_cache_->Insert(
+          input_tensor.data.raw_const, input_tensor.bytes, output_tensor.bytes,
+          registration->builtin_code, std::move(cached_unpacked_data));
+    } else {
+      static_unpacked_data_offsets[t] = tensor_offset;
+    }
+  }
+  for (const std::pair<const int, size_t>& entry :
+       static_unpacked_data_offsets) {
+    static_unpacked_data_map_[entry.first] =
+        static_unpacked_data_.data() + entry.second;
   }
 
   // Add nodes that unpack static data consumed by delegated nodes.
@@ -2894,3 +2986,12 @@ void TfLiteXNNPackDelegateDelete(TfLiteDelegate* delegate) {
     delete static_cast<::tflite::xnnpack::Delegate*>(delegate->data_);
   }
 }
+
+TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate() {
+  return new TfLiteXNNPackDelegateWeightsCache();
+}
+
+void TfLiteXNNPackDelegateWeightsCacheDelete(
+    TfLiteXNNPackDelegateWeightsCache* cache) {
+  delete cache;
+}
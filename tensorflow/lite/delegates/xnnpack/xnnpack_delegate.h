@@ -22,10 +22,24 @@ limitations under the License.
 extern "C" {
 #endif  // __cplusplus
 
+// A cache of the static weights that XNNPack delegates unpack for XNNPack,
+// e.g. by converting FP16 weights to FP32 or by densifying sparse weights.
+// Delegates that share a cache, e.g. those of several interpreters for one
+// model, share the unpacked weights instead of each unpacking a copy of its
+// own. The weights are identified by their address in the model buffer, so a
+// cache may only be shared by delegates of models that stay in memory for as
+// long as the cache is used. Thread-safe.
+typedef struct TfLiteXNNPackDelegateWeightsCache
+    TfLiteXNNPackDelegateWeightsCache;
+
 typedef struct {
   // Number of threads to use in the thread pool.
   // 0 or negative value means no thread pool used.
   int32_t num_threads;
+  // Cache of unpacked static weights, or nullptr if the delegate unpacks the
+  // weights for itself. Not owned, and must outlive the delegate and the
+  // interpreters it is applied to.
+  TfLiteXNNPackDelegateWeightsCache* weights_cache;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns a structure with the default XNNPack delegate options.
@@ -40,6 +54,15 @@ TfLiteDelegate* TfLiteXNNPackDelegateCreate(
 // Destroys a delegate created with `TfLiteXNNPackDelegateCreate` call.
 void TfLiteXNNPackDelegateDelete(TfLiteDelegate* delegate);
 
+// Creates a new cache of unpacked static weights that need to be destroyed with
+// `TfLiteXNNPackDelegateWeightsCacheDelete` when the interpreters and
+// delegates that use it are destroyed.
+TfLiteXNNPackDelegateWeightsCache* TfLiteXNNPackDelegateWeightsCacheCreate();
+
+// Destroys a cache created with `TfLiteXNNPackDelegateWeightsCacheCreate` call.
+void TfLiteXNNPackDelegateWeightsCacheDelete(
+    TfLiteXNNPackDelegateWeightsCache* cache);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
@@ -0,0 +1,189 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_interpreter.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+
+namespace tflite {
+
+namespace {
+
+// Returns true if `tensor` holds `batch_size` examples of fixed size.
+bool IsBatched(const TfLiteTensor* tensor, int batch_size) {
+  return tensor->type != kTfLiteString && tensor->dims->size > 0 &&
+         tensor->dims->data[0] == batch_size;
+}
+
+}  // namespace
+
+std::unique_ptr<BatchingInterpreter> BatchingInterpreter::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const Options& options) {
+  ErrorReporter* error_reporter = model.error_reporter();
+  std::unique_ptr<BatchingInterpreter> batching_interpreter(
+      new BatchingInterpreter(options, error_reporter));
+
+  std::vector<int> batch_sizes = options.batch_sizes;
+  std::sort(batch_sizes.begin(), batch_sizes.end());
+  batch_sizes.erase(std::unique(batch_sizes.begin(), batch_sizes.end()),
+                    batch_sizes.end());
+  if (batch_sizes.empty() || batch_sizes.front() < 1) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "Batch sizes must be positive, and at least one.");
+    return nullptr;
+  }
+
+  for (int batch_size : batch_sizes) {
+    std::unique_ptr<Interpreter> interpreter;
+    if (InterpreterBuilder(model, op_resolver)(&interpreter,
+                                               options.num_threads) !=
+            kTfLiteOk ||
+        !interpreter) {
+      return nullptr;
+    }
+    for (int input : interpreter->inputs()) {
+      const TfLiteTensor* tensor = interpreter->tensor(input);
+      if (!IsBatched(tensor, 1)) {
+        TF_LITE_REPORT_ERROR(error_reporter,
+                             "Input '%s' does not have a batch size of 1.",
+                             tensor->name);
+        return nullptr;
+      }
+      std::vector<int> dims(tensor->dims->data,
+                            tensor->dims->data + tensor->dims->size);
+      dims[0] = batch_size;
+      if (interpreter->ResizeInputTensor(input, dims) != kTfLiteOk) {
+        return nullptr;
+      }
+    }
+    if (interpreter->AllocateTensors() != kTfLiteOk) return nullptr;
+    for (int output : interpreter->outputs()) {
+      const TfLiteTensor* tensor = interpreter->tensor(output);
+      if (!IsBatched(tensor, batch_size)) {
+        TF_LITE_REPORT_ERROR(
+            error_reporter,
+            "Output '%s' does not have the batch as its first dimension.",
+            tensor->name);
+        return nullptr;
+      }
+    }
+
+    if (batching_interpreter->variants_.empty()) {
+      for (int input : interpreter->inputs()) {
+        batching_interpreter->input_bytes_.push_back(
+            interpreter->tensor(input)->bytes / batch_size);
+      }
+      for (int output : interpreter->outputs()) {
+        batching_interpreter->output_bytes_.push_back(
+            interpreter->tensor(output)->bytes / batch_size);
+      }
+    }
+    batching_interpreter->variants_.push_back(
+        {batch_size, std::move(interpreter)});
+  }
+  return batching_interpreter;
+}
+
+TfLiteStatus BatchingInterpreter::Invoke(
+    const std::vector<const void*>& inputs,
+    const std::vector<void*>& outputs) {
+  if (inputs.size() != input_bytes_.size() ||
+      outputs.size() != output_bytes_.size()) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Expected %d inputs and %d outputs, got %d and %d.",
+                         input_bytes_.size(), output_bytes_.size(),
+                         inputs.size(), outputs.size());
+    return kTfLiteError;
+  }
+
+  Request request;
+  request.inputs = &inputs;
+  request.outputs = &outputs;
+  const size_t max_batch_size = variants_.back().batch_size;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  queue_.push_back(&request);
+  cv_.notify_all();
+  while (!request.done) {
+    if (batch_running_) {
+      cv_.wait(lock);
+      continue;
+    }
+    // Lead the next batch, which may or may not include this request.
+    batch_running_ = true;
+    if (options_.max_batch_delay_micros > 0) {
+      cv_.wait_for(lock,
+                   std::chrono::microseconds(options_.max_batch_delay_micros),
+                   [this, max_batch_size] {
+                     return queue_.size() >= max_batch_size;
+                   });
+    }
+    const size_t batch_size = std::min(queue_.size(), max_batch_size);
+    std::vector<Request*> batch(queue_.begin(), queue_.begin() + batch_size);
+    queue_.erase(queue_.begin(), queue_.begin() + batch_size);
+
+    lock.unlock();
+    RunBatch(batch);
+    lock.lock();
+
+    for (Request* batched_request : batch) {
+      batched_request->done = true;
+    }
+    batch_running_ = false;
+    cv_.notify_all();
+  }
+  return request.status;
+}
+
+void BatchingInterpreter::RunBatch(const std::vector<Request*>& batch) {
+  const int batch_size = batch.size();
+  auto variant = std::find_if(
+      variants_.begin(), variants_.end(),
+      [batch_size](const Variant& v) { return v.batch_size >= batch_size; });
+  Interpreter* interpreter = variant->interpreter.get();
+
+  // Unused examples of the variant are zeroed, so that they compute finite
+  // values.
+  for (int i = 0; i < input_bytes_.size(); ++i) {
+    char* data = interpreter->tensor(interpreter->inputs()[i])->data.raw;
+    const size_t bytes = input_bytes_[i];
+    for (int b = 0; b < batch_size; ++b) {
+      std::memcpy(data + b * bytes, (*batch[b]->inputs)[i], bytes);
+    }
+    std::memset(data + batch_size * bytes, 0,
+                (variant->batch_size - batch_size) * bytes);
+  }
+
+  const TfLiteStatus status = interpreter->Invoke();
+  for (int i = 0; status == kTfLiteOk && i < output_bytes_.size(); ++i) {
+    const char* data =
+        interpreter->tensor(interpreter->outputs()[i])->data.raw;
+    const size_t bytes = output_bytes_[i];
+    for (int b = 0; b < batch_size; ++b) {
+      std::memcpy((*batch[b]->outputs)[i], data + b * bytes, bytes);
+    }
+  }
+  for (Request* request : batch) {
+    request->status = status;
+  }
+}
+
+}  // namespace tflite
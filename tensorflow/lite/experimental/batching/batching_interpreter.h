@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+
+// Runs single-example requests, issued from many threads, through
+// interpreters of one model that are planned ahead for a few batch sizes.
+// Requests that arrive while a batch runs are coalesced into one Invoke() of
+// the smallest variant that fits them, instead of one Invoke() each, and the
+// outputs are split back per request.
+//
+// All the inputs and outputs of the model must have the batch as their first
+// dimension, with a batch size of 1 in the model. The interpreters read the
+// weights of the model in place from its allocation, so they share them.
+//
+// WARNING: This is an experimental API and subject to change.
+class BatchingInterpreter {
+ public:
+  struct Options {
+    // The batch sizes to plan interpreters for. The largest one bounds the
+    // number of requests in a batch.
+    std::vector<int> batch_sizes = {1, 2, 4, 8};
+    // How long a batch waits for more requests to join it before running,
+    // unless it is full. With 0, a batch takes the requests that queued up
+    // while the previous one ran.
+    int64_t max_batch_delay_micros = 0;
+    // The number of threads of each interpreter.
+    int num_threads = 1;
+  };
+
+  // Returns nullptr if the model can't be batched. `model` and `op_resolver`
+  // must outlive the result.
+  static std::unique_ptr<BatchingInterpreter> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const Options& options);
+
+  // Runs one example, and blocks until it has run. `inputs[i]` holds the
+  // input_bytes(i) bytes of the i-th input, and the output_bytes(i) bytes of
+  // the i-th output are written to `outputs[i]`. Thread-safe.
+  TfLiteStatus Invoke(const std::vector<const void*>& inputs,
+                      const std::vector<void*>& outputs);
+
+  int num_inputs() const { return input_bytes_.size(); }
+  int num_outputs() const { return output_bytes_.size(); }
+  // Bytes of the i-th input or output of one example.
+  size_t input_bytes(int i) const { return input_bytes_[i]; }
+  size_t output_bytes(int i) const { return output_bytes_[i]; }
+
+ private:
+  struct Request {
+    const std::vector<const void*>* inputs;
+    const std::vector<void*>* outputs;
+    TfLiteStatus status = kTfLiteOk;
+    bool done = false;
+  };
+
+  struct Variant {
+    int batch_size;
+    std::unique_ptr<Interpreter> interpreter;
+  };
+
+  BatchingInterpreter(const Options& options, ErrorReporter* error_reporter)
+      : options_(options), error_reporter_(error_reporter) {}
+
+  // Runs `batch` on the smallest variant that fits it, and sets the status of
+  // each request.
+  void RunBatch(const std::vector<Request*>& batch);
+
+  const Options options_;
+  ErrorReporter* const error_reporter_;
+  // Sorted by increasing batch size.
+  std::vector<Variant> variants_;
+  std::vector<size_t> input_bytes_;
+  std::vector<size_t> output_bytes_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // Requests that are not part of a batch yet, in arrival order.
+  std::deque<Request*> queue_;
+  // Whether a thread is currently gathering or running a batch.
+  bool batch_running_ = false;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_BATCHING_BATCHING_INTERPRETER_H_
@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/experimental/batching/batching_interpreter.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+// add.bin computes 3 * input, for an input of shape [1, 8, 8, 3].
+constexpr int kExampleSize = 8 * 8 * 3;
+
+std::unique_ptr<FlatBufferModel> LoadAddModel() {
+  return FlatBufferModel::BuildFromFile("tensorflow/lite/testdata/add.bin");
+}
+
+std::vector<float> Example(int seed) {
+  std::vector<float> example(kExampleSize);
+  for (int i = 0; i < kExampleSize; ++i) example[i] = seed * 1000 + i;
+  return example;
+}
+
+std::vector<float> Expected(const std::vector<float>& example) {
+  std::vector<float> expected;
+  for (float value : example) expected.push_back(3 * value);
+  return expected;
+}
+
+TEST(BatchingInterpreterTest, SingleRequest) {
+  auto model = LoadAddModel();
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolver resolver;
+  auto interpreter =
+      BatchingInterpreter::Create(*model, resolver, /*options=*/{});
+  ASSERT_NE(interpreter, nullptr);
+  ASSERT_EQ(interpreter->num_inputs(), 1);
+  ASSERT_EQ(interpreter->num_outputs(), 1);
+  EXPECT_EQ(interpreter->input_bytes(0), kExampleSize * sizeof(float));
+  EXPECT_EQ(interpreter->output_bytes(0), kExampleSize * sizeof(float));
+
+  const std::vector<float> input = Example(1);
+  std::vector<float> output(kExampleSize);
+  ASSERT_EQ(interpreter->Invoke({input.data()}, {output.data()}), kTfLiteOk);
+  EXPECT_THAT(output, ElementsAreArray(Expected(input)));
+}
+
+TEST(BatchingInterpreterTest, ConcurrentRequests) {
+  auto model = LoadAddModel();
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolver resolver;
+  BatchingInterpreter::Options options;
+  options.batch_sizes = {1, 3};
+  options.max_batch_delay_micros = 1000;
+  auto interpreter = BatchingInterpreter::Create(*model, resolver, options);
+  ASSERT_NE(interpreter, nullptr);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumRequestsPerThread = 10;
+  std::vector<std::vector<float>> outputs(kNumThreads * kNumRequestsPerThread,
+                                          std::vector<float>(kExampleSize));
+  std::vector<TfLiteStatus> statuses(outputs.size(), kTfLiteError);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int r = 0; r < kNumRequestsPerThread; ++r) {
+        const int index = t * kNumRequestsPerThread + r;
+        const std::vector<float> input = Example(index);
+        statuses[index] =
+            interpreter->Invoke({input.data()}, {outputs[index].data()});
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  for (int i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(statuses[i], kTfLiteOk);
+    EXPECT_THAT(outputs[i], ElementsAreArray(Expected(Example(i))));
+  }
+}
+
+TEST(BatchingInterpreterTest, WrongNumberOfInputs) {
+  auto model = LoadAddModel();
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolver resolver;
+  auto interpreter =
+      BatchingInterpreter::Create(*model, resolver, /*options=*/{});
+  ASSERT_NE(interpreter, nullptr);
+  std::vector<float> output(kExampleSize);
+  EXPECT_EQ(interpreter->Invoke({}, {output.data()}), kTfLiteError);
+}
+
+TEST(BatchingInterpreterTest, InvalidBatchSizes) {
+  auto model = LoadAddModel();
+  ASSERT_NE(model, nullptr);
+  ops::builtin::BuiltinOpResolver resolver;
+  BatchingInterpreter::Options options;
+  options.batch_sizes = {0, 2};
+  EXPECT_EQ(BatchingInterpreter::Create(*model, resolver, options), nullptr);
+}
+
+}  // namespace
+}  // namespace tflite
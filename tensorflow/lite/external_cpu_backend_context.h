@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -38,6 +39,16 @@ class TfLiteInternalBackendContext {
   // A context may internally cache prepacked versions of constant tensors for
   // faster computation. This function will clear any caches on the context.
   virtual void ClearCaches() = 0;
+
+  // Runs `task(i, worker)` for each i in [0, num_tasks) on the thread pool of
+  // the context, where tasks that run concurrently get different `worker`s in
+  // [0, num_tasks), and returns true once all of them are done. This lets the
+  // framework run independent nodes of a graph concurrently. Returns false,
+  // without running any task, if the context has no threads to spare.
+  virtual bool ExecuteTasks(int num_tasks,
+                            const std::function<void(int, int)>& task) {
+    return false;
+  }
 };
 
 // This TfLiteExternalContext-derived class is the default
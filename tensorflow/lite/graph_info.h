@@ -53,6 +53,12 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the first and the last of the nodes, contiguous in execution
+  // order, that may run concurrently with the node at `index`, including it.
+  // The tensors used by such nodes must not share memory.
+  virtual size_t first_concurrent_node(size_t index) const { return index; }
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -337,6 +337,31 @@ void Interpreter::SetCancellationFunction(void* data,
   }
 }
 
+void Interpreter::SetAllowConcurrentNodeExecution(bool allow) {
+  for (auto& subgraph : subgraphs_) {
+    subgraph->SetAllowConcurrentNodeExecution(allow);
+  }
+}
+
+void Interpreter::SetMmapWeightPaging(bool enable) {
+  for (auto& subgraph : subgraphs_) {
+    subgraph->SetMmapWeightPaging(enable);
+  }
+}
+
+TfLiteStatus Interpreter::SetSharedMemoryArena(
+    SharedMemoryArena* shared_arena) {
+  return primary_subgraph().SetSharedMemoryArena(shared_arena);
+}
+
+TfLiteStatus Interpreter::SetMaxCachedAllocationPlans(int max_cached_plans) {
+  for (auto& subgraph : subgraphs_) {
+    TF_LITE_ENSURE_STATUS(
+        subgraph->SetMaxCachedAllocationPlans(max_cached_plans));
+  }
+  return kTfLiteOk;
+}
+
 bool Interpreter::IsCancelled() { return primary_subgraph().IsCancelled(); }
 
 TfLiteStatus Interpreter::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
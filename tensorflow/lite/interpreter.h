@@ -393,6 +393,44 @@ class Interpreter {
   /// WARNING: This is an experimental API and subject to change.
   void SetCancellationFunction(void* data, bool (*check_cancelled_func)(void*));
 
+  /// Allow Invoke() to run nodes that do not depend on each other concurrently,
+  /// e.g. the branches of an inception block, on the thread pool of the CPU
+  /// backend context when SetNumThreads() allows more than one thread. The
+  /// execution plan is reordered into stages of such nodes by the next
+  /// AllocateTensors(), and memory is not shared between the tensors of the
+  /// nodes of a stage. Delegated, control flow and custom nodes, and nodes
+  /// using variable tensors, always run alone.
+  /// default: not allow.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetAllowConcurrentNodeExecution(bool allow);
+
+  /// When the model is mmap'd, hint the OS to read the constant tensors of
+  /// each node ahead of running it and to drop them from memory once it has
+  /// run, as well as after AllocateTensors(), which lowers the resident memory
+  /// of large models at the cost of reading the weights back from the file,
+  /// usually from the page cache, on every Invoke().
+  /// default: off.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetMmapWeightPaging(bool enable);
+
+  /// Plan the intermediate tensors of the primary subgraph into
+  /// `shared_arena`, so that interpreters that are never invoked at the same
+  /// time, e.g. the stages of a pipeline, need only as much memory for them as
+  /// the largest one. The inputs and outputs, and the tensors of control flow
+  /// subgraphs, keep memory of their own. Takes effect on the next
+  /// AllocateTensors(). 'shared_arena' must outlive the interpreter.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetSharedMemoryArena(SharedMemoryArena* shared_arena);
+
+  /// Keep the memory plans of up to `max_cached_plans` sets of tensor sizes,
+  /// e.g. for a model whose inputs are resized between a few sequence lengths,
+  /// so that AllocateTensors() after ResizeInputTensor() to shapes that have
+  /// been allocated before reuses their plan instead of planning the memory
+  /// again. The arena stays sized for the largest of the cached plans.
+  /// default: 0, no plans are kept.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetMaxCachedAllocationPlans(int max_cached_plans);
+
   /// Allow a delegate to look at the graph and modify the graph to handle
   /// parts of the graph themselves. After this is called, the graph may
   /// contain new nodes that replace 1 more nodes.
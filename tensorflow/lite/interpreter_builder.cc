@@ -262,6 +262,19 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
     BuiltinOperator op_type =
         static_cast<BuiltinOperator>(registration->builtin_code);
 
+    std::vector<int> inputs = FlatBufferIntArrayToVector(op->inputs());
+    if (!preserved_float16_weights_.empty()) {
+      if (op_type == BuiltinOperator_DEQUANTIZE && op->outputs() &&
+          op->outputs()->size() == 1 &&
+          preserved_float16_weights_.count(op->outputs()->Get(0))) {
+        continue;
+      }
+      for (int& input : inputs) {
+        auto it = preserved_float16_weights_.find(input);
+        if (it != preserved_float16_weights_.end()) input = it->second;
+      }
+    }
+
     if (op_type != BuiltinOperator_CUSTOM && op->custom_options()) {
       error_reporter_->Report(
           "Found builtin operator %s with custom options.\n",
@@ -271,15 +284,13 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
     if (op_type == BuiltinOperator_CUSTOM) {
       if (op->custom_options()) {
         subgraph->AddNodeWithParameters(
-            FlatBufferIntArrayToVector(op->inputs()),
-            FlatBufferIntArrayToVector(op->outputs()),
+            inputs, FlatBufferIntArrayToVector(op->outputs()),
             FlatBufferIntArrayToVector(op->intermediates()),
             reinterpret_cast<const char*>(op->custom_options()->data()),
             op->custom_options()->size(), nullptr, registration);
       } else {
         subgraph->AddNodeWithParameters(
-            FlatBufferIntArrayToVector(op->inputs()),
-            FlatBufferIntArrayToVector(op->outputs()),
+            inputs, FlatBufferIntArrayToVector(op->outputs()),
             FlatBufferIntArrayToVector(op->intermediates()), nullptr, 0,
             nullptr, registration);
       }
@@ -289,8 +300,7 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
       TF_LITE_ENSURE_STATUS(ParseOpData(op, op_type, error_reporter_,
                                         &malloc_allocator, &builtin_data));
       subgraph->AddNodeWithParameters(
-          FlatBufferIntArrayToVector(op->inputs()),
-          FlatBufferIntArrayToVector(op->outputs()),
+          inputs, FlatBufferIntArrayToVector(op->outputs()),
           FlatBufferIntArrayToVector(op->intermediates()), nullptr, 0,
           builtin_data, registration);
     }
@@ -299,6 +309,64 @@ TfLiteStatus InterpreterBuilder::ParseNodes(
   return status;
 }
 
+std::map<int, int> InterpreterBuilder::FindPreservableFloat16Weights(
+    const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+    const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
+    const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+    const flatbuffers::Vector<int32_t>* subgraph_outputs) {
+  std::map<int, int> preserved;
+  if (!preserve_float16_weights_) return preserved;
+
+  auto get_op_type = [this](const Operator* op) {
+    const int index = op->opcode_index();
+    if (index < 0 || index >= flatbuffer_op_index_to_registration_.size() ||
+        !flatbuffer_op_index_to_registration_[index]) {
+      return BuiltinOperator_CUSTOM;
+    }
+    return static_cast<BuiltinOperator>(
+        flatbuffer_op_index_to_registration_[index]->builtin_code);
+  };
+  auto is_constant_float16 = [&](int tensor_index) {
+    if (tensor_index < 0 || tensor_index >= tensors->size()) return false;
+    const Tensor* tensor = tensors->Get(tensor_index);
+    if (tensor->type() != TensorType_FLOAT16) return false;
+    const uint32_t buffer_index = tensor->buffer();
+    if (buffer_index == 0 || buffer_index >= buffers->size()) return false;
+    const auto* data = buffers->Get(buffer_index)->data();
+    return data && data->size() > 0;
+  };
+
+  // Candidates are the outputs of DEQUANTIZE ops of constant float16 tensors.
+  for (int i = 0; i < operators->size(); ++i) {
+    const auto* op = operators->Get(i);
+    if (get_op_type(op) != BuiltinOperator_DEQUANTIZE || !op->inputs() ||
+        !op->outputs() || op->inputs()->size() != 1 ||
+        op->outputs()->size() != 1) {
+      continue;
+    }
+    if (is_constant_float16(op->inputs()->Get(0))) {
+      preserved[op->outputs()->Get(0)] = op->inputs()->Get(0);
+    }
+  }
+  if (preserved.empty()) return preserved;
+
+  // Keep only the ones consumed exclusively as FULLY_CONNECTED weights.
+  if (subgraph_outputs) {
+    for (int output : *subgraph_outputs) preserved.erase(output);
+  }
+  for (int i = 0; i < operators->size(); ++i) {
+    const auto* op = operators->Get(i);
+    if (!op->inputs()) continue;
+    const bool is_fully_connected =
+        get_op_type(op) == BuiltinOperator_FULLY_CONNECTED;
+    for (int j = 0; j < op->inputs()->size(); ++j) {
+      if (is_fully_connected && j == 1) continue;
+      preserved.erase(op->inputs()->Get(j));
+    }
+  }
+  return preserved;
+}
+
 TfLiteStatus InterpreterBuilder::ParseQuantization(
     const QuantizationParameters* src_quantization,
     TfLiteQuantization* quantization, const std::vector<int>& dims) {
@@ -647,6 +715,8 @@ TfLiteStatus InterpreterBuilder::operator()(
         FlatBufferIntArrayToVector(subgraph->outputs()));
 
     // Finally setup nodes and tensors
+    preserved_float16_weights_ = FindPreservableFloat16Weights(
+        operators, tensors, buffers, subgraph->outputs());
     if (ParseNodes(operators, modified_subgraph) != kTfLiteOk)
       return cleanup_and_error();
     if (ParseTensors(buffers, tensors, modified_subgraph) != kTfLiteOk)
@@ -19,6 +19,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_INTERPRETER_BUILDER_H_
 #define TENSORFLOW_LITE_INTERPRETER_BUILDER_H_
 
+#include <map>
 #include <memory>
 
 #include "tensorflow/lite/c/common.h"
@@ -69,11 +70,26 @@ class InterpreterBuilder {
   TfLiteStatus operator()(std::unique_ptr<Interpreter>* interpreter,
                           int num_threads);
 
+  /// Keeps constant float16 weights of FULLY_CONNECTED ops in float16 instead
+  /// of dequantizing them to float32 when the interpreter is built, which
+  /// halves the memory they use. The DEQUANTIZE ops feeding them are dropped
+  /// and the kernel widens the weights while computing. Off by default.
+  void PreserveFloat16Weights(bool preserve) {
+    preserve_float16_weights_ = preserve;
+  }
+
  private:
   TfLiteStatus BuildLocalIndexToRegistrationMapping();
   TfLiteStatus ParseNodes(
       const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
       Subgraph* subgraph);
+  // Returns the outputs of the DEQUANTIZE ops that can be dropped when
+  // preserving float16 weights, mapped to their float16 inputs.
+  std::map<int, int> FindPreservableFloat16Weights(
+      const flatbuffers::Vector<flatbuffers::Offset<Operator>>* operators,
+      const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
+      const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
+      const flatbuffers::Vector<int32_t>* subgraph_outputs);
   TfLiteStatus ParseTensors(
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
@@ -96,6 +112,11 @@ class InterpreterBuilder {
 
   bool has_flex_op_ = false;
   int num_fp32_tensors_ = 0;
+
+  bool preserve_float16_weights_ = false;
+  // Float16 weights preserved in the subgraph being parsed, keyed by the
+  // output of the DEQUANTIZE op they bypass.
+  std::map<int, int> preserved_float16_weights_;
 };
 
 }  // namespace impl
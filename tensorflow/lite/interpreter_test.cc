@@ -17,7 +17,10 @@ limitations under the License.
 
 #include <stdint.h>
 
+#include <functional>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -1177,6 +1180,80 @@ TEST_F(InterpreterTest, ExternalBackendContextClearsCachesOnDelete) {
   EXPECT_EQ(cpu_backend_context->num_calls, 1);
 }
 
+// A CPU backend context that runs each task of ExecuteTasks on a thread of its
+// own.
+struct ThreadedCpuBackendContext : public TfLiteInternalBackendContext {
+  void ClearCaches() override {}
+  void SetMaxNumThreads(int num_threads) override {}
+  bool ExecuteTasks(int num_tasks,
+                    const std::function<void(int, int)>& task) override {
+    ++num_calls;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_tasks; ++i) {
+      threads.emplace_back(task, i, /*worker=*/i);
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    return true;
+  }
+  int num_calls = 0;
+};
+
+TEST_F(InterpreterTest, ConcurrentNodeExecution) {
+  ExternalCpuBackendContext external_cpu_context;
+  ThreadedCpuBackendContext* cpu_backend_context =
+      new ThreadedCpuBackendContext();
+  external_cpu_context.set_internal_backend_context(
+      std::unique_ptr<TfLiteInternalBackendContext>(cpu_backend_context));
+  interpreter_.SetExternalContext(kTfLiteCpuBackendContext,
+                                  &external_cpu_context);
+  interpreter_.SetNumThreads(2);
+
+  // Two independent chains of two nodes, 0 -> 2 -> 3 and 1 -> 4 -> 5.
+  ASSERT_EQ(interpreter_.AddTensors(6), kTfLiteOk);
+  ASSERT_EQ(interpreter_.SetInputs({0, 1}), kTfLiteOk);
+  ASSERT_EQ(interpreter_.SetOutputs({3, 5}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                        {3}, quantized),
+              kTfLiteOk);
+  }
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  ASSERT_EQ(
+      interpreter_.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_.AddNodeWithParameters({2}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_.AddNodeWithParameters({1}, {4}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter_.AddNodeWithParameters({4}, {5}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  interpreter_.SetAllowConcurrentNodeExecution(true);
+  ASSERT_EQ(interpreter_.AllocateTensors(), kTfLiteOk);
+  // The first nodes of the chains run together, and then the second ones.
+  EXPECT_THAT(interpreter_.execution_plan(),
+              ::testing::ElementsAre(0, 2, 1, 3));
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter_.typed_tensor<float>(0)[i] = i;
+    interpreter_.typed_tensor<float>(1)[i] = 10 + i;
+  }
+  ASSERT_EQ(interpreter_.Invoke(), kTfLiteOk);
+  EXPECT_EQ(cpu_backend_context->num_calls, 2);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter_.typed_tensor<float>(3)[i], i);
+    EXPECT_EQ(interpreter_.typed_tensor<float>(5)[i], 10 + i);
+  }
+
+  interpreter_.SetExternalContext(kTfLiteCpuBackendContext, nullptr);
+}
+
 // Test fixture that allows playing with execution plans. It creates a two
 // node graph that can be executed in either [0,1] order or [1,0] order.
 // The CopyOp records when it is invoked in the class member run_order_
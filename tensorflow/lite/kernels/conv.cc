@@ -995,20 +995,34 @@ template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, 0);
 
+  // Types compiled out by TFLITE_SELECTED_TYPES fall through to the error.
   switch (input->type) {
     case kTfLiteFloat32:
-      return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
+      if (IsTypeSelected(kTfLiteFloat32)) {
+        return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
+      }
+      break;
     case kTfLiteUInt8:
-      return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
+      if (IsTypeSelected(kTfLiteUInt8)) {
+        return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
+      }
+      break;
     case kTfLiteInt8:
-      return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
+      if (IsTypeSelected(kTfLiteInt8)) {
+        return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
+      }
+      break;
     case kTfLiteInt16:
-      return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
+      if (IsTypeSelected(kTfLiteInt16)) {
+        return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
+      }
+      break;
     default:
-      TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
-                         TfLiteTypeGetName(input->type));
-      return kTfLiteError;
+      break;
   }
+  TF_LITE_KERNEL_LOG(context, "Type %s not currently supported.",
+                     TfLiteTypeGetName(input->type));
+  return kTfLiteError;
 }
 
 }  // namespace conv
@@ -15,10 +15,15 @@ limitations under the License.
 
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include "public/gemmlowp.h"
 #include "ruy/context.h"  // from @ruy
+#include "ruy/thread_pool.h"  // from @ruy
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/kernels/op_macros.h"
@@ -26,6 +31,36 @@ limitations under the License.
 namespace {
 const int kDefaultNumThreadpoolThreads = 1;
 
+#ifdef TFLITE_WITH_RUY
+using ThreadPoolTask = ruy::Task;
+#else
+using ThreadPoolTask = gemmlowp::Task;
+#endif
+
+// Runs tasks, as worker `worker`, until `next_task` reaches `num_tasks`.
+class ClaimingTask : public ThreadPoolTask {
+ public:
+  ClaimingTask(int worker, int num_tasks, std::atomic<int>* next_task,
+               const std::function<void(int, int)>* task)
+      : worker_(worker),
+        num_tasks_(num_tasks),
+        next_task_(next_task),
+        task_(task) {}
+
+  void Run() override {
+    for (int i = next_task_->fetch_add(1); i < num_tasks_;
+         i = next_task_->fetch_add(1)) {
+      (*task_)(i, worker_);
+    }
+  }
+
+ private:
+  const int worker_;
+  const int num_tasks_;
+  std::atomic<int>* const next_task_;
+  const std::function<void(int, int)>* const task_;
+};
+
 }  // namespace
 
 namespace tflite {
@@ -79,4 +114,24 @@ void CpuBackendContext::SetMaxNumThreads(int max_num_threads) {
 
 void CpuBackendContext::SetUseCaching(bool flag) { use_caching_ = flag; }
 
+bool CpuBackendContext::ExecuteTasks(
+    int num_tasks, const std::function<void(int, int)>& task) {
+  const int num_workers = std::min(num_tasks, max_num_threads_);
+  if (num_workers <= 1) {
+    return false;
+  }
+  std::atomic<int> next_task(0);
+  std::vector<ClaimingTask> tasks;
+  tasks.reserve(num_workers);
+  for (int worker = 0; worker < num_workers; ++worker) {
+    tasks.emplace_back(worker, num_tasks, &next_task, &task);
+  }
+#ifdef TFLITE_WITH_RUY
+  ruy_context_->mutable_thread_pool()->Execute(num_workers, tasks.data());
+#else
+  gemmlowp_context_->workers_pool()->Execute(num_workers, tasks.data());
+#endif
+  return true;
+}
+
 }  // namespace tflite
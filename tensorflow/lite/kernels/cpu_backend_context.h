@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_KERNELS_CPU_BACKEND_CONTEXT_H_
 
+#include <functional>
 #include <memory>
 
 #include "public/gemmlowp.h"
@@ -50,6 +51,12 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   void ClearCaches() override { ruy_context_->ClearPrepackedCache(); }
 
+  // Runs the tasks on up to max_num_threads() threads of the thread pool that
+  // the kernels use, so the kernels that the tasks run must not use this
+  // context themselves.
+  bool ExecuteTasks(int num_tasks,
+                    const std::function<void(int, int)>& task) override;
+
  private:
   // To enable a smooth transition from the current direct usage
   // of the underlying gemmlowp context to going through abstractions
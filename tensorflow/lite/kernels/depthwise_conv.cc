@@ -549,20 +549,34 @@ template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   const TfLiteTensor* input = GetInput(context, node, kInputTensor);
 
+  // Types compiled out by TFLITE_SELECTED_TYPES fall through to the error.
   switch (input->type) {  // Already know in/out types are same.
     case kTfLiteFloat32:
-      return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
+      if (IsTypeSelected(kTfLiteFloat32)) {
+        return EvalImpl<kernel_type, kTfLiteFloat32>(context, node);
+      }
+      break;
     case kTfLiteUInt8:
-      return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
+      if (IsTypeSelected(kTfLiteUInt8)) {
+        return EvalImpl<kernel_type, kTfLiteUInt8>(context, node);
+      }
+      break;
     case kTfLiteInt8:
-      return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
+      if (IsTypeSelected(kTfLiteInt8)) {
+        return EvalImpl<kernel_type, kTfLiteInt8>(context, node);
+      }
+      break;
     case kTfLiteInt16:
-      return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
+      if (IsTypeSelected(kTfLiteInt16)) {
+        return EvalImpl<kernel_type, kTfLiteInt16>(context, node);
+      }
+      break;
     default:
-      context->ReportError(context, "Type %d not currently supported.",
-                           input->type);
-      return kTfLiteError;
+      break;
   }
+  context->ReportError(context, "Type %d not currently supported.",
+                       input->type);
+  return kTfLiteError;
 }
 
 }  // namespace depthwise_conv
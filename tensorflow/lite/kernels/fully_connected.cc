@@ -119,10 +119,14 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
       TF_LITE_ENSURE_EQ(context, is_optional_bias_int, true);
     }
   } else {
-    // Only float32 is supported currently
+    // Only float32 is supported currently, with optional float16 weights.
     TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
     TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
-    TF_LITE_ENSURE_TYPES_EQ(context, filter->type, kTfLiteFloat32);
+    TF_LITE_ENSURE(context, filter->type == kTfLiteFloat32 ||
+                                filter->type == kTfLiteFloat16);
+    if (filter->type == kTfLiteFloat16) {
+      TF_LITE_ENSURE(context, filter->sparsity == nullptr);
+    }
     TF_LITE_ENSURE_EQ(context, is_optional_bias_float, true);
   }
 
@@ -353,6 +357,41 @@ TfLiteStatus EvalPie(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+// Float inputs and outputs with float16 weights. The weights stay in half
+// precision, halving their memory, and are widened while accumulating.
+TfLiteStatus EvalFloat16Weights(TfLiteContext* context,
+                                TfLiteFullyConnectedParams* params,
+                                const TfLiteTensor* input,
+                                const TfLiteTensor* filter,
+                                const TfLiteTensor* bias,
+                                TfLiteTensor* output) {
+  const int total_input_size = NumElements(input);
+  const int input_size = filter->dims->data[1];
+  const int batch_size = total_input_size / input_size;
+  const int num_units = filter->dims->data[0];
+
+  // Output = bias if bias tensor exists.
+  if (bias) {
+    tensor_utils::VectorBatchVectorAssign(GetTensorData<float>(bias), num_units,
+                                          batch_size,
+                                          GetTensorData<float>(output));
+  } else {
+    std::fill_n(GetTensorData<float>(output), batch_size * num_units, 0.0f);
+  }
+
+  // Compute output += weight * input
+  tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+      GetTensorData<TfLiteFloat16>(filter), num_units, input_size,
+      GetTensorData<float>(input), batch_size, GetTensorData<float>(output));
+
+  // Apply activation function
+  tensor_utils::ApplyActivationToVector(
+      GetTensorData<float>(output), batch_size * num_units, params->activation,
+      GetTensorData<float>(output));
+
+  return kTfLiteOk;
+}
+
 TfLiteStatus EvalHybrid(TfLiteContext* context, TfLiteNode* node,
                         TfLiteFullyConnectedParams* params, OpData* data,
                         const TfLiteTensor* input, const TfLiteTensor* filter,
@@ -454,6 +493,56 @@ void FullyConnectedInt8(const OpData* data, const TfLiteTensor* input,
 }
 }  // namespace
 
+namespace {
+template <KernelType kernel_type>
+TfLiteStatus FullyConnectedSparseInt8(TfLiteContext* context,
+                                      const OpData* data,
+                                      const TfLiteTensor* input,
+                                      const TfLiteTensor* filter,
+                                      const TfLiteTensor* bias,
+                                      TfLiteTensor* output) {
+  const auto& sparsity = *filter->sparsity;
+  if (!SupportedSparsityFormat(sparsity)) {
+    TF_LITE_KERNEL_LOG(context,
+                       "Unsupported sparse fully-connected weight format.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE_EQ(context, filter->params.zero_point, 0);
+
+  FullyConnectedParams op_params;
+  op_params.input_offset = -input->params.zero_point;
+  op_params.weights_offset = 0;
+  op_params.output_offset = output->params.zero_point;
+  op_params.output_multiplier = data->output_multiplier;
+  op_params.output_shift = data->output_shift;
+  op_params.quantized_activation_min = data->output_activation_min;
+  op_params.quantized_activation_max = data->output_activation_max;
+  if (kernel_type == kReference) {
+    reference_ops::FullyConnectedSparseWeight(
+        sparsity, op_params, GetTensorShape(input),
+        GetTensorData<int8_t>(input), GetTensorShape(filter),
+        GetTensorData<int8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<int8_t>(output));
+  } else if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
+             sparsity.dim_metadata[2].dense_size == 4) {
+    // Block sparse with block size of 1x4.
+    optimized_ops::FullyConnectedSparseWeight1x4(
+        sparsity, op_params, GetTensorShape(input),
+        GetTensorData<int8_t>(input), GetTensorShape(filter),
+        GetTensorData<int8_t>(filter), GetTensorShape(bias),
+        GetTensorData<int32_t>(bias), GetTensorShape(output),
+        GetTensorData<int8_t>(output),
+        CpuBackendContext::GetFromContext(context));
+  } else {
+    TF_LITE_KERNEL_LOG(context,
+                       "Unsupported sparse fully-connected weight format.");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+}  // namespace
+
 namespace {
 template <KernelType kernel_type>
 void FullyConnectedInt16(const OpData* data, const TfLiteTensor* input,
@@ -521,9 +610,14 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
         }
         break;
       case kTfLiteInt8:
-        FullyConnectedInt8<kernel_type>(
-            data, input, filter, bias, output,
-            CpuBackendContext::GetFromContext(context));
+        if (filter->sparsity != nullptr) {
+          TF_LITE_ENSURE_STATUS(FullyConnectedSparseInt8<kernel_type>(
+              context, data, input, filter, bias, output));
+        } else {
+          FullyConnectedInt8<kernel_type>(
+              data, input, filter, bias, output,
+              CpuBackendContext::GetFromContext(context));
+        }
         break;
       case kTfLiteInt16:
         if (input->type == kTfLiteInt16) {
@@ -701,11 +795,17 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           : nullptr;
   TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
 
+  // Types compiled out by TFLITE_SELECTED_TYPES break out of the switch.
   switch (filter->type) {
     case kTfLiteFloat32:
+      if (!IsTypeSelected(kTfLiteFloat32)) break;
       return EvalFloat<kernel_type>(context, node, params, data, input, filter,
                                     bias, output);
+    case kTfLiteFloat16:
+      if (!IsTypeSelected(kTfLiteFloat16)) break;
+      return EvalFloat16Weights(context, params, input, filter, bias, output);
     case kTfLiteUInt8:
+      if (!IsTypeSelected(kTfLiteUInt8)) break;
       if (params->weights_format ==
           kTfLiteFullyConnectedWeightsFormatShuffled4x16Int8) {
         TfLiteTensor* shuffled_input_workspace =
@@ -723,6 +823,7 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         return kTfLiteError;
       }
     case kTfLiteInt8:
+      if (!IsTypeSelected(kTfLiteInt8)) break;
       if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
         return EvalQuantized<kernel_type>(context, node, params, data, input,
                                           filter, bias, output);
@@ -737,7 +838,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
                            TfLiteTypeGetName(filter->type));
       return kTfLiteError;
   }
-  return kTfLiteOk;
+  context->ReportError(context,
+                       "Filter data type %s was not selected in this build.",
+                       TfLiteTypeGetName(filter->type));
+  return kTfLiteError;
 }
 
 }  // namespace fully_connected
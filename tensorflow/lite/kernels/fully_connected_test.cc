@@ -1355,6 +1355,88 @@ TEST_P(SparseFullyConnectedOpTest, Simple1x4TestMultiThreadedMoreBatches) {
                                            ));
   }
 }
+class SparseQuantizedFullyConnectedOpModel : public SingleOpModel {
+ public:
+  SparseQuantizedFullyConnectedOpModel(
+      TfLiteRegistration* registration, int units, const TensorData& input,
+      const TensorData& weights, std::initializer_list<int8_t> weights_data,
+      const TensorData& output, int num_threads = 1) {
+    input_ = AddInput(input);
+    weights_ = AddConstSparseInput(weights, weights_data);
+
+    TensorData bias{TensorType_INT32, {units}, 0, 0,
+                    GetScale(input_) * GetScale(weights_)};
+    bias_ = AddInput(bias);
+
+    output_ = AddOutput(output);
+
+    SetBuiltinOp(
+        BuiltinOperator_FULLY_CONNECTED, BuiltinOptions_FullyConnectedOptions,
+        CreateFullyConnectedOptions(builder_, ActivationFunctionType_RELU)
+            .Union());
+    resolver_ = absl::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), GetShape(weights_), GetShape(bias_)},
+                     num_threads, /*allow_fp32_relax_to_fp16=*/false,
+                     /*apply_delegate=*/false);
+  }
+  void SetBias(const std::vector<float>& data) {
+    QuantizeAndPopulate<int32_t>(bias_, data);
+  }
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+  std::vector<float> GetDequantizedOutput() {
+    return Dequantize<int8_t>(ExtractVector<int8_t>(output_),
+                              GetScale(output_), GetZeroPoint(output_));
+  }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ protected:
+  int input_;
+  int weights_;
+  int bias_;
+  int output_;
+};
+
+TEST_P(SparseFullyConnectedOpTest, Simple1x4Int8TestMultiThreaded) {
+  std::initializer_list<int8_t> weight_data = {
+      1, 2, 3, 4, 0, 0, 0, 0, 9, 10, 11, 12,  // u = 0
+      0, 0, 0, 0, 5, 6, 7, 8, 9, 10, 11, 12,  // u = 1
+      1, 2, 3, 4, 5, 6, 7, 8, 0, 0,  0,  0,   // u = 2
+  };
+  TensorData weight = {};
+  weight.type = TensorType_INT8;
+  weight.shape = {3, 12};
+  weight.scale = 1.0f;
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {4};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(), /*units=*/3,
+        /*input=*/{TensorType_INT8, {3, 12}, -63.5, 64}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, -508, 512}, num_threads);
+    m.SetBias({1, 2, 3});
+
+    m.SetInput({
+        1, 2, 3, 4, 5, 6, 7, 8,  -9, -10, 11,  12,  // b = 0
+        1, 2, 3, 4, 5, 6, 7, -8, 9,  -10, -11, 12,  // b = 1
+        1, 1, 1, 1, 1, 1, 1, 1,  1,  1,   1,   1,   // b = 2
+    });
+
+    m.Invoke();
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(3, 3));
+    EXPECT_THAT(m.GetDequantizedOutput(),
+                ElementsAreArray(ArrayFloatNear({115, 260, 207,  // b = 0
+                                                 35, 52, 79,     // b = 1
+                                                 53, 70, 39},    // b = 2
+                                                /*max_abs_error=*/2)));
+  }
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
@@ -0,0 +1,309 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Interprets a chain of float element-wise ops fused by the converter's
+// tfl-fuse-elementwise-chains pass. The chain is applied to one cache-sized
+// tile of the output at a time, so intermediate values never go to memory.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "ruy/profiler/instrumentation.h"  // from @ruy
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace fused_elementwise {
+
+constexpr int kChainInputTensor = 0;
+constexpr int kOutputTensor = 0;
+// Number of floats processed per tile, small enough to stay in L1.
+constexpr int kTileSize = 256;
+
+enum class StepOp {
+  kAdd,
+  kSub,
+  kReverseSub,
+  kMul,
+  kDiv,
+  kReverseDiv,
+  kMaximum,
+  kMinimum,
+  kLogistic,
+  kTanh,
+  kRelu,
+  kRelu6,
+  kReluN1To1,
+  kNeg,
+  kAbs,
+  kSquare,
+};
+
+struct Step {
+  StepOp op;
+  // Index of the side input for binary steps, -1 for unary ones.
+  int operand;
+};
+
+struct OpData {
+  std::vector<Step> steps;
+  bool valid = true;
+};
+
+bool ParseStepOp(const std::string& name, StepOp* op) {
+  static const struct {
+    const char* name;
+    StepOp op;
+  } kStepOps[] = {
+      {"ADD", StepOp::kAdd},
+      {"SUB", StepOp::kSub},
+      {"REVERSE_SUB", StepOp::kReverseSub},
+      {"MUL", StepOp::kMul},
+      {"DIV", StepOp::kDiv},
+      {"REVERSE_DIV", StepOp::kReverseDiv},
+      {"MAXIMUM", StepOp::kMaximum},
+      {"MINIMUM", StepOp::kMinimum},
+      {"LOGISTIC", StepOp::kLogistic},
+      {"TANH", StepOp::kTanh},
+      {"RELU", StepOp::kRelu},
+      {"RELU6", StepOp::kRelu6},
+      {"RELU_N1_TO_1", StepOp::kReluN1To1},
+      {"NEG", StepOp::kNeg},
+      {"ABS", StepOp::kAbs},
+      {"SQUARE", StepOp::kSquare},
+  };
+  for (const auto& entry : kStepOps) {
+    if (name == entry.name) {
+      *op = entry.op;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IsBinary(StepOp op) {
+  switch (op) {
+    case StepOp::kAdd:
+    case StepOp::kSub:
+    case StepOp::kReverseSub:
+    case StepOp::kMul:
+    case StepOp::kDiv:
+    case StepOp::kReverseDiv:
+    case StepOp::kMaximum:
+    case StepOp::kMinimum:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void* Init(TfLiteContext* context, const char* buffer, size_t length) {
+  auto* data = new OpData;
+  const uint8_t* buffer_t = reinterpret_cast<const uint8_t*>(buffer);
+  const flexbuffers::Map& m = flexbuffers::GetRoot(buffer_t, length).AsMap();
+  const flexbuffers::Vector ops = m["ops"].AsVector();
+  const flexbuffers::Vector operands = m["operands"].AsVector();
+  if (ops.size() != operands.size()) {
+    data->valid = false;
+    return data;
+  }
+  data->steps.reserve(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    Step step;
+    if (!ParseStepOp(ops[i].AsString().str(), &step.op)) {
+      data->valid = false;
+      return data;
+    }
+    step.operand = operands[i].AsInt32();
+    data->steps.push_back(step);
+  }
+  return data;
+}
+
+void Free(TfLiteContext* context, void* buffer) {
+  delete reinterpret_cast<OpData*>(buffer);
+}
+
+TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  const auto* data = reinterpret_cast<const OpData*>(node->user_data);
+  TF_LITE_ENSURE(context, data->valid);
+  TF_LITE_ENSURE(context, NumInputs(node) >= 1);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+
+  const TfLiteTensor* input = GetInput(context, node, kChainInputTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+  TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+
+  // Side inputs are read element by element or broadcast as scalars.
+  const int64_t num_elements = NumElements(input);
+  for (const Step& step : data->steps) {
+    if (!IsBinary(step.op)) {
+      TF_LITE_ENSURE_EQ(context, step.operand, -1);
+      continue;
+    }
+    TF_LITE_ENSURE(context,
+                   step.operand >= 0 && step.operand < NumInputs(node));
+    const TfLiteTensor* side = GetInput(context, node, step.operand);
+    TF_LITE_ENSURE_TYPES_EQ(context, side->type, kTfLiteFloat32);
+    TF_LITE_ENSURE(context, NumElements(side) == num_elements ||
+                                NumElements(side) == 1);
+  }
+
+  return context->ResizeTensor(context, output,
+                               TfLiteIntArrayCopy(input->dims));
+}
+
+// Applies the binary `op` to `size` values of `tile`, with the side input
+// either read alongside it or broadcast from `side[0]`.
+template <typename Fn>
+void ApplyBinary(float* tile, const float* side, bool broadcast, int size,
+                 Fn fn) {
+  if (broadcast) {
+    const float value = side[0];
+    for (int i = 0; i < size; ++i) tile[i] = fn(tile[i], value);
+  } else {
+    for (int i = 0; i < size; ++i) tile[i] = fn(tile[i], side[i]);
+  }
+}
+
+template <typename Fn>
+void ApplyUnary(float* tile, int size, Fn fn) {
+  for (int i = 0; i < size; ++i) tile[i] = fn(tile[i]);
+}
+
+void ApplyStep(const Step& step, float* tile, const float* side,
+               bool broadcast, int size) {
+  switch (step.op) {
+    case StepOp::kAdd:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return x + y; });
+      break;
+    case StepOp::kSub:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return x - y; });
+      break;
+    case StepOp::kReverseSub:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return y - x; });
+      break;
+    case StepOp::kMul:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return x * y; });
+      break;
+    case StepOp::kDiv:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return x / y; });
+      break;
+    case StepOp::kReverseDiv:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return y / x; });
+      break;
+    case StepOp::kMaximum:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return std::max(x, y); });
+      break;
+    case StepOp::kMinimum:
+      ApplyBinary(tile, side, broadcast, size,
+                  [](float x, float y) { return std::min(x, y); });
+      break;
+    case StepOp::kLogistic:
+      ApplyUnary(tile, size, [](float x) { return 1.f / (1.f + expf(-x)); });
+      break;
+    case StepOp::kTanh:
+      ApplyUnary(tile, size, [](float x) { return tanhf(x); });
+      break;
+    case StepOp::kRelu:
+      ApplyUnary(tile, size, [](float x) { return std::max(x, 0.f); });
+      break;
+    case StepOp::kRelu6:
+      ApplyUnary(tile, size,
+                 [](float x) { return std::min(std::max(x, 0.f), 6.f); });
+      break;
+    case StepOp::kReluN1To1:
+      ApplyUnary(tile, size,
+                 [](float x) { return std::min(std::max(x, -1.f), 1.f); });
+      break;
+    case StepOp::kNeg:
+      ApplyUnary(tile, size, [](float x) { return -x; });
+      break;
+    case StepOp::kAbs:
+      ApplyUnary(tile, size, [](float x) { return fabsf(x); });
+      break;
+    case StepOp::kSquare:
+      ApplyUnary(tile, size, [](float x) { return x * x; });
+      break;
+  }
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  ruy::profiler::ScopeLabel label("FusedElementwise");
+  const auto* data = reinterpret_cast<const OpData*>(node->user_data);
+  const TfLiteTensor* input = GetInput(context, node, kChainInputTensor);
+  TfLiteTensor* output = GetOutput(context, node, kOutputTensor);
+
+  const int num_inputs = NumInputs(node);
+  std::vector<const float*> input_data(num_inputs);
+  std::vector<bool> is_broadcast(num_inputs);
+  const int64_t num_elements = NumElements(input);
+  for (int i = 0; i < num_inputs; ++i) {
+    const TfLiteTensor* tensor = GetInput(context, node, i);
+    input_data[i] = GetTensorData<float>(tensor);
+    is_broadcast[i] = NumElements(tensor) == 1 && num_elements != 1;
+  }
+
+  float tile[kTileSize];
+  float* output_data = GetTensorData<float>(output);
+  for (int64_t start = 0; start < num_elements; start += kTileSize) {
+    const int size =
+        static_cast<int>(std::min<int64_t>(kTileSize, num_elements - start));
+    memcpy(tile, input_data[kChainInputTensor] + start, size * sizeof(float));
+    for (const Step& step : data->steps) {
+      const float* side = nullptr;
+      bool broadcast = false;
+      if (step.operand >= 0) {
+        broadcast = is_broadcast[step.operand];
+        side = input_data[step.operand] + (broadcast ? 0 : start);
+      }
+      ApplyStep(step, tile, side, broadcast, size);
+    }
+    memcpy(output_data + start, tile, size * sizeof(float));
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace fused_elementwise
+
+TfLiteRegistration* Register_FUSED_ELEMENTWISE() {
+  static TfLiteRegistration r = {
+      fused_elementwise::Init, fused_elementwise::Free,
+      fused_elementwise::Prepare, fused_elementwise::Eval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
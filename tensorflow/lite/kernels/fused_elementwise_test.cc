@@ -0,0 +1,129 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <math.h>
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flexbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/custom_ops_register.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+
+namespace {
+
+using ::testing::ElementsAreArray;
+
+class FusedElementwiseOpModel : public SingleOpModel {
+ public:
+  FusedElementwiseOpModel(const std::vector<TensorData>& inputs,
+                          const std::vector<std::string>& ops,
+                          const std::vector<int>& operands) {
+    std::vector<std::vector<int>> input_shapes;
+    for (const TensorData& input : inputs) {
+      inputs_.push_back(AddInput(input));
+      input_shapes.push_back(input.shape);
+    }
+    output_ = AddOutput({TensorType_FLOAT32, {}});
+
+    flexbuffers::Builder fbb;
+    fbb.Map([&]() {
+      fbb.Vector("ops", [&]() {
+        for (const std::string& op : ops) fbb.String(op);
+      });
+      fbb.Vector("operands", [&]() {
+        for (int operand : operands) fbb.Int(operand);
+      });
+    });
+    fbb.Finish();
+    SetCustomOp("FusedElementwise", fbb.GetBuffer(),
+                Register_FUSED_ELEMENTWISE);
+    BuildInterpreter(input_shapes);
+  }
+
+  int input(int i) { return inputs_[i]; }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  std::vector<int> inputs_;
+  int output_;
+};
+
+float Logistic(float x) { return 1.f / (1.f + expf(-x)); }
+
+TEST(FusedElementwiseOpTest, MulAddLogisticMul) {
+  // ((x * y) + 0.5) -> logistic -> * x
+  FusedElementwiseOpModel m(
+      {{TensorType_FLOAT32, {1, 2, 2}},
+       {TensorType_FLOAT32, {1, 2, 2}},
+       {TensorType_FLOAT32, {}}},
+      {"MUL", "ADD", "LOGISTIC", "MUL"}, {1, 2, -1, 0});
+  m.PopulateTensor<float>(m.input(0), {-2.f, -1.f, 1.f, 2.f});
+  m.PopulateTensor<float>(m.input(1), {0.5f, 1.f, 2.f, -1.f});
+  m.PopulateTensor<float>(m.input(2), {0.5f});
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAreArray({1, 2, 2}));
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({
+                  -2.f * Logistic(-0.5f),
+                  -1.f * Logistic(-0.5f),
+                  1.f * Logistic(2.5f),
+                  2.f * Logistic(-1.5f),
+              })));
+}
+
+TEST(FusedElementwiseOpTest, ReversedOpsAndActivations) {
+  // relu6(2 - x) / x -> relu_n1_to_1
+  FusedElementwiseOpModel m(
+      {{TensorType_FLOAT32, {4}}, {TensorType_FLOAT32, {1}}},
+      {"REVERSE_SUB", "RELU6", "DIV", "RELU_N1_TO_1"}, {1, -1, 0, -1});
+  m.PopulateTensor<float>(m.input(0), {-4.f, 1.f, 4.f, 8.f});
+  m.PopulateTensor<float>(m.input(1), {2.f});
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(),
+              ElementsAreArray(ArrayFloatNear({-1.f, 1.f, 0.f, 0.f})));
+}
+
+TEST(FusedElementwiseOpTest, SpansMultipleTiles) {
+  const int kSize = 1000;
+  FusedElementwiseOpModel m(
+      {{TensorType_FLOAT32, {kSize}}, {TensorType_FLOAT32, {kSize}}},
+      {"SQUARE", "SUB", "NEG"}, {-1, 1, -1});
+  std::vector<float> x(kSize), y(kSize), expected(kSize);
+  for (int i = 0; i < kSize; ++i) {
+    x[i] = 0.01f * i;
+    y[i] = 0.5f * i;
+    expected[i] = y[i] - x[i] * x[i];
+  }
+  m.PopulateTensor<float>(m.input(0), x);
+  m.PopulateTensor<float>(m.input(1), y);
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear(expected)));
+}
+
+}  // namespace
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 
 #include "ruy/ruy.h"  // from @ruy
+#include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
@@ -280,6 +281,47 @@ void NeonMatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
   }
 }
 
+void NeonMatrixBatchVectorMultiplyAccumulate(const TfLiteFloat16* matrix,
+                                             int m_rows, int m_cols,
+                                             const float* vector, int n_batch,
+                                             float* result) {
+  // The half precision weights are widened to float right after the load, so
+  // they take half the memory bandwidth while accumulating in float.
+#ifdef __aarch64__
+  const int postamble_start =
+      RoundDownVectors<kFloatValuesPerNeonVector>(m_cols);
+#else
+  const int postamble_start = 0;
+#endif
+
+  for (int b = 0; b < n_batch; b++) {
+    float* result_in_batch = result + b * m_rows;
+    const float* vector_in_batch = vector + b * m_cols;
+    const uint16_t* matrix_row = reinterpret_cast<const uint16_t*>(matrix);
+
+    for (int r = 0; r < m_rows; r++) {
+      int c = 0;
+#ifdef __aarch64__
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      for (; c < postamble_start; c += kFloatValuesPerNeonVector) {
+        float32x4_t vector_f32x4 = vld1q_f32(vector_in_batch + c);
+        float32x4_t matrix_f32x4 =
+            vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(matrix_row + c)));
+        acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+      }
+      *result_in_batch += AccumulateNeonLane(acc_32x4);
+#endif
+      for (; c < m_cols; c++) {
+        const float weight = Eigen::half_impl::half_to_float(
+            Eigen::half_impl::raw_uint16_to_half(matrix_row[c]));
+        *result_in_batch += weight * vector_in_batch[c];
+      }
+      matrix_row += m_cols;
+      ++result_in_batch;
+    }
+  }
+}
+
 #ifdef __aarch64__
 
 // We interleave vector data to make the dot product logic more efficient.
@@ -1989,6 +2031,52 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, int32_t input_offset, int32_t output_multiplier,
+    int32_t output_shift, int32_t output_offset, int32_t output_activation_min,
+    int32_t output_activation_max, int8_t* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+  const int16x4_t input_offset_s16x4 = vdup_n_s16(input_offset);
+
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = matrix;
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      int32x4_t acc_32x4 = vdupq_n_s32(0);
+      for (int i = segments[row]; i < segments[row + 1]; ++i) {
+        const int block_start_index = indices[i] * kBlockSize;
+        // Load the 4 int8 values of the matrix block and of the vector, which
+        // may not be aligned, and widen them to int16.
+        int32_t matrix_block;
+        int32_t vector_block;
+        memcpy(&matrix_block, matrix_ptr, sizeof(matrix_block));
+        memcpy(&vector_block, vector_in_batch + block_start_index,
+               sizeof(vector_block));
+        const int16x4_t matrix_s16x4 = vget_low_s16(
+            vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(matrix_block))));
+        const int16x4_t vector_s16x4 = vadd_s16(
+            vget_low_s16(
+                vmovl_s8(vreinterpret_s8_s32(vdup_n_s32(vector_block)))),
+            input_offset_s16x4);
+        acc_32x4 = vmlal_s16(acc_32x4, matrix_s16x4, vector_s16x4);
+        matrix_ptr += kBlockSize;
+      }
+      int32_t dot_prod = AccumulateNeonLane(acc_32x4);
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(dot_prod + bias_value,
+                                               output_multiplier, output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -97,6 +97,13 @@ void MatrixBatchVectorMultiplyAccumulate(const float* matrix, int m_rows,
                                          int m_cols, const float* vector,
                                          int n_batch, float* result);
 
+// Same as the function above, but the matrix is stored in half precision and
+// widened to float while accumulating.
+void MatrixBatchVectorMultiplyAccumulate(const TfLiteFloat16* matrix,
+                                         int m_rows, int m_cols,
+                                         const float* vector, int n_batch,
+                                         float* result);
+
 // Same as the function above, but the matrix is a sparse tensor with block
 // pattern 1x4.
 // This function assumes that m_cols is a multiple of the block size (4 in this
@@ -106,6 +113,20 @@ void SparseMatrixBatchVectorMultiplyAccumulate1x4(
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
     const float* __restrict__ vector, int n_batch, float* __restrict__ result);
 
+// Same as the function above, but for a fully quantized int8 matrix and
+// batch-vector with a per-tensor output multiplier. The matrix is assumed to
+// be symmetrically quantized (zero point 0) and 'input_offset' is the negated
+// zero point of the vector. 'bias_vector' may be null. Unlike the float
+// version, the requantized and clamped products are written (not accumulated)
+// to 'result'.
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, int32_t input_offset, int32_t output_multiplier,
+    int32_t output_shift, int32_t output_offset, int32_t output_activation_min,
+    int32_t output_activation_max, int8_t* __restrict__ result);
+
 // Same as the function above, but the matrix is stored in block compressed
 // sparse row format with block pattern 1x16 which consists of two arrays:
 //   1. A matrix array stores non-zero blocks of the matrix in row major.
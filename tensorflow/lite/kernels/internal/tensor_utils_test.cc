@@ -335,6 +335,31 @@ TEST(uKernels, MatrixBatchVectorMultiplyAccumulateTest) {
                                                        -1., 7., 23.})));
 }
 
+TEST(uKernels, Float16MatrixBatchVectorMultiplyAccumulateTest) {
+  constexpr int kRow = 2;
+  constexpr int kCol = 9;
+  constexpr int kBatch = 2;
+  // Half precision bit patterns of 1.0, 2.0 and -2.0.
+  constexpr uint16_t kOne = 0x3C00;
+  constexpr uint16_t kTwo = 0x4000;
+  constexpr uint16_t kMinusTwo = 0xC000;
+  std::vector<TfLiteFloat16> matrix(kRow * kCol);
+  for (int c = 0; c < kCol; ++c) {
+    matrix[c].data = kOne;
+    matrix[kCol + c].data = c % 2 == 0 ? kTwo : kMinusTwo;
+  }
+  static float vector[kCol * kBatch] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0,
+                                        9.0,  //
+                                        1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0,
+                                        1.0};
+  std::vector<float> output(kRow * kBatch);
+  std::fill(output.begin(), output.end(), 1.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix.data(), kRow, kCol, vector,
+                                      kBatch, output.data());
+  EXPECT_THAT(output, ElementsAreArray(ArrayFloatNear({46., 11.,  //
+                                                       10., 3.})));
+}
+
 // Quantized matmul with 2 * 30 input and 9 * 30 matrix.
 TEST(uKernels, QuantMatrixBatchVectorMultiplyAccumulate8x8_16Test) {
   CpuBackendContext context;
@@ -197,6 +197,18 @@ TfLiteStatus CalculateShapeForBroadcast(TfLiteContext* context,
                                         const TfLiteTensor* input2,
                                         const TfLiteTensor* input3,
                                         TfLiteIntArray** output_shape);
+
+// Returns false if the kernel paths for `type` are compiled out. Builds for a
+// known set of models can define TFLITE_SELECTED_TYPES to the mask written by
+// `generate_op_registrations --output_selected_types`, which has one bit per
+// TfLiteType, so kernels only keep the paths for the types those models use.
+constexpr bool IsTypeSelected(TfLiteType type) {
+#ifdef TFLITE_SELECTED_TYPES
+  return (static_cast<uint64_t>(TFLITE_SELECTED_TYPES) >> type) & 1;
+#else
+  return true;
+#endif
+}
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_KERNELS_KERNEL_UTIL_H_
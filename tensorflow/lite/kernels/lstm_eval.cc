@@ -330,6 +330,90 @@ void CalculateLstmOutputInteger8x8_8(
   }
 }
 
+// Initializes the gate scratch buffers of 'n_batch' inputs with the gate biases
+// for regular LSTM or with zero for layer norm LSTM, and accumulates the
+// input_weight * input and aux_input_weight * aux_input products into them.
+// This is the part of an LSTM step that does not depend on the state, so it
+// can be run for all the steps of a sequence at once by passing
+// n_batch * max_time as 'n_batch'.
+inline void InitializeGatesFloat(
+    const float* input_ptr, const float* input_to_input_weights_ptr,
+    const float* input_to_forget_weights_ptr,
+    const float* input_to_cell_weights_ptr,
+    const float* input_to_output_weights_ptr, const float* aux_input_ptr,
+    const float* aux_input_to_input_weights_ptr,
+    const float* aux_input_to_forget_weights_ptr,
+    const float* aux_input_to_cell_weights_ptr,
+    const float* aux_input_to_output_weights_ptr,
+    const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
+    const float* cell_gate_bias_ptr, const float* output_gate_bias_ptr,
+    bool use_cifg, bool use_layer_norm, int n_batch, int n_cell, int n_input,
+    int n_aux_input, float* input_gate_scratch, float* forget_gate_scratch,
+    float* cell_gate_scratch, float* output_gate_scratch) {
+  // Initialize scratch buffers with bias for regular lstm or initialize with
+  // zero for layer norm lstm.
+  if (use_layer_norm) {
+    if (!use_cifg) {
+      std::fill_n(input_gate_scratch, n_cell * n_batch, 0.0f);
+    }
+    std::fill_n(forget_gate_scratch, n_cell * n_batch, 0.0f);
+    std::fill_n(cell_gate_scratch, n_cell * n_batch, 0.0f);
+    std::fill_n(output_gate_scratch, n_cell * n_batch, 0.0f);
+  } else {
+    if (!use_cifg) {
+      tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell,
+                                            n_batch, input_gate_scratch);
+    }
+    tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell, n_batch,
+                                          forget_gate_scratch);
+    tensor_utils::VectorBatchVectorAssign(cell_gate_bias_ptr, n_cell, n_batch,
+                                          cell_gate_scratch);
+    tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell, n_batch,
+                                          output_gate_scratch);
+  }
+
+  // For each batch and cell: compute input_weight * input.
+  // Skip if input is all zeros.
+  if (!tensor_utils::IsZeroVector(input_ptr, n_batch * n_input)) {
+    if (!use_cifg) {
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          input_to_input_weights_ptr, n_cell, n_input, input_ptr, n_batch,
+          input_gate_scratch);
+    }
+
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_forget_weights_ptr, n_cell, n_input, input_ptr, n_batch,
+        forget_gate_scratch);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_cell_weights_ptr, n_cell, n_input, input_ptr, n_batch,
+        cell_gate_scratch);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        input_to_output_weights_ptr, n_cell, n_input, input_ptr, n_batch,
+        output_gate_scratch);
+  }
+
+  // For each batch and cell: compute aux_input_weight * aux_input.
+  // Skip if auxiliary input is not available or all zeros.
+  if (aux_input_ptr != nullptr &&
+      !tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input)) {
+    if (!use_cifg) {
+      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+          aux_input_to_input_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
+          n_batch, input_gate_scratch);
+    }
+
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        aux_input_to_forget_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
+        n_batch, forget_gate_scratch);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        aux_input_to_cell_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
+        n_batch, cell_gate_scratch);
+    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
+        aux_input_to_output_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
+        n_batch, output_gate_scratch);
+  }
+}
+
 // Performs an LSTM batch inference step for input specified by input_ptr.
 // The LSTM cell is specified by the pointers to its weights (*_weights_ptr) and
 // biases (*_bias_ptr), and buffers (*_scratch), along with additional
@@ -393,6 +477,10 @@ void CalculateLstmOutputInteger8x8_8(
 // for bidirectional LSTMs with merge_outputs. In this case, the batched
 // operations cannot be used since they assume that the batched outputs are
 // contiguous, and we manually loop over the batched outputs.
+//
+// If input_gates_precomputed is true, the scratch buffers already hold the
+// result of InitializeGatesFloat for this step and the input weights, input
+// and gate biases (for regular LSTM) are not used.
 // LINT.IfChange
 inline void LstmStepFloat(
     const float* input_ptr, const float* input_to_input_weights_ptr,
@@ -420,7 +508,8 @@ inline void LstmStepFloat(
     const TfLiteLSTMParams* params, int n_batch, int n_cell, int n_input,
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* scratch0,
-    float* scratch1, float* scratch2, float* scratch3, float* output_ptr) {
+    float* scratch1, float* scratch2, float* scratch3, float* output_ptr,
+    bool input_gates_precomputed) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -434,67 +523,16 @@ inline void LstmStepFloat(
   float* cell_gate_scratch = scratch2;
   float* output_gate_scratch = scratch3;
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
-    if (!use_cifg) {
-      std::fill_n(input_gate_scratch, n_cell * n_batch, 0.0f);
-    }
-    std::fill_n(forget_gate_scratch, n_cell * n_batch, 0.0f);
-    std::fill_n(cell_gate_scratch, n_cell * n_batch, 0.0f);
-    std::fill_n(output_gate_scratch, n_cell * n_batch, 0.0f);
-  } else {
-    if (!use_cifg) {
-      tensor_utils::VectorBatchVectorAssign(input_gate_bias_ptr, n_cell,
-                                            n_batch, input_gate_scratch);
-    }
-    tensor_utils::VectorBatchVectorAssign(forget_gate_bias_ptr, n_cell, n_batch,
-                                          forget_gate_scratch);
-    tensor_utils::VectorBatchVectorAssign(cell_gate_bias_ptr, n_cell, n_batch,
-                                          cell_gate_scratch);
-    tensor_utils::VectorBatchVectorAssign(output_gate_bias_ptr, n_cell, n_batch,
-                                          output_gate_scratch);
-  }
-
-  // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
-  if (!tensor_utils::IsZeroVector(input_ptr, n_batch * n_input)) {
-    if (!use_cifg) {
-      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-          input_to_input_weights_ptr, n_cell, n_input, input_ptr, n_batch,
-          input_gate_scratch);
-    }
-
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_forget_weights_ptr, n_cell, n_input, input_ptr, n_batch,
-        forget_gate_scratch);
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_cell_weights_ptr, n_cell, n_input, input_ptr, n_batch,
-        cell_gate_scratch);
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        input_to_output_weights_ptr, n_cell, n_input, input_ptr, n_batch,
-        output_gate_scratch);
-  }
-
-  // For each batch and cell: compute aux_input_weight * aux_input.
-  // Skip if auxiliary input is not available or all zeros.
-  if (aux_input_ptr != nullptr &&
-      !tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input)) {
-    if (!use_cifg) {
-      tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-          aux_input_to_input_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
-          n_batch, input_gate_scratch);
-    }
-
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        aux_input_to_forget_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
-        n_batch, forget_gate_scratch);
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        aux_input_to_cell_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
-        n_batch, cell_gate_scratch);
-    tensor_utils::MatrixBatchVectorMultiplyAccumulate(
-        aux_input_to_output_weights_ptr, n_cell, n_aux_input, aux_input_ptr,
-        n_batch, output_gate_scratch);
+  if (!input_gates_precomputed) {
+    InitializeGatesFloat(
+        input_ptr, input_to_input_weights_ptr, input_to_forget_weights_ptr,
+        input_to_cell_weights_ptr, input_to_output_weights_ptr, aux_input_ptr,
+        aux_input_to_input_weights_ptr, aux_input_to_forget_weights_ptr,
+        aux_input_to_cell_weights_ptr, aux_input_to_output_weights_ptr,
+        input_gate_bias_ptr, forget_gate_bias_ptr, cell_gate_bias_ptr,
+        output_gate_bias_ptr, use_cifg, use_layer_norm, n_batch, n_cell,
+        n_input, n_aux_input, input_gate_scratch, forget_gate_scratch,
+        cell_gate_scratch, output_gate_scratch);
   }
 
   // For each batch and cell: compute recurrent_weight * output_state.
@@ -1708,6 +1746,17 @@ TfLiteStatus EvalFloat(
   // check the existence of only one to the get the condition.
   const bool use_cifg = (input_to_input_weights == nullptr);
 
+  // If the scratch buffer can hold the gates of all the steps of a time-major
+  // sequence, the input contributions to the gates, which do not depend on the
+  // state, are computed for the whole sequence at once.
+  const int n_gates = use_cifg ? 3 : 4;
+  const bool precompute_input_gates =
+      time_major && max_time > 1 && aux_input == nullptr &&
+      scratch_buffer->bytes >=
+          sizeof(float) * n_gates * max_time * n_batch * n_cell;
+  const int gate_scratch_size =
+      precompute_input_gates ? max_time * n_batch * n_cell : n_batch * n_cell;
+
   // Index the scratch buffers pointers to the global scratch buffer.
   float* scratch_buffer_ptr = GetTensorData<float>(scratch_buffer);
   float* input_gate_scratch = nullptr;
@@ -1716,18 +1765,39 @@ TfLiteStatus EvalFloat(
   float* output_gate_scratch = nullptr;
   if (use_cifg) {
     cell_gate_scratch = scratch_buffer_ptr;
-    forget_gate_scratch = scratch_buffer_ptr + n_cell * n_batch;
-    output_gate_scratch = scratch_buffer_ptr + 2 * n_cell * n_batch;
+    forget_gate_scratch = scratch_buffer_ptr + gate_scratch_size;
+    output_gate_scratch = scratch_buffer_ptr + 2 * gate_scratch_size;
   } else {
     input_gate_scratch = scratch_buffer_ptr;
-    cell_gate_scratch = scratch_buffer_ptr + n_cell * n_batch;
-    forget_gate_scratch = scratch_buffer_ptr + 2 * n_cell * n_batch;
-    output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
+    cell_gate_scratch = scratch_buffer_ptr + gate_scratch_size;
+    forget_gate_scratch = scratch_buffer_ptr + 2 * gate_scratch_size;
+    output_gate_scratch = scratch_buffer_ptr + 3 * gate_scratch_size;
   }
 
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
+    if (precompute_input_gates) {
+      const bool use_layer_norm = (forget_layer_norm_coefficients != nullptr);
+      InitializeGatesFloat(
+          GetTensorData<float>(input),
+          GetTensorData<float>(input_to_input_weights),
+          GetTensorData<float>(input_to_forget_weights),
+          GetTensorData<float>(input_to_cell_weights),
+          GetTensorData<float>(input_to_output_weights),
+          /*aux_input_ptr=*/nullptr, /*aux_input_to_input_weights_ptr=*/nullptr,
+          /*aux_input_to_forget_weights_ptr=*/nullptr,
+          /*aux_input_to_cell_weights_ptr=*/nullptr,
+          /*aux_input_to_output_weights_ptr=*/nullptr,
+          GetTensorData<float>(input_gate_bias),
+          GetTensorData<float>(forget_gate_bias),
+          GetTensorData<float>(cell_gate_bias),
+          GetTensorData<float>(output_gate_bias), use_cifg, use_layer_norm,
+          /*n_batch=*/max_time * n_batch, n_cell, n_input,
+          /*n_aux_input=*/0, input_gate_scratch, forget_gate_scratch,
+          cell_gate_scratch, output_gate_scratch);
+    }
+
     // Loop through the sequence.
     const int input_step = n_batch * n_input;
     const int output_step = n_batch * output_batch_leading_dim;
@@ -1742,6 +1812,9 @@ TfLiteStatus EvalFloat(
       }
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
+      // Each step uses its own slice of the precomputed gates.
+      const int gate_offset =
+          precompute_input_gates ? t_rel * n_batch * n_cell : 0;
 
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
@@ -1771,8 +1844,10 @@ TfLiteStatus EvalFloat(
           GetTensorData<float>(projection_bias), params, n_batch, n_cell,
           n_input, aux_input_size, n_output, output_batch_leading_dim,
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
-          input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
-          output_gate_scratch, output_ptr);
+          input_gate_scratch ? input_gate_scratch + gate_offset : nullptr,
+          forget_gate_scratch + gate_offset, cell_gate_scratch + gate_offset,
+          output_gate_scratch + gate_offset, output_ptr,
+          precompute_input_gates);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -1833,7 +1908,8 @@ TfLiteStatus EvalFloat(
             n_cell, n_input, aux_input_size, n_output, output_batch_leading_dim,
             output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
-            output_gate_scratch_ptr, output_ptr);
+            output_gate_scratch_ptr, output_ptr,
+            /*input_gates_precomputed=*/false);
       }
     }
   }
@@ -357,6 +357,11 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   const bool use_cifg = (input_to_input_weights == nullptr);
   TfLiteIntArray* scratch_buffer_size = TfLiteIntArrayCreate(2);
   scratch_buffer_size->data[0] = n_batch;
+  if (time_major && !IsHybridOp(input, input_to_output_weights)) {
+    // Reserve the gates of all the time steps so that lstm_eval::EvalFloat
+    // can compute their input contributions for the whole sequence at once.
+    scratch_buffer_size->data[0] = n_batch * input->dims->data[0];
+  }
   if (use_cifg) {
     // Reserving space for Cell, Forget, Output gates
     scratch_buffer_size->data[1] = n_cell * 3;
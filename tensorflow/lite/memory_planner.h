@@ -59,6 +59,11 @@ class MemoryPlanner {
 
   // Returns true if the non-persistent memory is available.
   virtual bool HasNonPersistentMemory() = 0;
+
+  // Returns true if the non-persistent memory is shared with other planners
+  // and has moved since the tensors were last pointed into it, in which case
+  // AcquireNonPersistentMemory() must be called before the tensors are used.
+  virtual bool NonPersistentMemoryMoved() = 0;
 };
 
 }  // namespace tflite
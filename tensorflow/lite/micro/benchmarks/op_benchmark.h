@@ -0,0 +1,90 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_BENCHMARKS_OP_BENCHMARK_H_
+#define TENSORFLOW_LITE_MICRO_BENCHMARKS_OP_BENCHMARK_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/micro/micro_time.h"
+#include "tensorflow/lite/micro/testing/test_utils.h"
+
+namespace tflite {
+namespace testing {
+
+// Runs the op of `registration` on `tensors`, with the node inputs and outputs
+// given as {N, Element 1, ... Element N} arrays of tensor indices. One warm-up
+// invoke is followed by `num_runs` timed ones, and the average number of ticks
+// per invoke is returned in `ticks_per_run`.
+inline TfLiteStatus BenchmarkOp(const TfLiteRegistration* registration,
+                                TfLiteTensor* tensors, int tensors_size,
+                                const int* inputs_array_data,
+                                const int* outputs_array_data,
+                                void* builtin_data, int num_runs,
+                                ErrorReporter* reporter,
+                                int32_t* ticks_per_run) {
+  TfLiteContext context;
+  PopulateContext(tensors, tensors_size, reporter, &context);
+
+  // Init data size is always 0 for builtin ops.
+  void* user_data = nullptr;
+  if (registration->init) {
+    user_data = registration->init(
+        &context, reinterpret_cast<const char*>(builtin_data), 0);
+  }
+
+  TfLiteNode node;
+  node.inputs = IntArrayFromInts(inputs_array_data);
+  node.outputs = IntArrayFromInts(outputs_array_data);
+  node.user_data = user_data;
+  node.builtin_data = builtin_data;
+  node.custom_initial_data = nullptr;
+  node.custom_initial_data_size = 0;
+
+  TfLiteStatus status = kTfLiteOk;
+  if (registration->prepare) {
+    status = registration->prepare(&context, &node);
+  }
+  if (status == kTfLiteOk) {
+    status = registration->invoke(&context, &node);
+  }
+  if (status == kTfLiteOk) {
+    const int32_t start = GetCurrentTimeTicks();
+    for (int i = 0; i < num_runs && status == kTfLiteOk; ++i) {
+      status = registration->invoke(&context, &node);
+    }
+    *ticks_per_run = (GetCurrentTimeTicks() - start) / num_runs;
+  }
+
+  if (registration->free) {
+    registration->free(&context, user_data);
+  }
+  return status;
+}
+
+// Logs the result of BenchmarkOp() in the format read by select_kernels.py:
+//   OP_BENCHMARK <op> <shape> <ticks per invoke>
+inline void ReportOpBenchmark(ErrorReporter* reporter, const char* op,
+                              const char* shape, int32_t ticks_per_run) {
+  TF_LITE_REPORT_ERROR(reporter, "OP_BENCHMARK %s %s %d", op, shape,
+                       ticks_per_run);
+}
+
+}  // namespace testing
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_BENCHMARKS_OP_BENCHMARK_H_
@@ -0,0 +1,181 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Times the int8 kernels linked into this build on a range of shapes, so that
+// builds with different TAGS, e.g. with and without cmsis-nn, can be compared
+// per op and shape by select_kernels.py.
+
+#include <cstdint>
+
+#include "tensorflow/lite/c/builtin_op_data.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/micro/benchmarks/op_benchmark.h"
+#include "tensorflow/lite/micro/kernels/micro_ops.h"
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/test_utils.h"
+
+namespace tflite {
+namespace testing {
+namespace {
+
+constexpr int kNumRuns = 10;
+constexpr int kMaxElements = 16 * 16 * 16;
+constexpr int kMaxWeights = 256 * 128;
+
+int8_t input_data[kMaxElements];
+int8_t input2_data[kMaxElements];
+int8_t weights_data[kMaxWeights];
+int32_t bias_data[256];
+int8_t output_data[kMaxElements];
+
+void FillInputs() {
+  for (int i = 0; i < kMaxElements; ++i) {
+    input_data[i] = static_cast<int8_t>((i * 7) % 256 - 128);
+    input2_data[i] = static_cast<int8_t>((i * 13) % 256 - 128);
+  }
+  for (int i = 0; i < kMaxWeights; ++i) {
+    weights_data[i] = static_cast<int8_t>((i * 25) % 256 - 128);
+  }
+  for (int i = 0; i < 256; ++i) {
+    bias_data[i] = i * 16 - 2048;
+  }
+}
+
+void BenchmarkFullyConnected(int batches, int input_depth, int output_depth,
+                             const char* shape, ErrorReporter* reporter) {
+  const int input_shape[] = {2, batches, input_depth};
+  const int weights_shape[] = {2, output_depth, input_depth};
+  const int bias_shape[] = {1, output_depth};
+  const int output_shape[] = {2, batches, output_depth};
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape), 0.5f,
+                            0),
+      CreateQuantizedTensor(weights_data, IntArrayFromInts(weights_shape),
+                            0.5f, 0),
+      CreateQuantized32Tensor(bias_data, IntArrayFromInts(bias_shape), 0.25f),
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape), 64.0f,
+                            0),
+  };
+  TfLiteFullyConnectedParams params = {};
+  params.activation = kTfLiteActNone;
+  params.weights_format = kTfLiteFullyConnectedWeightsFormatDefault;
+  const int inputs[] = {3, 0, 1, 2};
+  const int outputs[] = {1, 3};
+
+  int32_t ticks = 0;
+  if (BenchmarkOp(ops::micro::Register_FULLY_CONNECTED(), tensors, 4, inputs,
+                  outputs, &params, kNumRuns, reporter,
+                  &ticks) == kTfLiteOk) {
+    ReportOpBenchmark(reporter, "FULLY_CONNECTED", shape, ticks);
+  }
+}
+
+void BenchmarkAdd(int height, int width, int depth, const char* shape,
+                  ErrorReporter* reporter) {
+  const int tensor_shape[] = {4, 1, height, width, depth};
+  TfLiteIntArray* dims = IntArrayFromInts(tensor_shape);
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, dims, 0.5f, -10),
+      CreateQuantizedTensor(input2_data, dims, 0.25f, 5),
+      CreateQuantizedTensor(output_data, dims, 1.0f, 0),
+  };
+  TfLiteAddParams params = {};
+  params.activation = kTfLiteActNone;
+  const int inputs[] = {2, 0, 1};
+  const int outputs[] = {1, 2};
+
+  int32_t ticks = 0;
+  if (BenchmarkOp(ops::micro::Register_ADD(), tensors, 3, inputs, outputs,
+                  &params, kNumRuns, reporter, &ticks) == kTfLiteOk) {
+    ReportOpBenchmark(reporter, "ADD", shape, ticks);
+  }
+}
+
+void BenchmarkSoftmax(int batches, int depth, const char* shape,
+                      ErrorReporter* reporter) {
+  const int tensor_shape[] = {2, batches, depth};
+  TfLiteIntArray* dims = IntArrayFromInts(tensor_shape);
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, dims, 0.1f, 0),
+      CreateQuantizedTensor(output_data, dims, 1.0f / 256, -128),
+  };
+  TfLiteSoftmaxParams params = {};
+  params.beta = 1.0f;
+  const int inputs[] = {1, 0};
+  const int outputs[] = {1, 1};
+
+  int32_t ticks = 0;
+  if (BenchmarkOp(ops::micro::Register_SOFTMAX(), tensors, 2, inputs, outputs,
+                  &params, kNumRuns, reporter, &ticks) == kTfLiteOk) {
+    ReportOpBenchmark(reporter, "SOFTMAX", shape, ticks);
+  }
+}
+
+void BenchmarkPool(TfLiteRegistration* registration, const char* op,
+                   int height, int width, int depth, int filter_size,
+                   const char* shape, ErrorReporter* reporter) {
+  const int input_shape[] = {4, 1, height, width, depth};
+  const int output_shape[] = {4, 1, height / filter_size, width / filter_size,
+                              depth};
+  TfLiteTensor tensors[] = {
+      CreateQuantizedTensor(input_data, IntArrayFromInts(input_shape), 0.5f,
+                            0),
+      CreateQuantizedTensor(output_data, IntArrayFromInts(output_shape), 0.5f,
+                            0),
+  };
+  TfLitePoolParams params = {};
+  params.padding = kTfLitePaddingValid;
+  params.stride_width = filter_size;
+  params.stride_height = filter_size;
+  params.filter_width = filter_size;
+  params.filter_height = filter_size;
+  params.activation = kTfLiteActNone;
+  const int inputs[] = {1, 0};
+  const int outputs[] = {1, 1};
+
+  int32_t ticks = 0;
+  if (BenchmarkOp(registration, tensors, 2, inputs, outputs, &params, kNumRuns,
+                  reporter, &ticks) == kTfLiteOk) {
+    ReportOpBenchmark(reporter, op, shape, ticks);
+  }
+}
+
+}  // namespace
+}  // namespace testing
+}  // namespace tflite
+
+int main() {
+  tflite::MicroErrorReporter reporter;
+  tflite::testing::FillInputs();
+
+  tflite::testing::BenchmarkFullyConnected(1, 64, 32, "1x64x32", &reporter);
+  tflite::testing::BenchmarkFullyConnected(1, 256, 128, "1x256x128",
+                                           &reporter);
+  tflite::testing::BenchmarkFullyConnected(8, 32, 10, "8x32x10", &reporter);
+
+  tflite::testing::BenchmarkAdd(4, 4, 8, "1x4x4x8", &reporter);
+  tflite::testing::BenchmarkAdd(16, 16, 16, "1x16x16x16", &reporter);
+
+  tflite::testing::BenchmarkSoftmax(1, 10, "1x10", &reporter);
+  tflite::testing::BenchmarkSoftmax(4, 1000, "4x1000", &reporter);
+
+  tflite::testing::BenchmarkPool(
+      tflite::ops::micro::Register_AVERAGE_POOL_2D(), "AVERAGE_POOL_2D", 16,
+      16, 16, 2, "1x16x16x16/2", &reporter);
+  tflite::testing::BenchmarkPool(tflite::ops::micro::Register_MAX_POOL_2D(),
+                                 "MAX_POOL_2D", 16, 16, 16, 2, "1x16x16x16/2",
+                                 &reporter);
+  return 0;
+}
@@ -0,0 +1,122 @@
+# Lint as: python2, python3
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Picks the fastest kernel variant of each op from op suite benchmark logs.
+
+Each log comes from a run of op_suite_benchmark built with the tag of one
+kernel variant, e.g. cmsis-nn, or with no tag for the reference kernels. The
+ticks of all the shapes of an op are summed per variant, and the specialized
+kernels of the variants that are not the fastest are printed, for use as
+EXCLUDED_SPECIALIZATIONS in the Makefile build.
+
+Example usage:
+python select_kernels.py --log=reference:reference.log \\
+  --log=cmsis-nn:cmsis-nn.log
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import collections
+import re
+import sys
+
+KERNELS_DIR = 'tensorflow/lite/micro/kernels/'
+
+# The name of the untagged variant.
+REFERENCE_VARIANT = 'reference'
+
+# Source file of the kernel of each benchmarked op.
+OP_KERNEL_FILES = {
+    'ADD': 'add.cc',
+    'AVERAGE_POOL_2D': 'pooling.cc',
+    'CONV_2D': 'conv.cc',
+    'DEPTHWISE_CONV_2D': 'depthwise_conv.cc',
+    'FULLY_CONNECTED': 'fully_connected.cc',
+    'MAX_POOL_2D': 'pooling.cc',
+    'MUL': 'mul.cc',
+    'SOFTMAX': 'softmax.cc',
+}
+
+_BENCHMARK_LINE = re.compile(r'OP_BENCHMARK (\S+) (\S+) (-?\d+)')
+
+
+def parse_log(log_text):
+  """Returns a dict of (op, shape) to the ticks logged for it."""
+  results = {}
+  for line in log_text.splitlines():
+    match = _BENCHMARK_LINE.search(line)
+    if match:
+      results[(match.group(1), match.group(2))] = int(match.group(3))
+  return results
+
+
+def select_kernels(variant_results):
+  """Picks the fastest variant of each kernel source file.
+
+  Args:
+    variant_results: A dict of variant name to the parse_log() results of its
+      benchmark run.
+
+  Returns:
+    The sorted paths of the specialized kernel sources to exclude.
+  """
+  # Only shapes measured for all variants are compared.
+  common_keys = None
+  for results in variant_results.values():
+    keys = set(results.keys())
+    common_keys = keys if common_keys is None else common_keys & keys
+
+  ticks_per_file = collections.defaultdict(
+      lambda: collections.defaultdict(int))
+  for variant, results in variant_results.items():
+    for op, shape in common_keys or []:
+      kernel_file = OP_KERNEL_FILES.get(op)
+      if kernel_file:
+        ticks_per_file[kernel_file][variant] += results[(op, shape)]
+
+  excluded = []
+  for kernel_file, variant_ticks in ticks_per_file.items():
+    fastest = min(sorted(variant_ticks), key=lambda v: variant_ticks[v])
+    for variant in variant_ticks:
+      if variant != fastest and variant != REFERENCE_VARIANT:
+        excluded.append(KERNELS_DIR + variant + '/' + kernel_file)
+  return sorted(excluded)
+
+
+def main():
+  parser = argparse.ArgumentParser(
+      description='Picks the fastest kernel variant of each op.')
+  parser.add_argument(
+      '--log',
+      action='append',
+      required=True,
+      help='<variant>:<path> of the op_suite_benchmark log of a variant, '
+      'where the variant is the tag of the kernel directory or "%s".' %
+      REFERENCE_VARIANT)
+  flags = parser.parse_args()
+
+  variant_results = {}
+  for log in flags.log:
+    variant, _, path = log.partition(':')
+    with open(path) as log_file:
+      variant_results[variant] = parse_log(log_file.read())
+  print(' '.join(select_kernels(variant_results)))
+
+
+if __name__ == '__main__':
+  sys.exit(main())
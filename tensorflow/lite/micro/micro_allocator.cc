@@ -370,6 +370,50 @@ TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
   return kTfLiteOk;
 }
 
+// Returns true if the offsets of all the buffers that need allocating were
+// planned offline, so that no memory planner has to run on the device.
+bool IsFullyOfflinePlanned(const AllocationInfo* allocation_info,
+                           size_t allocation_info_size) {
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating &&
+        current->offline_offset == kOnlinePlannedBuffer) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the arena size spanned by the offline planned buffers.
+size_t GetOfflinePlanSize(const AllocationInfo* allocation_info,
+                          size_t allocation_info_size) {
+  size_t plan_size = 0;
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating) {
+      const size_t buffer_end = current->offline_offset +
+                                AlignSizeUp(current->bytes, kBufferAlignment);
+      if (buffer_end > plan_size) {
+        plan_size = buffer_end;
+      }
+    }
+  }
+  return plan_size;
+}
+
+// Sets the buffer pointers from the offline planned offsets.
+void CommitOfflinePlan(uint8_t* starting_point,
+                       const AllocationInfo* allocation_info,
+                       size_t allocation_info_size) {
+  for (size_t i = 0; i < allocation_info_size; ++i) {
+    const AllocationInfo* current = &allocation_info[i];
+    if (current->needs_allocating) {
+      *current->output_ptr =
+          reinterpret_cast<void*>(starting_point + current->offline_offset);
+    }
+  }
+}
+
 TfLiteStatus CommitPlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
                         uint8_t* starting_point,
                         const AllocationInfo* allocation_info,
@@ -894,6 +938,7 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(const Model* model,
   // 4. Set tensor/buffer pointers based on the offsets from the previous step.
   // Note that AllocationInfo is only needed for creating the plan. It will be
   // thrown away when the child allocator (tmp_allocator) goes out of scope.
+  // Steps 2 and 3 are skipped when the converter planned all the offsets.
   {
     SimpleMemoryAllocator tmp_allocator(error_reporter_,
                                         memory_allocator_->GetHead(),
@@ -912,6 +957,25 @@ TfLiteStatus MicroAllocator::CommitStaticMemoryPlan(const Model* model,
     TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_));
     const AllocationInfo* allocation_info = builder.Finish();
 
+    if (IsFullyOfflinePlanned(allocation_info, builder.Size())) {
+      const size_t plan_size =
+          GetOfflinePlanSize(allocation_info, builder.Size());
+      if (plan_size > memory_allocator_->GetAvailableMemory()) {
+        TF_LITE_REPORT_ERROR(
+            error_reporter_,
+            "Arena size is too small for activation buffers. Needed %d but "
+            "only %d was available.",
+            plan_size, memory_allocator_->GetAvailableMemory());
+        return kTfLiteError;
+      }
+      CommitOfflinePlan(memory_allocator_->GetHead(), allocation_info,
+                        builder.Size());
+      TF_LITE_ENSURE(error_reporter_,
+                     memory_allocator_->AllocateFromHead(
+                         plan_size, /*alignment=*/1) != nullptr);
+      return kTfLiteOk;
+    }
+
     // Remaining arena size that memory planner can use for calculating offsets.
     size_t remaining_arena_size = tmp_allocator.GetAvailableMemory();
     uint8_t* planner_arena =
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 
 #include <fcntl.h>
+#include <stdint.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -57,6 +58,22 @@ size_t MMAPAllocation::bytes() const { return buffer_size_bytes_; }
 
 bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
+void MMAPAllocation::Advise(const void* ptr, size_t bytes,
+                            Advice advice) const {
+  if (!valid() || bytes == 0) return;
+  const uintptr_t base = reinterpret_cast<uintptr_t>(mmapped_buffer_);
+  uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  const uintptr_t end = begin + bytes;
+  if (begin < base || end > base + buffer_size_bytes_) return;
+  // madvise() wants a page aligned start, which stays inside the mapping
+  // since it starts on a page boundary. The pages shared with neighbouring
+  // data are only ever re-read from the file.
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  begin &= ~(page_size - 1);
+  madvise(reinterpret_cast<void*>(begin), end - begin,
+          advice == Advice::kWillNeed ? MADV_WILLNEED : MADV_DONTNEED);
+}
+
 bool MMAPAllocation::IsSupported() { return true; }
 
 }  // namespace tflite
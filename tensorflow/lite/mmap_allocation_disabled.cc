@@ -35,6 +35,9 @@ size_t MMAPAllocation::bytes() const { return 0; }
 
 bool MMAPAllocation::valid() const { return false; }
 
+void MMAPAllocation::Advise(const void* ptr, size_t bytes,
+                            Advice advice) const {}
+
 bool MMAPAllocation::IsSupported() { return false; }
 
 }  // namespace tflite
@@ -232,6 +232,33 @@ TEST(BasicFlatBufferModel, TestModelInInterpreter) {
   }
 }
 
+TEST(BasicFlatBufferModel, TestMmapWeightPaging) {
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/test_model.bin");
+  ASSERT_TRUE(model);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(
+      InterpreterBuilder(*model, TrivialResolver(&dummy_reg))(&interpreter),
+      kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+  const TfLiteTensor* weights = interpreter->tensor(0);
+  ASSERT_EQ(weights->allocation_type, kTfLiteMmapRo);
+  const std::vector<char> expected(weights->data.raw,
+                                   weights->data.raw + weights->bytes);
+
+  // Dropped pages are read back from the file, so the weights stay intact.
+  interpreter->SetMmapWeightPaging(true);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(std::vector<char>(weights->data.raw,
+                              weights->data.raw + weights->bytes),
+            expected);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  EXPECT_EQ(std::vector<char>(weights->data.raw,
+                              weights->data.raw + weights->bytes),
+            expected);
+}
+
 // Test that loading a model with TensorFlow ops fails when the flex delegate is
 // not linked into the target.
 TEST(FlexModel, FailureWithoutFlexDelegate) {
@@ -31,6 +31,24 @@ T AlignTo(size_t alignment, T offset) {
 }  // namespace
 
 namespace tflite {
+void SharedMemoryArena::Reserve(size_t size) {
+  if (size <= underlying_buffer_size_) {
+    return;
+  }
+  char* new_alloc = new char[size + arena_alignment_];
+  char* new_underlying_buffer_aligned_ptr = reinterpret_cast<char*>(
+      AlignTo(arena_alignment_, reinterpret_cast<intptr_t>(new_alloc)));
+  // The arena that grows the buffer may be in use, so keep its contents.
+  if (underlying_buffer_size_ > 0) {
+    memcpy(new_underlying_buffer_aligned_ptr, underlying_buffer_aligned_ptr_,
+           underlying_buffer_size_);
+  }
+  underlying_buffer_.reset(new_alloc);
+  underlying_buffer_size_ = size;
+  underlying_buffer_aligned_ptr_ = new_underlying_buffer_aligned_ptr;
+  ++generation_;
+}
+
 TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
@@ -105,6 +123,16 @@ TfLiteStatus SimpleMemoryArena::Deallocate(
 }
 
 TfLiteStatus SimpleMemoryArena::Commit(TfLiteContext* context) {
+  if (shared_arena_ != nullptr) {
+    TF_LITE_ENSURE(context,
+                   shared_arena_->arena_alignment() % arena_alignment_ == 0);
+    shared_arena_->Reserve(RequiredBufferSize());
+    underlying_buffer_size_ = shared_arena_->GetBufferSize();
+    underlying_buffer_aligned_ptr_ = shared_arena_->AlignedPointer();
+    committed_generation_ = shared_arena_->generation();
+    committed_ = true;
+    return kTfLiteOk;
+  }
   size_t required_size = RequiredBufferSize();
   if (required_size > underlying_buffer_size_) {
     char* new_alloc = new char[required_size];
@@ -153,10 +181,18 @@ TfLiteStatus SimpleMemoryArena::ClearPlan() {
   return kTfLiteOk;
 }
 
+TfLiteStatus SimpleMemoryArena::RestorePlan(const Plan& plan) {
+  committed_ = false;
+  high_water_mark_ = plan.high_water_mark;
+  ordered_allocs_ = plan.ordered_allocs;
+  return kTfLiteOk;
+}
+
 TfLiteStatus SimpleMemoryArena::ReleaseBuffer() {
   committed_ = false;
   underlying_buffer_size_ = 0;
   underlying_buffer_aligned_ptr_ = nullptr;
+  // A shared buffer stays with the SharedMemoryArena.
   underlying_buffer_.reset();
   return kTfLiteOk;
 }
@@ -52,19 +52,65 @@ struct ArenaAllocWithUsageInterval {
   }
 };
 
+// An underlying buffer that the non-persistent arenas of several interpreters
+// can share when they are never invoked at the same time, e.g. models that run
+// one after the other in a pipeline, instead of each arena holding a buffer
+// sized for its own peak. The buffer only ever grows, to the largest size that
+// an arena requires, keeping its contents, and it is only released when this
+// object is destroyed. Every time the buffer moves its generation changes, so
+// that the other arenas know to resolve their allocations again.
+class SharedMemoryArena {
+ public:
+  // `arena_alignment` must be a multiple of the alignment of every arena that
+  // shares the buffer; the default is that of the arenas of ArenaPlanner.
+  explicit SharedMemoryArena(size_t arena_alignment = 64)
+      : arena_alignment_(arena_alignment),
+        underlying_buffer_size_(0),
+        underlying_buffer_aligned_ptr_(nullptr),
+        generation_(0) {}
+  SharedMemoryArena(const SharedMemoryArena&) = delete;
+  SharedMemoryArena& operator=(const SharedMemoryArena&) = delete;
+
+  // Grows the buffer to at least `size` bytes past the aligned pointer.
+  void Reserve(size_t size);
+
+  size_t arena_alignment() const { return arena_alignment_; }
+  size_t GetBufferSize() const { return underlying_buffer_size_; }
+  char* AlignedPointer() const { return underlying_buffer_aligned_ptr_; }
+  int64_t generation() const { return generation_; }
+
+ private:
+  const size_t arena_alignment_;
+  std::unique_ptr<char[]> underlying_buffer_;
+  size_t underlying_buffer_size_;
+  char* underlying_buffer_aligned_ptr_;
+  int64_t generation_;
+};
+
 // This small class is responsible for allocating, deallocating and reusing
 // dynamic memory from a common underlying buffer. The arena can be used in
 // scenarios when the pattern of memory allocations and deallocations is
 // repetitive, e.g. running NN inference in multiple iterations. Note that
 // zero-sized allocations are explicitly allowed, and will resolve to null.
+// If `shared_arena` is not null, the arena commits into its buffer instead of
+// one of its own.
 class SimpleMemoryArena {
  public:
-  explicit SimpleMemoryArena(size_t arena_alignment)
+  // The allocations that have been scheduled in the arena.
+  struct Plan {
+    size_t high_water_mark = 0;
+    std::vector<ArenaAllocWithUsageInterval> ordered_allocs;
+  };
+
+  explicit SimpleMemoryArena(size_t arena_alignment,
+                             SharedMemoryArena* shared_arena = nullptr)
       : committed_(false),
         arena_alignment_(arena_alignment),
         high_water_mark_(0),
         underlying_buffer_size_(0),
-        ordered_allocs_() {}
+        ordered_allocs_(),
+        shared_arena_(shared_arena),
+        committed_generation_(0) {}
 
   // Schedule memory allocation for a tensor with a given size, assuming that it
   // needs to be allocated before the execution of first_node, and deallocated
@@ -94,6 +140,13 @@ class SimpleMemoryArena {
   // again.
   TfLiteStatus ClearPlan();
 
+  Plan GetPlan() const { return {high_water_mark_, ordered_allocs_}; }
+
+  // This replaces the allocation details with those of `plan`, e.g. one saved
+  // by GetPlan() before a ClearPlan(), but does not release the underlying
+  // buffer. The arena must be committed & resolved before it is used again.
+  TfLiteStatus RestorePlan(const Plan& plan);
+
   // This releases the underlying buffer but does not clear the allocation plan.
   // Since all associated pointers are invalidated, the arena cannot be used
   // again until Commit() is called & tensor allocations are resolved.
@@ -101,6 +154,14 @@ class SimpleMemoryArena {
 
   size_t GetBufferSize() { return underlying_buffer_size_; }
 
+  // Returns true if the arena commits into a shared buffer that has moved
+  // since the last Commit(), which must be called, and the allocations
+  // resolved, again before the arena is used.
+  bool SharedBufferMoved() const {
+    return shared_arena_ != nullptr && underlying_buffer_size_ != 0 &&
+           committed_generation_ != shared_arena_->generation();
+  }
+
   std::intptr_t BasePointer() const {
     return reinterpret_cast<std::intptr_t>(underlying_buffer_aligned_ptr_);
   }
@@ -113,6 +174,8 @@ class SimpleMemoryArena {
   size_t underlying_buffer_size_;
   char* underlying_buffer_aligned_ptr_;
   std::vector<ArenaAllocWithUsageInterval> ordered_allocs_;
+  SharedMemoryArena* const shared_arena_;
+  int64_t committed_generation_;
 };
 
 }  // namespace tflite
@@ -157,6 +157,48 @@ TEST(SimpleMemoryArenaTest, TestClearBuffer) {
   EXPECT_NE(resolved_ptr, nullptr);
 }
 
+TEST(SimpleMemoryArenaTest, TestSharedArena) {
+  TfLiteContext context;
+  context.ReportError = ReportError;
+  SharedMemoryArena shared_arena(64);
+  SimpleMemoryArena arena1(64, &shared_arena);
+  SimpleMemoryArena arena2(64, &shared_arena);
+  ArenaAllocWithUsageInterval allocs[3];
+
+  arena1.Allocate(&context, 32, 2047, 0, 0, 2, &allocs[0]);
+  ASSERT_EQ(arena1.Commit(&context), kTfLiteOk);
+  char* resolved_ptr = nullptr;
+  ASSERT_EQ(arena1.ResolveAlloc(&context, allocs[0], &resolved_ptr),
+            kTfLiteOk);
+  resolved_ptr[0] = 42;
+
+  // A smaller arena reuses the buffer.
+  arena2.Allocate(&context, 32, 1023, 0, 0, 2, &allocs[1]);
+  ASSERT_EQ(arena2.Commit(&context), kTfLiteOk);
+  EXPECT_EQ(arena2.BasePointer(), arena1.BasePointer());
+  EXPECT_FALSE(arena1.SharedBufferMoved());
+
+  // A larger one grows it, and the other arena has to commit again.
+  arena2.ClearPlan();
+  arena2.Allocate(&context, 32, 8191, 0, 0, 2, &allocs[2]);
+  ASSERT_EQ(arena2.Commit(&context), kTfLiteOk);
+  EXPECT_TRUE(arena1.SharedBufferMoved());
+  EXPECT_FALSE(arena2.SharedBufferMoved());
+  ASSERT_EQ(arena1.Commit(&context), kTfLiteOk);
+  EXPECT_FALSE(arena1.SharedBufferMoved());
+  EXPECT_EQ(arena1.BasePointer(), arena2.BasePointer());
+  ASSERT_EQ(arena1.ResolveAlloc(&context, allocs[0], &resolved_ptr),
+            kTfLiteOk);
+  EXPECT_EQ(resolved_ptr[0], 42);
+
+  // Releasing the buffer of an arena leaves the shared buffer alone.
+  ASSERT_EQ(arena1.ReleaseBuffer(), kTfLiteOk);
+  EXPECT_EQ(arena1.BasePointer(), 0);
+  EXPECT_NE(arena2.BasePointer(), 0);
+  EXPECT_EQ(reinterpret_cast<std::intptr_t>(shared_arena.AlignedPointer()),
+            arena2.BasePointer());
+}
+
 // Test parameterized by whether ClearBuffer() is called before ClearPlan(), or
 // vice versa.
 class BufferAndPlanClearingTest : public ::testing::Test,
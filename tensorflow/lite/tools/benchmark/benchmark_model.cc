@@ -44,6 +44,16 @@ BenchmarkParams BenchmarkModel::DefaultParams() {
 
 BenchmarkModel::BenchmarkModel() : params_(DefaultParams()) {}
 
+int64_t BenchmarkResults::inference_latency_percentile_us(
+    double percentile) const {
+  if (inference_latencies_us_.empty()) return 0;
+  // The nearest-rank percentile.
+  const size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * inference_latencies_us_.size()));
+  return inference_latencies_us_[std::min(
+      std::max<size_t>(rank, 1) - 1, inference_latencies_us_.size() - 1)];
+}
+
 void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   auto inference_us = results.inference_time_us();
   auto init_us = results.startup_latency_us();
@@ -55,6 +65,19 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                    << "First inference: " << warmup_us.first() << ", "
                    << "Warmup (avg): " << warmup_us.avg() << ", "
                    << "Inference (avg): " << inference_us.avg();
+  if (inference_us.count() > 0) {
+    TFLITE_LOG(INFO) << "Inference latency percentiles in us: "
+                     << "p50: " << results.inference_latency_percentile_us(50)
+                     << ", "
+                     << "p90: " << results.inference_latency_percentile_us(90)
+                     << ", "
+                     << "p99: " << results.inference_latency_percentile_us(99)
+                     << ", "
+                     << "p99.9: "
+                     << results.inference_latency_percentile_us(99.9);
+    TFLITE_LOG(INFO) << "Throughput: " << results.inferences_per_second()
+                     << " inferences per second";
+  }
 
   if (!init_mem_usage.IsSupported()) return;
   TFLITE_LOG(INFO)
@@ -142,6 +165,8 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
   int64_t max_finish_us = now_us + static_cast<int64_t>(max_secs * 1.e6f);
 
   *invoke_status = kTfLiteOk;
+  run_latencies_us_.clear();
+  const int64_t first_start_us = now_us;
   for (int run = 0; (run < min_num_times || now_us < min_finish_us) &&
                     now_us <= max_finish_us;
        run++) {
@@ -153,6 +178,7 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
     listeners_.OnSingleRunEnd();
 
     run_stats.UpdateStat(end_us - start_us);
+    run_latencies_us_.push_back(end_us - start_us);
     util::SleepForSeconds(params_.Get<float>("run_delay"));
     now_us = profiling::time::NowMicros();
 
@@ -160,6 +186,9 @@ Stat<int64_t> BenchmarkModel::Run(int min_num_times, float min_secs,
       *invoke_status = status;
     }
   }
+  runs_per_second_ = now_us > first_start_us
+                         ? run_stats.count() * 1e6 / (now_us - first_start_us)
+                         : 0.0;
 
   std::stringstream stream;
   run_stats.OutputToStream(&stream);
@@ -216,7 +245,8 @@ TfLiteStatus BenchmarkModel::Run() {
 
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
-                             overall_mem_usage});
+                             overall_mem_usage, run_latencies_us_,
+                             runs_per_second_});
   return status;
 }
 
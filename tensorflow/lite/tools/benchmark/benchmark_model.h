@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_MODEL_H_
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <limits>
@@ -46,14 +47,20 @@ class BenchmarkResults {
                    tensorflow::Stat<int64_t> warmup_time_us,
                    tensorflow::Stat<int64_t> inference_time_us,
                    const profiling::memory::MemoryUsage& init_mem_usage,
-                   const profiling::memory::MemoryUsage& overall_mem_usage)
+                   const profiling::memory::MemoryUsage& overall_mem_usage,
+                   std::vector<int64_t> inference_latencies_us = {},
+                   double inferences_per_second = 0.0)
       : model_size_mb_(model_size_mb),
         startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
         warmup_time_us_(warmup_time_us),
         inference_time_us_(inference_time_us),
         init_mem_usage_(init_mem_usage),
-        overall_mem_usage_(overall_mem_usage) {}
+        overall_mem_usage_(overall_mem_usage),
+        inference_latencies_us_(std::move(inference_latencies_us)),
+        inferences_per_second_(inferences_per_second) {
+    std::sort(inference_latencies_us_.begin(), inference_latencies_us_.end());
+  }
 
   const double model_size_mb() const { return model_size_mb_; }
   tensorflow::Stat<int64_t> inference_time_us() const {
@@ -75,6 +82,12 @@ class BenchmarkResults {
     return overall_mem_usage_;
   }
 
+  // Returns the latency in us that 'percentile' percent of the inference runs
+  // took at most, or 0 if there were no runs.
+  int64_t inference_latency_percentile_us(double percentile) const;
+  // The number of inference runs that completed per second.
+  double inferences_per_second() const { return inferences_per_second_; }
+
  private:
   double model_size_mb_ = 0.0;
   int64_t startup_latency_us_ = 0;
@@ -83,6 +96,9 @@ class BenchmarkResults {
   tensorflow::Stat<int64_t> inference_time_us_;
   profiling::memory::MemoryUsage init_mem_usage_;
   profiling::memory::MemoryUsage overall_mem_usage_;
+  // The latency of each inference run, in increasing order.
+  std::vector<int64_t> inference_latencies_us_;
+  double inferences_per_second_ = 0.0;
 };
 
 class BenchmarkListener {
@@ -214,6 +230,10 @@ class BenchmarkModel {
   virtual TfLiteStatus RunImpl() = 0;
   BenchmarkParams params_;
   BenchmarkListeners listeners_;
+  // The latency of each run of the last Run(min_num_times, ...), and the
+  // number of runs that it completed per second.
+  std::vector<int64_t> run_latencies_us_;
+  double runs_per_second_ = 0.0;
 };
 
 }  // namespace benchmark
@@ -19,6 +19,7 @@ limitations under the License.
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <utility>
 
 #include "tensorflow/core/util/stats_calculator.h"
@@ -91,13 +92,22 @@ void MultiRunStatsRecorder::OutputStats() {
   std::sort(results_.begin(), results_.end(), EachRunStatsEntryComparator());
 
   for (const auto& run_stats : results_) {
-    const auto perf_option_name = PerfOptionName(*run_stats.params);
+    auto perf_option_name = PerfOptionName(*run_stats.params);
+    const auto& params = *run_stats.params;
+    if (params.HasParam("batch_size") &&
+        params.Get<int32_t>("batch_size") > 0) {
+      perf_option_name +=
+          " batch " + std::to_string(params.Get<int32_t>("batch_size"));
+    }
     std::stringstream stream;
     stream << std::setw(26) << perf_option_name << ": ";
     if (!run_stats.completed) {
       stream << " failed!";
     } else {
       run_stats.metrics.inference_time_us().OutputToStream(&stream);
+      stream << " p50=" << run_stats.metrics.inference_latency_percentile_us(50)
+             << " p99=" << run_stats.metrics.inference_latency_percentile_us(99)
+             << " inferences/s=" << run_stats.metrics.inferences_per_second();
       // NOTE: As of 2019/11/07, the memory usage is collected in an
       // OS-process-wide way and this program performs multiple runs in a single
       // OS process, therefore, the memory usage information of each run becomes
@@ -131,6 +141,7 @@ BenchmarkParams BenchmarkPerformanceOptions::DefaultParams() {
                   BenchmarkParam::Create<float>(-1.0f));
   params.AddParam("random_shuffle_benchmark_runs",
                   BenchmarkParam::Create<bool>(true));
+  params.AddParam("batch_sizes", BenchmarkParam::Create<std::string>(""));
   return params;
 }
 
@@ -149,6 +160,11 @@ std::vector<Flag> BenchmarkPerformanceOptions::GetFlags() {
           "random_shuffle_benchmark_runs", &params_,
           "Whether to perform all benchmark runs, each of which has different "
           "performance options, in a random order. It is enabled by default."),
+      CreateFlag<std::string>(
+          "batch_sizes", &params_,
+          "A comma-separated list of batch sizes that each set of performance "
+          "options is benchmarked with, e.g. '1,8,32'. By default, the batch "
+          "size of the model is kept."),
   };
 }
 
@@ -164,7 +180,33 @@ bool BenchmarkPerformanceOptions::ParseFlags(int* argc, char** argv) {
 
   // Parse the value of --perf_options_list to find performance options to be
   // benchmarked.
-  return ParsePerfOptions();
+  return ParsePerfOptions() && ParseBatchSizes();
+}
+
+bool BenchmarkPerformanceOptions::ParseBatchSizes() {
+  batch_sizes_.clear();
+  const auto& batch_sizes = params_.Get<std::string>("batch_sizes");
+  if (batch_sizes.empty()) return true;
+  if (!util::SplitAndParse(batch_sizes, ',', &batch_sizes_)) {
+    TFLITE_LOG(ERROR) << "Cannot parse --batch_sizes: '" << batch_sizes
+                      << "'. Please double-check its value.";
+    batch_sizes_.clear();
+    return false;
+  }
+  for (const int batch_size : batch_sizes_) {
+    if (batch_size <= 0) {
+      TFLITE_LOG(ERROR) << "Batch sizes in --batch_sizes must be positive: '"
+                        << batch_sizes << "'";
+      batch_sizes_.clear();
+      return false;
+    }
+  }
+  if (!single_option_run_params_->HasParam("batch_size")) {
+    TFLITE_LOG(ERROR) << "--batch_sizes is not supported by this benchmark.";
+    batch_sizes_.clear();
+    return false;
+  }
+  return true;
 }
 
 bool BenchmarkPerformanceOptions::ParsePerfOptions() {
@@ -346,14 +388,23 @@ void BenchmarkPerformanceOptions::Run() {
       ResetPerformanceOptions();
       single_option_run_params_->Set(run_params);
     }
-    util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
+    // Each set of options is run once with the batch size of the model unless
+    // --batch_sizes is set.
+    const std::vector<int> batch_sizes =
+        batch_sizes_.empty() ? std::vector<int>{0} : batch_sizes_;
+    for (const int batch_size : batch_sizes) {
+      if (batch_size > 0) {
+        single_option_run_params_->Set<int32_t>("batch_size", batch_size);
+      }
+      util::SleepForSeconds(params_.Get<float>("option_benchmark_run_delay"));
 
-    // Clear internally created listeners before each run but keep externally
-    // created ones.
-    single_option_run_->RemoveListeners(num_external_listeners);
+      // Clear internally created listeners before each run but keep externally
+      // created ones.
+      single_option_run_->RemoveListeners(num_external_listeners);
 
-    all_run_stats_->MarkBenchmarkStart(*single_option_run_params_);
-    single_option_run_->Run();
+      all_run_stats_->MarkBenchmarkStart(*single_option_run_params_);
+      single_option_run_->Run();
+    }
   }
 
   all_run_stats_->OutputStats();
@@ -101,6 +101,7 @@ class BenchmarkPerformanceOptions {
   virtual std::vector<Flag> GetFlags();
 
   bool ParsePerfOptions();
+  bool ParseBatchSizes();
   virtual std::vector<std::string> GetValidPerfOptions() const;
   bool HasOption(const std::string& option) const;
 
@@ -109,6 +110,9 @@ class BenchmarkPerformanceOptions {
 
   BenchmarkParams params_;
   std::vector<std::string> perf_options_;
+  // The batch sizes that each set of performance options is benchmarked with.
+  // Empty if the batch size of the model is to be kept.
+  std::vector<int> batch_sizes_;
 
   // The object that drives a single-performance-option run.
   BenchmarkModel* const single_option_run_;          // Doesn't own the memory.
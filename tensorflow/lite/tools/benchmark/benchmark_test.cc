@@ -88,6 +88,9 @@ BenchmarkParams CreateParams(int32_t num_runs, float min_secs, float max_secs,
                   BenchmarkParam::Create<std::string>(""));
   params.AddParam("enable_platform_tracing",
                   BenchmarkParam::Create<bool>(false));
+  params.AddParam("num_interpreters", BenchmarkParam::Create<int32_t>(1));
+  params.AddParam("request_rate", BenchmarkParam::Create<float>(0.0f));
+  params.AddParam("batch_size", BenchmarkParam::Create<int32_t>(0));
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -425,6 +428,46 @@ TEST(BenchmarkTest, MaxDurationWorks) {
   benchmark.Run();
 }
 
+class LatencyPercentilesTestListener : public BenchmarkListener {
+  void OnBenchmarkEnd(const BenchmarkResults& results) override {
+    EXPECT_GE(results.inference_time_us().count(), 1);
+    EXPECT_LE(results.inference_latency_percentile_us(50),
+              results.inference_latency_percentile_us(99));
+    EXPECT_GT(results.inferences_per_second(), 0.0);
+  }
+};
+
+TEST(BenchmarkTest, RunWithMultipleInterpreters) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = CreateFp32Params();
+  params.Set<int32_t>("num_interpreters", 2);
+  TestBenchmark benchmark(std::move(params));
+  LatencyPercentilesTestListener listener;
+  benchmark.AddListener(&listener);
+  EXPECT_EQ(kTfLiteOk, benchmark.Run());
+}
+
+TEST(BenchmarkTest, RunWithRequestRate) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkParams params = CreateParams(2, 0.1f, 150.0f, ModelGraphType::FP32);
+  params.Set<int32_t>("num_interpreters", 2);
+  params.Set<float>("request_rate", 100.0f);
+  TestBenchmark benchmark(std::move(params));
+  LatencyPercentilesTestListener listener;
+  benchmark.AddListener(&listener);
+  EXPECT_EQ(kTfLiteOk, benchmark.Run());
+}
+
+TEST(BenchmarkTest, RunWithBatchSizes) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  TestBenchmark benchmark(CreateFp32Params());
+  ScopedCommandlineArgs scoped_argv(
+      {"--perf_options_list=cpu", "--batch_sizes=1,2"});
+  BenchmarkPerformanceOptions all_options_benchmark(
+      &benchmark, absl::make_unique<TestMultiRunStatsRecorder>());
+  all_options_benchmark.Run(scoped_argv.argc(), scoped_argv.argv());
+}
+
 TEST(BenchmarkTest, ParametersArePopulatedWhenInputShapeIsNotSpecified) {
   ASSERT_THAT(g_fp32_model_path, testing::NotNull());
 
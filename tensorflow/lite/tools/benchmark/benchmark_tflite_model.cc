@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <chrono>  // NOLINT(build/c++11)
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <random>
+#include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <vector>
 
@@ -36,6 +42,7 @@ limitations under the License.
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/profiling/platform_profiler.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
@@ -273,6 +280,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("enable_platform_tracing",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("num_interpreters",
+                          BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("request_rate", BenchmarkParam::Create<float>(0.0f));
+  default_params.AddParam("batch_size", BenchmarkParam::Create<int32_t>(0));
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -331,7 +342,21 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "prints to stdout."),
       CreateFlag<bool>("enable_platform_tracing", &params_,
                        "enable platform-wide tracing, only meaningful when "
-                       "--enable_op_profiling is set to true.")};
+                       "--enable_op_profiling is set to true."),
+      CreateFlag<int32_t>(
+          "num_interpreters", &params_,
+          "number of interpreters that run the model concurrently, each on a "
+          "thread of its own. Op profiling only covers the runs of the first "
+          "interpreter."),
+      CreateFlag<float>(
+          "request_rate", &params_,
+          "number of runs per second to start across all interpreters, "
+          "whether or not the previous runs have completed, in which case the "
+          "latency of a run includes the time it waits for an interpreter. 0 "
+          "means that each interpreter runs the model back to back."),
+      CreateFlag<int32_t>("batch_size", &params_,
+                          "if positive, the size of the first dimension of "
+                          "all non-string inputs")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -375,6 +400,12 @@ void BenchmarkTfLiteModel::LogParams() {
                    << "]";
   TFLITE_LOG(INFO) << "Enable platform-wide tracing: ["
                    << params_.Get<bool>("enable_platform_tracing") << "]";
+  TFLITE_LOG(INFO) << "Num interpreters: ["
+                   << params_.Get<int32_t>("num_interpreters") << "]";
+  TFLITE_LOG(INFO) << "Request rate (runs per second): ["
+                   << params_.Get<float>("request_rate") << "]";
+  TFLITE_LOG(INFO) << "Batch size: [" << params_.Get<int32_t>("batch_size")
+                   << "]";
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -388,6 +419,14 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
         << "Please specify the name of your TF Lite input file with --graph";
     return kTfLiteError;
   }
+  if (params_.Get<int32_t>("num_interpreters") < 1) {
+    TFLITE_LOG(ERROR) << "--num_interpreters must be at least 1";
+    return kTfLiteError;
+  }
+  if (params_.Get<float>("request_rate") < 0) {
+    TFLITE_LOG(ERROR) << "--request_rate must not be negative";
+    return kTfLiteError;
+  }
 
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
@@ -572,11 +611,19 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  ResetInputs(interpreter_.get());
+  for (auto& interpreter : extra_interpreters_) {
+    ResetInputs(interpreter.get());
+  }
+  return kTfLiteOk;
+}
+
+void BenchmarkTfLiteModel::ResetInputs(Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -594,7 +641,62 @@ TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
                   inputs_data_[j].bytes);
     }
   }
+}
 
+void BenchmarkTfLiteModel::ResizeInputs(Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
+  // Resize all non-string tensors.
+  for (int j = 0; j < inputs_.size(); ++j) {
+    const InputLayerInfo& input = inputs_[j];
+    int i = interpreter_inputs[j];
+    TfLiteTensor* t = interpreter->tensor(i);
+    if (t->type != kTfLiteString) {
+      interpreter->ResizeInputTensor(i, input.shape);
+    }
+  }
+
+  const int32_t batch_size = params_.Get<int32_t>("batch_size");
+  if (batch_size <= 0) return;
+  for (int i : interpreter_inputs) {
+    TfLiteTensor* t = interpreter->tensor(i);
+    if (t->type == kTfLiteString || t->dims->size == 0) continue;
+    std::vector<int> shape(t->dims->data, t->dims->data + t->dims->size);
+    shape[0] = batch_size;
+    interpreter->ResizeInputTensor(i, shape);
+  }
+}
+
+TfLiteStatus BenchmarkTfLiteModel::InitExtraInterpreters() {
+  const int32_t num_interpreters = params_.Get<int32_t>("num_interpreters");
+  const int32_t num_threads = params_.Get<int32_t>("num_threads");
+  auto resolver = GetOpResolver();
+  for (int n = 1; n < num_interpreters; ++n) {
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    tflite::InterpreterBuilder(*model_, *resolver)(&interpreter, num_threads);
+    if (!interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to initialize interpreter #" << n;
+      return kTfLiteError;
+    }
+    interpreter->UseNNAPI(params_.Get<bool>("use_legacy_nnapi"));
+    interpreter->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
+    for (const auto& delegate_provider :
+         tools::GetRegisteredDelegateProviders()) {
+      auto delegate = delegate_provider->CreateTfLiteDelegate(params_);
+      if (delegate == nullptr) continue;
+      if (interpreter->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to apply " << delegate_provider->GetName()
+                          << " delegate to interpreter #" << n;
+        return kTfLiteError;
+      }
+      owned_delegates_.emplace_back(std::move(delegate));
+    }
+    ResizeInputs(interpreter.get());
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to allocate tensors of interpreter #" << n;
+      return kTfLiteError;
+    }
+    extra_interpreters_.push_back(std::move(interpreter));
+  }
   return kTfLiteOk;
 }
 
@@ -624,6 +726,7 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::Init() {
+  extra_interpreters_.clear();
   TF_LITE_ENSURE_STATUS(LoadModel());
   TF_LITE_ENSURE_STATUS(InitInterpreter());
 
@@ -693,21 +796,15 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     }
   }
 
-  // Resize all non-string tensors.
-  for (int j = 0; j < inputs_.size(); ++j) {
-    const InputLayerInfo& input = inputs_[j];
-    int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
-    if (t->type != kTfLiteString) {
-      interpreter_->ResizeInputTensor(i, input.shape);
-    }
-  }
+  ResizeInputs(interpreter_.get());
 
   if (interpreter_->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
 
+  TF_LITE_ENSURE_STATUS(InitExtraInterpreters());
+
   ruy_profiling_listener_.reset(new RuyProfileListener());
   AddListener(ruy_profiling_listener_.get());
 
@@ -750,5 +847,125 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
+tensorflow::Stat<int64_t> BenchmarkTfLiteModel::Run(
+    int min_num_times, float min_secs, float max_secs, RunType run_type,
+    TfLiteStatus* invoke_status) {
+  const float request_rate = params_.Get<float>("request_rate");
+  if (extra_interpreters_.empty() && request_rate <= 0) {
+    return BenchmarkModel::Run(min_num_times, min_secs, max_secs, run_type,
+                               invoke_status);
+  }
+
+  std::vector<Interpreter*> interpreters = {interpreter_.get()};
+  for (auto& interpreter : extra_interpreters_) {
+    interpreters.push_back(interpreter.get());
+  }
+  std::stringstream load;
+  if (request_rate > 0) {
+    load << request_rate << " runs per second";
+  } else {
+    load << "back-to-back runs";
+  }
+  TFLITE_LOG(INFO) << "Running benchmark on " << interpreters.size()
+                   << " interpreters with " << load.str() << " for at least "
+                   << min_num_times << " iterations and at least " << min_secs
+                   << " seconds but terminate if exceeding " << max_secs
+                   << " seconds.";
+  ResetInputsAndOutputs();
+
+  std::mutex mutex;
+  std::condition_variable request_cv;
+  std::condition_variable completion_cv;
+  // The times at which the runs that have not started yet were requested.
+  std::deque<int64_t> requests;
+  bool stop = false;
+  int num_completed = 0;
+  tensorflow::Stat<int64_t> run_stats;
+  run_latencies_us_.clear();
+  *invoke_status = kTfLiteOk;
+
+  auto serve = [&](int index) {
+    while (true) {
+      int64_t request_us;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (request_rate > 0) {
+          request_cv.wait(lock, [&] { return stop || !requests.empty(); });
+          if (stop) return;
+          request_us = requests.front();
+          requests.pop_front();
+        } else {
+          if (stop) return;
+          request_us = profiling::time::NowMicros();
+        }
+      }
+      // Only the runs of the first interpreter are reported to the listeners,
+      // which are not thread-safe.
+      if (index == 0) listeners_.OnSingleRunStart(run_type);
+      const TfLiteStatus status = interpreters[index]->Invoke();
+      const int64_t end_us = profiling::time::NowMicros();
+      if (index == 0) listeners_.OnSingleRunEnd();
+
+      std::lock_guard<std::mutex> lock(mutex);
+      run_stats.UpdateStat(end_us - request_us);
+      run_latencies_us_.push_back(end_us - request_us);
+      ++num_completed;
+      if (status != kTfLiteOk) *invoke_status = status;
+      completion_cv.notify_one();
+    }
+  };
+
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t min_finish_us =
+      start_us + static_cast<int64_t>(min_secs * 1e6f);
+  const int64_t max_finish_us =
+      start_us + static_cast<int64_t>(max_secs * 1e6f);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < interpreters.size(); ++i) {
+    threads.emplace_back(serve, i);
+  }
+  int num_requested = 0;
+  int64_t next_request_us = start_us;
+  while (true) {
+    const int64_t now_us = profiling::time::NowMicros();
+    std::unique_lock<std::mutex> lock(mutex);
+    const int num_runs = request_rate > 0 ? num_requested : num_completed;
+    if ((num_runs >= min_num_times && now_us >= min_finish_us) ||
+        now_us > max_finish_us) {
+      break;
+    }
+    if (request_rate <= 0) {
+      completion_cv.wait_for(lock, std::chrono::milliseconds(1));
+    } else if (now_us < next_request_us) {
+      lock.unlock();
+      util::SleepForSeconds((next_request_us - now_us) / 1e6f);
+    } else {
+      requests.push_back(next_request_us);
+      ++num_requested;
+      next_request_us += static_cast<int64_t>(1e6f / request_rate);
+      request_cv.notify_one();
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+    // Requests that no interpreter has picked up are dropped.
+    requests.clear();
+  }
+  request_cv.notify_all();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const int64_t end_us = profiling::time::NowMicros();
+  runs_per_second_ =
+      end_us > start_us ? num_completed * 1e6 / (end_us - start_us) : 0.0;
+
+  std::stringstream stream;
+  run_stats.OutputToStream(&stream);
+  TFLITE_LOG(INFO) << stream.str() << std::endl;
+
+  return run_stats;
+}
+
 }  // namespace benchmark
 }  // namespace tflite
@@ -67,6 +67,12 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   TfLiteStatus PrepareInputData() override;
   TfLiteStatus ResetInputsAndOutputs() override;
 
+  // Runs the interpreters concurrently when there are several of them, or at
+  // the requested rate if there is one, and otherwise one run after the other.
+  tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
+                                float max_secs, RunType run_type,
+                                TfLiteStatus* invoke_status) override;
+
   int64_t MayGetModelFileSize() override;
 
   virtual TfLiteStatus LoadModel();
@@ -118,12 +124,24 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   InputTensorData LoadInputTensorData(const TfLiteTensor& t,
                                       const std::string& input_file_path);
 
+  // Resizes the inputs of 'interpreter' to the shapes of the benchmark.
+  void ResizeInputs(Interpreter* interpreter);
+
+  // Sets the inputs of 'interpreter' from inputs_data_.
+  void ResetInputs(Interpreter* interpreter);
+
+  // Creates the interpreters other than interpreter_ for --num_interpreters.
+  TfLiteStatus InitExtraInterpreters();
+
   std::vector<InputLayerInfo> inputs_;
   std::vector<InputTensorData> inputs_data_;
   std::unique_ptr<BenchmarkListener> profiling_listener_ = nullptr;
   std::unique_ptr<BenchmarkListener> ruy_profiling_listener_ = nullptr;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+  // The interpreters that run the model concurrently with interpreter_. They
+  // are destroyed before the delegates that they use.
+  std::vector<std::unique_ptr<tflite::Interpreter>> extra_interpreters_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
 };
@@ -28,11 +28,33 @@ from __future__ import print_function
 import os
 import random
 
+import numpy as np
+
 from flatbuffers.python import flatbuffers
 from tensorflow.lite.python import schema_py_generated as schema_fb
 
 TFLITE_FILE_IDENTIFIER = b'TFL3'
 
+# Name of the metadata holding the arena offsets planned by
+# plan_offline_memory(), as read by the TFLite Micro allocator.
+OFFLINE_MEMORY_ALLOCATION_METADATA = 'OfflineMemoryAllocation'
+
+# The TFLite Micro allocator aligns all buffers in the arena to 16 bytes.
+_MICRO_BUFFER_ALIGNMENT = 16
+
+_TENSOR_TYPE_SIZES = {
+    schema_fb.TensorType.FLOAT32: 4,
+    schema_fb.TensorType.FLOAT16: 2,
+    schema_fb.TensorType.INT32: 4,
+    schema_fb.TensorType.UINT8: 1,
+    schema_fb.TensorType.INT64: 8,
+    schema_fb.TensorType.BOOL: 1,
+    schema_fb.TensorType.INT16: 2,
+    schema_fb.TensorType.COMPLEX64: 8,
+    schema_fb.TensorType.INT8: 1,
+    schema_fb.TensorType.FLOAT64: 8,
+}
+
 
 def read_model(input_tflite_file):
   """Reads and parses a tflite model.
@@ -122,3 +144,137 @@ def randomize_weights(model, random_seed=0):
     # end up as denormalized or NaN/Inf floating point numbers.
     for j in range(buffer_i_size):
       buffer_i_data[j] = random.randint(0, 255)
+
+
+def _get_micro_buffers(model, subgraph):
+  """Returns the tensors of `subgraph` that TFLite Micro allocates in its arena.
+
+  Args:
+    model: The model owning `subgraph`.
+    subgraph: The subgraph to plan.
+
+  Returns:
+    A list of (tensor index, aligned size, first created, last used) tuples,
+    with the lifetimes computed the same way as by the Micro allocator.
+  """
+  num_ops = len(subgraph.operators) if subgraph.operators else 0
+  first_created = {}
+  last_used = {}
+  for tensor_index in subgraph.inputs if subgraph.inputs is not None else []:
+    first_created[tensor_index] = 0
+  for tensor_index in subgraph.outputs if subgraph.outputs is not None else []:
+    last_used[tensor_index] = num_ops - 1
+  for op_index in range(num_ops):
+    op = subgraph.operators[op_index]
+    for tensor_index in op.inputs if op.inputs is not None else []:
+      if tensor_index >= 0:
+        last_used[tensor_index] = max(last_used.get(tensor_index, -1),
+                                      op_index)
+    for tensor_index in op.outputs if op.outputs is not None else []:
+      first_created.setdefault(tensor_index, op_index)
+
+  buffers = []
+  for tensor_index, tensor in enumerate(subgraph.tensors):
+    buffer = model.buffers[tensor.buffer] if tensor.buffer else None
+    has_data = buffer is not None and buffer.data is not None and len(
+        buffer.data)
+    if has_data or tensor.isVariable:
+      continue
+    if tensor_index not in first_created or tensor_index not in last_used:
+      continue
+    if tensor.type not in _TENSOR_TYPE_SIZES:
+      continue
+    size = _TENSOR_TYPE_SIZES[tensor.type]
+    for dim in tensor.shape if tensor.shape is not None else []:
+      size *= dim
+    size = -(-size // _MICRO_BUFFER_ALIGNMENT) * _MICRO_BUFFER_ALIGNMENT
+    buffers.append((tensor_index, size, first_created[tensor_index],
+                    last_used[tensor_index]))
+  return buffers
+
+
+def _best_fit_plan(buffers):
+  """Places `buffers` in the order given, each in the smallest free gap.
+
+  Args:
+    buffers: A list of (tensor index, size, first created, last used) tuples.
+
+  Returns:
+    A tuple of the arena size needed and a dict of tensor index to offset.
+  """
+  placed = []
+  offsets = {}
+  arena_size = 0
+  for tensor_index, size, first, last in buffers:
+    live = sorted((offset, offset + other_size)
+                  for offset, other_size, other_first, other_last in placed
+                  if other_first <= last and first <= other_last)
+    best_offset = None
+    best_gap = None
+    gap_start = 0
+    for start, end in live:
+      gap = start - gap_start
+      if gap >= size and (best_gap is None or gap < best_gap):
+        best_offset = gap_start
+        best_gap = gap
+      gap_start = max(gap_start, end)
+    if best_offset is None:
+      best_offset = gap_start
+    placed.append((best_offset, size, first, last))
+    offsets[tensor_index] = best_offset
+    arena_size = max(arena_size, best_offset + size)
+  return arena_size, offsets
+
+
+def plan_offline_memory(model, subgraph_index=0):
+  """Plans the TFLite Micro arena offsets of a subgraph ahead of time.
+
+  The offsets are stored in the "OfflineMemoryAllocation" metadata of the
+  model, so that the Micro allocator uses them instead of planning on the
+  device. Best-fit placement is tried for several orders of the buffers and
+  the smallest plan is kept, which is usually at least as small as the plan
+  of the greedy planner that runs on the device.
+
+  Args:
+    model: The model to plan, which is changed in place.
+    subgraph_index: The subgraph to plan.
+
+  Returns:
+    The arena size needed by the planned tensors, in bytes.
+  """
+  subgraph = model.subgraphs[subgraph_index]
+  buffers = _get_micro_buffers(model, subgraph)
+  orders = [
+      lambda b: (-b[1], b[2]),  # Largest first.
+      lambda b: (-(b[3] - b[2]), -b[1]),  # Longest lifetime first.
+      lambda b: (b[2], -b[1]),  # In execution order.
+      lambda b: (-b[1] * (b[3] - b[2] + 1), b[2]),  # Largest area first.
+  ]
+  arena_size, offsets = min(
+      (_best_fit_plan(sorted(buffers, key=order)) for order in orders),
+      key=lambda plan: plan[0])
+
+  # Tensors that aren't planned here are left to the allocator, which marks
+  # constants and variables as not needing arena memory anyway.
+  num_tensors = len(subgraph.tensors)
+  plan = [0, subgraph_index, num_tensors]
+  plan.extend(offsets.get(i, -1) for i in range(num_tensors))
+  plan_buffer = schema_fb.BufferT()
+  plan_buffer.data = np.array(plan, dtype='<i4').view(np.uint8)
+
+  if model.metadata is None:
+    model.metadata = []
+  for metadata in model.metadata:
+    name = metadata.name
+    if isinstance(name, bytes):
+      name = name.decode('utf-8')
+    if name == OFFLINE_MEMORY_ALLOCATION_METADATA:
+      model.buffers[metadata.buffer] = plan_buffer
+      break
+  else:
+    metadata = schema_fb.MetadataT()
+    metadata.name = OFFLINE_MEMORY_ALLOCATION_METADATA
+    metadata.buffer = len(model.buffers)
+    model.buffers.append(plan_buffer)
+    model.metadata.append(metadata)
+  return arena_size
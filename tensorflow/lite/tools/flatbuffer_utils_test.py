@@ -159,5 +159,57 @@ class RandomizeWeightsTest(test_util.TensorFlowTestCase):
       self.assertNotEqual(initial_buffer.data[j], final_buffer.data[j])
 
 
+class PlanOfflineMemoryTest(test_util.TensorFlowTestCase):
+
+  def _get_offline_plan(self, model):
+    for metadata in model.metadata:
+      name = metadata.name
+      if isinstance(name, bytes):
+        name = name.decode('utf-8')
+      if name == flatbuffer_utils.OFFLINE_MEMORY_ALLOCATION_METADATA:
+        return model.buffers[metadata.buffer].data.view('<i4').tolist()
+    return None
+
+  def testPlanOfflineMemory(self):
+    # 1. SETUP
+    # Define the initial model
+    model = test_utils.build_mock_model()
+    num_buffers = len(model.buffers)
+
+    # 2. INVOKE
+    # Invoke the plan_offline_memory function
+    arena_size = flatbuffer_utils.plan_offline_memory(model)
+
+    # 3. VALIDATE
+    # The input and the output of the ADD are live at the same time and take
+    # 48 bytes each once aligned, while the constant isn't planned.
+    self.assertEqual(96, arena_size)
+    self.assertEqual(num_buffers + 1, len(model.buffers))
+    version, subgraph, num_tensors, input_offset, constant_offset, \
+        output_offset = self._get_offline_plan(model)
+    self.assertEqual(0, version)
+    self.assertEqual(0, subgraph)
+    self.assertEqual(3, num_tensors)
+    self.assertEqual(-1, constant_offset)
+    self.assertEqual([0, 48], sorted([input_offset, output_offset]))
+
+  def testPlanOfflineMemoryReplacesPlan(self):
+    # 1. SETUP
+    # Define the initial model
+    model = test_utils.build_mock_model()
+    flatbuffer_utils.plan_offline_memory(model)
+    num_buffers = len(model.buffers)
+
+    # 2. INVOKE
+    # Invoke the plan_offline_memory function once more
+    flatbuffer_utils.plan_offline_memory(model)
+
+    # 3. VALIDATE
+    # The existing plan is replaced instead of adding another one.
+    self.assertEqual(num_buffers, len(model.buffers))
+    self.assertEqual(1, len(model.metadata))
+    self.assertEqual(6, len(self._get_offline_plan(model)))
+
+
 if __name__ == '__main__':
   test.main()
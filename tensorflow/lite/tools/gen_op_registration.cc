@@ -18,7 +18,9 @@ limitations under the License.
 #include <vector>
 
 #include "re2/re2.h"
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
 #include "tensorflow/lite/model.h"
+#include "tensorflow/lite/stderr_reporter.h"
 
 namespace tflite {
 
@@ -54,4 +56,30 @@ void ReadOpsFromModel(const ::tflite::Model* model,
   }
 }
 
+void ReadTensorTypesFromModel(const ::tflite::Model* model,
+                              std::set<TfLiteType>* types) {
+  if (!model) return;
+  auto subgraphs = model->subgraphs();
+  if (!subgraphs) return;
+  for (const auto* subgraph : *subgraphs) {
+    auto tensors = subgraph->tensors();
+    if (!tensors) continue;
+    for (const auto* tensor : *tensors) {
+      TfLiteType type;
+      if (ConvertTensorType(tensor->type(), &type, DefaultErrorReporter()) ==
+          kTfLiteOk) {
+        types->insert(type);
+      }
+    }
+  }
+}
+
+uint64_t GetSelectedTypesMask(const std::set<TfLiteType>& types) {
+  uint64_t mask = 0;
+  for (TfLiteType type : types) {
+    mask |= uint64_t{1} << type;
+  }
+  return mask;
+}
+
 }  // namespace tflite
@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 #define TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
 
+#include <cstdint>
+#include <set>
+
+#include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/model.h"
 #include "tensorflow/lite/string_type.h"
 
@@ -37,6 +41,14 @@ void ReadOpsFromModel(const ::tflite::Model* model,
                       RegisteredOpMap* builtin_ops,
                       RegisteredOpMap* custom_ops);
 
+// Read the types of all tensors of the TFLite model.
+void ReadTensorTypesFromModel(const ::tflite::Model* model,
+                              std::set<TfLiteType>* types);
+
+// Returns the value for TFLITE_SELECTED_TYPES that compiles in the kernel
+// paths of `types` only, with one bit per TfLiteType.
+uint64_t GetSelectedTypesMask(const std::set<TfLiteType>& types);
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_TOOLS_GEN_OP_REGISTRATION_H_
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include <fstream>
+#include <ios>
 #include <map>
+#include <set>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -30,11 +32,12 @@ const char kNamespace[] = "namespace";
 const char kOutputRegistrationFlag[] = "output_registration";
 const char kTfLitePathFlag[] = "tflite_path";
 const char kForMicro[] = "for_micro";
+const char kOutputSelectedTypesFlag[] = "output_selected_types";
 
 void ParseFlagAndInit(int* argc, char** argv, std::string* input_models,
                       std::string* output_registration,
                       std::string* tflite_path, std::string* namespace_flag,
-                      bool* for_micro) {
+                      bool* for_micro, std::string* output_selected_types) {
   std::vector<tflite::Flag> flag_list = {
       tflite::Flag::CreateFlag(kInputModelFlag, input_models,
                                "path to the tflite models, separated by comma"),
@@ -49,6 +52,10 @@ void ParseFlagAndInit(int* argc, char** argv, std::string* input_models,
           kForMicro, for_micro,
           "By default this script generate TFL registration file, but can "
           "also generate TFLM files when this flag is set to true"),
+      tflite::Flag::CreateFlag(
+          kOutputSelectedTypesFlag, output_selected_types,
+          "filename for the compiler flag that restricts the kernels to the "
+          "tensor types used by the models, e.g. for bazel --copt"),
   };
 
   tflite::Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
@@ -135,9 +142,18 @@ void GenerateFileContent(const std::string& tflite_path,
   fout.close();
 }
 
+void GenerateSelectedTypes(const std::string& filename,
+                           const std::set<TfLiteType>& types) {
+  std::ofstream fout(filename);
+  fout << "-DTFLITE_SELECTED_TYPES=0x" << std::hex
+       << tflite::GetSelectedTypesMask(types) << "\n";
+  fout.close();
+}
+
 void AddOpsFromModel(const std::string& input_model,
                      tflite::RegisteredOpMap* builtin_ops,
-                     tflite::RegisteredOpMap* custom_ops) {
+                     tflite::RegisteredOpMap* custom_ops,
+                     std::set<TfLiteType>* types) {
   std::ifstream fin(input_model);
   std::stringstream content;
   content << fin.rdbuf();
@@ -145,6 +161,7 @@ void AddOpsFromModel(const std::string& input_model,
   std::string content_str = content.str();
   const ::tflite::Model* model = ::tflite::GetModel(content_str.data());
   ::tflite::ReadOpsFromModel(model, builtin_ops, custom_ops);
+  ::tflite::ReadTensorTypesFromModel(model, types);
 }
 
 }  // namespace
@@ -155,22 +172,28 @@ int main(int argc, char** argv) {
   std::string tflite_path;
   std::string namespace_flag;
   bool for_micro = false;
+  std::string output_selected_types;
   ParseFlagAndInit(&argc, argv, &input_models, &output_registration,
-                   &tflite_path, &namespace_flag, &for_micro);
+                   &tflite_path, &namespace_flag, &for_micro,
+                   &output_selected_types);
 
   tflite::RegisteredOpMap builtin_ops;
   tflite::RegisteredOpMap custom_ops;
+  std::set<TfLiteType> types;
   if (!input_models.empty()) {
     std::vector<std::string> models = absl::StrSplit(input_models, ',');
     for (const std::string& input_model : models) {
-      AddOpsFromModel(input_model, &builtin_ops, &custom_ops);
+      AddOpsFromModel(input_model, &builtin_ops, &custom_ops, &types);
     }
   }
   for (int i = 1; i < argc; i++) {
-    AddOpsFromModel(argv[i], &builtin_ops, &custom_ops);
+    AddOpsFromModel(argv[i], &builtin_ops, &custom_ops, &types);
   }
 
   GenerateFileContent(tflite_path, output_registration, namespace_flag,
                       builtin_ops, custom_ops, for_micro);
+  if (!output_selected_types.empty()) {
+    GenerateSelectedTypes(output_selected_types, types);
+  }
   return 0;
 }
@@ -29,11 +29,13 @@ class GenOpRegistrationTest : public ::testing::Test {
     auto model = FlatBufferModel::BuildFromFile(model_path.data());
     if (model) {
       ReadOpsFromModel(model->GetModel(), &builtin_ops_, &custom_ops_);
+      ReadTensorTypesFromModel(model->GetModel(), &types_);
     }
   }
 
   std::map<string, std::pair<int, int>> builtin_ops_;
   std::map<string, std::pair<int, int>> custom_ops_;
+  std::set<TfLiteType> types_;
 };
 
 TEST_F(GenOpRegistrationTest, TestNonExistentFiles) {
@@ -85,6 +87,18 @@ TEST_F(GenOpRegistrationTest, TestBrokenMmap) {
   EXPECT_EQ(custom_ops_.size(), 0);
 }
 
+TEST_F(GenOpRegistrationTest, TestTensorTypes) {
+  ReadOps("tensorflow/lite/testdata/test_model.bin");
+  EXPECT_THAT(types_, ElementsAreArray({kTfLiteFloat32}));
+  EXPECT_EQ(GetSelectedTypesMask(types_), uint64_t{1} << kTfLiteFloat32);
+}
+
+TEST_F(GenOpRegistrationTest, TestTensorTypesEmptyModel) {
+  ReadOps("tensorflow/lite/testdata/empty_model.bin");
+  EXPECT_EQ(types_.size(), 0);
+  EXPECT_EQ(GetSelectedTypesMask(types_), 0);
+}
+
 TEST_F(GenOpRegistrationTest, TestNormalizeCustomOpName) {
   std::vector<std::pair<string, string>> testcase = {
       {"CustomOp", "CUSTOM_OP"},
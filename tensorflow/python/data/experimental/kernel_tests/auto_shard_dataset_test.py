@@ -17,6 +17,8 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import os
+
 from absl.testing import parameterized
 
 from tensorflow.python.data.experimental.kernel_tests import reader_dataset_ops_test_base
@@ -32,6 +34,7 @@ from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import readers as core_readers
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import errors
+from tensorflow.python.lib.io import python_io
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
@@ -332,6 +335,39 @@ class AutoShardDatasetTest(reader_dataset_ops_test_base.TFRecordDatasetTestBase,
       dataset = distribute._AutoShardDataset(dataset, 10, 0)
       self.evaluate(self.getNext(dataset)())
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(index=[0, 1])))
+  def testBalancedFileSharding(self, index):
+    # File 0 holds as many records as the other three together, so it is the
+    # only file that worker 0 reads.
+    filenames = []
+    for f, num_records in enumerate([30, 10, 10, 10]):
+      fn = os.path.join(self.get_temp_dir(), "balanced.%d.txt" % f)
+      filenames.append(fn)
+      writer = python_io.TFRecordWriter(fn)
+      for r in range(num_records):
+        writer.write(b"Record %d of file %d" % (r, f))
+      writer.close()
+
+    options = dataset_ops.Options()
+    options.experimental_distribute.auto_shard_policy = (
+        distribute_options.AutoShardPolicy.BALANCED_FILE)
+    dataset = core_readers.TFRecordDataset(filenames)
+    dataset = dataset.with_options(options)
+    dataset = distribute._AutoShardDataset(dataset, 2, index)
+
+    if index == 0:
+      expected = [b"Record %d of file 0" % r for r in range(30)]
+    else:
+      expected = [
+          b"Record %d of file %d" % (r, f)  # pylint:disable=g-complex-comprehension
+          for f in (1, 2, 3)
+          for r in range(10)
+      ]
+    self.assertDatasetProduces(dataset, expected)
+
   @combinations.generate(test_base.default_test_combinations())
   def testWorkersGreaterThanNumFiles(self):
     dataset = dataset_ops.Dataset.list_files(self.test_filenames)
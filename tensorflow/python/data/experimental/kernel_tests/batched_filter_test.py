@@ -0,0 +1,102 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.filter_batched()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import batched_filter
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+class BatchedFilterTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(batch_size=[1, 3, 10, 100])))
+  def testMatchesFilter(self, batch_size):
+    dataset = dataset_ops.Dataset.range(50).apply(
+        batched_filter.filter_batched(lambda x: x % 7 < 2, batch_size))
+    self.assertDatasetProduces(
+        dataset, [x for x in range(50) if x % 7 < 2])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testTupleElements(self):
+    dataset = dataset_ops.Dataset.range(10).map(
+        lambda x: (x, array_ops.fill([2], x)))
+    dataset = dataset.apply(
+        batched_filter.filter_batched(
+            lambda x, y: math_ops.reduce_sum(y, axis=1) > 10, batch_size=4))
+    self.assertDatasetProduces(dataset, [(x, [x, x]) for x in range(6, 10)])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testNoMatches(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        batched_filter.filter_batched(lambda x: x < 0, batch_size=3))
+    self.assertDatasetProduces(dataset, [])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testCapturedInputs(self):
+    threshold = math_ops.cast(5, "int64")
+    dataset = dataset_ops.Dataset.range(10).apply(
+        batched_filter.filter_batched(lambda x: x >= threshold, batch_size=3))
+    self.assertDatasetProduces(dataset, list(range(5, 10)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPredicateMustReturnAVector(self):
+    with self.assertRaisesRegexp(ValueError, "boolean vector"):
+      dataset_ops.Dataset.range(10).apply(
+          batched_filter.filter_batched(
+              lambda x: math_ops.reduce_any(x > 5), batch_size=3))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testPredicateMustReturnOneValuePerElement(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        batched_filter.filter_batched(lambda x: (x > 5)[:1], batch_size=3))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors.InvalidArgumentError,
+                        "one value per element of the batch"))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testDifferentShapesInABatch(self):
+    dataset = dataset_ops.Dataset.range(4).map(lambda x: array_ops.fill([x], x))
+    dataset = dataset.apply(
+        batched_filter.filter_batched(lambda x: array_ops.shape(x)[:1] > 0,
+                                      batch_size=2))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors.InvalidArgumentError,
+                        "Cannot batch tensors with different shapes"))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInvalidBatchSize(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "batch_size must be greater than zero"):
+      dataset = dataset_ops.Dataset.range(10).apply(
+          batched_filter.filter_batched(lambda x: x > 5, batch_size=0))
+      self.evaluate(self.getNext(dataset)())
+
+
+if __name__ == "__main__":
+  test.main()
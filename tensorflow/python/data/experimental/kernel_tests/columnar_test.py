@@ -0,0 +1,103 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for reading and writing columnar files."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import columnar
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.ops import string_ops
+from tensorflow.python.platform import test
+
+
+class ColumnarTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _dataset(self, num_elements):
+    return dataset_ops.Dataset.range(num_elements).map(
+        lambda x: (x, array_ops.fill([2], math_ops.cast(x, dtypes.float32)),
+                   string_ops.as_string(x)))
+
+  def _write(self, dataset, name, **kwargs):
+    filename = os.path.join(self.get_temp_dir(), name)
+    columnar.write_columnar(dataset, filename, **kwargs)
+    return filename
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testRoundTrip(self):
+    dataset = self._dataset(10)
+    filename = self._write(dataset, "round_trip", rows_per_chunk=3)
+    self.assertDatasetProduces(
+        columnar.ColumnarDataset([filename], dataset.element_spec),
+        [(i, [float(i)] * 2, str(i).encode()) for i in range(10)])
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testProjection(self):
+    dataset = self._dataset(10)
+    filename = self._write(dataset, "projection")
+    self.assertDatasetProduces(
+        columnar.ColumnarDataset([filename], dataset.element_spec,
+                                 columns=[2, 0]),
+        [(str(i).encode(), i) for i in range(10)])
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testPredicate(self):
+    dataset = self._dataset(10)
+    filename = self._write(dataset, "predicate", rows_per_chunk=2)
+    self.assertDatasetProduces(
+        columnar.ColumnarDataset([filename], dataset.element_spec,
+                                 columns=[1], predicate=(0, 3, 6)),
+        [([float(i)] * 2,) for i in range(3, 7)])
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testMultipleFiles(self):
+    dataset = self._dataset(4)
+    filenames = [self._write(dataset, "file_%d" % i) for i in range(3)]
+    self.assertDatasetProduces(
+        columnar.ColumnarDataset(filenames, dataset.element_spec,
+                                 columns=[0]),
+        [(i,) for i in range(4)] * 3)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testUndefinedShape(self):
+    dataset = dataset_ops.Dataset.range(3).map(lambda x: array_ops.fill([x], x))
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "fully defined component shapes"):
+      self._write(dataset, "undefined_shape")
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testMismatchedSpec(self):
+    dataset = self._dataset(3)
+    filename = self._write(dataset, "mismatched_spec")
+    element_spec = dataset_ops.Dataset.range(3).map(
+        lambda x: (x, x, string_ops.as_string(x))).element_spec
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "but the dataset expects"):
+      self.getDatasetOutput(
+          columnar.ColumnarDataset([filename], element_spec, columns=[1]))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -24,6 +24,7 @@ from tensorflow.python.data.experimental.ops import prefetching_ops
 from tensorflow.python.data.kernel_tests import test_base
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import iterator_ops
+from tensorflow.python.data.ops import multi_device_iterator_ops
 from tensorflow.python.data.util import structure
 from tensorflow.python.framework import combinations
 from tensorflow.python.framework import dtypes
@@ -31,6 +32,8 @@ from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.platform import test
 from tensorflow.python.util import compat as util_compat
@@ -525,6 +528,73 @@ class CopyToDeviceTest(test_base.DatasetTestBase, parameterized.TestCase):
       with self.assertRaises(errors.OutOfRangeError):
         self.evaluate(next_element)
 
+  @combinations.generate(test_base.graph_only_combinations())
+  def testCopyToDeviceGpuPackedBatches(self):
+    if not test_util.is_gpu_available():
+      self.skipTest("No GPU available")
+
+    host_dataset = dataset_ops.Dataset.range(8).map(
+        lambda x: (array_ops.fill([3, 5], x), math_ops.cast(x, dtypes.int8)))
+    host_dataset = host_dataset.batch(2, drop_remainder=True)
+    self.assertTrue(
+        multi_device_iterator_ops.should_pack_element(
+            host_dataset.element_spec, "/gpu:0"))
+    device_dataset = host_dataset.apply(
+        prefetching_ops.copy_to_device("/gpu:0")).prefetch(1)
+
+    with ops.device("/gpu:0"):
+      iterator = dataset_ops.make_initializable_iterator(device_dataset)
+      next_element = iterator.get_next()
+
+    with self.cached_session(
+        config=config_pb2.ConfigProto(allow_soft_placement=False)):
+      self.evaluate(iterator.initializer)
+      for i in range(0, 8, 2):
+        matrices, scalars = self.evaluate(next_element)
+        self.assertAllEqual([[[i] * 5] * 3, [[i + 1] * 5] * 3], matrices)
+        self.assertAllEqual([i, i + 1], scalars)
+      with self.assertRaises(errors.OutOfRangeError):
+        self.evaluate(next_element)
+
+  @combinations.generate(test_base.graph_only_combinations())
+  def testPackElementRoundTrip(self):
+    components = [
+        array_ops.fill([3, 5], 7.0),
+        math_ops.range(3),
+        array_ops.zeros([0], dtypes.int64),
+        array_ops.constant(True),
+    ]
+    packed = ged_ops.pack_element(components)
+    unpacked = ged_ops.unpack_element(
+        packed,
+        output_types=[component.dtype for component in components],
+        output_shapes=[component.shape for component in components])
+    # Every component starts at a multiple of 64 bytes.
+    self.assertEqual(64 * 2 + 1, self.evaluate(array_ops.size(packed)))
+    for expected, actual in zip(self.evaluate(components),
+                                self.evaluate(unpacked)):
+      self.assertAllEqual(expected, actual)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testShouldPackElement(self):
+    dataset = dataset_ops.Dataset.range(10).batch(2, drop_remainder=True)
+    self.assertTrue(
+        multi_device_iterator_ops.should_pack_element(dataset.element_spec,
+                                                      "/gpu:0"))
+    self.assertFalse(
+        multi_device_iterator_ops.should_pack_element(dataset.element_spec,
+                                                      "/cpu:1"))
+    # Components that vary in shape or are not memcpy-able are copied one by
+    # one.
+    dataset = dataset_ops.Dataset.range(10).batch(2)
+    self.assertFalse(
+        multi_device_iterator_ops.should_pack_element(dataset.element_spec,
+                                                      "/gpu:0"))
+    dataset = dataset_ops.Dataset.from_tensors("a")
+    self.assertFalse(
+        multi_device_iterator_ops.should_pack_element(dataset.element_spec,
+                                                      "/gpu:0"))
+
   @combinations.generate(test_base.graph_only_combinations())
   def testIteratorGetNextAsOptionalOnGPU(self):
     if not test_util.is_gpu_available():
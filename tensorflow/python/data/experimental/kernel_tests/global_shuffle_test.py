@@ -0,0 +1,123 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.global_shuffle()`."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import shuffle_ops
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import readers
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
+from tensorflow.python.platform import test
+
+
+class GlobalShuffleTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _getElements(self, dataset):
+    get_next = self.getNext(dataset)
+    elements = []
+    while True:
+      try:
+        elements.append(self.evaluate(get_next()))
+      except errors.OutOfRangeError:
+        return elements
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(num_elements=[0, 1, 5, 1000])))
+  def testProducesEveryElementOnce(self, num_elements):
+    dataset = dataset_ops.Dataset.range(num_elements).apply(
+        shuffle_ops.global_shuffle(seed=42))
+    self.assertDatasetProduces(
+        dataset, list(range(num_elements)), assert_items_equal=True)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testShuffles(self):
+    dataset = dataset_ops.Dataset.range(1000).apply(
+        shuffle_ops.global_shuffle(seed=42))
+    self.assertNotEqual(self._getElements(dataset), list(range(1000)))
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testSeedDeterminesTheOrder(self):
+
+    def shuffled(seed):
+      return self._getElements(
+          dataset_ops.Dataset.range(100).apply(
+              shuffle_ops.global_shuffle(seed=seed)))
+
+    self.assertEqual(shuffled(1), shuffled(1))
+    self.assertNotEqual(shuffled(1), shuffled(2))
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(reshuffle_each_iteration=[True, False])))
+  def testReshuffleEachIteration(self, reshuffle_each_iteration):
+    dataset = dataset_ops.Dataset.range(100).apply(
+        shuffle_ops.global_shuffle(
+            seed=42, reshuffle_each_iteration=reshuffle_each_iteration))
+    elements = self._getElements(dataset.repeat(2))
+    first_epoch, second_epoch = elements[:100], elements[100:]
+    self.assertCountEqual(first_epoch, second_epoch)
+    if reshuffle_each_iteration:
+      self.assertNotEqual(first_epoch, second_epoch)
+    else:
+      self.assertEqual(first_epoch, second_epoch)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testTensorSlices(self):
+    dataset = dataset_ops.Dataset.from_tensor_slices(
+        (list(range(10)), [[x, -x] for x in range(10)]))
+    dataset = dataset.apply(shuffle_ops.global_shuffle(seed=42))
+    elements = self._getElements(dataset)
+    self.assertCountEqual([x for x, _ in elements], list(range(10)))
+    for x, y in elements:
+      self.assertAllEqual(y, [x, -x])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testFixedLengthRecords(self):
+    filenames = []
+    expected = []
+    for i in range(3):
+      filename = os.path.join(self.get_temp_dir(), "records.%d.bin" % i)
+      records = [b"%d%04d" % (i, j) for j in range(7 + i)]
+      with open(filename, "wb") as f:
+        f.write(b"HH" + b"".join(records) + b"FFF")
+      filenames.append(filename)
+      expected.extend(records)
+    dataset = readers.FixedLengthRecordDataset(
+        filenames, record_bytes=5, header_bytes=2, footer_bytes=3)
+    dataset = dataset.apply(shuffle_ops.global_shuffle(seed=42))
+    self.assertDatasetProduces(dataset, expected, assert_items_equal=True)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testInputMustSupportRandomAccess(self):
+    dataset = dataset_ops.Dataset.range(10).map(lambda x: x * 2).apply(
+        shuffle_ops.global_shuffle(seed=42))
+    self.assertDatasetProduces(
+        dataset,
+        expected_error=(errors.InvalidArgumentError,
+                        "elements can be read in any order"))
+
+
+if __name__ == "__main__":
+  test.main()
@@ -688,5 +688,19 @@ class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
     self.assertDatasetProduces(dataset, [[x**2 for x in range(10)]])
 
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testMicroBatching(self):
+    # 100 elements do not fill the last micro-batch.
+    dataset = dataset_ops.Dataset.range(100)
+    dataset = dataset.map(lambda x: (x**2, x + 1), num_parallel_calls=4)
+    options = dataset_ops.Options()
+    opt_options = options.experimental_optimization
+    opt_options.map_vectorization.enabled = True
+    opt_options.map_vectorization.use_choose_fastest = False
+    opt_options.map_vectorization.micro_batch_size = 16
+    dataset = dataset.with_options(options)
+    self.assertDatasetProduces(dataset, [(x**2, x + 1) for x in range(100)])
+
+
 if __name__ == "__main__":
   test.main()
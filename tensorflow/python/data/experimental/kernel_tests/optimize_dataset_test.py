@@ -285,23 +285,40 @@ class OptimizeDatasetTest(test_base.DatasetTestBase, parameterized.TestCase):
     options = dataset_ops.Options()
 
     # Check defaults
-    autotune, algorithm, cpu_budget = options._autotune_settings()
+    (autotune, algorithm, cpu_budget, ram_budget,
+     account_for_step_threads) = options._autotune_settings()
     self.assertTrue(autotune)
     self.assertEqual(algorithm,
                      optimization_options._AutotuneAlgorithm.HILL_CLIMB)
     self.assertEqual(cpu_budget, 0)
+    self.assertEqual(ram_budget, 0)
+    self.assertFalse(account_for_step_threads)
 
   @combinations.generate(test_base.default_test_combinations())
   def testAutotuningBufferSizes(self):
     options = dataset_ops.Options()
     options.experimental_optimization.autotune_buffers = True
     self.assertIn("inject_prefetch", options._graph_rewrites())
-    autotune, algorithm, cpu_budget = options._autotune_settings()
+    autotune, algorithm, cpu_budget, _, _ = options._autotune_settings()
     self.assertTrue(autotune)
     self.assertEqual(algorithm,
                      optimization_options._AutotuneAlgorithm.GRADIENT_DESCENT)
     self.assertEqual(cpu_budget, 0)
 
+  @combinations.generate(test_base.default_test_combinations())
+  def testAutotuningResourceBudgets(self):
+    options = dataset_ops.Options()
+    options.experimental_optimization.autotune_ram_budget = 1 << 30
+    options.experimental_optimization.autotune_account_for_step_threads = True
+    _, _, cpu_budget, ram_budget, account_for_step_threads = (
+        options._autotune_settings())
+    self.assertEqual(cpu_budget, 0)
+    self.assertEqual(ram_budget, 1 << 30)
+    self.assertTrue(account_for_step_threads)
+
+    dataset = dataset_ops.Dataset.range(10).with_options(options)
+    self.assertDatasetProduces(dataset, expected_output=list(range(10)))
+
 
 if __name__ == "__main__":
   test.main()
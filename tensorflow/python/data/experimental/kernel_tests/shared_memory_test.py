@@ -0,0 +1,90 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for sharing tf.data elements through shared memory."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import threading
+
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import shared_memory
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import errors
+from tensorflow.python.ops import array_ops
+from tensorflow.python.platform import test
+
+
+class SharedMemoryTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _sharedMemoryName(self):
+    return "shared_memory_test_%d_%s" % (os.getpid(), self._testMethodName)
+
+  def _publish(self, dataset, name, num_consumers, **kwargs):
+    errors_seen = []
+
+    def publish():
+      try:
+        shared_memory.publish_to_shared_memory(dataset, name, num_consumers,
+                                               **kwargs)
+      except errors.OpError as e:
+        errors_seen.append(e)
+
+    thread = threading.Thread(target=publish)
+    thread.start()
+    return thread, errors_seen
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testShardsElements(self):
+    name = self._sharedMemoryName()
+    dataset = dataset_ops.Dataset.range(10).map(
+        lambda x: (x, array_ops.fill([x], x)))
+    thread, errors_seen = self._publish(dataset, name, 3, num_slots=2)
+    for index in range(3):
+      consumer = shared_memory.SharedMemoryDataset(
+          name, dataset.element_spec, num_consumers=3, index=index)
+      self.assertDatasetProduces(
+          consumer, [(i, [i] * i) for i in range(index, 10, 3)])
+    thread.join()
+    self.assertEqual(errors_seen, [])
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testElementTooLarge(self):
+    name = self._sharedMemoryName()
+    dataset = dataset_ops.Dataset.from_tensors(array_ops.zeros([1024]))
+    thread, errors_seen = self._publish(dataset, name, 1, slot_bytes=1024)
+    consumer = shared_memory.SharedMemoryDataset(
+        name, dataset.element_spec, num_consumers=1, index=0)
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "does not fit into a slot"):
+      self.getDatasetOutput(consumer)
+    thread.join()
+    self.assertLen(errors_seen, 1)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testInvalidIndex(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "Index must be between 0 and 1"):
+      shared_memory.SharedMemoryDataset(
+          "unused", dataset_ops.Dataset.range(1).element_spec,
+          num_consumers=2, index=2)
+
+
+if __name__ == "__main__":
+  test.main()
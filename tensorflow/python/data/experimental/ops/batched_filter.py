@@ -0,0 +1,94 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Filter transformation that evaluates its predicate on batches."""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import nest
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.ops import gen_experimental_dataset_ops
+
+
+class _BatchedFilterDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` of the elements of its input that match a batched predicate."""
+
+  def __init__(self, input_dataset, predicate, batch_size):
+    """See `filter_batched()` for details."""
+    self._input_dataset = input_dataset
+    # The predicate sees the components of `batch_size` elements stacked, as
+    # `Dataset.batch()` would produce them.
+    batched_structure = nest.map_structure(
+        lambda spec: spec._batch(None),  # pylint: disable=protected-access
+        input_dataset.element_spec)
+    wrapped_func = dataset_ops.StructuredFunctionWrapper(
+        predicate,
+        "tf.data.experimental.filter_batched()",
+        input_structure=batched_structure)
+    if not wrapped_func.output_structure.is_compatible_with(
+        tensor_spec.TensorSpec([None], dtypes.bool)):
+      raise ValueError("`predicate` must return a boolean vector.")
+
+    self._predicate = wrapped_func
+    self._batch_size = ops.convert_to_tensor(
+        batch_size, dtype=dtypes.int64, name="batch_size")
+    variant_tensor = gen_experimental_dataset_ops.batched_filter_dataset(
+        input_dataset._variant_tensor,  # pylint: disable=protected-access
+        batch_size=self._batch_size,
+        other_arguments=self._predicate.function.captured_inputs,
+        predicate=self._predicate.function,
+        **self._flat_structure)
+    super(_BatchedFilterDataset, self).__init__(input_dataset, variant_tensor)
+
+  def _functions(self):
+    return [self._predicate]
+
+
+def filter_batched(predicate, batch_size):
+  """Filters a dataset with a predicate that is evaluated on batches.
+
+  `dataset.apply(filter_batched(predicate, batch_size))` produces the same
+  elements as `dataset.filter(predicate)` when `predicate` is elementwise, but
+  evaluates `predicate` once for every `batch_size` elements:
+
+  ```python
+  dataset = tf.data.Dataset.range(10)
+  # Produces 0, 3, 6 and 9, with four calls to the predicate.
+  dataset = dataset.apply(filter_batched(lambda x: x % 3 == 0, batch_size=3))
+  ```
+
+  Filtering a selective predicate this way before an expensive `map` avoids
+  paying for a function call on every element that is dropped.
+
+  Args:
+    predicate: A function that maps a nested structure of tensors, with the
+      structure of an element of the dataset but batched along a new leading
+      dimension, to a `tf.bool` vector with one value per element of the batch.
+    batch_size: A `tf.int64` scalar `tf.Tensor`, the maximum number of elements
+      on which `predicate` is evaluated at once. The components of these
+      elements must have the same shape.
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return _BatchedFilterDataset(dataset, predicate, batch_size)
+
+  return _apply_fn
@@ -0,0 +1,113 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Reading and writing datasets in a columnar file format.
+
+A columnar file stores the flattened components of every element in columns,
+so a pipeline that needs a few of many features reads only their bytes and
+does not parse records:
+
+```python
+write_columnar(dataset, "/path/to/file")
+
+# Reads components 3 and 17 of the elements whose component 0 is in [0, 10].
+dataset = ColumnarDataset(["/path/to/file"], element_spec, columns=[3, 17],
+                          predicate=(0, 0, 10))
+```
+
+Elements are stored in chunks of `rows_per_chunk` rows, and the file records
+the minimum and maximum of every numeric scalar column in every chunk, so
+that chunks which hold no element selected by the predicate are skipped. The
+components must have fully defined shapes, and must be numeric, boolean or
+strings.
+"""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.util import nest
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
+
+
+def write_columnar(dataset, filename, rows_per_chunk=4096):
+  """Writes the elements of `dataset` to a columnar file.
+
+  Args:
+    dataset: A `tf.data.Dataset` whose elements are written.
+    filename: A `tf.string` scalar, the name of the file to write.
+    rows_per_chunk: The number of elements per chunk. Predicates skip whole
+      chunks, so smaller chunks skip more elements but have larger footers.
+
+  Returns:
+    In graph mode, the operation that writes the file. In eager mode, the file
+    is written by this function and there is no return value.
+
+  Raises:
+    TypeError: if `dataset` is not a `tf.data.Dataset`.
+  """
+  if not isinstance(dataset, dataset_ops.DatasetV2):
+    raise TypeError("`dataset` must be a `tf.data.Dataset` object.")
+  return gen_experimental_dataset_ops.dataset_to_columnar(
+      dataset._variant_tensor,  # pylint: disable=protected-access
+      filename=ops.convert_to_tensor(
+          filename, dtype=dtypes.string, name="filename"),
+      rows_per_chunk=rows_per_chunk)
+
+
+class ColumnarDataset(dataset_ops.DatasetSource):
+  """A `Dataset` of the elements of files written with `write_columnar`."""
+
+  def __init__(self, filenames, element_spec, columns=None, predicate=None):
+    """Creates a `ColumnarDataset`.
+
+    Args:
+      filenames: A `tf.string` tensor containing one or more filenames.
+      element_spec: The element spec of the written dataset.
+      columns: (Optional.) A list with the indices of the flattened components
+        to read. The elements of the dataset are tuples of these components.
+        Defaults to all components, with the structure of `element_spec`.
+      predicate: (Optional.) A tuple `(column, min_value, max_value)`. Only the
+        elements whose flattened component `column`, which must be a numeric
+        scalar, is in `[min_value, max_value]` are produced.
+    """
+    flat_specs = nest.flatten(element_spec)
+    if columns is None:
+      self._element_spec = element_spec
+      columns = list(range(len(flat_specs)))
+    else:
+      columns = list(columns)
+      self._element_spec = tuple(flat_specs[column] for column in columns)
+    if predicate is None:
+      predicate = (-1, float("-inf"), float("inf"))
+    predicate_column, predicate_min, predicate_max = predicate
+    variant_tensor = gen_experimental_dataset_ops.columnar_dataset(
+        filenames=ops.convert_to_tensor(
+            filenames, dtype=dtypes.string, name="filenames"),
+        columns=ops.convert_to_tensor(
+            columns, dtype=dtypes.int64, name="columns"),
+        predicate_column=ops.convert_to_tensor(
+            predicate_column, dtype=dtypes.int64, name="predicate_column"),
+        predicate_min=ops.convert_to_tensor(
+            predicate_min, dtype=dtypes.float64, name="predicate_min"),
+        predicate_max=ops.convert_to_tensor(
+            predicate_max, dtype=dtypes.float64, name="predicate_max"),
+        **self._flat_structure)
+    super(ColumnarDataset, self).__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._element_spec
@@ -34,11 +34,12 @@ from tensorflow.python.util.tf_export import tf_export
 
 class ProcessingMode(object):
   PARALLEL_EPOCHS = "parallel_epochs"
+  ONE_EPOCH = "one_epoch"
 
   @staticmethod
   def validate(mode):
     """Raises a ValueError if the given object is not a valid processing mode."""
-    valid_modes = [ProcessingMode.PARALLEL_EPOCHS]
+    valid_modes = [ProcessingMode.PARALLEL_EPOCHS, ProcessingMode.ONE_EPOCH]
     if mode not in valid_modes:
       raise ValueError(
           "{0} is not a valid processing mode. Valid modes: {1}".format(
@@ -64,8 +65,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
         tf.data service under `dataset_id`.
       dataset_id: The dataset id for the dataset to read from.
       processing_mode: A string specifying the policy for how data should be
-        processed by tf.data workers. Currently, the only supported value is
-        "parallel_epochs".
+        processed by tf.data workers. Supported values are "parallel_epochs"
+        and "one_epoch".
       address: The tf.data service address, e.g. "localhost:5000".
       protocol: The protocol to use for communicating with the tf.data service,
         e.g. "grpc".
@@ -75,7 +76,8 @@ class _DataServiceDatasetV2(dataset_ops.DatasetSource):
       max_outstanding_requests: (Optional.) A limit on how many elements may be
         requested at the same time. You can use this option to control the
         amount of memory used, since `distribute` won't use more than
-        `element_size` * `max_outstanding_requests` of memory.
+        `element_size` * `max_outstanding_requests` of memory, plus up to a
+        megabyte per request for batches of small elements.
       task_refresh_interval_hint_ms: (Optional.) A hint for how often to query
         the master for task changes.
     """
@@ -160,8 +162,8 @@ def _distribute(processing_mode,
 
   Args:
     processing_mode: A string specifying the policy for how data should be
-      processed by tf.data workers. Currently, the only supported value is
-      "parallel_epochs".
+      processed by tf.data workers. Supported values are "parallel_epochs" and
+      "one_epoch".
     service: A string indicating how to connect to the tf.data service. The
       string should be in the format <protocol>://<address>, e.g.
       grpc://localhost:5000.
@@ -171,7 +173,8 @@ def _distribute(processing_mode,
     max_outstanding_requests: (Optional.) A limit on how many elements may be
       requested at the same time. You can use this option to control the amount
       of memory used, since `distribute` won't use more than `element_size` *
-      `max_outstanding_requests` of memory.
+      `max_outstanding_requests` of memory, plus up to a megabyte per request
+      for batches of small elements.
     task_refresh_interval_hint_ms: (Optional.) A hint for how often to query the
       master for task changes.
 
@@ -268,7 +271,7 @@ def distribute(processing_mode,
   iteration.
 
   The `processing_mode` argument controls what data is produced by a tf.data
-  service job. Currently, the only supported mode is "parallel_epochs".
+  service job. The supported modes are "parallel_epochs" and "one_epoch".
 
   processing_mode="parallel_epochs" means that multiple tf.data workers will
   iterate through the dataset in parallel, each producing all elements of the
@@ -279,9 +282,16 @@ def distribute(processing_mode,
   your dataset, so that different tf.data workers will iterate through the
   dataset in different orders.
 
-  In the future, there will be additional processing modes. For example,
-  a "one_epoch" mode which partitions the dataset across the tf.data
-  workers, so that the consumers see each element of the dataset only once.
+  processing_mode="one_epoch" means that the tf.data workers share a single
+  iteration through the dataset, so that the consumers see each element of the
+  dataset only once. The dataset is divided into splits, which the tf.data
+  master hands out to workers as they finish their previous split, so that
+  faster workers process more of the dataset. Datasets which read files are
+  split by their files, and other datasets are split by their elements, in
+  which case every worker runs the preprocessing before the split. Each split
+  is produced by a separate iteration through the dataset, so the dataset must
+  produce its elements in a deterministic order, e.g. by seeding any shuffling
+  that happens before the dataset is split.
 
   ```
   dataset = tf.data.Dataset.range(5)
@@ -362,8 +372,8 @@ def distribute(processing_mode,
 
   Args:
     processing_mode: A string specifying the policy for how data should be
-      processed by tf.data workers. Currently, the only supported value is
-      "parallel_epochs".
+      processed by tf.data workers. Supported values are "parallel_epochs" and
+      "one_epoch".
     service: A string indicating how to connect to the tf.data service. The
       string should be in the format <protocol>://<address>, e.g.
       grpc://localhost:5000.
@@ -373,7 +383,8 @@ def distribute(processing_mode,
     max_outstanding_requests: (Optional.) A limit on how many elements may be
       requested at the same time. You can use this option to control the amount
       of memory used, since `distribute` won't use more than `element_size` *
-      `max_outstanding_requests` of memory.
+      `max_outstanding_requests` of memory, plus up to a megabyte per request
+      for batches of small elements.
 
   Returns:
     Dataset: A `Dataset` of the elements produced by the data service.
@@ -34,6 +34,7 @@ class AutoShardPolicy(enum.IntEnum):
   AUTO = 0
   FILE = 1
   DATA = 2
+  BALANCED_FILE = 3
 
 
 class ExternalStatePolicy(enum.Enum):
@@ -67,6 +68,9 @@ class DistributeOptions(options.OptionsBase):
       "option is selected, make sure that you have enough files so that each "
       "worker gets at least one file. There will be a runtime error thrown if "
       "there are insufficient files. "
+      "If this is set to BALANCED_FILE, then we will shard by files like FILE, "
+      "but when the file names are a constant, the files are assigned to "
+      "workers so that each reads about the same number of bytes. "
       "If this is set to DATA, then we will shard by elements produced by the "
       "dataset, and each worker will process the whole dataset and discard the "
       "portion that is not for itself. "
@@ -52,6 +52,17 @@ class MapVectorizationOptions(options.OptionsBase):
       "original segment at runtime based on their iterations speed. If None, "
       "defaults to False.")
 
+  micro_batch_size = options.create_option(
+      name="micro_batch_size",
+      ty=int,
+      docstring=
+      "If positive, parallel map transformations that are not followed by a "
+      "batch transformation are also vectorized, provided that their function "
+      "can be vectorized completely. The function then processes groups of "
+      "`micro_batch_size` elements at a time, which amortizes its per-call "
+      "overhead for cheap functions. If None, defaults to 0, which leaves "
+      "these map transformations as they are.")
+
   def _graph_rewrites(self):
     if self.enabled:
       return ["map_vectorization"]
@@ -61,9 +72,13 @@ class MapVectorizationOptions(options.OptionsBase):
     if not self.enabled:
       return []
     if self.use_choose_fastest:
-      return ["map_vectorization:use_choose_fastest:true"]
+      result = ["map_vectorization:use_choose_fastest:true"]
     else:
-      return ["map_vectorization:use_choose_fastest:false"]
+      result = ["map_vectorization:use_choose_fastest:false"]
+    if self.micro_batch_size:
+      result.append(
+          "map_vectorization:micro_batch_size:%d" % self.micro_batch_size)
+    return result
 
 
 @tf_export("data.experimental.OptimizationOptions")
@@ -96,6 +111,15 @@ class OptimizationOptions(options.OptionsBase):
       "Whether to automatically tune performance knobs. If None, defaults to "
       "True.")
 
+  autotune_account_for_step_threads = options.create_option(
+      name="autotune_account_for_step_threads",
+      ty=bool,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines whether the "
+      "intra-op threads running the computation that consumes the input "
+      "pipeline are deducted from the CPU budget, so that the input pipeline "
+      "does not compete with them. If None, defaults to False.")
+
   autotune_buffers = options.create_option(
       name="autotune_buffers",
       ty=bool,
@@ -113,6 +137,14 @@ class OptimizationOptions(options.OptionsBase):
       "are allowed but may result in CPU contention. If None, defaults to the "
       "number of schedulable CPU cores.")
 
+  autotune_ram_budget = options.create_option(
+      name="autotune_ram_budget",
+      ty=int,
+      docstring=
+      "When autotuning is enabled (through `autotune`), determines the RAM "
+      "budget, in bytes, that the buffers of the input pipeline may use. If "
+      "None, defaults to half of the available RAM.")
+
   filter_fusion = options.create_option(
       name="filter_fusion",
       ty=bool,
@@ -203,14 +235,21 @@ class OptimizationOptions(options.OptionsBase):
         _AutotuneAlgorithm.GRADIENT_DESCENT
         if self._autotune_buffers() else _AutotuneAlgorithm.HILL_CLIMB)
     cpu_budget = 0  # Indicates that all CPU cores should be used by default.
+    ram_budget = 0  # Indicates that the default share of RAM should be used.
+    account_for_step_threads = False
 
     # Set these options if they are explicitly set by the user.
     if self.autotune is False:  # pylint: disable=g-bool-id-comparison
       autotune = False
     if self.autotune_cpu_budget is not None:
       cpu_budget = self.autotune_cpu_budget
+    if self.autotune_ram_budget is not None:
+      ram_budget = self.autotune_ram_budget
+    if self.autotune_account_for_step_threads:
+      account_for_step_threads = True
 
-    return autotune, algorithm, cpu_budget
+    return (autotune, algorithm, cpu_budget, ram_budget,
+            account_for_step_threads)
 
   def _graph_rewrites(self):
     """Produces the list of enabled graph optimizations."""
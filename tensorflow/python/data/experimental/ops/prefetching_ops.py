@@ -19,6 +19,7 @@ from __future__ import print_function
 
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import iterator_ops
+from tensorflow.python.data.ops import multi_device_iterator_ops
 from tensorflow.python.data.util import structure
 from tensorflow.python.eager import function
 from tensorflow.python.framework import device as framework_device
@@ -100,6 +101,9 @@ class _CopyToDeviceDataset(dataset_ops.UnaryUnchangedStructureDataset):
     self._is_gpu_target = (spec.device_type == "GPU")
     self._source_device_string = source_device
     self._source_device = ops.convert_to_tensor(source_device)
+    # Packed elements are copied to the target with a single memcpy.
+    self._pack_element = multi_device_iterator_ops.should_pack_element(
+        self._input_dataset.element_spec, self._target_device)
 
     wrap_ds_variant = gen_dataset_ops.wrap_dataset_variant(
         self._input_dataset._variant_tensor)  # pylint: disable=protected-access
@@ -146,7 +150,11 @@ class _CopyToDeviceDataset(dataset_ops.UnaryUnchangedStructureDataset):
             dataset_ops.get_legacy_output_types(self),
             dataset_ops.get_legacy_output_shapes(self),
             dataset_ops.get_legacy_output_classes(self))
-      return structure.to_tensor_list(self.element_spec, iterator.get_next())
+      components = structure.to_tensor_list(self.element_spec,
+                                            iterator.get_next())
+      if self._pack_element:
+        return [ged_ops.pack_element(components)]
+      return components
 
     next_func_concrete = _next_func._get_concrete_function_internal()  # pylint: disable=protected-access
 
@@ -154,11 +162,20 @@ class _CopyToDeviceDataset(dataset_ops.UnaryUnchangedStructureDataset):
         input_signature=[tensor_spec.TensorSpec([], dtypes.string)],
         attributes={"experimental_ints_on_device": True})
     def _remote_next_func(string_handle):
-      return functional_ops.remote_call(
+      if not self._pack_element:
+        return functional_ops.remote_call(
+            target=self._source_device,
+            args=[string_handle] + next_func_concrete.captured_inputs,
+            Tout=self._input_dataset._flat_types,  # pylint: disable=protected-access
+            f=next_func_concrete)
+      packed = functional_ops.remote_call(
           target=self._source_device,
           args=[string_handle] + next_func_concrete.captured_inputs,
-          Tout=self._input_dataset._flat_types,  # pylint: disable=protected-access
+          Tout=[dtypes.uint8],
           f=next_func_concrete)
+      return ged_ops.unpack_element(
+          packed[0],
+          **self._input_dataset._flat_structure)  # pylint: disable=protected-access
 
     self._next_func = _remote_next_func._get_concrete_function_internal()  # pylint: disable=protected-access
     self._next_captured_args = self._next_func.captured_inputs
@@ -0,0 +1,113 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Sharing the elements of an input pipeline between processes of a host.
+
+With one trainer process per accelerator, every process would otherwise run
+its own copy of the input pipeline. Instead, one process can publish the
+elements of a single pipeline to shared memory, and every trainer process
+reads its shard of them:
+
+```python
+# In the producer process.
+dataset = ...  # The expensive input pipeline.
+publish_to_shared_memory(dataset, "my_pipeline", num_consumers=8)
+
+# In trainer process `i`.
+dataset = SharedMemoryDataset("my_pipeline", element_spec, num_consumers=8,
+                              index=i)
+```
+
+Like `Dataset.shard`, the consumer with index `i` gets the elements `i`,
+`i + num_consumers`, `i + 2 * num_consumers`, and so on. Elements are read
+without copying, so a consumer can keep at most `num_slots` elements alive at
+the same time. Only numeric and boolean components are supported.
+"""
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
+
+
+def publish_to_shared_memory(dataset,
+                             shared_memory_name,
+                             num_consumers,
+                             num_slots=16,
+                             slot_bytes=16 * 1024 * 1024):
+  """Publishes the elements of `dataset` to its consumer processes.
+
+  The returned operation runs until all elements are published and every
+  consumer read its shard of them.
+
+  Args:
+    dataset: A `tf.data.Dataset` whose elements are published.
+    shared_memory_name: A `tf.string` scalar naming the shared memory, which
+      consumers pass to `SharedMemoryDataset`. Must not contain '/'.
+    num_consumers: A `tf.int64` scalar, the number of consumer processes.
+    num_slots: The number of elements that can be in flight to every
+      consumer.
+    slot_bytes: The maximum number of bytes of an element. Every component
+      takes up a multiple of 64 bytes.
+
+  Returns:
+    In graph mode, the operation that publishes the elements. In eager mode,
+    the elements are published by this function and there is no return value.
+
+  Raises:
+    TypeError: if `dataset` is not a `tf.data.Dataset`.
+  """
+  if not isinstance(dataset, dataset_ops.DatasetV2):
+    raise TypeError("`dataset` must be a `tf.data.Dataset` object.")
+  return gen_experimental_dataset_ops.dataset_to_shared_memory(
+      dataset._variant_tensor,  # pylint: disable=protected-access
+      shared_memory_name=ops.convert_to_tensor(
+          shared_memory_name, dtype=dtypes.string, name="shared_memory_name"),
+      num_consumers=ops.convert_to_tensor(
+          num_consumers, dtype=dtypes.int64, name="num_consumers"),
+      num_slots=num_slots,
+      slot_bytes=slot_bytes)
+
+
+class SharedMemoryDataset(dataset_ops.DatasetSource):
+  """A `Dataset` of the elements published with `publish_to_shared_memory`."""
+
+  def __init__(self, shared_memory_name, element_spec, num_consumers, index):
+    """Creates a `SharedMemoryDataset`.
+
+    Args:
+      shared_memory_name: A `tf.string` scalar, the name that the producer
+        publishes the elements with.
+      element_spec: The element spec of the published dataset.
+      num_consumers: A `tf.int64` scalar, the number of consumer processes.
+      index: A `tf.int64` scalar, the index of this consumer in
+        `[0, num_consumers)`.
+    """
+    self._element_spec = element_spec
+    variant_tensor = gen_experimental_dataset_ops.shared_memory_dataset(
+        shared_memory_name=ops.convert_to_tensor(
+            shared_memory_name, dtype=dtypes.string,
+            name="shared_memory_name"),
+        num_consumers=ops.convert_to_tensor(
+            num_consumers, dtype=dtypes.int64, name="num_consumers"),
+        index=ops.convert_to_tensor(index, dtype=dtypes.int64, name="index"),
+        **self._flat_structure)
+    super(SharedMemoryDataset, self).__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return self._element_spec
@@ -23,6 +23,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops
 from tensorflow.python.util import deprecation
 from tensorflow.python.util.tf_export import tf_export
 
@@ -107,3 +108,58 @@ def shuffle_and_repeat(buffer_size, count=None, seed=None):
     return _ShuffleAndRepeatDataset(dataset, buffer_size, count, seed)
 
   return _apply_fn
+
+
+class _GlobalShuffleDataset(dataset_ops.UnaryUnchangedStructureDataset):
+  """A `Dataset` that shuffles all the elements of a random-access dataset."""
+
+  def __init__(self, input_dataset, seed=None, reshuffle_each_iteration=True):
+    """See `global_shuffle()` for details."""
+    self._input_dataset = input_dataset
+    self._seed, self._seed2 = random_seed.get_seed(seed)
+    variant_tensor = gen_experimental_dataset_ops.global_shuffle_dataset(
+        self._input_dataset._variant_tensor,  # pylint: disable=protected-access
+        seed=self._seed,
+        seed2=self._seed2,
+        reshuffle_each_iteration=reshuffle_each_iteration,
+        **self._flat_structure)
+    super(_GlobalShuffleDataset, self).__init__(input_dataset, variant_tensor)
+
+
+def global_shuffle(seed=None, reshuffle_each_iteration=True):
+  """Shuffles all the elements of a dataset that supports random access.
+
+  Unlike `tf.data.Dataset.shuffle`, which samples from a buffer of elements,
+  this transformation reads the elements of its input on demand, in the order
+  of a pseudo-random permutation of their indices. Every order of the elements
+  is thus possible, and no elements are buffered, however large the dataset:
+
+  ```python
+  dataset = tf.data.FixedLengthRecordDataset(filenames, record_bytes=1024)
+  dataset = dataset.apply(global_shuffle(seed=42))
+  ```
+
+  The input must support random access. `tf.data.Dataset.range`,
+  `tf.data.Dataset.from_tensor_slices`, uncompressed
+  `tf.data.FixedLengthRecordDataset`s and columnar datasets without a
+  predicate do; iterating over other datasets raises an
+  `InvalidArgumentError`. Since it does not consume the elements of its input
+  in order, it must be applied directly to the source dataset.
+
+  Args:
+    seed: (Optional.) A `tf.int64` scalar `tf.Tensor`, representing the random
+      seed that will be used to create the permutation. See
+      `tf.random.set_seed` for behavior.
+    reshuffle_each_iteration: (Optional.) A boolean, which if true indicates
+      that the dataset should be pseudorandomly reshuffled each time it is
+      iterated over. (Defaults to `True`.)
+
+  Returns:
+    A `Dataset` transformation function, which can be passed to
+    `tf.data.Dataset.apply`.
+  """
+
+  def _apply_fn(dataset):
+    return _GlobalShuffleDataset(dataset, seed, reshuffle_each_iteration)
+
+  return _apply_fn
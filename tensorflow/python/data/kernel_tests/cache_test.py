@@ -381,5 +381,67 @@ class MemoryCacheTest(test_base.DatasetTestBase, parameterized.TestCase):
       self.assertEqual(next(it), results[i])
 
 
+
+class HybridCacheTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def setUp(self):
+    super(HybridCacheTest, self).setUp()
+    self.tmp_dir = tempfile.mkdtemp()
+    self.cache_prefix = path.join(self.tmp_dir, "cache")
+
+  def tearDown(self):
+    if self.tmp_dir:
+      shutil.rmtree(self.tmp_dir, ignore_errors=True)
+    super(HybridCacheTest, self).tearDown()
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testCacheRepeatEpochs(self):
+    counter = variables.Variable(0)
+    self.evaluate(counter.initializer)
+
+    def increment_fn(x):
+      counter.assign_add(1)
+      return x
+
+    # Only the first four elements fit in the memory budget.
+    dataset = dataset_ops.Dataset.range(10).map(increment_fn)
+    dataset = dataset_ops.CacheDataset(
+        dataset, self.cache_prefix, memory_budget=32).repeat(3)
+    get_next = self.getNext(dataset, requires_initialization=True)
+
+    for i in range(10):
+      self.assertEqual(i, self.evaluate(counter))
+      self.assertEqual(i, self.evaluate(get_next()))
+    for _ in range(2):
+      for i in range(10):
+        self.assertEqual(10, self.evaluate(counter))
+        self.assertEqual(i, self.evaluate(get_next()))
+    with self.assertRaises(errors.OutOfRangeError):
+      self.evaluate(get_next())
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testStringElements(self):
+    words = [b"a", b"bb", b"ccc", b"dddd", b"eeeee"]
+    dataset = dataset_ops.Dataset.from_tensor_slices(words)
+    dataset = dataset_ops.CacheDataset(
+        dataset, self.cache_prefix, memory_budget=2).repeat(2)
+    self.assertDatasetProduces(dataset, expected_output=words + words)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testEverythingFitsInMemory(self):
+    dataset = dataset_ops.CacheDataset(
+        dataset_ops.Dataset.range(10), self.cache_prefix,
+        memory_budget=1 << 20).repeat(2)
+    self.assertDatasetProduces(dataset, expected_output=list(range(10)) * 2)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testMemoryBudgetRequiresFilename(self):
+    with self.assertRaisesRegexp(errors.InvalidArgumentError,
+                                 "needs a filename"):
+      dataset = dataset_ops.CacheDataset(
+          dataset_ops.Dataset.range(10), "", memory_budget=32)
+      self.evaluate(self.getNext(dataset)())
+
+
 if __name__ == "__main__":
   test.main()
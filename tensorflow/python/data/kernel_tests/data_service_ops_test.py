@@ -40,11 +40,14 @@ from tensorflow.python.platform import test
 PROTOCOL = "grpc"
 
 
-def _make_distributed_dataset(dataset, address, job_name=None):
+def _make_distributed_dataset(dataset,
+                              address,
+                              job_name=None,
+                              processing_mode="parallel_epochs"):
   """Creates a distributed dataset with a short task refresh interval."""
   return dataset.apply(
       data_service_ops._distribute(
-          "parallel_epochs",
+          processing_mode,
           "{0}://{1}".format(PROTOCOL, address),
           job_name=job_name,
           task_refresh_interval_hint_ms=20))
@@ -176,6 +179,54 @@ class DataServiceOpsTest(test_base.DatasetTestBase, parameterized.TestCase):
     results = [elem.numpy() for elem in ds]
     self.assertCountEqual(num_workers * list(range(num_elements)), results)
 
+  @combinations.generate(test_base.eager_only_combinations())
+  def testOneEpoch(self):
+    num_workers = 3
+    num_elements = 100
+    master_address = self.create_cluster(num_workers)
+    ds = dataset_ops.Dataset.range(num_elements)
+    ds = ds.map(lambda x: x * x)
+    ds = _make_distributed_dataset(
+        ds, master_address, processing_mode="one_epoch")
+    results = [elem.numpy() for elem in ds]
+    self.assertCountEqual([x * x for x in range(num_elements)], results)
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testOneEpochMultipleEpochs(self):
+    num_elements = 10
+    master_address = self.create_cluster(2)
+    ds = dataset_ops.Dataset.range(num_elements)
+    ds = _make_distributed_dataset(
+        ds, master_address, processing_mode="one_epoch")
+    for _ in range(3):
+      self.assertCountEqual(
+          list(range(num_elements)), [elem.numpy() for elem in ds])
+
+  @combinations.generate(test_base.eager_only_combinations())
+  def testOneEpochAddWorkerMidJob(self):
+    self._master = server_lib.MasterServer(port=0, protocol=PROTOCOL)
+    self._worker = server_lib.WorkerServer(
+        port=0, master_address=self._master._address, protocol=PROTOCOL)
+    num_elements = 100
+    ds = dataset_ops.Dataset.range(num_elements)
+    ds = _make_distributed_dataset(
+        ds, self._master._address, processing_mode="one_epoch")
+    iterator = iter(ds)
+    results = []
+    for _ in range(num_elements // 10):
+      results.append(next(iterator).numpy())
+
+    self._new_worker = server_lib.WorkerServer(
+        port=0, master_address=self._master._address, protocol=PROTOCOL)
+    while self._master._num_workers() < 2:
+      time.sleep(10 / 1000)  # 10ms
+
+    # The new worker takes over some of the remaining splits, without
+    # producing any element twice.
+    for elem in iterator:
+      results.append(elem.numpy())
+    self.assertCountEqual(list(range(num_elements)), results)
+
   @combinations.generate(test_base.eager_only_combinations())
   def testAddWorkerMidJob(self):
     self._master = server_lib.MasterServer(port=0, protocol=PROTOCOL)
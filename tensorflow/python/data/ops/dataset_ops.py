@@ -387,10 +387,12 @@ class DatasetV2(collections.Iterable, tracking_base.Trackable,
                                    graph_rewrite_configs)
 
     # (3) Apply autotune options
-    autotune, algorithm, cpu_budget = options._autotune_settings()  # pylint: disable=protected-access
+    (autotune, algorithm, cpu_budget, ram_budget,
+     account_for_step_threads) = options._autotune_settings()  # pylint: disable=protected-access
 
     if autotune:
-      dataset = _ModelDataset(dataset, algorithm, cpu_budget)
+      dataset = _ModelDataset(dataset, algorithm, cpu_budget, ram_budget,
+                              account_for_step_threads)
 
     # (4) Apply stats aggregator options
     if options.experimental_stats and options.experimental_stats.aggregator:  # pylint: disable=line-too-long
@@ -3610,22 +3612,34 @@ class RangeDataset(DatasetSource):
 class CacheDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that caches elements of its input."""
 
-  def __init__(self, input_dataset, filename):
-    """See `Dataset.cache()` for details."""
+  def __init__(self, input_dataset, filename, memory_budget=None):
+    """See `Dataset.cache()` for details.
+
+    Args:
+      input_dataset: The input dataset.
+      filename: A `tf.string` scalar `tf.Tensor`, the name of a file to cache
+        the elements in, or the empty string to cache them in memory.
+      memory_budget: (Optional.) If positive, the number of bytes of leading
+        elements to keep in memory. The remaining elements are spilled to a
+        file with the `filename` prefix, which must not be empty.
+    """
     self._input_dataset = input_dataset
     self._filename = ops.convert_to_tensor(
         filename, dtype=dtypes.string, name="filename")
+    kwargs = dict(self._flat_structure)
+    if memory_budget:
+      kwargs["memory_budget"] = memory_budget
     if tf2.enabled() and (context.executing_eagerly() or ops.inside_function()):
       variant_tensor = gen_dataset_ops.cache_dataset_v2(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
           cache=gen_dataset_ops.dummy_memory_cache(),
-          **self._flat_structure)
+          **kwargs)
     else:
       variant_tensor = gen_dataset_ops.cache_dataset(
           input_dataset._variant_tensor,  # pylint: disable=protected-access
           filename=self._filename,
-          **self._flat_structure)
+          **kwargs)
     super(CacheDataset, self).__init__(input_dataset, variant_tensor)
 
 
@@ -4372,12 +4386,15 @@ class _OptionsDataset(UnaryUnchangedStructureDataset):
 class _ModelDataset(UnaryUnchangedStructureDataset):
   """A `Dataset` that acts as an identity, and models performance."""
 
-  def __init__(self, input_dataset, algorithm, cpu_budget):
+  def __init__(self, input_dataset, algorithm, cpu_budget, ram_budget=0,
+               account_for_step_threads=False):
     self._input_dataset = input_dataset
     variant_tensor = gen_dataset_ops.model_dataset(
         input_dataset._variant_tensor,  # pylint: disable=protected-access
         algorithm=algorithm.value,
         cpu_budget=cpu_budget,
+        ram_budget=ram_budget,
+        account_for_step_threads=account_for_step_threads,
         **self._flat_structure)
     super(_ModelDataset, self).__init__(input_dataset, variant_tensor)
 
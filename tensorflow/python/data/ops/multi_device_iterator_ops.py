@@ -23,6 +23,7 @@ from tensorflow.python.data.util import structure
 from tensorflow.python.eager import context
 from tensorflow.python.eager import function
 from tensorflow.python.framework import composite_tensor
+from tensorflow.python.framework import device as framework_device
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
@@ -32,14 +33,42 @@ from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import functional_ops
 from tensorflow.python.ops import gen_dataset_ops
+from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 from tensorflow.python.ops import resource_variable_ops
 
 
+def should_pack_element(element_spec, device):
+  """Returns whether elements should be packed for copying to `device`.
+
+  A packed element is a single buffer of pinned host memory, which is copied
+  to a GPU with one asynchronous memcpy instead of one copy per component.
+  This requires components with fully defined shapes and types that can be
+  copied with memcpy.
+
+  Args:
+    element_spec: The element spec of the copied elements.
+    device: The name of the device that the elements are copied to.
+
+  Returns:
+    Whether elements should be packed with `PackElement` on the source device
+    and unpacked with `UnpackElement` on `device`.
+  """
+  spec = framework_device.DeviceSpec.from_string(device)
+  if spec.device_type != "GPU":
+    return False
+  for component_spec in structure.get_flat_tensor_specs(element_spec):
+    if (not component_spec.shape.is_fully_defined() or
+        component_spec.dtype in (dtypes.string, dtypes.variant,
+                                 dtypes.resource)):
+      return False
+  return True
+
+
 class _PerDeviceGenerator(dataset_ops.DatasetV2):
   """A `dummy` generator dataset."""
 
   def __init__(self, shard_num, multi_device_iterator_resource, incarnation_id,
-               source_device, element_spec):
+               source_device, element_spec, pack_element=False):
     self._element_spec = element_spec
 
     multi_device_iterator_string_handle = (
@@ -77,12 +106,15 @@ class _PerDeviceGenerator(dataset_ops.DatasetV2):
               output_types=structure.get_flat_tensor_types(self._element_spec),
               output_shapes=structure.get_flat_tensor_shapes(
                   self._element_spec)))
-      return gen_dataset_ops.multi_device_iterator_get_next_from_shard(
+      components = gen_dataset_ops.multi_device_iterator_get_next_from_shard(
           multi_device_iterator=multi_device_iterator,
           shard_num=shard_num,
           incarnation_id=incarnation_id,
           output_types=structure.get_flat_tensor_types(self._element_spec),
           output_shapes=structure.get_flat_tensor_shapes(self._element_spec))
+      if pack_element:
+        return [ged_ops.pack_element(components)]
+      return components
 
     next_func_concrete = _next_func.get_concrete_function()
 
@@ -92,11 +124,21 @@ class _PerDeviceGenerator(dataset_ops.DatasetV2):
         attributes={"experimental_ints_on_device": True},
         autograph=False)  # Pure graph code.
     def _remote_next_func(string_handle):
-      return functional_ops.remote_call(
+      if not pack_element:
+        return functional_ops.remote_call(
+            target=source_device,
+            args=[string_handle] + next_func_concrete.captured_inputs,
+            Tout=structure.get_flat_tensor_types(self._element_spec),
+            f=next_func_concrete)
+      packed = functional_ops.remote_call(
           target=source_device,
           args=[string_handle] + next_func_concrete.captured_inputs,
-          Tout=structure.get_flat_tensor_types(self._element_spec),
+          Tout=[dtypes.uint8],
           f=next_func_concrete)
+      return ged_ops.unpack_element(
+          packed[0],
+          output_types=structure.get_flat_tensor_types(self._element_spec),
+          output_shapes=structure.get_flat_tensor_shapes(self._element_spec))
 
     self._next_func = _remote_next_func.get_concrete_function()
     self._next_captured_args = self._next_func.captured_inputs
@@ -271,10 +313,14 @@ class MultiDeviceIterator(object):
     self._prototype_device_datasets = []
     for i, device in enumerate(self._devices):
       with ops.device(device):
-        ds = _PerDeviceGenerator(i, self._multi_device_iterator_resource,
-                                 self._incarnation_id,
-                                 self._source_device_tensor,
-                                 self._dataset.element_spec)
+        ds = _PerDeviceGenerator(
+            i,
+            self._multi_device_iterator_resource,
+            self._incarnation_id,
+            self._source_device_tensor,
+            self._dataset.element_spec,
+            pack_element=should_pack_element(self._dataset.element_spec,
+                                             device))
         self._prototype_device_datasets.append(ds)
 
     # TODO(rohanj): Explore the possibility of the MultiDeviceIterator to
@@ -542,9 +588,13 @@ class OwnedMultiDeviceIterator(composite_tensor.CompositeTensor):
       prototype_device_datasets = []
       for i, device in enumerate(self._devices):
         with ops.device(device):
-          ds = _PerDeviceGenerator(i, self._multi_device_iterator_resource,
-                                   incarnation_id, source_device_tensor,
-                                   dataset.element_spec)
+          ds = _PerDeviceGenerator(
+              i,
+              self._multi_device_iterator_resource,
+              incarnation_id,
+              source_device_tensor,
+              dataset.element_spec,
+              pack_element=should_pack_element(dataset.element_spec, device))
           prototype_device_datasets.append(ds)
 
       # TODO(rohanj): Explore the possibility of the MultiDeviceIterator to
@@ -53,8 +53,10 @@ class Hints(object):
     Args:
       bytes_per_pack: A non-negative integer. Breaks collective operations into
         packs of certain size. If it's zero, the value is determined
-        automatically. This only applies to all-reduce with
-        `MultiWorkerMirroredStrategy` currently.
+        automatically. If it's positive, the dense values of each pack are
+        concatenated and all-reduced by a single collective operation. This
+        only applies to all-reduce with `MultiWorkerMirroredStrategy`
+        currently.
 
     Raises:
       ValueError: When arguments have invalid value.
@@ -1090,6 +1090,27 @@ class CollectiveAllReduce(CrossDeviceOps):
       # we ensure they will be picked up by the `ScopedAllocator` grappler
       # optimizer and packed into a single all-reduce.
       with self._lock, ops.name_scope("allreduce"):
+        if (experimental_hints.bytes_per_pack > 0 and
+            cross_device_utils.can_fuse(pack)):
+          # Explicitly sized packs are fused into one buffer, so that they
+          # need a single collective whether or not `ScopedAllocator` applies.
+          if (communication == CollectiveCommunication.NCCL.value and
+              reduced_values):
+            control_inputs = list(reduced_values[-1])
+          else:
+            control_inputs = None
+          reduced_values.extend(
+              cross_device_utils.build_fused_collective_reduce(
+                  [per_replica.values for per_replica in pack],
+                  self._devices,
+                  self._group_size,
+                  self._collective_keys,
+                  "Add",
+                  "Id",
+                  communication,
+                  control_inputs,
+                  executors=self._executors))
+          continue
         for per_replica in pack:
           # Add control dependencies per device from the last gradients to the
           # current set, in order to serialize NCCL launches.
@@ -783,7 +783,7 @@ class CollectiveAllReduceTest(multi_worker_test_base.MultiWorkerTestBase,
           mode=["graph"],
           required_gpus=[0, 1, 2],
           use_strategy_object=[True, False],
-          bytes_per_pack=[0, 1, 4]))
+          bytes_per_pack=[0, 1, 4, 1024]))
   def testReductionDistributed(self, required_gpus, use_strategy_object,
                                bytes_per_pack):
     hints = collective_util.Hints(bytes_per_pack=bytes_per_pack)
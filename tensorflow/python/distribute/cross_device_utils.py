@@ -388,6 +388,78 @@ def build_collective_reduce(input_tensors,
   return out_tensors
 
 
+def build_fused_collective_reduce(input_tensors_list,
+                                  devices,
+                                  group_size,
+                                  collective_keys,
+                                  reduction_op='Add',
+                                  unary_op='Id',
+                                  communication_hint='AUTO',
+                                  control_inputs=None,
+                                  executors=None):
+  """Build a subgraph that all-reduces several tensors with one collective.
+
+  On each device the tensors are flattened and concatenated into one buffer,
+  which is reduced by a single collective and then split back.  This pays the
+  latency of one collective instead of one per tensor, at the cost of copying
+  the tensors into and out of the buffer, so it suits many small tensors.
+
+  Args:
+    input_tensors_list: a list of lists of tensors, where
+      `input_tensors_list[i][j]` is the i-th value on the j-th device.  All
+      tensors must have the same dtype, and the tensors of a value the same
+      fully defined shape.
+    devices: a list of device strings to run the collective on.
+    group_size: total number of devices globally that will be doing this same
+      reduction.
+    collective_keys: a CollectiveKeys object.
+    reduction_op: string naming the reduction op.
+    unary_op: string naming the unary final op.
+    communication_hint: string providing hint to runtime for choosing collective
+      implementation.
+    control_inputs: if not None, add control edges between control_inputs and
+      (index-wise) corresponding collective_reduce tensors
+    executors: a list of async executor. Required for eager execution.
+
+  Returns:
+    A list of lists of reduced tensors with the structure of
+    `input_tensors_list`.
+  """
+  shapes = [tensors[0].shape for tensors in input_tensors_list]
+  sizes = [shape.num_elements() for shape in shapes]
+  fused_tensors = []
+  for idx, device in enumerate(devices):
+    with ops.device(device):
+      fused_tensors.append(
+          array_ops.concat([
+              array_ops.reshape(tensors[idx], [-1])
+              for tensors in input_tensors_list
+          ], axis=0))
+  reduced_tensors = build_collective_reduce(
+      fused_tensors, devices, group_size, collective_keys, reduction_op,
+      unary_op, communication_hint, control_inputs, executors)
+  output_tensors_list = [[] for _ in input_tensors_list]
+  for idx, device in enumerate(devices):
+    with ops.device(device):
+      parts = array_ops.split(reduced_tensors[idx], sizes)
+      for i, part in enumerate(parts):
+        output_tensors_list[i].append(array_ops.reshape(part, shapes[i]))
+  return output_tensors_list
+
+
+def can_fuse(per_replica_list):
+  """Returns whether `build_fused_collective_reduce` can reduce the values."""
+  if len(per_replica_list) < 2:
+    return False
+  dtype = per_replica_list[0]._primary.dtype  # pylint: disable=protected-access
+  for value in per_replica_list:
+    if value._primary.dtype != dtype:  # pylint: disable=protected-access
+      return False
+    if per_replica_num_elements(value) is None:
+      return False
+  return True
+
+
 def build_collective_gather(input_tensors,
                             devices,
                             group_size,
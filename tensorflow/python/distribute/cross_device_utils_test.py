@@ -218,5 +218,37 @@ class PackBySizeTest(test.TestCase):
     self.assertEqual(packs[0], per_replica_values)
 
 
+
+class FusedCollectiveReduceTest(test.TestCase):
+
+  def testCanFuse(self):
+    a = array_ops.ones([2, 3], dtype=dtypes.float32)
+    b = array_ops.ones([4], dtype=dtypes.float32)
+    c = array_ops.ones([4], dtype=dtypes.int32)
+    self.assertTrue(
+        cross_device_utils.can_fuse(
+            [value_lib.PerReplica([a, a]),
+             value_lib.PerReplica([b, b])]))
+    # A single value needs no fusion.
+    self.assertFalse(
+        cross_device_utils.can_fuse([value_lib.PerReplica([a, a])]))
+    self.assertFalse(
+        cross_device_utils.can_fuse(
+            [value_lib.PerReplica([a, a]),
+             value_lib.PerReplica([c, c])]))
+
+  def testSplitsBackToInputShapes(self):
+    # With a group of one device the collective is the identity, so the result
+    # shows how the buffer is split back.
+    with ops.Graph().as_default(), self.cached_session():
+      a = constant_op.constant([[1., 2., 3.], [4., 5., 6.]])
+      b = constant_op.constant([7., 8.])
+      result = cross_device_utils.build_fused_collective_reduce(
+          [[a], [b]], ["/cpu:0"], 1, cross_device_utils.CollectiveKeys())
+      self.assertLen(result, 2)
+      self.assertAllEqual([[1., 2., 3.], [4., 5., 6.]],
+                          self.evaluate(result[0][0]))
+      self.assertAllEqual([7., 8.], self.evaluate(result[1][0]))
+
 if __name__ == "__main__":
   test.main()
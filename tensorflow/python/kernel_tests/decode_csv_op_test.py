@@ -329,6 +329,38 @@ class DecodeCSVOpTest(test.TestCase):
     else:
       self._test(args, expected_err_re="Expected list for 'record_defaults'")
 
+  def testManyRecords(self):
+    # Large batches are decoded by several threads.
+    num_records = 10000
+    args = {
+        "records": [
+            '%d,"%d ""quoted"", with a comma",%d.5' % (i, i, i)
+            for i in range(num_records)
+        ],
+        "record_defaults": [[0], [""], [0.0]],
+    }
+
+    expected_out = [
+        list(range(num_records)),
+        [b'%d "quoted", with a comma' % i for i in range(num_records)],
+        [i + 0.5 for i in range(num_records)]
+    ]
+
+    self._test(args, expected_out)
+
+  def testManyRecordsReportsFirstError(self):
+    records = ["%d" % i for i in range(10000)]
+    records[5000] = "x"
+    records[9000] = "y"
+    args = {
+        "records": records,
+        "record_defaults": [[0]],
+    }
+
+    self._test(
+        args,
+        expected_err_re="Field 0 in record 5000 is not a valid int32: x")
+
 
 if __name__ == "__main__":
   test.main()
@@ -24,6 +24,8 @@ import numpy as np
 
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_image_ops
 from tensorflow.python.ops import image_ops
 from tensorflow.python.ops import io_ops
 import tensorflow.python.ops.nn_grad  # pylint: disable=unused-import
@@ -97,6 +99,25 @@ class DecodeImageOpTest(test.TestCase):
       with self.assertRaises(errors_impl.InvalidArgumentError):
         self.evaluate(bad_channels)
 
+  def testDecodeAndResizeJpeg(self):
+    # The 256x128 image is decoded at a quarter of its size for both sizes.
+    path = os.path.join(prefix_path, "jpeg", "testdata", "jpeg_merge_test1.jpg")
+    jpeg0 = io_ops.read_file(path)
+    decoded = array_ops.expand_dims(
+        gen_image_ops.decode_jpeg(jpeg0, channels=3, ratio=4), 0)
+    for size in [64, 32], [50, 30]:
+      images = gen_image_ops.decode_and_resize_jpeg([jpeg0, jpeg0], size)
+      expected = gen_image_ops.resize_bilinear(
+          decoded, size, half_pixel_centers=True)
+      images, expected = self.evaluate([images, expected])
+      self.assertEqual(images.shape, (2, size[0], size[1], 3))
+      self.assertAllClose(images[0], expected[0])
+      self.assertAllClose(images[1], expected[0])
+
+    with self.assertRaises(errors_impl.InvalidArgumentError):
+      self.evaluate(
+          gen_image_ops.decode_and_resize_jpeg([jpeg0, b"NotAJpeg"], [8, 8]))
+
   def testPng(self):
     # Read some real PNGs, converting to different channel numbers
     inputs = [(1, "lena_gray.png")]
@@ -24,6 +24,7 @@ import math
 import numpy as np
 from six.moves import xrange  # pylint: disable=redefined-builtin
 
+from tensorflow.python.compat import compat as forward_compat
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
@@ -689,8 +690,7 @@ class EmbeddingLookupSparseTest(test.TestCase):
       index += num_val
     return grouped_vals
 
-  @test_util.run_deprecated_v1
-  def testEmbeddingLookupSparse(self):
+  def _testEmbeddingLookupSparse(self):
     vocab_size = 13
     batch_size = 10
     param_shape = [2, 5]
@@ -748,8 +748,7 @@ class EmbeddingLookupSparseTest(test.TestCase):
         atol = rtol
         self.assertAllClose(np_embedding_sum, tf_embedding_sum, rtol, atol)
 
-  @test_util.run_deprecated_v1
-  def testGradientsEmbeddingLookupSparse(self):
+  def _testGradientsEmbeddingLookupSparse(self):
     vocab_size = 12
     batch_size = 4
     param_shape = [2, 3]
@@ -776,6 +775,48 @@ class EmbeddingLookupSparseTest(test.TestCase):
             x, x_shape, y, y_shape, x_init_value=x_init_value)
       self.assertLess(err, 1e-5 if dtype == dtypes.float64 else 2e-3)
 
+  @test_util.run_deprecated_v1
+  def testEmbeddingLookupSparse(self):
+    self._testEmbeddingLookupSparse()
+
+  @test_util.run_deprecated_v1
+  def testGradientsEmbeddingLookupSparse(self):
+    self._testGradientsEmbeddingLookupSparse()
+
+  @test_util.run_deprecated_v1
+  def testFusedEmbeddingLookupSparse(self):
+    with forward_compat.forward_compatibility_horizon(2020, 7, 25):
+      self._testEmbeddingLookupSparse()
+
+  @test_util.run_deprecated_v1
+  def testFusedGradientsEmbeddingLookupSparse(self):
+    with forward_compat.forward_compatibility_horizon(2020, 7, 25):
+      self._testGradientsEmbeddingLookupSparse()
+
+  @test_util.run_deprecated_v1
+  def testFusedGradientsEmbeddingLookupSparseWeights(self):
+    vocab_size = 12
+    batch_size = 4
+    sp_ids, sp_weights, _, weights, _ = self._RandomIdsAndWeights(
+        batch_size, vocab_size)
+    params = np.random.rand(vocab_size, 3)
+    for combiner in ["sum", "mean", "sqrtn"]:
+      with self.cached_session(), forward_compat.forward_compatibility_horizon(
+          2020, 7, 25):
+        x = constant_op.constant(params, dtypes.float64)
+        w = constant_op.constant(weights, dtypes.float64)
+        y = embedding_ops.embedding_lookup_sparse(
+            x,
+            sp_ids,
+            sparse_tensor.SparseTensor(sp_weights.indices, w,
+                                       sp_weights.dense_shape),
+            combiner=combiner)
+        self.assertEqual(y.op.inputs[0].op.type, "EmbeddingLookupSparse")
+        err = gradient_checker.compute_gradient_error(
+            [x, w], [params.shape, weights.shape], y, [batch_size, 3],
+            x_init_value=[params, weights])
+      self.assertLess(err, 1e-5)
+
   @test_util.run_deprecated_v1
   def testIncompatibleShapes(self):
     with self.cached_session():
@@ -3146,6 +3146,42 @@ class MutableHashTableOpTest(test.TestCase):
       result = self.evaluate(output)
       self.assertAllEqual([3, 1, -1], result)
 
+  @test_util.run_deprecated_v1
+  def testMutableHashTableConcurrentInsertAndFind(self):
+    with self.cached_session() as sess:
+      table = lookup_ops.MutableHashTable(dtypes.int64, dtypes.int64, -1)
+      inserts = []
+      for i in range(4):
+        keys = np.arange(i * 1000, (i + 1) * 1000, dtype=np.int64)
+        inserts.append(
+            table.insert(constant_op.constant(keys),
+                         constant_op.constant(keys * 2)))
+      all_keys = np.arange(4000, dtype=np.int64)
+      output = table.lookup(constant_op.constant(all_keys))
+
+      def run(op):
+        for _ in range(20):
+          result = sess.run(op)
+          if op is output:
+            # Each key is either missing or has its final value.
+            self.assertTrue(np.all((result == -1) | (result == all_keys * 2)))
+
+      threads = [
+          self.checkedThread(target=run, args=(op,))
+          for op in inserts + [output]
+      ]
+      for t in threads:
+        t.start()
+      for t in threads:
+        t.join()
+
+      self.assertAllEqual(4000, self.evaluate(table.size()))
+      self.assertAllEqual(all_keys * 2, self.evaluate(output))
+      exported_keys, exported_values = table.export()
+      self.assertAllEqual(all_keys, np.sort(self.evaluate(exported_keys)))
+      self.assertAllEqual(all_keys * 2,
+                          np.sort(self.evaluate(exported_values)))
+
   def testMutableHashTableFindHighRank(self):
     with self.cached_session():
       default_val = -1
@@ -38,7 +38,11 @@ from tensorflow.python.framework import tensor_shape
 from tensorflow.python.framework import tensor_util
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_parsing_ops
+from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import parsing_ops
+from tensorflow.python.ops import sparse_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.ops.ragged import ragged_concat_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.ops.ragged import ragged_tensor
@@ -2505,5 +2509,77 @@ class ParseTensorOpTest(test.TestCase):
         tensor.eval(feed_dict={serialized: ["bogus"]})
 
 
+class ParseExampleFeatureIdsTest(test.TestCase):
+
+  def _serialized(self):
+    return [
+        example(features=features({
+            "s": bytes_feature([b"a", b"b"]),
+            "f": float_feature([0.5]),
+            "i": int64_feature([2]),
+        })).SerializeToString(),
+        example(features=features({
+            "s": bytes_feature([b"c"]),
+            "f": float_feature([-1.0, 3.0]),
+        })).SerializeToString(),
+        example(features=features({})).SerializeToString(),
+    ]
+
+  def _parse(self, serialized, **kwargs):
+    return gen_parsing_ops.parse_example_feature_ids(
+        serialized,
+        num_outputs=4,
+        feature_keys=["s", "f", "i"],
+        feature_transforms=["hash_bucket", "bucketize", "identity"],
+        num_buckets=[100, 3, 5],
+        boundaries=[0.0, 1.0],
+        cross_sizes=[2],
+        cross_features=[0, 1],
+        cross_num_buckets=[1000],
+        **kwargs)
+
+  def testMatchesUnfusedOps(self):
+    indices, ids, weights, dense_shapes = self._parse(self._serialized())
+    hashed = string_ops.string_to_hash_bucket_fast([b"a", b"b", b"c"], 100)
+    bucketized = math_ops._bucketize([0.5, -1.0, 3.0], boundaries=[0.0, 1.0])
+    self.assertAllEqual([[0, 0], [0, 1], [1, 0]], indices[0])
+    self.assertAllEqual(hashed, ids[0])
+    self.assertAllEqual([3, 2], dense_shapes[0])
+    self.assertAllEqual([[0, 0], [1, 0], [1, 1]], indices[1])
+    self.assertAllEqual(bucketized, ids[1])
+    self.assertAllEqual([[0, 0]], indices[2])
+    self.assertAllEqual([2], ids[2])
+    self.assertAllEqual([3, 1], dense_shapes[2])
+    for i in range(4):
+      self.assertAllEqual(array_ops.ones_like(weights[i]), weights[i])
+
+    crossed = sparse_ops.sparse_cross_hashed([
+        sparse_tensor.SparseTensor(indices[0], ids[0], dense_shapes[0]),
+        sparse_tensor.SparseTensor(indices[1], ids[1], dense_shapes[1]),
+    ], num_buckets=1000)
+    self.assertAllEqual(crossed.indices, indices[3])
+    self.assertAllEqual(crossed.values, ids[3])
+    self.assertAllEqual(crossed.dense_shape, dense_shapes[3])
+
+  def testFillEmptyRows(self):
+    indices, ids, weights, dense_shapes = self._parse(
+        self._serialized(), fill_empty_rows=True)
+    self.assertAllEqual([[0, 0], [1, 0], [2, 0]], indices[2])
+    self.assertAllEqual([2, 0, 0], ids[2])
+    self.assertAllEqual([1.0, 0.0, 0.0], weights[2])
+    self.assertAllEqual([3, 1], dense_shapes[2])
+    self.assertAllEqual([[0, 0], [0, 1], [1, 0], [1, 1], [2, 0]], indices[3])
+    self.assertAllEqual([1.0, 1.0, 1.0, 1.0, 0.0], weights[3])
+
+  def testIdOutOfRange(self):
+    serialized = [
+        example(features=features({
+            "i": int64_feature([7])
+        })).SerializeToString()
+    ]
+    with self.assertRaisesOpError("which is not in"):
+      self.evaluate(self._parse(serialized))
+
+
 if __name__ == "__main__":
   test.main()
@@ -865,6 +865,19 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     value = self.evaluate(v.sparse_read([0, 3, 1, 2]))
     self.assertAllEqual(init_value[[0, 3, 1, 2], ...], value)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testGatherPrefetch(self):
+    init_value = np.reshape(np.arange(np.power(4, 3)), (4, 4, 4))
+    v = resource_variable_ops.ResourceVariable(
+        constant_op.constant(init_value, dtype=dtypes.float32), name="var3")
+    self.evaluate(variables.global_variables_initializer())
+
+    # Prefetching only hints the device, and ignores out of range indices.
+    self.evaluate(
+        resource_variable_ops.resource_gather_prefetch(v.handle, [3, 0, 5, 0]))
+    value = self.evaluate(v.sparse_read([3, 0]))
+    self.assertAllEqual(init_value[[3, 0], ...], value)
+
   @test_util.run_in_graph_and_eager_modes
   def testGatherNd(self):
     init_value = np.reshape(np.arange(np.power(4, 3)), (4, 4, 4))
@@ -558,6 +558,31 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
               # and may therefore vary dynamically.
               self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testValuesManySegments(self):
+    # Covers the rows of the widths that are reduced with fixed-size loops,
+    # and enough segments to be reduced in parallel.
+    ops_list = [(np.add, None, math_ops.sparse_segment_sum),
+                (self._mean_cum_op, self._mean_reduce_op,
+                 math_ops.sparse_segment_mean),
+                (self._mean_cum_op, self._sqrt_n_reduce_op,
+                 math_ops.sparse_segment_sqrt_n)]
+    segment_indices = []
+    for i in range(0, 2000, 2):
+      for _ in range(i % 13 + 1):
+        segment_indices.append(i)
+    num_indices = len(segment_indices)
+    for dtype in [dtypes_lib.float32, dtypes_lib.float64]:
+      for width in [3, 8, 16, 64]:
+        with self.cached_session(use_gpu=False):
+          tf_indices, np_indices, tf_x, np_x = self._sparse_input(
+              [500, width], num_indices, dtype=dtype)
+          for np_op1, np_op2, tf_op in ops_list:
+            np_ans = self._sparseSegmentReduce(np_x, np_indices,
+                                               segment_indices, np_op1, np_op2)
+            s = tf_op(
+                data=tf_x, indices=tf_indices, segment_ids=segment_indices)
+            self.assertAllClose(np_ans, self.evaluate(s))
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
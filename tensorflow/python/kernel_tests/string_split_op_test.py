@@ -27,6 +27,7 @@ from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_string_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.ops.ragged import ragged_string_ops
@@ -450,6 +451,21 @@ class StringSplitV2OpTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     with self.assertRaisesRegexp(ValueError, "result_type must be .*"):
       ragged_string_ops.strings_split_v1("foo", result_type="BouncyTensor")
 
+  @parameterized.parameters([
+      {"sep": b" "},
+      {"sep": b""},
+      {"sep": b"<>", "maxsplit": 1},
+  ])
+  def testSplitToHashBucketFast(self, sep, maxsplit=-1):
+    strings = [b"pigs on the wing", b"animals<>dogs<>sheep", b"", b"  a  b "]
+    indices, values, shape = gen_string_ops.string_split_to_hash_bucket_fast(
+        strings, sep, maxsplit=maxsplit, num_buckets=1000)
+    expected = gen_string_ops.string_split_v2(strings, sep, maxsplit=maxsplit)
+    self.assertAllEqual(expected.indices, indices)
+    self.assertAllEqual(
+        string_ops.string_to_hash_bucket_fast(expected.values, 1000), values)
+    self.assertAllEqual(expected.shape, shape)
+
   def _py_split(self, strings, **kwargs):
     if isinstance(strings, compat.bytes_or_text_types):
       # Note: str.split doesn't accept keyword args.
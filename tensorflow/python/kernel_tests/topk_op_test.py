@@ -153,6 +153,23 @@ class TopKTest(test.TestCase):
     self._testMediumTopK(np.float32)
     self._testMediumTopK(np.float16)
 
+  def testLargeRowTopK(self):
+    # Single rows this long are split across threads on CPU.
+    n = 1 << 18
+    for k in [5, 100]:
+      inputs = np.random.permutation(n).astype(np.float32).reshape(1, n)
+      indices = np.argsort(-inputs, axis=1)[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+
+  def testLargeRowStableSort(self):
+    n = 1 << 18
+    inputs = np.random.randint(0, 4, size=(2, n)).astype(np.int32)
+    k = 100
+    indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def testStableSort(self):
     b = 5
     n = 500
@@ -17,6 +17,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.python.framework import dtypes
 from tensorflow.python.ops import gen_collective_ops
 
 
@@ -28,7 +29,8 @@ def all_reduce(t,
                final_op,
                subdiv_offsets=(0,),
                communication_hint='auto',
-               timeout=0):
+               timeout=0,
+               wire_dtype=None):
   """Reduces tensors collectively, across devices.
 
   Args:
@@ -45,11 +47,17 @@ def all_reduce(t,
       independent subdivision should begin.  Use [0] if no subdivision should
       be done.
     communication_hint: preferred collective communication.  The implementation
-      may fall back to another mechanism.  Options include `auto`, `ring`, and
-      `nccl`.
+      may fall back to another mechanism.  Options include `auto`, `ring`,
+      `nccl`, and `hierarchical`, which on CPU devices reduces within each task
+      before reducing across tasks, if all tasks have the same number of
+      devices.
     timeout: If set to a non zero, set a completion timeout to detect staleness.
       If the timer goes off, a DeadlineExceededError is raised.
       The timeout value in seconds. This feature is experimental.
+    wire_dtype: if `float16` or `bfloat16`, a float32 `t` is sent between
+      CPU devices in that lower precision data type, while partial reductions
+      are still computed in float32.  Must be the same on all devices of the
+      group.  This feature is experimental.
 
   Returns:
     An Op implementing the distributed reduction.
@@ -68,7 +76,8 @@ def all_reduce(t,
       final_op=final_op,
       subdiv_offsets=subdiv_offsets,
       communication_hint=communication_hint.lower(),
-      timeout_seconds=timeout)
+      timeout_seconds=timeout,
+      wire_dtype=wire_dtype or dtypes.float32)
 
 
 def all_gather(t,
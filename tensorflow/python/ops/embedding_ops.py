@@ -30,6 +30,7 @@ from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
@@ -505,6 +506,12 @@ def embedding_lookup_sparse(params,
                       params + [sp_ids]) as name:
     segment_ids = sp_ids.indices[:, 0]
 
+    if (len(params) == 1 and max_norm is None and
+        _can_fuse_embedding_lookup_sparse(params[0], sp_ids)):
+      return _fused_embedding_lookup_sparse(params[0], sp_ids.values,
+                                            sp_weights, segment_ids, combiner,
+                                            name)
+
     ids = sp_ids.values
     ids, idx = array_ops.unique(ids)
 
@@ -577,6 +584,34 @@ def embedding_lookup_sparse(params,
     return embeddings
 
 
+def _can_fuse_embedding_lookup_sparse(params, sp_ids):
+  """Whether embedding_lookup_sparse can use the EmbeddingLookupSparse op."""
+  if not compat.forward_compatible(2020, 7, 24):
+    return False
+  if not isinstance(params,
+                    (ops.Tensor, resource_variable_ops.BaseResourceVariable)):
+    return False
+  return (params.dtype in (dtypes.float32, dtypes.float64) and
+          sp_ids.values.dtype in (dtypes.int32, dtypes.int64))
+
+
+def _fused_embedding_lookup_sparse(params, ids, sp_weights, segment_ids,
+                                   combiner, name):
+  """Combines the embeddings without gathering them into a temporary."""
+  if sp_weights is None:
+    weights = array_ops.zeros([0], dtype=params.dtype)
+  else:
+    weights = sp_weights.values
+    if weights.dtype != params.dtype:
+      weights = math_ops.cast(weights, params.dtype)
+  with ops.colocate_with(params):
+    result = gen_math_ops.embedding_lookup_sparse(
+        params, ids, weights, segment_ids, combiner=combiner)
+  # Make sure the final result does not have colocation constraints on the
+  # params, as in _embedding_lookup_and_transform.
+  return array_ops.identity(result, name=name)
+
+
 @tf_export("nn.embedding_lookup_sparse", v1=[])
 @dispatch.add_dispatch_support
 def embedding_lookup_sparse_v2(params,
@@ -384,6 +384,26 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("EmbeddingLookupSparse")
+def _EmbeddingLookupSparseGrad(op, grad):
+  """Gradient for EmbeddingLookupSparse."""
+  params, ids, weights, segment_ids = op.inputs
+  params_grad, weights_grad = gen_math_ops.embedding_lookup_sparse_grad(
+      grad,
+      params,
+      ids,
+      weights,
+      segment_ids,
+      op.outputs[0],
+      combiner=op.get_attr("combiner"))
+  # The gradient has one row per id, like the gradient of Gather.
+  with ops.colocate_with(params):
+    params_shape = array_ops.shape(params, out_type=dtypes.int64)
+    params_shape = math_ops.cast(params_shape, dtypes.int32)
+  params_grad = ops.IndexedSlices(params_grad, ids, params_shape)
+  return params_grad, None, weights_grad, None
+
+
 def _SegmentMinOrMaxGrad(op, grad):
   """ Gradient for SegmentMin and SegmentMax. """
   zeros = array_ops.zeros_like(op.inputs[0], dtype=op.inputs[0].dtype)
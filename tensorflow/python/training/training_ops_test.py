@@ -423,6 +423,79 @@ class TrainingOpsTest(TensorFlowTestCase):
       self.assertShapeEqual(out, apply_adam)
       self.assertAllCloseAccordingToType(new_var, out)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceApplyAdamGroup(self):
+    shapes = [[3], [2, 2], [0], [5]]
+    rng = np.random.RandomState(0)
+    var_vals = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    m_vals = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    v_vals = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    grads = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    t = 2
+    beta1, beta2, lr, epsilon = 0.9, 0.999, 0.01, 1e-8
+    with self.cached_session(use_gpu=False):
+      var = [resource_variable_ops.ResourceVariable(x) for x in var_vals]
+      m = [resource_variable_ops.ResourceVariable(x) for x in m_vals]
+      v = [resource_variable_ops.ResourceVariable(x) for x in v_vals]
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.resource_apply_adam_group(
+              [x.handle for x in var], [x.handle for x in m],
+              [x.handle for x in v], beta1**t, beta2**t, lr, beta1, beta2,
+              epsilon, grads))
+      for i in range(len(shapes)):
+        new_var, new_m, new_v = self._adamUpdateNumpy(
+            var_vals[i], grads[i], t, m_vals[i], v_vals[i], lr, beta1, beta2,
+            epsilon)
+        self.assertAllClose(new_var, self.evaluate(var[i]), rtol=1e-5)
+        self.assertAllClose(new_m, self.evaluate(m[i]), rtol=1e-5)
+        self.assertAllClose(new_v, self.evaluate(v[i]), rtol=1e-5)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceApplyAdagradGroup(self):
+    shapes = [[3], [2, 2], [5]]
+    rng = np.random.RandomState(0)
+    var_vals = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    accum_vals = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    grads = [rng.rand(*shape).astype(np.float32) for shape in shapes]
+    lr = 0.1
+    with self.cached_session(use_gpu=False):
+      var = [resource_variable_ops.ResourceVariable(x) for x in var_vals]
+      accum = [resource_variable_ops.ResourceVariable(x) for x in accum_vals]
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.resource_apply_adagrad_group(
+              [x.handle for x in var], [x.handle for x in accum], lr, grads))
+      for i in range(len(shapes)):
+        new_accum = accum_vals[i] + grads[i] * grads[i]
+        new_var = var_vals[i] - lr * grads[i] / np.sqrt(new_accum)
+        self.assertAllClose(new_var, self.evaluate(var[i]), rtol=1e-5)
+        self.assertAllClose(new_accum, self.evaluate(accum[i]), rtol=1e-5)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testResourceSparseApplyAdagradRowLocking(self):
+    rng = np.random.RandomState(0)
+    for shape in [[4], [4, 3]]:
+      var_val = rng.rand(*shape).astype(np.float32)
+      accum_val = rng.rand(*shape).astype(np.float32)
+      indices = np.array([3, 0]).astype(np.int64)
+      grad = rng.rand(2, *shape[1:]).astype(np.float32)
+      lr = 0.1
+      with self.cached_session(use_gpu=False):
+        var = resource_variable_ops.ResourceVariable(var_val)
+        accum = resource_variable_ops.ResourceVariable(accum_val)
+        self.evaluate(variables.global_variables_initializer())
+        self.evaluate(
+            training_ops.resource_sparse_apply_adagrad(
+                var.handle, accum.handle, lr, grad, indices,
+                use_row_locking=True))
+        new_accum = accum_val.copy()
+        new_accum[indices] += grad * grad
+        new_var = var_val.copy()
+        new_var[indices] -= lr * grad / np.sqrt(new_accum[indices])
+        self.assertAllClose(new_var, self.evaluate(var), rtol=1e-5)
+        self.assertAllClose(new_accum, self.evaluate(accum), rtol=1e-5)
+
   def _adamUpdateNumpy(self, param, g_t, t, m, v, alpha, beta1, beta2, epsilon):
     alpha_t = alpha * np.sqrt(1 - beta2**t) / (1 - beta1**t)
 
@@ -46,6 +46,7 @@ limitations under the License.
 
 #include <complex>
 
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "third_party/eigen3/Eigen/Core"
@@ -220,31 +221,33 @@ class ScopedCublasMathMode {
 
 bool CUDABlas::Init() {
   gpu::ScopedActivateExecutorContext sac{parent_};
-  cublasStatus_t ret = cublasCreate(&blas_);
+  cublasStatus_t ret = cublasCreate(&shared_handle_.handle);
   if (ret != CUBLAS_STATUS_SUCCESS) {
     LOG(ERROR) << "failed to create cublas handle: " << ToString(ret);
     return false;
   }
+  shared_handle_.shared = true;
 
   return true;
 }
 
 CUDABlas::CUDABlas(gpu::GpuExecutor *parent)
-    : parent_(CHECK_NOTNULL(parent)), blas_(nullptr) {}
+    : parent_(CHECK_NOTNULL(parent)) {}
 
 CUDABlas::~CUDABlas() {
-  if (blas_ != nullptr) {
-    gpu::ScopedActivateExecutorContext sac{parent_};
-    cublasDestroy(blas_);
+  gpu::ScopedActivateExecutorContext sac{parent_};
+  if (shared_handle_.handle != nullptr) {
+    cublasDestroy(shared_handle_.handle);
+  }
+  absl::MutexLock lock(&mu_);
+  for (auto &stream_handle : stream_handles_) {
+    cublasDestroy(stream_handle.second->handle);
   }
 }
 
-bool CUDABlas::SetStream(Stream *stream) {
-  CHECK(stream != nullptr);
-  CHECK(AsGpuStreamValue(stream) != nullptr);
-  CHECK(blas_ != nullptr);
+bool CUDABlas::SetStream(cublasHandle_t handle, Stream *stream) {
   gpu::ScopedActivateExecutorContext sac{parent_};
-  cublasStatus_t ret = cublasSetStream(blas_, AsGpuStreamValue(stream));
+  cublasStatus_t ret = cublasSetStream(handle, AsGpuStreamValue(stream));
   if (ret != CUBLAS_STATUS_SUCCESS) {
     LOG(ERROR) << "failed to set stream for cuBLAS calls: " << ToString(ret);
     return false;
@@ -253,6 +256,36 @@ bool CUDABlas::SetStream(Stream *stream) {
   return true;
 }
 
+CUDABlas::StreamHandle *CUDABlas::GetStreamHandle(Stream *stream) {
+  CHECK(stream != nullptr);
+  CHECK(AsGpuStreamValue(stream) != nullptr);
+  CHECK(shared_handle_.handle != nullptr);
+  absl::MutexLock lock(&mu_);
+  auto it = stream_handles_.find(AsGpuStreamValue(stream));
+  if (it != stream_handles_.end()) {
+    return it->second.get();
+  }
+  if (stream_handles_.size() >= kMaxStreamHandles) {
+    return &shared_handle_;
+  }
+  auto stream_handle = absl::make_unique<StreamHandle>();
+  gpu::ScopedActivateExecutorContext sac{parent_};
+  cublasStatus_t ret = cublasCreate(&stream_handle->handle);
+  if (ret != CUBLAS_STATUS_SUCCESS) {
+    LOG(WARNING) << "failed to create cublas handle for stream, sharing the "
+                    "default one: "
+                 << ToString(ret);
+    return &shared_handle_;
+  }
+  if (!SetStream(stream_handle->handle, stream)) {
+    cublasDestroy(stream_handle->handle);
+    return nullptr;
+  }
+  StreamHandle *result = stream_handle.get();
+  stream_handles_[AsGpuStreamValue(stream)] = std::move(stream_handle);
+  return result;
+}
+
 namespace {
 
 // Helper functions transforming blas arguments into cuBLAS arguments.
@@ -389,15 +422,18 @@ template <typename FuncT, typename... Args>
 bool CUDABlas::DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
                                   bool pointer_mode_host, bool err_on_failure,
                                   cublasMath_t math_type, Args... args) {
-  absl::MutexLock lock(&mu_);
-
-  CHECK(blas_ != nullptr);
-  if (!SetStream(stream)) {
+  StreamHandle *stream_handle = GetStreamHandle(stream);
+  if (stream_handle == nullptr) {
+    return false;
+  }
+  absl::MutexLock lock(&stream_handle->mu);
+  cublasHandle_t blas = stream_handle->handle;
+  if (stream_handle->shared && !SetStream(blas, stream)) {
     return false;
   }
 
 #if CUDA_VERSION >= 9000
-  ScopedCublasMathMode math_mode{blas_};
+  ScopedCublasMathMode math_mode{blas};
 #if CUBLAS_VER_MAJOR >= 11
   if (math_type == CUBLAS_TF32_TENSOR_OP_MATH &&
       tensorflow::tf32_execution_allowed()) {
@@ -411,12 +447,12 @@ bool CUDABlas::DoBlasInternalImpl(FuncT cublas_func, Stream *stream,
 #endif
 
   gpu::ScopedActivateExecutorContext sac{parent_};
-  ScopedCublasPointerMode pointer_mode{blas_};
+  ScopedCublasPointerMode pointer_mode{blas};
   if (!pointer_mode.Init(pointer_mode_host ? CUBLAS_POINTER_MODE_HOST
                                            : CUBLAS_POINTER_MODE_DEVICE)) {
     return false;
   }
-  cublasStatus_t ret = cublas_func(blas_, args...);
+  cublasStatus_t ret = cublas_func(blas, args...);
   if ((err_on_failure || VLOG_IS_ON(3)) && ret != CUBLAS_STATUS_SUCCESS) {
     LOG(ERROR) << "failed to run cuBLAS routine: " << ToString(ret);
   }
@@ -2912,10 +2948,10 @@ bool CUDABlas::DoBlasTrsm(Stream *stream, blas::Side side,
 }
 
 port::Status CUDABlas::GetVersion(std::string *version) {
-  absl::MutexLock lock(&mu_);
+  absl::MutexLock lock(&shared_handle_.mu);
 
   int v;
-  auto status = cublasGetVersion(blas_, &v);
+  auto status = cublasGetVersion(shared_handle_.handle, &v);
   if (status != CUBLAS_STATUS_SUCCESS) {
     return port::InternalError(ToString(status));
   }
@@ -20,6 +20,9 @@ limitations under the License.
 #ifndef TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_BLAS_H_
 #define TENSORFLOW_STREAM_EXECUTOR_CUDA_CUDA_BLAS_H_
 
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "third_party/gpus/cuda/include/cublas_v2.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -50,6 +53,11 @@ class GpuExecutor;
 // to. This simply happens as an artifact of creating the cuBLAS handle when a
 // CUDA context is active.
 //
+// Each stream that enqueues BLAS operations gets its own cuBLAS handle, bound
+// to it once, so that calls on different streams don't serialize on a single
+// handle. Past kMaxStreamHandles streams, the remaining ones share the handle
+// created by Init() and set it to their stream on every call.
+//
 // Thread-safe post-initialization.
 class CUDABlas : public blas::BlasSupport {
  public:
@@ -64,12 +72,28 @@ class CUDABlas : public blas::BlasSupport {
   TENSORFLOW_STREAM_EXECUTOR_GPU_BLAS_SUPPORT_OVERRIDES
 
  private:
+  // A cuBLAS handle, and the mutex serializing the calls that use it.
+  struct StreamHandle {
+    absl::Mutex mu;
+    cublasHandle_t handle = nullptr;  // Owned.
+    // If true, the handle is shared by several streams and must be set to
+    // the stream of each call.
+    bool shared = false;
+  };
+
+  // At most this many streams get a handle of their own.
+  static constexpr int kMaxStreamHandles = 16;
+
   // Tells cuBLAS to enqueue the BLAS operation onto a particular Stream.
   //
   // cuBLAS is stateful, and only be associated with one stream (in order to
-  // enqueue dispatch) at a given time. As a result, this generally must be
-  // invoked before calling into cuBLAS.
-  bool SetStream(Stream *stream) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // enqueue dispatch) at a given time. As a result, this must be invoked
+  // before calling into cuBLAS with a shared handle.
+  bool SetStream(cublasHandle_t handle, Stream *stream);
+
+  // Returns the handle to use for stream, creating one bound to it on first
+  // use. Returns nullptr if stream is invalid.
+  StreamHandle *GetStreamHandle(Stream *stream) TF_LOCKS_EXCLUDED(mu_);
 
   // A helper function that calls the real cuBLAS function together with error
   // handling.
@@ -134,15 +158,20 @@ class CUDABlas : public blas::BlasSupport {
                                    const T &beta, DeviceMemory<T> *y, int incy,
                                    blas::ProfileResult *output_profile_result);
 
-  // Guards the cuBLAS handle for this device.
-  absl::Mutex mu_;
-
   // GpuExecutor which instantiated this CUDABlas.
   // Immutable post-initialization.
   GpuExecutor *parent_;
 
-  // cuBLAS library handle on the device.
-  cublasHandle_t blas_ TF_GUARDED_BY(mu_);
+  // The cuBLAS handle created by Init(), shared by the streams without a
+  // handle of their own.
+  StreamHandle shared_handle_;
+
+  // Guards stream_handles_.
+  absl::Mutex mu_;
+
+  // The handles bound to a single stream, keyed by the stream.
+  absl::flat_hash_map<cudaStream_t, std::unique_ptr<StreamHandle>>
+      stream_handles_ TF_GUARDED_BY(mu_);
 
   SE_DISALLOW_COPY_AND_ASSIGN(CUDABlas);
 };
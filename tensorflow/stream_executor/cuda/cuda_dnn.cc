@@ -19,6 +19,8 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "third_party/eigen3/Eigen/Core"
 #include "tensorflow/core/lib/core/errors.h"
@@ -150,10 +152,15 @@ class CudnnHandle {
 
 }  // namespace
 
-// Wraps a cuDNN handle and provides access to it through CudnnHandle
+// Wraps cuDNN handles and provides access to them through CudnnHandle
 // instances, which also locks a mutex, acquires the CUDA context, and sets
 // the stream that cuDNN should use to enqueue any work.
 //
+// Each stream gets a handle of its own, bound to it on first use, so that
+// cuDNN calls on different streams don't serialize on one mutex. Past
+// kMaxStreamHandles streams, and for the null stream, calls share the handle
+// passed to the constructor and set its stream every time.
+//
 // Note: CudnnSupport::cudnn_ should be the only instantiation of this class.
 class CudnnAccess {
  public:
@@ -161,6 +168,12 @@ class CudnnAccess {
   explicit CudnnAccess(cudnnHandle_t handle) : handle_(handle) {}
 
   ~CudnnAccess() {
+    {
+      absl::MutexLock lock(&stream_handles_mutex_);
+      for (auto& stream_handle : stream_handles_) {
+        cudnnDestroy(stream_handle.second->handle);
+      }
+    }
     absl::MutexLock lock(&mutex_);
     cudnnDestroy(handle_);
   }
@@ -169,11 +182,11 @@ class CudnnAccess {
   //
   // cuDNN API calls using the same handle instance need to be serialized
   // across threads. This is guaranteed by CudnnHandle instances locking the
-  // mutex owned by this class.
+  // mutex of the handle.
   //
   // Most cuDNN APIs taking a handle perform work on a CUDA stream. The
-  // CudnnHandle instance acquires the executor's CUDA context and sets cuDNN
-  // to use the provided stream.
+  // CudnnHandle instance acquires the executor's CUDA context and uses a
+  // handle set to the provided stream.
   //
   // The stream argument may be null, which translates to the legacy default
   // stream. See
@@ -182,6 +195,15 @@ class CudnnAccess {
   // therefore a bad idea (performance wise) to call any cuDNN APIs that
   // enqueue work in the stream.
   CudnnHandle GetHandle(GpuExecutor* executor, Stream* stream) {
+    if (stream != nullptr) {
+      if (StreamHandle* stream_handle =
+              GetStreamHandle(executor, AsGpuStreamValue(stream))) {
+        auto lock = absl::make_unique<absl::MutexLock>(&stream_handle->mutex);
+        gpu::ScopedActivateExecutorContext context(executor);
+        return CudnnHandle(std::move(context), std::move(lock),
+                           stream_handle->handle);
+      }
+    }
     auto lock = absl::make_unique<absl::MutexLock>(&mutex_);
     mutex_.AssertHeld();
     gpu::ScopedActivateExecutorContext context(executor);
@@ -192,11 +214,55 @@ class CudnnAccess {
   }
 
  private:
+  // A cuDNN handle bound to one stream.
+  struct StreamHandle {
+    // Guards the enqueueing of cuDNN operations via the handle below.
+    absl::Mutex mutex;
+    cudnnHandle_t handle = nullptr;  // Owned.
+  };
+
+  // At most this many streams get a handle of their own.
+  static constexpr int kMaxStreamHandles = 16;
+
+  // Returns the handle bound to cu_stream, creating it on first use. Returns
+  // nullptr if the stream should use the shared handle_.
+  StreamHandle* GetStreamHandle(GpuExecutor* executor, CUstream cu_stream) {
+    absl::MutexLock lock(&stream_handles_mutex_);
+    auto it = stream_handles_.find(cu_stream);
+    if (it != stream_handles_.end()) {
+      return it->second.get();
+    }
+    if (stream_handles_.size() >= kMaxStreamHandles) {
+      return nullptr;
+    }
+    gpu::ScopedActivateExecutorContext context(executor);
+    auto stream_handle = absl::make_unique<StreamHandle>();
+    auto status = cudnnCreate(&stream_handle->handle);
+    if (status != CUDNN_STATUS_SUCCESS) {
+      LOG(WARNING) << "Failed to create cuDNN handle for stream, sharing the "
+                      "default one: "
+                   << ToString(status);
+      return nullptr;
+    }
+    status = cudnnSetStream(stream_handle->handle, cu_stream);
+    CHECK_EQ(status, CUDNN_STATUS_SUCCESS) << "Failed to set cuDNN stream.";
+    StreamHandle* result = stream_handle.get();
+    stream_handles_[cu_stream] = std::move(stream_handle);
+    return result;
+  }
+
   // Guards the enqueueing of cuDNN operations via the handle_ below.
   absl::Mutex mutex_;
 
   // cuDNN library handle.
   cudnnHandle_t handle_ TF_GUARDED_BY(mutex_);  // Owned.
+
+  // Guards stream_handles_. Acquired before the mutex of a StreamHandle.
+  absl::Mutex stream_handles_mutex_;
+
+  // The handles bound to a single stream, keyed by the stream.
+  absl::flat_hash_map<CUstream, std::unique_ptr<StreamHandle>> stream_handles_
+      TF_GUARDED_BY(stream_handles_mutex_);
 };
 
 namespace {
@@ -965,6 +965,94 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+#if CUDA_VERSION >= 10010
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_THREAD_LOCAL),
+      "Failed to begin capturing CUDA stream");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError(
+      "Capturing CUDA streams requires CUDA 10.1 or later");
+#endif
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+#if CUDA_VERSION >= 10010
+  ScopedActivateContext activated{context};
+  CHECK(stream != nullptr);
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to capture CUDA stream");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError(
+      "Capturing CUDA streams requires CUDA 10.1 or later");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* graph_exec) {
+#if CUDA_VERSION >= 10010
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(graph_exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+#endif
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec graph_exec,
+                                                 CUstream stream) {
+#if CUDA_VERSION >= 10010
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(graph_exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10.1 or later");
+#endif
+}
+
+/* static */ void GpuDriver::DestroyGraph(GpuContext* context,
+                                          CUgraph* graph) {
+#if CUDA_VERSION >= 10010
+  if (*graph == nullptr) {
+    return;
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphDestroy(*graph);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph: " << ToString(res);
+  }
+  *graph = nullptr;
+#endif
+}
+
+/* static */ void GpuDriver::DestroyGraphExec(GpuContext* context,
+                                              CUgraphExec* graph_exec) {
+#if CUDA_VERSION >= 10010
+  if (*graph_exec == nullptr) {
+    return;
+  }
+  ScopedActivateContext activated{context};
+  CUresult res = cuGraphExecDestroy(*graph_exec);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to destroy CUDA graph executable: " << ToString(res);
+  }
+  *graph_exec = nullptr;
+#endif
+}
+
 /* static */ bool GpuDriver::IsStreamIdle(GpuContext* context,
                                           CUstream stream) {
   ScopedActivateContext activated{context};
@@ -335,6 +335,43 @@ class GpuDriver {
   static port::Status SynchronizeStream(GpuContext* context,
                                         GpuStreamHandle stream);
 
+  // Starts capturing the operations enqueued onto stream by the calling thread
+  // into a graph, instead of running them, via cuStreamBeginCapture.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html#group__CUDA__STREAM_1g767167da0bbf07157dc20b6c258a2143
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Stops capturing stream, and returns the captured graph in *graph, via
+  // cuStreamEndCapture.  Fails if an operation that cannot be captured was
+  // enqueued during the capture.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__STREAM.html#group__CUDA__STREAM_1g03dab8b2ba76b00718955177a929970c
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Creates an executable graph from graph, via cuGraphInstantiate.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1g433ae118a751c9f2087f53d7add7bc2c
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* graph_exec);
+
+  // Enqueues the operations of graph_exec onto stream, via cuGraphLaunch.
+  //
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html#group__CUDA__GRAPH_1g6b2dceb3901e71a390d2bd8b0491e471
+  static port::Status GraphLaunch(GpuContext* context,
+                                  GpuGraphExecHandle graph_exec,
+                                  GpuStreamHandle stream);
+
+  // Destroys *graph and sets it to null, via cuGraphDestroy.
+  static void DestroyGraph(GpuContext* context, GpuGraphHandle* graph);
+
+  // Destroys *graph_exec and sets it to null, via cuGraphExecDestroy.
+  static void DestroyGraphExec(GpuContext* context,
+                               GpuGraphExecHandle* graph_exec);
+
   // Blocks the calling thread until the operations associated with the context
   // have been completed, via cuCtxSynchronize.
   //